@@ -90,9 +90,18 @@ void module_sha256_complete(struct image *image, uint8_t *hash)
 #endif
 }
 
+/* uses its own digest context so modules can be hashed in parallel */
 void ri_hash(struct image *image, unsigned int offset, unsigned int size, uint8_t *hash)
 {
-	module_sha256_create(image);
-	module_sha256_update(image, image->fw_image + offset, size);
-	module_sha256_complete(image, hash);
+	unsigned char md_value[EVP_MAX_MD_SIZE];
+	unsigned int md_len;
+	EVP_MD_CTX *mdctx;
+
+	mdctx = EVP_MD_CTX_new();
+	EVP_DigestInit_ex(mdctx, EVP_sha256(), NULL);
+	EVP_DigestUpdate(mdctx, image->fw_image + offset, size);
+	EVP_DigestFinal_ex(mdctx, md_value, &md_len);
+	EVP_MD_CTX_free(mdctx);
+
+	memcpy(hash, md_value, md_len);
 }
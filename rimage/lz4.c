@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2019, Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ *  Author: Liam Girdwood <liam.r.girdwood@linux.intel.com>
+ */
+
+/*
+ * LZ4 block format compressor. Greedy matching with a single entry hash
+ * table, which is enough for firmware text and data and keeps the format
+ * trivial to decompress in the boot loader.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+
+#include "rimage.h"
+
+#define LZ4_MIN_MATCH		4
+#define LZ4_LAST_LITERALS	5	/* block must end with literals */
+#define LZ4_MF_LIMIT		12	/* no match starts in last bytes */
+#define LZ4_MAX_OFFSET		65535
+#define LZ4_HASH_BITS		12
+#define LZ4_RUN_MASK		15
+
+static uint32_t lz4_hash(const uint8_t *p)
+{
+	uint32_t v = p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+
+	return (v * 2654435761U) >> (32 - LZ4_HASH_BITS);
+}
+
+/* write the extension bytes of a literal or match length */
+static int lz4_put_len(uint8_t **op, const uint8_t *oend, size_t len)
+{
+	while (len >= 255) {
+		if (*op >= oend)
+			return -ENOSPC;
+		*(*op)++ = 255;
+		len -= 255;
+	}
+
+	if (*op >= oend)
+		return -ENOSPC;
+	*(*op)++ = len;
+
+	return 0;
+}
+
+/* write literals and an optional match, match of 0 ends the block */
+static int lz4_put_sequence(uint8_t **op, const uint8_t *oend,
+			    const uint8_t *lit, size_t lit_len,
+			    size_t offset, size_t match)
+{
+	size_t mlen = match ? match - LZ4_MIN_MATCH : 0;
+	uint8_t *token = *op;
+
+	if (*op >= oend)
+		return -ENOSPC;
+
+	*token = (lit_len < LZ4_RUN_MASK ? lit_len : LZ4_RUN_MASK) << 4;
+	(*op)++;
+
+	if (lit_len >= LZ4_RUN_MASK &&
+	    lz4_put_len(op, oend, lit_len - LZ4_RUN_MASK) < 0)
+		return -ENOSPC;
+
+	if (oend - *op < lit_len)
+		return -ENOSPC;
+	memcpy(*op, lit, lit_len);
+	*op += lit_len;
+
+	if (!match)
+		return 0;
+
+	if (oend - *op < 2)
+		return -ENOSPC;
+	*(*op)++ = offset & 0xff;
+	*(*op)++ = offset >> 8;
+
+	*token |= mlen < LZ4_RUN_MASK ? mlen : LZ4_RUN_MASK;
+	if (mlen >= LZ4_RUN_MASK &&
+	    lz4_put_len(op, oend, mlen - LZ4_RUN_MASK) < 0)
+		return -ENOSPC;
+
+	return 0;
+}
+
+/*
+ * Compress size bytes of src to an LZ4 block in dst. Returns the block
+ * size or -ENOSPC if it doesn't fit in dst_size bytes.
+ */
+int ri_lz4_compress(const uint8_t *src, size_t size, uint8_t *dst,
+		    size_t dst_size)
+{
+	int32_t table[1 << LZ4_HASH_BITS];
+	const uint8_t *oend = dst + dst_size;
+	uint8_t *op = dst;
+	size_t anchor = 0;
+	size_t ip = 0;
+	size_t ref;
+	size_t len;
+	uint32_t h;
+	int ret;
+
+	memset(table, 0xff, sizeof(table));
+
+	while (size >= LZ4_MF_LIMIT && ip <= size - LZ4_MF_LIMIT) {
+		h = lz4_hash(src + ip);
+		ref = table[h];
+		table[h] = ip;
+
+		if (ref == (size_t)-1 || ip - ref > LZ4_MAX_OFFSET ||
+		    memcmp(src + ref, src + ip, LZ4_MIN_MATCH)) {
+			ip++;
+			continue;
+		}
+
+		len = LZ4_MIN_MATCH;
+		while (ip + len < size - LZ4_LAST_LITERALS &&
+		       src[ref + len] == src[ip + len])
+			len++;
+
+		ret = lz4_put_sequence(&op, oend, src + anchor, ip - anchor,
+				       ip - ref, len);
+		if (ret < 0)
+			return ret;
+
+		ip += len;
+		anchor = ip;
+	}
+
+	ret = lz4_put_sequence(&op, oend, src + anchor, size - anchor, 0, 0);
+	if (ret < 0)
+		return ret;
+
+	return op - dst;
+}
@@ -23,6 +23,7 @@
 #include <string.h>
 #include <time.h>
 #include <sys/time.h>
+#include <pthread.h>
 
 #include <uapi/user/manifest.h>
 
@@ -630,6 +631,131 @@ static int man_write_fw_mod(struct image *image)
 	return 0;
 }
 
+/* compress one segment into buf, returns bytes used or 0 if not worth it */
+static size_t man_segment_compress(struct image *image,
+				   struct sof_man_segment_desc *segment,
+				   uint8_t *buf, size_t buf_size)
+{
+	struct sof_man_lz4_hdr *lz4 = (struct sof_man_lz4_hdr *)buf;
+	size_t size = segment->flags.r.length * MAN_PAGE_SIZE;
+	int ret;
+
+	if (!size)
+		return 0;
+
+	ret = ri_lz4_compress((uint8_t *)image->fw_image +
+			      segment->file_offset, size, buf + sizeof(*lz4),
+			      buf_size - sizeof(*lz4));
+	if (ret < 0 || ret + sizeof(*lz4) >= size)
+		return 0;
+
+	lz4->size = ret;
+
+	/* keep the next header word aligned */
+	size = sizeof(*lz4) + ret;
+	return (size + 3) & ~3;
+}
+
+/*
+ * Replace the text and data of a module created by man_module_create() with
+ * LZ4 blocks for the boot loader to decompress, and move the module end
+ * back. Segments that don't compress are kept as they are.
+ */
+static int man_module_compress(struct image *image, struct module *module,
+			       struct sof_man_module *man_module)
+{
+	struct sof_man_segment_desc *text =
+		&man_module->segment[SOF_MAN_SEGMENT_TEXT];
+	struct sof_man_segment_desc *data =
+		&man_module->segment[SOF_MAN_SEGMENT_RODATA];
+	uint32_t file_size = image->image_end - module->foffset;
+	size_t text_size;
+	size_t data_size;
+	uint8_t *buf;
+	uint32_t end;
+
+	/* worst case LZ4 block of each segment */
+	buf = calloc(2 * (file_size + file_size / 255 + 64), 1);
+	if (!buf)
+		return -ENOMEM;
+
+	text_size = man_segment_compress(image, text, buf,
+					 file_size + file_size / 255 + 64);
+	if (!text_size) {
+		fprintf(stdout, " module %s: text not compressed\n",
+			module->elf_file);
+		goto out;
+	}
+
+	data_size = man_segment_compress(image, data, buf + text_size,
+					 file_size + file_size / 255 + 64);
+
+	/* uncompressed data stays after the compressed text */
+	if (!data_size) {
+		data_size = data->flags.r.length * MAN_PAGE_SIZE;
+		memmove((uint8_t *)image->fw_image + module->foffset +
+			text_size, (uint8_t *)image->fw_image +
+			data->file_offset, data_size);
+	} else {
+		data->flags.r.compressed = 1;
+		memcpy((uint8_t *)image->fw_image + module->foffset +
+		       text_size, buf + text_size, data_size);
+	}
+
+	memcpy((uint8_t *)image->fw_image + module->foffset, buf, text_size);
+	text->flags.r.compressed = 1;
+	text->file_offset = module->foffset;
+	if (data->flags.r.length)
+		data->file_offset = module->foffset + text_size;
+
+	/* clear the space freed and round the end up to a page */
+	end = module->foffset + text_size + data_size;
+	if (end % MAN_PAGE_SIZE)
+		end = (end / MAN_PAGE_SIZE + 1) * MAN_PAGE_SIZE;
+	memset((uint8_t *)image->fw_image + module->foffset + text_size +
+	       data_size, 0, image->image_end - module->foffset - text_size -
+	       data_size);
+
+	fprintf(stdout, " module %s compressed 0x%x -> 0x%x bytes\n\n",
+		module->elf_file, file_size, end - module->foffset);
+	image->image_end = end;
+
+out:
+	free(buf);
+	return 0;
+}
+
+/* bytes of a module text and data in the image file */
+static uint32_t man_module_file_size(struct image *image,
+				     struct sof_man_module *man_module)
+{
+	struct sof_man_segment_desc *text =
+		&man_module->segment[SOF_MAN_SEGMENT_TEXT];
+	struct sof_man_segment_desc *data =
+		&man_module->segment[SOF_MAN_SEGMENT_RODATA];
+	struct sof_man_lz4_hdr *lz4;
+	uint32_t size;
+
+	if (!text->flags.r.compressed)
+		return (text->flags.r.length + data->flags.r.length) *
+			MAN_PAGE_SIZE;
+
+	if (!data->flags.r.length) {
+		lz4 = (struct sof_man_lz4_hdr *)((uint8_t *)image->fw_image +
+						 text->file_offset);
+		return sizeof(*lz4) + lz4->size;
+	}
+
+	if (!data->flags.r.compressed)
+		return data->file_offset - text->file_offset +
+			data->flags.r.length * MAN_PAGE_SIZE;
+
+	lz4 = (struct sof_man_lz4_hdr *)((uint8_t *)image->fw_image +
+					 data->file_offset);
+	size = data->file_offset - text->file_offset;
+	return size + sizeof(*lz4) + lz4->size;
+}
+
 static int man_create_modules(struct image *image, struct sof_man_fw_desc *desc,
 			      int file_text_offset)
 {
@@ -676,16 +802,47 @@ static int man_create_modules(struct image *image, struct sof_man_fw_desc *desc,
 
 		if (err < 0)
 			return err;
+
+		/* the boot loader is loaded by ROM and can't be compressed */
+		if (image->compress && i - offset > 0 && !image->reloc) {
+			err = man_module_compress(image, module, man_module);
+			if (err < 0)
+				return err;
+		}
 	}
 
 	return 0;
 }
 
+/* module hash job, run in its own thread with -j */
+struct man_hash_job {
+	struct image *image;
+	struct sof_man_module *man_module;
+	pthread_t thread;
+	int started;
+};
+
+static void *man_hash_module(void *data)
+{
+	struct man_hash_job *job = data;
+	struct sof_man_module *man_module = job->man_module;
+
+	ri_hash(job->image,
+		man_module->segment[SOF_MAN_SEGMENT_TEXT].file_offset,
+		man_module_file_size(job->image, man_module),
+		man_module->hash);
+
+	return NULL;
+}
+
 static int man_hash_modules(struct image *image, struct sof_man_fw_desc *desc)
 {
+	struct man_hash_job job[MAX_MODULES];
 	struct sof_man_module *man_module;
 	int i;
 
+	memset(job, 0, sizeof(job));
+
 	for (i = 0; i < image->num_modules; i++) {
 		man_module = sof_man_get_module(desc, i);
 
@@ -695,11 +852,20 @@ static int man_hash_modules(struct image *image, struct sof_man_fw_desc *desc)
 			continue;
 		}
 
-		ri_hash(image,
-			man_module->segment[SOF_MAN_SEGMENT_TEXT].file_offset,
-			(man_module->segment[SOF_MAN_SEGMENT_TEXT].flags.r.length +
-			man_module->segment[SOF_MAN_SEGMENT_RODATA].flags.r.length) *
-			MAN_PAGE_SIZE, man_module->hash);
+		job[i].image = image;
+		job[i].man_module = man_module;
+
+		/* fall back to hashing here if the thread can't start */
+		if (image->jobs && !pthread_create(&job[i].thread, NULL,
+						   man_hash_module, &job[i]))
+			job[i].started = 1;
+		else
+			man_hash_module(&job[i]);
+	}
+
+	for (i = 0; i < image->num_modules; i++) {
+		if (job[i].started)
+			pthread_join(job[i].thread, NULL);
 	}
 
 	return 0;
@@ -45,6 +45,8 @@ static void usage(char *name)
 	fprintf(stdout, "\t -r enable relocatable ELF files\n");
 	fprintf(stdout, "\t -s MEU signing offset\n");
 	fprintf(stdout, "\t -p log dictionary outfile\n");
+	fprintf(stdout, "\t -z compress modules loaded by the boot loader\n");
+	fprintf(stdout, "\t -j hash modules in parallel\n");
 	exit(0);
 }
 
@@ -56,7 +58,7 @@ int main(int argc, char *argv[])
 
 	memset(&image, 0, sizeof(image));
 
-	while ((opt = getopt(argc, argv, "ho:p:m:vba:s:k:l:r")) != -1) {
+	while ((opt = getopt(argc, argv, "ho:p:m:vba:s:k:l:rzj")) != -1) {
 		switch (opt) {
 		case 'o':
 			image.out_file = optarg;
@@ -82,6 +84,12 @@ int main(int argc, char *argv[])
 		case 'r':
 			image.reloc = 1;
 			break;
+		case 'z':
+			image.compress = 1;
+			break;
+		case 'j':
+			image.jobs = 1;
+			break;
 		case 'h':
 			usage(argv[0]);
 			break;
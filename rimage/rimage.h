@@ -107,6 +107,8 @@ struct image {
 	int abi;
 	int verbose;
 	int reloc;	/* ELF data is relocatable */
+	int compress;	/* LZ4 compress firmware modules */
+	int jobs;	/* hash modules in parallel threads */
 	int num_modules;
 	struct module module[MAX_MODULES];
 	uint32_t image_end;/* module end, equal to output image size */
@@ -167,6 +169,9 @@ int ri_manifest_sign_v1_5(struct image *image);
 int ri_manifest_sign_v1_8(struct image *image);
 void ri_hash(struct image *image, unsigned offset, unsigned size, uint8_t *hash);
 
+int ri_lz4_compress(const uint8_t *src, size_t size, uint8_t *dst,
+		    size_t dst_size);
+
 int pkcs_v1_5_sign_man_v1_5(struct image *image,
 			    struct fw_image_manifest_v1_5 *man,
 			    void *ptr1, unsigned int size1);
@@ -0,0 +1,51 @@
+#!/bin/sh
+
+# Report where the __hot_text functions and __cold_rodata tables of a
+# firmware ELF were linked.
+# usage: sof-hot-report.sh <objdump> <elf>
+
+OBJDUMP=$1
+ELF=$2
+
+if [ -z "$OBJDUMP" ] || [ ! -f "$ELF" ]
+then
+	echo "usage: $0 <objdump> <elf>"
+	exit 1
+fi
+
+# addresses are fixed width hex so they compare as strings
+$OBJDUMP -t "$ELF" | sort | awk '
+	function hex(s,    i, v) {
+		v = 0
+		for (i = 1; i <= length(s); i++)
+			v = v * 16 + index("0123456789abcdef", substr(s, i, 1)) - 1
+		return v
+	}
+	$NF == "_hot_text_start" { start = $1 }
+	$NF == "_hot_text_end" { end = $1 }
+	$NF == "_cold_rodata_start" { cstart = $1 }
+	$NF == "_cold_rodata_end" { cend = $1 }
+	$3 == "F" { addr[n] = $1; size[n] = $5; name[n] = $6; n++ }
+	$3 == "O" { oaddr[m] = $1; osize[m] = $5; oname[m] = $6; m++ }
+	END {
+		if (start == end) {
+			print "no hot text linked"
+		} else {
+			printf("hot text 0x%s - 0x%s, %d bytes\n", start, end,
+			       hex(end) - hex(start))
+			for (i = 0; i < n; i++)
+				if (addr[i] >= start && addr[i] < end)
+					printf("0x%s %6d %s\n", addr[i],
+					       hex(size[i]), name[i])
+		}
+		if (cstart == cend) {
+			print "no cold rodata linked"
+			exit
+		}
+		printf("cold rodata 0x%s - 0x%s, %d bytes\n", cstart, cend,
+		       hex(cend) - hex(cstart))
+		for (i = 0; i < m; i++)
+			if (oaddr[i] >= cstart && oaddr[i] < cend)
+				printf("0x%s %6d %s\n", oaddr[i], hex(osize[i]),
+				       oname[i])
+	}'
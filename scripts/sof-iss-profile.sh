@@ -0,0 +1,50 @@
+#!/bin/sh
+
+# Run a program on the Xtensa ISS with profiling. Reports the time spent in
+# each source file, i.e. per component and DSP variant such as fir_hifi3.c,
+# followed by the xt-gprof flat profile.
+# usage: sof-iss-profile.sh <elf> [args]
+
+ELF=$1
+
+if [ ! -f "$ELF" ]
+then
+	echo "usage: $0 <elf> [args]"
+	exit 1
+fi
+
+shift
+
+if ! xt-run --profile="$ELF.gmon" "$ELF" "$@" > "$ELF.log"
+then
+	cat "$ELF.log"
+	echo "error: $ELF failed on the ISS"
+	exit 1
+fi
+
+# source file of every function
+xt-nm -l --defined-only "$ELF" | awk '
+	$2 ~ /^[tT]$/ && NF >= 4 {
+		n = split($4, path, "/")
+		sub(/:.*/, "", path[n])
+		print $3, path[n]
+	}' > "$ELF.files"
+
+xt-gprof -b -p "$ELF" "$ELF.gmon" > "$ELF.flat"
+
+# flat profile lines are: %time cumulative self [calls self/call total/call] name
+awk '
+	NR == FNR { file[$1] = $2; next }
+	$1 ~ /^[0-9.]+$/ && NF >= 4 {
+		src = ($NF in file) ? file[$NF] : "other"
+		self[src] += $3
+		total += $3
+	}
+	END {
+		for (src in self)
+			printf("%-32s %12.2f %6.2f%%\n", src, self[src],
+			       total ? 100 * self[src] / total : 0)
+	}' "$ELF.files" "$ELF.flat" | sort -k2 -nr
+
+echo
+cat "$ELF.flat"
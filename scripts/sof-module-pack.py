@@ -0,0 +1,202 @@
+#!/usr/bin/env python3
+
+# Pack a component module ELF into the image format of uapi/user/module.h.
+#
+# The module must be linked at address 0 keeping its relocations and with
+# calls into the firmware left unresolved, e.g.
+#   xt-xcc -mlongcalls -c ... -o mod.o
+#   xt-ld -q --no-relax -Ttext=0 --unresolved-symbols=ignore-all \
+#	-e module_init mod.o -o mod.elf
+# Calls and branches inside the module are PC relative and need no fixup,
+# every absolute 32 bit word becomes a BASE or IMPORT relocation.
+
+from __future__ import print_function
+import argparse
+import os
+import re
+import struct
+import sys
+
+MODULE_MAGIC = 0x4d464f53
+MODULE_NAME_SIZE = 32
+RELOC_BASE = 0
+RELOC_IMPORT = 1
+
+HDR = struct.Struct("<12I")
+RELOC = struct.Struct("<III")
+
+ET_EXEC = 2
+SHT_PROGBITS = 1
+SHT_SYMTAB = 2
+SHT_RELA = 4
+SHT_NOBITS = 8
+SHF_ALLOC = 2
+SHN_UNDEF = 0
+R_XTENSA_NONE = 0
+R_XTENSA_32 = 1
+R_XTENSA_ASM_EXPAND = 11
+R_XTENSA_SLOT0_OP = 20
+
+def stderr_print(*args, **kwargs):
+	print(*args, file=sys.stderr, **kwargs)
+
+class Section(object):
+	def __init__(self, data, fields):
+		(self.name_off, self.type, self.flags, self.addr, self.offset,
+			self.size, self.link, self.info, _, self.entsize) = fields
+		self.data = data[self.offset : self.offset + self.size]
+
+def read_sections(data):
+	if data[:4] != b"\x7fELF" or data[4] != 1 or data[5] != 1:
+		raise ValueError("not a 32 bit little endian ELF")
+
+	e_type, = struct.unpack_from("<H", data, 16)
+	shoff, = struct.unpack_from("<I", data, 32)
+	shentsize, shnum, shstrndx = struct.unpack_from("<HHH", data, 46)
+
+	sections = [Section(data, struct.unpack_from("<10I", data,
+		shoff + i * shentsize)) for i in range(shnum)]
+	names = sections[shstrndx].data
+	for sec in sections:
+		sec.name = names[sec.name_off : names.index(b"\0",
+			sec.name_off)].decode()
+	return e_type, sections
+
+def read_symbols(sections):
+	symtab = [s for s in sections if s.type == SHT_SYMTAB][0]
+	strtab = sections[symtab.link].data
+	symbols = []
+	for off in range(0, len(symtab.data), 16):
+		name, value, _, _, _, shndx = struct.unpack_from("<IIIBBH",
+			symtab.data, off)
+		symbols.append((strtab[name : strtab.index(b"\0", name)]
+			.decode(), value, shndx))
+	return symbols
+
+def layout(sections):
+	alloc = [s for s in sections if s.flags & SHF_ALLOC and s.size]
+	image_end = max([s.addr + s.size for s in alloc
+		if s.type != SHT_NOBITS] or [0])
+	image_end = (image_end + 3) & ~3
+	image = bytearray(image_end)
+
+	bss_end = image_end
+	for sec in alloc:
+		if sec.type == SHT_NOBITS:
+			if sec.addr < image_end:
+				raise ValueError("{:s} overlaps the image"
+					.format(sec.name))
+			bss_end = max(bss_end, sec.addr + sec.size)
+		else:
+			image[sec.addr : sec.addr + sec.size] = sec.data
+	return image, bss_end - image_end
+
+def relocations(e_type, sections, symbols, image):
+	relocs = []
+	imports = []
+	for sec in sections:
+		if sec.type != SHT_RELA or \
+		   not sections[sec.info].flags & SHF_ALLOC:
+			continue
+		base = 0 if e_type == ET_EXEC else sections[sec.info].addr
+		for off in range(0, len(sec.data), 12):
+			r_offset, r_info, addend = struct.unpack_from("<IIi",
+				sec.data, off)
+			rtype = r_info & 0xff
+			if rtype in (R_XTENSA_NONE, R_XTENSA_ASM_EXPAND) or \
+			   rtype >= R_XTENSA_SLOT0_OP:
+				continue	# PC relative, already resolved
+			if rtype != R_XTENSA_32:
+				raise ValueError("unsupported relocation {:d}"
+					.format(rtype))
+
+			offset = base + r_offset
+			if offset + 4 > len(image) or offset % 4:
+				raise ValueError("relocation outside image 0x{:x}"
+					.format(offset))
+
+			name, _, shndx = symbols[r_info >> 8]
+			if shndx != SHN_UNDEF:
+				relocs.append((offset, RELOC_BASE, 0))
+				continue
+
+			if addend:
+				raise ValueError("import {:s} with addend"
+					.format(name))
+			if len(name) >= MODULE_NAME_SIZE:
+				raise ValueError("import {:s} name too long"
+					.format(name))
+			if name not in imports:
+				imports.append(name)
+			relocs.append((offset, RELOC_IMPORT,
+				imports.index(name)))
+	return relocs, imports
+
+def default_abi():
+	path = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+		"..", "src", "include", "uapi", "abi.h")
+	with open(path) as f:
+		text = f.read()
+	ver = [int(re.search(r"#define SOF_ABI_{:s} (\d+)".format(v), text)
+		.group(1)) for v in ("MAJOR", "MINOR", "PATCH")]
+	return (ver[0] << 24) | (ver[1] << 12) | ver[2]
+
+def pack(args):
+	with open(args.infile, "rb") as f:
+		data = f.read()
+
+	e_type, sections = read_sections(data)
+	symbols = read_symbols(sections)
+	image, bss_size = layout(sections)
+	relocs, imports = relocations(e_type, sections, symbols, image)
+
+	init = [value for name, value, shndx in symbols
+		if name == args.init and shndx != SHN_UNDEF]
+	if not init or init[0] >= len(image):
+		raise ValueError("no init function {:s}".format(args.init))
+
+	abi = args.abi if args.abi is not None else default_abi()
+	size = HDR.size + len(image) + len(relocs) * RELOC.size + \
+		len(imports) * MODULE_NAME_SIZE
+
+	out = bytearray(HDR.pack(MODULE_MAGIC, abi, args.type, size,
+		len(image), bss_size, init[0], len(relocs), len(imports),
+		0, 0, 0))
+	out += image
+	for reloc in relocs:
+		out += RELOC.pack(*reloc)
+	for name in imports:
+		out += name.encode().ljust(MODULE_NAME_SIZE, b"\0")
+
+	with open(args.outfile, "wb") as f:
+		f.write(out)
+
+	print("{:s}: type {:d}, {:d} bytes, image {:d} bss {:d}, {:d} "
+		"relocations, imports: {:s}".format(args.outfile, args.type,
+		size, len(image), bss_size, len(relocs),
+		" ".join(imports) or "none"))
+
+def parse_params():
+	parser = argparse.ArgumentParser(
+		description="Pack a component module ELF into a SOF module"
+			+" image loaded by the firmware on first use."
+	)
+	parser.add_argument('-i', '--infile', type=str, required=True,
+		help='module ELF linked at 0 with its relocations')
+	parser.add_argument('-o', '--outfile', type=str, required=True,
+		help='module image to write')
+	parser.add_argument('-t', '--type', type=int, required=True,
+		help='SOF_COMP_ component type the module registers')
+	parser.add_argument('-e', '--init', type=str, default="module_init",
+		help='init function registering the driver')
+	parser.add_argument('-a', '--abi', type=lambda x: int(x, 0),
+		help='ABI version, taken from uapi/abi.h if not given')
+	return parser.parse_args()
+
+if __name__ == "__main__":
+	args = parse_params()
+	try:
+		pack(args)
+	except (ValueError, IndexError) as e:
+		stderr_print("error: {:s}".format(str(e)))
+		sys.exit(1)
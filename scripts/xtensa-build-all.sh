@@ -6,6 +6,7 @@ BUILD_LOCAL=1
 BUILD_DEBUG=no
 BUILD_JOBS=1
 BUILD_JOBS_NEXT=0
+BUILD_PROFILE=0
 
 PATH=$pwd/local/bin:$PATH
 
@@ -18,6 +19,7 @@ then
 	echo "       [-r] Build rom (gcc only)"
 	echo "       [-a] Build all platforms"
 	echo "       [-d] Enable debug build"
+	echo "       [-p] Profile kernel benchmarks on the ISS (xt-xcc only)"
 	echo "       [-j [n]] Set number of make build jobs. Infinite jobs with no arg."
 	echo "       Supported platforms ${SUPPORTED_PLATFORMS[@]}"
 else
@@ -39,6 +41,10 @@ else
 			then
 			BUILD_DEBUG=yes
 
+		elif [[ "$args" == "-p" ]]
+			then
+			BUILD_PROFILE=1
+
 		elif [[ "$args" == "-j" ]]
 			then
 			BUILD_JOBS_NEXT=1
@@ -257,7 +263,37 @@ do
 	make clean
 	make -j ${BUILD_JOBS}
 	make bin
+
+	# ISS profile of the kernel benchmarks, cmocka must be in the root
+	if [[ "x$BUILD_PROFILE" == "x1" ]]
+	then
+		if [ "$XCC" == "xt-xcc" ]
+		then
+			./configure --with-arch=$ARCH --with-platform=$PLATFORM \
+				--with-root-dir=$ROOT --host=$HOST \
+				CC=$XCC OBJCOPY=$XTOBJCOPY OBJDUMP=$XTOBJDUMP \
+				--with-dsp-core=$XTENSA_CORE \
+				--with-cmocka-prefix=${CMOCKA_PREFIX:-$ROOT}
+			make -C test/cmocka profile
+			mkdir -p profile
+			cp test/cmocka/kernel_bench.profile profile/$j.profile
+			# report of the cycles, checked against the baseline
+			tools/perf/sof-perf-report.py -p $j -o profile/$j.csv \
+				-b tools/perf/baseline/$j.csv \
+				test/cmocka/kernel_bench.log \
+				profile/$j.profile ||
+				echo "Warning: $j is slower than its baseline"
+		else
+			echo "Warning: ISS profile of $j needs xt-xcc, skipped"
+		fi
+	fi
 done
 
+# list the ISS profiles
+if [[ "x$BUILD_PROFILE" == "x1" ]] && [ -d profile ]
+then
+	ls -l profile
+fi
+
 # list all the images
 ls -l src/arch/xtensa/*.ri
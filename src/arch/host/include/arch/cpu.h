@@ -32,22 +32,22 @@
 #ifndef __INCLUDE_ARCH_CPU__
 #define __INCLUDE_ARCH_CPU__
 
-static inline void arch_cpu_enable_core(int id)
-{
-}
+/* emulated core of the calling thread, see src/host/smp.c */
+extern __thread int host_core_id;
 
-static inline void arch_cpu_disable_core(int id)
-{
-}
+void arch_cpu_enable_core(int id);
 
-static inline int arch_cpu_is_core_enabled(int id)
-{
-	return 0;
-}
+void arch_cpu_disable_core(int id);
+
+void arch_cpu_standby_core(int id);
+
+int arch_cpu_is_core_enabled(int id);
+
+int arch_cpu_is_core_standby(int id);
 
 static inline int arch_cpu_get_id(void)
 {
-	return 0;
+	return host_core_id;
 }
 
 static inline void cpu_write_threadptr(int threadptr)
@@ -35,12 +35,59 @@
 #include <stdint.h>
 #include <errno.h>
 #include <pthread.h>
+#include <arch/cpu.h>
 
+/*
+ * Emulated cores are threads, so locks are real. The owner is the emulated
+ * core + 1, a core taking a lock it holds nests, as the synchronous host
+ * scheduler may run a task from inside a locked section.
+ */
 typedef struct {
+	volatile int32_t owner;
+	uint32_t depth;
 } spinlock_t;
 
-static inline void arch_spinlock_init(spinlock_t *lock) {}
-static inline void arch_spin_lock(spinlock_t *lock) {}
-static inline void arch_spin_unlock(spinlock_t *lock) {}
+/* lock acquisitions that found the lock taken by another core */
+extern volatile uint64_t host_lock_contended;
+
+static inline void arch_spinlock_init(spinlock_t *lock)
+{
+	lock->owner = 0;
+	lock->depth = 0;
+}
+
+static inline int arch_try_lock(spinlock_t *lock)
+{
+	int32_t core = arch_cpu_get_id() + 1;
+	int32_t free = 0;
+
+	if (lock->owner == core) {
+		lock->depth++;
+		return 1;
+	}
+
+	if (!__atomic_compare_exchange_n(&lock->owner, &free, core, 0,
+					 __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+		return 0;
+
+	lock->depth = 1;
+	return 1;
+}
+
+static inline void arch_spin_lock(spinlock_t *lock)
+{
+	if (arch_try_lock(lock))
+		return;
+
+	__atomic_add_fetch(&host_lock_contended, 1, __ATOMIC_RELAXED);
+	while (!arch_try_lock(lock))
+		;
+}
+
+static inline void arch_spin_unlock(spinlock_t *lock)
+{
+	if (--lock->depth == 0)
+		__atomic_store_n(&lock->owner, 0, __ATOMIC_RELEASE);
+}
 
 #endif
@@ -28,7 +28,13 @@
  * Author: Liam Girdwood <liam.r.girdwood@linux.intel.com>
  */
 
+#include <sched.h>
+
 static inline void arch_wait_for_interrupt(int level) {}
 
-static inline void idelay(int n) {}
+/* emulated cores are threads, let the one being waited on run */
+static inline void idelay(int n)
+{
+	sched_yield();
+}
 
@@ -32,6 +32,7 @@
 #include <arch/wait.h>
 #include <sof/trace.h>
 #include <sof/io.h>
+#include <sof/math/numbers.h>
 #include <uapi/user/manifest.h>
 #include <platform/platform.h>
 #include <platform/memory.h>
@@ -75,6 +76,71 @@ static inline void bbzero(void *dest, size_t bytes)
 	dcache_writeback_region(dest, bytes);
 }
 
+#if defined(CONFIG_FW_COMPRESS)
+/* length of an LZ4 literal run or match, ext bytes follow a nibble of 15 */
+static inline uint32_t lz4_len(const uint8_t **src, const uint8_t *end,
+			       uint32_t len)
+{
+	uint8_t b;
+
+	if (len != 15)
+		return len;
+
+	do {
+		b = *(*src)++;
+		len += b;
+	} while (b == 255 && *src < end);
+
+	return len;
+}
+
+/*
+ * Decompress an LZ4 block to dest. Anything left over by a short block is
+ * zeroed, so the segment is always fully written.
+ */
+static void blz4_decompress(void *dest, size_t bytes,
+			    const struct sof_man_lz4_hdr *lz4)
+{
+	const uint8_t *src = (const uint8_t *)(lz4 + 1);
+	const uint8_t *send = src + lz4->size;
+	uint8_t *d = dest;
+	uint8_t *dend = d + bytes;
+	const uint8_t *match;
+	uint32_t token;
+	uint32_t len;
+
+	while (src < send && d < dend) {
+		token = *src++;
+
+		/* literals */
+		len = lz4_len(&src, send, token >> 4);
+		len = MIN(len, MIN(dend - d, send - src));
+		while (len--)
+			*d++ = *src++;
+
+		/* last sequence has no match */
+		if (send - src < 2)
+			break;
+
+		match = d - (src[0] | (src[1] << 8));
+		src += 2;
+		if (match < (uint8_t *)dest || match == d)
+			break;
+
+		/* match may overlap the output, so copy forwards */
+		len = lz4_len(&src, send, token & 0xf) + 4;
+		len = MIN(len, dend - d);
+		while (len--)
+			*d++ = *match++;
+	}
+
+	while (d < dend)
+		*d++ = 0;
+
+	dcache_writeback_region(dest, bytes);
+}
+#endif
+
 static void parse_module(struct sof_man_fw_header *hdr,
 	struct sof_man_module *mod)
 {
@@ -91,6 +157,16 @@ static void parse_module(struct sof_man_fw_header *hdr,
 			bias = (mod->segment[i].file_offset -
 				SOF_MAN_ELF_TEXT_OFFSET);
 
+#if defined(CONFIG_FW_COMPRESS)
+			/* decompress from IMR to SRAM */
+			if (mod->segment[i].flags.r.compressed) {
+				blz4_decompress((void *)mod->segment[i].v_base_addr,
+					mod->segment[i].flags.r.length *
+					HOST_PAGE_SIZE,
+					(void *)((int)hdr + bias));
+				break;
+			}
+#endif
 			/* copy from IMR to SRAM */
 			bmemcpy((void *)mod->segment[i].v_base_addr,
 				(void *)((int)hdr + bias),
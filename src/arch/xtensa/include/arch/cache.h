@@ -38,6 +38,12 @@
 
 #define DCACHE_LINE_SIZE	XCHAL_DCACHE_LINESIZE
 
+#if XCHAL_DCACHE_SIZE > 0
+#define DCACHE_WAYS		XCHAL_DCACHE_WAYS
+#define DCACHE_SETS		(XCHAL_DCACHE_SIZE / \
+				 (XCHAL_DCACHE_LINESIZE * XCHAL_DCACHE_WAYS))
+#endif
+
 static inline void dcache_writeback_region(void *addr, size_t size)
 {
 #if XCHAL_DCACHE_SIZE > 0
@@ -134,6 +134,34 @@ static inline void register_exceptions(void)
 	/* Reserved				40..63 */
 }
 
+#if defined(CONFIG_HOT_TEXT_LOCK) && XCHAL_ICACHE_LINE_LOCKABLE
+/** \brief Hot path code boundaries, set by the linker script. */
+extern char _hot_text_start[];
+extern char _hot_text_end[];
+
+/** \brief Locked lines leave one way of each set to the rest of the code. */
+#define HOT_TEXT_LOCK_MAX \
+	(XCHAL_ICACHE_SIZE - XCHAL_ICACHE_SIZE / XCHAL_ICACHE_WAYS)
+
+/**
+ * \brief Locks hot path code into the instruction cache of this core.
+ *
+ * The hot code is contiguous and line aligned, so locking at most
+ * HOT_TEXT_LOCK_MAX bytes of it never fills all ways of a set.
+ */
+static inline void lock_hot_text(void)
+{
+	uint32_t size = _hot_text_end - _hot_text_start;
+
+	if (size > HOT_TEXT_LOCK_MAX)
+		size = HOT_TEXT_LOCK_MAX;
+
+	xthal_icache_region_lock(_hot_text_start, size);
+}
+#else
+static inline void lock_hot_text(void) { }
+#endif
+
 /**
  * \brief Called from assembler context with no return or parameters.
  */
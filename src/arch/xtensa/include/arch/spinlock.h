@@ -37,9 +37,13 @@
 
 typedef struct {
 	volatile uint32_t lock;
-#if DEBUG_LOCKS
+#if DEBUG_LOCKS || defined CONFIG_LOCK_PROFILE
 	uint32_t user;
 #endif
+#ifdef CONFIG_LOCK_PROFILE
+	uint32_t prof_spins;	/* failed tries by the current holder */
+	uint32_t prof_start;	/* time the current holder took the lock */
+#endif
 } spinlock_t;
 
 static inline void arch_spinlock_init(spinlock_t *lock)
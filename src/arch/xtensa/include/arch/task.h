@@ -41,6 +41,7 @@
 #include <sof/schedule.h>
 #include <sof/interrupt.h>
 #include <platform/platform.h>
+#include <platform/timer.h>
 #include <sof/debug.h>
 #include <sof/alloc.h>
 
@@ -70,15 +71,38 @@ struct irq_task **task_irq_med_get(void);
 struct irq_task **task_irq_high_get(void);
 
 /**
- * \brief Retrieves task IRQ level.
- * \param[in,out] task Task data.
+ * \brief Retrieves priority the task runs at this time.
+ *
+ * With CONFIG_TASK_PROMOTE a task is moved to the high IRQ level if its
+ * worst queueing delay plus run time would take it past its deadline, so
+ * it isn't held up behind lower priority tasks such as IPC.
+ *
+ * \param[in,out] task Task data, task->start is its release time.
+ * \return Task priority.
+ */
+static inline int task_run_priority(struct task *task)
+{
+#ifdef CONFIG_TASK_PROMOTE
+	if (task->priority > TASK_PRI_HIGH &&
+	    task->start + task->stats.max_qdelay + task->max_rtime >
+	    task->deadline) {
+		task->stats.promoted++;
+		return TASK_PRI_HIGH;
+	}
+#endif
+	return task->priority;
+}
+
+/**
+ * \brief Retrieves IRQ level for a priority.
+ * \param[in] priority Task priority.
  * \return IRQ level.
  */
-static inline uint32_t task_get_irq(struct task *task)
+static inline uint32_t task_get_irq(int priority)
 {
 	uint32_t irq;
 
-	switch (task->priority) {
+	switch (priority) {
 	case TASK_PRI_MED + 1 ... TASK_PRI_LOW:
 		irq = PLATFORM_IRQ_TASK_LOW;
 		break;
@@ -97,14 +121,15 @@ static inline uint32_t task_get_irq(struct task *task)
 /**
  * \brief Adds task to the list per IRQ level.
  * \param[in,out] task Task data.
+ * \param[in] priority Priority the task runs at.
  */
-static inline int task_set_data(struct task *task)
+static inline int task_set_data(struct task *task, int priority)
 {
 	struct list_item *dst = NULL;
 	struct irq_task *irq_task;
 	uint32_t flags;
 
-	switch (task->priority) {
+	switch (priority) {
 #ifdef CONFIG_TASK_HAVE_PRIORITY_MEDIUM
 	case TASK_PRI_MED + 1 ... TASK_PRI_LOW:
 		irq_task = *task_irq_low_get();
@@ -126,7 +151,7 @@ static inline int task_set_data(struct task *task)
 	default:
 		trace_error(TRACE_CLASS_IRQ,
 			    "task_set_data() error: task priority %d",
-			    task->priority);
+			    priority);
 		return -EINVAL;
 	}
 
@@ -148,6 +173,8 @@ static void _irq_task(void *arg)
 	struct list_item *tlist;
 	struct list_item *clist;
 	struct task *task;
+	uint64_t start;
+	uint64_t rtime;
 	uint32_t flags;
 	int run_task = 0;
 
@@ -170,9 +197,21 @@ static void _irq_task(void *arg)
 		/* run task without holding task lock */
 		spin_unlock_irq(&irq_task->lock, flags);
 
-		if (run_task)
+		if (run_task) {
+			start = platform_timer_get(platform_timer);
+
+			/* time queued behind other work at this level */
+			if (start - task->start > task->stats.max_qdelay)
+				task->stats.max_qdelay = start - task->start;
+
 			task->func(task->data);
 
+			/* track worst case runtime for deadline calc */
+			rtime = platform_timer_get(platform_timer) - start;
+			if (rtime > task->max_rtime)
+				task->max_rtime = rtime;
+		}
+
 		spin_lock_irq(&irq_task->lock, flags);
 		schedule_task_complete(task);
 	}
@@ -186,15 +225,16 @@ static void _irq_task(void *arg)
  */
 static inline int arch_run_task(struct task *task)
 {
+	int priority = task_run_priority(task);
 	uint32_t irq;
 	int ret;
 
-	ret = task_set_data(task);
+	ret = task_set_data(task, priority);
 
 	if (ret < 0)
 		return ret;
 
-	irq = task_get_irq(task);
+	irq = task_get_irq(priority);
 	interrupt_set(irq);
 
 	return 0;
@@ -80,6 +80,15 @@ static inline void arch_timer_disable(struct timer *timer)
 
 uint64_t arch_timer_get_system(struct timer *timer);
 
+/* free running core cycle counter, wraps and stops in clock gated WAITI */
+static inline uint32_t arch_timer_get_cycles(void)
+{
+	uint32_t ccount;
+
+	__asm__ __volatile__ ("rsr %0, CCOUNT" : "=a" (ccount));
+	return ccount;
+}
+
 int arch_timer_set(struct timer *timer, uint64_t ticks);
 
 static inline void arch_timer_clear(struct timer *timer)
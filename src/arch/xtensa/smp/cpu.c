@@ -50,26 +50,42 @@
 #define tracev_cpu(__e) tracev_event(TRACE_CLASS_CPU, __e)
 
 static uint32_t active_cores_mask = 0x1;
+
+/* cores booted and idle in waiti, but not available to pipelines */
+static uint32_t standby_cores_mask;
+
 static spinlock_t lock = { 0 };
 
-void arch_cpu_enable_core(int id)
+/* boots a powered off core, called with lock held */
+static void cpu_power_up_core(int id)
 {
 	struct idc_msg power_up = {
 		IDC_MSG_POWER_UP, IDC_MSG_POWER_UP_EXT, id };
+
+	/* allocate resources for core */
+	alloc_core_context(id);
+
+	/* enable IDC interrupt for the the slave core */
+	idc_enable_interrupts(id, arch_cpu_get_id());
+
+	/* send IDC power up message */
+	arch_idc_send_msg(&power_up, IDC_NON_BLOCKING);
+}
+
+void arch_cpu_enable_core(int id)
+{
 	uint32_t flags;
 
 	spin_lock_irq(&lock, flags);
 
 	if (!arch_cpu_is_core_enabled(id)) {
-		/* allocate resources for core */
-		alloc_core_context(id);
-
-		/* enable IDC interrupt for the the slave core */
-		idc_enable_interrupts(id, arch_cpu_get_id());
-
-		/* send IDC power up message */
-		arch_idc_send_msg(&power_up, IDC_NON_BLOCKING);
+		/* a core in standby keeps its scheduler, work queue and
+		 * heap, so it only needs to be made available again
+		 */
+		if (!arch_cpu_is_core_standby(id))
+			cpu_power_up_core(id);
 
+		standby_cores_mask &= ~(1 << id);
 		active_cores_mask |= (1 << id);
 	}
 
@@ -84,10 +100,29 @@ void arch_cpu_disable_core(int id)
 
 	spin_lock_irq(&lock, flags);
 
-	if (arch_cpu_is_core_enabled(id)) {
+	if (arch_cpu_is_core_enabled(id) || arch_cpu_is_core_standby(id)) {
 		arch_idc_send_msg(&power_down, IDC_NON_BLOCKING);
 
-		active_cores_mask ^= (1 << id);
+		active_cores_mask &= ~(1 << id);
+		standby_cores_mask &= ~(1 << id);
+	}
+
+	spin_unlock_irq(&lock, flags);
+}
+
+void arch_cpu_standby_core(int id)
+{
+	uint32_t flags;
+
+	spin_lock_irq(&lock, flags);
+
+	if (!arch_cpu_is_core_standby(id)) {
+		/* boot a powered off core so the next enable is warm */
+		if (!arch_cpu_is_core_enabled(id))
+			cpu_power_up_core(id);
+
+		active_cores_mask &= ~(1 << id);
+		standby_cores_mask |= (1 << id);
 	}
 
 	spin_unlock_irq(&lock, flags);
@@ -98,6 +133,11 @@ int arch_cpu_is_core_enabled(int id)
 	return active_cores_mask & (1 << id);
 }
 
+int arch_cpu_is_core_standby(int id)
+{
+	return standby_cores_mask & (1 << id);
+}
+
 void cpu_power_down_core(void)
 {
 	arch_interrupt_global_disable();
@@ -46,6 +46,7 @@
 #include <sof/ipc.h>
 #include <sof/lock.h>
 #include <sof/notifier.h>
+#include <sof/work.h>
 
 extern struct ipc *_ipc;
 extern void cpu_power_down_core(void);
@@ -73,6 +74,53 @@ static inline void idc_enable_interrupts(int target_core, int source_core)
 	platform_interrupt_unmask(PLATFORM_IDC_INTERRUPT(target_core), 0);
 }
 
+/**
+ * \brief Starts transfer of the oldest queued async message.
+ * \param[in,out] idc Pointer to IDC data.
+ * \param[in] target Target core id.
+ */
+static inline void idc_async_start(struct idc *idc, int target)
+{
+	struct idc_ring *ring = &idc->ring[target];
+	struct idc_msg *msg = &ring->msg[ring->head].msg;
+	int core = arch_cpu_get_id();
+
+	idc_write(IPC_IDCIETC(target), core, msg->extension);
+	idc_write(IPC_IDCITC(target), core, msg->header | IPC_IDCITC_BUSY);
+}
+
+/**
+ * \brief Completes the async message in flight to target core.
+ * \param[in,out] idc Pointer to IDC data.
+ * \param[in] target Target core id.
+ */
+static inline void idc_async_done(struct idc *idc, int target)
+{
+	struct idc_ring *ring = &idc->ring[target];
+	struct idc_async done;
+
+	spin_lock(&idc->lock);
+
+	/* DONE of a blocking message */
+	if (!ring->count) {
+		spin_unlock(&idc->lock);
+		return;
+	}
+
+	done = ring->msg[ring->head];
+	ring->head = (ring->head + 1) & (IDC_ASYNC_RING_SIZE - 1);
+	ring->count--;
+
+	if (ring->count)
+		idc_async_start(idc, target);
+
+	spin_unlock(&idc->lock);
+
+	/* callback may queue more messages */
+	if (done.cb)
+		done.cb(done.cb_data, _ipc->shared_ctx->idc_ret[target]);
+}
+
 /**
  * \brief IDC interrupt handler.
  * \param[in,out] arg Pointer to IDC data.
@@ -120,7 +168,7 @@ static void idc_irq_handler(void *arg)
 			idc_write(IPC_IDCIETC(i), core,
 				  idcietc | IPC_IDCIETC_DONE);
 
-			break;
+			idc_async_done(idc, i);
 		}
 	}
 }
@@ -144,6 +192,13 @@ static inline int arch_idc_send_msg(struct idc_msg *msg, uint32_t mode)
 
 	spin_lock_irq(&idc->lock, flags);
 
+	/* target register is owned by the async queue until it drains */
+	if (idc->ring[msg->core].count) {
+		spin_unlock_irq(&idc->lock, flags);
+		trace_idc_error("arch_idc_send_msg() error: async busy");
+		return -EBUSY;
+	}
+
 	idc_write(IPC_IDCIETC(msg->core), core, msg->extension);
 	idc_write(IPC_IDCITC(msg->core), core, msg->header | IPC_IDCITC_BUSY);
 
@@ -166,6 +221,59 @@ static inline int arch_idc_send_msg(struct idc_msg *msg, uint32_t mode)
 	return ret;
 }
 
+/**
+ * \brief Queues IDC message and returns without waiting.
+ *
+ * Messages to the same core are sent in order, messages to different cores
+ * are in flight at the same time. Callback runs from the IDC interrupt once
+ * the target core has executed the message. Only the master core receives
+ * DONE interrupts, so only it can send async messages.
+ *
+ * \param[in] msg Pointer to IDC message, copied.
+ * \param[in] cb Completion callback, may be NULL.
+ * \param[in] cb_data Callback data.
+ * \return Error code.
+ */
+static inline int arch_idc_send_msg_async(struct idc_msg *msg,
+					  void (*cb)(void *data, int ret),
+					  void *cb_data)
+{
+	struct idc *idc = *idc_get();
+	struct idc_ring *ring;
+	struct idc_async *entry;
+	uint32_t flags;
+	int ret = 0;
+
+	if (arch_cpu_get_id() != PLATFORM_MASTER_CORE_ID ||
+	    msg->core == PLATFORM_MASTER_CORE_ID ||
+	    msg->core >= PLATFORM_CORE_COUNT)
+		return -EINVAL;
+
+	ring = &idc->ring[msg->core];
+
+	spin_lock_irq(&idc->lock, flags);
+
+	if (ring->count == IDC_ASYNC_RING_SIZE) {
+		ret = -EBUSY;
+		goto out;
+	}
+
+	entry = &ring->msg[(ring->head + ring->count) &
+			   (IDC_ASYNC_RING_SIZE - 1)];
+	entry->msg = *msg;
+	entry->cb = cb;
+	entry->cb_data = cb_data;
+
+	/* start now unless an earlier message is still in flight */
+	if (!ring->count++)
+		idc_async_start(idc, msg->core);
+
+out:
+	spin_unlock_irq(&idc->lock, flags);
+
+	return ret;
+}
+
 /**
  * \brief Executes IDC pipeline trigger message.
  * \param[in] cmd Trigger command.
@@ -205,6 +313,34 @@ static inline int idc_pipeline_trigger(uint32_t cmd)
 	return ret;
 }
 
+/**
+ * \brief Executes IDC group trigger message.
+ *
+ * Result is posted to the shared group context, the master core polls it
+ * instead of waiting for IDC completion.
+ */
+static inline void idc_pipeline_group_trigger(void)
+{
+	struct ipc_group_trigger *group = &_ipc->shared_ctx->group;
+	int core = arch_cpu_get_id();
+
+	group->ret[core] = ipc_pipeline_group_trigger(_ipc);
+	group->done[core] = 1;
+}
+
+/**
+ * \brief Executes IDC pipeline branch message.
+ *
+ * Result is posted to the shared branch context, the master core polls it
+ * while walking the rest of the graph.
+ *
+ * \return Error code.
+ */
+static inline int idc_pipeline_branch(void)
+{
+	return pipeline_branch_run(&_ipc->shared_ctx->branch[arch_cpu_get_id()]);
+}
+
 /**
  * \brief Executes IDC component command message.
  * \param[in] cmd Component command.
@@ -242,27 +378,35 @@ static inline int idc_component_command(uint32_t cmd)
 /**
  * \brief Executes IDC message based on type.
  * \param[in,out] msg Pointer to IDC message.
+ * \return Error code.
  */
-static inline void idc_cmd(struct idc_msg *msg)
+static inline int idc_cmd(struct idc_msg *msg)
 {
 	uint32_t type = iTS(msg->header);
 
 	switch (type) {
 	case iTS(IDC_MSG_POWER_DOWN):
 		cpu_power_down_core();
-		break;
+		return 0;
 	case iTS(IDC_MSG_PPL_TRIGGER):
-		idc_pipeline_trigger(msg->extension);
-		break;
+		return idc_pipeline_trigger(msg->extension);
 	case iTS(IDC_MSG_COMP_CMD):
-		idc_component_command(msg->extension);
-		break;
+		return idc_component_command(msg->extension);
 	case iTS(IDC_MSG_NOTIFY):
 		notifier_notify();
-		break;
+		return 0;
+	case iTS(IDC_MSG_PPL_GROUP):
+		idc_pipeline_group_trigger();
+		return 0;
+	case iTS(IDC_MSG_WORK):
+		work_inbox_drain();
+		return 0;
+	case iTS(IDC_MSG_PPL_BRANCH):
+		return idc_pipeline_branch();
 	default:
 		trace_idc_error("idc_cmd() error: invalid msg->header = %u",
 				msg->header);
+		return -EINVAL;
 	}
 }
 
@@ -278,7 +422,8 @@ static inline void idc_do_cmd(void *data)
 
 	trace_idc("idc_do_cmd()");
 
-	idc_cmd(&idc->received_msg);
+	/* result is read by the initiator once it sees DONE */
+	_ipc->shared_ctx->idc_ret[core] = idc_cmd(&idc->received_msg);
 
 	/* clear BUSY bit */
 	idc_write(IPC_IDCTFC(initiator), core,
@@ -45,6 +45,7 @@
 #include <sof/lock.h>
 #include <sof/notifier.h>
 #include <sof/task.h>
+#include <sof/timebase.h>
 #include <platform/idc.h>
 #include <stdint.h>
 
@@ -104,6 +105,7 @@ int arch_init(struct sof *sof)
 	initialize_pointers_per_core();
 	register_exceptions();
 	arch_assign_tasks();
+	lock_hot_text();
 	return 0;
 }
 
@@ -123,6 +125,8 @@ int slave_core_init(struct sof *sof)
 	trace_point(TRACE_BOOT_SYS_SCHED);
 	scheduler_init(sof);
 
+	timebase_init();
+
 	platform_interrupt_init();
 
 	trace_point(TRACE_BOOT_SYS_WORK);
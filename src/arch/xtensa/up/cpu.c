@@ -41,4 +41,8 @@ void arch_cpu_enable_core(int id) { }
 
 void arch_cpu_disable_core(int id) { }
 
+void arch_cpu_standby_core(int id) { }
+
 int arch_cpu_is_core_enabled(int id) { return 1; }
+
+int arch_cpu_is_core_standby(int id) { return 0; }
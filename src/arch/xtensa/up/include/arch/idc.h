@@ -37,6 +37,8 @@
 #ifndef __ARCH_IDC_H__
 #define __ARCH_IDC_H__
 
+#include <errno.h>
+
 struct idc_msg;
 
 /**
@@ -48,6 +50,17 @@ struct idc_msg;
 static inline int arch_idc_send_msg(struct idc_msg *msg,
 				    uint32_t mode) { return 0; }
 
+/**
+ * \brief Queues IDC message and returns without waiting.
+ * \param[in] msg Pointer to IDC message.
+ * \param[in] cb Completion callback.
+ * \param[in] cb_data Callback data.
+ * \return Error code, there is no other core to send to.
+ */
+static inline int arch_idc_send_msg_async(struct idc_msg *msg,
+					  void (*cb)(void *data, int ret),
+					  void *cb_data) { return -ENODEV; }
+
 /**
  * \brief Initializes IDC data and registers for interrupt.
  */
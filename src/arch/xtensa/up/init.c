@@ -61,6 +61,7 @@ int arch_init(struct sof *sof)
 {
 	register_exceptions();
 	arch_assign_tasks();
+	lock_hot_text();
 	return 0;
 }
 
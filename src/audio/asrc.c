@@ -0,0 +1,579 @@
+/*
+ * Copyright (c) 2018, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * \file audio/asrc.c
+ * \brief Asynchronous sample rate converter
+ *
+ * Converts between the host side and DAI side stream rates with a
+ * fractional step that follows the real DAI clock. The DAI rate is measured
+ * against the DSP wallclock from the DAI stream position timestamps and the
+ * step is adjusted continuously so the buffers next to the converter neither
+ * fill up nor drain when the two clock domains drift apart.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <errno.h>
+#include <sof/sof.h>
+#include <sof/stream.h>
+#include <sof/alloc.h>
+#include <sof/clk.h>
+#include <sof/ipc.h>
+#include <sof/drivers/timer.h>
+#include <sof/audio/component.h>
+#include <sof/audio/format.h>
+#include <sof/math/numbers.h>
+#include <uapi/ipc/topology.h>
+#include <platform/platform.h>
+
+#define trace_asrc(__e, ...) \
+	trace_event(TRACE_CLASS_ASRC, __e, ##__VA_ARGS__)
+#define tracev_asrc(__e, ...) \
+	tracev_event(TRACE_CLASS_ASRC, __e, ##__VA_ARGS__)
+#define trace_asrc_error(__e, ...) \
+	trace_error(TRACE_CLASS_ASRC, __e, ##__VA_ARGS__)
+
+/* step and phase are Q2.30, the largest supported ratio is 3:1 */
+#define ASRC_STEP_SHIFT		30
+#define ASRC_STEP_ONE		(1U << ASRC_STEP_SHIFT)
+#define ASRC_STEP_MAX		(3 * ASRC_STEP_ONE)
+
+/* interpolator works on Q1.27 samples to keep headroom in 64 bits */
+#define ASRC_HEADROOM		4
+
+/* history taps of the cubic interpolator */
+#define ASRC_TAPS		4
+
+/* drift estimation starts after this and ignores larger deviations */
+#define ASRC_DRIFT_MIN_MS	2000
+#define ASRC_DRIFT_MAX_PPM	2000
+
+/* measured DAI rate is Q24.8 */
+#define ASRC_RATE_SHIFT		8
+
+/* asrc component private data */
+struct comp_data {
+	uint32_t source_rate;
+	uint32_t sink_rate;
+	uint32_t step;		/**< input frames per output frame, Q2.30 */
+	uint32_t phase;		/**< position between history taps, Q2.30 */
+	uint32_t fs_dai;	/**< measured DAI rate, Q24.8 */
+	uint32_t wclk_per_ms;	/**< wallclock ticks per millisecond */
+	struct comp_dev *dai;	/**< DAI used for drift estimation */
+	int32_t hist[PLATFORM_MAX_CHANNELS][ASRC_TAPS];
+};
+
+/* Catmull-Rom interpolation between x[1] and x[2] at fractional t */
+static inline int32_t asrc_interpolate(const int32_t *x, uint32_t t)
+{
+	int64_t xm1 = x[0] >> ASRC_HEADROOM;
+	int64_t x0 = x[1] >> ASRC_HEADROOM;
+	int64_t x1 = x[2] >> ASRC_HEADROOM;
+	int64_t x2 = x[3] >> ASRC_HEADROOM;
+	int64_t c1 = (x1 - xm1) >> 1;
+	int64_t c2 = xm1 - ((5 * x0) >> 1) + 2 * x1 - (x2 >> 1);
+	int64_t c3 = ((x2 - xm1) >> 1) + ((3 * (x0 - x1)) >> 1);
+	int64_t y;
+
+	y = (c3 * t) >> ASRC_STEP_SHIFT;
+	y = ((y + c2) * t) >> ASRC_STEP_SHIFT;
+	y = ((y + c1) * t) >> ASRC_STEP_SHIFT;
+
+	return sat_int32((y + x0) << ASRC_HEADROOM);
+}
+
+static inline int32_t asrc_read(void *ptr, uint32_t frame_fmt)
+{
+	switch (frame_fmt) {
+	case SOF_IPC_FRAME_S16_LE:
+		return *(int16_t *)ptr << 16;
+	case SOF_IPC_FRAME_S24_4LE:
+		return *(int32_t *)ptr << 8;
+	default:
+		return *(int32_t *)ptr;
+	}
+}
+
+static inline void asrc_write(void *ptr, uint32_t frame_fmt, int32_t x)
+{
+	switch (frame_fmt) {
+	case SOF_IPC_FRAME_S16_LE:
+		*(int16_t *)ptr = x >> 16;
+		break;
+	case SOF_IPC_FRAME_S24_4LE:
+		*(int32_t *)ptr = x >> 8;
+		break;
+	default:
+		*(int32_t *)ptr = x;
+		break;
+	}
+}
+
+/*
+ * Convert until either max_out frames are produced or max_in frames are
+ * consumed and the next output needs more input. Returns produced frames.
+ */
+static int asrc_process(struct comp_dev *dev, struct comp_buffer *source,
+			struct comp_buffer *sink, int max_in, int max_out,
+			int *consumed)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	uint32_t frame_fmt = dev->params.frame_fmt;
+	uint32_t nch = dev->params.channels;
+	uint32_t bytes = dev->params.sample_container_bytes;
+	uint8_t *src = source->r_ptr;
+	uint8_t *snk = sink->w_ptr;
+	int32_t *h;
+	int produced = 0;
+	int in = 0;
+	int ch;
+
+	while (produced < max_out) {
+		/* shift in the input frames the next output needs */
+		while (cd->phase >= ASRC_STEP_ONE) {
+			if (in == max_in)
+				goto out;
+
+			for (ch = 0; ch < nch; ch++) {
+				h = cd->hist[ch];
+				h[0] = h[1];
+				h[1] = h[2];
+				h[2] = h[3];
+				h[3] = asrc_read(src, frame_fmt);
+				src += bytes;
+			}
+			if (src >= (uint8_t *)source->end_addr)
+				src = source->addr;
+
+			cd->phase -= ASRC_STEP_ONE;
+			in++;
+		}
+
+		for (ch = 0; ch < nch; ch++) {
+			asrc_write(snk, frame_fmt,
+				   asrc_interpolate(cd->hist[ch], cd->phase));
+			snk += bytes;
+		}
+		if (snk >= (uint8_t *)sink->end_addr)
+			snk = sink->addr;
+
+		cd->phase += cd->step;
+		produced++;
+	}
+
+out:
+	*consumed = in;
+	return produced;
+}
+
+/* input frames needed to produce frames of output from current phase */
+static uint32_t asrc_input_frames(struct comp_data *cd, uint32_t frames)
+{
+	if (!frames)
+		return 0;
+
+	return ((uint64_t)cd->step * (frames - 1) + cd->phase) >>
+		ASRC_STEP_SHIFT;
+}
+
+/* output frames produced when frames of input are consumed */
+static uint32_t asrc_output_frames(struct comp_data *cd, uint32_t frames)
+{
+	return (((uint64_t)frames << ASRC_STEP_SHIFT) + cd->step) / cd->step +
+		1;
+}
+
+static uint32_t asrc_nominal_step(struct comp_data *cd)
+{
+	return ((uint64_t)cd->source_rate << ASRC_STEP_SHIFT) / cd->sink_rate;
+}
+
+/* find the DAI that clocks this stream by walking away from the host */
+static struct comp_dev *asrc_find_dai(struct comp_dev *dev, int dir)
+{
+	struct comp_buffer *buffer;
+	struct list_item *clist;
+
+	while (dev->comp.type != SOF_COMP_DAI &&
+	       dev->comp.type != SOF_COMP_SG_DAI) {
+		clist = dir == SOF_IPC_STREAM_PLAYBACK ? &dev->bsink_list :
+			&dev->bsource_list;
+		if (list_is_empty(clist))
+			return NULL;
+
+		if (dir == SOF_IPC_STREAM_PLAYBACK) {
+			buffer = list_first_item(clist, struct comp_buffer,
+						 source_list);
+			dev = buffer->sink;
+		} else {
+			buffer = list_first_item(clist, struct comp_buffer,
+						 sink_list);
+			dev = buffer->source;
+		}
+	}
+
+	return dev;
+}
+
+/*
+ * Measure the DAI rate against the DSP wallclock and derive the step from
+ * it. The DAI position only moves once per DMA period so half a period is
+ * added to remove the bias, the remaining error shrinks with stream length.
+ */
+static void asrc_drift_update(struct comp_dev *dev)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	struct sof_ipc_stream_posn posn;
+	uint64_t frames;
+	uint64_t us;
+	int64_t nominal;
+	int64_t delta;
+	uint32_t fs;
+
+	if (!cd->dai || cd->dai->state != COMP_STATE_ACTIVE)
+		return;
+
+	platform_dai_timestamp(cd->dai, &posn);
+
+	us = posn.wallclock * 1000 / cd->wclk_per_ms;
+	if (us < ASRC_DRIFT_MIN_MS * 1000)
+		return;
+
+	frames = posn.dai_posn / comp_frame_bytes(cd->dai) +
+		(cd->dai->frames >> 1);
+	fs = ((frames << ASRC_RATE_SHIFT) * 1000000) / us;
+
+	nominal = dev->params.direction == SOF_IPC_STREAM_PLAYBACK ?
+		cd->sink_rate : cd->source_rate;
+	nominal <<= ASRC_RATE_SHIFT;
+	delta = fs > nominal ? fs - nominal : nominal - fs;
+	if (delta > nominal * ASRC_DRIFT_MAX_PPM / 1000000) {
+		tracev_asrc("asrc_drift_update() rate %u out of range", fs);
+		return;
+	}
+
+	cd->fs_dai = fs;
+
+	/* step is input frames per output frame, DAI is sink on playback */
+	if (dev->params.direction == SOF_IPC_STREAM_PLAYBACK)
+		cd->step = ((uint64_t)cd->source_rate <<
+			    (ASRC_STEP_SHIFT + ASRC_RATE_SHIFT)) / fs;
+	else
+		cd->step = ((uint64_t)fs <<
+			    (ASRC_STEP_SHIFT - ASRC_RATE_SHIFT)) /
+			cd->sink_rate;
+
+	cd->step = MIN(cd->step, ASRC_STEP_MAX);
+}
+
+static struct comp_dev *asrc_new(struct sof_ipc_comp *comp)
+{
+	struct comp_dev *dev;
+	struct sof_ipc_comp_asrc *asrc;
+	struct sof_ipc_comp_asrc *ipc_asrc = (struct sof_ipc_comp_asrc *)comp;
+	struct comp_data *cd;
+
+	trace_asrc("asrc_new()");
+
+	if (IPC_IS_SIZE_INVALID(ipc_asrc->config)) {
+		IPC_SIZE_ERROR_TRACE(TRACE_CLASS_ASRC, ipc_asrc->config);
+		return NULL;
+	}
+
+	/* validate init data - either ASRC sink or source rate must be set */
+	if (ipc_asrc->source_rate == 0 && ipc_asrc->sink_rate == 0) {
+		trace_asrc_error("asrc_new() error: "
+				 "ASRC sink and source rate are not set");
+		return NULL;
+	}
+
+	dev = rzalloc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM,
+		      COMP_SIZE(struct sof_ipc_comp_asrc));
+	if (!dev)
+		return NULL;
+
+	asrc = (struct sof_ipc_comp_asrc *)&dev->comp;
+	memcpy(asrc, ipc_asrc, sizeof(struct sof_ipc_comp_asrc));
+
+	cd = rzalloc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM, sizeof(*cd));
+	if (!cd) {
+		rfree(dev);
+		return NULL;
+	}
+
+	comp_set_drvdata(dev, cd);
+
+	cd->wclk_per_ms = clock_ms_to_ticks(PLATFORM_DEFAULT_CLOCK, 1);
+
+	dev->state = COMP_STATE_READY;
+	return dev;
+}
+
+static void asrc_free(struct comp_dev *dev)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+
+	trace_asrc("asrc_free()");
+
+	rfree(cd);
+	rfree(dev);
+}
+
+static int asrc_params(struct comp_dev *dev)
+{
+	struct sof_ipc_stream_params *params = &dev->params;
+	struct sof_ipc_comp_asrc *asrc = COMP_GET_IPC(dev, sof_ipc_comp_asrc);
+	struct comp_data *cd = comp_get_drvdata(dev);
+
+	trace_asrc("asrc_params()");
+
+	/* one rate comes from IPC new and the other one from params */
+	if (asrc->source_rate == 0) {
+		cd->source_rate = params->rate;
+		cd->sink_rate = asrc->sink_rate;
+		params->rate = cd->sink_rate;
+	} else {
+		cd->source_rate = asrc->source_rate;
+		cd->sink_rate = params->rate;
+		params->rate = cd->source_rate;
+	}
+
+	if (!cd->source_rate || !cd->sink_rate ||
+	    cd->source_rate > 3 * cd->sink_rate) {
+		trace_asrc_error("asrc_params() error: unsupported rates "
+				 "%u -> %u", cd->source_rate, cd->sink_rate);
+		return -EINVAL;
+	}
+
+	trace_asrc("asrc_params(), source_rate = %u, sink_rate = %u",
+		   cd->source_rate, cd->sink_rate);
+
+	return 0;
+}
+
+static int asrc_cmd(struct comp_dev *dev, int cmd, void *data,
+		    int max_data_size)
+{
+	trace_asrc("asrc_cmd()");
+
+	return 0;
+}
+
+static int asrc_trigger(struct comp_dev *dev, int cmd)
+{
+	trace_asrc("asrc_trigger()");
+
+	return comp_set_state(dev, cmd);
+}
+
+/*
+ * The side facing the DAI moves a fixed period per copy, the host side
+ * takes or gives whatever the current step requires.
+ */
+static int asrc_copy(struct comp_dev *dev)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	struct comp_buffer *source;
+	struct comp_buffer *sink;
+	uint32_t avail;
+	uint32_t free;
+	int consumed = 0;
+	int produced;
+
+	tracev_asrc("asrc_copy()");
+
+	source = list_first_item(&dev->bsource_list, struct comp_buffer,
+				 sink_list);
+	sink = list_first_item(&dev->bsink_list, struct comp_buffer,
+			       source_list);
+
+	asrc_drift_update(dev);
+
+	avail = comp_buffer_get_avail_bytes(source) / dev->frame_bytes;
+	free = comp_buffer_get_free_bytes(sink) / dev->frame_bytes;
+
+	if (dev->params.direction == SOF_IPC_STREAM_PLAYBACK) {
+		if (avail < asrc_input_frames(cd, dev->frames) ||
+		    free < dev->frames) {
+			trace_asrc_error("asrc_copy() error: xrun, avail %u "
+					 "free %u", avail, free);
+			return -EIO; /* xrun */
+		}
+		produced = asrc_process(dev, source, sink, avail,
+					dev->frames, &consumed);
+	} else {
+		if (avail < dev->frames ||
+		    free < asrc_output_frames(cd, dev->frames)) {
+			trace_asrc_error("asrc_copy() error: xrun, avail %u "
+					 "free %u", avail, free);
+			return -EIO; /* xrun */
+		}
+		produced = asrc_process(dev, source, sink, dev->frames,
+					free, &consumed);
+	}
+
+	if (consumed > 0)
+		comp_update_buffer_consume(source, consumed * dev->frame_bytes);
+
+	if (produced > 0) {
+		comp_update_buffer_produce(sink, produced * dev->frame_bytes);
+		return produced;
+	}
+
+	return 0;
+}
+
+static int asrc_prepare(struct comp_dev *dev)
+{
+	struct sof_ipc_comp_asrc *asrc = COMP_GET_IPC(dev, sof_ipc_comp_asrc);
+	struct comp_data *cd = comp_get_drvdata(dev);
+	struct comp_buffer *source;
+	struct comp_buffer *sink;
+	uint32_t step_max;
+	int ret;
+
+	trace_asrc("asrc_prepare()");
+
+	ret = comp_set_state(dev, COMP_TRIGGER_PREPARE);
+	if (ret < 0)
+		return ret;
+
+	switch (dev->params.frame_fmt) {
+	case SOF_IPC_FRAME_S16_LE:
+	case SOF_IPC_FRAME_S24_4LE:
+	case SOF_IPC_FRAME_S32_LE:
+		break;
+	default:
+		trace_asrc_error("asrc_prepare() error: "
+				 "invalid frame_fmt");
+		comp_set_state(dev, COMP_TRIGGER_RESET);
+		return -EINVAL;
+	}
+
+	dev->frame_bytes =
+		dev->params.sample_container_bytes * dev->params.channels;
+
+	cd->step = asrc_nominal_step(cd);
+	cd->phase = ASRC_STEP_ONE;
+	cd->fs_dai = 0;
+	memset(cd->hist, 0, sizeof(cd->hist));
+
+	/* the host side buffer needs room for the largest drifted block */
+	step_max = cd->step + (uint64_t)cd->step * ASRC_DRIFT_MAX_PPM /
+		1000000;
+	step_max = MIN(step_max, ASRC_STEP_MAX);
+	source = list_first_item(&dev->bsource_list, struct comp_buffer,
+				 sink_list);
+	sink = list_first_item(&dev->bsink_list, struct comp_buffer,
+			       source_list);
+	if (dev->params.direction == SOF_IPC_STREAM_PLAYBACK) {
+		cd->dai = asrc->asynchronous_mode ?
+			asrc_find_dai(dev, SOF_IPC_STREAM_PLAYBACK) : NULL;
+		ret = source->size < (((uint64_t)step_max * dev->frames >>
+				       ASRC_STEP_SHIFT) + ASRC_TAPS) *
+			dev->frame_bytes;
+	} else {
+		cd->dai = asrc->asynchronous_mode ?
+			asrc_find_dai(dev, SOF_IPC_STREAM_CAPTURE) : NULL;
+		ret = sink->size < asrc_output_frames(cd, dev->frames) *
+			dev->frame_bytes;
+	}
+
+	if (ret) {
+		trace_asrc_error("asrc_prepare() error: buffer too small, "
+				 "source %u sink %u", source->size,
+				 sink->size);
+		comp_set_state(dev, COMP_TRIGGER_RESET);
+		return -EINVAL;
+	}
+
+	if (asrc->asynchronous_mode && !cd->dai)
+		trace_asrc("asrc_prepare(), no DAI found, fixed ratio");
+
+	return 0;
+}
+
+static int asrc_reset(struct comp_dev *dev)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+
+	trace_asrc("asrc_reset()");
+
+	cd->dai = NULL;
+	cd->fs_dai = 0;
+
+	comp_set_state(dev, COMP_TRIGGER_RESET);
+	return 0;
+}
+
+static void asrc_cache(struct comp_dev *dev, int cmd)
+{
+	struct comp_data *cd;
+
+	switch (cmd) {
+	case COMP_CACHE_WRITEBACK_INV:
+		trace_asrc("asrc_cache(), COMP_CACHE_WRITEBACK_INV");
+
+		cd = comp_get_drvdata(dev);
+
+		dcache_writeback_invalidate_region(cd, sizeof(*cd));
+		dcache_writeback_invalidate_region(dev, sizeof(*dev));
+		break;
+
+	case COMP_CACHE_INVALIDATE:
+		trace_asrc("asrc_cache(), COMP_CACHE_INVALIDATE");
+
+		dcache_invalidate_region(dev, sizeof(*dev));
+
+		cd = comp_get_drvdata(dev);
+		dcache_invalidate_region(cd, sizeof(*cd));
+		break;
+	}
+}
+
+struct comp_driver comp_asrc = {
+	.type = SOF_COMP_ASRC,
+	.ops = {
+		.new = asrc_new,
+		.free = asrc_free,
+		.params = asrc_params,
+		.cmd = asrc_cmd,
+		.trigger = asrc_trigger,
+		.copy = asrc_copy,
+		.prepare = asrc_prepare,
+		.reset = asrc_reset,
+		.cache = asrc_cache,
+	},
+};
+
+void sys_comp_asrc_init(void)
+{
+	comp_register(&comp_asrc);
+}
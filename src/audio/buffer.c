@@ -39,16 +39,37 @@
 #include <sof/alloc.h>
 #include <sof/debug.h>
 #include <sof/ipc.h>
+#include <sof/probe.h>
 #include <platform/timer.h>
 #include <platform/platform.h>
 #include <sof/audio/component.h>
 #include <sof/audio/pipeline.h>
 #include <sof/audio/buffer.h>
 
+/* zone of the buffer structure and data */
+static int buffer_zone(struct sof_ipc_buffer *desc)
+{
+	/* shared buffers are uncached so they're coherent between cores */
+	if (desc->caps & SOF_MEM_CAPS_SHARED)
+		return RZONE_RUNTIME | RZONE_FLAG_UNCACHED;
+
+	return RZONE_RUNTIME;
+}
+
+/* allocation capabilities of the buffer data */
+static uint32_t buffer_caps(struct sof_ipc_buffer *desc)
+{
+	/* sharing, reset and position policies are not allocation caps */
+	return desc->caps & ~(SOF_MEM_CAPS_SHARED | SOF_MEM_CAPS_ZERO |
+			      SOF_MEM_CAPS_POW2 | SOF_MEM_CAPS_FANOUT |
+			      SOF_MEM_CAPS_LOOPBACK);
+}
+
 /* create a new component in the pipeline */
 struct comp_buffer *buffer_new(struct sof_ipc_buffer *desc)
 {
 	struct comp_buffer *buffer;
+	int zone = buffer_zone(desc);
 
 	trace_buffer("buffer_new()");
 
@@ -60,14 +81,14 @@ struct comp_buffer *buffer_new(struct sof_ipc_buffer *desc)
 	}
 
 	/* allocate new buffer */
-	buffer = rzalloc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM, sizeof(*buffer));
+	buffer = rzalloc(zone, SOF_MEM_CAPS_RAM, sizeof(*buffer));
 	if (buffer == NULL) {
 		trace_buffer_error("buffer_new() error: "
 				   "could not alloc structure");
 		return NULL;
 	}
 
-	buffer->addr = rballoc(RZONE_RUNTIME, desc->caps, desc->size);
+	buffer->addr = rballoc(zone, buffer_caps(desc), desc->size);
 	if (buffer->addr == NULL) {
 		rfree(buffer);
 		trace_buffer_error("buffer_new() error: "
@@ -81,11 +102,13 @@ struct comp_buffer *buffer_new(struct sof_ipc_buffer *desc)
 
 	buffer->size = buffer->alloc_size = desc->size;
 	buffer->ipc_buffer = *desc;
+	buffer->caps = desc->caps;
 	buffer->w_ptr = buffer->r_ptr = buffer->addr;
 	buffer->end_addr = buffer->addr + buffer->ipc_buffer.size;
 	buffer->free = buffer->ipc_buffer.size;
 	buffer->avail = 0;
 	buffer->connected = 0;
+	buffer_set_mask(buffer);
 
 	buffer_zero(buffer);
 
@@ -94,24 +117,234 @@ struct comp_buffer *buffer_new(struct sof_ipc_buffer *desc)
 	return buffer;
 }
 
+/*
+ * Replace the buffer data with a new allocation of size bytes, e.g. when
+ * pipeline params size the buffer for its components. The buffer must not
+ * be running. DMA descriptors hold the address of DMA connected buffers,
+ * so those keep their allocation.
+ */
+int buffer_realloc(struct comp_buffer *buffer, uint32_t size)
+{
+	struct comp_buffer *reader = buffer;
+	void *addr;
+
+	if (size == buffer->alloc_size)
+		return 0;
+
+	if (size == 0 || size > HEAP_BUFFER_SIZE)
+		return -EINVAL;
+
+	/* fan-out readers share the data, so all of them must allow it */
+	do {
+		if ((reader->source && reader->source->is_dma_connected) ||
+		    (reader->sink && reader->sink->is_dma_connected))
+			return -ENOMEM;
+		reader = reader->next_reader;
+	} while (reader && reader != buffer);
+
+	addr = rballoc(buffer_zone(&buffer->ipc_buffer),
+		       buffer_caps(&buffer->ipc_buffer), size);
+	if (!addr) {
+		trace_buffer_error("buffer_realloc() error: "
+				   "could not alloc size = %u bytes", size);
+		return -ENOMEM;
+	}
+
+	tracev_buffer("buffer_realloc(), ((buffer->ipc_buffer.comp.id << 16) "
+		      "| size) = %08x", (buffer->ipc_buffer.comp.id << 16) |
+		      size);
+
+	rfree(buffer->addr);
+
+	do {
+		reader->addr = addr;
+		reader->size = reader->alloc_size = size;
+		reader->end_addr = reader->addr + size;
+		reader->w_ptr = reader->r_ptr = reader->addr;
+		reader->free = size;
+		reader->avail = 0;
+		reader->produced = 0;
+		reader->consumed = 0;
+		buffer_set_mask(reader);
+		reader = reader->next_reader;
+	} while (reader && reader != buffer);
+
+	buffer_zero(buffer);
+
+	return 0;
+}
+
+/*
+ * Fan-out buffers of one source component share a single data buffer,
+ * each keeps the read position of its own sink. The writer sees the free
+ * space of the slowest active reader and every produce moves the write
+ * positions of all readers, so the data is written once for all sinks.
+ */
+void buffer_fanout_join(struct comp_buffer *group, struct comp_buffer *buffer)
+{
+	trace_buffer("buffer_fanout_join(), ((group->ipc_buffer.comp.id << 16)"
+		     " | buffer->ipc_buffer.comp.id) = %08x",
+		     (group->ipc_buffer.comp.id << 16) |
+		     buffer->ipc_buffer.comp.id);
+
+	rfree(buffer->addr);
+
+	buffer->addr = group->addr;
+	buffer->alloc_size = group->alloc_size;
+	buffer->size = group->size;
+	buffer->end_addr = group->end_addr;
+
+	/* new reader starts empty at the write position */
+	buffer->w_ptr = buffer->r_ptr = group->w_ptr;
+	buffer->free = buffer->size;
+	buffer->avail = 0;
+	buffer->produced = buffer->consumed = group->w_ptr - group->addr;
+	buffer_set_mask(buffer);
+
+	buffer->next_reader = group->next_reader ? group->next_reader : group;
+	group->next_reader = buffer;
+}
+
+/* readers of inactive sinks don't hold back the writer */
+static inline int buffer_fanout_reader_active(struct comp_buffer *reader)
+{
+	return reader->connected && reader->sink->state == COMP_STATE_ACTIVE;
+}
+
+uint32_t buffer_fanout_free_bytes(struct comp_buffer *buffer)
+{
+	struct comp_buffer *reader = buffer;
+	uint32_t free_bytes = buffer->size;
+
+	do {
+		if (buffer_fanout_reader_active(reader))
+			free_bytes = MIN(free_bytes,
+					 buffer_reader_free_bytes(reader));
+		reader = reader->next_reader;
+	} while (reader != buffer);
+
+	return free_bytes;
+}
+
+/* restart a reader empty at the write position the group shares, the
+ * data may still be read by the others so it is never zeroed here */
+void buffer_fanout_reset_pos(struct comp_buffer *buffer)
+{
+	struct comp_buffer *from = buffer->next_reader;
+	uint32_t avail = 0;
+
+	/* loopback readers start at the data being played */
+	if (buffer->trail) {
+		from = buffer->trail;
+		avail = buffer_reader_avail_bytes(from);
+	}
+
+	buffer->w_ptr = from->w_ptr;
+	buffer->r_ptr = from->r_ptr;
+	if (!buffer->trail)
+		buffer->r_ptr = buffer->w_ptr;
+	buffer->avail = avail;
+	buffer->free = buffer->size - avail;
+
+	/* power of two counters carry the position */
+	buffer->consumed = buffer->r_ptr - buffer->addr;
+	buffer->produced = buffer->consumed + avail;
+}
+
+/*
+ * An echo canceller in a capture pipeline needs the samples as they leave
+ * the speaker. A SOF_MEM_CAPS_LOOPBACK fan-out reader trails the reader of
+ * the playback DAI in its group, so the data it sees is what that DAI has
+ * already consumed and no copy of the playback stream is made.
+ */
+uint32_t buffer_loopback_avail_bytes(struct comp_buffer *buffer)
+{
+	uint32_t avail = buffer_reader_avail_bytes(buffer);
+	uint32_t queued = buffer_reader_avail_bytes(buffer->trail);
+
+	return avail > queued ? avail - queued : 0;
+}
+
+void buffer_loopback_update(struct comp_buffer *buffer)
+{
+	struct comp_buffer *reader = buffer;
+	struct comp_buffer *dai = NULL;
+
+	if (!buffer->next_reader)
+		return;
+
+	/* playback DAIs are the only DAIs reading from a buffer */
+	do {
+		if (reader->sink && (reader->sink->comp.type == SOF_COMP_DAI ||
+				     reader->sink->comp.type == SOF_COMP_SG_DAI))
+			dai = reader;
+		reader = reader->next_reader;
+	} while (reader != buffer);
+
+	do {
+		if (reader->ipc_buffer.caps & SOF_MEM_CAPS_LOOPBACK)
+			reader->trail = dai;
+		reader = reader->next_reader;
+	} while (reader != buffer);
+}
+
+/* the DAI consumes whole periods, its position adds what the DMA moved
+ * since so the delay is exact to the DMA burst */
+uint32_t buffer_loopback_delay(struct comp_buffer *buffer)
+{
+	struct sof_ipc_stream_posn posn;
+	struct comp_dev *dai;
+	uint32_t delay = comp_buffer_get_avail_bytes(buffer);
+
+	if (!buffer->trail)
+		return delay;
+
+	dai = buffer->trail->sink;
+	posn.dai_posn = dai->position;
+	if (dai->state == COMP_STATE_ACTIVE && !comp_position(dai, &posn))
+		delay += posn.dai_posn - dai->position;
+
+	return delay;
+}
+
 /* free component in the pipeline */
 void buffer_free(struct comp_buffer *buffer)
 {
+	struct comp_buffer *prev = buffer->next_reader;
+
 	trace_buffer("buffer_free()");
 
 	list_item_del(&buffer->source_list);
 	list_item_del(&buffer->sink_list);
-	rfree(buffer->addr);
+
+	/* the last fan-out reader frees the shared data */
+	if (prev) {
+		while (prev->next_reader != buffer) {
+			if (prev->trail == buffer)
+				prev->trail = NULL;
+			prev = prev->next_reader;
+		}
+		if (prev->trail == buffer)
+			prev->trail = NULL;
+		prev->next_reader = buffer->next_reader == prev ?
+			NULL : buffer->next_reader;
+	} else {
+		rfree(buffer->addr);
+	}
+
 	rfree(buffer);
 }
 
-void comp_update_buffer_produce(struct comp_buffer *buffer, uint32_t bytes)
+/* handle data cache for bytes produced at the write position */
+static inline void buffer_produce_cache(struct comp_buffer *buffer,
+					uint32_t bytes)
 {
-	uint32_t flags;
 	uint32_t head = bytes;
 	uint32_t tail = 0;
 
-	spin_lock_irq(&buffer->lock, flags);
+	/* uncached shared buffers are always coherent */
+	if (buffer_is_shared(buffer))
+		return;
 
 	/* calculate head and tail size for dcache circular wrap ops */
 	if (buffer->w_ptr + bytes > buffer->end_addr) {
@@ -125,6 +358,8 @@ void comp_update_buffer_produce(struct comp_buffer *buffer, uint32_t bytes)
 	 * 2. source(non-DMA) --> buffer --> sink(DMA): write back to memory.
 	 * 3. source(DMA) --> buffer --> sink(DMA): do nothing.
 	 * 4. source(non-DMA) --> buffer --> sink(non-DMA): do nothing.
+	 * SPSC buffers can be read by another core, so new data is always
+	 * written back unless it came from DMA.
 	 */
 	if (buffer->source->is_dma_connected &&
 	    !buffer->sink->is_dma_connected) {
@@ -134,12 +369,141 @@ void comp_update_buffer_produce(struct comp_buffer *buffer, uint32_t bytes)
 			dcache_invalidate_region(buffer->addr, tail);
 	}
 	else if (!buffer->source->is_dma_connected &&
-		 buffer->sink->is_dma_connected) {
+		 (buffer->sink->is_dma_connected || buffer->spsc)) {
 		/* need write back to memory for sink component to use */
 		dcache_writeback_region(buffer->w_ptr, head);
 		if (tail)
 			dcache_writeback_region(buffer->addr, tail);
 	}
+}
+
+/* get the position of a byte counter in power of two mode */
+static inline void *buffer_mask_pos(struct comp_buffer *buffer,
+				    uint32_t count)
+{
+	return (uint8_t *)buffer->addr + (count & buffer->mask);
+}
+
+/* producer side of SPSC mode, only the write position is updated */
+static void __hot_text comp_update_buffer_produce_spsc(
+	struct comp_buffer *buffer, uint32_t bytes)
+{
+	void *w_ptr = buffer->w_ptr + bytes;
+
+	/* check for pointer wrap */
+	if (buffer->mask)
+		w_ptr = buffer_mask_pos(buffer, buffer->produced + bytes);
+	else if (w_ptr >= buffer->end_addr)
+		w_ptr = buffer->addr + (w_ptr - buffer->end_addr);
+
+	buffer->w_ptr = w_ptr;
+	buffer->produced += bytes;
+
+	/* make new position visible to the consumer core */
+	if (!buffer_is_shared(buffer))
+		dcache_writeback_region(&buffer->w_ptr,
+					sizeof(buffer->w_ptr) +
+					sizeof(buffer->produced));
+
+	tracehot_buffer("comp_update_buffer_produce_spsc(), "
+			"((buffer->ipc_buffer.comp.id << 16) | bytes) = %08x",
+			(buffer->ipc_buffer.comp.id << 16) | bytes);
+}
+
+/* consumer side of SPSC mode, only the read position is updated */
+static void __hot_text comp_update_buffer_consume_spsc(
+	struct comp_buffer *buffer, uint32_t bytes)
+{
+	void *r_ptr = buffer->r_ptr + bytes;
+	uint32_t head = bytes;
+
+	/* check for pointer wrap */
+	if (r_ptr >= buffer->end_addr) {
+		r_ptr = buffer->addr + (r_ptr - buffer->end_addr);
+		head = buffer->end_addr - buffer->r_ptr;
+	}
+	if (buffer->mask)
+		r_ptr = buffer_mask_pos(buffer, buffer->consumed + bytes);
+
+	/* drop consumed data so the next lap is read from memory */
+	if (!buffer_is_shared(buffer)) {
+		dcache_invalidate_region(buffer->r_ptr, head);
+		if (head < bytes)
+			dcache_invalidate_region(buffer->addr, bytes - head);
+	}
+
+	buffer->r_ptr = r_ptr;
+	buffer->consumed += bytes;
+
+	/* make new position visible to the producer core */
+	if (!buffer_is_shared(buffer))
+		dcache_writeback_region(&buffer->r_ptr,
+					sizeof(buffer->r_ptr) +
+					sizeof(buffer->consumed));
+
+	tracehot_buffer("comp_update_buffer_consume_spsc(), "
+			"((buffer->ipc_buffer.comp.id << 16) | bytes) = %08x",
+			(buffer->ipc_buffer.comp.id << 16) | bytes);
+}
+
+/*
+ * Power of two mode, the producer only writes its counter and position so
+ * no lock is needed and avail and free are derived when read.
+ */
+static void __hot_text comp_update_buffer_produce_pow2(
+	struct comp_buffer *buffer, uint32_t bytes)
+{
+	buffer->produced += bytes;
+	buffer->w_ptr = buffer_mask_pos(buffer, buffer->produced);
+
+	tracehot_buffer("comp_update_buffer_produce_pow2(), "
+			"((buffer->ipc_buffer.comp.id << 16) | bytes) = %08x",
+			(buffer->ipc_buffer.comp.id << 16) | bytes);
+}
+
+static void __hot_text comp_update_buffer_consume_pow2(
+	struct comp_buffer *buffer, uint32_t bytes)
+{
+	buffer->consumed += bytes;
+	buffer->r_ptr = buffer_mask_pos(buffer, buffer->consumed);
+
+	if (buffer->sink->is_dma_connected &&
+	    !buffer->source->is_dma_connected && !buffer_is_shared(buffer))
+		dcache_writeback_region(buffer->r_ptr, bytes);
+
+	tracehot_buffer("comp_update_buffer_consume_pow2(), "
+			"((buffer->ipc_buffer.comp.id << 16) | bytes) = %08x",
+			(buffer->ipc_buffer.comp.id << 16) | bytes);
+}
+
+static inline void buffer_produce(struct comp_buffer *buffer, uint32_t bytes)
+{
+	uint32_t flags;
+
+	/* producer owns the new data until the write position moves */
+	buffer_produce_cache(buffer, bytes);
+
+	/* in place component processes new data before the consumer sees it */
+	if (buffer->inplace)
+		comp_copy_inplace(buffer->bypass_comp, buffer, buffer->w_ptr,
+				  bytes);
+
+	/* probes see the data as the consumer will */
+	if (buffer->probe)
+		probe_produce(buffer, buffer->w_ptr, bytes);
+
+	/* SPSC buffers don't need lock, producer owns write position */
+	if (buffer->spsc) {
+		comp_update_buffer_produce_spsc(buffer, bytes);
+		return;
+	}
+
+	if (buffer->mask) {
+		comp_update_buffer_produce_pow2(buffer, bytes);
+		return;
+	}
+
+	spin_lock_irq(&buffer->lock, flags);
 
 	buffer->w_ptr += bytes;
 
@@ -160,21 +524,54 @@ void comp_update_buffer_produce(struct comp_buffer *buffer, uint32_t bytes)
 
 	spin_unlock_irq(&buffer->lock, flags);
 
-	tracev_buffer("comp_update_buffer_produce(), ((buffer->avail << 16) | "
-		      "buffer->free) = %08x, ((buffer->ipc_buffer.comp.id << "
-		      "16) | buffer->size) = %08x",
-		      (buffer->avail << 16) | buffer->free,
-		      (buffer->ipc_buffer.comp.id << 16) | buffer->size);
-	tracev_buffer("comp_update_buffer_produce(), ((buffer->r_ptr - buffer"
-		      "->addr) << 16 | (buffer->w_ptr - buffer->addr)) = %08x",
-		      (buffer->r_ptr - buffer->addr) << 16 | 
-		      (buffer->w_ptr - buffer->addr));
+	tracehot_buffer("comp_update_buffer_produce(), ((buffer->avail << 16) | "
+			"buffer->free) = %08x, ((buffer->ipc_buffer.comp.id << "
+			"16) | buffer->size) = %08x",
+			(buffer->avail << 16) | buffer->free,
+			(buffer->ipc_buffer.comp.id << 16) | buffer->size);
+	tracehot_buffer("comp_update_buffer_produce(), ((buffer->r_ptr - buffer"
+			"->addr) << 16 | (buffer->w_ptr - buffer->addr)) = %08x",
+			(buffer->r_ptr - buffer->addr) << 16 | 
+			(buffer->w_ptr - buffer->addr));
+}
+
+void __hot_text comp_update_buffer_produce(struct comp_buffer *buffer,
+					   uint32_t bytes)
+{
+	struct comp_buffer *reader = buffer;
+
+	if (!buffer->next_reader) {
+		buffer_produce(buffer, bytes);
+		return;
+	}
+
+	/* every fan-out reader sees the new data, inactive ones drop it */
+	do {
+		if (reader->connected) {
+			buffer_produce(reader, bytes);
+			if (!buffer_fanout_reader_active(reader))
+				comp_update_buffer_consume(reader, bytes);
+		}
+		reader = reader->next_reader;
+	} while (reader != buffer);
 }
 
-void comp_update_buffer_consume(struct comp_buffer *buffer, uint32_t bytes)
+void __hot_text comp_update_buffer_consume(struct comp_buffer *buffer,
+					   uint32_t bytes)
 {
 	uint32_t flags;
 
+	/* SPSC buffers don't need lock, consumer owns read position */
+	if (buffer->spsc) {
+		comp_update_buffer_consume_spsc(buffer, bytes);
+		return;
+	}
+
+	if (buffer->mask) {
+		comp_update_buffer_consume_pow2(buffer, bytes);
+		return;
+	}
+
 	spin_lock_irq(&buffer->lock, flags);
 
 	buffer->r_ptr += bytes;
@@ -195,14 +592,73 @@ void comp_update_buffer_consume(struct comp_buffer *buffer, uint32_t bytes)
 	buffer->free = buffer->size - buffer->avail;
 
 	if (buffer->sink->is_dma_connected &&
-	    !buffer->source->is_dma_connected)
+	    !buffer->source->is_dma_connected && !buffer_is_shared(buffer))
 		dcache_writeback_region(buffer->r_ptr, bytes);
 
 	spin_unlock_irq(&buffer->lock, flags);
 
-	tracev_buffer("comp_update_buffer_consume(), %u, %u, %u",
-		     (buffer->avail << 16) | buffer->free,
-		     (buffer->ipc_buffer.comp.id << 16) | buffer->size,
-		     (buffer->r_ptr - buffer->addr) << 16 |
-		     (buffer->w_ptr - buffer->addr));
+	tracehot_buffer("comp_update_buffer_consume(), %u, %u, %u",
+		       (buffer->avail << 16) | buffer->free,
+		       (buffer->ipc_buffer.comp.id << 16) | buffer->size,
+		       (buffer->r_ptr - buffer->addr) << 16 |
+		       (buffer->w_ptr - buffer->addr));
+}
+
+/* all frame formats are made of 16 bit words, OR them up to each wrap */
+bool __hot_text buffer_is_silent(struct comp_buffer *buffer, uint32_t bytes)
+{
+	const int16_t *sample = buffer->r_ptr;
+	int16_t acc = 0;
+	uint32_t n;
+	uint32_t i;
+
+	while (bytes && !acc) {
+		n = MIN(bytes, buffer_bytes_to_wrap(buffer, sample));
+		for (i = 0; i < n / sizeof(int16_t); i++)
+			acc |= sample[i];
+
+		sample = buffer_wrap(buffer, (uint8_t *)sample + n);
+		bytes -= n;
+	}
+
+	return !acc;
+}
+
+/* linear Q1.15 ramp from silence over the frames at the read position,
+ * integer formats only
+ */
+void buffer_fade_in(struct comp_buffer *buffer, uint32_t frames,
+		    uint32_t channels, enum sof_ipc_frame frame_fmt)
+{
+	uint32_t sample_bytes = frame_fmt == SOF_IPC_FRAME_S16_LE ? 2 : 4;
+	uint32_t bytes = frames * channels * sample_bytes;
+	uint32_t n = MIN(bytes, buffer_bytes_to_wrap(buffer, buffer->r_ptr));
+	uint8_t *ptr = buffer->r_ptr;
+	int32_t gain;
+	uint32_t i;
+	uint32_t j;
+
+	if (frame_fmt == SOF_IPC_FRAME_FLOAT || !frames)
+		return;
+
+	for (i = 0; i < frames; i++) {
+		gain = (int32_t)((i << 15) / frames);
+		for (j = 0; j < channels; j++) {
+			if (sample_bytes == 2)
+				*(int16_t *)ptr = (*(int16_t *)ptr * gain) >> 15;
+			else
+				*(int32_t *)ptr =
+					((int64_t)*(int32_t *)ptr * gain) >> 15;
+			ptr = buffer_wrap(buffer, ptr + sample_bytes);
+		}
+	}
+
+	/* DMA may rewrite the ramp once it is consumed, don't let it be
+	 * evicted over the new data
+	 */
+	if (buffer->source->is_dma_connected) {
+		dcache_writeback_region(buffer->r_ptr, n);
+		if (bytes > n)
+			dcache_writeback_region(buffer->addr, bytes - n);
+	}
 }
@@ -31,42 +31,81 @@
 #include <stdint.h>
 #include <stddef.h>
 #include <errno.h>
+#include <string.h>
 #include <sof/sof.h>
 #include <sof/lock.h>
 #include <sof/list.h>
 #include <sof/stream.h>
 #include <sof/alloc.h>
 #include <sof/audio/component.h>
+#include <sof/audio/format.h>
 #include <sof/audio/pipeline.h>
+#include <sof/module.h>
+#include <arch/cache.h>
 #include <uapi/ipc/topology.h>
 
+/* driver lookup table size, higher types are only on the list */
+#define COMP_DRV_TYPES		32
+
+/* control events a component can have queued */
+#define COMP_EVENT_MAX		32
+
 struct comp_data {
 	struct list_item list;		/* list of components */
 	spinlock_t lock;
+
+	/* newest driver of each type, written under lock, read without */
+	struct comp_driver *type_drv[COMP_DRV_TYPES];
+
+	struct list_item blob_list;	/* shared control blobs */
+	spinlock_t blob_lock;
+};
+
+/* control blob shared by the components with the same configuration */
+struct comp_blob {
+	struct list_item list;
+	uint32_t hash;
+	uint32_t refs;
+	uint32_t size;
 };
 
+/* blob data starts on its own cache line, components writeback and
+ * invalidate it without touching the header
+ */
+#define COMP_BLOB_HDR_SIZE \
+	ALIGN_UP(sizeof(struct comp_blob), PLATFORM_DCACHE_ALIGN)
+
 static struct comp_data *cd;
 
-static struct comp_driver *get_drv(uint32_t type)
+/* newest registered driver of type, lock must be held */
+static struct comp_driver *find_drv(uint32_t type)
 {
 	struct list_item *clist;
-	struct comp_driver *drv = NULL;
-
-	spin_lock(&cd->lock);
+	struct comp_driver *drv;
 
 	/* search driver list for driver type */
 	list_for_item(clist, &cd->list) {
 
 		drv = container_of(clist, struct comp_driver, list);
 		if (drv->type == type)
-			goto out;
+			return drv;
 	}
 
 	/* not found */
-	drv = NULL;
+	return NULL;
+}
+
+static struct comp_driver *get_drv(uint32_t type)
+{
+	struct comp_driver *drv;
+
+	if (type < COMP_DRV_TYPES)
+		return cd->type_drv[type];
 
-out:
+	spin_lock(&cd->lock);
+	drv = find_drv(type);
 	spin_unlock(&cd->lock);
+
 	return drv;
 }
 
@@ -75,8 +114,12 @@ struct comp_dev *comp_new(struct sof_ipc_comp *comp)
 	struct comp_dev *cdev;
 	struct comp_driver *drv;
 
-	/* find the driver for our new component */
+	/* find the driver for our new component, loading its module if the
+	 * type isn't built in
+	 */
 	drv = get_drv(comp->type);
+	if (drv == NULL && module_load(comp->type) >= 0)
+		drv = get_drv(comp->type);
 	if (drv == NULL) {
 		trace_comp_error("comp_new() error: driver not found, "
 				 "comp->type = %u", comp->type);
@@ -97,6 +140,10 @@ struct comp_dev *comp_new(struct sof_ipc_comp *comp)
 	spinlock_init(&cdev->lock);
 	list_init(&cdev->bsource_list);
 	list_init(&cdev->bsink_list);
+	list_init(&cdev->event_list);
+#ifdef CONFIG_PERFORMANCE_COUNTERS
+	comp_perf_reset(cdev);
+#endif
 
 	return cdev;
 }
@@ -105,6 +152,8 @@ int comp_register(struct comp_driver *drv)
 {
 	spin_lock(&cd->lock);
 	list_item_prepend(&drv->list, &cd->list);
+	if (drv->type < COMP_DRV_TYPES)
+		cd->type_drv[drv->type] = drv;
 	spin_unlock(&cd->lock);
 
 	return 0;
@@ -114,6 +163,10 @@ void comp_unregister(struct comp_driver *drv)
 {
 	spin_lock(&cd->lock);
 	list_item_del(&drv->list);
+
+	/* fall back to an older driver of the same type */
+	if (drv->type < COMP_DRV_TYPES && cd->type_drv[drv->type] == drv)
+		cd->type_drv[drv->type] = find_drv(drv->type);
 	spin_unlock(&cd->lock);
 }
 
@@ -219,9 +272,216 @@ void comp_set_period_bytes(struct comp_dev *dev, uint32_t frames,
 	*period_bytes = frames * comp_frame_bytes(dev);
 }
 
+int comp_event_schedule(struct comp_dev *dev, uint64_t position, int cmd,
+			struct sof_ipc_ctrl_data *data)
+{
+	struct comp_event *event;
+	struct comp_event *next;
+	struct list_item *elist;
+	struct list_item *insert;
+	uint32_t flags;
+	int count = 0;
+
+	event = rmalloc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM,
+			sizeof(*event) + data->rhdr.hdr.size - sizeof(*data));
+	if (!event)
+		return -ENOMEM;
+
+	event->position = position;
+	event->cmd = cmd;
+	memcpy(&event->data, data, data->rhdr.hdr.size);
+
+	spin_lock_irq(&dev->lock, flags);
+
+	/* queue after the events at the same position */
+	insert = &dev->event_list;
+	list_for_item(elist, &dev->event_list) {
+		next = container_of(elist, struct comp_event, list);
+		if (insert == &dev->event_list && next->position > position)
+			insert = elist;
+		count++;
+	}
+
+	if (count >= COMP_EVENT_MAX) {
+		spin_unlock_irq(&dev->lock, flags);
+		trace_comp_error("comp_event_schedule() error: comp %u has "
+				 "%d events queued", dev->comp.id, count);
+		rfree(event);
+		return -ENOSPC;
+	}
+
+	list_item_append(&event->list, insert);
+
+	spin_unlock_irq(&dev->lock, flags);
+
+	return 0;
+}
+
+uint32_t comp_event_apply(struct comp_dev *dev, uint32_t frames)
+{
+	struct comp_event *event;
+	uint64_t ahead;
+	uint32_t flags;
+	int ret;
+
+	for (;;) {
+		spin_lock_irq(&dev->lock, flags);
+
+		if (list_is_empty(&dev->event_list)) {
+			spin_unlock_irq(&dev->lock, flags);
+			return frames;
+		}
+
+		/* frames up to the next event can be processed */
+		event = list_first_item(&dev->event_list, struct comp_event,
+					list);
+		if (event->position > dev->event_position) {
+			spin_unlock_irq(&dev->lock, flags);
+			ahead = event->position - dev->event_position;
+			return ahead < frames ? ahead : frames;
+		}
+
+		list_item_del(&event->list);
+
+		spin_unlock_irq(&dev->lock, flags);
+
+		tracev_comp("comp_event_apply(), comp %u cmd %u at %u",
+			    dev->comp.id, event->data.cmd,
+			    (uint32_t)dev->event_position);
+
+		/* the event was validated when scheduled, report only */
+		ret = comp_cmd(dev, event->cmd, &event->data,
+			       event->data.rhdr.hdr.size);
+		if (ret < 0)
+			trace_comp_error("comp_event_apply() error: comp %u "
+					 "cmd %u failed %d", dev->comp.id,
+					 event->data.cmd, ret);
+
+		rfree(event);
+	}
+}
+
+void comp_event_flush(struct comp_dev *dev)
+{
+	struct comp_event *event;
+	uint32_t flags;
+
+	for (;;) {
+		spin_lock_irq(&dev->lock, flags);
+
+		if (list_is_empty(&dev->event_list)) {
+			dev->event_position = 0;
+			spin_unlock_irq(&dev->lock, flags);
+			return;
+		}
+
+		event = list_first_item(&dev->event_list, struct comp_event,
+					list);
+		list_item_del(&event->list);
+
+		spin_unlock_irq(&dev->lock, flags);
+
+		rfree(event);
+	}
+}
+
+bool __hot_text comp_silence_check(struct comp_silence *silence,
+				   struct comp_buffer *source, uint32_t bytes)
+{
+	silence->silent = silence->decay && buffer_is_silent(source, bytes);
+	if (!silence->silent)
+		silence->frames = 0;
+
+	silence->skip = silence->silent && silence->frames >= silence->decay;
+	return silence->skip;
+}
+
+/* FNV-1a */
+static uint32_t comp_blob_hash(const uint8_t *data, size_t size)
+{
+	uint32_t hash = 2166136261u;
+	size_t i;
+
+	for (i = 0; i < size; i++)
+		hash = (hash ^ data[i]) * 16777619u;
+
+	return hash;
+}
+
+static inline void *comp_blob_data(struct comp_blob *blob)
+{
+	return (uint8_t *)blob + COMP_BLOB_HDR_SIZE;
+}
+
+void *comp_blob_get(const void *data, size_t size)
+{
+	struct list_item *blist;
+	struct comp_blob *blob;
+	uint32_t hash = comp_blob_hash(data, size);
+	uint32_t flags;
+
+	spin_lock_irq(&cd->blob_lock, flags);
+
+	list_for_item(blist, &cd->blob_list) {
+		blob = container_of(blist, struct comp_blob, list);
+		if (blob->hash == hash && blob->size == size &&
+		    !memcmp(comp_blob_data(blob), data, size)) {
+			blob->refs++;
+			spin_unlock_irq(&cd->blob_lock, flags);
+			return comp_blob_data(blob);
+		}
+	}
+
+	spin_unlock_irq(&cd->blob_lock, flags);
+
+	blob = rzalloc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM,
+		       COMP_BLOB_HDR_SIZE + size);
+	if (!blob)
+		return NULL;
+
+	blob->hash = hash;
+	blob->refs = 1;
+	blob->size = size;
+	memcpy(comp_blob_data(blob), data, size);
+
+	/* other cores can pick it up from the list */
+	dcache_writeback_region(comp_blob_data(blob), size);
+
+	spin_lock_irq(&cd->blob_lock, flags);
+	list_item_prepend(&blob->list, &cd->blob_list);
+	spin_unlock_irq(&cd->blob_lock, flags);
+
+	trace_comp("comp_blob_get() new blob, size %u hash 0x%x", size, hash);
+
+	return comp_blob_data(blob);
+}
+
+void comp_blob_put(void *data)
+{
+	struct comp_blob *blob;
+	uint32_t flags;
+	uint32_t refs;
+
+	if (!data)
+		return;
+
+	blob = (struct comp_blob *)((uint8_t *)data - COMP_BLOB_HDR_SIZE);
+
+	spin_lock_irq(&cd->blob_lock, flags);
+	refs = --blob->refs;
+	if (!refs)
+		list_item_del(&blob->list);
+	spin_unlock_irq(&cd->blob_lock, flags);
+
+	if (!refs)
+		rfree(blob);
+}
+
 void sys_comp_init(void)
 {
 	cd = rzalloc(RZONE_SYS, SOF_MEM_CAPS_RAM, sizeof(*cd));
 	list_init(&cd->list);
 	spinlock_init(&cd->lock);
+	list_init(&cd->blob_list);
+	spinlock_init(&cd->blob_lock);
 }
@@ -0,0 +1,403 @@
+/*
+ * Copyright (c) 2018, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file audio/conv.c
+ * \brief Format converter component implementation
+ *
+ * Converts between the sample formats and channel counts of the host side
+ * and the DAI side of a pipeline without applying any gain. The host side
+ * is described by the stream params and the DAI side by the component
+ * config frame format and channels, so playback converts from params to
+ * config and capture from config to params.
+ *
+ * When channels match, samples are converted by a format pair kernel. If
+ * the DAI side has more channels the source channels are duplicated
+ * round robin (mono to stereo copies the channel), if it has fewer every
+ * sink channel is the average of the source channels that map to it
+ * (stereo to mono averages left and right).
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <errno.h>
+#include <sof/sof.h>
+#include <sof/stream.h>
+#include <sof/alloc.h>
+#include <sof/ipc.h>
+#include <sof/audio/component.h>
+#include <sof/audio/format.h>
+#include <sof/math/numbers.h>
+#include "conv.h"
+
+/* bytes of one sample in the given format */
+static inline uint32_t conv_sample_bytes(enum sof_ipc_frame fmt)
+{
+	return fmt == SOF_IPC_FRAME_S16_LE ? sizeof(int16_t) : sizeof(int32_t);
+}
+
+/* read one sample as Q1.31 */
+static inline int32_t conv_read(const void *ptr, enum sof_ipc_frame fmt)
+{
+	switch (fmt) {
+	case SOF_IPC_FRAME_S16_LE:
+		return conv_s16_to_q31(*(const int16_t *)ptr);
+	case SOF_IPC_FRAME_S24_4LE:
+		return conv_s24_to_q31(*(const int32_t *)ptr);
+	default:
+		return *(const int32_t *)ptr;
+	}
+}
+
+/* write one Q1.31 sample */
+static inline void conv_write(void *ptr, enum sof_ipc_frame fmt, int32_t val)
+{
+	switch (fmt) {
+	case SOF_IPC_FRAME_S16_LE:
+		*(int16_t *)ptr = conv_q31_to_s16(val);
+		break;
+	case SOF_IPC_FRAME_S24_4LE:
+		*(int32_t *)ptr = conv_q31_to_s24(val);
+		break;
+	default:
+		*(int32_t *)ptr = val;
+		break;
+	}
+}
+
+/*
+ * Convert one period with equal channels. Source and sink buffers are
+ * circular, so the processing function is called for each region that
+ * doesn't wrap in either buffer.
+ */
+static void conv_period(struct comp_dev *dev, struct comp_buffer *sink,
+			struct comp_buffer *source)
+{
+	struct conv_data *cd = comp_get_drvdata(dev);
+	uint32_t source_bytes = conv_sample_bytes(cd->source_format);
+	uint32_t sink_bytes = conv_sample_bytes(cd->sink_format);
+	uint32_t samples = dev->frames * cd->sink_channels;
+	void *src = source->r_ptr;
+	void *dest = sink->w_ptr;
+	uint32_t n;
+
+	while (samples) {
+		/* samples until the first buffer wrap */
+		n = buffer_segment_samples(source, src, source_bytes,
+					   sink, dest, sink_bytes, samples);
+
+		cd->conv(dest, src, n);
+
+		dest = buffer_wrap(sink, (char *)dest + n * sink_bytes);
+		src = buffer_wrap(source, (char *)src + n * source_bytes);
+
+		samples -= n;
+	}
+}
+
+/*
+ * Convert one period with a different number of channels. Buffer sizes are
+ * multiples of the frame size so a frame never wraps.
+ */
+static void conv_period_remap(struct comp_dev *dev, struct comp_buffer *sink,
+			      struct comp_buffer *source)
+{
+	struct conv_data *cd = comp_get_drvdata(dev);
+	uint32_t source_bytes = conv_sample_bytes(cd->source_format);
+	uint32_t sink_bytes = conv_sample_bytes(cd->sink_format);
+	char *src = source->r_ptr;
+	char *dest = sink->w_ptr;
+	int64_t acc;
+	uint32_t frame;
+	uint32_t ch;
+	uint32_t i;
+	uint32_t n;
+
+	for (frame = 0; frame < dev->frames; frame++) {
+		for (ch = 0; ch < cd->sink_channels; ch++) {
+			if (cd->sink_channels > cd->source_channels) {
+				/* duplicate */
+				acc = conv_read(src + (ch % cd->source_channels)
+						* source_bytes,
+						cd->source_format);
+			} else {
+				/* downmix */
+				acc = 0;
+				n = 0;
+				for (i = ch; i < cd->source_channels;
+				     i += cd->sink_channels, n++)
+					acc += conv_read(src + i * source_bytes,
+							 cd->source_format);
+				acc /= n;
+			}
+
+			conv_write(dest + ch * sink_bytes, cd->sink_format,
+				   (int32_t)acc);
+		}
+
+		src = buffer_wrap(source, src + cd->source_channels *
+				  source_bytes);
+		dest = buffer_wrap(sink, dest + cd->sink_channels * sink_bytes);
+	}
+}
+
+static struct comp_dev *conv_new(struct sof_ipc_comp *comp)
+{
+	struct comp_dev *dev;
+	struct sof_ipc_comp_conv *conv;
+	struct sof_ipc_comp_conv *ipc_conv = (struct sof_ipc_comp_conv *)comp;
+	struct conv_data *cd;
+
+	trace_conv("conv_new()");
+
+	if (IPC_IS_SIZE_INVALID(ipc_conv->config)) {
+		IPC_SIZE_ERROR_TRACE(TRACE_CLASS_CONV, ipc_conv->config);
+		return NULL;
+	}
+
+	if (ipc_conv->channels > PLATFORM_MAX_CHANNELS) {
+		trace_conv_error("conv_new() error: invalid channels %u",
+				 ipc_conv->channels);
+		return NULL;
+	}
+
+	dev = rzalloc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM,
+		      COMP_SIZE(struct sof_ipc_comp_conv));
+	if (!dev)
+		return NULL;
+
+	conv = (struct sof_ipc_comp_conv *)&dev->comp;
+	memcpy(conv, ipc_conv, sizeof(struct sof_ipc_comp_conv));
+
+	cd = rzalloc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM, sizeof(*cd));
+	if (!cd) {
+		rfree(dev);
+		return NULL;
+	}
+
+	comp_set_drvdata(dev, cd);
+	dev->state = COMP_STATE_READY;
+	return dev;
+}
+
+static void conv_free(struct comp_dev *dev)
+{
+	struct conv_data *cd = comp_get_drvdata(dev);
+
+	trace_conv("conv_free()");
+
+	rfree(cd);
+	rfree(dev);
+}
+
+/*
+ * Set component audio stream parameters. Params are rewritten to the DAI
+ * side format for the rest of the walk, in playback that is downstream
+ * and in capture upstream.
+ */
+static int conv_params(struct comp_dev *dev)
+{
+	struct sof_ipc_stream_params *params = &dev->params;
+	struct sof_ipc_comp_conv *conv = COMP_GET_IPC(dev, sof_ipc_comp_conv);
+	struct sof_ipc_comp_config *config = COMP_GET_CONFIG(dev);
+	struct conv_data *cd = comp_get_drvdata(dev);
+	struct comp_buffer *sink;
+	enum sof_ipc_frame dai_format = config->frame_fmt;
+	uint32_t dai_channels = conv->channels ? conv->channels :
+		params->channels;
+	int ret;
+
+	trace_conv("conv_params()");
+
+	if (params->direction == SOF_IPC_STREAM_PLAYBACK) {
+		cd->source_format = params->frame_fmt;
+		cd->source_channels = params->channels;
+		cd->sink_format = dai_format;
+		cd->sink_channels = dai_channels;
+	} else {
+		cd->source_format = dai_format;
+		cd->source_channels = dai_channels;
+		cd->sink_format = params->frame_fmt;
+		cd->sink_channels = params->channels;
+	}
+
+	if (!cd->source_channels || !cd->sink_channels ||
+	    cd->source_channels > PLATFORM_MAX_CHANNELS ||
+	    cd->sink_channels > PLATFORM_MAX_CHANNELS) {
+		trace_conv_error("conv_params() error: unsupported channels "
+				 "%u -> %u", cd->source_channels,
+				 cd->sink_channels);
+		return -EINVAL;
+	}
+
+	cd->conv = conv_get_processing_function(dev);
+	if (!cd->conv) {
+		trace_conv_error("conv_params() error: unsupported formats "
+				 "%u -> %u", cd->source_format,
+				 cd->sink_format);
+		return -EINVAL;
+	}
+
+	params->frame_fmt = dai_format;
+	params->channels = dai_channels;
+
+	cd->source_period_bytes = dev->frames * cd->source_channels *
+		conv_sample_bytes(cd->source_format);
+	cd->sink_period_bytes = dev->frames * cd->sink_channels *
+		conv_sample_bytes(cd->sink_format);
+	if (cd->sink_period_bytes == 0) {
+		trace_conv_error("conv_params() error: period_bytes = 0");
+		return -EINVAL;
+	}
+
+	dev->frame_bytes = cd->sink_period_bytes / dev->frames;
+
+	sink = list_first_item(&dev->bsink_list, struct comp_buffer,
+			       source_list);
+
+	/* set downstream buffer size */
+	ret = buffer_set_size(sink, cd->sink_period_bytes *
+			      config->periods_sink);
+	if (ret < 0) {
+		trace_conv_error("conv_params() error: "
+				 "buffer_set_size() failed");
+		return ret;
+	}
+
+	return 0;
+}
+
+static int conv_trigger(struct comp_dev *dev, int cmd)
+{
+	trace_conv("conv_trigger()");
+
+	return comp_set_state(dev, cmd);
+}
+
+/* copy and convert stream data from source to sink buffers */
+static int conv_copy(struct comp_dev *dev)
+{
+	struct conv_data *cd = comp_get_drvdata(dev);
+	struct comp_buffer *source;
+	struct comp_buffer *sink;
+
+	tracev_conv("conv_copy()");
+
+	/* converters will only ever have 1 source and 1 sink buffer */
+	source = list_first_item(&dev->bsource_list, struct comp_buffer,
+				 sink_list);
+	sink = list_first_item(&dev->bsink_list, struct comp_buffer,
+			       source_list);
+
+	/* make sure source component buffer has enough data available and that
+	 * the sink component buffer has enough free bytes for copy. Also
+	 * check for XRUNs
+	 */
+	if (comp_buffer_get_avail_bytes(source) < cd->source_period_bytes) {
+		trace_conv_error("conv_copy() error: source component buffer "
+				 "has not enough data available");
+		comp_underrun(dev, source, cd->source_period_bytes, 0);
+		return -EIO;	/* xrun */
+	}
+	if (comp_buffer_get_free_bytes(sink) < cd->sink_period_bytes) {
+		trace_conv_error("conv_copy() error: sink component buffer "
+				 "has not enough free bytes for copy");
+		comp_overrun(dev, sink, cd->sink_period_bytes, 0);
+		return -EIO;	/* xrun */
+	}
+
+	if (cd->source_channels == cd->sink_channels)
+		conv_period(dev, sink, source);
+	else
+		conv_period_remap(dev, sink, source);
+
+	/* calc new free and available */
+	comp_update_buffer_produce(sink, cd->sink_period_bytes);
+	comp_update_buffer_consume(source, cd->source_period_bytes);
+
+	return dev->frames;
+}
+
+static int conv_prepare(struct comp_dev *dev)
+{
+	trace_conv("conv_prepare()");
+
+	return comp_set_state(dev, COMP_TRIGGER_PREPARE);
+}
+
+static int conv_reset(struct comp_dev *dev)
+{
+	trace_conv("conv_reset()");
+
+	comp_set_state(dev, COMP_TRIGGER_RESET);
+	return 0;
+}
+
+static void conv_cache(struct comp_dev *dev, int cmd)
+{
+	struct conv_data *cd;
+
+	switch (cmd) {
+	case COMP_CACHE_WRITEBACK_INV:
+		trace_conv("conv_cache(), COMP_CACHE_WRITEBACK_INV");
+
+		cd = comp_get_drvdata(dev);
+
+		dcache_writeback_invalidate_region(cd, sizeof(*cd));
+		dcache_writeback_invalidate_region(dev, sizeof(*dev));
+		break;
+
+	case COMP_CACHE_INVALIDATE:
+		trace_conv("conv_cache(), COMP_CACHE_INVALIDATE");
+
+		dcache_invalidate_region(dev, sizeof(*dev));
+
+		cd = comp_get_drvdata(dev);
+		dcache_invalidate_region(cd, sizeof(*cd));
+		break;
+	}
+}
+
+struct comp_driver comp_conv = {
+	.type	= SOF_COMP_CONV,
+	.ops	= {
+		.new		= conv_new,
+		.free		= conv_free,
+		.params		= conv_params,
+		.trigger	= conv_trigger,
+		.copy		= conv_copy,
+		.prepare	= conv_prepare,
+		.reset		= conv_reset,
+		.cache		= conv_cache,
+	},
+};
+
+void sys_comp_conv_init(void)
+{
+	comp_register(&comp_conv);
+}
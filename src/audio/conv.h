@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2018, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file audio/conv.h
+ * \brief Format converter component header file
+ */
+
+#ifndef CONV_H
+#define CONV_H
+
+#include <stdint.h>
+#include <sof/audio/component.h>
+#include <sof/audio/format.h>
+
+#define CONFIG_GENERIC
+
+#if defined(__XCC__)
+#include <xtensa/config/core-isa.h>
+
+#if XCHAL_HAVE_HIFI3
+#undef CONFIG_GENERIC
+#endif
+
+#endif
+
+/** \brief Format converter trace function. */
+#define trace_conv(__e, ...) \
+	trace_event(TRACE_CLASS_CONV, __e, ##__VA_ARGS__)
+
+/** \brief Format converter trace value function. */
+#define tracev_conv(__e, ...) \
+	tracev_event(TRACE_CLASS_CONV, __e, ##__VA_ARGS__)
+
+/** \brief Format converter trace error function. */
+#define trace_conv_error(__e, ...) \
+	trace_error(TRACE_CLASS_CONV, __e, ##__VA_ARGS__)
+
+/**
+ * \brief Format converter processing function.
+ *
+ * Converts samples between contiguous (non wrapping) source and sink
+ * regions with the same number of channels.
+ */
+typedef void (*conv_func)(void *dest, const void *src, uint32_t samples);
+
+/** \brief Format converter component private data. */
+struct conv_data {
+	enum sof_ipc_frame source_format;	/**< source frame format */
+	enum sof_ipc_frame sink_format;		/**< sink frame format */
+	uint32_t source_channels;		/**< source channels */
+	uint32_t sink_channels;			/**< sink channels */
+	uint32_t source_period_bytes;		/**< source period bytes */
+	uint32_t sink_period_bytes;		/**< sink period bytes */
+	conv_func conv;				/**< processing function */
+};
+
+/** \brief Format converter processing functions map. */
+struct conv_func_map {
+	uint16_t source;			/**< source frame format */
+	uint16_t sink;				/**< sink frame format */
+	conv_func func;				/**< processing function */
+};
+
+/** \brief Map of format pairs with dedicated processing functions. */
+extern const struct conv_func_map conv_func_map[];
+
+/**
+ * \brief Retrieves format converter processing function.
+ * \param[in] dev Format converter base component device.
+ * \return Processing function for the source and sink formats or NULL.
+ */
+conv_func conv_get_processing_function(struct comp_dev *dev);
+
+/*
+ * Single sample conversions through Q1.31. These are used by the channel
+ * remapping path and for the samples left over by the SIMD kernels, so
+ * both implementations round and saturate exactly the same way.
+ */
+
+static inline int32_t conv_s16_to_q31(int16_t x)
+{
+	return (int32_t)x << 16;
+}
+
+static inline int32_t conv_s24_to_q31(int32_t x)
+{
+	return sign_extend_s24(x) << 8;
+}
+
+static inline int16_t conv_q31_to_s16(int32_t x)
+{
+	return sat_int16((int32_t)(((int64_t)x + (1 << 15)) >> 16));
+}
+
+static inline int32_t conv_q31_to_s24(int32_t x)
+{
+	return sat_int24((int32_t)(((int64_t)x + (1 << 7)) >> 8));
+}
+
+#endif /* CONV_H */
@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2018, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file audio/conv_generic.c
+ * \brief Format converter generic processing implementation
+ */
+
+#include <string.h>
+#include "conv.h"
+
+#ifdef CONFIG_GENERIC
+
+/**
+ * \brief Copies samples of any 16 bit format.
+ * \param[out] dest Sink samples.
+ * \param[in] src Source samples.
+ * \param[in] samples Number of samples.
+ */
+static void conv_copy_16(void *dest, const void *src, uint32_t samples)
+{
+	memcpy(dest, src, samples * sizeof(int16_t));
+}
+
+/**
+ * \brief Copies samples of any 32 bit container format.
+ * \param[out] dest Sink samples.
+ * \param[in] src Source samples.
+ * \param[in] samples Number of samples.
+ */
+static void conv_copy_32(void *dest, const void *src, uint32_t samples)
+{
+	memcpy(dest, src, samples * sizeof(int32_t));
+}
+
+/**
+ * \brief Converts 16 bit samples to 24 bit samples.
+ * \param[out] dest Sink samples.
+ * \param[in] src Source samples.
+ * \param[in] samples Number of samples.
+ */
+static void conv_s16_to_s24(void *dest, const void *src, uint32_t samples)
+{
+	const int16_t *in = src;
+	int32_t *out = dest;
+	uint32_t i;
+
+	for (i = 0; i < samples; i++)
+		out[i] = (int32_t)in[i] << 8;
+}
+
+/**
+ * \brief Converts 16 bit samples to 32 bit samples.
+ * \param[out] dest Sink samples.
+ * \param[in] src Source samples.
+ * \param[in] samples Number of samples.
+ */
+static void conv_s16_to_s32(void *dest, const void *src, uint32_t samples)
+{
+	const int16_t *in = src;
+	int32_t *out = dest;
+	uint32_t i;
+
+	for (i = 0; i < samples; i++)
+		out[i] = conv_s16_to_q31(in[i]);
+}
+
+/**
+ * \brief Converts 24 bit samples to 16 bit samples.
+ * \param[out] dest Sink samples.
+ * \param[in] src Source samples.
+ * \param[in] samples Number of samples.
+ */
+static void conv_s24_to_s16(void *dest, const void *src, uint32_t samples)
+{
+	const int32_t *in = src;
+	int16_t *out = dest;
+	uint32_t i;
+
+	for (i = 0; i < samples; i++)
+		out[i] = conv_q31_to_s16(conv_s24_to_q31(in[i]));
+}
+
+/**
+ * \brief Converts 24 bit samples to 32 bit samples.
+ * \param[out] dest Sink samples.
+ * \param[in] src Source samples.
+ * \param[in] samples Number of samples.
+ */
+static void conv_s24_to_s32(void *dest, const void *src, uint32_t samples)
+{
+	const int32_t *in = src;
+	int32_t *out = dest;
+	uint32_t i;
+
+	for (i = 0; i < samples; i++)
+		out[i] = conv_s24_to_q31(in[i]);
+}
+
+/**
+ * \brief Converts 32 bit samples to 16 bit samples.
+ * \param[out] dest Sink samples.
+ * \param[in] src Source samples.
+ * \param[in] samples Number of samples.
+ */
+static void conv_s32_to_s16(void *dest, const void *src, uint32_t samples)
+{
+	const int32_t *in = src;
+	int16_t *out = dest;
+	uint32_t i;
+
+	for (i = 0; i < samples; i++)
+		out[i] = conv_q31_to_s16(in[i]);
+}
+
+/**
+ * \brief Converts 32 bit samples to 24 bit samples.
+ * \param[out] dest Sink samples.
+ * \param[in] src Source samples.
+ * \param[in] samples Number of samples.
+ */
+static void conv_s32_to_s24(void *dest, const void *src, uint32_t samples)
+{
+	const int32_t *in = src;
+	int32_t *out = dest;
+	uint32_t i;
+
+	for (i = 0; i < samples; i++)
+		out[i] = conv_q31_to_s24(in[i]);
+}
+
+const struct conv_func_map conv_func_map[] = {
+	{SOF_IPC_FRAME_S16_LE, SOF_IPC_FRAME_S16_LE, conv_copy_16},
+	{SOF_IPC_FRAME_S16_LE, SOF_IPC_FRAME_S24_4LE, conv_s16_to_s24},
+	{SOF_IPC_FRAME_S16_LE, SOF_IPC_FRAME_S32_LE, conv_s16_to_s32},
+	{SOF_IPC_FRAME_S24_4LE, SOF_IPC_FRAME_S16_LE, conv_s24_to_s16},
+	{SOF_IPC_FRAME_S24_4LE, SOF_IPC_FRAME_S24_4LE, conv_copy_32},
+	{SOF_IPC_FRAME_S24_4LE, SOF_IPC_FRAME_S32_LE, conv_s24_to_s32},
+	{SOF_IPC_FRAME_S32_LE, SOF_IPC_FRAME_S16_LE, conv_s32_to_s16},
+	{SOF_IPC_FRAME_S32_LE, SOF_IPC_FRAME_S24_4LE, conv_s32_to_s24},
+	{SOF_IPC_FRAME_S32_LE, SOF_IPC_FRAME_S32_LE, conv_copy_32},
+};
+
+conv_func conv_get_processing_function(struct comp_dev *dev)
+{
+	struct conv_data *cd = comp_get_drvdata(dev);
+	int i;
+
+	/* map the conversion function for source and sink formats */
+	for (i = 0; i < ARRAY_SIZE(conv_func_map); i++) {
+		if (cd->source_format == conv_func_map[i].source &&
+		    cd->sink_format == conv_func_map[i].sink)
+			return conv_func_map[i].func;
+	}
+
+	return NULL;
+}
+
+#endif
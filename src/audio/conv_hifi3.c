@@ -0,0 +1,310 @@
+/*
+ * Copyright (c) 2018, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file audio/conv_hifi3.c
+ * \brief Format converter HiFi3 processing implementation
+ */
+
+#include "conv.h"
+
+#if defined(__XCC__) && XCHAL_HAVE_HIFI3
+
+#include <xtensa/tie/xt_hifi3.h>
+
+/*
+ * Samples are converted in 64 bit vectors with unaligned loads/stores,
+ * four samples per loop when either side is 16 bit and two otherwise. Any
+ * remaining samples are converted in C with the same rounding.
+ */
+
+/**
+ * \brief HiFi3 enabled copy of 16 bit samples.
+ * \param[out] dest Sink samples.
+ * \param[in] src Source samples.
+ * \param[in] samples Number of samples.
+ */
+static void conv_copy_16(void *dest, const void *src, uint32_t samples)
+{
+	ae_int16x4 *in = (ae_int16x4 *)src;
+	ae_int16x4 *out = (ae_int16x4 *)dest;
+	ae_valign in_align = AE_LA64_PP(in);
+	ae_valign out_align = AE_ZALIGN64();
+	ae_int16x4 sample = AE_ZERO16();
+	uint32_t i;
+
+	for (i = 0; i < samples >> 2; i++) {
+		AE_LA16X4_IP(sample, in_align, in);
+		AE_SA16X4_IP(sample, out_align, out);
+	}
+
+	AE_SA64POS_FP(out_align, out);
+
+	for (i = samples & ~0x3; i < samples; i++)
+		((int16_t *)dest)[i] = ((const int16_t *)src)[i];
+}
+
+/**
+ * \brief HiFi3 enabled copy of samples in 32 bit containers.
+ * \param[out] dest Sink samples.
+ * \param[in] src Source samples.
+ * \param[in] samples Number of samples.
+ */
+static void conv_copy_32(void *dest, const void *src, uint32_t samples)
+{
+	ae_int32x2 *in = (ae_int32x2 *)src;
+	ae_int32x2 *out = (ae_int32x2 *)dest;
+	ae_valign in_align = AE_LA64_PP(in);
+	ae_valign out_align = AE_ZALIGN64();
+	ae_int32x2 sample = AE_ZERO32();
+	uint32_t i;
+
+	for (i = 0; i < samples >> 1; i++) {
+		AE_LA32X2_IP(sample, in_align, in);
+		AE_SA32X2_IP(sample, out_align, out);
+	}
+
+	AE_SA64POS_FP(out_align, out);
+
+	if (samples & 0x1)
+		((int32_t *)dest)[samples - 1] =
+			((const int32_t *)src)[samples - 1];
+}
+
+/**
+ * \brief HiFi3 enabled widening of 16 bit samples.
+ * \param[out] dest Sink samples.
+ * \param[in] src Source samples.
+ * \param[in] samples Number of samples.
+ * \param[in] shift Left shift of the sign extended samples.
+ */
+static inline void conv_s16_to_sX(void *dest, const void *src,
+				  uint32_t samples, const int shift)
+{
+	const int16_t *in16 = src;
+	int32_t *out32 = dest;
+	ae_int16x4 *in = (ae_int16x4 *)src;
+	ae_int32x2 *out = (ae_int32x2 *)dest;
+	ae_valign in_align = AE_LA64_PP(in);
+	ae_valign out_align = AE_ZALIGN64();
+	ae_int16x4 sample = AE_ZERO16();
+	uint32_t i;
+
+	for (i = 0; i < samples >> 2; i++) {
+		AE_LA16X4_IP(sample, in_align, in);
+		AE_SA32X2_IP(AE_SLAA32(AE_SEXT32X2D16_32(sample), shift),
+			     out_align, out);
+		AE_SA32X2_IP(AE_SLAA32(AE_SEXT32X2D16_10(sample), shift),
+			     out_align, out);
+	}
+
+	AE_SA64POS_FP(out_align, out);
+
+	for (i = samples & ~0x3; i < samples; i++)
+		out32[i] = (int32_t)in16[i] << shift;
+}
+
+/**
+ * \brief HiFi3 enabled narrowing of 32 bit container samples to 16 bit.
+ * \param[out] dest Sink samples.
+ * \param[in] src Source samples.
+ * \param[in] samples Number of samples.
+ * \param[in] shift Right shift of the rounded samples.
+ *
+ * 24 bit samples are sign extended first. Rounding adds half an output
+ * LSB with saturation, so the largest input can't wrap around.
+ */
+static inline void conv_sX_to_s16(void *dest, const void *src,
+				  uint32_t samples, const int shift)
+{
+	const int32_t *in32 = src;
+	int16_t *out16 = dest;
+	ae_int32x2 *in = (ae_int32x2 *)src;
+	ae_int16x4 *out = (ae_int16x4 *)dest;
+	ae_valign in_align = AE_LA64_PP(in);
+	ae_valign out_align = AE_ZALIGN64();
+	ae_int32x2 round = AE_MOVDA32(1 << (shift - 1));
+	ae_int32x2 sample_h = AE_ZERO32();
+	ae_int32x2 sample_l = AE_ZERO32();
+	uint32_t i;
+
+	for (i = 0; i < samples >> 2; i++) {
+		AE_LA32X2_IP(sample_h, in_align, in);
+		AE_LA32X2_IP(sample_l, in_align, in);
+
+		if (shift == 8) {
+			sample_h = AE_SRAI32(AE_SLAI32(sample_h, 8), 8);
+			sample_l = AE_SRAI32(AE_SLAI32(sample_l, 8), 8);
+		}
+
+		sample_h = AE_SRAA32(AE_ADD32S(sample_h, round), shift);
+		sample_l = AE_SRAA32(AE_ADD32S(sample_l, round), shift);
+
+		AE_SA16X4_IP(AE_SAT16X4(sample_h, sample_l), out_align, out);
+	}
+
+	AE_SA64POS_FP(out_align, out);
+
+	for (i = samples & ~0x3; i < samples; i++)
+		out16[i] = shift == 8 ?
+			conv_q31_to_s16(conv_s24_to_q31(in32[i])) :
+			conv_q31_to_s16(in32[i]);
+}
+
+/**
+ * \brief HiFi3 enabled conversion from 16 bit to 24 bit.
+ * \param[out] dest Sink samples.
+ * \param[in] src Source samples.
+ * \param[in] samples Number of samples.
+ */
+static void conv_s16_to_s24(void *dest, const void *src, uint32_t samples)
+{
+	conv_s16_to_sX(dest, src, samples, 8);
+}
+
+/**
+ * \brief HiFi3 enabled conversion from 16 bit to 32 bit.
+ * \param[out] dest Sink samples.
+ * \param[in] src Source samples.
+ * \param[in] samples Number of samples.
+ */
+static void conv_s16_to_s32(void *dest, const void *src, uint32_t samples)
+{
+	conv_s16_to_sX(dest, src, samples, 16);
+}
+
+/**
+ * \brief HiFi3 enabled conversion from 24 bit to 16 bit.
+ * \param[out] dest Sink samples.
+ * \param[in] src Source samples.
+ * \param[in] samples Number of samples.
+ */
+static void conv_s24_to_s16(void *dest, const void *src, uint32_t samples)
+{
+	conv_sX_to_s16(dest, src, samples, 8);
+}
+
+/**
+ * \brief HiFi3 enabled conversion from 32 bit to 16 bit.
+ * \param[out] dest Sink samples.
+ * \param[in] src Source samples.
+ * \param[in] samples Number of samples.
+ */
+static void conv_s32_to_s16(void *dest, const void *src, uint32_t samples)
+{
+	conv_sX_to_s16(dest, src, samples, 16);
+}
+
+/**
+ * \brief HiFi3 enabled conversion from 24 bit to 32 bit.
+ * \param[out] dest Sink samples.
+ * \param[in] src Source samples.
+ * \param[in] samples Number of samples.
+ *
+ * The shift drops the unused top byte, so no sign extension is needed.
+ */
+static void conv_s24_to_s32(void *dest, const void *src, uint32_t samples)
+{
+	ae_int32x2 *in = (ae_int32x2 *)src;
+	ae_int32x2 *out = (ae_int32x2 *)dest;
+	ae_valign in_align = AE_LA64_PP(in);
+	ae_valign out_align = AE_ZALIGN64();
+	ae_int32x2 sample = AE_ZERO32();
+	uint32_t i;
+
+	for (i = 0; i < samples >> 1; i++) {
+		AE_LA32X2_IP(sample, in_align, in);
+		AE_SA32X2_IP(AE_SLAI32(sample, 8), out_align, out);
+	}
+
+	AE_SA64POS_FP(out_align, out);
+
+	if (samples & 0x1)
+		((int32_t *)dest)[samples - 1] =
+			conv_s24_to_q31(((const int32_t *)src)[samples - 1]);
+}
+
+/**
+ * \brief HiFi3 enabled conversion from 32 bit to 24 bit.
+ * \param[out] dest Sink samples.
+ * \param[in] src Source samples.
+ * \param[in] samples Number of samples.
+ *
+ * The saturating rounding add keeps the shifted result within 24 bits.
+ */
+static void conv_s32_to_s24(void *dest, const void *src, uint32_t samples)
+{
+	ae_int32x2 *in = (ae_int32x2 *)src;
+	ae_int32x2 *out = (ae_int32x2 *)dest;
+	ae_valign in_align = AE_LA64_PP(in);
+	ae_valign out_align = AE_ZALIGN64();
+	ae_int32x2 round = AE_MOVDA32(1 << 7);
+	ae_int32x2 sample = AE_ZERO32();
+	uint32_t i;
+
+	for (i = 0; i < samples >> 1; i++) {
+		AE_LA32X2_IP(sample, in_align, in);
+		AE_SA32X2_IP(AE_SRAI32(AE_ADD32S(sample, round), 8),
+			     out_align, out);
+	}
+
+	AE_SA64POS_FP(out_align, out);
+
+	if (samples & 0x1)
+		((int32_t *)dest)[samples - 1] =
+			conv_q31_to_s24(((const int32_t *)src)[samples - 1]);
+}
+
+const struct conv_func_map conv_func_map[] = {
+	{SOF_IPC_FRAME_S16_LE, SOF_IPC_FRAME_S16_LE, conv_copy_16},
+	{SOF_IPC_FRAME_S16_LE, SOF_IPC_FRAME_S24_4LE, conv_s16_to_s24},
+	{SOF_IPC_FRAME_S16_LE, SOF_IPC_FRAME_S32_LE, conv_s16_to_s32},
+	{SOF_IPC_FRAME_S24_4LE, SOF_IPC_FRAME_S16_LE, conv_s24_to_s16},
+	{SOF_IPC_FRAME_S24_4LE, SOF_IPC_FRAME_S24_4LE, conv_copy_32},
+	{SOF_IPC_FRAME_S24_4LE, SOF_IPC_FRAME_S32_LE, conv_s24_to_s32},
+	{SOF_IPC_FRAME_S32_LE, SOF_IPC_FRAME_S16_LE, conv_s32_to_s16},
+	{SOF_IPC_FRAME_S32_LE, SOF_IPC_FRAME_S24_4LE, conv_s32_to_s24},
+	{SOF_IPC_FRAME_S32_LE, SOF_IPC_FRAME_S32_LE, conv_copy_32},
+};
+
+conv_func conv_get_processing_function(struct comp_dev *dev)
+{
+	struct conv_data *cd = comp_get_drvdata(dev);
+	int i;
+
+	/* map the conversion function for source and sink formats */
+	for (i = 0; i < ARRAY_SIZE(conv_func_map); i++) {
+		if (cd->source_format == conv_func_map[i].source &&
+		    cd->sink_format == conv_func_map[i].sink)
+			return conv_func_map[i].func;
+	}
+
+	return NULL;
+}
+
+#endif
@@ -0,0 +1,963 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Seppo Ingalsuo <seppo.ingalsuo@linux.intel.com>
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <errno.h>
+#include <string.h>
+#include <sof/sof.h>
+#include <sof/lock.h>
+#include <sof/list.h>
+#include <sof/stream.h>
+#include <sof/alloc.h>
+#include <sof/ipc.h>
+#include <sof/audio/component.h>
+#include <sof/audio/pipeline.h>
+#include <sof/audio/format.h>
+#include <sof/math/numbers.h>
+#include <uapi/ipc/control.h>
+#include <uapi/user/eq.h>
+#include <uapi/user/crossover.h>
+#include "crossover.h"
+#include "iir.h"
+
+/*
+ * Crossover algorithm code
+ *
+ * The input is read to band 0 in blocks of CROSSOVER_BLOCK_SIZE frames.
+ * Split k filters band k in place to its low band and to band k + 1 that
+ * the next split takes as input, then the all-pass of the split is run
+ * on the bands below k.
+ */
+
+static void crossover_process_block(struct crossover_data *cd, int nch,
+				    int n)
+{
+	struct crossover_split_state *split;
+	int ch;
+	int k;
+	int b;
+
+	for (k = 0; k < cd->num_splits; k++) {
+		split = &cd->split[k];
+		for (ch = 0; ch < nch; ch++) {
+			crossover_split(&split->lowpass[ch],
+					&split->highpass[ch], cd->band[k][ch],
+					cd->band[k][ch], cd->band[k + 1][ch],
+					n);
+
+			if (!split->aligned)
+				continue;
+
+			for (b = 0; b < k; b++)
+				iir_df2t_block(&split->allpass[b][ch],
+					       cd->band[b][ch],
+					       cd->band[b][ch], n);
+		}
+	}
+}
+
+static void crossover_s16_default(struct comp_dev *dev,
+				  struct comp_buffer *source, uint32_t frames)
+{
+	struct crossover_data *cd = comp_get_drvdata(dev);
+	struct crossover_sink *sink;
+	int16_t *x = source->r_ptr;
+	int16_t *y[SOF_CROSSOVER_MAX_BANDS];
+	int nch = cd->channels;
+	int ch;
+	int b;
+	int i;
+	int f;
+	int n;
+
+	for (b = 0; b < cd->num_bands; b++)
+		y[b] = (int16_t *)cd->sink[b].buffer->w_ptr +
+			cd->sink[b].offset;
+
+	for (f = 0; f < frames; f += n) {
+		n = MIN(frames - f, CROSSOVER_BLOCK_SIZE);
+		for (i = 0; i < n; i++) {
+			for (ch = 0; ch < nch; ch++) {
+				cd->band[0][ch][i] = *x << 16;
+				x = buffer_wrap(source, x + 1);
+			}
+		}
+
+		crossover_process_block(cd, nch, n);
+
+		for (b = 0; b < cd->num_bands; b++) {
+			sink = &cd->sink[b];
+			for (i = 0; i < n; i++) {
+				for (ch = 0; ch < nch; ch++) {
+					*y[b] = sat_int16(Q_SHIFT_RND(
+						cd->band[b][ch][i], 31, 15));
+					y[b] = buffer_wrap(sink->buffer,
+							   y[b] + 1);
+				}
+				y[b] = buffer_wrap(sink->buffer,
+						   y[b] + sink->skip);
+			}
+		}
+	}
+}
+
+static void crossover_s24_default(struct comp_dev *dev,
+				  struct comp_buffer *source, uint32_t frames)
+{
+	struct crossover_data *cd = comp_get_drvdata(dev);
+	struct crossover_sink *sink;
+	int32_t *x = source->r_ptr;
+	int32_t *y[SOF_CROSSOVER_MAX_BANDS];
+	int nch = cd->channels;
+	int ch;
+	int b;
+	int i;
+	int f;
+	int n;
+
+	for (b = 0; b < cd->num_bands; b++)
+		y[b] = (int32_t *)cd->sink[b].buffer->w_ptr +
+			cd->sink[b].offset;
+
+	for (f = 0; f < frames; f += n) {
+		n = MIN(frames - f, CROSSOVER_BLOCK_SIZE);
+		for (i = 0; i < n; i++) {
+			for (ch = 0; ch < nch; ch++) {
+				cd->band[0][ch][i] = *x << 8;
+				x = buffer_wrap(source, x + 1);
+			}
+		}
+
+		crossover_process_block(cd, nch, n);
+
+		for (b = 0; b < cd->num_bands; b++) {
+			sink = &cd->sink[b];
+			for (i = 0; i < n; i++) {
+				for (ch = 0; ch < nch; ch++) {
+					*y[b] = sat_int24(Q_SHIFT_RND(
+						cd->band[b][ch][i], 31, 23));
+					y[b] = buffer_wrap(sink->buffer,
+							   y[b] + 1);
+				}
+				y[b] = buffer_wrap(sink->buffer,
+						   y[b] + sink->skip);
+			}
+		}
+	}
+}
+
+static void crossover_s32_default(struct comp_dev *dev,
+				  struct comp_buffer *source, uint32_t frames)
+{
+	struct crossover_data *cd = comp_get_drvdata(dev);
+	struct crossover_sink *sink;
+	int32_t *x = source->r_ptr;
+	int32_t *y[SOF_CROSSOVER_MAX_BANDS];
+	int nch = cd->channels;
+	int ch;
+	int b;
+	int i;
+	int f;
+	int n;
+
+	for (b = 0; b < cd->num_bands; b++)
+		y[b] = (int32_t *)cd->sink[b].buffer->w_ptr +
+			cd->sink[b].offset;
+
+	for (f = 0; f < frames; f += n) {
+		n = MIN(frames - f, CROSSOVER_BLOCK_SIZE);
+		for (i = 0; i < n; i++) {
+			for (ch = 0; ch < nch; ch++) {
+				cd->band[0][ch][i] = *x;
+				x = buffer_wrap(source, x + 1);
+			}
+		}
+
+		crossover_process_block(cd, nch, n);
+
+		for (b = 0; b < cd->num_bands; b++) {
+			sink = &cd->sink[b];
+			for (i = 0; i < n; i++) {
+				for (ch = 0; ch < nch; ch++) {
+					*y[b] = cd->band[b][ch][i];
+					y[b] = buffer_wrap(sink->buffer,
+							   y[b] + 1);
+				}
+				y[b] = buffer_wrap(sink->buffer,
+						   y[b] + sink->skip);
+			}
+		}
+	}
+}
+
+static crossover_func crossover_find_func(enum sof_ipc_frame fmt)
+{
+	switch (fmt) {
+	case SOF_IPC_FRAME_S16_LE:
+		return crossover_s16_default;
+	case SOF_IPC_FRAME_S24_4LE:
+		return crossover_s24_default;
+	case SOF_IPC_FRAME_S32_LE:
+		return crossover_s32_default;
+	default:
+		return NULL;
+	}
+}
+
+/*
+ * Crossover setup code
+ */
+
+static void crossover_free_parameters(struct sof_crossover_config **config)
+{
+	rfree(*config);
+	*config = NULL;
+}
+
+static void crossover_free_state(struct crossover_data *cd)
+{
+	/* The state is owned by the pipeline arena */
+	cd->state = NULL;
+	cd->state_size = 0;
+	cd->num_splits = 0;
+}
+
+/* Check the blob and collect the start of each split response */
+static int crossover_init_lookup(struct crossover_data *cd,
+				 struct sof_crossover_config *config,
+				 struct sof_eq_iir_header_df2t *lookup[])
+{
+	struct sof_eq_iir_header_df2t *eq;
+	struct sof_crossover_split *split;
+	size_t words;
+	size_t j;
+	int i;
+
+	if (config->size < sizeof(*config) ||
+	    config->size > SOF_CROSSOVER_MAX_SIZE) {
+		trace_crossover_error("crossover_init_lookup() error: invalid "
+				      "size %u", config->size);
+		return -EINVAL;
+	}
+
+	if (config->num_bands != cd->num_bands ||
+	    config->number_of_responses > SOF_CROSSOVER_MAX_RESPONSES) {
+		trace_crossover_error("crossover_init_lookup() error: "
+				      "num_bands = %u, number_of_responses = "
+				      "%u", config->num_bands,
+				      config->number_of_responses);
+		return -EINVAL;
+	}
+
+	words = (config->size - sizeof(*config)) / sizeof(int32_t);
+	j = (config->num_bands - 1) * SOF_CROSSOVER_NSPLIT;
+	for (i = 0; i < config->number_of_responses; i++) {
+		if (j + SOF_EQ_IIR_NHEADER_DF2T > words)
+			goto truncated;
+
+		eq = (struct sof_eq_iir_header_df2t *)&config->data[j];
+		lookup[i] = eq;
+		j += SOF_EQ_IIR_NHEADER_DF2T +
+			SOF_EQ_IIR_NBIQUAD_DF2T * eq->num_sections;
+	}
+
+	if (j > words)
+		goto truncated;
+
+	split = (struct sof_crossover_split *)config->data;
+	for (i = 0; i < config->num_bands - 1; i++) {
+		if (split[i].lowpass < 0 || split[i].highpass < 0 ||
+		    split[i].allpass < -1 ||
+		    split[i].lowpass >= (int32_t)config->number_of_responses ||
+		    split[i].highpass >= (int32_t)config->number_of_responses ||
+		    split[i].allpass >= (int32_t)config->number_of_responses) {
+			trace_crossover_error("crossover_init_lookup() error: "
+					      "split %d responses %d %d %d", i,
+					      split[i].lowpass,
+					      split[i].highpass,
+					      split[i].allpass);
+			return -EINVAL;
+		}
+	}
+
+	return 0;
+
+truncated:
+	trace_crossover_error("crossover_init_lookup() error: responses "
+			      "exceed size");
+	return -EINVAL;
+}
+
+/* Set up the coefficients of an IIR, returns its delay line size or 0 */
+static size_t crossover_init_iir(struct iir_state_df2t *iir,
+				 struct sof_eq_iir_header_df2t *response)
+{
+	size_t s;
+
+	if (!response->num_sections_in_series ||
+	    response->num_sections % response->num_sections_in_series) {
+		trace_crossover_error("crossover_init_iir() error: %u "
+				      "sections, %u in series",
+				      response->num_sections,
+				      response->num_sections_in_series);
+		return 0;
+	}
+
+	s = iir_init_coef_df2t(iir, response);
+	return s > SOF_CROSSOVER_MAX_SIZE ? 0 : s;
+}
+
+static int crossover_setup(struct comp_dev *dev, struct crossover_data *cd,
+			   int nch)
+{
+	struct sof_crossover_config *config = cd->config;
+	struct sof_eq_iir_header_df2t *lookup[SOF_CROSSOVER_MAX_RESPONSES];
+	struct sof_crossover_split *split_cfg;
+	struct crossover_split_state *split;
+	void *old_state = cd->state;
+	size_t old_size = cd->state_size;
+	size_t size = 0;
+	size_t s;
+	int64_t *iir_delay;
+	int ret;
+	int ch;
+	int k;
+	int b;
+
+	crossover_free_state(cd);
+
+	if (nch > PLATFORM_MAX_CHANNELS) {
+		trace_crossover_error("crossover_setup() error: channels = %d",
+				      nch);
+		return -EINVAL;
+	}
+
+	ret = crossover_init_lookup(cd, config, lookup);
+	if (ret < 0)
+		return ret;
+
+	/* Initialize IIR coefficients, the delay lines are sized on the way */
+	split_cfg = (struct sof_crossover_split *)config->data;
+	for (k = 0; k < cd->num_bands - 1; k++) {
+		split = &cd->split[k];
+		split->aligned = k > 0 && split_cfg[k].allpass >= 0;
+		for (ch = 0; ch < nch; ch++) {
+			s = crossover_init_iir(&split->lowpass[ch],
+					       lookup[split_cfg[k].lowpass]);
+			if (!s)
+				return -EINVAL;
+
+			size += s;
+			s = crossover_init_iir(&split->highpass[ch],
+					       lookup[split_cfg[k].highpass]);
+			if (!s)
+				return -EINVAL;
+
+			size += s;
+			for (b = 0; split->aligned && b < k; b++) {
+				s = crossover_init_iir(&split->allpass[b][ch],
+						lookup[split_cfg[k].allpass]);
+				if (!s)
+					return -EINVAL;
+
+				size += s;
+			}
+		}
+
+		trace_crossover("crossover_setup(), split = %d, responses = "
+				"%d %d %d", k, split_cfg[k].lowpass,
+				split_cfg[k].highpass, split_cfg[k].allpass);
+	}
+
+	if (old_state && old_size >= size)
+		cd->state = old_state;
+	else
+		cd->state = pipeline_arena_alloc(dev->pipeline, size);
+	if (!cd->state)
+		return -ENOMEM;
+
+	cd->state_size = size;
+	memset(cd->state, 0, size);
+
+	iir_delay = cd->state;
+	for (k = 0; k < cd->num_bands - 1; k++) {
+		split = &cd->split[k];
+		for (ch = 0; ch < nch; ch++) {
+			iir_init_delay_df2t(&split->lowpass[ch], &iir_delay);
+			iir_init_delay_df2t(&split->highpass[ch], &iir_delay);
+			for (b = 0; split->aligned && b < k; b++)
+				iir_init_delay_df2t(&split->allpass[b][ch],
+						    &iir_delay);
+		}
+	}
+
+	cd->num_splits = cd->num_bands - 1;
+	return 0;
+}
+
+/* Without a configuration band 0 passes the input and the rest are silent */
+static void crossover_setup_pass(struct crossover_data *cd)
+{
+	crossover_free_state(cd);
+	memset(cd->band, 0, sizeof(cd->band));
+}
+
+/*
+ * End of crossover setup code. Next the standard component methods.
+ */
+
+static struct comp_dev *crossover_new(struct sof_ipc_comp *comp)
+{
+	struct comp_dev *dev;
+	struct crossover_data *cd;
+	struct sof_ipc_comp_crossover *ipc_crossover =
+		(struct sof_ipc_comp_crossover *)comp;
+	size_t bs = ipc_crossover->size;
+
+	trace_crossover("crossover_new()");
+
+	if (IPC_IS_SIZE_INVALID(ipc_crossover->config)) {
+		IPC_SIZE_ERROR_TRACE(TRACE_CLASS_CROSSOVER,
+				     ipc_crossover->config);
+		return NULL;
+	}
+
+	if (ipc_crossover->num_bands < 2 ||
+	    ipc_crossover->num_bands > SOF_CROSSOVER_MAX_BANDS) {
+		trace_crossover_error("crossover_new() error: num_bands = %u",
+				      ipc_crossover->num_bands);
+		return NULL;
+	}
+
+	if (bs > SOF_CROSSOVER_MAX_SIZE) {
+		trace_crossover_error("crossover_new() error: config blob "
+				      "size = %u > SOF_CROSSOVER_MAX_SIZE",
+				      bs);
+		return NULL;
+	}
+
+	dev = rzalloc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM,
+		      COMP_SIZE(struct sof_ipc_comp_crossover));
+	if (!dev)
+		return NULL;
+
+	memcpy(&dev->comp, comp, sizeof(struct sof_ipc_comp_crossover));
+
+	cd = rzalloc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM, sizeof(*cd));
+	if (!cd) {
+		rfree(dev);
+		return NULL;
+	}
+
+	comp_set_drvdata(dev, cd);
+
+	cd->num_bands = ipc_crossover->num_bands;
+
+	/* Make a copy of the configuration blob. If the crossover is
+	 * configured later in run-time the size is zero.
+	 */
+	if (bs) {
+		cd->config = rzalloc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM, bs);
+		if (!cd->config) {
+			rfree(dev);
+			rfree(cd);
+			return NULL;
+		}
+
+		memcpy(cd->config, ipc_crossover->data, bs);
+	}
+
+	dev->state = COMP_STATE_READY;
+	return dev;
+}
+
+static void crossover_free(struct comp_dev *dev)
+{
+	struct crossover_data *cd = comp_get_drvdata(dev);
+
+	trace_crossover("crossover_free()");
+
+	crossover_free_state(cd);
+	crossover_free_parameters(&cd->config);
+	crossover_free_parameters(&cd->config_new);
+
+	rfree(cd);
+	rfree(dev);
+}
+
+/* Returns 1 if one of the first n bands goes to buffer */
+static int crossover_sink_used(struct crossover_data *cd,
+			       struct comp_buffer *buffer, int n)
+{
+	int b;
+
+	for (b = 0; b < n; b++) {
+		if (cd->sink[b].buffer == buffer)
+			return 1;
+	}
+
+	return 0;
+}
+
+/* Find the sink of each band. With one sink buffer the bands are its
+ * channels and the rest of the walk sees the channels of all bands.
+ */
+static int crossover_params(struct comp_dev *dev)
+{
+	struct sof_ipc_comp_crossover *ipc_crossover =
+		COMP_GET_IPC(dev, sof_ipc_comp_crossover);
+	struct sof_ipc_stream_params *params = &dev->params;
+	struct crossover_data *cd = comp_get_drvdata(dev);
+	struct comp_buffer *sinkb;
+	struct list_item *blist;
+	int nch = params->channels;
+	int b;
+
+	trace_crossover("crossover_params()");
+
+	if (params->direction != SOF_IPC_STREAM_PLAYBACK) {
+		trace_crossover_error("crossover_params() error: capture is "
+				      "not supported");
+		return -EINVAL;
+	}
+
+	cd->num_sinks = 0;
+	memset(cd->sink, 0, sizeof(cd->sink));
+	list_for_item(blist, &dev->bsink_list) {
+		sinkb = container_of(blist, struct comp_buffer, source_list);
+		cd->num_sinks++;
+		for (b = 0; b < cd->num_bands; b++) {
+			if (ipc_crossover->sink_buffer_id[b] ==
+			    sinkb->ipc_buffer.comp.id)
+				cd->sink[b].buffer = sinkb;
+		}
+	}
+
+	if (cd->num_sinks == 1) {
+		sinkb = list_first_item(&dev->bsink_list, struct comp_buffer,
+					source_list);
+		for (b = 0; b < cd->num_bands; b++) {
+			cd->sink[b].buffer = sinkb;
+			cd->sink[b].offset = b * nch;
+			cd->sink[b].skip = (cd->num_bands - 1) * nch;
+		}
+	} else if (cd->num_sinks != cd->num_bands) {
+		trace_crossover_error("crossover_params() error: %d sinks for "
+				      "%d bands", cd->num_sinks,
+				      cd->num_bands);
+		return -EINVAL;
+	}
+
+	/* every band needs a sink buffer of its own */
+	for (b = 0; b < cd->num_bands; b++) {
+		if (!cd->sink[b].buffer ||
+		    (cd->num_sinks > 1 && b > 0 &&
+		     crossover_sink_used(cd, cd->sink[b].buffer, b))) {
+			trace_crossover_error("crossover_params() error: no "
+					      "sink for band %d", b);
+			return -EINVAL;
+		}
+	}
+
+	if (!nch || nch > PLATFORM_MAX_CHANNELS ||
+	    (cd->num_sinks == 1 &&
+	     nch * cd->num_bands > PLATFORM_MAX_CHANNELS)) {
+		trace_crossover_error("crossover_params() error: channels = "
+				      "%d", nch);
+		return -EINVAL;
+	}
+
+	cd->channels = nch;
+	if (cd->num_sinks == 1)
+		params->channels = nch * cd->num_bands;
+
+	return 0;
+}
+
+static int crossover_cmd_get_data(struct comp_dev *dev,
+				  struct sof_ipc_ctrl_data *cdata,
+				  int max_size)
+{
+	struct crossover_data *cd = comp_get_drvdata(dev);
+	size_t bs;
+
+	if (cdata->cmd != SOF_CTRL_CMD_BINARY) {
+		trace_crossover_error("crossover_cmd_get_data() error: "
+				      "invalid cdata->cmd");
+		return -EINVAL;
+	}
+
+	if (!cd->config) {
+		trace_crossover_error("crossover_cmd_get_data() error: no "
+				      "configuration");
+		return -EINVAL;
+	}
+
+	bs = cd->config->size;
+	if (bs > SOF_CROSSOVER_MAX_SIZE || bs == 0 || bs > max_size)
+		return -EINVAL;
+
+	memcpy(cdata->data->data, cd->config, bs);
+	cdata->data->abi = SOF_ABI_VERSION;
+	cdata->data->size = bs;
+
+	return 0;
+}
+
+static int crossover_cmd_set_data(struct comp_dev *dev,
+				  struct sof_ipc_ctrl_data *cdata)
+{
+	struct crossover_data *cd = comp_get_drvdata(dev);
+	struct sof_crossover_config *cfg;
+	struct sof_crossover_config *new_config;
+	struct sof_crossover_config *old_config;
+	uint32_t flags;
+	size_t bs;
+
+	if (SOF_ABI_VERSION_INCOMPATIBLE(SOF_ABI_VERSION, cdata->data->abi)) {
+		trace_crossover_error("crossover_cmd_set_data() error: "
+				      "invalid version");
+		return -EINVAL;
+	}
+
+	if (cdata->cmd != SOF_CTRL_CMD_BINARY) {
+		trace_crossover_error("crossover_cmd_set_data() error: "
+				      "invalid cdata->cmd");
+		return -EINVAL;
+	}
+
+	/* Copy new config, find size from header */
+	cfg = (struct sof_crossover_config *)cdata->data->data;
+	bs = cfg->size;
+	trace_crossover("crossover_cmd_set_data(), blob size = %u", bs);
+	if (bs > SOF_CROSSOVER_MAX_SIZE || bs < sizeof(*cfg)) {
+		trace_crossover_error("crossover_cmd_set_data() error: "
+				      "invalid blob size");
+		return -EINVAL;
+	}
+
+	new_config = rzalloc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM, bs);
+	if (!new_config) {
+		trace_crossover_error("crossover_cmd_set_data() error: "
+				      "alloc failed");
+		return -ENOMEM;
+	}
+
+	memcpy(new_config, cdata->data->data, bs);
+
+	if (dev->state == COMP_STATE_READY) {
+		/* The crossover will be initialized in prepare() */
+		crossover_free_parameters(&cd->config);
+		cd->config = new_config;
+		return 0;
+	}
+
+	/* During playback the new configuration is staged and swapped in by
+	 * copy() at the next period.
+	 */
+	spin_lock_irq(&dev->lock, flags);
+	old_config = cd->config_new;
+	cd->config_new = new_config;
+	spin_unlock_irq(&dev->lock, flags);
+
+	crossover_free_parameters(&old_config);
+	return 0;
+}
+
+/* used to pass standard and bespoke commands (with data) to component */
+static int crossover_cmd(struct comp_dev *dev, int cmd, void *data,
+			 int max_data_size)
+{
+	struct sof_ipc_ctrl_data *cdata = data;
+
+	trace_crossover("crossover_cmd()");
+
+	switch (cmd) {
+	case COMP_CMD_SET_DATA:
+		return crossover_cmd_set_data(dev, cdata);
+	case COMP_CMD_GET_DATA:
+		return crossover_cmd_get_data(dev, cdata, max_data_size);
+	default:
+		trace_crossover_error("crossover_cmd() error: invalid "
+				      "command");
+		return -EINVAL;
+	}
+}
+
+static int crossover_trigger(struct comp_dev *dev, int cmd)
+{
+	trace_crossover("crossover_trigger()");
+
+	return comp_set_state(dev, cmd);
+}
+
+/* Take a configuration staged by crossover_cmd_set_data() into use at the
+ * period boundary. The filters start again from zero state. The old
+ * configuration is restored if the new one fails.
+ */
+static void crossover_apply_config(struct comp_dev *dev)
+{
+	struct crossover_data *cd = comp_get_drvdata(dev);
+	struct sof_crossover_config *config;
+	struct sof_crossover_config *old;
+	uint32_t flags;
+
+	spin_lock_irq(&dev->lock, flags);
+	config = cd->config_new;
+	cd->config_new = NULL;
+	spin_unlock_irq(&dev->lock, flags);
+
+	if (!config)
+		return;
+
+	old = cd->config;
+	cd->config = config;
+	if (crossover_setup(dev, cd, cd->channels) == 0) {
+		crossover_free_parameters(&old);
+		return;
+	}
+
+	trace_crossover_error("crossover_apply_config() error: "
+			      "new configuration failed, keeping old");
+	crossover_free_parameters(&cd->config);
+	cd->config = old;
+	if (!old || crossover_setup(dev, cd, cd->channels) < 0)
+		crossover_setup_pass(cd);
+}
+
+/* copy and process stream data from source to the band sink buffers */
+static int crossover_copy(struct comp_dev *dev)
+{
+	struct crossover_data *cd = comp_get_drvdata(dev);
+	struct comp_buffer *source;
+	struct comp_buffer *sink;
+	int b;
+
+	tracev_crossover("crossover_copy()");
+
+	/* swap in new configuration before processing the period */
+	if (cd->config_new)
+		crossover_apply_config(dev);
+
+	source = list_first_item(&dev->bsource_list, struct comp_buffer,
+				 sink_list);
+
+	/* make sure source component buffer has enough data available and that
+	 * the sink component buffers have enough free bytes for copy. Also
+	 * check for XRUNs
+	 */
+	if (comp_buffer_get_avail_bytes(source) < cd->period_bytes) {
+		trace_crossover_error("crossover_copy() error: source "
+				      "component buffer has not enough data "
+				      "available");
+		comp_underrun(dev, source, cd->period_bytes, 0);
+		return -EIO;	/* xrun */
+	}
+
+	for (b = 0; b < cd->num_sinks; b++) {
+		sink = cd->sink[b].buffer;
+		if (comp_buffer_get_free_bytes(sink) < cd->sink_period_bytes) {
+			trace_crossover_error("crossover_copy() error: sink "
+					      "component buffer has not enough "
+					      "free bytes for copy");
+			comp_overrun(dev, sink, cd->sink_period_bytes, 0);
+			return -EIO;	/* xrun */
+		}
+	}
+
+	cd->crossover_func(dev, source, dev->frames);
+
+	comp_update_buffer_consume(source, cd->period_bytes);
+	for (b = 0; b < cd->num_sinks; b++)
+		comp_update_buffer_produce(cd->sink[b].buffer,
+					   cd->sink_period_bytes);
+
+	return dev->frames;
+}
+
+static int crossover_prepare(struct comp_dev *dev)
+{
+	struct crossover_data *cd = comp_get_drvdata(dev);
+	struct sof_ipc_comp_config *config = COMP_GET_CONFIG(dev);
+	struct comp_buffer *sourceb;
+	struct comp_buffer *sinkb;
+	enum sof_ipc_frame sink_fmt;
+	uint32_t sink_period_bytes;
+	int ret;
+	int b;
+
+	trace_crossover("crossover_prepare()");
+
+	ret = comp_set_state(dev, COMP_TRIGGER_PREPARE);
+	if (ret < 0)
+		return ret;
+
+	sourceb = list_first_item(&dev->bsource_list,
+				  struct comp_buffer, sink_list);
+	comp_set_period_bytes(sourceb->source, dev->frames, &cd->frame_fmt,
+			      &cd->period_bytes);
+	dev->frame_bytes = cd->period_bytes / dev->frames;
+
+	/* the crossover does not convert formats, an interleaved sink has
+	 * the frames of all bands
+	 */
+	cd->sink_period_bytes = cd->num_sinks == 1 ?
+		cd->period_bytes * cd->num_bands : cd->period_bytes;
+	for (b = 0; b < cd->num_sinks; b++) {
+		sinkb = cd->sink[b].buffer;
+		comp_set_period_bytes(sinkb->sink, dev->frames, &sink_fmt,
+				      &sink_period_bytes);
+		if (cd->frame_fmt != sink_fmt ||
+		    cd->sink_period_bytes != sink_period_bytes) {
+			trace_crossover_error("crossover_prepare() error: "
+					      "source_format = %d, "
+					      "sink_format = %d",
+					      cd->frame_fmt, sink_fmt);
+			ret = -EINVAL;
+			goto err;
+		}
+
+		ret = buffer_set_size(sinkb, cd->sink_period_bytes *
+				      config->periods_sink);
+		if (ret < 0) {
+			trace_crossover_error("crossover_prepare() error: "
+					      "buffer_set_size() failed");
+			goto err;
+		}
+	}
+
+	if (cd->config) {
+		ret = crossover_setup(dev, cd, cd->channels);
+		if (ret < 0) {
+			trace_crossover_error("crossover_prepare() error: "
+					      "crossover_setup() failed");
+			goto err;
+		}
+	} else {
+		crossover_setup_pass(cd);
+		trace_crossover("crossover_prepare(), pass-through mode");
+	}
+
+	cd->crossover_func = crossover_find_func(cd->frame_fmt);
+	if (!cd->crossover_func) {
+		trace_crossover_error("crossover_prepare() error: invalid "
+				      "format %d", cd->frame_fmt);
+		ret = -EINVAL;
+		goto err;
+	}
+
+	return 0;
+
+err:
+	comp_set_state(dev, COMP_TRIGGER_RESET);
+	return ret;
+}
+
+static int crossover_reset(struct comp_dev *dev)
+{
+	struct crossover_data *cd = comp_get_drvdata(dev);
+
+	trace_crossover("crossover_reset()");
+
+	crossover_free_state(cd);
+
+	/* A configuration staged while running is used in next prepare() */
+	if (cd->config_new) {
+		crossover_free_parameters(&cd->config);
+		cd->config = cd->config_new;
+		cd->config_new = NULL;
+	}
+
+	comp_set_state(dev, COMP_TRIGGER_RESET);
+	return 0;
+}
+
+static void crossover_cache(struct comp_dev *dev, int cmd)
+{
+	struct crossover_data *cd;
+
+	switch (cmd) {
+	case COMP_CACHE_WRITEBACK_INV:
+		trace_crossover("crossover_cache(), COMP_CACHE_WRITEBACK_INV");
+
+		cd = comp_get_drvdata(dev);
+		if (cd->config)
+			dcache_writeback_invalidate_region(cd->config,
+							   cd->config->size);
+
+		if (cd->state)
+			dcache_writeback_invalidate_region(cd->state,
+							   cd->state_size);
+
+		dcache_writeback_invalidate_region(cd, sizeof(*cd));
+		dcache_writeback_invalidate_region(dev, sizeof(*dev));
+		break;
+
+	case COMP_CACHE_INVALIDATE:
+		trace_crossover("crossover_cache(), COMP_CACHE_INVALIDATE");
+
+		dcache_invalidate_region(dev, sizeof(*dev));
+
+		/* Note: The component data need to be retrieved after
+		 * the dev data has been invalidated.
+		 */
+		cd = comp_get_drvdata(dev);
+		dcache_invalidate_region(cd, sizeof(*cd));
+
+		if (cd->state)
+			dcache_invalidate_region(cd->state, cd->state_size);
+
+		if (cd->config)
+			dcache_invalidate_region(cd->config,
+						 cd->config->size);
+		break;
+	}
+}
+
+struct comp_driver comp_crossover = {
+	.type = SOF_COMP_CROSSOVER,
+	.ops = {
+		.new = crossover_new,
+		.free = crossover_free,
+		.params = crossover_params,
+		.cmd = crossover_cmd,
+		.trigger = crossover_trigger,
+		.copy = crossover_copy,
+		.prepare = crossover_prepare,
+		.reset = crossover_reset,
+		.cache = crossover_cache,
+	},
+};
+
+void sys_comp_crossover_init(void)
+{
+	comp_register(&comp_crossover);
+}
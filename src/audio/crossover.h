@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Seppo Ingalsuo <seppo.ingalsuo@linux.intel.com>
+ */
+
+#ifndef CROSSOVER_H
+#define CROSSOVER_H
+
+#include <stdint.h>
+#include <sof/audio/component.h>
+#include <uapi/user/crossover.h>
+#include "iir.h"
+
+#define trace_crossover(__e, ...) \
+	trace_event(TRACE_CLASS_CROSSOVER, __e, ##__VA_ARGS__)
+#define tracev_crossover(__e, ...) \
+	tracev_event(TRACE_CLASS_CROSSOVER, __e, ##__VA_ARGS__)
+#define trace_crossover_error(__e, ...) \
+	trace_error(TRACE_CLASS_CROSSOVER, __e, ##__VA_ARGS__)
+
+/* Frames per processing block */
+#define CROSSOVER_BLOCK_SIZE 16
+
+/* Filters of one split for all channels */
+struct crossover_split_state {
+	struct iir_state_df2t lowpass[PLATFORM_MAX_CHANNELS];
+	struct iir_state_df2t highpass[PLATFORM_MAX_CHANNELS];
+	/* phase alignment of each lower band */
+	struct iir_state_df2t allpass[SOF_CROSSOVER_MAX_BANDS - 2]
+		[PLATFORM_MAX_CHANNELS];
+	int aligned; /* lower bands go through the all-pass */
+};
+
+/* Where the frames of a band go */
+struct crossover_sink {
+	struct comp_buffer *buffer;
+	uint32_t offset; /* first channel of the band in a sink frame */
+	uint32_t skip; /* channels of the other bands in a sink frame */
+};
+
+/* Processes frames of the source buffer to the band sinks */
+typedef void (*crossover_func)(struct comp_dev *dev,
+			       struct comp_buffer *source, uint32_t frames);
+
+/* Crossover component private data */
+struct crossover_data {
+	/* Q1.31 blocks of the bands, band 0 takes the input */
+	int32_t band[SOF_CROSSOVER_MAX_BANDS][PLATFORM_MAX_CHANNELS]
+		[CROSSOVER_BLOCK_SIZE] __attribute__((aligned(8)));
+	struct crossover_split_state split[SOF_CROSSOVER_MAX_BANDS - 1];
+	struct crossover_sink sink[SOF_CROSSOVER_MAX_BANDS];
+	struct sof_crossover_config *config;
+	struct sof_crossover_config *config_new; /* staged while running */
+	int num_bands;
+	int num_splits; /* 0 sends the input to band 0 only */
+	int num_sinks; /* 1 for bands interleaved in one sink */
+	int channels; /* source channels */
+	void *state; /* all IIR delay lines from pipeline arena */
+	size_t state_size;
+	uint32_t period_bytes; /* source period bytes */
+	uint32_t sink_period_bytes;
+	enum sof_ipc_frame frame_fmt;
+	crossover_func crossover_func;
+};
+
+/* Low and high passes n samples of x, low may be the same buffer as x */
+void crossover_split(struct iir_state_df2t *lowpass,
+		     struct iir_state_df2t *highpass, const int32_t *x,
+		     int32_t *low, int32_t *high, int n);
+
+#endif
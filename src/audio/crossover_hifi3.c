@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Seppo Ingalsuo <seppo.ingalsuo@linux.intel.com>
+ */
+
+#include <stdint.h>
+#include "crossover.h"
+
+#if IIR_HIFI3
+
+/* The low and high pass of a Linkwitz-Riley split have the same structure,
+ * so they run as a pair on the two channel IIR with the same input sample
+ * in both lanes. Other splits run one filter at a time, the high pass
+ * first so the low pass can filter x in place.
+ */
+void crossover_split(struct iir_state_df2t *lowpass,
+		     struct iir_state_df2t *highpass, const int32_t *x,
+		     int32_t *low, int32_t *high, int n)
+{
+	int32_t in;
+	int i;
+
+	if (!iir_df2t_2x_supported(lowpass, highpass)) {
+		iir_df2t_block(highpass, x, high, n);
+		iir_df2t_block(lowpass, x, low, n);
+		return;
+	}
+
+	for (i = 0; i < n; i++) {
+		in = x[i];
+		iir_df2t_2x(lowpass, highpass, in, in, &low[i], &high[i]);
+	}
+}
+
+#endif
@@ -85,6 +85,10 @@ struct dai_data {
 
 	struct dai *dai;
 	struct dma *dma;
+	struct dma_stream stream;	/* placement on the DMAC */
+	uint32_t dma_dir;		/* DMAC request, made at first config */
+	uint32_t dma_caps;
+	uint32_t dma_dev;
 	uint32_t period_bytes;
 	int xrun;		/* true if we are doing xrun recovery */
 	int pointer_init;	/* true if buffer pointer was initialized */
@@ -95,7 +99,17 @@ struct dai_data {
 	uint64_t wallclock;	/* wall clock at stream start */
 };
 
-static void dai_buffer_process(struct comp_dev *dev)
+/*
+ * Timer driven DAI DMA runs without period interrupts and its callback comes
+ * from dw_dma_work(), right before the pipeline is copied synchronously.
+ */
+static inline int dai_is_irqless(struct dai_data *dd)
+{
+	return dd->config.timer_delay && dd->dai->type != SOF_DAI_INTEL_HDA;
+}
+
+/* publish the DMA buffer position for the host to read without IPC */
+static void dai_pos_update(struct comp_dev *dev)
 {
 	struct dai_data *dd = comp_get_drvdata(dev);
 	struct comp_buffer *dma_buffer;
@@ -104,14 +118,35 @@ static void dai_buffer_process(struct comp_dev *dev)
 	if (dev->params.direction == SOF_IPC_STREAM_PLAYBACK) {
 		dma_buffer = list_first_item(&dev->bsource_list,
 					     struct comp_buffer, sink_list);
+		buffer_ptr = dma_buffer->r_ptr;
+	} else {
+		dma_buffer = list_first_item(&dev->bsink_list,
+					     struct comp_buffer, source_list);
+		buffer_ptr = dma_buffer->w_ptr;
+	}
 
-		/* recalc available buffer space */
-		comp_update_buffer_consume(dma_buffer, dd->period_bytes);
+	*dd->dai_pos = dd->dai_pos_blks + buffer_ptr - dma_buffer->addr;
+}
 
-		buffer_ptr = dma_buffer->r_ptr;
+static void dai_buffer_process(struct comp_dev *dev, uint32_t bytes)
+{
+	struct dai_data *dd = comp_get_drvdata(dev);
+	struct comp_buffer *dma_buffer;
+	int irqless = dai_is_irqless(dd);
+
+	/* an irqless pipeline copies next and reports its own xruns, so only
+	 * the buffer and position accounting is left here
+	 */
+	if (dev->params.direction == SOF_IPC_STREAM_PLAYBACK) {
+		dma_buffer = list_first_item(&dev->bsource_list,
+					     struct comp_buffer, sink_list);
+
+		/* recalc available buffer space */
+		comp_update_buffer_consume(dma_buffer, bytes);
 
 		/* make sure there is available bytes for next period */
-		if (dma_buffer->avail < dd->period_bytes) {
+		if (!irqless && comp_buffer_get_avail_bytes(dma_buffer) <
+		    dd->period_bytes) {
 			trace_dai_error_with_ids(dev, "dai_buffer_process() "
 						 "error: Insufficient bytes for"
 						 " next period. "
@@ -123,12 +158,11 @@ static void dai_buffer_process(struct comp_dev *dev)
 					     struct comp_buffer, source_list);
 
 		/* recalc available buffer space */
-		comp_update_buffer_produce(dma_buffer, dd->period_bytes);
-
-		buffer_ptr = dma_buffer->w_ptr;
+		comp_update_buffer_produce(dma_buffer, bytes);
 
 		/* make sure there is free bytes for next period */
-		if (dma_buffer->free < dd->period_bytes) {
+		if (!irqless && comp_buffer_get_free_bytes(dma_buffer) <
+		    dd->period_bytes) {
 			trace_dai_error_with_ids(dev, "dai_buffer_process() "
 						 "error: Insufficient free "
 						 "bytes for next period. "
@@ -138,11 +172,13 @@ static void dai_buffer_process(struct comp_dev *dev)
 	}
 
 	/* update host position (in bytes offset) for drivers */
-	dev->position += dd->period_bytes;
+	dev->position += bytes;
 	if (dd->dai_pos) {
-		dd->dai_pos_blks += dd->period_bytes;
-		*dd->dai_pos = dd->dai_pos_blks +
-			buffer_ptr - dma_buffer->addr;
+		dd->dai_pos_blks += bytes;
+
+		/* irqless DAIs publish it once per copy from dai_copy() */
+		if (!irqless)
+			dai_pos_update(dev);
 	}
 }
 
@@ -152,9 +188,16 @@ static void dai_dma_cb(void *data, uint32_t type, struct dma_sg_elem *next)
 	struct comp_dev *dev = (struct comp_dev *)data;
 	struct dai_data *dd = comp_get_drvdata(dev);
 	struct comp_buffer *dma_buffer;
+	uint32_t bytes = dd->period_bytes;
 
 	tracev_dai_with_ids(dev, "dai_dma_cb()");
 
+	/* several periods completed in one callback */
+	if (type & DMA_IRQ_TYPE_BYTES) {
+		bytes = next->size;
+		next->size = DMA_RELOAD_LLI;
+	}
+
 	/* stop dma copy for pause/stop/xrun */
 	if (dev->state != COMP_STATE_ACTIVE || dd->xrun) {
 
@@ -180,10 +223,19 @@ static void dai_dma_cb(void *data, uint32_t type, struct dma_sg_elem *next)
 		return;
 	}
 
-	dai_buffer_process(dev);
+	dai_buffer_process(dev, bytes);
+
+	/* notify pipeline that DAI needs its buffer processed, timer driven
+	 * DMA reports every period it moved since it was last polled and
+	 * polled DMA already runs from the pipeline task
+	 */
+	if (dev->state != COMP_STATE_ACTIVE || dev->polled)
+		return;
 
-	/* notify pipeline that DAI needs its buffer processed */
-	if (dev->state == COMP_STATE_ACTIVE)
+	if (dev->pipeline->ipc_pipe.timer_delay)
+		pipeline_schedule_periods(dev->pipeline,
+					  MAX(bytes / dd->period_bytes, 1));
+	else
 		pipeline_schedule_copy(dev->pipeline, 0);
 }
 
@@ -193,7 +245,6 @@ static struct comp_dev *dai_new(struct sof_ipc_comp *comp)
 	struct sof_ipc_comp_dai *dai;
 	struct sof_ipc_comp_dai *ipc_dai = (struct sof_ipc_comp_dai *)comp;
 	struct dai_data *dd;
-	uint32_t dir, caps, dma_dev;
 
 	trace_dai("dai_new()");
 
@@ -225,31 +276,30 @@ static struct comp_dev *dai_new(struct sof_ipc_comp *comp)
 		goto error;
 	}
 
-	/* request GP LP DMA with shared access privilege */
+	/* request GP LP DMA with shared access privilege, the DMAC is
+	 * picked at the first config when the stream bandwidth is known
+	 */
 	/* TODO: hda: retrieve req'ed caps from the dai,
 	 * dmas are not cross-compatible.
 	 */
 	switch (dai->type) {
 	case SOF_DAI_INTEL_HDA:
-		dir = dai->direction == SOF_IPC_STREAM_PLAYBACK ?
+		dd->dma_dir = dai->direction == SOF_IPC_STREAM_PLAYBACK ?
 				DMA_DIR_MEM_TO_DEV : DMA_DIR_DEV_TO_MEM;
-		caps = DMA_CAP_HDA;
-		dma_dev = DMA_DEV_HDA;
+		dd->dma_caps = DMA_CAP_HDA;
+		dd->dma_dev = DMA_DEV_HDA;
+		/* link DMA progress is polled from the pipeline task */
+		dev->polled = 1;
 		break;
 	case SOF_DAI_INTEL_SSP:
 	case SOF_DAI_INTEL_DMIC:
 	default:
-		dir = DMA_DIR_MEM_TO_DEV | DMA_DIR_DEV_TO_MEM;
-		caps = DMA_CAP_GP_LP | DMA_CAP_GP_HP;
-		dma_dev = DMA_DEV_SSP | DMA_DEV_DMIC;
+		dd->dma_dir = DMA_DIR_MEM_TO_DEV | DMA_DIR_DEV_TO_MEM;
+		dd->dma_caps = DMA_CAP_GP_LP | DMA_CAP_GP_HP;
+		dd->dma_dev = DMA_DEV_SSP | DMA_DEV_DMIC;
 		break;
 	}
-	dd->dma = dma_get(dir, caps, dma_dev, DMA_ACCESS_SHARED);
-	if (dd->dma == NULL) {
-		trace_dai_error("dai_new() error: dma_get() failed to get "
-				"shared access to DMA.");
-		goto error;
-	}
+	dd->stream.pipeline_id = dai->comp.pipeline_id;
 
 	dma_sg_init(&dd->config.elem_array);
 	dd->dai_pos = NULL;
@@ -271,8 +321,10 @@ static void dai_free(struct comp_dev *dev)
 {
 	struct dai_data *dd = comp_get_drvdata(dev);
 
-	dma_channel_put(dd->dma, dd->chan);
-	dma_put(dd->dma);
+	if (dd->dma) {
+		dma_channel_put(dd->dma, dd->chan);
+		dma_put_stream(dd->dma, &dd->stream);
+	}
 
 	dai_put(dd->dai);
 
@@ -418,6 +470,13 @@ static int dai_params(struct comp_dev *dev)
 		return -EINVAL;
 	}
 
+	/* the DMAC and channel come with the DAI config */
+	if (!dd->dma) {
+		trace_dai_error_with_ids(dev, "dai_params() error: DAI is not "
+					 "configured.");
+		return -EINVAL;
+	}
+
 	/* for DAI, we should configure its frame_fmt from topology */
 	dev->params.frame_fmt = dconfig->frame_fmt;
 
@@ -436,6 +495,10 @@ static int dai_params(struct comp_dev *dev)
 		return -EINVAL;
 	}
 
+	/* replace the bandwidth estimated from the DAI config */
+	dma_stream_update(dd->dma, &dd->stream,
+			  dev->params.rate * dev->frame_bytes);
+
 	if (dev->params.direction == SOF_IPC_STREAM_PLAYBACK) {
 		dma_buffer = list_first_item(&dev->bsource_list,
 			struct comp_buffer, sink_list);
@@ -481,9 +544,14 @@ static int dai_prepare(struct comp_dev *dev)
 			struct comp_buffer, source_list);
 	}
 
-	/* TODO: not sure what this wb is for? */
-	/* write back buffer contents from cache */
-	dcache_writeback_region(dma_buffer->addr, dma_buffer->size);
+	/* write back any core written buffer contents from cache, a DMA
+	 * capable passthrough buffer between host and DAI DMA holds none
+	 * as any buffer_zero() has already written back what it cleared
+	 */
+	if (!(dma_buffer->ipc_buffer.caps & SOF_MEM_CAPS_DMA) ||
+	    !dma_buffer->source->is_dma_connected ||
+	    !dma_buffer->sink->is_dma_connected)
+		dcache_writeback_region(dma_buffer->addr, dma_buffer->size);
 
 	dd->pointer_init = 0;
 
@@ -550,7 +618,11 @@ static void dai_pointer_init(struct comp_dev *dev)
 			break;
 		default:
 			/* advance source pipeline w_ptr by one period
-			 * this places pipeline w_ptr in period before DAI r_ptr */
+			 * this places pipeline w_ptr in period before DAI r_ptr,
+			 * DMA reads that period before anyone writes it so
+			 * it is the only part of the buffer to be silenced */
+			buffer_zero_bytes(dma_buffer, dma_buffer->w_ptr,
+					  dd->period_bytes);
 			comp_update_buffer_produce(dma_buffer, dd->period_bytes);
 			break;
 		}
@@ -580,7 +652,7 @@ static int dai_comp_trigger(struct comp_dev *dev, int cmd)
 		 */
 		else {
 			/* set valid buffer pointer */
-			dai_buffer_process(dev);
+			dai_buffer_process(dev, dd->period_bytes);
 
 			/* recover valid start position */
 			ret = dma_release(dd->dma, dd->chan);
@@ -594,11 +666,11 @@ static int dai_comp_trigger(struct comp_dev *dev, int cmd)
 		 * is populated by the host only then
 		 */
 		if (dd->xrun == 0 && dd->pointer_init != DAI_PTR_INIT_HOST) {
-			/* start the DAI */
-			ret = dma_start(dd->dma, dd->chan);
+			/* start the DAI, with the others of the trigger */
+			ret = dai_group_start(dd->dai, dd->dma, dd->chan, cmd,
+					      dev->params.direction);
 			if (ret < 0)
 				return ret;
-			dai_trigger(dd->dai, cmd, dev->params.direction);
 		} else {
 			dd->xrun = 0;
 		}
@@ -621,18 +693,18 @@ static int dai_comp_trigger(struct comp_dev *dev, int cmd)
 		/* only start the DAI if we are not XRUN handling */
 		if (dd->xrun == 0) {
 			/* set valid buffer pointer */
-			dai_buffer_process(dev);
+			dai_buffer_process(dev, dd->period_bytes);
 
 			/* recover valid start position */
 			ret = dma_release(dd->dma, dd->chan);
 			if (ret < 0)
 				return ret;
 
-			/* start the DAI */
-			ret = dma_start(dd->dma, dd->chan);
+			/* start the DAI, with the others of the trigger */
+			ret = dai_group_start(dd->dai, dd->dma, dd->chan, cmd,
+					      dev->params.direction);
 			if (ret < 0)
 				return ret;
-			dai_trigger(dd->dai, cmd, dev->params.direction);
 		} else {
 			dd->xrun = 0;
 		}
@@ -658,6 +730,40 @@ static int dai_comp_trigger(struct comp_dev *dev, int cmd)
 	return ret;
 }
 
+/* copy every period polled DMA moved since the last pipeline period */
+static int dai_dma_poll(struct comp_dev *dev)
+{
+	struct dai_data *dd = comp_get_drvdata(dev);
+	struct comp_buffer *dma_buffer;
+	uint32_t avail;
+	uint32_t free;
+	uint32_t i;
+	int ret;
+
+	if (dev->params.direction == SOF_IPC_STREAM_PLAYBACK)
+		dma_buffer = list_first_item(&dev->bsource_list,
+					     struct comp_buffer, sink_list);
+	else
+		dma_buffer = list_first_item(&dev->bsink_list,
+					     struct comp_buffer, source_list);
+
+	for (i = 0; i < dma_buffer->size / dd->period_bytes; i++) {
+		ret = dma_get_data_size(dd->dma, dd->chan, &avail, &free);
+		if (ret < 0)
+			return ret;
+
+		if ((dev->params.direction == SOF_IPC_STREAM_PLAYBACK ?
+		     free : avail) < dd->period_bytes)
+			break;
+
+		ret = dma_copy(dd->dma, dd->chan, dd->period_bytes, 0);
+		if (ret < 0)
+			return ret;
+	}
+
+	return 0;
+}
+
 /* copy and process stream data from source to sink buffers */
 static int dai_copy(struct comp_dev *dev)
 {
@@ -673,16 +779,32 @@ static int dai_copy(struct comp_dev *dev)
 		dd->pointer_init = DAI_PTR_INIT_DAI; /* next copy just quits */
 		platform_dai_wallclock(dev, &dd->wallclock);
 	}
+
+	if (dd->dai_pos && dai_is_irqless(dd))
+		dai_pos_update(dev);
+
+	if (dev->polled)
+		return dai_dma_poll(dev);
+
 	return 0;
 }
 
 static int dai_position(struct comp_dev *dev, struct sof_ipc_stream_posn *posn)
 {
 	struct dai_data *dd = comp_get_drvdata(dev);
+	uint32_t avail;
+	uint32_t free;
 
-	/* TODO: improve accuracy by adding current DMA position */
 	posn->dai_posn = dev->position;
 
+	/* irqless DMA can lag a whole timer tick, so add what the hardware
+	 * moved since the last callback
+	 */
+	if (dai_is_irqless(dd) && dev->state == COMP_STATE_ACTIVE &&
+	    !dma_get_data_size(dd->dma, dd->chan, &avail, &free))
+		posn->dai_posn += dev->params.direction ==
+			SOF_IPC_STREAM_PLAYBACK ? free : avail;
+
 	/* set stream start wallclock */
 	posn->wallclock = dd->wallclock;
 
@@ -692,6 +814,7 @@ static int dai_position(struct comp_dev *dev, struct sof_ipc_stream_posn *posn)
 static int dai_config(struct comp_dev *dev, struct sof_ipc_dai_config *config)
 {
 	struct dai_data *dd = comp_get_drvdata(dev);
+	uint32_t rate = 0;
 	int channel = 0;
 
 	trace_dai("config comp %d pipe %d dai %d type %d", dev->comp.id,
@@ -713,6 +836,7 @@ static int dai_config(struct comp_dev *dev, struct sof_ipc_dai_config *config)
 		default:
 			break;
 		}
+		rate = config->ssp.fsync_rate;
 		break;
 	case SOF_DAI_INTEL_DMIC:
 		/* The frame bytes setting follows only FIFO A setting in
@@ -753,6 +877,7 @@ static int dai_config(struct comp_dev *dev, struct sof_ipc_dai_config *config)
 				   config->dmic.pdm[0].enable_mic_b);
 		trace_dai_with_ids(dev, "dai_config(), dev->frame_bytes = %u",
 				   dev->frame_bytes);
+		rate = config->dmic.fifo_fs_a;
 		break;
 	case SOF_DAI_INTEL_HDA:
 		/* set to some non-zero value to satisfy the condition below,
@@ -778,8 +903,20 @@ static int dai_config(struct comp_dev *dev, struct sof_ipc_dai_config *config)
 		return -EINVAL;
 	}
 
+	/* get dma and its channel at first config only */
+	if (!dd->dma) {
+		dd->stream.bandwidth = rate * dev->frame_bytes;
+		dd->dma = dma_get_stream(dd->dma_dir, dd->dma_caps,
+					 dd->dma_dev, &dd->stream);
+		if (!dd->dma) {
+			trace_dai_error_with_ids(dev, "dai_config() error: "
+						 "dma_get_stream() failed to "
+						 "get shared access to DMA.");
+			return -ENODEV;
+		}
+	}
+
 	if (dd->chan == DMA_CHAN_INVALID)
-		/* get dma channel at first config only */
 		dd->chan = dma_channel_get(dd->dma, channel);
 
 	if (dd->chan < 0) {
@@ -810,7 +947,9 @@ static void dai_cache(struct comp_dev *dev, int cmd)
 		dma_sg_cache_wb_inv(&dd->config.elem_array);
 
 		dcache_writeback_invalidate_region(dd->dai, sizeof(*dd->dai));
-		dcache_writeback_invalidate_region(dd->dma, sizeof(*dd->dma));
+		if (dd->dma)
+			dcache_writeback_invalidate_region(dd->dma,
+							   sizeof(*dd->dma));
 		dcache_writeback_invalidate_region(dd, sizeof(*dd));
 		dcache_writeback_invalidate_region(dev, sizeof(*dev));
 		break;
@@ -822,7 +961,8 @@ static void dai_cache(struct comp_dev *dev, int cmd)
 
 		dd = comp_get_drvdata(dev);
 		dcache_invalidate_region(dd, sizeof(*dd));
-		dcache_invalidate_region(dd->dma, sizeof(*dd->dma));
+		if (dd->dma)
+			dcache_invalidate_region(dd->dma, sizeof(*dd->dma));
 		dcache_invalidate_region(dd->dai, sizeof(*dd->dai));
 
 		dma_sg_cache_inv(&dd->config.elem_array);
@@ -0,0 +1,493 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Liam Girdwood <liam.r.girdwood@linux.intel.com>
+ */
+
+/**
+ * \file audio/decoder.c
+ * \brief Compressed offload decoder component implementation
+ *
+ * The decoder sits behind the host component of a playback pipeline and
+ * turns the compressed stream copied in by host DMA into PCM for the rest
+ * of the pipeline, so the host only has to wake up to refill its ring of
+ * compressed data. Compressed bytes are staged linearly for the codec,
+ * which decodes whole frames into a PCM stage that is drained one pipeline
+ * period per copy. Codec frame and pipeline period sizes are independent,
+ * so the pipeline can run with the long periods of a deep buffer. Codec
+ * libraries plug in through codec_register(); a PCM passthrough codec is
+ * built in for validation.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <errno.h>
+#include <sof/sof.h>
+#include <sof/lock.h>
+#include <sof/list.h>
+#include <sof/stream.h>
+#include <sof/alloc.h>
+#include <sof/ipc.h>
+#include <sof/audio/component.h>
+#include <sof/audio/codec.h>
+#include "decoder.h"
+
+struct codec_data {
+	struct list_item list;		/* list of codecs */
+	spinlock_t lock;
+};
+
+static struct codec_data *codecs;
+
+static struct codec_driver *decoder_get_codec(uint32_t id)
+{
+	struct list_item *clist;
+	struct codec_driver *drv = NULL;
+
+	spin_lock(&codecs->lock);
+
+	list_for_item(clist, &codecs->list) {
+		drv = container_of(clist, struct codec_driver, list);
+		if (drv->id == id)
+			goto out;
+	}
+
+	/* not found */
+	drv = NULL;
+
+out:
+	spin_unlock(&codecs->lock);
+	return drv;
+}
+
+int codec_register(struct codec_driver *drv)
+{
+	if (decoder_get_codec(drv->id)) {
+		trace_decoder_error("codec_register() error: codec %u is "
+				    "already registered", drv->id);
+		return -EEXIST;
+	}
+
+	spin_lock(&codecs->lock);
+	list_item_prepend(&drv->list, &codecs->list);
+	spin_unlock(&codecs->lock);
+
+	return 0;
+}
+
+void codec_unregister(struct codec_driver *drv)
+{
+	spin_lock(&codecs->lock);
+	list_item_del(&drv->list);
+	spin_unlock(&codecs->lock);
+}
+
+/* PCM passthrough codec, a "frame" is up to DECODER_PCM_FRAMES frames */
+struct pcm_codec {
+	uint32_t frame_bytes;
+};
+
+static int pcm_codec_init(void **priv, const struct codec_params *params)
+{
+	struct pcm_codec *pcm;
+
+	if (!params->channels || !params->sample_bytes)
+		return -EINVAL;
+
+	pcm = rzalloc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM, sizeof(*pcm));
+	if (!pcm)
+		return -ENOMEM;
+
+	pcm->frame_bytes = params->channels * params->sample_bytes;
+	*priv = pcm;
+	return 0;
+}
+
+static int pcm_codec_decode(void *priv, const void *in, uint32_t in_bytes,
+			    uint32_t *consumed, void *out, uint32_t out_bytes,
+			    uint32_t *produced)
+{
+	struct pcm_codec *pcm = priv;
+	uint32_t bytes = MIN(in_bytes, out_bytes);
+
+	bytes = MIN(bytes, DECODER_PCM_FRAMES * pcm->frame_bytes);
+	bytes -= bytes % pcm->frame_bytes;
+
+	*consumed = bytes;
+	*produced = bytes;
+
+	if (!bytes)
+		return -ENODATA;
+
+	memcpy(out, in, bytes);
+	return 0;
+}
+
+static void pcm_codec_free(void *priv)
+{
+	rfree(priv);
+}
+
+static struct codec_driver codec_pcm = {
+	.id = SOF_IPC_CODEC_PCM,
+	.max_frame_bytes = DECODER_PCM_FRAMES * sizeof(int32_t) *
+		SOF_IPC_MAX_CHANNELS,
+	.max_frame_samples = DECODER_PCM_FRAMES,
+	.ops = {
+		.init = pcm_codec_init,
+		.decode = pcm_codec_decode,
+		.free = pcm_codec_free,
+	},
+};
+
+static void decoder_free_stage(struct decoder_stage *stage)
+{
+	rfree(stage->addr);
+	stage->addr = NULL;
+	stage->size = 0;
+	stage->r = 0;
+	stage->w = 0;
+}
+
+static int decoder_alloc_stage(struct decoder_stage *stage, uint32_t size)
+{
+	stage->addr = rballoc(RZONE_BUFFER, SOF_MEM_CAPS_RAM, size);
+	if (!stage->addr) {
+		trace_decoder_error("decoder_alloc_stage() error: no memory "
+				    "for %u bytes", size);
+		return -ENOMEM;
+	}
+
+	stage->size = size;
+	stage->r = 0;
+	stage->w = 0;
+	return 0;
+}
+
+/* frees the codec instance and the stages */
+static void decoder_release(struct decoder_data *cd)
+{
+	if (cd->codec_priv) {
+		cd->codec->ops.free(cd->codec_priv);
+		cd->codec_priv = NULL;
+	}
+
+	decoder_free_stage(&cd->in);
+	decoder_free_stage(&cd->out);
+}
+
+static struct comp_dev *decoder_new(struct sof_ipc_comp *comp)
+{
+	struct comp_dev *dev;
+	struct sof_ipc_comp_decoder *ipc_dec =
+		(struct sof_ipc_comp_decoder *)comp;
+	struct decoder_data *cd;
+	struct codec_driver *codec;
+
+	trace_decoder("decoder_new()");
+
+	if (IPC_IS_SIZE_INVALID(ipc_dec->config)) {
+		IPC_SIZE_ERROR_TRACE(TRACE_CLASS_DECODER, ipc_dec->config);
+		return NULL;
+	}
+
+	codec = decoder_get_codec(ipc_dec->codec_id);
+	if (!codec) {
+		trace_decoder_error("decoder_new() error: codec %u is not "
+				    "registered", ipc_dec->codec_id);
+		return NULL;
+	}
+
+	dev = rzalloc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM,
+		      COMP_SIZE(struct sof_ipc_comp_decoder));
+	if (!dev)
+		return NULL;
+
+	memcpy(&dev->comp, comp, sizeof(struct sof_ipc_comp_decoder));
+
+	cd = rzalloc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM, sizeof(*cd));
+	if (!cd) {
+		rfree(dev);
+		return NULL;
+	}
+
+	comp_set_drvdata(dev, cd);
+	cd->codec = codec;
+
+	dev->state = COMP_STATE_READY;
+	return dev;
+}
+
+static void decoder_free(struct comp_dev *dev)
+{
+	struct decoder_data *cd = comp_get_drvdata(dev);
+
+	trace_decoder("decoder_free()");
+
+	decoder_release(cd);
+
+	rfree(cd);
+	rfree(dev);
+}
+
+/* set component audio stream parameters */
+static int decoder_params(struct comp_dev *dev)
+{
+	trace_decoder("decoder_params()");
+
+	/* All configuration work is postponed to prepare(). */
+	return 0;
+}
+
+static int decoder_cmd(struct comp_dev *dev, int cmd, void *data,
+		       int max_data_size)
+{
+	trace_decoder("decoder_cmd()");
+
+	return 0;
+}
+
+static int decoder_trigger(struct comp_dev *dev, int cmd)
+{
+	trace_decoder("decoder_trigger()");
+
+	return comp_set_state(dev, cmd);
+}
+
+/* tops up the input stage with as much of the source as it can hold */
+static void decoder_refill(struct decoder_data *cd, struct comp_buffer *source)
+{
+	uint32_t bytes;
+
+	decoder_stage_compact(&cd->in);
+
+	bytes = MIN(comp_buffer_get_avail_bytes(source),
+		    cd->in.size - cd->in.w);
+	if (!bytes)
+		return;
+
+	decoder_stage_fill(&cd->in, source, bytes);
+	comp_update_buffer_consume(source, bytes);
+}
+
+/*
+ * Decodes frames until a period of PCM is staged and moves it to the sink.
+ * Running out of compressed data is not an xrun, the host may be at the
+ * end of the stream, so the period is completed with silence instead.
+ */
+static int decoder_copy(struct comp_dev *dev)
+{
+	struct decoder_data *cd = comp_get_drvdata(dev);
+	struct comp_buffer *source;
+	struct comp_buffer *sink;
+	uint32_t consumed;
+	uint32_t produced;
+	uint32_t level;
+	int ret;
+
+	tracev_decoder("decoder_copy()");
+
+	source = list_first_item(&dev->bsource_list, struct comp_buffer,
+				 sink_list);
+	sink = list_first_item(&dev->bsink_list, struct comp_buffer,
+			       source_list);
+
+	/* wait for the sink to have room for a period */
+	if (comp_buffer_get_free_bytes(sink) < cd->period_bytes)
+		return 0;
+
+	while (decoder_stage_level(&cd->out) < cd->period_bytes) {
+		decoder_refill(cd, source);
+		decoder_stage_compact(&cd->out);
+
+		ret = cd->codec->ops.decode(cd->codec_priv,
+					    cd->in.addr + cd->in.r,
+					    decoder_stage_level(&cd->in),
+					    &consumed,
+					    cd->out.addr + cd->out.w,
+					    cd->out.size - cd->out.w,
+					    &produced);
+		if (ret == -ENODATA)
+			break;
+
+		if (ret < 0) {
+			trace_decoder_error("decoder_copy() error: decode "
+					    "failed, ret = %d", ret);
+			/* skip what was rejected, or all to resync */
+			cd->in.r = consumed ? cd->in.r + consumed : cd->in.w;
+			break;
+		}
+
+		cd->in.r += consumed;
+		cd->out.w += produced;
+
+		/* a codec making no progress would spin here */
+		if (!consumed && !produced)
+			break;
+	}
+
+	level = decoder_stage_level(&cd->out);
+	if (level < cd->period_bytes) {
+		tracev_decoder("decoder_copy(), %u bytes of silence",
+			       cd->period_bytes - level);
+		decoder_stage_compact(&cd->out);
+		memset(cd->out.addr + cd->out.w, 0, cd->period_bytes - level);
+		cd->out.w += cd->period_bytes - level;
+	}
+
+	decoder_stage_drain(&cd->out, sink, cd->period_bytes);
+	comp_update_buffer_produce(sink, cd->period_bytes);
+
+	return dev->frames;
+}
+
+static int decoder_prepare(struct comp_dev *dev)
+{
+	struct decoder_data *cd = comp_get_drvdata(dev);
+	struct codec_driver *codec = cd->codec;
+	struct codec_params params;
+	uint32_t out_size;
+	int ret;
+
+	trace_decoder("decoder_prepare()");
+
+	ret = comp_set_state(dev, COMP_TRIGGER_PREPARE);
+	if (ret < 0)
+		return ret;
+
+	dev->frame_bytes = comp_frame_bytes(dev);
+	cd->period_bytes = dev->frames * dev->frame_bytes;
+	if (!cd->period_bytes) {
+		trace_decoder_error("decoder_prepare() error: frame_fmt = %d, "
+				    "channels = %u", dev->params.frame_fmt,
+				    dev->params.channels);
+		ret = -EINVAL;
+		goto err;
+	}
+
+	/* a prepare after a stream stop starts decoding afresh */
+	decoder_release(cd);
+
+	/* room for a whole decoded frame on top of a partial period */
+	out_size = codec->max_frame_samples * dev->frame_bytes +
+		cd->period_bytes;
+
+	ret = decoder_alloc_stage(&cd->in,
+				  codec->max_frame_bytes * DECODER_IN_FRAMES);
+	if (ret < 0)
+		goto err;
+
+	ret = decoder_alloc_stage(&cd->out, out_size);
+	if (ret < 0)
+		goto err;
+
+	params.channels = dev->params.channels;
+	params.rate = dev->params.rate;
+	params.sample_bytes = comp_sample_bytes(dev);
+
+	ret = codec->ops.init(&cd->codec_priv, &params);
+	if (ret < 0) {
+		trace_decoder_error("decoder_prepare() error: codec %u init "
+				    "failed", codec->id);
+		cd->codec_priv = NULL;
+		goto err;
+	}
+
+	trace_decoder("decoder_prepare(), codec = %u, period_bytes = %u",
+		      codec->id, cd->period_bytes);
+
+	return 0;
+
+err:
+	decoder_release(cd);
+	comp_set_state(dev, COMP_TRIGGER_RESET);
+	return ret;
+}
+
+static int decoder_reset(struct comp_dev *dev)
+{
+	struct decoder_data *cd = comp_get_drvdata(dev);
+
+	trace_decoder("decoder_reset()");
+
+	decoder_release(cd);
+
+	comp_set_state(dev, COMP_TRIGGER_RESET);
+	return 0;
+}
+
+static void decoder_cache(struct comp_dev *dev, int cmd)
+{
+	struct decoder_data *cd;
+
+	switch (cmd) {
+	case COMP_CACHE_WRITEBACK_INV:
+		trace_decoder("decoder_cache(), COMP_CACHE_WRITEBACK_INV");
+
+		cd = comp_get_drvdata(dev);
+		dcache_writeback_invalidate_region(cd, sizeof(*cd));
+		dcache_writeback_invalidate_region(dev, sizeof(*dev));
+		break;
+
+	case COMP_CACHE_INVALIDATE:
+		trace_decoder("decoder_cache(), COMP_CACHE_INVALIDATE");
+
+		dcache_invalidate_region(dev, sizeof(*dev));
+
+		/* Note: The component data need to be retrieved after
+		 * the dev data has been invalidated.
+		 */
+		cd = comp_get_drvdata(dev);
+		dcache_invalidate_region(cd, sizeof(*cd));
+		break;
+	}
+}
+
+struct comp_driver comp_decoder = {
+	.type = SOF_COMP_DECODER,
+	.ops = {
+		.new = decoder_new,
+		.free = decoder_free,
+		.params = decoder_params,
+		.cmd = decoder_cmd,
+		.trigger = decoder_trigger,
+		.copy = decoder_copy,
+		.prepare = decoder_prepare,
+		.reset = decoder_reset,
+		.cache = decoder_cache,
+	},
+};
+
+void sys_comp_decoder_init(void)
+{
+	codecs = rzalloc(RZONE_SYS, SOF_MEM_CAPS_RAM, sizeof(*codecs));
+	list_init(&codecs->list);
+	spinlock_init(&codecs->lock);
+
+	comp_register(&comp_decoder);
+	codec_register(&codec_pcm);
+}
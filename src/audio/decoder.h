@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Liam Girdwood <liam.r.girdwood@linux.intel.com>
+ */
+
+/**
+ * \file audio/decoder.h
+ * \brief Compressed offload decoder component header file
+ */
+
+#ifndef DECODER_H
+#define DECODER_H
+
+#include <stdint.h>
+#include <string.h>
+#include <sof/audio/component.h>
+#include <sof/audio/codec.h>
+
+/** \brief Decoder trace function. */
+#define trace_decoder(__e, ...) \
+	trace_event(TRACE_CLASS_DECODER, __e, ##__VA_ARGS__)
+
+/** \brief Decoder trace value function. */
+#define tracev_decoder(__e, ...) \
+	tracev_event(TRACE_CLASS_DECODER, __e, ##__VA_ARGS__)
+
+/** \brief Decoder trace error function. */
+#define trace_decoder_error(__e, ...) \
+	trace_error(TRACE_CLASS_DECODER, __e, ##__VA_ARGS__)
+
+/** \brief Compressed frames held by the input stage. */
+#define DECODER_IN_FRAMES	2
+
+/** \brief PCM frames per passthrough codec frame. */
+#define DECODER_PCM_FRAMES	128
+
+/** \brief Linear staging buffer, codecs never see a ring wrap. */
+struct decoder_stage {
+	uint8_t *addr;		/**< stage base */
+	uint32_t size;		/**< stage size in bytes */
+	uint32_t r;		/**< read offset */
+	uint32_t w;		/**< write offset */
+};
+
+/** \brief Decoder component private data. */
+struct decoder_data {
+	struct codec_driver *codec;	/**< codec library */
+	void *codec_priv;		/**< codec instance, NULL if none */
+	struct decoder_stage in;	/**< compressed frames */
+	struct decoder_stage out;	/**< decoded PCM */
+	uint32_t period_bytes;		/**< sink period bytes */
+};
+
+/**
+ * \brief Returns bytes held by a stage.
+ * \param[in] stage Staging buffer.
+ */
+static inline uint32_t decoder_stage_level(struct decoder_stage *stage)
+{
+	return stage->w - stage->r;
+}
+
+/**
+ * \brief Moves the held bytes to the stage base so that all free space
+ *	  follows them.
+ * \param[in,out] stage Staging buffer.
+ */
+static inline void decoder_stage_compact(struct decoder_stage *stage)
+{
+	uint32_t level = decoder_stage_level(stage);
+
+	if (!stage->r)
+		return;
+
+	memmove(stage->addr, stage->addr + stage->r, level);
+	stage->r = 0;
+	stage->w = level;
+}
+
+/**
+ * \brief Appends bytes from the source read pointer to the stage.
+ * \param[in,out] stage Staging buffer.
+ * \param[in] source Source buffer, not consumed.
+ * \param[in] bytes Bytes to append, at most the space after w.
+ */
+static inline void decoder_stage_fill(struct decoder_stage *stage,
+				      struct comp_buffer *source,
+				      uint32_t bytes)
+{
+	void *src = source->r_ptr;
+	uint32_t n;
+
+	while (bytes) {
+		n = MIN(bytes, buffer_bytes_to_wrap(source, src));
+		memcpy(stage->addr + stage->w, src, n);
+		src = buffer_wrap(source, (char *)src + n);
+		stage->w += n;
+		bytes -= n;
+	}
+}
+
+/**
+ * \brief Moves the oldest bytes of the stage to the sink write pointer.
+ * \param[in,out] stage Staging buffer.
+ * \param[in,out] sink Sink buffer, not produced.
+ * \param[in] bytes Bytes to move, at most the stage level.
+ */
+static inline void decoder_stage_drain(struct decoder_stage *stage,
+				       struct comp_buffer *sink,
+				       uint32_t bytes)
+{
+	void *dst = sink->w_ptr;
+	uint32_t n;
+
+	while (bytes) {
+		n = MIN(bytes, buffer_bytes_to_wrap(sink, dst));
+		memcpy(dst, stage->addr + stage->r, n);
+		dst = buffer_wrap(sink, (char *)dst + n);
+		stage->r += n;
+		bytes -= n;
+	}
+
+	if (stage->r == stage->w) {
+		stage->r = 0;
+		stage->w = 0;
+	}
+}
+
+#endif /* DECODER_H */
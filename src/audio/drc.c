@@ -0,0 +1,928 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Seppo Ingalsuo <seppo.ingalsuo@linux.intel.com>
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <errno.h>
+#include <string.h>
+#include <sof/sof.h>
+#include <sof/lock.h>
+#include <sof/list.h>
+#include <sof/stream.h>
+#include <sof/alloc.h>
+#include <sof/ipc.h>
+#include <sof/audio/component.h>
+#include <sof/audio/pipeline.h>
+#include <sof/audio/format.h>
+#include <sof/math/numbers.h>
+#include <sof/math/fixed.h>
+#include <uapi/ipc/control.h>
+#include <uapi/user/eq.h>
+#include <uapi/user/drc.h>
+#include "drc.h"
+#include "iir.h"
+
+#define LOG2_E_Q2_30 1549082005 /* log2(e) */
+
+/* Peaks below this Q1.31 level (about -96 dB) are not compressed */
+#define DRC_PEAK_SHIFT 15
+
+/*
+ * DRC algorithm code
+ *
+ * Each band is split from the input with an IIR response, delayed by the
+ * look-ahead and scaled with a gain computed once per DRC_BLOCK_SIZE
+ * frames from the peak of all channels. The gain moves linearly across
+ * the block and the output is the sum of the bands.
+ */
+
+/* Swaps n samples of x with the delay line from position idx */
+static void drc_delay(int32_t *line, int length, int idx, int32_t *x, int n)
+{
+	int32_t tmp;
+	int i;
+
+	for (i = 0; i < n; i++) {
+		tmp = line[idx];
+		line[idx] = x[i];
+		x[i] = tmp;
+		if (++idx == length)
+			idx = 0;
+	}
+}
+
+/* Static curve and attack/release smoothing, returns Q2.30 linear gain */
+static int32_t drc_band_gain(struct drc_band_state *band, int32_t peak)
+{
+	int32_t level = peak >> DRC_PEAK_SHIFT; /* Q1.31 to Q16.16 */
+	int32_t target = 0;
+	int32_t over;
+	int32_t alpha;
+
+	if (level > 0) {
+		over = lin2db_fixed(level) - band->threshold;
+		if (over > 0)
+			target = -q_multsr_sat_32x32(over, band->slope, 16);
+	}
+
+	alpha = target < band->gain_db ? band->attack : band->release;
+	band->gain_db += q_multsr_sat_32x32(target - band->gain_db, alpha, 16);
+
+	return sat_int32((int64_t)db2lin_fixed(band->gain_db +
+					       band->makeup_gain) << 14);
+}
+
+static void drc_band_process(struct drc_data *cd, struct drc_band_state *band,
+			     int nch, int n)
+{
+	int32_t peak = 0;
+	int32_t gain;
+	int32_t step;
+	int ch;
+	int i;
+
+	for (ch = 0; ch < nch; ch++) {
+		iir_df2t_block(&band->iir[ch], cd->in[ch], cd->buf[ch], n);
+		peak = drc_peak(cd->buf[ch], n, peak);
+		if (cd->lookahead)
+			drc_delay(band->delay + ch * cd->lookahead,
+				  cd->lookahead, cd->delay_idx, cd->buf[ch], n);
+	}
+
+	/* The delayed block and all blocks after it set the gain */
+	band->peak[cd->peak_idx] = peak;
+	for (i = 0; i <= cd->lookahead_blocks; i++)
+		peak = MAX(peak, band->peak[i]);
+
+	gain = drc_band_gain(band, peak);
+	step = (gain - band->gain) / n;
+
+	for (ch = 0; ch < nch; ch++)
+		drc_gain_acc(cd->buf[ch], cd->out[ch], n, band->gain, step);
+
+	band->gain = gain;
+}
+
+/* Processes n <= DRC_BLOCK_SIZE frames from cd->in to cd->out */
+static void drc_process_block(struct drc_data *cd, int nch, int n)
+{
+	int ch;
+	int b;
+
+	for (ch = 0; ch < nch; ch++)
+		memset(cd->out[ch], 0, n * sizeof(int32_t));
+
+	for (b = 0; b < cd->num_bands; b++)
+		drc_band_process(cd, &cd->band[b], nch, n);
+
+	if (cd->lookahead) {
+		cd->delay_idx += n;
+		if (cd->delay_idx >= cd->lookahead)
+			cd->delay_idx -= cd->lookahead;
+	}
+
+	if (++cd->peak_idx > cd->lookahead_blocks)
+		cd->peak_idx = 0;
+}
+
+static void drc_s16_default(struct comp_dev *dev, struct comp_buffer *source,
+			    struct comp_buffer *sink, uint32_t frames)
+{
+	struct drc_data *cd = comp_get_drvdata(dev);
+	int16_t *x = source->r_ptr;
+	int16_t *y = sink->w_ptr;
+	int nch = dev->params.channels;
+	int ch;
+	int i;
+	int f;
+	int n;
+
+	for (f = 0; f < frames; f += n) {
+		n = MIN(frames - f, DRC_BLOCK_SIZE);
+		for (i = 0; i < n; i++) {
+			for (ch = 0; ch < nch; ch++) {
+				cd->in[ch][i] = *x << 16;
+				x = buffer_wrap(source, x + 1);
+			}
+		}
+
+		drc_process_block(cd, nch, n);
+
+		for (i = 0; i < n; i++) {
+			for (ch = 0; ch < nch; ch++) {
+				*y = sat_int16(Q_SHIFT_RND(cd->out[ch][i],
+							   31, 15));
+				y = buffer_wrap(sink, y + 1);
+			}
+		}
+	}
+}
+
+static void drc_s24_default(struct comp_dev *dev, struct comp_buffer *source,
+			    struct comp_buffer *sink, uint32_t frames)
+{
+	struct drc_data *cd = comp_get_drvdata(dev);
+	int32_t *x = source->r_ptr;
+	int32_t *y = sink->w_ptr;
+	int nch = dev->params.channels;
+	int ch;
+	int i;
+	int f;
+	int n;
+
+	for (f = 0; f < frames; f += n) {
+		n = MIN(frames - f, DRC_BLOCK_SIZE);
+		for (i = 0; i < n; i++) {
+			for (ch = 0; ch < nch; ch++) {
+				cd->in[ch][i] = *x << 8;
+				x = buffer_wrap(source, x + 1);
+			}
+		}
+
+		drc_process_block(cd, nch, n);
+
+		for (i = 0; i < n; i++) {
+			for (ch = 0; ch < nch; ch++) {
+				*y = sat_int24(Q_SHIFT_RND(cd->out[ch][i],
+							   31, 23));
+				y = buffer_wrap(sink, y + 1);
+			}
+		}
+	}
+}
+
+static void drc_s32_default(struct comp_dev *dev, struct comp_buffer *source,
+			    struct comp_buffer *sink, uint32_t frames)
+{
+	struct drc_data *cd = comp_get_drvdata(dev);
+	int32_t *x = source->r_ptr;
+	int32_t *y = sink->w_ptr;
+	int nch = dev->params.channels;
+	int ch;
+	int i;
+	int f;
+	int n;
+
+	for (f = 0; f < frames; f += n) {
+		n = MIN(frames - f, DRC_BLOCK_SIZE);
+		for (i = 0; i < n; i++) {
+			for (ch = 0; ch < nch; ch++) {
+				cd->in[ch][i] = *x;
+				x = buffer_wrap(source, x + 1);
+			}
+		}
+
+		drc_process_block(cd, nch, n);
+
+		for (i = 0; i < n; i++) {
+			for (ch = 0; ch < nch; ch++) {
+				*y = cd->out[ch][i];
+				y = buffer_wrap(sink, y + 1);
+			}
+		}
+	}
+}
+
+static void drc_s16_pass(struct comp_dev *dev, struct comp_buffer *source,
+			 struct comp_buffer *sink, uint32_t frames)
+{
+	memcpy(sink->w_ptr, source->r_ptr,
+	       frames * dev->params.channels * sizeof(int16_t));
+}
+
+static void drc_s32_pass(struct comp_dev *dev, struct comp_buffer *source,
+			 struct comp_buffer *sink, uint32_t frames)
+{
+	memcpy(sink->w_ptr, source->r_ptr,
+	       frames * dev->params.channels * sizeof(int32_t));
+}
+
+static drc_func drc_find_func(enum sof_ipc_frame fmt, int configured)
+{
+	switch (fmt) {
+	case SOF_IPC_FRAME_S16_LE:
+		return configured ? drc_s16_default : drc_s16_pass;
+	case SOF_IPC_FRAME_S24_4LE:
+		return configured ? drc_s24_default : drc_s32_pass;
+	case SOF_IPC_FRAME_S32_LE:
+		return configured ? drc_s32_default : drc_s32_pass;
+	default:
+		return NULL;
+	}
+}
+
+/*
+ * DRC setup code
+ */
+
+static void drc_free_parameters(struct sof_drc_config **config)
+{
+	rfree(*config);
+	*config = NULL;
+}
+
+static void drc_free_state(struct drc_data *cd)
+{
+	int b;
+
+	/* The state is owned by the pipeline arena */
+	cd->state = NULL;
+	cd->state_size = 0;
+	for (b = 0; b < SOF_DRC_MAX_BANDS; b++)
+		cd->band[b].delay = NULL;
+}
+
+/* Check the blob and collect the start of each band split response */
+static int drc_init_lookup(struct sof_drc_config *config,
+			   struct sof_eq_iir_header_df2t *lookup[])
+{
+	struct sof_eq_iir_header_df2t *eq;
+	struct sof_drc_band *band;
+	size_t words;
+	size_t j;
+	int i;
+
+	if (config->size < sizeof(*config) ||
+	    config->size > SOF_DRC_MAX_SIZE) {
+		trace_drc_error("drc_init_lookup() error: invalid size %u",
+				config->size);
+		return -EINVAL;
+	}
+
+	if (!config->num_bands || config->num_bands > SOF_DRC_MAX_BANDS ||
+	    config->number_of_responses > SOF_DRC_MAX_BANDS) {
+		trace_drc_error("drc_init_lookup() error: num_bands = %u, "
+				"number_of_responses = %u",
+				config->num_bands, config->number_of_responses);
+		return -EINVAL;
+	}
+
+	words = (config->size - sizeof(*config)) / sizeof(int32_t);
+	j = config->num_bands * SOF_DRC_NBAND;
+	for (i = 0; i < config->number_of_responses; i++) {
+		if (j + SOF_EQ_IIR_NHEADER_DF2T > words)
+			goto truncated;
+
+		eq = (struct sof_eq_iir_header_df2t *)&config->data[j];
+		lookup[i] = eq;
+		j += SOF_EQ_IIR_NHEADER_DF2T +
+			SOF_EQ_IIR_NBIQUAD_DF2T * eq->num_sections;
+	}
+
+	if (j > words)
+		goto truncated;
+
+	band = (struct sof_drc_band *)config->data;
+	for (i = 0; i < config->num_bands; i++) {
+		if (band[i].response < -1 ||
+		    band[i].response >= (int32_t)config->number_of_responses) {
+			trace_drc_error("drc_init_lookup() error: band %d "
+					"response = %d", i, band[i].response);
+			return -EINVAL;
+		}
+	}
+
+	return 0;
+
+truncated:
+	trace_drc_error("drc_init_lookup() error: responses exceed size");
+	return -EINVAL;
+}
+
+/* Per block smoothing coefficient 1 - exp(-block / time) as Q16.16 */
+static int32_t drc_coef(uint32_t rate, uint32_t time_us)
+{
+	int64_t blocks;
+
+	if (!time_us)
+		return FIXED_ONE_Q16;
+
+	/* blocks per time constant as Q16.16, 1 - exp(-x) = 1 - 2^(-x*log2e) */
+	blocks = ((int64_t)DRC_BLOCK_SIZE * 1000000 << 16) /
+		((int64_t)rate * time_us);
+	blocks = MIN(blocks, INT32_MAX);
+
+	return FIXED_ONE_Q16 -
+		exp2_fixed(-q_multsr_sat_32x32(blocks, LOG2_E_Q2_30, 30));
+}
+
+static int drc_setup(struct comp_dev *dev, struct drc_data *cd, int nch)
+{
+	struct sof_drc_config *config = cd->config;
+	struct sof_eq_iir_header_df2t *lookup[SOF_DRC_MAX_BANDS];
+	struct sof_drc_band *band_cfg;
+	struct drc_band_state *band;
+	uint32_t rate = dev->params.rate;
+	void *old_state = cd->state;
+	size_t old_size = cd->state_size;
+	size_t iir_size = 0;
+	size_t size;
+	size_t s;
+	int64_t *iir_delay;
+	int32_t *line;
+	int ret;
+	int ch;
+	int b;
+
+	drc_free_state(cd);
+
+	if (nch > PLATFORM_MAX_CHANNELS || !rate) {
+		trace_drc_error("drc_setup() error: channels = %d, rate = %u",
+				nch, rate);
+		return -EINVAL;
+	}
+
+	ret = drc_init_lookup(config, lookup);
+	if (ret < 0)
+		return ret;
+
+	if (config->lookahead_us > SOF_DRC_MAX_LOOKAHEAD_US) {
+		trace_drc_error("drc_setup() error: lookahead_us = %u",
+				config->lookahead_us);
+		return -EINVAL;
+	}
+
+	/* look-ahead rounded up to whole gain blocks */
+	cd->lookahead_blocks = ((uint64_t)config->lookahead_us * rate +
+				1000000 * DRC_BLOCK_SIZE - 1) /
+		(1000000 * DRC_BLOCK_SIZE);
+	if (cd->lookahead_blocks > DRC_MAX_LOOKAHEAD_BLOCKS) {
+		trace_drc_error("drc_setup() error: lookahead_blocks = %d",
+				cd->lookahead_blocks);
+		return -EINVAL;
+	}
+
+	cd->lookahead = cd->lookahead_blocks * DRC_BLOCK_SIZE;
+	cd->num_bands = config->num_bands;
+	cd->delay_idx = 0;
+	cd->peak_idx = 0;
+
+	/* Initialize band parameters and IIR coefficients */
+	band_cfg = (struct sof_drc_band *)config->data;
+	for (b = 0; b < cd->num_bands; b++) {
+		band = &cd->band[b];
+		if (band_cfg[b].ratio && band_cfg[b].ratio < FIXED_ONE_Q16) {
+			trace_drc_error("drc_setup() error: band %d ratio "
+					"= %d", b, band_cfg[b].ratio);
+			return -EINVAL;
+		}
+
+		band->threshold = band_cfg[b].threshold;
+		band->slope = band_cfg[b].ratio ?
+			FIXED_ONE_Q16 - inv_fixed(band_cfg[b].ratio) :
+			FIXED_ONE_Q16;
+		band->makeup_gain = band_cfg[b].makeup_gain;
+		band->attack = drc_coef(rate, band_cfg[b].attack_us);
+		band->release = drc_coef(rate, band_cfg[b].release_us);
+		band->gain_db = 0;
+		band->gain = sat_int32((int64_t)db2lin_fixed(band->makeup_gain)
+				       << 14);
+		memset(band->peak, 0, sizeof(band->peak));
+
+		for (ch = 0; ch < nch; ch++) {
+			if (band_cfg[b].response < 0) {
+				iir_reset_df2t(&band->iir[ch]);
+				continue;
+			}
+
+			s = iir_init_coef_df2t(&band->iir[ch],
+					       lookup[band_cfg[b].response]);
+			if (!s || s > SOF_DRC_MAX_SIZE)
+				return -EINVAL;
+
+			iir_size += s;
+		}
+
+		trace_drc("drc_setup(), band = %d, response = %d", b,
+			  band_cfg[b].response);
+	}
+
+	/* IIR delays first to keep them 64 bit aligned, then look-ahead */
+	size = iir_size + cd->num_bands * nch * cd->lookahead *
+		sizeof(int32_t);
+	if (!size)
+		return 0;
+
+	if (old_state && old_size >= size)
+		cd->state = old_state;
+	else
+		cd->state = pipeline_arena_alloc(dev->pipeline, size);
+	if (!cd->state)
+		return -ENOMEM;
+
+	cd->state_size = size;
+	memset(cd->state, 0, size);
+
+	iir_delay = cd->state;
+	for (b = 0; b < cd->num_bands; b++) {
+		if (band_cfg[b].response < 0)
+			continue;
+
+		for (ch = 0; ch < nch; ch++)
+			iir_init_delay_df2t(&cd->band[b].iir[ch], &iir_delay);
+	}
+
+	line = (int32_t *)iir_delay;
+	for (b = 0; b < cd->num_bands; b++) {
+		cd->band[b].delay = line;
+		line += nch * cd->lookahead;
+	}
+
+	return 0;
+}
+
+/*
+ * End of DRC setup code. Next the standard component methods.
+ */
+
+static struct comp_dev *drc_new(struct sof_ipc_comp *comp)
+{
+	struct comp_dev *dev;
+	struct drc_data *cd;
+	struct sof_ipc_comp_drc *ipc_drc = (struct sof_ipc_comp_drc *)comp;
+	size_t bs = ipc_drc->size;
+
+	trace_drc("drc_new()");
+
+	if (IPC_IS_SIZE_INVALID(ipc_drc->config)) {
+		IPC_SIZE_ERROR_TRACE(TRACE_CLASS_DRC, ipc_drc->config);
+		return NULL;
+	}
+
+	if (bs > SOF_DRC_MAX_SIZE) {
+		trace_drc_error("drc_new() error: config blob size = %u > "
+				"SOF_DRC_MAX_SIZE", bs);
+		return NULL;
+	}
+
+	dev = rzalloc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM,
+		      COMP_SIZE(struct sof_ipc_comp_drc));
+	if (!dev)
+		return NULL;
+
+	memcpy(&dev->comp, comp, sizeof(struct sof_ipc_comp_drc));
+
+	cd = rzalloc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM, sizeof(*cd));
+	if (!cd) {
+		rfree(dev);
+		return NULL;
+	}
+
+	comp_set_drvdata(dev, cd);
+
+	cd->drc_func = drc_s32_pass;
+
+	/* Make a copy of the configuration blob. If the DRC is configured
+	 * later in run-time the size is zero.
+	 */
+	if (bs) {
+		cd->config = rzalloc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM, bs);
+		if (!cd->config) {
+			rfree(dev);
+			rfree(cd);
+			return NULL;
+		}
+
+		memcpy(cd->config, ipc_drc->data, bs);
+	}
+
+	dev->can_idle = 1;
+	dev->state = COMP_STATE_READY;
+	return dev;
+}
+
+static void drc_free(struct comp_dev *dev)
+{
+	struct drc_data *cd = comp_get_drvdata(dev);
+
+	trace_drc("drc_free()");
+
+	drc_free_state(cd);
+	drc_free_parameters(&cd->config);
+	drc_free_parameters(&cd->config_new);
+
+	rfree(cd);
+	rfree(dev);
+}
+
+/* set component audio stream parameters */
+static int drc_params(struct comp_dev *dev)
+{
+	trace_drc("drc_params()");
+
+	/* All configuration work is postponed to prepare(). */
+	return 0;
+}
+
+static int drc_cmd_get_data(struct comp_dev *dev,
+			    struct sof_ipc_ctrl_data *cdata, int max_size)
+{
+	struct drc_data *cd = comp_get_drvdata(dev);
+	size_t bs;
+
+	if (cdata->cmd != SOF_CTRL_CMD_BINARY) {
+		trace_drc_error("drc_cmd_get_data() error: invalid cdata->cmd");
+		return -EINVAL;
+	}
+
+	if (!cd->config) {
+		trace_drc_error("drc_cmd_get_data() error: no configuration");
+		return -EINVAL;
+	}
+
+	bs = cd->config->size;
+	if (bs > SOF_DRC_MAX_SIZE || bs == 0 || bs > max_size)
+		return -EINVAL;
+
+	memcpy(cdata->data->data, cd->config, bs);
+	cdata->data->abi = SOF_ABI_VERSION;
+	cdata->data->size = bs;
+
+	return 0;
+}
+
+static int drc_cmd_set_data(struct comp_dev *dev,
+			    struct sof_ipc_ctrl_data *cdata)
+{
+	struct drc_data *cd = comp_get_drvdata(dev);
+	struct sof_drc_config *cfg;
+	struct sof_drc_config *new_config;
+	struct sof_drc_config *old_config;
+	uint32_t flags;
+	size_t bs;
+
+	if (SOF_ABI_VERSION_INCOMPATIBLE(SOF_ABI_VERSION, cdata->data->abi)) {
+		trace_drc_error("drc_cmd_set_data() error: invalid version");
+		return -EINVAL;
+	}
+
+	if (cdata->cmd != SOF_CTRL_CMD_BINARY) {
+		trace_drc_error("drc_cmd_set_data() error: invalid cdata->cmd");
+		return -EINVAL;
+	}
+
+	/* Copy new config, find size from header */
+	cfg = (struct sof_drc_config *)cdata->data->data;
+	bs = cfg->size;
+	trace_drc("drc_cmd_set_data(), blob size = %u", bs);
+	if (bs > SOF_DRC_MAX_SIZE || bs < sizeof(*cfg)) {
+		trace_drc_error("drc_cmd_set_data() error: invalid blob size");
+		return -EINVAL;
+	}
+
+	new_config = rzalloc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM, bs);
+	if (!new_config) {
+		trace_drc_error("drc_cmd_set_data() error: alloc failed");
+		return -ENOMEM;
+	}
+
+	memcpy(new_config, cdata->data->data, bs);
+
+	if (dev->state == COMP_STATE_READY) {
+		/* The DRC will be initialized in prepare() */
+		drc_free_parameters(&cd->config);
+		cd->config = new_config;
+		return 0;
+	}
+
+	/* During playback/capture the new configuration is staged and
+	 * swapped in by copy() at the next period.
+	 */
+	spin_lock_irq(&dev->lock, flags);
+	old_config = cd->config_new;
+	cd->config_new = new_config;
+	spin_unlock_irq(&dev->lock, flags);
+
+	drc_free_parameters(&old_config);
+	return 0;
+}
+
+/* used to pass standard and bespoke commands (with data) to component */
+static int drc_cmd(struct comp_dev *dev, int cmd, void *data,
+		   int max_data_size)
+{
+	struct sof_ipc_ctrl_data *cdata = data;
+
+	trace_drc("drc_cmd()");
+
+	switch (cmd) {
+	case COMP_CMD_SET_DATA:
+		return drc_cmd_set_data(dev, cdata);
+	case COMP_CMD_GET_DATA:
+		return drc_cmd_get_data(dev, cdata, max_data_size);
+	default:
+		trace_drc_error("drc_cmd() error: invalid command");
+		return -EINVAL;
+	}
+}
+
+static int drc_trigger(struct comp_dev *dev, int cmd)
+{
+	trace_drc("drc_trigger()");
+
+	return comp_set_state(dev, cmd);
+}
+
+/* Take a configuration staged by drc_cmd_set_data() into use at the period
+ * boundary. The DRC state starts again from unity gain. The old
+ * configuration is restored if the new one fails.
+ */
+static void drc_apply_config(struct comp_dev *dev)
+{
+	struct drc_data *cd = comp_get_drvdata(dev);
+	struct sof_drc_config *config;
+	struct sof_drc_config *old;
+	int nch = dev->params.channels;
+	uint32_t flags;
+
+	spin_lock_irq(&dev->lock, flags);
+	config = cd->config_new;
+	cd->config_new = NULL;
+	spin_unlock_irq(&dev->lock, flags);
+
+	if (!config)
+		return;
+
+	old = cd->config;
+	cd->config = config;
+	if (drc_setup(dev, cd, nch) == 0) {
+		cd->drc_func = drc_find_func(cd->frame_fmt, 1);
+		drc_free_parameters(&old);
+		return;
+	}
+
+	trace_drc_error("drc_apply_config() error: "
+			"new configuration failed, keeping old");
+	drc_free_parameters(&cd->config);
+	cd->config = old;
+	if (!old || drc_setup(dev, cd, nch) < 0)
+		cd->drc_func = drc_find_func(cd->frame_fmt, 0);
+}
+
+/* copy and process stream data from source to sink buffers */
+static int drc_copy(struct comp_dev *dev)
+{
+	struct drc_data *cd = comp_get_drvdata(dev);
+	struct comp_buffer *source;
+	struct comp_buffer *sink;
+
+	tracev_drc("drc_copy()");
+
+	/* swap in new configuration before processing the period */
+	if (cd->config_new)
+		drc_apply_config(dev);
+
+	source = list_first_item(&dev->bsource_list, struct comp_buffer,
+				 sink_list);
+	sink = list_first_item(&dev->bsink_list, struct comp_buffer,
+			       source_list);
+
+	/* make sure source component buffer has enough data available and that
+	 * the sink component buffer has enough free bytes for copy. Also
+	 * check for XRUNs
+	 */
+	if (comp_buffer_get_avail_bytes(source) < cd->period_bytes) {
+		trace_drc_error("drc_copy() error: source component buffer "
+				"has not enough data available");
+		comp_underrun(dev, source, cd->period_bytes, 0);
+		return -EIO;	/* xrun */
+	}
+	if (comp_buffer_get_free_bytes(sink) < cd->period_bytes) {
+		trace_drc_error("drc_copy() error: sink component buffer "
+				"has not enough free bytes for copy");
+		comp_overrun(dev, sink, cd->period_bytes, 0);
+		return -EIO;	/* xrun */
+	}
+
+	cd->drc_func(dev, source, sink, dev->frames);
+
+	comp_update_buffer_consume(source, cd->period_bytes);
+	comp_update_buffer_produce(sink, cd->period_bytes);
+
+	return dev->frames;
+}
+
+static int drc_prepare(struct comp_dev *dev)
+{
+	struct drc_data *cd = comp_get_drvdata(dev);
+	struct sof_ipc_comp_config *config = COMP_GET_CONFIG(dev);
+	struct comp_buffer *sourceb;
+	struct comp_buffer *sinkb;
+	enum sof_ipc_frame sink_fmt;
+	uint32_t sink_period_bytes;
+	int ret;
+
+	trace_drc("drc_prepare()");
+
+	ret = comp_set_state(dev, COMP_TRIGGER_PREPARE);
+	if (ret < 0)
+		return ret;
+
+	/* DRC components will only ever have 1 source and 1 sink buffer */
+	sourceb = list_first_item(&dev->bsource_list,
+				  struct comp_buffer, sink_list);
+	sinkb = list_first_item(&dev->bsink_list,
+				struct comp_buffer, source_list);
+
+	comp_set_period_bytes(sourceb->source, dev->frames, &cd->frame_fmt,
+			      &cd->period_bytes);
+	comp_set_period_bytes(sinkb->sink, dev->frames, &sink_fmt,
+			      &sink_period_bytes);
+
+	/* the DRC does not convert formats */
+	if (cd->frame_fmt != sink_fmt ||
+	    cd->period_bytes != sink_period_bytes) {
+		trace_drc_error("drc_prepare() error: source_format = %d, "
+				"sink_format = %d", cd->frame_fmt, sink_fmt);
+		ret = -EINVAL;
+		goto err;
+	}
+
+	dev->frame_bytes = cd->period_bytes / dev->frames;
+
+	ret = buffer_set_size(sinkb, cd->period_bytes * config->periods_sink);
+	if (ret < 0) {
+		trace_drc_error("drc_prepare() error: "
+				"buffer_set_size() failed");
+		goto err;
+	}
+
+	dev->can_bypass = 0;
+	if (cd->config) {
+		ret = drc_setup(dev, cd, dev->params.channels);
+		if (ret < 0) {
+			trace_drc_error("drc_prepare() error: "
+					"drc_setup() failed");
+			goto err;
+		}
+	} else {
+		/* pipeline can skip an unconfigured DRC */
+		dev->can_bypass = 1;
+		trace_drc("drc_prepare(), pass-through mode");
+	}
+
+	cd->drc_func = drc_find_func(cd->frame_fmt, cd->config != NULL);
+	if (!cd->drc_func) {
+		trace_drc_error("drc_prepare() error: invalid format %d",
+				cd->frame_fmt);
+		ret = -EINVAL;
+		goto err;
+	}
+
+	return 0;
+
+err:
+	cd->drc_func = drc_s32_pass;
+	comp_set_state(dev, COMP_TRIGGER_RESET);
+	return ret;
+}
+
+static int drc_reset(struct comp_dev *dev)
+{
+	struct drc_data *cd = comp_get_drvdata(dev);
+
+	trace_drc("drc_reset()");
+
+	drc_free_state(cd);
+
+	/* A configuration staged while running is used in next prepare() */
+	if (cd->config_new) {
+		drc_free_parameters(&cd->config);
+		cd->config = cd->config_new;
+		cd->config_new = NULL;
+	}
+
+	cd->drc_func = drc_s32_pass;
+	dev->can_bypass = 0;
+
+	comp_set_state(dev, COMP_TRIGGER_RESET);
+	return 0;
+}
+
+static void drc_cache(struct comp_dev *dev, int cmd)
+{
+	struct drc_data *cd;
+
+	switch (cmd) {
+	case COMP_CACHE_WRITEBACK_INV:
+		trace_drc("drc_cache(), COMP_CACHE_WRITEBACK_INV");
+
+		cd = comp_get_drvdata(dev);
+		if (cd->config)
+			dcache_writeback_invalidate_region(cd->config,
+							   cd->config->size);
+
+		if (cd->state)
+			dcache_writeback_invalidate_region(cd->state,
+							   cd->state_size);
+
+		dcache_writeback_invalidate_region(cd, sizeof(*cd));
+		dcache_writeback_invalidate_region(dev, sizeof(*dev));
+		break;
+
+	case COMP_CACHE_INVALIDATE:
+		trace_drc("drc_cache(), COMP_CACHE_INVALIDATE");
+
+		dcache_invalidate_region(dev, sizeof(*dev));
+
+		/* Note: The component data need to be retrieved after
+		 * the dev data has been invalidated.
+		 */
+		cd = comp_get_drvdata(dev);
+		dcache_invalidate_region(cd, sizeof(*cd));
+
+		if (cd->state)
+			dcache_invalidate_region(cd->state, cd->state_size);
+
+		if (cd->config)
+			dcache_invalidate_region(cd->config, cd->config->size);
+		break;
+	}
+}
+
+struct comp_driver comp_drc = {
+	.type = SOF_COMP_DRC,
+	.ops = {
+		.new = drc_new,
+		.free = drc_free,
+		.params = drc_params,
+		.cmd = drc_cmd,
+		.trigger = drc_trigger,
+		.copy = drc_copy,
+		.prepare = drc_prepare,
+		.reset = drc_reset,
+		.cache = drc_cache,
+	},
+};
+
+void sys_comp_drc_init(void)
+{
+	comp_register(&comp_drc);
+}
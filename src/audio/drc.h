@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Seppo Ingalsuo <seppo.ingalsuo@linux.intel.com>
+ */
+
+#ifndef DRC_H
+#define DRC_H
+
+#include <stdint.h>
+#include <sof/audio/component.h>
+#include <uapi/user/drc.h>
+#include "iir.h"
+
+#define CONFIG_GENERIC
+
+#if defined(__XCC__)
+#include <xtensa/config/core-isa.h>
+
+#if XCHAL_HAVE_HIFI3
+#undef CONFIG_GENERIC
+#endif
+
+#endif
+
+#define trace_drc(__e, ...) trace_event(TRACE_CLASS_DRC, __e, ##__VA_ARGS__)
+#define tracev_drc(__e, ...) tracev_event(TRACE_CLASS_DRC, __e, ##__VA_ARGS__)
+#define trace_drc_error(__e, ...) \
+	trace_error(TRACE_CLASS_DRC, __e, ##__VA_ARGS__)
+
+/* Frames per gain computation block */
+#define DRC_BLOCK_SIZE 16
+
+/* Look-ahead in blocks, covers SOF_DRC_MAX_LOOKAHEAD_US up to 96 kHz */
+#define DRC_MAX_LOOKAHEAD_BLOCKS 32
+
+/* Dynamics state of one band, gains are Q16.16 dB unless noted */
+struct drc_band_state {
+	struct iir_state_df2t iir[PLATFORM_MAX_CHANNELS]; /* band split */
+	int32_t *delay; /* look-ahead delay lines of all channels */
+	int32_t peak[DRC_MAX_LOOKAHEAD_BLOCKS + 1]; /* block peaks, Q1.31 */
+	int32_t threshold;
+	int32_t slope; /* gain reduction per dB over threshold, Q16.16 */
+	int32_t makeup_gain;
+	int32_t attack; /* smoothing coefficient per block, Q16.16 */
+	int32_t release; /* smoothing coefficient per block, Q16.16 */
+	int32_t gain_db; /* smoothed gain reduction */
+	int32_t gain; /* applied linear gain, Q2.30 */
+};
+
+/* Processes frames of the first source buffer to the first sink buffer */
+typedef void (*drc_func)(struct comp_dev *dev, struct comp_buffer *source,
+			 struct comp_buffer *sink, uint32_t frames);
+
+/* DRC component private data */
+struct drc_data {
+	/* Q1.31 blocks of input, band and output samples */
+	int32_t in[PLATFORM_MAX_CHANNELS][DRC_BLOCK_SIZE]
+		__attribute__((aligned(8)));
+	int32_t buf[PLATFORM_MAX_CHANNELS][DRC_BLOCK_SIZE]
+		__attribute__((aligned(8)));
+	int32_t out[PLATFORM_MAX_CHANNELS][DRC_BLOCK_SIZE]
+		__attribute__((aligned(8)));
+	struct drc_band_state band[SOF_DRC_MAX_BANDS];
+	struct sof_drc_config *config;
+	struct sof_drc_config *config_new; /* staged while running */
+	int num_bands;
+	int lookahead_blocks;
+	int lookahead; /* delay line length in frames */
+	int delay_idx; /* delay line position of all bands and channels */
+	int peak_idx; /* block peak history position of all bands */
+	void *state; /* all IIR and delay lines data from pipeline arena */
+	size_t state_size;
+	uint32_t period_bytes;
+	enum sof_ipc_frame frame_fmt;
+	drc_func drc_func;
+};
+
+/* Returns the max of peak and the absolute values of n samples */
+int32_t drc_peak(const int32_t *x, int n, int32_t peak);
+
+/* Adds n samples of x to y with Q2.30 gain that moves by step per sample,
+ * both the scaled sample and the sum saturate.
+ */
+void drc_gain_acc(const int32_t *x, int32_t *y, int n, int32_t gain,
+		  int32_t step);
+
+#endif
@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Seppo Ingalsuo <seppo.ingalsuo@linux.intel.com>
+ */
+
+#include <stdint.h>
+#include <sof/audio/format.h>
+#include <sof/math/numbers.h>
+#include "drc.h"
+
+#ifdef CONFIG_GENERIC
+
+int32_t drc_peak(const int32_t *x, int n, int32_t peak)
+{
+	int32_t a;
+	int i;
+
+	for (i = 0; i < n; i++) {
+		a = x[i] == INT32_MIN ? INT32_MAX : x[i] < 0 ? -x[i] : x[i];
+		peak = MAX(peak, a);
+	}
+
+	return peak;
+}
+
+void drc_gain_acc(const int32_t *x, int32_t *y, int n, int32_t gain,
+		  int32_t step)
+{
+	int32_t tmp;
+	int i;
+
+	for (i = 0; i < n; i++) {
+		/* Q1.31 x Q2.30 -> Q1.31 */
+		tmp = sat_int32(((int64_t)x[i] * gain) >> 30);
+		y[i] = sat_int32((int64_t)y[i] + tmp);
+		gain += step;
+	}
+}
+
+#endif
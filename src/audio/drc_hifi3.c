@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Seppo Ingalsuo <seppo.ingalsuo@linux.intel.com>
+ */
+
+#include <stdint.h>
+#include <sof/audio/format.h>
+#include <sof/math/numbers.h>
+#include "drc.h"
+
+#if defined(__XCC__) && XCHAL_HAVE_HIFI3
+
+#include <xtensa/tie/xt_hifi3.h>
+
+/* The block buffers are 64 bit aligned so samples are loaded in pairs and
+ * an odd sample at the end is handled separately.
+ */
+
+int32_t drc_peak(const int32_t *x, int n, int32_t peak)
+{
+	ae_int32x2 *in = (ae_int32x2 *)x;
+	ae_int32x2 max = AE_MOVDA32(peak);
+	ae_int32x2 d;
+	int i;
+
+	for (i = 0; i < n >> 1; i++) {
+		AE_L32X2_IP(d, in, sizeof(ae_int32x2));
+		max = AE_MAX32(max, AE_ABS32S(d));
+	}
+
+	if (n & 1) {
+		d = AE_MOVDA32(x[n - 1]);
+		max = AE_MAX32(max, AE_ABS32S(d));
+	}
+
+	return MAX(AE_MOVAD32_H(max), AE_MOVAD32_L(max));
+}
+
+void drc_gain_acc(const int32_t *x, int32_t *y, int n, int32_t gain,
+		  int32_t step)
+{
+	int32_t g2[2] __attribute__((aligned(8)));
+	ae_int32x2 *in = (ae_int32x2 *)x;
+	ae_int32x2 *out = (ae_int32x2 *)y;
+	ae_int32x2 g;
+	ae_int32x2 step2 = AE_MOVDA32(2 * step);
+	ae_int32x2 d;
+	ae_int32x2 sum;
+	int32_t tmp;
+	int i;
+
+	/* gains of two consecutive samples in the same lanes as the data */
+	g2[0] = gain;
+	g2[1] = gain + step;
+	g = *(ae_int32x2 *)g2;
+
+	for (i = 0; i < n >> 1; i++) {
+		AE_L32X2_IP(d, in, sizeof(ae_int32x2));
+		sum = *out;
+
+		/* Q1.31 x Q2.30 -> Q3.61, saturated back to Q1.31 */
+		d = AE_TRUNCA32X2F64S(AE_MUL32_HH(d, g), AE_MUL32_LL(d, g), 2);
+		AE_S32X2_IP(AE_ADD32S(sum, d), out, sizeof(ae_int32x2));
+		g = AE_ADD32(g, step2);
+	}
+
+	if (n & 1) {
+		gain += (n - 1) * step;
+		tmp = sat_int32(((int64_t)x[n - 1] * gain) >> 30);
+		y[n - 1] = sat_int32((int64_t)y[n - 1] + tmp);
+	}
+}
+
+#endif
@@ -34,8 +34,10 @@
 #include <sof/sof.h>
 #include <sof/audio/component.h>
 #include <sof/ipc.h>
+#include <sof/math/fft.h>
 #include <uapi/user/eq.h>
 #include "fir_config.h"
+#include "fir_fft.h"
 
 #if FIR_GENERIC
 #include "fir.h"
@@ -61,10 +63,17 @@
 /* src component private data */
 struct comp_data {
 	struct fir_state_32x16 fir[PLATFORM_MAX_CHANNELS];
+	struct fir_fft_state fft[PLATFORM_MAX_CHANNELS];
 	struct sof_eq_fir_config *config;
+	struct sof_eq_fir_config *config_new; /* staged while running */
 	uint32_t period_bytes;
 	int32_t *fir_delay;
 	size_t fir_delay_size;
+	struct comp_dirty delay_dirty;	/* delay written since writeback */
+	void (*eq_fir_func_4x)(struct fir_state_32x16 fir[],
+			       struct comp_buffer *source,
+			       struct comp_buffer *sink,
+			       int frames, int nch);
 	void (*eq_fir_func_even)(struct fir_state_32x16 fir[],
 				 struct comp_buffer *source,
 				 struct comp_buffer *sink,
@@ -73,47 +82,60 @@ struct comp_data {
 			    struct comp_buffer *source,
 			    struct comp_buffer *sink,
 			    int frames, int nch);
+	void (*eq_fir_fft_func)(struct fir_fft_state fft[],
+				struct comp_buffer *source,
+				struct comp_buffer *sink,
+				int frames, int nch);
+	bool fft_mode; /* Long responses use partitioned FFT convolution */
+	struct comp_silence silence; /* skip filters on decayed silence */
 };
 
 /* The optimized FIR functions variants need to be updated into function
  * set_fir_func. The cd->eq_fir_func is a function that can process any
  * number of samples. The cd->eq_fir_func_even is for optimized version
- * that is guaranteed to be called with even samples number.
+ * that is guaranteed to be called with even samples number and the
+ * cd->eq_fir_func_4x with samples number divisible by four.
  */
 
 #if FIR_HIFI3
 static inline void set_s16_fir(struct comp_data *cd)
 {
+	cd->eq_fir_func_4x = eq_fir_4x_s16_hifi3;
 	cd->eq_fir_func_even = eq_fir_2x_s16_hifi3;
 	cd->eq_fir_func = eq_fir_s16_hifi3;
 }
 
 static inline void set_s24_fir(struct comp_data *cd)
 {
+	cd->eq_fir_func_4x = eq_fir_4x_s24_hifi3;
 	cd->eq_fir_func_even = eq_fir_2x_s24_hifi3;
 	cd->eq_fir_func = eq_fir_s24_hifi3;
 }
 
 static inline void set_s32_fir(struct comp_data *cd)
 {
+	cd->eq_fir_func_4x = eq_fir_4x_s32_hifi3;
 	cd->eq_fir_func_even = eq_fir_2x_s32_hifi3;
 	cd->eq_fir_func = eq_fir_s32_hifi3;
 }
 #elif FIR_HIFIEP
 static inline void set_s16_fir(struct comp_data *cd)
 {
+	cd->eq_fir_func_4x = eq_fir_2x_s16_hifiep;
 	cd->eq_fir_func_even = eq_fir_2x_s16_hifiep;
 	cd->eq_fir_func = eq_fir_s16_hifiep;
 }
 
 static inline void set_s24_fir(struct comp_data *cd)
 {
+	cd->eq_fir_func_4x = eq_fir_2x_s24_hifiep;
 	cd->eq_fir_func_even = eq_fir_2x_s24_hifiep;
 	cd->eq_fir_func = eq_fir_s24_hifiep;
 }
 
 static inline void set_s32_fir(struct comp_data *cd)
 {
+	cd->eq_fir_func_4x = eq_fir_2x_s32_hifiep;
 	cd->eq_fir_func_even = eq_fir_2x_s32_hifiep;
 	cd->eq_fir_func = eq_fir_s32_hifiep;
 }
@@ -121,27 +143,77 @@ static inline void set_s32_fir(struct comp_data *cd)
 /* FIR_GENERIC */
 static inline void set_s16_fir(struct comp_data *cd)
 {
+	cd->eq_fir_func_4x = eq_fir_s16;
 	cd->eq_fir_func_even = eq_fir_s16;
 	cd->eq_fir_func = eq_fir_s16;
 }
 
 static inline void set_s24_fir(struct comp_data *cd)
 {
+	cd->eq_fir_func_4x = eq_fir_s24;
 	cd->eq_fir_func_even = eq_fir_s24;
 	cd->eq_fir_func = eq_fir_s24;
 }
 
 static inline void set_s32_fir(struct comp_data *cd)
 {
+	cd->eq_fir_func_4x = eq_fir_s32;
 	cd->eq_fir_func_even = eq_fir_s32;
 	cd->eq_fir_func = eq_fir_s32;
 }
 #endif
 
+static inline int set_fir_fft_func(struct comp_dev *dev)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+
+	switch (dev->params.frame_fmt) {
+	case SOF_IPC_FRAME_S16_LE:
+		trace_eq("set_fir_fft_func(), SOF_IPC_FRAME_S16_LE");
+		cd->eq_fir_fft_func = eq_fir_fft_s16;
+		break;
+	case SOF_IPC_FRAME_S24_4LE:
+		trace_eq("set_fir_fft_func(), SOF_IPC_FRAME_S24_4LE");
+		cd->eq_fir_fft_func = eq_fir_fft_s24;
+		break;
+	case SOF_IPC_FRAME_S32_LE:
+		trace_eq("set_fir_fft_func(), SOF_IPC_FRAME_S32_LE");
+		cd->eq_fir_fft_func = eq_fir_fft_s32;
+		break;
+	default:
+		trace_eq_error("set_fir_fft_func(), invalid frame_fmt");
+		return -EINVAL;
+	}
+	return 0;
+}
+
+/* Frames of silent input until every delay line holds only zeros */
+static uint32_t eq_fir_decay_frames(struct comp_data *cd, int nch)
+{
+	uint32_t frames = 0;
+	int i;
+
+	for (i = 0; i < nch; i++) {
+		if (cd->fft_mode)
+			frames = MAX(frames, cd->fft[i].length +
+				     FIR_FFT_BLOCK_SIZE);
+		else
+			frames = MAX(frames, cd->fir[i].length);
+	}
+
+	return frames;
+}
+
 static inline int set_fir_func(struct comp_dev *dev)
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
 
+	comp_silence_init(&cd->silence,
+			  eq_fir_decay_frames(cd, dev->params.channels));
+
+	if (cd->fft_mode)
+		return set_fir_fft_func(dev);
+
 	switch (dev->params.frame_fmt) {
 	case SOF_IPC_FRAME_S16_LE:
 		trace_eq("set_fir_func(), SOF_IPC_FRAME_S16_LE");
@@ -196,15 +268,20 @@ static inline int set_pass_func(struct comp_dev *dev)
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
 
+	cd->eq_fir_fft_func = NULL;
+	comp_silence_init(&cd->silence, 0);
+
 	switch (dev->params.frame_fmt) {
 	case SOF_IPC_FRAME_S16_LE:
 		trace_eq("set_pass_func(), SOF_IPC_FRAME_S16_LE");
+		cd->eq_fir_func_4x = eq_fir_s16_passthrough;
 		cd->eq_fir_func_even = eq_fir_s16_passthrough;
 		cd->eq_fir_func = eq_fir_s16_passthrough;
 		break;
 	case SOF_IPC_FRAME_S24_4LE:
 	case SOF_IPC_FRAME_S32_LE:
 		trace_eq("set_pass_func(), SOF_IPC_FRAME_S32_LE");
+		cd->eq_fir_func_4x = eq_fir_s32_passthrough;
 		cd->eq_fir_func_even = eq_fir_s32_passthrough;
 		cd->eq_fir_func = eq_fir_s32_passthrough;
 		break;
@@ -222,7 +299,7 @@ static inline int set_pass_func(struct comp_dev *dev)
 
 static void eq_fir_free_parameters(struct sof_eq_fir_config **config)
 {
-	rfree(*config);
+	comp_blob_put(*config);
 	*config = NULL;
 }
 
@@ -231,31 +308,28 @@ static void eq_fir_free_delaylines(struct comp_data *cd)
 	struct fir_state_32x16 *fir = cd->fir;
 	int i = 0;
 
-	/* Free the common buffer for all EQs and point then
-	 * each FIR channel delay line to NULL.
+	/* The common buffer for all EQs is owned by the pipeline arena,
+	 * drop it and point then each FIR channel delay line to NULL.
 	 */
-	rfree(cd->fir_delay);
+	cd->fir_delay = NULL;
 	cd->fir_delay_size = 0;
-	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++)
+	comp_dirty_clear(&cd->delay_dirty);
+	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++) {
 		fir[i].delay = NULL;
+		fir_fft_reset(&cd->fft[i]);
+	}
 }
 
-static int eq_fir_setup(struct comp_data *cd, int nch)
+/* Check the blob and collect the start of each response */
+static int eq_fir_init_lookup(struct sof_eq_fir_config *config, int nch,
+			      struct sof_eq_fir_coef_data *lookup[])
 {
-	struct fir_state_32x16 *fir = cd->fir;
-	struct sof_eq_fir_config *config = cd->config;
-	struct sof_eq_fir_coef_data *lookup[SOF_EQ_FIR_MAX_RESPONSES];
 	struct sof_eq_fir_coef_data *eq;
-	int32_t *fir_delay;
 	int16_t *coef_data;
-	int16_t *assign_response;
-	int resp;
 	int i;
 	int j;
-	size_t s;
-	size_t size_sum = 0;
 
-	trace_eq("eq_fir_setup(), "
+	trace_eq("eq_fir_init_lookup(), "
 		 "channels_in_config = %u, number_of_responses = %u",
 		 config->channels_in_config, config->number_of_responses);
 
@@ -263,23 +337,22 @@ static int eq_fir_setup(struct comp_data *cd, int nch)
 	if (nch > PLATFORM_MAX_CHANNELS ||
 	    config->channels_in_config > PLATFORM_MAX_CHANNELS ||
 	    !config->channels_in_config) {
-		trace_eq_error("eq_fir_setup() error: "
+		trace_eq_error("eq_fir_init_lookup() error: "
 			       "invalid channels_in_config");
 		return -EINVAL;
 	}
 	if (config->number_of_responses > SOF_EQ_FIR_MAX_RESPONSES) {
-		trace_eq_error("eq_fir_setup() error: number_of_responses > "
-			       "SOF_EQ_FIR_MAX_RESPONSES");
+		trace_eq_error("eq_fir_init_lookup() error: "
+			       "number_of_responses > SOF_EQ_FIR_MAX_RESPONSES");
 		return -EINVAL;
 	}
 
 	/* Collect index of respose start positions in all_coefficients[]  */
 	j = 0;
-	assign_response = &config->data[0];
 	coef_data = &config->data[config->channels_in_config];
 	for (i = 0; i < SOF_EQ_FIR_MAX_RESPONSES; i++) {
 		if (i < config->number_of_responses) {
-			trace_eq("eq_fir_setup(), "
+			trace_eq("eq_fir_init_lookup(), "
 				 "index of respose start position = %u", j);
 			eq = (struct sof_eq_fir_coef_data *)&coef_data[j];
 			lookup[i] = eq;
@@ -289,19 +362,195 @@ static int eq_fir_setup(struct comp_data *cd, int nch)
 		}
 	}
 
-	/* Initialize 1st phase */
+	return 0;
+}
+
+/* Get the response assigned to channel. If the blob has smaller channel map
+ * then apply for additional channels the response that was used for the
+ * first channel. This allows to use mono blobs to setup multi channel
+ * equalization without stopping to an error.
+ */
+static int eq_fir_get_response(struct sof_eq_fir_config *config, int ch)
+{
+	if (ch < config->channels_in_config)
+		return config->data[ch];
+
+	return config->data[0];
+}
+
+/* Get the delay data chunk, existing data is reused if it fits */
+static int eq_fir_alloc_delay(struct comp_data *cd, struct pipeline *p,
+			      int32_t *old_delay, size_t old_size,
+			      size_t size_sum)
+{
+	if (old_delay && old_size >= size_sum)
+		cd->fir_delay = old_delay;
+	else
+		cd->fir_delay = pipeline_arena_alloc(p, size_sum);
+	if (!cd->fir_delay) {
+		trace_eq_error("eq_fir_setup() error: alloc failed, size = %u",
+			       size_sum);
+		return -ENOMEM;
+	}
+
+	cd->fir_delay_size = size_sum;
+	memset(cd->fir_delay, 0, size_sum);
+	comp_dirty_clear(&cd->delay_dirty);
+	comp_dirty_mark(&cd->delay_dirty, cd->fir_delay, size_sum);
+	return 0;
+}
+
+/* Setup partitioned FFT convolution for all channels. Channels in bypass
+ * are delayed by one block to stay aligned with the filtered channels. The
+ * filter spectra are computed once per response.
+ */
+static int eq_fir_fft_setup(struct comp_data *cd, struct pipeline *p,
+			    int nch, struct sof_eq_fir_coef_data *lookup[])
+{
+	struct fir_fft_state *fft = cd->fft;
+	struct fir_fft_state *first[SOF_EQ_FIR_MAX_RESPONSES];
+	int32_t *old_delay = cd->fir_delay;
+	size_t old_size = cd->fir_delay_size;
+	struct icomplex32 *twiddle;
+	struct icomplex32 *work;
+	struct icomplex32 *coef;
+	int32_t *data;
+	int resp[PLATFORM_MAX_CHANNELS];
+	size_t size_sum;
+	int ret;
+	int i;
+
+	eq_fir_free_delaylines(cd);
+
+	/* Twiddle factors and FFT scratch shared by all channels */
+	size_sum = (FIR_FFT_SIZE / 2 + FIR_FFT_SIZE) *
+		sizeof(struct icomplex32);
+
+	for (i = 0; i < SOF_EQ_FIR_MAX_RESPONSES; i++)
+		first[i] = NULL;
+
 	for (i = 0; i < nch; i++) {
-		/* Check for not reading past blob response to channel assign
-		 * map. If the blob has smaller channel map then apply for
-		 * additional channels the response that was used for the first
-		 * channel. This allows to use mono blobs to setup multi
-		 * channel equalization without stopping to an error.
-		 */
-		if (i < config->channels_in_config)
-			resp = assign_response[i];
-		else
-			resp = assign_response[0];
+		resp[i] = eq_fir_get_response(cd->config, i);
+
+		if (resp[i] >= cd->config->number_of_responses)
+			return -EINVAL;
+
+		ret = fir_fft_init(&fft[i],
+				   resp[i] < 0 ? NULL : lookup[resp[i]]);
+		if (ret < 0)
+			return ret;
+
+		size_sum += fir_fft_delay_size(&fft[i]);
+		if (resp[i] >= 0 && !first[resp[i]]) {
+			first[resp[i]] = &fft[i];
+			size_sum += fir_fft_coef_size(&fft[i]);
+		}
+
+		trace_eq("eq_fir_fft_setup(), "
+			 "ch = %d initialized to response = %d", i, resp[i]);
+	}
+
+	ret = eq_fir_alloc_delay(cd, p, old_delay, old_size, size_sum);
+	if (ret < 0)
+		return ret;
+
+	twiddle = (struct icomplex32 *)cd->fir_delay;
+	work = twiddle + FIR_FFT_SIZE / 2;
+	coef = work + FIR_FFT_SIZE;
+	fft_init_twiddle(twiddle, FIR_FFT_SIZE);
+
+	/* Filter spectra of all used responses */
+	for (i = 0; i < nch; i++) {
+		if (resp[i] >= 0 && first[resp[i]] == &fft[i])
+			fir_fft_init_coef(&fft[i], lookup[resp[i]], &coef,
+					  work, twiddle);
+	}
+
+	/* Delay lines follow the spectra */
+	data = (int32_t *)coef;
+	for (i = 0; i < nch; i++) {
+		if (resp[i] >= 0 && first[resp[i]] != &fft[i])
+			fir_fft_share_coef(&fft[i], first[resp[i]]);
+
+		fir_fft_init_delay(&fft[i], &data);
+	}
+
+	return 0;
+}
+
+/* Switch channels to new responses with the same lengths without touching
+ * the delay lines, returns error if the layout has changed. Partitioned FFT
+ * mode always needs a new setup.
+ */
+static int eq_fir_update_coef(struct comp_data *cd,
+			      struct sof_eq_fir_config *config, int nch)
+{
+	struct sof_eq_fir_coef_data *lookup[SOF_EQ_FIR_MAX_RESPONSES];
+	int resp;
+	int ret;
+	int i;
+
+	if (cd->fft_mode)
+		return -EINVAL;
+
+	ret = eq_fir_init_lookup(config, nch, lookup);
+	if (ret < 0)
+		return ret;
+
+	for (i = 0; i < nch; i++) {
+		resp = eq_fir_get_response(config, i);
+		if (resp >= config->number_of_responses)
+			return -EINVAL;
+
+		ret = fir_update_coef(&cd->fir[i],
+				      resp < 0 ? NULL : lookup[resp]);
+		if (ret < 0)
+			return ret;
+	}
+
+	return 0;
+}
+
+static int eq_fir_setup(struct comp_data *cd, struct pipeline *p, int nch)
+{
+	struct fir_state_32x16 *fir = cd->fir;
+	int32_t *old_delay = cd->fir_delay;
+	size_t old_size = cd->fir_delay_size;
+	struct sof_eq_fir_config *config = cd->config;
+	struct sof_eq_fir_coef_data *lookup[SOF_EQ_FIR_MAX_RESPONSES];
+	struct sof_eq_fir_coef_data *eq;
+	int32_t *fir_delay;
+	int resp;
+	int ret;
+	int i;
+	size_t s;
+	size_t size_sum = 0;
 
+	ret = eq_fir_init_lookup(config, nch, lookup);
+	if (ret < 0)
+		return ret;
+
+	/* Responses longer than the direct form FIR supports switch all
+	 * channels to partitioned FFT convolution.
+	 */
+	cd->fft_mode = false;
+	for (i = 0; i < nch; i++) {
+		resp = eq_fir_get_response(config, i);
+		if (resp >= 0 && resp < config->number_of_responses &&
+		    lookup[resp]->length > SOF_EQ_FIR_MAX_LENGTH)
+			cd->fft_mode = true;
+	}
+
+	if (cd->fft_mode) {
+		for (i = 0; i < nch; i++)
+			fir_reset(&fir[i]);
+
+		return eq_fir_fft_setup(cd, p, nch, lookup);
+	}
+
+	/* Initialize 1st phase */
+	for (i = 0; i < nch; i++) {
+		resp = eq_fir_get_response(config, i);
 		if (resp < 0) {
 			/* Initialize EQ channel to bypass and continue with
 			 * next channel response.
@@ -328,23 +577,19 @@ static int eq_fir_setup(struct comp_data *cd, int nch)
 	/* If all channels were set to bypass there's no need to
 	 * allocate delay. Just return with success.
 	 */
-	cd->fir_delay = NULL;
-	cd->fir_delay_size = size_sum;
+	eq_fir_free_delaylines(cd);
 	if (!size_sum)
 		return 0;
 
 	/* Allocate all FIR channels data in a big chunk and clear it */
-	cd->fir_delay = rzalloc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM, size_sum);
-	if (!cd->fir_delay) {
-		trace_eq_error("eq_fir_setup() error: alloc failed, size = %u",
-			       size_sum);
-		return -ENOMEM;
-	}
+	ret = eq_fir_alloc_delay(cd, p, old_delay, old_size, size_sum);
+	if (ret < 0)
+		return ret;
 
 	/* Initialize 2nd phase to set EQ delay lines pointers */
 	fir_delay = cd->fir_delay;
 	for (i = 0; i < nch; i++) {
-		resp = assign_response[i];
+		resp = eq_fir_get_response(config, i);
 		if (resp >= 0) {
 			fir_init_delay(&fir[i], &fir_delay);
 		}
@@ -412,27 +657,31 @@ static struct comp_dev *eq_fir_new(struct sof_ipc_comp *comp)
 
 	comp_set_drvdata(dev, cd);
 
+	cd->eq_fir_func_4x = eq_fir_s32_passthrough;
 	cd->eq_fir_func_even = eq_fir_s32_passthrough;
 	cd->eq_fir_func = eq_fir_s32_passthrough;
 	cd->config = NULL;
 
-	/* Allocate and make a copy of the coefficients blob and reset FIR. If
-	 * the EQ is configured later in run-time the size is zero.
+	/* Get the coefficients blob, shared with the other EQs of the same
+	 * configuration, and reset FIR. If the EQ is configured later in
+	 * run-time the size is zero.
 	 */
 	if (bs) {
-		cd->config = rzalloc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM, bs);
+		cd->config = comp_blob_get(ipc_fir->data, bs);
 		if (!cd->config) {
 			rfree(dev);
 			rfree(cd);
 			return NULL;
 		}
-
-		memcpy(cd->config, ipc_fir->data, bs);
 	}
 
-	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++)
+	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++) {
 		fir_reset(&cd->fir[i]);
+		fir_fft_reset(&cd->fft[i]);
+	}
 
+	dev->can_schedule = 1;
+	dev->can_idle = 1;
 	dev->state = COMP_STATE_READY;
 	return dev;
 }
@@ -445,6 +694,7 @@ static void eq_fir_free(struct comp_dev *dev)
 
 	eq_fir_free_delaylines(cd);
 	eq_fir_free_parameters(&cd->config);
+	eq_fir_free_parameters(&cd->config_new);
 
 	rfree(cd);
 	rfree(dev);
@@ -480,6 +730,58 @@ static int eq_fir_params(struct comp_dev *dev)
 	return 0;
 }
 
+/* Private copy of the newest configuration for changing it */
+static struct sof_eq_fir_config *eq_fir_config_copy(struct comp_data *cd)
+{
+	struct sof_eq_fir_config *config = cd->config_new ?
+		cd->config_new : cd->config;
+	struct sof_eq_fir_config *copy;
+
+	if (!config)
+		return NULL;
+
+	copy = rballoc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM, config->size);
+	if (copy)
+		memcpy(copy, config, config->size);
+
+	return copy;
+}
+
+/* Use the blob of a new configuration, shared with other EQs */
+static int eq_fir_set_config(struct comp_dev *dev,
+			     struct sof_eq_fir_config *cfg)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	struct sof_eq_fir_config *new_config;
+	struct sof_eq_fir_config *old_config;
+	uint32_t flags;
+
+	new_config = comp_blob_get(cfg, cfg->size);
+	if (!new_config) {
+		trace_eq_error("eq_fir_set_config() error: alloc failed");
+		return -EINVAL;
+	}
+
+	if (dev->state == COMP_STATE_READY) {
+		/* The EQ will be initialized in prepare() */
+		eq_fir_free_parameters(&cd->config);
+		cd->config = new_config;
+		return 0;
+	}
+
+	/* During playback/capture the new configuration is staged
+	 * and swapped in by copy() at the next period. A staged
+	 * configuration that was not yet used is replaced.
+	 */
+	spin_lock_irq(&dev->lock, flags);
+	old_config = cd->config_new;
+	cd->config_new = new_config;
+	spin_unlock_irq(&dev->lock, flags);
+
+	eq_fir_free_parameters(&old_config);
+	return 0;
+}
+
 static int fir_cmd_get_data(struct comp_dev *dev,
 			    struct sof_ipc_ctrl_data *cdata, int max_size)
 {
@@ -536,13 +838,22 @@ static int fir_cmd_set_data(struct comp_dev *dev,
 		trace_eq("fir_cmd_set_data(), SOF_CTRL_CMD_ENUM");
 		compv = (struct sof_ipc_ctrl_value_comp *)cdata->data->data;
 		if (cdata->index == SOF_EQ_FIR_IDX_SWITCH) {
+			/* The blob may be shared, the responses are switched
+			 * in a copy that is then set like a new blob.
+			 */
+			cfg = eq_fir_config_copy(cd);
+			if (!cfg) {
+				trace_eq_error("fir_cmd_set_data() error: "
+					       "no configuration to switch");
+				return -EINVAL;
+			}
+
 			for (i = 0; i < (int)cdata->num_elems; i++) {
 				trace_eq("fir_cmd_set_data(), "
 					 "SOF_EQ_FIR_IDX_SWITCH, "
 					 "compv index = %u, svalue = %u",
 					 compv[i].index, compv[i].svalue);
-				ret = eq_fir_switch_store(cd->fir,
-							  cd->config,
+				ret = eq_fir_switch_store(cd->fir, cfg,
 							  compv[i].index,
 							  compv[i].svalue);
 				if (ret < 0) {
@@ -550,9 +861,13 @@ static int fir_cmd_set_data(struct comp_dev *dev,
 						       "error: "
 						       "eq_fir_switch_store() "
 						       "failed");
+					rfree(cfg);
 					return -EINVAL;
 				}
 			}
+
+			ret = eq_fir_set_config(dev, cfg);
+			rfree(cfg);
 		} else {
 			trace_eq_error("fir_cmd_set_data() error: "
 				       "invalid cdata->index = %u",
@@ -563,40 +878,14 @@ static int fir_cmd_set_data(struct comp_dev *dev,
 	case SOF_CTRL_CMD_BINARY:
 		trace_eq("fir_cmd_set_data(), SOF_CTRL_CMD_BINARY");
 
-		if (dev->state != COMP_STATE_READY) {
-			/* It is a valid request but currently this is not
-			 * supported during playback/capture. The driver will
-			 * re-send data in next resume when idle and the new
-			 * EQ configuration will be used when playback/capture
-			 * starts.
-			 */
-			trace_eq_error("fir_cmd_set_data() error: "
-				       "driver is busy");
-			return -EBUSY;
-		}
-
-		/* Check and free old config */
-		eq_fir_free_parameters(&cd->config);
-
-		/* Copy new config, find size from header */
+		/* New config, find size from header */
 		cfg = (struct sof_eq_fir_config *)cdata->data->data;
 		bs = cfg->size;
 		trace_eq("fir_cmd_set_data(): blob size: %u", bs);
 		if (bs > SOF_EQ_FIR_MAX_SIZE || bs == 0)
 			return -EINVAL;
 
-		/* Allocate buffer for copy of the blob. */
-		cd->config = rzalloc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM, bs);
-		if (!cd->config) {
-			trace_eq_error("fir_cmd_set_data() error: "
-				       "buffer allocation failed");
-			return -EINVAL;
-		}
-
-		/* Just copy the configuration. The EQ will be initialized in
-		 * prepare().
-		 */
-		memcpy(cd->config, cfg, bs);
+		ret = eq_fir_set_config(dev, cfg);
 		break;
 	default:
 		trace_eq_error("fir_cmd_set_data() error: invalid cdata->cmd");
@@ -644,15 +933,82 @@ static int eq_fir_trigger(struct comp_dev *dev, int cmd)
 	return comp_set_state(dev, cmd);
 }
 
+/* Take a new configuration staged by fir_cmd_set_data() into use at the
+ * period boundary. Responses with unchanged lengths only switch
+ * coefficients and keep the delay lines, otherwise the EQ is set up again.
+ * The old configuration is restored if the new one fails.
+ */
+static void eq_fir_apply_config(struct comp_dev *dev)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	struct sof_eq_fir_config *config;
+	struct sof_eq_fir_config *old;
+	int nch = dev->params.channels;
+	uint32_t flags;
+
+	spin_lock_irq(&dev->lock, flags);
+	config = cd->config_new;
+	cd->config_new = NULL;
+	spin_unlock_irq(&dev->lock, flags);
+
+	if (!config)
+		return;
+
+	old = cd->config;
+	cd->config = config;
+
+	if (old && eq_fir_update_coef(cd, config, nch) == 0) {
+		eq_fir_free_parameters(&old);
+		return;
+	}
+
+	trace_eq("eq_fir_apply_config(), layout changed, setup again");
+	if (eq_fir_setup(cd, dev->pipeline, nch) == 0 &&
+	    set_fir_func(dev) == 0) {
+		eq_fir_free_parameters(&old);
+		return;
+	}
+
+	trace_eq_error("eq_fir_apply_config() error: "
+		       "new configuration failed, keeping old");
+	eq_fir_free_parameters(&cd->config);
+	cd->config = old;
+	if (old && (eq_fir_setup(cd, dev->pipeline, nch) < 0 ||
+		    set_fir_func(dev) < 0)) {
+		trace_eq_error("eq_fir_apply_config() error: "
+			       "old configuration failed");
+		set_pass_func(dev);
+	}
+}
+
+/* filter frames from source r_ptr to sink w_ptr */
+static void eq_fir_process(struct comp_dev *dev, struct comp_buffer *source,
+			   struct comp_buffer *sink, int frames)
+{
+	struct comp_data *sd = comp_get_drvdata(dev);
+	int nch = dev->params.channels;
+
+	if (sd->eq_fir_fft_func)
+		sd->eq_fir_fft_func(sd->fft, source, sink, frames, nch);
+	else if (frames & 1)
+		sd->eq_fir_func(sd->fir, source, sink, frames, nch);
+	else if (frames & 2)
+		sd->eq_fir_func_even(sd->fir, source, sink, frames, nch);
+	else
+		sd->eq_fir_func_4x(sd->fir, source, sink, frames, nch);
+}
+
 /* copy and process stream data from source to sink buffers */
 static int eq_fir_copy(struct comp_dev *dev)
 {
 	struct comp_data *sd = comp_get_drvdata(dev);
 	struct comp_buffer *source;
 	struct comp_buffer *sink;
+	uint32_t frame_bytes = sd->period_bytes / dev->frames;
+	uint32_t frames = dev->frames;
+	uint32_t n;
+	bool skip;
 	int res;
-	int nch = dev->params.channels;
-	struct fir_state_32x16 *fir = sd->fir;
 
 	tracev_comp("eq_fir_copy()");
 
@@ -673,14 +1029,35 @@ static int eq_fir_copy(struct comp_dev *dev)
 		return -EIO;	/* xrun */
 	}
 
-	if (dev->frames & 1)
-		sd->eq_fir_func(fir, source, sink, dev->frames, nch);
-	else
-		sd->eq_fir_func_even(fir, source, sink, dev->frames, nch);
+	/* silence after the responses have decayed filters to zeros */
+	skip = comp_silence_check(&sd->silence, source, sd->period_bytes);
+
+	/* the period is split where scheduled control events apply */
+	while (frames) {
+		n = comp_event_run(dev, frames);
+
+		/* swap in new configuration before processing the part */
+		if (sd->config_new)
+			eq_fir_apply_config(dev);
+
+		if (skip)
+			buffer_zero_bytes(sink, sink->w_ptr, n * frame_bytes);
+		else
+			eq_fir_process(dev, source, sink, n);
+		comp_event_advance(dev, n);
+		frames -= n;
+
+		/* calc new free and available */
+		comp_update_buffer_consume(source, n * frame_bytes);
+		comp_update_buffer_produce(sink, n * frame_bytes);
+	}
 
-	/* calc new free and available */
-	comp_update_buffer_consume(source, sd->period_bytes);
-	comp_update_buffer_produce(sink, sd->period_bytes);
+	comp_silence_count(&sd->silence, dev->frames);
+
+	/* every channel advances its circular delay line */
+	if (!skip && sd->fir_delay)
+		comp_dirty_mark(&sd->delay_dirty, sd->fir_delay,
+				sd->fir_delay_size);
 
 	return dev->frames;
 }
@@ -720,8 +1097,9 @@ static int eq_fir_prepare(struct comp_dev *dev)
 	}
 
 	/* Initialize EQ */
+	dev->can_bypass = 0;
 	if (cd->config) {
-		ret = eq_fir_setup(cd, dev->params.channels);
+		ret = eq_fir_setup(cd, dev->pipeline, dev->params.channels);
 		if (ret < 0) {
 			comp_set_state(dev, COMP_TRIGGER_RESET);
 			return ret;
@@ -732,6 +1110,11 @@ static int eq_fir_prepare(struct comp_dev *dev)
 	}
 
 	ret = set_pass_func(dev);
+
+	/* pipeline can skip a pass-through component */
+	if (!ret)
+		dev->can_bypass = 1;
+
 	return ret;
 }
 
@@ -744,8 +1127,20 @@ static int eq_fir_reset(struct comp_dev *dev)
 
 	eq_fir_free_delaylines(cd);
 
+	/* A configuration staged while running is used in next prepare() */
+	if (cd->config_new) {
+		eq_fir_free_parameters(&cd->config);
+		cd->config = cd->config_new;
+		cd->config_new = NULL;
+	}
+
+	cd->eq_fir_func_4x = eq_fir_s32_passthrough;
 	cd->eq_fir_func_even = eq_fir_s32_passthrough;
 	cd->eq_fir_func = eq_fir_s32_passthrough;
+	cd->eq_fir_fft_func = NULL;
+	cd->fft_mode = false;
+	comp_silence_init(&cd->silence, 0);
+	dev->can_bypass = 0;
 	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++)
 		fir_reset(&cd->fir[i]);
 
@@ -765,9 +1160,7 @@ static void eq_fir_cache(struct comp_dev *dev, int cmd)
 		if (cd->config)
 			dcache_writeback_invalidate_region(cd->config,
 							   cd->config->size);
-		if (cd->fir_delay)
-			dcache_writeback_invalidate_region(cd->fir_delay,
-							   cd->fir_delay_size);
+		comp_dirty_writeback_inv(&cd->delay_dirty);
 
 		dcache_writeback_invalidate_region(cd, sizeof(*cd));
 		dcache_writeback_invalidate_region(dev, sizeof(*dev));
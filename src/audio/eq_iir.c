@@ -45,9 +45,11 @@
 #include <sof/audio/component.h>
 #include <sof/audio/pipeline.h>
 #include <sof/audio/format.h>
+#include <sof/math/numbers.h>
 #include <uapi/ipc/control.h>
 #include <uapi/user/eq.h>
 #include "eq_iir.h"
+#include "iir_config.h"
 #include "iir.h"
 
 #ifdef MODULE_TEST
@@ -63,18 +65,31 @@
 struct comp_data {
 	struct iir_state_df2t iir[PLATFORM_MAX_CHANNELS];
 	struct sof_eq_iir_config *config;
+	struct sof_eq_iir_config *config_new; /* staged while running */
 	uint32_t source_period_bytes;
 	uint32_t sink_period_bytes;
 	enum sof_ipc_frame source_format;	/**< source frame format */
 	enum sof_ipc_frame sink_format;		/**< sink frame format */
 	int64_t *iir_delay;
 	size_t iir_delay_size;
+	struct comp_dirty delay_dirty;	/* delay written since writeback */
+	struct comp_silence silence;	/* skip filters on decayed silence */
 	void (*eq_iir_func)(struct comp_dev *dev,
 			    struct comp_buffer *source,
 			    struct comp_buffer *sink,
 			    uint32_t frames);
 };
 
+/* Silent input time after which the IIR state is taken as decayed. The
+ * response never reaches exact zero, so the state is cleared at that point.
+ */
+#define EQ_IIR_DECAY_MS		1000
+
+static inline uint32_t eq_iir_decay_frames(struct comp_dev *dev)
+{
+	return dev->params.rate * EQ_IIR_DECAY_MS / 1000;
+}
+
 /*
  * EQ IIR algorithm code
  */
@@ -139,6 +154,9 @@ static void eq_iir_s32_24_pass(struct comp_dev *dev,
 	}
 }
 
+/* The processing functions gather one channel at a time into a block of
+ * Q1.31 samples, filter the block and scatter it back to the sink.
+ */
 static void eq_iir_s16_default(struct comp_dev *dev,
 			       struct comp_buffer *source,
 			       struct comp_buffer *sink,
@@ -147,24 +165,32 @@ static void eq_iir_s16_default(struct comp_dev *dev,
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
 	struct iir_state_df2t *filter;
-	int16_t *src = (int16_t *)source->r_ptr;
-	int16_t *snk = (int16_t *)sink->w_ptr;
 	int16_t *x;
 	int16_t *y;
-	int32_t z;
+	int32_t buf[IIR_DF2T_BLOCK_SIZE];
 	int ch;
 	int i;
+	int f;
+	int n;
 	int nch = dev->params.channels;
 
 	for (ch = 0; ch < nch; ch++) {
 		filter = &cd->iir[ch];
-		x = src++;
-		y = snk++;
-		for (i = 0; i < frames; i++) {
-			z = iir_df2t(filter, *x << 16);
-			*y = sat_int16(Q_SHIFT_RND(z, 31, 15));
-			x += nch;
-			y += nch;
+		x = (int16_t *)source->r_ptr + ch;
+		y = (int16_t *)sink->w_ptr + ch;
+		for (f = 0; f < frames; f += n) {
+			n = MIN(frames - f, IIR_DF2T_BLOCK_SIZE);
+			for (i = 0; i < n; i++) {
+				buf[i] = *x << 16;
+				x = buffer_wrap(source, x + nch);
+			}
+
+			iir_df2t_block(filter, buf, buf, n);
+
+			for (i = 0; i < n; i++) {
+				*y = sat_int16(Q_SHIFT_RND(buf[i], 31, 15));
+				y = buffer_wrap(sink, y + nch);
+			}
 		}
 	}
 }
@@ -177,24 +203,32 @@ static void eq_iir_s24_default(struct comp_dev *dev,
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
 	struct iir_state_df2t *filter;
-	int32_t *src = (int32_t *)source->r_ptr;
-	int32_t *snk = (int32_t *)sink->w_ptr;
 	int32_t *x;
 	int32_t *y;
-	int32_t z;
+	int32_t buf[IIR_DF2T_BLOCK_SIZE];
 	int ch;
 	int i;
+	int f;
+	int n;
 	int nch = dev->params.channels;
 
 	for (ch = 0; ch < nch; ch++) {
 		filter = &cd->iir[ch];
-		x = src++;
-		y = snk++;
-		for (i = 0; i < frames; i++) {
-			z = iir_df2t(filter, *x << 8);
-			*y = sat_int24(Q_SHIFT_RND(z, 31, 23));
-			x += nch;
-			y += nch;
+		x = (int32_t *)source->r_ptr + ch;
+		y = (int32_t *)sink->w_ptr + ch;
+		for (f = 0; f < frames; f += n) {
+			n = MIN(frames - f, IIR_DF2T_BLOCK_SIZE);
+			for (i = 0; i < n; i++) {
+				buf[i] = *x << 8;
+				x = buffer_wrap(source, x + nch);
+			}
+
+			iir_df2t_block(filter, buf, buf, n);
+
+			for (i = 0; i < n; i++) {
+				*y = sat_int24(Q_SHIFT_RND(buf[i], 31, 23));
+				y = buffer_wrap(sink, y + nch);
+			}
 		}
 	}
 }
@@ -207,22 +241,32 @@ static void eq_iir_s32_default(struct comp_dev *dev,
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
 	struct iir_state_df2t *filter;
-	int32_t *src = (int32_t *)source->r_ptr;
-	int32_t *snk = (int32_t *)sink->w_ptr;
 	int32_t *x;
 	int32_t *y;
+	int32_t buf[IIR_DF2T_BLOCK_SIZE];
 	int ch;
 	int i;
+	int f;
+	int n;
 	int nch = dev->params.channels;
 
 	for (ch = 0; ch < nch; ch++) {
 		filter = &cd->iir[ch];
-		x = src++;
-		y = snk++;
-		for (i = 0; i < frames; i++) {
-			*y = iir_df2t(filter, *x);
-			x += nch;
-			y += nch;
+		x = (int32_t *)source->r_ptr + ch;
+		y = (int32_t *)sink->w_ptr + ch;
+		for (f = 0; f < frames; f += n) {
+			n = MIN(frames - f, IIR_DF2T_BLOCK_SIZE);
+			for (i = 0; i < n; i++) {
+				buf[i] = *x;
+				x = buffer_wrap(source, x + nch);
+			}
+
+			iir_df2t_block(filter, buf, buf, n);
+
+			for (i = 0; i < n; i++) {
+				*y = buf[i];
+				y = buffer_wrap(sink, y + nch);
+			}
 		}
 	}
 }
@@ -235,22 +279,32 @@ static void eq_iir_s32_16_default(struct comp_dev *dev,
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
 	struct iir_state_df2t *filter;
-	int32_t *src = (int32_t *)source->r_ptr;
-	int16_t *snk = (int16_t *)sink->w_ptr;
 	int32_t *x;
 	int16_t *y;
+	int32_t buf[IIR_DF2T_BLOCK_SIZE];
 	int ch;
 	int i;
+	int f;
+	int n;
 	int nch = dev->params.channels;
 
 	for (ch = 0; ch < nch; ch++) {
 		filter = &cd->iir[ch];
-		x = src++;
-		y = snk++;
-		for (i = 0; i < frames; i++) {
-			*y = iir_df2t(filter, *x) >> 16;
-			x += nch;
-			y += nch;
+		x = (int32_t *)source->r_ptr + ch;
+		y = (int16_t *)sink->w_ptr + ch;
+		for (f = 0; f < frames; f += n) {
+			n = MIN(frames - f, IIR_DF2T_BLOCK_SIZE);
+			for (i = 0; i < n; i++) {
+				buf[i] = *x;
+				x = buffer_wrap(source, x + nch);
+			}
+
+			iir_df2t_block(filter, buf, buf, n);
+
+			for (i = 0; i < n; i++) {
+				*y = buf[i] >> 16;
+				y = buffer_wrap(sink, y + nch);
+			}
 		}
 	}
 }
@@ -263,36 +317,192 @@ static void eq_iir_s32_24_default(struct comp_dev *dev,
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
 	struct iir_state_df2t *filter;
-	int32_t *src = (int32_t *)source->r_ptr;
-	int32_t *snk = (int32_t *)sink->w_ptr;
 	int32_t *x;
 	int32_t *y;
+	int32_t buf[IIR_DF2T_BLOCK_SIZE];
 	int ch;
 	int i;
+	int f;
+	int n;
 	int nch = dev->params.channels;
 
 	for (ch = 0; ch < nch; ch++) {
 		filter = &cd->iir[ch];
-		x = src++;
-		y = snk++;
-		for (i = 0; i < frames; i++) {
-			*y = iir_df2t(filter, *x) >> 8;
-			x += nch;
-			y += nch;
+		x = (int32_t *)source->r_ptr + ch;
+		y = (int32_t *)sink->w_ptr + ch;
+		for (f = 0; f < frames; f += n) {
+			n = MIN(frames - f, IIR_DF2T_BLOCK_SIZE);
+			for (i = 0; i < n; i++) {
+				buf[i] = *x;
+				x = buffer_wrap(source, x + nch);
+			}
+
+			iir_df2t_block(filter, buf, buf, n);
+
+			for (i = 0; i < n; i++) {
+				*y = buf[i] >> 8;
+				y = buffer_wrap(sink, y + nch);
+			}
+		}
+	}
+}
+
+#if IIR_HIFI3
+
+/* Process channels in pairs with the two channel IIR when the pair has
+ * identical filter structure, otherwise one channel at a time.
+ */
+static void eq_iir_s16_2x(struct comp_dev *dev,
+			  struct comp_buffer *source,
+			  struct comp_buffer *sink,
+			  uint32_t frames)
+
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	int16_t *src = (int16_t *)source->r_ptr;
+	int16_t *snk = (int16_t *)sink->w_ptr;
+	int16_t *x;
+	int16_t *y;
+	int32_t z0;
+	int32_t z1;
+	int ch;
+	int i;
+	int n;
+	int nch = dev->params.channels;
+
+	for (ch = 0; ch < nch; ch += n) {
+		x = src + ch;
+		y = snk + ch;
+		if (ch + 1 < nch &&
+		    iir_df2t_2x_supported(&cd->iir[ch], &cd->iir[ch + 1])) {
+			n = 2;
+			for (i = 0; i < frames; i++) {
+				iir_df2t_2x(&cd->iir[ch], &cd->iir[ch + 1],
+					    x[0] << 16, x[1] << 16, &z0, &z1);
+				y[0] = sat_int16(Q_SHIFT_RND(z0, 31, 15));
+				y[1] = sat_int16(Q_SHIFT_RND(z1, 31, 15));
+				x += nch;
+				y += nch;
+			}
+		} else {
+			n = 1;
+			for (i = 0; i < frames; i++) {
+				z0 = iir_df2t(&cd->iir[ch], *x << 16);
+				*y = sat_int16(Q_SHIFT_RND(z0, 31, 15));
+				x += nch;
+				y += nch;
+			}
+		}
+	}
+}
+
+static void eq_iir_s24_2x(struct comp_dev *dev,
+			  struct comp_buffer *source,
+			  struct comp_buffer *sink,
+			  uint32_t frames)
+
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	int32_t *src = (int32_t *)source->r_ptr;
+	int32_t *snk = (int32_t *)sink->w_ptr;
+	int32_t *x;
+	int32_t *y;
+	int32_t z0;
+	int32_t z1;
+	int ch;
+	int i;
+	int n;
+	int nch = dev->params.channels;
+
+	for (ch = 0; ch < nch; ch += n) {
+		x = src + ch;
+		y = snk + ch;
+		if (ch + 1 < nch &&
+		    iir_df2t_2x_supported(&cd->iir[ch], &cd->iir[ch + 1])) {
+			n = 2;
+			for (i = 0; i < frames; i++) {
+				iir_df2t_2x(&cd->iir[ch], &cd->iir[ch + 1],
+					    x[0] << 8, x[1] << 8, &z0, &z1);
+				y[0] = sat_int24(Q_SHIFT_RND(z0, 31, 23));
+				y[1] = sat_int24(Q_SHIFT_RND(z1, 31, 23));
+				x += nch;
+				y += nch;
+			}
+		} else {
+			n = 1;
+			for (i = 0; i < frames; i++) {
+				z0 = iir_df2t(&cd->iir[ch], *x << 8);
+				*y = sat_int24(Q_SHIFT_RND(z0, 31, 23));
+				x += nch;
+				y += nch;
+			}
 		}
 	}
 }
 
+static void eq_iir_s32_2x(struct comp_dev *dev,
+			  struct comp_buffer *source,
+			  struct comp_buffer *sink,
+			  uint32_t frames)
+
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	int32_t *src = (int32_t *)source->r_ptr;
+	int32_t *snk = (int32_t *)sink->w_ptr;
+	int32_t *x;
+	int32_t *y;
+	int ch;
+	int i;
+	int n;
+	int nch = dev->params.channels;
+
+	for (ch = 0; ch < nch; ch += n) {
+		x = src + ch;
+		y = snk + ch;
+		if (ch + 1 < nch &&
+		    iir_df2t_2x_supported(&cd->iir[ch], &cd->iir[ch + 1])) {
+			n = 2;
+			for (i = 0; i < frames; i++) {
+				iir_df2t_2x(&cd->iir[ch], &cd->iir[ch + 1],
+					    x[0], x[1], &y[0], &y[1]);
+				x += nch;
+				y += nch;
+			}
+		} else {
+			n = 1;
+			for (i = 0; i < frames; i++) {
+				*y = iir_df2t(&cd->iir[ch], *x);
+				x += nch;
+				y += nch;
+			}
+		}
+	}
+}
+
+#endif
+
 const struct eq_iir_func_map fm_configured[] = {
+#if IIR_HIFI3
+	{SOF_IPC_FRAME_S16_LE,  SOF_IPC_FRAME_S16_LE,  eq_iir_s16_2x},
+#else
 	{SOF_IPC_FRAME_S16_LE,  SOF_IPC_FRAME_S16_LE,  eq_iir_s16_default},
+#endif
 	{SOF_IPC_FRAME_S16_LE,  SOF_IPC_FRAME_S24_4LE, NULL},
 	{SOF_IPC_FRAME_S16_LE,  SOF_IPC_FRAME_S32_LE,  NULL},
 	{SOF_IPC_FRAME_S24_4LE, SOF_IPC_FRAME_S16_LE,  NULL},
+#if IIR_HIFI3
+	{SOF_IPC_FRAME_S24_4LE, SOF_IPC_FRAME_S24_4LE, eq_iir_s24_2x},
+#else
 	{SOF_IPC_FRAME_S24_4LE, SOF_IPC_FRAME_S24_4LE, eq_iir_s24_default},
+#endif
 	{SOF_IPC_FRAME_S24_4LE, SOF_IPC_FRAME_S32_LE,  NULL},
 	{SOF_IPC_FRAME_S32_LE,  SOF_IPC_FRAME_S16_LE,  eq_iir_s32_16_default},
 	{SOF_IPC_FRAME_S32_LE,  SOF_IPC_FRAME_S24_4LE, eq_iir_s32_24_default},
+#if IIR_HIFI3
+	{SOF_IPC_FRAME_S32_LE,  SOF_IPC_FRAME_S32_LE,  eq_iir_s32_2x},
+#else
 	{SOF_IPC_FRAME_S32_LE,  SOF_IPC_FRAME_S32_LE,  eq_iir_s32_default},
+#endif
 };
 
 const struct eq_iir_func_map fm_passthrough[] = {
@@ -328,7 +538,7 @@ static eq_iir_func eq_iir_find_func(struct comp_data *cd,
 
 static void eq_iir_free_parameters(struct sof_eq_iir_config **config)
 {
-	rfree(*config);
+	comp_blob_put(*config);
 	*config = NULL;
 }
 
@@ -337,33 +547,26 @@ static void eq_iir_free_delaylines(struct comp_data *cd)
 	struct iir_state_df2t *iir = cd->iir;
 	int i = 0;
 
-	/* Free the common buffer for all EQs and point then
-	 * each IIR channel delay line to NULL.
+	/* The common buffer for all EQs is owned by the pipeline arena,
+	 * drop it and point then each IIR channel delay line to NULL.
 	 */
-	rfree(cd->iir_delay);
+	cd->iir_delay = NULL;
 	cd->iir_delay_size = 0;
+	comp_dirty_clear(&cd->delay_dirty);
 	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++)
 		iir[i].delay = NULL;
 }
 
-static int eq_iir_setup(struct comp_data *cd, int nch)
+/* Check the blob and collect the start of each response */
+static int eq_iir_init_lookup(struct sof_eq_iir_config *config, int nch,
+			      struct sof_eq_iir_header_df2t *lookup[])
 {
-	struct iir_state_df2t *iir = cd->iir;
-	struct sof_eq_iir_config *config = cd->config;
-	struct sof_eq_iir_header_df2t *lookup[SOF_EQ_IIR_MAX_RESPONSES];
 	struct sof_eq_iir_header_df2t *eq;
-	int64_t *iir_delay;
-	int32_t *coef_data, *assign_response;
-	size_t s;
-	size_t size_sum = 0;
+	int32_t *coef_data;
 	int i;
 	int j;
-	int resp;
-
-	/* Free existing IIR channels data if it was allocated */
-	eq_iir_free_delaylines(cd);
 
-	trace_eq("eq_iir_setup(), "
+	trace_eq("eq_iir_init_lookup(), "
 		 "channels_in_config = %u, number_of_responses = %u",
 		 config->channels_in_config, config->number_of_responses);
 
@@ -371,23 +574,22 @@ static int eq_iir_setup(struct comp_data *cd, int nch)
 	if (nch > PLATFORM_MAX_CHANNELS ||
 	    config->channels_in_config > PLATFORM_MAX_CHANNELS ||
 	    !config->channels_in_config) {
-		trace_eq_error("eq_iir_setup() error: "
+		trace_eq_error("eq_iir_init_lookup() error: "
 			       "invalid nch or channels_in_config");
 		return -EINVAL;
 	}
 	if (config->number_of_responses > SOF_EQ_IIR_MAX_RESPONSES) {
-		trace_eq_error("eq_iir_setup() error: number_of_responses"
-			       " > SOF_EQ_IIR_MAX_RESPONSES");
+		trace_eq_error("eq_iir_init_lookup() error: "
+			       "number_of_responses > SOF_EQ_IIR_MAX_RESPONSES");
 		return -EINVAL;
 	}
 
 	/* Collect index of response start positions in all_coefficients[]  */
 	j = 0;
-	assign_response = &config->data[0];
 	coef_data = &config->data[config->channels_in_config];
 	for (i = 0; i < SOF_EQ_IIR_MAX_RESPONSES; i++) {
 		if (i < config->number_of_responses) {
-			trace_eq("eq_iir_setup(), "
+			trace_eq("eq_iir_init_lookup(), "
 				 "index of respose start position = %u", j);
 			eq = (struct sof_eq_iir_header_df2t *)&coef_data[j];
 			lookup[i] = eq;
@@ -398,19 +600,82 @@ static int eq_iir_setup(struct comp_data *cd, int nch)
 		}
 	}
 
-	/* Initialize 1st phase */
+	return 0;
+}
+
+/* Get the response assigned to channel. If the blob has smaller channel map
+ * then apply for additional channels the response that was used for the
+ * first channel. This allows to use mono blobs to setup multi channel
+ * equalization without stopping to an error.
+ */
+static int eq_iir_get_response(struct sof_eq_iir_config *config, int ch)
+{
+	if (ch < config->channels_in_config)
+		return config->data[ch];
+
+	return config->data[0];
+}
+
+/* Switch channels to new responses with the same layout without touching
+ * the filter state, returns error if the layout has changed.
+ */
+static int eq_iir_update_coef(struct comp_data *cd,
+			      struct sof_eq_iir_config *config, int nch)
+{
+	struct sof_eq_iir_header_df2t *lookup[SOF_EQ_IIR_MAX_RESPONSES];
+	int resp;
+	int ret;
+	int i;
+
+	ret = eq_iir_init_lookup(config, nch, lookup);
+	if (ret < 0)
+		return ret;
+
 	for (i = 0; i < nch; i++) {
-		/* Check for not reading past blob response to channel assign
-		 * map. If the blob has smaller channel map then apply for
-		 * additional channels the response that was used for the first
-		 * channel. This allows to use mono blobs to setup multi
-		 * channel equalization without stopping to an error.
-		 */
-		if (i < config->channels_in_config)
-			resp = assign_response[i];
-		else
-			resp = assign_response[0];
+		resp = eq_iir_get_response(config, i);
+		if (resp >= config->number_of_responses)
+			return -EINVAL;
 
+		if (resp < 0) {
+			if (cd->iir[i].biquads)
+				return -EINVAL;
+			continue;
+		}
+
+		ret = iir_update_coef_df2t(&cd->iir[i], lookup[resp]);
+		if (ret < 0)
+			return ret;
+	}
+
+	return 0;
+}
+
+static int eq_iir_setup(struct comp_data *cd, struct pipeline *p, int nch)
+{
+	struct iir_state_df2t *iir = cd->iir;
+	int64_t *old_delay = cd->iir_delay;
+	size_t old_size = cd->iir_delay_size;
+	struct sof_eq_iir_config *config = cd->config;
+	struct sof_eq_iir_header_df2t *lookup[SOF_EQ_IIR_MAX_RESPONSES];
+	struct sof_eq_iir_header_df2t *eq;
+	int64_t *iir_delay;
+	size_t s;
+	size_t size_sum = 0;
+	int ret;
+	int i;
+	int resp;
+
+	/* Drop existing IIR channels data, it is reused below if it fits */
+	eq_iir_free_delaylines(cd);
+
+	ret = eq_iir_init_lookup(config, nch, lookup);
+	if (ret < 0)
+		return ret;
+
+
+	/* Initialize 1st phase */
+	for (i = 0; i < nch; i++) {
+		resp = eq_iir_get_response(config, i);
 		if (resp < 0) {
 			/* Initialize EQ channel to bypass and continue with
 			 * next channel response.
@@ -437,21 +702,26 @@ static int eq_iir_setup(struct comp_data *cd, int nch)
 	/* If all channels were set to bypass there's no need to
 	 * allocate delay. Just return with success.
 	 */
-	cd->iir_delay = NULL;
-	cd->iir_delay_size = size_sum;
 	if (!size_sum)
 		return 0;
+
 	/* Allocate all IIR channels data in a big chunk and clear it */
-	cd->iir_delay = rzalloc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM, size_sum);
+	if (old_delay && old_size >= size_sum)
+		cd->iir_delay = old_delay;
+	else
+		cd->iir_delay = pipeline_arena_alloc(p, size_sum);
 	if (!cd->iir_delay)
 		return -ENOMEM;
 
+	cd->iir_delay_size = size_sum;
 	memset(cd->iir_delay, 0, size_sum);
+	comp_dirty_clear(&cd->delay_dirty);
+	comp_dirty_mark(&cd->delay_dirty, cd->iir_delay, size_sum);
 
 	/* Initialize 2nd phase to set EQ delay lines pointers */
 	iir_delay = cd->iir_delay;
 	for (i = 0; i < nch; i++) {
-		resp = assign_response[i];
+		resp = eq_iir_get_response(config, i);
 		if (resp >= 0)
 			iir_init_delay_df2t(&iir[i], &iir_delay);
 	}
@@ -522,23 +792,23 @@ static struct comp_dev *eq_iir_new(struct sof_ipc_comp *comp)
 	cd->iir_delay_size = 0;
 	cd->config = NULL;
 
-	/* Allocate and make a copy of the coefficients blob and reset IIR. If
-	 * the EQ is configured later in run-time the size is zero.
+	/* Get the coefficients blob, shared with the other EQs of the same
+	 * configuration, and reset IIR. If the EQ is configured later in
+	 * run-time the size is zero.
 	 */
 	if (bs) {
-		cd->config = rzalloc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM, bs);
+		cd->config = comp_blob_get(ipc_iir->data, bs);
 		if (!cd->config) {
 			rfree(dev);
 			rfree(cd);
 			return NULL;
 		}
-
-		memcpy(cd->config, ipc_iir->data, bs);
 	}
 
 	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++)
 		iir_reset_df2t(&cd->iir[i]);
 
+	dev->can_idle = 1;
 	dev->state = COMP_STATE_READY;
 	return dev;
 }
@@ -551,6 +821,7 @@ static void eq_iir_free(struct comp_dev *dev)
 
 	eq_iir_free_delaylines(cd);
 	eq_iir_free_parameters(&cd->config);
+	eq_iir_free_parameters(&cd->config_new);
 
 	rfree(cd);
 	rfree(dev);
@@ -565,6 +836,58 @@ static int eq_iir_params(struct comp_dev *dev)
 	return 0;
 }
 
+/* Private copy of the newest configuration for changing it */
+static struct sof_eq_iir_config *eq_iir_config_copy(struct comp_data *cd)
+{
+	struct sof_eq_iir_config *config = cd->config_new ?
+		cd->config_new : cd->config;
+	struct sof_eq_iir_config *copy;
+
+	if (!config)
+		return NULL;
+
+	copy = rballoc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM, config->size);
+	if (copy)
+		memcpy(copy, config, config->size);
+
+	return copy;
+}
+
+/* Use the blob of a new configuration, shared with other EQs */
+static int eq_iir_set_config(struct comp_dev *dev,
+			     struct sof_eq_iir_config *cfg)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	struct sof_eq_iir_config *new_config;
+	struct sof_eq_iir_config *old_config;
+	uint32_t flags;
+
+	new_config = comp_blob_get(cfg, cfg->size);
+	if (!new_config) {
+		trace_eq_error("eq_iir_set_config() error: alloc failed");
+		return -EINVAL;
+	}
+
+	if (dev->state == COMP_STATE_READY) {
+		/* The EQ will be initialized in prepare() */
+		eq_iir_free_parameters(&cd->config);
+		cd->config = new_config;
+		return 0;
+	}
+
+	/* During playback/capture the new configuration is staged
+	 * and swapped in by copy() at the next period. A staged
+	 * configuration that was not yet used is replaced.
+	 */
+	spin_lock_irq(&dev->lock, flags);
+	old_config = cd->config_new;
+	cd->config_new = new_config;
+	spin_unlock_irq(&dev->lock, flags);
+
+	eq_iir_free_parameters(&old_config);
+	return 0;
+}
+
 static int iir_cmd_get_data(struct comp_dev *dev,
 			    struct sof_ipc_ctrl_data *cdata, int max_size)
 {
@@ -622,13 +945,22 @@ static int iir_cmd_set_data(struct comp_dev *dev,
 		trace_eq("iir_cmd_set_data(), SOF_CTRL_CMD_ENUM");
 		compv = (struct sof_ipc_ctrl_value_comp *)cdata->data->data;
 		if (cdata->index == SOF_EQ_IIR_IDX_SWITCH) {
+			/* The blob may be shared, the responses are switched
+			 * in a copy that is then set like a new blob.
+			 */
+			cfg = eq_iir_config_copy(cd);
+			if (!cfg) {
+				trace_eq_error("iir_cmd_set_data() error: "
+					       "no configuration to switch");
+				return -EINVAL;
+			}
+
 			for (i = 0; i < (int)cdata->num_elems; i++) {
 				trace_eq("iir_cmd_set_data(),"
 					"SOF_EQ_IIR_IDX_SWITCH, "
 					"compv index = %u, svalue = %u",
 					compv[i].index, compv[i].svalue);
-				ret = eq_iir_switch_store(cd->iir,
-							  cd->config,
+				ret = eq_iir_switch_store(cd->iir, cfg,
 							  compv[i].index,
 							  compv[i].svalue);
 				if (ret < 0) {
@@ -636,9 +968,13 @@ static int iir_cmd_set_data(struct comp_dev *dev,
 						       "error:"
 						       "eq_iir_switch_store()"
 						       " failed");
+					rfree(cfg);
 					return -EINVAL;
 				}
 			}
+
+			ret = eq_iir_set_config(dev, cfg);
+			rfree(cfg);
 		} else {
 			trace_eq_error("iir_cmd_set_data() error:"
 				       "invalid cdata->index = %u",
@@ -649,22 +985,7 @@ static int iir_cmd_set_data(struct comp_dev *dev,
 	case SOF_CTRL_CMD_BINARY:
 		trace_eq("iir_cmd_set_data(), SOF_CTRL_CMD_BINARY");
 
-		if (dev->state != COMP_STATE_READY) {
-			/* It is a valid request but currently this is not
-			 * supported during playback/capture. The driver will
-			 * re-send data in next resume when idle and the new
-			 * EQ configuration will be used when playback/capture
-			 * starts.
-			 */
-			trace_eq_error("iir_cmd_set_data() error: "
-				       "driver is busy");
-			return -EBUSY;
-		}
-
-		/* Check and free old config */
-		eq_iir_free_parameters(&cd->config);
-
-		/* Copy new config, find size from header */
+		/* New config, find size from header */
 		cfg = (struct sof_eq_iir_config *)cdata->data->data;
 		bs = cfg->size;
 		trace_eq("iir_cmd_set_data(), blob size = %u", bs);
@@ -674,18 +995,7 @@ static int iir_cmd_set_data(struct comp_dev *dev,
 			return -EINVAL;
 		}
 
-		/* Allocate and make a copy of the blob and setup IIR */
-		cd->config = rzalloc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM, bs);
-		if (!cd->config) {
-			trace_eq_error("iir_cmd_set_data() error: "
-				       "alloc failed");
-			return -EINVAL;
-		}
-
-		/* Just copy the configurate. The EQ will be initialized in
-		 * prepare().
-		 */
-		memcpy(cd->config, cdata->data->data, bs);
+		ret = eq_iir_set_config(dev, cfg);
 		break;
 	default:
 		trace_eq_error("iir_cmd_set_data() error: invalid cdata->cmd");
@@ -733,15 +1043,76 @@ static int eq_iir_trigger(struct comp_dev *dev, int cmd)
 	return comp_set_state(dev, cmd);
 }
 
+/* Take a new configuration staged by iir_cmd_set_data() into use at the
+ * period boundary. Responses with unchanged layout only switch coefficients
+ * and keep the filter state, otherwise the EQ is set up again. The old
+ * configuration is restored if the new one fails.
+ */
+static void eq_iir_apply_config(struct comp_dev *dev)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	struct sof_eq_iir_config *config;
+	struct sof_eq_iir_config *old;
+	eq_iir_func func;
+	int nch = dev->params.channels;
+	uint32_t flags;
+	int ret;
+
+	spin_lock_irq(&dev->lock, flags);
+	config = cd->config_new;
+	cd->config_new = NULL;
+	spin_unlock_irq(&dev->lock, flags);
+
+	if (!config)
+		return;
+
+	old = cd->config;
+	cd->config = config;
+
+	if (old && eq_iir_update_coef(cd, config, nch) == 0) {
+		eq_iir_free_parameters(&old);
+		return;
+	}
+
+	trace_eq("eq_iir_apply_config(), layout changed, setup again");
+	ret = eq_iir_setup(cd, dev->pipeline, nch);
+	if (ret == 0) {
+		func = eq_iir_find_func(cd, fm_configured,
+					ARRAY_SIZE(fm_configured));
+		if (func) {
+			cd->eq_iir_func = func;
+			comp_silence_init(&cd->silence,
+					  eq_iir_decay_frames(dev));
+			eq_iir_free_parameters(&old);
+			return;
+		}
+	}
+
+	trace_eq_error("eq_iir_apply_config() error: "
+		       "new configuration failed, keeping old");
+	eq_iir_free_parameters(&cd->config);
+	cd->config = old;
+	if (old && eq_iir_setup(cd, dev->pipeline, nch) < 0) {
+		trace_eq_error("eq_iir_apply_config() error: "
+			       "old configuration failed");
+		cd->eq_iir_func = eq_iir_s32_pass;
+	}
+}
+
 /* copy and process stream data from source to sink buffers */
 static int eq_iir_copy(struct comp_dev *dev)
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
 	struct comp_buffer *source;
 	struct comp_buffer *sink;
+	bool skipped;
 
 	tracev_comp("eq_iir_copy()");
 
+	/* swap in new configuration before processing the period */
+	if (cd->config_new)
+		eq_iir_apply_config(dev);
+
 	/* get source and sink buffers */
 	source = list_first_item(&dev->bsource_list, struct comp_buffer,
 				 sink_list);
@@ -752,14 +1123,14 @@ static int eq_iir_copy(struct comp_dev *dev)
 	 * the sink component buffer has enough free bytes for copy. Also
 	 * check for XRUNs
 	 */
-	if (source->avail < cd->source_period_bytes) {
+	if (comp_buffer_get_avail_bytes(source) < cd->source_period_bytes) {
 		trace_eq_error("eq_iir_copy() error: "
 			       "source component buffer"
 			       " has not enough data available");
 		comp_underrun(dev, source, cd->source_period_bytes, 0);
 		return -EIO;	/* xrun */
 	}
-	if (sink->free < cd->sink_period_bytes) {
+	if (comp_buffer_get_free_bytes(sink) < cd->sink_period_bytes) {
 		trace_eq_error("eq_iir_copy() error: "
 			       "sink component buffer"
 			       " has not enough free bytes for copy");
@@ -767,7 +1138,26 @@ static int eq_iir_copy(struct comp_dev *dev)
 		return -EIO;	/* xrun */
 	}
 
-	cd->eq_iir_func(dev, source, sink, dev->frames);
+	skipped = cd->silence.skip;
+	if (comp_silence_check(&cd->silence, source,
+			       cd->source_period_bytes)) {
+		/* clear the decayed tail once, processing resumes from rest */
+		if (!skipped && cd->iir_delay) {
+			bzero(cd->iir_delay, cd->iir_delay_size);
+			comp_dirty_mark(&cd->delay_dirty, cd->iir_delay,
+					cd->iir_delay_size);
+		}
+
+		buffer_zero_bytes(sink, sink->w_ptr, cd->sink_period_bytes);
+	} else {
+		cd->eq_iir_func(dev, source, sink, dev->frames);
+
+		/* every section of every channel updates its state */
+		if (cd->iir_delay)
+			comp_dirty_mark(&cd->delay_dirty, cd->iir_delay,
+					cd->iir_delay_size);
+	}
+	comp_silence_count(&cd->silence, dev->frames);
 
 	/* calc new free and available */
 	comp_update_buffer_consume(source, cd->source_period_bytes);
@@ -821,8 +1211,10 @@ static int eq_iir_prepare(struct comp_dev *dev)
 	/* Initialize EQ */
 	trace_eq("eq_iir_prepare(), source_format=%d, sink_format=%d",
 		 cd->source_format, cd->sink_format);
+	dev->can_bypass = 0;
+	comp_silence_init(&cd->silence, 0);
 	if (cd->config) {
-		ret = eq_iir_setup(cd, dev->params.channels);
+		ret = eq_iir_setup(cd, dev->pipeline, dev->params.channels);
 		if (ret < 0) {
 			trace_eq_error("eq_iir_prepare() error: "
 				       "eq_iir_setup failed.");
@@ -838,6 +1230,7 @@ static int eq_iir_prepare(struct comp_dev *dev)
 			cd->eq_iir_func = eq_iir_s32_pass;
 			return -EINVAL;
 		}
+		comp_silence_init(&cd->silence, eq_iir_decay_frames(dev));
 		trace_eq("eq_iir_prepare(), IIR is configured.");
 	} else {
 		cd->eq_iir_func = eq_iir_find_func(cd, fm_passthrough,
@@ -850,6 +1243,9 @@ static int eq_iir_prepare(struct comp_dev *dev)
 			return -EINVAL;
 		}
 		trace_eq("eq_iir_prepare(), pass-through mode.");
+
+		/* pipeline can skip a pass-through without format conversion */
+		dev->can_bypass = cd->source_format == cd->sink_format;
 	}
 	return 0;
 }
@@ -863,7 +1259,16 @@ static int eq_iir_reset(struct comp_dev *dev)
 
 	eq_iir_free_delaylines(cd);
 
+	/* A configuration staged while running is used in next prepare() */
+	if (cd->config_new) {
+		eq_iir_free_parameters(&cd->config);
+		cd->config = cd->config_new;
+		cd->config_new = NULL;
+	}
+
 	cd->eq_iir_func = eq_iir_s32_default;
+	comp_silence_init(&cd->silence, 0);
+	dev->can_bypass = 0;
 	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++)
 		iir_reset_df2t(&cd->iir[i]);
 
@@ -884,9 +1289,7 @@ static void eq_iir_cache(struct comp_dev *dev, int cmd)
 			dcache_writeback_invalidate_region(cd->config,
 							   cd->config->size);
 
-		if (cd->iir_delay)
-			dcache_writeback_invalidate_region(cd->iir_delay,
-							   cd->iir_delay_size);
+		comp_dirty_writeback_inv(&cd->delay_dirty);
 
 		dcache_writeback_invalidate_region(cd, sizeof(*cd));
 		dcache_writeback_invalidate_region(dev, sizeof(*dev));
@@ -75,14 +75,32 @@ size_t fir_init_coef(struct fir_state_32x16 *fir,
 	return fir->length * sizeof(int32_t);
 }
 
+/* Point to new coefficients but keep the filter state. The new response
+ * must have the same length, NULL config checks that the FIR is in bypass.
+ */
+int fir_update_coef(struct fir_state_32x16 *fir,
+		    struct sof_eq_fir_coef_data *config)
+{
+	if (!config)
+		return fir->length ? -EINVAL : 0;
+
+	if (fir->length != config->length || !fir->delay)
+		return -EINVAL;
+
+	fir->out_shift = (int)config->out_shift;
+	fir->coef = &config->coef[0];
+	return 0;
+}
+
 void fir_init_delay(struct fir_state_32x16 *fir, int32_t **data)
 {
 	fir->delay = *data;
 	*data += fir->length; /* Point to next delay line start */
 }
 
-void eq_fir_s16(struct fir_state_32x16 fir[], struct comp_buffer *source,
-		struct comp_buffer *sink, int frames, int nch)
+void __hot_text eq_fir_s16(struct fir_state_32x16 fir[],
+			   struct comp_buffer *source, struct comp_buffer *sink,
+			   int frames, int nch)
 {
 	struct fir_state_32x16 *filter;
 	int16_t *src = (int16_t *)source->r_ptr;
@@ -106,8 +124,9 @@ void eq_fir_s16(struct fir_state_32x16 fir[], struct comp_buffer *source,
 	}
 }
 
-void eq_fir_s24(struct fir_state_32x16 fir[], struct comp_buffer *source,
-		struct comp_buffer *sink, int frames, int nch)
+void __hot_text eq_fir_s24(struct fir_state_32x16 fir[],
+			   struct comp_buffer *source, struct comp_buffer *sink,
+			   int frames, int nch)
 {
 	struct fir_state_32x16 *filter;
 	int32_t *src = (int32_t *)source->r_ptr;
@@ -131,8 +150,9 @@ void eq_fir_s24(struct fir_state_32x16 fir[], struct comp_buffer *source,
 	}
 }
 
-void eq_fir_s32(struct fir_state_32x16 fir[], struct comp_buffer *source,
-		struct comp_buffer *sink, int frames, int nch)
+void __hot_text eq_fir_s32(struct fir_state_32x16 fir[],
+			   struct comp_buffer *source, struct comp_buffer *sink,
+			   int frames, int nch)
 {
 	struct fir_state_32x16 *filter;
 	int32_t *src = (int32_t *)source->r_ptr;
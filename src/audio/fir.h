@@ -52,6 +52,9 @@ void fir_reset(struct fir_state_32x16 *fir);
 size_t fir_init_coef(struct fir_state_32x16 *fir,
 		     struct sof_eq_fir_coef_data *config);
 
+int fir_update_coef(struct fir_state_32x16 *fir,
+		    struct sof_eq_fir_coef_data *config);
+
 void fir_init_delay(struct fir_state_32x16 *fir, int32_t **data);
 
 void eq_fir_s16(struct fir_state_32x16 *fir, struct comp_buffer *source,
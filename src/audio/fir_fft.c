@@ -0,0 +1,307 @@
+/*
+ * Copyright (c) 2018, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <errno.h>
+#include <sof/audio/component.h>
+#include <sof/audio/format.h>
+#include <sof/math/numbers.h>
+#include <sof/math/fft.h>
+#include <uapi/user/eq.h>
+#include "fir_fft.h"
+
+/*
+ * Partitioned FFT convolution for long FIR responses
+ */
+
+void fir_fft_reset(struct fir_fft_state *fft)
+{
+	fft->length = 0;
+	fft->out_shift = 0;
+	fft->partitions = 0;
+	fft->fdl_idx = 0;
+	fft->pos = 0;
+	fft->coef = NULL;
+	fft->fdl = NULL;
+	fft->in = NULL;
+	fft->out = NULL;
+	fft->work = NULL;
+	fft->twiddle = NULL;
+}
+
+/* Initialize filter dimensions, NULL config sets the channel to only delay
+ * the signal by one block to keep it aligned with the filtered channels.
+ */
+int fir_fft_init(struct fir_fft_state *fft,
+		 struct sof_eq_fir_coef_data *config)
+{
+	fir_fft_reset(fft);
+	if (!config)
+		return 0;
+
+	if (config->length > SOF_EQ_FIR_FFT_MAX_LENGTH || config->length < 1)
+		return -EINVAL;
+
+	fft->length = config->length;
+	fft->out_shift = config->out_shift;
+	fft->partitions = ceil_divide(fft->length, FIR_FFT_BLOCK_SIZE);
+	return 0;
+}
+
+size_t fir_fft_coef_size(struct fir_fft_state *fft)
+{
+	return fft->partitions * FIR_FFT_BINS * sizeof(struct icomplex32);
+}
+
+size_t fir_fft_delay_size(struct fir_fft_state *fft)
+{
+	return fft->partitions * FIR_FFT_BINS * sizeof(struct icomplex32) +
+		(FIR_FFT_SIZE + FIR_FFT_BLOCK_SIZE) * sizeof(int32_t);
+}
+
+/* Compute spectra of the zero padded filter partitions. Forward FFT is
+ * scaled by 1 / FIR_FFT_SIZE and the result is shifted back up to keep
+ * FIR_FFT_HEADROOM bits of headroom in the spectra.
+ */
+void fir_fft_init_coef(struct fir_fft_state *fft,
+		       struct sof_eq_fir_coef_data *config,
+		       struct icomplex32 **coef, struct icomplex32 *work,
+		       const struct icomplex32 *twiddle)
+{
+	struct icomplex32 *h = *coef;
+	int shift = FIR_FFT_SIZE_LOG2 - FIR_FFT_HEADROOM;
+	int tap;
+	int p;
+	int i;
+
+	fft->coef = h;
+	fft->work = work;
+	fft->twiddle = twiddle;
+
+	for (p = 0; p < fft->partitions; p++) {
+		for (i = 0; i < FIR_FFT_SIZE; i++) {
+			tap = p * FIR_FFT_BLOCK_SIZE + i;
+			/* Q1.15 to Q1.31 */
+			if (i < FIR_FFT_BLOCK_SIZE && tap < fft->length)
+				work[i].real = (int32_t)config->coef[tap] << 16;
+			else
+				work[i].real = 0;
+			work[i].imag = 0;
+		}
+
+		fft_execute(work, twiddle, FIR_FFT_SIZE, false);
+
+		/* Spectrum of real signal is symmetric, store only the
+		 * bins up to Nyquist.
+		 */
+		for (i = 0; i < FIR_FFT_BINS; i++) {
+			h[i].real = sat_int32((int64_t)work[i].real << shift);
+			h[i].imag = sat_int32((int64_t)work[i].imag << shift);
+		}
+
+		h += FIR_FFT_BINS;
+	}
+
+	*coef = h;
+}
+
+/* Use filter spectra of other channel with the same response */
+void fir_fft_share_coef(struct fir_fft_state *fft,
+			const struct fir_fft_state *ref)
+{
+	fft->coef = ref->coef;
+	fft->work = ref->work;
+	fft->twiddle = ref->twiddle;
+}
+
+void fir_fft_init_delay(struct fir_fft_state *fft, int32_t **data)
+{
+	fft->fdl = (struct icomplex32 *)*data;
+	*data += fft->partitions * FIR_FFT_BINS * 2;
+	fft->in = *data;
+	*data += FIR_FFT_SIZE;
+	fft->out = *data;
+	*data += FIR_FFT_BLOCK_SIZE; /* Point to next delay line start */
+}
+
+void fir_fft_process_block(struct fir_fft_state *fft)
+{
+	struct icomplex32 *work = fft->work;
+	struct icomplex32 *x;
+	struct icomplex32 *h;
+	int64_t re;
+	int64_t im;
+	int32_t *in = fft->in;
+	int n = fft->partitions;
+	int idx;
+	int p;
+	int i;
+
+	/* Channel without filter only delays the signal */
+	if (!n) {
+		memcpy(fft->out, &in[FIR_FFT_BLOCK_SIZE],
+		       FIR_FFT_BLOCK_SIZE * sizeof(int32_t));
+		memcpy(in, &in[FIR_FFT_BLOCK_SIZE],
+		       FIR_FFT_BLOCK_SIZE * sizeof(int32_t));
+		return;
+	}
+
+	/* Spectrum of previous and current input block */
+	for (i = 0; i < FIR_FFT_SIZE; i++) {
+		work[i].real = in[i];
+		work[i].imag = 0;
+	}
+
+	fft_execute(work, fft->twiddle, FIR_FFT_SIZE, false);
+
+	/* Store to frequency delay line */
+	if (++fft->fdl_idx == n)
+		fft->fdl_idx = 0;
+
+	memcpy(&fft->fdl[fft->fdl_idx * FIR_FFT_BINS], work,
+	       FIR_FFT_BINS * sizeof(struct icomplex32));
+
+	/* Multiply and accumulate the delayed input spectra with the filter
+	 * partition spectra. Q1.31 x Q5.27 -> Q6.58, the sum is converted
+	 * to Q5.27 to keep the headroom for inverse FFT.
+	 */
+	for (i = 0; i < FIR_FFT_BINS; i++) {
+		re = 0;
+		im = 0;
+		idx = fft->fdl_idx;
+		h = &fft->coef[i];
+		for (p = 0; p < n; p++) {
+			x = &fft->fdl[idx * FIR_FFT_BINS + i];
+			re += (int64_t)x->real * h->real -
+				(int64_t)x->imag * h->imag;
+			im += (int64_t)x->real * h->imag +
+				(int64_t)x->imag * h->real;
+			h += FIR_FFT_BINS;
+			idx = idx ? idx - 1 : n - 1;
+		}
+
+		work[i].real = sat_int32(Q_SHIFT_RND(re, 62, 31));
+		work[i].imag = sat_int32(Q_SHIFT_RND(im, 62, 31));
+	}
+
+	/* Restore the conjugate symmetric upper half of spectrum */
+	for (i = 1; i < FIR_FFT_BINS - 1; i++) {
+		work[FIR_FFT_SIZE - i].real = work[i].real;
+		work[FIR_FFT_SIZE - i].imag = -work[i].imag;
+	}
+
+	fft_execute(work, fft->twiddle, FIR_FFT_SIZE, true);
+
+	/* Overlap-save, the second half of inverse FFT is the valid output.
+	 * Remove the headroom and apply the filter output shift.
+	 */
+	for (i = 0; i < FIR_FFT_BLOCK_SIZE; i++) {
+		re = (int64_t)work[i + FIR_FFT_BLOCK_SIZE].real <<
+			FIR_FFT_HEADROOM;
+		fft->out[i] = sat_int32(re >> fft->out_shift);
+	}
+
+	/* Current block becomes previous block */
+	memcpy(in, &in[FIR_FFT_BLOCK_SIZE],
+	       FIR_FFT_BLOCK_SIZE * sizeof(int32_t));
+}
+
+void eq_fir_fft_s16(struct fir_fft_state fft[], struct comp_buffer *source,
+		    struct comp_buffer *sink, int frames, int nch)
+{
+	struct fir_fft_state *filter;
+	int16_t *src = (int16_t *)source->r_ptr;
+	int16_t *snk = (int16_t *)sink->w_ptr;
+	int16_t *x;
+	int16_t *y;
+	int32_t z;
+	int ch;
+	int i;
+
+	for (ch = 0; ch < nch; ch++) {
+		filter = &fft[ch];
+		x = src++;
+		y = snk++;
+		for (i = 0; i < frames; i++) {
+			z = fir_fft(filter, *x << 16);
+			*y = sat_int16(Q_SHIFT_RND(z, 31, 15));
+			x += nch;
+			y += nch;
+		}
+	}
+}
+
+void eq_fir_fft_s24(struct fir_fft_state fft[], struct comp_buffer *source,
+		    struct comp_buffer *sink, int frames, int nch)
+{
+	struct fir_fft_state *filter;
+	int32_t *src = (int32_t *)source->r_ptr;
+	int32_t *snk = (int32_t *)sink->w_ptr;
+	int32_t *x;
+	int32_t *y;
+	int32_t z;
+	int ch;
+	int i;
+
+	for (ch = 0; ch < nch; ch++) {
+		filter = &fft[ch];
+		x = src++;
+		y = snk++;
+		for (i = 0; i < frames; i++) {
+			z = fir_fft(filter, *x << 8);
+			*y = sat_int24(Q_SHIFT_RND(z, 31, 23));
+			x += nch;
+			y += nch;
+		}
+	}
+}
+
+void eq_fir_fft_s32(struct fir_fft_state fft[], struct comp_buffer *source,
+		    struct comp_buffer *sink, int frames, int nch)
+{
+	struct fir_fft_state *filter;
+	int32_t *src = (int32_t *)source->r_ptr;
+	int32_t *snk = (int32_t *)sink->w_ptr;
+	int32_t *x;
+	int32_t *y;
+	int ch;
+	int i;
+
+	for (ch = 0; ch < nch; ch++) {
+		filter = &fft[ch];
+		x = src++;
+		y = snk++;
+		for (i = 0; i < frames; i++) {
+			*y = fir_fft(filter, *x);
+			x += nch;
+			y += nch;
+		}
+	}
+}
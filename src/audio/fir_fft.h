@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2018, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef FIR_FFT_H
+#define FIR_FFT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <sof/audio/component.h>
+#include <sof/math/fft.h>
+#include <uapi/user/eq.h>
+
+/* Uniformly partitioned overlap-save convolution. The filter is split into
+ * partitions of FIR_FFT_BLOCK_SIZE taps and each input block is convolved
+ * with all partitions in frequency domain with FFT size of two blocks. The
+ * output is delayed by one block.
+ */
+#define FIR_FFT_BLOCK_SIZE	64
+#define FIR_FFT_SIZE		(2 * FIR_FFT_BLOCK_SIZE)
+#define FIR_FFT_SIZE_LOG2	7
+#define FIR_FFT_BINS		(FIR_FFT_SIZE / 2 + 1)
+
+/* Filter spectra are stored in Q5.27 to allow partition gain up to 16 */
+#define FIR_FFT_HEADROOM	4
+
+struct fir_fft_state {
+	int length; /* Number of FIR taps */
+	int out_shift; /* Amount of right shifts at output */
+	int partitions; /* Number of filter partitions, zero for delay only */
+	int fdl_idx; /* Newest spectrum in frequency delay line */
+	int pos; /* Sample position in current block */
+	struct icomplex32 *coef; /* Filter partition spectra */
+	struct icomplex32 *fdl; /* Frequency delay line of input spectra */
+	int32_t *in; /* Previous and current input block */
+	int32_t *out; /* Output of previous block */
+	struct icomplex32 *work; /* FFT scratch, shared by channels */
+	const struct icomplex32 *twiddle; /* Twiddle factors, shared */
+};
+
+void fir_fft_reset(struct fir_fft_state *fft);
+
+int fir_fft_init(struct fir_fft_state *fft,
+		 struct sof_eq_fir_coef_data *config);
+
+size_t fir_fft_coef_size(struct fir_fft_state *fft);
+
+size_t fir_fft_delay_size(struct fir_fft_state *fft);
+
+void fir_fft_init_coef(struct fir_fft_state *fft,
+		       struct sof_eq_fir_coef_data *config,
+		       struct icomplex32 **coef, struct icomplex32 *work,
+		       const struct icomplex32 *twiddle);
+
+void fir_fft_share_coef(struct fir_fft_state *fft,
+			const struct fir_fft_state *ref);
+
+void fir_fft_init_delay(struct fir_fft_state *fft, int32_t **data);
+
+void fir_fft_process_block(struct fir_fft_state *fft);
+
+void eq_fir_fft_s16(struct fir_fft_state fft[], struct comp_buffer *source,
+		    struct comp_buffer *sink, int frames, int nch);
+
+void eq_fir_fft_s24(struct fir_fft_state fft[], struct comp_buffer *source,
+		    struct comp_buffer *sink, int frames, int nch);
+
+void eq_fir_fft_s32(struct fir_fft_state fft[], struct comp_buffer *source,
+		    struct comp_buffer *sink, int frames, int nch);
+
+/* Push one sample and return the output delayed by one block */
+static inline int32_t fir_fft(struct fir_fft_state *fft, int32_t x)
+{
+	int32_t y;
+
+	/* Bypass is set with no delay line. */
+	if (!fft->in)
+		return x;
+
+	y = fft->out[fft->pos];
+	fft->in[FIR_FFT_BLOCK_SIZE + fft->pos] = x;
+	if (++fft->pos == FIR_FFT_BLOCK_SIZE) {
+		fir_fft_process_block(fft);
+		fft->pos = 0;
+	}
+
+	return y;
+}
+
+#endif
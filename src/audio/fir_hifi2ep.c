@@ -83,6 +83,23 @@ size_t fir_init_coef(struct fir_state_32x16 *fir,
 	return fir->length * sizeof(int32_t);
 }
 
+/* Point to new coefficients but keep the filter state. The new response
+ * must have the same length, NULL config checks that the FIR is in bypass.
+ */
+int fir_update_coef(struct fir_state_32x16 *fir,
+		    struct sof_eq_fir_coef_data *config)
+{
+	if (!config)
+		return fir->taps ? -EINVAL : 0;
+
+	if (fir->taps != config->length || !fir->delay)
+		return -EINVAL;
+
+	fir->out_shift = (int)config->out_shift;
+	fir->coef = (ae_p16x2s *)&config->coef[0];
+	return 0;
+}
+
 void fir_init_delay(struct fir_state_32x16 *fir, int32_t **data)
 {
 	fir->delay = (ae_p24f *) *data;
@@ -101,10 +118,10 @@ void fir_get_lrshifts(struct fir_state_32x16 *fir, int *lshift,
 /* For even frame lengths use FIR filter that processes two sequential
  * sample per call.
  */
-void eq_fir_2x_s32_hifiep(struct fir_state_32x16 fir[],
-			  struct comp_buffer *source,
-			  struct comp_buffer *sink,
-			  int frames, int nch)
+void __hot_text eq_fir_2x_s32_hifiep(struct fir_state_32x16 fir[],
+				     struct comp_buffer *source,
+				     struct comp_buffer *sink, int frames,
+				     int nch)
 {
 	struct fir_state_32x16 *f;
 	int32_t *src = (int32_t *)source->r_ptr;
@@ -142,10 +159,10 @@ void eq_fir_2x_s32_hifiep(struct fir_state_32x16 fir[],
 	}
 }
 
-void eq_fir_2x_s24_hifiep(struct fir_state_32x16 fir[],
-			  struct comp_buffer *source,
-			  struct comp_buffer *sink,
-			  int frames, int nch)
+void __hot_text eq_fir_2x_s24_hifiep(struct fir_state_32x16 fir[],
+				     struct comp_buffer *source,
+				     struct comp_buffer *sink, int frames,
+				     int nch)
 {
 	struct fir_state_32x16 *f;
 	int32_t *src = (int32_t *)source->r_ptr;
@@ -187,10 +204,10 @@ void eq_fir_2x_s24_hifiep(struct fir_state_32x16 fir[],
 	}
 }
 
-void eq_fir_2x_s16_hifiep(struct fir_state_32x16 fir[],
-			  struct comp_buffer *source,
-			  struct comp_buffer *sink,
-			  int frames, int nch)
+void __hot_text eq_fir_2x_s16_hifiep(struct fir_state_32x16 fir[],
+				     struct comp_buffer *source,
+				     struct comp_buffer *sink, int frames,
+				     int nch)
 {
 	struct fir_state_32x16 *f;
 	int16_t *src = (int16_t *)source->r_ptr;
@@ -233,8 +250,9 @@ void eq_fir_2x_s16_hifiep(struct fir_state_32x16 fir[],
 }
 
 /* FIR for any number of frames */
-void eq_fir_s32_hifiep(struct fir_state_32x16 fir[], struct comp_buffer *source,
-		       struct comp_buffer *sink, int frames, int nch)
+void __hot_text eq_fir_s32_hifiep(struct fir_state_32x16 fir[],
+				  struct comp_buffer *source,
+				  struct comp_buffer *sink, int frames, int nch)
 {
 	struct fir_state_32x16 *f;
 	int32_t *src = (int32_t *)source->r_ptr;
@@ -267,8 +285,9 @@ void eq_fir_s32_hifiep(struct fir_state_32x16 fir[], struct comp_buffer *source,
 }
 
 /* FIR for any number of frames */
-void eq_fir_s24_hifiep(struct fir_state_32x16 fir[], struct comp_buffer *source,
-		       struct comp_buffer *sink, int frames, int nch)
+void __hot_text eq_fir_s24_hifiep(struct fir_state_32x16 fir[],
+				  struct comp_buffer *source,
+				  struct comp_buffer *sink, int frames, int nch)
 {
 	struct fir_state_32x16 *f;
 	int32_t *src = (int32_t *)source->r_ptr;
@@ -303,8 +322,9 @@ void eq_fir_s24_hifiep(struct fir_state_32x16 fir[], struct comp_buffer *source,
 }
 
 /* FIR for any number of frames */
-void eq_fir_s16_hifiep(struct fir_state_32x16 fir[], struct comp_buffer *source,
-		       struct comp_buffer *sink, int frames, int nch)
+void __hot_text eq_fir_s16_hifiep(struct fir_state_32x16 fir[],
+				  struct comp_buffer *source,
+				  struct comp_buffer *sink, int frames, int nch)
 {
 	struct fir_state_32x16 *f;
 	int16_t *src = (int16_t *)source->r_ptr;
@@ -60,14 +60,14 @@ void fir_reset(struct fir_state_32x16 *fir)
 size_t fir_init_coef(struct fir_state_32x16 *fir,
 		     struct sof_eq_fir_coef_data *config)
 {
-	/* The length is taps plus two since the filter computes two
-	 * samples per call. Length plus one would be minimum but the add
+	/* The length is taps plus four since the filter computes up to four
+	 * samples per call. Length plus three would be minimum but the add
 	 * must be even. The even length is needed for 64 bit loads from delay
 	 * lines with 32 bit samples.
 	 */
 	fir->rwp = NULL;
 	fir->taps = (int)config->length;
-	fir->length = fir->taps + 2;
+	fir->length = fir->taps + 4;
 	fir->out_shift = (int)config->out_shift;
 	fir->coef = (ae_f16x4 *)&config->coef[0];
 	fir->delay = NULL;
@@ -83,6 +83,23 @@ size_t fir_init_coef(struct fir_state_32x16 *fir,
 	return fir->length * sizeof(int32_t);
 }
 
+/* Point to new coefficients but keep the filter state. The new response
+ * must have the same length, NULL config checks that the FIR is in bypass.
+ */
+int fir_update_coef(struct fir_state_32x16 *fir,
+		    struct sof_eq_fir_coef_data *config)
+{
+	if (!config)
+		return fir->taps ? -EINVAL : 0;
+
+	if (fir->taps != config->length || !fir->delay)
+		return -EINVAL;
+
+	fir->out_shift = (int)config->out_shift;
+	fir->coef = (ae_f16x4 *)&config->coef[0];
+	return 0;
+}
+
 void fir_init_delay(struct fir_state_32x16 *fir, int32_t **data)
 {
 	fir->delay = (ae_int32 *) *data;
@@ -101,9 +118,10 @@ void fir_get_lrshifts(struct fir_state_32x16 *fir, int *lshift,
 /* For even frame lengths use FIR filter that processes two sequential
  * sample per call.
  */
-void eq_fir_2x_s32_hifi3(struct fir_state_32x16 fir[],
-			 struct comp_buffer *source, struct comp_buffer *sink,
-			 int frames, int nch)
+void __hot_text eq_fir_2x_s32_hifi3(struct fir_state_32x16 fir[],
+				    struct comp_buffer *source,
+				    struct comp_buffer *sink, int frames,
+				    int nch)
 {
 	struct fir_state_32x16 *f;
 	int32_t *src = (int32_t *)source->r_ptr;
@@ -141,9 +159,10 @@ void eq_fir_2x_s32_hifi3(struct fir_state_32x16 fir[],
 	}
 }
 
-void eq_fir_2x_s24_hifi3(struct fir_state_32x16 fir[],
-			 struct comp_buffer *source, struct comp_buffer *sink,
-			 int frames, int nch)
+void __hot_text eq_fir_2x_s24_hifi3(struct fir_state_32x16 fir[],
+				    struct comp_buffer *source,
+				    struct comp_buffer *sink, int frames,
+				    int nch)
 {
 	struct fir_state_32x16 *f;
 	int32_t *src = (int32_t *)source->r_ptr;
@@ -186,9 +205,10 @@ void eq_fir_2x_s24_hifi3(struct fir_state_32x16 fir[],
 	}
 }
 
-void eq_fir_2x_s16_hifi3(struct fir_state_32x16 fir[],
-			 struct comp_buffer *source, struct comp_buffer *sink,
-			 int frames, int nch)
+void __hot_text eq_fir_2x_s16_hifi3(struct fir_state_32x16 fir[],
+				    struct comp_buffer *source,
+				    struct comp_buffer *sink, int frames,
+				    int nch)
 {
 	struct fir_state_32x16 *f;
 	int16_t *src = (int16_t *)source->r_ptr;
@@ -231,9 +251,151 @@ void eq_fir_2x_s16_hifi3(struct fir_state_32x16 fir[],
 	}
 }
 
+/* For frame lengths divisible by four use FIR filter that processes four
+ * sequential samples per call. The coefficients are loaded once for the
+ * four outputs instead of twice with the two sample version.
+ */
+void __hot_text eq_fir_4x_s32_hifi3(struct fir_state_32x16 fir[],
+				    struct comp_buffer *source,
+				    struct comp_buffer *sink, int frames,
+				    int nch)
+{
+	struct fir_state_32x16 *f;
+	int32_t *src = (int32_t *)source->r_ptr;
+	int32_t *snk = (int32_t *)sink->w_ptr;
+	int32_t *x;
+	int32_t *y;
+	int32_t z[4];
+	int ch;
+	int i;
+	int rshift;
+	int lshift;
+	int shift;
+	int inc = nch << 2;
+
+	for (ch = 0; ch < nch; ch++) {
+		/* Get FIR instance and get shifts.
+		 */
+		f = &fir[ch];
+		fir_get_lrshifts(f, &lshift, &rshift);
+		shift = lshift - rshift;
+
+		/* Setup circular buffer for FIR input data delay */
+		fir_hifi3_setup_circular(f);
+
+		x = src++;
+		y = snk++;
+		for (i = 0; i < (frames >> 2); i++) {
+			z[0] = x[0];
+			z[1] = x[nch];
+			z[2] = x[2 * nch];
+			z[3] = x[3 * nch];
+			fir_32x16_4x_hifi3(f, z, y, y + nch, y + 2 * nch,
+					   y + 3 * nch, shift);
+			x += inc;
+			y += inc;
+		}
+	}
+}
+
+void __hot_text eq_fir_4x_s24_hifi3(struct fir_state_32x16 fir[],
+				    struct comp_buffer *source,
+				    struct comp_buffer *sink, int frames,
+				    int nch)
+{
+	struct fir_state_32x16 *f;
+	int32_t *src = (int32_t *)source->r_ptr;
+	int32_t *snk = (int32_t *)sink->w_ptr;
+	int32_t *x;
+	int32_t *y;
+	int32_t z[4];
+	int ch;
+	int i;
+	int j;
+	int rshift;
+	int lshift;
+	int shift;
+	int inc = nch << 2;
+
+	for (ch = 0; ch < nch; ch++) {
+		/* Get FIR instance and get shifts.
+		 */
+		f = &fir[ch];
+		fir_get_lrshifts(f, &lshift, &rshift);
+		shift = lshift - rshift;
+
+		/* Setup circular buffer for FIR input data delay */
+		fir_hifi3_setup_circular(f);
+
+		x = src++;
+		y = snk++;
+		for (i = 0; i < (frames >> 2); i++) {
+			for (j = 0; j < 4; j++)
+				z[j] = x[j * nch] << 8;
+
+			fir_32x16_4x_hifi3(f, z, &z[0], &z[1], &z[2], &z[3],
+					   shift);
+			for (j = 0; j < 4; j++)
+				y[j * nch] = sat_int24(Q_SHIFT_RND(z[j], 31,
+								   23));
+
+			x += inc;
+			y += inc;
+		}
+	}
+}
+
+void __hot_text eq_fir_4x_s16_hifi3(struct fir_state_32x16 fir[],
+				    struct comp_buffer *source,
+				    struct comp_buffer *sink, int frames,
+				    int nch)
+{
+	struct fir_state_32x16 *f;
+	int16_t *src = (int16_t *)source->r_ptr;
+	int16_t *snk = (int16_t *)sink->w_ptr;
+	int16_t *x;
+	int16_t *y;
+	int32_t z[4];
+	int ch;
+	int i;
+	int j;
+	int rshift;
+	int lshift;
+	int shift;
+	int inc = nch << 2;
+
+	for (ch = 0; ch < nch; ch++) {
+		/* Get FIR instance and get shifts.
+		 */
+		f = &fir[ch];
+		fir_get_lrshifts(f, &lshift, &rshift);
+		shift = lshift - rshift;
+
+		/* Setup circular buffer for FIR input data delay */
+		fir_hifi3_setup_circular(f);
+
+		x = src++;
+		y = snk++;
+		for (i = 0; i < (frames >> 2); i++) {
+			for (j = 0; j < 4; j++)
+				z[j] = x[j * nch] << 16;
+
+			fir_32x16_4x_hifi3(f, z, &z[0], &z[1], &z[2], &z[3],
+					   shift);
+			for (j = 0; j < 4; j++)
+				y[j * nch] = sat_int16(Q_SHIFT_RND(z[j], 31,
+								   15));
+
+			x += inc;
+			y += inc;
+		}
+	}
+}
+
 /* FIR for any number of frames */
-void eq_fir_s32_hifi3(struct fir_state_32x16 fir[], struct comp_buffer *source,
-		      struct comp_buffer *sink, int frames, int nch)
+void __hot_text eq_fir_s32_hifi3(struct fir_state_32x16 fir[],
+				 struct comp_buffer *source,
+				 struct comp_buffer *sink, int frames, int nch)
 {
 	struct fir_state_32x16 *f;
 	int32_t *src = (int32_t *)source->r_ptr;
@@ -267,8 +429,9 @@ void eq_fir_s32_hifi3(struct fir_state_32x16 fir[], struct comp_buffer *source,
 	}
 }
 
-void eq_fir_s24_hifi3(struct fir_state_32x16 fir[], struct comp_buffer *source,
-		      struct comp_buffer *sink, int frames, int nch)
+void __hot_text eq_fir_s24_hifi3(struct fir_state_32x16 fir[],
+				 struct comp_buffer *source,
+				 struct comp_buffer *sink, int frames, int nch)
 {
 	struct fir_state_32x16 *f;
 	int32_t *src = (int32_t *)source->r_ptr;
@@ -304,8 +467,9 @@ void eq_fir_s24_hifi3(struct fir_state_32x16 fir[], struct comp_buffer *source,
 	}
 }
 
-void eq_fir_s16_hifi3(struct fir_state_32x16 fir[], struct comp_buffer *source,
-		      struct comp_buffer *sink, int frames, int nch)
+void __hot_text eq_fir_s16_hifi3(struct fir_state_32x16 fir[],
+				 struct comp_buffer *source,
+				 struct comp_buffer *sink, int frames, int nch)
 {
 	struct fir_state_32x16 *f;
 	int16_t *src = (int16_t *)source->r_ptr;
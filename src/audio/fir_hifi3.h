@@ -55,6 +55,9 @@ void fir_reset(struct fir_state_32x16 *fir);
 size_t fir_init_coef(struct fir_state_32x16 *fir,
 		     struct sof_eq_fir_coef_data *config);
 
+int fir_update_coef(struct fir_state_32x16 *fir,
+		    struct sof_eq_fir_coef_data *config);
+
 void fir_init_delay(struct fir_state_32x16 *fir, int32_t **data);
 
 void eq_fir_s16_hifi3(struct fir_state_32x16 *fir, struct comp_buffer *source,
@@ -78,6 +81,18 @@ void eq_fir_2x_s32_hifi3(struct fir_state_32x16 *fir,
 			 struct comp_buffer *source, struct comp_buffer *sink,
 			 int frames, int nch);
 
+void eq_fir_4x_s16_hifi3(struct fir_state_32x16 *fir,
+			 struct comp_buffer *source, struct comp_buffer *sink,
+			 int frames, int nch);
+
+void eq_fir_4x_s24_hifi3(struct fir_state_32x16 *fir,
+			 struct comp_buffer *source, struct comp_buffer *sink,
+			 int frames, int nch);
+
+void eq_fir_4x_s32_hifi3(struct fir_state_32x16 *fir,
+			 struct comp_buffer *source, struct comp_buffer *sink,
+			 int frames, int nch);
+
 /* Setup circular buffer for FIR input data delay */
 static inline void fir_hifi3_setup_circular(struct fir_state_32x16 *fir)
 {
@@ -258,5 +273,96 @@ static inline void fir_32x16_2x_hifi3(struct fir_state_32x16 *fir, int32_t x0,
 	AE_S32_L_I(AE_ROUND32F48SSYM(a), (ae_int32 *)y0, 0);
 }
 
+static inline void fir_32x16_4x_hifi3(struct fir_state_32x16 *fir,
+				      const int32_t *x, int32_t *y0,
+				      int32_t *y1, int32_t *y2, int32_t *y3,
+				      int shift)
+{
+	/* This function uses
+	 * 4x 64 bit accumulators,
+	 * 5x 64 bit data and coefficient registers
+	 * 3x integers
+	 * 2x address pointers,
+	 */
+	ae_f64 a;
+	ae_f64 b;
+	ae_f64 c;
+	ae_f64 d;
+	ae_valign u;
+	ae_f32x2 d0;
+	ae_f32x2 d1;
+	ae_f32x2 d2;
+	ae_f32x2 d3;
+	ae_f16x4 coefs;
+	int i;
+	ae_f32x2 *dp;
+	ae_f16x4 *coefp = fir->coef;
+	const int taps_div_4 = fir->taps >> 2;
+	const int inc = 2 * sizeof(int32_t);
+
+	/* Bypass samples if taps count is zero. */
+	if (!taps_div_4) {
+		*y0 = x[0];
+		*y1 = x[1];
+		*y2 = x[2];
+		*y3 = x[3];
+		return;
+	}
+
+	/* Write samples to delay, dp points to the newest sample x[3] */
+	AE_S32_L_XC(x[0], fir->rwp, -sizeof(int32_t));
+	AE_S32_L_XC(x[1], fir->rwp, -sizeof(int32_t));
+	AE_S32_L_XC(x[2], fir->rwp, -sizeof(int32_t));
+	dp = (ae_f32x2 *)fir->rwp;
+	AE_S32_L_XC(x[3], fir->rwp, -sizeof(int32_t));
+
+	a = AE_ZERO64();
+	b = AE_ZERO64();
+	c = AE_ZERO64();
+	d = AE_ZERO64();
+
+	/* Prime the coefficients stream */
+	u = AE_LA64_PP(coefp);
+
+	/* Load four newest samples, d0 is x[3], x[2] and d1 is x[1], x[0] */
+	AE_L32X2_XC(d0, dp, inc);
+	AE_L32X2_XC(d1, dp, inc);
+	for (i = 0; i < taps_div_4; i++) {
+		/* Load four coefficients. Coef_3 contains tap h[n],
+		 * coef_2 contains h[n+1], coef_1 contains h[n+2], and
+		 * coef_0 contains h[n+3];
+		 */
+		AE_LA16X4_IP(coefs, u, coefp);
+
+		/* Every coefficient and data load is shared by the four
+		 * outputs. Quad MACs (HH) for the first two taps
+		 * d += d0_h * coefs_3 + d0_l * coefs_2	(y3)
+		 * c += d0_l * coefs_3 + d1_h * coefs_2	(y2)
+		 * b += d1_h * coefs_3 + d1_l * coefs_2	(y1)
+		 * a += d1_l * coefs_3 + d2_h * coefs_2	(y0)
+		 */
+		AE_L32X2_XC(d2, dp, inc);
+		AE_MULAFD32X16X2_FIR_HH(d, c, d0, d1, coefs);
+		AE_MULAFD32X16X2_FIR_HH(b, a, d1, d2, coefs);
+
+		/* Quad MACs (HL) for the next two taps */
+		AE_L32X2_XC(d3, dp, inc);
+		AE_MULAFD32X16X2_FIR_HL(d, c, d1, d2, coefs);
+		AE_MULAFD32X16X2_FIR_HL(b, a, d2, d3, coefs);
+		d0 = d2;
+		d1 = d3;
+	}
+
+	/* Do scaling shifts and store samples. */
+	d = AE_SLAA64S(d, shift);
+	c = AE_SLAA64S(c, shift);
+	b = AE_SLAA64S(b, shift);
+	a = AE_SLAA64S(a, shift);
+	AE_S32_L_I(AE_ROUND32F48SSYM(d), (ae_int32 *)y3, 0);
+	AE_S32_L_I(AE_ROUND32F48SSYM(c), (ae_int32 *)y2, 0);
+	AE_S32_L_I(AE_ROUND32F48SSYM(b), (ae_int32 *)y1, 0);
+	AE_S32_L_I(AE_ROUND32F48SSYM(a), (ae_int32 *)y0, 0);
+}
+
 #endif
 #endif
@@ -69,18 +69,27 @@ struct hc_buf {
  * multiple of host_period_bytes.
  *
  * host_size is the host buffer size (in bytes) specified in the IPC parameters.
+ *
+ * dma_buffer is the buffer between the host and the first (playback) or
+ * last (capture) processing component, sized as the local DMA ring. The
+ * host DMA reads or writes it in place, so copies only move its pointers.
  */
 struct host_data {
 	/* local DMA config */
 	struct dma *dma;
+	struct dma_stream stream;	/**< placement on the DMAC */
 	int chan;
 	struct dma_sg_config config;
 	completion_t complete;
-	struct comp_buffer *dma_buffer;
+	struct comp_buffer *dma_buffer;	/**< component buffer, the DMA ring */
 
 	uint32_t period_bytes;	/**< Size of a single period (in bytes) */
 	uint32_t period_count;	/**< Number of periods */
+#if defined CONFIG_HOST_DMA_BATCH
+	uint32_t batch_bytes;	/**< Bytes moved per host DMA transfer */
+#endif
 	uint32_t pointer_init;
+	uint32_t fast_start;	/**< Playback starts on the first period */
 
 	/* host position reporting related */
 	uint32_t host_size;	/**< Host buffer size (in bytes) */
@@ -132,6 +141,7 @@ static void host_dma_cb(void *data, uint32_t type, struct dma_sg_elem *next)
 	struct comp_dev *dev = (struct comp_dev *)data;
 	struct host_data *hd = comp_get_drvdata(dev);
 	struct dma_sg_elem *local_elem;
+	uint32_t bytes;
 #if !defined CONFIG_DMA_GW
 	struct dma_sg_elem *source_elem;
 	struct dma_sg_elem *sink_elem;
@@ -141,34 +151,44 @@ static void host_dma_cb(void *data, uint32_t type, struct dma_sg_elem *next)
 #endif
 
 	local_elem = hd->config.elem_array.elems;
+	bytes = local_elem->size;
 
 	tracev_host("host_dma_cb()");
 
+	/* several periods completed in one callback */
+	if (type & DMA_IRQ_TYPE_BYTES) {
+		bytes = next->size;
+		next->size = DMA_RELOAD_LLI;
+	}
+
 	if (dev->params.direction == SOF_IPC_STREAM_PLAYBACK)
 		/* recalc available buffer space */
-		comp_update_buffer_produce(hd->dma_buffer, local_elem->size);
+		comp_update_buffer_produce(hd->dma_buffer, bytes);
 	else
 		/* recalc available buffer space */
-		comp_update_buffer_consume(hd->dma_buffer, local_elem->size);
+		comp_update_buffer_consume(hd->dma_buffer, bytes);
 
-	dev->position += local_elem->size;
+	dev->position += bytes;
 
 	/* new local period, update host buffer position blks
 	 * local_pos is queried by the ops.potision() API
 	 */
-	hd->local_pos += local_elem->size;
+	hd->local_pos += bytes;
 
 	/* buffer overlap, hard code host buffer size at the moment ? */
 	if (hd->local_pos >= hd->host_size)
-		hd->local_pos = 0;
+		hd->local_pos = hd->host_size ?
+			hd->local_pos % hd->host_size : 0;
 
 	/* NO_IRQ mode if host_period_size == 0 */
 	if (dev->params.host_period_bytes != 0) {
-		hd->report_pos += local_elem->size;
+		hd->report_pos += bytes;
 
-		/* send IPC message to driver if needed */
+		/* send IPC message to driver if needed, a batch of
+		 * periods is reported with a single position update
+		 */
 		if (hd->report_pos >= dev->params.host_period_bytes) {
-			hd->report_pos = 0;
+			hd->report_pos %= dev->params.host_period_bytes;
 
 			/* send timestamped position to host
 			 * (updates position first, by calling ops.position())
@@ -310,6 +330,15 @@ static int host_trigger(struct comp_dev *dev, int cmd)
 		/* preload first playback period for preloader task */
 		if (dev->params.direction == SOF_IPC_STREAM_PLAYBACK) {
 			if (!hd->pointer_init) {
+				/* a DAI reading the ring directly needs it
+				 * full before it starts
+				 */
+				hd->fast_start =
+					dev->pipeline->ipc_pipe.fast_start &&
+					hd->dma_buffer->sink->comp.type !=
+					SOF_COMP_DAI &&
+					hd->dma_buffer->sink->comp.type !=
+					SOF_COMP_SG_DAI;
 				ret = host_copy_int(dev, true);
 
 				if (ret == dev->frames)
@@ -370,9 +399,11 @@ static struct comp_dev *host_new(struct sof_ipc_comp *comp)
 
 	caps = 0;
 	dma_dev = DMA_DEV_HOST;
-	hd->dma = dma_get(dir, caps, dma_dev, DMA_ACCESS_SHARED);
+	hd->stream.pipeline_id = comp->pipeline_id;
+	hd->dma = dma_get_stream(dir, caps, dma_dev, &hd->stream);
 	if (hd->dma == NULL) {
-		trace_host_error("host_new() error: dma_get() returned NULL");
+		trace_host_error("host_new() error: dma_get_stream() returned "
+				 "NULL");
 		goto error;
 	}
 
@@ -410,7 +441,7 @@ static void host_free(struct comp_dev *dev)
 
 	trace_host("host_free()");
 
-	dma_put(hd->dma);
+	dma_put_stream(hd->dma, &hd->stream);
 
 	dma_sg_free(&hd->config.elem_array);
 	rfree(hd);
@@ -496,6 +527,10 @@ static int host_params(struct comp_dev *dev)
 		return -EINVAL;
 	}
 
+	/* let later streams balance against this one */
+	dma_stream_update(hd->dma, &hd->stream,
+			  dev->params.rate * comp_frame_bytes(dev));
+
 	/* resize the buffer if space is available to align with period size */
 	buffer_size = hd->period_count * hd->period_bytes;
 	err = buffer_set_size(hd->dma_buffer, buffer_size);
@@ -506,6 +541,14 @@ static int host_params(struct comp_dev *dev)
 		return err;
 	}
 
+#if defined CONFIG_HOST_DMA_BATCH
+	/* move all but one period per transfer, the spare period covers the
+	 * transfer itself so fewer L1 exits don't cost xruns
+	 */
+	hd->batch_bytes = hd->period_count > 2 ?
+		(hd->period_count - 1) * hd->period_bytes : hd->period_bytes;
+#endif
+
 	/* component buffer size must be divisor of host buffer size */
 	if (hd->host_size % hd->period_bytes) {
 		trace_comp_error("host_params() error: component buffer size "
@@ -648,6 +691,7 @@ static int host_reset(struct comp_dev *dev)
 
 	/* reset dma channel as we have put it */
 	hd->chan = DMA_CHAN_INVALID;
+	dma_stream_update(hd->dma, &hd->stream, 0);
 
 	host_pointer_reset(dev);
 	hd->pointer_init = 0;
@@ -670,6 +714,13 @@ static int host_copy_int(struct comp_dev *dev, bool preload_run)
 {
 	struct host_data *hd = comp_get_drvdata(dev);
 	struct dma_sg_elem *local_elem;
+	uint32_t copy_bytes;
+#if defined CONFIG_DMA_GW
+	uint32_t flags = preload_run ? DMA_COPY_PRELOAD : 0;
+	uint32_t last;
+	uint32_t avail;
+	uint32_t room;
+#endif
 	int ret;
 
 	tracev_host("host_copy_int()");
@@ -678,17 +729,32 @@ static int host_copy_int(struct comp_dev *dev, bool preload_run)
 		return 0;
 
 	local_elem = hd->config.elem_array.elems;
+	copy_bytes = local_elem->size;
+
+#if defined CONFIG_DMA_GW && defined CONFIG_HOST_DMA_BATCH
+	/* one larger transfer lets the host link stay in L1 between bursts */
+	if (!preload_run && hd->batch_bytes != hd->period_bytes) {
+		copy_bytes = hd->batch_bytes;
+		flags |= DMA_COPY_BATCH;
+	}
+#endif
+#if defined CONFIG_DMA_GW
+	if (preload_run && hd->fast_start)
+		flags |= DMA_COPY_FAST_START;
+#endif
 
 	/* enough free or avail to copy ? */
 	if (dev->params.direction == SOF_IPC_STREAM_PLAYBACK) {
-		if (hd->dma_buffer->free < local_elem->size) {
+		if (comp_buffer_get_free_bytes(hd->dma_buffer) <
+		    copy_bytes) {
 			/* buffer is enough avail, just return. */
 			tracev_host("host_copy_int(), buffer is enough avail");
 			return 0;
 		}
 	} else {
 
-		if (hd->dma_buffer->avail < local_elem->size) {
+		if (comp_buffer_get_avail_bytes(hd->dma_buffer) <
+		    copy_bytes) {
 			/* buffer is enough empty, just return. */
 			tracev_host("host_copy_int(), buffer is enough empty");
 			return 0;
@@ -698,12 +764,51 @@ static int host_copy_int(struct comp_dev *dev, bool preload_run)
  * as in the host_trigger().
  */
 #if defined CONFIG_DMA_GW
-	/* tell gateway to copy another period */
-	ret = dma_copy(hd->dma, hd->chan, hd->period_bytes,
-		       preload_run ? DMA_COPY_PRELOAD : 0);
+	last = comp_buffer_get_avail_bytes(hd->dma_buffer);
+
+	/* tell gateway to copy another period or batch of periods */
+	ret = dma_copy(hd->dma, hd->chan, copy_bytes, flags);
 	if (ret < 0)
 		goto out;
 
+	/*
+	 * Capture may have a backlog, e.g. history drained from a key phrase
+	 * buffer, so pass every complete period on instead of one per
+	 * scheduling period. The callback normally consumes each period
+	 * right away, stop as soon as one isn't.
+	 */
+	if (dev->params.direction == SOF_IPC_STREAM_CAPTURE && !preload_run) {
+		avail = comp_buffer_get_avail_bytes(hd->dma_buffer);
+		while (avail >= local_elem->size && avail < last) {
+			ret = dma_copy(hd->dma, hd->chan, hd->period_bytes, 0);
+			if (ret < 0)
+				goto out;
+
+			last = avail;
+			avail = comp_buffer_get_avail_bytes(hd->dma_buffer);
+		}
+	}
+
+	/*
+	 * The periods a fast start consumed while the host was still filling
+	 * the ring are not released to the gateway yet, give all of them
+	 * back rather than one per scheduling period.
+	 */
+	if (dev->params.direction == SOF_IPC_STREAM_PLAYBACK &&
+	    hd->fast_start && !preload_run) {
+		last = comp_buffer_get_free_bytes(hd->dma_buffer);
+		while (last >= copy_bytes) {
+			ret = dma_copy(hd->dma, hd->chan, copy_bytes, flags);
+			if (ret < 0)
+				goto out;
+
+			room = comp_buffer_get_free_bytes(hd->dma_buffer);
+			if (room >= last)
+				break;
+			last = room;
+		}
+	}
+
 	/* note: update() moved to callback */
 #else
 	/* do DMA transfer */
@@ -33,13 +33,16 @@
 #include <stdint.h>
 #include <stddef.h>
 #include <errno.h>
+#include <string.h>
 
 #ifdef MODULE_TEST
 #include <stdio.h>
 #endif
 
 #include <sof/audio/format.h>
+#include <sof/math/numbers.h>
 #include <uapi/user/eq.h>
+#include "iir_config.h"
 #include "iir.h"
 
 /*
@@ -67,8 +70,53 @@
  *
  */
 
+#if IIR_GENERIC
+
 /* Series DF2T IIR */
 
+/* 32 bit data, 32 bit coefficients and 32 bit state variables. The state
+ * is kept in Q3.29, the upper half of the Q3.61 sums of the 64 bit state
+ * version, so the headroom is the same.
+ */
+static int32_t iir_df2t_32(struct iir_state_df2t *iir, int32_t x)
+{
+	int32_t *coef = iir->coef;
+	int32_t *delay = iir->delay32;
+	int32_t in;
+	int32_t tmp;
+	int64_t acc;
+	int32_t out = 0;
+	int i;
+	int j;
+
+	for (j = 0; j < iir->biquads; j += iir->biquads_in_series) {
+		in = x;
+		for (i = 0; i < iir->biquads_in_series; i++) {
+			/* Output, Q3.29 delay is Q3.61 in upper word */
+			acc = ((int64_t)delay[0] << 32) +
+				(int64_t)coef[4] * in;
+			tmp = (int32_t)Q_SHIFT_RND(acc, 61, 31);
+
+			/* 1st and 2nd delay, Q3.61 to Q3.29 */
+			acc = ((int64_t)delay[1] << 32) +
+				(int64_t)coef[3] * in + (int64_t)coef[1] * tmp;
+			delay[0] = sat_int32(Q_SHIFT_RND(acc, 61, 29));
+			acc = (int64_t)coef[2] * in + (int64_t)coef[0] * tmp;
+			delay[1] = sat_int32(Q_SHIFT_RND(acc, 61, 29));
+
+			/* Gain and output shift as with 64 bit state */
+			acc = (int64_t)coef[6] * tmp;
+			acc = Q_SHIFT_RND(acc, 45 + coef[5], 31);
+			in = sat_int32(acc);
+
+			coef += SOF_EQ_IIR_NBIQUAD_DF2T;
+			delay += IIR_DF2T_NUM_DELAYS;
+		}
+		out = sat_int32((int64_t)out + in);
+	}
+	return out;
+}
+
 /* 32 bit data, 32 bit coefficients and 64 bit state variables */
 
 int32_t iir_df2t(struct iir_state_df2t *iir, int32_t x)
@@ -86,9 +134,12 @@ int32_t iir_df2t(struct iir_state_df2t *iir, int32_t x)
 	if (!iir->biquads)
 		return x;
 
+	if (iir->precision == SOF_EQ_IIR_PRECISION_32)
+		return iir_df2t_32(iir, x);
+
 	/* Coefficients order in coef[] is {a2, a1, b2, b1, b0, shift, gain} */
-	in = x;
 	for (j = 0; j < iir->biquads; j += iir->biquads_in_series) {
+		in = x;
 		for (i = 0; i < iir->biquads_in_series; i++) {
 			/* Compute output: Delay is Q3.61
 			 * Q2.30 x Q1.31 -> Q3.61
@@ -131,38 +182,208 @@ int32_t iir_df2t(struct iir_state_df2t *iir, int32_t x)
 	return out;
 }
 
+/* Run one biquad over a block of samples. Coefficients and delays are kept
+ * in locals for the whole block. Input and output may be the same buffer.
+ */
+void iir_df2t_biquad_block(int32_t *coef, int64_t *delay, const int32_t *x,
+			   int32_t *y, int n)
+{
+	int64_t acc;
+	int64_t d0 = delay[0];
+	int64_t d1 = delay[1];
+	int32_t a2 = coef[0];
+	int32_t a1 = coef[1];
+	int32_t b2 = coef[2];
+	int32_t b1 = coef[3];
+	int32_t b0 = coef[4];
+	int32_t shift = coef[5];
+	int32_t gain = coef[6];
+	int32_t in;
+	int32_t tmp;
+	int i;
+
+	for (i = 0; i < n; i++) {
+		in = x[i];
+		acc = (int64_t)b0 * in + d0;
+		tmp = (int32_t)Q_SHIFT_RND(acc, 61, 31);
+		d0 = d1 + (int64_t)b1 * in + (int64_t)a1 * tmp;
+		d1 = (int64_t)b2 * in + (int64_t)a2 * tmp;
+		acc = (int64_t)gain * tmp;
+		y[i] = sat_int32(Q_SHIFT_RND(acc, 45 + shift, 31));
+	}
+
+	delay[0] = d0;
+	delay[1] = d1;
+}
+
+/* Same as above with Q3.29 state, see iir_df2t_32() */
+void iir_df2t_biquad_block_32(int32_t *coef, int32_t *delay,
+			      const int32_t *x, int32_t *y, int n)
+{
+	int64_t acc;
+	int32_t d0 = delay[0];
+	int32_t d1 = delay[1];
+	int32_t a2 = coef[0];
+	int32_t a1 = coef[1];
+	int32_t b2 = coef[2];
+	int32_t b1 = coef[3];
+	int32_t b0 = coef[4];
+	int32_t shift = coef[5];
+	int32_t gain = coef[6];
+	int32_t in;
+	int32_t tmp;
+	int i;
+
+	for (i = 0; i < n; i++) {
+		in = x[i];
+		acc = ((int64_t)d0 << 32) + (int64_t)b0 * in;
+		tmp = (int32_t)Q_SHIFT_RND(acc, 61, 31);
+		acc = ((int64_t)d1 << 32) + (int64_t)b1 * in +
+			(int64_t)a1 * tmp;
+		d0 = sat_int32(Q_SHIFT_RND(acc, 61, 29));
+		acc = (int64_t)b2 * in + (int64_t)a2 * tmp;
+		d1 = sat_int32(Q_SHIFT_RND(acc, 61, 29));
+		acc = (int64_t)gain * tmp;
+		y[i] = sat_int32(Q_SHIFT_RND(acc, 45 + shift, 31));
+	}
+
+	delay[0] = d0;
+	delay[1] = d1;
+}
+
+#endif
+
+/* Run the biquad of coefficients coef and delay line index d of the IIR */
+static inline void iir_df2t_biquad(struct iir_state_df2t *iir, int32_t *coef,
+				   int d, const int32_t *x, int32_t *y, int n)
+{
+	if (iir->precision == SOF_EQ_IIR_PRECISION_32)
+		iir_df2t_biquad_block_32(coef, iir->delay32 + d, x, y, n);
+	else
+		iir_df2t_biquad_block(coef, iir->delay + d, x, y, n);
+}
+
+/* Process a block of n contiguous samples of one channel. The biquads are
+ * run one at a time over the block instead of one sample at a time through
+ * all of them. Input and output may be the same buffer.
+ */
+void iir_df2t_block(struct iir_state_df2t *iir, const int32_t *x, int32_t *y,
+		    int n)
+{
+	int32_t work[IIR_DF2T_BLOCK_SIZE];
+	int32_t sum[IIR_DF2T_BLOCK_SIZE];
+	int32_t *coef;
+	int d;
+	int i;
+	int j;
+	int k;
+	int m;
+
+	/* Bypass is set with number of biquads set to zero. */
+	if (!iir->biquads) {
+		if (x != y)
+			memcpy(y, x, n * sizeof(int32_t));
+		return;
+	}
+
+	/* A single series section is filtered in place in the output */
+	if (iir->biquads == iir->biquads_in_series) {
+		coef = iir->coef;
+		for (i = 0; i < iir->biquads; i++) {
+			iir_df2t_biquad(iir, coef, i * IIR_DF2T_NUM_DELAYS,
+					i ? y : x, y, n);
+			coef += SOF_EQ_IIR_NBIQUAD_DF2T;
+		}
+		return;
+	}
+
+	/* Parallel sections are summed in chunks of IIR_DF2T_BLOCK_SIZE */
+	for (k = 0; k < n; k += m) {
+		m = MIN(n - k, IIR_DF2T_BLOCK_SIZE);
+		coef = iir->coef;
+		d = 0;
+		for (j = 0; j < iir->biquads; j += iir->biquads_in_series) {
+			for (i = 0; i < iir->biquads_in_series; i++) {
+				iir_df2t_biquad(iir, coef, d, i ? work : x + k,
+						work, m);
+				coef += SOF_EQ_IIR_NBIQUAD_DF2T;
+				d += IIR_DF2T_NUM_DELAYS;
+			}
+
+			if (!j) {
+				memcpy(sum, work, m * sizeof(int32_t));
+				continue;
+			}
+
+			for (i = 0; i < m; i++)
+				sum[i] = sat_int32((int64_t)sum[i] + work[i]);
+		}
+
+		memcpy(y + k, sum, m * sizeof(int32_t));
+	}
+}
+
 size_t iir_init_coef_df2t(struct iir_state_df2t *iir,
 			  struct sof_eq_iir_header_df2t *config)
 {
 	iir->biquads = config->num_sections;
 	iir->biquads_in_series = config->num_sections_in_series;
+	iir->precision = config->precision;
 	iir->coef = config->biquads;
 	iir->delay = NULL;
+	iir->delay32 = NULL;
 
 	if (iir->biquads > SOF_EQ_IIR_DF2T_BIQUADS_MAX ||
-	    iir->biquads == 0) {
+	    iir->biquads == 0 ||
+	    (iir->precision != SOF_EQ_IIR_PRECISION_64 &&
+	     iir->precision != SOF_EQ_IIR_PRECISION_32)) {
 		iir_reset_df2t(iir);
 		return -EINVAL;
 	}
 
-	return 2 * iir->biquads * sizeof(int64_t); /* Needed delay line size */
+	/* Needed delay line size, 32 bit state takes half */
+	if (iir->precision == SOF_EQ_IIR_PRECISION_32)
+		return iir->biquads * sizeof(int64_t);
+
+	return 2 * iir->biquads * sizeof(int64_t);
+}
+
+/* Point to new coefficients but keep the filter state. The new response
+ * must have the same sections layout.
+ */
+int iir_update_coef_df2t(struct iir_state_df2t *iir,
+			 struct sof_eq_iir_header_df2t *config)
+{
+	if (iir->biquads != config->num_sections ||
+	    iir->biquads_in_series != config->num_sections_in_series ||
+	    iir->precision != config->precision ||
+	    !iir->delay)
+		return -EINVAL;
+
+	iir->coef = config->biquads;
+	return 0;
 }
 
 void iir_init_delay_df2t(struct iir_state_df2t *iir, int64_t **delay)
 {
 	/* Set delay line of this IIR */
 	iir->delay = *delay;
+	iir->delay32 = (int32_t *)*delay;
 
 	/* Point to next IIR delay line start. The DF2T biquad uses two
-	 * memory elements.
+	 * memory elements, with 32 bit state they fit in one int64_t.
 	 */
-	*delay += 2 * iir->biquads;
+	if (iir->precision == SOF_EQ_IIR_PRECISION_32)
+		*delay += iir->biquads;
+	else
+		*delay += 2 * iir->biquads;
 }
 
 void iir_reset_df2t(struct iir_state_df2t *iir)
 {
 	iir->biquads = 0;
 	iir->biquads_in_series = 0;
+	iir->precision = SOF_EQ_IIR_PRECISION_64;
 	iir->coef = NULL;
 	/* Note: May need to know the beginning of dynamic allocation after so
 	 * omitting setting iir->delay to NULL.
@@ -34,23 +34,58 @@
 #define IIR_H
 
 #include <uapi/user/eq.h>
+#include "iir_config.h"
 
 #define IIR_DF2T_NUM_DELAYS 2
 
+/* Max frames per block for functions that need scratch on stack */
+#define IIR_DF2T_BLOCK_SIZE 32
+
 struct iir_state_df2t {
 	unsigned int biquads; /* Number of IIR 2nd order sections total */
 	unsigned int biquads_in_series; /* Number of IIR 2nd order sections
 					 * in series.
 					 */
+	unsigned int precision; /* SOF_EQ_IIR_PRECISION_ of the state */
 	int32_t *coef; /* Pointer to IIR coefficients */
 	int64_t *delay; /* Pointer to IIR delay line */
+	int32_t *delay32; /* Same delay line with 32 bit state */
 };
 
 int32_t iir_df2t(struct iir_state_df2t *iir, int32_t x);
 
+void iir_df2t_biquad_block(int32_t *coef, int64_t *delay, const int32_t *x,
+			   int32_t *y, int n);
+
+void iir_df2t_biquad_block_32(int32_t *coef, int32_t *delay,
+			      const int32_t *x, int32_t *y, int n);
+
+void iir_df2t_block(struct iir_state_df2t *iir, const int32_t *x, int32_t *y,
+		    int n);
+
+#if IIR_HIFI3
+void iir_df2t_2x(struct iir_state_df2t *iir0, struct iir_state_df2t *iir1,
+		 int32_t x0, int32_t x1, int32_t *y0, int32_t *y1);
+
+/* Two channels can be processed in parallel only if they have the same
+ * filter structure with 64 bit state and neither is in bypass.
+ */
+static inline int iir_df2t_2x_supported(struct iir_state_df2t *iir0,
+					struct iir_state_df2t *iir1)
+{
+	return iir0->biquads && iir0->biquads == iir1->biquads &&
+		iir0->biquads_in_series == iir1->biquads_in_series &&
+		iir0->precision == SOF_EQ_IIR_PRECISION_64 &&
+		iir1->precision == SOF_EQ_IIR_PRECISION_64;
+}
+#endif
+
 size_t iir_init_coef_df2t(struct iir_state_df2t *iir,
 			  struct sof_eq_iir_header_df2t *config);
 
+int iir_update_coef_df2t(struct iir_state_df2t *iir,
+			 struct sof_eq_iir_header_df2t *config);
+
 void iir_init_delay_df2t(struct iir_state_df2t *iir, int64_t **delay);
 
 void iir_mute_df2t(struct iir_state_df2t *iir);
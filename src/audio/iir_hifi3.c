@@ -0,0 +1,342 @@
+/*
+ * Copyright (c) 2018, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Seppo Ingalsuo <seppo.ingalsuo@linux.intel.com>
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <errno.h>
+#include <sof/audio/format.h>
+#include <uapi/user/eq.h>
+#include "iir_config.h"
+
+#if IIR_HIFI3
+
+#include <xtensa/config/defs.h>
+#include <xtensa/tie/xt_hifi3.h>
+#include "iir.h"
+
+/*
+ * Series DF2T IIR, see iir.c for the biquad block diagram.
+ *
+ * The 32x32 bit fractional multiply gives Q2.30 x Q1.31 -> Q18.46 so the
+ * delay lines are kept in Q18.46. The Q1.31 rounding instruction expects
+ * Q17.47 so the sums are shifted left by one before rounding. The biquad
+ * gain is Q2.14 and the product with gain is converted to Q17.47 with the
+ * biquad output shift applied in the same step.
+ */
+
+/* Coefficients order in coef[] is {a2, a1, b2, b1, b0, shift, gain} */
+
+/* The 32 bit state is kept in Q3.29, the same headroom as Q18.46 */
+static inline ae_f64 iir_state_load_32(int32_t d)
+{
+	return AE_SLAI64(AE_CVT64F32_H(AE_MOVDA32(d)), 1);
+}
+
+static inline int32_t iir_state_store_32(ae_f64 acc)
+{
+	return AE_MOVAD32_L(AE_MOVDA32(AE_ROUND32F48SSYM(AE_SRAI64(acc, 1))));
+}
+
+static int32_t iir_df2t_32(struct iir_state_df2t *iir, int32_t x)
+{
+	ae_f64 acc;
+	ae_int32x2 coef_a2a1;
+	ae_int32x2 coef_b2b1;
+	ae_int32x2 coef_b0;
+	ae_int32x2 gain;
+	ae_int32x2 in;
+	ae_int32x2 tmp;
+	ae_int32x2 out = AE_ZERO32();
+	int32_t *delay = iir->delay32;
+	int32_t *coef = iir->coef;
+	int i;
+	int j;
+
+	for (j = 0; j < iir->biquads; j += iir->biquads_in_series) {
+		in = AE_MOVDA32(x);
+		for (i = 0; i < iir->biquads_in_series; i++) {
+			coef_a2a1 = AE_MOVDA32X2(coef[0], coef[1]);
+			coef_b2b1 = AE_MOVDA32X2(coef[2], coef[3]);
+			coef_b0 = AE_MOVDA32(coef[4]);
+			gain = AE_MOVDA32(coef[6]);
+
+			acc = iir_state_load_32(delay[0]);
+			AE_MULAF32R_LL(acc, coef_b0, in);
+			tmp = AE_MOVDA32(AE_ROUND32F48SSYM(AE_SLAI64(acc, 1)));
+
+			acc = iir_state_load_32(delay[1]);
+			AE_MULAF32R_LL(acc, coef_b2b1, in);
+			AE_MULAF32R_LL(acc, coef_a2a1, tmp);
+			delay[0] = iir_state_store_32(acc);
+
+			acc = AE_MULF32R_HH(coef_b2b1, in);
+			AE_MULAF32R_HH(acc, coef_a2a1, tmp);
+			delay[1] = iir_state_store_32(acc);
+
+			acc = AE_MULF32R_LL(gain, tmp);
+			acc = AE_SLAA64S(acc, 17 - coef[5]);
+			in = AE_MOVDA32(AE_ROUND32F48SSYM(acc));
+
+			coef += SOF_EQ_IIR_NBIQUAD_DF2T;
+			delay += IIR_DF2T_NUM_DELAYS;
+		}
+		out = AE_ADD32S(out, in);
+	}
+
+	return AE_MOVAD32_L(out);
+}
+
+int32_t iir_df2t(struct iir_state_df2t *iir, int32_t x)
+{
+	ae_f64 acc;
+	ae_int32x2 coef_a2a1;
+	ae_int32x2 coef_b2b1;
+	ae_int32x2 coef_b0;
+	ae_int32x2 gain;
+	ae_int32x2 in;
+	ae_int32x2 tmp;
+	ae_int32x2 out = AE_ZERO32();
+	ae_int64 *delay = (ae_int64 *)iir->delay;
+	int32_t *coef = iir->coef;
+	int i;
+	int j;
+
+	/* Bypass is set with number of biquads set to zero. */
+	if (!iir->biquads)
+		return x;
+
+	if (iir->precision == SOF_EQ_IIR_PRECISION_32)
+		return iir_df2t_32(iir, x);
+
+	for (j = 0; j < iir->biquads; j += iir->biquads_in_series) {
+		in = AE_MOVDA32(x);
+		for (i = 0; i < iir->biquads_in_series; i++) {
+			coef_a2a1 = AE_MOVDA32X2(coef[0], coef[1]);
+			coef_b2b1 = AE_MOVDA32X2(coef[2], coef[3]);
+			coef_b0 = AE_MOVDA32(coef[4]);
+			gain = AE_MOVDA32(coef[6]);
+
+			/* Compute output */
+			acc = delay[0];
+			AE_MULAF32R_LL(acc, coef_b0, in);
+			tmp = AE_MOVDA32(AE_ROUND32F48SSYM(AE_SLAI64(acc, 1)));
+
+			/* Compute 1st delay */
+			acc = delay[1];
+			AE_MULAF32R_LL(acc, coef_b2b1, in);
+			AE_MULAF32R_LL(acc, coef_a2a1, tmp);
+			delay[0] = acc;
+
+			/* Compute 2nd delay */
+			acc = AE_MULF32R_HH(coef_b2b1, in);
+			AE_MULAF32R_HH(acc, coef_a2a1, tmp);
+			delay[1] = acc;
+
+			/* Apply gain and output shift, negative shift amount
+			 * is a right shift. Then saturate to Q1.31 and prepare
+			 * for next biquad.
+			 */
+			acc = AE_MULF32R_LL(gain, tmp);
+			acc = AE_SLAA64S(acc, 17 - coef[5]);
+			in = AE_MOVDA32(AE_ROUND32F48SSYM(acc));
+
+			/* Proceed to next biquad coefficients and delay
+			 * lines.
+			 */
+			coef += SOF_EQ_IIR_NBIQUAD_DF2T;
+			delay += IIR_DF2T_NUM_DELAYS;
+		}
+		/* Output of previous section is in variable in */
+		out = AE_ADD32S(out, in);
+	}
+
+	return AE_MOVAD32_L(out);
+}
+
+void iir_df2t_biquad_block(int32_t *coef, int64_t *delay, const int32_t *x,
+			   int32_t *y, int n)
+{
+	ae_f64 acc;
+	ae_int64 d0 = ((ae_int64 *)delay)[0];
+	ae_int64 d1 = ((ae_int64 *)delay)[1];
+	ae_int32x2 coef_a2a1 = AE_MOVDA32X2(coef[0], coef[1]);
+	ae_int32x2 coef_b2b1 = AE_MOVDA32X2(coef[2], coef[3]);
+	ae_int32x2 coef_b0 = AE_MOVDA32(coef[4]);
+	ae_int32x2 gain = AE_MOVDA32(coef[6]);
+	ae_int32x2 in;
+	ae_int32x2 tmp;
+	int shift = 17 - coef[5];
+	int i;
+
+	for (i = 0; i < n; i++) {
+		in = AE_MOVDA32(x[i]);
+
+		acc = d0;
+		AE_MULAF32R_LL(acc, coef_b0, in);
+		tmp = AE_MOVDA32(AE_ROUND32F48SSYM(AE_SLAI64(acc, 1)));
+
+		acc = d1;
+		AE_MULAF32R_LL(acc, coef_b2b1, in);
+		AE_MULAF32R_LL(acc, coef_a2a1, tmp);
+		d0 = acc;
+
+		acc = AE_MULF32R_HH(coef_b2b1, in);
+		AE_MULAF32R_HH(acc, coef_a2a1, tmp);
+		d1 = acc;
+
+		acc = AE_MULF32R_LL(gain, tmp);
+		acc = AE_SLAA64S(acc, shift);
+		y[i] = AE_MOVAD32_L(AE_MOVDA32(AE_ROUND32F48SSYM(acc)));
+	}
+
+	((ae_int64 *)delay)[0] = d0;
+	((ae_int64 *)delay)[1] = d1;
+}
+
+void iir_df2t_biquad_block_32(int32_t *coef, int32_t *delay,
+			      const int32_t *x, int32_t *y, int n)
+{
+	ae_f64 acc;
+	int32_t d0 = delay[0];
+	int32_t d1 = delay[1];
+	ae_int32x2 coef_a2a1 = AE_MOVDA32X2(coef[0], coef[1]);
+	ae_int32x2 coef_b2b1 = AE_MOVDA32X2(coef[2], coef[3]);
+	ae_int32x2 coef_b0 = AE_MOVDA32(coef[4]);
+	ae_int32x2 gain = AE_MOVDA32(coef[6]);
+	ae_int32x2 in;
+	ae_int32x2 tmp;
+	int shift = 17 - coef[5];
+	int i;
+
+	for (i = 0; i < n; i++) {
+		in = AE_MOVDA32(x[i]);
+
+		acc = iir_state_load_32(d0);
+		AE_MULAF32R_LL(acc, coef_b0, in);
+		tmp = AE_MOVDA32(AE_ROUND32F48SSYM(AE_SLAI64(acc, 1)));
+
+		acc = iir_state_load_32(d1);
+		AE_MULAF32R_LL(acc, coef_b2b1, in);
+		AE_MULAF32R_LL(acc, coef_a2a1, tmp);
+		d0 = iir_state_store_32(acc);
+
+		acc = AE_MULF32R_HH(coef_b2b1, in);
+		AE_MULAF32R_HH(acc, coef_a2a1, tmp);
+		d1 = iir_state_store_32(acc);
+
+		acc = AE_MULF32R_LL(gain, tmp);
+		acc = AE_SLAA64S(acc, shift);
+		y[i] = AE_MOVAD32_L(AE_MOVDA32(AE_ROUND32F48SSYM(acc)));
+	}
+
+	delay[0] = d0;
+	delay[1] = d1;
+}
+
+/* Two channels with identical filter structure are processed in parallel,
+ * the first channel in the high and the second in the low vector element.
+ */
+void iir_df2t_2x(struct iir_state_df2t *iir0, struct iir_state_df2t *iir1,
+		 int32_t x0, int32_t x1, int32_t *y0, int32_t *y1)
+{
+	ae_f64 acc0;
+	ae_f64 acc1;
+	ae_int32x2 coef_a2;
+	ae_int32x2 coef_a1;
+	ae_int32x2 coef_b2;
+	ae_int32x2 coef_b1;
+	ae_int32x2 coef_b0;
+	ae_int32x2 gain;
+	ae_int32x2 in;
+	ae_int32x2 tmp;
+	ae_int32x2 out = AE_ZERO32();
+	ae_int64 *delay0 = (ae_int64 *)iir0->delay;
+	ae_int64 *delay1 = (ae_int64 *)iir1->delay;
+	int32_t *c0 = iir0->coef;
+	int32_t *c1 = iir1->coef;
+	int i;
+	int j;
+
+	for (j = 0; j < iir0->biquads; j += iir0->biquads_in_series) {
+		in = AE_MOVDA32X2(x0, x1);
+		for (i = 0; i < iir0->biquads_in_series; i++) {
+			coef_a2 = AE_MOVDA32X2(c0[0], c1[0]);
+			coef_a1 = AE_MOVDA32X2(c0[1], c1[1]);
+			coef_b2 = AE_MOVDA32X2(c0[2], c1[2]);
+			coef_b1 = AE_MOVDA32X2(c0[3], c1[3]);
+			coef_b0 = AE_MOVDA32X2(c0[4], c1[4]);
+			gain = AE_MOVDA32X2(c0[6], c1[6]);
+
+			/* Compute output */
+			acc0 = delay0[0];
+			acc1 = delay1[0];
+			AE_MULAF32R_HH(acc0, coef_b0, in);
+			AE_MULAF32R_LL(acc1, coef_b0, in);
+			tmp = AE_ROUND32X2F48SSYM(AE_SLAI64(acc0, 1),
+						  AE_SLAI64(acc1, 1));
+
+			/* Compute 1st delay */
+			acc0 = delay0[1];
+			acc1 = delay1[1];
+			AE_MULAF32R_HH(acc0, coef_b1, in);
+			AE_MULAF32R_LL(acc1, coef_b1, in);
+			AE_MULAF32R_HH(acc0, coef_a1, tmp);
+			AE_MULAF32R_LL(acc1, coef_a1, tmp);
+			delay0[0] = acc0;
+			delay1[0] = acc1;
+
+			/* Compute 2nd delay */
+			acc0 = AE_MULF32R_HH(coef_b2, in);
+			acc1 = AE_MULF32R_LL(coef_b2, in);
+			AE_MULAF32R_HH(acc0, coef_a2, tmp);
+			AE_MULAF32R_LL(acc1, coef_a2, tmp);
+			delay0[1] = acc0;
+			delay1[1] = acc1;
+
+			/* Apply gain and output shift */
+			acc0 = AE_MULF32R_HH(gain, tmp);
+			acc1 = AE_MULF32R_LL(gain, tmp);
+			acc0 = AE_SLAA64S(acc0, 17 - c0[5]);
+			acc1 = AE_SLAA64S(acc1, 17 - c1[5]);
+			in = AE_ROUND32X2F48SSYM(acc0, acc1);
+
+			c0 += SOF_EQ_IIR_NBIQUAD_DF2T;
+			c1 += SOF_EQ_IIR_NBIQUAD_DF2T;
+			delay0 += IIR_DF2T_NUM_DELAYS;
+			delay1 += IIR_DF2T_NUM_DELAYS;
+		}
+		out = AE_ADD32S(out, in);
+	}
+
+	*y0 = AE_MOVAD32_H(out);
+	*y1 = AE_MOVAD32_L(out);
+}
+
+#endif
@@ -0,0 +1,461 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Liam Girdwood <liam.r.girdwood@linux.intel.com>
+ */
+
+/**
+ * \file audio/kpb.c
+ * \brief Key phrase buffer component implementation
+ *
+ * The key phrase buffer sits between a low rate capture DAI and the host.
+ * While buffering it keeps the last history_ms of the stream in a history
+ * ring, preferably in low power memory, sends nothing to the host and runs
+ * the core at its lowest clock. A wake switch control, e.g. from a key
+ * phrase detector, raises the clock and drains the history to the host as
+ * fast as the sink buffer and host DMA allow. Live capture is queued behind
+ * the history, so no samples are lost while draining, and the clock is
+ * restored once the history has been sent.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <errno.h>
+#include <sof/sof.h>
+#include <sof/lock.h>
+#include <sof/list.h>
+#include <sof/stream.h>
+#include <sof/alloc.h>
+#include <sof/ipc.h>
+#include <sof/clk.h>
+#include <sof/cpu.h>
+#include <sof/audio/component.h>
+#include <platform/clk.h>
+#include <uapi/ipc/control.h>
+#include "kpb.h"
+
+/* request a CPU clock for the calling core, 0 restores the default */
+static void kpb_set_clock(struct kpb_data *cd, uint32_t hz)
+{
+	if (cd->clock_hz == hz)
+		return;
+
+	trace_kpb("kpb_set_clock(), hz = %u", hz);
+
+	cd->clock_hz = hz;
+	clock_set_freq(CLK_CPU(cpu_get_id()), hz ? hz : CLK_DEFAULT_CPU_HZ);
+}
+
+/* clock for the current state of a running KPB */
+static void kpb_state_clock(struct kpb_data *cd)
+{
+	switch (cd->state) {
+	case KPB_STATE_BUFFERING:
+		kpb_set_clock(cd, clock_cpu_min_freq());
+		break;
+	case KPB_STATE_DRAINING:
+		kpb_set_clock(cd, CLK_MAX_CPU_HZ);
+		break;
+	default:
+		kpb_set_clock(cd, 0);
+		break;
+	}
+}
+
+static void kpb_free_hist(struct kpb_data *cd)
+{
+	rfree(cd->hist.addr);
+	cd->hist.addr = NULL;
+	cd->hist.size = 0;
+	cd->hist.w = 0;
+	cd->hist.level = 0;
+}
+
+/* history rounded up to whole periods, in low power memory if available */
+static int kpb_alloc_hist(struct comp_dev *dev, struct kpb_data *cd)
+{
+	struct sof_ipc_comp_kpb *ipc_kpb = COMP_GET_IPC(dev, sof_ipc_comp_kpb);
+	uint32_t ms = ipc_kpb->history_ms ? ipc_kpb->history_ms :
+		KPB_DEFAULT_HISTORY_MS;
+	uint32_t frames = ((uint64_t)dev->params.rate * ms + 999) / 1000;
+	uint32_t periods = (frames + dev->frames - 1) / dev->frames;
+	uint32_t size = periods * cd->period_bytes;
+
+	if (cd->hist.addr && cd->hist.size == size)
+		goto out;
+
+	kpb_free_hist(cd);
+
+	cd->hist.addr = rballoc(RZONE_BUFFER,
+				SOF_MEM_CAPS_RAM | SOF_MEM_CAPS_LP, size);
+	if (!cd->hist.addr)
+		cd->hist.addr = rballoc(RZONE_BUFFER, SOF_MEM_CAPS_RAM, size);
+	if (!cd->hist.addr) {
+		trace_kpb_error("kpb_alloc_hist() error: no memory for %u "
+				"bytes", size);
+		return -ENOMEM;
+	}
+
+	cd->hist.size = size;
+
+out:
+	cd->hist.w = 0;
+	cd->hist.level = 0;
+
+	trace_kpb("kpb_alloc_hist(), ms = %u, size = %u", ms, size);
+	return 0;
+}
+
+static struct comp_dev *kpb_new(struct sof_ipc_comp *comp)
+{
+	struct comp_dev *dev;
+	struct sof_ipc_comp_kpb *ipc_kpb = (struct sof_ipc_comp_kpb *)comp;
+	struct kpb_data *cd;
+
+	trace_kpb("kpb_new()");
+
+	if (IPC_IS_SIZE_INVALID(ipc_kpb->config)) {
+		IPC_SIZE_ERROR_TRACE(TRACE_CLASS_KPB, ipc_kpb->config);
+		return NULL;
+	}
+
+	if (ipc_kpb->history_ms > KPB_MAX_HISTORY_MS) {
+		trace_kpb_error("kpb_new() error: history_ms = %u > "
+				"KPB_MAX_HISTORY_MS", ipc_kpb->history_ms);
+		return NULL;
+	}
+
+	dev = rzalloc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM,
+		      COMP_SIZE(struct sof_ipc_comp_kpb));
+	if (!dev)
+		return NULL;
+
+	memcpy(&dev->comp, comp, sizeof(struct sof_ipc_comp_kpb));
+
+	cd = rzalloc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM, sizeof(*cd));
+	if (!cd) {
+		rfree(dev);
+		return NULL;
+	}
+
+	comp_set_drvdata(dev, cd);
+	cd->state = KPB_STATE_BUFFERING;
+
+	dev->state = COMP_STATE_READY;
+	return dev;
+}
+
+static void kpb_free(struct comp_dev *dev)
+{
+	struct kpb_data *cd = comp_get_drvdata(dev);
+
+	trace_kpb("kpb_free()");
+
+	kpb_set_clock(cd, 0);
+	kpb_free_hist(cd);
+
+	rfree(cd);
+	rfree(dev);
+}
+
+/* set component audio stream parameters */
+static int kpb_params(struct comp_dev *dev)
+{
+	trace_kpb("kpb_params()");
+
+	/* room to drain the history several periods per copy */
+	dev->min_sink_bytes = KPB_DRAIN_PERIODS * dev->frames *
+		comp_frame_bytes(dev);
+
+	/* All other configuration work is postponed to prepare(). */
+	return 0;
+}
+
+static int kpb_cmd_set_value(struct comp_dev *dev,
+			     struct sof_ipc_ctrl_data *cdata)
+{
+	struct kpb_data *cd = comp_get_drvdata(dev);
+
+	if (cdata->cmd != SOF_CTRL_CMD_SWITCH || !cdata->num_elems) {
+		trace_kpb_error("kpb_cmd_set_value() error: invalid cmd = %u",
+				cdata->cmd);
+		return -EINVAL;
+	}
+
+	cd->wake = cdata->chanv[0].value ? 1 : 0;
+
+	trace_kpb("kpb_cmd_set_value(), wake = %u", cd->wake);
+
+	if (cd->wake && cd->state == KPB_STATE_BUFFERING)
+		cd->state = KPB_STATE_DRAINING;
+	else if (!cd->wake)
+		cd->state = KPB_STATE_BUFFERING;
+
+	if (dev->state == COMP_STATE_ACTIVE)
+		kpb_state_clock(cd);
+
+	return 0;
+}
+
+static int kpb_cmd_get_value(struct comp_dev *dev,
+			     struct sof_ipc_ctrl_data *cdata)
+{
+	struct kpb_data *cd = comp_get_drvdata(dev);
+	int j;
+
+	if (cdata->cmd != SOF_CTRL_CMD_SWITCH ||
+	    cdata->num_elems > SOF_IPC_MAX_CHANNELS) {
+		trace_kpb_error("kpb_cmd_get_value() error: invalid cmd = %u",
+				cdata->cmd);
+		return -EINVAL;
+	}
+
+	for (j = 0; j < cdata->num_elems; j++) {
+		cdata->chanv[j].channel = j;
+		cdata->chanv[j].value = cd->wake;
+	}
+
+	return 0;
+}
+
+static int kpb_cmd(struct comp_dev *dev, int cmd, void *data,
+		   int max_data_size)
+{
+	struct sof_ipc_ctrl_data *cdata = data;
+
+	trace_kpb("kpb_cmd()");
+
+	switch (cmd) {
+	case COMP_CMD_SET_VALUE:
+		return kpb_cmd_set_value(dev, cdata);
+	case COMP_CMD_GET_VALUE:
+		return kpb_cmd_get_value(dev, cdata);
+	default:
+		trace_kpb_error("kpb_cmd() error: invalid command");
+		return -EINVAL;
+	}
+}
+
+static int kpb_trigger(struct comp_dev *dev, int cmd)
+{
+	struct kpb_data *cd = comp_get_drvdata(dev);
+	int ret;
+
+	trace_kpb("kpb_trigger()");
+
+	ret = comp_set_state(dev, cmd);
+	if (ret < 0)
+		return ret;
+
+	switch (cmd) {
+	case COMP_TRIGGER_START:
+	case COMP_TRIGGER_RELEASE:
+		kpb_state_clock(cd);
+		break;
+	case COMP_TRIGGER_STOP:
+	case COMP_TRIGGER_PAUSE:
+	case COMP_TRIGGER_XRUN:
+		kpb_set_clock(cd, 0);
+		break;
+	default:
+		break;
+	}
+
+	return ret;
+}
+
+/*
+ * Every period of the source goes into the history. Unless buffering, as
+ * much of the history as the sink has room for is then moved on, which
+ * is one period per copy once the history has been drained.
+ */
+static int kpb_copy(struct comp_dev *dev)
+{
+	struct kpb_data *cd = comp_get_drvdata(dev);
+	struct comp_buffer *source;
+	struct comp_buffer *sink;
+	uint32_t bytes;
+
+	tracev_kpb("kpb_copy()");
+
+	source = list_first_item(&dev->bsource_list, struct comp_buffer,
+				 sink_list);
+	sink = list_first_item(&dev->bsink_list, struct comp_buffer,
+			       source_list);
+
+	if (comp_buffer_get_avail_bytes(source) < cd->period_bytes) {
+		trace_kpb_error("kpb_copy() error: source component buffer "
+				"has not enough data available");
+		comp_underrun(dev, source, cd->period_bytes, 0);
+		return -EIO;	/* xrun */
+	}
+
+	kpb_hist_write(&cd->hist, source, cd->period_bytes);
+	comp_update_buffer_consume(source, cd->period_bytes);
+
+	if (cd->state == KPB_STATE_BUFFERING)
+		return dev->frames;
+
+	bytes = MIN(cd->hist.level, comp_buffer_get_free_bytes(sink));
+	bytes -= bytes % cd->period_bytes;
+	if (bytes) {
+		kpb_hist_read(&cd->hist, sink, bytes);
+		comp_update_buffer_produce(sink, bytes);
+	}
+
+	if (cd->state == KPB_STATE_DRAINING && !cd->hist.level) {
+		trace_kpb("kpb_copy(), history drained");
+		cd->state = KPB_STATE_STREAMING;
+		kpb_state_clock(cd);
+	}
+
+	return dev->frames;
+}
+
+static int kpb_prepare(struct comp_dev *dev)
+{
+	struct kpb_data *cd = comp_get_drvdata(dev);
+	struct sof_ipc_comp_config *config = COMP_GET_CONFIG(dev);
+	struct comp_buffer *sourceb;
+	struct comp_buffer *sinkb;
+	enum sof_ipc_frame source_fmt;
+	enum sof_ipc_frame sink_fmt;
+	uint32_t sink_period_bytes;
+	uint32_t periods;
+	int ret;
+
+	trace_kpb("kpb_prepare()");
+
+	ret = comp_set_state(dev, COMP_TRIGGER_PREPARE);
+	if (ret < 0)
+		return ret;
+
+	/* KPB components will only ever have 1 source and 1 sink buffer */
+	sourceb = list_first_item(&dev->bsource_list,
+				  struct comp_buffer, sink_list);
+	sinkb = list_first_item(&dev->bsink_list,
+				struct comp_buffer, source_list);
+
+	comp_set_period_bytes(sourceb->source, dev->frames, &source_fmt,
+			      &cd->period_bytes);
+	comp_set_period_bytes(sinkb->sink, dev->frames, &sink_fmt,
+			      &sink_period_bytes);
+
+	/* the history is sent as captured */
+	if (source_fmt != sink_fmt || cd->period_bytes != sink_period_bytes ||
+	    !cd->period_bytes) {
+		trace_kpb_error("kpb_prepare() error: source_format = %d, "
+				"sink_format = %d", source_fmt, sink_fmt);
+		ret = -EINVAL;
+		goto err;
+	}
+
+	dev->frame_bytes = cd->period_bytes / dev->frames;
+
+	ret = kpb_alloc_hist(dev, cd);
+	if (ret < 0)
+		goto err;
+
+	/* a deeper sink lets the host take several periods per copy */
+	periods = MIN(KPB_DRAIN_PERIODS, sinkb->alloc_size / cd->period_bytes);
+	periods = MAX(periods, config->periods_sink);
+	ret = buffer_set_size(sinkb, cd->period_bytes * periods);
+	if (ret < 0) {
+		trace_kpb_error("kpb_prepare() error: "
+				"buffer_set_size() failed");
+		goto err;
+	}
+
+	cd->state = cd->wake ? KPB_STATE_STREAMING : KPB_STATE_BUFFERING;
+
+	return 0;
+
+err:
+	comp_set_state(dev, COMP_TRIGGER_RESET);
+	return ret;
+}
+
+static int kpb_reset(struct comp_dev *dev)
+{
+	struct kpb_data *cd = comp_get_drvdata(dev);
+
+	trace_kpb("kpb_reset()");
+
+	kpb_set_clock(cd, 0);
+	kpb_free_hist(cd);
+	cd->state = KPB_STATE_BUFFERING;
+
+	comp_set_state(dev, COMP_TRIGGER_RESET);
+	return 0;
+}
+
+static void kpb_cache(struct comp_dev *dev, int cmd)
+{
+	struct kpb_data *cd;
+
+	switch (cmd) {
+	case COMP_CACHE_WRITEBACK_INV:
+		trace_kpb("kpb_cache(), COMP_CACHE_WRITEBACK_INV");
+
+		cd = comp_get_drvdata(dev);
+		dcache_writeback_invalidate_region(cd, sizeof(*cd));
+		dcache_writeback_invalidate_region(dev, sizeof(*dev));
+		break;
+
+	case COMP_CACHE_INVALIDATE:
+		trace_kpb("kpb_cache(), COMP_CACHE_INVALIDATE");
+
+		dcache_invalidate_region(dev, sizeof(*dev));
+
+		/* Note: The component data need to be retrieved after
+		 * the dev data has been invalidated.
+		 */
+		cd = comp_get_drvdata(dev);
+		dcache_invalidate_region(cd, sizeof(*cd));
+		break;
+	}
+}
+
+struct comp_driver comp_kpb = {
+	.type = SOF_COMP_KPB,
+	.ops = {
+		.new = kpb_new,
+		.free = kpb_free,
+		.params = kpb_params,
+		.cmd = kpb_cmd,
+		.trigger = kpb_trigger,
+		.copy = kpb_copy,
+		.prepare = kpb_prepare,
+		.reset = kpb_reset,
+		.cache = kpb_cache,
+	},
+};
+
+void sys_comp_kpb_init(void)
+{
+	comp_register(&comp_kpb);
+}
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Liam Girdwood <liam.r.girdwood@linux.intel.com>
+ */
+
+/**
+ * \file audio/kpb.h
+ * \brief Key phrase buffer component header file
+ */
+
+#ifndef KPB_H
+#define KPB_H
+
+#include <stdint.h>
+#include <string.h>
+#include <sof/audio/component.h>
+
+/** \brief KPB trace function. */
+#define trace_kpb(__e, ...) \
+	trace_event(TRACE_CLASS_KPB, __e, ##__VA_ARGS__)
+
+/** \brief KPB trace value function. */
+#define tracev_kpb(__e, ...) \
+	tracev_event(TRACE_CLASS_KPB, __e, ##__VA_ARGS__)
+
+/** \brief KPB trace error function. */
+#define trace_kpb_error(__e, ...) \
+	trace_error(TRACE_CLASS_KPB, __e, ##__VA_ARGS__)
+
+/** \brief Default history length in ms. */
+#define KPB_DEFAULT_HISTORY_MS	2000
+
+/** \brief Longest supported history in ms. */
+#define KPB_MAX_HISTORY_MS	2100
+
+/** \brief Periods in the sink buffer while draining. */
+#define KPB_DRAIN_PERIODS	8
+
+/** \brief KPB states. */
+enum kpb_state {
+	KPB_STATE_BUFFERING = 0,	/**< history only, nothing to sink */
+	KPB_STATE_DRAINING,		/**< history moved to sink, clock high */
+	KPB_STATE_STREAMING,		/**< history drained, live to sink */
+};
+
+/** \brief History ring buffer. */
+struct kpb_hist {
+	uint8_t *addr;		/**< ring base */
+	uint32_t size;		/**< ring size in bytes */
+	uint32_t w;		/**< write offset */
+	uint32_t level;		/**< bytes of history in the ring */
+};
+
+/** \brief KPB component private data. */
+struct kpb_data {
+	struct kpb_hist hist;	/**< history of the source stream */
+	uint32_t period_bytes;	/**< source and sink period bytes */
+	uint32_t state;		/**< enum kpb_state */
+	uint32_t wake;		/**< switch control, 1 drains the history */
+	uint32_t clock_hz;	/**< CPU clock requested, 0 if none */
+};
+
+/**
+ * \brief Writes bytes from the source read pointer to the history. The
+ *	  oldest history is dropped when the ring is full.
+ * \param[in,out] hist History ring buffer.
+ * \param[in] source Source buffer, not consumed.
+ * \param[in] bytes Bytes to write, at most the ring size.
+ */
+static inline void kpb_hist_write(struct kpb_hist *hist,
+				  struct comp_buffer *source, uint32_t bytes)
+{
+	void *src = source->r_ptr;
+	uint32_t n;
+
+	hist->level = MIN(hist->level + bytes, hist->size);
+
+	while (bytes) {
+		n = MIN(bytes, buffer_bytes_to_wrap(source, src));
+		n = MIN(n, hist->size - hist->w);
+		memcpy(hist->addr + hist->w, src, n);
+		src = buffer_wrap(source, (char *)src + n);
+		hist->w += n;
+		if (hist->w == hist->size)
+			hist->w = 0;
+		bytes -= n;
+	}
+}
+
+/**
+ * \brief Moves the oldest history to the sink write pointer.
+ * \param[in,out] hist History ring buffer.
+ * \param[in,out] sink Sink buffer, not produced.
+ * \param[in] bytes Bytes to move, at most the history level.
+ */
+static inline void kpb_hist_read(struct kpb_hist *hist,
+				 struct comp_buffer *sink, uint32_t bytes)
+{
+	uint32_t r = hist->w >= hist->level ? hist->w - hist->level :
+		hist->w + hist->size - hist->level;
+	void *dst = sink->w_ptr;
+	uint32_t n;
+
+	hist->level -= bytes;
+
+	while (bytes) {
+		n = MIN(bytes, buffer_bytes_to_wrap(sink, dst));
+		n = MIN(n, hist->size - r);
+		memcpy(dst, hist->addr + r, n);
+		dst = buffer_wrap(sink, (char *)dst + n);
+		r += n;
+		if (r == hist->size)
+			r = 0;
+		bytes -= n;
+	}
+}
+
+#endif /* KPB_H */
@@ -38,43 +38,161 @@
 #include <sof/ipc.h>
 #include <sof/audio/component.h>
 #include <sof/audio/format.h>
+#include <sof/math/numbers.h>
+#include "mixer.h"
 
-#define trace_mixer(__e)	trace_event(TRACE_CLASS_MIXER, __e)
-#define tracev_mixer(__e)	tracev_event(TRACE_CLASS_MIXER, __e)
-#define trace_mixer_error(__e)	trace_error(TRACE_CLASS_MIXER, __e)
+/*
+ * Mix one period of frames. Source and sink buffers are circular, so the
+ * processing function is called for each region that doesn't wrap in any
+ * of the buffers and the period size is not required to divide the buffer
+ * sizes.
+ */
+static void mixer_mix(struct comp_dev *dev, struct comp_buffer *sink,
+		      struct comp_buffer **sources, uint32_t num_sources)
+{
+	struct mixer_data *md = comp_get_drvdata(dev);
+	uint32_t sample_bytes = comp_sample_bytes(dev);
+	uint32_t samples = dev->frames * dev->params.channels;
+	void *src[PLATFORM_MAX_STREAMS];
+	void *dest = sink->w_ptr;
+	uint32_t n;
+	uint32_t i;
+
+	for (i = 0; i < num_sources; i++)
+		src[i] = sources[i]->r_ptr;
+
+	while (samples) {
+		/* samples until the first buffer wrap */
+		n = buffer_wrap_samples(sink, dest, sample_bytes, samples);
+		for (i = 0; i < num_sources; i++)
+			n = buffer_wrap_samples(sources[i], src[i],
+						sample_bytes, n);
+
+		md->mix(dest, src, num_sources, n);
+
+		dest = buffer_wrap(sink, dest + n * sample_bytes);
+		for (i = 0; i < num_sources; i++)
+			src[i] = buffer_wrap(sources[i],
+					     src[i] + n * sample_bytes);
+
+		samples -= n;
+	}
+}
 
-/* mixer component private data */
-struct mixer_data {
-	uint32_t period_bytes;
-	void (*mix_func)(struct comp_dev *dev, struct comp_buffer *sink,
-		struct comp_buffer **sources, uint32_t count, uint32_t frames);
-};
+static inline uint32_t mixer_sample_bytes(uint32_t format)
+{
+	return format == SOF_IPC_FRAME_S16_LE ? 2 : 4;
+}
 
-/* mix N PCM source streams to one sink stream */
-static void mix_n(struct comp_dev *dev, struct comp_buffer *sink,
-	struct comp_buffer **sources, uint32_t num_sources, uint32_t frames)
+/* sample i of a source in Q1.31 */
+static inline int32_t mixer_sample(const void *ptr, uint32_t format,
+				   uint32_t i)
 {
-	int32_t *src;
-	int32_t *dest = sink->w_ptr;
-	int32_t count;
-	int64_t val[2];
-	int i;
-	int j;
+	switch (format) {
+	case SOF_IPC_FRAME_S16_LE:
+		return (int32_t)((const int16_t *)ptr)[i] << 16;
+	case SOF_IPC_FRAME_S24_4LE:
+		return sign_extend_s24(((const int32_t *)ptr)[i]) << 8;
+	default:
+		return ((const int32_t *)ptr)[i];
+	}
+}
 
-	count = frames * dev->params.channels;
+/*
+ * Mix samples of sources in any format, each scaled by its gain, to the
+ * sink format. The conversion and gain are applied as the sources are
+ * summed, the partial sums saturate as in the HiFi3 kernels. The gain of
+ * each source moves by its step at every frame, channel is the position
+ * in the frame of the first sample.
+ */
+static void mixer_mix_weighted(struct comp_dev *dev, void *dest,
+			       struct mixer_input *in, uint32_t num_sources,
+			       uint32_t samples, uint32_t *channel)
+{
+	int32_t acc[MIXER_ACC_SAMPLES];
+	uint32_t channels = dev->params.channels;
+	uint32_t ch;
+	uint32_t n;
+	uint32_t i;
+	uint32_t j;
+	int32_t gain;
+
+	while (samples) {
+		n = MIN(samples, MIXER_ACC_SAMPLES);
+		memset(acc, 0, n * sizeof(acc[0]));
 
-	for (i = 0; i < count; i += 2) {
-		val[0] = 0;
-		val[1] = 0;
 		for (j = 0; j < num_sources; j++) {
-			src = sources[j]->r_ptr;
-			val[0] += src[i];
-			val[1] += src[i + 1];
+			gain = in[j].gain;
+			ch = *channel;
+
+			for (i = 0; i < n; i++) {
+				acc[i] = sat_int32((int64_t)acc[i] +
+					(((int64_t)mixer_sample(in[j].ptr,
+							in[j].format, i) *
+					  gain) >> MIXER_WEIGHT_Q));
+
+				if (++ch == channels) {
+					ch = 0;
+					gain += in[j].step;
+				}
+			}
+
+			in[j].gain = gain;
+			in[j].ptr += n * mixer_sample_bytes(in[j].format);
+		}
+
+		switch (dev->params.frame_fmt) {
+		case SOF_IPC_FRAME_S16_LE:
+			for (i = 0; i < n; i++)
+				((int16_t *)dest)[i] = acc[i] >> 16;
+			break;
+		case SOF_IPC_FRAME_S24_4LE:
+			for (i = 0; i < n; i++)
+				((int32_t *)dest)[i] = acc[i] >> 8;
+			break;
+		default:
+			memcpy(dest, acc, n * sizeof(acc[0]));
+			break;
 		}
 
-		/* Saturate to 32 bits */
-		dest[i] = sat_int32(val[0]);
-		dest[i + 1] = sat_int32(val[1]);
+		*channel = (*channel + n) % channels;
+		dest += n * comp_sample_bytes(dev);
+		samples -= n;
+	}
+}
+
+/*
+ * Mix one period of sources with their own format and gain, split at the
+ * buffer wraps as mixer_mix() does.
+ */
+static void mixer_mix_inputs(struct comp_dev *dev, struct comp_buffer *sink,
+			     struct comp_buffer **sources,
+			     struct mixer_input *in, uint32_t num_sources)
+{
+	uint32_t sample_bytes = comp_sample_bytes(dev);
+	uint32_t samples = dev->frames * dev->params.channels;
+	void *dest = sink->w_ptr;
+	uint32_t channel = 0;
+	uint32_t n;
+	uint32_t i;
+
+	for (i = 0; i < num_sources; i++)
+		in[i].ptr = sources[i]->r_ptr;
+
+	while (samples) {
+		/* samples until the first buffer wrap */
+		n = buffer_wrap_samples(sink, dest, sample_bytes, samples);
+		for (i = 0; i < num_sources; i++)
+			n = buffer_wrap_samples(sources[i], in[i].ptr,
+					mixer_sample_bytes(in[i].format), n);
+
+		mixer_mix_weighted(dev, dest, in, num_sources, n, &channel);
+
+		dest = buffer_wrap(sink, dest + n * sample_bytes);
+		for (i = 0; i < num_sources; i++)
+			in[i].ptr = buffer_wrap(sources[i], in[i].ptr);
+
+		samples -= n;
 	}
 }
 
@@ -85,6 +203,7 @@ static struct comp_dev *mixer_new(struct sof_ipc_comp *comp)
 	struct sof_ipc_comp_mixer *ipc_mixer =
 		(struct sof_ipc_comp_mixer *)comp;
 	struct mixer_data *md;
+	int i;
 
 	trace_mixer("mixer_new()");
 
@@ -93,6 +212,11 @@ static struct comp_dev *mixer_new(struct sof_ipc_comp *comp)
 		return NULL;
 	}
 
+	if (ipc_mixer->underrun > SOF_MIXER_UNDERRUN_SILENCE) {
+		trace_mixer_error("mixer_new() error: invalid underrun mode");
+		return NULL;
+	}
+
 	dev = rzalloc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM,
 		COMP_SIZE(struct sof_ipc_comp_mixer));
 	if (dev == NULL)
@@ -107,6 +231,12 @@ static struct comp_dev *mixer_new(struct sof_ipc_comp *comp)
 		return NULL;
 	}
 
+	md->underrun = ipc_mixer->underrun;
+
+	/* no input gains set */
+	for (i = 0; i < PLATFORM_MAX_STREAMS; i++)
+		md->gains[i].volume = MIXER_VOLUME_ZERO_DB;
+
 	comp_set_drvdata(dev, md);
 	dev->state = COMP_STATE_READY;
 	return dev;
@@ -127,11 +257,21 @@ static int mixer_params(struct comp_dev *dev)
 {
 	struct mixer_data *md = comp_get_drvdata(dev);
 	struct sof_ipc_comp_config *config = COMP_GET_CONFIG(dev);
+	struct sof_ipc_comp_config *dai_config;
 	struct comp_buffer *sink;
 	int ret;
 
 	trace_mixer("mixer_params()");
 
+	sink = list_first_item(&dev->bsink_list, struct comp_buffer, source_list);
+
+	/* sources are converted to the DAI format while they are mixed */
+	if (sink->sink->comp.type == SOF_COMP_DAI ||
+	    sink->sink->comp.type == SOF_COMP_SG_DAI) {
+		dai_config = COMP_GET_CONFIG(sink->sink);
+		dev->params.frame_fmt = dai_config->frame_fmt;
+	}
+
 	/* calculate frame size based on config */
 	dev->frame_bytes = comp_frame_bytes(dev);
 	if (dev->frame_bytes == 0) {
@@ -146,8 +286,6 @@ static int mixer_params(struct comp_dev *dev)
 		return -EINVAL;
 	}
 
-	sink = list_first_item(&dev->bsink_list, struct comp_buffer, source_list);
-
 	/* set downstream buffer size */
 	ret = buffer_set_size(sink, md->period_bytes * config->periods_sink);
 	if (ret < 0) {
@@ -184,17 +322,120 @@ static inline int mixer_sink_status(struct comp_dev *mixer)
 	return sink->sink->state;
 }
 
+/* slot of source buffer, an idle slot is claimed for it if asked */
+static struct mixer_source *mixer_source_get(struct mixer_data *md,
+					     struct comp_buffer *buffer,
+					     int claim)
+{
+	struct mixer_source *idle = NULL;
+	struct mixer_source *ms;
+	int i;
+
+	for (i = 0; i < PLATFORM_MAX_STREAMS; i++) {
+		ms = &md->sources[i];
+		if (ms->buffer == buffer)
+			return ms;
+		if (!idle && !ms->attached && !ms->mixing)
+			idle = ms;
+	}
+
+	if (!claim || !idle)
+		return NULL;
+
+	idle->buffer = buffer;
+	md->num_sources = MAX(md->num_sources, idle - md->sources + 1);
+
+	return idle;
+}
+
+/* input gain set for the source pipeline */
+static uint32_t mixer_gain_get(struct mixer_data *md, uint32_t pipeline_id)
+{
+	int i;
+
+	for (i = 0; i < PLATFORM_MAX_STREAMS; i++) {
+		if (md->gains[i].volume != MIXER_VOLUME_ZERO_DB &&
+		    md->gains[i].pipeline_id == pipeline_id)
+			return md->gains[i].volume;
+	}
+
+	return MIXER_VOLUME_ZERO_DB;
+}
+
+/*
+ * Attach the active sources and detach the others. While the mix runs the
+ * copy ramps sources in and out, otherwise they are switched at once.
+ */
+static void mixer_source_sync(struct comp_dev *dev, int running)
+{
+	struct mixer_data *md = comp_get_drvdata(dev);
+	struct mixer_source *ms;
+	struct comp_buffer *source;
+	struct list_item *blist;
+	uint32_t format;
+	int active;
+
+	list_for_item(blist, &dev->bsource_list) {
+		source = container_of(blist, struct comp_buffer, sink_list);
+		active = source->source->state == COMP_STATE_ACTIVE;
+		format = source->source->params.frame_fmt;
+
+		if (active && format != SOF_IPC_FRAME_S16_LE &&
+		    format != SOF_IPC_FRAME_S24_4LE &&
+		    format != SOF_IPC_FRAME_S32_LE) {
+			trace_mixer_error("mixer_source_sync() error: "
+					  "unsupported source format");
+			active = 0;
+		}
+
+		ms = mixer_source_get(md, source, active);
+		if (!ms) {
+			if (active)
+				trace_mixer_error("mixer_source_sync() error: "
+						  "no free source slot");
+			continue;
+		}
+
+		/* copy only reads the format of mixed sources */
+		if (active && (!running || !ms->mixing)) {
+			ms->format = format;
+			ms->sample_bytes = mixer_sample_bytes(format);
+			ms->tvolume = mixer_gain_get(md,
+				source->source->comp.pipeline_id);
+			ms->volume = ms->tvolume;
+		}
+
+		if (!running) {
+			ms->mixing = active;
+			ms->gain = active ? MIXER_GAIN_ONE : 0;
+			ms->deficit = 0;
+		}
+
+		ms->attached = active;
+	}
+}
+
 /* used to pass standard and bespoke commands (with data) to component */
 static int mixer_trigger(struct comp_dev *dev, int cmd)
 {
+	int running = dev->state == COMP_STATE_ACTIVE;
 	int ret;
 
 	trace_mixer("mixer_trigger()");
 
+	/* a new source joins the running mix, downstream is left as is */
+	if (running &&
+	    (cmd == COMP_TRIGGER_START || cmd == COMP_TRIGGER_RELEASE)) {
+		mixer_source_sync(dev, running);
+		return 1;
+	}
+
 	ret = comp_set_state(dev, cmd);
 	if (ret < 0)
 		return ret;
 
+	mixer_source_sync(dev, running);
+
 	switch(cmd) {
 	case COMP_TRIGGER_START:
 	case COMP_TRIGGER_RELEASE:
@@ -215,69 +456,346 @@ static int mixer_trigger(struct comp_dev *dev, int cmd)
 	return 0; /* send cmd downstream */
 }
 
+/* set the input gain of a source pipeline, a mixed source ramps to it */
+static int mixer_gain_set(struct comp_dev *dev, uint32_t pipeline_id,
+			  uint32_t volume)
+{
+	struct mixer_data *md = comp_get_drvdata(dev);
+	struct mixer_gain *entry = NULL;
+	struct mixer_source *ms;
+	int i;
+
+	volume = MIN(volume, MIXER_VOLUME_ZERO_DB);
+
+	for (i = 0; i < PLATFORM_MAX_STREAMS; i++) {
+		if (md->gains[i].volume == MIXER_VOLUME_ZERO_DB) {
+			if (!entry)
+				entry = &md->gains[i];
+		} else if (md->gains[i].pipeline_id == pipeline_id) {
+			entry = &md->gains[i];
+			break;
+		}
+	}
+
+	if (!entry) {
+		trace_mixer_error("mixer_gain_set() error: no free gain");
+		return -ENOMEM;
+	}
+
+	entry->pipeline_id = pipeline_id;
+	entry->volume = volume;
+
+	for (i = 0; i < md->num_sources; i++) {
+		ms = &md->sources[i];
+		if ((ms->attached || ms->mixing) &&
+		    ms->buffer->source->comp.pipeline_id == pipeline_id)
+			ms->tvolume = volume;
+	}
+
+	return 0;
+}
+
 /*
- * Mix N source PCM streams to one sink PCM stream. Frames copied is constant.
+ * SOF_CTRL_CMD_VOLUME sets the input gains, chanv[].channel is the source
+ * pipeline ID and chanv[].value its gain in Q1.16 up to 0dB.
  */
-static int mixer_copy(struct comp_dev *dev)
+static int mixer_ctrl_set_cmd(struct comp_dev *dev,
+			      struct sof_ipc_ctrl_data *cdata)
+{
+	int ret;
+	int j;
+
+	if (cdata->cmd != SOF_CTRL_CMD_VOLUME) {
+		trace_mixer_error("mixer_ctrl_set_cmd() error: "
+				  "invalid cdata->cmd");
+		return -EINVAL;
+	}
+
+	if (cdata->num_elems == 0 || cdata->num_elems > PLATFORM_MAX_STREAMS) {
+		trace_mixer_error("mixer_ctrl_set_cmd() error: "
+				  "invalid cdata->num_elems");
+		return -EINVAL;
+	}
+
+	for (j = 0; j < cdata->num_elems; j++) {
+		ret = mixer_gain_set(dev, cdata->chanv[j].channel,
+				     cdata->chanv[j].value);
+		if (ret < 0)
+			return ret;
+	}
+
+	return 0;
+}
+
+/* gains of the first num_elems source pipelines with one set */
+static int mixer_ctrl_get_cmd(struct comp_dev *dev,
+			      struct sof_ipc_ctrl_data *cdata, int size)
 {
 	struct mixer_data *md = comp_get_drvdata(dev);
-	struct comp_buffer *sink;
-	struct comp_buffer *sources[PLATFORM_MAX_STREAMS];
-	struct comp_buffer *source;
-	struct list_item *blist;
-	int32_t i = 0;
-	int32_t num_mix_sources = 0;
-	int res;
+	int i;
+	int j = 0;
 
-	tracev_mixer("mixer_copy()");
+	if (cdata->cmd != SOF_CTRL_CMD_VOLUME) {
+		trace_mixer_error("mixer_ctrl_get_cmd() error: "
+				  "invalid cdata->cmd");
+		return -EINVAL;
+	}
 
-	sink = list_first_item(&dev->bsink_list, struct comp_buffer, source_list);
+	if (cdata->num_elems == 0 || cdata->num_elems > PLATFORM_MAX_STREAMS ||
+	    sizeof(*cdata) + cdata->num_elems * sizeof(cdata->chanv[0]) >
+	    size) {
+		trace_mixer_error("mixer_ctrl_get_cmd() error: "
+				  "invalid cdata->num_elems");
+		return -EINVAL;
+	}
 
-	/* calculate the highest runtime component status between input streams */
-	list_for_item(blist, &dev->bsource_list) {
-		source = container_of(blist, struct comp_buffer, sink_list);
+	for (i = 0; i < PLATFORM_MAX_STREAMS && j < cdata->num_elems; i++) {
+		if (md->gains[i].volume == MIXER_VOLUME_ZERO_DB)
+			continue;
+
+		cdata->chanv[j].channel = md->gains[i].pipeline_id;
+		cdata->chanv[j].value = md->gains[i].volume;
+		j++;
+	}
+
+	cdata->num_elems = j;
 
-		/* only mix the sources with the same state with mixer */
-		if (source->source->state == dev->state)
-			sources[num_mix_sources++] = source;
+	return 0;
+}
 
-		/* too many sources ? */
-		if (num_mix_sources == PLATFORM_MAX_STREAMS - 1)
-			return 0;
+/* used to pass standard and bespoke commands (with data) to component */
+static int mixer_cmd(struct comp_dev *dev, int cmd, void *data,
+		     int max_data_size)
+{
+	struct sof_ipc_ctrl_data *cdata = data;
+
+	trace_mixer("mixer_cmd()");
+
+	switch (cmd) {
+	case COMP_CMD_SET_VALUE:
+		return mixer_ctrl_set_cmd(dev, cdata);
+	case COMP_CMD_GET_VALUE:
+		return mixer_ctrl_get_cmd(dev, cdata, max_data_size);
+	default:
+		return -EINVAL;
 	}
+}
 
-	/* don't have any work if all sources are inactive */
-	if (num_mix_sources == 0)
-		return 0;
+/*
+ * Leave the late sources out of the mix, so they are heard as silence and
+ * the other streams don't glitch with them. A late source consumes nothing
+ * and its deficit grows by the period. Data it has beyond a period later is
+ * skipped until the deficit is paid back, so each source consumes what
+ * keeps it in step with the rest of the mix. Returns the number of sources
+ * left in mixed.
+ */
+static int mixer_drop_late(struct comp_dev *dev, struct comp_buffer *sink,
+			   struct mixer_source **mixed, uint32_t num_sources)
+{
+	struct mixer_data *md = comp_get_drvdata(dev);
+	uint32_t samples = dev->frames * dev->params.channels;
+	struct mixer_source *ms;
+	uint32_t num_ready = 0;
+	uint32_t period_bytes;
+	uint32_t frame_bytes;
+	uint32_t avail;
+	uint32_t skip;
+	uint32_t i;
+
+	if (comp_buffer_get_free_bytes(sink) < md->period_bytes) {
+		trace_mixer_error("mixer_copy() error: "
+				  "sink component buffer has not "
+				  "enough free bytes for copy");
+		comp_overrun(dev, sink, md->period_bytes, md->period_bytes);
+		return -EIO;
+	}
 
-	/* make sure no sources have underruns */
-	for (i = 0; i < num_mix_sources; i++) {
+	for (i = 0; i < num_sources; i++) {
+		ms = mixed[i];
+		period_bytes = samples * ms->sample_bytes;
+		frame_bytes = dev->params.channels * ms->sample_bytes;
+		avail = comp_buffer_get_avail_bytes(ms->buffer);
+
+		if (avail < period_bytes) {
+			tracev_mixer("mixer_copy(), late source mixed as "
+				     "silence");
+			ms->deficit = MIN(ms->deficit + period_bytes,
+					  ms->buffer->size);
+			continue;
+		}
+
+		if (ms->deficit) {
+			skip = MIN(ms->deficit, avail - period_bytes);
+			skip -= skip % frame_bytes;
+			comp_update_buffer_consume(ms->buffer, skip);
+			ms->deficit -= skip;
+		}
+
+		mixed[num_ready++] = ms;
+	}
+
+	return num_ready;
+}
+
+/* report the sources and sink that can't copy a period, they are mixed
+ * anyway and recovered by the pipeline xrun handling */
+static void mixer_check_xrun(struct comp_dev *dev, struct comp_buffer *sink,
+			     struct mixer_source **mixed, uint32_t num_sources)
+{
+	struct mixer_data *md = comp_get_drvdata(dev);
+	uint32_t samples = dev->frames * dev->params.channels;
+	struct comp_buffer *source;
+	uint32_t period_bytes;
+	uint32_t i;
+
+	for (i = 0; i < num_sources; i++) {
+		source = mixed[i]->buffer;
+		period_bytes = samples * mixed[i]->sample_bytes;
 
 		/* make sure source component buffer has enough data available
 		 * and that the sink component buffer has enough free bytes
 		 * for copy. Also check for XRUNs */
-		res = comp_buffer_can_copy_bytes(sources[i], sink, md->period_bytes);
-		if (res < 0) {
+		if (comp_buffer_get_avail_bytes(source) < period_bytes) {
 			trace_mixer_error("mixer_copy() error: "
 					  "source component buffer "
 					  "has not enough data available");
-			comp_underrun(dev, sources[i], sources[i]->avail,
-				md->period_bytes);
-		} else if (res > 0) {
+			comp_underrun(dev, source,
+				      comp_buffer_get_avail_bytes(source),
+				period_bytes);
+		} else if (comp_buffer_get_free_bytes(sink) <
+			   md->period_bytes) {
 			trace_mixer_error("mixer_copy() error: "
 					  "sink component buffer has not "
 					  "enough free bytes for copy");
-			comp_overrun(dev, sources[i], sink->free,
+			comp_overrun(dev, source,
+				     comp_buffer_get_free_bytes(sink),
 				md->period_bytes);
 		}
 	}
+}
+
+/* input gain at the end of the period, ramping linearly to the target */
+static uint32_t mixer_volume_ramp(struct comp_dev *dev, uint32_t volume,
+				  uint32_t target)
+{
+	uint32_t delta = MIXER_VOLUME_ZERO_DB;
+
+	if (dev->params.rate)
+		delta = MAX((uint64_t)MIXER_VOLUME_ZERO_DB * 1000 *
+			    dev->frames /
+			    (MIXER_RAMP_LENGTH_MS * dev->params.rate), 1);
+
+	if (volume < target)
+		return target - volume > delta ? volume + delta : target;
+
+	return volume - target > delta ? volume - delta : target;
+}
+
+/*
+ * Mix N source PCM streams to one sink PCM stream. Frames copied is constant.
+ *
+ * Sources attached while the mix runs join with their first whole period, so
+ * they don't underrun as they start, and are ramped in over it. A detached
+ * source is ramped out over the period it has left, it has no other effect
+ * on the running streams.
+ *
+ * Sources at 0dB in the sink format are summed by the processing function,
+ * otherwise each source is converted and scaled by its input gain while it
+ * is summed, so no volume component is needed before the mixer.
+ */
+static int mixer_copy(struct comp_dev *dev)
+{
+	struct mixer_data *md = comp_get_drvdata(dev);
+	struct comp_buffer *sink;
+	struct comp_buffer *sources[PLATFORM_MAX_STREAMS];
+	struct mixer_source *mixed[PLATFORM_MAX_STREAMS];
+	struct mixer_input in[PLATFORM_MAX_STREAMS];
+	struct mixer_source *ms;
+	uint32_t samples = dev->frames * dev->params.channels;
+	uint32_t attached;
+	uint32_t avail;
+	uint32_t volume;
+	int32_t target;
+	int32_t end;
+	int32_t i;
+	int32_t num_mix_sources = 0;
+	int weighted = 0;
+
+	tracev_mixer("mixer_copy()");
+
+	sink = list_first_item(&dev->bsink_list, struct comp_buffer, source_list);
+
+	for (i = 0; i < md->num_sources; i++) {
+		ms = &md->sources[i];
+		attached = ms->attached;
+		if (!attached && !ms->mixing)
+			continue;
+
+		avail = comp_buffer_get_avail_bytes(ms->buffer);
+
+		if (!ms->mixing) {
+			/* wait for a whole period to join */
+			if (avail < samples * ms->sample_bytes)
+				continue;
+			ms->mixing = 1;
+			ms->gain = 0;
+			ms->deficit = 0;
+		} else if (!attached && avail < samples * ms->sample_bytes) {
+			/* too little left to ramp out */
+			ms->mixing = 0;
+			continue;
+		}
+
+		mixed[num_mix_sources++] = ms;
+	}
+
+	/* don't have any work if all sources are inactive */
+	if (num_mix_sources == 0)
+		return 0;
+
+	if (md->underrun == SOF_MIXER_UNDERRUN_SILENCE) {
+		num_mix_sources = mixer_drop_late(dev, sink, mixed,
+						  num_mix_sources);
+		if (num_mix_sources < 0)
+			return num_mix_sources;
+	} else {
+		mixer_check_xrun(dev, sink, mixed, num_mix_sources);
+	}
 
-	/* mix streams */
-	md->mix_func(dev, sink, sources, i, dev->frames);
+	for (i = 0; i < num_mix_sources; i++) {
+		ms = mixed[i];
+		sources[i] = ms->buffer;
+		target = ms->attached ? MIXER_GAIN_ONE : 0;
+		volume = mixer_volume_ramp(dev, ms->volume, ms->tvolume);
+
+		/* attach ramp and input gain combined in Q1.30 */
+		in[i].format = ms->format;
+		in[i].gain = ((int64_t)ms->volume * ms->gain) >> 1;
+		end = ((int64_t)volume * target) >> 1;
+		in[i].step = (end - in[i].gain) / (int32_t)dev->frames;
+
+		if (ms->format != dev->params.frame_fmt ||
+		    in[i].gain != 1 << MIXER_WEIGHT_Q ||
+		    end != 1 << MIXER_WEIGHT_Q)
+			weighted = 1;
+
+		ms->volume = volume;
+		ms->gain = target;
+	}
+
+	/* mix streams, all late gives a period of silence */
+	if (weighted)
+		mixer_mix_inputs(dev, sink, sources, in, num_mix_sources);
+	else
+		mixer_mix(dev, sink, sources, num_mix_sources);
 
 	/* update source buffer pointers for overflow */
-	for (i = --num_mix_sources; i >= 0; i--)
-		comp_update_buffer_consume(sources[i], md->period_bytes);
+	for (i = 0; i < num_mix_sources; i++) {
+		comp_update_buffer_consume(sources[i],
+					   samples * mixed[i]->sample_bytes);
+		if (!mixed[i]->gain)
+			mixed[i]->mixing = 0;
+	}
 
 	/* calc new free and available */
 	comp_update_buffer_produce(sink, md->period_bytes);
@@ -288,8 +806,10 @@ static int mixer_copy(struct comp_dev *dev)
 
 static int mixer_reset(struct comp_dev *dev)
 {
+	struct mixer_data *md = comp_get_drvdata(dev);
 	struct list_item * blist;
 	struct comp_buffer *source;
+	int i;
 
 	trace_mixer("mixer_reset()");
 
@@ -300,6 +820,14 @@ static int mixer_reset(struct comp_dev *dev)
 			return 1; /* should not reset the downstream components */
 	}
 
+	/* forget the sources, their buffers may be freed after reset */
+	for (i = 0; i < PLATFORM_MAX_STREAMS; i++) {
+		md->sources[i].attached = 0;
+		md->sources[i].mixing = 0;
+		md->sources[i].buffer = NULL;
+	}
+	md->num_sources = 0;
+
 	comp_set_state(dev, COMP_TRIGGER_RESET);
 	return 0;
 }
@@ -326,11 +854,19 @@ static int mixer_prepare(struct comp_dev *dev)
 	if (dev->state != COMP_STATE_ACTIVE) {
 
 		/* currently inactive so setup mixer */
-		md->mix_func = mix_n;
+		md->mix = mixer_get_processing_function(dev);
+		if (!md->mix) {
+			trace_mixer_error("mixer_prepare() error: "
+					  "unsupported frame format");
+			return -EINVAL;
+		}
 
 		ret = comp_set_state(dev, COMP_TRIGGER_PREPARE);
 		if (ret < 0)
 			return ret;
+
+		/* sources prepared again start without a deficit */
+		mixer_source_sync(dev, 0);
 	}
 
 	/* check each mixer source state */
@@ -381,6 +917,7 @@ struct comp_driver comp_mixer = {
 		.params		= mixer_params,
 		.prepare	= mixer_prepare,
 		.trigger	= mixer_trigger,
+		.cmd		= mixer_cmd,
 		.copy		= mixer_copy,
 		.reset		= mixer_reset,
 		.cache		= mixer_cache,
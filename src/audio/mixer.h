@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2018, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Liam Girdwood <liam.r.girdwood@linux.intel.com>
+ *         Keyon Jie <yang.jie@linux.intel.com>
+ */
+
+/**
+ * \file audio/mixer.h
+ * \brief Mixer component header file
+ * \authors Liam Girdwood <liam.r.girdwood@linux.intel.com>\n
+ *          Keyon Jie <yang.jie@linux.intel.com>
+ */
+
+#ifndef MIXER_H
+#define MIXER_H
+
+#include <stdint.h>
+#include <sof/audio/component.h>
+#include <sof/audio/format.h>
+
+#define CONFIG_GENERIC
+
+#if defined(__XCC__)
+#include <xtensa/config/core-isa.h>
+
+#if XCHAL_HAVE_HIFI3
+#undef CONFIG_GENERIC
+#endif
+
+#endif
+
+/** \brief Mixer trace function. */
+#define trace_mixer(__e)	trace_event(TRACE_CLASS_MIXER, __e)
+
+/** \brief Mixer trace value function. */
+#define tracev_mixer(__e)	tracev_event(TRACE_CLASS_MIXER, __e)
+
+/** \brief Mixer trace error function. */
+#define trace_mixer_error(__e)	trace_error(TRACE_CLASS_MIXER, __e)
+
+/**
+ * \brief Mixer processing function.
+ *
+ * Mixes samples from contiguous (non wrapping) source and sink regions.
+ */
+typedef void (*mix_func)(void *dest, void **src, uint32_t num_sources,
+			 uint32_t samples);
+
+/** \brief Gain of a source mixed at full level, Q1.15. */
+#define MIXER_GAIN_ONE		(1 << 15)
+
+/** \brief Input gain at 0dB, Q1.16 as the volume component. */
+#define MIXER_VOLUME_ZERO_DB	(1 << 16)
+
+/** \brief Input gain linear ramp length from mute to 0dB in milliseconds. */
+#define MIXER_RAMP_LENGTH_MS	250
+
+/** \brief Fractional bits of the weighted mix gain, Q1.30. */
+#define MIXER_WEIGHT_Q		30
+
+/** \brief Samples summed at a time by the weighted mix. */
+#define MIXER_ACC_SAMPLES	64
+
+/**
+ * \brief Mixer source slot.
+ *
+ * Slots are attached and detached by trigger while copy runs, buffer,
+ * attached and the source format are only written by trigger, tvolume by
+ * the control command and the other fields by copy, so no side takes a
+ * lock.
+ */
+struct mixer_source {
+	struct comp_buffer *volatile buffer;	/**< source, NULL if unused */
+	volatile uint32_t attached;	/**< source is to be mixed */
+	volatile uint32_t tvolume;	/**< target input gain, Q1.16 */
+	uint32_t format;		/**< source frame format */
+	uint32_t sample_bytes;		/**< source sample size */
+	uint32_t mixing;		/**< source is in the mix */
+	int32_t gain;			/**< gain reached by the ramp, Q1.15 */
+	uint32_t volume;		/**< input gain reached, Q1.16 */
+	uint32_t deficit;		/**< bytes mixed as silence, not skipped */
+};
+
+/** \brief Input gain of a source pipeline, entries at 0dB are free. */
+struct mixer_gain {
+	uint32_t pipeline_id;		/**< source pipeline */
+	uint32_t volume;		/**< input gain, Q1.16 */
+};
+
+/** \brief Source of the weighted mix, the gain moves by step each frame. */
+struct mixer_input {
+	void *ptr;			/**< next sample */
+	uint32_t format;		/**< source frame format */
+	int32_t gain;			/**< gain, Q1.30 */
+	int32_t step;			/**< gain change per frame, Q1.30 */
+};
+
+/** \brief Mixer component private data. */
+struct mixer_data {
+	uint32_t period_bytes;		/**< number of period bytes */
+	mix_func mix;			/**< mixer processing function */
+	uint32_t underrun;		/**< SOF_MIXER_UNDERRUN_ */
+	uint32_t num_sources;		/**< slots used are below this */
+	struct mixer_source sources[PLATFORM_MAX_STREAMS];
+	struct mixer_gain gains[PLATFORM_MAX_STREAMS];
+};
+
+/** \brief Mixer processing functions map. */
+struct mixer_func_map {
+	uint16_t frame_fmt;		/**< source and sink frame format */
+	mix_func func;			/**< mixer processing function */
+};
+
+/** \brief Map of formats with dedicated processing functions. */
+extern const struct mixer_func_map mixer_func_map[];
+
+/**
+ * \brief Retrieves mixer processing function.
+ * \param[in] dev Mixer base component device.
+ * \return Processing function for the stream format or NULL.
+ */
+mix_func mixer_get_processing_function(struct comp_dev *dev);
+
+#endif /* MIXER_H */
@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2018, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Liam Girdwood <liam.r.girdwood@linux.intel.com>
+ *         Keyon Jie <yang.jie@linux.intel.com>
+ */
+
+/**
+ * \file audio/mixer_generic.c
+ * \brief Mixer generic processing implementation
+ * \authors Liam Girdwood <liam.r.girdwood@linux.intel.com>\n
+ *          Keyon Jie <yang.jie@linux.intel.com>
+ */
+
+#include "mixer.h"
+
+#ifdef CONFIG_GENERIC
+
+/**
+ * \brief Mixes N 16 bit source streams to one 16 bit sink stream.
+ * \param[out] dest Sink samples.
+ * \param[in] src Source samples, one pointer per source.
+ * \param[in] num_sources Number of sources.
+ * \param[in] samples Number of samples per source.
+ */
+static void __hot_text mix_n_s16(void *dest, void **src, uint32_t num_sources,
+				 uint32_t samples)
+{
+	int16_t *out = dest;
+	int16_t **in = (int16_t **)src;
+	int32_t val;
+	uint32_t i;
+	uint32_t j;
+
+	for (i = 0; i < samples; i++) {
+		val = 0;
+		for (j = 0; j < num_sources; j++)
+			val += in[j][i];
+
+		out[i] = sat_int16(val);
+	}
+}
+
+/**
+ * \brief Mixes N 24 bit source streams to one 24 bit sink stream.
+ * \param[out] dest Sink samples.
+ * \param[in] src Source samples, one pointer per source.
+ * \param[in] num_sources Number of sources.
+ * \param[in] samples Number of samples per source.
+ */
+static void __hot_text mix_n_s24(void *dest, void **src, uint32_t num_sources,
+				 uint32_t samples)
+{
+	int32_t *out = dest;
+	int32_t **in = (int32_t **)src;
+	int32_t val;
+	uint32_t i;
+	uint32_t j;
+
+	for (i = 0; i < samples; i++) {
+		val = 0;
+		for (j = 0; j < num_sources; j++)
+			val += sign_extend_s24(in[j][i]);
+
+		out[i] = sat_int24(val);
+	}
+}
+
+/**
+ * \brief Mixes N 32 bit source streams to one 32 bit sink stream.
+ * \param[out] dest Sink samples.
+ * \param[in] src Source samples, one pointer per source.
+ * \param[in] num_sources Number of sources.
+ * \param[in] samples Number of samples per source.
+ */
+static void __hot_text mix_n_s32(void *dest, void **src, uint32_t num_sources,
+				 uint32_t samples)
+{
+	int32_t *out = dest;
+	int32_t **in = (int32_t **)src;
+	int64_t val;
+	uint32_t i;
+	uint32_t j;
+
+	for (i = 0; i < samples; i++) {
+		val = 0;
+		for (j = 0; j < num_sources; j++)
+			val += in[j][i];
+
+		out[i] = sat_int32(val);
+	}
+}
+
+const struct mixer_func_map mixer_func_map[] = {
+	{SOF_IPC_FRAME_S16_LE, mix_n_s16},
+	{SOF_IPC_FRAME_S24_4LE, mix_n_s24},
+	{SOF_IPC_FRAME_S32_LE, mix_n_s32},
+};
+
+mix_func mixer_get_processing_function(struct comp_dev *dev)
+{
+	int i;
+
+	/* map the mixer function for the stream format */
+	for (i = 0; i < ARRAY_SIZE(mixer_func_map); i++) {
+		if (dev->params.frame_fmt == mixer_func_map[i].frame_fmt)
+			return mixer_func_map[i].func;
+	}
+
+	return NULL;
+}
+
+#endif
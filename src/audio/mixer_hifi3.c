@@ -0,0 +1,257 @@
+/*
+ * Copyright (c) 2018, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Liam Girdwood <liam.r.girdwood@linux.intel.com>
+ *         Keyon Jie <yang.jie@linux.intel.com>
+ */
+
+/**
+ * \file audio/mixer_hifi3.c
+ * \brief Mixer HiFi3 processing implementation
+ * \authors Liam Girdwood <liam.r.girdwood@linux.intel.com>\n
+ *          Keyon Jie <yang.jie@linux.intel.com>
+ */
+
+#include "mixer.h"
+#include <platform/platform.h>
+
+#if defined(__XCC__) && XCHAL_HAVE_HIFI3
+
+#include <xtensa/tie/xt_hifi3.h>
+
+/*
+ * The kernels below are inlined into wrappers with a constant number of
+ * sources so the compiler can fully unroll the source loop for the most
+ * common 2, 3 and 4 way mixes. Samples are processed in 64 bit vectors
+ * with unaligned loads/stores, any remaining samples are mixed in C.
+ */
+
+/**
+ * \brief HiFi3 enabled mixing of 16 bit samples.
+ * \param[out] dest Sink samples.
+ * \param[in] src Source samples, one pointer per source.
+ * \param[in] num_sources Number of sources.
+ * \param[in] samples Number of samples per source.
+ */
+static inline void mix_s16(int16_t *dest, int16_t **src,
+			   uint32_t num_sources, uint32_t samples)
+{
+	ae_int16x4 *in[PLATFORM_MAX_STREAMS];
+	ae_valign in_align[PLATFORM_MAX_STREAMS];
+	ae_int16x4 *out = (ae_int16x4 *)dest;
+	ae_valign out_align = AE_ZALIGN64();
+	ae_int16x4 sample = AE_ZERO16();
+	ae_int32x2 acc_h;
+	ae_int32x2 acc_l;
+	int32_t val;
+	uint32_t i;
+	uint32_t j;
+
+	for (j = 0; j < num_sources; j++) {
+		in[j] = (ae_int16x4 *)src[j];
+		in_align[j] = AE_LA64_PP(in[j]);
+	}
+
+	for (i = 0; i < samples >> 2; i++) {
+		acc_h = AE_ZERO32();
+		acc_l = AE_ZERO32();
+
+		/* accumulate in 32 bits so only the result is saturated */
+		for (j = 0; j < num_sources; j++) {
+			AE_LA16X4_IP(sample, in_align[j], in[j]);
+			acc_h = AE_ADD32(acc_h, AE_SEXT32X2D16_32(sample));
+			acc_l = AE_ADD32(acc_l, AE_SEXT32X2D16_10(sample));
+		}
+
+		AE_SA16X4_IP(AE_SAT16X4(acc_h, acc_l), out_align, out);
+	}
+
+	AE_SA64POS_FP(out_align, out);
+
+	for (i = samples & ~0x3; i < samples; i++) {
+		val = 0;
+		for (j = 0; j < num_sources; j++)
+			val += src[j][i];
+
+		dest[i] = sat_int16(val);
+	}
+}
+
+/**
+ * \brief HiFi3 enabled mixing of 24 bit samples.
+ * \param[out] dest Sink samples.
+ * \param[in] src Source samples, one pointer per source.
+ * \param[in] num_sources Number of sources.
+ * \param[in] samples Number of samples per source.
+ */
+static inline void mix_s24(int32_t *dest, int32_t **src,
+			   uint32_t num_sources, uint32_t samples)
+{
+	ae_int32x2 *in[PLATFORM_MAX_STREAMS];
+	ae_valign in_align[PLATFORM_MAX_STREAMS];
+	ae_int32x2 *out = (ae_int32x2 *)dest;
+	ae_valign out_align = AE_ZALIGN64();
+	ae_int32x2 sample = AE_ZERO32();
+	ae_int32x2 acc;
+	int32_t val;
+	uint32_t i;
+	uint32_t j;
+
+	for (j = 0; j < num_sources; j++) {
+		in[j] = (ae_int32x2 *)src[j];
+		in_align[j] = AE_LA64_PP(in[j]);
+	}
+
+	for (i = 0; i < samples >> 1; i++) {
+		acc = AE_ZERO32();
+
+		/* sign extend 24 in 32 bits, sum can't overflow 32 bits */
+		for (j = 0; j < num_sources; j++) {
+			AE_LA32X2_IP(sample, in_align[j], in[j]);
+			acc = AE_ADD32(acc, AE_SRAI32(AE_SLAI32(sample, 8), 8));
+		}
+
+		/* saturate to 24 bits */
+		acc = AE_SRAI32(AE_SLAI32S(acc, 8), 8);
+
+		AE_SA32X2_IP(acc, out_align, out);
+	}
+
+	AE_SA64POS_FP(out_align, out);
+
+	if (samples & 0x1) {
+		i = samples - 1;
+		val = 0;
+		for (j = 0; j < num_sources; j++)
+			val += sign_extend_s24(src[j][i]);
+
+		dest[i] = sat_int24(val);
+	}
+}
+
+/**
+ * \brief HiFi3 enabled mixing of 32 bit samples.
+ * \param[out] dest Sink samples.
+ * \param[in] src Source samples, one pointer per source.
+ * \param[in] num_sources Number of sources.
+ * \param[in] samples Number of samples per source.
+ *
+ * Partial sums are saturated, so the result can differ from the generic
+ * 64 bit accumulation only when the output is clipping anyway.
+ */
+static inline void mix_s32(int32_t *dest, int32_t **src,
+			   uint32_t num_sources, uint32_t samples)
+{
+	ae_int32x2 *in[PLATFORM_MAX_STREAMS];
+	ae_valign in_align[PLATFORM_MAX_STREAMS];
+	ae_int32x2 *out = (ae_int32x2 *)dest;
+	ae_valign out_align = AE_ZALIGN64();
+	ae_int32x2 sample = AE_ZERO32();
+	ae_int32x2 acc;
+	int64_t val;
+	uint32_t i;
+	uint32_t j;
+
+	for (j = 0; j < num_sources; j++) {
+		in[j] = (ae_int32x2 *)src[j];
+		in_align[j] = AE_LA64_PP(in[j]);
+	}
+
+	for (i = 0; i < samples >> 1; i++) {
+		acc = AE_ZERO32();
+
+		for (j = 0; j < num_sources; j++) {
+			AE_LA32X2_IP(sample, in_align[j], in[j]);
+			acc = AE_ADD32S(acc, sample);
+		}
+
+		AE_SA32X2_IP(acc, out_align, out);
+	}
+
+	AE_SA64POS_FP(out_align, out);
+
+	if (samples & 0x1) {
+		i = samples - 1;
+		val = 0;
+		for (j = 0; j < num_sources; j++)
+			val += src[j][i];
+
+		dest[i] = sat_int32(val);
+	}
+}
+
+/**
+ * \brief Generates mixer function for a format with 2, 3 and 4 source variants.
+ * \param[in] fmt Format suffix of the kernel.
+ * \param[in] type Sample type.
+ */
+#define MIX_FUNC(fmt, type) \
+static void __hot_text mix_n_##fmt(void *dest, void **src, \
+				    uint32_t num_sources, uint32_t samples) \
+{ \
+	type **in = (type **)src; \
+	\
+	switch (num_sources) { \
+	case 2: \
+		mix_##fmt(dest, in, 2, samples); \
+		break; \
+	case 3: \
+		mix_##fmt(dest, in, 3, samples); \
+		break; \
+	case 4: \
+		mix_##fmt(dest, in, 4, samples); \
+		break; \
+	default: \
+		mix_##fmt(dest, in, num_sources, samples); \
+		break; \
+	} \
+}
+
+MIX_FUNC(s16, int16_t)
+MIX_FUNC(s24, int32_t)
+MIX_FUNC(s32, int32_t)
+
+const struct mixer_func_map mixer_func_map[] = {
+	{SOF_IPC_FRAME_S16_LE, mix_n_s16},
+	{SOF_IPC_FRAME_S24_4LE, mix_n_s24},
+	{SOF_IPC_FRAME_S32_LE, mix_n_s32},
+};
+
+mix_func mixer_get_processing_function(struct comp_dev *dev)
+{
+	int i;
+
+	/* map the mixer function for the stream format */
+	for (i = 0; i < ARRAY_SIZE(mixer_func_map); i++) {
+		if (dev->params.frame_fmt == mixer_func_map[i].frame_fmt)
+			return mixer_func_map[i].func;
+	}
+
+	return NULL;
+}
+
+#endif
@@ -28,37 +28,530 @@
  * Author: Liam Girdwood <liam.r.girdwood@linux.intel.com>
  */
 
+/**
+ * \file audio/mux.c
+ * \brief Mux/demux component implementation
+ *
+ * A mux routes the channels of several source streams into the channels of
+ * one sink, a demux routes the channels of one source to several sink
+ * streams. Every stream buffer has a channel map from the IPC config that
+ * gives the mux side channel of each stream channel. Mux side channels no
+ * active source maps to are written as silence.
+ *
+ * Streams that are a contiguous slice of the mux side frames use the slice
+ * functions where the shape has one, and streams with the same layout as
+ * the mux side are copied as blocks. A single stream with the same layout
+ * between one source and one sink is bypassed by the pipeline, so nothing
+ * is copied at all.
+ *
+ * A mux in front of a TDM DAI aggregates several pipelines into the slots
+ * of one DMA stream, so all of them share one DMA channel and one period
+ * interrupt. With MUX_FUSE_STREAMS or more active streams they are routed
+ * in one pass over the mux side frames, rather than one pass per stream
+ * plus one more to silence unused slots.
+ */
+
 #include <stdint.h>
 #include <stddef.h>
+#include <errno.h>
+#include <sof/sof.h>
 #include <sof/lock.h>
 #include <sof/list.h>
 #include <sof/stream.h>
+#include <sof/alloc.h>
+#include <sof/ipc.h>
 #include <sof/audio/component.h>
+#include "mux.h"
+
+/* route stream frames to and from the mux side frames sample by sample */
+static void mux_route_frames(struct mux_data *cd,
+			     struct mux_stream_data *stream, char *wide,
+			     char *narrow, uint32_t frames)
+{
+	const struct mux_route *route = &stream->route;
+	uint32_t wide_bytes = route->wide_channels * cd->sample_bytes;
+	uint32_t narrow_bytes = route->channels * cd->sample_bytes;
+	uint32_t frame;
+	uint32_t ch;
+
+	for (frame = 0; frame < frames; frame++) {
+		for (ch = 0; ch < route->channels; ch++) {
+			if (cd->sample_bytes == sizeof(int16_t)) {
+				int16_t *w = (int16_t *)wide + route->map[ch];
+				int16_t *n = (int16_t *)narrow + ch;
+
+				if (cd->demux)
+					*n = *w;
+				else
+					*w = *n;
+			} else {
+				int32_t *w = (int32_t *)wide + route->map[ch];
+				int32_t *n = (int32_t *)narrow + ch;
+
+				if (cd->demux)
+					*n = *w;
+				else
+					*w = *n;
+			}
+		}
+
+		wide += wide_bytes;
+		narrow += narrow_bytes;
+	}
+}
+
+/* route frames of all active streams, silencing unrouted mux side channels */
+static void mux_fused_frames(struct mux_data *cd,
+			     struct mux_stream_data **active,
+			     uint32_t num_active, uint32_t mask, char *wide,
+			     char **narrow, uint32_t frames)
+{
+	const struct mux_route *route;
+	uint32_t wide_bytes = cd->channels * cd->sample_bytes;
+	uint32_t frame;
+	uint32_t ch;
+	uint32_t i;
+
+	for (frame = 0; frame < frames; frame++) {
+		if (cd->sample_bytes == sizeof(int16_t)) {
+			int16_t *w = (int16_t *)wide;
+
+			for (ch = 0; ch < cd->channels; ch++) {
+				if (!(mask & (1 << ch)))
+					w[ch] = 0;
+			}
+
+			for (i = 0; i < num_active; i++) {
+				int16_t *n = (int16_t *)narrow[i];
+
+				route = &active[i]->route;
+				for (ch = 0; ch < route->channels; ch++) {
+					if (cd->demux)
+						n[ch] = w[route->map[ch]];
+					else
+						w[route->map[ch]] = n[ch];
+				}
+
+				narrow[i] += route->channels * sizeof(int16_t);
+			}
+		} else {
+			int32_t *w = (int32_t *)wide;
 
-/* tracing */
-#define trace_mux(__e) trace_event(TRACE_CLASS_MUX, __e)
-#define trace_mux_error(__e)   trace_error(TRACE_CLASS_MUX, __e)
-#define tracev_mux(__e)        tracev_event(TRACE_CLASS_MUX, __e)
+			for (ch = 0; ch < cd->channels; ch++) {
+				if (!(mask & (1 << ch)))
+					w[ch] = 0;
+			}
+
+			for (i = 0; i < num_active; i++) {
+				int32_t *n = (int32_t *)narrow[i];
+
+				route = &active[i]->route;
+				for (ch = 0; ch < route->channels; ch++) {
+					if (cd->demux)
+						n[ch] = w[route->map[ch]];
+					else
+						w[route->map[ch]] = n[ch];
+				}
+
+				narrow[i] += route->channels * sizeof(int32_t);
+			}
+		}
+
+		wide += wide_bytes;
+	}
+}
+
+/*
+ * Route one period of all active streams in a single pass, for each region
+ * that doesn't wrap in any of the buffers. A demux passes a full mask so
+ * its mux side source is never written.
+ */
+static void mux_fused_period(struct comp_dev *dev,
+			     struct mux_stream_data **active,
+			     uint32_t num_active, uint32_t mask,
+			     struct comp_buffer *wide)
+{
+	struct mux_data *cd = comp_get_drvdata(dev);
+	char *narrow[SOF_IPC_MAX_MUX_STREAMS];
+	uint32_t wide_bytes = cd->channels * cd->sample_bytes;
+	uint32_t narrow_bytes;
+	uint32_t frames = dev->frames;
+	void *w = cd->demux ? wide->r_ptr : wide->w_ptr;
+	uint32_t count;
+	uint32_t i;
+
+	for (i = 0; i < num_active; i++)
+		narrow[i] = cd->demux ? active[i]->buffer->w_ptr :
+			active[i]->buffer->r_ptr;
+
+	while (frames) {
+		/* frames until the first wrap of any buffer */
+		count = buffer_wrap_samples(wide, w, wide_bytes, frames);
+		for (i = 0; i < num_active; i++) {
+			narrow_bytes = active[i]->route.channels *
+				cd->sample_bytes;
+			count = buffer_wrap_samples(active[i]->buffer,
+						    narrow[i], narrow_bytes,
+						    count);
+		}
+
+		/* advances the stream pointers */
+		mux_fused_frames(cd, active, num_active, mask, w, narrow,
+				 count);
+
+		w = buffer_wrap(wide, (char *)w + count * wide_bytes);
+		for (i = 0; i < num_active; i++)
+			narrow[i] = buffer_wrap(active[i]->buffer, narrow[i]);
+
+		frames -= count;
+	}
+}
+
+/*
+ * Route one period of a stream. The mux side and stream buffers are
+ * circular and their sizes are multiples of the frame size, so frames are
+ * routed for each region that doesn't wrap in either buffer.
+ */
+static void mux_stream_period(struct comp_dev *dev,
+			      struct mux_stream_data *stream,
+			      struct comp_buffer *wide)
+{
+	struct mux_data *cd = comp_get_drvdata(dev);
+	struct comp_buffer *narrow = stream->buffer;
+	uint32_t wide_bytes = cd->channels * cd->sample_bytes;
+	uint32_t narrow_bytes = stream->route.channels * cd->sample_bytes;
+	uint32_t frames = dev->frames;
+	void *w = cd->demux ? wide->r_ptr : wide->w_ptr;
+	void *n = cd->demux ? narrow->w_ptr : narrow->r_ptr;
+	uint32_t count;
+
+	while (frames) {
+		/* frames until the first buffer wrap */
+		count = buffer_segment_samples(wide, w, wide_bytes,
+					       narrow, n, narrow_bytes, frames);
+
+		if (stream->copy)
+			memcpy(cd->demux ? n : w, cd->demux ? w : n,
+			       count * wide_bytes);
+		else if (stream->func && cd->demux)
+			stream->func->gather(&stream->route, w, n, count);
+		else if (stream->func)
+			stream->func->scatter(&stream->route, w, n, count);
+		else
+			mux_route_frames(cd, stream, w, n, count);
+
+		w = buffer_wrap(wide, (char *)w + count * wide_bytes);
+		n = buffer_wrap(narrow, (char *)n + count * narrow_bytes);
+
+		frames -= count;
+	}
+}
+
+/* write silence to one period of the mux side sink */
+static void mux_zero_period(struct mux_data *cd, struct comp_buffer *sink)
+{
+	uint32_t bytes = cd->period_bytes;
+	void *ptr = sink->w_ptr;
+	uint32_t n;
+
+	while (bytes) {
+		n = MIN(bytes, buffer_bytes_to_wrap(sink, ptr));
+		memset(ptr, 0, n);
+		ptr = buffer_wrap(sink, (char *)ptr + n);
+		bytes -= n;
+	}
+}
+
+/* find the IPC routing of a stream buffer */
+static struct sof_ipc_mux_stream *mux_find_stream(struct comp_dev *dev,
+						   struct comp_buffer *buffer)
+{
+	struct sof_ipc_comp_mux *mux = COMP_GET_IPC(dev, sof_ipc_comp_mux);
+	uint32_t i;
+
+	for (i = 0; i < mux->num_streams; i++) {
+		if (mux->streams[i].buffer_id == buffer->ipc_buffer.comp.id)
+			return &mux->streams[i];
+	}
+
+	return NULL;
+}
+
+/* set up routing of a stream buffer and pick its processing */
+static int mux_stream_init(struct comp_dev *dev,
+			   struct mux_stream_data *stream,
+			   struct comp_buffer *buffer)
+{
+	struct mux_data *cd = comp_get_drvdata(dev);
+	struct sof_ipc_mux_stream *ipc_stream;
+	struct mux_route *route = &stream->route;
+	uint32_t slice = 1;
+	uint32_t i;
+
+	ipc_stream = mux_find_stream(dev, buffer);
+	if (!ipc_stream) {
+		trace_mux_error("mux_stream_init() error: no routing for "
+				"buffer %u", buffer->ipc_buffer.comp.id);
+		return -EINVAL;
+	}
+
+	stream->buffer = buffer;
+	stream->mask = 0;
+	route->wide_channels = cd->channels;
+	route->channels = ipc_stream->channels;
+	route->offset = ipc_stream->map[0];
+
+	for (i = 0; i < route->channels; i++) {
+		route->map[i] = ipc_stream->map[i];
+		if (route->map[i] >= cd->channels) {
+			trace_mux_error("mux_stream_init() error: channel %u "
+					"out of %u", route->map[i],
+					cd->channels);
+			return -EINVAL;
+		}
+
+		stream->mask |= 1 << route->map[i];
+		if (route->map[i] != route->offset + i)
+			slice = 0;
+	}
+
+	stream->copy = slice && !route->offset &&
+		route->channels == route->wide_channels;
+	stream->func = slice ?
+		mux_get_processing_function(cd->sample_bytes, route) : NULL;
+	stream->period_bytes = dev->frames * route->channels *
+		cd->sample_bytes;
+
+	return 0;
+}
 
 static struct comp_dev *mux_new(struct sof_ipc_comp *comp)
 {
+	struct comp_dev *dev;
+	struct sof_ipc_comp_mux *mux;
+	struct sof_ipc_comp_mux *ipc_mux = (struct sof_ipc_comp_mux *)comp;
+	struct mux_data *cd;
+	uint32_t i;
+
 	trace_mux("mux_new()");
 
-	return NULL;
+	if (IPC_IS_SIZE_INVALID(ipc_mux->config)) {
+		IPC_SIZE_ERROR_TRACE(TRACE_CLASS_MUX, ipc_mux->config);
+		return NULL;
+	}
+
+	if (ipc_mux->channels > PLATFORM_MAX_CHANNELS ||
+	    ipc_mux->num_streams > SOF_IPC_MAX_MUX_STREAMS) {
+		trace_mux_error("mux_new() error: invalid channels %u or "
+				"streams %u", ipc_mux->channels,
+				ipc_mux->num_streams);
+		return NULL;
+	}
+
+	for (i = 0; i < ipc_mux->num_streams; i++) {
+		if (!ipc_mux->streams[i].channels ||
+		    ipc_mux->streams[i].channels > PLATFORM_MAX_CHANNELS) {
+			trace_mux_error("mux_new() error: invalid stream %u "
+					"channels %u", i,
+					ipc_mux->streams[i].channels);
+			return NULL;
+		}
+	}
+
+	dev = rzalloc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM,
+		      COMP_SIZE(struct sof_ipc_comp_mux));
+	if (!dev)
+		return NULL;
+
+	mux = (struct sof_ipc_comp_mux *)&dev->comp;
+	memcpy(mux, ipc_mux, sizeof(struct sof_ipc_comp_mux));
+
+	cd = rzalloc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM, sizeof(*cd));
+	if (!cd) {
+		rfree(dev);
+		return NULL;
+	}
+
+	comp_set_drvdata(dev, cd);
+	dev->can_idle = 1;
+	dev->state = COMP_STATE_READY;
+	return dev;
 }
 
 static void mux_free(struct comp_dev *dev)
 {
+	struct mux_data *cd = comp_get_drvdata(dev);
 
+	trace_mux("mux_free()");
+
+	rfree(cd);
+	rfree(dev);
 }
 
-/* set component audio stream parameters */
+/*
+ * Set component audio stream parameters. A component with several source
+ * buffers is a mux and one with a single source a demux. Params carry the
+ * mux side channels when the walk continues on the mux side, the sink
+ * streams of a playback demux get theirs from their own pipelines.
+ */
 static int mux_params(struct comp_dev *dev)
 {
+	struct sof_ipc_stream_params *params = &dev->params;
+	struct sof_ipc_comp_mux *mux = COMP_GET_IPC(dev, sof_ipc_comp_mux);
+	struct sof_ipc_comp_config *config = COMP_GET_CONFIG(dev);
+	struct mux_data *cd = comp_get_drvdata(dev);
+	struct mux_stream_data *stream;
+	struct comp_buffer *buffer;
+	struct list_item *streams;
+	struct list_item *blist;
+	int ret;
+
+	trace_mux("mux_params()");
+
+	switch (params->frame_fmt) {
+	case SOF_IPC_FRAME_S16_LE:
+		cd->sample_bytes = sizeof(int16_t);
+		break;
+	case SOF_IPC_FRAME_S24_4LE:
+	case SOF_IPC_FRAME_S32_LE:
+		cd->sample_bytes = sizeof(int32_t);
+		break;
+	default:
+		trace_mux_error("mux_params() error: unsupported format %u",
+				params->frame_fmt);
+		return -EINVAL;
+	}
+
+	cd->channels = mux->channels ? mux->channels : params->channels;
+	if (!cd->channels || cd->channels > PLATFORM_MAX_CHANNELS) {
+		trace_mux_error("mux_params() error: invalid channels %u",
+				cd->channels);
+		return -EINVAL;
+	}
+
+	cd->demux = list_item_is_last(dev->bsource_list.next,
+				      &dev->bsource_list);
+	if (!cd->demux && !list_item_is_last(dev->bsink_list.next,
+					     &dev->bsink_list)) {
+		trace_mux_error("mux_params() error: several sources and "
+				"sinks");
+		return -EINVAL;
+	}
+
+	/* route every buffer on the stream side */
+	cd->num_streams = 0;
+	streams = cd->demux ? &dev->bsink_list : &dev->bsource_list;
+	list_for_item(blist, streams) {
+		buffer = cd->demux ?
+			container_of(blist, struct comp_buffer, source_list) :
+			container_of(blist, struct comp_buffer, sink_list);
+
+		if (cd->num_streams == SOF_IPC_MAX_MUX_STREAMS) {
+			trace_mux_error("mux_params() error: too many streams");
+			return -EINVAL;
+		}
+
+		stream = &cd->streams[cd->num_streams];
+		ret = mux_stream_init(dev, stream, buffer);
+		if (ret < 0)
+			return ret;
+
+		cd->num_streams++;
+
+		/* set downstream stream buffer size */
+		if (cd->demux) {
+			ret = buffer_set_size(buffer, stream->period_bytes *
+					      config->periods_sink);
+			if (ret < 0) {
+				trace_mux_error("mux_params() error: "
+						"buffer_set_size() failed");
+				return ret;
+			}
+		}
+	}
+
+	cd->period_bytes = dev->frames * cd->channels * cd->sample_bytes;
+	if (cd->period_bytes == 0) {
+		trace_mux_error("mux_params() error: period_bytes = 0");
+		return -EINVAL;
+	}
+
+	dev->frame_bytes = cd->period_bytes / dev->frames;
+
+	/* set downstream mux side buffer size */
+	if (!cd->demux) {
+		buffer = list_first_item(&dev->bsink_list, struct comp_buffer,
+					 source_list);
+		ret = buffer_set_size(buffer, cd->period_bytes *
+				      config->periods_sink);
+		if (ret < 0) {
+			trace_mux_error("mux_params() error: "
+					"buffer_set_size() failed");
+			return ret;
+		}
+	}
+
+	/* rest of the walk is on the mux side */
+	if (cd->demux == (params->direction == SOF_IPC_STREAM_CAPTURE))
+		params->channels = cd->channels;
 
 	return 0;
 }
 
+/* number of mux sources in the given state */
+static int mux_source_status_count(struct comp_dev *dev, uint32_t status)
+{
+	struct comp_buffer *source;
+	struct list_item *blist;
+	int count = 0;
+
+	list_for_item(blist, &dev->bsource_list) {
+		source = container_of(blist, struct comp_buffer, sink_list);
+		if (source->source->state == status)
+			count++;
+	}
+
+	return count;
+}
+
+/*
+ * A mux is shared by its source pipelines like the mixer, so it keeps
+ * running downstream while any source is still active.
+ */
+static int mux_trigger(struct comp_dev *dev, int cmd)
+{
+	struct mux_data *cd = comp_get_drvdata(dev);
+	struct comp_buffer *sink;
+	int ret;
+
+	trace_mux("mux_trigger()");
+
+	ret = comp_set_state(dev, cmd);
+	if (ret < 0 || cd->demux)
+		return ret;
+
+	switch (cmd) {
+	case COMP_TRIGGER_START:
+	case COMP_TRIGGER_RELEASE:
+		sink = list_first_item(&dev->bsink_list, struct comp_buffer,
+				       source_list);
+		if (sink->sink->state == COMP_STATE_ACTIVE)
+			return 1; /* no need to go downstream */
+		break;
+	case COMP_TRIGGER_PAUSE:
+	case COMP_TRIGGER_STOP:
+		if (mux_source_status_count(dev, COMP_STATE_ACTIVE) > 0) {
+			dev->state = COMP_STATE_ACTIVE;
+			return 1; /* no need to go downstream */
+		}
+		break;
+	default:
+		break;
+	}
+
+	return 0; /* send cmd downstream */
+}
+
 /* used to pass standard and bespoke commands (with data) to component */
 static int mux_cmd(struct comp_dev *dev, int cmd, void *data,
 		   int max_data_size)
@@ -67,23 +560,212 @@ static int mux_cmd(struct comp_dev *dev, int cmd, void *data,
 	return 0;
 }
 
+/* route the active source streams into one mux side sink period */
+static int mux_copy_sources(struct comp_dev *dev)
+{
+	struct mux_data *cd = comp_get_drvdata(dev);
+	struct mux_stream_data *active[SOF_IPC_MAX_MUX_STREAMS];
+	struct mux_stream_data *stream;
+	struct comp_buffer *sink;
+	uint32_t num_active = 0;
+	uint32_t mask = 0;
+	uint32_t i;
+
+	sink = list_first_item(&dev->bsink_list, struct comp_buffer,
+			       source_list);
+
+	/* only route the sources with the same state as the mux */
+	for (i = 0; i < cd->num_streams; i++) {
+		stream = &cd->streams[i];
+		if (stream->buffer->source->state != dev->state)
+			continue;
+
+		if (comp_buffer_get_avail_bytes(stream->buffer) <
+		    stream->period_bytes) {
+			trace_mux_error("mux_copy() error: source component "
+					"buffer has not enough data available");
+			comp_underrun(dev, stream->buffer,
+				      stream->period_bytes, 0);
+			return -EIO;	/* xrun */
+		}
+
+		active[num_active++] = stream;
+		mask |= stream->mask;
+	}
+
+	/* don't have any work if all sources are inactive */
+	if (!num_active)
+		return 0;
+
+	if (comp_buffer_get_free_bytes(sink) < cd->period_bytes) {
+		trace_mux_error("mux_copy() error: sink component buffer "
+				"has not enough free bytes for copy");
+		comp_overrun(dev, sink, cd->period_bytes, 0);
+		return -EIO;	/* xrun */
+	}
+
+	if (num_active >= MUX_FUSE_STREAMS) {
+		mux_fused_period(dev, active, num_active, mask, sink);
+	} else {
+		/* silence the mux side channels nothing is routed to */
+		if (mask != (1 << cd->channels) - 1)
+			mux_zero_period(cd, sink);
+
+		for (i = 0; i < num_active; i++)
+			mux_stream_period(dev, active[i], sink);
+	}
+
+	/* calc new free and available */
+	for (i = 0; i < num_active; i++)
+		comp_update_buffer_consume(active[i]->buffer,
+					   active[i]->period_bytes);
+	comp_update_buffer_produce(sink, cd->period_bytes);
+
+	return dev->frames;
+}
+
+/* route one mux side source period to the active sink streams */
+static int mux_copy_sinks(struct comp_dev *dev)
+{
+	struct mux_data *cd = comp_get_drvdata(dev);
+	struct mux_stream_data *active[SOF_IPC_MAX_MUX_STREAMS];
+	struct mux_stream_data *stream;
+	struct comp_buffer *source;
+	uint32_t num_active = 0;
+	uint32_t i;
+
+	source = list_first_item(&dev->bsource_list, struct comp_buffer,
+				 sink_list);
+
+	/* only route the sinks with the same state as the demux */
+	for (i = 0; i < cd->num_streams; i++) {
+		stream = &cd->streams[i];
+		if (stream->buffer->sink->state != dev->state)
+			continue;
+
+		if (comp_buffer_get_free_bytes(stream->buffer) <
+		    stream->period_bytes) {
+			trace_mux_error("mux_copy() error: sink component "
+					"buffer has not enough free bytes for "
+					"copy");
+			comp_overrun(dev, stream->buffer,
+				     stream->period_bytes, 0);
+			return -EIO;	/* xrun */
+		}
+
+		active[num_active++] = stream;
+	}
+
+	/* don't have any work if all sinks are inactive */
+	if (!num_active)
+		return 0;
+
+	if (comp_buffer_get_avail_bytes(source) < cd->period_bytes) {
+		trace_mux_error("mux_copy() error: source component buffer "
+				"has not enough data available");
+		comp_underrun(dev, source, cd->period_bytes, 0);
+		return -EIO;	/* xrun */
+	}
+
+	if (num_active >= MUX_FUSE_STREAMS) {
+		mux_fused_period(dev, active, num_active,
+				 (1 << cd->channels) - 1, source);
+	} else {
+		for (i = 0; i < num_active; i++)
+			mux_stream_period(dev, active[i], source);
+	}
+
+	/* calc new free and available */
+	for (i = 0; i < num_active; i++)
+		comp_update_buffer_produce(active[i]->buffer,
+					   active[i]->period_bytes);
+	comp_update_buffer_consume(source, cd->period_bytes);
+
+	return dev->frames;
+}
+
 /* copy and process stream data from source to sink buffers */
 static int mux_copy(struct comp_dev *dev)
 {
+	struct mux_data *cd = comp_get_drvdata(dev);
 
-	return 0;
+	tracev_mux("mux_copy()");
+
+	return cd->demux ? mux_copy_sinks(dev) : mux_copy_sources(dev);
 }
 
 static int mux_reset(struct comp_dev *dev)
 {
+	struct mux_data *cd = comp_get_drvdata(dev);
+	struct comp_buffer *source;
+	struct list_item *blist;
+
+	trace_mux("mux_reset()");
+
+	/* a mux with used sources should not reset downstream */
+	if (!cd->demux) {
+		list_for_item(blist, &dev->bsource_list) {
+			source = container_of(blist, struct comp_buffer,
+					      sink_list);
+			if (source->source->state > COMP_STATE_READY)
+				return 1;
+		}
+	}
+
+	dev->can_bypass = 0;
+	comp_set_state(dev, COMP_TRIGGER_RESET);
 	return 0;
 }
 
 static int mux_prepare(struct comp_dev *dev)
 {
+	struct mux_data *cd = comp_get_drvdata(dev);
+	int ret;
+
+	trace_mux("mux_prepare()");
+
+	/* a running mux only prepares downstream for its new source */
+	if (dev->state == COMP_STATE_ACTIVE)
+		return 1;
+
+	ret = comp_set_state(dev, COMP_TRIGGER_PREPARE);
+	if (ret < 0)
+		return ret;
+
+	/* a single stream with the mux side layout needs no copy */
+	dev->can_bypass = cd->num_streams == 1 && cd->streams[0].copy &&
+		list_item_is_last(dev->bsource_list.next,
+				  &dev->bsource_list) &&
+		list_item_is_last(dev->bsink_list.next, &dev->bsink_list);
+
 	return 0;
 }
 
+static void mux_cache(struct comp_dev *dev, int cmd)
+{
+	struct mux_data *cd;
+
+	switch (cmd) {
+	case COMP_CACHE_WRITEBACK_INV:
+		trace_mux("mux_cache(), COMP_CACHE_WRITEBACK_INV");
+
+		cd = comp_get_drvdata(dev);
+
+		dcache_writeback_invalidate_region(cd, sizeof(*cd));
+		dcache_writeback_invalidate_region(dev, sizeof(*dev));
+		break;
+
+	case COMP_CACHE_INVALIDATE:
+		trace_mux("mux_cache(), COMP_CACHE_INVALIDATE");
+
+		dcache_invalidate_region(dev, sizeof(*dev));
+
+		cd = comp_get_drvdata(dev);
+		dcache_invalidate_region(cd, sizeof(*cd));
+		break;
+	}
+}
+
 struct comp_driver comp_mux = {
 	.type	= SOF_COMP_MUX,
 	.ops	= {
@@ -91,9 +773,11 @@ struct comp_driver comp_mux = {
 		.free		= mux_free,
 		.params		= mux_params,
 		.cmd		= mux_cmd,
+		.trigger	= mux_trigger,
 		.copy		= mux_copy,
 		.prepare	= mux_prepare,
 		.reset		= mux_reset,
+		.cache		= mux_cache,
 	},
 };
 
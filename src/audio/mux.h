@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Liam Girdwood <liam.r.girdwood@linux.intel.com>
+ */
+
+/**
+ * \file audio/mux.h
+ * \brief Mux/demux component header file
+ */
+
+#ifndef MUX_H
+#define MUX_H
+
+#include <stdint.h>
+#include <sof/audio/component.h>
+
+#define CONFIG_GENERIC
+
+#if defined(__XCC__)
+#include <xtensa/config/core-isa.h>
+
+#if XCHAL_HAVE_HIFI3
+#undef CONFIG_GENERIC
+#endif
+
+#endif
+
+/** \brief Active streams from which they are routed in a single pass. */
+#define MUX_FUSE_STREAMS	3
+
+/** \brief Mux trace function. */
+#define trace_mux(__e, ...) \
+	trace_event(TRACE_CLASS_MUX, __e, ##__VA_ARGS__)
+
+/** \brief Mux trace value function. */
+#define tracev_mux(__e, ...) \
+	tracev_event(TRACE_CLASS_MUX, __e, ##__VA_ARGS__)
+
+/** \brief Mux trace error function. */
+#define trace_mux_error(__e, ...) \
+	trace_error(TRACE_CLASS_MUX, __e, ##__VA_ARGS__)
+
+/** \brief Channel routing between the mux side and one stream. */
+struct mux_route {
+	uint32_t wide_channels;			/**< mux side channels */
+	uint32_t channels;			/**< stream channels */
+	uint32_t offset;			/**< first channel of a slice */
+	uint8_t map[PLATFORM_MAX_CHANNELS];	/**< mux side channels */
+};
+
+/**
+ * \brief Mux slice processing function.
+ *
+ * Copies frames of stream channels that are a contiguous slice of the mux
+ * side frames starting at route offset, between regions that don't wrap.
+ */
+typedef void (*mux_func)(const struct mux_route *route, void *wide,
+			 void *narrow, uint32_t frames);
+
+/** \brief Mux slice processing functions map. */
+struct mux_func_map {
+	uint16_t sample_bytes;			/**< sample container size */
+	uint16_t channels;			/**< stream channels */
+	uint16_t wide_channels;			/**< mux side channels */
+	mux_func gather;			/**< mux side to stream */
+	mux_func scatter;			/**< stream to mux side */
+};
+
+/** \brief Routing state of one stream buffer. */
+struct mux_stream_data {
+	struct comp_buffer *buffer;		/**< stream buffer */
+	struct mux_route route;			/**< channel routing */
+	uint32_t period_bytes;			/**< stream period bytes */
+	uint32_t mask;				/**< mux side channels used */
+	uint32_t copy;				/**< same layout as mux side */
+	const struct mux_func_map *func;	/**< slice functions or NULL */
+};
+
+/** \brief Mux component private data. */
+struct mux_data {
+	uint32_t demux;			/**< one source to several sinks */
+	uint32_t sample_bytes;		/**< sample container size */
+	uint32_t channels;		/**< mux side channels */
+	uint32_t period_bytes;		/**< mux side period bytes */
+	uint32_t num_streams;		/**< number of connected streams */
+	struct mux_stream_data streams[SOF_IPC_MAX_MUX_STREAMS];
+};
+
+/**
+ * \brief Retrieves mux slice processing functions.
+ * \param[in] sample_bytes Sample container size.
+ * \param[in] route Routing of the stream.
+ * \return Functions for the slice shape or NULL.
+ */
+const struct mux_func_map *mux_get_processing_function(uint32_t sample_bytes,
+	const struct mux_route *route);
+
+#endif /* MUX_H */
@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Liam Girdwood <liam.r.girdwood@linux.intel.com>
+ */
+
+/**
+ * \file audio/mux_generic.c
+ * \brief Mux/demux generic processing implementation
+ */
+
+#include <stdint.h>
+#include "mux.h"
+
+#ifdef CONFIG_GENERIC
+
+/*
+ * A 2 channel slice of 4 channel frames is moved as whole 16 bit frames
+ * packed in one 32 bit word, or two words for 32 bit containers.
+ */
+
+/**
+ * \brief Gathers a 2 channel 16 bit slice from 4 channel frames.
+ * \param[in] route Routing of the stream.
+ * \param[in] wide Mux side frames.
+ * \param[out] narrow Stream frames.
+ * \param[in] frames Number of frames.
+ */
+static void mux_s16_2of4_gather(const struct mux_route *route, void *wide,
+				void *narrow, uint32_t frames)
+{
+	uint32_t *in = (uint32_t *)((int16_t *)wide + route->offset);
+	uint32_t *out = narrow;
+	uint32_t i;
+
+	for (i = 0; i < frames; i++)
+		out[i] = in[i << 1];
+}
+
+/**
+ * \brief Scatters a 2 channel 16 bit slice into 4 channel frames.
+ * \param[in] route Routing of the stream.
+ * \param[out] wide Mux side frames.
+ * \param[in] narrow Stream frames.
+ * \param[in] frames Number of frames.
+ */
+static void mux_s16_2of4_scatter(const struct mux_route *route, void *wide,
+				 void *narrow, uint32_t frames)
+{
+	uint32_t *out = (uint32_t *)((int16_t *)wide + route->offset);
+	uint32_t *in = narrow;
+	uint32_t i;
+
+	for (i = 0; i < frames; i++)
+		out[i << 1] = in[i];
+}
+
+/**
+ * \brief Gathers a 2 channel 32 bit slice from 4 channel frames.
+ * \param[in] route Routing of the stream.
+ * \param[in] wide Mux side frames.
+ * \param[out] narrow Stream frames.
+ * \param[in] frames Number of frames.
+ */
+static void mux_s32_2of4_gather(const struct mux_route *route, void *wide,
+				void *narrow, uint32_t frames)
+{
+	uint32_t *in = (uint32_t *)wide + route->offset;
+	uint32_t *out = narrow;
+	uint32_t i;
+
+	for (i = 0; i < frames; i++) {
+		out[0] = in[0];
+		out[1] = in[1];
+		in += 4;
+		out += 2;
+	}
+}
+
+/**
+ * \brief Scatters a 2 channel 32 bit slice into 4 channel frames.
+ * \param[in] route Routing of the stream.
+ * \param[out] wide Mux side frames.
+ * \param[in] narrow Stream frames.
+ * \param[in] frames Number of frames.
+ */
+static void mux_s32_2of4_scatter(const struct mux_route *route, void *wide,
+				 void *narrow, uint32_t frames)
+{
+	uint32_t *out = (uint32_t *)wide + route->offset;
+	uint32_t *in = narrow;
+	uint32_t i;
+
+	for (i = 0; i < frames; i++) {
+		out[0] = in[0];
+		out[1] = in[1];
+		in += 2;
+		out += 4;
+	}
+}
+
+static const struct mux_func_map mux_func_map[] = {
+	{sizeof(int16_t), 2, 4, mux_s16_2of4_gather, mux_s16_2of4_scatter},
+	{sizeof(int32_t), 2, 4, mux_s32_2of4_gather, mux_s32_2of4_scatter},
+};
+
+const struct mux_func_map *mux_get_processing_function(uint32_t sample_bytes,
+	const struct mux_route *route)
+{
+	int i;
+
+	/* map the slice functions for the sample size and channels */
+	for (i = 0; i < ARRAY_SIZE(mux_func_map); i++) {
+		if (sample_bytes == mux_func_map[i].sample_bytes &&
+		    route->channels == mux_func_map[i].channels &&
+		    route->wide_channels == mux_func_map[i].wide_channels)
+			return &mux_func_map[i];
+	}
+
+	return NULL;
+}
+
+#endif
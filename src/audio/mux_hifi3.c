@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Liam Girdwood <liam.r.girdwood@linux.intel.com>
+ */
+
+/**
+ * \file audio/mux_hifi3.c
+ * \brief Mux/demux HiFi3 processing implementation
+ */
+
+#include <stdint.h>
+#include "mux.h"
+
+#if defined(__XCC__) && XCHAL_HAVE_HIFI3
+
+#include <xtensa/tie/xt_hifi3.h>
+
+/*
+ * The stream side is contiguous and the mux side is strided by the mux
+ * frame size. A 2 channel 16 bit frame is one 32 bit word and a 2 channel
+ * 32 bit frame one 64 bit vector, which needs the mux side slice to be 64
+ * bit aligned. Unaligned 32 bit slices are moved one word at a time.
+ */
+
+/**
+ * \brief HiFi3 enabled gather of a 2 channel 16 bit slice from 4 channel
+ *	  frames.
+ * \param[in] route Routing of the stream.
+ * \param[in] wide Mux side frames.
+ * \param[out] narrow Stream frames.
+ * \param[in] frames Number of frames.
+ */
+static void mux_s16_2of4_gather(const struct mux_route *route, void *wide,
+				void *narrow, uint32_t frames)
+{
+	ae_int32 *in = (ae_int32 *)((int16_t *)wide + route->offset);
+	ae_int32 *out = narrow;
+	ae_int32x2 frame;
+	uint32_t i;
+
+	for (i = 0; i < frames; i++) {
+		AE_L32_XP(frame, in, 4 * sizeof(int16_t));
+		AE_S32_L_IP(frame, out, 2 * sizeof(int16_t));
+	}
+}
+
+/**
+ * \brief HiFi3 enabled scatter of a 2 channel 16 bit slice into 4 channel
+ *	  frames.
+ * \param[in] route Routing of the stream.
+ * \param[out] wide Mux side frames.
+ * \param[in] narrow Stream frames.
+ * \param[in] frames Number of frames.
+ */
+static void mux_s16_2of4_scatter(const struct mux_route *route, void *wide,
+				 void *narrow, uint32_t frames)
+{
+	ae_int32 *out = (ae_int32 *)((int16_t *)wide + route->offset);
+	ae_int32 *in = narrow;
+	ae_int32x2 frame;
+	uint32_t i;
+
+	for (i = 0; i < frames; i++) {
+		AE_L32_IP(frame, in, 2 * sizeof(int16_t));
+		AE_S32_L_XP(frame, out, 4 * sizeof(int16_t));
+	}
+}
+
+/**
+ * \brief HiFi3 enabled gather of a 2 channel 32 bit slice from 4 channel
+ *	  frames.
+ * \param[in] route Routing of the stream.
+ * \param[in] wide Mux side frames.
+ * \param[out] narrow Stream frames.
+ * \param[in] frames Number of frames.
+ */
+static void mux_s32_2of4_gather(const struct mux_route *route, void *wide,
+				void *narrow, uint32_t frames)
+{
+	int32_t *slice = (int32_t *)wide + route->offset;
+	ae_int32x2 *in = (ae_int32x2 *)slice;
+	ae_int32x2 *out = narrow;
+	ae_valign align = AE_ZALIGN64();
+	ae_int32 *win = (ae_int32 *)slice;
+	ae_int32 *wout = narrow;
+	ae_int32x2 frame;
+	uint32_t i;
+
+	if ((uintptr_t)slice & 0x7) {
+		for (i = 0; i < frames; i++) {
+			AE_L32_IP(frame, win, sizeof(int32_t));
+			AE_S32_L_IP(frame, wout, sizeof(int32_t));
+			AE_L32_XP(frame, win, 3 * sizeof(int32_t));
+			AE_S32_L_IP(frame, wout, sizeof(int32_t));
+		}
+		return;
+	}
+
+	for (i = 0; i < frames; i++) {
+		AE_L32X2_XP(frame, in, 4 * sizeof(int32_t));
+		AE_SA32X2_IP(frame, align, out);
+	}
+
+	AE_SA64POS_FP(align, out);
+}
+
+/**
+ * \brief HiFi3 enabled scatter of a 2 channel 32 bit slice into 4 channel
+ *	  frames.
+ * \param[in] route Routing of the stream.
+ * \param[out] wide Mux side frames.
+ * \param[in] narrow Stream frames.
+ * \param[in] frames Number of frames.
+ */
+static void mux_s32_2of4_scatter(const struct mux_route *route, void *wide,
+				 void *narrow, uint32_t frames)
+{
+	int32_t *slice = (int32_t *)wide + route->offset;
+	ae_int32x2 *out = (ae_int32x2 *)slice;
+	ae_int32x2 *in = narrow;
+	ae_valign align = AE_LA64_PP(in);
+	ae_int32 *wout = (ae_int32 *)slice;
+	ae_int32 *win = narrow;
+	ae_int32x2 frame;
+	uint32_t i;
+
+	if ((uintptr_t)slice & 0x7) {
+		for (i = 0; i < frames; i++) {
+			AE_L32_IP(frame, win, sizeof(int32_t));
+			AE_S32_L_IP(frame, wout, sizeof(int32_t));
+			AE_L32_IP(frame, win, sizeof(int32_t));
+			AE_S32_L_XP(frame, wout, 3 * sizeof(int32_t));
+		}
+		return;
+	}
+
+	for (i = 0; i < frames; i++) {
+		AE_LA32X2_IP(frame, align, in);
+		AE_S32X2_XP(frame, out, 4 * sizeof(int32_t));
+	}
+}
+
+static const struct mux_func_map mux_func_map[] = {
+	{sizeof(int16_t), 2, 4, mux_s16_2of4_gather, mux_s16_2of4_scatter},
+	{sizeof(int32_t), 2, 4, mux_s32_2of4_gather, mux_s32_2of4_scatter},
+};
+
+const struct mux_func_map *mux_get_processing_function(uint32_t sample_bytes,
+	const struct mux_route *route)
+{
+	int i;
+
+	/* map the slice functions for the sample size and channels */
+	for (i = 0; i < ARRAY_SIZE(mux_func_map); i++) {
+		if (sample_bytes == mux_func_map[i].sample_bytes &&
+		    route->channels == mux_func_map[i].channels &&
+		    route->wide_channels == mux_func_map[i].wide_channels)
+			return &mux_func_map[i];
+	}
+
+	return NULL;
+}
+
+#endif
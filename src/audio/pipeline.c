@@ -39,15 +39,20 @@
 #include <sof/alloc.h>
 #include <sof/debug.h>
 #include <sof/ipc.h>
+#include <sof/dai.h>
+#include <sof/mailbox.h>
 #include <sof/lock.h>
 #include <platform/timer.h>
 #include <platform/platform.h>
 #include <sof/audio/component.h>
 #include <sof/audio/pipeline.h>
 #include <sof/cpu.h>
+#include <sof/clk.h>
 #include <sof/idc.h>
 #include <platform/idc.h>
 
+extern struct ipc *_ipc;
+
 /* generic operation data used by op graph walk */
 struct op_data {
 	int op;
@@ -55,9 +60,67 @@ struct op_data {
 	struct stream_params *params;
 	int cmd;
 	void *cmd_data;
+	int ret;		/* result of the last component op */
+	uint32_t branches;	/* cores walking a branch of this op */
+	uint32_t remote;	/* walking a branch for another core */
+};
+
+/* graph walk directions */
+#define PIPELINE_WALK_DOWNSTREAM	0
+#define PIPELINE_WALK_UPSTREAM		1
+
+/* graph walk visitor results, negative values are errors ending the walk */
+#define PIPELINE_WALK_CONTINUE	0	/* walk the components beyond */
+#define PIPELINE_WALK_PRUNE	1	/* don't walk beyond this component */
+#define PIPELINE_WALK_STOP	2	/* the walk is complete */
+
+/* longest component chain a graph walk can follow */
+#define PIPELINE_WALK_DEPTH	32
+
+/*
+ * Graph walk with per operation visitors. visit() is called when a component
+ * is reached, leave() once every component beyond it has been walked and
+ * follow() decides which buffers to walk through, connected ones by default.
+ */
+struct pipeline_walk {
+	struct comp_dev *start;	/* first component visited */
+	struct comp_buffer *buffer;	/* start reached through, else NULL */
+	int dir;		/* PIPELINE_WALK_DOWNSTREAM or UPSTREAM */
+	void *data;		/* visitor private data */
+
+	/* buffer is NULL for the start component */
+	int (*visit)(struct pipeline_walk *walk, struct comp_dev *current,
+		     struct comp_buffer *buffer);
+	int (*leave)(struct pipeline_walk *walk, struct comp_dev *current);
+	/* returns 1 to walk to next, 0 to skip it or a negative error */
+	int (*follow)(struct pipeline_walk *walk, struct comp_dev *current,
+		      struct comp_buffer *buffer, struct comp_dev *next);
+};
+
+/* a component on the walk stack and the next of its buffers to walk */
+struct pipeline_walk_frame {
+	struct comp_dev *comp;
+	struct list_item *next;
 };
 
 static void pipeline_task(void *arg);
+static void pipeline_group_join(struct pipeline *p);
+static void pipeline_group_leave(struct pipeline *p);
+
+/* period groups of each core, see pipeline_group_join() */
+static struct pipeline_group pipeline_groups[PLATFORM_CORE_COUNT]
+					    [PIPELINE_GROUPS];
+
+#ifdef CONFIG_STREAM_STATS
+#define pipeline_stats_add(p, field, n)	((p)->stats.field += (n))
+#else
+#define pipeline_stats_add(p, field, n)	do {} while (0)
+#endif
+
+/* pipeline arena chunk size and allocation alignment */
+#define PIPELINE_ARENA_CHUNK_SIZE	4096
+#define PIPELINE_ARENA_ALIGN \
+	(PLATFORM_DCACHE_ALIGN > 8 ? PLATFORM_DCACHE_ALIGN : 8)
 
 /* call op on all upstream components - locks held by caller */
 static void connect_upstream(struct pipeline *p, struct comp_dev *start,
@@ -71,6 +134,7 @@ static void connect_upstream(struct pipeline *p, struct comp_dev *start,
 	/* complete component init */
 	current->pipeline = p;
 	current->frames = p->ipc_pipe.frames_per_sched;
+	p->polled |= current->polled;
 
 	/* we are an endpoint if we have 0 source components */
 	if (list_is_empty(&current->bsource_list)) {
@@ -112,6 +176,7 @@ static void connect_downstream(struct pipeline *p, struct comp_dev *start,
 	/* complete component init */
 	current->pipeline = p;
 	current->frames = p->ipc_pipe.frames_per_sched;
+	p->polled |= current->polled;
 
 	/* we are an endpoint if we have 0 sink components */
 	if (list_is_empty(&current->bsink_list)) {
@@ -198,6 +263,10 @@ static void disconnect_downstream(struct pipeline *p, struct comp_dev *start,
 static void pipeline_trigger_sched_comp(struct pipeline *p,
 					struct comp_dev *comp, int cmd)
 {
+	/* component state changed, rebuild the copy schedule */
+	p->sched_dirty = 1;
+	p->ts_dai = NULL;
+
 	/* only required by the scheduling component */
 	if (p->sched_comp != comp)
 		return;
@@ -213,14 +282,21 @@ static void pipeline_trigger_sched_comp(struct pipeline *p,
 	case COMP_TRIGGER_RELEASE:
 	case COMP_TRIGGER_START:
 		p->xrun_bytes = 0;
+		p->timer_periods = 0;
 		trace_pipe_with_ids(p, "pipeline_trigger_sched_comp(): "
 				    "RELEASE/START");
+		/* fast start playback runs on silence until the host data */
+		if (cmd == COMP_TRIGGER_START)
+			p->start_pending = p->ipc_pipe.fast_start &&
+				comp->params.direction ==
+				SOF_IPC_STREAM_PLAYBACK;
+		pipeline_group_join(p);
 		/* playback pipelines need scheduled now, capture pipelines are
 		 * scheduled once their initial DMA period is filled by the DAI
-		 * or in resume process
+		 * or in resume process, polled pipelines drive themselves
 		 */
 		if (comp->params.direction == SOF_IPC_STREAM_PLAYBACK ||
-		    p->status == COMP_STATE_PAUSED) {
+		    p->status == COMP_STATE_PAUSED || p->polled) {
 			/* schedule initial pipeline fill when next idle */
 			pipeline_schedule_copy_idle(p);
 		}
@@ -234,6 +310,105 @@ static void pipeline_trigger_sched_comp(struct pipeline *p,
 	}
 }
 
+#ifdef CONFIG_CACHE_LOCK
+/* keep the coefficients of running components in the data cache */
+static void pipeline_trigger_cache_lock(struct comp_dev *comp, int cmd)
+{
+	/* lines are locked in the cache of the core running the component */
+	if (comp->pipeline->ipc_pipe.core != cpu_get_id())
+		return;
+
+	switch (cmd) {
+	case COMP_TRIGGER_RELEASE:
+	case COMP_TRIGGER_START:
+		comp_cache(comp, COMP_CACHE_LOCK);
+		break;
+	case COMP_TRIGGER_PAUSE:
+	case COMP_TRIGGER_STOP:
+		comp_cache(comp, COMP_CACHE_UNLOCK);
+		break;
+	default:
+		break;
+	}
+}
+#else
+static inline void pipeline_trigger_cache_lock(struct comp_dev *comp,
+					       int cmd) { }
+#endif
+
+/* arena chunk header, allocations follow the header */
+struct pipeline_arena {
+	struct pipeline_arena *next;	/* next chunk in pipeline */
+	uint32_t size;			/* usable bytes in chunk */
+	uint32_t used;			/* bytes allocated from chunk */
+} __attribute__ ((__aligned__(PIPELINE_ARENA_ALIGN)));
+
+/*
+ * Component runtime data such as delay lines is allocated from chunks owned
+ * by the pipeline. Allocations are rewound in one step on pipeline reset
+ * and the chunks are kept for the next stream, so repeated stream open and
+ * close does not fragment the heap. Chunks are returned by pipeline_free().
+ */
+void *pipeline_arena_alloc(struct pipeline *p, size_t bytes)
+{
+	struct pipeline_arena *chunk;
+	void *ptr;
+	uint32_t size;
+
+	/* keep allocations aligned for cache operations and 64bit data */
+	if (bytes % PIPELINE_ARENA_ALIGN)
+		bytes += PIPELINE_ARENA_ALIGN - bytes % PIPELINE_ARENA_ALIGN;
+
+	for (chunk = p->arena; chunk; chunk = chunk->next) {
+		if (chunk->size - chunk->used >= bytes)
+			goto found;
+	}
+
+	/* no room, add a new chunk big enough for the request */
+	size = bytes > PIPELINE_ARENA_CHUNK_SIZE ?
+		bytes : PIPELINE_ARENA_CHUNK_SIZE;
+	chunk = rballoc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM,
+			sizeof(*chunk) + size);
+	if (!chunk) {
+		trace_pipe_error_with_ids(p, "pipeline_arena_alloc() error: "
+					  "Out of Memory, bytes = %u", bytes);
+		return NULL;
+	}
+
+	chunk->size = size;
+	chunk->used = 0;
+	chunk->next = p->arena;
+	p->arena = chunk;
+
+found:
+	ptr = (uint8_t *)(chunk + 1) + chunk->used;
+	chunk->used += bytes;
+	bzero(ptr, bytes);
+
+	return ptr;
+}
+
+/* rewind all arena allocations, chunks are kept */
+static void pipeline_arena_reset(struct pipeline *p)
+{
+	struct pipeline_arena *chunk;
+
+	for (chunk = p->arena; chunk; chunk = chunk->next)
+		chunk->used = 0;
+}
+
+/* return all arena chunks to the heap */
+static void pipeline_arena_free(struct pipeline *p)
+{
+	struct pipeline_arena *chunk;
+
+	while (p->arena) {
+		chunk = p->arena;
+		p->arena = chunk->next;
+		rfree(chunk);
+	}
+}
+
 /* create new pipeline - returns pipeline id or negative error */
 struct pipeline *pipeline_new(struct sof_ipc_pipe_new *pipe_desc,
 	struct comp_dev *cd)
@@ -251,6 +426,7 @@ struct pipeline *pipeline_new(struct sof_ipc_pipe_new *pipe_desc,
 
 	/* init pipeline */
 	p->sched_comp = cd;
+	p->sched_dirty = 1;
 	p->status = COMP_STATE_INIT;
 	schedule_task_init(&p->pipe_task, pipeline_task, p);
 	schedule_task_config(&p->pipe_task, pipe_desc->priority,
@@ -260,6 +436,14 @@ struct pipeline *pipeline_new(struct sof_ipc_pipe_new *pipe_desc,
 	spinlock_init(&p->lock);
 	memcpy(&p->ipc_pipe, pipe_desc, sizeof(*pipe_desc));
 
+	/* throughput pipelines run several periods at once, components
+	 * take their frames and the task its deadline from the scaled values
+	 */
+	if (pipe_desc->periods_per_sched > 1) {
+		p->ipc_pipe.frames_per_sched *= pipe_desc->periods_per_sched;
+		p->ipc_pipe.deadline *= pipe_desc->periods_per_sched;
+	}
+
 	return p;
 }
 
@@ -276,12 +460,16 @@ int pipeline_free(struct pipeline *p)
 	}
 
 	/* remove from any scheduling */
+	pipeline_group_leave(p);
 	schedule_task_free(&p->pipe_task);
 
 	/* disconnect components */
 	disconnect_downstream(p, p->sched_comp, p->sched_comp);
 	disconnect_upstream(p, p->sched_comp, p->sched_comp);
 
+	/* release component runtime data in one step */
+	pipeline_arena_free(p);
+
 	/* now free the pipeline */
 	rfree(p);
 
@@ -316,19 +504,60 @@ int pipeline_complete(struct pipeline *p)
 	return 0;
 }
 
+/* pipelines on both ends of the buffer must rebuild their copy schedule */
+static void pipeline_sched_invalidate(struct comp_buffer *buffer)
+{
+	if (buffer->source && buffer->source->pipeline) {
+		buffer->source->pipeline->sched_dirty = 1;
+		buffer->source->pipeline->ts_dai = NULL;
+	}
+	if (buffer->sink && buffer->sink->pipeline) {
+		buffer->sink->pipeline->sched_dirty = 1;
+		buffer->sink->pipeline->ts_dai = NULL;
+	}
+}
+
+/* get a fan-out buffer the source component already writes to */
+static struct comp_buffer *pipeline_fanout_group(struct comp_dev *source_comp)
+{
+	struct list_item *clist;
+	struct comp_buffer *buffer;
+
+	list_for_item(clist, &source_comp->bsink_list) {
+		buffer = container_of(clist, struct comp_buffer, source_list);
+		if (buffer->ipc_buffer.caps & SOF_MEM_CAPS_FANOUT)
+			return buffer;
+	}
+
+	return NULL;
+}
+
 /* connect component -> buffer */
 int pipeline_comp_connect(struct comp_dev *source_comp,
 			  struct comp_buffer *sink_buffer)
 {
+	struct comp_buffer *group = NULL;
+
 	trace_pipe("pipeline: connect source comp %d -> sink buffer %d",
 		   source_comp->comp.id, sink_buffer->ipc_buffer.comp.id);
 
+	/* fan-out sinks of one component read the same data */
+	if ((sink_buffer->ipc_buffer.caps & SOF_MEM_CAPS_FANOUT) &&
+	    !sink_buffer->next_reader)
+		group = pipeline_fanout_group(source_comp);
+	if (group) {
+		buffer_fanout_join(group, sink_buffer);
+		buffer_loopback_update(sink_buffer);
+	}
+
 	/* connect source to buffer */
 	spin_lock(&source_comp->lock);
 	list_item_prepend(&sink_buffer->source_list, &source_comp->bsink_list);
 	sink_buffer->source = source_comp;
 	spin_unlock(&source_comp->lock);
 
+	pipeline_sched_invalidate(sink_buffer);
+
 	/* connect the components */
 	if (sink_buffer->source && sink_buffer->sink)
 		sink_buffer->connected = 1;
@@ -349,6 +578,11 @@ int pipeline_buffer_connect(struct comp_buffer *source_buffer,
 	source_buffer->sink = sink_comp;
 	spin_unlock(&sink_comp->lock);
 
+	/* a playback DAI may be the reader loopback readers trail */
+	buffer_loopback_update(source_buffer);
+
+	pipeline_sched_invalidate(source_buffer);
+
 	/* connect the components */
 	if (source_buffer->source && source_buffer->sink)
 		source_buffer->connected = 1;
@@ -356,125 +590,246 @@ int pipeline_buffer_connect(struct comp_buffer *source_buffer,
 	return 0;
 }
 
-/* Walk the graph downstream from start component in any pipeline and perform
- * the operation on each component. Graph walk is stopped on any component
- * returning an error ( < 0) and returns immediately. Components returning a
- * positive error code also stop the graph walk on that branch causing the
- * walk to return to a shallower level in the graph. */
-static int component_op_downstream(struct op_data *op_data,
-	struct comp_dev *start, struct comp_dev *current,
-	struct comp_dev *previous)
+/* disconnect component -> buffer, reverses pipeline_comp_connect() */
+void pipeline_comp_disconnect(struct comp_dev *source_comp,
+			      struct comp_buffer *sink_buffer)
 {
-	struct list_item *clist;
-	int err = 0;
+	trace_pipe("pipeline: disconnect source comp %d -> sink buffer %d",
+		   source_comp->comp.id, sink_buffer->ipc_buffer.comp.id);
 
-	tracev_pipe("component_op_downstream(), current->comp.id = %u",
-		    current->comp.id);
+	pipeline_sched_invalidate(sink_buffer);
 
-	/* do operation on this component */
-	switch (op_data->op) {
-	case COMP_OPS_PARAMS:
+	spin_lock(&source_comp->lock);
+	list_item_del(&sink_buffer->source_list);
+	sink_buffer->source = NULL;
+	sink_buffer->connected = 0;
+	spin_unlock(&source_comp->lock);
+}
+
+/* disconnect buffer -> component, reverses pipeline_buffer_connect() */
+void pipeline_buffer_disconnect(struct comp_buffer *source_buffer,
+				struct comp_dev *sink_comp)
+{
+	trace_pipe("pipeline: disconnect source buffer %d -> sink comp %d",
+		   source_buffer->ipc_buffer.comp.id, sink_comp->comp.id);
+
+	pipeline_sched_invalidate(source_buffer);
+
+	spin_lock(&sink_comp->lock);
+	list_item_del(&source_buffer->sink_list);
+	source_buffer->sink = NULL;
+	source_buffer->connected = 0;
+	spin_unlock(&sink_comp->lock);
+
+	buffer_loopback_update(source_buffer);
+}
+
+/* the copy schedules only run the components beyond a parked buffer as
+ * silence copies, see pipeline_sched_copy() */
+void pipeline_buffer_park(struct comp_buffer *buffer, uint32_t parked)
+{
+	if (buffer->parked == parked)
+		return;
+
+	trace_pipe("pipeline: buffer %d parked %u",
+		   buffer->ipc_buffer.comp.id, parked);
+
+	buffer->parked = parked;
+	pipeline_sched_invalidate(buffer);
+}
+
+/* buffer list walked beyond a component */
+static inline struct list_item *pipeline_walk_list(struct pipeline_walk *walk,
+						   struct comp_dev *current)
+{
+	return walk->dir == PIPELINE_WALK_DOWNSTREAM ?
+		&current->bsink_list : &current->bsource_list;
+}
+
+/* host to DAI walk direction of the stream started from dev */
+static inline int pipeline_walk_dir(struct comp_dev *dev)
+{
+	return dev->params.direction == SOF_IPC_STREAM_PLAYBACK ?
+		PIPELINE_WALK_DOWNSTREAM : PIPELINE_WALK_UPSTREAM;
+}
+
+/*
+ * Walk the graph depth first from walk->start with an explicit stack rather
+ * than recursion, so deep topologies cost neither DSP stack nor register
+ * window spills. The next buffer of a component is looked up before walking
+ * through the current one, so visitors may unlink the buffer they came from.
+ * Returns 0 when the walk completes or stops, else the visitor error.
+ */
+static int pipeline_walk(struct pipeline_walk *walk)
+{
+	struct pipeline_walk_frame stack[PIPELINE_WALK_DEPTH];
+	struct pipeline_walk_frame *frame;
+	struct comp_dev *current = walk->start;
+	struct comp_buffer *buffer = walk->buffer;
+	struct comp_dev *next;
+	struct list_item *list;
+	int depth = 0;
+	int ret;
 
-		/* don't do any params downstream if current is running */
-		if (current->state == COMP_STATE_ACTIVE)
+	for (;;) {
+		ret = walk->visit ? walk->visit(walk, current, buffer) :
+			PIPELINE_WALK_CONTINUE;
+		if (ret < 0)
+			return ret;
+		if (ret == PIPELINE_WALK_STOP)
 			return 0;
 
-		/* send params to the component */
-		if (current != start && previous != NULL)
-			comp_install_params(current, previous);
-		err = comp_params(current);
-		break;
-	case COMP_OPS_TRIGGER:
-		/* send command to the component and update pipeline state  */
-		err = comp_trigger(current, op_data->cmd);
-		if (err == 0)
-			pipeline_trigger_sched_comp(current->pipeline, current,
-						    op_data->cmd);
-		break;
-	case COMP_OPS_PREPARE:
-		/* prepare the component */
-		err = comp_prepare(current);
-		break;
-	case COMP_OPS_RESET:
-		/* component should reset and free resources */
-		err = comp_reset(current);
-		break;
-	case COMP_OPS_BUFFER: /* handled by other API call */
-	case COMP_OPS_CACHE:
-	default:
-		trace_pipe_error("component_op_downstream() error: op_data->op"
-				 "= %d", op_data->op);
-		return -EINVAL;
-	}
+		if (ret == PIPELINE_WALK_CONTINUE) {
+			if (depth == PIPELINE_WALK_DEPTH) {
+				trace_pipe_error("pipeline_walk() error: graph "
+						 "deeper than %d components",
+						 PIPELINE_WALK_DEPTH);
+				return -ENOSPC;
+			}
+
+			frame = &stack[depth++];
+			frame->comp = current;
+			frame->next = pipeline_walk_list(walk, current)->next;
+		} else if (walk->leave) {
+			ret = walk->leave(walk, current);
+			if (ret < 0)
+				return ret;
+		}
 
-	/* don't walk the graph any further if this component fails */
-	if (err < 0) {
-		trace_pipe_error("component_op_downstream() error: err = %d",
-				 err);
-		return err;
-	} else if (err > 0 || (current != start && current->is_endpoint)) {
-		/* we finish walking the graph if we reach the DAI or component is
-		 * currently active and configured already (err > 0).
-		 */
-		tracev_pipe("component_op_downstream() DAI or component "
-			    "currently active or configured already, err = %d",
-			    err);
-		return err;
+		/* find the next component, leaving the ones fully walked */
+		for (;;) {
+			if (!depth)
+				return 0;
+
+			frame = &stack[depth - 1];
+			list = pipeline_walk_list(walk, frame->comp);
+
+			if (frame->next == list) {
+				depth--;
+				if (walk->leave) {
+					ret = walk->leave(walk, frame->comp);
+					if (ret < 0)
+						return ret;
+				}
+				continue;
+			}
+
+			if (walk->dir == PIPELINE_WALK_DOWNSTREAM) {
+				buffer = container_of(frame->next,
+						      struct comp_buffer,
+						      source_list);
+				next = buffer->sink;
+			} else {
+				buffer = container_of(frame->next,
+						      struct comp_buffer,
+						      sink_list);
+				next = buffer->source;
+			}
+			frame->next = frame->next->next;
+
+			ret = walk->follow ?
+				walk->follow(walk, frame->comp, buffer, next) :
+				buffer->connected;
+			if (ret < 0)
+				return ret;
+			if (ret) {
+				current = next;
+				break;
+			}
+		}
 	}
+}
 
-	/* now run this operation downstream */
-	list_for_item(clist, &current->bsink_list) {
-		struct comp_buffer *buffer;
+/* run the cache op on a component, stopping at the DAI */
+static int component_cache_visit(struct pipeline_walk *walk,
+				 struct comp_dev *current,
+				 struct comp_buffer *buffer)
+{
+	struct op_data *op_data = walk->data;
 
-		buffer = container_of(clist, struct comp_buffer, source_list);
+	comp_cache(current, op_data->cmd);
 
-		/* don't go downstream if this component is not connected */
-		if (!buffer->connected)
-			continue;
+	/* we finish walking the graph if we reach the DAI */
+	return buffer && current->is_endpoint ? PIPELINE_WALK_PRUNE :
+		PIPELINE_WALK_CONTINUE;
+}
 
-		err = component_op_downstream(op_data, start, buffer->sink,
-			current);
-		if (err < 0)
-			break;
-	}
+/* run the cache op on every buffer, following the connected ones */
+static int component_cache_follow(struct pipeline_walk *walk,
+				  struct comp_dev *current,
+				  struct comp_buffer *buffer,
+				  struct comp_dev *next)
+{
+	struct op_data *op_data = walk->data;
+	cache_command cache_cmd = comp_get_cache_command(op_data->cmd);
 
-	return err;
+	/* shared buffers are uncached */
+	if (cache_cmd && !buffer_is_shared(buffer))
+		cache_cmd(buffer, sizeof(*buffer));
+
+	return buffer->connected;
 }
 
-/* Walk the graph upstream from start component in any pipeline and perform
- * the operation on each component. Graph walk is stopped on any component
- * returning an error ( < 0) and returns immediately. Components returning a
- * positive error code also stop the graph walk on that branch causing the
- * walk to return to a shallower level in the graph. */
-static int component_op_upstream(struct op_data *op_data,
-	struct comp_dev *start, struct comp_dev *current,
-	struct comp_dev *previous)
+/* run the cache op on the components and buffers from start to the
+ * endpoints, start is entered through buffer unless it is NULL */
+static void component_cache(struct comp_dev *start, struct comp_buffer *buffer,
+			    int dir, int cmd)
 {
-	struct list_item *clist;
+	struct op_data op_data;
+	struct pipeline_walk walk = {
+		.start = start,
+		.buffer = buffer,
+		.dir = dir,
+		.data = &op_data,
+		.visit = component_cache_visit,
+		.follow = component_cache_follow,
+	};
+
+	op_data.op = COMP_OPS_CACHE;
+	op_data.cmd = cmd;
+
+	pipeline_walk(&walk);
+}
+
+/* Perform the operation on each component of the walk. Graph walk is stopped
+ * on any component returning an error ( < 0) and returns immediately.
+ * Components returning a positive error code also stop the graph walk on that
+ * branch causing the walk to continue at a shallower level in the graph. */
+static int component_op_visit(struct pipeline_walk *walk,
+			      struct comp_dev *current,
+			      struct comp_buffer *buffer)
+{
+	struct op_data *op_data = walk->data;
 	int err = 0;
 
-	tracev_pipe("component_op_upstream(), current->comp.id = %u",
+	tracev_pipe("component_op_visit(), current->comp.id = %u",
 		    current->comp.id);
 
 	/* do operation on this component */
 	switch (op_data->op) {
 	case COMP_OPS_PARAMS:
 
-		/* don't do any params upstream if current is running */
-		if (current->state == COMP_STATE_ACTIVE)
-			return 0;
+		/* don't do any params beyond if current is running */
+		if (current->state == COMP_STATE_ACTIVE) {
+			op_data->ret = 0;
+			return PIPELINE_WALK_PRUNE;
+		}
 
 		/* send params to the component */
-		if (current != start && previous != NULL)
-			comp_install_params(current, previous);
+		if (buffer)
+			comp_install_params(current,
+					    walk->dir == PIPELINE_WALK_DOWNSTREAM ?
+					    buffer->source : buffer->sink);
 		err = comp_params(current);
 		break;
 	case COMP_OPS_TRIGGER:
 		/* send command to the component and update pipeline state  */
 		err = comp_trigger(current, op_data->cmd);
-		if (err == 0)
+		if (err == 0) {
 			pipeline_trigger_sched_comp(current->pipeline, current,
 						    op_data->cmd);
+			pipeline_trigger_cache_lock(current, op_data->cmd);
+		}
 		break;
 	case COMP_OPS_PREPARE:
 		/* prepare the component */
@@ -487,217 +842,666 @@ static int component_op_upstream(struct op_data *op_data,
 	case COMP_OPS_BUFFER: /* handled by other API call */
 	case COMP_OPS_CACHE:
 	default:
-		trace_pipe_error("component_op_upstream() error, op_data->op = "
+		trace_pipe_error("component_op_visit() error: op_data->op = "
 				 "%d", op_data->op);
 		return -EINVAL;
 	}
 
 	/* don't walk the graph any further if this component fails */
 	if (err < 0) {
-		trace_pipe_error("component_op_upstream() error: Component "
-				 "failed, err = %d", err);
+		trace_pipe_error("component_op_visit() error: err = %d", err);
 		return err;
-	} else if (err > 0 || (current != start && current->is_endpoint)) {
-		tracev_pipe("component_op_upstream(), err > 0 || (current != "
-			    "start && current->is_endpoint)");
-		return 0;
 	}
 
-	/* now run this operation upstream */
-	list_for_item(clist, &current->bsource_list) {
-		struct comp_buffer *buffer;
-
-		buffer = container_of(clist, struct comp_buffer, sink_list);
-
-		/* don't go upstream if this component is not connected */
-		if (!buffer->connected)
-			continue;
+	op_data->ret = err;
 
-		err = component_op_upstream(op_data, start, buffer->source,
-			current);
-		if (err < 0)
-			break;
+	/* we finish walking the branch if we reach the DAI or component is
+	 * currently active and configured already (err > 0).
+	 */
+	if (err > 0 || (buffer && current->is_endpoint)) {
+		tracev_pipe("component_op_visit() DAI or component currently "
+			    "active or configured already, err = %d", err);
+		return PIPELINE_WALK_PRUNE;
 	}
 
-	return err;
+	return PIPELINE_WALK_CONTINUE;
 }
 
-/* walk the graph upstream from start component in any pipeline and prepare
- * the buffer context for each inactive component */
-static int component_prepare_buffers_upstream(struct comp_dev *start,
-	struct comp_dev *current, struct comp_buffer *buffer)
+/*
+ * Hand the branch beyond buffer to the core running its pipeline, so params
+ * and prepare setup of independent branches such as mixer inputs run in
+ * parallel. Each core takes one branch per walk, others are walked here.
+ * Returns 1 if the branch was handed over.
+ */
+static int pipeline_branch_start(struct pipeline_walk *walk,
+				 struct comp_dev *current,
+				 struct comp_buffer *buffer,
+				 struct comp_dev *next)
 {
-	struct list_item *clist;
-	int err = 0;
+	struct op_data *op_data = walk->data;
+	struct idc_msg branch_msg = { IDC_MSG_PPL_BRANCH,
+		IDC_MSG_PPL_BRANCH_EXT, 0 };
+	struct pipeline_branch *branch;
+	int core;
+
+	if ((op_data->op != COMP_OPS_PARAMS &&
+	     op_data->op != COMP_OPS_PREPARE) || op_data->remote)
+		return 0;
 
-	/* component copy/process to downstream */
-	if (current != start && buffer != NULL) {
+	if (!next->pipeline || next->pipeline == current->pipeline)
+		return 0;
 
-		buffer_reset_pos(buffer);
+	core = next->pipeline->ipc_pipe.core;
+	if (core == cpu_get_id() || op_data->branches & (1 << core) ||
+	    !cpu_is_core_enabled(core))
+		return 0;
 
-		/* stop going downstream if we reach an end point in this pipeline */
-		if (current->is_endpoint)
-			return 0;
-	}
+	branch = &_ipc->shared_ctx->branch[core];
+	branch->start = next;
+	branch->buffer = buffer;
+	branch->op = op_data->op;
+	branch->dir = walk->dir;
+	branch->done = 0;
+	branch->ret = 0;
+
+	/* the other core reads params from current and walks the branch */
+	comp_cache(current, COMP_CACHE_WRITEBACK_INV);
+	if (!buffer_is_shared(buffer))
+		dcache_writeback_invalidate_region(buffer, sizeof(*buffer));
+	component_cache(next, buffer, walk->dir, COMP_CACHE_WRITEBACK_INV);
+
+	branch_msg.core = core;
+	if (idc_send_msg(&branch_msg, IDC_NON_BLOCKING) < 0)
+		return 0;
 
-	/* travel uptream to sink end point(s) */
-	list_for_item(clist, &current->bsource_list) {
+	tracev_pipe("pipeline_branch_start(), next->comp.id = %u, core = %d",
+		    next->comp.id, core);
 
-		buffer = container_of(clist, struct comp_buffer, sink_list);
+	op_data->branches |= 1 << core;
+
+	return 1;
+}
+
+/* wait for the branches handed to other cores, returns the first error */
+static int pipeline_branch_wait(struct op_data *op_data, int ret)
+{
+	struct pipeline_branch *branch;
+	uint32_t timeout = 0;
+	int core;
+
+	if (!op_data->branches)
+		return ret;
 
-		/* dont go upstream if this component is not connected or active */
-		if (!buffer->connected || buffer->source->state == COMP_STATE_ACTIVE)
+	for (core = 0; core < PLATFORM_CORE_COUNT; core++) {
+		if (!(op_data->branches & (1 << core)))
 			continue;
 
-		/* continue downstream */
-		err = component_prepare_buffers_upstream(start, buffer->source,
-			buffer);
-		if (err < 0) {
-			trace_pipe_error("component_prepare_buffers_upstream()"
-					 " error: err = %d", err);
-			break;
+		branch = &_ipc->shared_ctx->branch[core];
+
+		while (!branch->done && timeout < PIPELINE_BRANCH_TIMEOUT) {
+			idelay(PLATFORM_DEFAULT_DELAY);
+			timeout += PLATFORM_DEFAULT_DELAY;
+		}
+
+		if (branch->done) {
+			component_cache(branch->start, branch->buffer,
+					branch->dir, COMP_CACHE_INVALIDATE);
+		} else {
+			trace_pipe_error("pipeline_branch_wait() error: core %d "
+					 "timeout", core);
+			branch->ret = -ETIME;
 		}
+
+		if (branch->ret < 0 && ret >= 0)
+			ret = branch->ret;
 	}
 
-	/* return back downstream */
-	return err;
+	op_data->branches = 0;
+
+	return ret;
 }
 
-/* walk the graph downstream from start component in any pipeline and prepare
- * the buffer context for each inactive component */
-static int component_prepare_buffers_downstream(struct comp_dev *start,
-	struct comp_dev *current, struct comp_buffer *buffer)
+/* walk connected buffers, unless another core walks the branch beyond */
+static int component_op_follow(struct pipeline_walk *walk,
+			       struct comp_dev *current,
+			       struct comp_buffer *buffer,
+			       struct comp_dev *next)
 {
-	struct list_item *clist;
-	int err = 0;
-
-	/* component copy/process to downstream */
-	if (current != start && buffer != NULL) {
-
-		buffer_reset_pos(buffer);
+	if (!buffer->connected)
+		return 0;
 
-		/* stop going downstream if we reach an end point in this pipeline */
-		if (current->is_endpoint)
-			return 0;
-	}
+	return !pipeline_branch_start(walk, current, buffer, next);
+}
 
-	/* travel downstream to sink end point(s) */
-	list_for_item(clist, &current->bsink_list) {
+/* Run the operation from start to the endpoints in direction dir. Downstream
+ * walks return the positive code of a component that stopped the last
+ * branch walked. */
+static int component_op(struct op_data *op_data, struct comp_dev *start,
+			int dir)
+{
+	struct pipeline_walk walk = {
+		.start = start,
+		.dir = dir,
+		.data = op_data,
+		.visit = component_op_visit,
+		.follow = component_op_follow,
+	};
+	int ret;
 
-		buffer = container_of(clist, struct comp_buffer, source_list);
+	op_data->ret = 0;
+	op_data->branches = 0;
+	op_data->remote = 0;
 
-		/* dont go downstream if this component is not connected or active */
-		if (!buffer->connected || buffer->sink->state == COMP_STATE_ACTIVE)
-			continue;
+	ret = pipeline_walk(&walk);
 
-		/* continue downstream */
-		err = component_prepare_buffers_downstream(start, buffer->sink,
-			buffer);
-		if (err < 0) {
-			trace_pipe_error("component_prepare_buffers_downstream"
-					 "() error: err = %d", err);
-			break;
-		}
-	}
+	/* branches on other cores are done before the walk returns */
+	ret = pipeline_branch_wait(op_data, ret);
+	if (ret < 0)
+		return ret;
 
-	/* return back upstream */
-	return err;
+	return dir == PIPELINE_WALK_DOWNSTREAM ? op_data->ret : 0;
 }
 
-/* prepare the pipeline for usage - preload host buffers here */
-int pipeline_prepare(struct pipeline *p, struct comp_dev *dev)
+/* walk a params or prepare branch handed over by another core, the result
+ * is posted in the branch */
+int pipeline_branch_run(struct pipeline_branch *branch)
 {
 	struct op_data op_data;
-	int ret = -1;
-	uint32_t flags;
+	struct pipeline_walk walk = {
+		.start = branch->start,
+		.buffer = branch->buffer,
+		.dir = branch->dir,
+		.data = &op_data,
+		.visit = component_op_visit,
+		.follow = component_op_follow,
+	};
+	struct comp_dev *previous = branch->dir == PIPELINE_WALK_DOWNSTREAM ?
+		branch->buffer->source : branch->buffer->sink;
+	int ret;
 
-	trace_pipe_with_ids(p, "pipeline_prepare()");
+	trace_pipe("pipeline_branch_run(), start->comp.id = %u",
+		   branch->start->comp.id);
 
-	op_data.p = p;
-	op_data.op = COMP_OPS_PREPARE;
+	op_data.op = branch->op;
+	op_data.ret = 0;
+	op_data.branches = 0;
+	op_data.remote = 1;
 
-	spin_lock_irq(&p->lock, flags);
+	/* see the branch as the master core left it */
+	comp_cache(previous, COMP_CACHE_INVALIDATE);
+	if (!buffer_is_shared(branch->buffer))
+		dcache_invalidate_region(branch->buffer,
+					 sizeof(*branch->buffer));
+	component_cache(branch->start, branch->buffer, branch->dir,
+			COMP_CACHE_INVALIDATE);
 
-	/* playback pipelines can be preloaded from host before trigger */
-	if (dev->params.direction == SOF_IPC_STREAM_PLAYBACK) {
+	ret = pipeline_walk(&walk);
 
-		ret = component_op_downstream(&op_data, dev, dev, NULL);
-		if (ret < 0)
-			goto out;
+	component_cache(branch->start, branch->buffer, branch->dir,
+			COMP_CACHE_WRITEBACK_INV);
 
-		/* set up reader and writer positions */
-		component_prepare_buffers_downstream(dev, dev, NULL);
-	} else {
-		ret = component_op_upstream(&op_data, dev, dev, NULL);
-		if (ret < 0)
-			goto out;
+	branch->ret = ret;
+	branch->done = 1;
 
-		/* set up reader and writer positions */
-		component_prepare_buffers_upstream(dev, dev, NULL);
-	}
+	return ret;
+}
 
-	p->status = COMP_STATE_PREPARE;
-out:
-	spin_unlock_irq(&p->lock, flags);
-	return ret;
+/* reset the buffer positions up to the endpoints */
+static int component_prepare_buffers_visit(struct pipeline_walk *walk,
+					   struct comp_dev *current,
+					   struct comp_buffer *buffer)
+{
+	if (!buffer)
+		return PIPELINE_WALK_CONTINUE;
+
+	buffer_reset_pos(buffer);
+
+	/* stop going further if we reach an end point in this pipeline */
+	return current->is_endpoint ? PIPELINE_WALK_PRUNE :
+		PIPELINE_WALK_CONTINUE;
 }
 
-static void component_cache_downstream(int cmd, struct comp_dev *start,
-				       struct comp_dev *current)
+/* don't walk to components that are not connected or active */
+static int component_follow_inactive(struct pipeline_walk *walk,
+				     struct comp_dev *current,
+				     struct comp_buffer *buffer,
+				     struct comp_dev *next)
+{
+	return buffer->connected && next->state != COMP_STATE_ACTIVE;
+}
+
+/* walk the graph from start component in any pipeline and prepare the
+ * buffer context for each inactive component */
+static void component_prepare_buffers(struct comp_dev *start, int dir)
+{
+	struct pipeline_walk walk = {
+		.start = start,
+		.dir = dir,
+		.visit = component_prepare_buffers_visit,
+		.follow = component_follow_inactive,
+	};
+	int err;
+
+	err = pipeline_walk(&walk);
+	if (err < 0)
+		trace_pipe_error("component_prepare_buffers() error: err = %d",
+				 err);
+}
+
+/* components with nothing to process are bypassed, low latency builds also
+ * bypass components that can process their source buffer in place */
+static inline int component_bypass_mode(struct comp_dev *current)
+{
+#ifdef CONFIG_PIPELINE_INPLACE
+	if (current->can_inplace && current->drv->ops.copy_inplace)
+		return 1;
+#endif
+	return current->can_bypass;
+}
+
+/* check if a prepared component can be bypassed, it must have a single
+ * source and sink buffer in the same pipeline and its downstream component
+ * must not hold DMA descriptors pointing at the sink buffer */
+static int component_can_bypass(struct comp_dev *current)
+{
+	struct comp_buffer *source;
+	struct comp_buffer *sink;
+
+	if (!component_bypass_mode(current) || current->is_endpoint ||
+	    current->state == COMP_STATE_ACTIVE)
+		return 0;
+
+	if (list_is_empty(&current->bsource_list) ||
+	    !list_item_is_last(current->bsource_list.next,
+			       &current->bsource_list) ||
+	    list_is_empty(&current->bsink_list) ||
+	    !list_item_is_last(current->bsink_list.next,
+			       &current->bsink_list))
+		return 0;
+
+	source = list_first_item(&current->bsource_list, struct comp_buffer,
+				 sink_list);
+	sink = list_first_item(&current->bsink_list, struct comp_buffer,
+			       source_list);
+
+	/* a source buffer can only stand in for one bypassed component */
+	if (!source->connected || !sink->connected || source->bypass_comp)
+		return 0;
+
+	/* processing in place would change the data of fan-out siblings */
+	if (source->next_reader && !current->can_bypass)
+		return 0;
+
+	if (source->source->pipeline != current->pipeline ||
+	    sink->sink->pipeline != current->pipeline)
+		return 0;
+
+	return !sink->sink->is_dma_connected;
+}
+
+/* connect the source buffer of a bypassed component to its downstream
+ * component in place of the sink buffer, so no copy runs for it */
+static void component_bypass(struct comp_dev *current)
+{
+	struct comp_buffer *source;
+	struct comp_buffer *sink;
+
+	source = list_first_item(&current->bsource_list, struct comp_buffer,
+				 sink_list);
+	sink = list_first_item(&current->bsink_list, struct comp_buffer,
+			       source_list);
+
+	trace_pipe("component_bypass(), current->comp.id = %u",
+		   current->comp.id);
+
+	/* source buffer takes the sink buffer position downstream */
+	list_item_del(&source->sink_list);
+	list_item_append(&source->sink_list, &sink->sink_list);
+	list_item_del(&sink->sink_list);
+
+	source->sink = sink->sink;
+	source->bypass_comp = current;
+
+	/* no copy runs but the data may still need processing */
+	source->inplace = !current->can_bypass;
+}
+
+/* reconnect a bypassed component between its source and sink buffers */
+static struct comp_dev *component_bypass_restore(struct comp_buffer *source)
+{
+	struct comp_dev *current = source->bypass_comp;
+	struct comp_buffer *sink;
+
+	sink = list_first_item(&current->bsink_list, struct comp_buffer,
+			       source_list);
+
+	trace_pipe("component_bypass_restore(), current->comp.id = %u",
+		   current->comp.id);
+
+	/* sink buffer takes its position back downstream */
+	list_item_append(&sink->sink_list, &source->sink_list);
+	list_item_del(&source->sink_list);
+	list_item_append(&source->sink_list, &current->bsource_list);
+
+	source->sink = current;
+	source->bypass_comp = NULL;
+	source->inplace = 0;
+
+	return current;
+}
+
+/* walk the graph downstream from start component in this pipeline and
+ * bypass all prepared components that have nothing to process */
+static void component_bypass_downstream(struct comp_dev *start,
+					struct comp_dev *current)
 {
-	cache_command cache_cmd = comp_get_cache_command(cmd);
 	struct list_item *clist;
 	struct comp_buffer *buffer;
 
-	comp_cache(current, cmd);
-
-	/* we finish walking the graph if we reach the DAI */
+	/* stop going downstream if we reach an end point in this pipeline */
 	if (current != start && current->is_endpoint)
 		return;
 
-	/* now run this operation downstream */
 	list_for_item(clist, &current->bsink_list) {
 		buffer = container_of(clist, struct comp_buffer, source_list);
 
-		if (cache_cmd)
-			cache_cmd(buffer, sizeof(*buffer));
+		if (!buffer->connected ||
+		    buffer->sink->pipeline != current->pipeline)
+			continue;
 
-		/* don't go downstream if this component is not connected */
-		if (!buffer->connected)
+		component_bypass_downstream(start, buffer->sink);
+	}
+
+	if (current != start && component_can_bypass(current))
+		component_bypass(current);
+}
+
+/* walk the graph upstream from start component in this pipeline and
+ * bypass all prepared components that have nothing to process */
+static void component_bypass_upstream(struct comp_dev *start,
+				      struct comp_dev *current)
+{
+	struct list_item *clist;
+	struct list_item *tlist;
+	struct comp_buffer *buffer;
+
+	/* stop going upstream if we reach an end point in this pipeline */
+	if (current != start && current->is_endpoint)
+		return;
+
+	/* the list is modified when an upstream component is bypassed */
+	list_for_item_safe(clist, tlist, &current->bsource_list) {
+		buffer = container_of(clist, struct comp_buffer, sink_list);
+
+		if (!buffer->connected || buffer->bypass_comp ||
+		    buffer->source->pipeline != current->pipeline)
 			continue;
 
-		component_cache_downstream(cmd, start, buffer->sink);
+		component_bypass_upstream(start, buffer->source);
 	}
+
+	if (current != start && component_can_bypass(current))
+		component_bypass(current);
 }
 
-static void component_cache_upstream(int cmd, struct comp_dev *start,
-				     struct comp_dev *current)
+/* walk the graph downstream from start component in this pipeline and
+ * reconnect all bypassed components */
+static void component_restore_downstream(struct comp_dev *start,
+					 struct comp_dev *current)
 {
-	cache_command cache_cmd = comp_get_cache_command(cmd);
 	struct list_item *clist;
 	struct comp_buffer *buffer;
 
-	comp_cache(current, cmd);
+	if (current != start && current->is_endpoint)
+		return;
+
+	list_for_item(clist, &current->bsink_list) {
+		buffer = container_of(clist, struct comp_buffer, source_list);
+
+		if (buffer->bypass_comp)
+			component_bypass_restore(buffer);
+
+		if (!buffer->connected ||
+		    buffer->sink->pipeline != current->pipeline)
+			continue;
+
+		component_restore_downstream(start, buffer->sink);
+	}
+}
+
+/* walk the graph upstream from start component in this pipeline and
+ * reconnect all bypassed components */
+static void component_restore_upstream(struct comp_dev *start,
+				       struct comp_dev *current)
+{
+	struct list_item *clist;
+	struct list_item *tlist;
+	struct comp_buffer *buffer;
+	struct comp_dev *source;
 
-	/* we finish walking the graph if we reach the DAI */
 	if (current != start && current->is_endpoint)
 		return;
 
-	/* now run this operation upstream */
-	list_for_item(clist, &current->bsource_list) {
+	/* the list is modified when an upstream component is reconnected */
+	list_for_item_safe(clist, tlist, &current->bsource_list) {
 		buffer = container_of(clist, struct comp_buffer, sink_list);
 
-		if (cache_cmd)
-			cache_cmd(buffer, sizeof(*buffer));
+		if (buffer->bypass_comp)
+			source = component_bypass_restore(buffer);
+		else
+			source = buffer->source;
 
-		/* don't go upstream if this component is not connected */
-		if (!buffer->connected)
+		if (!buffer->connected || source->pipeline != current->pipeline)
 			continue;
 
-		component_cache_upstream(cmd, start, buffer->source);
+		component_restore_upstream(start, source);
+	}
+}
+
+/* reconnect the bypassed components of the pipeline path from dev */
+static void pipeline_bypass_restore(struct comp_dev *dev)
+{
+	if (dev->params.direction == SOF_IPC_STREAM_PLAYBACK)
+		component_restore_downstream(dev, dev);
+	else
+		component_restore_upstream(dev, dev);
+}
+
+/* a buffer is parked itself or written by a parked component, the
+ * components before the current one were added in copy order */
+static uint32_t pipeline_sched_parked(struct pipeline *p,
+				      struct comp_buffer *buffer)
+{
+	uint32_t i;
+
+	if (buffer->parked)
+		return 1;
+
+	for (i = 0; i < p->sched_count - 1; i++) {
+		if (p->sched[i].sink == buffer)
+			return p->sched[i].parked;
+	}
+
+	return 0;
+}
+
+/* append component copy to the compiled schedule, components of an idle
+ * capable, pull or parked pipeline branch also get the periods their copy
+ * moves */
+static int pipeline_sched_add(struct pipeline *p, struct comp_dev *dev)
+{
+	struct pipeline_sched_entry *entry;
+	enum sof_ipc_frame frame_fmt;
+
+	if (p->sched_count >= PIPELINE_SCHED_MAX_COMPS)
+		return -ENOSPC;
+
+	entry = &p->sched[p->sched_count++];
+	entry->dev = dev;
+	entry->copy = dev->drv->ops.copy;
+	entry->source = NULL;
+	entry->sink = NULL;
+	entry->source_bytes = 0;
+	entry->sink_bytes = 0;
+	entry->idle = p->idle_limit && dev->can_idle;
+	entry->parked = 0;
+	dev->pull = p->ipc_pipe.pull && dev->can_pull;
+
+	/* only a single source and sink component can copy silence or wait
+	 * for its sink to have room */
+	if (dev->is_endpoint ||
+	    list_is_empty(&dev->bsource_list) ||
+	    !list_item_is_last(dev->bsource_list.next, &dev->bsource_list) ||
+	    list_is_empty(&dev->bsink_list) ||
+	    !list_item_is_last(dev->bsink_list.next, &dev->bsink_list))
+		return 0;
+
+	entry->source = list_first_item(&dev->bsource_list, struct comp_buffer,
+					sink_list);
+	entry->sink = list_first_item(&dev->bsink_list, struct comp_buffer,
+				      source_list);
+
+	/* a parked component has nothing to check for silence */
+	entry->parked = pipeline_sched_parked(p, entry->source);
+	if (entry->parked)
+		entry->idle = 0;
+	else if (!entry->idle && !p->ipc_pipe.pull && !p->ipc_pipe.fast_start)
+		return 0;
+
+	comp_set_period_bytes(entry->source->source, dev->frames, &frame_fmt,
+			      &entry->source_bytes);
+	comp_set_period_bytes(entry->sink->sink, dev->frames, &frame_fmt,
+			      &entry->sink_bytes);
+	if (!entry->sink_bytes)
+		entry->source_bytes = 0;
+
+	return 0;
+}
+
+/* only walk to active components in this pipeline */
+static int pipeline_sched_follow(struct pipeline_walk *walk,
+				 struct comp_dev *current,
+				 struct comp_buffer *buffer,
+				 struct comp_dev *next)
+{
+	return buffer->connected && next->state == COMP_STATE_ACTIVE &&
+		next->pipeline == current->pipeline;
+}
+
+/* upstream components are added after their sources, the same visiting
+ * order as pipeline_copy_from_upstream() */
+static int pipeline_sched_visit_upstream(struct pipeline_walk *walk,
+					 struct comp_dev *current,
+					 struct comp_buffer *buffer)
+{
+	return buffer && current->is_endpoint ? PIPELINE_WALK_PRUNE :
+		PIPELINE_WALK_CONTINUE;
+}
+
+static int pipeline_sched_leave_upstream(struct pipeline_walk *walk,
+					 struct comp_dev *current)
+{
+	return pipeline_sched_add(walk->data, current);
+}
+
+/* downstream components are added before their sinks, the same visiting
+ * order as pipeline_copy_to_downstream() */
+static int pipeline_sched_visit_downstream(struct pipeline_walk *walk,
+					   struct comp_dev *current,
+					   struct comp_buffer *buffer)
+{
+	int err;
+
+	if (!buffer)
+		return PIPELINE_WALK_CONTINUE;
+
+	err = pipeline_sched_add(walk->data, current);
+	if (err < 0)
+		return err;
+
+	return current->is_endpoint ? PIPELINE_WALK_PRUNE :
+		PIPELINE_WALK_CONTINUE;
+}
+
+/*
+ * Compile the active graph into a flat copy schedule. It is rebuilt on the
+ * next copy after a connect, disconnect, prepare, reset or trigger marks it
+ * dirty, every other period just runs the array instead of walking the
+ * buffer lists.
+ */
+static void pipeline_sched_compile(struct pipeline *p)
+{
+	struct pipeline_walk upstream = {
+		.start = p->sched_comp,
+		.dir = PIPELINE_WALK_UPSTREAM,
+		.data = p,
+		.visit = pipeline_sched_visit_upstream,
+		.leave = pipeline_sched_leave_upstream,
+		.follow = pipeline_sched_follow,
+	};
+	struct pipeline_walk downstream = {
+		.start = p->sched_comp,
+		.dir = PIPELINE_WALK_DOWNSTREAM,
+		.data = p,
+		.visit = pipeline_sched_visit_downstream,
+		.follow = pipeline_sched_follow,
+	};
+
+	p->sched_dirty = 0;
+	p->sched_count = 0;
+
+	/* any change to the graph or its state leaves idle mode */
+	p->idle_frames = 0;
+	p->idle_limit = (uint64_t)p->ipc_pipe.idle_ms *
+		p->sched_comp->params.rate / 1000;
+
+	if (pipeline_walk(&upstream) < 0 || pipeline_walk(&downstream) < 0) {
+		trace_pipe_error_with_ids(p, "pipeline_sched_compile() error: "
+					  "too many components, walking graph");
+		p->sched_count = 0;
 	}
 }
 
+/* prepare the pipeline for usage - preload host buffers here */
+int pipeline_prepare(struct pipeline *p, struct comp_dev *dev)
+{
+	struct op_data op_data;
+	int ret = -1;
+	uint32_t flags;
+
+	trace_pipe_with_ids(p, "pipeline_prepare()");
+
+	op_data.p = p;
+	op_data.op = COMP_OPS_PREPARE;
+
+	spin_lock_irq(&p->lock, flags);
+
+	/* components are prepared with their original connections */
+	pipeline_bypass_restore(dev);
+
+	/* playback pipelines can be preloaded from host before trigger */
+	ret = component_op(&op_data, dev, pipeline_walk_dir(dev));
+	if (ret < 0)
+		goto out;
+
+	/* set up reader and writer positions */
+	component_prepare_buffers(dev, pipeline_walk_dir(dev));
+
+	/* skip components with nothing to process */
+	if (dev->params.direction == SOF_IPC_STREAM_PLAYBACK)
+		component_bypass_downstream(dev, dev);
+	else
+		component_bypass_upstream(dev, dev);
+
+	/* bypass changed the connections */
+	p->sched_dirty = 1;
+
+	p->status = COMP_STATE_PREPARE;
+out:
+	spin_unlock_irq(&p->lock, flags);
+	return ret;
+}
+
 void pipeline_cache(struct pipeline *p, struct comp_dev *dev, int cmd)
 {
 	cache_command cache_cmd = comp_get_cache_command(cmd);
@@ -707,12 +1511,8 @@ void pipeline_cache(struct pipeline *p, struct comp_dev *dev, int cmd)
 
 	spin_lock_irq(&p->lock, flags);
 
-	if (dev->params.direction == SOF_IPC_STREAM_PLAYBACK)
-		/* execute cache op on components and buffers downstream */
-		component_cache_downstream(cmd, dev, dev);
-	else
-		/* execute cache op on components and buffers upstream */
-		component_cache_upstream(cmd, dev, dev);
+	/* execute cache op on components and buffers to the endpoints */
+	component_cache(dev, NULL, pipeline_walk_dir(dev), cmd);
 
 	/* execute cache operation on pipeline itself */
 	if (cache_cmd)
@@ -766,6 +1566,7 @@ int pipeline_trigger(struct pipeline *p, struct comp_dev *host, int cmd)
 {
 	struct op_data op_data;
 	int ret;
+	int err;
 	uint32_t flags;
 
 	trace_pipe_with_ids(p, "pipeline_trigger()");
@@ -780,13 +1581,15 @@ int pipeline_trigger(struct pipeline *p, struct comp_dev *host, int cmd)
 
 	spin_lock_irq(&p->lock, flags);
 
-	if (host->params.direction == SOF_IPC_STREAM_PLAYBACK) {
-		/* send cmd downstream from host to DAI */
-		ret = component_op_downstream(&op_data, host, host, NULL);
-	} else {
-		/* send cmd upstream from host to DAI */
-		ret = component_op_upstream(&op_data, host, host, NULL);
-	}
+	/* DAIs reached by the walk start together once it is done */
+	dai_group_begin();
+
+	/* send cmd from host to DAI */
+	ret = component_op(&op_data, host, pipeline_walk_dir(host));
+
+	err = dai_group_end();
+	if (err < 0 && ret >= 0)
+		ret = err;
 
 	if (ret < 0) {
 		trace_ipc_error("pipeline_trigger() error: ret = %d, host->"
@@ -798,6 +1601,97 @@ int pipeline_trigger(struct pipeline *p, struct comp_dev *host, int cmd)
 	return ret;
 }
 
+/* smallest safe size of a buffer for the components on both sides */
+static uint32_t pipeline_buffer_need(struct comp_buffer *buffer)
+{
+	struct comp_dev *source = buffer->source;
+	struct comp_dev *sink = buffer->sink;
+	struct sof_ipc_comp_config *config;
+	uint32_t periods;
+	uint32_t period;
+	uint32_t size;
+
+	/* a scheduling period of whichever side moves more data */
+	period = MAX(source->frames * comp_frame_bytes(source),
+		     sink->frames * comp_frame_bytes(sink));
+	if (!period)
+		return 0;
+
+	config = COMP_GET_CONFIG(source);
+	periods = config->periods_sink;
+	config = COMP_GET_CONFIG(sink);
+	periods = MAX(periods, config->periods_source);
+
+	size = period * MAX(periods, PIPELINE_BUFFER_MIN_PERIODS);
+
+	/* block processing components need whole blocks */
+	size = MAX(size, source->min_sink_bytes);
+	size = MAX(size, sink->min_source_bytes);
+
+	/* keep a smaller size a component has already set in params() */
+	if (buffer->size < buffer->alloc_size)
+		size = MAX(size, buffer->size);
+
+	return size;
+}
+
+/* only components not yet prepared are sized, up to the endpoints */
+static int pipeline_size_visit(struct pipeline_walk *walk,
+			       struct comp_dev *current,
+			       struct comp_buffer *buffer)
+{
+	if (current->state != COMP_STATE_READY ||
+	    (buffer && current->is_endpoint))
+		return PIPELINE_WALK_PRUNE;
+
+	return PIPELINE_WALK_CONTINUE;
+}
+
+/*
+ * Reallocate every buffer between two processing components that are not yet
+ * prepared to what they need, instead of what the topology allocated. DMA
+ * connected buffers are sized by their endpoint.
+ */
+static int pipeline_size_follow(struct pipeline_walk *walk,
+				struct comp_dev *current,
+				struct comp_buffer *buffer,
+				struct comp_dev *next)
+{
+	uint32_t set_size;
+	uint32_t size;
+	int ret;
+
+	if (!buffer->connected || next->state != COMP_STATE_READY)
+		return 0;
+
+	if (buffer->source->is_dma_connected || buffer->sink->is_dma_connected)
+		return 1;
+
+	set_size = buffer->size < buffer->alloc_size ? buffer->size : 0;
+	size = pipeline_buffer_need(buffer);
+
+	if (size && size != buffer->alloc_size) {
+		tracev_pipe("pipeline_size_follow(), id = %u, alloc_size = %u, "
+			    "size = %u", buffer->ipc_buffer.comp.id,
+			    buffer->alloc_size, size);
+
+		ret = buffer_realloc(buffer, size);
+
+		/* a failed shrink leaves a bigger buffer */
+		if (ret < 0 && size > buffer->alloc_size) {
+			trace_pipe_error("pipeline_size_follow() error: id = "
+					 "%u, size = %u",
+					 buffer->ipc_buffer.comp.id, size);
+			return ret;
+		}
+
+		if (set_size)
+			buffer_set_size(buffer, set_size);
+	}
+
+	return 1;
+}
+
 /*
  * Send pipeline component params from host to endpoints.
  * Params always start at host (PCM) and go downstream for playback and
@@ -815,7 +1709,13 @@ int pipeline_params(struct pipeline *p, struct comp_dev *host,
 	struct sof_ipc_pcm_params *params)
 {
 	struct op_data op_data;
+	struct pipeline_walk size_walk = {
+		.start = host,
+		.visit = pipeline_size_visit,
+		.follow = pipeline_size_follow,
+	};
 	int ret;
+	int err;
 	uint32_t flags;
 
 	trace_pipe_with_ids(p, "pipeline_params()");
@@ -826,13 +1726,16 @@ int pipeline_params(struct pipeline *p, struct comp_dev *host,
 	spin_lock_irq(&p->lock, flags);
 
 	host->params = params->params;
+	size_walk.dir = pipeline_walk_dir(host);
 
-	if (host->params.direction == SOF_IPC_STREAM_PLAYBACK) {
-		/* send params downstream from host to DAI */
-		ret = component_op_downstream(&op_data, host, host, NULL);
-	} else {
-		/* send params upstream from host to DAI */
-		ret = component_op_upstream(&op_data, host, host, NULL);
+	/* send params from host to DAI */
+	ret = component_op(&op_data, host, pipeline_walk_dir(host));
+
+	/* size buffers now every component on the path knows its format */
+	if (ret >= 0) {
+		err = pipeline_walk(&size_walk);
+		if (err < 0)
+			ret = err;
 	}
 
 	if (ret < 0) {
@@ -858,23 +1761,60 @@ int pipeline_reset(struct pipeline *p, struct comp_dev *host)
 
 	spin_lock_irq(&p->lock, flags);
 
-	if (host->params.direction == SOF_IPC_STREAM_PLAYBACK) {
-		/* send reset downstream from host to DAI */
-		ret = component_op_downstream(&op_data, host, host, NULL);
-	} else {
-		/* send reset upstream from host to DAI */
-		ret = component_op_upstream(&op_data, host, host, NULL);
-	}
+	/* bypassed components must be reset too */
+	pipeline_bypass_restore(host);
+
+	/* schedule was compiled for the bypassed graph */
+	p->sched_dirty = 1;
+	p->ts_dai = NULL;
+
+	/* send reset from host to DAI */
+	ret = component_op(&op_data, host, pipeline_walk_dir(host));
 
 	if (ret < 0) {
 		trace_ipc_error("pipeline_reset() error: ret = %d, host->comp."
 				"id = %u", ret, host->comp.id);
+	} else {
+		/* components dropped their arena data on reset */
+		pipeline_arena_reset(p);
 	}
 
 	spin_unlock_irq(&p->lock, flags);
 	return ret;
 }
 
+/* run component copy() op and account the time it takes */
+static inline int pipeline_comp_run(struct comp_dev *current,
+				    int (*copy)(struct comp_dev *dev))
+{
+#ifdef CONFIG_PERFORMANCE_COUNTERS
+	struct comp_perf *perf = &current->perf;
+	uint64_t start;
+	uint32_t delta;
+	int err;
+
+	start = platform_timer_get(platform_timer);
+	err = copy(current);
+	delta = platform_timer_get(platform_timer) - start;
+
+	perf->count++;
+	perf->total += delta;
+	if (delta < perf->min)
+		perf->min = delta;
+	if (delta > perf->max)
+		perf->max = delta;
+
+	return err;
+#else
+	return copy(current);
+#endif
+}
+
+static inline int pipeline_comp_copy(struct comp_dev *current)
+{
+	return pipeline_comp_run(current, current->drv->ops.copy);
+}
+
 /*
  * Upstream Copy and Process.
  *
@@ -894,8 +1834,8 @@ static int pipeline_copy_from_upstream(struct comp_dev *start,
 	struct list_item *clist;
 	int err = 0;
 
-	tracev_pipe("pipeline_copy_from_upstream(), current->comp.id = %u",
-		    current->comp.id);
+	tracehot_pipe("pipeline_copy_from_upstream(), current->comp.id = %u",
+		      current->comp.id);
 
 	/* stop going upstream if we reach an end point in this pipeline */
 	if (current->is_endpoint && current != start)
@@ -927,10 +1867,11 @@ static int pipeline_copy_from_upstream(struct comp_dev *start,
 
 copy:
 	/* we are at the upstream end point component so copy the buffers */
-	err = comp_copy(current);
+	err = pipeline_comp_copy(current);
 
 	/* return back downstream */
-	tracev_pipe("pipeline_copy_from_upstream() buffer from upstream copied");
+	tracehot_pipe("pipeline_copy_from_upstream() "
+		      "buffer from upstream copied");
 	return err;
 }
 
@@ -953,12 +1894,12 @@ static int pipeline_copy_to_downstream(struct comp_dev *start,
 	struct list_item *clist;
 	int err = 0;
 
-	tracev_pipe("pipeline_copy_to_downstream(), current->comp.id = %u",
-		    current->comp.id);
+	tracehot_pipe("pipeline_copy_to_downstream(), current->comp.id = %u",
+		      current->comp.id);
 
 	/* component copy/process to downstream */
 	if (current != start) {
-		err = comp_copy(current);
+		err = pipeline_comp_copy(current);
 
 		/* stop going downstream if we reach an end point in this pipeline */
 		if (current->is_endpoint)
@@ -991,180 +1932,232 @@ static int pipeline_copy_to_downstream(struct comp_dev *start,
 
 out:
 	/* return back upstream */
-	tracev_pipe("pipeline_copy_to_downstream() completed");
+	tracehot_pipe("pipeline_copy_to_downstream() completed");
 	return err;
 }
 
-/* walk the graph to downstream active components in any pipeline to find
- * the first active DAI and return it's timestamp.
- * TODO: consider pipeline with multiple DAIs
- */
-static int timestamp_downstream(struct comp_dev *start,
-		struct comp_dev *current, struct sof_ipc_stream_posn *posn)
+/* idle copy of a component with a silent source, its sink gets silence */
+static int pipeline_sched_copy_idle(struct pipeline_sched_entry *entry)
 {
-	struct list_item *clist;
-	int res = 0;
+	struct comp_dev *dev = entry->dev;
 
-	/* is component a DAI endpoint ? */
-	if (current != start) {
+	/* the component copy applies its events and reports xruns */
+	if (!list_is_empty(&dev->event_list) ||
+	    comp_buffer_get_avail_bytes(entry->source) < entry->source_bytes ||
+	    comp_buffer_get_free_bytes(entry->sink) < entry->sink_bytes)
+		return pipeline_comp_run(dev, entry->copy);
 
-		/* go downstream if we are not endpoint */
-		if (!current->is_endpoint)
-			goto downstream;
+	buffer_zero_bytes(entry->sink, entry->sink->w_ptr, entry->sink_bytes);
+	comp_update_buffer_produce(entry->sink, entry->sink_bytes);
+	comp_update_buffer_consume(entry->source, entry->source_bytes);
+	comp_event_advance(dev, dev->frames);
 
-		if (current->comp.type == SOF_COMP_DAI ||
-			current->comp.type == SOF_COMP_SG_DAI) {
-			platform_dai_timestamp(current, posn);
-			return 1;
-		}
-	}
+	return dev->frames;
+}
 
-downstream:
-	/* travel downstream to sink end point(s) */
-	list_for_item(clist, &current->bsink_list) {
-		struct comp_buffer *buffer;
+/* fast start copy of a component whose source has no period yet, its sink
+ * gets silence and the source is left for the host to fill
+ */
+static void pipeline_sched_copy_silence(struct pipeline_sched_entry *entry)
+{
+	if (comp_buffer_get_free_bytes(entry->sink) < entry->sink_bytes)
+		return;
 
-		buffer = container_of(clist, struct comp_buffer, source_list);
+	buffer_zero_bytes(entry->sink, entry->sink->w_ptr, entry->sink_bytes);
+	comp_update_buffer_produce(entry->sink, entry->sink_bytes);
+}
 
-		/* don't go downstream if this component is not connected */
-		if (!buffer->connected || buffer->sink->state != COMP_STATE_ACTIVE)
-			continue;
+/* the first source period of a fast start fades in from the silence */
+static int pipeline_sched_started(struct pipeline *p,
+				  struct pipeline_sched_entry *entry)
+{
+	struct comp_dev *source = entry->source->source;
 
-		/* continue downstream */
-		res = timestamp_downstream(start, buffer->sink, posn);
-		if (res == 1)
-			break;
-	}
+	if (comp_buffer_get_avail_bytes(entry->source) < entry->source_bytes)
+		return 0;
 
-	/* return back upstream */
-	return res;
+	buffer_fade_in(entry->source, entry->dev->frames,
+		       source->params.channels, source->params.frame_fmt);
+	p->start_pending = 0;
+
+	return 1;
 }
 
-/* walk the graph to upstream active components in any pipeline to find
- * the first active DAI and return it's timestamp.
- * TODO: consider pipeline with multiple DAIs
+/*
+ * Run the compiled copy schedule. Pipelines with an idle time count the
+ * periods their sources stay silent, checked at the input of the first idle
+ * capable component. Once the idle time has passed, idle capable components
+ * with silent input write silence instead of running their copy, and input
+ * that is not silent runs every component again from that period on.
+ *
+ * In pull mode the free space downstream drives the copies. A component
+ * that only processes whole periods waits, rather than xruns, until its
+ * source has a period and its sink room for one. Components that can
+ * process partial blocks run every time and take what fits in their sink.
+ *
+ * Components beyond a parked buffer, an output a switch does not route to,
+ * always write silence instead of running their copy.
+ *
+ * A fast start playback pipeline starts its DAI on silence. The first
+ * component with a source writes silence until the host delivers a period,
+ * which is then faded in over the period instead of waiting for the whole
+ * host buffer to fill before the first output.
  */
-static int timestamp_upstream(struct comp_dev *start,
-		struct comp_dev *current, struct sof_ipc_stream_posn *posn)
+static int pipeline_sched_copy(struct pipeline *p)
 {
-	struct list_item *clist;
-	int res = 0;
-
-	/* is component a DAI endpoint ? */
-	if (current != start) {
-
-		/* go downstream if we are not endpoint */
-		if (!current->is_endpoint)
-			goto upstream;
+	struct pipeline_sched_entry *entry = p->sched;
+	struct pipeline_sched_entry *end = p->sched + p->sched_count;
+	struct comp_buffer *silent = NULL;
+	int idle = p->idle_limit && p->idle_frames >= p->idle_limit;
+	int start = p->start_pending;
+	int checked = 0;
+	int active = 0;
+	int err;
 
-		if (current->comp.type == SOF_COMP_DAI ||
-			current->comp.type == SOF_COMP_SG_DAI) {
-			platform_dai_timestamp(current, posn);
-			return 1;
+	for (; entry < end; entry++) {
+		/* a fast start plays silence until the host data arrives */
+		if (start && entry->source_bytes) {
+			start = 0;
+			if (!pipeline_sched_started(p, entry)) {
+				pipeline_sched_copy_silence(entry);
+				continue;
+			}
 		}
-	}
-
-
-upstream:
-	/* travel upstream to source end point(s) */
-	list_for_item(clist, &current->bsource_list) {
-		struct comp_buffer *buffer;
-
-		buffer = container_of(clist, struct comp_buffer, sink_list);
 
-		/* don't go downstream if this component is not connected */
-		if (!buffer->connected || buffer->source->state != COMP_STATE_ACTIVE)
+		/* a pull pipeline only copies a period downstream has room for */
+		if (p->ipc_pipe.pull && entry->source_bytes &&
+		    !entry->dev->can_pull &&
+		    (comp_buffer_get_avail_bytes(entry->source) <
+		     entry->source_bytes ||
+		     comp_buffer_get_free_bytes(entry->sink) <
+		     entry->sink_bytes))
 			continue;
 
-		/* continue downstream */
-		res = timestamp_upstream(start, buffer->source, posn);
-		if (res == 1)
-			break;
+		/* an idle pipeline checks every input not known to be silent */
+		if (entry->idle && entry->source_bytes && (idle || !checked)) {
+			checked = 1;
+			if (entry->source != silent &&
+			    !buffer_is_silent(entry->source,
+					      entry->source_bytes)) {
+				active = 1;
+				idle = 0;
+			}
+		}
+
+		if (entry->parked && entry->source_bytes) {
+			err = pipeline_sched_copy_idle(entry);
+		} else if (idle && entry->idle && entry->source_bytes) {
+			err = pipeline_sched_copy_idle(entry);
+			silent = entry->sink;
+		} else {
+			err = pipeline_comp_run(entry->dev, entry->copy);
+		}
+		if (err < 0) {
+			trace_pipe_error("pipeline_sched_copy() error: "
+					 "err = %d, dev->comp.id = %u",
+					 err, entry->dev->comp.id);
+			return err;
+		}
 	}
 
-	/* return back upstream */
-	return res;
+	if (active || !checked)
+		p->idle_frames = 0;
+	else if (p->idle_frames < p->idle_limit)
+		p->idle_frames += p->sched_comp->frames;
+
+	return 0;
 }
 
-/*
- * Get the timestamps for host and first active DAI found.
+/* find the first active DAI endpoint
+ * TODO: consider pipeline with multiple DAIs
  */
-void pipeline_get_timestamp(struct pipeline *p, struct comp_dev *host,
-	struct sof_ipc_stream_posn *posn)
+static int timestamp_visit(struct pipeline_walk *walk,
+			   struct comp_dev *current,
+			   struct comp_buffer *buffer)
 {
-	platform_host_timestamp(host, posn);
+	struct comp_dev **dai = walk->data;
 
-	if (host->params.direction == SOF_IPC_STREAM_PLAYBACK) {
-		timestamp_downstream(host, host, posn);
-	} else {
-		timestamp_upstream(host, host, posn);
+	/* is component a DAI endpoint ? */
+	if (buffer && current->is_endpoint &&
+	    (current->comp.type == SOF_COMP_DAI ||
+	     current->comp.type == SOF_COMP_SG_DAI)) {
+		*dai = current;
+		return PIPELINE_WALK_STOP;
 	}
+
+	return PIPELINE_WALK_CONTINUE;
 }
 
-static void xrun(struct comp_dev *dev, void *data)
+/* only walk to connected active components */
+static int component_follow_active(struct pipeline_walk *walk,
+				   struct comp_dev *current,
+				   struct comp_buffer *buffer,
+				   struct comp_dev *next)
 {
-	struct sof_ipc_stream_posn *posn = data;
-
-	/* get host timestamps */
-	platform_host_timestamp(dev, posn);
-
-	/* send XRUN to host */
-	ipc_stream_send_xrun(dev, posn);
+	return buffer->connected && next->state == COMP_STATE_ACTIVE;
 }
 
-
-/* walk the graph downstream from start component in any pipeline and run
- * function <func> for each component of type <type> */
-static void pipeline_for_each_downstream(struct pipeline *p,
-	enum sof_comp_type type, struct comp_dev *current,
-	void (*func)(struct comp_dev *, void *), void *data)
+/* DAI timestamped with the host, the graph is only walked again once the
+ * last DAI found is no longer active */
+static struct comp_dev *pipeline_timestamp_dai(struct pipeline *p,
+					       struct comp_dev *host)
 {
-	struct list_item *clist;
-
-	if (current->comp.type == type)
-		func(current, data);
+	struct comp_dev *dai = NULL;
+	struct pipeline_walk walk = {
+		.start = host,
+		.dir = pipeline_walk_dir(host),
+		.data = &dai,
+		.visit = timestamp_visit,
+		.follow = component_follow_active,
+	};
 
-	/* travel downstream to sink end point(s) */
-	list_for_item(clist, &current->bsink_list) {
-		struct comp_buffer *buffer;
+	if (p->ts_dai && p->ts_dai->state == COMP_STATE_ACTIVE)
+		return p->ts_dai;
 
-		buffer = container_of(clist, struct comp_buffer, source_list);
+	pipeline_walk(&walk);
 
-		/* don't go downstream if this component is not connected */
-		if (!buffer->connected)
-			continue;
+	/* a host state change drops it, see pipeline_trigger_sched_comp() */
+	if (host->state == COMP_STATE_ACTIVE)
+		p->ts_dai = dai;
 
-		/* continue downstream */
-		pipeline_for_each_downstream(p, type, buffer->sink,
-			func, data);
-	}
+	return dai;
 }
 
-/* walk the graph upstream from start component in any pipeline and run
- * function <func> for each component of type <type> */
-static void pipeline_for_each_upstream(struct pipeline *p,
-	enum sof_comp_type type, struct comp_dev *current,
-	void (*func)(struct comp_dev *, void *), void *data)
+/*
+ * Get the timestamps for host and first active DAI found. Both positions and
+ * the clocks are latched together with interrupts off, so the host can relate
+ * them to each other from a single report.
+ */
+void pipeline_get_timestamp(struct pipeline *p, struct comp_dev *host,
+	struct sof_ipc_stream_posn *posn)
 {
-	struct list_item *clist;
+	struct comp_dev *dai = pipeline_timestamp_dai(p, host);
+	uint32_t flags;
 
-	if (current->comp.type == type)
-		func(current, data);
+	flags = interrupt_global_disable();
 
-	/* travel upstream to sink end point(s) */
-	list_for_item(clist, &current->bsource_list) {
-		struct comp_buffer *buffer;
+	platform_host_timestamp(host, posn);
+	if (dai)
+		platform_dai_timestamp(dai, posn);
 
-		buffer = container_of(clist, struct comp_buffer, sink_list);
+	interrupt_global_enable(flags);
+}
 
-		/* don't go downstream if this component is not connected */
-		if (!buffer->connected)
-			continue;
+/* send XRUN to each host reached */
+static int xrun_visit(struct pipeline_walk *walk, struct comp_dev *current,
+		      struct comp_buffer *buffer)
+{
+	struct sof_ipc_stream_posn *posn = walk->data;
 
-		/* continue downstream */
-		pipeline_for_each_upstream(p, type, buffer->source,
-			func, data);
+	if (current->comp.type == SOF_COMP_HOST) {
+		/* get host timestamps */
+		platform_host_timestamp(current, posn);
+
+		/* send XRUN to host */
+		ipc_stream_send_xrun(current, posn);
 	}
+
+	return PIPELINE_WALK_CONTINUE;
 }
 
 /*
@@ -1174,6 +2167,15 @@ void pipeline_xrun(struct pipeline *p, struct comp_dev *dev,
 	int32_t bytes)
 {
 	struct sof_ipc_stream_posn posn;
+	struct pipeline_walk walk = {
+		.start = dev,
+		.data = &posn,
+		.visit = xrun_visit,
+	};
+
+	/* a DMA endpoint starved or overflowed */
+	if (dev->is_dma_connected)
+		pipeline_stats_add(p, dma_stalls, 1);
 
 	/* don't flood host */
 	if (p->xrun_bytes)
@@ -1187,18 +2189,25 @@ void pipeline_xrun(struct pipeline *p, struct comp_dev *dev,
 	p->xrun_bytes = posn.xrun_size = bytes;
 	posn.xrun_comp_id = dev->comp.id;
 
-	if (dev->params.direction == SOF_IPC_STREAM_PLAYBACK) {
-		pipeline_for_each_upstream(p, SOF_COMP_HOST, dev, xrun, &posn);
-	} else {
-		pipeline_for_each_downstream(p, SOF_COMP_HOST, dev, xrun, &posn);
-	}
+	/* walk back to the hosts feeding or fed by this component */
+	walk.dir = dev->params.direction == SOF_IPC_STREAM_PLAYBACK ?
+		PIPELINE_WALK_UPSTREAM : PIPELINE_WALK_DOWNSTREAM;
+	pipeline_walk(&walk);
 }
 
 /* copy data from upstream source endpoints to downstream endpoints*/
 static int pipeline_copy(struct comp_dev *dev)
 {
+	struct pipeline *p = dev->pipeline;
 	int err;
 
+	if (dev == p->sched_comp) {
+		if (p->sched_dirty)
+			pipeline_sched_compile(p);
+		if (p->sched_count)
+			return pipeline_sched_copy(p);
+	}
+
 	err = pipeline_copy_from_upstream(dev, dev);
 	if (err < 0)
 		return err;
@@ -1210,7 +2219,98 @@ static int pipeline_copy(struct comp_dev *dev)
 	return 0;
 }
 
-/* recover the pipeline from a XRUN condition */
+/* restore one period of level in a buffer without touching DMA pointers */
+static void pipeline_xrun_level(struct comp_buffer *buffer, int dir)
+{
+	struct comp_dev *source = buffer->source;
+	struct comp_dev *sink = buffer->sink;
+	uint32_t period;
+	uint32_t level;
+
+	period = MAX(source->frames * comp_frame_bytes(source),
+		     sink->frames * comp_frame_bytes(sink));
+	period = MIN(period, buffer->size);
+
+	if (dir == SOF_IPC_STREAM_PLAYBACK) {
+		/* the producer pointer of a DMA written buffer is the DMA's */
+		if (source->is_dma_connected)
+			return;
+
+		/* insert silence for the missing data */
+		level = comp_buffer_get_avail_bytes(buffer);
+		if (level >= period)
+			return;
+
+		buffer_zero_bytes(buffer, buffer->w_ptr, period - level);
+		comp_update_buffer_produce(buffer, period - level);
+	} else {
+		/* the consumer pointer of a DMA read buffer is the DMA's */
+		if (sink->is_dma_connected)
+			return;
+
+		/* drop the oldest data to make room */
+		level = comp_buffer_get_free_bytes(buffer);
+		if (level >= period)
+			return;
+
+		comp_update_buffer_consume(buffer, period - level);
+	}
+}
+
+/* a stopped or paused component needs a full restart */
+static int pipeline_xrun_visit(struct pipeline_walk *walk,
+			       struct comp_dev *current,
+			       struct comp_buffer *buffer)
+{
+	return current->state == COMP_STATE_ACTIVE ?
+		PIPELINE_WALK_CONTINUE : -EINVAL;
+}
+
+/* restore each buffer level downstream within the pipeline */
+static int pipeline_xrun_follow(struct pipeline_walk *walk,
+				struct comp_dev *current,
+				struct comp_buffer *buffer,
+				struct comp_dev *next)
+{
+	struct pipeline *p = walk->data;
+
+	if (!buffer->connected || next->pipeline != p)
+		return 0;
+
+	pipeline_xrun_level(buffer, p->source_comp->params.direction);
+
+	return 1;
+}
+
+/*
+ * Recover the pipeline from a XRUN condition while its DMA keeps running.
+ * Playback buffers are topped up with silence and capture buffers drop
+ * their oldest data until each holds or has room for a period again.
+ */
+static int pipeline_xrun_soft_recover(struct pipeline *p)
+{
+	struct pipeline_walk walk = {
+		.start = p->source_comp,
+		.dir = PIPELINE_WALK_DOWNSTREAM,
+		.data = p,
+		.visit = pipeline_xrun_visit,
+		.follow = pipeline_xrun_follow,
+	};
+	int ret;
+
+	trace_pipe_with_ids(p, "pipeline_xrun_soft_recover(), xrun_bytes = %d",
+			    p->xrun_bytes);
+
+	ret = pipeline_walk(&walk);
+	if (ret < 0)
+		return ret;
+
+	p->xrun_bytes = 0;
+
+	return 0;
+}
+
+/* recover the pipeline from a XRUN condition with a full restart */
 static int pipeline_xrun_recover(struct pipeline *p)
 {
 	int ret;
@@ -1248,36 +2348,235 @@ static int pipeline_xrun_recover(struct pipeline *p)
 	return 0;
 }
 
+/* find whether data from pipeline source reaches pipeline sink */
+static int pipeline_feeds_visit(struct pipeline_walk *walk,
+				struct comp_dev *current,
+				struct comp_buffer *buffer)
+{
+	struct pipeline **sink = walk->data;
+
+	if (current->pipeline != *sink)
+		return PIPELINE_WALK_CONTINUE;
+
+	*sink = NULL;
+	return PIPELINE_WALK_STOP;
+}
+
+static int pipeline_feeds(struct pipeline *source, struct pipeline *sink)
+{
+	struct pipeline_walk walk = {
+		.start = source->source_comp,
+		.dir = PIPELINE_WALK_DOWNSTREAM,
+		.data = &sink,
+		.visit = pipeline_feeds_visit,
+	};
+
+	if (!walk.start)
+		return 0;
+
+	pipeline_walk(&walk);
+
+	return !sink;
+}
+
+/* run the members with a copy pending in their copy order */
+static void pipeline_group_task(void *arg)
+{
+	struct pipeline_group *g = arg;
+	struct pipeline *p;
+	uint64_t start;
+	uint64_t rtime;
+	uint32_t flags;
+	uint32_t i;
+	int run;
+
+	for (i = 0; ; i++) {
+		/* members are only set or cleared with interrupts off */
+		flags = interrupt_global_disable();
+		p = i < g->count ? g->pipes[i] : NULL;
+		run = p && p->group_pending;
+		if (run)
+			p->group_pending = 0;
+		interrupt_global_enable(flags);
+
+		if (!p)
+			break;
+		if (!run)
+			continue;
+
+		start = platform_timer_get(platform_timer);
+		pipeline_task(p);
+
+		/* members keep their own worst case for core balancing */
+		rtime = platform_timer_get(platform_timer) - start;
+		if (rtime > p->pipe_task.max_rtime)
+			p->pipe_task.max_rtime = rtime;
+	}
+}
+
+/*
+ * Active pipelines with the same core, period and priority share one task,
+ * so copies requested together take a single scheduler pass however many
+ * pipelines ask for them. A pipeline runs before the members it feeds, e.g.
+ * through a mixer, and after the ones feeding it. Pipelines that don't fit
+ * in a group keep using their own task.
+ */
+static void pipeline_group_join(struct pipeline *p)
+{
+	struct pipeline_group *groups = pipeline_groups[p->ipc_pipe.core];
+	struct pipeline_group *g = NULL;
+	uint32_t flags;
+	uint32_t pos;
+	uint32_t i;
+
+	if (p->group)
+		return;
+
+	for (i = 0; i < PIPELINE_GROUPS; i++) {
+		if (groups[i].count &&
+		    groups[i].deadline == p->ipc_pipe.deadline &&
+		    groups[i].task.priority == p->ipc_pipe.priority) {
+			g = &groups[i];
+			break;
+		}
+
+		if (!groups[i].count && !g)
+			g = &groups[i];
+	}
+
+	if (!g || g->count == PIPELINE_GROUP_MAX_PIPES) {
+		trace_pipe_with_ids(p, "pipeline_group_join(): no group");
+		return;
+	}
+
+	if (!g->count) {
+		schedule_task_init(&g->task, pipeline_group_task, g);
+		schedule_task_config(&g->task, p->ipc_pipe.priority,
+				     p->ipc_pipe.core);
+		g->deadline = p->ipc_pipe.deadline;
+	}
+
+	for (pos = 0; pos < g->count; pos++) {
+		if (pipeline_feeds(p, g->pipes[pos]))
+			break;
+	}
+
+	flags = interrupt_global_disable();
+	for (i = g->count; i > pos; i--)
+		g->pipes[i] = g->pipes[i - 1];
+	g->pipes[pos] = p;
+	g->count++;
+	p->group = g;
+	p->group_pending = 0;
+	interrupt_global_enable(flags);
+
+	trace_pipe_with_ids(p, "pipeline_group_join(): period %u position %u "
+			    "of %u", g->deadline, pos, g->count);
+}
+
+static void pipeline_group_leave(struct pipeline *p)
+{
+	struct pipeline_group *g = p->group;
+	uint32_t flags;
+	uint32_t i;
+
+	if (!g)
+		return;
+
+	flags = interrupt_global_disable();
+	for (i = 0; g->pipes[i] != p; i++)
+		;
+	for (; i + 1 < g->count; i++)
+		g->pipes[i] = g->pipes[i + 1];
+	g->count--;
+	p->group = NULL;
+	p->group_pending = 0;
+	interrupt_global_enable(flags);
+
+	/* copies pending for the other members still run */
+	if (!g->count)
+		schedule_task_cancel(&g->task);
+}
+
+/* queue the pipeline task, or its group task with the copy marked */
+static void pipeline_schedule_task(struct pipeline *p, uint64_t start)
+{
+	struct pipeline_group *g = p->group;
+
+	if (!g) {
+		schedule_task(&p->pipe_task, start, p->ipc_pipe.deadline);
+		return;
+	}
+
+	p->group_pending = 1;
+	schedule_task(&g->task, start, g->deadline);
+}
+
 /* notify pipeline that this component requires buffers emptied/filled */
 void pipeline_schedule_copy(struct pipeline *p, uint64_t start)
 {
+	/* timer driven pipelines count the period for their task */
+	if (p->ipc_pipe.timer_delay) {
+		pipeline_schedule_periods(p, 1);
+		return;
+	}
+
 	if (p->sched_comp->state == COMP_STATE_ACTIVE) {
-		/* timer driven pipeline should execute task synchronously */
-		if (p->ipc_pipe.timer_delay) {
-			tracev_pipe_with_ids(p, "pipeline_schedule_copy(): "
-					     "copy synchronously");
-			pipeline_copy(p->sched_comp);
-		} else {
-			tracev_pipe_with_ids(p, "pipeline_schedule_copy(): "
-					     "scheduled pipeline task");
-			schedule_task(&p->pipe_task, start,
-				      p->ipc_pipe.deadline);
-		}
+		tracehot_pipe_with_ids(p, "pipeline_schedule_copy(): "
+				       "scheduled pipeline task");
+		pipeline_schedule_task(p, start);
 	}
 }
 
+/*
+ * Timer driven DMA is polled on the shared system work queue tick and
+ * reports every whole period the hardware moved since the last poll. The
+ * pipeline task copies exactly that many periods, so the pipeline follows
+ * the DAI position however the tick drifts against the DAI clock.
+ */
+void pipeline_schedule_periods(struct pipeline *p, uint32_t periods)
+{
+	uint32_t flags;
+
+	if (p->sched_comp->state != COMP_STATE_ACTIVE || !periods)
+		return;
+
+	/* more than a batch behind is left to xrun recovery, the count is
+	 * shared with the task on this core only
+	 */
+	flags = interrupt_global_disable();
+	p->timer_periods = MIN(p->timer_periods + periods,
+			       PIPELINE_MAX_PERIODS_PER_SCHED);
+	interrupt_global_enable(flags);
+
+	tracehot_pipe_with_ids(p, "pipeline_schedule_periods(): "
+			       "%u periods pending", p->timer_periods);
+	pipeline_schedule_task(p, 0);
+}
+
 /* notify pipeline that this component requires buffers emptied/filled
  * when DSP is next idle. This is intended to be used to preload pipeline
  * buffers prior to trigger start. */
 void pipeline_schedule_copy_idle(struct pipeline *p)
 {
-	schedule_task_idle(&p->pipe_task, p->ipc_pipe.deadline);
+	struct pipeline_group *g = p->group;
+
+	if (!g) {
+		schedule_task_idle(&p->pipe_task, p->ipc_pipe.deadline);
+		return;
+	}
+
+	p->group_pending = 1;
+	schedule_task_idle(&g->task, g->deadline);
 }
 
 void pipeline_schedule_cancel(struct pipeline *p)
 {
 	int err;
 
+	/* the group task is only cancelled with its last member */
+	pipeline_group_leave(p);
+
 	/* cancel and wait for pipeline to complete */
 	err = schedule_task_cancel(&p->pipe_task);
 	if (err < 0)
@@ -1286,29 +2585,173 @@ void pipeline_schedule_cancel(struct pipeline *p)
 					  "= %d", err);
 }
 
+#ifdef CONFIG_PIPELINE_CORE_BALANCE
+uint32_t pipeline_load(struct pipeline *p)
+{
+	uint64_t period;
+
+	/* deadline is the pipeline scheduling period in microseconds */
+	period = clock_ms_to_ticks(PLATFORM_SCHED_CLOCK, 1) *
+		p->ipc_pipe.deadline / 1000;
+	if (!period)
+		return 0;
+
+	return p->pipe_task.max_rtime * 1000 / period;
+}
+#endif
+
+#ifdef CONFIG_STREAM_STATS
+/* collect the buffers of this pipeline the stats record follows */
+static int pipeline_stats_follow(struct pipeline_walk *walk,
+				 struct comp_dev *current,
+				 struct comp_buffer *buffer,
+				 struct comp_dev *next)
+{
+	struct pipeline *p = walk->data;
+	struct sof_ipc_stream_stats *stats = &p->stats;
+	uint32_t i = stats->num_buffers;
+
+	if (!buffer->connected || next->pipeline != p)
+		return 0;
+
+	if (i < SOF_IPC_STREAM_STATS_BUFFERS) {
+		p->stats_buffer[i] = buffer;
+		stats->buffer[i].buffer_id = buffer->ipc_buffer.comp.id;
+		stats->buffer[i].min_avail = buffer->size;
+		stats->num_buffers++;
+	}
+
+	return 1;
+}
+
+/* copy the record to the stream region, seq is odd until it is complete */
+static void pipeline_stats_write(struct pipeline *p)
+{
+	struct sof_ipc_stream_stats *stats = &p->stats;
+
+	stats->seq++;
+	mailbox_stream_write(p->stats_offset, stats, sizeof(*stats));
+	stats->seq++;
+	mailbox_stream_write(p->stats_offset +
+			     offsetof(struct sof_ipc_stream_stats, seq),
+			     &stats->seq, sizeof(stats->seq));
+}
+
+void pipeline_stats_init(struct pipeline *p, struct comp_dev *host,
+			 uint32_t offset)
+{
+	struct pipeline_walk walk = {
+		.start = host,
+		.dir = pipeline_walk_dir(host),
+		.data = p,
+		.follow = pipeline_stats_follow,
+	};
+
+	memset(&p->stats, 0, sizeof(p->stats));
+	p->stats.comp_id = host->comp.id;
+	p->stats_offset = offset;
+
+	pipeline_walk(&walk);
+	pipeline_stats_write(p);
+}
+
+/* account one pipeline task run and publish the record */
+static void pipeline_stats_update(struct pipeline *p, uint64_t start)
+{
+	struct sof_ipc_stream_stats *stats = &p->stats;
+	struct sof_ipc_stream_stats_buffer *entry;
+	uint32_t avail;
+	uint32_t i;
+
+	if (!p->stats_offset)
+		return;
+
+	stats->task_last_us = (platform_timer_get(platform_timer) - start) *
+		1000 / clock_ms_to_ticks(PLATFORM_SCHED_CLOCK, 1);
+	if (stats->task_last_us > stats->task_max_us)
+		stats->task_max_us = stats->task_last_us;
+
+	for (i = 0; i < stats->num_buffers; i++) {
+		entry = &stats->buffer[i];
+		avail = comp_buffer_get_avail_bytes(p->stats_buffer[i]);
+		if (avail < entry->min_avail)
+			entry->min_avail = avail;
+		if (avail > entry->max_avail)
+			entry->max_avail = avail;
+	}
+
+	pipeline_stats_write(p);
+}
+#endif
+
+/* take the periods a timer driven pipeline has to copy, at least one */
+static uint32_t pipeline_task_periods(struct pipeline *p)
+{
+	uint32_t periods;
+	uint32_t flags;
+
+	flags = interrupt_global_disable();
+	periods = MAX(p->timer_periods, 1);
+	p->timer_periods = 0;
+	interrupt_global_enable(flags);
+
+	return periods;
+}
+
 static void pipeline_task(void *arg)
 {
 	struct pipeline *p = arg;
 	struct comp_dev *dev = p->sched_comp;
+	uint32_t periods = pipeline_task_periods(p);
+	uint32_t i;
 	int err;
+#if defined(CONFIG_CLOCK_GOVERNOR) || defined(CONFIG_STREAM_STATS)
+	uint64_t start = platform_timer_get(platform_timer);
+#endif
 
-	tracev_pipe_with_ids(p, "pipeline_task()");
+	tracehot_pipe_with_ids(p, "pipeline_task()");
 
 	/* are we in xrun ? */
 	if (p->xrun_bytes) {
-		err = pipeline_xrun_recover(p);
+		pipeline_stats_add(p, xruns, 1);
+		err = pipeline_xrun_soft_recover(p);
+		if (err < 0)
+			err = pipeline_xrun_recover(p);
 		if (err < 0)
 			return; /* failed - host will stop this pipeline */
 		goto sched;
 	}
 
-	err = pipeline_copy(dev);
-	if (err < 0) {
-		err = pipeline_xrun_recover(p);
-		if (err < 0)
-			return; /* failed - host will stop this pipeline */
+	for (i = 0; i < periods; i++) {
+		err = pipeline_copy(dev);
+		if (err < 0) {
+			pipeline_stats_add(p, xruns, 1);
+
+			/* only an xrun can recover without restarting the DMA */
+			if (err != -EIO || pipeline_xrun_soft_recover(p) < 0) {
+				err = pipeline_xrun_recover(p);
+				if (err < 0)
+					return; /* host stops the pipeline */
+			}
+			goto sched;
+		}
+
+		pipeline_stats_add(p, frames, dev->frames);
 	}
 
 sched:
-	tracev_pipe_with_ids(p, "pipeline_task() reschedule");
+#ifdef CONFIG_CLOCK_GOVERNOR
+	/* deadline is the pipeline scheduling period in microseconds */
+	clock_gov_account(platform_timer_get(platform_timer) - start,
+			  clock_ms_to_ticks(PLATFORM_SCHED_CLOCK, 1) *
+			  p->ipc_pipe.deadline / 1000 * periods);
+#endif
+#ifdef CONFIG_STREAM_STATS
+	pipeline_stats_update(p, start);
+#endif
+	/* no DMA interrupt schedules a polled pipeline, run again next period */
+	if (p->polled && dev->state == COMP_STATE_ACTIVE)
+		pipeline_schedule_task(p, p->ipc_pipe.deadline);
+
+	tracehot_pipe_with_ids(p, "pipeline_task() reschedule");
 }
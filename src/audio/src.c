@@ -41,6 +41,7 @@
 #include <sof/work.h>
 #include <sof/clk.h>
 #include <sof/ipc.h>
+#include <sof/cache_lock.h>
 #include <sof/audio/component.h>
 #include <sof/audio/pipeline.h>
 #include <sof/math/numbers.h>
@@ -74,6 +75,9 @@ struct comp_data {
 	struct polyphase_src src;
 	struct src_param param;
 	int32_t *delay_lines;
+	size_t delay_lines_size;	/* allocated bytes in pipeline arena */
+	struct comp_dirty delay_dirty;	/* delay lines written since writeback */
+	const struct src_stage *locked[2];	/* stages with locked coefs */
 	uint32_t sink_rate;
 	uint32_t source_rate;
 	int32_t *sbuf_w_ptr;
@@ -87,6 +91,8 @@ struct comp_data {
 			 int *consumed,
 			 int *produced);
 	void (*polyphase_func)(struct src_stage_prm *s);
+	void (*polyphase_filter)(struct src_stage_prm *s); /* when not silent */
+	struct comp_silence silence;	/* skip filters on decayed silence */
 };
 
 /* Calculates the needed FIR delay line length */
@@ -336,6 +342,179 @@ int src_polyphase_init(struct polyphase_src *src, struct src_param *p,
 	return n_stages;
 }
 
+#if SRC_SHORT
+#define SRC_COEF_BYTES	sizeof(int16_t)
+#else
+#define SRC_COEF_BYTES	sizeof(int32_t)
+#endif
+
+#ifdef CONFIG_SRC_COEF_CACHE
+
+/* run-time copy of SRC stage coefficients shared by all instances that
+ * use the same conversion stage
+ */
+struct src_coef_cache {
+	struct src_stage stage;		/* stage with shared coefficients */
+	struct src_stage *table;	/* stage in the coefficient table */
+	uint32_t refs;			/* number of users */
+	struct list_item list;		/* list in src_coef_list */
+};
+
+static struct list_item src_coef_list;
+static spinlock_t src_coef_lock;
+
+/* Returns a shared stage using coefficients in run-time memory. The table
+ * stage is returned if the coefficients cannot be copied.
+ */
+static struct src_stage *src_coef_get(struct src_stage *table)
+{
+	struct src_coef_cache *cache;
+	struct list_item *clist;
+	size_t bytes = table->filter_length * SRC_COEF_BYTES;
+	void *coefs;
+
+	/* single tap and deleted modes have nothing worth sharing */
+	if (table->filter_length <= 1)
+		return table;
+
+	spin_lock(&src_coef_lock);
+
+	list_for_item(clist, &src_coef_list) {
+		cache = container_of(clist, struct src_coef_cache, list);
+		if (cache->table == table) {
+			cache->refs++;
+			spin_unlock(&src_coef_lock);
+			return &cache->stage;
+		}
+	}
+
+	cache = rzalloc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM, sizeof(*cache));
+	if (!cache)
+		goto out;
+
+	coefs = rballoc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM, bytes);
+	if (!coefs) {
+		rfree(cache);
+		goto out;
+	}
+
+	memcpy(coefs, table->coefs, bytes);
+	memcpy(&cache->stage, table, sizeof(*table));
+	cache->stage.coefs = coefs;
+	cache->table = table;
+	cache->refs = 1;
+	list_item_append(&cache->list, &src_coef_list);
+
+	trace_src("src_coef_get(), cached %u bytes", bytes);
+
+	spin_unlock(&src_coef_lock);
+	return &cache->stage;
+
+out:
+	/* instance can still run with the table coefficients */
+	spin_unlock(&src_coef_lock);
+	trace_src_error("src_coef_get() error: failed to cache %u bytes",
+			bytes);
+	return table;
+}
+
+/* Drops a reference to a shared stage, table stages are ignored */
+static void src_coef_put(struct src_stage *stage)
+{
+	struct src_coef_cache *cache;
+	struct list_item *clist;
+
+	if (!stage)
+		return;
+
+	spin_lock(&src_coef_lock);
+
+	list_for_item(clist, &src_coef_list) {
+		cache = container_of(clist, struct src_coef_cache, list);
+		if (&cache->stage != stage)
+			continue;
+
+		if (--cache->refs == 0) {
+			list_item_del(&cache->list);
+			rfree((void *)cache->stage.coefs);
+			rfree(cache);
+		}
+		break;
+	}
+
+	spin_unlock(&src_coef_lock);
+}
+
+/* Moves the stages of an initialized SRC to the shared coefficients */
+static void src_coef_share(struct polyphase_src *src)
+{
+	src->stage1 = src_coef_get(src->stage1);
+	src->stage2 = src_coef_get(src->stage2);
+}
+
+/* Releases the shared coefficients of an SRC */
+static void src_coef_release(struct polyphase_src *src)
+{
+	src_coef_put(src->stage1);
+	src_coef_put(src->stage2);
+	src->stage1 = NULL;
+	src->stage2 = NULL;
+}
+
+#else
+
+static inline void src_coef_share(struct polyphase_src *src) { }
+static inline void src_coef_release(struct polyphase_src *src) { }
+
+#endif /* CONFIG_SRC_COEF_CACHE */
+
+#ifdef CONFIG_CACHE_LOCK
+
+/* Locks the coefficients of both stages into the data cache */
+static void src_coef_lock(struct comp_data *cd)
+{
+	const struct src_stage *stage[2] = { cd->src.stage1, cd->src.stage2 };
+	int i;
+
+	for (i = 0; i < 2; i++) {
+		if (!stage[i] || cd->locked[i])
+			continue;
+
+		/* runs unlocked if the cache sets are taken */
+		if (cache_lock_data((void *)stage[i]->coefs,
+				    stage[i]->filter_length *
+				    SRC_COEF_BYTES) < 0) {
+			trace_src("src_coef_lock(), stage %d not locked", i);
+			continue;
+		}
+
+		cd->locked[i] = stage[i];
+	}
+}
+
+/* Unlocks the coefficients, must be called before the stages change */
+static void src_coef_unlock(struct comp_data *cd)
+{
+	int i;
+
+	for (i = 0; i < 2; i++) {
+		if (!cd->locked[i])
+			continue;
+
+		cache_unlock_data((void *)cd->locked[i]->coefs,
+				  cd->locked[i]->filter_length *
+				  SRC_COEF_BYTES);
+		cd->locked[i] = NULL;
+	}
+}
+
+#else
+
+static inline void src_coef_lock(struct comp_data *cd) { }
+static inline void src_coef_unlock(struct comp_data *cd) { }
+
+#endif /* CONFIG_CACHE_LOCK */
+
 /* Fallback function */
 static void src_fallback(struct comp_dev *dev, struct comp_buffer *source,
 			 struct comp_buffer *sink, int *n_read, int *n_written)
@@ -344,28 +523,32 @@ static void src_fallback(struct comp_dev *dev, struct comp_buffer *source,
 	*n_written = 0;
 }
 
-/* Normal 2 stage SRC */
+/* Normal 2 stage SRC. The stages are interleaved one 1st stage block at a
+ * time so that the 2nd stage consumes the intermediate samples while they
+ * are still in cache instead of after a whole period has been buffered.
+ */
 static void src_2s(struct comp_dev *dev,
 		   struct comp_buffer *source, struct comp_buffer *sink,
 		   int *n_read, int *n_written)
 {
 	struct src_stage_prm s1;
 	struct src_stage_prm s2;
-	int s1_blk_in;
-	int s1_blk_out;
-	int s2_blk_in;
-	int s2_blk_out;
 	struct comp_data *cd = comp_get_drvdata(dev);
 	void *sbuf_addr = cd->delay_lines;
 	void *sbuf_end_addr = &cd->delay_lines[cd->param.sbuf_length];
 	size_t sbuf_size = cd->param.sbuf_length * sizeof(int32_t);
 	int nch = dev->params.channels;
 	int sbuf_free = cd->param.sbuf_length - cd->sbuf_avail;
+	int sz = dev->params.sample_container_bytes;
+	int s1_blk_in = cd->src.stage1->blk_in * nch * sz;
+	int s1_blk_out = cd->src.stage1->blk_out * nch;
+	int s2_blk_in = cd->src.stage2->blk_in * nch;
+	int s2_blk_out = cd->src.stage2->blk_out * nch * sz;
+	int avail_b = comp_buffer_get_avail_bytes(source);
+	int free_b = comp_buffer_get_free_bytes(sink);
 	int n1 = 0;
 	int n2 = 0;
-	int avail_b = source->avail;
-	int free_b = sink->free;
-	int sz = dev->params.sample_container_bytes;
+	int s1_run;
 
 	*n_read = 0;
 	*n_written = 0;
@@ -380,6 +563,7 @@ static void src_2s(struct comp_dev *dev,
 	s1.y_wptr = cd->sbuf_w_ptr;
 	s1.nch = nch;
 	s1.shift = cd->data_shift;
+	s1.times = 1;
 
 	s2.x_end_addr = sbuf_end_addr;
 	s2.x_size = sbuf_size;
@@ -393,69 +577,37 @@ static void src_2s(struct comp_dev *dev,
 	s2.nch = nch;
 	s2.shift = cd->data_shift;
 
-	/* Test if 1st stage can be run with default block length to reach
-	 * the period length or just under it.
-	 */
-	s1.times = cd->param.stage1_times;
-	s1_blk_in = s1.times * cd->src.stage1->blk_in * nch;
-	s1_blk_out = s1.times * cd->src.stage1->blk_out * nch;
-	if (avail_b >= s1_blk_in * sz && sbuf_free >= s1_blk_out) {
-		cd->polyphase_func(&s1);
+	do {
+		/* Run one 1st stage block if input and stage buffer allow */
+		s1_run = n1 < cd->param.stage1_times_max &&
+			avail_b >= s1_blk_in && sbuf_free >= s1_blk_out;
+		if (s1_run) {
+			cd->polyphase_func(&s1);
+
+			cd->sbuf_avail += s1_blk_out;
+			*n_read += cd->src.stage1->blk_in;
+			avail_b -= s1_blk_in;
+			sbuf_free -= s1_blk_out;
+			n1++;
+		}
 
-		cd->sbuf_w_ptr = s1.y_wptr;
-		cd->sbuf_avail += s1_blk_out;
-		*n_read += s1.times * cd->src.stage1->blk_in;
-		avail_b -= s1_blk_in * sz;
-		sbuf_free -= s1_blk_out;
-		n1 = s1.times;
-	}
+		/* Drain every complete 2nd stage block now available */
+		s2.times = MIN(cd->sbuf_avail / s2_blk_in,
+			       free_b / s2_blk_out);
+		s2.times = MIN(s2.times, cd->param.stage2_times_max - n2);
+		if (s2.times > 0) {
+			cd->polyphase_func(&s2);
+
+			cd->sbuf_avail -= s2.times * s2_blk_in;
+			sbuf_free += s2.times * s2_blk_in;
+			free_b -= s2.times * s2_blk_out;
+			*n_written += s2.times * cd->src.stage2->blk_out;
+			n2 += s2.times;
+		}
+	} while (s1_run);
 
-	/* Run one block at time the remaining data for 1st stage. */
-	s1.times = 1;
-	s1_blk_in = cd->src.stage1->blk_in * nch;
-	s1_blk_out = cd->src.stage1->blk_out * nch;
-	while (n1 < cd->param.stage1_times_max &&
-	       avail_b >= s1_blk_in * sz &&
-	       sbuf_free >= s1_blk_out) {
-		cd->polyphase_func(&s1);
-
-		cd->sbuf_w_ptr = s1.y_wptr;
-		cd->sbuf_avail += s1_blk_out;
-		*n_read += cd->src.stage1->blk_in;
-		avail_b -= s1_blk_in * sz;
-		sbuf_free -= s1_blk_out;
-		n1 += s1.times;
-	}
-
-	/* Test if 2nd stage can be run with default block length. */
-	s2.times = cd->param.stage2_times;
-	s2_blk_in = s2.times * cd->src.stage2->blk_in * nch;
-	s2_blk_out = s2.times * cd->src.stage2->blk_out * nch;
-	if (cd->sbuf_avail >= s2_blk_in && free_b >= s2_blk_out * sz) {
-		cd->polyphase_func(&s2);
-
-		cd->sbuf_r_ptr = s2.x_rptr;
-		cd->sbuf_avail -= s2_blk_in;
-		free_b -= s2_blk_out * sz;
-		*n_written += s2.times * cd->src.stage2->blk_out;
-		n2 = s2.times;
-	}
-
-	/* Run one block at time the remaining 2nd stage output */
-	s2.times = 1;
-	s2_blk_in = cd->src.stage2->blk_in * nch;
-	s2_blk_out = cd->src.stage2->blk_out * nch;
-	while (n2 < cd->param.stage2_times_max &&
-	       cd->sbuf_avail >= s2_blk_in &&
-	       free_b >= s2_blk_out * sz) {
-		cd->polyphase_func(&s2);
-
-		cd->sbuf_r_ptr = s2.x_rptr;
-		cd->sbuf_avail -= s2_blk_in;
-		free_b -= s2_blk_out * sz;
-		*n_written += cd->src.stage2->blk_out;
-		n2 += s2.times;
-	}
+	cd->sbuf_w_ptr = s1.y_wptr;
+	cd->sbuf_r_ptr = s2.x_rptr;
 }
 
 /* 1 stage SRC for simple conversions */
@@ -484,6 +636,43 @@ static void src_1s(struct comp_dev *dev,
 	*n_written = cd->param.blk_out;
 }
 
+/* Stage run while decayed silence comes in, advances the input and writes
+ * the zeros the filter would produce.
+ */
+static void src_zero_stage(struct src_stage_prm *s, size_t sample_bytes)
+{
+	size_t in = s->times * s->stage->blk_in * s->nch * sample_bytes;
+	size_t out = s->times * s->stage->blk_out * s->nch * sample_bytes;
+	uint8_t *x = (uint8_t *)s->x_rptr + in;
+	uint8_t *y = s->y_wptr;
+	size_t n;
+
+	if (x >= (uint8_t *)s->x_end_addr)
+		x -= s->x_size;
+
+	while (out) {
+		n = MIN(out, (size_t)((uint8_t *)s->y_end_addr - y));
+		memset(y, 0, n);
+		out -= n;
+		y += n;
+		if (y >= (uint8_t *)s->y_end_addr)
+			y -= s->y_size;
+	}
+
+	s->x_rptr = x;
+	s->y_wptr = y;
+}
+
+static void src_zero_stage_s16(struct src_stage_prm *s)
+{
+	src_zero_stage(s, sizeof(int16_t));
+}
+
+static void src_zero_stage_s32(struct src_stage_prm *s)
+{
+	src_zero_stage(s, sizeof(int32_t));
+}
+
 /* A fast copy function for same in and out rate */
 static void src_copy_s32(struct comp_dev *dev,
 			 struct comp_buffer *source, struct comp_buffer *sink,
@@ -495,26 +684,18 @@ static void src_copy_s32(struct comp_dev *dev,
 	int nch = dev->params.channels;
 	int frames = cd->param.blk_in;
 	int n;
-	int n_wrap_src;
-	int n_wrap_snk;
-	int n_wrap_min;
 	int n_copy;
 
 	n = frames * nch;
 	while (n > 0) {
-		n_wrap_src = (int32_t *)source->end_addr - src;
-		n_wrap_snk = (int32_t *)sink->end_addr - snk;
-		n_wrap_min = (n_wrap_src < n_wrap_snk) ?
-			n_wrap_src : n_wrap_snk;
-		n_copy = (n < n_wrap_min) ? n : n_wrap_min;
+		n_copy = buffer_segment_samples(source, src, sizeof(int32_t),
+						sink, snk, sizeof(int32_t), n);
 		memcpy(snk, src, n_copy * sizeof(int32_t));
 
 		/* Update and check both source and destination for wrap */
 		n -= n_copy;
-		src += n_copy;
-		snk += n_copy;
-		src_inc_wrap(&src, source->end_addr, source->size);
-		src_inc_wrap(&snk, sink->end_addr, sink->size);
+		src = buffer_wrap(source, src + n_copy);
+		snk = buffer_wrap(sink, snk + n_copy);
 	}
 	*n_read = frames;
 	*n_written = frames;
@@ -530,26 +711,18 @@ static void src_copy_s16(struct comp_dev *dev,
 	int nch = dev->params.channels;
 	int frames = cd->param.blk_in;
 	int n;
-	int n_wrap_src;
-	int n_wrap_snk;
-	int n_wrap_min;
 	int n_copy;
 
 	n = frames * nch;
 	while (n > 0) {
-		n_wrap_src = (int16_t *)source->end_addr - src;
-		n_wrap_snk = (int16_t *)sink->end_addr - snk;
-		n_wrap_min = (n_wrap_src < n_wrap_snk) ?
-			n_wrap_src : n_wrap_snk;
-		n_copy = (n < n_wrap_min) ? n : n_wrap_min;
+		n_copy = buffer_segment_samples(source, src, sizeof(int16_t),
+						sink, snk, sizeof(int16_t), n);
 		memcpy(snk, src, n_copy * sizeof(int16_t));
 
 		/* Update and check both source and destination for wrap */
 		n -= n_copy;
-		src += n_copy;
-		snk += n_copy;
-		src_inc_wrap_s16(&src, source->end_addr, source->size);
-		src_inc_wrap_s16(&snk, sink->end_addr, sink->size);
+		src = buffer_wrap(source, src + n_copy);
+		snk = buffer_wrap(sink, snk + n_copy);
 	}
 	*n_read = frames;
 	*n_written = frames;
@@ -597,6 +770,7 @@ static struct comp_dev *src_new(struct sof_ipc_comp *comp)
 	cd->polyphase_func = src_polyphase_stage_cir;
 	src_polyphase_reset(&cd->src);
 
+	dev->can_pull = 1;
 	dev->state = COMP_STATE_READY;
 	return dev;
 }
@@ -607,10 +781,9 @@ static void src_free(struct comp_dev *dev)
 
 	trace_src("src_free()");
 
-	/* Free dynamically reserved buffers for SRC algorithm */
-	if (!cd->delay_lines)
-		rfree(cd->delay_lines);
-
+	/* delay lines are owned by the pipeline arena */
+	src_coef_unlock(cd);
+	src_coef_release(&cd->src);
 	rfree(cd);
 	rfree(dev);
 }
@@ -623,6 +796,7 @@ static int src_params(struct comp_dev *dev)
 	struct comp_data *cd = comp_get_drvdata(dev);
 	size_t delay_lines_size;
 	int32_t *buffer_start;
+	uint32_t frame_bytes;
 	int n = 0;
 	int err;
 	int frames_is_for_source;
@@ -671,25 +845,33 @@ static int src_params(struct comp_dev *dev)
 		return -EINVAL;
 	}
 
-	/* free any existing delay lines. TODO reuse if same size */
-	if (!cd->delay_lines)
-		rfree(cd->delay_lines);
-
-	cd->delay_lines = rballoc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM,
-				  delay_lines_size);
-	if (!cd->delay_lines) {
-		trace_src_error("src_params() error: "
-				"failed to alloc cd->delay_lines, "
-				"delay_lines_size = %u", delay_lines_size);
-		return -EINVAL;
+	/* reuse existing delay lines if they are big enough */
+	if (!cd->delay_lines || cd->delay_lines_size < delay_lines_size) {
+		cd->delay_lines = pipeline_arena_alloc(dev->pipeline,
+						       delay_lines_size);
+		if (!cd->delay_lines) {
+			trace_src_error("src_params() error: "
+					"failed to alloc cd->delay_lines, "
+					"delay_lines_size = %u",
+					delay_lines_size);
+			cd->delay_lines_size = 0;
+			return -EINVAL;
+		}
+		cd->delay_lines_size = delay_lines_size;
 	}
 
 	/* Clear all delay lines here */
 	memset(cd->delay_lines, 0, delay_lines_size);
+	comp_dirty_clear(&cd->delay_dirty);
+	comp_dirty_mark(&cd->delay_dirty, cd->delay_lines, delay_lines_size);
 	buffer_start = cd->delay_lines + cd->param.sbuf_length;
 
 	/* Initialize SRC for actual sample rate */
+	src_coef_unlock(cd);
+	src_coef_release(&cd->src);
 	n = src_polyphase_init(&cd->src, &cd->param, buffer_start);
+	if (n > 0)
+		src_coef_share(&cd->src);
 
 	/* Reset stage buffer */
 	cd->sbuf_r_ptr = cd->delay_lines;
@@ -718,6 +900,13 @@ static int src_params(struct comp_dev *dev)
 		return -EINVAL;
 	}
 
+	/* buffer needs for the pipeline sizing pass, see src_prepare() */
+	frame_bytes = params->sample_container_bytes * params->channels;
+	dev->min_sink_bytes = (ceil_divide(cd->param.blk_out,
+					   (int)dev->frames) + 1) *
+		dev->frames * frame_bytes;
+	dev->min_source_bytes = cd->param.blk_in * frame_bytes;
+
 	return 0;
 }
 
@@ -759,6 +948,7 @@ static int src_copy(struct comp_dev *dev)
 	int need_sink;
 	int consumed = 0;
 	int produced = 0;
+	bool skipped;
 
 	tracev_src("src_copy()");
 
@@ -772,9 +962,11 @@ static int src_copy(struct comp_dev *dev)
 	 * with sufficient amount of zeros if the min. output block length
 	 * is too short. It prevents xrun for the downstream component. In
 	 * successive copy executions the block length will jitter around the
-	 * nominal period length and xruns won't happen.
+	 * nominal period length and xruns won't happen. In pull mode the
+	 * downstream components wait for a full period instead.
 	 */
-	if (cd->prefill && sink->free >= cd->prefill) {
+	if (cd->prefill && !dev->pull &&
+	    comp_buffer_get_free_bytes(sink) >= cd->prefill) {
 		tracev_src("src_copy(), need to "
 			   "pre-fill buffer, cd->prefill = %u", cd->prefill);
 		comp_update_buffer_produce(sink, cd->prefill);
@@ -793,20 +985,51 @@ static int src_copy(struct comp_dev *dev)
 
 	/* make sure source component buffer has enough data available and that
 	 * the sink component buffer has enough free bytes for copy. Also
-	 * check for XRUNs.
+	 * check for XRUNs. In pull mode the 2 stage SRC runs the blocks that
+	 * fit and the others wait for a whole run.
 	 */
-	if (source->avail < need_source) {
-		trace_src_error("src_copy() error: source component buffer "
-				"has not enough data available");
-		return -EIO; /* xrun */
+	if (dev->pull && (comp_buffer_get_avail_bytes(source) < need_source ||
+			  comp_buffer_get_free_bytes(sink) < need_sink)) {
+		if (cd->src_func != src_2s)
+			return 0;
+	} else {
+		if (comp_buffer_get_avail_bytes(source) < need_source) {
+			trace_src_error("src_copy() error: source component "
+					"buffer has not enough data available");
+			return -EIO; /* xrun */
+		}
+		if (comp_buffer_get_free_bytes(sink) < need_sink) {
+			trace_src_error("src_copy() error: sink component "
+					"buffer has not enough free bytes for copy");
+			return -EIO; /* xrun */
+		}
 	}
-	if (sink->free < need_sink) {
-		trace_src_error("src_copy() error: sink component buffer "
-				"has not enough free bytes for copy");
-		return -EIO; /* xrun */
+
+	/* while decayed silence comes in the stages only write zeros */
+	skipped = cd->silence.skip;
+	if (comp_silence_check(&cd->silence, source,
+			       comp_buffer_get_avail_bytes(source)) != skipped) {
+		if (cd->silence.skip) {
+			/* clear the decayed tail, processing resumes from rest */
+			bzero(cd->delay_lines, sizeof(int32_t) * cd->param.total);
+			comp_dirty_mark(&cd->delay_dirty, cd->delay_lines,
+					sizeof(int32_t) * cd->param.total);
+			cd->polyphase_func = dev->params.frame_fmt ==
+				SOF_IPC_FRAME_S16_LE ? src_zero_stage_s16 :
+				src_zero_stage_s32;
+		} else {
+			cd->polyphase_func = cd->polyphase_filter;
+		}
 	}
 
 	cd->src_func(dev, source, sink, &consumed, &produced);
+	comp_silence_count(&cd->silence, consumed);
+
+	/* the polyphase stages move through all of their delay lines */
+	if (consumed > 0 && !cd->silence.skip &&
+	    (cd->src_func == src_1s || cd->src_func == src_2s))
+		comp_dirty_mark(&cd->delay_dirty, cd->delay_lines,
+				sizeof(int32_t) * cd->param.total);
 
 	tracev_src("src_copy(), consumed = %u,  produced = %u",
 		   consumed, produced);
@@ -905,6 +1128,18 @@ static int src_prepare(struct comp_dev *dev)
 		return -EINVAL;
 	}
 
+	/* Silence is skipped once it has flushed every delay line, the
+	 * later stages run at up to the source rate over the sink rate
+	 * times fewer frames.
+	 */
+	cd->polyphase_filter = cd->polyphase_func;
+	if (cd->src_func == src_1s || cd->src_func == src_2s)
+		comp_silence_init(&cd->silence, cd->param.total /
+				  dev->params.channels *
+				  (cd->source_rate / cd->sink_rate + 1));
+	else
+		comp_silence_init(&cd->silence, 0);
+
 	return comp_set_state(dev, COMP_TRIGGER_PREPARE);
 }
 
@@ -914,7 +1149,15 @@ static int src_reset(struct comp_dev *dev)
 
 	trace_src("src_reset()");
 
+	/* pipeline reset releases the delay lines in the arena */
+	cd->delay_lines = NULL;
+	cd->delay_lines_size = 0;
+	comp_dirty_clear(&cd->delay_dirty);
+
 	cd->src_func = src_fallback;
+	comp_silence_init(&cd->silence, 0);
+	src_coef_unlock(cd);
+	src_coef_release(&cd->src);
 	src_polyphase_reset(&cd->src);
 
 	comp_set_state(dev, COMP_TRIGGER_RESET);
@@ -931,10 +1174,8 @@ static void src_cache(struct comp_dev *dev, int cmd)
 
 		cd = comp_get_drvdata(dev);
 
-		if (cd->delay_lines)
-			dcache_writeback_invalidate_region
-				(cd->delay_lines,
-				 sizeof(int32_t) * cd->param.total);
+		/* only delay lines written since the last writeback */
+		comp_dirty_writeback_inv(&cd->delay_dirty);
 
 		dcache_writeback_invalidate_region(cd, sizeof(*cd));
 		dcache_writeback_invalidate_region(dev, sizeof(*dev));
@@ -953,6 +1194,20 @@ static void src_cache(struct comp_dev *dev, int cmd)
 				(cd->delay_lines,
 				 sizeof(int32_t) * cd->param.total);
 		break;
+
+	case COMP_CACHE_LOCK:
+		trace_src("src_cache(), COMP_CACHE_LOCK");
+
+		cd = comp_get_drvdata(dev);
+		src_coef_lock(cd);
+		break;
+
+	case COMP_CACHE_UNLOCK:
+		trace_src("src_cache(), COMP_CACHE_UNLOCK");
+
+		cd = comp_get_drvdata(dev);
+		src_coef_unlock(cd);
+		break;
 	}
 }
 
@@ -973,5 +1228,9 @@ struct comp_driver comp_src = {
 
 void sys_comp_src_init(void)
 {
+#ifdef CONFIG_SRC_COEF_CACHE
+	list_init(&src_coef_list);
+	spinlock_init(&src_coef_lock);
+#endif
 	comp_register(&comp_src);
 }
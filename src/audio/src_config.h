@@ -60,7 +60,11 @@
 #define SRC_HIFI3	0
 #endif
 #if XCHAL_HAVE_HIFI3 == 1
+#if defined(CONFIG_SRC_SHORT_COEFS)
+#define SRC_SHORT	1  /* Select 16 bit coefficients for voice grade SRC */
+#else
 #define SRC_SHORT	0  /* Select 32 bit default quality coefficients */
+#endif
 #define SRC_HIFI3	1
 #define SRC_HIFIEP	0
 #endif
@@ -248,7 +248,7 @@ static inline void fir_filter_generic(int32_t *rp, const void *cp, int32_t *wp0,
 
 #endif /* 32bit coefficients version */
 
-void src_polyphase_stage_cir(struct src_stage_prm *s)
+void __hot_text src_polyphase_stage_cir(struct src_stage_prm *s)
 {
 	int i;
 	int n;
@@ -347,7 +347,7 @@ void src_polyphase_stage_cir(struct src_stage_prm *s)
 	s->y_wptr = y_wptr;
 }
 
-void src_polyphase_stage_cir_s16(struct src_stage_prm *s)
+void __hot_text src_polyphase_stage_cir_s16(struct src_stage_prm *s)
 {
 	int i;
 	int n;
@@ -322,7 +322,7 @@ static inline void fir_filter(ae_q32s *rp, const void *cp, ae_q32s *wp0,
 }
 #endif /* 32bit coefficients version */
 
-void src_polyphase_stage_cir(struct src_stage_prm *s)
+void __hot_text src_polyphase_stage_cir(struct src_stage_prm *s)
 {
 	/* This function uses
 	 *  1x 56 bit registers Q,
@@ -446,7 +446,7 @@ void src_polyphase_stage_cir(struct src_stage_prm *s)
 	s->y_wptr = y_wptr;
 }
 
-void src_polyphase_stage_cir_s16(struct src_stage_prm *s)
+void __hot_text src_polyphase_stage_cir_s16(struct src_stage_prm *s)
 {
 	/* This function uses
 	 *  0x 56 bit registers Q,
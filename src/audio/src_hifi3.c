@@ -75,64 +75,79 @@ static inline void fir_filter(ae_f32 *rp, const void *cp, ae_f32 *wp0,
 	ae_f32 *wp = wp0;
 	const int inc = nch * sizeof(int32_t);
 
-	if (nch == 2) {
+	if (!(nch & 1)) {
 		/* Move data pointer back by one sample to start from right
-		 * channel sample. Discard read value p0.
+		 * channel sample of the first channel pair. Discard read
+		 * value p0.
 		 */
-		dp = (ae_f32x2 *)rp;
-		AE_L32_XC(d0, (ae_f32 *)dp, -sizeof(ae_f32));
-
-		/* Reset coefficient pointer and clear accumulator */
-		coefp = (ae_f16x4 *)cp;
-		a0 = AE_ZERO64();
-		a1 = AE_ZERO64();
+		dp1 = (ae_f32 *)rp;
+		AE_L32_XC(d0, dp1, -sizeof(ae_f32));
 
-		/* Compute FIR filter for current channel with four
-		 * taps per every loop iteration.  Four coefficients
-		 * are loaded simultaneously. Data is read
-		 * from interleaved buffer with stride of channels
-		 * count.
+		/* Compute two output channels per iteration so every data
+		 * load feeds two dual MACs.
 		 */
-		for (i = 0; i < taps_div_4; i++) {
-			/* Load four coefficients */
-			AE_LA16X4_IP(coef4, u, coefp);
-
-			/* Load two data samples from two channels */
-			AE_L32X2_XC(d0, dp, inc); /* r0, l0 */
-			AE_L32X2_XC(d1, dp, inc); /* r1, l1 */
+		for (j = 0; j < nch; j += 2) {
+			/* Copy pointer and advance to next channel pair with
+			 * dummy load.
+			 */
+			dp = (ae_f32x2 *)dp1;
+			AE_L32_XC(d0, dp1, -2 * sizeof(ae_f32));
 
-			/* Select to data2 sequential samples from a channel
-			 * and then accumulate to a0 and a1
-			 * data2_h * coef4_3 + data2_l * coef4_2.
-			 * The data is 32 bits Q1.31 and coefficient 16 bits
-			 * Q1.15. The accumulators are Q17.47.
+			/* Reset coefficient pointer, prime the unaligned
+			 * coefficient stream and clear accumulators.
 			 */
-			data2 = AE_SEL32_LL(d0, d1); /* l0, l1 */
-			AE_MULAAFD32X16_H3_L2(a0, data2, coef4);
-			data2 = AE_SEL32_HH(d0, d1); /* r0, r1 */
-			AE_MULAAFD32X16_H3_L2(a1, data2, coef4);
+			coefp = (ae_f16x4 *)cp;
+			u = AE_LA64_PP(coefp);
+			a0 = AE_ZERO64();
+			a1 = AE_ZERO64();
+
+			/* Compute FIR filter for current channels with four
+			 * taps per every loop iteration.  Four coefficients
+			 * are loaded simultaneously. Data is read
+			 * from interleaved buffer with stride of channels
+			 * count.
+			 */
+			for (i = 0; i < taps_div_4; i++) {
+				/* Load four coefficients */
+				AE_LA16X4_IP(coef4, u, coefp);
+
+				/* Load two data samples from two channels */
+				AE_L32X2_XC(d0, dp, inc); /* r0, l0 */
+				AE_L32X2_XC(d1, dp, inc); /* r1, l1 */
+
+				/* Select to data2 sequential samples from a
+				 * channel and then accumulate to a0 and a1
+				 * data2_h * coef4_3 + data2_l * coef4_2.
+				 * The data is 32 bits Q1.31 and coefficient
+				 * 16 bits Q1.15. The accumulators are Q17.47.
+				 */
+				data2 = AE_SEL32_LL(d0, d1); /* l0, l1 */
+				AE_MULAAFD32X16_H3_L2(a0, data2, coef4);
+				data2 = AE_SEL32_HH(d0, d1); /* r0, r1 */
+				AE_MULAAFD32X16_H3_L2(a1, data2, coef4);
 
-			/* Load two data samples from two channels */
-			AE_L32X2_XC(d0, dp, inc); /* r2, l2 */
-			AE_L32X2_XC(d1, dp, inc); /* r3, l3 */
+				/* Load two data samples from two channels */
+				AE_L32X2_XC(d0, dp, inc); /* r2, l2 */
+				AE_L32X2_XC(d1, dp, inc); /* r3, l3 */
 
-			/* Accumulate
-			 * data2_h * coef4_1 + data2_l * coef4_0.
+				/* Accumulate
+				 * data2_h * coef4_1 + data2_l * coef4_0.
+				 */
+				data2 = AE_SEL32_LL(d0, d1); /* l2, l3 */
+				AE_MULAAFD32X16_H1_L0(a0, data2, coef4);
+				data2 = AE_SEL32_HH(d0, d1); /* r2, r3 */
+				AE_MULAAFD32X16_H1_L0(a1, data2, coef4);
+			}
+
+			/* Scale FIR output with right shifts, round/saturate
+			 * to Q1.31, and store 32 bit output.
 			 */
-			data2 = AE_SEL32_LL(d0, d1); /* l2, l3 */
-			AE_MULAAFD32X16_H1_L0(a0, data2, coef4);
-			data2 = AE_SEL32_HH(d0, d1); /* r2, r3 */
-			AE_MULAAFD32X16_H1_L0(a1, data2, coef4);
+			AE_S32_L_XP(AE_ROUND32F48SSYM(AE_SRAA64(a0, shift)),
+				    wp, sizeof(int32_t));
+			AE_S32_L_XP(AE_ROUND32F48SSYM(AE_SRAA64(a1, shift)),
+				    wp, sizeof(int32_t));
 		}
 
-		/* Scale FIR output with right shifts, round/saturate
-		 * to Q1.31, and store 32 bit output.
-		 */
-		AE_S32_L_XP(AE_ROUND32F48SSYM(AE_SRAA64(a0, shift)), wp,
-			    sizeof(int32_t));
-		AE_S32_L_XP(AE_ROUND32F48SSYM(AE_SRAA64(a1, shift)), wp,
-			    sizeof(int32_t));
-
 		return;
 	}
 
@@ -142,8 +157,11 @@ static inline void fir_filter(ae_f32 *rp, const void *cp, ae_f32 *wp0,
 		dp0 = dp1;
 		AE_L32_XC(d0, dp1, -sizeof(ae_f32));
 
-		/* Reset coefficient pointer and clear accumulator */
+		/* Reset coefficient pointer, prime the unaligned coefficient
+		 * stream and clear accumulator.
+		 */
 		coefp = (ae_f16x4 *)cp;
+		u = AE_LA64_PP(coefp);
 		a0 = AE_ZERO64();
 
 		/* Compute FIR filter for current channel with four
@@ -327,7 +345,7 @@ static inline void fir_filter(ae_f32 *rp, const void *cp, ae_f32 *wp0,
 
 #endif /* 32bit coefficients version */
 
-void src_polyphase_stage_cir(struct src_stage_prm *s)
+void __hot_text src_polyphase_stage_cir(struct src_stage_prm *s)
 {
 	/* This function uses
 	 *  1x 64 bit registers
@@ -450,7 +468,7 @@ void src_polyphase_stage_cir(struct src_stage_prm *s)
 	s->y_wptr = y_wptr;
 }
 
-void src_polyphase_stage_cir_s16(struct src_stage_prm *s)
+void __hot_text src_polyphase_stage_cir_s16(struct src_stage_prm *s)
 {
 	/* This function uses
 	 *  2x 64 bit registers
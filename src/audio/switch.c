@@ -28,34 +28,264 @@
  * Author: Liam Girdwood <liam.r.girdwood@linux.intel.com>
  */
 
+/**
+ * \file audio/switch.c
+ * \brief Switch component implementation
+ *
+ * A switch routes its single source to one of its sink buffers, the
+ * outputs, numbered in buffer id order. The route is selected with an enum
+ * control at runtime, every output stays connected and running so nothing
+ * in the pipelines is reconfigured.
+ *
+ * Outputs not routed to are parked: the pipeline schedules write silence
+ * in place of the component copies beyond them and the switch stops
+ * zeroing a parked output once its whole buffer is silent, so unused
+ * outputs cost next to nothing. The routed output is a plain copy and a
+ * route change crossfades the old and new output over a few ms.
+ */
+
 #include <stdint.h>
 #include <stddef.h>
+#include <errno.h>
+#include <sof/sof.h>
 #include <sof/lock.h>
 #include <sof/list.h>
 #include <sof/stream.h>
+#include <sof/alloc.h>
+#include <sof/ipc.h>
 #include <sof/audio/component.h>
+#include <sof/audio/pipeline.h>
 
 /* tracing */
-#define trace_switch(__e) trace_event(TRACE_CLASS_SWITCH, __e)
-#define trace_switch_error(__e)   trace_error(TRACE_CLASS_SWITCH, __e)
-#define tracev_switch(__e)        tracev_event(TRACE_CLASS_SWITCH, __e)
+#define trace_switch(__e, ...) \
+	trace_event(TRACE_CLASS_SWITCH, __e, ##__VA_ARGS__)
+#define trace_switch_error(__e, ...) \
+	trace_error(TRACE_CLASS_SWITCH, __e, ##__VA_ARGS__)
+#define tracev_switch(__e, ...) \
+	tracev_event(TRACE_CLASS_SWITCH, __e, ##__VA_ARGS__)
+
+#define SWITCH_MAX_OUTPUTS	8
+#define SWITCH_FADE_MS		5	/* default crossfade length */
+#define SWITCH_GAIN_Q		30
+#define SWITCH_GAIN_ONE		(1 << SWITCH_GAIN_Q)
+
+struct switch_output {
+	struct comp_buffer *buffer;
+	uint32_t zeroed;	/* silent bytes written since parked */
+};
+
+struct switch_data {
+	struct switch_output outputs[SWITCH_MAX_OUTPUTS]; /* buffer id order */
+	uint32_t num_outputs;
+	uint32_t route;			/* output fed the source */
+	volatile uint32_t target;	/* output selected by the control */
+	struct switch_output *fading;	/* output faded out, NULL if none */
+	uint32_t fade_frames;		/* crossfade length */
+	uint32_t fade_pos;		/* crossfade frames done */
+	uint32_t sample_bytes;
+	uint32_t period_bytes;
+};
 
 static struct comp_dev *switch_new(struct sof_ipc_comp *comp)
 {
+	struct comp_dev *dev;
+	struct sof_ipc_comp_switch *sw;
+	struct sof_ipc_comp_switch *ipc_sw =
+		(struct sof_ipc_comp_switch *)comp;
+	struct switch_data *cd;
+
 	trace_switch("switch_new()");
 
-	return NULL;
+	if (IPC_IS_SIZE_INVALID(ipc_sw->config)) {
+		IPC_SIZE_ERROR_TRACE(TRACE_CLASS_SWITCH, ipc_sw->config);
+		return NULL;
+	}
+
+	if (ipc_sw->route >= SWITCH_MAX_OUTPUTS) {
+		trace_switch_error("switch_new() error: invalid route %u",
+				   ipc_sw->route);
+		return NULL;
+	}
+
+	dev = rzalloc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM,
+		      COMP_SIZE(struct sof_ipc_comp_switch));
+	if (!dev)
+		return NULL;
+
+	sw = (struct sof_ipc_comp_switch *)&dev->comp;
+	memcpy(sw, ipc_sw, sizeof(struct sof_ipc_comp_switch));
+
+	cd = rzalloc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM, sizeof(*cd));
+	if (!cd) {
+		rfree(dev);
+		return NULL;
+	}
+
+	cd->target = ipc_sw->route;
+
+	comp_set_drvdata(dev, cd);
+	dev->state = COMP_STATE_READY;
+	return dev;
 }
 
 static void switch_free(struct comp_dev *dev)
 {
+	struct switch_data *cd = comp_get_drvdata(dev);
+
+	trace_switch("switch_free()");
+
+	rfree(cd);
+	rfree(dev);
+}
+
+/* add an output, keeping them in buffer id order */
+static void switch_add_output(struct switch_data *cd,
+			      struct comp_buffer *buffer)
+{
+	uint32_t i = cd->num_outputs++;
+
+	for (; i > 0; i--) {
+		if (cd->outputs[i - 1].buffer->ipc_buffer.comp.id <
+		    buffer->ipc_buffer.comp.id)
+			break;
+		cd->outputs[i] = cd->outputs[i - 1];
+	}
 
+	cd->outputs[i].buffer = buffer;
+	cd->outputs[i].zeroed = 0;
 }
 
-/* set component audio stream parameters */
+/* set component audio stream parameters, every output gets the source
+ * stream unchanged */
 static int switch_params(struct comp_dev *dev)
 {
+	struct sof_ipc_comp_switch *sw = COMP_GET_IPC(dev, sof_ipc_comp_switch);
+	struct sof_ipc_comp_config *config = COMP_GET_CONFIG(dev);
+	struct switch_data *cd = comp_get_drvdata(dev);
+	struct comp_buffer *buffer;
+	struct list_item *blist;
+	int ret;
+
+	trace_switch("switch_params()");
+
+	switch (dev->params.frame_fmt) {
+	case SOF_IPC_FRAME_S16_LE:
+		cd->sample_bytes = sizeof(int16_t);
+		break;
+	case SOF_IPC_FRAME_S24_4LE:
+	case SOF_IPC_FRAME_S32_LE:
+		cd->sample_bytes = sizeof(int32_t);
+		break;
+	default:
+		trace_switch_error("switch_params() error: unsupported "
+				   "format %u", dev->params.frame_fmt);
+		return -EINVAL;
+	}
+
+	if (list_is_empty(&dev->bsource_list) ||
+	    !list_item_is_last(dev->bsource_list.next, &dev->bsource_list)) {
+		trace_switch_error("switch_params() error: switch needs a "
+				   "single source");
+		return -EINVAL;
+	}
+
+	dev->frame_bytes = dev->params.channels * cd->sample_bytes;
+	cd->period_bytes = dev->frames * dev->frame_bytes;
+	if (cd->period_bytes == 0) {
+		trace_switch_error("switch_params() error: period_bytes = 0");
+		return -EINVAL;
+	}
+
+	cd->fade_frames = (sw->fade_ms ? sw->fade_ms : SWITCH_FADE_MS) *
+		(dev->params.rate / 1000);
+	if (!cd->fade_frames)
+		cd->fade_frames = 1;
+
+	cd->num_outputs = 0;
+	list_for_item(blist, &dev->bsink_list) {
+		buffer = container_of(blist, struct comp_buffer, source_list);
+
+		if (cd->num_outputs == SWITCH_MAX_OUTPUTS) {
+			trace_switch_error("switch_params() error: too many "
+					   "outputs");
+			return -EINVAL;
+		}
+
+		/* each output carries its own data */
+		if (buffer->next_reader) {
+			trace_switch_error("switch_params() error: fan-out "
+					   "output");
+			return -EINVAL;
+		}
+
+		switch_add_output(cd, buffer);
+
+		ret = buffer_set_size(buffer, cd->period_bytes *
+				      config->periods_sink);
+		if (ret < 0) {
+			trace_switch_error("switch_params() error: "
+					   "buffer_set_size() failed");
+			return ret;
+		}
+	}
+
+	if (!cd->num_outputs) {
+		trace_switch_error("switch_params() error: no outputs");
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+/* route the source to an output, fading starts with the next copy */
+static int switch_select(struct comp_dev *dev, uint32_t route)
+{
+	struct switch_data *cd = comp_get_drvdata(dev);
+
+	if (route >= SWITCH_MAX_OUTPUTS ||
+	    (cd->num_outputs && route >= cd->num_outputs)) {
+		trace_switch_error("switch_select() error: invalid route %u",
+				   route);
+		return -EINVAL;
+	}
+
+	trace_switch("switch_select(), route %u", route);
+
+	/* the schedules run the new output again from their next copy */
+	if (cd->num_outputs && dev->state == COMP_STATE_ACTIVE)
+		pipeline_buffer_park(cd->outputs[route].buffer, 0);
 
+	cd->target = route;
+	return 0;
+}
+
+static int switch_ctrl_set_cmd(struct comp_dev *dev,
+			       struct sof_ipc_ctrl_data *cdata)
+{
+	if (cdata->cmd != SOF_CTRL_CMD_ENUM || cdata->num_elems != 1) {
+		trace_switch_error("switch_ctrl_set_cmd() error: invalid "
+				   "cmd %u or num_elems %u", cdata->cmd,
+				   cdata->num_elems);
+		return -EINVAL;
+	}
+
+	return switch_select(dev, cdata->chanv[0].value);
+}
+
+static int switch_ctrl_get_cmd(struct comp_dev *dev,
+			       struct sof_ipc_ctrl_data *cdata, int size)
+{
+	struct switch_data *cd = comp_get_drvdata(dev);
+
+	if (cdata->cmd != SOF_CTRL_CMD_ENUM || cdata->num_elems != 1) {
+		trace_switch_error("switch_ctrl_get_cmd() error: invalid "
+				   "cmd %u or num_elems %u", cdata->cmd,
+				   cdata->num_elems);
+		return -EINVAL;
+	}
+
+	cdata->chanv[0].channel = 0;
+	cdata->chanv[0].value = cd->target;
 	return 0;
 }
 
@@ -63,27 +293,270 @@ static int switch_params(struct comp_dev *dev)
 static int switch_cmd(struct comp_dev *dev, int cmd, void *data,
 		      int max_data_size)
 {
-	/* switch will use buffer "connected" status */
-	return 0;
+	struct sof_ipc_ctrl_data *cdata = data;
+
+	trace_switch("switch_cmd()");
+
+	switch (cmd) {
+	case COMP_CMD_SET_VALUE:
+		return switch_ctrl_set_cmd(dev, cdata);
+	case COMP_CMD_GET_VALUE:
+		return switch_ctrl_get_cmd(dev, cdata, max_data_size);
+	default:
+		return -EINVAL;
+	}
+}
+
+static int switch_trigger(struct comp_dev *dev, int cmd)
+{
+	trace_switch("switch_trigger()");
+
+	return comp_set_state(dev, cmd);
+}
+
+static inline int32_t switch_read(const void *ptr, uint32_t bytes)
+{
+	return bytes == sizeof(int16_t) ? *(const int16_t *)ptr :
+		*(const int32_t *)ptr;
+}
+
+static inline void switch_write(void *ptr, uint32_t bytes, int32_t x,
+				int32_t gain)
+{
+	x = ((int64_t)x * gain) >> SWITCH_GAIN_Q;
+
+	if (bytes == sizeof(int16_t))
+		*(int16_t *)ptr = x;
+	else
+		*(int32_t *)ptr = x;
+}
+
+/* copy one period to the routed output */
+static void switch_copy_period(struct switch_data *cd,
+			       struct comp_buffer *source,
+			       struct comp_buffer *sink)
+{
+	uint32_t bytes = cd->period_bytes;
+	void *src = source->r_ptr;
+	void *dst = sink->w_ptr;
+	uint32_t n;
+
+	while (bytes) {
+		/* bytes until the first buffer wrap */
+		n = MIN(bytes, MIN(buffer_bytes_to_wrap(source, src),
+				   buffer_bytes_to_wrap(sink, dst)));
+		memcpy(dst, src, n);
+		src = buffer_wrap(source, (char *)src + n);
+		dst = buffer_wrap(sink, (char *)dst + n);
+		bytes -= n;
+	}
+}
+
+/*
+ * Crossfade one period from the output faded out to the one faded in with
+ * linear gains. Buffer sizes are multiples of the frame size so a frame
+ * never wraps.
+ */
+static void switch_fade_period(struct comp_dev *dev,
+			       struct comp_buffer *source,
+			       struct comp_buffer *out,
+			       struct comp_buffer *in)
+{
+	struct switch_data *cd = comp_get_drvdata(dev);
+	uint32_t step = SWITCH_GAIN_ONE / cd->fade_frames;
+	uint32_t bytes = cd->sample_bytes;
+	char *src = source->r_ptr;
+	char *dst_out = out->w_ptr;
+	char *dst_in = in->w_ptr;
+	uint32_t frame;
+	uint32_t ch;
+	int32_t gain;
+	int32_t x;
+
+	for (frame = 0; frame < dev->frames; frame++) {
+		gain = MIN(cd->fade_pos, cd->fade_frames) * step;
+
+		for (ch = 0; ch < dev->params.channels; ch++) {
+			x = switch_read(src + ch * bytes, bytes);
+			switch_write(dst_in + ch * bytes, bytes, x, gain);
+			switch_write(dst_out + ch * bytes, bytes, x,
+				     SWITCH_GAIN_ONE - gain);
+		}
+
+		src = buffer_wrap(source, src + dev->frame_bytes);
+		dst_out = buffer_wrap(out, dst_out + dev->frame_bytes);
+		dst_in = buffer_wrap(in, dst_in + dev->frame_bytes);
+		cd->fade_pos++;
+	}
+}
+
+/* a parked output gets silence, written until its whole buffer is zero */
+static void switch_park_period(struct switch_data *cd,
+			       struct switch_output *output)
+{
+	struct comp_buffer *buffer = output->buffer;
+
+	if (output->zeroed < buffer->size) {
+		buffer_zero_bytes(buffer, buffer->w_ptr, cd->period_bytes);
+		output->zeroed += cd->period_bytes;
+	}
+
+	comp_update_buffer_produce(buffer, cd->period_bytes);
 }
 
 /* copy and process stream data from source to sink buffers */
 static int switch_copy(struct comp_dev *dev)
 {
+	struct switch_data *cd = comp_get_drvdata(dev);
+	struct switch_output *route;
+	struct switch_output *output;
+	struct comp_buffer *source;
+	uint32_t i;
 
-	return 0;
+	tracev_switch("switch_copy()");
+
+	source = list_first_item(&dev->bsource_list, struct comp_buffer,
+				 sink_list);
+
+	if (comp_buffer_get_avail_bytes(source) < cd->period_bytes) {
+		trace_switch_error("switch_copy() error: source component "
+				   "buffer has not enough data available");
+		comp_underrun(dev, source, cd->period_bytes, 0);
+		return -EIO;	/* xrun */
+	}
+
+	for (i = 0; i < cd->num_outputs; i++) {
+		output = &cd->outputs[i];
+		if (output->buffer->sink->state == dev->state &&
+		    comp_buffer_get_free_bytes(output->buffer) <
+		    cd->period_bytes) {
+			trace_switch_error("switch_copy() error: sink "
+					   "component buffer has not enough "
+					   "free bytes for copy");
+			comp_overrun(dev, output->buffer, cd->period_bytes, 0);
+			return -EIO;	/* xrun */
+		}
+	}
+
+	/* a new route fades in once the last crossfade is done */
+	if (!cd->fading && cd->target != cd->route) {
+		pipeline_buffer_park(cd->outputs[cd->target].buffer, 0);
+		cd->fading = &cd->outputs[cd->route];
+		cd->route = cd->target;
+		cd->fade_pos = 0;
+	}
+
+	route = &cd->outputs[cd->route];
+	if (cd->fading)
+		switch_fade_period(dev, source, cd->fading->buffer,
+				   route->buffer);
+	else
+		switch_copy_period(cd, source, route->buffer);
+
+	for (i = 0; i < cd->num_outputs; i++) {
+		output = &cd->outputs[i];
+		if (output->buffer->sink->state != dev->state)
+			continue;
+
+		if (output == route || output == cd->fading)
+			comp_update_buffer_produce(output->buffer,
+						   cd->period_bytes);
+		else
+			switch_park_period(cd, output);
+	}
+
+	comp_update_buffer_consume(source, cd->period_bytes);
+
+	/* the faded out output is parked unless it was selected again */
+	if (cd->fading && cd->fade_pos >= cd->fade_frames) {
+		if (cd->fading != &cd->outputs[cd->target]) {
+			cd->fading->zeroed = 0;
+			pipeline_buffer_park(cd->fading->buffer, 1);
+		}
+		cd->fading = NULL;
+	}
+
+	return dev->frames;
+}
+
+/* unpark every output so the graph is left as it was connected */
+static void switch_unpark(struct switch_data *cd)
+{
+	uint32_t i;
+
+	for (i = 0; i < cd->num_outputs; i++)
+		pipeline_buffer_park(cd->outputs[i].buffer, 0);
 }
 
 static int switch_reset(struct comp_dev *dev)
 {
+	struct switch_data *cd = comp_get_drvdata(dev);
+
+	trace_switch("switch_reset()");
+
+	switch_unpark(cd);
+	cd->num_outputs = 0;
+	cd->fading = NULL;
+
+	comp_set_state(dev, COMP_TRIGGER_RESET);
 	return 0;
 }
 
+/* only the routed output runs its pipeline components from the start */
 static int switch_prepare(struct comp_dev *dev)
 {
+	struct switch_data *cd = comp_get_drvdata(dev);
+	uint32_t i;
+	int ret;
+
+	trace_switch("switch_prepare()");
+
+	ret = comp_set_state(dev, COMP_TRIGGER_PREPARE);
+	if (ret < 0)
+		return ret;
+
+	if (cd->target >= cd->num_outputs) {
+		trace_switch_error("switch_prepare() error: route %u without "
+				   "output, using 0", cd->target);
+		cd->target = 0;
+	}
+
+	cd->route = cd->target;
+	cd->fading = NULL;
+
+	for (i = 0; i < cd->num_outputs; i++) {
+		cd->outputs[i].zeroed = 0;
+		pipeline_buffer_park(cd->outputs[i].buffer, i != cd->route);
+	}
+
 	return 0;
 }
 
+static void switch_cache(struct comp_dev *dev, int cmd)
+{
+	struct switch_data *cd;
+
+	switch (cmd) {
+	case COMP_CACHE_WRITEBACK_INV:
+		trace_switch("switch_cache(), COMP_CACHE_WRITEBACK_INV");
+
+		cd = comp_get_drvdata(dev);
+
+		dcache_writeback_invalidate_region(cd, sizeof(*cd));
+		dcache_writeback_invalidate_region(dev, sizeof(*dev));
+		break;
+
+	case COMP_CACHE_INVALIDATE:
+		trace_switch("switch_cache(), COMP_CACHE_INVALIDATE");
+
+		dcache_invalidate_region(dev, sizeof(*dev));
+
+		cd = comp_get_drvdata(dev);
+		dcache_invalidate_region(cd, sizeof(*cd));
+		break;
+	}
+}
+
 struct comp_driver comp_switch = {
 	.type	= SOF_COMP_SWITCH,
 	.ops	= {
@@ -91,9 +564,11 @@ struct comp_driver comp_switch = {
 		.free		= switch_free,
 		.params		= switch_params,
 		.cmd		= switch_cmd,
+		.trigger	= switch_trigger,
 		.copy		= switch_copy,
 		.prepare	= switch_prepare,
 		.reset		= switch_reset,
+		.cache		= switch_cache,
 	},
 };
 
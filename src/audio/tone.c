@@ -92,6 +92,7 @@ struct tone_state {
 	int32_t ramp_step; /* Amplitude ramp step Q1.31 */
 	int32_t w; /* Angle radians Q4.28 */
 	int32_t w_step; /* Angle step Q4.28 */
+	int32_t w_coef; /* Oscillator coefficient 2*cos(w_step) Q2.30 */
 	uint32_t block_count;
 	uint32_t repeat_count;
 	uint32_t repeats; /* Number of repeats for tone (sweep steps) */
@@ -101,17 +102,31 @@ struct tone_state {
 	uint32_t tone_period; /* Active + idle time in 125 us blocks */
 };
 
+/* wavetable playback position, see struct sof_tone_wave_config */
+struct tone_wave {
+	const int32_t *data;
+	uint32_t channels; /* Table channels, 1 or stream channels */
+	uint32_t length; /* Table frames */
+	uint32_t period; /* Table and silence frames */
+	uint32_t pos; /* Frame in period */
+	uint32_t frac; /* Fraction of frame Q0.32 */
+	uint32_t step; /* Frames per output frame Q32.0 */
+	uint32_t step_frac; /* Fraction of step Q0.32 */
+};
+
 struct comp_data {
 	uint32_t period_bytes;
 	uint32_t channels;
 	uint32_t frame_bytes;
 	uint32_t rate;
 	struct tone_state sg[PLATFORM_MAX_CHANNELS];
+	struct tone_wave wave;
+	struct sof_tone_wave_config *wave_config;
+	struct sof_tone_wave_config *wave_new; /* staged while running */
 	void (*tone_func)(struct comp_dev *dev, struct comp_buffer *sink,
 		uint32_t frames);
 };
 
-static int32_t tonegen(struct tone_state *sg);
 static void tonegen_control(struct tone_state *sg);
 static void tonegen_update_f(struct tone_state *sg, int32_t f);
 
@@ -119,61 +134,297 @@ static void tonegen_update_f(struct tone_state *sg, int32_t f);
  * Tone generator algorithm code
  */
 
-static inline void tone_circ_inc_wrap(int32_t **ptr, int32_t *end, size_t size)
+/*
+ * The sine is generated with a second order recursive oscillator
+ * s[n + 1] = 2 * cos(w_step) * s[n] - s[n - 1], so no table lookup is
+ * needed per sample. The oscillator is seeded from the phase angle with
+ * two sin_fixed() calls for every 125 us control block, which keeps the
+ * drift of the recursion below -100 dB. Channels with the same state are
+ * generated once and copied.
+ */
+
+/* Generate n samples with no control update between them */
+static void tonegen(struct tone_state *sg, int32_t *dest, int stride, int n)
 {
-	if (*ptr >= end)
-		*ptr = (int32_t *) ((size_t) * ptr - size);
+	int32_t w_prev = sg->w - sg->w_step;
+	int32_t seed[2];
+	int32_t s0;
+	int32_t s1;
+	int32_t s2;
+	int64_t w = sg->w;
+	int i;
+
+	/* seed from the previous and current phase angle */
+	if (w_prev < 0)
+		w_prev += PI_MUL2_Q4_28;
+
+	sin_fixed_step(w_prev, sg->w_step, seed, 2);
+	s0 = seed[0];
+	s1 = seed[1];
+
+	for (i = 0; i < n; i++) {
+		/* sg->a is amplitude as Q1.31, Q1.31 no saturation need */
+		*dest = sg->mute ? 0 : (int32_t)q_mults_32x32(s1, sg->a,
+			Q_SHIFT_BITS_64(31, 31, 31));
+		dest += stride;
+
+		/* Next point, w_coef is Q2.30 */
+		s2 = sat_int32(q_mults_32x32(sg->w_coef, s1,
+			       Q_SHIFT_BITS_64(30, 31, 31)) - s0);
+		s0 = s1;
+		s1 = s2;
+
+		/* sg->w is angle in Q4.28 radians format */
+		w += sg->w_step;
+		if (w > PI_MUL2_Q4_28)
+			w -= PI_MUL2_Q4_28;
+	}
+
+	sg->w = (int32_t)w;
+}
+
+/* Generate frames of one channel at stride, running control per block */
+static void tonegen_channel(struct tone_state *sg, int32_t *dest, int stride,
+			    int frames)
+{
+	int n;
+
+	while (frames > 0) {
+		/* control for the first sample, then samples to next block */
+		tonegen_control(sg);
+		n = MIN(frames, (int)(sg->samples_in_block - sg->sample_count));
+		sg->sample_count += n - 1;
+
+		tonegen(sg, dest, stride, n);
+		dest += n * stride;
+		frames -= n;
+	}
 }
 
 static void tone_s32_default(struct comp_dev *dev, struct comp_buffer *sink,
 	uint32_t frames)
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
-	int32_t *dest = (int32_t*) sink->w_ptr;
-	int i;
-	int n;
-	int n_wrap_dest;
-	int n_min;
+	int32_t *dest = (int32_t *)sink->w_ptr;
+	int leader[PLATFORM_MAX_CHANNELS];
 	int nch = cd->channels;
+	int n_frames;
+	int n;
+	int i;
+	int j;
 
-	n = frames * nch;
+	/* channels with the same state generate the same samples */
+	for (i = 0; i < nch; i++) {
+		leader[i] = i;
+		for (j = 0; j < i; j++) {
+			if (leader[j] == j &&
+			    !memcmp(&cd->sg[i], &cd->sg[j], sizeof(cd->sg[i]))) {
+				leader[i] = j;
+				break;
+			}
+		}
+	}
+
+	n = frames;
 	while (n > 0) {
-		n_wrap_dest = (int32_t *) sink->end_addr - dest;
-		n_min = (n < n_wrap_dest) ? n : n_wrap_dest;
 		/* Process until wrap or completed n */
-		while (n_min > 0) {
-			n -= nch;
-			n_min -= nch;
-			for (i = 0; i < nch; i++) {
-				tonegen_control(&cd->sg[i]);
-				*dest = tonegen(&cd->sg[i]);
-				dest++;
+		n_frames = buffer_wrap_samples(sink, dest,
+					       nch * sizeof(int32_t), n);
+
+		for (i = 0; i < nch; i++) {
+			if (leader[i] == i)
+				tonegen_channel(&cd->sg[i], dest + i, nch,
+						n_frames);
+			else
+				for (j = 0; j < n_frames; j++)
+					dest[j * nch + i] =
+						dest[j * nch + leader[i]];
+		}
+
+		n -= n_frames;
+		dest = buffer_wrap(sink, dest + n_frames * nch);
+	}
+
+	/* copied channels continue from the generated state */
+	for (i = 0; i < nch; i++) {
+		if (leader[i] != i)
+			cd->sg[i] = cd->sg[leader[i]];
+	}
+}
+
+/*
+ * Wavetable mode plays a table from the host in a loop instead of the
+ * oscillator. With the table at the stream rate the period is copied as
+ * is, otherwise the position steps in Q32.32 frames and samples are
+ * interpolated linearly from the two nearest table frames.
+ */
+
+/* Sample of table channel ch at frame pos, zero in the silence */
+static inline int32_t tone_wave_sample(struct tone_wave *wave, uint32_t pos,
+				       int ch)
+{
+	return pos < wave->length ? wave->data[pos * wave->channels + ch] : 0;
+}
+
+/* Copy frames of a table at the stream rate */
+static void tone_wave_copy(struct tone_wave *wave, int32_t *dest, int nch,
+			   int frames)
+{
+	const int32_t *src;
+	int n;
+	int i;
+	int j;
+
+	while (frames > 0) {
+		if (wave->pos < wave->length) {
+			n = MIN(frames, (int)(wave->length - wave->pos));
+			src = wave->data + wave->pos * wave->channels;
+			if (wave->channels == nch) {
+				memcpy(dest, src, n * nch * sizeof(int32_t));
+			} else {
+				for (i = 0; i < n; i++)
+					for (j = 0; j < nch; j++)
+						dest[i * nch + j] = src[i];
 			}
+		} else {
+			n = MIN(frames, (int)(wave->period - wave->pos));
+			memset(dest, 0, n * nch * sizeof(int32_t));
 		}
-		tone_circ_inc_wrap(&dest, sink->end_addr, sink->size);
+
+		wave->pos += n;
+		if (wave->pos == wave->period)
+			wave->pos = 0;
+
+		dest += n * nch;
+		frames -= n;
 	}
 }
 
-static int32_t tonegen(struct tone_state *sg)
+/* Interpolate frames of a table at another rate than the stream */
+static void tone_wave_interp(struct tone_wave *wave, int32_t *dest, int nch,
+			     int frames)
 {
-	int64_t sine;
-	int64_t w;
+	uint32_t next;
+	uint32_t frac;
+	int32_t s0;
+	int32_t s1;
+	int i;
+	int j;
 
-	/* sg->w is angle in Q4.28 radians format, sin() returns Q1.31 */
-	/* sg->a is amplitude as Q1.31 */
-	sine =
-		q_mults_32x32(sin_fixed(sg->w), sg->a,
-		Q_SHIFT_BITS_64(31, 31, 31));
+	for (i = 0; i < frames; i++) {
+		next = wave->pos + 1 < wave->period ? wave->pos + 1 : 0;
+		frac = wave->frac >> 1; /* Q1.31 */
+		for (j = 0; j < nch; j++) {
+			if (wave->channels == 1 && j > 0) {
+				dest[j] = dest[0];
+				continue;
+			}
 
-	/* Next point */
-	w = (int64_t) sg->w + sg->w_step;
-	sg->w = (w > PI_MUL2_Q4_28)
-		? (int32_t) (w - PI_MUL2_Q4_28) : (int32_t) w;
+			s0 = tone_wave_sample(wave, wave->pos, j);
+			s1 = tone_wave_sample(wave, next, j);
+			dest[j] = s0 + (int32_t)((((int64_t)s1 - s0) * frac)
+						 >> 31);
+		}
+		dest += nch;
+
+		/* step is less than a period */
+		frac = wave->frac + wave->step_frac;
+		wave->pos += wave->step + (frac < wave->frac);
+		wave->frac = frac;
+		if (wave->pos >= wave->period)
+			wave->pos -= wave->period;
+	}
+}
 
-	if (sg->mute)
+static void tone_s32_wave(struct comp_dev *dev, struct comp_buffer *sink,
+			  uint32_t frames)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	struct tone_wave *wave = &cd->wave;
+	int32_t *dest = (int32_t *)sink->w_ptr;
+	int nch = cd->channels;
+	int n_frames;
+	int n;
+	int i;
+	int j;
+
+	n = frames;
+	while (n > 0) {
+		/* Process until wrap or completed n */
+		n_frames = buffer_wrap_samples(sink, dest,
+					       nch * sizeof(int32_t), n);
+
+		if (wave->step == 1 && !wave->step_frac)
+			tone_wave_copy(wave, dest, nch, n_frames);
+		else
+			tone_wave_interp(wave, dest, nch, n_frames);
+
+		for (i = 0; i < nch; i++) {
+			if (cd->sg[i].mute)
+				for (j = 0; j < n_frames; j++)
+					dest[j * nch + i] = 0;
+		}
+
+		n -= n_frames;
+		dest = buffer_wrap(sink, dest + n_frames * nch);
+	}
+}
+
+/* Set up the wavetable of config for the stream, or the oscillator when
+ * the table is empty.
+ */
+static int tone_wave_setup(struct comp_data *cd,
+			   struct sof_tone_wave_config *config)
+{
+	struct tone_wave *wave = &cd->wave;
+	uint64_t step;
+
+	if (!config || !config->length) {
+		cd->tone_func = tone_s32_default;
 		return 0;
+	}
+
+	if (config->channels != 1 && config->channels != cd->channels) {
+		trace_tone_error("tone_wave_setup() error: table channels %u "
+				 "for %u stream channels", config->channels,
+				 cd->channels);
+		return -EINVAL;
+	}
+
+	if (!cd->rate) {
+		trace_tone_error("tone_wave_setup() error: no rate");
+		return -EINVAL;
+	}
+
+	/* Q32.32 table frames per stream frame */
+	if (config->frequency > 0)
+		step = (((uint64_t)config->frequency * config->length) << 16) /
+			cd->rate;
+	else if (config->rate)
+		step = ((uint64_t)config->rate << 32) / cd->rate;
 	else
-		return(int32_t) sine; /* Q1.31 no saturation need */
+		step = (uint64_t)1 << 32;
+
+	wave->data = (const int32_t *)(config + 1); /* config->data */
+	wave->channels = config->channels;
+	wave->length = config->length;
+	wave->period = config->length + config->silence;
+	if (!step || step >= (uint64_t)wave->period << 32) {
+		trace_tone_error("tone_wave_setup() error: step out of range "
+				 "for rate %u", cd->rate);
+		return -EINVAL;
+	}
+
+	wave->step = step >> 32;
+	wave->step_frac = (uint32_t)step;
+	wave->pos = 0;
+	wave->frac = 0;
+
+	trace_tone("tone_wave_setup(), length = %u, period = %u, step = %u",
+		   wave->length, wave->period, (uint32_t)(step >> 16));
+
+	cd->tone_func = tone_s32_wave;
+	return 0;
 }
 
 static void tonegen_control(struct tone_state *sg)
@@ -313,6 +564,7 @@ static inline void tonegen_unmute(struct tone_state *sg)
 static void tonegen_update_f(struct tone_state *sg, int32_t f)
 {
 	int64_t w_tmp;
+	int32_t s_tmp;
 	int64_t f_max;
 
 	/* Calculate Fs/2, fs is Q32.0, f is Q16.16 */
@@ -324,6 +576,15 @@ static void tonegen_update_f(struct tone_state *sg, int32_t f)
 	w_tmp = (w_tmp > PI_Q4_28) ? PI_Q4_28 : w_tmp; /* Limit to pi Q4.28 */
 	sg->w_step = (int32_t) w_tmp;
 
+	/* 2*cos(w_step) = 2 - 4*sin(w_step/2)^2 keeps the precision of the
+	 * table for low frequencies. Q1.31 x Q1.31 -> Q2.32 is 4*s^2 as
+	 * Q2.30, exactly 2.0 doesn't fit Q2.30 so it saturates.
+	 */
+	s_tmp = sin_fixed(sg->w_step >> 1);
+	w_tmp = ((int64_t)1 << 31) - q_mults_32x32(s_tmp, s_tmp,
+		Q_SHIFT_BITS_64(31, 31, 32));
+	sg->w_coef = sat_int32(w_tmp);
+
 #ifdef MODULE_TEST
 	printf("Fs=%d, f_max=%d, f_new=%.3f\n",
 		sg->fs, (int32_t) (f_max >> 16), sg->f / 65536.0);
@@ -339,6 +600,7 @@ static void tonegen_reset(struct tone_state *sg)
 	sg->f = TONE_FREQUENCY_DEFAULT;
 	sg->w = 0;
 	sg->w_step = 0;
+	sg->w_coef = 0;
 
 	sg->block_count = 0;
 	sg->repeat_count = 0;
@@ -433,17 +695,20 @@ static struct comp_dev *tone_new(struct sof_ipc_comp *comp)
 	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++)
 		tonegen_reset(&cd->sg[i]);
 
+	dev->can_schedule = 1;
 	dev->state = COMP_STATE_READY;
 	return dev;
 }
 
 static void tone_free(struct comp_dev *dev)
 {
-	struct tone_data *td = comp_get_drvdata(dev);
+	struct comp_data *cd = comp_get_drvdata(dev);
 
 	trace_tone("tone_free()");
 
-	rfree(td);
+	rfree(cd->wave_config);
+	rfree(cd->wave_new);
+	rfree(cd);
 	rfree(dev);
 }
 
@@ -526,6 +791,112 @@ static int tone_cmd_set_value(struct comp_dev *dev,
 	return 0;
 }
 
+static int tone_cmd_get_data(struct comp_dev *dev,
+			     struct sof_ipc_ctrl_data *cdata, int max_size)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	size_t bs;
+
+	trace_tone("tone_cmd_get_data()");
+
+	if (cdata->cmd != SOF_CTRL_CMD_BINARY) {
+		trace_tone_error("tone_cmd_get_data() error: "
+				 "invalid cdata->cmd");
+		return -EINVAL;
+	}
+
+	if (!cd->wave_config) {
+		trace_tone_error("tone_cmd_get_data() error: no wavetable");
+		return -EINVAL;
+	}
+
+	bs = cd->wave_config->size;
+	if (bs > max_size)
+		return -EINVAL;
+
+	memcpy(cdata->data->data, cd->wave_config, bs);
+	cdata->data->abi = SOF_ABI_VERSION;
+	cdata->data->size = bs;
+
+	return 0;
+}
+
+/* Copy a wavetable blob, it is taken into use in prepare() or at the next
+ * period when running.
+ */
+static int tone_cmd_set_wave(struct comp_dev *dev,
+			     struct sof_ipc_ctrl_data *cdata)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	struct sof_tone_wave_config *cfg;
+	struct sof_tone_wave_config *new_config;
+	struct sof_tone_wave_config *old_config;
+	uint32_t flags;
+	size_t bs;
+
+	cfg = (struct sof_tone_wave_config *)cdata->data->data;
+	bs = cfg->size;
+	trace_tone("tone_cmd_set_wave(), blob size = %u", bs);
+	if (bs > SOF_TONE_WAVE_MAX_SIZE || bs < sizeof(*cfg) ||
+	    cfg->channels < 1 || cfg->channels > PLATFORM_MAX_CHANNELS ||
+	    cfg->length > SOF_TONE_WAVE_MAX_SIZE ||
+	    cfg->silence > INT32_MAX - SOF_TONE_WAVE_MAX_SIZE ||
+	    bs != sizeof(*cfg) +
+		  cfg->length * cfg->channels * sizeof(int32_t)) {
+		trace_tone_error("tone_cmd_set_wave() error: invalid blob");
+		return -EINVAL;
+	}
+
+	new_config = rzalloc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM, bs);
+	if (!new_config) {
+		trace_tone_error("tone_cmd_set_wave() error: alloc failed");
+		return -ENOMEM;
+	}
+
+	memcpy(new_config, cfg, bs);
+
+	if (dev->state == COMP_STATE_READY) {
+		rfree(cd->wave_config);
+		cd->wave_config = new_config;
+		return 0;
+	}
+
+	spin_lock_irq(&dev->lock, flags);
+	old_config = cd->wave_new;
+	cd->wave_new = new_config;
+	spin_unlock_irq(&dev->lock, flags);
+
+	rfree(old_config);
+	return 0;
+}
+
+/* Take a wavetable staged while running into use at the period boundary,
+ * the old one is kept if the new one does not fit the stream.
+ */
+static void tone_wave_apply(struct comp_dev *dev)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	struct sof_tone_wave_config *config;
+	uint32_t flags;
+
+	spin_lock_irq(&dev->lock, flags);
+	config = cd->wave_new;
+	cd->wave_new = NULL;
+	spin_unlock_irq(&dev->lock, flags);
+
+	if (!config)
+		return;
+
+	if (tone_wave_setup(cd, config) < 0) {
+		trace_tone_error("tone_wave_apply() error: keeping old table");
+		rfree(config);
+		return;
+	}
+
+	rfree(cd->wave_config);
+	cd->wave_config = config;
+}
+
 static int tone_cmd_set_data(struct comp_dev *dev,
 	struct sof_ipc_ctrl_data *cdata)
 {
@@ -602,6 +973,8 @@ static int tone_cmd_set_data(struct comp_dev *dev,
 			}
 		}
 		break;
+	case SOF_CTRL_CMD_BINARY:
+		return tone_cmd_set_wave(dev, cdata);
 	default:
 		trace_tone_error("tone_cmd_set_data() error: "
 				 "invalid cdata->cmd");
@@ -624,6 +997,9 @@ static int tone_cmd(struct comp_dev *dev, int cmd, void *data,
 	case COMP_CMD_SET_DATA:
 		ret = tone_cmd_set_data(dev, cdata);
 		break;
+	case COMP_CMD_GET_DATA:
+		ret = tone_cmd_get_data(dev, cdata, max_data_size);
+		break;
 	case COMP_CMD_SET_VALUE:
 		ret = tone_cmd_set_value(dev, cdata);
 		break;
@@ -647,9 +1023,15 @@ static int tone_copy(struct comp_dev * dev)
 {
 	struct comp_buffer *sink;
 	struct comp_data *cd = comp_get_drvdata(dev);
+	uint32_t frames = dev->frames;
+	uint32_t n;
 
 	tracev_comp("tone_copy()");
 
+	/* swap in a new wavetable before generating the period */
+	if (cd->wave_new)
+		tone_wave_apply(dev);
+
 	/* tone component sink buffer */
 	sink = list_first_item(&dev->bsink_list, struct comp_buffer,
 		source_list);
@@ -657,19 +1039,25 @@ static int tone_copy(struct comp_dev * dev)
 	/* Test that sink has enough free frames. Then run once to maintain
 	 * low latency and steady load for tones.
 	 */
-	if (sink->free >= cd->period_bytes) {
-		/* create tone */
-		cd->tone_func(dev, sink, dev->frames);
-
-		/* calc new free and available */
-		comp_update_buffer_produce(sink, cd->period_bytes);
+	if (comp_buffer_get_free_bytes(sink) >= cd->period_bytes) {
+		/* create tone, split where scheduled control events apply */
+		while (frames) {
+			n = comp_event_run(dev, frames);
+			cd->tone_func(dev, sink, n);
+			comp_event_advance(dev, n);
+			frames -= n;
+
+			/* calc new free and available */
+			comp_update_buffer_produce(sink, n * dev->frame_bytes);
+		}
 
 		return dev->frames;
 	} else {
 		/* XRUN */
 		trace_tone_error("tone_copy() error: "
 				 "sink has not enough free frames");
-		comp_overrun(dev, sink, cd->period_bytes, sink->free);
+		comp_overrun(dev, sink, cd->period_bytes,
+			     comp_buffer_get_free_bytes(sink));
 		return -EIO;
 	}
 }
@@ -692,16 +1080,28 @@ static int tone_prepare(struct comp_dev * dev)
 	trace_tone("tone_prepare(), cd->channels = %u, cd->rate = %u",
 		   cd->channels, cd->rate);
 
+	/* The wavetable plays at any rate, the oscillator needs a rate from
+	 * its table.
+	 */
 	for (i = 0; i < cd->channels; i++) {
 		f = tonegen_get_f(&cd->sg[i]);
 		a = tonegen_get_a(&cd->sg[i]);
-		if (tonegen_init(&cd->sg[i], cd->rate, f, a) < 0) {
-			comp_set_state(dev, COMP_TRIGGER_RESET);
-			return -EINVAL;
-		}
+		ret = tonegen_init(&cd->sg[i], cd->rate, f, a);
+		if (ret < 0 && cd->wave_config && cd->wave_config->length)
+			tonegen_unmute(&cd->sg[i]);
+		else if (ret < 0)
+			goto err;
 	}
 
+	ret = tone_wave_setup(cd, cd->wave_config);
+	if (ret < 0)
+		goto err;
+
 	return 0;
+
+err:
+	comp_set_state(dev, COMP_TRIGGER_RESET);
+	return -EINVAL;
 }
 
 static int tone_reset(struct comp_dev * dev)
@@ -716,6 +1116,13 @@ static int tone_reset(struct comp_dev * dev)
 	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++)
 		tonegen_reset(&cd->sg[i]);
 
+	/* A wavetable staged while running is used in next prepare() */
+	if (cd->wave_new) {
+		rfree(cd->wave_config);
+		cd->wave_config = cd->wave_new;
+		cd->wave_new = NULL;
+	}
+
 	comp_set_state(dev, COMP_TRIGGER_RESET);
 
 	return 0;
@@ -730,6 +1137,9 @@ static void tone_cache(struct comp_dev *dev, int cmd)
 		trace_tone("tone_cache(), COMP_CACHE_WRITEBACK_INV");
 
 		cd = comp_get_drvdata(dev);
+		if (cd->wave_config)
+			dcache_writeback_invalidate_region(cd->wave_config,
+							   cd->wave_config->size);
 
 		dcache_writeback_invalidate_region(cd, sizeof(*cd));
 		dcache_writeback_invalidate_region(dev, sizeof(*dev));
@@ -742,6 +1152,10 @@ static void tone_cache(struct comp_dev *dev, int cmd)
 
 		cd = comp_get_drvdata(dev);
 		dcache_invalidate_region(cd, sizeof(*cd));
+
+		if (cd->wave_config)
+			dcache_invalidate_region(cd->wave_config,
+						 cd->wave_config->size);
 		break;
 	}
 }
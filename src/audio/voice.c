@@ -0,0 +1,947 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Seppo Ingalsuo <seppo.ingalsuo@linux.intel.com>
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <errno.h>
+#include <string.h>
+#include <sof/sof.h>
+#include <sof/lock.h>
+#include <sof/list.h>
+#include <sof/stream.h>
+#include <sof/alloc.h>
+#include <sof/ipc.h>
+#include <sof/audio/component.h>
+#include <sof/audio/pipeline.h>
+#include <sof/audio/format.h>
+#include <sof/math/numbers.h>
+#include <uapi/ipc/control.h>
+#include <uapi/user/eq.h>
+#include <uapi/user/voice.h>
+#include "voice.h"
+#include "iir.h"
+#include "src.h"
+
+/* Max output frames decimated before they are filtered */
+#define VOICE_BLOCK_FRAMES 16
+
+/*
+ * Voice front end algorithm code
+ *
+ * A capture stream is decimated with the polyphase SRC stages straight into
+ * the sink buffer. Every block of output frames is then high-pass filtered
+ * and scaled in place while it is still in cache, so no period sized
+ * intermediate buffer is written and read back between the stages. With
+ * S16_LE the decimator runs the 16 bit stage kernels and the stage buffer
+ * of a 2 stage conversion holds 16 bit samples.
+ */
+
+/* Filter and scale frames from x in source to y in sink across wraps */
+static void voice_process(struct comp_dev *dev, struct comp_buffer *source,
+			  void *x, struct comp_buffer *sink, void *y,
+			  int frames)
+{
+	struct voice_data *cd = comp_get_drvdata(dev);
+	int nch = dev->params.channels;
+	int n;
+
+	while (frames > 0) {
+		n = buffer_segment_samples(source, x, dev->frame_bytes,
+					   sink, y, dev->frame_bytes, frames);
+		cd->voice_func(cd, nch, x, y, n);
+
+		frames -= n;
+		x = buffer_wrap(source, (uint8_t *)x + n * dev->frame_bytes);
+		y = buffer_wrap(sink, (uint8_t *)y + n * dev->frame_bytes);
+	}
+}
+
+/* Equal rates, filter and scale a block from source to sink */
+static void voice_1to1(struct comp_dev *dev, struct comp_buffer *source,
+		       struct comp_buffer *sink, int *n_read, int *n_written)
+{
+	struct voice_data *cd = comp_get_drvdata(dev);
+
+	voice_process(dev, source, source->r_ptr, sink, sink->w_ptr,
+		      cd->param.blk_in);
+
+	*n_read = cd->param.blk_in;
+	*n_written = cd->param.blk_in;
+}
+
+/* 1 stage decimation, the output is filtered every VOICE_BLOCK_FRAMES */
+static void voice_1s(struct comp_dev *dev, struct comp_buffer *source,
+		     struct comp_buffer *sink, int *n_read, int *n_written)
+{
+	struct voice_data *cd = comp_get_drvdata(dev);
+	struct src_stage_prm s1;
+	struct src_stage *stage = cd->src.stage1;
+	int times_max = MAX(VOICE_BLOCK_FRAMES / stage->blk_out, 1);
+	int times = cd->param.stage1_times;
+	void *y;
+
+	s1.x_rptr = source->r_ptr;
+	s1.x_end_addr = source->end_addr;
+	s1.x_size = source->size;
+	s1.y_wptr = sink->w_ptr;
+	s1.y_end_addr = sink->end_addr;
+	s1.y_size = sink->size;
+	s1.state = &cd->src.state1;
+	s1.stage = stage;
+	s1.nch = dev->params.channels;
+	s1.shift = cd->data_shift;
+
+	while (times > 0) {
+		y = s1.y_wptr;
+		s1.times = MIN(times, times_max);
+		cd->polyphase_func(&s1);
+
+		voice_process(dev, sink, y, sink, y,
+			      s1.times * stage->blk_out);
+		times -= s1.times;
+	}
+
+	*n_read = cd->param.blk_in;
+	*n_written = cd->param.stage1_times * stage->blk_out;
+}
+
+/* 2 stage decimation as in the SRC component, the output of every 2nd
+ * stage run is filtered right after it has been written
+ */
+static void voice_2s(struct comp_dev *dev, struct comp_buffer *source,
+		     struct comp_buffer *sink, int *n_read, int *n_written)
+{
+	struct voice_data *cd = comp_get_drvdata(dev);
+	struct src_stage_prm s1;
+	struct src_stage_prm s2;
+	void *sbuf_addr = cd->delay_lines;
+	void *sbuf_end_addr = &cd->delay_lines[cd->param.sbuf_length];
+	size_t sbuf_size = cd->param.sbuf_length * sizeof(int32_t);
+	int nch = dev->params.channels;
+	int sbuf_free = cd->param.sbuf_length - cd->sbuf_avail;
+	int sz = dev->params.sample_container_bytes;
+	int s1_blk_in = cd->src.stage1->blk_in * nch * sz;
+	int s1_blk_out = cd->src.stage1->blk_out * nch;
+	int s2_blk_in = cd->src.stage2->blk_in * nch;
+	int s2_blk_out = cd->src.stage2->blk_out * nch * sz;
+	int avail_b = comp_buffer_get_avail_bytes(source);
+	int free_b = comp_buffer_get_free_bytes(sink);
+	int n1 = 0;
+	int n2 = 0;
+	int s1_run;
+	void *y;
+
+	*n_read = 0;
+	*n_written = 0;
+	s1.x_end_addr = source->end_addr;
+	s1.x_size = source->size;
+	s1.y_addr = sbuf_addr;
+	s1.y_end_addr = sbuf_end_addr;
+	s1.y_size = sbuf_size;
+	s1.state = &cd->src.state1;
+	s1.stage = cd->src.stage1;
+	s1.x_rptr = source->r_ptr;
+	s1.y_wptr = cd->sbuf_w_ptr;
+	s1.nch = nch;
+	s1.shift = cd->data_shift;
+	s1.times = 1;
+
+	s2.x_end_addr = sbuf_end_addr;
+	s2.x_size = sbuf_size;
+	s2.y_addr = sink->addr;
+	s2.y_end_addr = sink->end_addr;
+	s2.y_size = sink->size;
+	s2.state = &cd->src.state2;
+	s2.stage = cd->src.stage2;
+	s2.x_rptr = cd->sbuf_r_ptr;
+	s2.y_wptr = sink->w_ptr;
+	s2.nch = nch;
+	s2.shift = cd->data_shift;
+
+	do {
+		s1_run = n1 < cd->param.stage1_times_max &&
+			avail_b >= s1_blk_in && sbuf_free >= s1_blk_out;
+		if (s1_run) {
+			cd->polyphase_func(&s1);
+
+			cd->sbuf_avail += s1_blk_out;
+			*n_read += cd->src.stage1->blk_in;
+			avail_b -= s1_blk_in;
+			sbuf_free -= s1_blk_out;
+			n1++;
+		}
+
+		s2.times = MIN(cd->sbuf_avail / s2_blk_in,
+			       free_b / s2_blk_out);
+		s2.times = MIN(s2.times, cd->param.stage2_times_max - n2);
+		if (s2.times > 0) {
+			y = s2.y_wptr;
+			cd->polyphase_func(&s2);
+
+			voice_process(dev, sink, y, sink, y,
+				      s2.times * cd->src.stage2->blk_out);
+
+			cd->sbuf_avail -= s2.times * s2_blk_in;
+			sbuf_free += s2.times * s2_blk_in;
+			free_b -= s2.times * s2_blk_out;
+			*n_written += s2.times * cd->src.stage2->blk_out;
+			n2 += s2.times;
+		}
+	} while (s1_run);
+
+	cd->sbuf_w_ptr = s1.y_wptr;
+	cd->sbuf_r_ptr = s2.x_rptr;
+}
+
+/*
+ * Voice front end setup code
+ */
+
+static void voice_free_parameters(struct sof_voice_config **config)
+{
+	rfree(*config);
+	*config = NULL;
+}
+
+static void voice_free_state(struct voice_data *cd)
+{
+	int i;
+
+	/* the state is owned by the pipeline arena */
+	cd->state = NULL;
+	cd->state_size = 0;
+	cd->iir_delay = NULL;
+	cd->delay_lines = NULL;
+	comp_dirty_clear(&cd->state_dirty);
+	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++)
+		iir_reset_df2t(&cd->iir[i]);
+}
+
+/* Find the high-pass response of the blob, NULL if it has none */
+static int voice_get_response(struct sof_voice_config *config,
+			      struct sof_eq_iir_header_df2t **response)
+{
+	struct sof_eq_iir_header_df2t *hp;
+	size_t words;
+
+	*response = NULL;
+	if (!config || !config->num_responses)
+		return 0;
+
+	if (config->num_responses > 1 || config->size < sizeof(*config) ||
+	    config->size > SOF_VOICE_MAX_SIZE)
+		return -EINVAL;
+
+	words = (config->size - sizeof(*config)) / sizeof(int32_t);
+	if (words < SOF_EQ_IIR_NHEADER_DF2T)
+		return -EINVAL;
+
+	hp = (struct sof_eq_iir_header_df2t *)config->data;
+	if (!hp->num_sections ||
+	    hp->num_sections > SOF_EQ_IIR_DF2T_BIQUADS_MAX ||
+	    !hp->num_sections_in_series ||
+	    hp->num_sections % hp->num_sections_in_series ||
+	    words < SOF_EQ_IIR_NHEADER_DF2T +
+	    SOF_EQ_IIR_NBIQUAD_DF2T * hp->num_sections)
+		return -EINVAL;
+
+	*response = hp;
+	return 0;
+}
+
+/* Set the high-pass filter of the blob to all channels. A response with
+ * the same layout keeps the filter state, otherwise it starts from zero.
+ */
+static int voice_setup_iir(struct voice_data *cd, int nch)
+{
+	struct sof_eq_iir_header_df2t *hp;
+	int64_t *delay;
+	int ret;
+	int i;
+
+	ret = voice_get_response(cd->config, &hp);
+	if (ret < 0)
+		return ret;
+
+	for (i = 0; i < nch; i++) {
+		if (!hp) {
+			iir_reset_df2t(&cd->iir[i]);
+			continue;
+		}
+
+		if (iir_update_coef_df2t(&cd->iir[i], hp) == 0)
+			continue;
+
+		delay = cd->iir_delay + i * VOICE_IIR_DELAY_SIZE /
+			sizeof(int64_t);
+		memset(delay, 0, VOICE_IIR_DELAY_SIZE);
+		iir_init_coef_df2t(&cd->iir[i], hp);
+		iir_init_delay_df2t(&cd->iir[i], &delay);
+	}
+
+	return 0;
+}
+
+static void voice_set_gain(struct voice_data *cd)
+{
+	int i;
+
+	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++)
+		cd->gain[i] = cd->config ? cd->config->gain :
+			SOF_VOICE_GAIN_ZERO_DB;
+}
+
+/*
+ * End of voice front end setup code. Next the standard component methods.
+ */
+
+static struct comp_dev *voice_new(struct sof_ipc_comp *comp)
+{
+	struct comp_dev *dev;
+	struct voice_data *cd;
+	struct sof_ipc_comp_voice *ipc_voice =
+		(struct sof_ipc_comp_voice *)comp;
+	struct sof_voice_config *cfg =
+		(struct sof_voice_config *)ipc_voice->data;
+	size_t bs = ipc_voice->size;
+	int i;
+
+	trace_voice("voice_new()");
+
+	if (IPC_IS_SIZE_INVALID(ipc_voice->config)) {
+		IPC_SIZE_ERROR_TRACE(TRACE_CLASS_VOICE, ipc_voice->config);
+		return NULL;
+	}
+
+	/* either sink or source rate must be set */
+	if (ipc_voice->source_rate == 0 && ipc_voice->sink_rate == 0) {
+		trace_voice_error("voice_new() error: "
+				  "sink and source rate are not set");
+		return NULL;
+	}
+
+	if (bs > SOF_VOICE_MAX_SIZE || (bs && (bs < sizeof(*cfg) ||
+					      cfg->size != bs))) {
+		trace_voice_error("voice_new() error: invalid config blob "
+				  "size = %u", bs);
+		return NULL;
+	}
+
+	dev = rzalloc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM,
+		      COMP_SIZE(struct sof_ipc_comp_voice));
+	if (!dev)
+		return NULL;
+
+	memcpy(&dev->comp, comp, sizeof(struct sof_ipc_comp_voice));
+
+	cd = rzalloc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM, sizeof(*cd));
+	if (!cd) {
+		rfree(dev);
+		return NULL;
+	}
+
+	comp_set_drvdata(dev, cd);
+
+	/* Make a copy of the configuration blob. Without one the front end
+	 * only decimates until a blob is set in run-time.
+	 */
+	if (bs) {
+		cd->config = rzalloc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM, bs);
+		if (!cd->config) {
+			rfree(dev);
+			rfree(cd);
+			return NULL;
+		}
+
+		memcpy(cd->config, ipc_voice->data, bs);
+	}
+
+	voice_set_gain(cd);
+	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++)
+		iir_reset_df2t(&cd->iir[i]);
+
+	cd->polyphase_func = src_polyphase_stage_cir;
+	cd->voice_func = voice_s32;
+	src_polyphase_reset(&cd->src);
+
+	dev->state = COMP_STATE_READY;
+	return dev;
+}
+
+static void voice_free(struct comp_dev *dev)
+{
+	struct voice_data *cd = comp_get_drvdata(dev);
+
+	trace_voice("voice_free()");
+
+	voice_free_state(cd);
+	voice_free_parameters(&cd->config);
+	voice_free_parameters(&cd->config_new);
+
+	rfree(cd);
+	rfree(dev);
+}
+
+/* set component audio stream parameters */
+static int voice_params(struct comp_dev *dev)
+{
+	struct sof_ipc_stream_params *params = &dev->params;
+	struct sof_ipc_comp_voice *voice =
+		COMP_GET_IPC(dev, sof_ipc_comp_voice);
+	struct voice_data *cd = comp_get_drvdata(dev);
+	uint32_t frame_bytes;
+	int frames_is_for_source;
+	int err;
+
+	trace_voice("voice_params()");
+
+	/* One rate comes from IPC new and the other from params, params are
+	 * rewritten with the rate of the other side as in the SRC.
+	 */
+	if (voice->source_rate == 0) {
+		cd->source_rate = params->rate;
+		cd->sink_rate = voice->sink_rate;
+		params->rate = cd->sink_rate;
+		frames_is_for_source = 0;
+	} else {
+		cd->source_rate = voice->source_rate;
+		cd->sink_rate = params->rate;
+		params->rate = cd->source_rate;
+		frames_is_for_source = 1;
+	}
+
+	trace_voice("voice_params(), source_rate = %u, sink_rate = %u",
+		    cd->source_rate, cd->sink_rate);
+
+	err = src_buffer_lengths(&cd->param, cd->source_rate, cd->sink_rate,
+				 params->channels, dev->frames,
+				 frames_is_for_source);
+	if (err < 0) {
+		trace_voice_error("voice_params() error: "
+				  "src_buffer_lengths() failed");
+		return err;
+	}
+
+	/* buffer needs for the pipeline sizing pass, see voice_prepare() */
+	frame_bytes = params->sample_container_bytes * params->channels;
+	dev->min_sink_bytes = (ceil_divide(cd->param.blk_out,
+					   (int)dev->frames) + 1) *
+		dev->frames * frame_bytes;
+	dev->min_source_bytes = cd->param.blk_in * frame_bytes;
+
+	return 0;
+}
+
+static int voice_cmd_get_data(struct comp_dev *dev,
+			      struct sof_ipc_ctrl_data *cdata, int max_size)
+{
+	struct voice_data *cd = comp_get_drvdata(dev);
+	size_t bs;
+
+	if (cdata->cmd != SOF_CTRL_CMD_BINARY) {
+		trace_voice_error("voice_cmd_get_data() error: "
+				  "invalid cdata->cmd");
+		return -EINVAL;
+	}
+
+	if (!cd->config) {
+		trace_voice_error("voice_cmd_get_data() error: "
+				  "no configuration");
+		return -EINVAL;
+	}
+
+	bs = cd->config->size;
+	if (bs > SOF_VOICE_MAX_SIZE || bs == 0 || bs > max_size)
+		return -EINVAL;
+
+	memcpy(cdata->data->data, cd->config, bs);
+	cdata->data->abi = SOF_ABI_VERSION;
+	cdata->data->size = bs;
+
+	return 0;
+}
+
+static int voice_cmd_set_data(struct comp_dev *dev,
+			      struct sof_ipc_ctrl_data *cdata)
+{
+	struct voice_data *cd = comp_get_drvdata(dev);
+	struct sof_voice_config *cfg;
+	struct sof_voice_config *new_config;
+	struct sof_voice_config *old_config;
+	uint32_t flags;
+	size_t bs;
+
+	if (SOF_ABI_VERSION_INCOMPATIBLE(SOF_ABI_VERSION, cdata->data->abi)) {
+		trace_voice_error("voice_cmd_set_data() error: "
+				  "invalid version");
+		return -EINVAL;
+	}
+
+	if (cdata->cmd != SOF_CTRL_CMD_BINARY) {
+		trace_voice_error("voice_cmd_set_data() error: "
+				  "invalid cdata->cmd");
+		return -EINVAL;
+	}
+
+	/* Copy new config, find size from header */
+	cfg = (struct sof_voice_config *)cdata->data->data;
+	bs = cfg->size;
+	trace_voice("voice_cmd_set_data(), blob size = %u", bs);
+	if (bs > SOF_VOICE_MAX_SIZE || bs < sizeof(*cfg)) {
+		trace_voice_error("voice_cmd_set_data() error: "
+				  "invalid blob size");
+		return -EINVAL;
+	}
+
+	new_config = rzalloc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM, bs);
+	if (!new_config) {
+		trace_voice_error("voice_cmd_set_data() error: "
+				  "alloc failed");
+		return -ENOMEM;
+	}
+
+	memcpy(new_config, cdata->data->data, bs);
+
+	if (dev->state == COMP_STATE_READY) {
+		/* The filter will be initialized in prepare() */
+		voice_free_parameters(&cd->config);
+		cd->config = new_config;
+		voice_set_gain(cd);
+		return 0;
+	}
+
+	/* During capture the new configuration is staged and swapped in by
+	 * copy() at the next period.
+	 */
+	spin_lock_irq(&dev->lock, flags);
+	old_config = cd->config_new;
+	cd->config_new = new_config;
+	spin_unlock_irq(&dev->lock, flags);
+
+	voice_free_parameters(&old_config);
+	return 0;
+}
+
+/* The gain steps at the next block, a voice stream has no ramp */
+static int voice_cmd_set_value(struct comp_dev *dev,
+			       struct sof_ipc_ctrl_data *cdata)
+{
+	struct voice_data *cd = comp_get_drvdata(dev);
+	uint32_t ch;
+	int i;
+
+	if (cdata->cmd != SOF_CTRL_CMD_VOLUME) {
+		trace_voice_error("voice_cmd_set_value() error: "
+				  "invalid cdata->cmd");
+		return -EINVAL;
+	}
+
+	for (i = 0; i < cdata->num_elems; i++) {
+		ch = cdata->chanv[i].channel;
+		if (ch >= PLATFORM_MAX_CHANNELS) {
+			trace_voice_error("voice_cmd_set_value() error: "
+					  "invalid channel = %u", ch);
+			return -EINVAL;
+		}
+
+		cd->gain[ch] = cdata->chanv[i].value;
+	}
+
+	return 0;
+}
+
+static int voice_cmd_get_value(struct comp_dev *dev,
+			       struct sof_ipc_ctrl_data *cdata)
+{
+	struct voice_data *cd = comp_get_drvdata(dev);
+	int i;
+
+	if (cdata->cmd != SOF_CTRL_CMD_VOLUME ||
+	    cdata->num_elems > PLATFORM_MAX_CHANNELS) {
+		trace_voice_error("voice_cmd_get_value() error: "
+				  "invalid cdata->cmd");
+		return -EINVAL;
+	}
+
+	for (i = 0; i < cdata->num_elems; i++) {
+		cdata->chanv[i].channel = i;
+		cdata->chanv[i].value = cd->gain[i];
+	}
+
+	return 0;
+}
+
+/* used to pass standard and bespoke commands (with data) to component */
+static int voice_cmd(struct comp_dev *dev, int cmd, void *data,
+		     int max_data_size)
+{
+	struct sof_ipc_ctrl_data *cdata = data;
+
+	trace_voice("voice_cmd()");
+
+	switch (cmd) {
+	case COMP_CMD_SET_DATA:
+		return voice_cmd_set_data(dev, cdata);
+	case COMP_CMD_GET_DATA:
+		return voice_cmd_get_data(dev, cdata, max_data_size);
+	case COMP_CMD_SET_VALUE:
+		return voice_cmd_set_value(dev, cdata);
+	case COMP_CMD_GET_VALUE:
+		return voice_cmd_get_value(dev, cdata);
+	default:
+		trace_voice_error("voice_cmd() error: invalid command");
+		return -EINVAL;
+	}
+}
+
+static int voice_trigger(struct comp_dev *dev, int cmd)
+{
+	trace_voice("voice_trigger()");
+
+	return comp_set_state(dev, cmd);
+}
+
+/* Take a configuration staged by voice_cmd_set_data() into use at the
+ * period boundary. The old configuration is kept if the new one fails.
+ */
+static void voice_apply_config(struct comp_dev *dev)
+{
+	struct voice_data *cd = comp_get_drvdata(dev);
+	struct sof_voice_config *config;
+	struct sof_voice_config *old;
+	uint32_t flags;
+
+	spin_lock_irq(&dev->lock, flags);
+	config = cd->config_new;
+	cd->config_new = NULL;
+	spin_unlock_irq(&dev->lock, flags);
+
+	if (!config)
+		return;
+
+	old = cd->config;
+	cd->config = config;
+	if (voice_setup_iir(cd, dev->params.channels) == 0) {
+		voice_set_gain(cd);
+		voice_free_parameters(&old);
+		return;
+	}
+
+	trace_voice_error("voice_apply_config() error: "
+			  "new configuration failed, keeping old");
+	voice_free_parameters(&cd->config);
+	cd->config = old;
+}
+
+/* copy and process stream data from source to sink buffers */
+static int voice_copy(struct comp_dev *dev)
+{
+	struct voice_data *cd = comp_get_drvdata(dev);
+	struct comp_buffer *source;
+	struct comp_buffer *sink;
+	int need_source;
+	int need_sink;
+	int consumed = 0;
+	int produced = 0;
+
+	tracev_voice("voice_copy()");
+
+	/* swap in new configuration before processing the period */
+	if (cd->config_new)
+		voice_apply_config(dev);
+
+	source = list_first_item(&dev->bsource_list, struct comp_buffer,
+				 sink_list);
+	sink = list_first_item(&dev->bsink_list, struct comp_buffer,
+			       source_list);
+
+	/* pre-fill with zeros as the SRC does when the decimated block is
+	 * shorter than a period
+	 */
+	if (cd->prefill && comp_buffer_get_free_bytes(sink) >= cd->prefill) {
+		comp_update_buffer_produce(sink, cd->prefill);
+		cd->prefill = 0;
+	}
+
+	need_source = cd->param.blk_in * dev->frame_bytes;
+	need_sink = cd->param.blk_out * dev->frame_bytes;
+
+	/* make sure source component buffer has enough data available and that
+	 * the sink component buffer has enough free bytes for copy. Also
+	 * check for XRUNs
+	 */
+	if (comp_buffer_get_avail_bytes(source) < need_source) {
+		trace_voice_error("voice_copy() error: source component buffer "
+				  "has not enough data available");
+		comp_underrun(dev, source, need_source, 0);
+		return -EIO;	/* xrun */
+	}
+	if (comp_buffer_get_free_bytes(sink) < need_sink) {
+		trace_voice_error("voice_copy() error: sink component buffer "
+				  "has not enough free bytes for copy");
+		comp_overrun(dev, sink, need_sink, 0);
+		return -EIO;	/* xrun */
+	}
+
+	switch (cd->stages) {
+	case 0:
+		voice_1to1(dev, source, sink, &consumed, &produced);
+		break;
+	case 1:
+		voice_1s(dev, source, sink, &consumed, &produced);
+		break;
+	default:
+		voice_2s(dev, source, sink, &consumed, &produced);
+		break;
+	}
+
+	/* the filters and stages move through all of their delay lines */
+	comp_dirty_mark(&cd->state_dirty, cd->state, cd->state_size);
+
+	if (consumed > 0)
+		comp_update_buffer_consume(source, consumed * dev->frame_bytes);
+
+	if (produced > 0) {
+		comp_update_buffer_produce(sink, produced * dev->frame_bytes);
+		return produced;
+	}
+
+	/* produced no data */
+	return 0;
+}
+
+static int voice_prepare(struct comp_dev *dev)
+{
+	struct voice_data *cd = comp_get_drvdata(dev);
+	struct comp_buffer *sourceb;
+	struct comp_buffer *sinkb;
+	size_t iir_size;
+	size_t size;
+	int nch = dev->params.channels;
+	int q;
+	int d;
+	int i;
+	int ret;
+
+	trace_voice("voice_prepare()");
+
+	ret = comp_set_state(dev, COMP_TRIGGER_PREPARE);
+	if (ret < 0)
+		return ret;
+
+	/* the front end does not convert formats */
+	switch (dev->params.frame_fmt) {
+	case SOF_IPC_FRAME_S16_LE:
+		cd->data_shift = 0;
+		cd->polyphase_func = src_polyphase_stage_cir_s16;
+		cd->voice_func = voice_s16;
+		break;
+	case SOF_IPC_FRAME_S24_4LE:
+		cd->data_shift = 8;
+		cd->polyphase_func = src_polyphase_stage_cir;
+		cd->voice_func = voice_s24;
+		break;
+	case SOF_IPC_FRAME_S32_LE:
+		cd->data_shift = 0;
+		cd->polyphase_func = src_polyphase_stage_cir;
+		cd->voice_func = voice_s32;
+		break;
+	default:
+		trace_voice_error("voice_prepare() error: "
+				  "invalid frame_fmt = %d",
+				  dev->params.frame_fmt);
+		ret = -EINVAL;
+		goto err;
+	}
+
+	dev->frame_bytes =
+		dev->params.sample_container_bytes * dev->params.channels;
+
+	/* high-pass delay lines first for 64 bit alignment, then the SRC
+	 * stage buffer and delay lines. Existing state is reused if it fits.
+	 */
+	iir_size = nch * VOICE_IIR_DELAY_SIZE;
+	size = iir_size + sizeof(int32_t) * cd->param.total;
+	if (!cd->state || cd->state_size < size) {
+		voice_free_state(cd);
+		cd->state = pipeline_arena_alloc(dev->pipeline, size);
+		if (!cd->state) {
+			trace_voice_error("voice_prepare() error: "
+					  "failed to alloc state, size = %u",
+					  size);
+			ret = -ENOMEM;
+			goto err;
+		}
+		cd->state_size = size;
+	}
+
+	memset(cd->state, 0, cd->state_size);
+	comp_dirty_clear(&cd->state_dirty);
+	comp_dirty_mark(&cd->state_dirty, cd->state, cd->state_size);
+	cd->iir_delay = cd->state;
+	cd->delay_lines = (int32_t *)((uint8_t *)cd->state + iir_size);
+
+	/* stage buffer is at the start of the SRC delay lines */
+	cd->sbuf_w_ptr = cd->delay_lines;
+	cd->sbuf_r_ptr = cd->delay_lines;
+	cd->sbuf_avail = 0;
+	cd->stages = src_polyphase_init(&cd->src, &cd->param,
+					cd->delay_lines +
+					cd->param.sbuf_length);
+	if (cd->stages < 0) {
+		trace_voice_error("voice_prepare() error: missing coefficients "
+				  "for %u to %u Hz", cd->source_rate,
+				  cd->sink_rate);
+		ret = cd->stages;
+		goto err;
+	}
+
+	/* filters restart from zero state */
+	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++)
+		iir_reset_df2t(&cd->iir[i]);
+	ret = voice_setup_iir(cd, nch);
+	if (ret < 0) {
+		trace_voice_error("voice_prepare() error: "
+				  "invalid high-pass response");
+		goto err;
+	}
+
+	/* The downstream buffer holds blk_out plus a period, rounded to
+	 * periods, and is pre-filled when blk_out is shorter than a period.
+	 */
+	q = ceil_divide(cd->param.blk_out, (int)dev->frames) + 1;
+	d = dev->frames - cd->param.blk_out;
+	cd->prefill = d > 0 ? d * dev->frame_bytes : 0;
+
+	sinkb = list_first_item(&dev->bsink_list, struct comp_buffer,
+				source_list);
+	ret = buffer_set_size(sinkb, q * dev->frames * dev->frame_bytes);
+	if (ret < 0) {
+		trace_voice_error("voice_prepare() error: "
+				  "buffer_set_size() failed");
+		goto err;
+	}
+
+	sourceb = list_first_item(&dev->bsource_list, struct comp_buffer,
+				  sink_list);
+	if (sourceb->size < cd->param.blk_in * dev->frame_bytes) {
+		trace_voice_error("voice_prepare() error: source buffer "
+				  "size = %u too small", sourceb->size);
+		ret = -EINVAL;
+		goto err;
+	}
+
+	return 0;
+
+err:
+	comp_set_state(dev, COMP_TRIGGER_RESET);
+	return ret;
+}
+
+static int voice_reset(struct comp_dev *dev)
+{
+	struct voice_data *cd = comp_get_drvdata(dev);
+
+	trace_voice("voice_reset()");
+
+	voice_free_state(cd);
+	src_polyphase_reset(&cd->src);
+
+	/* A configuration staged while running is used in next prepare() */
+	if (cd->config_new) {
+		voice_free_parameters(&cd->config);
+		cd->config = cd->config_new;
+		cd->config_new = NULL;
+		voice_set_gain(cd);
+	}
+
+	comp_set_state(dev, COMP_TRIGGER_RESET);
+	return 0;
+}
+
+static void voice_cache(struct comp_dev *dev, int cmd)
+{
+	struct voice_data *cd;
+
+	switch (cmd) {
+	case COMP_CACHE_WRITEBACK_INV:
+		trace_voice("voice_cache(), COMP_CACHE_WRITEBACK_INV");
+
+		cd = comp_get_drvdata(dev);
+		if (cd->config)
+			dcache_writeback_invalidate_region(cd->config,
+							   cd->config->size);
+
+		/* only state written since the last writeback */
+		comp_dirty_writeback_inv(&cd->state_dirty);
+
+		dcache_writeback_invalidate_region(cd, sizeof(*cd));
+		dcache_writeback_invalidate_region(dev, sizeof(*dev));
+		break;
+
+	case COMP_CACHE_INVALIDATE:
+		trace_voice("voice_cache(), COMP_CACHE_INVALIDATE");
+
+		dcache_invalidate_region(dev, sizeof(*dev));
+
+		/* Note: The component data need to be retrieved after
+		 * the dev data has been invalidated.
+		 */
+		cd = comp_get_drvdata(dev);
+		dcache_invalidate_region(cd, sizeof(*cd));
+
+		if (cd->state)
+			dcache_invalidate_region(cd->state, cd->state_size);
+
+		if (cd->config)
+			dcache_invalidate_region(cd->config, cd->config->size);
+		break;
+	}
+}
+
+struct comp_driver comp_voice = {
+	.type = SOF_COMP_VOICE,
+	.ops = {
+		.new = voice_new,
+		.free = voice_free,
+		.params = voice_params,
+		.cmd = voice_cmd,
+		.trigger = voice_trigger,
+		.copy = voice_copy,
+		.prepare = voice_prepare,
+		.reset = voice_reset,
+		.cache = voice_cache,
+	},
+};
+
+void sys_comp_voice_init(void)
+{
+	comp_register(&comp_voice);
+}
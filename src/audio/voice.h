@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Seppo Ingalsuo <seppo.ingalsuo@linux.intel.com>
+ */
+
+#ifndef VOICE_H
+#define VOICE_H
+
+#include <stdint.h>
+#include <sof/audio/component.h>
+#include <uapi/user/voice.h>
+#include "iir.h"
+#include "src.h"
+
+#define trace_voice(__e, ...) \
+	trace_event(TRACE_CLASS_VOICE, __e, ##__VA_ARGS__)
+#define tracev_voice(__e, ...) \
+	tracev_event(TRACE_CLASS_VOICE, __e, ##__VA_ARGS__)
+#define trace_voice_error(__e, ...) \
+	trace_error(TRACE_CLASS_VOICE, __e, ##__VA_ARGS__)
+
+/* High-pass delay line bytes per channel, any response layout fits */
+#define VOICE_IIR_DELAY_SIZE \
+	(SOF_EQ_IIR_DF2T_BIQUADS_MAX * IIR_DF2T_NUM_DELAYS * sizeof(int64_t))
+
+struct voice_data;
+
+/* Filters and scales frames from x to y, x and y may be the same */
+typedef void (*voice_func)(struct voice_data *cd, int nch, const void *x,
+			   void *y, int frames);
+
+/* voice front end component private data */
+struct voice_data {
+	struct iir_state_df2t iir[PLATFORM_MAX_CHANNELS]; /* high-pass */
+	int32_t gain[PLATFORM_MAX_CHANNELS]; /* Q8.16 */
+	struct polyphase_src src;
+	struct src_param param;
+	struct sof_voice_config *config;
+	struct sof_voice_config *config_new; /* staged while running */
+	void *state; /* IIR and SRC delay lines from pipeline arena */
+	size_t state_size;
+	struct comp_dirty state_dirty; /* state written since writeback */
+	int64_t *iir_delay;
+	int32_t *delay_lines; /* SRC stage buffer and delay lines */
+	int32_t *sbuf_w_ptr;
+	int32_t *sbuf_r_ptr;
+	int sbuf_avail;
+	int stages; /* SRC stages, 0 for equal rates */
+	uint32_t source_rate;
+	uint32_t sink_rate;
+	int prefill;
+	int data_shift;
+	void (*polyphase_func)(struct src_stage_prm *s);
+	voice_func voice_func;
+};
+
+void voice_s16(struct voice_data *cd, int nch, const void *x, void *y,
+	       int frames);
+
+void voice_s24(struct voice_data *cd, int nch, const void *x, void *y,
+	       int frames);
+
+void voice_s32(struct voice_data *cd, int nch, const void *x, void *y,
+	       int frames);
+
+#endif
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Seppo Ingalsuo <seppo.ingalsuo@linux.intel.com>
+ */
+
+#include <stdint.h>
+#include <sof/audio/format.h>
+#include "voice.h"
+
+/* The high-pass output in Q1.31 is scaled with the Q8.16 gain to Q9.47 */
+
+void voice_s16(struct voice_data *cd, int nch, const void *x, void *y,
+	       int frames)
+{
+	const int16_t *in = x;
+	int16_t *out = y;
+	int32_t tmp;
+	int ch;
+	int i;
+
+	for (i = 0; i < frames; i++) {
+		for (ch = 0; ch < nch; ch++) {
+			tmp = iir_df2t(&cd->iir[ch], *in++ << 16);
+			*out++ = sat_int16(Q_SHIFT_RND((int64_t)tmp *
+						       cd->gain[ch], 47, 15));
+		}
+	}
+}
+
+void voice_s24(struct voice_data *cd, int nch, const void *x, void *y,
+	       int frames)
+{
+	const int32_t *in = x;
+	int32_t *out = y;
+	int32_t tmp;
+	int ch;
+	int i;
+
+	for (i = 0; i < frames; i++) {
+		for (ch = 0; ch < nch; ch++) {
+			tmp = iir_df2t(&cd->iir[ch], *in++ << 8);
+			*out++ = sat_int24(Q_SHIFT_RND((int64_t)tmp *
+						       cd->gain[ch], 47, 23));
+		}
+	}
+}
+
+void voice_s32(struct voice_data *cd, int nch, const void *x, void *y,
+	       int frames)
+{
+	const int32_t *in = x;
+	int32_t *out = y;
+	int32_t tmp;
+	int ch;
+	int i;
+
+	for (i = 0; i < frames; i++) {
+		for (ch = 0; ch < nch; ch++) {
+			tmp = iir_df2t(&cd->iir[ch], *in++);
+			*out++ = sat_int32(Q_SHIFT_RND((int64_t)tmp *
+						       cd->gain[ch], 47, 31));
+		}
+	}
+}
@@ -45,12 +45,14 @@
 #include <sof/list.h>
 #include <sof/stream.h>
 #include <sof/alloc.h>
-#include <sof/work.h>
 #include <sof/clk.h>
 #include <sof/ipc.h>
+#include <sof/mailbox.h>
 #include "volume.h"
 #include <sof/math/numbers.h>
 
+extern struct ipc *_ipc;
+
 /**
  * \brief Synchronize host mmap() volume with real value.
  * \param[in,out] cd Volume component private data.
@@ -81,66 +83,103 @@ static void vol_update(struct comp_data *cd, uint32_t chan)
 }
 
 /**
- * \brief Ramps volume changes over time.
- * \param[in,out] data Volume base component device.
- * \param[in] delay Update time.
- * \return Time until next work.
+ * \brief Computes volume at the end of the next period.
+ * \param[in,out] dev Volume base component device.
+ *
+ * Ramp progress is derived from the number of frames processed since the
+ * ramp started, so it does not depend on period length or the accumulated
+ * rounding of per period steps. The processing function ramps linearly
+ * from volume[] to rvolume[] within the period.
  */
-static uint64_t vol_work(void *data, uint64_t delay)
+static void vol_ramp_period(struct comp_dev *dev)
 {
-	struct comp_dev *dev = (struct comp_dev *)data;
 	struct comp_data *cd = comp_get_drvdata(dev);
+	uint32_t delta = VOL_MAX;
 	uint32_t vol;
-	int again = 0;
-	int i, new_vol;
+	int i;
+
+	cd->ramp = false;
 
-	/* inc/dec each volume if it's not at target */
 	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++) {
+		if (cd->volume[i] != cd->tvolume[i])
+			break;
+	}
 
-		/* skip if target reached */
-		if (cd->volume[i] == cd->tvolume[i])
-			continue;
+	/* all channels at target */
+	if (i == PLATFORM_MAX_CHANNELS)
+		return;
 
-		vol = cd->volume[i];
+	/* VOL_RAMP_STEP is defined per VOL_RAMP_US of audio */
+	cd->ramp_frames += dev->frames;
+	if (dev->params.rate)
+		delta = (uint64_t)VOL_RAMP_STEP * cd->ramp_frames *
+			(1000000 / VOL_RAMP_US) / dev->params.rate;
 
-		if (cd->volume[i] < cd->tvolume[i]) {
-			/* ramp up */
-			vol += VOL_RAMP_STEP;
+	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++) {
+		vol = cd->svolume[i];
 
-			/* ramp completed ? */
-			if (vol >= cd->tvolume[i] || vol >= cd->max_volume)
-				vol_update(cd, i);
-			else {
-				cd->volume[i] = vol;
-				again = 1;
-			}
-		} else {
-			/* ramp down */
-			new_vol = vol - VOL_RAMP_STEP;
-			if (new_vol <= 0) {
-				/* cannot ramp down below 0 */
-				vol_update(cd, i);
-			} else {
-				/* ramp completed ? */
-				if (new_vol <= cd->tvolume[i] ||
-					new_vol <= cd->min_volume) {
-					vol_update(cd, i);
-				} else {
-					cd->volume[i] = new_vol;
-					again = 1;
-				}
-			}
+		if (vol < cd->tvolume[i]) {
+			/* ramp up */
+			if (cd->tvolume[i] - vol > delta)
+				vol += delta;
+			else
+				vol = cd->tvolume[i];
+		} else if (vol > cd->tvolume[i]) {
+			/* ramp down, cannot ramp below target */
+			if (vol - cd->tvolume[i] > delta)
+				vol -= delta;
+			else
+				vol = cd->tvolume[i];
 		}
 
-		/* sync host with new value */
+		cd->rvolume[i] = vol;
+		if (vol != cd->volume[i])
+			cd->ramp = true;
+	}
+}
+
+/**
+ * \brief Completes volume ramp of the processed period.
+ * \param[in,out] cd Volume component private data.
+ */
+static void vol_ramp_done(struct comp_data *cd)
+{
+	int i;
+
+	if (!cd->ramp)
+		return;
+
+	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++) {
+		if (cd->volume[i] == cd->rvolume[i])
+			continue;
+
+		cd->volume[i] = cd->rvolume[i];
 		vol_sync_host(cd, i);
 	}
+}
 
-	/* do we need to continue ramping */
-	if (again)
-		return VOL_RAMP_US;
-	else
-		return 0;
+/**
+ * \brief Applies new target volumes.
+ * \param[in,out] dev Volume base component device.
+ *
+ * Volume is ramped by copy() while the stream is running, otherwise
+ * the target volume is set immediately.
+ */
+static void vol_set_target(struct comp_dev *dev)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	int i;
+
+	if (dev->state == COMP_STATE_ACTIVE) {
+		/* restart ramp from the current volume */
+		for (i = 0; i < PLATFORM_MAX_CHANNELS; i++)
+			cd->svolume[i] = cd->volume[i];
+		cd->ramp_frames = 0;
+		return;
+	}
+
+	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++)
+		vol_update(cd, i);
 }
 
 /**
@@ -182,6 +221,12 @@ static struct comp_dev *volume_new(struct sof_ipc_comp *comp)
 		return NULL;
 	}
 
+	if (ipc_vol->precision > SOF_VOLUME_PRECISION_Q1_15) {
+		trace_volume_error("volume_new() error: invalid precision %u",
+				   ipc_vol->precision);
+		return NULL;
+	}
+
 	dev = rzalloc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM,
 		COMP_SIZE(struct sof_ipc_comp_volume));
 	if (dev == NULL)
@@ -197,7 +242,7 @@ static struct comp_dev *volume_new(struct sof_ipc_comp *comp)
 	}
 
 	comp_set_drvdata(dev, cd);
-	work_init(&cd->volwork, vol_work, dev, WORK_ASYNC);
+	cd->precision = ipc_vol->precision;
 
 	/* set volume min/max levels */
 	vol_set_min_max_levels(cd, ipc_vol->min_value, ipc_vol->max_value);
@@ -209,6 +254,8 @@ static struct comp_dev *volume_new(struct sof_ipc_comp *comp)
 		cd->tvolume[i] =  cd->volume[i];
 	}
 
+	dev->can_schedule = 1;
+	dev->can_idle = 1;
 	dev->state = COMP_STATE_READY;
 	return dev;
 }
@@ -223,6 +270,9 @@ static void volume_free(struct comp_dev *dev)
 
 	trace_volume("volume_free()");
 
+	if (cd->mmap)
+		ipc_put_vol_offset(_ipc, dev);
+
 	rfree(cd);
 	rfree(dev);
 }
@@ -300,6 +350,75 @@ static inline void volume_set_chan_unmute(struct comp_dev *dev, int chan)
 		cd->tvolume[chan] = cd->mvolume[chan];
 }
 
+/**
+ * \brief Maps or unmaps channel target volumes to the stream region.
+ * \param[in,out] dev Volume base component device.
+ * \param[in,out] cdata Control command data, slot offset on return.
+ * \return Error code.
+ *
+ * The slot is seeded with the current targets so the volume does not move
+ * until the host writes a new value.
+ */
+static int vol_mmap(struct comp_dev *dev, struct sof_ipc_ctrl_data *cdata)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	struct sof_ipc_ctrl_mmap_vol vol;
+	int offset;
+	int i;
+
+	if (!cdata->chanv[0].value) {
+		if (cd->mmap)
+			ipc_put_vol_offset(_ipc, dev);
+		cd->mmap = false;
+		return 0;
+	}
+
+	offset = ipc_get_vol_offset(_ipc, dev);
+	if (offset < 0) {
+		trace_volume_error("vol_mmap() error: no free slot");
+		return offset;
+	}
+
+	for (i = 0; i < SOF_IPC_MAX_CHANNELS; i++) {
+		vol.value[i] = cd->tvolume[i];
+		cd->mmap_last[i] = cd->tvolume[i];
+	}
+	mailbox_stream_write(offset, &vol, sizeof(vol));
+
+	cd->mmap_offset = offset;
+	cd->mmap = true;
+	cdata->chanv[0].value = offset;
+
+	trace_volume("vol_mmap(), offset = %u", offset);
+
+	return 0;
+}
+
+/**
+ * \brief Applies target volumes changed by the host in the mapped slot.
+ * \param[in,out] dev Volume base component device.
+ */
+static void vol_mmap_poll(struct comp_dev *dev)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	struct sof_ipc_ctrl_mmap_vol *vol;
+	bool changed = false;
+	int i;
+
+	vol = mailbox_stream_data(cd->mmap_offset, sizeof(*vol));
+
+	for (i = 0; i < SOF_IPC_MAX_CHANNELS; i++) {
+		if (vol->value[i] != cd->mmap_last[i]) {
+			cd->mmap_last[i] = vol->value[i];
+			volume_set_chan(dev, i, cd->mmap_last[i]);
+			changed = true;
+		}
+	}
+
+	if (changed)
+		vol_set_target(dev);
+}
+
 /**
  * \brief Sets volume control command.
  * \param[in,out] dev Volume base component device.
@@ -309,7 +428,6 @@ static inline void volume_set_chan_unmute(struct comp_dev *dev, int chan)
 static int volume_ctrl_set_cmd(struct comp_dev *dev,
 			       struct sof_ipc_ctrl_data *cdata)
 {
-	struct comp_data *cd = comp_get_drvdata(dev);
 	int i;
 	int j;
 
@@ -339,7 +457,7 @@ static int volume_ctrl_set_cmd(struct comp_dev *dev,
 						   "invalid i = %u", i);
 			}
 		}
-		work_schedule_default(&cd->volwork, VOL_RAMP_US);
+		vol_set_target(dev);
 		break;
 
 	case SOF_CTRL_CMD_SWITCH:
@@ -364,9 +482,14 @@ static int volume_ctrl_set_cmd(struct comp_dev *dev,
 						   "invalid i = %u", i);
 			}
 		}
-		work_schedule_default(&cd->volwork, VOL_RAMP_US);
+		vol_set_target(dev);
 		break;
 
+	case SOF_CTRL_CMD_MMAP_VOLUME:
+		trace_volume("volume_ctrl_set_cmd(), SOF_CTRL_CMD_MMAP_VOLUME, "
+			     "cdata->comp_id = %u", cdata->comp_id);
+		return vol_mmap(dev, cdata);
+
 	default:
 		trace_volume_error("volume_ctrl_set_cmd() error: "
 				   "invalid cdata->cmd");
@@ -402,7 +525,7 @@ static int volume_ctrl_get_cmd(struct comp_dev *dev,
 			    "SOF_CTRL_CMD_SWITCH, cdata->comp_id = %u",
 			    cdata->comp_id);
 		for (j = 0; j < cdata->num_elems; j++) {
-			cdata->chanv[j].channel = j;
+			cdata->chanv[j].channel = j;
 			cdata->chanv[j].value = cd->tvolume[j];
 			trace_volume("volume_ctrl_set_cmd(), "
 				     "channel = %u, value = %u",
@@ -455,6 +578,98 @@ static int volume_trigger(struct comp_dev *dev, int cmd)
 	return comp_set_state(dev, cmd);
 }
 
+/**
+ * \brief Checks if volume can pass stream data through unchanged.
+ * \param[in] dev Volume base component device.
+ * \return True if all channels are at unity gain and not ramping.
+ */
+static bool vol_is_passthrough(struct comp_dev *dev)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	int i;
+
+	if (cd->ramp || cd->source_format != cd->sink_format)
+		return false;
+
+	for (i = 0; i < dev->params.channels; i++) {
+		if (cd->volume[i] != VOL_ZERO_DB)
+			return false;
+	}
+
+	return true;
+}
+
+/**
+ * \brief Copies dev->frames of stream data without scaling.
+ * \param[in,out] dev Volume base component device.
+ * \param[in,out] sink Destination buffer.
+ * \param[in,out] source Source buffer.
+ */
+static void vol_passthrough(struct comp_dev *dev, struct comp_buffer *sink,
+			    struct comp_buffer *source)
+{
+	uint32_t bytes = dev->frames * dev->frame_bytes;
+	uint8_t *src = source->r_ptr;
+	uint8_t *dest = sink->w_ptr;
+	uint32_t n;
+
+	while (bytes) {
+		/* copy up to the nearest buffer end */
+		n = buffer_segment_samples(source, src, 1, sink, dest, 1,
+					   bytes);
+		memcpy(dest, src, n);
+		bytes -= n;
+
+		src = buffer_wrap(source, src + n);
+		dest = buffer_wrap(sink, dest + n);
+	}
+}
+
+/**
+ * \brief Scales a period in parts split at scheduled control events.
+ * \param[in,out] dev Volume base component device.
+ * \param[in,out] sink Destination buffer.
+ * \param[in,out] source Source buffer, same as sink when in place.
+ *
+ * The ramp and the kernels process dev->frames from source r_ptr to sink
+ * w_ptr, these are set for each part and restored for the caller.
+ */
+static void vol_process(struct comp_dev *dev, struct comp_buffer *sink,
+			struct comp_buffer *source)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	uint32_t period_frames = dev->frames;
+	uint32_t source_frame_bytes = cd->source_period_bytes / period_frames;
+	void *r_ptr = source->r_ptr;
+	void *w_ptr = sink->w_ptr;
+	uint32_t frames = period_frames;
+	uint32_t n;
+
+	while (frames) {
+		n = comp_event_run(dev, frames);
+		dev->frames = n;
+
+		vol_ramp_period(dev);
+		if (!vol_is_passthrough(dev))
+			cd->scale_vol(dev, sink, source);
+		else if (sink != source)
+			vol_passthrough(dev, sink, source);
+		vol_ramp_done(cd);
+
+		comp_event_advance(dev, n);
+		frames -= n;
+
+		/* a period never wraps so parts can be stepped linearly */
+		source->r_ptr = (uint8_t *)source->r_ptr +
+			n * source_frame_bytes;
+		sink->w_ptr = (uint8_t *)sink->w_ptr + n * dev->frame_bytes;
+	}
+
+	dev->frames = period_frames;
+	source->r_ptr = r_ptr;
+	sink->w_ptr = w_ptr;
+}
+
 /**
  * \brief Copies and processes stream data.
  * \param[in,out] dev Volume base component device.
@@ -478,14 +693,14 @@ static int volume_copy(struct comp_dev *dev)
 	 * the sink component buffer has enough free bytes for copy. Also
 	 * check for XRUNs
 	 */
-	if (source->avail < cd->source_period_bytes) {
+	if (comp_buffer_get_avail_bytes(source) < cd->source_period_bytes) {
 		trace_volume_error("volume_copy() error: "
 				   "source component buffer"
 				   " has not enough data available");
 		comp_underrun(dev, source, cd->source_period_bytes, 0);
 		return -EIO;	/* xrun */
 	}
-	if (sink->free < cd->sink_period_bytes) {
+	if (comp_buffer_get_free_bytes(sink) < cd->sink_period_bytes) {
 		trace_volume_error("volume_copy() error: "
 				   "sink component buffer"
 				   " has not enough free bytes for copy");
@@ -493,8 +708,12 @@ static int volume_copy(struct comp_dev *dev)
 		return -EIO;	/* xrun */
 	}
 
-	/* copy and scale volume */
-	cd->scale_vol(dev, sink, source);
+	/* pick up volume moved by the host without IPC */
+	if (cd->mmap)
+		vol_mmap_poll(dev);
+
+	/* copy and scale volume, ramping towards target */
+	vol_process(dev, sink, source);
 
 	/* calc new free and available */
 	comp_update_buffer_produce(sink, cd->sink_period_bytes);
@@ -503,6 +722,54 @@ static int volume_copy(struct comp_dev *dev)
 	return dev->frames;
 }
 
+/**
+ * \brief Processes stream data in place in the source buffer.
+ * \param[in,out] dev Volume base component device.
+ * \param[in,out] buffer Buffer holding the new data.
+ * \param[in,out] ptr Start of new data in buffer.
+ * \param[in] bytes Size of new data.
+ * \return Error code.
+ *
+ * Called by the producer of a buffer standing in for the bypassed volume,
+ * the data is scaled one period at a time before the consumer can read it.
+ */
+static int volume_copy_inplace(struct comp_dev *dev,
+			       struct comp_buffer *buffer, void *ptr,
+			       uint32_t bytes)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	struct comp_buffer view;
+
+	tracev_volume("volume_copy_inplace()");
+
+	if (bytes % cd->source_period_bytes) {
+		trace_volume_error("volume_copy_inplace() error: "
+				   "bytes = %u not in periods", bytes);
+		return -EINVAL;
+	}
+
+	/* scaling kernels read source r_ptr and write sink w_ptr */
+	view.addr = buffer->addr;
+	view.end_addr = buffer->end_addr;
+	view.size = buffer->size;
+
+	if (cd->mmap)
+		vol_mmap_poll(dev);
+
+	while (bytes) {
+		view.r_ptr = ptr;
+		view.w_ptr = ptr;
+
+		vol_process(dev, &view, &view);
+
+		ptr = buffer_wrap(buffer, (uint8_t *)ptr +
+				  cd->source_period_bytes);
+		bytes -= cd->source_period_bytes;
+	}
+
+	return 0;
+}
+
 /**
  * \brief Prepares volume component for processing.
  * \param[in,out] dev Volume base component device.
@@ -586,9 +853,17 @@ static int volume_prepare(struct comp_dev *dev)
 		goto err;
 	}
 
+	/* restart any pending ramp from the current volume */
+	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++)
+		cd->svolume[i] = cd->volume[i];
+	cd->ramp_frames = 0;
+
 	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++)
 		vol_sync_host(cd, i);
 
+	/* scaling does not change the data size so it can run in place */
+	dev->can_inplace = cd->source_format == cd->sink_format;
+
 	return 0;
 
 err:
@@ -605,6 +880,7 @@ static int volume_reset(struct comp_dev *dev)
 {
 	trace_volume("volume_reset()");
 
+	dev->can_inplace = 0;
 	comp_set_state(dev, COMP_TRIGGER_RESET);
 	return 0;
 }
@@ -649,6 +925,7 @@ struct comp_driver comp_volume = {
 		.cmd		= volume_cmd,
 		.trigger	= volume_trigger,
 		.copy		= volume_copy,
+		.copy_inplace	= volume_copy_inplace,
 		.prepare	= volume_prepare,
 		.reset		= volume_reset,
 		.cache		= volume_cache,
@@ -40,6 +40,7 @@
 #define VOLUME_H
 
 #include <stdint.h>
+#include <stdbool.h>
 #include <sof/audio/component.h>
 #include <sof/audio/pipeline.h>
 #include <sof/audio/format.h>
@@ -71,15 +72,16 @@
 #define VOL_QXY_Y 16
 
 /**
- * \brief Volume ramp update rate in microseconds.
- * Update volume gain value every 1 ms.
+ * \brief Volume ramp step time in microseconds.
+ * VOL_RAMP_STEP is the gain change per 1 ms of audio.
  */
 #define VOL_RAMP_US 1000
 
 /**
  * \brief Volume linear ramp length in milliseconds.
  * Use linear ramp length of 250 ms from mute to unity gain. The linear ramp
- * step in Q1.16 to use in vol_work function  is computed from the length.
+ * step in Q1.16 per VOL_RAMP_US is computed from the length and applied
+ * in proportion to the frames processed by volume_copy().
  */
 #define VOL_RAMP_LENGTH_MS 250
 #define VOL_RAMP_STEP Q_CONVERT_FLOAT(1.0 / 1000 * \
@@ -96,6 +98,9 @@
 /** \brief Volume 0dB value. */
 #define VOL_ZERO_DB	(1 << 16)
 
+/** \brief Largest Q1.15 gain, just below 0dB. */
+#define VOL_Q15_MAX	INT16_MAX
+
 /** \brief Volume minimum value. */
 #define VOL_MIN		0
 
@@ -112,14 +117,31 @@ struct comp_data {
 	uint32_t volume[SOF_IPC_MAX_CHANNELS];	/**< current volume */
 	uint32_t tvolume[SOF_IPC_MAX_CHANNELS];	/**< target volume */
 	uint32_t mvolume[SOF_IPC_MAX_CHANNELS];	/**< mute volume */
+	uint32_t rvolume[SOF_IPC_MAX_CHANNELS];	/**< volume at period end */
+	uint32_t svolume[SOF_IPC_MAX_CHANNELS];	/**< ramp start volume */
+	uint32_t ramp_frames;			/**< frames since ramp start */
+	bool ramp;				/**< ramping in this period */
 	uint32_t min_volume;			/**< minimum volume level */
 	uint32_t max_volume;			/**< maximum volume level */
+	uint32_t precision;			/**< SOF_VOLUME_PRECISION_ */
 	void (*scale_vol)(struct comp_dev *dev, struct comp_buffer *sink,
 		struct comp_buffer *source);	/**< volume processing function */
-	struct work volwork;			/**< volume scheduled work function */
 	struct sof_ipc_ctrl_value_chan *hvol;	/**< host volume readback */
+	bool mmap;				/**< volume mapped by host */
+	uint32_t mmap_offset;			/**< stream region slot offset */
+	uint32_t mmap_last[SOF_IPC_MAX_CHANNELS]; /**< last mapped volume */
 };
 
+/**
+ * \brief Converts volume to a Q1.15 gain.
+ * \param[in] vol Volume in Q1.16.
+ * \return Gain in Q1.15, saturated at VOL_Q15_MAX.
+ */
+static inline int16_t vol_gain_q15(uint32_t vol)
+{
+	return vol >> 1 > VOL_Q15_MAX ? VOL_Q15_MAX : vol >> 1;
+}
+
 /** \brief Volume processing functions map. */
 struct comp_func_map {
 	uint16_t source;			/**< source frame format */
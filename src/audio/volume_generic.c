@@ -39,6 +39,7 @@
  */
 
 #include "volume.h"
+#include <sof/audio/kernel.h>
 
 #ifdef CONFIG_GENERIC
 
@@ -111,801 +112,233 @@ static inline int32_t vol_mult_s32_to_s24(int32_t x, int32_t vol)
 }
 
 /**
- * \brief Volume processing from 16 bit to 32 bit in 2 channels.
- * \param[in,out] dev Volume base component device.
- * \param[in,out] sink Destination buffer.
- * \param[in,out] source Source buffer.
- *
- * Copy and scale volume from 16 bit source buffer
- * to 32 bit destination buffer for 2 channels.
- */
-static void vol_s16_to_s32_2ch(struct comp_dev *dev, struct comp_buffer *sink,
-			       struct comp_buffer *source)
-{
-	struct comp_data *cd = comp_get_drvdata(dev);
-	int16_t *src = (int16_t *)source->r_ptr;
-	int32_t *dest = (int32_t *)sink->w_ptr;
-	int32_t i;
-
-	/* buffer sizes are always divisible by period frames */
-	/* Samples are Q1.15 --> Q1.31 and volume is Q1.16 */
-	for (i = 0; i < dev->frames * 2; i += 2) {
-		dest[i] = (int32_t)src[i] * cd->volume[0];
-		dest[i + 1] = (int32_t)src[i + 1] * cd->volume[1];
-	}
-}
-
-/**
- * \brief Volume processing from 32 bit to 16 bit in 2 channels.
- * \param[in,out] dev Volume base component device.
- * \param[in,out] sink Destination buffer.
- * \param[in,out] source Source buffer.
- *
- * Copy and scale volume from 32 bit source buffer
- * to 16 bit destination buffer for 2 channels.
- */
-static void vol_s32_to_s16_2ch(struct comp_dev *dev, struct comp_buffer *sink,
-			       struct comp_buffer *source)
-{
-	struct comp_data *cd = comp_get_drvdata(dev);
-	int32_t *src = (int32_t *)source->r_ptr;
-	int16_t *dest = (int16_t *)sink->w_ptr;
-	int32_t i;
-
-	/* buffer sizes are always divisible by period frames */
-	/* Samples are Q1.31 --> Q1.15 and volume is Q1.16 */
-	for (i = 0; i < dev->frames * 2; i += 2) {
-		dest[i] = vol_mult_s32_to_s16(src[i], cd->volume[0]);
-		dest[i + 1] = vol_mult_s32_to_s16(src[i + 1], cd->volume[1]);
-	}
-}
-
-/**
- * \brief Volume processing from 32 bit to 32 bit in 2 channels.
- * \param[in,out] dev Volume base component device.
- * \param[in,out] sink Destination buffer.
- * \param[in,out] source Source buffer.
- *
- * Copy and scale volume from 32 bit source buffer
- * to 32 bit destination buffer for 2 channels.
- */
-static void vol_s32_to_s32_2ch(struct comp_dev *dev, struct comp_buffer *sink,
-			       struct comp_buffer *source)
-{
-	struct comp_data *cd = comp_get_drvdata(dev);
-	int32_t *src = (int32_t *)source->r_ptr;
-	int32_t *dest = (int32_t *)sink->w_ptr;
-	int32_t i;
-
-	/* buffer sizes are always divisible by period frames */
-	/* Samples are Q1.31 --> Q1.31 and volume is Q1.16 */
-	for (i = 0; i < dev->frames * 2; i += 2) {
-		dest[i] = q_multsr_sat_32x32(
-			src[i], cd->volume[0], Q_SHIFT_BITS_64(31, 16, 31));
-		dest[i + 1] = q_multsr_sat_32x32(
-			src[i + 1], cd->volume[1], Q_SHIFT_BITS_64(31, 16, 31));
-	}
-}
-
-/**
- * \brief Volume processing from 16 bit to 16 bit in 2 channels.
- * \param[in,out] dev Volume base component device.
- * \param[in,out] sink Destination buffer.
- * \param[in,out] source Source buffer.
- *
- * Copy and scale volume from 16 bit source buffer
- * to 16 bit destination buffer for 2 channels.
- */
-static void vol_s16_to_s16_2ch(struct comp_dev *dev, struct comp_buffer *sink,
-			       struct comp_buffer *source)
-{
-	struct comp_data *cd = comp_get_drvdata(dev);
-	int16_t *src = (int16_t *)source->r_ptr;
-	int16_t *dest = (int16_t *)sink->w_ptr;
-	int32_t i;
-
-	/* buffer sizes are always divisible by period frames */
-	/* Samples are Q1.15 --> Q1.15 and volume is Q1.16 */
-	for (i = 0; i < dev->frames * 2; i += 2) {
-		dest[i] = q_multsr_sat_16x16(
-			src[i], cd->volume[0], Q_SHIFT_BITS_32(15, 16, 15));
-		dest[i + 1] = q_multsr_sat_16x16(
-			src[i + 1], cd->volume[1], Q_SHIFT_BITS_32(15, 16, 15));
-	}
-}
-
-/**
- * \brief Volume processing from 16 bit to 24/32 bit in 2 channels.
- * \param[in,out] dev Volume base component device.
- * \param[in,out] sink Destination buffer.
- * \param[in,out] source Source buffer.
- *
- * Copy and scale volume from 16 bit source buffer
- * to 24/32 bit destination buffer for 2 channels.
- */
-static void vol_s16_to_s24_2ch(struct comp_dev *dev, struct comp_buffer *sink,
-			       struct comp_buffer *source)
-{
-	struct comp_data *cd = comp_get_drvdata(dev);
-	int16_t *src = (int16_t *)source->r_ptr;
-	int32_t *dest = (int32_t *)sink->w_ptr;
-	int32_t i;
-
-	/* buffer sizes are always divisible by period frames */
-	/* Samples are Q1.15 and volume is Q1.16 */
-	for (i = 0; i < dev->frames * 2; i += 2) {
-		dest[i] = vol_mult_s16_to_s24(src[i], cd->volume[0]);
-		dest[i + 1] = vol_mult_s16_to_s24(src[i + 1], cd->volume[1]);
-	}
-}
-
-/**
- * \brief Volume processing from 24/32 bit to 16 bit in 2 channels.
- * \param[in,out] dev Volume base component device.
- * \param[in,out] sink Destination buffer.
- * \param[in,out] source Source buffer.
- *
- * Copy and scale volume from 24/32 bit source buffer
- * to 16 bit destination buffer for 2 channels.
- */
-static void vol_s24_to_s16_2ch(struct comp_dev *dev, struct comp_buffer *sink,
-			       struct comp_buffer *source)
-{
-	struct comp_data *cd = comp_get_drvdata(dev);
-	int32_t *src = (int32_t *)source->r_ptr;
-	int16_t *dest = (int16_t *)sink->w_ptr;
-	int32_t i;
-
-	/* buffer sizes are always divisible by period frames */
-	/* Samples are Q1.23 --> Q1.15 and volume is Q1.16 */
-	for (i = 0; i < dev->frames * 2; i += 2) {
-		dest[i] = vol_mult_s24_to_s16(src[i], cd->volume[0]);
-		dest[i + 1] = vol_mult_s24_to_s16(src[i + 1], cd->volume[1]);
-	}
-}
-
-/**
- * \brief Volume processing from 32 bit to 24/32 bit in 2 channels.
- * \param[in,out] dev Volume base component device.
- * \param[in,out] sink Destination buffer.
- * \param[in,out] source Source buffer.
- *
- * Copy and scale volume from 32 bit source buffer
- * to 24/32 bit destination buffer for 2 channels.
- */
-static void vol_s32_to_s24_2ch(struct comp_dev *dev, struct comp_buffer *sink,
-			       struct comp_buffer *source)
-{
-	struct comp_data *cd = comp_get_drvdata(dev);
-	int32_t *src = (int32_t *)source->r_ptr;
-	int32_t *dest = (int32_t *)sink->w_ptr;
-	int32_t i;
-
-	/* buffer sizes are always divisible by period frames */
-	/* Samples are Q1.31 --> Q1.23 and volume is Q1.16 */
-	for (i = 0; i < dev->frames * 2; i += 2) {
-		dest[i] = vol_mult_s32_to_s24(src[i], cd->volume[0]);
-		dest[i + 1] = vol_mult_s32_to_s24(src[i + 1], cd->volume[1]);
-	}
-}
-
-/**
- * \brief Volume processing from 24/32 bit to 32 bit in 2 channels.
- * \param[in,out] dev Volume base component device.
- * \param[in,out] sink Destination buffer.
- * \param[in,out] source Source buffer.
- *
- * Copy and scale volume from 24/32 bit source buffer
- * to 32 bit destination buffer for 2 channels.
- */
-static void vol_s24_to_s32_2ch(struct comp_dev *dev, struct comp_buffer *sink,
-			       struct comp_buffer *source)
-{
-	struct comp_data *cd = comp_get_drvdata(dev);
-	int32_t *src = (int32_t *)source->r_ptr;
-	int32_t *dest = (int32_t *)sink->w_ptr;
-	int32_t i;
-
-	/* buffer sizes are always divisible by period frames */
-	/* Samples are Q1.23 --> Q1.31 and volume is Q1.16 */
-	for (i = 0; i < dev->frames * 2; i += 2) {
-		dest[i] = q_multsr_sat_32x32(
-			sign_extend_s24(src[i]), cd->volume[0],
-			Q_SHIFT_BITS_64(23, 16, 31));
-		dest[i + 1] = q_multsr_sat_32x32(
-			sign_extend_s24(src[i + 1]), cd->volume[1],
-			Q_SHIFT_BITS_64(23, 16, 31));
-	}
-}
-
-/**
- * \brief Volume processing from 24/32 bit to 24/32 bit in 2 channels.
- * \param[in,out] dev Volume base component device.
- * \param[in,out] sink Destination buffer.
- * \param[in,out] source Source buffer.
- *
- * Copy and scale volume from 24/32 bit source buffer
- * to 24/32 bit destination buffer for 2 channels.
- */
-static void vol_s24_to_s24_2ch(struct comp_dev *dev, struct comp_buffer *sink,
-			       struct comp_buffer *source)
-{
-	struct comp_data *cd = comp_get_drvdata(dev);
-	int32_t i, *src = (int32_t *)source->r_ptr;
-	int32_t *dest = (int32_t *)sink->w_ptr;
-
-	/* buffer sizes are always divisible by period frames */
-	/* Samples are Q1.23 --> Q1.23 and volume is Q1.16 */
-	for (i = 0; i < dev->frames * 2; i += 2) {
-		dest[i] = vol_mult_s24_to_s24(src[i], cd->volume[0]);
-		dest[i + 1] = vol_mult_s24_to_s24(src[i + 1], cd->volume[1]);
-	}
-}
-
-#if PLATFORM_MAX_CHANNELS >= 4
-/**
- * \brief Volume processing from 16 bit to 32 bit in 4 channels.
- * \param[in,out] dev Volume base component device.
- * \param[in,out] sink Destination buffer.
- * \param[in,out] source Source buffer.
- *
- * Copy and scale volume from 16 bit source buffer
- * to 32 bit destination buffer for 4 channels.
- */
-static void vol_s16_to_s32_4ch(struct comp_dev *dev, struct comp_buffer *sink,
-			       struct comp_buffer *source)
-{
-	struct comp_data *cd = comp_get_drvdata(dev);
-	int16_t *src = (int16_t *)source->r_ptr;
-	int32_t *dest = (int32_t *)sink->w_ptr;
-	int32_t i;
-
-	/* buffer sizes are always divisible by period frames */
-	/* Samples are Q1.15 --> Q1.31 and volume is Q1.16 */
-	for (i = 0; i < dev->frames * 4; i += 4) {
-		dest[i] = (int32_t)src[i] * cd->volume[0];
-		dest[i + 1] = (int32_t)src[i + 1] * cd->volume[1];
-		dest[i + 2] = (int32_t)src[i + 2] * cd->volume[2];
-		dest[i + 3] = (int32_t)src[i + 3] * cd->volume[3];
-	}
-}
-
-/**
- * \brief Volume processing from 32 bit to 16 bit in 4 channels.
- * \param[in,out] dev Volume base component device.
- * \param[in,out] sink Destination buffer.
- * \param[in,out] source Source buffer.
+ * \brief Volume s16 to s16 multiply function
+ * \param[in] x   input sample.
+ * \param[in] vol gain.
+ * \return output sample.
  *
- * Copy and scale volume from 32 bit source buffer
- * to 16 bit destination buffer for 4 channels.
+ * Volume multiply for 16 bit input and 16 bit bit output.
  */
-static void vol_s32_to_s16_4ch(struct comp_dev *dev, struct comp_buffer *sink,
-			       struct comp_buffer *source)
+static inline int16_t vol_mult_s16_to_s16(int16_t x, int32_t vol)
 {
-	struct comp_data *cd = comp_get_drvdata(dev);
-	int32_t *src = (int32_t *)source->r_ptr;
-	int16_t *dest = (int16_t *)sink->w_ptr;
-	int32_t i;
-
-	/* buffer sizes are always divisible by period frames */
-	/* Samples are Q1.31 --> Q1.15 and volume is Q1.16 */
-	for (i = 0; i < dev->frames * 4; i += 4) {
-		dest[i] = vol_mult_s32_to_s16(src[i], cd->volume[0]);
-		dest[i + 1] = vol_mult_s32_to_s16(src[i + 1], cd->volume[1]);
-		dest[i + 2] = vol_mult_s32_to_s16(src[i + 2], cd->volume[2]);
-		dest[i + 3] = vol_mult_s32_to_s16(src[i + 3], cd->volume[3]);
-	}
+	return q_multsr_sat_16x16(x, vol, Q_SHIFT_BITS_32(15, 16, 15));
 }
 
 /**
- * \brief Volume processing from 32 bit to 32 bit in 4 channels.
- * \param[in,out] dev Volume base component device.
- * \param[in,out] sink Destination buffer.
- * \param[in,out] source Source buffer.
+ * \brief Volume s16 to s32 multiply function
+ * \param[in] x   input sample.
+ * \param[in] vol gain.
+ * \return output sample.
  *
- * Copy and scale volume from 32 bit source buffer
- * to 32 bit destination buffer for 4 channels.
+ * Volume multiply for 16 bit input and 32 bit bit output. Samples are
+ * Q1.15 --> Q1.31 and volume is Q1.16 so the product needs no shift.
  */
-static void vol_s32_to_s32_4ch(struct comp_dev *dev, struct comp_buffer *sink,
-			       struct comp_buffer *source)
+static inline int32_t vol_mult_s16_to_s32(int16_t x, int32_t vol)
 {
-	struct comp_data *cd = comp_get_drvdata(dev);
-	int32_t *src = (int32_t *)source->r_ptr;
-	int32_t *dest = (int32_t *)sink->w_ptr;
-	int32_t i;
-
-	/* buffer sizes are always divisible by period frames */
-	/* Samples are Q1.31 --> Q1.31 and volume is Q1.16 */
-	for (i = 0; i < dev->frames * 4; i += 4) {
-		dest[i] = q_multsr_sat_32x32(src[i], cd->volume[0],
-					     Q_SHIFT_BITS_64(31, 16, 31));
-		dest[i + 1] = q_multsr_sat_32x32(src[i + 1], cd->volume[1],
-						 Q_SHIFT_BITS_64(31, 16, 31));
-		dest[i + 2] = q_multsr_sat_32x32(src[i + 2], cd->volume[2],
-						 Q_SHIFT_BITS_64(31, 16, 31));
-		dest[i + 3] = q_multsr_sat_32x32(src[i + 3], cd->volume[3],
-						 Q_SHIFT_BITS_64(31, 16, 31));
-	}
+	return (int32_t)x * vol;
 }
 
 /**
- * \brief Volume processing from 16 bit to 16 bit in 4 channels.
- * \param[in,out] dev Volume base component device.
- * \param[in,out] sink Destination buffer.
- * \param[in,out] source Source buffer.
+ * \brief Volume s24 to s32 multiply function
+ * \param[in] x   input sample.
+ * \param[in] vol gain.
+ * \return output sample.
  *
- * Copy and scale volume from 16 bit source buffer
- * to 16 bit destination buffer for 4 channels.
+ * Volume multiply for 24 bit input and 32 bit bit output.
  */
-static void vol_s16_to_s16_4ch(struct comp_dev *dev, struct comp_buffer *sink,
-			       struct comp_buffer *source)
+static inline int32_t vol_mult_s24_to_s32(int32_t x, int32_t vol)
 {
-	struct comp_data *cd = comp_get_drvdata(dev);
-	int16_t *src = (int16_t *)source->r_ptr;
-	int16_t *dest = (int16_t *)sink->w_ptr;
-	int32_t i;
-
-	/* buffer sizes are always divisible by period frames */
-	/* Samples are Q1.15 --> Q1.15 and volume is Q1.16 */
-	for (i = 0; i < dev->frames * 4; i += 4) {
-		dest[i] = q_multsr_sat_16x16(src[i], cd->volume[0],
-					     Q_SHIFT_BITS_32(15, 16, 15));
-		dest[i + 1] = q_multsr_sat_16x16(src[i + 1], cd->volume[1],
-						 Q_SHIFT_BITS_32(15, 16, 15));
-		dest[i + 2] = q_multsr_sat_16x16(src[i + 2], cd->volume[2],
-						 Q_SHIFT_BITS_32(15, 16, 15));
-		dest[i + 3] = q_multsr_sat_16x16(src[i + 3], cd->volume[3],
-						 Q_SHIFT_BITS_32(15, 16, 15));
-	}
+	return q_multsr_sat_32x32(sign_extend_s24(x), vol,
+				  Q_SHIFT_BITS_64(23, 16, 31));
 }
 
 /**
- * \brief Volume processing from 16 bit to 24/32 bit in 4 channels.
- * \param[in,out] dev Volume base component device.
- * \param[in,out] sink Destination buffer.
- * \param[in,out] source Source buffer.
+ * \brief Volume s32 to s32 multiply function
+ * \param[in] x   input sample.
+ * \param[in] vol gain.
+ * \return output sample.
  *
- * Copy and scale volume from 16 bit source buffer
- * to 24/32 bit destination buffer for 4 channels.
+ * Volume multiply for 32 bit input and 32 bit bit output.
  */
-static void vol_s16_to_s24_4ch(struct comp_dev *dev, struct comp_buffer *sink,
-			       struct comp_buffer *source)
+static inline int32_t vol_mult_s32_to_s32(int32_t x, int32_t vol)
 {
-	struct comp_data *cd = comp_get_drvdata(dev);
-	int16_t *src = (int16_t *)source->r_ptr;
-	int32_t *dest = (int32_t *)sink->w_ptr;
-	int32_t i;
-
-	/* buffer sizes are always divisible by period frames */
-	/* Samples are Q1.15 and volume is Q1.16 */
-	for (i = 0; i < dev->frames * 4; i += 4) {
-		dest[i] = vol_mult_s16_to_s24(src[i], cd->volume[0]);
-		dest[i + 1] = vol_mult_s16_to_s24(src[i + 1], cd->volume[1]);
-		dest[i + 2] = vol_mult_s16_to_s24(src[i + 2], cd->volume[2]);
-		dest[i + 3] = vol_mult_s16_to_s24(src[i + 3], cd->volume[3]);
-	}
+	return q_multsr_sat_32x32(x, vol, Q_SHIFT_BITS_64(31, 16, 31));
 }
 
 /**
- * \brief Volume processing from 24/32 bit to 16 bit in 4 channels.
- * \param[in,out] dev Volume base component device.
- * \param[in,out] sink Destination buffer.
- * \param[in,out] source Source buffer.
+ * \brief Supported (source, sink) format pairs.
  *
- * Copy and scale volume from 24/32 bit source buffer
- * to 16 bit destination buffer for 4 channels.
+ * Each pair is processed with its vol_mult_<source>_to_<sink>() function
+ * and gets one kernel per channel count from KERNEL_FOR_EACH_CHANNELS(),
+ * plus one for any other channel count.
  */
-static void vol_s24_to_s16_4ch(struct comp_dev *dev, struct comp_buffer *sink,
-			       struct comp_buffer *source)
-{
-	struct comp_data *cd = comp_get_drvdata(dev);
-	int32_t *src = (int32_t *)source->r_ptr;
-	int16_t *dest = (int16_t *)sink->w_ptr;
-	int32_t i;
+#define VOL_FORMATS(m) \
+	m(s16, s16) \
+	m(s16, s24) \
+	m(s16, s32) \
+	m(s24, s16) \
+	m(s24, s24) \
+	m(s24, s32) \
+	m(s32, s16) \
+	m(s32, s24) \
+	m(s32, s32)
+
+#define VOL_MULT(source_fmt, sink_fmt) \
+	KERNEL_SAMPLE_OP(vol_mult, source_fmt, sink_fmt)
 
-	/* buffer sizes are always divisible by period frames */
-	/* Samples are Q1.23 --> Q1.15 and volume is Q1.16 */
-	for (i = 0; i < dev->frames * 4; i += 4) {
-		dest[i] = vol_mult_s24_to_s16(src[i], cd->volume[0]);
-		dest[i + 1] = vol_mult_s24_to_s16(src[i + 1], cd->volume[1]);
-		dest[i + 2] = vol_mult_s24_to_s16(src[i + 2], cd->volume[2]);
-		dest[i + 3] = vol_mult_s24_to_s16(src[i + 3], cd->volume[3]);
-	}
-}
-
-/**
- * \brief Volume processing from 32 bit to 24/32 bit in 4 channels.
- * \param[in,out] dev Volume base component device.
- * \param[in,out] sink Destination buffer.
- * \param[in,out] source Source buffer.
- *
- * Copy and scale volume from 32 bit source buffer
- * to 24/32 bit destination buffer for 4 channels.
+/*
+ * Copy and scale volume from source buffer to sink buffer for a fixed
+ * number of channels. Buffer sizes are always divisible by period frames
+ * and the constant channel count lets the compiler unroll the frame.
  */
-static void vol_s32_to_s24_4ch(struct comp_dev *dev, struct comp_buffer *sink,
-			       struct comp_buffer *source)
-{
-	struct comp_data *cd = comp_get_drvdata(dev);
-	int32_t *src = (int32_t *)source->r_ptr;
-	int32_t *dest = (int32_t *)sink->w_ptr;
-	int32_t i;
+#define VOL_KERNEL(channels, source_fmt, sink_fmt) \
+static void __hot_text KERNEL_NAME(vol, source_fmt, sink_fmt, channels)( \
+	struct comp_dev *dev, struct comp_buffer *sink, \
+	struct comp_buffer *source) \
+{ \
+	struct comp_data *cd = comp_get_drvdata(dev); \
+	KERNEL_SAMPLE(source_fmt) *src = \
+		(KERNEL_SAMPLE(source_fmt) *)source->r_ptr; \
+	KERNEL_SAMPLE(sink_fmt) *dest = \
+		(KERNEL_SAMPLE(sink_fmt) *)sink->w_ptr; \
+	int32_t i; \
+	int32_t j; \
+ \
+	for (i = 0; i < dev->frames * channels; i += channels) { \
+		for (j = 0; j < channels; j++) \
+			dest[i + j] = VOL_MULT(source_fmt, sink_fmt)( \
+				src[i + j], cd->volume[j]); \
+	} \
+}
+
+/* gain lanes, whole frames of every channel count up to 8 fit in 24 */
+#define VOL_LANES	24
 
-	/* buffer sizes are always divisible by period frames */
-	/* Samples are Q1.31 --> Q1.23 and volume is Q1.16 */
-	for (i = 0; i < dev->frames * 4; i += 4) {
-		dest[i] = vol_mult_s32_to_s24(src[i], cd->volume[0]);
-		dest[i + 1] = vol_mult_s32_to_s24(src[i + 1], cd->volume[1]);
-		dest[i + 2] = vol_mult_s32_to_s24(src[i + 2], cd->volume[2]);
-		dest[i + 3] = vol_mult_s32_to_s24(src[i + 3], cd->volume[3]);
-	}
-}
-
-/**
- * \brief Volume processing from 24/32 bit to 32 bit in 4 channels.
- * \param[in,out] dev Volume base component device.
- * \param[in,out] sink Destination buffer.
- * \param[in,out] source Source buffer.
- *
- * Copy and scale volume from 24/32 bit source buffer
- * to 32 bit destination buffer for 4 channels.
+/*
+ * Copy and scale volume for any number of channels. The channel gains are
+ * repeated over a block of whole frames so the block is scaled as one flat
+ * run of samples against matching gain lanes, a loop the compiler can
+ * vectorize whatever the channel count.
  */
-static void vol_s24_to_s32_4ch(struct comp_dev *dev, struct comp_buffer *sink,
-			       struct comp_buffer *source)
-{
-	struct comp_data *cd = comp_get_drvdata(dev);
-	int32_t *src = (int32_t *)source->r_ptr;
-	int32_t *dest = (int32_t *)sink->w_ptr;
-	int32_t i;
+#define VOL_KERNEL_ANY(source_fmt, sink_fmt) \
+static void __hot_text KERNEL_NAME_ANY(vol, source_fmt, sink_fmt)( \
+	struct comp_dev *dev, struct comp_buffer *sink, \
+	struct comp_buffer *source) \
+{ \
+	struct comp_data *cd = comp_get_drvdata(dev); \
+	KERNEL_SAMPLE(source_fmt) *src = \
+		(KERNEL_SAMPLE(source_fmt) *)source->r_ptr; \
+	KERNEL_SAMPLE(sink_fmt) *dest = \
+		(KERNEL_SAMPLE(sink_fmt) *)sink->w_ptr; \
+	int32_t gain[VOL_LANES]; \
+	int32_t channels = dev->params.channels; \
+	int32_t lanes = VOL_LANES - VOL_LANES % channels; \
+	int32_t samples = dev->frames * channels; \
+	int32_t n; \
+	int32_t i; \
+	int32_t j; \
+ \
+	for (j = 0; j < lanes; j++) \
+		gain[j] = cd->volume[j % channels]; \
+ \
+	for (i = 0; i < samples; i += lanes) { \
+		n = MIN(lanes, samples - i); \
+		for (j = 0; j < n; j++) \
+			dest[i + j] = VOL_MULT(source_fmt, sink_fmt)( \
+				src[i + j], gain[j]); \
+	} \
+}
+
+#define VOL_KERNELS(source_fmt, sink_fmt) \
+	KERNEL_FOR_EACH_CHANNELS(VOL_KERNEL, source_fmt, sink_fmt) \
+	VOL_KERNEL_ANY(source_fmt, sink_fmt)
+
+#define VOL_MAP_ENTRY(channels, source_fmt, sink_fmt) \
+	KERNEL_MAP_ENTRY(vol, source_fmt, sink_fmt, channels)
+
+#define VOL_MAP_ENTRIES(source_fmt, sink_fmt) \
+	KERNEL_FOR_EACH_CHANNELS(VOL_MAP_ENTRY, source_fmt, sink_fmt) \
+	KERNEL_MAP_ENTRY_ANY(vol, source_fmt, sink_fmt)
+
+VOL_FORMATS(VOL_KERNELS)
 
-	/* buffer sizes are always divisible by period frames */
-	/* Samples are Q1.23 --> Q1.31 and volume is Q1.16 */
-	for (i = 0; i < dev->frames * 4; i += 4) {
-		dest[i] = q_multsr_sat_32x32(sign_extend_s24(src[i]),
-					     cd->volume[0],
-					     Q_SHIFT_BITS_64(23, 16, 31));
-		dest[i + 1] = q_multsr_sat_32x32(sign_extend_s24(src[i + 1]),
-						 cd->volume[1],
-						 Q_SHIFT_BITS_64(23, 16, 31));
-		dest[i + 2] = q_multsr_sat_32x32(sign_extend_s24(src[i + 2]),
-						 cd->volume[2],
-						 Q_SHIFT_BITS_64(23, 16, 31));
-		dest[i + 3] = q_multsr_sat_32x32(sign_extend_s24(src[i + 3]),
-						 cd->volume[3],
-						 Q_SHIFT_BITS_64(23, 16, 31));
-	}
-}
+const struct comp_func_map func_map[] = {
+	VOL_FORMATS(VOL_MAP_ENTRIES)
+};
 
 /**
- * \brief Volume processing from 24/32 bit to 24/32 bit in 4 channels.
- * \param[in,out] dev Volume base component device.
- * \param[in,out] sink Destination buffer.
- * \param[in,out] source Source buffer.
+ * \brief Volume Q1.15 multiply function
+ * \param[in] x    input sample.
+ * \param[in] gain Q1.15 gain.
+ * \return output sample.
  *
- * Copy and scale volume from 24/32 bit source buffer
- * to 24/32 bit destination buffer for 4 channels.
+ * Volume multiply for 16 bit input and 16 bit output within 32 bits.
  */
-static void vol_s24_to_s24_4ch(struct comp_dev *dev, struct comp_buffer *sink,
-			       struct comp_buffer *source)
-{
-	struct comp_data *cd = comp_get_drvdata(dev);
-	int32_t i, *src = (int32_t *)source->r_ptr;
-	int32_t *dest = (int32_t *)sink->w_ptr;
-
-	/* buffer sizes are always divisible by period frames */
-	/* Samples are Q1.23 --> Q1.23 and volume is Q1.16 */
-	for (i = 0; i < dev->frames * 4; i += 4) {
-		dest[i] = vol_mult_s24_to_s24(src[i], cd->volume[0]);
-		dest[i + 1] = vol_mult_s24_to_s24(src[i + 1], cd->volume[1]);
-		dest[i + 2] = vol_mult_s24_to_s24(src[i + 2], cd->volume[2]);
-		dest[i + 3] = vol_mult_s24_to_s24(src[i + 3], cd->volume[3]);
-	}
-}
-#endif
-
-#if PLATFORM_MAX_CHANNELS >= 8
-/* volume scaling functions for 8-channel input */
-
-/* copy and scale volume from 16 bit source buffer to 32 bit dest buffer */
-static void vol_s16_to_s32_8ch(struct comp_dev *dev, struct comp_buffer *sink,
-			       struct comp_buffer *source)
+static inline int16_t vol_mult_q15(int16_t x, int16_t gain)
 {
-	struct comp_data *cd = comp_get_drvdata(dev);
-	int16_t *src = (int16_t *)source->r_ptr;
-	int32_t *dest = (int32_t *)sink->w_ptr;
-	int32_t i;
-
-	/* buffer sizes are always divisible by period frames */
-	/* Samples are Q1.15 --> Q1.31 and volume is Q1.16 */
-	for (i = 0; i < dev->frames * 8; i += 8) {
-		dest[i] = (int32_t)src[i] * cd->volume[0];
-		dest[i + 1] = (int32_t)src[i + 1] * cd->volume[1];
-		dest[i + 2] = (int32_t)src[i + 2] * cd->volume[2];
-		dest[i + 3] = (int32_t)src[i + 3] * cd->volume[3];
-		dest[i + 4] = (int32_t)src[i + 4] * cd->volume[4];
-		dest[i + 5] = (int32_t)src[i + 5] * cd->volume[5];
-		dest[i + 6] = (int32_t)src[i + 6] * cd->volume[6];
-		dest[i + 7] = (int32_t)src[i + 7] * cd->volume[7];
-	}
+	return sat_int16(((int32_t)x * gain + (1 << 14)) >> 15);
 }
 
-/* copy and scale volume from 32 bit source buffer to 16 bit dest buffer */
-static void vol_s32_to_s16_8ch(struct comp_dev *dev, struct comp_buffer *sink,
-			       struct comp_buffer *source)
-{
-	struct comp_data *cd = comp_get_drvdata(dev);
-	int32_t *src = (int32_t *)source->r_ptr;
-	int16_t *dest = (int16_t *)sink->w_ptr;
-	int32_t i;
-
-	/* buffer sizes are always divisible by period frames */
-	/* Samples are Q1.31 --> Q1.15 and volume is Q1.16 */
-	for (i = 0; i < dev->frames * 8; i += 8) {
-		dest[i] = vol_mult_s32_to_s16(src[i], cd->volume[0]);
-		dest[i + 1] = vol_mult_s32_to_s16(src[i + 1], cd->volume[1]);
-		dest[i + 2] = vol_mult_s32_to_s16(src[i + 2], cd->volume[2]);
-		dest[i + 3] = vol_mult_s32_to_s16(src[i + 3], cd->volume[3]);
-		dest[i + 4] = vol_mult_s32_to_s16(src[i + 4], cd->volume[4]);
-		dest[i + 5] = vol_mult_s32_to_s16(src[i + 5], cd->volume[5]);
-		dest[i + 6] = vol_mult_s32_to_s16(src[i + 6], cd->volume[6]);
-		dest[i + 7] = vol_mult_s32_to_s16(src[i + 7], cd->volume[7]);
-	}
-}
-
-/* copy and scale volume from 32 bit source buffer to 32 bit dest buffer */
-static void vol_s32_to_s32_8ch(struct comp_dev *dev, struct comp_buffer *sink,
-			       struct comp_buffer *source)
-{
-	struct comp_data *cd = comp_get_drvdata(dev);
-	int32_t *src = (int32_t *)source->r_ptr;
-	int32_t *dest = (int32_t *)sink->w_ptr;
-	int32_t i;
-
-	/* buffer sizes are always divisible by period frames */
-	/* Samples are Q1.31 --> Q1.31 and volume is Q1.16 */
-	for (i = 0; i < dev->frames * 8; i += 8) {
-		dest[i] = q_multsr_sat_32x32(src[i], cd->volume[0],
-					     Q_SHIFT_BITS_64(31, 16, 31));
-		dest[i + 1] = q_multsr_sat_32x32(src[i + 1], cd->volume[1],
-						 Q_SHIFT_BITS_64(31, 16, 31));
-		dest[i + 2] = q_multsr_sat_32x32(src[i + 2], cd->volume[2],
-						 Q_SHIFT_BITS_64(31, 16, 31));
-		dest[i + 3] = q_multsr_sat_32x32(src[i + 3], cd->volume[3],
-						 Q_SHIFT_BITS_64(31, 16, 31));
-		dest[i + 4] = q_multsr_sat_32x32(src[i + 4], cd->volume[4],
-						 Q_SHIFT_BITS_64(31, 16, 31));
-		dest[i + 5] = q_multsr_sat_32x32(src[i + 5], cd->volume[5],
-						 Q_SHIFT_BITS_64(31, 16, 31));
-		dest[i + 6] = q_multsr_sat_32x32(src[i + 6], cd->volume[6],
-						 Q_SHIFT_BITS_64(31, 16, 31));
-		dest[i + 7] = q_multsr_sat_32x32(src[i + 7], cd->volume[7],
-						 Q_SHIFT_BITS_64(31, 16, 31));
-	}
-}
-
-/* copy and scale volume from 16 bit source buffer to 16 bit dest buffer */
-static void vol_s16_to_s16_8ch(struct comp_dev *dev, struct comp_buffer *sink,
-			       struct comp_buffer *source)
-{
-	struct comp_data *cd = comp_get_drvdata(dev);
-	int16_t *src = (int16_t *)source->r_ptr;
-	int16_t *dest = (int16_t *)sink->w_ptr;
-	int32_t i;
-
-	/* buffer sizes are always divisible by period frames */
-	/* Samples are Q1.15 --> Q1.15 and volume is Q1.16 */
-	for (i = 0; i < dev->frames * 8; i += 8) {
-		dest[i] = q_multsr_sat_16x16(src[i], cd->volume[0],
-					     Q_SHIFT_BITS_32(15, 16, 15));
-		dest[i + 1] = q_multsr_sat_16x16(src[i + 1], cd->volume[1],
-						 Q_SHIFT_BITS_32(15, 16, 15));
-		dest[i + 2] = q_multsr_sat_16x16(src[i + 2], cd->volume[2],
-						 Q_SHIFT_BITS_32(15, 16, 15));
-		dest[i + 3] = q_multsr_sat_16x16(src[i + 3], cd->volume[3],
-						 Q_SHIFT_BITS_32(15, 16, 15));
-		dest[i + 4] = q_multsr_sat_16x16(src[i + 4], cd->volume[4],
-						 Q_SHIFT_BITS_32(15, 16, 15));
-		dest[i + 5] = q_multsr_sat_16x16(src[i + 5], cd->volume[5],
-						 Q_SHIFT_BITS_32(15, 16, 15));
-		dest[i + 6] = q_multsr_sat_16x16(src[i + 6], cd->volume[6],
-						 Q_SHIFT_BITS_32(15, 16, 15));
-		dest[i + 7] = q_multsr_sat_16x16(src[i + 7], cd->volume[7],
-						 Q_SHIFT_BITS_32(15, 16, 15));
-	}
-}
-
-/* copy and scale volume from 16 bit source buffer to 24 bit
- * on 32 bit boundary buffer
+/*
+ * Copy and scale volume from 16 bit to 16 bit with Q1.15 gains for any
+ * number of channels. Same gain lanes as VOL_KERNEL_ANY() but with half
+ * width products, so twice the samples fit each vector.
  */
-static void vol_s16_to_s24_8ch(struct comp_dev *dev, struct comp_buffer *sink,
-			       struct comp_buffer *source)
+static void __hot_text vol_q15_s16_to_s16(struct comp_dev *dev,
+					  struct comp_buffer *sink,
+					  struct comp_buffer *source)
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
 	int16_t *src = (int16_t *)source->r_ptr;
-	int32_t *dest = (int32_t *)sink->w_ptr;
-	int32_t i;
-
-	/* buffer sizes are always divisible by period frames */
-	/* Samples are Q1.15 and volume is Q1.16 */
-	for (i = 0; i < dev->frames * 8; i += 8) {
-		dest[i] = vol_mult_s16_to_s24(src[i], cd->volume[0]);
-		dest[i + 1] = vol_mult_s16_to_s24(src[i + 1], cd->volume[1]);
-		dest[i + 2] = vol_mult_s16_to_s24(src[i + 2], cd->volume[2]);
-		dest[i + 3] = vol_mult_s16_to_s24(src[i + 3], cd->volume[3]);
-		dest[i + 4] = vol_mult_s16_to_s24(src[i + 4], cd->volume[4]);
-		dest[i + 5] = vol_mult_s16_to_s24(src[i + 5], cd->volume[5]);
-		dest[i + 6] = vol_mult_s16_to_s24(src[i + 6], cd->volume[6]);
-		dest[i + 7] = vol_mult_s16_to_s24(src[i + 7], cd->volume[7]);
-	}
-}
-
-/* copy and scale volume from 16 bit source buffer to 24 bit
- * on 32 bit boundary dest buffer
- */
-static void vol_s24_to_s16_8ch(struct comp_dev *dev, struct comp_buffer *sink,
-			       struct comp_buffer *source)
-{
-	struct comp_data *cd = comp_get_drvdata(dev);
-	int32_t *src = (int32_t *)source->r_ptr;
 	int16_t *dest = (int16_t *)sink->w_ptr;
+	int16_t gain[VOL_LANES];
+	int32_t channels = dev->params.channels;
+	int32_t lanes = VOL_LANES - VOL_LANES % channels;
+	int32_t samples = dev->frames * channels;
+	int32_t n;
 	int32_t i;
+	int32_t j;
 
-	/* buffer sizes are always divisible by period frames */
-	/* Samples are Q1.23 --> Q1.15 and volume is Q1.16 */
-	for (i = 0; i < dev->frames * 8; i += 8) {
-		dest[i] = vol_mult_s24_to_s16(src[i], cd->volume[0]);
-		dest[i + 1] = vol_mult_s24_to_s16(src[i + 1], cd->volume[1]);
-		dest[i + 2] = vol_mult_s24_to_s16(src[i + 2], cd->volume[2]);
-		dest[i + 3] = vol_mult_s24_to_s16(src[i + 3], cd->volume[3]);
-		dest[i + 4] = vol_mult_s24_to_s16(src[i + 4], cd->volume[4]);
-		dest[i + 5] = vol_mult_s24_to_s16(src[i + 5], cd->volume[5]);
-		dest[i + 6] = vol_mult_s24_to_s16(src[i + 6], cd->volume[6]);
-		dest[i + 7] = vol_mult_s24_to_s16(src[i + 7], cd->volume[7]);
-	}
-}
-
-/* copy and scale volume from 32 bit source buffer to 24 bit
- * on 32 bit boundary dest buffer
- */
-static void vol_s32_to_s24_8ch(struct comp_dev *dev, struct comp_buffer *sink,
-			       struct comp_buffer *source)
-{
-	struct comp_data *cd = comp_get_drvdata(dev);
-	int32_t *src = (int32_t *)source->r_ptr;
-	int32_t *dest = (int32_t *)sink->w_ptr;
-	int32_t i;
+	for (j = 0; j < lanes; j++)
+		gain[j] = vol_gain_q15(cd->volume[j % channels]);
 
-	/* buffer sizes are always divisible by period frames */
-	/* Samples are Q1.31 --> Q1.23 and volume is Q1.16 */
-	for (i = 0; i < dev->frames * 8; i += 8) {
-		dest[i] = vol_mult_s32_to_s24(src[i], cd->volume[0]);
-		dest[i + 1] = vol_mult_s32_to_s24(src[i + 1], cd->volume[1]);
-		dest[i + 2] = vol_mult_s32_to_s24(src[i + 2], cd->volume[2]);
-		dest[i + 3] = vol_mult_s32_to_s24(src[i + 3], cd->volume[3]);
-		dest[i + 4] = vol_mult_s32_to_s24(src[i + 4], cd->volume[4]);
-		dest[i + 5] = vol_mult_s32_to_s24(src[i + 5], cd->volume[5]);
-		dest[i + 6] = vol_mult_s32_to_s24(src[i + 6], cd->volume[6]);
-		dest[i + 7] = vol_mult_s32_to_s24(src[i + 7], cd->volume[7]);
+	for (i = 0; i < samples; i += lanes) {
+		n = MIN(lanes, samples - i);
+		for (j = 0; j < n; j++)
+			dest[i + j] = vol_mult_q15(src[i + j], gain[j]);
 	}
 }
 
-/* copy and scale volume from 16 bit source buffer to 24 bit
- * on 32 bit boundary dest buffer
- */
-static void vol_s24_to_s32_8ch(struct comp_dev *dev, struct comp_buffer *sink,
-			       struct comp_buffer *source)
-{
-	struct comp_data *cd = comp_get_drvdata(dev);
-	int32_t *src = (int32_t *)source->r_ptr;
-	int32_t *dest = (int32_t *)sink->w_ptr;
-	int32_t i;
-
-	/* buffer sizes are always divisible by period frames */
-	/* Samples are Q1.23 --> Q1.31 and volume is Q1.16 */
-	for (i = 0; i < dev->frames * 8; i += 8) {
-		dest[i] = q_multsr_sat_32x32(sign_extend_s24(src[i]),
-					     cd->volume[0],
-					     Q_SHIFT_BITS_64(23, 16, 31));
-		dest[i + 1] = q_multsr_sat_32x32(sign_extend_s24(src[i + 1]),
-						 cd->volume[1],
-						 Q_SHIFT_BITS_64(23, 16, 31));
-		dest[i + 2] = q_multsr_sat_32x32(sign_extend_s24(src[i + 2]),
-						 cd->volume[2],
-						 Q_SHIFT_BITS_64(23, 16, 31));
-		dest[i + 3] = q_multsr_sat_32x32(sign_extend_s24(src[i + 3]),
-						 cd->volume[3],
-						 Q_SHIFT_BITS_64(23, 16, 31));
-		dest[i + 4] = q_multsr_sat_32x32(sign_extend_s24(src[i + 4]),
-						 cd->volume[4],
-						 Q_SHIFT_BITS_64(23, 16, 31));
-		dest[i + 5] = q_multsr_sat_32x32(sign_extend_s24(src[i + 5]),
-						 cd->volume[5],
-						 Q_SHIFT_BITS_64(23, 16, 31));
-		dest[i + 6] = q_multsr_sat_32x32(sign_extend_s24(src[i + 6]),
-						 cd->volume[6],
-						 Q_SHIFT_BITS_64(23, 16, 31));
-		dest[i + 7] = q_multsr_sat_32x32(sign_extend_s24(src[i + 7]),
-						 cd->volume[7],
-						 Q_SHIFT_BITS_64(23, 16, 31));
-	}
-}
-
-/* Copy and scale volume from 24 bit source buffer to 24 bit on 32 bit boundary
- * dest buffer.
- */
-static void vol_s24_to_s24_8ch(struct comp_dev *dev, struct comp_buffer *sink,
-			       struct comp_buffer *source)
-{
-	struct comp_data *cd = comp_get_drvdata(dev);
-	int32_t i, *src = (int32_t *)source->r_ptr;
-	int32_t *dest = (int32_t *)sink->w_ptr;
-
-	/* buffer sizes are always divisible by period frames */
-	/* Samples are Q1.23 --> Q1.23 and volume is Q1.16 */
-	for (i = 0; i < dev->frames * 8; i += 8) {
-		dest[i] = vol_mult_s24_to_s24(src[i], cd->volume[0]);
-		dest[i + 1] = vol_mult_s24_to_s24(src[i + 1], cd->volume[1]);
-		dest[i + 2] = vol_mult_s24_to_s24(src[i + 2], cd->volume[2]);
-		dest[i + 3] = vol_mult_s24_to_s24(src[i + 3], cd->volume[3]);
-		dest[i + 4] = vol_mult_s24_to_s24(src[i + 4], cd->volume[4]);
-		dest[i + 5] = vol_mult_s24_to_s24(src[i + 5], cd->volume[5]);
-		dest[i + 6] = vol_mult_s24_to_s24(src[i + 6], cd->volume[6]);
-		dest[i + 7] = vol_mult_s24_to_s24(src[i + 7], cd->volume[7]);
-	}
-}
-#endif
-
-const struct comp_func_map func_map[] = {
-	{SOF_IPC_FRAME_S16_LE, SOF_IPC_FRAME_S16_LE, 2, vol_s16_to_s16_2ch},
-	{SOF_IPC_FRAME_S16_LE, SOF_IPC_FRAME_S32_LE, 2, vol_s16_to_s32_2ch},
-	{SOF_IPC_FRAME_S32_LE, SOF_IPC_FRAME_S16_LE, 2, vol_s32_to_s16_2ch},
-	{SOF_IPC_FRAME_S32_LE, SOF_IPC_FRAME_S32_LE, 2, vol_s32_to_s32_2ch},
-	{SOF_IPC_FRAME_S16_LE, SOF_IPC_FRAME_S24_4LE, 2, vol_s16_to_s24_2ch},
-	{SOF_IPC_FRAME_S24_4LE, SOF_IPC_FRAME_S16_LE, 2, vol_s24_to_s16_2ch},
-	{SOF_IPC_FRAME_S32_LE, SOF_IPC_FRAME_S24_4LE, 2, vol_s32_to_s24_2ch},
-	{SOF_IPC_FRAME_S24_4LE, SOF_IPC_FRAME_S32_LE, 2, vol_s24_to_s32_2ch},
-	{SOF_IPC_FRAME_S24_4LE, SOF_IPC_FRAME_S24_4LE, 2, vol_s24_to_s24_2ch},
-#if PLATFORM_MAX_CHANNELS >= 4
-	{SOF_IPC_FRAME_S16_LE, SOF_IPC_FRAME_S16_LE, 4, vol_s16_to_s16_4ch},
-	{SOF_IPC_FRAME_S16_LE, SOF_IPC_FRAME_S32_LE, 4, vol_s16_to_s32_4ch},
-	{SOF_IPC_FRAME_S32_LE, SOF_IPC_FRAME_S16_LE, 4, vol_s32_to_s16_4ch},
-	{SOF_IPC_FRAME_S32_LE, SOF_IPC_FRAME_S32_LE, 4, vol_s32_to_s32_4ch},
-	{SOF_IPC_FRAME_S16_LE, SOF_IPC_FRAME_S24_4LE, 4, vol_s16_to_s24_4ch},
-	{SOF_IPC_FRAME_S24_4LE, SOF_IPC_FRAME_S16_LE, 4, vol_s24_to_s16_4ch},
-	{SOF_IPC_FRAME_S32_LE, SOF_IPC_FRAME_S24_4LE, 4, vol_s32_to_s24_4ch},
-	{SOF_IPC_FRAME_S24_4LE, SOF_IPC_FRAME_S32_LE, 4, vol_s24_to_s32_4ch},
-	{SOF_IPC_FRAME_S24_4LE, SOF_IPC_FRAME_S24_4LE, 4, vol_s24_to_s24_4ch},
-#endif
-#if PLATFORM_MAX_CHANNELS >= 8
-	{SOF_IPC_FRAME_S16_LE, SOF_IPC_FRAME_S16_LE, 8, vol_s16_to_s16_8ch},
-	{SOF_IPC_FRAME_S16_LE, SOF_IPC_FRAME_S32_LE, 8, vol_s16_to_s32_8ch},
-	{SOF_IPC_FRAME_S32_LE, SOF_IPC_FRAME_S16_LE, 8, vol_s32_to_s16_8ch},
-	{SOF_IPC_FRAME_S32_LE, SOF_IPC_FRAME_S32_LE, 8, vol_s32_to_s32_8ch},
-	{SOF_IPC_FRAME_S16_LE, SOF_IPC_FRAME_S24_4LE, 8, vol_s16_to_s24_8ch},
-	{SOF_IPC_FRAME_S24_4LE, SOF_IPC_FRAME_S16_LE, 8, vol_s24_to_s16_8ch},
-	{SOF_IPC_FRAME_S32_LE, SOF_IPC_FRAME_S24_4LE, 8, vol_s32_to_s24_8ch},
-	{SOF_IPC_FRAME_S24_4LE, SOF_IPC_FRAME_S32_LE, 8, vol_s24_to_s32_8ch},
-	{SOF_IPC_FRAME_S24_4LE, SOF_IPC_FRAME_S24_4LE, 8, vol_s24_to_s24_8ch},
-#endif
-};
-
 scale_vol vol_get_processing_function(struct comp_dev *dev)
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
+	scale_vol any = NULL;
 	int i;
 
+	if (!dev->params.channels ||
+	    dev->params.channels > PLATFORM_MAX_CHANNELS)
+		return NULL;
+
+	if (cd->precision == SOF_VOLUME_PRECISION_Q1_15 &&
+	    cd->source_format == SOF_IPC_FRAME_S16_LE &&
+	    cd->sink_format == SOF_IPC_FRAME_S16_LE)
+		return vol_q15_s16_to_s16;
+
 	/* map the volume function for source and sink buffers */
 	for (i = 0; i < ARRAY_SIZE(func_map); i++) {
 		if (cd->source_format != func_map[i].source)
 			continue;
 		if (cd->sink_format != func_map[i].sink)
 			continue;
-		if (dev->params.channels != func_map[i].channels)
-			continue;
 
-		return func_map[i].func;
+		/* prefer a kernel specialised for the channel count */
+		if (func_map[i].channels == KERNEL_ANY_CHANNELS)
+			any = func_map[i].func;
+		else if (dev->params.channels == func_map[i].channels)
+			return func_map[i].func;
 	}
 
-	return NULL;
+	return any;
 }
 
 #endif
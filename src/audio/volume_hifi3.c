@@ -33,7 +33,6 @@
  * \brief Volume HiFi3 processing implementation
  * \authors Tomasz Lauda <tomasz.lauda@linux.intel.com>
  */
-
 #include "volume.h"
 
 #if defined(__XCC__) && XCHAL_HAVE_HIFI3
@@ -43,29 +42,161 @@
 /** \brief Volume scale ratio. */
 #define VOL_SCALE (uint32_t)((double)INT32_MAX / VOL_MAX)
 
+/**
+ * \brief Scaled gains and per frame ramp increments of all channels.
+ *
+ * Stored as channel pairs so the interleaved samples of two channels
+ * can be scaled with a single SIMD operation. Room is left for two frames
+ * of gains, needed when an odd channel count makes pairs straddle frames.
+ */
+struct vol_hifi3_gain {
+	ae_f32x2 gain[SOF_IPC_MAX_CHANNELS];	/**< current gain */
+	ae_f32x2 inc[SOF_IPC_MAX_CHANNELS];	/**< gain increment */
+};
+
+/**
+ * \brief Initializes scaled gains for the period.
+ * \param[in,out] dev Volume base component device.
+ * \param[out] g Scaled gains and ramp increments.
+ *
+ * When ramping the gain of each channel moves linearly from volume[] at
+ * the start of the period to rvolume[] at its end.
+ */
+static void vol_gain_init(struct comp_dev *dev, struct vol_hifi3_gain *g)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	int32_t *gain = (int32_t *)g->gain;
+	int32_t *inc = (int32_t *)g->inc;
+	int32_t end;
+	size_t channel;
+
+	/* Scale to VOL_MAX */
+	for (channel = 0; channel < dev->params.channels; channel++) {
+		gain[channel] = cd->volume[channel] * VOL_SCALE;
+		inc[channel] = 0;
+
+		if (cd->ramp) {
+			end = cd->rvolume[channel] * VOL_SCALE;
+			inc[channel] = (end - gain[channel]) /
+				(int32_t)dev->frames;
+		}
+	}
+}
+
+/**
+ * \brief Checks if the period can be processed in channel pairs.
+ * \param[in] dev Volume base component device.
+ * \param[in] samples Number of samples loaded per SIMD operation.
+ * \return True if channel pairs can be processed.
+ */
+static inline bool vol_pairs_supported(struct comp_dev *dev, int samples)
+{
+	return !((dev->frames * dev->params.channels) % samples);
+}
+
+/**
+ * \brief Lays out the gains as the channel pairs of the SIMD loop.
+ * \param[in] dev Volume base component device.
+ * \param[in,out] g Scaled gains and ramp increments of vol_gain_init().
+ * \return Number of channel pairs before the gains repeat.
+ *
+ * With an odd channel count the pairs straddle frames, so the gains of
+ * two consecutive frames are stored and every lane is stepped by two
+ * frames of ramp each time the pairs wrap.
+ */
+static int vol_pairs_init(struct comp_dev *dev, struct vol_hifi3_gain *g)
+{
+	int32_t *gain = (int32_t *)g->gain;
+	int32_t *inc = (int32_t *)g->inc;
+	size_t channels = dev->params.channels;
+	size_t channel;
+
+	if (!(channels & 1))
+		return channels >> 1;
+
+	for (channel = 0; channel < channels; channel++) {
+		gain[channels + channel] = gain[channel] + inc[channel];
+		inc[channel] *= 2;
+		inc[channels + channel] = inc[channel];
+	}
+
+	return channels;
+}
+
+/**
+ * \brief Returns gain of channel pair and steps its ramp.
+ * \param[in,out] g Scaled gains and ramp increments.
+ * \param[in,out] pair Channel pair index, advanced to the next pair.
+ * \param[in] pairs Number of channel pairs.
+ * \return Gain of the channel pair for the current frame.
+ */
+static inline ae_f32x2 vol_pair_gain(struct vol_hifi3_gain *g, int *pair,
+				     int pairs)
+{
+	ae_f32x2 gain = g->gain[*pair];
+
+	g->gain[*pair] = AE_ADD32S(gain, g->inc[*pair]);
+	*pair = *pair + 1 == pairs ? 0 : *pair + 1;
+
+	return gain;
+}
+
 /**
  * \brief HiFi3 enabled volume processing from 16 bit to 16 bit.
  * \param[in,out] dev Volume base component device.
  * \param[in,out] sink Destination buffer.
  * \param[in,out] source Source buffer.
  */
-static void vol_s16_to_s16(struct comp_dev *dev, struct comp_buffer *sink,
-			   struct comp_buffer *source)
+static void __hot_text vol_s16_to_s16(struct comp_dev *dev,
+				      struct comp_buffer *sink,
+				      struct comp_buffer *source)
 {
-	struct comp_data *cd = comp_get_drvdata(dev);
-	uint32_t vol_scaled[SOF_IPC_MAX_CHANNELS];
+	struct vol_hifi3_gain g;
+	int32_t *gain = (int32_t *)g.gain;
+	int32_t *inc = (int32_t *)g.inc;
 	ae_f32x2 volume;
 	ae_f32x2 mult;
+	ae_f32x2 mult1;
 	ae_f32x2 out_sample;
 	ae_f16x4 in_sample = AE_ZERO16();
+	ae_valign inu;
+	ae_valign outu = AE_ZALIGN64();
 	size_t channel;
+	int pairs;
+	int pair = 0;
 	int i;
 	ae_int16 *in = (ae_int16 *)source->r_ptr;
 	ae_int16 *out = (ae_int16 *)sink->w_ptr;
+	ae_int16x4 *in4 = (ae_int16x4 *)source->r_ptr;
+	ae_int16x4 *out4 = (ae_int16x4 *)sink->w_ptr;
 
-	/* Scale to VOL_MAX */
-	for (channel = 0; channel < dev->params.channels; channel++)
-		vol_scaled[channel] = cd->volume[channel] * VOL_SCALE;
+	vol_gain_init(dev, &g);
+
+	if (vol_pairs_supported(dev, 4)) {
+		pairs = vol_pairs_init(dev, &g);
+		inu = AE_LA64_PP(in4);
+
+		/* Four samples of two channel pairs per loop */
+		for (i = 0; i < dev->frames * dev->params.channels; i += 4) {
+			/* Load the input samples */
+			AE_LA16X4_IP(in_sample, inu, in4);
+
+			/* Multiply the input samples */
+			volume = vol_pair_gain(&g, &pair, pairs);
+			mult = AE_MULFP32X16X2RS_H(volume, in_sample);
+			volume = vol_pair_gain(&g, &pair, pairs);
+			mult1 = AE_MULFP32X16X2RS_L(volume, in_sample);
+
+			/* Shift right and round to get 16 in 32 bits */
+			mult = AE_SRAA32RS(mult, 16);
+			mult1 = AE_SRAA32RS(mult1, 16);
+
+			/* Store the output samples */
+			AE_SA16X4_IP(AE_SAT16X4(mult, mult1), outu, out4);
+		}
+		AE_SA64POS_FP(outu, out4);
+		return;
+	}
 
 	/* Main processing loop */
 	for (i = 0; i < dev->frames; i++) {
@@ -75,7 +206,8 @@ static void vol_s16_to_s16(struct comp_dev *dev, struct comp_buffer *sink,
 			AE_L16_XP(in_sample, in, sizeof(ae_int16));
 
 			/* Get gain coefficients */
-			volume = *((ae_f32 *)&vol_scaled[channel]);
+			volume = *((ae_f32 *)&gain[channel]);
+			gain[channel] += inc[channel];
 
 			/* Multiply the input sample */
 			mult = AE_MULFP32X16X2RS_L(volume, in_sample);
@@ -96,20 +228,29 @@ static void vol_s16_to_s16(struct comp_dev *dev, struct comp_buffer *sink,
  * \param[in,out] sink Destination buffer.
  * \param[in,out] source Source buffer.
  */
-static void vol_s16_to_sX(struct comp_dev *dev, struct comp_buffer *sink,
-			  struct comp_buffer *source)
+static void __hot_text vol_s16_to_sX(struct comp_dev *dev,
+				     struct comp_buffer *sink,
+				     struct comp_buffer *source)
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
-	uint32_t vol_scaled[SOF_IPC_MAX_CHANNELS];
+	struct vol_hifi3_gain g;
+	int32_t *gain = (int32_t *)g.gain;
+	int32_t *inc = (int32_t *)g.inc;
 	ae_f32x2 volume;
 	ae_f32x2 mult;
 	ae_f32x2 out_sample;
 	ae_f16x4 in_sample = AE_ZERO16();
+	ae_valign inu;
+	ae_valign outu = AE_ZALIGN64();
 	size_t channel;
 	uint8_t shift_left = 0;
+	int pairs;
+	int pair = 0;
 	int i;
 	ae_int16 *in = (ae_int16 *)source->r_ptr;
 	ae_int32 *out = (ae_int32 *)sink->w_ptr;
+	ae_int16x4 *in4 = (ae_int16x4 *)source->r_ptr;
+	ae_int32x2 *out2 = (ae_int32x2 *)sink->w_ptr;
 
 	/* Get value of shift left */
 	if (cd->sink_format == SOF_IPC_FRAME_S24_4LE)
@@ -117,9 +258,34 @@ static void vol_s16_to_sX(struct comp_dev *dev, struct comp_buffer *sink,
 	else if (cd->sink_format == SOF_IPC_FRAME_S32_LE)
 		shift_left = 16;
 
-	/* Scale to VOL_MAX */
-	for (channel = 0; channel < dev->params.channels; channel++)
-		vol_scaled[channel] = cd->volume[channel] * VOL_SCALE;
+	vol_gain_init(dev, &g);
+
+	if (vol_pairs_supported(dev, 4)) {
+		pairs = vol_pairs_init(dev, &g);
+		inu = AE_LA64_PP(in4);
+
+		/* Four samples of two channel pairs per loop */
+		for (i = 0; i < dev->frames * dev->params.channels; i += 4) {
+			/* Load the input samples */
+			AE_LA16X4_IP(in_sample, inu, in4);
+
+			/* First channel pair */
+			volume = vol_pair_gain(&g, &pair, pairs);
+			mult = AE_MULFP32X16X2RS_H(volume, in_sample);
+			out_sample = AE_SRAA32RS(mult, 16);
+			out_sample = AE_SLAA32(out_sample, shift_left);
+			AE_SA32X2_IP(out_sample, outu, out2);
+
+			/* Second channel pair */
+			volume = vol_pair_gain(&g, &pair, pairs);
+			mult = AE_MULFP32X16X2RS_L(volume, in_sample);
+			out_sample = AE_SRAA32RS(mult, 16);
+			out_sample = AE_SLAA32(out_sample, shift_left);
+			AE_SA32X2_IP(out_sample, outu, out2);
+		}
+		AE_SA64POS_FP(outu, out2);
+		return;
+	}
 
 	/* Main processing loop */
 	for (i = 0; i < dev->frames; i++) {
@@ -129,7 +295,8 @@ static void vol_s16_to_sX(struct comp_dev *dev, struct comp_buffer *sink,
 			AE_L16_XP(in_sample, in, sizeof(ae_int16));
 
 			/* Get gain coefficients */
-			volume = *((ae_f32 *)&vol_scaled[channel]);
+			volume = *((ae_f32 *)&gain[channel]);
+			gain[channel] += inc[channel];
 
 			/* Multiply the input sample */
 			mult = AE_MULFP32X16X2RS_L(volume, in_sample);
@@ -152,28 +319,65 @@ static void vol_s16_to_sX(struct comp_dev *dev, struct comp_buffer *sink,
  * \param[in,out] sink Destination buffer.
  * \param[in,out] source Source buffer.
  */
-static void vol_sX_to_s16(struct comp_dev *dev, struct comp_buffer *sink,
-			  struct comp_buffer *source)
+static void __hot_text vol_sX_to_s16(struct comp_dev *dev,
+				     struct comp_buffer *sink,
+				     struct comp_buffer *source)
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
-	uint32_t vol_scaled[SOF_IPC_MAX_CHANNELS];
+	struct vol_hifi3_gain g;
+	int32_t *gain = (int32_t *)g.gain;
+	int32_t *inc = (int32_t *)g.inc;
 	ae_f32x2 volume;
 	ae_f32x2 mult;
+	ae_f32x2 mult1;
 	ae_f32x2 in_sample = AE_ZERO32();
 	ae_f16x4 out_sample;
+	ae_valign inu;
+	ae_valign outu = AE_ZALIGN64();
 	size_t channel;
 	uint8_t shift_left = 0;
+	int pairs;
+	int pair = 0;
 	int i;
 	ae_int32 *in = (ae_int32 *)source->r_ptr;
 	ae_int16 *out = (ae_int16 *)sink->w_ptr;
+	ae_int32x2 *in2 = (ae_int32x2 *)source->r_ptr;
+	ae_int16x4 *out4 = (ae_int16x4 *)sink->w_ptr;
 
 	/* Get value of shift left */
 	if (cd->source_format == SOF_IPC_FRAME_S24_4LE)
 		shift_left = 8;
 
-	/* Scale to VOL_MAX */
-	for (channel = 0; channel < dev->params.channels; channel++)
-		vol_scaled[channel] = cd->volume[channel] * VOL_SCALE;
+	vol_gain_init(dev, &g);
+
+	if (vol_pairs_supported(dev, 4)) {
+		pairs = vol_pairs_init(dev, &g);
+		inu = AE_LA64_PP(in2);
+
+		/* Four samples of two channel pairs per loop */
+		for (i = 0; i < dev->frames * dev->params.channels; i += 4) {
+			/* First channel pair */
+			AE_LA32X2_IP(in_sample, inu, in2);
+			in_sample = AE_SLAA32(in_sample, shift_left);
+			volume = vol_pair_gain(&g, &pair, pairs);
+			mult = AE_MULFP32X2RS(volume, in_sample);
+
+			/* Second channel pair */
+			AE_LA32X2_IP(in_sample, inu, in2);
+			in_sample = AE_SLAA32(in_sample, shift_left);
+			volume = vol_pair_gain(&g, &pair, pairs);
+			mult1 = AE_MULFP32X2RS(volume, in_sample);
+
+			/* Shift right to get 16 in 32 bits */
+			out_sample = AE_SAT16X4(AE_SRLA32(mult, 16),
+						AE_SRLA32(mult1, 16));
+
+			/* Store the output samples */
+			AE_SA16X4_IP(out_sample, outu, out4);
+		}
+		AE_SA64POS_FP(outu, out4);
+		return;
+	}
 
 	/* Main processing loop */
 	for (i = 0; i < dev->frames; i++) {
@@ -186,7 +390,8 @@ static void vol_sX_to_s16(struct comp_dev *dev, struct comp_buffer *sink,
 			in_sample = AE_SLAA32(in_sample, shift_left);
 
 			/* Get gain coefficients */
-			volume = *((ae_f32 *)&vol_scaled[channel]);
+			volume = *((ae_f32 *)&gain[channel]);
+			gain[channel] += inc[channel];
 
 			/* Multiply the input sample */
 			mult = AE_MULFP32X2RS(volume, in_sample);
@@ -207,28 +412,52 @@ static void vol_sX_to_s16(struct comp_dev *dev, struct comp_buffer *sink,
  * \param[in,out] sink Destination buffer.
  * \param[in,out] source Source buffer.
  */
-static void vol_s24_to_s24_s32(struct comp_dev *dev, struct comp_buffer *sink,
-			       struct comp_buffer *source)
+static void __hot_text vol_s24_to_s24_s32(struct comp_dev *dev,
+					  struct comp_buffer *sink,
+					  struct comp_buffer *source)
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
-	uint32_t vol_scaled[SOF_IPC_MAX_CHANNELS];
+	struct vol_hifi3_gain g;
+	int32_t *gain = (int32_t *)g.gain;
+	int32_t *inc = (int32_t *)g.inc;
 	ae_f32x2 volume;
 	ae_f32x2 in_sample = AE_ZERO32();
 	ae_f32x2 out_sample;
 	ae_f32x2 mult;
+	ae_valign inu;
+	ae_valign outu = AE_ZALIGN64();
 	size_t channel;
 	uint8_t shift_left = 0;
+	int pairs;
+	int pair = 0;
 	int i;
 	ae_int32 *in = (ae_int32 *)source->r_ptr;
 	ae_int32 *out = (ae_int32 *)sink->w_ptr;
+	ae_int32x2 *in2 = (ae_int32x2 *)source->r_ptr;
+	ae_int32x2 *out2 = (ae_int32x2 *)sink->w_ptr;
 
 	/* Get value of shift left */
 	if (cd->sink_format == SOF_IPC_FRAME_S32_LE)
 		shift_left = 8;
 
-	/* Scale to VOL_MAX */
-	for (channel = 0; channel < dev->params.channels; channel++)
-		vol_scaled[channel] = cd->volume[channel] * VOL_SCALE;
+	vol_gain_init(dev, &g);
+
+	if (vol_pairs_supported(dev, 2)) {
+		pairs = vol_pairs_init(dev, &g);
+		inu = AE_LA64_PP(in2);
+
+		/* Two samples of one channel pair per loop */
+		for (i = 0; i < dev->frames * dev->params.channels; i += 2) {
+			AE_LA32X2_IP(in_sample, inu, in2);
+			volume = vol_pair_gain(&g, &pair, pairs);
+			mult = AE_MULFP32X2RS(volume, AE_SLAA32(in_sample, 8));
+			out_sample = AE_SRLA32(mult, 8);
+			out_sample = AE_SLAA32(out_sample, shift_left);
+			AE_SA32X2_IP(out_sample, outu, out2);
+		}
+		AE_SA64POS_FP(outu, out2);
+		return;
+	}
 
 	/* Main processing loop */
 	for (i = 0; i < dev->frames; i++) {
@@ -238,7 +467,8 @@ static void vol_s24_to_s24_s32(struct comp_dev *dev, struct comp_buffer *sink,
 			AE_L32_XP(in_sample, in, sizeof(ae_int32));
 
 			/* Get gain coefficients */
-			volume = *((ae_f32 *)&vol_scaled[channel]);
+			volume = *((ae_f32 *)&gain[channel]);
+			gain[channel] += inc[channel];
 
 			/* Multiply the input sample */
 			mult = AE_MULFP32X2RS(volume, AE_SLAA32(in_sample, 8));
@@ -261,28 +491,51 @@ static void vol_s24_to_s24_s32(struct comp_dev *dev, struct comp_buffer *sink,
  * \param[in,out] sink Destination buffer.
  * \param[in,out] source Source buffer.
  */
-static void vol_s32_to_s24_s32(struct comp_dev *dev, struct comp_buffer *sink,
-			       struct comp_buffer *source)
+static void __hot_text vol_s32_to_s24_s32(struct comp_dev *dev,
+					  struct comp_buffer *sink,
+					  struct comp_buffer *source)
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
-	uint32_t vol_scaled[SOF_IPC_MAX_CHANNELS];
+	struct vol_hifi3_gain g;
+	int32_t *gain = (int32_t *)g.gain;
+	int32_t *inc = (int32_t *)g.inc;
 	ae_f32x2 volume;
 	ae_f32x2 in_sample = AE_ZERO32();
 	ae_f32x2 out_sample;
 	ae_f32x2 mult;
+	ae_valign inu;
+	ae_valign outu = AE_ZALIGN64();
 	size_t channel;
 	uint8_t shift_right = 0;
+	int pairs;
+	int pair = 0;
 	int i;
 	ae_int32 *in = (ae_int32 *)source->r_ptr;
 	ae_int32 *out = (ae_int32 *)sink->w_ptr;
+	ae_int32x2 *in2 = (ae_int32x2 *)source->r_ptr;
+	ae_int32x2 *out2 = (ae_int32x2 *)sink->w_ptr;
 
 	/* Get value of shift right */
 	if (cd->sink_format == SOF_IPC_FRAME_S24_4LE)
 		shift_right = 8;
 
-	/* Scale to VOL_MAX */
-	for (channel = 0; channel < dev->params.channels; channel++)
-		vol_scaled[channel] = cd->volume[channel] * VOL_SCALE;
+	vol_gain_init(dev, &g);
+
+	if (vol_pairs_supported(dev, 2)) {
+		pairs = vol_pairs_init(dev, &g);
+		inu = AE_LA64_PP(in2);
+
+		/* Two samples of one channel pair per loop */
+		for (i = 0; i < dev->frames * dev->params.channels; i += 2) {
+			AE_LA32X2_IP(in_sample, inu, in2);
+			volume = vol_pair_gain(&g, &pair, pairs);
+			mult = AE_MULFP32X2RS(volume, in_sample);
+			out_sample = AE_SRLA32(mult, shift_right);
+			AE_SA32X2_IP(out_sample, outu, out2);
+		}
+		AE_SA64POS_FP(outu, out2);
+		return;
+	}
 
 	/* Main processing loop */
 	for (i = 0; i < dev->frames; i++) {
@@ -292,7 +545,8 @@ static void vol_s32_to_s24_s32(struct comp_dev *dev, struct comp_buffer *sink,
 			AE_L32_XP(in_sample, in, sizeof(ae_int32));
 
 			/* Get gain coefficients */
-			volume = *((ae_f32 *)&vol_scaled[channel]);
+			volume = *((ae_f32 *)&gain[channel]);
+			gain[channel] += inc[channel];
 
 			/* Multiply the input sample */
 			mult = AE_MULFP32X2RS(volume, in_sample);
@@ -306,6 +560,56 @@ static void vol_s32_to_s24_s32(struct comp_dev *dev, struct comp_buffer *sink,
 	}
 }
 
+/**
+ * \brief HiFi3 enabled volume processing from 16 bit to 16 bit in Q1.15.
+ * \param[in,out] dev Volume base component device.
+ * \param[in,out] sink Destination buffer.
+ * \param[in,out] source Source buffer.
+ *
+ * Four samples are scaled per 16 bit multiply against Q1.15 gains laid
+ * out over four frames, so every channel count fills whole vectors. Gains
+ * are taken once per period, any ramp steps between periods.
+ */
+static void __hot_text vol_q15_s16_to_s16(struct comp_dev *dev,
+					  struct comp_buffer *sink,
+					  struct comp_buffer *source)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	ae_f16x4 gain[SOF_IPC_MAX_CHANNELS];
+	int16_t *lane = (int16_t *)gain;
+	ae_f16x4 in_sample = AE_ZERO16();
+	ae_valign inu;
+	ae_valign outu = AE_ZALIGN64();
+	int channels = dev->params.channels;
+	int lanes = channels << 2;
+	int samples = dev->frames * channels;
+	int vector = 0;
+	int i;
+	int16_t *in = (int16_t *)source->r_ptr;
+	int16_t *out = (int16_t *)sink->w_ptr;
+	ae_int16x4 *in4 = (ae_int16x4 *)source->r_ptr;
+	ae_int16x4 *out4 = (ae_int16x4 *)sink->w_ptr;
+
+	for (i = 0; i < lanes; i++)
+		lane[i] = vol_gain_q15(cd->volume[i % channels]);
+
+	inu = AE_LA64_PP(in4);
+
+	/* Four samples per loop */
+	for (i = 0; i + 4 <= samples; i += 4) {
+		AE_LA16X4_IP(in_sample, inu, in4);
+		AE_SA16X4_IP(AE_MULFP16X4RAS(in_sample, gain[vector]),
+			     outu, out4);
+		vector = vector + 1 == channels ? 0 : vector + 1;
+	}
+	AE_SA64POS_FP(outu, out4);
+
+	/* Samples left over when the period is not a multiple of four */
+	for (; i < samples; i++)
+		out[i] = sat_int16(((int32_t)in[i] * lane[i % lanes] +
+				    (1 << 14)) >> 15);
+}
+
 const struct comp_func_map func_map[] = {
 	{SOF_IPC_FRAME_S16_LE, SOF_IPC_FRAME_S16_LE, 0, vol_s16_to_s16},
 	{SOF_IPC_FRAME_S16_LE, SOF_IPC_FRAME_S24_4LE, 0, vol_s16_to_sX},
@@ -323,6 +627,11 @@ scale_vol vol_get_processing_function(struct comp_dev *dev)
 	struct comp_data *cd = comp_get_drvdata(dev);
 	int i;
 
+	if (cd->precision == SOF_VOLUME_PRECISION_Q1_15 &&
+	    cd->source_format == SOF_IPC_FRAME_S16_LE &&
+	    cd->sink_format == SOF_IPC_FRAME_S16_LE)
+		return vol_q15_s16_to_s16;
+
 	/* map the volume function for source and sink buffers */
 	for (i = 0; i < ARRAY_SIZE(func_map); i++) {
 		if (cd->source_format != func_map[i].source)
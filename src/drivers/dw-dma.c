@@ -120,6 +120,7 @@
 #define INT_MASK_ALL			0xFF00
 #define INT_UNMASK_ALL			0xFFFF
 #define CHAN_ENABLE(chan)		(0x101 << chan)
+#define CHAN_ENABLE_MASK(mask)		(((mask) << 8) | (mask))
 #define CHAN_DISABLE(chan)		(0x100 << chan)
 #define CHAN_MASK(chan)		(0x1 << chan)
 
@@ -159,6 +160,8 @@
 
 /* CFG_LO */
 #define DW_CFG_CLASS(x)		(x << 5)
+#define DW_CFG_RELOAD_SRC		(1 << 30)
+#define DW_CFG_RELOAD_DST		(1 << 31)
 
 /* CFG_HI */
 #define DW_CFGH_SRC_PER(x)		(x << 7)
@@ -183,6 +186,8 @@
 
 /* CFG_LO */
 #define DW_CFG_CH_DRAIN		0x400
+#define DW_CFG_RELOAD_SRC		(1 << 30)
+#define DW_CFG_RELOAD_DST		(1 << 31)
 
 /* CFG_HI */
 #define DW_CFGH_SRC_PER(x)		((x) << 0)
@@ -270,12 +275,20 @@ struct dma_chan_data {
 	struct dw_lli2 *lli;
 	struct dw_lli2 *lli_current;
 	uint32_t desc_count;
+	uint32_t desc_max;	/* size of the reusable lli ring */
 	uint32_t cfg_lo;
 	uint32_t cfg_hi;
 	struct dma_id id;
 	uint32_t timer_delay;
 	struct work dma_ch_work;
 
+	/* timer driven ring run as one auto reloaded block */
+	uint32_t reload;
+	uint32_t reload_start;	/* memory side start of the ring */
+	uint32_t reload_size;	/* ring size in bytes */
+	uint32_t reload_block;	/* period size, reported in whole periods */
+	uint32_t reload_pos;	/* memory side position already reported */
+
 	/* client callback function */
 	void (*cb)(void *data, uint32_t type, struct dma_sg_elem *next);
 	/* client callback data */
@@ -296,6 +309,9 @@ static inline void dw_dma_chan_reload_next(struct dma *dma, int channel,
 static inline int dw_dma_interrupt_register(struct dma *dma, int channel);
 static inline void dw_dma_interrupt_unregister(struct dma *dma, int channel);
 static uint64_t dw_dma_work(void *data, uint64_t delay);
+#if !DW_USE_HW_LLI
+static void dw_dma_set_reload(struct dma *dma, int channel);
+#endif
 
 static inline void dw_write(struct dma *dma, uint32_t reg, uint32_t value)
 {
@@ -366,11 +382,7 @@ static void dw_dma_channel_put_unlocked(struct dma *dma, int channel)
 		dw_write(dma, DW_MASK_ERR, INT_MASK(channel));
 	}
 
-	/* free the lli allocated by set_config*/
-	if (p->chan[channel].lli) {
-		rfree(p->chan[channel].lli);
-		p->chan[channel].lli = NULL;
-	}
+	/* the lli ring is kept for the next stream on this channel */
 
 	/* set new state */
 	p->chan[channel].status = COMP_STATE_INIT;
@@ -393,41 +405,31 @@ static void dw_dma_channel_put(struct dma *dma, int channel)
 	spin_unlock_irq(&dma->lock, flags);
 }
 
-static int dw_dma_start(struct dma *dma, int channel)
+/* program a channel for start, everything but the enable, dma->lock held */
+static int dw_dma_start_program(struct dma *dma, int channel)
 {
 	struct dma_pdata *p = dma_get_drvdata(dma);
-	uint32_t flags;
 	int ret = 0;
 
-	if (channel >= dma->plat_data.channels) {
-		trace_dwdma_error("dw-dma: %d invalid channel %d",
-				  dma->plat_data.id, channel);
-		return -EINVAL;
-	}
-
-	spin_lock_irq(&dma->lock, flags);
-
 	tracev_dwdma("dw-dma: %d channel %d start", dma->plat_data.id, channel);
 
 	/* is channel idle, disabled and ready ? */
 	if (p->chan[channel].status != COMP_STATE_PREPARE ||
 		(dw_read(dma, DW_DMA_CHAN_EN) & (0x1 << channel))) {
-		ret = -EBUSY;
 		trace_dwdma_error("dw-dma: %d channel %d not ready",
 				  dma->plat_data.id, channel);
 		trace_dwdma_error(" ena 0x%x cfglow 0x%x status 0x%x",
 				  dw_read(dma, DW_DMA_CHAN_EN),
 				  dw_read(dma, DW_CFG_LOW(channel)),
 				  p->chan[channel].status);
-		goto out;
+		return -EBUSY;
 	}
 
 	/* valid stream ? */
-	if (p->chan[channel].lli == NULL) {
-		ret = -EINVAL;
+	if (!p->chan[channel].desc_count) {
 		trace_dwdma_error("dw-dma: %d channel %d invalid stream",
 				  dma->plat_data.id, channel);
-		goto out;
+		return -EINVAL;
 	}
 
 	if (!p->chan[channel].timer_delay) {
@@ -467,6 +469,9 @@ static int dw_dma_start(struct dma *dma, int channel)
 	dw_write(dma, DW_CFG_LOW(channel), p->chan[channel].cfg_lo);
 	dw_write(dma, DW_CFG_HIGH(channel), p->chan[channel].cfg_hi);
 
+	/* auto reload block restarts from the ring start */
+	p->chan[channel].reload_pos = p->chan[channel].reload_start;
+
 	if (p->chan[channel].timer_delay)
 		/* activate timer for timer driven scheduling */
 		work_schedule_default(&p->chan[channel].dma_ch_work,
@@ -475,13 +480,72 @@ static int dw_dma_start(struct dma *dma, int channel)
 		/* enable interrupt only for the first start */
 		ret = dw_dma_interrupt_register(dma, channel);
 
+	return ret;
+}
+
+static int dw_dma_start(struct dma *dma, int channel)
+{
+	struct dma_pdata *p = dma_get_drvdata(dma);
+	uint32_t flags;
+	int ret;
+
+	if (channel >= dma->plat_data.channels) {
+		trace_dwdma_error("dw-dma: %d invalid channel %d",
+				  dma->plat_data.id, channel);
+		return -EINVAL;
+	}
+
+	spin_lock_irq(&dma->lock, flags);
+
+	ret = dw_dma_start_program(dma, channel);
 	if (ret == 0) {
 		/* enable the channel */
 		p->chan[channel].status = COMP_STATE_ACTIVE;
 		dw_write(dma, DW_DMA_CHAN_EN, CHAN_ENABLE(channel));
 	}
 
-out:
+	spin_unlock_irq(&dma->lock, flags);
+	return ret;
+}
+
+/* start several channels with a single write of the enable register, the
+ * channels programmed without error are started even if another one fails
+ */
+static int dw_dma_start_group(struct dma *dma, uint32_t chan_mask)
+{
+	struct dma_pdata *p = dma_get_drvdata(dma);
+	uint32_t started = 0;
+	uint32_t flags;
+	int channel;
+	int ret = 0;
+	int err;
+
+	if (chan_mask >> dma->plat_data.channels) {
+		trace_dwdma_error("dw-dma: %d invalid channel mask 0x%x",
+				  dma->plat_data.id, chan_mask);
+		return -EINVAL;
+	}
+
+	spin_lock_irq(&dma->lock, flags);
+
+	while (chan_mask) {
+		channel = __builtin_ctz(chan_mask);
+		chan_mask &= ~CHAN_MASK(channel);
+
+		err = dw_dma_start_program(dma, channel);
+		if (err < 0) {
+			if (!ret)
+				ret = err;
+			continue;
+		}
+
+		p->chan[channel].status = COMP_STATE_ACTIVE;
+		started |= CHAN_MASK(channel);
+	}
+
+	if (started)
+		dw_write(dma, DW_DMA_CHAN_EN, CHAN_ENABLE_MASK(started));
+
 	spin_unlock_irq(&dma->lock, flags);
 	return ret;
 }
@@ -556,6 +620,10 @@ static int dw_dma_stop(struct dma *dma, int channel)
 	if (p->chan[channel].timer_delay)
 		work_cancel_default(&p->chan[channel].dma_ch_work);
 
+	/* auto reloaded block never completes, so stop it here */
+	if (p->chan[channel].reload)
+		dw_write(dma, DW_DMA_CHAN_EN, CHAN_DISABLE(channel));
+
 	ret = poll_for_register_delay(dma_base(dma) + DW_DMA_CHAN_EN,
 				      CHAN_MASK(channel), val,
 				      PLATFORM_DMA_TIMEOUT);
@@ -658,6 +726,9 @@ static int dw_dma_set_config(struct dma *dma, int channel,
 	struct dw_lli2 *lli_desc;
 	struct dw_lli2 *lli_desc_head;
 	struct dw_lli2 *lli_desc_tail;
+	uint32_t ctrl_lo = 0;
+	uint32_t sar_mask = 0;
+	uint32_t dar_mask = 0;
 	uint32_t flags;
 	uint32_t msize = 3;/* default msize */
 	int i, ret = 0;
@@ -686,30 +757,27 @@ static int dw_dma_set_config(struct dma *dma, int channel,
 		goto out;
 	}
 
-	/* do we need to realloc descriptors */
-	if (config->elem_array.count != p->chan[channel].desc_count) {
-
-		p->chan[channel].desc_count = config->elem_array.count;
-
-		/* allocate descriptors for channel */
+	/* reuse the channel descriptor ring if it is big enough */
+	if (config->elem_array.count > p->chan[channel].desc_max) {
 		if (p->chan[channel].lli)
 			rfree(p->chan[channel].lli);
+		p->chan[channel].desc_max = 0;
 		p->chan[channel].lli =
 			rzalloc(RZONE_SYS_RUNTIME,
 				SOF_MEM_CAPS_RAM | SOF_MEM_CAPS_DMA,
 				sizeof(struct dw_lli2) *
-				p->chan[channel].desc_count);
+				config->elem_array.count);
 		if (p->chan[channel].lli == NULL) {
 			trace_dwdma_error("dw-dma: %d channel %d LLI alloc failed",
 					  dma->plat_data.id, channel);
+			p->chan[channel].desc_count = 0;
 			ret = -ENOMEM;
 			goto out;
 		}
+		p->chan[channel].desc_max = config->elem_array.count;
 	}
 
-	/* initialise descriptors */
-	bzero(p->chan[channel].lli, sizeof(struct dw_lli2) *
-	      p->chan[channel].desc_count);
+	p->chan[channel].desc_count = config->elem_array.count;
 	lli_desc = lli_desc_head = p->chan[channel].lli;
 	lli_desc_tail = p->chan[channel].lli + p->chan[channel].desc_count - 1;
 
@@ -733,159 +801,143 @@ static int dw_dma_set_config(struct dma *dma, int channel,
 		dw_write(dma, DW_MASK_ERR, INT_UNMASK(channel));
 	}
 
-	/* fill in lli for the elem in the list */
-	for (i = 0; i < config->elem_array.count; i++) {
-
-		sg_elem = config->elem_array.elems + i;
-
-		/* write CTL_LOn for each lli */
-		switch (config->src_width) {
-		case 2:
-			/* non peripheral copies are optimal using words */
-			switch (config->direction) {
-			case DMA_DIR_LMEM_TO_HMEM:
-			case DMA_DIR_HMEM_TO_LMEM:
-			case DMA_DIR_MEM_TO_MEM:
-				/* config the src tr width for 32 bit words */
-				lli_desc->ctrl_lo |= DW_CTLL_SRC_WIDTH(2);
-				break;
-			default:
-				/* config the src width for 16 bit samples */
-				lli_desc->ctrl_lo |= DW_CTLL_SRC_WIDTH(1);
-				break;
-			}
-			break;
-		case 4:
-			/* config the src tr width for 24, 32 bit samples */
-			lli_desc->ctrl_lo |= DW_CTLL_SRC_WIDTH(2);
+	/* CTL_LOn is the same for every lli in the ring */
+	switch (config->src_width) {
+	case 2:
+		/* non peripheral copies are optimal using words */
+		switch (config->direction) {
+		case DMA_DIR_LMEM_TO_HMEM:
+		case DMA_DIR_HMEM_TO_LMEM:
+		case DMA_DIR_MEM_TO_MEM:
+			/* config the src tr width for 32 bit words */
+			ctrl_lo |= DW_CTLL_SRC_WIDTH(2);
 			break;
 		default:
-			trace_dwdma_error("dw-dma: %d channel %d invalid src width %d",
-					  dma->plat_data.id, channel,
-					  config->src_width);
-			ret = -EINVAL;
-			goto out;
+			/* config the src width for 16 bit samples */
+			ctrl_lo |= DW_CTLL_SRC_WIDTH(1);
+			break;
 		}
+		break;
+	case 4:
+		/* config the src tr width for 24, 32 bit samples */
+		ctrl_lo |= DW_CTLL_SRC_WIDTH(2);
+		break;
+	default:
+		trace_dwdma_error("dw-dma: %d channel %d invalid src width %d",
+				  dma->plat_data.id, channel,
+				  config->src_width);
+		ret = -EINVAL;
+		goto out;
+	}
 
-		switch (config->dest_width) {
-		case 2:
-			/* non peripheral copies are optimal using words */
-			switch (config->direction) {
-			case DMA_DIR_LMEM_TO_HMEM:
-			case DMA_DIR_HMEM_TO_LMEM:
-			case DMA_DIR_MEM_TO_MEM:
-				/* config the dest tr width for 32 bit words */
-				lli_desc->ctrl_lo |= DW_CTLL_DST_WIDTH(2);
-				break;
-			default:
-				/* config the dest width for 16 bit samples */
-				lli_desc->ctrl_lo |= DW_CTLL_DST_WIDTH(1);
-				break;
-			}
-			break;
-		case 4:
-			/* config the dest tr width for 24, 32 bit samples */
-			lli_desc->ctrl_lo |= DW_CTLL_DST_WIDTH(2);
+	switch (config->dest_width) {
+	case 2:
+		/* non peripheral copies are optimal using words */
+		switch (config->direction) {
+		case DMA_DIR_LMEM_TO_HMEM:
+		case DMA_DIR_HMEM_TO_LMEM:
+		case DMA_DIR_MEM_TO_MEM:
+			/* config the dest tr width for 32 bit words */
+			ctrl_lo |= DW_CTLL_DST_WIDTH(2);
 			break;
 		default:
-			trace_dwdma_error("dw-dma: %d channel %d invalid dest width %d",
-					  dma->plat_data.id, channel,
-					  config->dest_width);
-			ret = -EINVAL;
-			goto out;
+			/* config the dest width for 16 bit samples */
+			ctrl_lo |= DW_CTLL_DST_WIDTH(1);
+			break;
 		}
+		break;
+	case 4:
+		/* config the dest tr width for 24, 32 bit samples */
+		ctrl_lo |= DW_CTLL_DST_WIDTH(2);
+		break;
+	default:
+		trace_dwdma_error("dw-dma: %d channel %d invalid dest width %d",
+				  dma->plat_data.id, channel,
+				  config->dest_width);
+		ret = -EINVAL;
+		goto out;
+	}
 
-		lli_desc->ctrl_lo |= DW_CTLL_SRC_MSIZE(msize);
-		lli_desc->ctrl_lo |= DW_CTLL_DST_MSIZE(msize);
-		lli_desc->ctrl_lo |= DW_CTLL_INT_EN; /* enable interrupt */
+	ctrl_lo |= DW_CTLL_SRC_MSIZE(msize);
+	ctrl_lo |= DW_CTLL_DST_MSIZE(msize);
 
-		/* config the SINC and DINC field of CTL_LOn,
-		 * SRC/DST_PER filed of CFGn
-		 */
-		switch (config->direction) {
-		case DMA_DIR_LMEM_TO_HMEM:
-			lli_desc->ctrl_lo |= DW_CTLL_FC_M2M;
-			lli_desc->ctrl_lo |= DW_CTLL_SRC_INC | DW_CTLL_DST_INC;
+	/* timer driven channels are polled, no block interrupts */
+	if (!p->chan[channel].timer_delay)
+		ctrl_lo |= DW_CTLL_INT_EN; /* enable interrupt */
+
+	/* config the SINC and DINC field of CTL_LOn,
+	 * SRC/DST_PER filed of CFGn
+	 */
+	switch (config->direction) {
+	case DMA_DIR_LMEM_TO_HMEM:
+		ctrl_lo |= DW_CTLL_FC_M2M;
+		ctrl_lo |= DW_CTLL_SRC_INC | DW_CTLL_DST_INC;
 #if DW_USE_HW_LLI
-			lli_desc->ctrl_lo |=
-				DW_CTLL_LLP_S_EN | DW_CTLL_LLP_D_EN;
+		ctrl_lo |= DW_CTLL_LLP_S_EN | DW_CTLL_LLP_D_EN;
 #endif
-			lli_desc->sar =
-				(uint32_t)sg_elem->src | PLATFORM_HOST_DMA_MASK;
-			lli_desc->dar = (uint32_t)sg_elem->dest;
-			break;
-		case DMA_DIR_HMEM_TO_LMEM:
-			lli_desc->ctrl_lo |= DW_CTLL_FC_M2M;
-			lli_desc->ctrl_lo |= DW_CTLL_SRC_INC | DW_CTLL_DST_INC;
+		sar_mask = PLATFORM_HOST_DMA_MASK;
+		break;
+	case DMA_DIR_HMEM_TO_LMEM:
+		ctrl_lo |= DW_CTLL_FC_M2M;
+		ctrl_lo |= DW_CTLL_SRC_INC | DW_CTLL_DST_INC;
 #if DW_USE_HW_LLI
-			lli_desc->ctrl_lo |=
-				DW_CTLL_LLP_S_EN | DW_CTLL_LLP_D_EN;
+		ctrl_lo |= DW_CTLL_LLP_S_EN | DW_CTLL_LLP_D_EN;
 #endif
-			lli_desc->dar =
-				(uint32_t)sg_elem->dest
-				| PLATFORM_HOST_DMA_MASK;
-			lli_desc->sar = (uint32_t)sg_elem->src;
-			break;
-		case DMA_DIR_MEM_TO_MEM:
-			lli_desc->ctrl_lo |= DW_CTLL_FC_M2M;
-			lli_desc->ctrl_lo |= DW_CTLL_SRC_INC | DW_CTLL_DST_INC;
+		dar_mask = PLATFORM_HOST_DMA_MASK;
+		break;
+	case DMA_DIR_MEM_TO_MEM:
+		ctrl_lo |= DW_CTLL_FC_M2M;
+		ctrl_lo |= DW_CTLL_SRC_INC | DW_CTLL_DST_INC;
 #if DW_USE_HW_LLI
-			lli_desc->ctrl_lo |=
-				DW_CTLL_LLP_S_EN | DW_CTLL_LLP_D_EN;
+		ctrl_lo |= DW_CTLL_LLP_S_EN | DW_CTLL_LLP_D_EN;
 #endif
-			lli_desc->sar = (uint32_t)sg_elem->src
-					| PLATFORM_HOST_DMA_MASK;
-			lli_desc->dar = (uint32_t)sg_elem->dest
-					| PLATFORM_HOST_DMA_MASK;
-			break;
-		case DMA_DIR_MEM_TO_DEV:
-			lli_desc->ctrl_lo |= DW_CTLL_FC_M2P;
-			lli_desc->ctrl_lo |= DW_CTLL_SRC_INC | DW_CTLL_DST_FIX;
+		sar_mask = PLATFORM_HOST_DMA_MASK;
+		dar_mask = PLATFORM_HOST_DMA_MASK;
+		break;
+	case DMA_DIR_MEM_TO_DEV:
+		ctrl_lo |= DW_CTLL_FC_M2P;
+		ctrl_lo |= DW_CTLL_SRC_INC | DW_CTLL_DST_FIX;
 #if DW_USE_HW_LLI
-			lli_desc->ctrl_lo |= DW_CTLL_LLP_S_EN;
-			lli_desc->ctrl_hi |= DW_CTLH_DONE(1);
-			p->chan[channel].cfg_lo |= DW_CFG_RELOAD_DST;
+		ctrl_lo |= DW_CTLL_LLP_S_EN;
+		p->chan[channel].cfg_lo |= DW_CFG_RELOAD_DST;
 #endif
-			p->chan[channel].cfg_hi |=
-				DW_CFGH_DST_PER(config->dest_dev);
-			lli_desc->sar = (uint32_t)sg_elem->src
-					| PLATFORM_HOST_DMA_MASK;
-			lli_desc->dar = (uint32_t)sg_elem->dest;
-			break;
-		case DMA_DIR_DEV_TO_MEM:
-			lli_desc->ctrl_lo |= DW_CTLL_FC_P2M;
-			lli_desc->ctrl_lo |= DW_CTLL_SRC_FIX | DW_CTLL_DST_INC;
+		p->chan[channel].cfg_hi |=
+			DW_CFGH_DST_PER(config->dest_dev);
+		sar_mask = PLATFORM_HOST_DMA_MASK;
+		break;
+	case DMA_DIR_DEV_TO_MEM:
+		ctrl_lo |= DW_CTLL_FC_P2M;
+		ctrl_lo |= DW_CTLL_SRC_FIX | DW_CTLL_DST_INC;
 #if DW_USE_HW_LLI
-			lli_desc->ctrl_lo |= DW_CTLL_LLP_D_EN;
-			lli_desc->ctrl_hi |= DW_CTLH_DONE(0);
-			p->chan[channel].cfg_lo |= DW_CFG_RELOAD_SRC;
+		ctrl_lo |= DW_CTLL_LLP_D_EN;
+		p->chan[channel].cfg_lo |= DW_CFG_RELOAD_SRC;
 #endif
-			p->chan[channel].cfg_hi |=
-				DW_CFGH_SRC_PER(config->src_dev);
-			lli_desc->sar = (uint32_t)sg_elem->src;
-			lli_desc->dar = (uint32_t)sg_elem->dest
-					| PLATFORM_HOST_DMA_MASK;
-			break;
-		case DMA_DIR_DEV_TO_DEV:
-			lli_desc->ctrl_lo |= DW_CTLL_FC_P2P;
-			lli_desc->ctrl_lo |= DW_CTLL_SRC_FIX | DW_CTLL_DST_FIX;
+		p->chan[channel].cfg_hi |=
+			DW_CFGH_SRC_PER(config->src_dev);
+		dar_mask = PLATFORM_HOST_DMA_MASK;
+		break;
+	case DMA_DIR_DEV_TO_DEV:
+		ctrl_lo |= DW_CTLL_FC_P2P;
+		ctrl_lo |= DW_CTLL_SRC_FIX | DW_CTLL_DST_FIX;
 #if DW_USE_HW_LLI
-			lli_desc->ctrl_lo |=
-				DW_CTLL_LLP_S_EN | DW_CTLL_LLP_D_EN;
+		ctrl_lo |= DW_CTLL_LLP_S_EN | DW_CTLL_LLP_D_EN;
 #endif
-			p->chan[channel].cfg_hi |=
-				DW_CFGH_SRC_PER(config->src_dev) |
-				DW_CFGH_DST_PER(config->dest_dev);
-			lli_desc->sar = (uint32_t)sg_elem->src;
-			lli_desc->dar = (uint32_t)sg_elem->dest;
-			break;
-		default:
-			trace_dwdma_error("dw-dma: %d channel %d invalid direction %d",
-					  dma->plat_data.id, channel,
-					  config->direction);
-			ret = -EINVAL;
-			goto out;
-		}
+		p->chan[channel].cfg_hi |=
+			DW_CFGH_SRC_PER(config->src_dev) |
+			DW_CFGH_DST_PER(config->dest_dev);
+		break;
+	default:
+		trace_dwdma_error("dw-dma: %d channel %d invalid direction %d",
+				  dma->plat_data.id, channel,
+				  config->direction);
+		ret = -EINVAL;
+		goto out;
+	}
+
+	/* fill in the ring, only addresses and sizes differ per lli */
+	for (i = 0; i < config->elem_array.count; i++) {
+
+		sg_elem = config->elem_array.elems + i;
 
 		if (sg_elem->size > DW_CTLH_BLOCK_TS_MASK) {
 			trace_dwdma_error("dw-dma: %d channel %d block size too big %d",
@@ -895,6 +947,12 @@ static int dw_dma_set_config(struct dma *dma, int channel,
 			goto out;
 		}
 
+		lli_desc->sar = (uint32_t)sg_elem->src | sar_mask;
+		lli_desc->dar = (uint32_t)sg_elem->dest | dar_mask;
+		lli_desc->ctrl_lo = ctrl_lo;
+		lli_desc->sstat = 0;
+		lli_desc->dstat = 0;
+
 		/* set transfer size of element */
 #if defined CONFIG_BAYTRAIL || defined CONFIG_CHERRYTRAIL \
 	|| defined CONFIG_APOLLOLAKE || defined CONFIG_CANNONLAKE \
@@ -930,6 +988,13 @@ static int dw_dma_set_config(struct dma *dma, int channel,
 #endif
 	}
 
+	p->chan[channel].reload = 0;
+#if !DW_USE_HW_LLI
+	/* no HW LLI, a timer driven ring would stop after its first block */
+	if (p->chan[channel].timer_delay && config->cyclic)
+		dw_dma_set_reload(dma, channel);
+#endif
+
 	/* write back descriptors so DMA engine can read them directly */
 	dcache_writeback_region(p->chan[channel].lli,
 			sizeof(struct dw_lli2) * p->chan[channel].desc_count);
@@ -1130,27 +1195,245 @@ static void dw_dma_process_block(struct dma_chan_data *chan,
 	chan->lli_current = (struct dw_lli2 *)chan->lli_current->llp;
 }
 
+/* bytes transferred by a single lli block */
+static inline uint32_t dw_dma_lli_bytes(struct dw_lli2 *lli)
+{
+#if defined CONFIG_BROADWELL || defined CONFIG_HASWELL
+	/* for bdw, the unit is transaction--TR_WIDTH. */
+	return (lli->ctrl_hi & DW_CTLH_BLOCK_TS_MASK) *
+		(1 << (lli->ctrl_lo >> 4 & 0x7));
+#else
+	return lli->ctrl_hi & DW_CTLH_BLOCK_TS_MASK;
+#endif
+}
+
+/* memory side address of lli or of the running channel */
+static inline uint32_t dw_dma_mem_addr(struct dma *dma, int channel,
+				       struct dw_lli2 *lli)
+{
+	struct dma_pdata *p = dma_get_drvdata(dma);
+
+	if (p->chan[channel].direction == DMA_DIR_DEV_TO_MEM)
+		return lli ? lli->dar : dw_read(dma, DW_DAR(channel));
+
+	return lli ? lli->sar : dw_read(dma, DW_SAR(channel));
+}
+
+#if !DW_USE_HW_LLI
+/* merge a contiguous cyclic ring into a single block that the hardware
+ * reloads by itself. The ring is left as is if it cannot be merged.
+ */
+static void dw_dma_set_reload(struct dma *dma, int channel)
+{
+	struct dma_pdata *p = dma_get_drvdata(dma);
+	struct dma_chan_data *chan = &p->chan[channel];
+	struct dw_lli2 *lli = chan->lli;
+	uint32_t start = dw_dma_mem_addr(dma, channel, lli);
+	uint32_t size = 0;
+	uint32_t ts;
+	int i;
+
+	/* the device side address must be fixed */
+	if (chan->direction != DMA_DIR_MEM_TO_DEV &&
+	    chan->direction != DMA_DIR_DEV_TO_MEM)
+		return;
+
+	for (i = 0; i < chan->desc_count; i++) {
+		if (dw_dma_mem_addr(dma, channel, lli + i) != start + size) {
+			trace_dwdma_error("dw-dma: %d channel %d ring not contiguous",
+					  dma->plat_data.id, channel);
+			return;
+		}
+		size += dw_dma_lli_bytes(lli + i);
+	}
+
+#if defined CONFIG_BROADWELL || defined CONFIG_HASWELL
+	/* for bdw, the unit is transaction--TR_WIDTH. */
+	ts = size / (1 << (lli->ctrl_lo >> 4 & 0x7));
+#else
+	ts = size;
+#endif
+	if (ts > DW_CTLH_BLOCK_TS_MASK) {
+		trace_dwdma_error("dw-dma: %d channel %d ring too big %d",
+				  dma->plat_data.id, channel, size);
+		return;
+	}
+
+	chan->reload = 1;
+	chan->reload_start = start;
+	chan->reload_size = size;
+	chan->reload_block = dw_dma_lli_bytes(lli);
+	chan->reload_pos = start;
+
+	lli->ctrl_hi = (lli->ctrl_hi & ~DW_CTLH_BLOCK_TS_MASK) | ts;
+	lli->llp = (uint32_t)lli;
+	chan->desc_count = 1;
+	chan->cfg_lo |= DW_CFG_RELOAD_SRC | DW_CFG_RELOAD_DST;
+}
+#endif
+
+/* bytes moved by an auto reloaded block since the last reported position */
+static inline uint32_t dw_dma_reload_bytes(struct dma_chan_data *chan,
+					   uint32_t pos)
+{
+	if (pos >= chan->reload_pos)
+		return pos - chan->reload_pos;
+
+	return pos + chan->reload_size - chan->reload_pos;
+}
+
+/* timer driven channels run without block IRQs, so work out how far the
+ * hardware got since the last run and report it in one callback.
+ */
 static uint64_t dw_dma_work(void *data, uint64_t delay)
 {
 	struct dma_id *dma_id = (struct dma_id *)data;
 	struct dma *dma = dma_id->dma;
 	struct dma_pdata *p = dma_get_drvdata(dma);
+	struct dma_chan_data *chan;
+	struct dw_lli2 *lli;
 	struct dma_sg_elem next;
+	uint32_t bytes = 0;
+	uint32_t start;
+	uint32_t end;
+	uint32_t pos;
 	int i = dma_id->channel;
+	int j;
 
 	tracev_dwdma("dw-dma: %d channel work", dma->plat_data.id,
 		     dma_id->channel);
 
-	if (p->chan[i].status != COMP_STATE_ACTIVE) {
+	chan = &p->chan[i];
+
+	if (chan->status != COMP_STATE_ACTIVE) {
 		trace_dwdma_error("dw-dma: %d channel %d not running",
 				  dma->plat_data.id, dma_id->channel);
 		/* skip if channel is not running */
 		return 0;
 	}
 
-	dw_dma_process_block(&p->chan[i], &next);
+	pos = dw_dma_mem_addr(dma, i, NULL);
+
+	if (chan->reload) {
+		/* report whole periods only, like the per block path */
+		bytes = dw_dma_reload_bytes(chan, pos);
+		bytes -= bytes % chan->reload_block;
 
-	return next.size == DMA_RELOAD_END ? 0 : p->chan[i].timer_delay;
+		chan->reload_pos += bytes;
+		if (chan->reload_pos >= chan->reload_start + chan->reload_size)
+			chan->reload_pos -= chan->reload_size;
+	}
+
+	/* retire every block the hardware has moved past */
+	for (j = 0; j < chan->desc_count && !chan->reload; j++) {
+		lli = chan->lli_current;
+		start = dw_dma_mem_addr(dma, i, lli);
+		end = start + dw_dma_lli_bytes(lli);
+
+		/* block still in progress */
+		if (pos >= start && pos < end)
+			break;
+
+		bytes += end - start;
+
+		lli->ctrl_hi &= ~DW_CTLH_DONE(1);
+		dcache_writeback_region(lli, sizeof(*lli));
+		chan->lli_current = (struct dw_lli2 *)lli->llp;
+
+		/* hardware stopped right at the end of this block */
+		if (pos == end || !chan->lli_current)
+			break;
+	}
+
+	if (!bytes)
+		return chan->timer_delay;
+
+	/* reload lli by default */
+	next.src = DMA_RELOAD_LLI;
+	next.dest = DMA_RELOAD_LLI;
+	next.size = bytes;
+
+	if (chan->cb)
+		chan->cb(chan->cb_data,
+			 DMA_IRQ_TYPE_BLOCK | DMA_IRQ_TYPE_BYTES, &next);
+
+	if (next.size == DMA_RELOAD_END) {
+		tracev_dwdma("dw-dma: %d channel %d block end",
+			     dma->plat_data.id, i);
+
+		/* disable channel, finished */
+		dw_write(dma, DW_DMA_CHAN_EN, CHAN_DISABLE(i));
+		chan->status = COMP_STATE_PREPARE;
+		return 0;
+	}
+
+	return chan->timer_delay;
+}
+
+/* hardware progress since the last retired block against the ring size */
+static int dw_dma_get_data_size(struct dma *dma, int channel,
+				uint32_t *avail, uint32_t *free)
+{
+	struct dma_pdata *p = dma_get_drvdata(dma);
+	struct dma_chan_data *chan;
+	struct dw_lli2 *lli;
+	uint32_t flags;
+	uint32_t total = 0;
+	uint32_t done = 0;
+	uint32_t start;
+	uint32_t pos;
+	int found = 0;
+	int i;
+
+	if (channel >= dma->plat_data.channels) {
+		trace_dwdma_error("dw-dma: %d invalid channel %d",
+				  dma->plat_data.id, channel);
+		return -EINVAL;
+	}
+
+	spin_lock_irq(&dma->lock, flags);
+
+	chan = &p->chan[channel];
+	pos = dw_dma_mem_addr(dma, channel, NULL);
+	lli = chan->lli_current;
+
+	if (chan->reload) {
+		total = chan->reload_size;
+		done = dw_dma_reload_bytes(chan, pos);
+		lli = NULL;
+	}
+
+	for (i = 0; i < chan->desc_count && lli; i++) {
+		start = dw_dma_mem_addr(dma, channel, lli);
+		total += dw_dma_lli_bytes(lli);
+
+		if (!found) {
+			if (pos >= start && pos < start + dw_dma_lli_bytes(lli)) {
+				done += pos - start;
+				found = 1;
+			} else {
+				done += dw_dma_lli_bytes(lli);
+			}
+		}
+
+		lli = (struct dw_lli2 *)lli->llp;
+	}
+
+	spin_unlock_irq(&dma->lock, flags);
+
+	if (done > total)
+		done = total;
+
+	/* capture produces data, playback frees space */
+	if (chan->direction == DMA_DIR_DEV_TO_MEM) {
+		*avail = done;
+		*free = total - done;
+	} else {
+		*avail = total - done;
+		*free = done;
+	}
+
+	return 0;
 }
 
 #if CONFIG_APOLLOLAKE
@@ -1399,8 +1682,17 @@ static int dw_dma_probe(struct dma *dma)
 
 static int dw_dma_remove(struct dma *dma)
 {
-	pm_runtime_put_sync(DW_DMAC_CLK, dma->plat_data.id);
-	rfree(dma_get_drvdata(dma));
+	struct dma_pdata *p = dma_get_drvdata(dma);
+	int i;
+
+	/* gate the clock later so back to back streams don't toggle it */
+	pm_runtime_put(DW_DMAC_CLK, dma->plat_data.id);
+
+	/* free the lli rings kept across channel get/put */
+	for (i = 0; i < dma->plat_data.channels; i++)
+		rfree(p->chan[i].lli);
+
+	rfree(p);
 	dma_set_drvdata(dma, NULL);
 	return 0;
 }
@@ -1409,12 +1701,14 @@ const struct dma_ops dw_dma_ops = {
 	.channel_get	= dw_dma_channel_get,
 	.channel_put	= dw_dma_channel_put,
 	.start		= dw_dma_start,
+	.start_group	= dw_dma_start_group,
 	.stop		= dw_dma_stop,
 	.pause		= dw_dma_pause,
 	.release	= dw_dma_release,
 	.status		= dw_dma_status,
 	.set_config	= dw_dma_set_config,
 	.set_cb		= dw_dma_set_cb,
+	.get_data_size	= dw_dma_get_data_size,
 	.pm_context_restore		= dw_dma_pm_context_restore,
 	.pm_context_store		= dw_dma_pm_context_store,
 	.probe		= dw_dma_probe,
@@ -81,6 +81,15 @@ struct dmic_configuration {
 	int32_t fir_b_scale;
 };
 
+/* decimator mode selected for the params last seen by set_config, the
+ * params copy follows the struct
+ */
+struct dmic_cfg_cache {
+	struct dmic_configuration cfg;
+	struct sof_ipc_dai_dmic_params *prm;
+	int valid;
+};
+
 struct pdm_controllers_configuration {
 	uint32_t cic_control;
 	uint32_t cic_config;
@@ -225,9 +234,15 @@ static uint64_t dmic_work(void *data, uint64_t delay)
 	/* Note that DMIC gain value zero has a special purpose. Value zero
 	 * sets gain bypass mode in HW. Zero value will be applied after ramp
 	 * is complete. It is because exact 1.0 gain is not possible with Q1.19.
+	 * A requested output gain ends the ramp at that gain instead, so
+	 * level is applied by the decimator and not by a later component.
 	 */
-	if (gval > DMIC_HW_FIR_GAIN_MAX)
+	if (dmic->gain_target && dmic->gain >= dmic->gain_target) {
+		dmic->gain = dmic->gain_target;
+		gval = dmic->gain >> 11;
+	} else if (gval > DMIC_HW_FIR_GAIN_MAX) {
 		gval = 0;
+	}
 
 	/* Write gain to registers */
 	for (i = 0; i < DMIC_HW_CONTROLLERS; i++) {
@@ -260,7 +275,7 @@ static uint64_t dmic_work(void *data, uint64_t delay)
 	}
 	spin_unlock(&dai->lock);
 
-	if (gval)
+	if (gval && dmic->gain != dmic->gain_target)
 		return DMIC_UNMUTE_RAMP_US;
 	else
 		return 0;
@@ -1182,6 +1197,14 @@ static int dmic_set_config(struct dai *dai, struct sof_ipc_dai_config *config)
 		goto finish;
 	}
 
+	/* reopening with the same params reuses the previous selection */
+	if (dmic->cfg_cache && dmic->cfg_cache->valid &&
+	    !memcmp(dmic->cfg_cache->prm, prm, size)) {
+		trace_dmic("dmic_set_config(): reuse cached mode");
+		cfg = dmic->cfg_cache->cfg;
+		goto configure;
+	}
+
 	/* Match and select optimal decimators configuration for FIFOs A and B
 	 * paths. This setup phase is still abstract. Successful completion
 	 * points struct cfg to FIR coefficients and contains the scale value
@@ -1213,6 +1236,23 @@ static int dmic_set_config(struct dai *dai, struct sof_ipc_dai_config *config)
 		goto finish;
 	}
 
+	/* remember the selection for the next stream with these params */
+	if (!dmic->cfg_cache) {
+		dmic->cfg_cache = rzalloc(RZONE_SYS_RUNTIME, SOF_MEM_CAPS_RAM,
+					  sizeof(*dmic->cfg_cache) + size);
+		if (dmic->cfg_cache)
+			dmic->cfg_cache->prm =
+				(struct sof_ipc_dai_dmic_params *)
+				(dmic->cfg_cache + 1);
+	}
+
+	if (dmic->cfg_cache) {
+		memcpy(dmic->cfg_cache->prm, prm, size);
+		dmic->cfg_cache->cfg = cfg;
+		dmic->cfg_cache->valid = 1;
+	}
+
+configure:
 	trace_dmic("dmic_set_config(), cfg clkdiv = %u", cfg.clkdiv);
 	trace_dmic("dmic_set_config(), "
 		   "mcic = %u, mfir_a = %u, mfir_b = %u, cic_shift = %u",
@@ -1234,6 +1274,12 @@ static int dmic_set_config(struct dai *dai, struct sof_ipc_dai_config *config)
 		goto finish;
 	}
 
+	/* fixed output gain in the decimator, HW can only attenuate */
+	dmic->gain_target = 0;
+	if (prm->out_gain &&
+	    (prm->out_gain >> 11) <= DMIC_HW_FIR_GAIN_MAX)
+		dmic->gain_target = MAX(prm->out_gain, LOGRAMP_GI);
+
 	dmic->state = COMP_STATE_PREPARE;
 
 finish:
@@ -1506,6 +1552,8 @@ static int dmic_probe(struct dai *dai)
 
 static int dmic_remove(struct dai *dai)
 {
+	struct dmic_pdata *dmic = dai_get_drvdata(dai);
+
 	interrupt_disable(dmic_irq(dai));
 	platform_interrupt_mask(dmic_irq(dai), 0);
 	interrupt_unregister(dmic_irq(dai));
@@ -1514,7 +1562,8 @@ static int dmic_remove(struct dai *dai)
 	/* Disable DMIC power */
 	pm_runtime_put_sync(DMIC_POW, dai->index);
 
-	rfree(dma_get_drvdata(dai));
+	rfree(dmic->cfg_cache);
+	rfree(dmic);
 	dai_set_drvdata(dai, NULL);
 
 	return 0;
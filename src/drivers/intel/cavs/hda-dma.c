@@ -44,6 +44,7 @@
 #include <sof/ipc.h>
 #include <sof/pm_runtime.h>
 #include <sof/wait.h>
+#include <sof/timebase.h>
 #include <sof/audio/format.h>
 #include <sof/math/numbers.h>
 #include <platform/dma.h>
@@ -88,12 +89,14 @@
 
 #define HDA_DMA_MAX_CHANS		9
 
-#define HDA_LINK_1MS_US	1000
+/* buffer full poll period during host preload */
+#define HDA_PRELOAD_POLL_US	100
 
 #define HDA_STATE_HOST_PRELOAD	BIT(0)
 #define HDA_STATE_BF_WAIT	BIT(1)
-#define HDA_STATE_INIT		BIT(2)
-#define HDA_STATE_RELEASE	BIT(3)
+#define HDA_STATE_RELEASE	BIT(2)
+#define HDA_STATE_FAST_START	BIT(3)
+#define HDA_STATE_HOST_FILL	BIT(4)
 
 /*
  * DMA Pointer Trace
@@ -158,7 +161,9 @@ struct hda_chan_data {
 
 	uint32_t period_bytes;
 	uint32_t buffer_bytes;
-	struct work dma_ch_work;
+	struct work preload_work;	/* polls buffer full on preload */
+	uint64_t preload_deadline;
+	uint32_t fill_bytes;	/* host bytes reported before buffer full */
 
 #if HDA_DMA_PTR_DBG
 	struct hda_dbg_data dbg_data;
@@ -318,50 +323,152 @@ static inline uint32_t hda_dma_get_free_size(struct dma *dma, uint32_t chan)
 	return bs - hda_dma_get_data_size(dma, chan);
 }
 
-static int hda_dma_host_preload(struct dma *dma, struct hda_chan_data *chan)
+/* bytes of whole periods the host has written and the DSP not released */
+static uint32_t hda_dma_host_periods(struct dma *dma,
+				     struct hda_chan_data *chan)
+{
+	uint32_t ds = hda_dma_get_data_size(dma, chan->index);
+
+	return ds - ds % chan->period_bytes;
+}
+
+/* preloaded bytes, the buffer full or on fast start its first periods */
+static uint32_t hda_dma_preload_bytes(struct dma *dma,
+				      struct hda_chan_data *chan)
+{
+	if (chan->state & HDA_STATE_FAST_START)
+		return hda_dma_host_periods(dma, chan);
+
+	if (host_dma_reg_read(dma, chan->index, DGCS) & DGCS_BF)
+		return chan->buffer_bytes;
+
+	return 0;
+}
+
+/* period callbacks run once, from whichever of copy or work sees BF first,
+ * a fast start keeps reporting periods from copy until the buffer is full
+ */
+static void hda_dma_preload_complete(struct dma *dma,
+				     struct hda_chan_data *chan,
+				     uint32_t bytes)
 {
 	struct dma_sg_elem next = {
 			.src = DMA_RELOAD_LLI,
 			.dest = DMA_RELOAD_LLI,
 			.size = DMA_RELOAD_LLI
 	};
-	int i;
-	int period_cnt;
+	uint32_t flags;
+
+	spin_lock_irq(&dma->lock, flags);
 
-	uint64_t deadline = platform_timer_get(platform_timer) +
-			    clock_ms_to_ticks(PLATFORM_DEFAULT_CLOCK, 1) *
-					      PLATFORM_HOST_DMA_TIMEOUT / 1000;
+	if (!(chan->state & HDA_STATE_HOST_PRELOAD)) {
+		spin_unlock_irq(&dma->lock, flags);
+		return;
+	}
 
-	/* waiting for buffer full after start
-	 * first try is unblocking, then blocking
-	 */
-	while (!(host_dma_reg_read(dma, chan->index, DGCS) & DGCS_BF) &&
-	       (chan->state & HDA_STATE_BF_WAIT)) {
-		if (deadline < platform_timer_get(platform_timer)) {
-			return -ETIME;
-		}
+	chan->state &= ~(HDA_STATE_HOST_PRELOAD | HDA_STATE_BF_WAIT |
+			 HDA_STATE_FAST_START);
+	if (bytes < chan->buffer_bytes) {
+		chan->state |= HDA_STATE_HOST_FILL;
+		chan->fill_bytes = bytes;
 	}
 
-	if (host_dma_reg_read(dma, chan->index, DGCS) & DGCS_BF) {
-		chan->state &= ~(HDA_STATE_HOST_PRELOAD | HDA_STATE_BF_WAIT);
-		if (chan->cb) {
-			/* loop over each period */
-			period_cnt = chan->buffer_bytes /
-					chan->period_bytes;
-			for (i = 0; i < period_cnt; i++)
-				chan->cb(chan->cb_data,
-					 DMA_IRQ_TYPE_LLIST, &next);
-			/* do not need to test out next in this path */
-		}
-	} else {
-		/* next call in pre-load state will be blocking */
+	spin_unlock_irq(&dma->lock, flags);
+
+	if (chan->cb) {
+		/* report all preloaded periods in a single callback */
+		next.size = bytes;
+		chan->cb(chan->cb_data,
+			 DMA_IRQ_TYPE_LLIST | DMA_IRQ_TYPE_BYTES, &next);
+		/* do not need to test out next in this path */
+	}
+}
+
+/*
+ * Fast start, the DSP consumes periods while the host is still filling the
+ * buffer. Nothing is released to the gateway until the buffer has been full
+ * once, so each copy reports the periods written since the previous one.
+ */
+static int hda_dma_host_fill(struct dma *dma, struct hda_chan_data *chan)
+{
+	struct dma_sg_elem next = {
+			.src = DMA_RELOAD_LLI,
+			.dest = DMA_RELOAD_LLI,
+			.size = DMA_RELOAD_LLI
+	};
+	uint32_t bytes = hda_dma_host_periods(dma, chan);
+
+	if (bytes <= chan->fill_bytes)
+		return 0;
+
+	next.size = bytes - chan->fill_bytes;
+	chan->fill_bytes = bytes;
+	if (bytes == chan->buffer_bytes)
+		chan->state &= ~HDA_STATE_HOST_FILL;
+
+	if (chan->cb)
+		chan->cb(chan->cb_data,
+			 DMA_IRQ_TYPE_LLIST | DMA_IRQ_TYPE_BYTES, &next);
+
+	return 0;
+}
+
+static uint64_t hda_dma_preload_work(void *data, uint64_t delay)
+{
+	struct hda_chan_data *chan = (struct hda_chan_data *)data;
+	uint32_t bytes;
+
+	/* completed by copy or channel stopped */
+	if (!(chan->state & HDA_STATE_BF_WAIT))
+		return 0;
+
+	bytes = hda_dma_preload_bytes(chan->dma, chan);
+	if (bytes) {
+		hda_dma_preload_complete(chan->dma, chan, bytes);
+		return 0;
+	}
+
+	/* give up polling, next copy reports the timeout */
+	if (chan->preload_deadline < timebase_get()) {
+		trace_hddma_error("hda-dmac: %d channel %d preload timeout",
+				  chan->dma->plat_data.id, chan->index);
+		return 0;
+	}
+
+	return HDA_PRELOAD_POLL_US;
+}
+
+static int hda_dma_host_preload(struct dma *dma, struct hda_chan_data *chan)
+{
+	uint32_t bytes = hda_dma_preload_bytes(dma, chan);
+
+	if (bytes) {
+		hda_dma_preload_complete(dma, chan, bytes);
+		return 0;
+	}
+
+	/* wait for buffer full from work instead of spinning in copy */
+	if (!(chan->state & HDA_STATE_BF_WAIT)) {
 		chan->state |= HDA_STATE_BF_WAIT;
+		chan->preload_deadline = timebase_get() +
+			clock_ms_to_ticks(PLATFORM_DEFAULT_CLOCK, 1) *
+			PLATFORM_HOST_DMA_TIMEOUT / 1000;
+
+		work_init(&chan->preload_work, hda_dma_preload_work, chan,
+			  WORK_ASYNC);
+		work_schedule_default(&chan->preload_work,
+				      HDA_PRELOAD_POLL_US);
+		return 0;
 	}
 
+	if (chan->preload_deadline < timebase_get())
+		return -ETIME;
+
 	return 0;
 }
 
-static void hda_dma_post_copy(struct dma *dma, struct hda_chan_data *chan)
+static void hda_dma_post_copy(struct dma *dma, struct hda_chan_data *chan,
+			      int bytes, uint32_t flags)
 {
 	struct dma_sg_elem next = {
 			.src = DMA_RELOAD_LLI,
@@ -374,7 +481,16 @@ static void hda_dma_post_copy(struct dma *dma, struct hda_chan_data *chan)
 		next.dest = DMA_RELOAD_LLI;
 		next.size = DMA_RELOAD_LLI;
 
-		chan->cb(chan->cb_data, DMA_IRQ_TYPE_LLIST, &next);
+		if (flags & DMA_COPY_BATCH) {
+			/* several periods moved, report them in one go */
+			next.size = bytes;
+			chan->cb(chan->cb_data,
+				 DMA_IRQ_TYPE_LLIST | DMA_IRQ_TYPE_BYTES,
+				 &next);
+		} else {
+			chan->cb(chan->cb_data, DMA_IRQ_TYPE_LLIST, &next);
+		}
+
 		if (next.size == DMA_RELOAD_END) {
 			/* disable channel, finished */
 			hda_dma_stop(dma, chan->index);
@@ -412,7 +528,7 @@ static int hda_dma_link_copy_ch(struct dma *dma, struct hda_chan_data *chan,
 	 * which will trigger next copy start.
 	 */
 	hda_dma_inc_link_fp(dma, chan->index, bytes);
-	hda_dma_post_copy(dma, chan);
+	hda_dma_post_copy(dma, chan, bytes, 0);
 
 	hda_dma_get_dbg_vals(chan, HDA_DBG_POST, HDA_DBG_LINK);
 	hda_dma_ptr_trace(chan, "link copy", HDA_DBG_LINK);
@@ -421,7 +537,7 @@ static int hda_dma_link_copy_ch(struct dma *dma, struct hda_chan_data *chan,
 }
 
 static int hda_dma_host_copy_ch(struct dma *dma, struct hda_chan_data *chan,
-				int bytes)
+				int bytes, uint32_t flags)
 {
 	tracev_hddma("hda-dmac: %d channel %d -> copy 0x%x bytes",
 		     dma->plat_data.id, chan->index, bytes);
@@ -434,7 +550,7 @@ static int hda_dma_host_copy_ch(struct dma *dma, struct hda_chan_data *chan,
 	hda_dma_get_dbg_vals(chan, HDA_DBG_PRE, HDA_DBG_HOST);
 
 	hda_dma_inc_fp(dma, chan->index, bytes);
-	hda_dma_post_copy(dma, chan);
+	hda_dma_post_copy(dma, chan, bytes, flags);
 
 	hda_dma_get_dbg_vals(chan, HDA_DBG_POST, HDA_DBG_HOST);
 	hda_dma_ptr_trace(chan, "host copy", HDA_DBG_HOST);
@@ -473,55 +589,23 @@ static void hda_dma_enable_unlock(struct dma *dma, int channel)
 		hda_dma_inc_link_fp(dma, channel,
 				    p->chan[channel].buffer_bytes);
 
-	p->chan[channel].state &= ~(HDA_STATE_INIT | HDA_STATE_RELEASE);
+	p->chan[channel].state &= ~HDA_STATE_RELEASE;
 
 	hda_dma_get_dbg_vals(&p->chan[channel], HDA_DBG_POST, HDA_DBG_BOTH);
 	hda_dma_ptr_trace(&p->chan[channel], "enable", HDA_DBG_BOTH);
 }
 
-static void hda_dma_enable(struct dma *dma, int channel)
-{
-	uint32_t flags;
-
-	spin_lock_irq(&dma->lock, flags);
-
-	hda_dma_enable_unlock(dma, channel);
-
-	spin_unlock_irq(&dma->lock, flags);
-}
-
-static uint64_t hda_dma_link_work(void *data, uint64_t delay)
-{
-	struct hda_chan_data *chan = (struct hda_chan_data *)data;
-
-	/* align pointers on release */
-	if (chan->state & HDA_STATE_RELEASE) {
-		hda_dma_inc_link_fp(chan->dma, chan->index,
-				    chan->period_bytes);
-	}
-
-	if (chan->state & HDA_STATE_INIT)
-		hda_dma_enable(chan->dma, chan->index);
-	else
-		hda_dma_link_copy_ch(chan->dma, chan, chan->period_bytes);
-
-	/* next time to re-arm */
-	return HDA_LINK_1MS_US;
-}
-
-/* notify DMA to copy bytes */
+/*
+ * Link DMA has no period interrupts. The DAI polls its progress with
+ * dma_get_data_size() from the pipeline task and copies each period the
+ * link has moved.
+ */
 static int hda_dma_link_copy(struct dma *dma, int channel, int bytes,
 			     uint32_t flags)
 {
 	struct dma_pdata *p = dma_get_drvdata(dma);
-	struct hda_chan_data *chan = p->chan + channel;
-
-	if (chan->state & HDA_STATE_INIT)
-		return 0;
-	else
-		return hda_dma_link_copy_ch(dma, chan, bytes);
 
-	return 0;
+	return hda_dma_link_copy_ch(dma, p->chan + channel, bytes);
 }
 
 /* notify DMA to copy bytes */
@@ -539,13 +623,15 @@ static int hda_dma_host_copy(struct dma *dma, int channel, int bytes,
 
 	if (flags & DMA_COPY_PRELOAD)
 		chan->state |= HDA_STATE_HOST_PRELOAD;
+	if (flags & DMA_COPY_FAST_START)
+		chan->state |= HDA_STATE_FAST_START;
 
-	if (chan->state & HDA_STATE_INIT)
-		return 0;
-	else if (chan->state & HDA_STATE_HOST_PRELOAD)
+	if (chan->state & HDA_STATE_HOST_PRELOAD)
 		return hda_dma_host_preload(dma, chan);
+	else if (chan->state & HDA_STATE_HOST_FILL)
+		return hda_dma_host_fill(dma, chan);
 	else
-		return hda_dma_host_copy_ch(dma, chan, bytes);
+		return hda_dma_host_copy_ch(dma, chan, bytes, flags);
 
 	return 0;
 }
@@ -604,7 +690,6 @@ static void hda_dma_channel_put_unlocked(struct dma *dma, int channel)
 	p->chan[channel].cb = NULL;
 	p->chan[channel].cb_type = 0;
 	p->chan[channel].cb_data = NULL;
-	work_init(&p->chan[channel].dma_ch_work, NULL, NULL, 0);
 }
 
 /* channel must not be running when this is called */
@@ -650,18 +735,11 @@ static int hda_dma_start(struct dma *dma, int channel)
 		goto out;
 	}
 
-	p->chan[channel].state |= HDA_STATE_INIT;
+	/* align pointers on release */
+	if (p->chan[channel].state & HDA_STATE_RELEASE)
+		hda_dma_inc_link_fp(dma, channel, p->chan[channel].period_bytes);
 
-	/*
-	 * Activate timer if configured in cyclic mode.
-	 * In cyclic mode DMA start is scheduled for later,
-	 * to make sure we stay synchronized with the system work queue.
-	 */
-	if (p->chan[channel].dma_ch_work.cb)
-		work_schedule_default(&p->chan[channel].dma_ch_work,
-				      HDA_LINK_1MS_US);
-	else
-		hda_dma_enable_unlock(dma, channel);
+	hda_dma_enable_unlock(dma, channel);
 
 out:
 	spin_unlock_irq(&dma->lock, flags);
@@ -686,7 +764,7 @@ static int hda_dma_release(struct dma *dma, int channel)
 		    channel);
 
 	/*
-	 * Prepare for the handling of release condition on the first work cb.
+	 * Prepare for the handling of release condition on the next start.
 	 * This flag will be unset afterwards.
 	 */
 	p->chan[channel].state |= HDA_STATE_RELEASE;
@@ -741,8 +819,9 @@ static int hda_dma_stop(struct dma *dma, int channel)
 	trace_hddma("hda-dmac: %d channel %d -> stop", dma->plat_data.id,
 		    channel);
 
-	if (p->chan[channel].dma_ch_work.cb)
-		work_cancel_default(&p->chan[channel].dma_ch_work);
+	/* preload work is only queued while waiting for buffer full */
+	if (p->chan[channel].state & HDA_STATE_BF_WAIT)
+		work_cancel_default(&p->chan[channel].preload_work);
 
 	/* disable the channel */
 	hda_update_bits(dma, channel, DGCS, DGCS_GEN | DGCS_FIFORDY, 0);
@@ -861,12 +940,6 @@ static int hda_dma_set_config(struct dma *dma, int channel,
 	p->chan[channel].period_bytes = period_bytes;
 	p->chan[channel].buffer_bytes = buffer_bytes;
 
-	/* initialize timer */
-	if (config->cyclic) {
-		work_init(&p->chan[channel].dma_ch_work, hda_dma_link_work,
-			  &p->chan[channel], WORK_ASYNC);
-	}
-
 	/* init channel in HW */
 	host_dma_reg_write(dma, channel, DGBBA,  buffer_addr);
 	host_dma_reg_write(dma, channel, DGBS,  buffer_bytes);
@@ -912,6 +985,26 @@ static int hda_dma_pm_context_store(struct dma *dma)
 	return 0;
 }
 
+static int hda_dma_data_size(struct dma *dma, int channel, uint32_t *avail,
+			     uint32_t *free)
+{
+	uint32_t flags;
+
+	if (channel >= HDA_DMA_MAX_CHANS) {
+		trace_hddma_error("hda-dmac: %d invalid channel %d",
+				  dma->plat_data.id, channel);
+		return -EINVAL;
+	}
+
+	spin_lock_irq(&dma->lock, flags);
+
+	*avail = hda_dma_get_data_size(dma, channel);
+	*free = host_dma_reg_read(dma, channel, DGBS) - *avail;
+
+	spin_unlock_irq(&dma->lock, flags);
+	return 0;
+}
+
 static int hda_dma_set_cb(struct dma *dma, int channel, int type,
 	void (*cb)(void *data, uint32_t type, struct dma_sg_elem *next),
 	void *data)
@@ -984,6 +1077,7 @@ const struct dma_ops hda_host_dma_ops = {
 	.status		= hda_dma_status,
 	.set_config	= hda_dma_set_config,
 	.set_cb		= hda_dma_set_cb,
+	.get_data_size	= hda_dma_data_size,
 	.pm_context_restore		= hda_dma_pm_context_restore,
 	.pm_context_store		= hda_dma_pm_context_store,
 	.probe		= hda_dma_probe,
@@ -1001,6 +1095,7 @@ const struct dma_ops hda_link_dma_ops = {
 	.status		= hda_dma_status,
 	.set_config	= hda_dma_set_config,
 	.set_cb		= hda_dma_set_cb,
+	.get_data_size	= hda_dma_data_size,
 	.pm_context_restore		= hda_dma_pm_context_restore,
 	.pm_context_store		= hda_dma_pm_context_store,
 	.probe		= hda_dma_probe,
@@ -40,6 +40,9 @@
 #include <platform/interrupt.h>
 #include <platform/platcfg.h>
 #include <platform/shim.h>
+#include <platform/timer.h>
+#include <sof/drivers/timer.h>
+#include <platform/platform.h>
 #include <stdint.h>
 #include <stdlib.h>
 
@@ -50,8 +53,13 @@ static inline void irq_lvl2_handler(void *data, int level, uint32_t ilxsd,
 	struct irq_desc *child = NULL;
 	struct list_item *clist;
 	uint32_t status;
-	uint32_t i = 0;
+	uint32_t i;
 	uint32_t unmask = 0;
+#ifdef CONFIG_IRQ_STATS
+	uint64_t dispatch = platform_timer_get(platform_timer);
+#else
+	uint64_t dispatch = 0;
+#endif
 
 	/* mask the parent IRQ */
 	arch_interrupt_disable_mask(1 << level);
@@ -60,18 +68,17 @@ static inline void irq_lvl2_handler(void *data, int level, uint32_t ilxsd,
 	status = irq_read(ilxsd);
 	irq_write(ilxmsd, status);
 
-	/* handle each child */
+	/* handle each asserted child bit, skipping idle bits */
 	while (status) {
-		/* any IRQ for this child bit ? */
-		if ((status & 0x1) == 0)
-			goto next;
+		i = __builtin_ctz(status);
+		status &= ~(0x1 << i);
 
 		/* get child if any and run handler */
 		list_for_item(clist, &parent->child[i]) {
 			child = container_of(clist, struct irq_desc, irq_list);
 
 			if (child && child->handler) {
-				child->handler(child->handler_arg);
+				interrupt_child_run(child, dispatch);
 				unmask = child->unmask;
 			} else {
 				/* nobody cared ? */
@@ -83,10 +90,6 @@ static inline void irq_lvl2_handler(void *data, int level, uint32_t ilxsd,
 		/* unmask this bit i interrupt */
 		if (unmask)
 			irq_write(ilxmcd, 0x1 << i);
-
-next:
-		status >>= 1;
-		i++;
 	}
 
 	/* clear parent and unmask */
@@ -34,6 +34,7 @@
 #include <platform/timer.h>
 #include <platform/shim.h>
 #include <sof/debug.h>
+#include <sof/clk.h>
 #include <sof/audio/component.h>
 #include <sof/drivers/timer.h>
 #include <stdint.h>
@@ -89,6 +90,13 @@ void platform_host_timestamp(struct comp_dev *host,
 	err = comp_position(host, posn);
 	if (err == 0)
 		posn->flags |= SOF_TIME_HOST_VALID;
+
+	/* system time stamp latched with the host position */
+	posn->timestamp = shim_read64(SHIM_DSPWC);
+	posn->wallclock_hz = clock_ms_to_ticks(PLATFORM_DEFAULT_CLOCK, 1) *
+		1000;
+	posn->timestamp_ns = 1000000000ULL / posn->wallclock_hz;
+	posn->flags |= SOF_TIME_STAMP_VALID | SOF_TIME_STAMP_64;
 }
 
 /* get timestamp for DAI stream DMA position */
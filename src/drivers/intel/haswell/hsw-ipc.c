@@ -129,14 +129,22 @@ static void irq_handler(void *arg)
 
 void ipc_platform_do_cmd(struct ipc *ipc)
 {
-	struct ipc_data *iipc = ipc_get_drvdata(ipc);
-	struct sof_ipc_reply reply;
 	int32_t err;
 
 	trace_ipc("ipc: msg rx -> 0x%x", ipc->host_msg);
 
-	/* perform command and return any error */
+	/* perform command, deferred commands complete later */
 	err = ipc_cmd();
+	if (err != IPC_CMD_DEFERRED)
+		ipc_platform_complete_cmd(ipc, err);
+}
+
+void ipc_platform_complete_cmd(struct ipc *ipc, int32_t err)
+{
+	struct ipc_data *iipc = ipc_get_drvdata(ipc);
+	struct sof_ipc_reply reply;
+
+	/* return any error of the command */
 	if (err > 0) {
 		goto done; /* reply created and copied by cmd() */
 	} else {
@@ -189,6 +197,7 @@ void ipc_platform_send_msg(struct ipc *ipc)
 			      list);
 	mailbox_dspbox_write(0, msg->tx_data, msg->tx_size);
 	list_item_del(&msg->list);
+	msg->queued = 0;
 	ipc->shared_ctx->dsp_msg = msg;
 	tracev_ipc("ipc: msg tx -> 0x%x", msg->header);
 
@@ -217,6 +226,10 @@ int platform_ipc_init(struct ipc *ipc)
 	schedule_task_init(&_ipc->ipc_task, ipc_process_task, _ipc);
 	schedule_task_config(&_ipc->ipc_task, TASK_PRI_IPC, 0);
 
+	/* deferred command stages run behind audio work, see ipc_defer() */
+	schedule_task_init(&_ipc->defer_task, ipc_defer_task, _ipc);
+	schedule_task_config(&_ipc->defer_task, TASK_PRI_LOW, 0);
+
 #ifdef CONFIG_HOST_PTABLE
 	/* allocate page table buffer */
 	iipc->page_table = rzalloc(RZONE_SYS, SOF_MEM_CAPS_RAM,
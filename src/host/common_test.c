@@ -38,6 +38,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <inttypes.h>
 #include <arch/sof.h>
 #include <sof/task.h>
 #include <sof/alloc.h>
@@ -51,6 +52,10 @@
 #include "host/common_test.h"
 #include "host/topology.h"
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
 /* testbench helper functions for pipeline setup and trigger */
 
 int tb_pipeline_setup(struct sof *sof)
@@ -80,6 +85,7 @@ int tb_pipeline_start(struct ipc *ipc, int nch, char *bits_in,
 		      struct sof_ipc_pipe_new *ipc_pipe)
 {
 	struct ipc_comp_dev *pcm_dev;
+	struct sof_ipc_stream *stream;
 	struct pipeline *p;
 	struct comp_dev *cd;
 	int ret;
@@ -102,6 +108,10 @@ int tb_pipeline_start(struct ipc *ipc, int nch, char *bits_in,
 	cd = pcm_dev->cd;
 	p = pcm_dev->cd->pipeline;
 
+	/* a trigger sent to another core reads the stream from comp_data */
+	stream = ipc->comp_data;
+	stream->comp_id = ipc_pipe->sched_id;
+
 	/* Component prepare */
 	ret = pipeline_prepare(p, cd);
 
@@ -186,6 +196,213 @@ int tb_pipeline_params(struct ipc *ipc, int nch, char *bits_in,
 	return ret;
 }
 
+/*
+ * Benchmark mode. Every component gets a private copy of its driver with
+ * copy() replaced by a timed wrapper, so the firmware sources need no
+ * instrumentation and the stats are found from the driver pointer.
+ */
+struct tb_bench_comp {
+	struct comp_driver drv;		/* must be first */
+	struct comp_driver *orig;
+	struct comp_dev *dev;
+	uint64_t count;
+	uint64_t ns;
+	uint64_t cycles;
+	uint64_t max_cycles;
+	struct list_item list;
+};
+
+static struct list_item tb_bench_list;
+
+static inline uint64_t tb_bench_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/* CPU cycle counter where the host has one, nanoseconds otherwise */
+static inline uint64_t tb_bench_cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	return tb_bench_ns();
+#endif
+}
+
+static int tb_bench_copy(struct comp_dev *dev)
+{
+	struct tb_bench_comp *bc = (struct tb_bench_comp *)dev->drv;
+	uint64_t ns = tb_bench_ns();
+	uint64_t cycles = tb_bench_cycles();
+	int ret;
+
+	ret = bc->orig->ops.copy(dev);
+
+	cycles = tb_bench_cycles() - cycles;
+	bc->ns += tb_bench_ns() - ns;
+	bc->cycles += cycles;
+	if (cycles > bc->max_cycles)
+		bc->max_cycles = cycles;
+	bc->count++;
+
+	return ret;
+}
+
+/* install timed copy() for all components */
+int tb_bench_init(struct sof *sof)
+{
+	struct ipc_comp_dev *icd;
+	struct tb_bench_comp *bc;
+	struct list_item *clist;
+
+	list_init(&tb_bench_list);
+
+	list_for_item(clist, &sof->ipc->shared_ctx->comp_list) {
+		icd = container_of(clist, struct ipc_comp_dev, list);
+		if (icd->type != COMP_TYPE_COMPONENT)
+			continue;
+
+		bc = calloc(1, sizeof(*bc));
+		if (!bc)
+			return -ENOMEM;
+
+		bc->drv = *icd->cd->drv;
+		bc->drv.ops.copy = tb_bench_copy;
+		bc->orig = icd->cd->drv;
+		bc->dev = icd->cd;
+		icd->cd->drv = &bc->drv;
+		list_item_append(&bc->list, &tb_bench_list);
+	}
+
+	return 0;
+}
+
+/* bytes of buffers the component writes to */
+static uint32_t tb_bench_buffer_bytes(struct comp_dev *dev)
+{
+	struct comp_buffer *buffer;
+	struct list_item *clist;
+	uint32_t bytes = 0;
+
+	list_for_item(clist, &dev->bsink_list) {
+		buffer = container_of(clist, struct comp_buffer, source_list);
+		bytes += buffer->size;
+	}
+
+	return bytes;
+}
+
+/* print the sum of all components of pipeline p */
+static void tb_bench_pipeline(struct pipeline *p, double audio_sec,
+			      FILE *csv)
+{
+	struct tb_bench_comp *bc;
+	struct list_item *clist;
+	uint64_t cycles = 0;
+	uint64_t ns = 0;
+	uint32_t bytes = 0;
+
+	list_for_item(clist, &tb_bench_list) {
+		bc = container_of(clist, struct tb_bench_comp, list);
+		if (bc->dev->pipeline != p)
+			continue;
+
+		cycles += bc->cycles;
+		ns += bc->ns;
+		bytes += tb_bench_buffer_bytes(bc->dev);
+	}
+
+	printf("pipeline %u: %.3f MCPS, %.1f x realtime, %u buffer bytes\n",
+	       p->ipc_pipe.pipeline_id, cycles / audio_sec / 1e6,
+	       ns ? audio_sec * 1e9 / ns : 0, bytes);
+	if (csv)
+		fprintf(csv, "%u,all,,,,,%.3f,%.1f,%u\n",
+			p->ipc_pipe.pipeline_id, cycles / audio_sec / 1e6,
+			ns ? audio_sec * 1e9 / ns : 0, bytes);
+}
+
+/*
+ * Print per component and per pipeline copy() cost for audio_sec seconds
+ * of processed audio. Cycles are TSC cycles on x86 hosts and nanoseconds
+ * elsewhere. The CSV file gets the same data when not NULL.
+ */
+void tb_bench_report(double audio_sec, FILE *csv)
+{
+	struct tb_bench_comp *bc;
+	struct tb_bench_comp *prev = NULL;
+	struct list_item *clist;
+	struct list_item *plist;
+	uint32_t bytes;
+	double period_cycles;
+	double rt;
+
+	if (list_is_empty(&tb_bench_list) || audio_sec <= 0)
+		return;
+
+	printf("==========================================================\n");
+	printf("		           Benchmark\n");
+	printf("==========================================================\n");
+	printf("%-5s %-5s %-5s %10s %14s %14s %10s %9s %9s\n", "ppl",
+	       "comp", "type", "periods", "cycles/period", "max cycles",
+	       "MCPS", "x RT", "buf bytes");
+	if (csv)
+		fprintf(csv, "pipeline,comp,type,periods,cycles_per_period,"
+			"max_cycles,mcps,realtime_factor,buffer_bytes\n");
+
+	list_for_item(clist, &tb_bench_list) {
+		bc = container_of(clist, struct tb_bench_comp, list);
+		bytes = tb_bench_buffer_bytes(bc->dev);
+		period_cycles = bc->count ?
+			(double)bc->cycles / bc->count : 0;
+		rt = bc->ns ? audio_sec * 1e9 / bc->ns : 0;
+
+		printf("%-5u %-5u %-5u %10" PRIu64 " %14.0f %14" PRIu64
+		       " %10.3f %9.1f %9u\n",
+		       bc->dev->pipeline->ipc_pipe.pipeline_id,
+		       bc->dev->comp.id, bc->dev->comp.type, bc->count,
+		       period_cycles, bc->max_cycles,
+		       bc->cycles / audio_sec / 1e6, rt, bytes);
+		if (csv)
+			fprintf(csv, "%u,%u,%u,%" PRIu64 ",%.0f,%" PRIu64
+				",%.3f,%.1f,%u\n",
+				bc->dev->pipeline->ipc_pipe.pipeline_id,
+				bc->dev->comp.id, bc->dev->comp.type,
+				bc->count, period_cycles, bc->max_cycles,
+				bc->cycles / audio_sec / 1e6, rt, bytes);
+	}
+
+	/* one summary per pipeline, at its first component */
+	list_for_item(clist, &tb_bench_list) {
+		bc = container_of(clist, struct tb_bench_comp, list);
+		list_for_item(plist, &tb_bench_list) {
+			prev = container_of(plist, struct tb_bench_comp, list);
+			if (prev == bc ||
+			    prev->dev->pipeline == bc->dev->pipeline)
+				break;
+		}
+		if (prev == bc)
+			tb_bench_pipeline(bc->dev->pipeline, audio_sec, csv);
+	}
+}
+
+/* restore component drivers and free benchmark data */
+void tb_bench_free(void)
+{
+	struct tb_bench_comp *bc;
+	struct list_item *clist;
+	struct list_item *tlist;
+
+	list_for_item_safe(clist, tlist, &tb_bench_list) {
+		bc = container_of(clist, struct tb_bench_comp, list);
+		bc->dev->drv = bc->orig;
+		list_item_del(&bc->list);
+		free(bc);
+	}
+}
+
 /* getindex of shared library from table */
 int get_index_by_name(char *comp_type,
 		      struct shared_lib_table *lib_table)
@@ -225,6 +442,21 @@ void dai_put(struct dai *dai)
 {
 }
 
+void dai_group_begin(void)
+{
+}
+
+int dai_group_start(struct dai *dai, struct dma *dma, int chan, int cmd,
+		    int direction)
+{
+	return 0;
+}
+
+int dai_group_end(void)
+{
+	return 0;
+}
+
 struct dma *dma_get(uint32_t dir, uint32_t caps, uint32_t dev, uint32_t flags)
 {
 	return NULL;
@@ -234,6 +466,21 @@ void dma_put(struct dma *dma)
 {
 }
 
+struct dma *dma_get_stream(uint32_t dir, uint32_t caps, uint32_t dev,
+			   struct dma_stream *stream)
+{
+	return NULL;
+}
+
+void dma_stream_update(struct dma *dma, struct dma_stream *stream,
+		       uint32_t bandwidth)
+{
+}
+
+void dma_put_stream(struct dma *dma, struct dma_stream *stream)
+{
+}
+
 int dma_sg_alloc(struct dma_sg_elem_array *elem_array,
 		 int zone,
 		 uint32_t direction,
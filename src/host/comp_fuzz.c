@@ -0,0 +1,801 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Host fuzz and benchmark harness for component kernels
+ *
+ * Each case creates one component between a source and a sink buffer and
+ * drives its comp_ops directly: new, params, prepare, trigger and copy.
+ * Stream params, buffer size, wrap position, the control blob given to
+ * new() and the samples all come from a byte stream. That stream is the
+ * fuzzer input, a file to replay, or rand_r() output.
+ *
+ * comp_bench runs seeded random cases and times copy() per frame for a
+ * fixed set of stream combinations. comp_fuzz is the libFuzzer target
+ * built with --enable-fuzzer. AFL can run comp_bench -r @@.
+ */
+
+#include <sof/ipc.h>
+#include <sof/list.h>
+#include <sof/audio/component.h>
+#include <sof/audio/buffer.h>
+#include <sof/audio/pipeline.h>
+#include <platform/memory.h>
+#include <uapi/abi.h>
+#include <uapi/user/crossover.h>
+#include <uapi/user/header.h>
+#include <uapi/user/voice.h>
+#include <getopt.h>
+#include <dlfcn.h>
+#include <inttypes.h>
+#include <time.h>
+#include "host/common_test.h"
+#include "host/trace.h"
+
+/* largest control blob passed to new() */
+#define FUZZ_BLOB_MAX		4096
+
+/* frames per period, buffer periods and copies limits of random cases */
+#define FUZZ_FRAMES_MAX		1024
+#define FUZZ_PERIODS_MAX	4
+#define FUZZ_COPIES_MAX		16
+
+/* copies per benchmark combination */
+#define BENCH_COPIES		10000
+
+/* byte stream the case parameters and samples are taken from */
+struct fuzz_input {
+	const uint8_t *data;
+	size_t size;
+	size_t pos;
+};
+
+struct fuzz_case;
+
+/* component under test */
+struct fuzz_comp {
+	const char *name;
+	const char *library;
+	const char *init;
+	uint32_t type;
+	size_t ipc_size;
+	/* set type specific fields of the new() IPC */
+	void (*config)(struct sof_ipc_comp *comp, struct fuzz_case *fc);
+	void *handle;
+};
+
+/* one set of stream parameters */
+struct fuzz_case {
+	struct fuzz_comp *comp;
+	uint32_t frame_fmt;
+	uint32_t channels;
+	uint32_t rate;
+	uint32_t sink_rate;
+	uint32_t frames;
+	uint32_t periods;
+	uint32_t wrap;
+	uint32_t copies;
+	uint32_t event;		/* 1 + frame of a volume change, 0 for none */
+	const uint8_t *blob;
+	uint32_t blob_size;
+};
+
+static struct sof sof;
+static int initialized;
+
+static const uint32_t rates[] = {
+	8000, 16000, 22050, 32000, 44100, 48000, 88200, 96000, 192000,
+};
+
+static const uint32_t formats[] = {
+	SOF_IPC_FRAME_S16_LE, SOF_IPC_FRAME_S24_4LE, SOF_IPC_FRAME_S32_LE,
+};
+
+static const char * const format_names[] = {
+	"S16_LE", "S24_LE", "S32_LE",
+};
+
+static void config_volume(struct sof_ipc_comp *comp, struct fuzz_case *fc)
+{
+	struct sof_ipc_comp_volume *vol = (struct sof_ipc_comp_volume *)comp;
+
+	vol->channels = fc->channels;
+	vol->max_value = fc->blob_size ? fc->blob[0] << 16 : 0;
+	vol->precision = fc->blob_size > 1 ? fc->blob[1] & 1 : 0;
+}
+
+static void config_src(struct sof_ipc_comp *comp, struct fuzz_case *fc)
+{
+	struct sof_ipc_comp_src *src = (struct sof_ipc_comp_src *)comp;
+
+	/* params give the source rate */
+	src->sink_rate = fc->sink_rate;
+}
+
+/* the process components take the blob after the same fixed header */
+static void config_blob(struct sof_ipc_comp *comp, struct fuzz_case *fc)
+{
+	struct sof_ipc_comp_eq_fir *eq = (struct sof_ipc_comp_eq_fir *)comp;
+
+	eq->size = fc->blob_size;
+	memcpy(eq->data, fc->blob, fc->blob_size);
+}
+
+static void config_voice(struct sof_ipc_comp *comp, struct fuzz_case *fc)
+{
+	struct sof_ipc_comp_voice *voice = (struct sof_ipc_comp_voice *)comp;
+
+	voice->sink_rate = fc->sink_rate;
+	voice->size = fc->blob_size;
+	memcpy(voice->data, fc->blob, fc->blob_size);
+
+	/* new() wants the blob size in its header, fuzz the rest of it */
+	if (fc->blob_size >= sizeof(struct sof_voice_config))
+		((struct sof_voice_config *)voice->data)->size = fc->blob_size;
+}
+
+static void config_crossover(struct sof_ipc_comp *comp, struct fuzz_case *fc)
+{
+	struct sof_ipc_comp_crossover *xo =
+		(struct sof_ipc_comp_crossover *)comp;
+	struct sof_crossover_config *cfg =
+		(struct sof_crossover_config *)xo->data;
+
+	/* the one sink buffer takes the bands interleaved */
+	xo->num_bands = 2 + fc->blob_size % (SOF_CROSSOVER_MAX_BANDS - 1);
+	xo->size = fc->blob_size;
+	memcpy(xo->data, fc->blob, fc->blob_size);
+
+	/* new() wants the blob size and bands in its header, fuzz the rest
+	 * but keep the bands of a valid blob
+	 */
+	if (fc->blob_size >= sizeof(*cfg)) {
+		cfg->size = fc->blob_size;
+		if (cfg->num_bands >= 2 &&
+		    cfg->num_bands <= SOF_CROSSOVER_MAX_BANDS)
+			xo->num_bands = cfg->num_bands;
+		else
+			cfg->num_bands = xo->num_bands;
+	}
+}
+
+static struct fuzz_comp comps[] = {
+	{"vol", "libsof_volume.so", "sys_comp_volume_init", SOF_COMP_VOLUME,
+		sizeof(struct sof_ipc_comp_volume), config_volume, NULL},
+	{"src", "libsof_src.so", "sys_comp_src_init", SOF_COMP_SRC,
+		sizeof(struct sof_ipc_comp_src), config_src, NULL},
+	{"eq_fir", "libsof_eq_fir.so", "sys_comp_eq_fir_init", SOF_COMP_EQ_FIR,
+		sizeof(struct sof_ipc_comp_eq_fir), config_blob, NULL},
+	{"eq_iir", "libsof_eq_iir.so", "sys_comp_eq_iir_init", SOF_COMP_EQ_IIR,
+		sizeof(struct sof_ipc_comp_eq_iir), config_blob, NULL},
+	{"drc", "libsof_drc.so", "sys_comp_drc_init", SOF_COMP_DRC,
+		sizeof(struct sof_ipc_comp_drc), config_blob, NULL},
+	{"voice", "libsof_voice.so", "sys_comp_voice_init", SOF_COMP_VOICE,
+		sizeof(struct sof_ipc_comp_voice), config_voice, NULL},
+	{"crossover", "libsof_crossover.so", "sys_comp_crossover_init",
+		SOF_COMP_CROSSOVER, sizeof(struct sof_ipc_comp_crossover),
+		config_crossover, NULL},
+};
+
+/* next value below max from the input, zero once it runs out */
+static uint32_t fuzz_u32(struct fuzz_input *in, uint32_t max)
+{
+	uint32_t val = 0;
+	int i;
+
+	for (i = 0; i < 4 && in->pos < in->size; i++)
+		val |= (uint32_t)in->data[in->pos++] << (8 * i);
+
+	return max ? val % max : val;
+}
+
+/* bytes of the input not used by the case parameters */
+static const uint8_t *fuzz_bytes(struct fuzz_input *in, uint32_t *size)
+{
+	const uint8_t *ptr = in->data + in->pos;
+
+	*size = MIN(*size, in->size - in->pos);
+	in->pos += *size;
+	return ptr;
+}
+
+static int fuzz_init(void)
+{
+	if (initialized)
+		return 0;
+
+	tb_enable_trace(false);
+	if (tb_pipeline_setup(&sof) < 0)
+		return -EINVAL;
+
+	initialized = 1;
+	return 0;
+}
+
+/* open the component library and register its driver once */
+static int fuzz_register(struct fuzz_comp *comp)
+{
+	void (*comp_init)(void);
+
+	if (comp->handle)
+		return 0;
+
+	comp->handle = dlopen(comp->library, RTLD_LAZY);
+	if (!comp->handle) {
+		fprintf(stderr, "error: %s\n", dlerror());
+		return -EINVAL;
+	}
+
+	comp_init = (void (*)(void))dlsym(comp->handle, comp->init);
+	if (!comp_init) {
+		fprintf(stderr, "error: %s\n", dlerror());
+		return -EINVAL;
+	}
+
+	comp_init();
+	return 0;
+}
+
+/* stand in for the component at the far end of a buffer */
+static struct comp_dev *fuzz_endpoint(void)
+{
+	struct comp_dev *ep = calloc(1, sizeof(*ep));
+
+	if (!ep)
+		return NULL;
+
+	list_init(&ep->bsource_list);
+	list_init(&ep->bsink_list);
+	ep->state = COMP_STATE_ACTIVE;
+	return ep;
+}
+
+/* buffer that can be freed before it is connected */
+static struct comp_buffer *fuzz_buffer(struct sof_ipc_buffer *desc)
+{
+	struct comp_buffer *buffer = buffer_new(desc);
+
+	if (buffer) {
+		list_init(&buffer->source_list);
+		list_init(&buffer->sink_list);
+	}
+
+	return buffer;
+}
+
+/* check the buffer pointers did not leave the buffer */
+static void fuzz_check_buffer(struct comp_buffer *buffer)
+{
+	if ((uint8_t *)buffer->r_ptr < (uint8_t *)buffer->addr ||
+	    (uint8_t *)buffer->r_ptr >= (uint8_t *)buffer->end_addr ||
+	    (uint8_t *)buffer->w_ptr < (uint8_t *)buffer->addr ||
+	    (uint8_t *)buffer->w_ptr >= (uint8_t *)buffer->end_addr ||
+	    comp_buffer_get_avail_bytes(buffer) > buffer->size) {
+		fprintf(stderr, "error: buffer %p pointers out of range\n",
+			buffer);
+		abort();
+	}
+}
+
+/* write n bytes of samples at the buffer write position */
+static void fuzz_fill(struct comp_buffer *buffer, const uint8_t *samples,
+		      uint32_t samples_size, uint32_t n)
+{
+	uint8_t *dest = buffer->w_ptr;
+	uint32_t i;
+
+	for (i = 0; i < n; i++) {
+		*dest = samples_size ? samples[i % samples_size] : 0;
+		dest = buffer_wrap(buffer, dest + 1);
+	}
+
+	comp_update_buffer_produce(buffer, n);
+}
+
+/* schedule a volume change, copies split the period at its position */
+static void fuzz_event(struct comp_dev *dev, struct fuzz_case *fc)
+{
+	struct {
+		struct sof_ipc_ctrl_data data;
+		struct sof_ipc_ctrl_value_chan chanv[PLATFORM_MAX_CHANNELS];
+	} msg;
+	uint32_t i;
+
+	memset(&msg, 0, sizeof(msg));
+	msg.data.rhdr.hdr.size = sizeof(msg);
+	msg.data.cmd = SOF_CTRL_CMD_VOLUME;
+	msg.data.num_elems = fc->channels;
+	for (i = 0; i < fc->channels; i++) {
+		msg.chanv[i].channel = i;
+		msg.chanv[i].value = fc->event;
+	}
+
+	comp_event_schedule(dev, fc->event - 1, COMP_CMD_SET_VALUE,
+			    &msg.data);
+}
+
+/*
+ * Run one case, the copy() time is added to ns. Returns 0 when the case
+ * ran or the component rejected it.
+ */
+static int fuzz_run(struct fuzz_case *fc, const uint8_t *samples,
+		    uint32_t samples_size, uint64_t *ns)
+{
+	struct sof_ipc_pipe_new pipe_desc;
+	struct sof_ipc_buffer buf_desc;
+	struct sof_ipc_comp_config *config;
+	struct sof_ipc_comp *ipc;
+	struct comp_buffer *source = NULL;
+	struct comp_buffer *sink = NULL;
+	struct comp_dev *source_ep = NULL;
+	struct comp_dev *sink_ep = NULL;
+	struct comp_dev *dev;
+	struct pipeline *p = NULL;
+	struct timespec tic, toc;
+	uint32_t period_bytes;
+	uint32_t frame_bytes;
+	uint32_t wrap;
+	uint32_t i;
+	int ret = 0;
+
+	if (fuzz_init() < 0 || fuzz_register(fc->comp) < 0)
+		return -EINVAL;
+
+	/* component new() with the blob after the IPC */
+	ipc = calloc(1, fc->comp->ipc_size + fc->blob_size);
+	if (!ipc)
+		return -ENOMEM;
+
+	ipc->hdr.size = fc->comp->ipc_size;
+	ipc->id = 1;
+	ipc->type = fc->comp->type;
+	ipc->pipeline_id = 1;
+	config = (struct sof_ipc_comp_config *)(ipc + 1);
+	config->hdr.size = sizeof(*config);
+	config->periods_sink = fc->periods;
+	config->periods_source = fc->periods;
+	config->frame_fmt = fc->frame_fmt;
+	fc->comp->config(ipc, fc);
+
+	dev = comp_new(ipc);
+	free(ipc);
+	if (!dev)
+		return 0;
+
+	memset(&pipe_desc, 0, sizeof(pipe_desc));
+	pipe_desc.comp_id = 2;
+	pipe_desc.pipeline_id = 1;
+	pipe_desc.sched_id = 1;
+	pipe_desc.deadline = 1000;
+	pipe_desc.frames_per_sched = fc->frames;
+	pipe_desc.timer_delay = 1;
+	p = pipeline_new(&pipe_desc, dev);
+	if (!p) {
+		ret = -ENOMEM;
+		goto out;
+	}
+	dev->pipeline = p;
+
+	/* stream params as pipeline_params() would install them */
+	dev->params.direction = SOF_IPC_STREAM_PLAYBACK;
+	dev->params.buffer_fmt = SOF_IPC_BUFFER_INTERLEAVED;
+	dev->params.frame_fmt = fc->frame_fmt;
+	dev->params.rate = fc->rate;
+	dev->params.channels = fc->channels;
+	dev->params.sample_container_bytes =
+		fc->frame_fmt == SOF_IPC_FRAME_S16_LE ? 2 : 4;
+	dev->params.sample_valid_bytes =
+		fc->frame_fmt == SOF_IPC_FRAME_S24_4LE ? 3 :
+		dev->params.sample_container_bytes;
+	dev->frames = fc->frames;
+	period_bytes = fc->frames * comp_frame_bytes(dev);
+
+	/* sink holds two rate converted periods of up to 24 times the frames,
+	 * cases needing more than the heap gives a buffer are skipped
+	 */
+	if (period_bytes * fc->periods > HEAP_BUFFER_SIZE ||
+	    period_bytes * 2 * 24 > HEAP_BUFFER_SIZE)
+		goto out;
+
+	memset(&buf_desc, 0, sizeof(buf_desc));
+	buf_desc.comp.id = 3;
+	buf_desc.comp.pipeline_id = 1;
+	buf_desc.size = period_bytes * fc->periods;
+	source = fuzz_buffer(&buf_desc);
+	buf_desc.comp.id = 4;
+	buf_desc.size = period_bytes * 2 * 24;
+	sink = fuzz_buffer(&buf_desc);
+	source_ep = fuzz_endpoint();
+	sink_ep = fuzz_endpoint();
+	if (!source || !sink || !source_ep || !sink_ep) {
+		ret = -ENOMEM;
+		goto out;
+	}
+
+	source_ep->params = dev->params;
+	sink_ep->params = dev->params;
+	sink_ep->params.rate = fc->sink_rate;
+	pipeline_comp_connect(source_ep, source);
+	pipeline_buffer_connect(source, dev);
+	pipeline_comp_connect(dev, sink);
+	pipeline_buffer_connect(sink, sink_ep);
+
+	/* params() may change the channels the rest of the walk sees */
+	if (comp_params(dev) < 0)
+		goto out;
+
+	sink_ep->params.channels = dev->params.channels;
+	if (comp_prepare(dev) < 0 ||
+	    comp_trigger(dev, COMP_TRIGGER_START) < 0)
+		goto out;
+
+	if (fc->event && fc->comp->type == SOF_COMP_VOLUME)
+		fuzz_event(dev, fc);
+
+	/* start both buffers at a whole frame wrap position, prepare may
+	 * resize them
+	 */
+	frame_bytes = comp_frame_bytes(source_ep);
+	wrap = fc->wrap % (source->size / frame_bytes) * frame_bytes;
+	comp_update_buffer_produce(source, wrap);
+	comp_update_buffer_consume(source, wrap);
+	frame_bytes = comp_frame_bytes(sink_ep);
+	wrap = fc->wrap % (sink->size / frame_bytes) * frame_bytes;
+	comp_update_buffer_produce(sink, wrap);
+	comp_update_buffer_consume(sink, wrap);
+
+	for (i = 0; i < fc->copies; i++) {
+		if (comp_buffer_get_free_bytes(source) >= period_bytes)
+			fuzz_fill(source, samples, samples_size, period_bytes);
+
+		clock_gettime(CLOCK_MONOTONIC, &tic);
+		comp_copy(dev);
+		clock_gettime(CLOCK_MONOTONIC, &toc);
+		*ns += (toc.tv_sec - tic.tv_sec) * 1000000000ULL +
+			toc.tv_nsec - tic.tv_nsec;
+
+		fuzz_check_buffer(source);
+		fuzz_check_buffer(sink);
+		comp_update_buffer_consume(sink,
+					   comp_buffer_get_avail_bytes(sink));
+	}
+
+	comp_trigger(dev, COMP_TRIGGER_STOP);
+	comp_reset(dev);
+
+out:
+	if (source)
+		buffer_free(source);
+	if (sink)
+		buffer_free(sink);
+	free(source_ep);
+	free(sink_ep);
+	if (p)
+		pipeline_free(p);
+	comp_free(dev);
+	return ret;
+}
+
+/* decode a case from the input, the rest of it is used as samples */
+static int fuzz_one(const uint8_t *data, size_t size, uint64_t *ns)
+{
+	struct fuzz_input in = { .data = data, .size = size };
+	struct fuzz_case fc;
+	const uint8_t *samples;
+	uint32_t samples_size;
+
+	fc.comp = &comps[fuzz_u32(&in, ARRAY_SIZE(comps))];
+	fc.frame_fmt = formats[fuzz_u32(&in, ARRAY_SIZE(formats))];
+	fc.channels = 1 + fuzz_u32(&in, PLATFORM_MAX_CHANNELS);
+	fc.rate = rates[fuzz_u32(&in, ARRAY_SIZE(rates))];
+	fc.sink_rate = rates[fuzz_u32(&in, ARRAY_SIZE(rates))];
+	fc.frames = 1 + fuzz_u32(&in, FUZZ_FRAMES_MAX);
+	fc.periods = 1 + fuzz_u32(&in, FUZZ_PERIODS_MAX);
+	fc.wrap = fuzz_u32(&in, 0);
+	fc.copies = 1 + fuzz_u32(&in, FUZZ_COPIES_MAX);
+	fc.event = fuzz_u32(&in, FUZZ_FRAMES_MAX * FUZZ_COPIES_MAX + 1);
+	fc.blob_size = fuzz_u32(&in, FUZZ_BLOB_MAX);
+	fc.blob = fuzz_bytes(&in, &fc.blob_size);
+
+	samples_size = size - in.pos;
+	samples = fuzz_bytes(&in, &samples_size);
+
+	return fuzz_run(&fc, samples, samples_size, ns);
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	uint64_t ns = 0;
+
+	fuzz_one(data, size, &ns);
+	return 0;
+}
+
+#ifndef COMP_FUZZER
+
+/* random cases use inputs of this many bytes */
+#define RANDOM_INPUT_SIZE	8192
+
+/* read a whole file, the caller frees the returned buffer */
+static uint8_t *read_file(const char *name, size_t *size)
+{
+	uint8_t *data;
+	FILE *fp;
+
+	fp = fopen(name, "rb");
+	if (!fp) {
+		fprintf(stderr, "error: can't open %s\n", name);
+		return NULL;
+	}
+
+	fseek(fp, 0, SEEK_END);
+	*size = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+
+	data = malloc(*size + 1);
+	if (data)
+		*size = fread(data, 1, *size, fp);
+
+	fclose(fp);
+	return data;
+}
+
+/* replay one input file, e.g. a fuzzer crash or an AFL test case */
+static int replay(const char *name)
+{
+	uint8_t *data;
+	uint64_t ns = 0;
+	size_t size;
+	int ret;
+
+	data = read_file(name, &size);
+	if (!data)
+		return -EINVAL;
+
+	ret = fuzz_one(data, size, &ns);
+	free(data);
+	return ret;
+}
+
+/* run seeded random cases, print the seed of each to reproduce crashes */
+static int random_cases(unsigned int seed, int count)
+{
+	uint8_t data[RANDOM_INPUT_SIZE];
+	unsigned int state;
+	uint64_t ns = 0;
+	int ret;
+	int i;
+	int j;
+
+	for (i = 0; i < count; i++) {
+		state = seed + i;
+		for (j = 0; j < RANDOM_INPUT_SIZE; j++)
+			data[j] = rand_r(&state);
+
+		if (debug)
+			printf("case seed %u\n", seed + i);
+
+		ret = fuzz_one(data, sizeof(data), &ns);
+		if (ret < 0) {
+			fprintf(stderr, "error: case seed %u failed %d\n",
+				seed + i, ret);
+			return ret;
+		}
+	}
+
+	printf("%d random cases passed\n", count);
+	return 0;
+}
+
+/*
+ * Time copy() for fixed stream combinations of the selected components.
+ * The optional blob, e.g. an EQ setup from tools/tune, is given to new().
+ * Silent input times the idle streams of components that skip silence.
+ */
+static int bench(const char *name, FILE *csv, const uint8_t *blob,
+		 uint32_t blob_size, int silent)
+{
+	static const uint32_t channels[] = {1, 2, 6, 8};
+	static const uint32_t sink_rates[] = {48000, 44100, 16000};
+	uint8_t samples[RANDOM_INPUT_SIZE];
+	struct fuzz_case fc;
+	unsigned int state = 1;
+	uint64_t ns;
+	double ns_frame;
+	int c, f, ch, r;
+	int ret;
+
+	for (c = 0; c < RANDOM_INPUT_SIZE; c++)
+		samples[c] = silent ? 0 : rand_r(&state);
+
+	printf("%-8s %-6s %3s %7s %7s %10s\n", "comp", "format", "ch",
+	       "rate", "sink", "ns/frame");
+	if (csv)
+		fprintf(csv, "comp,format,channels,rate,sink_rate,ns_frame\n");
+
+	for (c = 0; c < ARRAY_SIZE(comps); c++) {
+		if (name && strcmp(name, comps[c].name))
+			continue;
+
+		for (f = 0; f < ARRAY_SIZE(formats); f++)
+		for (ch = 0; ch < ARRAY_SIZE(channels); ch++)
+		for (r = 0; r < ARRAY_SIZE(sink_rates); r++) {
+			/* only the SRC and voice front end convert rates */
+			if (comps[c].type != SOF_COMP_SRC &&
+			    comps[c].type != SOF_COMP_VOICE && r)
+				break;
+
+			memset(&fc, 0, sizeof(fc));
+			fc.comp = &comps[c];
+			fc.frame_fmt = formats[f];
+			fc.channels = channels[ch];
+			fc.rate = 48000;
+			fc.sink_rate = sink_rates[r];
+			fc.frames = 48;
+			fc.periods = 4;
+			fc.copies = BENCH_COPIES;
+			fc.blob = blob;
+			fc.blob_size = blob_size;
+
+			ns = 0;
+			ret = fuzz_run(&fc, samples, sizeof(samples), &ns);
+			if (ret < 0)
+				return ret;
+
+			ns_frame = (double)ns / BENCH_COPIES / fc.frames;
+			printf("%-8s %-6s %3u %7u %7u %10.2f\n",
+			       comps[c].name, format_names[f], fc.channels,
+			       fc.rate, fc.sink_rate, ns_frame);
+			if (csv)
+				fprintf(csv, "%s,%s,%u,%u,%u,%.2f\n",
+					comps[c].name, format_names[f],
+					fc.channels, fc.rate, fc.sink_rate,
+					ns_frame);
+		}
+	}
+
+	return 0;
+}
+
+static void print_usage(char *executable)
+{
+	printf("Usage: %s [-c <comp>] [-b [-z] [-C <csv_file>] [-B <blob>]]\n",
+	       executable);
+	printf("or: %s -n <cases> [-s <seed>]\n", executable);
+	printf("or: %s -r <input_file>\n", executable);
+	printf("-b times copy() per frame, -n runs random cases, ");
+	printf("-r replays one fuzzer input\n");
+	printf("-B gives a tools/tune blob to new() of the -c component\n");
+	printf("-z times copy() with silent input\n");
+	printf("components: vol, src, eq_fir, eq_iir, drc, voice, "
+	       "crossover\n");
+}
+
+int main(int argc, char **argv)
+{
+	char *comp_name = NULL;
+	char *csv_name = NULL;
+	char *input = NULL;
+	char *blob_name = NULL;
+	struct sof_abi_hdr *hdr;
+	uint8_t *blob_file = NULL;
+	const uint8_t *blob = NULL;
+	size_t blob_size = 0;
+	unsigned int seed = 1;
+	int cases = 0;
+	int do_bench = 0;
+	int silent = 0;
+	FILE *csv = NULL;
+	int option;
+	int ret = 0;
+
+	while ((option = getopt(argc, argv, "hdbzc:C:B:n:s:r:")) != -1) {
+		switch (option) {
+		case 'b':
+			do_bench = 1;
+			break;
+		case 'z':
+			silent = 1;
+			break;
+		case 'c':
+			comp_name = optarg;
+			break;
+		case 'C':
+			csv_name = optarg;
+			break;
+		case 'B':
+			blob_name = optarg;
+			break;
+		case 'n':
+			cases = atoi(optarg);
+			break;
+		case 's':
+			seed = atoi(optarg);
+			break;
+		case 'r':
+			input = optarg;
+			break;
+		case 'd':
+			debug = 1;
+			break;
+		case 'h':
+		default:
+			print_usage(argv[0]);
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	if (!do_bench && !cases && !input) {
+		print_usage(argv[0]);
+		exit(EXIT_FAILURE);
+	}
+
+	if (blob_name) {
+		if (!comp_name) {
+			fprintf(stderr, "error: -B needs -c <comp>\n");
+			exit(EXIT_FAILURE);
+		}
+
+		blob_file = read_file(blob_name, &blob_size);
+		if (!blob_file) {
+			fprintf(stderr, "error: can't read blob %s\n",
+				blob_name);
+			exit(EXIT_FAILURE);
+		}
+
+		/* tools/tune blobs start with the ABI header */
+		blob = blob_file;
+		hdr = (struct sof_abi_hdr *)blob_file;
+		if (blob_size >= sizeof(*hdr) && hdr->magic == SOF_ABI_MAGIC) {
+			blob += sizeof(*hdr);
+			blob_size -= sizeof(*hdr);
+		}
+	}
+
+	if (input)
+		ret = replay(input);
+
+	if (!ret && cases)
+		ret = random_cases(seed, cases);
+
+	if (!ret && do_bench) {
+		csv = csv_name ? fopen(csv_name, "w") : NULL;
+		if (csv_name && !csv)
+			fprintf(stderr, "error: can't open %s\n", csv_name);
+		ret = bench(comp_name, csv, blob, blob_size, silent);
+		if (csv)
+			fclose(csv);
+	}
+
+	free(blob_file);
+	return ret < 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+#endif
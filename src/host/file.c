@@ -36,6 +36,9 @@
 #include <stddef.h>
 #include <errno.h>
 #include <inttypes.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <sof/sof.h>
 #include <sof/lock.h>
 #include <sof/list.h>
@@ -45,22 +48,100 @@
 #include <sof/audio/component.h>
 #include <sof/audio/format.h>
 #include <sof/audio/pipeline.h>
+#include <sof/math/numbers.h>
 #include <uapi/ipc/stream.h>
 #include "host/common_test.h"
 #include "host/file.h"
 
-static inline void buffer_check_wrap_32(int32_t **ptr, int32_t *end,
-					size_t size)
+/* samples converted per fwrite() for 24-bit binary output */
+#define FILE_S24_BLOCK	256
+
+/*
+ * Copy samples from the mapped binary input file straight into the sink
+ * buffer, one memcpy() per contiguous part of the buffer.
+ */
+static int read_samples_map(struct comp_dev *dev, struct comp_buffer *sink,
+			    int n, int fmt, int nch)
 {
-	if (*ptr >= end)
-		*ptr = (int32_t *)((size_t)*ptr - size);
+	struct file_comp_data *cd = comp_get_drvdata(dev);
+	int bytes = fmt == SOF_IPC_FRAME_S16_LE ?
+		sizeof(int16_t) : sizeof(int32_t);
+	uint8_t *dest = sink->w_ptr;
+	int avail = (cd->fs.map_end - cd->fs.map_pos) / (bytes * nch) * nch;
+	int32_t *sample;
+	int n_samples;
+	int n_copy;
+	int i;
+
+	/* quit after the last complete frame */
+	if (avail < n) {
+		n = avail;
+		cd->fs.reached_eof = 1;
+	}
+	n_samples = n;
+
+	while (n > 0) {
+		n_copy = buffer_wrap_samples(sink, dest, bytes, n);
+		memcpy(dest, cd->fs.map + cd->fs.map_pos, n_copy * bytes);
+
+		/* mask bits if 24-bit samples */
+		if (fmt == SOF_IPC_FRAME_S24_4LE) {
+			sample = (int32_t *)dest;
+			for (i = 0; i < n_copy; i++)
+				sample[i] &= 0x00ffffff;
+		}
+
+		cd->fs.map_pos += n_copy * bytes;
+		n -= n_copy;
+		dest = buffer_wrap(sink, dest + n_copy * bytes);
+	}
+
+	return n_samples;
 }
 
-static inline void buffer_check_wrap_16(int16_t **ptr, int16_t *end,
-					size_t size)
+/*
+ * Write samples from the source buffer to a binary output file, one
+ * fwrite() per contiguous part of the buffer. The stream is fully buffered
+ * so this does not reach the kernel for every period.
+ */
+static int write_samples_block(struct comp_dev *dev,
+			       struct comp_buffer *source, int n, int fmt)
 {
-	if (*ptr >= end)
-		*ptr = (int16_t *)((size_t)*ptr - size);
+	struct file_comp_data *cd = comp_get_drvdata(dev);
+	int bytes = fmt == SOF_IPC_FRAME_S16_LE ?
+		sizeof(int16_t) : sizeof(int32_t);
+	uint8_t *src = source->r_ptr;
+	int32_t block[FILE_S24_BLOCK];
+	int32_t *sample;
+	int n_samples = 0;
+	int n_copy;
+	int ret;
+	int i;
+
+	while (n > 0) {
+		n_copy = buffer_wrap_samples(source, src, bytes, n);
+
+		if (fmt == SOF_IPC_FRAME_S24_4LE) {
+			/* sign extend 24-bit samples */
+			n_copy = MIN(n_copy, FILE_S24_BLOCK);
+			sample = (int32_t *)src;
+			for (i = 0; i < n_copy; i++)
+				block[i] = (sample[i] << 8) >> 8;
+			ret = fwrite(block, bytes, n_copy, cd->fs.wfh);
+		} else {
+			ret = fwrite(src, bytes, n_copy, cd->fs.wfh);
+		}
+
+		n_samples += ret;
+		if (ret != n_copy)
+			break;
+
+		n -= n_copy;
+		src = buffer_wrap(source, src + n_copy * bytes);
+	}
+
+	cd->fs.data_bytes += n_samples * bytes;
+	return n_samples;
 }
 
 /*
@@ -74,13 +155,14 @@ static int read_samples_32(struct comp_dev *dev, struct comp_buffer *sink,
 	int32_t *dest = (int32_t *)sink->w_ptr;
 	int32_t sample;
 	int n_samples = 0;
-	int i, n_wrap, n_min, ret;
+	int i, n_min, ret;
 
-	while (n > 0) {
-		n_wrap = (int32_t *)sink->end_addr - dest;
+	if (cd->fs.map)
+		return read_samples_map(dev, sink, n, fmt, nch);
 
-		/* check for buffer wrap and copy to the end of the buffer */
-		n_min = (n < n_wrap) ? n : n_wrap;
+	while (n > 0) {
+		/* copy up to the end of the buffer */
+		n_min = buffer_wrap_samples(sink, dest, sizeof(int32_t), n);
 		while (n_min > 0) {
 			n -= nch;
 			n_min -= nch;
@@ -134,8 +216,7 @@ static int read_samples_32(struct comp_dev *dev, struct comp_buffer *sink,
 			}
 		}
 		/* check for buffer wrap and update pointer */
-		buffer_check_wrap_32(&dest, sink->end_addr,
-				     sink->size);
+		dest = buffer_wrap(sink, dest);
 	}
 quit:
 	return n_samples;
@@ -150,15 +231,17 @@ static int read_samples_16(struct comp_dev *dev, struct comp_buffer *sink,
 {
 	struct file_comp_data *cd = comp_get_drvdata(dev);
 	int16_t *dest = (int16_t *)sink->w_ptr;
-	int i, n_wrap, n_min, ret;
+	int i, n_min, ret;
 	int n_samples = 0;
 
+	if (cd->fs.map)
+		return read_samples_map(dev, sink, n, SOF_IPC_FRAME_S16_LE,
+					nch);
+
 	/* copy samples */
 	while (n > 0) {
-		n_wrap = (int16_t *)sink->end_addr - dest;
-
-		/* check for buffer wrap and copy to the end of the buffer */
-		n_min = (n < n_wrap) ? n : n_wrap;
+		/* copy up to the end of the buffer */
+		n_min = buffer_wrap_samples(sink, dest, sizeof(int16_t), n);
 		while (n_min > 0) {
 			n -= nch;
 			n_min -= nch;
@@ -191,8 +274,7 @@ static int read_samples_16(struct comp_dev *dev, struct comp_buffer *sink,
 			}
 		}
 		/* check for buffer wrap and update pointer */
-		buffer_check_wrap_16(&dest, sink->end_addr,
-				     sink->size);
+		dest = buffer_wrap(sink, dest);
 	}
 
 quit:
@@ -208,15 +290,17 @@ static int write_samples_16(struct comp_dev *dev, struct comp_buffer *source,
 {
 	struct file_comp_data *cd = comp_get_drvdata(dev);
 	int16_t *src = (int16_t *)source->r_ptr;
-	int i, n_wrap, n_min, ret;
+	int i, n_min, ret;
 	int n_samples = 0;
 
+	if (cd->fs.f_format != FILE_TEXT)
+		return write_samples_block(dev, source, n,
+					   SOF_IPC_FRAME_S16_LE);
+
 	/* copy samples */
 	while (n > 0) {
-		n_wrap = (int16_t *)source->end_addr - src;
-
-		/* check for buffer wrap and copy to the end of the buffer */
-		n_min = (n < n_wrap) ? n : n_wrap;
+		/* copy up to the end of the buffer */
+		n_min = buffer_wrap_samples(source, src, sizeof(int16_t), n);
 		while (n_min > 0) {
 			n -= nch;
 			n_min -= nch;
@@ -247,8 +331,7 @@ static int write_samples_16(struct comp_dev *dev, struct comp_buffer *source,
 			}
 		}
 		/* check for buffer wrap and update pointer */
-		buffer_check_wrap_16(&src, source->end_addr,
-				     source->size);
+		src = buffer_wrap(source, src);
 	}
 quit:
 	return n_samples;
@@ -263,16 +346,17 @@ static int write_samples_32(struct comp_dev *dev, struct comp_buffer *source,
 {
 	struct file_comp_data *cd = comp_get_drvdata(dev);
 	int32_t *src = (int32_t *)source->r_ptr;
-	int i, n_wrap, n_min, ret;
+	int i, n_min, ret;
 	int n_samples = 0;
 	int32_t sample;
 
+	if (cd->fs.f_format != FILE_TEXT)
+		return write_samples_block(dev, source, n, fmt);
+
 	/* copy samples */
 	while (n > 0) {
-		n_wrap = (int32_t *)source->end_addr - src;
-
-		/* check for buffer wrap and copy to the end of the buffer */
-		n_min = (n < n_wrap) ? n : n_wrap;
+		/* copy up to the end of the buffer */
+		n_min = buffer_wrap_samples(source, src, sizeof(int32_t), n);
 		while (n_min > 0) {
 			n -= nch;
 			n_min -= nch;
@@ -321,8 +405,7 @@ static int write_samples_32(struct comp_dev *dev, struct comp_buffer *source,
 			}
 		}
 		/* check for buffer wrap and update pointer */
-		buffer_check_wrap_32(&src, source->end_addr,
-				     source->size);
+		src = buffer_wrap(source, src);
 	}
 quit:
 	return n_samples;
@@ -414,12 +497,115 @@ static enum file_format get_file_format(char *filename)
 {
 	char *ext = strrchr(filename, '.');
 
+	if (!ext)
+		return FILE_RAW;
+
 	if (!strcmp(ext, ".txt"))
 		return FILE_TEXT;
 
+	if (!strcmp(ext, ".wav"))
+		return FILE_WAV;
+
 	return FILE_RAW;
 }
 
+static inline uint32_t wav_get_le32(const uint8_t *p)
+{
+	return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static inline void wav_put_le32(uint8_t *p, uint32_t v)
+{
+	p[0] = v;
+	p[1] = v >> 8;
+	p[2] = v >> 16;
+	p[3] = v >> 24;
+}
+
+static inline void wav_put_le16(uint8_t *p, uint16_t v)
+{
+	p[0] = v;
+	p[1] = v >> 8;
+}
+
+/* limit the mapped PCM data to the WAV data chunk */
+static int wav_find_data(struct file_state *fs)
+{
+	size_t pos = 12;
+	uint32_t len;
+
+	if (fs->map_size < 12 || memcmp(fs->map, "RIFF", 4) ||
+	    memcmp(fs->map + 8, "WAVE", 4))
+		return -EINVAL;
+
+	while (pos + 8 <= fs->map_size) {
+		len = wav_get_le32(fs->map + pos + 4);
+		if (!memcmp(fs->map + pos, "data", 4)) {
+			fs->map_pos = pos + 8;
+			fs->map_end = MIN(fs->map_pos + len, fs->map_size);
+			return 0;
+		}
+		pos += 8 + len + (len & 1);
+	}
+
+	return -EINVAL;
+}
+
+/* write PCM WAV header for data_bytes of data at the start of the file */
+static int wav_write_header(struct comp_dev *dev)
+{
+	struct file_comp_data *cd = comp_get_drvdata(dev);
+	uint32_t bytes = dev->params.sample_container_bytes;
+	uint32_t nch = dev->params.channels;
+	uint8_t hdr[44];
+
+	memcpy(hdr, "RIFF", 4);
+	wav_put_le32(hdr + 4, 36 + cd->fs.data_bytes);
+	memcpy(hdr + 8, "WAVEfmt ", 8);
+	wav_put_le32(hdr + 16, 16);
+	wav_put_le16(hdr + 20, 1); /* PCM */
+	wav_put_le16(hdr + 22, nch);
+	wav_put_le32(hdr + 24, dev->params.rate);
+	wav_put_le32(hdr + 28, dev->params.rate * nch * bytes);
+	wav_put_le16(hdr + 32, nch * bytes);
+	wav_put_le16(hdr + 34, bytes * 8);
+	memcpy(hdr + 36, "data", 4);
+	wav_put_le32(hdr + 40, cd->fs.data_bytes);
+
+	if (fseek(cd->fs.wfh, 0, SEEK_SET) ||
+	    fwrite(hdr, sizeof(hdr), 1, cd->fs.wfh) != 1)
+		return -EIO;
+
+	return fseek(cd->fs.wfh, 0, SEEK_END) ? -EIO : 0;
+}
+
+/* map binary input file so that periods can be block copied */
+static int file_map(struct file_state *fs)
+{
+	struct stat st;
+	void *map;
+
+	if (fstat(fileno(fs->rfh), &st) < 0 || st.st_size == 0)
+		return -EINVAL;
+
+	map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE,
+		   fileno(fs->rfh), 0);
+	if (map == MAP_FAILED)
+		return -errno;
+
+	madvise(map, st.st_size, MADV_SEQUENTIAL);
+
+	fs->map = map;
+	fs->map_size = st.st_size;
+	fs->map_pos = 0;
+	fs->map_end = st.st_size;
+
+	if (fs->f_format == FILE_WAV)
+		return wav_find_data(fs);
+
+	return 0;
+}
+
 static struct comp_dev *file_new(struct sof_ipc_comp *comp)
 {
 	struct comp_dev *dev;
@@ -468,6 +654,14 @@ static struct comp_dev *file_new(struct sof_ipc_comp *comp)
 			free(dev);
 			return NULL;
 		}
+
+		/* raw files fall back to fread() if they can't be mapped */
+		if (cd->fs.f_format != FILE_TEXT && file_map(&cd->fs) < 0 &&
+		    cd->fs.f_format == FILE_WAV) {
+			fprintf(stderr, "error: invalid wav file %s\n",
+				cd->fs.fn);
+			goto err;
+		}
 		break;
 	case FILE_WRITE:
 		cd->fs.wfh = fopen(cd->fs.fn, "w");
@@ -477,6 +671,14 @@ static struct comp_dev *file_new(struct sof_ipc_comp *comp)
 			free(dev);
 			return NULL;
 		}
+
+		/* buffer binary output in large blocks */
+		if (cd->fs.f_format != FILE_TEXT) {
+			cd->fs.wbuf = malloc(FILE_WRITE_BUF_SIZE);
+			if (cd->fs.wbuf)
+				setvbuf(cd->fs.wfh, cd->fs.wbuf, _IOFBF,
+					FILE_WRITE_BUF_SIZE);
+		}
 		break;
 	default:
 		/* TODO: duplex mode */
@@ -485,20 +687,37 @@ static struct comp_dev *file_new(struct sof_ipc_comp *comp)
 
 	cd->fs.reached_eof = 0;
 	cd->fs.n = 0;
+	cd->fs.marker = -1;
 
 	dev->state = COMP_STATE_READY;
 
 	return dev;
+
+err:
+	if (cd->fs.map)
+		munmap(cd->fs.map, cd->fs.map_size);
+	fclose(cd->fs.rfh);
+	free(cd->fs.fn);
+	free(cd);
+	free(dev);
+	return NULL;
 }
 
 static void file_free(struct comp_dev *dev)
 {
 	struct file_comp_data *cd = comp_get_drvdata(dev);
 
-	if (cd->fs.mode == FILE_READ)
+	if (cd->fs.mode == FILE_READ) {
+		if (cd->fs.map)
+			munmap(cd->fs.map, cd->fs.map_size);
 		fclose(cd->fs.rfh);
-	else
+	} else {
+		/* update WAV header with the final data size */
+		if (cd->fs.f_format == FILE_WAV && wav_write_header(dev) < 0)
+			fprintf(stderr, "error: writing wav header\n");
 		fclose(cd->fs.wfh);
+		free(cd->fs.wbuf);
+	}
 
 	free(cd->fs.fn);
 	free(cd);
@@ -566,6 +785,36 @@ static int file_cmd(struct comp_dev *dev, int cmd, void *data,
 	return ret;
 }
 
+/*
+ * Record the index of the first non-zero sample of the n samples just
+ * passed at ptr. Comparing the input and output markers of an impulse
+ * gives the latency of the pipeline.
+ */
+static void file_find_marker(struct comp_dev *dev, struct comp_buffer *buffer,
+			     uint8_t *ptr, int n)
+{
+	struct file_comp_data *cd = comp_get_drvdata(dev);
+	int bytes = dev->params.sample_container_bytes;
+	int32_t sample;
+	int i;
+
+	for (i = 0; i < n; i++) {
+		if (bytes == sizeof(int16_t))
+			sample = *(int16_t *)ptr;
+		else if (dev->params.frame_fmt == SOF_IPC_FRAME_S24_4LE)
+			sample = *(int32_t *)ptr << 8;
+		else
+			sample = *(int32_t *)ptr;
+
+		if (sample) {
+			cd->fs.marker = cd->fs.n - n + i;
+			return;
+		}
+
+		ptr = buffer_wrap(buffer, ptr + bytes);
+	}
+}
+
 /*
  * copy and process stream samples
  * returns the number of bytes copied
@@ -583,10 +832,15 @@ static int file_copy(struct comp_dev *dev)
 					 source_list);
 
 		/* test sink has enough free frames */
-		if (buffer->free >= cd->period_bytes && !cd->fs.reached_eof) {
+		if (comp_buffer_get_free_bytes(buffer) >= cd->period_bytes &&
+		    !cd->fs.reached_eof) {
 			/* read PCM samples from file */
 			ret = cd->file_func(dev, buffer, NULL, dev->frames);
 
+			if (ret > 0 && cd->fs.marker < 0)
+				file_find_marker(dev, buffer, buffer->w_ptr,
+						 ret);
+
 			/* update sink buffer pointers */
 			bytes = dev->params.sample_container_bytes;
 			if (ret > 0)
@@ -600,10 +854,14 @@ static int file_copy(struct comp_dev *dev)
 					 struct comp_buffer, sink_list);
 
 		/* test source has enough free frames */
-		if (buffer->avail >= cd->period_bytes) {
+		if (comp_buffer_get_avail_bytes(buffer) >= cd->period_bytes) {
 			/* write PCM samples into file */
 			ret = cd->file_func(dev, NULL, buffer, dev->frames);
 
+			if (ret > 0 && cd->fs.marker < 0)
+				file_find_marker(dev, buffer, buffer->r_ptr,
+						 ret);
+
 			/* update source buffer pointers */
 			bytes = dev->params.sample_container_bytes;
 			if (ret > 0)
@@ -687,6 +945,16 @@ static int file_prepare(struct comp_dev *dev)
 		return -EINVAL;
 	}
 
+	/* reserve room for the WAV header before the first period */
+	if (cd->fs.mode == FILE_WRITE && cd->fs.f_format == FILE_WAV &&
+	    !cd->fs.data_bytes) {
+		ret = wav_write_header(dev);
+		if (ret < 0) {
+			fprintf(stderr, "error: writing wav header\n");
+			return ret;
+		}
+	}
+
 	dev->state = COMP_STATE_PREPARE;
 
 	return ret;
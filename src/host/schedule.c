@@ -35,6 +35,9 @@
 #include <sof/task.h>
 #include <stdint.h>
 #include <sof/wait.h>
+#include <sof/probe.h>
+#include <sof/cpu.h>
+#include "host/common_test.h"
 
 /* scheduler testbench definition */
 
@@ -44,20 +47,40 @@ struct schedule_data {
 	uint32_t clock;
 };
 
-static struct schedule_data *sch;
+/* one scheduler per emulated core */
+static struct schedule_data *sch[PLATFORM_CORE_COUNT];
+
+struct schedule_data **arch_schedule_get(void)
+{
+	return &sch[cpu_get_id()];
+}
 
 void schedule_task_complete(struct task *task)
 {
+	struct schedule_data *sd = sch[task->core];
+
+	spin_lock(&sd->lock);
 	list_item_del(&task->list);
 	task->state = TASK_STATE_COMPLETED;
+	spin_unlock(&sd->lock);
 }
 
-/* schedule task */
+/*
+ * Schedule task, it runs at once on the calling thread or is queued to the
+ * thread of the emulated core it belongs to.
+ */
 void schedule_task(struct task *task, uint64_t start, uint64_t deadline)
 {
+	struct schedule_data *sd = sch[task->core];
+
+	spin_lock(&sd->lock);
 	task->deadline = deadline;
-	list_item_prepend(&task->list, &sch->list);
+	list_item_prepend(&task->list, &sd->list);
 	task->state = TASK_STATE_QUEUED;
+	spin_unlock(&sd->lock);
+
+	if (task->core != cpu_get_id() && !tb_smp_queue_task(task))
+		return;
 
 	if (task->func)
 		task->func(task->data);
@@ -68,10 +91,18 @@ void schedule_task(struct task *task, uint64_t start, uint64_t deadline)
 /* initialize scheduler */
 int scheduler_init(struct sof *sof)
 {
+	int i;
+
 	trace_pipe("scheduler_init()");
-	sch = malloc(sizeof(*sch));
-	list_init(&sch->list);
-	spinlock_init(&sch->lock);
+
+	for (i = 0; i < PLATFORM_CORE_COUNT; i++) {
+		sch[i] = malloc(sizeof(*sch[i]));
+		if (!sch[i])
+			return -ENOMEM;
+
+		list_init(&sch[i]->list);
+		spinlock_init(&sch[i]->lock);
+	}
 
 	return 0;
 }
@@ -91,6 +122,15 @@ int schedule_task_cancel(struct task *task)
 	return 0;
 }
 
+/* testbench has no platform timer, group triggers start at once */
+
+struct timer *platform_timer;
+
+uint64_t platform_timer_get(struct timer *timer)
+{
+	return 0;
+}
+
 /* testbench work definition */
 
 void work_schedule_default(struct work *w, uint64_t timeout)
@@ -100,3 +140,9 @@ void work_schedule_default(struct work *w, uint64_t timeout)
 void work_cancel_default(struct work *work)
 {
 }
+
+/* testbench has no probe extraction stream */
+
+void probe_produce(struct comp_buffer *buffer, void *ptr, uint32_t bytes)
+{
+}
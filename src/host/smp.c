@@ -0,0 +1,345 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Tomasz Lauda <tomasz.lauda@linux.intel.com>
+ */
+
+/*
+ * Host SMP emulation. Every enabled slave core is a thread taking pipeline
+ * tasks and IDC messages from its own queue, the testbench main thread is
+ * the master core. Messages to the master are not supported, the testbench
+ * drives it directly.
+ */
+
+#include <sof/cpu.h>
+#include <sof/idc.h>
+#include <platform/idc.h>
+#include <sof/ipc.h>
+#include <sof/schedule.h>
+#include <sof/audio/component.h>
+#include <sof/audio/pipeline.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <time.h>
+#include "host/common_test.h"
+
+#define TB_SMP_QUEUE_SIZE	16
+
+extern struct ipc *_ipc;
+
+/* IDC message or pipeline task queued to a core */
+struct tb_smp_job {
+	struct idc_msg msg;
+	struct task *task;	/* task to run, or NULL for msg */
+	int *ret;		/* result for a blocking sender or NULL */
+};
+
+struct tb_smp_core {
+	pthread_t thread;
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	struct tb_smp_job job[TB_SMP_QUEUE_SIZE];
+	uint64_t queued;	/* jobs queued so far */
+	uint64_t done;		/* jobs completed so far */
+	int running;		/* thread is taking jobs */
+	int enabled;
+	int exit;
+
+	/* statistics */
+	uint64_t tasks;
+	uint64_t msgs;
+	uint64_t busy_ns;
+};
+
+__thread int host_core_id;
+
+volatile uint64_t host_lock_contended;
+
+static struct tb_smp_core cores[PLATFORM_CORE_COUNT];
+
+static uint64_t tb_smp_time_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* same as idc_pipeline_trigger() of the DSP, stream is in comp_data */
+static int tb_smp_pipeline_trigger(uint32_t cmd)
+{
+	struct sof_ipc_stream *data = _ipc->comp_data;
+	struct ipc_comp_dev *pcm_dev;
+
+	pcm_dev = ipc_get_comp(_ipc, data->comp_id);
+	if (!pcm_dev)
+		return -ENODEV;
+
+	if (host_core_id != pcm_dev->cd->pipeline->ipc_pipe.core)
+		return -EINVAL;
+
+	return pipeline_trigger(pcm_dev->cd->pipeline, pcm_dev->cd, cmd);
+}
+
+/* same as idc_component_command() of the DSP, control is in comp_data */
+static int tb_smp_component_command(uint32_t cmd)
+{
+	struct sof_ipc_ctrl_data *data = _ipc->comp_data;
+	struct ipc_comp_dev *comp_dev;
+
+	comp_dev = ipc_get_comp(_ipc, data->comp_id);
+	if (!comp_dev)
+		return -ENODEV;
+
+	if (host_core_id != comp_dev->cd->pipeline->ipc_pipe.core)
+		return -EINVAL;
+
+	return comp_cmd(comp_dev->cd, cmd, data, data->rhdr.hdr.size);
+}
+
+static int tb_smp_idc_cmd(struct idc_msg *msg)
+{
+	switch (iTS(msg->header)) {
+	case iTS(IDC_MSG_PPL_TRIGGER):
+		return tb_smp_pipeline_trigger(msg->extension);
+	case iTS(IDC_MSG_COMP_CMD):
+		return tb_smp_component_command(msg->extension);
+	case iTS(IDC_MSG_PPL_BRANCH):
+		return pipeline_branch_run(
+			&_ipc->shared_ctx->branch[host_core_id]);
+	default:
+		fprintf(stderr, "error: core %d can't emulate IDC 0x%x\n",
+			host_core_id, msg->header);
+		return -EINVAL;
+	}
+}
+
+static void *tb_smp_core_thread(void *data)
+{
+	struct tb_smp_core *core = data;
+	struct tb_smp_job *job;
+	uint64_t start;
+	int ret;
+
+	host_core_id = core - cores;
+
+	pthread_mutex_lock(&core->mutex);
+
+	while (!core->exit || core->done != core->queued) {
+		if (core->done == core->queued) {
+			pthread_cond_wait(&core->cond, &core->mutex);
+			continue;
+		}
+
+		job = &core->job[core->done % TB_SMP_QUEUE_SIZE];
+		pthread_mutex_unlock(&core->mutex);
+
+		start = tb_smp_time_ns();
+		if (job->task) {
+			if (job->task->func)
+				job->task->func(job->task->data);
+			schedule_task_complete(job->task);
+			core->tasks++;
+			ret = 0;
+		} else {
+			ret = tb_smp_idc_cmd(&job->msg);
+			core->msgs++;
+		}
+		core->busy_ns += tb_smp_time_ns() - start;
+
+		pthread_mutex_lock(&core->mutex);
+		if (job->ret)
+			*job->ret = ret;
+		core->done++;
+		pthread_cond_broadcast(&core->cond);
+	}
+
+	pthread_mutex_unlock(&core->mutex);
+
+	return NULL;
+}
+
+/* queue job to core, waits for its result if ret is given */
+static int tb_smp_queue(int id, struct idc_msg *msg, struct task *task,
+			int *ret)
+{
+	struct tb_smp_core *core = &cores[id];
+	struct tb_smp_job *job;
+	uint64_t ticket;
+
+	if (id == host_core_id || !core->enabled)
+		return -ENODEV;
+
+	pthread_mutex_lock(&core->mutex);
+
+	while (core->queued - core->done == TB_SMP_QUEUE_SIZE)
+		pthread_cond_wait(&core->cond, &core->mutex);
+
+	job = &core->job[core->queued % TB_SMP_QUEUE_SIZE];
+	if (msg)
+		job->msg = *msg;
+	job->task = task;
+	job->ret = ret;
+	ticket = ++core->queued;
+	pthread_cond_broadcast(&core->cond);
+
+	while (ret && core->done < ticket)
+		pthread_cond_wait(&core->cond, &core->mutex);
+
+	pthread_mutex_unlock(&core->mutex);
+
+	return ret ? *ret : 0;
+}
+
+int idc_send_msg(struct idc_msg *msg, uint32_t mode)
+{
+	int ret = 0;
+
+	if (msg->core >= PLATFORM_CORE_COUNT)
+		return -EINVAL;
+
+	return tb_smp_queue(msg->core, msg, NULL,
+			    mode == IDC_BLOCKING ? &ret : NULL);
+}
+
+int tb_smp_queue_task(struct task *task)
+{
+	if (task->core >= PLATFORM_CORE_COUNT)
+		return -EINVAL;
+
+	return tb_smp_queue(task->core, NULL, task, NULL);
+}
+
+/* wait until no core has queued or running jobs */
+void tb_smp_sync(void)
+{
+	struct tb_smp_core *core;
+	int busy;
+	int i;
+
+	/* jobs may queue more jobs to other cores, repeat until all idle */
+	do {
+		busy = 0;
+		for (i = 0; i < PLATFORM_CORE_COUNT; i++) {
+			core = &cores[i];
+			if (!core->running)
+				continue;
+
+			pthread_mutex_lock(&core->mutex);
+			while (core->done != core->queued) {
+				busy = 1;
+				pthread_cond_wait(&core->cond, &core->mutex);
+			}
+			pthread_mutex_unlock(&core->mutex);
+		}
+	} while (busy);
+}
+
+void tb_smp_report(double exec_sec)
+{
+	struct tb_smp_core *core;
+	int i;
+
+	for (i = 0; i < PLATFORM_CORE_COUNT; i++) {
+		core = &cores[i];
+		if (!core->running)
+			continue;
+
+		printf("core %d: %" PRIu64 " tasks, %" PRIu64 " IDC messages, "
+		       "%.2f%% busy\n", i, core->tasks, core->msgs,
+		       exec_sec > 0 ? core->busy_ns / (exec_sec * 1e7) : 0.0);
+	}
+
+	printf("contended lock acquisitions: %" PRIu64 "\n",
+	       host_lock_contended);
+}
+
+static int tb_smp_start(int id)
+{
+	struct tb_smp_core *core = &cores[id];
+
+	if (id == PLATFORM_MASTER_CORE_ID || core->running)
+		return 0;
+
+	pthread_mutex_init(&core->mutex, NULL);
+	pthread_cond_init(&core->cond, NULL);
+	core->queued = 0;
+	core->done = 0;
+	core->exit = 0;
+
+	if (pthread_create(&core->thread, NULL, tb_smp_core_thread, core)) {
+		fprintf(stderr, "error: can't start core %d thread\n", id);
+		return -ENOMEM;
+	}
+
+	core->running = 1;
+	return 0;
+}
+
+void arch_cpu_enable_core(int id)
+{
+	if (!tb_smp_start(id))
+		cores[id].enabled = 1;
+}
+
+/* a standby core keeps its thread but takes no new work */
+void arch_cpu_standby_core(int id)
+{
+	if (!tb_smp_start(id))
+		cores[id].enabled = 0;
+}
+
+void arch_cpu_disable_core(int id)
+{
+	struct tb_smp_core *core = &cores[id];
+
+	if (id == PLATFORM_MASTER_CORE_ID || !core->running)
+		return;
+
+	pthread_mutex_lock(&core->mutex);
+	core->exit = 1;
+	pthread_cond_broadcast(&core->cond);
+	pthread_mutex_unlock(&core->mutex);
+
+	pthread_join(core->thread, NULL);
+	pthread_cond_destroy(&core->cond);
+	pthread_mutex_destroy(&core->mutex);
+
+	core->running = 0;
+	core->enabled = 0;
+}
+
+int arch_cpu_is_core_enabled(int id)
+{
+	return id == PLATFORM_MASTER_CORE_ID || cores[id].enabled;
+}
+
+int arch_cpu_is_core_standby(int id)
+{
+	return cores[id].running && !cores[id].enabled;
+}
@@ -31,8 +31,15 @@
 
 #include <sof/ipc.h>
 #include <sof/list.h>
+#include <sof/cpu.h>
 #include <getopt.h>
+#include <inttypes.h>
 #include <dlfcn.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <sys/wait.h>
 #include "host/common_test.h"
 #include "host/topology.h"
 #include "host/trace.h"
@@ -40,19 +47,44 @@
 
 #define TESTBENCH_NCH 2 /* Stereo */
 
+/* job list limits */
+#define JOB_LINE_LEN	1024
+#define JOB_MAX_ARGS	32
+
 /* shared library look up table */
 struct shared_lib_table lib_table[NUM_WIDGETS_SUPPORTED] = {
 {"file", "", SND_SOC_TPLG_DAPM_AIF_IN, "", 0, NULL},
 {"vol", "libsof_volume.so", SND_SOC_TPLG_DAPM_PGA, "sys_comp_volume_init", 0,
 	NULL},
 {"src", "libsof_src.so", SND_SOC_TPLG_DAPM_SRC, "sys_comp_src_init", 0, NULL},
+{"mixer", "libsof_mixer.so", SND_SOC_TPLG_DAPM_MIXER, "sys_comp_mixer_init", 0,
+	NULL},
 };
 
 /* main firmware context */
 static struct sof sof;
-static int fr_id; /* comp id for fileread */
-static int fw_id; /* comp id for filewrite */
-static int sched_id; /* comp id for scheduling comp */
+static struct tb_graph graph; /* file endpoints and pipelines */
+static struct file_comp_data *frcd[TB_MAX_FILES]; /* fileread data */
+static struct file_comp_data *fwcd[TB_MAX_FILES]; /* filewrite data */
+static struct pipeline *pipes[TB_MAX_PIPELINES]; /* pipelines in copy order */
+static struct comp_dev *sched_comps[TB_MAX_PIPELINES]; /* and their hosts */
+static int num_src_pipes; /* pipelines scheduled by a fileread */
+static char *job_list; /* file with one set of testbench arguments per line */
+static int job_workers; /* number of jobs run in parallel */
+static int bench; /* time component copy() and print a report */
+static char *bench_csv; /* benchmark CSV output file or NULL */
+static int paced; /* run one period per pipeline period of wall time */
+static int num_cores = 1; /* emulated DSP cores, one thread each */
+
+/* realtime paced run state and per period wake up jitter */
+struct tb_pace {
+	uint64_t period_ns;
+	uint64_t periods;
+	uint64_t jitter_sum_ns;
+	uint64_t jitter_max_ns;
+	uint64_t overruns;	/* copies that ran past the next period */
+	int rt;			/* running with SCHED_FIFO */
+};
 
 /*
  * Parse shared library from user input
@@ -114,7 +146,19 @@ static void print_usage(char *executable)
 	printf("Usage: %s -i <input_file> -o <output_file> ", executable);
 	printf("-t <tplg_file> -b <input_format> ");
 	printf("-a <comp1=comp1_library,comp2=comp2_library>\n");
+	printf("-P <csv_file|-> prints per component cost, CSV to the file\n");
+	printf("-T runs one period per pipeline period on a realtime ");
+	printf("thread and reports wake up jitter\n");
+	printf("-C <cores> emulates <cores> DSP cores with a thread each, ");
+	printf("pipelines run on the core set in the topology\n");
+	printf("-i and -o take comma separated lists for topologies with ");
+	printf("several file endpoints, assigned in topology order\n");
+	printf("or: %s -l <job_list> [-j <workers>]\n", executable);
+	printf("job_list has the arguments of one run per line, the runs ");
+	printf("are executed by <workers> processes, default one per CPU\n");
 	printf("input_format should be S16_LE, S32_LE, S24_LE or FLOAT_LE\n");
+	printf("default libraries use the best SIMD build the host CPU ");
+	printf("supports, -a overrides it\n");
 	printf("Example Usage:\n");
 	printf("%s -i in.txt -o out.txt -t test.tplg ", executable);
 	printf("-r 48000 -R 96000 ");
@@ -151,6 +195,60 @@ static void free_comps(void)
 	}
 }
 
+/*
+ * Return the library name suffix of the best host SIMD build the CPU can
+ * run or NULL when there is none. The suffixes match the per ISA builds of
+ * the component libraries in src/audio/Makefile.am.
+ */
+static const char *host_simd_suffix(int index)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_cpu_init();
+
+	switch (index) {
+	case 0:
+		return __builtin_cpu_supports("avx2") ? "_avx2" : NULL;
+	case 1:
+		return __builtin_cpu_supports("fma") ? "_fma" : NULL;
+	case 2:
+		return __builtin_cpu_supports("avx") ? "_avx" : NULL;
+	case 3:
+		return __builtin_cpu_supports("sse4.2") ? "_sse42" : NULL;
+	}
+#endif
+	return NULL;
+}
+
+#define HOST_SIMD_VARIANTS	4
+
+/* open the fastest variant of a component library present on the host */
+static void *open_simd_library(const char *name)
+{
+	char message[DEBUG_MSG_LEN];
+	char lib[MAX_LIB_NAME_LEN];
+	const char *ext = strstr(name, ".so");
+	const char *suffix;
+	void *handle;
+	int i;
+
+	for (i = 0; ext && i < HOST_SIMD_VARIANTS; i++) {
+		suffix = host_simd_suffix(i);
+		if (!suffix)
+			continue;
+
+		snprintf(lib, sizeof(lib), "%.*s%s%s", (int)(ext - name),
+			 name, suffix, ext);
+		handle = dlopen(lib, RTLD_LAZY);
+		if (handle) {
+			sprintf(message, "opening shared lib %s\n", lib);
+			debug_print(message);
+			return handle;
+		}
+	}
+
+	return dlopen(name, RTLD_LAZY);
+}
+
 static int set_up_library_table(void)
 {
 	int i;
@@ -160,7 +258,7 @@ static int set_up_library_table(void)
 
 		/* open default shared library */
 		lib_table[i].handle =
-				dlopen(lib_table[i].library_name, RTLD_LAZY);
+				open_simd_library(lib_table[i].library_name);
 		if (!lib_table[i].handle) {
 			fprintf(stderr, "error: %s\n", dlerror());
 			return -EINVAL;
@@ -174,7 +272,7 @@ static void parse_input_args(int argc, char **argv)
 {
 	int option = 0;
 
-	while ((option = getopt(argc, argv, "hdi:o:t:b:a:r:R:")) != -1) {
+	while ((option = getopt(argc, argv, "hdTi:o:t:b:a:r:R:l:j:P:C:")) != -1) {
 		switch (option) {
 		/* input sample file */
 		case 'i':
@@ -211,6 +309,38 @@ static void parse_input_args(int argc, char **argv)
 			fs_out = atoi(optarg);
 			break;
 
+		/* run jobs from list */
+		case 'l':
+			job_list = strdup(optarg);
+			break;
+
+		/* number of parallel jobs */
+		case 'j':
+			job_workers = atoi(optarg);
+			break;
+
+		/* benchmark components */
+		case 'P':
+			bench = 1;
+			if (strcmp(optarg, "-"))
+				bench_csv = strdup(optarg);
+			break;
+
+		/* realtime paced run */
+		case 'T':
+			paced = 1;
+			break;
+
+		/* emulated DSP cores */
+		case 'C':
+			num_cores = atoi(optarg);
+			if (num_cores < 1 || num_cores > PLATFORM_CORE_COUNT) {
+				fprintf(stderr, "error: 1 to %d cores\n",
+					PLATFORM_CORE_COUNT);
+				exit(EXIT_FAILURE);
+			}
+			break;
+
 		/* enable debug prints */
 		case 'd':
 			debug = 1;
@@ -225,17 +355,252 @@ static void parse_input_args(int argc, char **argv)
 	}
 }
 
+/* reap one finished job and count it as failed if it did not succeed */
+static int wait_job(void)
+{
+	int status;
+
+	if (wait(&status) < 0)
+		return -errno;
+
+	if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS)
+		return 1;
+
+	return 0;
+}
+
+/*
+ * Run every line of the job list as a separate testbench process, at most
+ * job_workers at a time. Each process has its own firmware context so the
+ * pipelines do not share any state. Returns the number of failed jobs.
+ */
+static int run_job_list(char *executable)
+{
+	char line[JOB_LINE_LEN];
+	char *args[JOB_MAX_ARGS + 2];
+	char *token;
+	char *save;
+	FILE *fp;
+	pid_t pid;
+	int running = 0;
+	int failed = 0;
+	int ret;
+	int n;
+
+	fp = fopen(job_list, "r");
+	if (!fp) {
+		fprintf(stderr, "error: can't open job list %s\n", job_list);
+		return -EINVAL;
+	}
+
+	if (job_workers <= 0)
+		job_workers = sysconf(_SC_NPROCESSORS_ONLN);
+	if (job_workers <= 0)
+		job_workers = 1;
+
+	while (fgets(line, sizeof(line), fp)) {
+		n = 0;
+		args[n++] = executable;
+		token = strtok_r(line, " \t\n", &save);
+		while (token && n <= JOB_MAX_ARGS) {
+			args[n++] = token;
+			token = strtok_r(NULL, " \t\n", &save);
+		}
+		args[n] = NULL;
+
+		/* skip empty lines and comments */
+		if (n == 1 || args[1][0] == '#')
+			continue;
+
+		if (running == job_workers) {
+			ret = wait_job();
+			if (ret < 0)
+				break;
+			failed += ret;
+			running--;
+		}
+
+		fflush(stdout);
+		pid = fork();
+		if (pid < 0) {
+			fprintf(stderr, "error: fork failed\n");
+			failed++;
+			break;
+		}
+
+		if (pid == 0) {
+			execvp(executable, args);
+			fprintf(stderr, "error: exec %s failed\n", executable);
+			_exit(EXIT_FAILURE);
+		}
+
+		running++;
+	}
+
+	while (running--) {
+		ret = wait_job();
+		if (ret < 0)
+			break;
+		failed += ret;
+	}
+
+	fclose(fp);
+	return failed;
+}
+
+/* stop once any input runs out, a mixer can not go on without it */
+static int tb_eof(void)
+{
+	int i;
+
+	for (i = 0; i < graph.num_fr; i++) {
+		if (frcd[i]->fs.reached_eof)
+			return 1;
+	}
+
+	return 0;
+}
+
+/*
+ * Copy one period of every pipeline, pipelines fed by files first. Pipelines
+ * on other cores run in parallel, so wait for them before the next step.
+ */
+static void tb_copy_period(void)
+{
+	int i;
+
+	for (i = 0; i < num_src_pipes; i++)
+		pipeline_schedule_copy(pipes[i], 0);
+
+	tb_smp_sync();
+
+	for (; i < graph.num_pipes; i++)
+		pipeline_schedule_copy(pipes[i], 0);
+
+	tb_smp_sync();
+}
+
+/*
+ * Order the pipelines so the ones scheduled by a fileread are copied
+ * before pipelines they feed, e.g. through a mixer.
+ */
+static int tb_get_pipelines(void)
+{
+	struct ipc_comp_dev *pcm_dev;
+	struct file_comp_data *cd;
+	int n = 0;
+	int pass;
+	int i;
+
+	for (pass = 0; pass < 2; pass++) {
+		for (i = 0; i < graph.num_pipes; i++) {
+			pcm_dev = ipc_get_comp(sof.ipc, graph.sched_id[i]);
+			if (!pcm_dev)
+				return -EINVAL;
+
+			/* first pass takes fileread, second filewrite */
+			cd = comp_get_drvdata(pcm_dev->cd);
+			if ((cd->fs.mode == FILE_READ) != (pass == 0))
+				continue;
+
+			sched_comps[n] = pcm_dev->cd;
+			pipes[n++] = pcm_dev->cd->pipeline;
+		}
+
+		if (pass == 0)
+			num_src_pipes = n;
+	}
+
+	return num_src_pipes ? 0 : -EINVAL;
+}
+
+static uint64_t ts_ns(const struct timespec *ts)
+{
+	return (uint64_t)ts->tv_sec * 1000000000ULL + ts->tv_nsec;
+}
+
+/*
+ * Copy one pipeline period at every period boundary of the monotonic
+ * clock until the input file ends. The wake up lateness against the
+ * boundary is the period jitter.
+ */
+static void *pace_thread(void *data)
+{
+	struct tb_pace *pace = data;
+	struct timespec ts;
+	uint64_t next;
+	uint64_t now;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	next = ts_ns(&ts);
+
+	while (!tb_eof()) {
+		next += pace->period_ns;
+		ts.tv_sec = next / 1000000000ULL;
+		ts.tv_nsec = next % 1000000000ULL;
+		while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts,
+				       NULL) == EINTR)
+			;
+
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		now = ts_ns(&ts);
+		if (now > next) {
+			pace->jitter_sum_ns += now - next;
+			pace->jitter_max_ns = MAX(pace->jitter_max_ns,
+						  now - next);
+		}
+
+		tb_copy_period();
+		pace->periods++;
+
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		if (ts_ns(&ts) > next + pace->period_ns)
+			pace->overruns++;
+	}
+
+	return NULL;
+}
+
+/* run the pipeline paced on a SCHED_FIFO thread, or a normal one if denied */
+static int run_paced(struct tb_pace *pace)
+{
+	struct sched_param param;
+	pthread_attr_t attr;
+	pthread_t thread;
+	int ret;
+
+	pthread_attr_init(&attr);
+	pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+	pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+	param.sched_priority = sched_get_priority_max(SCHED_FIFO) - 1;
+	pthread_attr_setschedparam(&attr, &param);
+
+	pace->rt = 1;
+	ret = pthread_create(&thread, &attr, pace_thread, pace);
+	if (ret == EPERM) {
+		printf("warning: no realtime priority, pacing is best effort\n");
+		pace->rt = 0;
+		ret = pthread_create(&thread, NULL, pace_thread, pace);
+	}
+	pthread_attr_destroy(&attr);
+
+	if (ret)
+		return -ret;
+
+	return -pthread_join(thread, NULL);
+}
+
 int main(int argc, char **argv)
 {
 	struct ipc_comp_dev *pcm_dev;
-	struct pipeline *p;
 	struct sof_ipc_pipe_new *ipc_pipe;
-	struct comp_dev *cd;
-	struct file_comp_data *frcd, *fwcd;
 	char pipeline[DEBUG_MSG_LEN];
+	struct tb_pace pace;
+	struct timespec wall_tic, wall_toc;
 	clock_t tic, toc;
-	double c_realtime, t_exec;
-	int n_in, n_out, ret;
+	double c_realtime, t_exec, latency;
+	FILE *csv;
+	int n_out, ret;
 	int i;
 
 	/* initialize input and output sample rates */
@@ -252,6 +617,15 @@ int main(int argc, char **argv)
 	/* command line arguments*/
 	parse_input_args(argc, argv);
 
+	/* run independent testbench instances in parallel */
+	if (job_list) {
+		ret = run_job_list(argv[0]);
+		if (ret > 0)
+			fprintf(stderr, "error: %d jobs failed\n", ret);
+		free(job_list);
+		return ret ? EXIT_FAILURE : EXIT_SUCCESS;
+	}
+
 	/* check args */
 	if (!tplg_file || !input_file || !output_file || !bits_in) {
 		print_usage(argv[0]);
@@ -264,23 +638,35 @@ int main(int argc, char **argv)
 		exit(EXIT_FAILURE);
 	}
 
+	/* slave cores run their pipelines from the topology */
+	for (i = 1; i < num_cores; i++)
+		cpu_enable_core(i);
+
 	/* parse topology file and create pipeline */
-	if (parse_topology(tplg_file, &sof, &fr_id, &fw_id, &sched_id, bits_in,
+	if (parse_topology(tplg_file, &sof, &graph, bits_in,
 	    input_file, output_file, lib_table, pipeline) < 0) {
 		fprintf(stderr, "error: parsing topology\n");
 		exit(EXIT_FAILURE);
 	}
 
-	/* Get pointers to fileread and filewrite */
-	pcm_dev = ipc_get_comp(sof.ipc, fw_id);
-	fwcd = comp_get_drvdata(pcm_dev->cd);
-	pcm_dev = ipc_get_comp(sof.ipc, fr_id);
-	frcd = comp_get_drvdata(pcm_dev->cd);
+	if (!graph.num_fr || !graph.num_fw || tb_get_pipelines() < 0) {
+		fprintf(stderr, "error: no file endpoints in topology\n");
+		exit(EXIT_FAILURE);
+	}
 
-	/* Run pipeline until EOF from fileread */
-	pcm_dev = ipc_get_comp(sof.ipc, sched_id);
-	p = pcm_dev->cd->pipeline;
-	ipc_pipe = &p->ipc_pipe;
+	/* Get pointers to filereads and filewrites */
+	for (i = 0; i < graph.num_fr; i++) {
+		pcm_dev = ipc_get_comp(sof.ipc, graph.fr_id[i]);
+		frcd[i] = comp_get_drvdata(pcm_dev->cd);
+	}
+
+	for (i = 0; i < graph.num_fw; i++) {
+		pcm_dev = ipc_get_comp(sof.ipc, graph.fw_id[i]);
+		fwcd[i] = comp_get_drvdata(pcm_dev->cd);
+	}
+
+	/* rates and period come from the first input pipeline */
+	ipc_pipe = &pipes[0]->ipc_pipe;
 
 	/* input and output sample rate */
 	if (!fs_in)
@@ -289,36 +675,66 @@ int main(int argc, char **argv)
 	if (!fs_out)
 		fs_out = ipc_pipe->deadline * ipc_pipe->frames_per_sched;
 
-	/* set pipeline params and trigger start */
-	if (tb_pipeline_start(sof.ipc, TESTBENCH_NCH, bits_in, ipc_pipe) < 0) {
-		fprintf(stderr, "error: pipeline params\n");
+	/*
+	 * set pipeline params and trigger start from each input, the graph
+	 * walk continues into the pipelines they feed
+	 */
+	for (i = 0; i < num_src_pipes; i++) {
+		if (tb_pipeline_start(sof.ipc, TESTBENCH_NCH, bits_in,
+				      &pipes[i]->ipc_pipe) < 0) {
+			fprintf(stderr, "error: pipeline params\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	if (bench && tb_bench_init(&sof) < 0) {
+		fprintf(stderr, "error: benchmark init\n");
 		exit(EXIT_FAILURE);
 	}
 
-	cd = pcm_dev->cd;
 	tb_enable_trace(false); /* reduce trace output */
 	tic = clock();
+	clock_gettime(CLOCK_MONOTONIC, &wall_tic);
 
-	while (frcd->fs.reached_eof == 0)
-		pipeline_schedule_copy(p, 0);
-
-	if (!frcd->fs.reached_eof)
-		printf("warning: possible pipeline xrun\n");
+	if (paced) {
+		memset(&pace, 0, sizeof(pace));
+		pace.period_ns = (uint64_t)ipc_pipe->deadline * 1000;
+		if (run_paced(&pace) < 0) {
+			fprintf(stderr, "error: paced run\n");
+			exit(EXIT_FAILURE);
+		}
+	} else {
+		while (!tb_eof())
+			tb_copy_period();
+	}
 
 	/* reset and free pipeline */
 	toc = clock();
+	clock_gettime(CLOCK_MONOTONIC, &wall_toc);
 	tb_enable_trace(true);
-	ret = pipeline_reset(p, cd);
-	if (ret < 0) {
-		fprintf(stderr, "error: pipeline reset\n");
-		exit(EXIT_FAILURE);
+	for (i = 0; i < num_src_pipes; i++) {
+		ret = pipeline_reset(pipes[i], sched_comps[i]);
+		if (ret < 0) {
+			fprintf(stderr, "error: pipeline reset\n");
+			exit(EXIT_FAILURE);
+		}
 	}
 
-	n_in = frcd->fs.n;
-	n_out = fwcd->fs.n;
+	n_out = fwcd[0]->fs.n;
 	t_exec = (double)(toc - tic) / CLOCKS_PER_SEC;
 	c_realtime = (double)n_out / TESTBENCH_NCH / fs_out / t_exec;
 
+	if (bench) {
+		csv = bench_csv ? fopen(bench_csv, "w") : NULL;
+		if (bench_csv && !csv)
+			fprintf(stderr, "error: can't open %s\n", bench_csv);
+		tb_bench_report((double)n_out / TESTBENCH_NCH / fs_out, csv);
+		if (csv)
+			fclose(csv);
+		tb_bench_free();
+		free(bench_csv);
+	}
+
 	/* free all components/buffers in pipeline */
 	free_comps();
 
@@ -332,11 +748,45 @@ int main(int argc, char **argv)
 	printf("Input sample rate: %d\n", fs_in);
 	printf("Output sample rate: %d\n", fs_out);
 	printf("Output written to file: \"%s\"\n", output_file);
-	printf("Input sample count: %d\n", n_in);
-	printf("Output sample count: %d\n", n_out);
+	for (i = 0; i < graph.num_fr; i++)
+		printf("Input %d sample count: %d\n", i, frcd[i]->fs.n);
+	for (i = 0; i < graph.num_fw; i++)
+		printf("Output %d sample count: %d\n", i, fwcd[i]->fs.n);
 	printf("Total execution time: %.2f us, %.2f x realtime\n",
 	       1e3 * t_exec, c_realtime);
 
+	/* impulse marker latency, the input must be silent before it */
+	for (i = 0; i < graph.num_fw; i++) {
+		if (frcd[0]->fs.marker < 0 || fwcd[i]->fs.marker < 0)
+			continue;
+
+		latency = (double)(fwcd[i]->fs.marker / TESTBENCH_NCH) /
+			fs_out -
+			(double)(frcd[0]->fs.marker / TESTBENCH_NCH) / fs_in;
+		printf("Impulse latency to output %d: %.2f us, %.2f periods\n",
+		       i, 1e6 * latency, 1e6 * latency / ipc_pipe->deadline);
+	}
+
+	if (paced) {
+		printf("Paced periods: %" PRIu64 " of %" PRIu64
+		       " us, %s priority\n", pace.periods,
+		       pace.period_ns / 1000, pace.rt ? "realtime" : "normal");
+		printf("Period jitter: avg %.2f us, max %.2f us, "
+		       "%" PRIu64 " overruns\n",
+		       pace.periods ?
+		       1e-3 * pace.jitter_sum_ns / pace.periods : 0.0,
+		       1e-3 * pace.jitter_max_ns, pace.overruns);
+	}
+
+	if (num_cores > 1) {
+		printf("Emulated cores: %d, wall time %.2f ms\n", num_cores,
+		       1e-6 * (ts_ns(&wall_toc) - ts_ns(&wall_tic)));
+		tb_smp_report(1e-9 * (ts_ns(&wall_toc) - ts_ns(&wall_tic)));
+	}
+
+	for (i = 1; i < num_cores; i++)
+		cpu_disable_core(i);
+
 	/* free all other data */
 	free(bits_in);
 	free(input_file);
@@ -38,14 +38,151 @@
 #include <stdio.h>
 #include <string.h>
 #include <dlfcn.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <sof/audio/component.h>
 #include "host/topology.h"
 #include "host/file.h"
 
-FILE *file;
 char pipeline_string[DEBUG_MSG_LEN];
 struct shared_lib_table *lib_table;
 
+/* topology file mapped for reading */
+static uint8_t *tplg_map;
+static size_t tplg_map_size;
+static size_t tplg_map_pos;
+
+/* input and output file names assigned to file endpoints in order */
+static char *in_files[TB_MAX_FILES];
+static char *out_files[TB_MAX_FILES];
+static int num_in_files;
+static int num_out_files;
+
+/* scheduling comp of the pipeline being loaded */
+static int cur_sched_id = -1;
+static int cur_sched_pipe = -1;
+
+/* length of pipeline_string without the terminator */
+static size_t pipeline_len;
+
+/* widget name hash, holds index + 1 into temp_comp_list or 0 if empty */
+static int *comp_hash;
+static uint32_t comp_hash_mask;
+
+/* copy the next bytes of the topology, returns 1 on success like fread() */
+static int tplg_read(void *dest, size_t size)
+{
+	if (size > tplg_map_size - tplg_map_pos)
+		return 0;
+
+	memcpy(dest, tplg_map + tplg_map_pos, size);
+	tplg_map_pos += size;
+	return 1;
+}
+
+/* move the topology read position by offset bytes */
+static int tplg_skip(long offset)
+{
+	if ((offset < 0 && (size_t)-offset > tplg_map_pos) ||
+	    (offset > 0 && (size_t)offset > tplg_map_size - tplg_map_pos))
+		return -EINVAL;
+
+	tplg_map_pos += offset;
+	return 0;
+}
+
+/* append to pipeline_string, truncating once it is full */
+static void pipeline_append(const char *str)
+{
+	int ret;
+
+	if (pipeline_len >= sizeof(pipeline_string) - 1)
+		return;
+
+	ret = snprintf(pipeline_string + pipeline_len,
+		       sizeof(pipeline_string) - pipeline_len, "%s", str);
+	if (ret > 0)
+		pipeline_len = MIN(pipeline_len + ret,
+				   sizeof(pipeline_string) - 1);
+}
+
+/* split a comma separated file list, returns the number of names */
+static int split_files(char *list, char **files)
+{
+	char *save = NULL;
+	char *token;
+	int n = 0;
+
+	token = strtok_r(list, ",", &save);
+	while (token && n < TB_MAX_FILES) {
+		files[n++] = token;
+		token = strtok_r(NULL, ",", &save);
+	}
+
+	return n;
+}
+
+/* FNV-1a hash of a widget name */
+static uint32_t comp_name_hash(const char *name)
+{
+	uint32_t hash = 2166136261u;
+
+	while (*name) {
+		hash ^= (uint8_t)*name++;
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+/* allocate a hash with at least twice as many slots as widgets */
+static int comp_hash_init(int count)
+{
+	uint32_t size = 1;
+
+	while (size < 2 * count)
+		size <<= 1;
+
+	free(comp_hash);
+	comp_hash = calloc(size, sizeof(*comp_hash));
+	if (!comp_hash)
+		return -ENOMEM;
+
+	comp_hash_mask = size - 1;
+	return 0;
+}
+
+/* add widget at index to the hash, first widget of a name wins lookups */
+static void comp_hash_add(struct comp_info *temp_comp_list, int index)
+{
+	uint32_t i = comp_name_hash(temp_comp_list[index].name);
+
+	for (;; i++) {
+		i &= comp_hash_mask;
+		if (!comp_hash[i]) {
+			comp_hash[i] = index + 1;
+			return;
+		}
+	}
+}
+
+/* find widget index by name, -1 if not found */
+static int comp_hash_find(struct comp_info *temp_comp_list, const char *name)
+{
+	uint32_t i = comp_name_hash(name);
+	int index;
+
+	for (;; i++) {
+		i &= comp_hash_mask;
+		index = comp_hash[i] - 1;
+		if (index < 0)
+			return -1;
+		if (strcmp(temp_comp_list[index].name, name) == 0)
+			return index;
+	}
+}
+
 /*
  * Register component driver
  * Only needed once per component type
@@ -102,7 +239,7 @@ static int read_array(struct snd_soc_tplg_vendor_array *array)
 		/* copy uuid elems into array */
 		for (j = 0; j < array->num_elems; j++) {
 			size = sizeof(struct snd_soc_tplg_vendor_uuid_elem);
-			ret = fread(&uuid, size, 1, file);
+			ret = tplg_read(&uuid, size);
 			if (ret != 1)
 				return -EINVAL;
 			memcpy(&array->uuid[j], &uuid, size);
@@ -113,7 +250,7 @@ static int read_array(struct snd_soc_tplg_vendor_array *array)
 		/* copy string elems into array */
 		for (j = 0; j < array->num_elems; j++) {
 			size = sizeof(struct snd_soc_tplg_vendor_string_elem);
-			ret = fread(&string, size, 1, file);
+			ret = tplg_read(&string, size);
 			if (ret != 1)
 				return -EINVAL;
 			memcpy(&array->string[j], &string, size);
@@ -126,7 +263,7 @@ static int read_array(struct snd_soc_tplg_vendor_array *array)
 		/* copy value elems into array */
 		for (j = 0; j < array->num_elems; j++) {
 			size = sizeof(struct snd_soc_tplg_vendor_value_elem);
-			ret = fread(&value, size, 1, file);
+			ret = tplg_read(&value, size);
 			if (ret != 1)
 				return -EINVAL;
 			memcpy(&array->value[j], &value, size);
@@ -148,6 +285,11 @@ static int load_graph(struct sof *sof, struct comp_info *temp_comp_list,
 	size_t size;
 	int i, j, ret = 0;
 
+	if (!comp_hash) {
+		fprintf(stderr, "error: graph before widgets\n");
+		return -EINVAL;
+	}
+
 	/* allocate memory for graph elem */
 	size = sizeof(struct snd_soc_tplg_dapm_graph_elem);
 	graph_elem = (struct snd_soc_tplg_dapm_graph_elem *)malloc(size);
@@ -161,26 +303,24 @@ static int load_graph(struct sof *sof, struct comp_info *temp_comp_list,
 	connection.sink_id = -1;
 	for (i = 0; i < count; i++) {
 		size = sizeof(struct snd_soc_tplg_dapm_graph_elem);
-		ret = fread(graph_elem, size, 1, file);
+		ret = tplg_read(graph_elem, size);
 		if (ret != 1)
 			return -EINVAL;
 
-		/* look up component id from the component list */
-		for (j = 0; j < num_comps; j++) {
-			if (strcmp(temp_comp_list[j].name,
-				   graph_elem->source) == 0)
-				connection.source_id = temp_comp_list[j].id;
+		/* look up component id from the widget name hash */
+		j = comp_hash_find(temp_comp_list, graph_elem->source);
+		if (j >= 0)
+			connection.source_id = temp_comp_list[j].id;
 
-			if (strcmp(temp_comp_list[j].name,
-				   graph_elem->sink) == 0)
-				connection.sink_id = temp_comp_list[j].id;
-		}
+		j = comp_hash_find(temp_comp_list, graph_elem->sink);
+		if (j >= 0)
+			connection.sink_id = temp_comp_list[j].id;
 
-		strcat(pipeline_string, graph_elem->source);
-		strcat(pipeline_string, "->");
+		pipeline_append(graph_elem->source);
+		pipeline_append("->");
 
 		if (i == (count - 1))
-			strcat(pipeline_string, graph_elem->sink);
+			pipeline_append(graph_elem->sink);
 
 		/* connect source and sink */
 		if (connection.source_id != -1 && connection.sink_id != -1)
@@ -214,7 +354,7 @@ static int load_buffer(struct sof *sof, int comp_id, int pipeline_id, int size)
 
 	/* allocate memory for vendor tuple array */
 	array = (struct snd_soc_tplg_vendor_array *)malloc(size);
-	ret = fread(array, sizeof(struct snd_soc_tplg_vendor_array), 1, file);
+	ret = tplg_read(array, sizeof(struct snd_soc_tplg_vendor_array));
 	if (ret != 1)
 		return -EINVAL;
 
@@ -235,13 +375,19 @@ static int load_buffer(struct sof *sof, int comp_id, int pipeline_id, int size)
 
 /* load fileread component */
 static int load_fileread(struct sof *sof, int comp_id, int pipeline_id,
-			 int size, char *bits_in, int *fr_id, int *sched_id)
+			 int size, char *bits_in, struct tb_graph *graph)
 {
 	struct sof_ipc_comp_file fileread;
 	struct snd_soc_tplg_vendor_array *array = NULL;
 	size_t total_array_size = 0, read_size;
 	int ret = 0;
 
+	if (graph->num_fr >= num_in_files) {
+		fprintf(stderr, "error: no input file for fileread %d\n",
+			graph->num_fr);
+		return -EINVAL;
+	}
+
 	fileread.config.frame_fmt = find_format(bits_in);
 
 	/* allocate memory for vendor tuple array */
@@ -254,7 +400,7 @@ static int load_fileread(struct sof *sof, int comp_id, int pipeline_id,
 	/* read vendor tokens */
 	while (total_array_size < size) {
 		read_size = sizeof(struct snd_soc_tplg_vendor_array);
-		ret = fread(array, read_size, 1, file);
+		ret = tplg_read(array, read_size);
 		if (ret != 1)
 			return -EINVAL;
 		read_array(array);
@@ -272,12 +418,14 @@ static int load_fileread(struct sof *sof, int comp_id, int pipeline_id,
 	}
 
 	/* configure fileread */
-	fileread.fn = strdup(input_file);
+	fileread.fn = strdup(in_files[graph->num_fr]);
 	fileread.mode = FILE_READ;
 	fileread.comp.id = comp_id;
 
 	/* use fileread comp as scheduling comp */
-	*fr_id = *sched_id = comp_id;
+	graph->fr_id[graph->num_fr++] = comp_id;
+	cur_sched_id = comp_id;
+	cur_sched_pipe = pipeline_id;
 	fileread.comp.hdr.size = sizeof(struct sof_ipc_comp_file);
 	fileread.comp.type = SOF_COMP_FILEREAD;
 	fileread.comp.pipeline_id = pipeline_id;
@@ -296,13 +444,19 @@ static int load_fileread(struct sof *sof, int comp_id, int pipeline_id,
 
 /* load filewrite component */
 static int load_filewrite(struct sof *sof, int comp_id, int pipeline_id,
-			  int size, int *fw_id)
+			  int size, struct tb_graph *graph)
 {
 	struct sof_ipc_comp_file filewrite;
 	struct snd_soc_tplg_vendor_array *array = NULL;
 	size_t total_array_size = 0, read_size;
 	int ret = 0;
 
+	if (graph->num_fw >= num_out_files) {
+		fprintf(stderr, "error: no output file for filewrite %d\n",
+			graph->num_fw);
+		return -EINVAL;
+	}
+
 	/* allocate memory for vendor tuple array */
 	array = (struct snd_soc_tplg_vendor_array *)malloc(size);
 	if (!array) {
@@ -313,7 +467,7 @@ static int load_filewrite(struct sof *sof, int comp_id, int pipeline_id,
 	/* read vendor tokens */
 	while (total_array_size < size) {
 		read_size = sizeof(struct snd_soc_tplg_vendor_array);
-		ret = fread(array, read_size, 1, file);
+		ret = tplg_read(array, read_size);
 		if (ret != 1)
 			return -EINVAL;
 
@@ -332,10 +486,16 @@ static int load_filewrite(struct sof *sof, int comp_id, int pipeline_id,
 	}
 
 	/* configure filewrite */
-	filewrite.fn = strdup(output_file);
+	filewrite.fn = strdup(out_files[graph->num_fw]);
 	filewrite.comp.id = comp_id;
 	filewrite.mode = FILE_WRITE;
-	*fw_id = comp_id;
+	graph->fw_id[graph->num_fw++] = comp_id;
+
+	/* schedule pipelines without a fileread, e.g. after a mixer, here */
+	if (cur_sched_pipe != pipeline_id) {
+		cur_sched_id = comp_id;
+		cur_sched_pipe = pipeline_id;
+	}
 	filewrite.comp.hdr.size = sizeof(struct sof_ipc_comp_file);
 	filewrite.comp.type = SOF_COMP_FILEREAD;
 	filewrite.comp.pipeline_id = pipeline_id;
@@ -356,7 +516,7 @@ static int load_filewrite(struct sof *sof, int comp_id, int pipeline_id,
 static int load_pga(struct sof *sof, int comp_id, int pipeline_id,
 		    int size)
 {
-	struct sof_ipc_comp_volume volume;
+	struct sof_ipc_comp_volume volume = {0};
 	struct snd_soc_tplg_vendor_array *array = NULL;
 	size_t total_array_size = 0, read_size;
 	int ret = 0;
@@ -371,7 +531,7 @@ static int load_pga(struct sof *sof, int comp_id, int pipeline_id,
 	/* read vendor tokens */
 	while (total_array_size < size) {
 		read_size = sizeof(struct snd_soc_tplg_vendor_array);
-		ret = fread(array, read_size, 1, file);
+		ret = tplg_read(array, read_size);
 		if (ret != 1)
 			return -EINVAL;
 		read_array(array);
@@ -404,16 +564,90 @@ static int load_pga(struct sof *sof, int comp_id, int pipeline_id,
 	return 0;
 }
 
+/* load mixer dapm widget */
+static int load_mixer(struct sof *sof, int comp_id, int pipeline_id,
+		      int size)
+{
+	struct sof_ipc_comp_mixer mixer = {0};
+	struct snd_soc_tplg_vendor_array *array = NULL;
+	size_t total_array_size = 0, read_size;
+	int ret = 0;
+
+	/* allocate memory for vendor tuple array */
+	array = (struct snd_soc_tplg_vendor_array *)malloc(size);
+	if (!array) {
+		fprintf(stderr, "error: mem alloc\n");
+		return -EINVAL;
+	}
+
+	/* read vendor tokens */
+	while (total_array_size < size) {
+		read_size = sizeof(struct snd_soc_tplg_vendor_array);
+		ret = tplg_read(array, read_size);
+		if (ret != 1)
+			return -EINVAL;
+		read_array(array);
+
+		/* parse mixer tokens */
+		ret = sof_parse_tokens(&mixer.config, comp_tokens,
+				       ARRAY_SIZE(comp_tokens), array,
+				       array->size);
+		if (ret != 0) {
+			fprintf(stderr, "error: parse mixer tokens %d\n",
+				size);
+			return -EINVAL;
+		}
+
+		ret = sof_parse_tokens(&mixer, mixer_tokens,
+				       ARRAY_SIZE(mixer_tokens), array,
+				       array->size);
+		if (ret != 0) {
+			fprintf(stderr, "error: parse mixer tokens %d\n",
+				size);
+			return -EINVAL;
+		}
+		total_array_size += array->size;
+	}
+
+	/* configure mixer */
+	mixer.comp.id = comp_id;
+	mixer.comp.hdr.size = sizeof(struct sof_ipc_comp_mixer);
+	mixer.comp.type = SOF_COMP_MIXER;
+	mixer.comp.pipeline_id = pipeline_id;
+	mixer.config.hdr.size = sizeof(struct sof_ipc_comp_config);
+
+	/* load mixer component */
+	if (ipc_comp_new(sof->ipc, (struct sof_ipc_comp *)&mixer) < 0) {
+		fprintf(stderr, "error: comp register\n");
+		return -EINVAL;
+	}
+
+	free(array);
+	return 0;
+}
+
 /* load scheduler dapm widget */
 static int load_pipeline(struct sof *sof, struct sof_ipc_pipe_new *pipeline,
-			 int comp_id, int pipeline_id, int size, int *sched_id)
+			 int comp_id, int pipeline_id, int size,
+			 struct tb_graph *graph)
 {
 	struct snd_soc_tplg_vendor_array *array = NULL;
 	size_t total_array_size = 0, read_size;
 	int ret = 0;
 
+	if (cur_sched_pipe != pipeline_id) {
+		fprintf(stderr, "error: pipeline %d has no file endpoint\n",
+			pipeline_id);
+		return -EINVAL;
+	}
+
+	if (graph->num_pipes >= TB_MAX_PIPELINES) {
+		fprintf(stderr, "error: too many pipelines\n");
+		return -EINVAL;
+	}
+
 	/* configure pipeline */
-	pipeline->sched_id = *sched_id;
+	pipeline->sched_id = cur_sched_id;
 	pipeline->comp_id = comp_id;
 	pipeline->pipeline_id = pipeline_id;
 
@@ -427,7 +661,7 @@ static int load_pipeline(struct sof *sof, struct sof_ipc_pipe_new *pipeline,
 	/* read vendor arrays */
 	while (total_array_size < size) {
 		read_size = sizeof(struct snd_soc_tplg_vendor_array);
-		ret = fread(array, read_size, 1, file);
+		ret = tplg_read(array, read_size);
 		if (ret != 1)
 			return -EINVAL;
 
@@ -453,6 +687,8 @@ static int load_pipeline(struct sof *sof, struct sof_ipc_pipe_new *pipeline,
 		return -EINVAL;
 	}
 
+	graph->sched_id[graph->num_pipes++] = cur_sched_id;
+
 	free(array);
 	return 0;
 }
@@ -502,7 +738,7 @@ static int load_controls(struct sof *sof, int num_kcontrols)
 	for (j = 0; j < num_kcontrols; j++) {
 		/* read control header */
 		read_size = sizeof(struct snd_soc_tplg_ctl_hdr);
-		ret = fread(ctl_hdr, read_size, 1, file);
+		ret = tplg_read(ctl_hdr, read_size);
 		if (ret != 1)
 			return -EINVAL;
 
@@ -517,14 +753,14 @@ static int load_controls(struct sof *sof, int num_kcontrols)
 
 			/* load mixer type control */
 			read_size = sizeof(struct snd_soc_tplg_ctl_hdr);
-			fseek(file, read_size * -1, SEEK_CUR);
+			tplg_skip(-(long)read_size);
 			read_size = sizeof(struct snd_soc_tplg_mixer_control);
-			ret = fread(mixer_ctl, read_size, 1, file);
+			ret = tplg_read(mixer_ctl, read_size);
 			if (ret != 1)
 				return -EINVAL;
 
 			/* skip mixer private data */
-			fseek(file, mixer_ctl->priv.size, SEEK_CUR);
+			tplg_skip(mixer_ctl->priv.size);
 			break;
 		case SND_SOC_TPLG_CTL_ENUM:
 		case SND_SOC_TPLG_CTL_ENUM_VALUE:
@@ -534,27 +770,27 @@ static int load_controls(struct sof *sof, int num_kcontrols)
 
 			/* load enum type control */
 			read_size = sizeof(struct snd_soc_tplg_ctl_hdr);
-			fseek(file, read_size * -1, SEEK_CUR);
+			tplg_skip(-(long)read_size);
 			read_size = sizeof(struct snd_soc_tplg_enum_control);
-			ret = fread(enum_ctl, read_size, 1, file);
+			ret = tplg_read(enum_ctl, read_size);
 			if (ret != 1)
 				return -EINVAL;
 
 			/* skip enum private data */
-			fseek(file, enum_ctl->priv.size, SEEK_CUR);
+			tplg_skip(enum_ctl->priv.size);
 			break;
 		case SND_SOC_TPLG_CTL_BYTES:
 
 			/* load bytes type controls */
 			read_size = sizeof(struct snd_soc_tplg_ctl_hdr);
-			fseek(file, read_size * -1, SEEK_CUR);
+			tplg_skip(-(long)read_size);
 			read_size = sizeof(struct snd_soc_tplg_bytes_control);
-			ret = fread(bytes_ctl, read_size, 1, file);
+			ret = tplg_read(bytes_ctl, read_size);
 			if (ret != 1)
 				return -EINVAL;
 
 			/* skip bytes private data */
-			fseek(file, bytes_ctl->priv.size, SEEK_CUR);
+			tplg_skip(bytes_ctl->priv.size);
 			break;
 		default:
 			printf("info: control type not supported\n");
@@ -589,7 +825,7 @@ static int load_src(struct sof *sof, int comp_id, int pipeline_id,
 	/* read vendor tokens */
 	while (total_array_size < size) {
 		read_size = sizeof(struct snd_soc_tplg_vendor_array);
-		ret = fread(array, read_size, 1, file);
+		ret = tplg_read(array, read_size);
 		if (ret != 1)
 			return -EINVAL;
 		read_array(array);
@@ -651,8 +887,8 @@ static int load_src(struct sof *sof, int comp_id, int pipeline_id,
 }
 
 /* load dapm widget */
-static int load_widget(struct sof *sof, int *fr_id, int *fw_id,
-		       int *sched_id, char *bits_in,
+static int load_widget(struct sof *sof, struct tb_graph *graph,
+		       char *bits_in,
 		       struct comp_info *temp_comp_list,
 		       struct sof_ipc_pipe_new *pipeline, int comp_id,
 		       int comp_index, int pipeline_id)
@@ -672,7 +908,7 @@ static int load_widget(struct sof *sof, int *fr_id, int *fw_id,
 
 	/* read widget data */
 	read_size = sizeof(struct snd_soc_tplg_dapm_widget);
-	ret = fread(widget, read_size, 1, file);
+	ret = tplg_read(widget, read_size);
 	if (ret != 1)
 		return -EINVAL;
 
@@ -685,6 +921,7 @@ static int load_widget(struct sof *sof, int *fr_id, int *fw_id,
 	temp_comp_list[comp_index].name = strdup(widget->name);
 	temp_comp_list[comp_index].type = widget->id;
 	temp_comp_list[comp_index].pipeline_id = pipeline_id;
+	comp_hash_add(temp_comp_list, comp_index);
 
 	sprintf(message, "loading widget %s id %d\n",
 		temp_comp_list[comp_index].name,
@@ -709,7 +946,7 @@ static int load_widget(struct sof *sof, int *fr_id, int *fw_id,
 	case(SND_SOC_TPLG_DAPM_AIF_IN):
 		if (load_fileread(sof, temp_comp_list[comp_index].id,
 				  pipeline_id, widget->priv.size, bits_in,
-				  fr_id, sched_id) < 0) {
+				  graph) < 0) {
 			fprintf(stderr, "error: load fileread\n");
 			return -EINVAL;
 		}
@@ -719,7 +956,7 @@ static int load_widget(struct sof *sof, int *fr_id, int *fw_id,
 	case(SND_SOC_TPLG_DAPM_DAI_IN):
 		if (load_filewrite(sof, temp_comp_list[comp_index].id,
 				   pipeline_id, widget->priv.size,
-				   fw_id) < 0) {
+				   graph) < 0) {
 			fprintf(stderr, "error: load filewrite\n");
 			return -EINVAL;
 		}
@@ -740,12 +977,21 @@ static int load_widget(struct sof *sof, int *fr_id, int *fw_id,
 				  temp_comp_list[comp_index].id,
 				  pipeline_id,
 				  widget->priv.size,
-				  sched_id) < 0) {
+				  graph) < 0) {
 			fprintf(stderr, "error: load buffer\n");
 			return -EINVAL;
 		}
 		break;
 
+	/* load mixer widget */
+	case(SND_SOC_TPLG_DAPM_MIXER):
+		if (load_mixer(sof, temp_comp_list[comp_index].id,
+			       pipeline_id, widget->priv.size) < 0) {
+			fprintf(stderr, "error: load mixer\n");
+			return -EINVAL;
+		}
+		break;
+
 	/* load src widget */
 	case(SND_SOC_TPLG_DAPM_SRC):
 		if (load_src(sof, temp_comp_list[comp_index].id,
@@ -774,8 +1020,8 @@ static int load_widget(struct sof *sof, int *fr_id, int *fw_id,
 }
 
 /* parse topology file and set up pipeline */
-int parse_topology(char *filename, struct sof *sof, int *fr_id, int *fw_id,
-		    int *sched_id, char *bits_in, char *in_file,
+int parse_topology(char *filename, struct sof *sof, struct tb_graph *graph,
+		    char *bits_in, char *in_file,
 		    char *out_file, struct shared_lib_table *library_table,
 		    char *pipeline_msg)
 {
@@ -786,21 +1032,51 @@ int parse_topology(char *filename, struct sof *sof, int *fr_id, int *fw_id,
 	char message[DEBUG_MSG_LEN];
 	int next_comp_id = 0, num_comps = 0;
 	int i, ret = 0;
-	size_t file_size, size;
+	size_t size;
+	struct stat st;
+	FILE *file;
 
-	/* open topology file */
+	/* map topology file */
 	file = fopen(tplg_file, "rb");
 	if (!file) {
 		fprintf(stderr, "error: opening file %s\n", tplg_file);
 		return -EINVAL;
 	}
 
+	if (fstat(fileno(file), &st) < 0 || st.st_size == 0) {
+		fprintf(stderr, "error: empty file %s\n", tplg_file);
+		fclose(file);
+		return -EINVAL;
+	}
+
+	tplg_map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE,
+			fileno(file), 0);
+	fclose(file);
+	if (tplg_map == MAP_FAILED) {
+		fprintf(stderr, "error: mapping file %s\n", tplg_file);
+		return -EINVAL;
+	}
+
+	madvise(tplg_map, st.st_size, MADV_SEQUENTIAL);
+	tplg_map_size = st.st_size;
+	tplg_map_pos = 0;
+
 	lib_table = library_table;
+	pipeline_string[0] = '\0';
+	pipeline_len = 0;
 
-	/* file size */
-	fseek(file, 0, SEEK_END);
-	file_size = ftell(file);
-	fseek(file, 0, SEEK_SET);
+	/* file endpoints take the listed files in topology order */
+	in_file = strdup(in_file);
+	out_file = strdup(out_file);
+	if (!in_file || !out_file) {
+		fprintf(stderr, "error: mem alloc\n");
+		return -EINVAL;
+	}
+	num_in_files = split_files(in_file, in_files);
+	num_out_files = split_files(out_file, out_files);
+	memset(graph, 0, sizeof(*graph));
+	cur_sched_id = -1;
+	cur_sched_pipe = -1;
 
 	/* allocate memory */
 	size = sizeof(struct snd_soc_tplg_hdr);
@@ -813,7 +1089,7 @@ int parse_topology(char *filename, struct sof *sof, int *fr_id, int *fw_id,
 	debug_print("topology parsing start\n");
 	while (1) {
 		/* read topology header */
-		ret = fread(hdr, sizeof(struct snd_soc_tplg_hdr), 1, file);
+		ret = tplg_read(hdr, sizeof(struct snd_soc_tplg_hdr));
 		if (ret != 1)
 			return -EINVAL;
 
@@ -831,9 +1107,13 @@ int parse_topology(char *filename, struct sof *sof, int *fr_id, int *fw_id,
 			size = sizeof(struct comp_info) * hdr->count;
 			temp_comp_list = (struct comp_info *)malloc(size);
 			num_comps = hdr->count;
+			if (!temp_comp_list || comp_hash_init(num_comps) < 0) {
+				fprintf(stderr, "error: mem alloc\n");
+				return -EINVAL;
+			}
 
 			for (i = 0; i < hdr->count; i++)
-				load_widget(sof, fr_id, fw_id, sched_id,
+				load_widget(sof, graph,
 					    bits_in, temp_comp_list,
 					    &pipeline, next_comp_id++,
 					    i, hdr->index);
@@ -847,12 +1127,13 @@ int parse_topology(char *filename, struct sof *sof, int *fr_id, int *fw_id,
 				return -EINVAL;
 			}
 
-			if (ftell(file) == file_size)
+			if (tplg_map_pos == tplg_map_size)
 				goto finish;
 			break;
 		default:
-			fseek(file, hdr->payload_size, SEEK_CUR);
-			if (ftell(file) == file_size)
+			if (tplg_skip(hdr->payload_size) < 0)
+				return -EINVAL;
+			if (tplg_map_pos == tplg_map_size)
 				goto finish;
 			break;
 		}
@@ -868,7 +1149,11 @@ finish:
 		free(temp_comp_list[i].name);
 
 	free(temp_comp_list);
-	fclose(file);
+	free(comp_hash);
+	comp_hash = NULL;
+	munmap(tplg_map, tplg_map_size);
+	free(in_file);
+	free(out_file);
 	return 0;
 }
 
@@ -68,6 +68,14 @@ char *get_trace_class(uint32_t trace_class)
 		CASE(SA);
 		CASE(DMIC);
 		CASE(POWER);
+		CASE(ASRC);
+		CASE(CONV);
+		CASE(DRC);
+		CASE(KPB);
+		CASE(DECODER);
+		CASE(PROBE);
+		CASE(VOICE);
+		CASE(CROSSOVER);
 	default: return "unknown";
 	}
 }
@@ -59,7 +59,11 @@ uint32_t fs_out;
 #define MAX_LIB_NAME_LEN	256
 
 /* number of widgets types supported in testbench */
-#define NUM_WIDGETS_SUPPORTED	3
+#define NUM_WIDGETS_SUPPORTED	4
+
+/* file sources or sinks and pipelines in one topology */
+#define TB_MAX_FILES		8
+#define TB_MAX_PIPELINES	8
 
 struct shared_lib_table {
 	char *comp_name;
@@ -86,6 +90,18 @@ int tb_pipeline_start(struct ipc *ipc, int nch, char *bits_in,
 int tb_pipeline_params(struct ipc *ipc, int nch, char *bits_in,
 		       struct sof_ipc_pipe_new *ipc_pipe);
 
+int tb_bench_init(struct sof *sof);
+
+void tb_bench_report(double audio_sec, FILE *csv);
+
+void tb_bench_free(void);
+
+int tb_smp_queue_task(struct task *task);
+
+void tb_smp_sync(void);
+
+void tb_smp_report(double exec_sec);
+
 void debug_print(char *message);
 
 int get_index_by_name(char *comp_name,
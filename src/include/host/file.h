@@ -43,8 +43,12 @@ enum file_mode {
 enum file_format {
 	FILE_TEXT = 0,
 	FILE_RAW,
+	FILE_WAV,
 };
 
+/* size of the stdio buffer used for binary output files */
+#define FILE_WRITE_BUF_SIZE	(256 * 1024)
+
 /* file component state */
 struct file_state {
 	char *fn;
@@ -53,6 +57,13 @@ struct file_state {
 	int n;
 	enum file_mode mode;
 	enum file_format f_format;
+	uint8_t *map;		/* binary input file mapping */
+	size_t map_pos;		/* next byte to read from mapping */
+	size_t map_end;		/* end of PCM data in mapping */
+	size_t map_size;	/* size of mapping */
+	char *wbuf;		/* stdio buffer for binary output */
+	uint32_t data_bytes;	/* PCM bytes written to WAV output */
+	int marker;		/* first non-zero sample index or -1 */
 };
 
 /* file comp data */
@@ -50,10 +50,15 @@
 #define SOF_TKN_SCHED_CORE                      203
 #define SOF_TKN_SCHED_FRAMES                    204
 #define SOF_TKN_SCHED_TIMER                     205
+#define SOF_TKN_SCHED_PERIODS                   206
+#define SOF_TKN_SCHED_IDLE                      207
+#define SOF_TKN_SCHED_PULL                      208
+#define SOF_TKN_SCHED_FAST_START                209
 
 /* volume */
 #define SOF_TKN_VOLUME_RAMP_STEP_TYPE           250
 #define SOF_TKN_VOLUME_RAMP_STEP_MS             251
+#define SOF_TKN_VOLUME_PRECISION                252
 
 /* SRC */
 #define SOF_TKN_SRC_RATE_IN                     300
@@ -65,6 +70,9 @@
 #define SOF_TKN_COMP_FORMAT                     402
 #define SOF_TKN_COMP_PRELOAD_COUNT              403
 
+/* mixer */
+#define SOF_TKN_MIXER_UNDERRUN                  1000
+
 struct comp_info {
 	char *name;
 	int id;
@@ -135,6 +143,18 @@ static const struct sof_topology_token sched_tokens[] = {
 	{SOF_TKN_SCHED_TIMER, SND_SOC_TPLG_TUPLE_TYPE_WORD,
 		get_token_uint32_t,
 		offsetof(struct sof_ipc_pipe_new, timer_delay), 0},
+	{SOF_TKN_SCHED_PERIODS, SND_SOC_TPLG_TUPLE_TYPE_WORD,
+		get_token_uint32_t,
+		offsetof(struct sof_ipc_pipe_new, periods_per_sched), 0},
+	{SOF_TKN_SCHED_IDLE, SND_SOC_TPLG_TUPLE_TYPE_WORD,
+		get_token_uint32_t,
+		offsetof(struct sof_ipc_pipe_new, idle_ms), 0},
+	{SOF_TKN_SCHED_PULL, SND_SOC_TPLG_TUPLE_TYPE_WORD,
+		get_token_uint32_t,
+		offsetof(struct sof_ipc_pipe_new, pull), 0},
+	{SOF_TKN_SCHED_FAST_START, SND_SOC_TPLG_TUPLE_TYPE_WORD,
+		get_token_uint32_t,
+		offsetof(struct sof_ipc_pipe_new, fast_start), 0},
 };
 
 /* volume */
@@ -145,6 +165,9 @@ static const struct sof_topology_token volume_tokens[] = {
 	{SOF_TKN_VOLUME_RAMP_STEP_MS,
 		SND_SOC_TPLG_TUPLE_TYPE_WORD, get_token_uint32_t,
 		offsetof(struct sof_ipc_comp_volume, initial_ramp), 0},
+	{SOF_TKN_VOLUME_PRECISION, SND_SOC_TPLG_TUPLE_TYPE_WORD,
+		get_token_uint32_t,
+		offsetof(struct sof_ipc_comp_volume, precision), 0},
 };
 
 /* SRC */
@@ -157,6 +180,13 @@ static const struct sof_topology_token src_tokens[] = {
 		offsetof(struct sof_ipc_comp_src, sink_rate), 0},
 };
 
+/* mixer */
+static const struct sof_topology_token mixer_tokens[] = {
+	{SOF_TKN_MIXER_UNDERRUN, SND_SOC_TPLG_TUPLE_TYPE_WORD,
+		get_token_uint32_t,
+		offsetof(struct sof_ipc_comp_mixer, underrun), 0},
+};
+
 /* Tone */
 static const struct sof_topology_token tone_tokens[] = {
 };
@@ -194,8 +224,18 @@ void sof_parse_word_tokens(void *object,
 			   int count,
 			   struct snd_soc_tplg_vendor_array *array);
 
-int parse_topology(char *filename, struct sof *sof, int *fr_id, int *fw_id,
-		    int *sched_id, char *bits_in, char *in_file,
+/* file endpoints and pipelines created by parse_topology() */
+struct tb_graph {
+	int fr_id[TB_MAX_FILES];	/* fileread comp ids in topology order */
+	int fw_id[TB_MAX_FILES];	/* filewrite comp ids in topology order */
+	int sched_id[TB_MAX_PIPELINES];	/* scheduling comp of each pipeline */
+	int num_fr;
+	int num_fw;
+	int num_pipes;
+};
+
+int parse_topology(char *filename, struct sof *sof, struct tb_graph *graph,
+		    char *bits_in, char *in_file,
 		    char *out_file, struct shared_lib_table *library_table,
 		    char *pipeline_msg);
 
@@ -74,15 +74,35 @@ struct sof;
 
 struct dma_copy;
 struct dma_sg_config;
+struct sof_ipc_debug_heap;
+struct sof_ipc_debug_heap_hist;
+struct sof_ipc_debug_mem_bench_params;
+struct sof_ipc_debug_mem_bench;
 
 struct mm_info {
 	uint32_t used;
 	uint32_t free;
+	uint32_t peak;		/* highest used since boot */
 };
 
+#ifdef CONFIG_ALLOC_FREE_LIST
+/* end of block map free list */
+#define BLOCK_FREE_END		0xffff
+
+/* direct mapped address to heap lookup used by rfree() */
+#define HEAP_LOOKUP_SHIFT	12
+#define HEAP_LOOKUP_ENTRIES	256
+#define HEAP_LOOKUP_NONE	0
+#define HEAP_LOOKUP_MULTI	0xff
+#endif
+
 struct block_hdr {
 	uint16_t size;		/* size in blocks for continuous allocation */
 	uint16_t used;		/* usage flags for page */
+#ifdef CONFIG_ALLOC_FREE_LIST
+	uint16_t next_free;	/* next free block in map */
+	uint16_t prev_free;	/* previous free block in map */
+#endif
 } __attribute__ ((packed));
 
 struct block_map {
@@ -90,6 +110,13 @@ struct block_map {
 	uint16_t count;		/* number of blocks in map */
 	uint16_t free_count;	/* number of free blocks */
 	uint16_t first_free;	/* index of first free block */
+#ifdef CONFIG_ALLOC_FREE_LIST
+	uint16_t free_head;	/* index of free list head */
+#endif
+	uint16_t pm_dirty;	/* alloc or free since last PM context save */
+#ifdef CONFIG_HEAP_HISTOGRAM
+	uint16_t peak_used;	/* most blocks used at once since boot */
+#endif
 	struct block_hdr *block;	/* base block header */
 	uint32_t base;		/* base address of space */
 } __attribute__ ((__aligned__(PLATFORM_DCACHE_ALIGN)));
@@ -106,6 +133,20 @@ struct mm_heap {
 	struct mm_info info;
 } __attribute__ ((__aligned__(PLATFORM_DCACHE_ALIGN)));
 
+#ifdef PLATFORM_HEAP_CORE
+/* per core heap partition, only the owning core allocates from it */
+struct mm_core_heap {
+	struct mm_heap runtime;	/* tried before memmap.runtime */
+	struct mm_heap buffer;	/* tried before memmap.buffer */
+	/* blocks freed by other cores, only accessed uncached */
+	uint32_t remote_free
+		__attribute__ ((__aligned__(PLATFORM_DCACHE_ALIGN)));
+	/* protects remote_free, the owner alloc and free path is lock free */
+	spinlock_t lock
+		__attribute__ ((__aligned__(PLATFORM_DCACHE_ALIGN)));
+} __attribute__ ((__aligned__(PLATFORM_DCACHE_ALIGN)));
+#endif
+
 /* heap block memory map */
 struct mm {
 	/* system heap - used during init cannot be freed */
@@ -116,8 +157,16 @@ struct mm {
 	struct mm_heap runtime[PLATFORM_HEAP_RUNTIME];
 	/* general component buffer heap */
 	struct mm_heap buffer[PLATFORM_HEAP_BUFFER];
+#ifdef PLATFORM_HEAP_CORE
+	/* runtime and buffer partitions, one per core */
+	struct mm_core_heap core[PLATFORM_HEAP_CORE];
+#endif
 
 	struct mm_info total;
+#ifdef CONFIG_ALLOC_FREE_LIST
+	/* heap index + 1 for each address slot, see HEAP_LOOKUP_SHIFT */
+	uint8_t heap_lookup[HEAP_LOOKUP_ENTRIES];
+#endif
 	uint32_t heap_trace_updated;	/* updates that can be presented */
 	spinlock_t lock;	/* all allocs and frees are atomic */
 } __attribute__ ((__aligned__(PLATFORM_DCACHE_ALIGN)));
@@ -204,4 +253,24 @@ void free_heap(int zone);
 void heap_trace_all(int force);
 void heap_trace(struct mm_heap *heap, int size);
 
+/* heap usage of IPC zone, returns reply size or negative error */
+int heap_info(uint32_t zone, struct sof_ipc_debug_heap *info);
+
+#ifdef CONFIG_HEAP_HISTOGRAM
+/* allocation histogram of IPC zone, returns reply size or negative error */
+int heap_hist(uint32_t zone, struct sof_ipc_debug_heap_hist *hist);
+#endif
+
+#ifdef CONFIG_MEM_BENCH
+/* cached allocation from heap index of an IPC runtime or buffer zone, freed
+ * with rfree(), -ENOENT past the last heap of the zone
+ */
+int heap_alloc_at(uint32_t zone, int index, size_t bytes, uint32_t *caps,
+		  void **ptr);
+
+/* benchmark the heaps of IPC zone, returns reply size or negative error */
+int mem_bench(struct sof_ipc_debug_mem_bench_params *params,
+	      struct sof_ipc_debug_mem_bench *bench);
+#endif
+
 #endif
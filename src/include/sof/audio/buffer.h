@@ -40,70 +40,204 @@
 #include <sof/audio/component.h>
 #include <sof/trace.h>
 #include <sof/schedule.h>
+#include <sof/platform.h>
+#include <sof/math/numbers.h>
+#include <platform/platform.h>
 #include <uapi/ipc/topology.h>
 
 /* pipeline tracing */
 #define trace_buffer(__e, ...)	trace_event(TRACE_CLASS_BUFFER, __e, ##__VA_ARGS__)
 #define trace_buffer_error(__e, ...)	trace_error(TRACE_CLASS_BUFFER, __e, ##__VA_ARGS__)
 #define tracev_buffer(__e, ...)	tracev_event(TRACE_CLASS_BUFFER, __e, ##__VA_ARGS__)
+#define tracehot_buffer(__e, ...)	\
+	tracehot_event(TRACE_CLASS_BUFFER, __e, ##__VA_ARGS__)
+
+/*
+ * In SPSC mode the producer and consumer can run on different cores, so
+ * their positions are kept in separate cache lines.
+ */
+#if PLATFORM_CORE_COUNT > 1
+#define BUFFER_SPSC_ALIGN	__attribute__ ((__aligned__(PLATFORM_DCACHE_ALIGN)))
+#else
+#define BUFFER_SPSC_ALIGN
+#endif
+
+/* the set up part of comp_buffer starts on a new cache line */
+#define BUFFER_COLD_ALIGN	__attribute__ ((__aligned__(PLATFORM_DCACHE_ALIGN)))
 
 /* audio component buffer - connects 2 audio components together in pipeline */
 struct comp_buffer {
 
-	/* runtime data */
-	uint32_t connected;	/* connected in path */
+	/* runtime data - read by every pipeline walk and copy, kept together
+	 * at the start of the object to fit the first cache line
+	 */
+	uint8_t connected;	/* connected in path */
+	uint8_t spsc;		/* lock free single producer/consumer mode */
+	uint8_t inplace;	/* bypass_comp processes in place */
+	uint8_t probe;		/* produced data mirrored to probes */
 	uint32_t size;		/* runtime buffer size in bytes (period multiple) */
-	uint32_t alloc_size;	/* allocated size in bytes */
-	uint32_t avail;		/* available bytes for reading */
-	uint32_t free;		/* free bytes for writing */
-	void *w_ptr;		/* buffer write pointer */
-	void *r_ptr;		/* buffer read position */
+	uint32_t avail;		/* available bytes for reading (not SPSC/pow2) */
+	uint32_t free;		/* free bytes for writing (not SPSC/pow2) */
+	uint32_t mask;		/* size - 1 in power of two mode, else 0 */
+	uint32_t caps;		/* ipc_buffer.caps */
 	void *addr;		/* buffer base address */
 	void *end_addr;		/* buffer end address */
 
-	/* IPC configuration */
-	struct sof_ipc_buffer ipc_buffer;
-
 	/* connected components */
 	struct comp_dev *source;	/* source component */
 	struct comp_dev *sink;		/* sink component */
-
-	/* lists */
 	struct list_item source_list;	/* list in comp buffers */
 	struct list_item sink_list;	/* list in comp buffers */
 
+	/* fan-out readers sharing the data, circular, NULL if not shared */
+	struct comp_buffer *next_reader;
+	struct comp_buffer *trail;	/* loopback reader trails this one */
+
+	/* producer position - only written by source component in SPSC */
+	void *w_ptr BUFFER_SPSC_ALIGN;	/* buffer write pointer */
+	uint32_t produced;	/* total bytes produced, SPSC or pow2 */
+
+	/* consumer position - only written by sink component in SPSC */
+	void *r_ptr BUFFER_SPSC_ALIGN;	/* buffer read position */
+	uint32_t consumed;	/* total bytes consumed, SPSC or pow2 */
+
+	/* set up - starts a new cache line */
+	struct comp_dev *bypass_comp BUFFER_COLD_ALIGN; /* bypassed sink */
+	uint32_t parked;		/* branch beyond only copies silence */
+	uint32_t alloc_size;		/* allocated size in bytes */
 	spinlock_t lock;
+
+	/* IPC configuration */
+	struct sof_ipc_buffer ipc_buffer;
 };
 
 /* pipeline buffer creation and destruction */
 struct comp_buffer *buffer_new(struct sof_ipc_buffer *desc);
 void buffer_free(struct comp_buffer *buffer);
 
+/* replace buffer data with size bytes, buffer must not be running */
+int buffer_realloc(struct comp_buffer *buffer, uint32_t size);
+
+/* share the data of a fan-out group, buffer must not be running */
+void buffer_fanout_join(struct comp_buffer *group, struct comp_buffer *buffer);
+
+/* fan-out helpers for the inline calls below */
+uint32_t buffer_fanout_free_bytes(struct comp_buffer *buffer);
+void buffer_fanout_reset_pos(struct comp_buffer *buffer);
+uint32_t buffer_loopback_avail_bytes(struct comp_buffer *buffer);
+
+/* let loopback readers of the group trail its playback DAI reader */
+void buffer_loopback_update(struct comp_buffer *buffer);
+
+/* bytes a loopback reader is behind the playback DAI output */
+uint32_t buffer_loopback_delay(struct comp_buffer *buffer);
+
 /* called by a component after producing data into this buffer */
 void comp_update_buffer_produce(struct comp_buffer *buffer, uint32_t bytes);
 
 /* called by a component after consuming data from this buffer */
 void comp_update_buffer_consume(struct comp_buffer *buffer, uint32_t bytes);
 
+/* check the bytes at the read position are all zero */
+bool buffer_is_silent(struct comp_buffer *buffer, uint32_t bytes);
+
+/* ramp the frames at the read position in from silence */
+void buffer_fade_in(struct comp_buffer *buffer, uint32_t frames,
+		    uint32_t channels, enum sof_ipc_frame frame_fmt);
+
 static inline void buffer_zero(struct comp_buffer *buffer)
 {
 	tracev_buffer("buffer_zero()");
 
 	bzero(buffer->addr, buffer->size);
-	if (buffer->ipc_buffer.caps & SOF_MEM_CAPS_DMA)
+	if (buffer->caps & SOF_MEM_CAPS_DMA)
 		dcache_writeback_region(buffer->addr, buffer->size);
 }
 
+/* zero bytes from ptr, wrapping at the buffer end */
+static inline void buffer_zero_bytes(struct comp_buffer *buffer, void *ptr,
+				     uint32_t bytes)
+{
+	uint32_t head = bytes;
+
+	if (ptr + bytes > buffer->end_addr)
+		head = buffer->end_addr - ptr;
+
+	bzero(ptr, head);
+	if (buffer->caps & SOF_MEM_CAPS_DMA)
+		dcache_writeback_region(ptr, head);
+
+	if (head < bytes) {
+		bzero(buffer->addr, bytes - head);
+		if (buffer->caps & SOF_MEM_CAPS_DMA)
+			dcache_writeback_region(buffer->addr, bytes - head);
+	}
+}
+
+/* shared buffers are uncached and need no cache maintenance */
+static inline int buffer_is_shared(struct comp_buffer *buffer)
+{
+	return buffer->caps & SOF_MEM_CAPS_SHARED;
+}
+
+/* get the number of bytes available for reading - called by consumer */
+static inline uint32_t buffer_reader_avail_bytes(struct comp_buffer *buffer)
+{
+	if (!buffer->spsc && !buffer->mask)
+		return buffer->avail;
+
+	/* producer position may have been updated by another core */
+	if (buffer->spsc && !buffer_is_shared(buffer))
+		dcache_invalidate_region(&buffer->w_ptr,
+					 sizeof(buffer->w_ptr) +
+					 sizeof(buffer->produced));
+
+	return buffer->produced - buffer->consumed;
+}
+
+/* loopback readers only see data once it has been played */
+static inline uint32_t comp_buffer_get_avail_bytes(struct comp_buffer *buffer)
+{
+	if (buffer->trail)
+		return buffer_loopback_avail_bytes(buffer);
+
+	return buffer_reader_avail_bytes(buffer);
+}
+
+/* get the number of bytes free for writing - called by producer */
+static inline uint32_t buffer_reader_free_bytes(struct comp_buffer *buffer)
+{
+	if (!buffer->spsc && !buffer->mask)
+		return buffer->free;
+
+	/* consumer position may have been updated by another core */
+	if (buffer->spsc && !buffer_is_shared(buffer))
+		dcache_invalidate_region(&buffer->r_ptr,
+					 sizeof(buffer->r_ptr) +
+					 sizeof(buffer->consumed));
+
+	return buffer->size - (buffer->produced - buffer->consumed);
+}
+
+/* fan-out writers are held back by their slowest reader */
+static inline uint32_t comp_buffer_get_free_bytes(struct comp_buffer *buffer)
+{
+	if (buffer->next_reader)
+		return buffer_fanout_free_bytes(buffer);
+
+	return buffer_reader_free_bytes(buffer);
+}
+
 /* get the max number of bytes that can be copied between sink and source */
 static inline int comp_buffer_can_copy_bytes(struct comp_buffer *source,
 	struct comp_buffer *sink, uint32_t bytes)
 {
 	/* check for underrun */
-	if (source->avail < bytes)
+	if (comp_buffer_get_avail_bytes(source) < bytes)
 		return -1;
 
 	/* check for overrun */
-	if (sink->free < bytes)
+	if (comp_buffer_get_free_bytes(sink) < bytes)
 		return 1;
 
 	/* we are good to copy */
@@ -113,14 +247,78 @@ static inline int comp_buffer_can_copy_bytes(struct comp_buffer *source,
 static inline uint32_t comp_buffer_get_copy_bytes(struct comp_buffer *source,
 	struct comp_buffer *sink)
 {
-	if (source->avail > sink->free)
-		return sink->free;
+	uint32_t avail = comp_buffer_get_avail_bytes(source);
+	uint32_t free = comp_buffer_get_free_bytes(sink);
+
+	if (avail > free)
+		return free;
 	else
-		return source->avail;
+		return avail;
+}
+
+/*
+ * Wrap aware segment iteration. Kernels run branch free inner loops over the
+ * largest region that is contiguous in the buffers they touch and only wrap
+ * their pointers once per segment, e.g.
+ *
+ *	while (samples) {
+ *		n = buffer_segment_samples(source, src, src_bytes,
+ *					   sink, dst, dst_bytes, samples);
+ *		kernel(dst, src, n);
+ *		src = buffer_wrap(source, src + n * src_bytes);
+ *		dst = buffer_wrap(sink, dst + n * dst_bytes);
+ *		samples -= n;
+ *	}
+ */
+
+/* get the number of bytes from ptr until the buffer wraps */
+static inline uint32_t buffer_bytes_to_wrap(struct comp_buffer *buffer,
+					    const void *ptr)
+{
+	return (const uint8_t *)buffer->end_addr - (const uint8_t *)ptr;
+}
+
+/* wrap a pointer that has been advanced up to or past the buffer end */
+static inline void *buffer_wrap(struct comp_buffer *buffer, void *ptr)
+{
+	if (ptr >= buffer->end_addr)
+		ptr = (uint8_t *)ptr - buffer->size;
+
+	return ptr;
+}
+
+/* get the number of contiguous samples at ptr, at most samples */
+static inline uint32_t buffer_wrap_samples(struct comp_buffer *buffer,
+					   const void *ptr,
+					   uint32_t sample_bytes,
+					   uint32_t samples)
+{
+	return MIN(samples, buffer_bytes_to_wrap(buffer, ptr) / sample_bytes);
+}
+
+/* get the number of samples contiguous in both source and sink */
+static inline uint32_t buffer_segment_samples(struct comp_buffer *source,
+					      const void *src,
+					      uint32_t source_sample_bytes,
+					      struct comp_buffer *sink,
+					      const void *dst,
+					      uint32_t sink_sample_bytes,
+					      uint32_t samples)
+{
+	samples = buffer_wrap_samples(source, src, source_sample_bytes,
+				      samples);
+
+	return buffer_wrap_samples(sink, dst, sink_sample_bytes, samples);
 }
 
 static inline void buffer_reset_pos(struct comp_buffer *buffer)
 {
+	/* fan-out readers restart at the write position of the group */
+	if (buffer->next_reader) {
+		buffer_fanout_reset_pos(buffer);
+		return;
+	}
+
 	/* reset read and write pointer to buffer bas */
 	buffer->w_ptr = buffer->r_ptr = buffer->addr;
 
@@ -129,23 +327,88 @@ static inline void buffer_reset_pos(struct comp_buffer *buffer)
 
 	/* ther are no avail samples at reset */
 	buffer->avail = 0;
+	buffer->produced = 0;
+	buffer->consumed = 0;
 
-	/* clear buffer contents */
-	buffer_zero(buffer);
+	/* readers only see produced data, so contents are cleared lazily by
+	 * whoever reads ahead of the writer unless the buffer asks for it
+	 */
+	if (buffer->caps & SOF_MEM_CAPS_ZERO)
+		buffer_zero(buffer);
+}
+
+/*
+ * Buffers created with SOF_MEM_CAPS_POW2 track their positions with free
+ * running byte counters while the runtime size is a power of two. The read
+ * and write positions are then the counters masked with size - 1 and avail
+ * and free are a single subtraction, so updates need neither wrap compares
+ * nor the lock. Other sizes fall back to pointer compares.
+ */
+static inline void buffer_set_mask(struct comp_buffer *buffer)
+{
+	uint32_t avail = buffer_reader_avail_bytes(buffer);
+
+	if (!(buffer->caps & SOF_MEM_CAPS_POW2) ||
+	    (buffer->size & (buffer->size - 1))) {
+		buffer->mask = 0;
+		buffer->avail = avail;
+		buffer->free = buffer->size - avail;
+		return;
+	}
+
+	/* counters keep the positions, only their difference matters */
+	buffer->mask = buffer->size - 1;
+	buffer->consumed = buffer->r_ptr - buffer->addr;
+	buffer->produced = buffer->consumed + avail;
 }
 
 /* set the runtime size of a buffer in bytes and improve the data cache */
 /* performance by only using minimum space needed for runtime params */
 static inline int buffer_set_size(struct comp_buffer *buffer, uint32_t size)
 {
-	if (size > buffer->alloc_size)
-		return -ENOMEM;
+	struct comp_buffer *reader = buffer;
+	int ret;
+
 	if (size == 0)
 		return -EINVAL;
 
-	buffer->end_addr = buffer->addr + size;
-	buffer->size = size;
+	/* grow the allocation when it can be replaced */
+	if (size > buffer->alloc_size) {
+		ret = buffer_realloc(buffer, size);
+		if (ret < 0)
+			return ret;
+	}
+
+	/* fan-out readers share one size */
+	do {
+		reader->end_addr = reader->addr + size;
+		reader->size = size;
+		buffer_set_mask(reader);
+		reader = reader->next_reader;
+	} while (reader && reader != buffer);
+
 	return 0;
 }
 
+/*
+ * Switch buffer to lock free single producer/single consumer mode. The
+ * producer then only updates the write position and the consumer only
+ * the read position, avail and free are calculated from both.
+ * Must be called before the buffer is used by both sides.
+ */
+static inline void buffer_set_spsc(struct comp_buffer *buffer)
+{
+	/* power of two buffers already count their positions */
+	if (!buffer->mask) {
+		buffer->produced = buffer->avail;
+		buffer->consumed = 0;
+	}
+	buffer->spsc = 1;
+
+	/* from now on only produced and consumed bytes are synced */
+	if (!buffer_is_shared(buffer))
+		dcache_writeback_invalidate_region(buffer->addr,
+						   buffer->size);
+}
+
 #endif
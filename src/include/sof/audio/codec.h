@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Liam Girdwood <liam.r.girdwood@linux.intel.com>
+ */
+
+/**
+ * \file include/sof/audio/codec.h
+ * \brief Codec library plug-in interface for the decoder component
+ *
+ * A codec library fills in a codec_driver and registers it with
+ * codec_register() once the audio components have been initialised. The
+ * decoder component looks codecs up by the codec_id of its IPC and never
+ * calls into a library outside of its own copy, prepare and reset.
+ */
+
+#ifndef __INCLUDE_AUDIO_CODEC_H__
+#define __INCLUDE_AUDIO_CODEC_H__
+
+#include <stdint.h>
+#include <sof/list.h>
+
+/** \brief PCM format the codec decodes to. */
+struct codec_params {
+	uint32_t channels;	/**< interleaved channels */
+	uint32_t rate;		/**< frames per second */
+	uint32_t sample_bytes;	/**< container bytes of one sample */
+};
+
+/** \brief Codec library operations. */
+struct codec_ops {
+	/**
+	 * Creates a codec instance for the PCM format.
+	 * \param[out] priv Codec instance.
+	 * \param[in] params PCM format of the decoded stream.
+	 * \return 0 on success, negative error otherwise.
+	 */
+	int (*init)(void **priv, const struct codec_params *params);
+
+	/**
+	 * Decodes at most one compressed frame.
+	 * \param[in] priv Codec instance.
+	 * \param[in] in Compressed data, starting at a frame boundary once
+	 *	     the codec has synchronised.
+	 * \param[in] in_bytes Bytes of compressed data.
+	 * \param[out] consumed Compressed bytes used, including any skipped
+	 *		while searching for a frame header.
+	 * \param[out] out Interleaved PCM.
+	 * \param[in] out_bytes Room for PCM, at least max_frame_samples
+	 *		  frames.
+	 * \param[out] produced PCM bytes written.
+	 * \return 0 on success, -ENODATA if in holds no whole frame, other
+	 *	   negative error if the frame could not be decoded.
+	 */
+	int (*decode)(void *priv, const void *in, uint32_t in_bytes,
+		      uint32_t *consumed, void *out, uint32_t out_bytes,
+		      uint32_t *produced);
+
+	/**
+	 * Frees the codec instance.
+	 * \param[in] priv Codec instance.
+	 */
+	void (*free)(void *priv);
+};
+
+/** \brief Codec library driver. */
+struct codec_driver {
+	uint32_t id;			/**< SOF_IPC_CODEC_ */
+	uint32_t max_frame_bytes;	/**< largest compressed frame */
+	uint32_t max_frame_samples;	/**< most PCM frames per frame */
+
+	struct codec_ops ops;		/**< codec operations */
+
+	struct list_item list;		/**< list of codec drivers */
+};
+
+/**
+ * \brief Registers a codec library with the decoder component.
+ * \param[in] drv Codec driver.
+ * \return 0 on success, -EEXIST if the codec id is already registered.
+ */
+int codec_register(struct codec_driver *drv);
+
+/**
+ * \brief Unregisters a codec library, no decoder may be using it.
+ * \param[in] drv Codec driver.
+ */
+void codec_unregister(struct codec_driver *drv);
+
+#endif /* __INCLUDE_AUDIO_CODEC_H__ */
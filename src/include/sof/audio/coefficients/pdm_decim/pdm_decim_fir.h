@@ -29,6 +29,8 @@
  *
  */
 
+#include <sof/sof.h>
+
 /* Format for generated coefficients tables */
 
 struct pdm_decim {
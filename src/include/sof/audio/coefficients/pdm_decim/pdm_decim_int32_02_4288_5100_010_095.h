@@ -1,4 +1,4 @@
-const int32_t fir_int32_02_4288_5100_010_095[91] = {
+const int32_t fir_int32_02_4288_5100_010_095[91] __cold_rodata = {
 	-193886,
 	104552,
 	2140521,
@@ -1,4 +1,4 @@
-const int32_t fir_int32_02_4375_5100_010_095[101] = {
+const int32_t fir_int32_02_4375_5100_010_095[101] __cold_rodata = {
 	-587830,
 	-2653881,
 	-5154608,
@@ -1,4 +1,4 @@
-const int32_t fir_int32_03_3850_5100_010_095[93] = {
+const int32_t fir_int32_03_3850_5100_010_095[93] __cold_rodata = {
 	44212,
 	-302176,
 	-1360920,
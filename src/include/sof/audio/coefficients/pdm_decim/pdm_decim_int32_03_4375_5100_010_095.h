@@ -1,4 +1,4 @@
-const int32_t fir_int32_03_4375_5100_010_095[157] = {
+const int32_t fir_int32_03_4375_5100_010_095[157] __cold_rodata = {
 	350904,
 	1127891,
 	2233546,
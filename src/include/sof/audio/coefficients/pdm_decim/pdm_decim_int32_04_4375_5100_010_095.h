@@ -1,4 +1,4 @@
-const int32_t fir_int32_04_4375_5100_010_095[211] = {
+const int32_t fir_int32_04_4375_5100_010_095[211] __cold_rodata = {
 	126017,
 	745791,
 	1735783,
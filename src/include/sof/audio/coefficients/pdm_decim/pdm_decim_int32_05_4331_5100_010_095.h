@@ -1,4 +1,4 @@
-const int32_t fir_int32_05_4331_5100_010_095[251] = {
+const int32_t fir_int32_05_4331_5100_010_095[251] __cold_rodata = {
 	-250963,
 	-530472,
 	-956449,
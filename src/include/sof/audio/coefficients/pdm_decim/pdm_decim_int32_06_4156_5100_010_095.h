@@ -1,4 +1,4 @@
-const int32_t fir_int32_06_4156_5100_010_095[249] = {
+const int32_t fir_int32_06_4156_5100_010_095[249] __cold_rodata = {
 	-145670,
 	-159762,
 	-183049,
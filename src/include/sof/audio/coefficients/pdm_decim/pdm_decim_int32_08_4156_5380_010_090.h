@@ -1,4 +1,4 @@
-const int32_t fir_int32_08_4156_5380_010_090[247] = {
+const int32_t fir_int32_08_4156_5380_010_090[247] __cold_rodata = {
 	-337052,
 	-90075,
 	37780,
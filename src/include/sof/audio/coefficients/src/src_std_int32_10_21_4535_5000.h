@@ -1,4 +1,4 @@
-const int32_t src_int32_10_21_4535_5000_fir[1720] = {
+const int32_t src_int32_10_21_4535_5000_fir[1720] __cold_rodata = {
 	68636,
 	149235,
 	-55047,
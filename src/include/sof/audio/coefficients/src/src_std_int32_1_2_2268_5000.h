@@ -1,4 +1,4 @@
-const int32_t src_int32_1_2_2268_5000_fir[40] = {
+const int32_t src_int32_1_2_2268_5000_fir[40] __cold_rodata = {
 	-108687,
 	1104325,
 	2453723,
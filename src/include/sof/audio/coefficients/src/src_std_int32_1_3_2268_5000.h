@@ -1,4 +1,4 @@
-const int32_t src_int32_1_3_2268_5000_fir[56] = {
+const int32_t src_int32_1_3_2268_5000_fir[56] __cold_rodata = {
 	674119,
 	1447898,
 	1237177,
@@ -1,4 +1,4 @@
-const int32_t src_int32_1_3_4535_5000_fir[268] = {
+const int32_t src_int32_1_3_4535_5000_fir[268] __cold_rodata = {
 	59807,
 	-3582,
 	-87792,
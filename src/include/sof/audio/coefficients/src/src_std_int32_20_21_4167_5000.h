@@ -1,4 +1,4 @@
-const int32_t src_int32_20_21_4167_5000_fir[1120] = {
+const int32_t src_int32_20_21_4167_5000_fir[1120] __cold_rodata = {
 	133310,
 	-340215,
 	608388,
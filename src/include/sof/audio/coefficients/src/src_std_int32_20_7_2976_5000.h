@@ -1,4 +1,4 @@
-const int32_t src_int32_20_7_2976_5000_fir[480] = {
+const int32_t src_int32_20_7_2976_5000_fir[480] __cold_rodata = {
 	-288033,
 	1508749,
 	-2789929,
@@ -1,4 +1,4 @@
-const int32_t src_int32_21_20_4167_5000_fir[1092] = {
+const int32_t src_int32_21_20_4167_5000_fir[1092] __cold_rodata = {
 	-157112,
 	268181,
 	-317732,
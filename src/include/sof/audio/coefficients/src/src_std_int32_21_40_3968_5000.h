@@ -1,4 +1,4 @@
-const int32_t src_int32_21_40_3968_5000_fir[1596] = {
+const int32_t src_int32_21_40_3968_5000_fir[1596] __cold_rodata = {
 	-222852,
 	-304844,
 	500459,
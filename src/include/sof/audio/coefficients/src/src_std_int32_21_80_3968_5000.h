@@ -1,4 +1,4 @@
-const int32_t src_int32_21_80_3968_5000_fir[3108] = {
+const int32_t src_int32_21_80_3968_5000_fir[3108] __cold_rodata = {
 	-184314,
 	2195,
 	327479,
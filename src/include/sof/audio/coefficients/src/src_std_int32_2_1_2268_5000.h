@@ -1,4 +1,4 @@
-const int32_t src_int32_2_1_2268_5000_fir[40] = {
+const int32_t src_int32_2_1_2268_5000_fir[40] __cold_rodata = {
 	-108687,
 	2453723,
 	-7534526,
@@ -1,4 +1,4 @@
-const int32_t src_int32_2_1_4535_5000_fir[200] = {
+const int32_t src_int32_2_1_4535_5000_fir[200] __cold_rodata = {
 	-89324,
 	147424,
 	-221148,
@@ -1,4 +1,4 @@
-const int32_t src_int32_2_3_4535_5000_fir[272] = {
+const int32_t src_int32_2_3_4535_5000_fir[272] __cold_rodata = {
 	14032,
 	81534,
 	-114276,
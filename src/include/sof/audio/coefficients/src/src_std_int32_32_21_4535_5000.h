@@ -1,4 +1,4 @@
-const int32_t src_int32_32_21_4535_5000_fir[2816] = {
+const int32_t src_int32_32_21_4535_5000_fir[2816] __cold_rodata = {
 	-79545,
 	104644,
 	-116025,
@@ -1,4 +1,4 @@
-const int32_t src_int32_3_1_2268_5000_fir[60] = {
+const int32_t src_int32_3_1_2268_5000_fir[60] __cold_rodata = {
 	-186848,
 	2587637,
 	-6788781,
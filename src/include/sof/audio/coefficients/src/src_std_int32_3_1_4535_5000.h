@@ -1,4 +1,4 @@
-const int32_t src_int32_3_1_4535_5000_fir[276] = {
+const int32_t src_int32_3_1_4535_5000_fir[276] __cold_rodata = {
 	-103811,
 	157671,
 	-215287,
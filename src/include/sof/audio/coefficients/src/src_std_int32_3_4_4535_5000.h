@@ -1,4 +1,4 @@
-const int32_t src_int32_3_4_4535_5000_fir[348] = {
+const int32_t src_int32_3_4_4535_5000_fir[348] __cold_rodata = {
 	-49725,
 	130356,
 	-122368,
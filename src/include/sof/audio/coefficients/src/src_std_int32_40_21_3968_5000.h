@@ -1,4 +1,4 @@
-const int32_t src_int32_40_21_3968_5000_fir[1600] = {
+const int32_t src_int32_40_21_3968_5000_fir[1600] __cold_rodata = {
 	-189418,
 	305314,
 	-164783,
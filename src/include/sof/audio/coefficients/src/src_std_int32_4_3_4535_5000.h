@@ -1,4 +1,4 @@
-const int32_t src_int32_4_3_4535_5000_fir[352] = {
+const int32_t src_int32_4_3_4535_5000_fir[352] __cold_rodata = {
 	-103639,
 	150956,
 	-193978,
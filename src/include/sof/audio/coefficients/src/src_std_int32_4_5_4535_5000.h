@@ -1,4 +1,4 @@
-const int32_t src_int32_4_5_4535_5000_fir[448] = {
+const int32_t src_int32_4_5_4535_5000_fir[448] __cold_rodata = {
 	75403,
 	-102497,
 	52393,
@@ -1,4 +1,4 @@
-const int32_t src_int32_5_4_4535_5000_fir[440] = {
+const int32_t src_int32_5_4_4535_5000_fir[440] __cold_rodata = {
 	-88511,
 	130537,
 	-169986,
@@ -1,4 +1,4 @@
-const int32_t src_int32_5_6_4354_5000_fir[380] = {
+const int32_t src_int32_5_6_4354_5000_fir[380] __cold_rodata = {
 	-117308,
 	214584,
 	-191918,
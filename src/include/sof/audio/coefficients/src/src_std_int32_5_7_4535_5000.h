@@ -1,4 +1,4 @@
-const int32_t src_int32_5_7_4535_5000_fir[580] = {
+const int32_t src_int32_5_7_4535_5000_fir[580] __cold_rodata = {
 	-40736,
 	108070,
 	-76414,
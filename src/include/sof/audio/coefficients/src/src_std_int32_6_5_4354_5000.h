@@ -1,4 +1,4 @@
-const int32_t src_int32_6_5_4354_5000_fir[384] = {
+const int32_t src_int32_6_5_4354_5000_fir[384] __cold_rodata = {
 	-129975,
 	208244,
 	-264531,
@@ -1,4 +1,4 @@
-const int32_t src_int32_7_8_4535_5000_fir[644] = {
+const int32_t src_int32_7_8_4535_5000_fir[644] __cold_rodata = {
 	-1066,
 	-101721,
 	256848,
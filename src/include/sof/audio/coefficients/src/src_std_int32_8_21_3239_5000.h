@@ -1,4 +1,4 @@
-const int32_t src_int32_8_21_3239_5000_fir[480] = {
+const int32_t src_int32_8_21_3239_5000_fir[480] __cold_rodata = {
 	-158031,
 	312746,
 	1134667,
@@ -1,4 +1,4 @@
-const int32_t src_int32_8_7_2468_5000_fir[160] = {
+const int32_t src_int32_8_7_2468_5000_fir[160] __cold_rodata = {
 	-447307,
 	2508809,
 	-3105790,
@@ -1,4 +1,4 @@
-const int32_t src_int32_8_7_4535_5000_fir[640] = {
+const int32_t src_int32_8_7_4535_5000_fir[640] __cold_rodata = {
 	-98913,
 	133113,
 	-146641,
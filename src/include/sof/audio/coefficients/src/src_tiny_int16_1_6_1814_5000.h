@@ -1,4 +1,4 @@
-const int16_t src_int16_1_6_1814_5000_fir[92] = {
+const int16_t src_int16_1_6_1814_5000_fir[92] __cold_rodata = {
 	-4,
 	0,
 	11,
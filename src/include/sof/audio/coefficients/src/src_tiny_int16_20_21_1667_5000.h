@@ -1,4 +1,4 @@
-const int16_t src_int16_20_21_1667_5000_fir[320] = {
+const int16_t src_int16_20_21_1667_5000_fir[320] __cold_rodata = {
 	2,
 	52,
 	-184,
@@ -1,4 +1,4 @@
-const int16_t src_int16_21_20_1667_5000_fir[336] = {
+const int16_t src_int16_21_20_1667_5000_fir[336] __cold_rodata = {
 	-4,
 	65,
 	-92,
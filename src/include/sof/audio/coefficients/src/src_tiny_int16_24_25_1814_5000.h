@@ -1,4 +1,4 @@
-const int16_t src_int16_24_25_1814_5000_fir[480] = {
+const int16_t src_int16_24_25_1814_5000_fir[480] __cold_rodata = {
 	6,
 	-36,
 	-13,
@@ -1,4 +1,4 @@
-const int16_t src_int16_25_24_1814_5000_fir[400] = {
+const int16_t src_int16_25_24_1814_5000_fir[400] __cold_rodata = {
 	-7,
 	66,
 	-49,
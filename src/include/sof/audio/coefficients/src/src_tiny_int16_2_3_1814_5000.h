@@ -1,4 +1,4 @@
-const int16_t src_int16_2_3_1814_5000_fir[48] = {
+const int16_t src_int16_2_3_1814_5000_fir[48] __cold_rodata = {
 	-10,
 	23,
 	141,
@@ -1,4 +1,4 @@
-const int16_t src_int16_3_2_1814_5000_fir[48] = {
+const int16_t src_int16_3_2_1814_5000_fir[48] __cold_rodata = {
 	-7,
 	65,
 	-31,
@@ -1,4 +1,4 @@
-const int16_t src_int16_6_1_1814_5000_fir[96] = {
+const int16_t src_int16_6_1_1814_5000_fir[96] __cold_rodata = {
 	-8,
 	59,
 	-2,
@@ -1,4 +1,4 @@
-const int16_t src_int16_7_8_1814_5000_fir[140] = {
+const int16_t src_int16_7_8_1814_5000_fir[140] __cold_rodata = {
 	-3,
 	-30,
 	99,
@@ -1,4 +1,4 @@
-const int16_t src_int16_8_7_1814_5000_fir[128] = {
+const int16_t src_int16_8_7_1814_5000_fir[128] __cold_rodata = {
 	-8,
 	58,
 	0,
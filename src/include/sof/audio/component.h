@@ -34,11 +34,13 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <stdbool.h>
 #include <sof/lock.h>
 #include <sof/list.h>
 #include <sof/sof.h>
 #include <sof/alloc.h>
 #include <sof/dma.h>
+#include <sof/platform.h>
 #include <sof/stream.h>
 #include <sof/audio/buffer.h>
 #include <sof/audio/pipeline.h>
@@ -123,6 +125,10 @@
 #define COMP_CACHE_WRITEBACK_INV	0
 /* invalidate component data */
 #define COMP_CACHE_INVALIDATE		1
+/* lock component coefficients into the data cache */
+#define COMP_CACHE_LOCK			2
+/* unlock component coefficients from the data cache */
+#define COMP_CACHE_UNLOCK		3
 
 /* component operations */
 #define COMP_OPS_PARAMS		0
@@ -176,6 +182,10 @@ struct comp_ops {
 	/* copy and process stream data from source to sink buffers */
 	int (*copy)(struct comp_dev *dev);
 
+	/* process bytes of new data at ptr in the buffer in place */
+	int (*copy_inplace)(struct comp_dev *dev, struct comp_buffer *buffer,
+			    void *ptr, uint32_t bytes);
+
 	/* host buffer config */
 	int (*host_buffer)(struct comp_dev *dev,
 			   struct dma_sg_elem_array *elem_array,
@@ -200,36 +210,71 @@ struct comp_driver {
 	struct list_item list;	/* list of component drivers */
 };	
 
+/* component copy() performance counters in platform timer ticks */
+struct comp_perf {
+	uint32_t count;			/* number of copy() calls */
+	uint32_t min;			/* fastest copy() */
+	uint32_t max;			/* slowest copy() */
+	uint64_t total;			/* total time spent in copy() */
+};
+
+/* the set up part of comp_dev starts on a new cache line */
+#define COMP_COLD_ALIGN	__attribute__ ((__aligned__(PLATFORM_DCACHE_ALIGN)))
+
 /* audio component base device "class" - used by other component types */
 struct comp_dev {
 
-	/* runtime */
+	/* runtime - read by every pipeline walk and copy, kept together at the
+	 * start of the object to fit the first cache line
+	 */
 	uint16_t state;			/* COMP_STATE_ */
-	uint16_t is_endpoint;		/* component is end point in pipeline */
-	uint16_t is_dma_connected;	/* component is connected to DMA */
-	spinlock_t lock;		/* lock for this component */
-	uint64_t position;		/* component rendering position */
+	uint8_t is_endpoint;		/* component is end point in pipeline */
+	uint8_t is_dma_connected;	/* component is connected to DMA */
+	uint8_t can_bypass;		/* prepared with nothing to process */
+	uint8_t can_inplace;		/* can process its source in place */
+	uint8_t can_schedule;		/* copy applies scheduled events */
+	uint8_t can_idle;		/* silent source makes a silent sink */
+	uint8_t can_pull;		/* copy can process partial blocks */
+	uint8_t pull;			/* copy is driven by sink free space */
+	uint8_t polled;			/* copy polls its DMA, no period IRQ */
 	uint32_t frames;		/* number of frames we copy to sink */
 	uint32_t frame_bytes;		/* frames size copied to sink in bytes */
 	struct pipeline *pipeline;	/* pipeline we belong to */
-
-	/* common runtime configuration for downstream/upstream */
-	struct sof_ipc_stream_params params;
-
-	/* driver */
-	struct comp_driver *drv;
-
-	/* lists */
+	struct comp_driver *drv;	/* driver */
+	void *private;			/* private data - core does not touch this */
 	struct list_item bsource_list;	/* list of source buffers */
 	struct list_item bsink_list;	/* list of sink buffers */
+	struct list_item event_list;	/* control events, see comp_event_run() */
+	uint64_t position;		/* component rendering position */
+
+	/* set up and control - starts a new cache line */
+	uint64_t event_position COMP_COLD_ALIGN; /* frames copied since reset */
+	uint32_t min_source_bytes;	/* source buffer need, set in params() */
+	uint32_t min_sink_bytes;	/* sink buffer need, set in params() */
+	spinlock_t lock;		/* lock for this component */
+
+#ifdef CONFIG_PERFORMANCE_COUNTERS
+	/* copy() timing - updated by the pipeline on every copy */
+	struct comp_perf perf;
+#endif
 
-	/* private data - core does not touch this */
-	void *private;		/* private data */
+	/* common runtime configuration for downstream/upstream */
+	struct sof_ipc_stream_params params;
 
 	/* IPC config object header - MUST be at end as it's variable size/type */
 	struct sof_ipc_comp comp;
 };
 
+/* control change queued for a frame position of the component */
+struct comp_event {
+	struct list_item list;		/* in comp_dev event_list */
+	uint64_t position;		/* frames copied before it applies */
+	int cmd;			/* COMP_CMD_SET_VALUE or _SET_DATA */
+
+	/* IPC control data - MUST be at end as it's variable size */
+	struct sof_ipc_ctrl_data data;
+};
+
 #define COMP_SIZE(x) \
 	(sizeof(struct comp_dev) - sizeof(struct sof_ipc_comp) + sizeof(x))
 #define COMP_GET_IPC(dev, type) \
@@ -248,14 +293,24 @@ typedef void (*cache_command)(void *, size_t);
 
 void sys_comp_init(void);
 
+/* Control blobs with the same content are shared by the components using
+ * them, e.g. the EQ instances of a topology with the same coefficients.
+ * The returned copy is read only, a component changing its configuration
+ * gets a new blob for the changed content and puts the old one.
+ */
+void *comp_blob_get(const void *data, size_t size);
+void comp_blob_put(void *blob);
+
 /* component registration */
 int comp_register(struct comp_driver *drv);
 void comp_unregister(struct comp_driver *drv);
 
 /* component creation and destruction - mandatory */
 struct comp_dev *comp_new(struct sof_ipc_comp *comp);
+void comp_event_flush(struct comp_dev *dev);
 static inline void comp_free(struct comp_dev *dev)
 {
+	comp_event_flush(dev);
 	dev->drv->ops.free(dev);
 }
 
@@ -319,12 +374,56 @@ static inline int comp_copy(struct comp_dev *dev)
 	return dev->drv->ops.copy(dev);
 }
 
+/* process buffer data in place - optional */
+static inline int comp_copy_inplace(struct comp_dev *dev,
+				    struct comp_buffer *buffer, void *ptr,
+				    uint32_t bytes)
+{
+	if (dev->drv->ops.copy_inplace)
+		return dev->drv->ops.copy_inplace(dev, buffer, ptr, bytes);
+	return 0;
+}
+
+#ifdef CONFIG_PERFORMANCE_COUNTERS
+/* reset component copy() performance counters */
+static inline void comp_perf_reset(struct comp_dev *dev)
+{
+	dev->perf.count = 0;
+	dev->perf.min = UINT32_MAX;
+	dev->perf.max = 0;
+	dev->perf.total = 0;
+}
+#endif
+
 /* component reset and free runtime resources -mandatory  */
 static inline int comp_reset(struct comp_dev *dev)
 {
+	comp_event_flush(dev);
 	return dev->drv->ops.reset(dev);
 }
 
+/* scheduled control events, only for components with can_schedule */
+int comp_event_schedule(struct comp_dev *dev, uint64_t position, int cmd,
+			struct sof_ipc_ctrl_data *data);
+uint32_t comp_event_apply(struct comp_dev *dev, uint32_t frames);
+
+/*
+ * Applies the control events due at the current position and returns how
+ * many of the frames copy() can process before the next event. Copy calls
+ * comp_event_advance() after processing them and runs again for the rest.
+ */
+static inline uint32_t comp_event_run(struct comp_dev *dev, uint32_t frames)
+{
+	if (list_is_empty(&dev->event_list))
+		return frames;
+	return comp_event_apply(dev, frames);
+}
+
+static inline void comp_event_advance(struct comp_dev *dev, uint32_t frames)
+{
+	dev->event_position += frames;
+}
+
 /* DAI configuration - only mandatory for DAI components */
 static inline int comp_dai_config(struct comp_dev *dev,
 	struct sof_ipc_dai_config *config)
@@ -358,9 +457,16 @@ void sys_comp_mux_init(void);
 void sys_comp_switch_init(void);
 void sys_comp_volume_init(void);
 void sys_comp_src_init(void);
+void sys_comp_asrc_init(void);
+void sys_comp_conv_init(void);
 void sys_comp_tone_init(void);
 void sys_comp_eq_iir_init(void);
 void sys_comp_eq_fir_init(void);
+void sys_comp_drc_init(void);
+void sys_comp_kpb_init(void);
+void sys_comp_decoder_init(void);
+void sys_comp_voice_init(void);
+void sys_comp_crossover_init(void);
 
 /*
  * Convenience functions to install upstream/downstream common params. Only
@@ -410,23 +516,27 @@ static inline uint32_t comp_sample_bytes(struct comp_dev *dev)
 static inline void comp_underrun(struct comp_dev *dev, struct comp_buffer *source,
 	uint32_t copy_bytes, uint32_t min_bytes)
 {
+	uint32_t avail = comp_buffer_get_avail_bytes(source);
+
 	trace_comp("comp_underrun(), ((dev->comp.id << 16) | source->avail) ="
 		   " %u, ((min_bytes << 16) | copy_bytes) = %u",
-		  (dev->comp.id << 16) | source->avail,
+		  (dev->comp.id << 16) | avail,
 		  (min_bytes << 16) | copy_bytes);
 
-	pipeline_xrun(dev->pipeline, dev, (int32_t)source->avail - copy_bytes);
+	pipeline_xrun(dev->pipeline, dev, (int32_t)avail - copy_bytes);
 }
 
 static inline void comp_overrun(struct comp_dev *dev, struct comp_buffer *sink,
 	uint32_t copy_bytes, uint32_t min_bytes)
 {
+	uint32_t free = comp_buffer_get_free_bytes(sink);
+
 	trace_comp("comp_overrun(), ((dev->comp.id << 16) | sink->free) = %u, "
 		   "((min_bytes << 16) | copy_bytes) = %u",
-		  (dev->comp.id << 16) | sink->free,
+		  (dev->comp.id << 16) | free,
 		  (min_bytes << 16) | copy_bytes);
 
-	pipeline_xrun(dev->pipeline, dev, (int32_t)copy_bytes - sink->free);
+	pipeline_xrun(dev->pipeline, dev, (int32_t)copy_bytes - free);
 }
 
 static inline cache_command comp_get_cache_command(int cmd)
@@ -443,4 +553,80 @@ static inline cache_command comp_get_cache_command(int cmd)
 	}
 }
 
+/*
+ * Dirty range of a component data region such as a delay line. Components
+ * mark the bytes they write and their cache op writes back only what was
+ * marked since the previous writeback, so regions of a pipeline that did
+ * not run are skipped. Invalidation still covers the whole region because
+ * the writes of another core are not known.
+ */
+struct comp_dirty {
+	uint8_t *start;
+	uint8_t *end;
+};
+
+static inline void comp_dirty_clear(struct comp_dirty *dirty)
+{
+	dirty->start = NULL;
+	dirty->end = NULL;
+}
+
+/* extend the dirty range to cover bytes at ptr */
+static inline void comp_dirty_mark(struct comp_dirty *dirty, void *ptr,
+				   uint32_t bytes)
+{
+	uint8_t *start = ptr;
+	uint8_t *end = start + bytes;
+
+	if (!dirty->start || start < dirty->start)
+		dirty->start = start;
+	if (end > dirty->end)
+		dirty->end = end;
+}
+
+/* write back and invalidate the dirty range, then clear it */
+static inline void comp_dirty_writeback_inv(struct comp_dirty *dirty)
+{
+	if (dirty->end > dirty->start)
+		dcache_writeback_invalidate_region(dirty->start,
+						   dirty->end - dirty->start);
+
+	comp_dirty_clear(dirty);
+}
+
+/*
+ * Silence tracking for filter components. The consecutive silent input
+ * frames are counted and once they cover the decay time of the component,
+ * when its state holds nothing but zeros, it writes zeros instead of
+ * running its filters until input that is not silent arrives. Digital
+ * silence is exact zero so the check is an OR over the input samples.
+ */
+struct comp_silence {
+	uint32_t frames;	/* consecutive silent input frames */
+	uint32_t decay;		/* frames for the state to decay, 0 disables */
+	bool silent;		/* last checked input was silent */
+	bool skip;		/* processing of the last check is skipped */
+};
+
+static inline void comp_silence_init(struct comp_silence *silence,
+				     uint32_t decay)
+{
+	silence->frames = 0;
+	silence->decay = decay;
+	silence->silent = false;
+	silence->skip = false;
+}
+
+/* check bytes at the source read position, true if processing is skipped */
+bool comp_silence_check(struct comp_silence *silence,
+			struct comp_buffer *source, uint32_t bytes);
+
+/* count frames consumed from the checked input */
+static inline void comp_silence_count(struct comp_silence *silence,
+				      uint32_t frames)
+{
+	if (silence->silent && silence->frames < silence->decay)
+		silence->frames += frames;
+}
+
 #endif
@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * \file include/sof/audio/kernel.h
+ * \brief Generation of format and channel specialised processing kernels
+ *
+ * A component describes its processing once, as a per sample operation
+ * for every supported (source, sink) format pair. These macros expand that
+ * description into one kernel per pair and channel count, with the channel
+ * count known at compile time so the per frame loop can be fully unrolled,
+ * and into the map the component searches at prepare() time.
+ *
+ * Formats are named with the short tokens s16, s24 and s32 so they can be
+ * pasted into kernel and helper names, e.g. KERNEL_NAME(vol, s16, s32, 2)
+ * is vol_s16_to_s32_2ch.
+ *
+ * Channel counts without a specialised kernel are served by a kernel
+ * taking the count at run time, named with the channels token n and
+ * mapped with KERNEL_ANY_CHANNELS.
+ */
+
+#ifndef __INCLUDE_AUDIO_KERNEL_H__
+#define __INCLUDE_AUDIO_KERNEL_H__
+
+#include <stdint.h>
+#include <sof/preproc.h>
+#include <platform/platform.h>
+#include <uapi/ipc/stream.h>
+
+/* IPC frame format of each format token */
+#define KERNEL_FRAME_s16	SOF_IPC_FRAME_S16_LE
+#define KERNEL_FRAME_s24	SOF_IPC_FRAME_S24_4LE
+#define KERNEL_FRAME_s32	SOF_IPC_FRAME_S32_LE
+
+/* sample container type of each format token */
+#define KERNEL_SAMPLE_s16	int16_t
+#define KERNEL_SAMPLE_s24	int32_t
+#define KERNEL_SAMPLE_s32	int32_t
+
+/** \brief IPC frame format of format token fmt. */
+#define KERNEL_FRAME(fmt) META_CONCAT(KERNEL_FRAME_, fmt)
+
+/** \brief Sample container type of format token fmt. */
+#define KERNEL_SAMPLE(fmt) META_CONCAT(KERNEL_SAMPLE_, fmt)
+
+#define _KERNEL_NAME(prefix, source, sink, n) \
+	prefix##_##source##_to_##sink##_##n##ch
+
+/** \brief Name of the kernel of prefix for a format pair and channels. */
+#define KERNEL_NAME(prefix, source, sink, channels) \
+	_KERNEL_NAME(prefix, source, sink, channels)
+
+/** \brief Name of the per sample operation of prefix for a format pair. */
+#define KERNEL_SAMPLE_OP(prefix, source, sink) \
+	META_CONCAT(prefix, META_CONCAT(_##source##_to_, sink))
+
+/**
+ * \brief Map entry of a generated kernel.
+ *
+ * Matches the { source, sink, channels, func } layout of the component
+ * function maps.
+ */
+#define KERNEL_MAP_ENTRY(prefix, source, sink, channels) \
+	{ KERNEL_FRAME(source), KERNEL_FRAME(sink), channels, \
+	  KERNEL_NAME(prefix, source, sink, channels) },
+
+/** \brief Map channels of a kernel taking any channel count. */
+#define KERNEL_ANY_CHANNELS	0
+
+/** \brief Name of the any channel count kernel of prefix for a format pair. */
+#define KERNEL_NAME_ANY(prefix, source, sink) \
+	_KERNEL_NAME(prefix, source, sink, n)
+
+/** \brief Map entry of an any channel count kernel. */
+#define KERNEL_MAP_ENTRY_ANY(prefix, source, sink) \
+	{ KERNEL_FRAME(source), KERNEL_FRAME(sink), KERNEL_ANY_CHANNELS, \
+	  KERNEL_NAME_ANY(prefix, source, sink) },
+
+#define _KERNEL_CHANNELS_2(m, ...) \
+	m(1, __VA_ARGS__) \
+	m(2, __VA_ARGS__)
+
+#define _KERNEL_CHANNELS_4(m, ...) \
+	_KERNEL_CHANNELS_2(m, __VA_ARGS__) \
+	m(4, __VA_ARGS__)
+
+#define _KERNEL_CHANNELS_6(m, ...) \
+	_KERNEL_CHANNELS_4(m, __VA_ARGS__) \
+	m(6, __VA_ARGS__)
+
+#define _KERNEL_CHANNELS_8(m, ...) \
+	_KERNEL_CHANNELS_6(m, __VA_ARGS__) \
+	m(8, __VA_ARGS__)
+
+/**
+ * \brief Expands m(channels, ...) for every specialised channel count.
+ *
+ * Only the channel counts the platform can carry are generated so the
+ * kernels of smaller platforms do not grow with the channel list.
+ */
+#if PLATFORM_MAX_CHANNELS >= 8
+#define KERNEL_FOR_EACH_CHANNELS(m, ...) _KERNEL_CHANNELS_8(m, __VA_ARGS__)
+#elif PLATFORM_MAX_CHANNELS >= 6
+#define KERNEL_FOR_EACH_CHANNELS(m, ...) _KERNEL_CHANNELS_6(m, __VA_ARGS__)
+#elif PLATFORM_MAX_CHANNELS >= 4
+#define KERNEL_FOR_EACH_CHANNELS(m, ...) _KERNEL_CHANNELS_4(m, __VA_ARGS__)
+#else
+#define KERNEL_FOR_EACH_CHANNELS(m, ...) _KERNEL_CHANNELS_2(m, __VA_ARGS__)
+#endif
+
+#endif /* __INCLUDE_AUDIO_KERNEL_H__ */
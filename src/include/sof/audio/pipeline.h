@@ -41,6 +41,7 @@
 #include <sof/trace.h>
 #include <sof/schedule.h>
 #include <uapi/ipc/topology.h>
+#include <uapi/ipc/stream.h>
 
 /* pipeline tracing */
 #define trace_pipe(format, ...) \
@@ -67,12 +68,67 @@
 			     pipe_ptr->ipc_pipe.comp_id,	\
 			     format, ##__VA_ARGS__)
 
+#define tracehot_pipe(format, ...) \
+	tracehot_event(TRACE_CLASS_PIPE, format, ##__VA_ARGS__)
+#define tracehot_pipe_with_ids(pipe_ptr, format, ...)		\
+	tracehot_event_with_ids(TRACE_CLASS_PIPE,		\
+			     pipe_ptr->ipc_pipe.pipeline_id,	\
+			     pipe_ptr->ipc_pipe.comp_id,	\
+			     format, ##__VA_ARGS__)
+
 struct ipc_pipeline_dev;
 struct ipc;
+struct pipeline_arena;
+
+/* max periods batched in one run of a throughput pipeline */
+#define PIPELINE_MAX_PERIODS_PER_SCHED	32
+
+/* fewest periods in a buffer sized by pipeline params */
+#define PIPELINE_BUFFER_MIN_PERIODS	2
+
+/* max components in a compiled pipeline copy schedule */
+#define PIPELINE_SCHED_MAX_COMPS	16
+
+/* cycles the other cores may take to walk params or prepare branches */
+#define PIPELINE_BRANCH_TIMEOUT		8000000
+
+/* period groups per core and pipelines per group */
+#define PIPELINE_GROUPS			4
+#define PIPELINE_GROUP_MAX_PIPES	8
+
+/* params or prepare walk of a branch handed to the core that runs it */
+struct pipeline_branch {
+	struct comp_dev *start;		/* first component of the branch */
+	struct comp_buffer *buffer;	/* buffer start is reached through */
+	uint32_t op;			/* COMP_OPS_PARAMS or COMP_OPS_PREPARE */
+	uint32_t dir;			/* graph walk direction */
+	volatile uint32_t done;
+	volatile int32_t ret;
+};
+
+/* one component copy in pipeline execution order */
+struct pipeline_sched_entry {
+	struct comp_dev *dev;
+	int (*copy)(struct comp_dev *dev);	/* resolved dev copy() op */
+	struct comp_buffer *source;	/* only source, idle or pull mode */
+	struct comp_buffer *sink;	/* only sink, idle or pull mode */
+	uint32_t source_bytes;		/* period consumed by a copy */
+	uint32_t sink_bytes;		/* period produced by a copy */
+	uint32_t idle;			/* copy can be replaced by silence */
+	uint32_t parked;		/* fed by a parked buffer, copies silence */
+};
 
 /*
  * Audio pipeline.
  */
+/* active pipelines of one core and period run from one scheduler wakeup */
+struct pipeline_group {
+	struct task task;		/* runs the pending members */
+	struct pipeline *pipes[PIPELINE_GROUP_MAX_PIPES]; /* in copy order */
+	uint32_t count;			/* members, 0 for an unused group */
+	uint32_t deadline;		/* member period in microseconds */
+};
+
 struct pipeline {
 	spinlock_t lock;
 	struct sof_ipc_pipe_new ipc_pipe;
@@ -80,6 +136,7 @@ struct pipeline {
 	/* runtime status */
 	int32_t xrun_bytes;		/* last xrun length */
 	uint32_t status;		/* pipeline status */
+	struct comp_dev *ts_dai;	/* DAI timestamped with the host */
 
 	/* lists */
 	struct list_item comp_list;		/* list of components */
@@ -89,19 +146,54 @@ struct pipeline {
 	struct task pipe_task;		/* pipeline processing task */
 	struct comp_dev *sched_comp;	/* component that drives scheduling in this pipe */
 	struct comp_dev *source_comp;	/* source component for this pipe */
+	uint32_t timer_periods;		/* timer DMA periods not yet copied */
+	struct pipeline_group *group;	/* period group while active */
+	uint32_t group_pending;		/* copy requested from the group */
+	uint32_t polled;		/* task re-armed each period, no DMA IRQ */
 
 	/* position update */
 	uint32_t posn_offset;		/* position update array offset*/
+
+#ifdef CONFIG_STREAM_STATS
+	/* runtime statistics mirrored to the stream region */
+	uint32_t stats_offset;		/* stats slot offset, 0 if none */
+	struct sof_ipc_stream_stats stats;
+	struct comp_buffer *stats_buffer[SOF_IPC_STREAM_STATS_BUFFERS];
+#endif
+
+	/* component runtime memory, see pipeline_arena_alloc() */
+	struct pipeline_arena *arena;
+
+	/* copy order of the active graph, 0 entries walks the graph */
+	struct pipeline_sched_entry sched[PIPELINE_SCHED_MAX_COMPS];
+	uint32_t sched_count;
+	uint32_t sched_dirty;		/* graph changed, recompile on copy */
+
+	/* idle mode, see pipeline_sched_copy() */
+	uint32_t idle_frames;		/* consecutive silent source frames */
+	uint32_t idle_limit;		/* silent frames before idling, 0 never */
+
+	/* fast start, see pipeline_sched_copy() */
+	uint32_t start_pending;		/* no source period copied since start */
 };
 
 /* static pipeline */
 extern struct pipeline *pipeline_static;
 
+/* task the pipeline is scheduled with, shared while it's in a group */
+static inline struct task *pipeline_sched_task(struct pipeline *p)
+{
+	return p->group ? &p->group->task : &p->pipe_task;
+}
+
 /* pipeline creation and destruction */
 struct pipeline *pipeline_new(struct sof_ipc_pipe_new *pipe_desc,
 	struct comp_dev *cd);
 int pipeline_free(struct pipeline *p);
 
+/* allocate zeroed component runtime data, released by pipeline_reset() */
+void *pipeline_arena_alloc(struct pipeline *p, size_t bytes);
+
 /* pipeline buffer creation and destruction */
 struct comp_buffer *buffer_new(struct sof_ipc_buffer *desc);
 void buffer_free(struct comp_buffer *buffer);
@@ -111,6 +203,13 @@ int pipeline_comp_connect(struct comp_dev *source_comp,
 			  struct comp_buffer *sink_buffer);
 int pipeline_buffer_connect(struct comp_buffer *source_buffer,
 			    struct comp_dev *sink_comp);
+void pipeline_comp_disconnect(struct comp_dev *source_comp,
+			      struct comp_buffer *sink_buffer);
+void pipeline_buffer_disconnect(struct comp_buffer *source_buffer,
+				struct comp_dev *sink_comp);
+
+/* park the branch beyond a buffer, its components copy silence */
+void pipeline_buffer_park(struct comp_buffer *buffer, uint32_t parked);
 int pipeline_complete(struct pipeline *p);
 
 /* pipeline parameters */
@@ -138,6 +237,7 @@ int init_pipeline(void);
 /* schedule a copy operation for this pipeline */
 void pipeline_schedule_copy(struct pipeline *p, uint64_t start);
 void pipeline_schedule_copy_idle(struct pipeline *p);
+void pipeline_schedule_periods(struct pipeline *p, uint32_t periods);
 void pipeline_schedule_cancel(struct pipeline *p);
 
 /* get time pipeline timestamps from host to dai */
@@ -149,4 +249,18 @@ void pipeline_schedule(void *arg);
 /* notify host that we have XRUN */
 void pipeline_xrun(struct pipeline *p, struct comp_dev *dev, int32_t bytes);
 
+/* walk a params or prepare branch handed over by another core */
+int pipeline_branch_run(struct pipeline_branch *branch);
+
+#ifdef CONFIG_PIPELINE_CORE_BALANCE
+/* get pipeline processing load in 1/1000 of its scheduling period */
+uint32_t pipeline_load(struct pipeline *p);
+#endif
+
+#ifdef CONFIG_STREAM_STATS
+/* start publishing runtime statistics at a stream region offset */
+void pipeline_stats_init(struct pipeline *p, struct comp_dev *host,
+			 uint32_t offset);
+#endif
+
 #endif
@@ -53,6 +53,28 @@ void clock_set_freq(int clock, uint32_t hz);
 
 uint64_t clock_ms_to_ticks(int clock, uint64_t ms);
 
+/* lowest frequency supported by the CPU clocks */
+uint32_t clock_cpu_min_freq(void);
+
 void clock_init(void);
 
+#ifdef CONFIG_CLOCK_GOVERNOR
+/*
+ * Account one pipeline run of rtime ticks against its period (both in
+ * scheduler clock ticks) and step the calling core clock if needed.
+ */
+void clock_gov_account(uint64_t rtime, uint64_t period);
+#endif
+
+#ifdef CONFIG_IDLE_MANAGER
+/*
+ * Wait for interrupt, dropping the calling core to its lowest clock first
+ * when the scheduler and work queue predict a long enough idle period.
+ */
+void clock_idle_wait(void);
+
+/* restore the clock lowered by clock_idle_wait(), safe from IRQ context */
+void clock_idle_exit(void);
+#endif
+
 #endif
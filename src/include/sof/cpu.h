@@ -54,9 +54,19 @@ static inline void cpu_disable_core(int id)
 	arch_cpu_disable_core(id);
 }
 
+static inline void cpu_standby_core(int id)
+{
+	arch_cpu_standby_core(id);
+}
+
 static inline int cpu_is_core_enabled(int id)
 {
 	return arch_cpu_is_core_enabled(id);
 }
 
+static inline int cpu_is_core_standby(int id)
+{
+	return arch_cpu_is_core_standby(id);
+}
+
 #endif
@@ -121,6 +121,7 @@ struct dai {
 	struct dai_plat_data plat_data;
 	const struct dai_ops *ops;
 	void *private;
+	struct sof_ipc_dai_config *config; /**< last applied, NULL if none */
 };
 
 /**
@@ -158,6 +159,52 @@ struct dai *dai_get(uint32_t type, uint32_t index, uint32_t flags);
  */
 void dai_put(struct dai *dai);
 
+/**
+ * \brief Applies a DAI config unless the hardware already holds it.
+ *
+ * Stream opens resend the same config, so the last applied one is kept
+ * and a byte identical config skips the driver.
+ *
+ * \param[in] dai DAI to configure.
+ * \param[in] config Config of hdr.size bytes.
+ */
+int dai_apply_config(struct dai *dai, struct sof_ipc_dai_config *config);
+
+/**
+ * \brief Forgets the configs of all DAIs, e.g. before the DSP powers off.
+ */
+void dai_config_invalidate(void);
+
+/**
+ * \brief Starts collecting DAI starts on the calling core.
+ *
+ * Calls nest, the starts collected are issued by the outermost
+ * dai_group_end().
+ */
+void dai_group_begin(void);
+
+/**
+ * \brief Starts the DMA channel and the DAI, or defers both to
+ * dai_group_end() when called between dai_group_begin() and
+ * dai_group_end().
+ *
+ * \param[in] dai DAI to trigger with cmd.
+ * \param[in] dma DMA feeding the DAI.
+ * \param[in] chan DMA channel.
+ * \param[in] cmd Trigger command, START or RELEASE.
+ * \param[in] direction Stream direction.
+ */
+int dai_group_start(struct dai *dai, struct dma *dma, int chan, int cmd,
+		    int direction);
+
+/**
+ * \brief Issues the collected starts in one IRQ off window, with one
+ * dma_start_group() per DMA controller, then the DAIs back to back.
+ *
+ * \return First error of the collected starts.
+ */
+int dai_group_end(void);
+
 #define dai_set_drvdata(dai, data) \
 	dai->private = data;
 #define dai_get_drvdata(dai) \
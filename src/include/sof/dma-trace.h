@@ -43,6 +43,16 @@
 #include <platform/platform.h>
 #include <platform/timer.h>
 
+/* trace work backs off when idle and speeds up under load */
+#define DMA_TRACE_PERIOD_MAX	(DMA_TRACE_PERIOD * 8)
+#define DMA_TRACE_PERIOD_MIN	(DMA_TRACE_PERIOD / 8)
+
+/* local buffer fill level that schedules a copy straight away */
+#define DMA_TRACE_WATERMARK	(DMA_TRACE_LOCAL_SIZE / 2)
+
+/* size of the trace ring of each core */
+#define DMA_TRACE_RING_SIZE	(DMA_TRACE_LOCAL_SIZE / 2)
+
 struct dma_trace_buf {
 	void *w_ptr;		/* buffer write pointer */
 	void *r_ptr;		/* buffer read position */
@@ -52,9 +62,36 @@ struct dma_trace_buf {
 	uint32_t avail;		/* avail bytes in buffer */
 };
 
+/*
+ * Events of each core are put in its own ring without locking, trace work
+ * merges them by timestamp into the DMA buffer. Positions are byte offsets,
+ * records are a length word and the event, a zero length wraps to the start.
+ */
+struct dma_trace_ring {
+	void *addr;		/* ring base address */
+	uint32_t w_pos;		/* written by the owning core only */
+	uint32_t r_pos;		/* written by trace work only */
+	uint32_t dropped;	/* events the owning core could not put */
+	uint32_t dropped_seen;	/* dropped events already reported */
+};
+
+#ifdef CONFIG_TRACE_PACKED
+/* delta state of the packed trace records */
+struct dma_trace_pack {
+	uint64_t timestamp;	/* timestamp of previous record */
+	uint32_t entry;		/* log entry address of previous record */
+	uint32_t id_0;		/* ids of previous record */
+	uint32_t id_1;
+	uint32_t core;		/* core of previous record */
+	uint32_t records;	/* records since the last sync */
+	uint32_t sync;		/* next record must be preceded by sync */
+};
+#endif
+
 struct dma_trace_data {
 	struct dma_sg_config config;
 	struct dma_trace_buf dmatb;
+	struct dma_trace_ring ring[PLATFORM_CORE_COUNT];
 	struct dma_copy dc;
 	uint32_t old_host_offset;
 	uint32_t host_offset;
@@ -64,7 +101,11 @@ struct dma_trace_data {
 	struct work dmat_work;
 	uint32_t enabled;
 	uint32_t copy_in_progress;
+	uint32_t period;	/* current trace work period in us */
 	uint32_t stream_tag;
+#ifdef CONFIG_TRACE_PACKED
+	struct dma_trace_pack pack;
+#endif
 	spinlock_t lock;
 };
 
@@ -79,9 +79,15 @@
 /* DMA IRQ types */
 #define DMA_IRQ_TYPE_BLOCK	BIT(0)
 #define DMA_IRQ_TYPE_LLIST	BIT(1)
+/* several periods completed at once, byte count is passed in next->size */
+#define DMA_IRQ_TYPE_BYTES	BIT(2)
 
 /* DMA copy flags */
 #define DMA_COPY_PRELOAD	BIT(0)
+/* bytes span several periods, report them with DMA_IRQ_TYPE_BYTES */
+#define DMA_COPY_BATCH		BIT(1)
+/* preload completes on the first period instead of the whole buffer */
+#define DMA_COPY_FAST_START	BIT(2)
 
 /* We will use this macro in cb handler to inform dma that
  * we need to stop the reload for special purpose
@@ -138,6 +144,8 @@ struct dma_ops {
 	void (*channel_put)(struct dma *dma, int channel);
 
 	int (*start)(struct dma *dma, int channel);
+	/* optional, start the channels in chan_mask at the same time */
+	int (*start_group)(struct dma *dma, uint32_t chan_mask);
 	int (*stop)(struct dma *dma, int channel);
 	int (*copy)(struct dma *dma, int channel, int bytes, uint32_t flags);
 	int (*pause)(struct dma *dma, int channel);
@@ -152,6 +160,9 @@ struct dma_ops {
 		void (*cb)(void *data, uint32_t type, struct dma_sg_elem *next),
 		void *data);
 
+	int (*get_data_size)(struct dma *dma, int channel, uint32_t *avail,
+			     uint32_t *free);
+
 	int (*pm_context_restore)(struct dma *dma);
 	int (*pm_context_store)(struct dma *dma);
 
@@ -178,9 +189,20 @@ struct dma {
 	int sref;		/**< simple ref counter, guarded by lock */
 	const struct dma_ops *ops;
 	atomic_t num_channels_busy; /* number of busy channels */
+	struct list_item streams; /**< dma_stream users, guarded by lock */
+	uint32_t bandwidth;	/**< bytes/s of the streams, guarded by lock */
 	void *private;
 };
 
+/**
+ * \brief Stream placed on a DMAC by dma_get_stream().
+ */
+struct dma_stream {
+	uint32_t pipeline_id;	/**< streams of a pipeline share a DMAC */
+	uint32_t bandwidth;	/**< bytes per second, 0 if not known yet */
+	struct list_item list;	/**< in dma->streams */
+};
+
 /**
  *  \brief Plugs platform specific DMA array once initialized into the lib.
  *
@@ -201,6 +223,38 @@ void dma_install(struct dma *dma_array, size_t num_dmas);
  */
 struct dma *dma_get(uint32_t dir, uint32_t caps, uint32_t dev, uint32_t flags);
 
+/**
+ * \brief API to request a shared platform DMAC for an audio stream.
+ *
+ * A DMAC already moving a stream of the same pipeline is returned, so the
+ * pipeline starts with one group start. Otherwise the DMAC with the least
+ * stream bandwidth is returned, and on a tie the one with fewer users.
+ *
+ * \param[in] dir Copy direction.
+ * \param[in] caps DMA capabilities.
+ * \param[in] dev Connectable devices.
+ * \param[in,out] stream Stream to place, added to the DMAC streams.
+ * \return DMAC or NULL if none matches.
+ */
+struct dma *dma_get_stream(uint32_t dir, uint32_t caps, uint32_t dev,
+			   struct dma_stream *stream);
+
+/**
+ * \brief Updates the bandwidth of a stream placed on a DMAC.
+ * \param[in] dma DMAC returned by dma_get_stream().
+ * \param[in,out] stream Stream placed on the DMAC.
+ * \param[in] bandwidth New stream bandwidth in bytes per second.
+ */
+void dma_stream_update(struct dma *dma, struct dma_stream *stream,
+		       uint32_t bandwidth);
+
+/**
+ * \brief Removes a stream from its DMAC and releases the DMAC.
+ * \param[in] dma DMAC returned by dma_get_stream().
+ * \param[in,out] stream Stream placed on the DMAC.
+ */
+void dma_put_stream(struct dma *dma, struct dma_stream *stream);
+
 /**
  * \brief API to release a platform DMAC.
  *
@@ -254,6 +308,33 @@ static inline int dma_start(struct dma *dma, int channel)
 	return dma->ops->start(dma, channel);
 }
 
+/*
+ * Start the channels in chan_mask together. Controllers without a common
+ * enable start them one after another, callers wanting them aligned keep
+ * IRQs off around the call. Channels that start are left running when
+ * another one fails, the first error is returned.
+ */
+static inline int dma_start_group(struct dma *dma, uint32_t chan_mask)
+{
+	int channel;
+	int ret = 0;
+	int err;
+
+	if (dma->ops->start_group)
+		return dma->ops->start_group(dma, chan_mask);
+
+	while (chan_mask) {
+		channel = __builtin_ctz(chan_mask);
+		chan_mask &= ~(1 << channel);
+
+		err = dma_start(dma, channel);
+		if (err < 0 && !ret)
+			ret = err;
+	}
+
+	return ret;
+}
+
 static inline int dma_stop(struct dma *dma, int channel)
 {
 	return dma->ops->stop(dma, channel);
@@ -287,6 +368,15 @@ static inline int dma_set_config(struct dma *dma, int channel,
 	return dma->ops->set_config(dma, channel, config);
 }
 
+/* bytes the client may read (avail) or write (free) based on the
+ * current hardware position of the channel
+ */
+static inline int dma_get_data_size(struct dma *dma, int channel,
+				    uint32_t *avail, uint32_t *free)
+{
+	return dma->ops->get_data_size(dma, channel, avail, free);
+}
+
 static inline int dma_pm_context_restore(struct dma *dma)
 {
 	return dma->ops->pm_context_restore(dma);
@@ -316,6 +316,8 @@
 	dmic->plat_data.irq
 
 /* DMIC private data */
+struct dmic_cfg_cache;
+
 struct dmic_pdata {
 	uint16_t fifo_a;
 	uint16_t fifo_b;
@@ -327,6 +329,8 @@ struct dmic_pdata {
 	struct work dmicwork;
 	int32_t startcount;
 	int32_t gain;
+	int32_t gain_target;	/* end of ramp Q2.30, 0 for HW gain bypass */
+	struct dmic_cfg_cache *cfg_cache;	/* last selected decimation */
 };
 
 extern const struct dai_ops dmic_ops;
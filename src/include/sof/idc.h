@@ -38,6 +38,7 @@
 #define __INCLUDE_IDC_H__
 
 #include <sof/schedule.h>
+#include <platform/platform.h>
 #include <sof/trace.h>
 
 /** \brief IDC trace function. */
@@ -55,6 +56,9 @@
 /** \brief IDC send non-blocking flag. */
 #define IDC_NON_BLOCKING	1
 
+/** \brief Async messages queued per target core, power of 2. */
+#define IDC_ASYNC_RING_SIZE	4
+
 /** \brief IDC send timeout in cycles. */
 #define IDC_TIMEOUT	800000
 
@@ -98,6 +102,18 @@
 #define IDC_MSG_NOTIFY		IDC_TYPE(0x5)
 #define IDC_MSG_NOTIFY_EXT	IDC_EXTENSION(0x0)
 
+/** \brief IDC group trigger message, group is in IPC shared context. */
+#define IDC_MSG_PPL_GROUP	IDC_TYPE(0x6)
+#define IDC_MSG_PPL_GROUP_EXT	IDC_EXTENSION(0x0)
+
+/** \brief IDC work message, work is in the shared work queue inbox. */
+#define IDC_MSG_WORK		IDC_TYPE(0x7)
+#define IDC_MSG_WORK_EXT	IDC_EXTENSION(0x0)
+
+/** \brief IDC pipeline branch message, branch is in IPC shared context. */
+#define IDC_MSG_PPL_BRANCH	IDC_TYPE(0x8)
+#define IDC_MSG_PPL_BRANCH_EXT	IDC_EXTENSION(0x0)
+
 /** \brief Decodes IDC message type. */
 #define iTS(x)	(((x) >> IDC_TYPE_SHIFT) & IDC_TYPE_MASK)
 
@@ -108,6 +124,20 @@ struct idc_msg {
 	uint32_t core;		/**< core id */
 };
 
+/** \brief IDC async message with completion callback. */
+struct idc_async {
+	struct idc_msg msg;				/**< message to send */
+	void (*cb)(void *data, int ret);		/**< completion */
+	void *cb_data;					/**< callback data */
+};
+
+/** \brief Async messages queued for one target core, head is in flight. */
+struct idc_ring {
+	struct idc_async msg[IDC_ASYNC_RING_SIZE];	/**< queued messages */
+	uint32_t head;					/**< oldest message */
+	uint32_t count;					/**< queued count */
+};
+
 /** \brief IDC data. */
 struct idc {
 	spinlock_t lock;		/**< lock mechanism */
@@ -115,6 +145,7 @@ struct idc {
 	uint32_t done_bit_mask;		/**< done interrupt mask */
 	struct idc_msg received_msg;	/**< received message */
 	struct task idc_task;		/**< IDC processing task */
+	struct idc_ring ring[PLATFORM_CORE_COUNT];	/**< async queues */
 };
 
 #endif
@@ -46,6 +46,16 @@
 #define IRQ_MANUAL_UNMASK	0
 #define IRQ_AUTO_UNMASK		1
 
+struct sof_ipc_debug_irq_stats;
+
+/* child handler statistics in platform timer ticks */
+struct irq_stats {
+	uint32_t count;		/* handler calls */
+	uint32_t max_run;	/* longest handler run */
+	uint64_t total_run;	/* total handler run */
+	uint32_t max_latency;	/* longest parent entry to handler entry */
+};
+
 struct irq_desc {
 	/* irq must be first for constructor */
 	int irq;        /* logical IRQ number */
@@ -67,6 +77,11 @@ struct irq_desc {
 
 	uint32_t num_children;
 	struct list_item child[PLATFORM_IRQ_CHILDREN];
+
+#ifdef CONFIG_IRQ_STATS
+	struct irq_stats stats;
+	struct list_item stats_list;	/* all registered children */
+#endif
 };
 
 int interrupt_register(uint32_t irq, int unmask, void(*handler)(void *arg),
@@ -75,6 +90,20 @@ void interrupt_unregister(uint32_t irq);
 uint32_t interrupt_enable(uint32_t irq);
 uint32_t interrupt_disable(uint32_t irq);
 
+#ifdef CONFIG_IRQ_STATS
+/* run a child handler, dispatch is the parent handler entry time */
+void interrupt_child_run(struct irq_desc *child, uint64_t dispatch);
+
+/* fill in the statistics of all child IRQs, returns reply size */
+int interrupt_stats_info(struct sof_ipc_debug_irq_stats *info, int reset);
+#else
+static inline void interrupt_child_run(struct irq_desc *child,
+				       uint64_t dispatch)
+{
+	child->handler(child->handler_arg);
+}
+#endif
+
 static inline void interrupt_set(int irq)
 {
 	arch_interrupt_set(SOF_IRQ_NUMBER(irq));
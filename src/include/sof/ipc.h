@@ -54,6 +54,16 @@ struct dai_config;
 	trace_error(TRACE_CLASS_IPC, format, ##__VA_ARGS__)
 
 #define MSG_QUEUE_SIZE		12
+#define MSG_INDEX_SIZE		16	/* replaceable messages, power of 2 */
+#define COMP_HASH_SIZE		32	/* component lookup buckets, power of 2 */
+#define IPC_TPLG_BATCH_MAX	32	/* descriptors per SOF_IPC_TPLG_BATCH */
+#define IPC_TPLG_BLOB_MAX_SIZE	(64 * 1024)	/* SOF_IPC_TPLG_BLOB bytes */
+
+/* group trigger limits, all times in us */
+#define IPC_GROUP_TRIGGER_MAX		8
+#define IPC_GROUP_TRIGGER_DELAY		250	/* default start delay */
+#define IPC_GROUP_TRIGGER_DELAY_MAX	10000
+#define IPC_GROUP_TRIGGER_TIMEOUT	2000	/* other cores done after start */
 
 #define COMP_TYPE_COMPONENT	1
 #define COMP_TYPE_BUFFER	2
@@ -80,8 +90,11 @@ struct ipc_comp_dev {
 		struct pipeline *pipeline;
 	};
 
+	uint32_t id;			/* comp, buffer or pipeline id */
+
 	/* lists */
 	struct list_item list;		/* list in components */
+	struct list_item hash_list;	/* list in id hash bucket */
 };
 
 struct ipc_msg {
@@ -91,18 +104,48 @@ struct ipc_msg {
 	uint32_t rx_size;	/* payload size in bytes */
 	uint8_t rx_data[SOF_IPC_MSG_MAX_SIZE];		/* pointer to payload data */
 	struct list_item list;
+	uint32_t queued;	/* in msg_list and not sent yet */
 	void (*cb)(void *cb_data, void *mailbox_data);
 	void *cb_data;
 };
 
+/* stream positions are coalesced for this long before the host is told */
+#define IPC_POSN_BATCH_PERIOD	1000	/* us */
+
+/* group trigger in progress, shared by all cores taking part */
+struct ipc_group_trigger {
+	uint64_t start;			/* platform_timer ticks */
+	uint32_t cmd;			/* COMP_TRIGGER_ */
+	uint32_t count;
+	uint32_t comp_id[IPC_GROUP_TRIGGER_MAX];
+	volatile uint32_t done[PLATFORM_CORE_COUNT];
+	volatile int32_t ret[PLATFORM_CORE_COUNT];
+};
+
 struct ipc_shared_context {
 	struct ipc_msg *dsp_msg;	/* current message to host */
 	uint32_t dsp_pending;
 	struct list_item msg_list;
 	struct list_item empty_list;
 	struct ipc_msg message[MSG_QUEUE_SIZE];
+	struct ipc_msg *msg_index[MSG_INDEX_SIZE];	/* by header hash */
 
 	struct list_item comp_list;	/* list of component devices */
+	struct list_item comp_hash[COMP_HASH_SIZE];	/* devices by id */
+
+	struct ipc_group_trigger group;
+
+	/* result of the last IDC message handled by each core */
+	volatile int32_t idc_ret[PLATFORM_CORE_COUNT];
+
+	/* params or prepare branch each core walks for the master */
+	struct pipeline_branch branch[PLATFORM_CORE_COUNT];
+
+#ifdef CONFIG_IPC_POSN_BATCH
+	uint32_t posn_pending;		/* position slots not yet notified */
+	uint32_t posn_next;		/* posn_work used for the next batch */
+	struct work posn_work[2];	/* send the coalesced positions */
+#endif
 };
 
 struct ipc {
@@ -121,12 +164,20 @@ struct ipc {
 	/* mmap for posn_offset */
 	struct pipeline *posn_map[PLATFORM_MAX_STREAMS];
 
+	/* mmap for volume slots after the positions */
+	struct comp_dev *vol_map[PLATFORM_MAX_STREAMS];
+
 	/* context shared between cores */
 	struct ipc_shared_context *shared_ctx;
 
 	/* processing task */
 	struct task ipc_task;
 
+	/* low priority stage of a deferred command, see ipc_defer() */
+	struct task defer_task;
+	int (*defer_func)(void *data);
+	void *defer_data;
+
 	void *private;
 };
 
@@ -148,13 +199,23 @@ int ipc_stream_send_position(struct comp_dev *cdev,
 		struct sof_ipc_stream_posn *posn);
 int ipc_stream_send_xrun(struct comp_dev *cdev,
 	struct sof_ipc_stream_posn *posn);
+#ifdef CONFIG_IPC_POSN_BATCH
+uint64_t ipc_stream_posn_work(void *data, uint64_t delay);
+#endif
 
 int ipc_queue_host_message(struct ipc *ipc, uint32_t header, void *tx_data,
 			   size_t tx_bytes, uint32_t replace);
 
 void ipc_platform_do_cmd(struct ipc *ipc);
+void ipc_platform_complete_cmd(struct ipc *ipc, int32_t err);
 void ipc_platform_send_msg(struct ipc *ipc);
 
+/* handler return value, the command completes from a deferred stage */
+#define IPC_CMD_DEFERRED	0x7fffffff
+
+int ipc_defer(int (*func)(void *data), void *data);
+void ipc_defer_task(void *data);
+
 /* create a SG page table eme list from a compressed page table */
 int ipc_parse_page_descriptors(uint8_t *page_table,
 			       struct sof_ipc_host_buffer *ring,
@@ -182,11 +243,26 @@ int ipc_pipeline_new(struct ipc *ipc, struct sof_ipc_pipe_new *pipeline);
 int ipc_pipeline_free(struct ipc *ipc, uint32_t comp_id);
 int ipc_pipeline_complete(struct ipc *ipc, uint32_t comp_id);
 
+/*
+ * Trigger the group trigger members owned by this core at the group start
+ * time. Called on every core taking part in the group.
+ */
+int ipc_pipeline_group_trigger(struct ipc *ipc);
+
+#ifdef CONFIG_PIPELINE_CORE_BALANCE
+/*
+ * Move pipeline to the least loaded core before it's started.
+ */
+void ipc_pipeline_balance(struct ipc *ipc, struct pipeline *p);
+#endif
+
 /*
  * Pipeline component and buffer connections.
  */
 int ipc_comp_connect(struct ipc *ipc,
 	struct sof_ipc_pipe_comp_connect *connect);
+int ipc_comp_disconnect(struct ipc *ipc,
+	struct sof_ipc_pipe_comp_connect *connect);
 
 /*
  * Get component by ID.
@@ -201,9 +277,22 @@ int ipc_comp_dai_config(struct ipc *ipc, struct sof_ipc_dai_config *config);
 /* send DMA trace host buffer position to host */
 int ipc_dma_trace_send_position(void);
 
+/* send probe extraction stream position to host */
+struct probe_data;
+int ipc_probe_send_position(struct probe_data *d);
+
 /* get posn offset by pipeline. */
 int ipc_get_posn_offset(struct ipc *ipc, struct pipeline *pipe);
 
+/* get and release mmap volume slot offset by component. */
+int ipc_get_vol_offset(struct ipc *ipc, struct comp_dev *dev);
+void ipc_put_vol_offset(struct ipc *ipc, struct comp_dev *dev);
+
+#ifdef CONFIG_STREAM_STATS
+/* get stream stats slot offset of a pipeline with a posn offset. */
+int ipc_get_stats_offset(struct ipc *ipc, struct pipeline *pipe);
+#endif
+
 /* private data for IPC */
 struct ipc_data {
 	/* DMA */
@@ -84,6 +84,11 @@
  * value after DEA is the line number where deadlock occurs and the second
  * number is the line number where the lock is allocated. These can be grepped
  * like above.
+ *
+ * Lock profiling (CONFIG_LOCK_PROFILE) records the acquire count, failed
+ * tries and hold time of every spin_lock_irq() section per lock, keyed by
+ * the spinlock_init() line number like above. The host reads the profile
+ * with SOF_IPC_DEBUG_LOCK_PROF.
  */
 
 #if DEBUG_LOCKS
@@ -181,10 +186,32 @@ extern uint32_t lock_dbg_user[DBG_LOCK_USERS];
 #define spin_lock_dbg()
 #define spin_unlock_dbg()
 
+#ifdef CONFIG_LOCK_PROFILE
+
+struct sof_ipc_debug_lock_prof;
+
+/* take lock counting the failed tries */
+void lock_prof_acquire(spinlock_t *lock);
+
+/* account the hold time and release lock */
+void lock_prof_release(spinlock_t *lock);
+
+/* fill in the lock profile of all cores, returns reply size */
+int lock_prof_info(struct sof_ipc_debug_lock_prof *info, int reset);
+
+/* all SMP spinlocks need init, nothing todo on UP */
+#define spinlock_init(lock) \
+	arch_spinlock_init(lock); \
+	(lock)->user = __LINE__;
+
+#else
+
 /* all SMP spinlocks need init, nothing todo on UP */
 #define spinlock_init(lock) \
 	arch_spinlock_init(lock)
 
+#endif
+
 /* does nothing on UP systems */
 #define spin_lock(lock) \
 	spin_lock_dbg(); \
@@ -198,6 +225,20 @@ extern uint32_t lock_dbg_user[DBG_LOCK_USERS];
 	arch_spin_unlock(lock); \
 	spin_unlock_dbg();
 
+#ifdef CONFIG_LOCK_PROFILE
+
+/* disables all IRQ sources and takes lock - enter atomic context */
+#define spin_lock_irq(lock, flags) \
+	flags = interrupt_global_disable(); \
+	lock_prof_acquire(lock);
+
+/* re-enables current IRQ sources and releases lock - leave atomic context */
+#define spin_unlock_irq(lock, flags) \
+	lock_prof_release(lock); \
+	interrupt_global_enable(flags);
+
+#else
+
 /* disables all IRQ sources and takes lock - enter atomic context */
 #define spin_lock_irq(lock, flags) \
 	flags = interrupt_global_disable(); \
@@ -211,3 +252,5 @@ extern uint32_t lock_dbg_user[DBG_LOCK_USERS];
 #endif
 
 #endif
+
+#endif
@@ -98,6 +98,15 @@ void mailbox_hostbox_read(void *dest, size_t offset, size_t bytes)
 	rmemcpy(dest, (void *)(MAILBOX_HOSTBOX_BASE + offset), bytes);
 }
 
+/* access hostbox contents in place, valid until the reply is written */
+static inline
+void *mailbox_hostbox_data(size_t offset, size_t bytes)
+{
+	dcache_invalidate_region((void *)(MAILBOX_HOSTBOX_BASE + offset),
+				 bytes);
+	return (void *)(MAILBOX_HOSTBOX_BASE + offset);
+}
+
 static inline
 void mailbox_stream_write(size_t offset, const void *src, size_t bytes)
 {
@@ -106,6 +115,15 @@ void mailbox_stream_write(size_t offset, const void *src, size_t bytes)
 				bytes);
 }
 
+/* access stream region contents written by the host in place */
+static inline
+void *mailbox_stream_data(size_t offset, size_t bytes)
+{
+	dcache_invalidate_region((void *)(MAILBOX_STREAM_BASE + offset),
+				 bytes);
+	return (void *)(MAILBOX_STREAM_BASE + offset);
+}
+
 static inline
 void mailbox_sw_reg_write(size_t offset, uint32_t src)
 {
@@ -39,4 +39,10 @@
 
 int32_t sin_fixed(int32_t w); /* Input is Q4.28, output is Q1.31 */
 
+/* Batch of n sines, w and out may be the same array */
+void sin_fixed_batch(const int32_t *w, int32_t *out, int n);
+
+/* Sines of n angles from w by w_step, returns the next angle */
+int32_t sin_fixed_step(int32_t w, int32_t w_step, int32_t *out, int n);
+
 #endif
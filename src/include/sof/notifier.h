@@ -40,6 +40,7 @@ struct sof;
 /* notifier general IDs */
 #define NOTIFIER_ID_CPU_FREQ	0
 #define NOTIFIER_ID_SSP_FREQ	1
+#define NOTIFIER_ID_COUNT	2
 
 /* notifier target core masks */
 #define NOTIFIER_TARGET_CORE_MASK(x)	(1 << x)
@@ -47,7 +48,7 @@ struct sof;
 
 struct notify {
 	spinlock_t lock;	/* notifier lock */
-	struct list_item list;	/* list of notifiers */
+	struct list_item list[NOTIFIER_ID_COUNT];	/* notifiers per id */
 };
 
 struct notify_data {
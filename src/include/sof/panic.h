@@ -36,6 +36,7 @@
 #include <sof/mailbox.h>
 #include <sof/interrupt.h>
 #include <sof/trace.h>
+#include <sof/coredump.h>
 #include <platform/platform.h>
 #include <uapi/ipc/trace.h>
 #include <stdint.h>
@@ -73,6 +74,9 @@ static inline void panic_rewind(uint32_t p, uint32_t stack_rewind_frames,
 	/* dump stack frames */
 	p = dump_stack(p, ext_offset, stack_rewind_frames, count);
 
+	/* stream heap and topology state while the host still listens */
+	coredump_stream(p, NULL);
+
 	/* panic - send IPC oops message to host */
 	platform_panic(p);
 
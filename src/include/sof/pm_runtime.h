@@ -40,6 +40,8 @@
 #include <sof/lock.h>
 #include <sof/trace.h>
 #include <sof/wait.h>
+#include <sof/work.h>
+#include <stdint.h>
 
 /** \addtogroup pm_runtime PM Runtime
  *  PM runtime specification.
@@ -49,6 +51,8 @@
 /** \brief Power management trace function. */
 #define trace_pm(__e, ...)	trace_event(TRACE_CLASS_POWER, __e, ##__VA_ARGS__)
 #define tracev_pm(__e, ...)	tracev_event(TRACE_CLASS_POWER, __e, ##__VA_ARGS__)
+#define trace_pm_error(__e, ...) \
+	trace_error(TRACE_CLASS_POWER, __e, ##__VA_ARGS__)
 
 /** \brief Power management trace value function. */
 #define tracev_pm_value(__e)	tracev_value(__e)
@@ -63,13 +67,32 @@ enum pm_runtime_context {
 	SSP_CLK,			/**< SSP Clock */
 	DMIC_CLK,			/**< DMIC Clock */
 	DMIC_POW,			/**< DMIC Power */
-	DW_DMAC_CLK			/**< DW DMAC Clock */
+	DW_DMAC_CLK,			/**< DW DMAC Clock */
+	HPSRAM_BANK,			/**< HP SRAM bank power */
+	PM_RUNTIME_CONTEXT_COUNT	/**< Number of contexts */
+};
+
+/** \brief Max device index reference counted per context. */
+#define PM_RUNTIME_MAX_INDEX	8
+
+/** \brief Time an async put waits before releasing the resource (us). */
+#define PM_RUNTIME_PUT_DELAY	10000
+
+/** \brief Reference count of one device resource. */
+struct pm_runtime_ref {
+	uint16_t count;		/**< number of active users */
+	uint16_t pending;	/**< release deferred to put_work */
 };
 
 /** \brief Runtime power management data. */
 struct pm_runtime_data {
 	spinlock_t lock;	/**< lock mechanism */
 	void *platform_data;	/**< platform specific data */
+
+	/** resource users, the platform is only called on 0 <-> 1 changes */
+	struct pm_runtime_ref ref[PM_RUNTIME_CONTEXT_COUNT]
+				 [PM_RUNTIME_MAX_INDEX];
+	struct work put_work;	/**< releases deferred resources */
 };
 
 /**
@@ -96,6 +119,9 @@ void pm_runtime_get_sync(enum pm_runtime_context context, uint32_t index);
 /**
  * \brief Releases power management resource (async).
  *
+ * Reference counted resources are released PM_RUNTIME_PUT_DELAY after
+ * the last user is gone, a get within that time keeps them active.
+ *
  * \param[in] context Type of power management context.
  * \param[in] index Index of the device.
  */
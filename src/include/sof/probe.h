@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef __INCLUDE_PROBE_H__
+#define __INCLUDE_PROBE_H__
+
+#include <stdint.h>
+#include <sof/lock.h>
+#include <sof/dma.h>
+#include <sof/work.h>
+#include <sof/audio/component.h>
+#include <uapi/ipc/debug.h>
+
+/* probe tracing */
+#define trace_probe(__e, ...) \
+	trace_event(TRACE_CLASS_PROBE, __e, ##__VA_ARGS__)
+#define trace_probe_error(__e, ...) \
+	trace_error(TRACE_CLASS_PROBE, __e, ##__VA_ARGS__)
+#define tracev_probe(__e, ...) \
+	tracev_event(TRACE_CLASS_PROBE, __e, ##__VA_ARGS__)
+
+/* local extraction buffer size */
+#define PROBE_LOCAL_SIZE	16384
+
+/* largest packet, bigger produces are dropped to bound the copy time */
+#define PROBE_MAX_PACKET	(PROBE_LOCAL_SIZE / 4)
+
+/* max number of probe points */
+#define PROBE_MAX_POINTS	8
+
+/* extraction work period in us */
+#define PROBE_PERIOD		1000
+
+struct probe_buf {
+	void *w_ptr;		/* buffer write pointer */
+	void *r_ptr;		/* buffer read position */
+	void *addr;		/* buffer base address */
+	void *end_addr;		/* buffer end address */
+	uint32_t size;		/* size of buffer in bytes */
+	uint32_t avail;		/* avail bytes in buffer */
+};
+
+struct probe_data {
+	struct dma_sg_config config;
+	struct probe_buf pb;
+	struct dma_copy dc;
+	uint32_t old_host_offset;
+	uint32_t host_offset;
+	uint32_t host_size;
+	uint32_t stream_tag;
+	uint32_t seq;		/* packets produced incl. dropped */
+	uint32_t packets;	/* packets written to the buffer */
+	uint32_t dropped;	/* packets dropped for lack of room */
+	struct work work;
+	uint32_t enabled;
+	uint32_t points[PROBE_MAX_POINTS];	/* probed buffer ids */
+	uint32_t num_points;
+	spinlock_t lock;
+};
+
+/* start the extraction stream, host buffer is described by config */
+int probe_init(uint32_t stream_tag, struct dma_sg_elem_array *elem_array,
+	       uint32_t host_size);
+
+/* attach a probe point to a buffer or detach it */
+int probe_point_set(struct comp_buffer *buffer, uint32_t enable);
+
+/* mirror bytes produced at ptr into a probed buffer */
+void probe_produce(struct comp_buffer *buffer, void *ptr, uint32_t bytes);
+
+#endif
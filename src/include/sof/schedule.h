@@ -64,6 +64,19 @@ struct sof;
 /* maximun task time slice in microseconds */
 #define SCHEDULE_TASK_MAX_TIME_SLICE	5000
 
+/* maximum number of tasks that can be queued in the scheduler at once */
+#define SCHEDULE_MAX_QUEUED_TASKS	64
+
+/* task deadline statistics in scheduling clock base */
+struct task_stats {
+	uint32_t missed;		/* deadlines missed */
+	uint32_t rescheduled;		/* reschedule attempts */
+	uint32_t cancelled;		/* cancelled after failed reschedule */
+	uint64_t max_lateness;		/* worst time past latest start */
+	uint64_t max_qdelay;		/* worst time from release to run */
+	uint32_t promoted;		/* runs moved to the high IRQ level */
+};
+
 /* task descriptor */
 struct task {
 	uint16_t core;			/* core id to run on */
@@ -72,6 +85,7 @@ struct task {
 	uint64_t deadline;		/* scheduling deadline */
 	uint32_t state;			/* TASK_STATE_ */
 	struct list_item list;		/* list in scheduler */
+	uint32_t queue_idx;		/* position in scheduler run queue */
 	struct list_item irq_list;	/* list for assigned irq level */
 
 	/* task function and private data */
@@ -81,12 +95,16 @@ struct task {
 	/* runtime duration in scheduling clock base */
 	uint64_t max_rtime;		/* max time taken to run */
 	completion_t complete;
+
+	struct task_stats stats;	/* deadline miss statistics */
 };
 
 struct schedule_data **arch_schedule_get(void);
 
 void schedule(void);
 
+uint64_t schedule_next_wakeup_us(void);
+
 void schedule_task(struct task *task, uint64_t start, uint64_t deadline);
 
 void schedule_task_idle(struct task *task, uint64_t deadline);
@@ -97,6 +115,16 @@ void schedule_task_complete(struct task *task);
 
 void schedule_task_running(struct task *task);
 
+static inline void schedule_task_stats_reset(struct task *task)
+{
+	task->stats.missed = 0;
+	task->stats.rescheduled = 0;
+	task->stats.cancelled = 0;
+	task->stats.max_lateness = 0;
+	task->stats.max_qdelay = 0;
+	task->stats.promoted = 0;
+}
+
 static inline void schedule_task_init(struct task *task, void (*func)(void *),
 	void *data)
 {
@@ -104,6 +132,7 @@ static inline void schedule_task_init(struct task *task, void (*func)(void *),
 	task->state = TASK_STATE_INIT;
 	task->func = func;
 	task->data = data;
+	schedule_task_stats_reset(task);
 }
 
 static inline void schedule_task_free(struct task *task)
@@ -54,6 +54,16 @@ struct sa;
 	__attribute__((unused))		\
 	typedef char META_CONCAT(assertion_failed_, MESSAGE)[(COND) ? 1 : -1]
 
+/* per period processing code, linked together at the start of the text
+ * so it doesn't share cache sets with init code and can be locked
+ */
+#define __hot_text	__attribute__((section(".hot.text")))
+
+/* large coefficient tables only read when a stream is configured, linked
+ * together at the end of the rodata so they don't mix with hot constants
+ */
+#define __cold_rodata	__attribute__((section(".cold.rodata")))
+
 /* general firmware context */
 struct sof {
 	/* init data */
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Liam Girdwood <liam.r.girdwood@linux.intel.com>
+ */
+
+/*
+ * Cached timebase. Each core keeps the platform timer value read at the
+ * start of its last scheduler or IRQ pass together with the core cycle
+ * count at that time. timebase_get() extends the cached value by the
+ * cycles elapsed since, scaled by a ratio calibrated against the platform
+ * timer, which avoids an uncached shim read on every trace or deadline
+ * check. The extension is bounded and dropped on WAITI, where the cycle
+ * counter may stop, so a stale value is never returned.
+ */
+
+#ifndef __INCLUDE_TIMEBASE__
+#define __INCLUDE_TIMEBASE__
+
+#include <arch/timer.h>
+#include <sof/cpu.h>
+#include <sof/interrupt.h>
+#include <sof/notifier.h>
+#include <platform/platform.h>
+#include <stdint.h>
+
+struct timebase {
+	uint64_t now;		/* platform timer at the last refresh */
+	uint32_t cycles;	/* core cycles at the last refresh */
+	uint32_t valid;		/* now and cycles can be extended */
+	uint32_t ticks_q16;	/* platform timer ticks per cycle, Q16.16 */
+	uint32_t max_cycles;	/* longest extension before a real read */
+
+	/* calibration summed over refresh pairs without WAITI in between */
+	uint64_t cal_window;
+	uint64_t cal_ticks;
+	uint32_t cal_cycles;
+
+	struct notifier clk_notifier;
+} __attribute__ ((__aligned__(PLATFORM_DCACHE_ALIGN)));
+
+extern struct timebase timebase[PLATFORM_CORE_COUNT];
+
+/* read the platform timer and restart the cycle extension from it */
+uint64_t timebase_refresh(void);
+
+/* cheap current platform timer value on the calling core */
+static inline uint64_t timebase_get(void)
+{
+	struct timebase *tb = &timebase[cpu_get_id()];
+	uint64_t now;
+	uint32_t delta;
+	uint32_t flags;
+
+	flags = interrupt_global_disable();
+
+	delta = arch_timer_get_cycles() - tb->cycles;
+	if (!tb->valid || delta > tb->max_cycles) {
+		interrupt_global_enable(flags);
+		return timebase_refresh();
+	}
+
+	now = tb->now + (((uint64_t)delta * tb->ticks_q16) >> 16);
+	interrupt_global_enable(flags);
+
+	return now;
+}
+
+/* platform timer ticks for a cycle count from arch_timer_get_cycles() */
+static inline uint64_t timebase_cycles_to_ticks(uint32_t cycles)
+{
+	return ((uint64_t)cycles * timebase[cpu_get_id()].ticks_q16) >> 16;
+}
+
+/* the cycle counter may stop, next timebase_get() reads the timer */
+static inline void timebase_invalidate(void)
+{
+	timebase[cpu_get_id()].valid = 0;
+}
+
+/* seed the calling core from its clock and follow its clock changes */
+void timebase_init(void);
+
+#endif
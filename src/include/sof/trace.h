@@ -44,42 +44,13 @@
 #include <platform/timer.h>
 #include <uapi/user/trace.h>
 
-/* bootloader trace values */
-#define TRACE_BOOT_LDR_ENTRY		0x100
-#define TRACE_BOOT_LDR_HPSRAM		0x110
-#define TRACE_BOOT_LDR_MANIFEST	0x120
-#define TRACE_BOOT_LDR_JUMP		0x150
-
-#define TRACE_BOOT_LDR_PARSE_MODULE	0x210
-#define TRACE_BOOT_LDR_PARSE_SEGMENT	0x220
-
-/* general trace init codes - only used at boot when main trace is not available */
-#define TRACE_BOOT_START		0x1000
-#define TRACE_BOOT_ARCH		0x2000
-#define TRACE_BOOT_SYS			0x3000
-#define TRACE_BOOT_PLATFORM		0x4000
-
-/* system specific codes */
-#define TRACE_BOOT_SYS_WORK		(TRACE_BOOT_SYS + 0x100)
-#define TRACE_BOOT_SYS_CPU_FREQ		(TRACE_BOOT_SYS + 0x200)
-#define TRACE_BOOT_SYS_HEAP		(TRACE_BOOT_SYS + 0x300)
-#define TRACE_BOOT_SYS_NOTE		(TRACE_BOOT_SYS + 0x400)
-#define TRACE_BOOT_SYS_SCHED		(TRACE_BOOT_SYS + 0x500)
-#define TRACE_BOOT_SYS_POWER		(TRACE_BOOT_SYS + 0x600)
-
-/* platform/device specific codes */
-#define TRACE_BOOT_PLATFORM_ENTRY	(TRACE_BOOT_PLATFORM + 0x100)
-#define TRACE_BOOT_PLATFORM_MBOX	(TRACE_BOOT_PLATFORM + 0x110)
-#define TRACE_BOOT_PLATFORM_SHIM	(TRACE_BOOT_PLATFORM + 0x120)
-#define TRACE_BOOT_PLATFORM_PMC		(TRACE_BOOT_PLATFORM + 0x130)
-#define TRACE_BOOT_PLATFORM_TIMER	(TRACE_BOOT_PLATFORM + 0x140)
-#define TRACE_BOOT_PLATFORM_CLOCK	(TRACE_BOOT_PLATFORM + 0x150)
-#define TRACE_BOOT_PLATFORM_SSP_FREQ	(TRACE_BOOT_PLATFORM + 0x160)
-#define TRACE_BOOT_PLATFORM_IPC		(TRACE_BOOT_PLATFORM + 0x170)
-#define TRACE_BOOT_PLATFORM_DMA		(TRACE_BOOT_PLATFORM + 0x180)
-#define TRACE_BOOT_PLATFORM_SSP		(TRACE_BOOT_PLATFORM + 0x190)
-#define TRACE_BOOT_PLATFORM_DMIC	(TRACE_BOOT_PLATFORM + 0x1a0)
-#define TRACE_BOOT_PLATFORM_IDC		(TRACE_BOOT_PLATFORM + 0x1b0)
+#ifdef CONFIG_BOOT_PROFILE
+/* record a boot trace point for the boot profile */
+void boot_profile_point(uint32_t point);
+
+/* write the boot profile to the mailbox and stop recording */
+void boot_profile_complete(void);
+#endif
 
 /* trace event classes - high 8 bits*/
 #define TRACE_CLASS_IRQ		(1 << 24)
@@ -108,12 +79,21 @@
 #define TRACE_CLASS_IDC		(24 << 24)
 #define TRACE_CLASS_CPU		(25 << 24)
 #define TRACE_CLASS_CLK		(26 << 24)
+#define TRACE_CLASS_ASRC	(27 << 24)
+#define TRACE_CLASS_CONV	(28 << 24)
+#define TRACE_CLASS_DRC		(29 << 24)
+#define TRACE_CLASS_KPB		(30 << 24)
+#define TRACE_CLASS_DECODER	(31 << 24)
+#define TRACE_CLASS_PROBE	(32 << 24)
+#define TRACE_CLASS_VOICE	(33 << 24)
+#define TRACE_CLASS_CROSSOVER	(34 << 24)
 
 /* move to config.h */
 #define TRACE	1
 #define TRACEV	0
 #define TRACEE	1
 #define TRACEM	0 /* send all trace messages to mbox and local trace buffer */
+#define TRACE_HOT_RATE	64 /* hot path events traced once per rate calls */
 
 #ifdef CONFIG_HOST
 extern int test_bench_trace;
@@ -208,6 +188,33 @@ void trace_flush(void);
 void trace_off(void);
 void trace_init(struct sof *sof);
 
+/* runtime trace filter, one level per trace class (high 8 bits) */
+#define TRACE_CLASS_SHIFT	24
+#define TRACE_FILTER_CLASSES	64
+#define TRACE_FILTER_COMP_MAX	8	/* per component overrides */
+#define TRACE_FILTER_COMP	0x80	/* class has component overrides */
+
+struct sof_ipc_trace_filter;
+
+extern uint8_t trace_filter_level[TRACE_FILTER_CLASSES];
+
+int trace_filter_comp(uint32_t level, uint32_t trace_class,
+		      uint32_t comp_id);
+int trace_filter_update(const struct sof_ipc_trace_filter *filter);
+
+/* single load and compare unless the class has component overrides */
+static inline int trace_filter_pass(uint32_t level, uint32_t trace_class,
+				    uint32_t comp_id)
+{
+	uint32_t max = trace_filter_level[(trace_class >> TRACE_CLASS_SHIFT) &
+					  (TRACE_FILTER_CLASSES - 1)];
+
+	if (!(max & TRACE_FILTER_COMP))
+		return level <= max;
+
+	return trace_filter_comp(level, trace_class, comp_id);
+}
+
 #if TRACE
 /*
  * trace_event macro definition
@@ -256,7 +263,12 @@ void trace_init(struct sof *sof);
 #define trace_value(x)		trace_event(0, "value %u", x)
 #define trace_value_atomic(x)	trace_event_atomic(0, "value %u", x)
 
+#ifdef CONFIG_BOOT_PROFILE
+#define trace_point(x) \
+	do { platform_trace_point(x); boot_profile_point(x); } while (0)
+#else
 #define trace_point(x) platform_trace_point(x)
+#endif
 
 /* verbose tracing */
 #if TRACEV
@@ -277,6 +289,27 @@ void trace_init(struct sof *sof);
 #define tracev_value_atomic(x)
 #endif
 
+/*
+ * Hot path tracing for events on every period of every stream, e.g. buffer
+ * updates. Verbose builds only trace one in TRACE_HOT_RATE calls of each
+ * call site, so long running streams stay usable with verbose tracing.
+ */
+#if TRACEV
+#define _tracehot(trace_call)					\
+do {								\
+	static uint32_t _tracehot_calls;			\
+	if (!(_tracehot_calls++ & (TRACE_HOT_RATE - 1)))	\
+		trace_call;					\
+} while (0)
+
+#define tracehot_event(...) _tracehot(trace_event(__VA_ARGS__))
+#define tracehot_event_with_ids(...)				\
+	_tracehot(trace_event_with_ids(__VA_ARGS__))
+#else
+#define tracehot_event(...)
+#define tracehot_event_with_ids(...)
+#endif
+
 /* error tracing */
 #if TRACEE
 #define _trace_error_with_ids(class, id_0, id_1, has_ids, format, ...)	\
@@ -344,7 +377,9 @@ _thrown_from_macro_BASE_LOG_in_trace_h
 {									\
 	_DECLARE_LOG_ENTRY(lvl, format, comp_class,			\
 			   PP_NARG(__VA_ARGS__), has_ids);		\
-	BASE_LOG(func_name, id_0, id_1, &log_entry, ##__VA_ARGS__)	\
+	if (trace_filter_pass(lvl, comp_class, id_1))			\
+		BASE_LOG(func_name, id_0, id_1, &log_entry,		\
+			 ##__VA_ARGS__)					\
 }
 
 #define _log_message(mbox, atomic, level, comp_class, id_0, id_1,	\
@@ -390,7 +425,11 @@ _thrown_from_macro_BASE_LOG_in_trace_h
 #define trace_value(x)
 #define trace_value_atomic(x)
 
+#ifdef CONFIG_BOOT_PROFILE
+#define trace_point(x) boot_profile_point(x)
+#else
 #define trace_point(x)
+#endif
 
 #define tracev_event(...)
 #define tracev_event_with_ids(...)
@@ -398,6 +437,8 @@ _thrown_from_macro_BASE_LOG_in_trace_h
 #define tracev_event_atomic_with_ids(...)
 #define tracev_value(x)
 #define tracev_value_atomic(x)
+#define tracehot_event(...)
+#define tracehot_event_with_ids(...)
 
 #endif
 
@@ -44,6 +44,7 @@
 #include <sof/trace.h>
 #include <sof/lock.h>
 #include <sof/clk.h>
+#include <sof/timebase.h>
 #include <platform/clk.h>
 #include <platform/interrupt.h>
 #include <sof/drivers/timer.h>
@@ -72,6 +73,7 @@ static inline void wait_for_interrupt(int level)
 {
 	tracev_event(TRACE_CLASS_WAIT, "WFE");
 	wait_atomic_check;
+	timebase_invalidate();
 	arch_wait_for_interrupt(level);
 	tracev_event(TRACE_CLASS_WAIT, "WFX");
 }
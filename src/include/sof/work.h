@@ -50,6 +50,7 @@ struct work {
 	void *cb_data;
 	struct list_item list;
 	uint64_t timeout;
+	uint64_t slack;		/* usecs work may run early to share a tick */
 	uint32_t pending;
 	uint32_t flags;
 };
@@ -69,8 +70,13 @@ struct work_queue_timesource {
 		(w)->cb = x; \
 		(w)->cb_data = xd; \
 		(w)->flags = xflags; \
+		(w)->slack = 0; \
 	} while (0)
 
+/* allow work to run up to usecs early with other work */
+#define work_set_slack(w, usecs) \
+	((w)->slack = (usecs))
+
 struct work_queue **arch_work_queue_get(void);
 
 /* schedule/cancel work on work queue */
@@ -84,6 +90,21 @@ void work_reschedule_default(struct work *work, uint64_t timeout);
 void work_reschedule_default_at(struct work *w, uint64_t time);
 void work_cancel_default(struct work *work);
 
+/* schedule work on the system work queue of another core */
+int work_schedule_on_core(int core, struct work *work, uint64_t timeout);
+
+/* schedule work submitted to this core by other cores */
+void work_inbox_drain(void);
+
+/* run work once on the first idle core */
+int work_submit_background(struct work *work);
+
+/* run one background work item, called from the idle loop */
+void work_background_run(void);
+
+/* time until the next queue run on this core */
+uint64_t work_next_wakeup_us(void);
+
 /* create new work queue */
 struct work_queue *work_new_queue(struct work_queue_timesource *ts);
 
@@ -41,6 +41,7 @@
 
 #include <uapi/user/header.h>
 #include <uapi/ipc/header.h>
+#include <uapi/ipc/stream.h>
 
 /*
  * Component Mixers and Controls
@@ -107,8 +108,19 @@ enum sof_ipc_ctrl_cmd {
 	SOF_CTRL_CMD_ENUM,	/**< maps to ALSA enum style controls */
 	SOF_CTRL_CMD_SWITCH,	/**< maps to ALSA switch style controls */
 	SOF_CTRL_CMD_BINARY,	/**< maps to ALSA binary style controls */
+	SOF_CTRL_CMD_MMAP_VOLUME, /**< map volume to the stream region */
 };
 
+/*
+ * Volume targets written by the host into the stream mailbox region. A
+ * SOF_CTRL_CMD_MMAP_VOLUME set with chanv[0].value = 1 maps the volume and
+ * returns the slot offset in chanv[0].value, value = 0 unmaps it. The
+ * firmware reads the slot once per period, so no IPC is needed to move it.
+ */
+struct sof_ipc_ctrl_mmap_vol {
+	uint32_t value[SOF_IPC_MAX_CHANNELS];	/**< target volume per channel */
+} __attribute__((packed));
+
 /* generic channel mapped value data */
 struct sof_ipc_ctrl_value_chan {
 	uint32_t channel;	/**< channel map - enum sof_ipc_chmap */
@@ -152,4 +164,64 @@ struct sof_ipc_ctrl_data {
 	};
 } __attribute__((packed));
 
+/* values for one component in a batch */
+struct sof_ipc_ctrl_batch_elem {
+	uint32_t comp_id;
+	uint32_t type;		/**< enum sof_ipc_ctrl_type */
+	uint32_t cmd;		/**< enum sof_ipc_ctrl_cmd */
+	uint32_t index;		/**< control index for comps > 1 control */
+	uint32_t num_elems;	/**< values that follow */
+
+	/* values - chanv or compv depending on cmd */
+	union {
+		struct sof_ipc_ctrl_value_chan chanv[0];
+		struct sof_ipc_ctrl_value_comp compv[0];
+	};
+} __attribute__((packed));
+
+/*
+ * Batched control values - SOF_IPC_COMP_SET_VALUE_BATCH
+ *
+ * Sets values of several components at once. Elems are packed back to back,
+ * each followed by its values. All elems are applied together between two
+ * pipeline copies, or none are if any elem is invalid.
+ */
+struct sof_ipc_ctrl_batch {
+	struct sof_ipc_cmd_hdr hdr;
+	uint32_t num_elems;	/**< components in the batch */
+
+	/* reserved for future use */
+	uint32_t reserved[3];
+
+	struct sof_ipc_ctrl_batch_elem elems[0];
+} __attribute__((packed));
+
+/* control change applied at a stream position */
+struct sof_ipc_ctrl_event {
+	uint64_t position;	/**< frames copied by the component before it */
+
+	/* SET_VALUE or SET_DATA message, rhdr.hdr.size bytes long */
+	struct sof_ipc_ctrl_data data;
+} __attribute__((packed));
+
+/*
+ * Scheduled control changes - SOF_IPC_COMP_SET_VALUE_SCHED
+ *
+ * Queues control changes of one component to be applied by its copy at
+ * exact frame positions. Positions count the frames the component has
+ * copied since it was last reset, events at a position already passed
+ * are applied at the start of the next copy. Events are packed back to
+ * back and none are queued if any is invalid.
+ */
+struct sof_ipc_ctrl_sched {
+	struct sof_ipc_cmd_hdr hdr;
+	uint32_t comp_id;
+	uint32_t num_events;	/**< events in the message */
+
+	/* reserved for future use */
+	uint32_t reserved[2];
+
+	struct sof_ipc_ctrl_event events[0];
+} __attribute__((packed));
+
 #endif
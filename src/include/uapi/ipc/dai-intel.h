@@ -195,8 +195,11 @@ struct sof_ipc_dai_dmic_params {
 	uint32_t wake_up_time;      /**< Time from clock start to data (us) */
 	uint32_t min_clock_on_time; /**< Min. time that clk is kept on (us) */
 
+	/**< Decimator output gain Q2.30 applied in HW, 0 for unity */
+	uint32_t out_gain;
+
 	/* reserved for future use */
-	uint32_t reserved[6];
+	uint32_t reserved[5];
 
 	/**< variable number of pdm controller config */
 	struct sof_ipc_dai_dmic_pdm_ctrl pdm[0];
@@ -0,0 +1,507 @@
+/*
+ * Copyright (c) 2018, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Liam Girdwood <liam.r.girdwood@linux.intel.com>
+ */
+
+/**
+ * \file include/uapi/ipc/debug.h
+ * \brief IPC definitions for runtime debug and statistics
+ * \author Liam Girdwood <liam.r.girdwood@linux.intel.com>
+ */
+
+#ifndef __INCLUDE_UAPI_IPC_DEBUG_H__
+#define __INCLUDE_UAPI_IPC_DEBUG_H__
+
+#include <uapi/ipc/header.h>
+#include <uapi/ipc/stream.h>
+
+/*
+ * Component performance counters - SOF_IPC_DEBUG_COMP_PERF
+ *
+ * Returns the copy() timing of every component in a pipeline. All times are
+ * in platform timer ticks.
+ */
+
+/* clear the counters after they have been read */
+#define SOF_IPC_DEBUG_PERF_RESET	(1 << 0)
+
+/* component performance request */
+struct sof_ipc_debug_perf_params {
+	struct sof_ipc_cmd_hdr hdr;
+	uint32_t pipeline_id;		/**< pipeline to query */
+	uint32_t flags;			/**< SOF_IPC_DEBUG_PERF_ */
+} __attribute__((packed));
+
+/* performance counters for a single component */
+struct sof_ipc_debug_perf_elem {
+	uint32_t comp_id;
+	uint32_t count;			/**< number of copy() calls */
+	uint32_t min;			/**< fastest copy() */
+	uint32_t avg;			/**< average copy() */
+	uint32_t max;			/**< slowest copy() */
+} __attribute__((packed));
+
+/* component performance reply */
+struct sof_ipc_debug_perf {
+	struct sof_ipc_reply rhdr;
+	uint32_t pipeline_id;
+	uint32_t num_elems;		/**< elems in this reply */
+	struct sof_ipc_debug_perf_elem elems[];
+} __attribute__((packed));
+
+/* max number of components reported in a single reply */
+#define SOF_IPC_DEBUG_PERF_MAX_ELEMS \
+	((SOF_IPC_MSG_MAX_SIZE - sizeof(struct sof_ipc_debug_perf)) / \
+	 sizeof(struct sof_ipc_debug_perf_elem))
+
+/*
+ * Pipeline task deadline statistics - SOF_IPC_DEBUG_TASK_STATS
+ *
+ * Returns the scheduler deadline statistics of a pipeline task. Lateness is
+ * in scheduler clock ticks.
+ */
+
+/* clear the statistics after they have been read */
+#define SOF_IPC_DEBUG_TASK_RESET	(1 << 0)
+
+/* task statistics request */
+struct sof_ipc_debug_task_params {
+	struct sof_ipc_cmd_hdr hdr;
+	uint32_t pipeline_id;		/**< pipeline to query */
+	uint32_t flags;			/**< SOF_IPC_DEBUG_TASK_ */
+} __attribute__((packed));
+
+/* task statistics reply */
+struct sof_ipc_debug_task_stats {
+	struct sof_ipc_reply rhdr;
+	uint32_t pipeline_id;
+	uint32_t missed;		/**< deadlines missed */
+	uint32_t rescheduled;		/**< reschedule attempts */
+	uint32_t cancelled;		/**< cancelled after failed reschedule */
+	uint32_t max_lateness;		/**< worst time past latest start */
+	uint32_t max_rtime;		/**< worst task run time */
+	uint32_t max_qdelay;		/**< worst time from release to run */
+	uint32_t promoted;		/**< runs moved to the high IRQ level */
+} __attribute__((packed));
+
+/*
+ * Heap usage - SOF_IPC_DEBUG_HEAP_INFO
+ *
+ * Returns the usage of all heaps in a memory zone and the free space of each
+ * heap block map. All sizes are in bytes unless stated otherwise.
+ */
+
+/* memory zones */
+#define SOF_IPC_DEBUG_HEAP_SYS		0
+#define SOF_IPC_DEBUG_HEAP_SYS_RUNTIME	1
+#define SOF_IPC_DEBUG_HEAP_RUNTIME	2
+#define SOF_IPC_DEBUG_HEAP_BUFFER	3
+
+/* heap usage request */
+struct sof_ipc_debug_heap_params {
+	struct sof_ipc_cmd_hdr hdr;
+	uint32_t zone;			/**< SOF_IPC_DEBUG_HEAP_ */
+	uint32_t reserved;
+} __attribute__((packed));
+
+/* usage of a single heap block map */
+struct sof_ipc_debug_heap_map {
+	uint32_t heap;			/**< heap index in zone */
+	uint32_t caps;			/**< heap SOF_MEM_CAPS_ */
+	uint32_t block_size;
+	uint32_t count;			/**< blocks in map */
+	uint32_t free_count;		/**< free blocks in map */
+	uint32_t largest_free;		/**< longest run of free blocks */
+} __attribute__((packed));
+
+/* heap usage reply */
+struct sof_ipc_debug_heap {
+	struct sof_ipc_reply rhdr;
+	uint32_t zone;
+	uint32_t num_heaps;		/**< heaps in zone */
+	uint32_t size;			/**< total size of zone heaps */
+	uint32_t used;
+	uint32_t free;
+	uint32_t peak;			/**< sum of heap peak usage since boot */
+	uint32_t num_elems;		/**< elems in this reply */
+	struct sof_ipc_debug_heap_map elems[];
+} __attribute__((packed));
+
+/* max number of block maps reported in a single reply */
+#define SOF_IPC_DEBUG_HEAP_MAX_ELEMS \
+	((SOF_IPC_MSG_MAX_SIZE - sizeof(struct sof_ipc_debug_heap)) / \
+	 sizeof(struct sof_ipc_debug_heap_map))
+
+/*
+ * Heap allocation histogram - SOF_IPC_DEBUG_HEAP_HIST
+ *
+ * Returns the request sizes seen by the allocator for a memory zone since
+ * boot and the most blocks each block map of the zone had in use at once.
+ * The request uses struct sof_ipc_debug_heap_params. Only available with
+ * CONFIG_HEAP_HISTOGRAM.
+ */
+
+/* request size bins, bin n counts requests of up to 16 << n bytes */
+#define SOF_IPC_DEBUG_HEAP_HIST_BINS	14
+
+/* requests of one size bin, the last bin also counts all larger ones */
+struct sof_ipc_debug_heap_hist_bin {
+	uint32_t allocs;		/**< requests */
+	uint32_t fails;			/**< requests that could not be met */
+} __attribute__((packed));
+
+/* peak usage of a single heap block map */
+struct sof_ipc_debug_heap_hist_map {
+	uint32_t heap;			/**< heap index in zone */
+	uint32_t block_size;
+	uint32_t count;			/**< blocks in map */
+	uint32_t peak_used;		/**< most blocks used at once */
+} __attribute__((packed));
+
+/* heap allocation histogram reply */
+struct sof_ipc_debug_heap_hist {
+	struct sof_ipc_reply rhdr;
+	uint32_t zone;
+	uint32_t num_maps;		/**< maps in this reply */
+	struct sof_ipc_debug_heap_hist_bin bins[SOF_IPC_DEBUG_HEAP_HIST_BINS];
+	struct sof_ipc_debug_heap_hist_map maps[];
+} __attribute__((packed));
+
+/* max number of block maps reported in a single reply */
+#define SOF_IPC_DEBUG_HEAP_HIST_MAX_MAPS \
+	((SOF_IPC_MSG_MAX_SIZE - sizeof(struct sof_ipc_debug_heap_hist)) / \
+	 sizeof(struct sof_ipc_debug_heap_hist_map))
+
+/*
+ * Memory benchmark - SOF_IPC_DEBUG_MEM_BENCH
+ *
+ * Measures every heap of a runtime or buffer zone through its cached and its
+ * uncached alias on the core handling the IPC. Each test is run iterations
+ * times and the fastest run is reported, so IRQs and other cores only add
+ * noise when they hit every run. Times are in core clock cycles, the reply
+ * carries the core clock rate they were taken at. Platforms without an
+ * uncached alias report the cached one only. Only available with
+ * CONFIG_MEM_BENCH.
+ */
+
+/* default and largest test size in bytes */
+#define SOF_IPC_DEBUG_MEM_BENCH_SIZE		16384
+#define SOF_IPC_DEBUG_MEM_BENCH_SIZE_MAX	65536
+
+/* default number of runs of each test */
+#define SOF_IPC_DEBUG_MEM_BENCH_ITERS		4
+
+/* memory benchmark request */
+struct sof_ipc_debug_mem_bench_params {
+	struct sof_ipc_cmd_hdr hdr;
+	uint32_t zone;			/**< SOF_IPC_DEBUG_HEAP_ RUNTIME or BUFFER */
+	uint32_t size;			/**< test bytes, 0 for the default */
+	uint32_t iterations;		/**< runs of each test, 0 for the default */
+	uint32_t reserved;
+} __attribute__((packed));
+
+/* results for one heap through one alias */
+struct sof_ipc_debug_mem_bench_elem {
+	uint32_t heap;			/**< heap index in zone */
+	uint32_t caps;			/**< heap SOF_MEM_CAPS_ */
+	uint32_t uncached;		/**< 1 for the uncached alias */
+	uint32_t read;			/**< read size bytes as words */
+	uint32_t write;			/**< write size bytes as words */
+	uint32_t copy;			/**< memcpy() size / 2 bytes in the heap */
+	uint32_t latency;		/**< dependent load, 1/256 cycle units */
+	uint32_t writeback;		/**< dcache writeback of 1 KB dirty lines */
+	uint32_t invalidate;		/**< dcache invalidate of 1 KB */
+} __attribute__((packed));
+
+/* memory benchmark reply */
+struct sof_ipc_debug_mem_bench {
+	struct sof_ipc_reply rhdr;
+	uint32_t zone;
+	uint32_t size;			/**< test bytes used */
+	uint32_t iterations;		/**< runs of each test used */
+	uint32_t cycles_per_ms;		/**< core clock during the tests */
+	uint32_t num_elems;		/**< elems in this reply */
+	struct sof_ipc_debug_mem_bench_elem elems[];
+} __attribute__((packed));
+
+/* max number of results reported in a single reply */
+#define SOF_IPC_DEBUG_MEM_BENCH_MAX_ELEMS \
+	((SOF_IPC_MSG_MAX_SIZE - sizeof(struct sof_ipc_debug_mem_bench)) / \
+	 sizeof(struct sof_ipc_debug_mem_bench_elem))
+
+/*
+ * Lock profile - SOF_IPC_DEBUG_LOCK_PROF
+ *
+ * Returns the IRQ off hold time of each profiled lock summed over all cores.
+ * Locks are identified by their spinlock_init() line number. Times are in
+ * platform timer ticks.
+ */
+
+/* clear the profile after it has been read */
+#define SOF_IPC_DEBUG_LOCK_RESET	(1 << 0)
+
+/* lock profile request */
+struct sof_ipc_debug_lock_params {
+	struct sof_ipc_cmd_hdr hdr;
+	uint32_t flags;			/**< SOF_IPC_DEBUG_LOCK_ */
+	uint32_t reserved;
+} __attribute__((packed));
+
+/* profile of a single lock */
+struct sof_ipc_debug_lock_elem {
+	uint32_t user;			/**< spinlock_init() line */
+	uint32_t count;			/**< times taken with IRQs off */
+	uint32_t spins;			/**< failed tries to take it */
+	uint32_t max;			/**< longest hold */
+	uint32_t avg;			/**< average hold */
+} __attribute__((packed));
+
+/* lock profile reply */
+struct sof_ipc_debug_lock_prof {
+	struct sof_ipc_reply rhdr;
+	uint32_t dropped;		/**< locks with no free profile entry */
+	uint32_t num_elems;		/**< elems in this reply */
+	struct sof_ipc_debug_lock_elem elems[];
+} __attribute__((packed));
+
+/* max number of locks reported in a single reply */
+#define SOF_IPC_DEBUG_LOCK_MAX_ELEMS \
+	((SOF_IPC_MSG_MAX_SIZE - sizeof(struct sof_ipc_debug_lock_prof)) / \
+	 sizeof(struct sof_ipc_debug_lock_elem))
+
+/*
+ * Interrupt statistics - SOF_IPC_DEBUG_IRQ_STATS
+ *
+ * Returns the handler statistics of each registered cascaded child IRQ.
+ * Latency is measured from the parent handler entry as the assertion time
+ * isn't visible. Times are in platform timer ticks.
+ */
+
+/* clear the statistics after they have been read */
+#define SOF_IPC_DEBUG_IRQ_RESET		(1 << 0)
+
+/* interrupt statistics request */
+struct sof_ipc_debug_irq_params {
+	struct sof_ipc_cmd_hdr hdr;
+	uint32_t flags;			/**< SOF_IPC_DEBUG_IRQ_ */
+	uint32_t reserved;
+} __attribute__((packed));
+
+/* statistics of a single child IRQ */
+struct sof_ipc_debug_irq_elem {
+	uint32_t irq;			/**< logical IRQ number */
+	uint32_t count;			/**< handler calls */
+	uint32_t avg_run;		/**< average handler run time */
+	uint32_t max_run;		/**< longest handler run time */
+	uint32_t max_latency;		/**< longest delay to handler entry */
+} __attribute__((packed));
+
+/* interrupt statistics reply */
+struct sof_ipc_debug_irq_stats {
+	struct sof_ipc_reply rhdr;
+	uint32_t num_irqs;		/**< registered child IRQs */
+	uint32_t num_elems;		/**< elems in this reply */
+	struct sof_ipc_debug_irq_elem elems[];
+} __attribute__((packed));
+
+/* max number of IRQs reported in a single reply */
+#define SOF_IPC_DEBUG_IRQ_MAX_ELEMS \
+	((SOF_IPC_MSG_MAX_SIZE - sizeof(struct sof_ipc_debug_irq_stats)) / \
+	 sizeof(struct sof_ipc_debug_irq_elem))
+
+/*
+ * Probes - SOF_IPC_DEBUG_PROBE_INIT, SOF_IPC_DEBUG_PROBE_POINT
+ *
+ * A probe point mirrors all data produced into a pipeline buffer to a host
+ * extraction stream. Data from all enabled points is multiplexed into the
+ * stream as packets, each a struct sof_ipc_probe_packet followed by size
+ * bytes of data padded to a 4 byte multiple. Packets that don't fit in the
+ * DSP extraction buffer are dropped whole, the host can detect this from a
+ * gap in seq. The stream position is sent with SOF_IPC_DEBUG_PROBE_POSITION.
+ */
+
+/* packet header magic, "PROB" */
+#define SOF_IPC_PROBE_MAGIC		0x50524f42
+
+/* extraction stream - SOF_IPC_DEBUG_PROBE_INIT */
+struct sof_ipc_probe_dma {
+	struct sof_ipc_cmd_hdr hdr;
+	struct sof_ipc_host_buffer buffer;
+	uint32_t stream_tag;
+} __attribute__((packed));
+
+/* enable or disable a probe point - SOF_IPC_DEBUG_PROBE_POINT */
+struct sof_ipc_probe_point {
+	struct sof_ipc_cmd_hdr hdr;
+	uint32_t buffer_id;		/**< pipeline buffer to probe */
+	uint32_t enable;		/**< 1 attaches, 0 detaches */
+	uint32_t reserved[2];
+} __attribute__((packed));
+
+/* extraction stream position - SOF_IPC_DEBUG_PROBE_POSITION */
+struct sof_ipc_probe_posn {
+	struct sof_ipc_reply rhdr;
+	uint32_t host_offset;		/**< offset of DMA host buffer */
+	uint32_t packets;		/**< total packets sent */
+	uint32_t dropped;		/**< total packets dropped */
+} __attribute__((packed));
+
+/* extraction stream packet header */
+struct sof_ipc_probe_packet {
+	uint32_t magic;			/**< SOF_IPC_PROBE_MAGIC */
+	uint32_t buffer_id;		/**< probed buffer */
+	uint32_t size;			/**< data bytes, without padding */
+	uint32_t seq;			/**< packet count incl. dropped */
+	uint64_t timestamp;		/**< platform timer at produce */
+} __attribute__((packed));
+
+/*
+ * Core dump - SOF_IPC_DEBUG_COREDUMP_INIT, SOF_IPC_DEBUG_COREDUMP
+ *
+ * The host hands the firmware a DMA buffer once with COREDUMP_INIT. On a
+ * panic, before the oops is sent, or on demand with SOF_IPC_DEBUG_COREDUMP,
+ * the firmware streams its heap block maps, pipelines, components and
+ * buffers to the start of that buffer. The dump is a sequence of records,
+ * each a struct sof_coredump_record followed by size bytes padded to a 4 byte
+ * multiple. It starts with a SOF_COREDUMP_HDR record and always ends with a
+ * SOF_COREDUMP_END record, records that don't fit the host buffer are left
+ * out and counted in the end record.
+ */
+
+/* record header magic, "CDMP" */
+#define SOF_COREDUMP_MAGIC		0x434d4450
+
+/* record types */
+#define SOF_COREDUMP_HDR		0
+#define SOF_COREDUMP_HEAP		1
+#define SOF_COREDUMP_PIPE		2
+#define SOF_COREDUMP_COMP		3
+#define SOF_COREDUMP_BUFFER		4
+#define SOF_COREDUMP_END		5
+
+/* heap zones besides SOF_IPC_DEBUG_HEAP_ */
+#define SOF_COREDUMP_HEAP_CORE_RUNTIME	4
+#define SOF_COREDUMP_HEAP_CORE_BUFFER	5
+
+/* heap block entry, 0 for a free block */
+#define SOF_COREDUMP_BLOCK_USED		(1 << 15)
+#define SOF_COREDUMP_BLOCK_SIZE_MASK	0x7fff
+
+/* dump stream - SOF_IPC_DEBUG_COREDUMP_INIT */
+struct sof_ipc_coredump_dma {
+	struct sof_ipc_cmd_hdr hdr;
+	struct sof_ipc_host_buffer buffer;
+	uint32_t stream_tag;
+} __attribute__((packed));
+
+/* on demand dump reply - SOF_IPC_DEBUG_COREDUMP */
+struct sof_ipc_coredump_reply {
+	struct sof_ipc_reply rhdr;
+	uint32_t size;			/**< dump bytes in host buffer */
+	uint32_t records;		/**< records in dump */
+	uint32_t dropped;		/**< records that didn't fit */
+	uint32_t reserved;
+} __attribute__((packed));
+
+/* dump record header */
+struct sof_coredump_record {
+	uint32_t magic;			/**< SOF_COREDUMP_MAGIC */
+	uint32_t type;			/**< SOF_COREDUMP_ */
+	uint32_t size;			/**< payload bytes, without padding */
+} __attribute__((packed));
+
+/* SOF_COREDUMP_HDR */
+struct sof_coredump_hdr {
+	uint32_t abi_version;		/**< SOF_ABI_VERSION */
+	uint32_t core;			/**< core that took the dump */
+	uint32_t panic;			/**< SOF_IPC_PANIC_ code, 0 on demand */
+	uint32_t reserved;
+	uint64_t timestamp;		/**< platform timer */
+} __attribute__((packed));
+
+/*
+ * SOF_COREDUMP_HEAP - one heap block map, followed by count uint16_t block
+ * entries. The first block of an allocation has SOF_COREDUMP_BLOCK_USED and
+ * the allocation length in blocks, the other blocks it spans have only
+ * SOF_COREDUMP_BLOCK_USED.
+ */
+struct sof_coredump_heap {
+	uint32_t zone;			/**< SOF_IPC_DEBUG_HEAP_ or SOF_COREDUMP_HEAP_ */
+	uint32_t heap;			/**< heap index in zone */
+	uint32_t caps;			/**< heap SOF_MEM_CAPS_ */
+	uint32_t base;			/**< address of first block */
+	uint32_t block_size;
+	uint32_t count;			/**< blocks in map */
+	uint32_t free_count;		/**< free blocks in map */
+	uint32_t first_free;		/**< index of first free block */
+} __attribute__((packed));
+
+/* SOF_COREDUMP_PIPE */
+struct sof_coredump_pipe {
+	uint32_t pipeline_id;
+	uint32_t core;
+	uint32_t status;		/**< COMP_STATE_ */
+	uint32_t sched_id;		/**< scheduling component ID */
+	uint32_t source_id;		/**< source component ID */
+	int32_t xrun_bytes;		/**< pending xrun length */
+	uint32_t period;		/**< scheduling period in us */
+	uint32_t priority;
+} __attribute__((packed));
+
+/* SOF_COREDUMP_COMP */
+struct sof_coredump_comp {
+	uint32_t comp_id;
+	uint32_t type;			/**< SOF_COMP_ */
+	uint32_t pipeline_id;
+	uint32_t state;			/**< COMP_STATE_ */
+	uint32_t frames;		/**< frames per copy */
+	uint32_t reserved;
+	uint64_t position;		/**< rendering position in bytes */
+} __attribute__((packed));
+
+/* SOF_COREDUMP_BUFFER */
+struct sof_coredump_buffer {
+	uint32_t buffer_id;
+	uint32_t source_id;		/**< source component ID, ~0 if none */
+	uint32_t sink_id;		/**< sink component ID, ~0 if none */
+	uint32_t size;
+	uint32_t avail;
+	uint32_t free;
+	uint32_t addr;
+	uint32_t r_ptr;
+	uint32_t w_ptr;
+	uint32_t reserved;
+} __attribute__((packed));
+
+/* SOF_COREDUMP_END */
+struct sof_coredump_end {
+	uint32_t records;		/**< records before this one */
+	uint32_t dropped;		/**< records that didn't fit */
+} __attribute__((packed));
+
+#endif
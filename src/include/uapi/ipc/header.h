@@ -79,6 +79,7 @@
 #define SOF_IPC_GLB_DAI_MSG			SOF_GLB_TYPE(0x8U)
 #define SOF_IPC_GLB_TRACE_MSG			SOF_GLB_TYPE(0x9U)
 #define SOF_IPC_GLB_GDB_DEBUG                   SOF_GLB_TYPE(0xAU)
+#define SOF_IPC_GLB_DEBUG			SOF_GLB_TYPE(0xBU)
 
 /*
  * DSP Command Message Types
@@ -94,6 +95,9 @@
 #define SOF_IPC_TPLG_PIPE_COMPLETE		SOF_CMD_TYPE(0x013)
 #define SOF_IPC_TPLG_BUFFER_NEW			SOF_CMD_TYPE(0x020)
 #define SOF_IPC_TPLG_BUFFER_FREE		SOF_CMD_TYPE(0x021)
+#define SOF_IPC_TPLG_BATCH			SOF_CMD_TYPE(0x030)
+#define SOF_IPC_TPLG_BLOB			SOF_CMD_TYPE(0x031)
+#define SOF_IPC_TPLG_MODULE_NEW			SOF_CMD_TYPE(0x040)
 
 /* PM */
 #define SOF_IPC_PM_CTX_SAVE			SOF_CMD_TYPE(0x001)
@@ -109,6 +113,8 @@
 #define SOF_IPC_COMP_GET_VALUE			SOF_CMD_TYPE(0x002)
 #define SOF_IPC_COMP_SET_DATA			SOF_CMD_TYPE(0x003)
 #define SOF_IPC_COMP_GET_DATA			SOF_CMD_TYPE(0x004)
+#define SOF_IPC_COMP_SET_VALUE_BATCH		SOF_CMD_TYPE(0x005)
+#define SOF_IPC_COMP_SET_VALUE_SCHED		SOF_CMD_TYPE(0x006)
 
 /* DAI messages */
 #define SOF_IPC_DAI_CONFIG			SOF_CMD_TYPE(0x001)
@@ -125,12 +131,29 @@
 #define SOF_IPC_STREAM_TRIG_DRAIN		SOF_CMD_TYPE(0x008)
 #define SOF_IPC_STREAM_TRIG_XRUN		SOF_CMD_TYPE(0x009)
 #define SOF_IPC_STREAM_POSITION			SOF_CMD_TYPE(0x00a)
+#define SOF_IPC_STREAM_POSITION_BATCH		SOF_CMD_TYPE(0x00b)
+#define SOF_IPC_STREAM_TRIG_GROUP		SOF_CMD_TYPE(0x00c)
 #define SOF_IPC_STREAM_VORBIS_PARAMS		SOF_CMD_TYPE(0x010)
 #define SOF_IPC_STREAM_VORBIS_FREE		SOF_CMD_TYPE(0x011)
 
 /* trace and debug */
 #define SOF_IPC_TRACE_DMA_PARAMS		SOF_CMD_TYPE(0x001)
 #define SOF_IPC_TRACE_DMA_POSITION		SOF_CMD_TYPE(0x002)
+#define SOF_IPC_TRACE_FILTER_UPDATE		SOF_CMD_TYPE(0x003)
+
+/* runtime debug and statistics */
+#define SOF_IPC_DEBUG_COMP_PERF			SOF_CMD_TYPE(0x001)
+#define SOF_IPC_DEBUG_TASK_STATS		SOF_CMD_TYPE(0x002)
+#define SOF_IPC_DEBUG_HEAP_INFO			SOF_CMD_TYPE(0x003)
+#define SOF_IPC_DEBUG_LOCK_PROF			SOF_CMD_TYPE(0x004)
+#define SOF_IPC_DEBUG_IRQ_STATS			SOF_CMD_TYPE(0x005)
+#define SOF_IPC_DEBUG_PROBE_INIT		SOF_CMD_TYPE(0x006)
+#define SOF_IPC_DEBUG_PROBE_POINT		SOF_CMD_TYPE(0x007)
+#define SOF_IPC_DEBUG_PROBE_POSITION		SOF_CMD_TYPE(0x008)
+#define SOF_IPC_DEBUG_COREDUMP_INIT		SOF_CMD_TYPE(0x009)
+#define SOF_IPC_DEBUG_COREDUMP			SOF_CMD_TYPE(0x00A)
+#define SOF_IPC_DEBUG_HEAP_HIST			SOF_CMD_TYPE(0x00B)
+#define SOF_IPC_DEBUG_MEM_BENCH			SOF_CMD_TYPE(0x00C)
 
 /* Get message component id */
 #define SOF_IPC_MESSAGE_ID(x)			((x) & 0xffff)
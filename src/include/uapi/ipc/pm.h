@@ -69,10 +69,16 @@ struct sof_ipc_pm_ctx {
 	struct sof_ipc_pm_ctx_elem elems[];
 } __attribute__((packed));
 
-/* enable or disable cores - SOF_IPC_PM_CORE_ENABLE */
+/*
+ * enable or disable cores - SOF_IPC_PM_CORE_ENABLE
+ *
+ * Disabled cores in standby_mask stay booted and idle, so enabling them again
+ * skips the boot and init. The host must keep their power on meanwhile.
+ */
 struct sof_ipc_pm_core_config {
 	struct sof_ipc_cmd_hdr hdr;
 	uint32_t enable_mask;
+	uint32_t standby_mask;
 } __attribute__((packed));
 
 #endif
@@ -135,6 +135,7 @@ struct sof_ipc_pcm_params_reply {
 	struct sof_ipc_reply rhdr;
 	uint32_t comp_id;
 	uint32_t posn_offset;
+	uint32_t stats_offset;	/**< struct sof_ipc_stream_stats, 0 if none */
 } __attribute__((packed));
 
 /* free stream - SOF_IPC_STREAM_PCM_PARAMS */
@@ -176,4 +177,57 @@ struct sof_ipc_stream_posn {
 	int32_t xrun_size;	/**< XRUN size in bytes */
 } __attribute__((packed));
 
+/*
+ * Stream runtime statistics kept by the firmware in the stream region at the
+ * stats_offset returned by SOF_IPC_STREAM_PCM_PARAMS_REPLY. The record is
+ * rewritten once per pipeline period and the host polls it without IPC.
+ * seq is odd while the record is being updated, so a reader retries when
+ * seq is odd or differs before and after reading the record.
+ */
+#define SOF_IPC_STREAM_STATS_BUFFERS	8
+
+struct sof_ipc_stream_stats_buffer {
+	uint32_t buffer_id;	/**< buffer component ID */
+	uint32_t min_avail;	/**< lowest fill level seen in bytes */
+	uint32_t max_avail;	/**< highest fill level seen in bytes */
+} __attribute__((packed));
+
+struct sof_ipc_stream_stats {
+	uint32_t comp_id;	/**< host component ID */
+	uint32_t seq;		/**< update sequence count */
+	uint64_t frames;	/**< frames processed by the pipeline */
+	uint32_t xruns;		/**< xrun recoveries */
+	uint32_t dma_stalls;	/**< DMA endpoint underruns and overruns */
+	uint32_t task_last_us;	/**< last pipeline task run time */
+	uint32_t task_max_us;	/**< longest pipeline task run time */
+	uint32_t num_buffers;	/**< valid buffer entries */
+	uint32_t reserved[3];
+	struct sof_ipc_stream_stats_buffer buffer[SOF_IPC_STREAM_STATS_BUFFERS];
+} __attribute__((packed));
+
+/*
+ * Coalesced stream positions - SOF_IPC_STREAM_POSITION_BATCH. Bit n of
+ * slot_mask is set when the struct sof_ipc_stream_posn at posn_offset
+ * n * sizeof(struct sof_ipc_stream_posn) in the stream region is updated.
+ */
+struct sof_ipc_stream_posn_batch {
+	struct sof_ipc_reply rhdr;
+	uint32_t slot_mask;	/**< updated position slots */
+	uint32_t reserved[3];
+} __attribute__((packed));
+
+/*
+ * Group trigger - SOF_IPC_STREAM_TRIG_GROUP. Triggers the PCMs of all listed
+ * host components, on whichever cores they run, at a common time delay_us
+ * after the message is received.
+ */
+struct sof_ipc_stream_group {
+	struct sof_ipc_cmd_hdr hdr;
+	uint32_t cmd;		/**< SOF_IPC_STREAM_TRIG_ START/STOP/PAUSE/RELEASE */
+	uint32_t count;		/**< number of comp_id entries */
+	uint32_t delay_us;	/**< start delay, 0 for firmware default */
+	uint32_t reserved[3];
+	uint32_t comp_id[0];	/**< host component ids */
+} __attribute__((packed));
+
 #endif
@@ -40,6 +40,7 @@
 #define __INCLUDE_UAPI_IPC_TOPOLOGY_H__
 
 #include <uapi/ipc/header.h>
+#include <uapi/ipc/stream.h>
 
 /*
  * Component
@@ -64,6 +65,13 @@ enum sof_comp_type {
 	SOF_COMP_EQ_FIR,
 	SOF_COMP_FILEREAD,	/**< host test based file IO */
 	SOF_COMP_FILEWRITE,	/**< host test based file IO */
+	SOF_COMP_ASRC,		/**< asynchronous SRC */
+	SOF_COMP_CONV,		/**< format converter */
+	SOF_COMP_DRC,		/**< dynamic range compressor */
+	SOF_COMP_KPB,		/**< key phrase history buffer */
+	SOF_COMP_DECODER,	/**< compressed offload decoder */
+	SOF_COMP_VOICE,		/**< voice capture front end */
+	SOF_COMP_CROSSOVER,	/**< crossover band split */
 };
 
 /* XRUN action for component */
@@ -97,6 +105,11 @@ struct sof_ipc_comp {
 #define SOF_MEM_CAPS_DMA			(1 << 5) /**< DMA'able */
 #define SOF_MEM_CAPS_CACHE			(1 << 6) /**< cacheable */
 #define SOF_MEM_CAPS_EXEC			(1 << 7) /**< executable */
+#define SOF_MEM_CAPS_SHARED			(1 << 8) /**< coherent between cores */
+#define SOF_MEM_CAPS_ZERO			(1 << 9) /**< zero on every reset */
+#define SOF_MEM_CAPS_POW2			(1 << 10) /**< power of two ring */
+#define SOF_MEM_CAPS_FANOUT			(1 << 11) /**< shares data with the other fan-out sinks of its source */
+#define SOF_MEM_CAPS_LOOPBACK			(1 << 12) /**< fan-out sink trailing the playback DAI */
 
 /* create new component buffer - SOF_IPC_TPLG_BUFFER_NEW */
 struct sof_ipc_buffer {
@@ -137,10 +150,25 @@ struct sof_ipc_comp_dai {
 	uint32_t dmac_config; /**< DMA engine specific */
 } __attribute__((packed));
 
+/* mixer handling of a source short of a period */
+enum sof_mixer_underrun {
+	SOF_MIXER_UNDERRUN_XRUN		= 0,	/**< xrun the mixer pipeline */
+	SOF_MIXER_UNDERRUN_SILENCE,		/**< mix the source as silence */
+};
+
 /* generic mixer component */
 struct sof_ipc_comp_mixer {
 	struct sof_ipc_comp comp;
 	struct sof_ipc_comp_config config;
+	uint32_t underrun;	/**< SOF_MIXER_UNDERRUN_ */
+} __attribute__((packed));
+
+/* generic switch component */
+struct sof_ipc_comp_switch {
+	struct sof_ipc_comp comp;
+	struct sof_ipc_comp_config config;
+	uint32_t route;		/**< output fed at start, in buffer id order */
+	uint32_t fade_ms;	/**< crossfade length, 0 for the default */
 } __attribute__((packed));
 
 /* volume ramping types */
@@ -151,6 +179,12 @@ enum sof_volume_ramp {
 	SOF_VOLUME_LOG_ZC,
 };
 
+/* volume gain precision */
+enum sof_volume_precision {
+	SOF_VOLUME_PRECISION_Q1_31	= 0,	/**< 32 bit gains, all formats */
+	SOF_VOLUME_PRECISION_Q1_15,		/**< 16 bit gains for s16 */
+};
+
 /* generic volume component */
 struct sof_ipc_comp_volume {
 	struct sof_ipc_comp comp;
@@ -160,6 +194,7 @@ struct sof_ipc_comp_volume {
 	uint32_t max_value;
 	uint32_t ramp;		/**< SOF_VOLUME_ */
 	uint32_t initial_ramp;	/**< ramp space in ms */
+	uint32_t precision;	/**< SOF_VOLUME_PRECISION_ */
 } __attribute__((packed));
 
 /* generic SRC component */
@@ -172,10 +207,44 @@ struct sof_ipc_comp_src {
 	uint32_t rate_mask;	/**< SOF_RATE_ supported rates */
 } __attribute__((packed));
 
-/* generic MUX component */
+/* generic ASRC component */
+struct sof_ipc_comp_asrc {
+	struct sof_ipc_comp comp;
+	struct sof_ipc_comp_config config;
+	/* either source or sink rate must be non zero */
+	uint32_t source_rate;	/**< source rate or 0 for variable */
+	uint32_t sink_rate;	/**< sink rate or 0 for variable */
+	uint32_t asynchronous_mode;	/**< track DAI clock drift if non zero */
+} __attribute__((packed));
+
+/* generic format converter component */
+struct sof_ipc_comp_conv {
+	struct sof_ipc_comp comp;
+	struct sof_ipc_comp_config config;	/**< frame_fmt is DAI side */
+	uint32_t channels;	/**< DAI side channels or 0 for same as host */
+} __attribute__((packed));
+
+/* maximum number of streams routed by a MUX component */
+#define SOF_IPC_MAX_MUX_STREAMS	8
+
+/* channel routing of one stream buffer connected to a MUX component */
+struct sof_ipc_mux_stream {
+	uint32_t buffer_id;	/**< stream buffer component id */
+	uint32_t channels;	/**< stream buffer channels */
+	uint8_t map[SOF_IPC_MAX_CHANNELS];	/**< mux side channel of each
+						  *  stream channel */
+} __attribute__((packed));
+
+/*
+ * generic MUX component, several source streams are muxed into the
+ * channels of one sink or one source is demuxed to several sink streams
+ */
 struct sof_ipc_comp_mux {
 	struct sof_ipc_comp comp;
 	struct sof_ipc_comp_config config;
+	uint32_t channels;	/**< mux side channels or 0 for same as params */
+	uint32_t num_streams;	/**< number of routed streams */
+	struct sof_ipc_mux_stream streams[SOF_IPC_MAX_MUX_STREAMS];
 } __attribute__((packed));
 
 /* generic tone generator component */
@@ -230,6 +299,80 @@ struct sof_ipc_comp_eq_iir {
 	unsigned char data[0];
 } __attribute__((packed));
 
+/* dynamic range compressor / limiter component */
+struct sof_ipc_comp_drc {
+	struct sof_ipc_comp comp;
+	struct sof_ipc_comp_config config;
+	uint32_t size;
+
+	/* reserved for future use */
+	uint32_t reserved[8];
+
+	unsigned char data[0];
+} __attribute__((packed));
+
+/* maximum number of bands of a crossover component */
+#define SOF_IPC_MAX_CROSSOVER_BANDS	4
+
+/*
+ * crossover component, splits one stream into frequency bands that go to
+ * the sink buffers listed in band order or, with a single sink buffer, to
+ * its channels with the channels of each band after the previous band
+ */
+struct sof_ipc_comp_crossover {
+	struct sof_ipc_comp comp;
+	struct sof_ipc_comp_config config;
+	uint32_t num_bands;	/**< number of output bands */
+	/** sink buffer component id of each band */
+	uint32_t sink_buffer_id[SOF_IPC_MAX_CROSSOVER_BANDS];
+	uint32_t size;		/**< size of struct sof_crossover_config */
+
+	/* reserved for future use */
+	uint32_t reserved[8];
+
+	unsigned char data[0];
+} __attribute__((packed));
+
+/* voice capture front end - decimation, high-pass IIR and gain in one pass */
+struct sof_ipc_comp_voice {
+	struct sof_ipc_comp comp;
+	struct sof_ipc_comp_config config;
+	/* either source or sink rate must be non zero */
+	uint32_t source_rate;	/**< source rate or 0 for variable */
+	uint32_t sink_rate;	/**< sink rate or 0 for variable */
+	uint32_t size;		/**< size of struct sof_voice_config in data */
+
+	/* reserved for future use */
+	uint32_t reserved[8];
+
+	unsigned char data[0];
+} __attribute__((packed));
+
+/* key phrase buffer - history of low power capture drained on wake */
+struct sof_ipc_comp_kpb {
+	struct sof_ipc_comp comp;
+	struct sof_ipc_comp_config config;
+	uint32_t history_ms;	/**< history length in ms, 0 for default */
+
+	/* reserved for future use */
+	uint32_t reserved[7];
+} __attribute__((packed));
+
+/* decoder codec ids */
+#define SOF_IPC_CODEC_PCM	0	/**< passthrough, for validation */
+#define SOF_IPC_CODEC_MP3	1
+#define SOF_IPC_CODEC_AAC	2
+
+/* compressed offload decoder - host compressed stream to PCM */
+struct sof_ipc_comp_decoder {
+	struct sof_ipc_comp comp;
+	struct sof_ipc_comp_config config;
+	uint32_t codec_id;	/**< SOF_IPC_CODEC_ */
+
+	/* reserved for future use */
+	uint32_t reserved[7];
+} __attribute__((packed));
+
 /* frees components, buffers and pipelines
  * SOF_IPC_TPLG_COMP_FREE, SOF_IPC_TPLG_PIPE_FREE, SOF_IPC_TPLG_BUFFER_FREE
  */
@@ -263,6 +406,18 @@ struct sof_ipc_pipe_new {
 
 	/* non zero if timer scheduled, otherwise DAI DMA irq scheduled */
 	uint32_t timer_delay;
+
+	/* periods processed per run for throughput pipelines, 0 is one */
+	uint32_t periods_per_sched;
+
+	/* ms of silent sources before the pipeline idles, 0 never idles */
+	uint32_t idle_ms;
+
+	/* non zero if sink free space drives the copies, see SOF_TKN_SCHED_PULL */
+	uint32_t pull;
+
+	/* non zero if playback starts on silence, see SOF_TKN_SCHED_FAST_START */
+	uint32_t fast_start;
 } __attribute__((packed));
 
 /* pipeline construction complete - SOF_IPC_TPLG_PIPE_COMPLETE */
@@ -283,4 +438,70 @@ struct sof_ipc_pipe_comp_connect {
 	uint32_t sink_id;
 } __attribute__((packed));
 
+/*
+ * Batched topology construction - SOF_IPC_TPLG_BATCH.
+ *
+ * The header is followed by count descriptors. Each descriptor is a complete
+ * SOF_IPC_TPLG_COMP_NEW, SOF_IPC_TPLG_BUFFER_NEW, SOF_IPC_TPLG_PIPE_NEW,
+ * SOF_IPC_TPLG_COMP_CONNECT or SOF_IPC_TPLG_PIPE_COMPLETE body starting with
+ * its own sof_ipc_cmd_hdr, padded to a multiple of 4 bytes. A pipeline may
+ * only be completed in the batch that created it.
+ *
+ * Descriptors are applied in order. If one fails, all descriptors applied
+ * before it are undone and the reply reports the failing index in done.
+ */
+struct sof_ipc_tplg_batch {
+	struct sof_ipc_cmd_hdr hdr;
+	uint32_t count;		/**< number of descriptors */
+	uint32_t reserved[2];
+	unsigned char data[0];	/**< descriptors */
+} __attribute__((packed));
+
+struct sof_ipc_tplg_batch_reply {
+	struct sof_ipc_reply rhdr;
+	uint32_t done;		/**< descriptors applied */
+	uint32_t reserved[3];
+} __attribute__((packed));
+
+/*
+ * Pre-linked topology blob - SOF_IPC_TPLG_BLOB.
+ *
+ * The host buffer holds a sof_ipc_tplg_blob_hdr followed by descriptors in
+ * the SOF_IPC_TPLG_BATCH format, ordered so every object is created before
+ * it is connected. The firmware fetches the whole blob with one DMA and
+ * applies it like a batch without the batch descriptor limit, so a complete
+ * topology can be built or rebuilt on resume with one IPC. The reply is a
+ * sof_ipc_tplg_batch_reply.
+ */
+#define SOF_IPC_TPLG_BLOB_MAGIC		0x534f4642	/* "SOFB" */
+
+struct sof_ipc_tplg_blob_hdr {
+	uint32_t magic;		/**< SOF_IPC_TPLG_BLOB_MAGIC */
+	uint32_t abi;		/**< SOF_ABI_VERSION the blob was built for */
+	uint32_t size;		/**< bytes including this header */
+	uint32_t count;		/**< number of descriptors */
+	uint32_t reserved[4];
+} __attribute__((packed));
+
+struct sof_ipc_tplg_blob {
+	struct sof_ipc_cmd_hdr hdr;
+	struct sof_ipc_host_buffer buffer;	/**< blob location in host */
+	uint32_t reserved[4];
+} __attribute__((packed));
+
+/*
+ * Loadable component module - SOF_IPC_TPLG_MODULE_NEW.
+ *
+ * Points the firmware at a module image (uapi/user/module.h) providing a
+ * component type that isn't built in. The host buffer must stay valid while
+ * the firmware runs, the image is only fetched on the first SOF_IPC_TPLG_
+ * COMP_NEW of that type.
+ */
+struct sof_ipc_module_new {
+	struct sof_ipc_cmd_hdr hdr;
+	uint32_t comp_type;			/**< SOF_COMP_ type provided */
+	struct sof_ipc_host_buffer buffer;	/**< image location in host */
+	uint32_t reserved[4];
+} __attribute__((packed));
+
 #endif
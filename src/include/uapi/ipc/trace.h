@@ -63,6 +63,21 @@ struct sof_ipc_dma_trace_posn {
 	uint32_t messages;	/* total trace messages */
 } __attribute__((packed));
 
+/* trace filter element - applies level to class, optionally one comp */
+struct sof_ipc_trace_filter_elem {
+	uint32_t trace_class;	/* TRACE_CLASS_ value */
+	int32_t comp_id;	/* component id or -1 for the whole class */
+	uint32_t level;		/* highest LOG_LEVEL_ passed, 0 mutes */
+} __attribute__((packed));
+
+/* Runtime trace filter - SOF_IPC_TRACE_FILTER_UPDATE */
+struct sof_ipc_trace_filter {
+	struct sof_ipc_cmd_hdr hdr;
+	uint32_t elem_cnt;		/* number of elems */
+	uint32_t reserved[2];
+	struct sof_ipc_trace_filter_elem elems[0];
+} __attribute__((packed));
+
 /*
  * Commom debug
  */
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Seppo Ingalsuo <seppo.ingalsuo@linux.intel.com>
+ */
+
+#ifndef __INCLUDE_UAPI_USER_CROSSOVER_H__
+#define __INCLUDE_UAPI_USER_CROSSOVER_H__
+
+#include <stdint.h>
+
+/* Crossover type */
+
+#define SOF_CROSSOVER_MAX_SIZE 1024 /* Max size allowed for config data */
+
+#define SOF_CROSSOVER_MAX_BANDS 4 /* Max number of output bands */
+
+#define SOF_CROSSOVER_MAX_RESPONSES 8 /* Max responses in a blob */
+
+/* crossover_configuration
+ *     uint32_t size
+ *         This is the number of bytes need to store the received crossover
+ *         configuration.
+ *     uint32_t num_bands
+ *         Number of output bands, 2 to SOF_CROSSOVER_MAX_BANDS. It must
+ *         match the num_bands of the component.
+ *     uint32_t number_of_responses
+ *         Number of split responses in data[].
+ *     int32_t data[]
+ *         struct sof_crossover_split split[num_bands - 1]
+ *         response_data[]
+ *             The split filters in the same format as IIR EQ responses,
+ *             see struct sof_eq_iir_header_df2t. All channels use the same
+ *             filters.
+ *
+ * The splits are run in a cascade from the lowest crossover frequency up.
+ * Split k low passes its input to band k and high passes it to the input
+ * of split k + 1, the last split high passes to the last band. Each band
+ * is so computed once from the shared high band of the previous split.
+ *
+ * For Linkwitz-Riley crossovers the low and high pass responses of a
+ * split are two Butterworth sections each. The lower bands do not go
+ * through the later splits, so a split can have an all-pass response of
+ * its crossover frequency that is run on each lower band to keep the band
+ * phases aligned. It is ignored for the first split.
+ */
+
+struct sof_crossover_split {
+	int32_t lowpass;	/* low pass response */
+	int32_t highpass;	/* high pass response */
+	int32_t allpass;	/* lower bands phase alignment, -1 = none */
+
+	/* reserved */
+	uint32_t reserved;
+} __attribute__((packed));
+
+struct sof_crossover_config {
+	uint32_t size;
+	uint32_t num_bands;
+	uint32_t number_of_responses;
+
+	/* reserved */
+	uint32_t reserved[5];
+
+	int32_t data[]; /* split[num_bands - 1], response 0, response 1, ... */
+} __attribute__((packed));
+
+/* The number of int32_t words in sof_crossover_split */
+#define SOF_CROSSOVER_NSPLIT \
+	(sizeof(struct sof_crossover_split) / sizeof(int32_t))
+
+#endif /* __INCLUDE_UAPI_USER_CROSSOVER_H__ */
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Seppo Ingalsuo <seppo.ingalsuo@linux.intel.com>
+ */
+
+#ifndef __INCLUDE_UAPI_USER_DRC_H__
+#define __INCLUDE_UAPI_USER_DRC_H__
+
+#include <stdint.h>
+
+/* Dynamic range compressor / limiter type */
+
+#define SOF_DRC_MAX_SIZE 1024 /* Max size allowed for config data in bytes */
+
+#define SOF_DRC_MAX_BANDS 3 /* Max number of compressed bands */
+
+#define SOF_DRC_MAX_LOOKAHEAD_US 5000 /* Max peak detect look-ahead */
+
+/* drc_configuration
+ *     uint32_t size
+ *         This is the number of bytes need to store the received DRC
+ *         configuration.
+ *     uint32_t num_bands
+ *         Number of bands, 1 to SOF_DRC_MAX_BANDS. The output is the sum of
+ *         the compressed bands.
+ *     uint32_t lookahead_us
+ *         The output is delayed by this time so gain reduction starts
+ *         before a peak reaches the output. It is rounded up to the gain
+ *         computation block.
+ *     uint32_t number_of_responses
+ *         Number of band split responses in data[].
+ *     int32_t data[]
+ *         struct sof_drc_band band[num_bands]
+ *         response_data[]
+ *             The band split filters in the same format as IIR EQ
+ *             responses, see struct sof_eq_iir_header_df2t. All channels
+ *             use the same filters. The filters are run in parallel on the
+ *             input so e.g. a 3-band setup has a low pass, a band pass and
+ *             a high pass response of Linkwitz-Riley crossovers.
+ *
+ * The gain is computed from the peak of all channels so the stereo image
+ * stays in place when one side exceeds the threshold.
+ */
+
+struct sof_drc_band {
+	int32_t response;	/* band split response, -1 = full band */
+	int32_t threshold;	/* Q16.16 dB */
+	int32_t ratio;		/* Q16.16 ratio >= 1.0, 0 = limiter */
+	int32_t makeup_gain;	/* Q16.16 dB */
+	uint32_t attack_us;	/* gain reduction time constant */
+	uint32_t release_us;	/* gain recovery time constant */
+
+	/* reserved */
+	uint32_t reserved[2];
+} __attribute__((packed));
+
+struct sof_drc_config {
+	uint32_t size;
+	uint32_t num_bands;
+	uint32_t lookahead_us;
+	uint32_t number_of_responses;
+
+	/* reserved */
+	uint32_t reserved[4];
+
+	int32_t data[]; /* band[num_bands], response 0, response 1, ... */
+} __attribute__((packed));
+
+/* The number of int32_t words in sof_drc_band */
+#define SOF_DRC_NBAND (sizeof(struct sof_drc_band) / sizeof(int32_t))
+
+#endif /* __INCLUDE_UAPI_USER_DRC_H__ */
@@ -41,6 +41,11 @@
 
 #define SOF_EQ_FIR_MAX_LENGTH 192 /* Max length for individual filter */
 
+/* Responses longer than SOF_EQ_FIR_MAX_LENGTH are run with partitioned FFT
+ * convolution. The length is also limited by SOF_EQ_FIR_MAX_SIZE.
+ */
+#define SOF_EQ_FIR_FFT_MAX_LENGTH 2048
+
 #define SOF_EQ_FIR_MAX_RESPONSES 8 /* A blob can define max 8 FIR EQs */
 
 /*
@@ -128,6 +133,7 @@ struct sof_eq_fir_coef_data {
  *             <1st EQ>
  *             uint32_t num_biquads
  *             uint32_t num_biquads_in_series
+ *             uint32_t precision     SOF_EQ_IIR_PRECISION_ of filter state
  *             <1st biquad>
  *             int32_t coef_a2       Q2.30 format
  *             int32_t coef_a1       Q2.30 format
@@ -159,9 +165,10 @@ struct sof_eq_iir_config {
 struct sof_eq_iir_header_df2t {
 	uint32_t num_sections;
 	uint32_t num_sections_in_series;
+	uint32_t precision; /* SOF_EQ_IIR_PRECISION_ */
 
 	/* reserved */
-	uint32_t reserved[4];
+	uint32_t reserved[3];
 
 	int32_t biquads[]; /* Repeated biquad coefficients */
 } __attribute__((packed));
@@ -176,13 +183,23 @@ struct sof_eq_iir_biquad_df2t {
 	int32_t output_gain;  /* Q2.14 */
 } __attribute__((packed));
 
+/* Precision of the filter state. The default keeps Q3.61 state and suits
+ * any response. Q3.29 state halves the delay line memory and the state
+ * loads and stores. It is enough for mild shelving and peaking sections
+ * and e.g. a voice band high-pass, but the state rounding noise grows as
+ * the poles get close to the unit circle, so sections with very low corner
+ * frequency versus the sample rate should keep the 64 bit state.
+ */
+#define SOF_EQ_IIR_PRECISION_64	0
+#define SOF_EQ_IIR_PRECISION_32	1
+
 /* A full 22th order equalizer with 11 biquads cover octave bands 1-11 in
  * in the 0 - 20 kHz bandwidth.
  */
 #define SOF_EQ_IIR_DF2T_BIQUADS_MAX 11
 
 /* The number of int32_t words in sof_eq_iir_header_df2t:
- *	num_sections, num_sections_in_series, reserved[4]
+ *	num_sections, num_sections_in_series, precision, reserved[3]
  */
 #define SOF_EQ_IIR_NHEADER_DF2T \
 	(sizeof(struct sof_eq_iir_header_df2t) / sizeof(int32_t))
@@ -73,13 +73,23 @@ union sof_man_segment_flags {
 		uint32_t readonly:1;
 		uint32_t code:1;
 		uint32_t data:1;
-		uint32_t _rsvd0:2;
+		uint32_t compressed:1;	/* sof_man_lz4_hdr at file_offset */
+		uint32_t _rsvd0:1;
 		uint32_t type:4;	/* MAN_SEGMENT_ */
 		uint32_t _rsvd1:4;
 		uint32_t length:16;	/* of segment in pages */
 	} r;
 } __attribute__((packed));
 
+/*
+ * Compressed segment data, followed by size bytes of an LZ4 block that
+ * decompresses to the segment length. Never used for the boot loader
+ * module as the ROM doesn't decompress.
+ */
+struct sof_man_lz4_hdr {
+	uint32_t size;		/* compressed bytes after this header */
+} __attribute__((packed));
+
 /*
  * Module segment descriptor. Used by ROM - Immutable.
  */
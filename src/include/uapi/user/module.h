@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Liam Girdwood <liam.r.girdwood@linux.intel.com>
+ */
+
+/*
+ * Loadable component module image format.
+ *
+ * A module is linked at address 0 and packed by scripts/sof-module-pack.py.
+ * The image is the module text and data, followed by its relocations and
+ * imports. bss follows the image in memory and is zeroed by the loader.
+ *
+ * Every relocation patches a 32 bit word in the image: BASE adds the load
+ * address, IMPORT stores the address of a firmware exported symbol. The init
+ * function at init_offset registers the module component driver.
+ */
+
+#ifndef __INCLUDE_UAPI_USER_MODULE_H__
+#define __INCLUDE_UAPI_USER_MODULE_H__
+
+#include <stdint.h>
+
+#define SOF_MODULE_MAGIC		0x4d464f53	/* "SOFM" */
+#define SOF_MODULE_NAME_SIZE		32
+
+#define SOF_MODULE_RELOC_BASE		0
+#define SOF_MODULE_RELOC_IMPORT		1
+
+struct sof_module_hdr {
+	uint32_t magic;		/**< SOF_MODULE_MAGIC */
+	uint32_t abi;		/**< SOF_ABI_VERSION the module was built for */
+	uint32_t comp_type;	/**< component type the module registers */
+	uint32_t size;		/**< bytes including this header */
+	uint32_t image_size;	/**< text and data bytes after this header */
+	uint32_t bss_size;	/**< zeroed bytes after the image */
+	uint32_t init_offset;	/**< int init(void) offset in the image */
+	uint32_t reloc_count;	/**< relocations after the image */
+	uint32_t import_count;	/**< imports after the relocations */
+	uint32_t reserved[3];
+} __attribute__((packed));
+
+struct sof_module_reloc {
+	uint32_t offset;	/**< word offset in the image, in bytes */
+	uint32_t type;		/**< SOF_MODULE_RELOC_ */
+	uint32_t import;	/**< import index for SOF_MODULE_RELOC_IMPORT */
+} __attribute__((packed));
+
+struct sof_module_import {
+	char name[SOF_MODULE_NAME_SIZE];	/**< nul terminated symbol */
+} __attribute__((packed));
+
+#endif
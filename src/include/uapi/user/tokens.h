@@ -66,10 +66,15 @@
 #define SOF_TKN_SCHED_CORE			203
 #define SOF_TKN_SCHED_FRAMES			204
 #define SOF_TKN_SCHED_TIMER			205
+#define SOF_TKN_SCHED_PERIODS			206
+#define SOF_TKN_SCHED_IDLE			207
+#define SOF_TKN_SCHED_PULL			208
+#define SOF_TKN_SCHED_FAST_START		209
 
 /* volume */
 #define SOF_TKN_VOLUME_RAMP_STEP_TYPE		250
 #define SOF_TKN_VOLUME_RAMP_STEP_MS		251
+#define SOF_TKN_VOLUME_PRECISION		252
 
 /* SRC */
 #define SOF_TKN_SRC_RATE_IN			300
@@ -113,4 +118,11 @@
 
 #define SOF_TKN_EFFECT_TYPE                     900
 
+/* mixer */
+#define SOF_TKN_MIXER_UNDERRUN			1000
+
+/* switch */
+#define SOF_TKN_SWITCH_ROUTE			1100
+#define SOF_TKN_SWITCH_FADE_MS			1101
+
 #endif
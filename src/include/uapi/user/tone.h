@@ -31,6 +31,8 @@
 #ifndef __INCLUDE_UAPI_USER_TONE_H__
 #define __INCLUDE_UAPI_USER_TONE_H__
 
+#include <stdint.h>
+
 /* Component will reject non-matching configuration. The version number need
  * to be incremented with any ABI changes in function fir_cmd().
  */
@@ -45,4 +47,46 @@
 #define SOF_TONE_IDX_REPEATS		6
 #define SOF_TONE_IDX_LIN_RAMP_STEP	7
 
+#define SOF_TONE_WAVE_MAX_SIZE		16384 /* Max size of wavetable blob */
+
+/* Wavetable sent with SOF_CTRL_CMD_BINARY, it replaces the oscillator
+ * output while set. A blob with zero length returns to the oscillator.
+ *
+ *     uint32_t size
+ *         Bytes of the blob including data[].
+ *     uint32_t channels
+ *         Channels of the table, 1 copies it to every channel, otherwise
+ *         it must match the stream channels.
+ *     uint32_t length
+ *         Table length in frames.
+ *     uint32_t silence
+ *         Zero frames after the table before it repeats, e.g. the pause
+ *         of a beep. The period is length + silence frames.
+ *     uint32_t rate
+ *         Sample rate of the table in Hz, 0 means the stream rate.
+ *     int32_t frequency
+ *         Repeat frequency of the table as Q16.16 Hz when the table is one
+ *         cycle of a waveform, it overrides rate. 0 uses rate.
+ *     int32_t data[]
+ *         Interleaved S32 samples, channels * length of them.
+ *
+ * The table and silence are stepped through at rate / stream rate frames,
+ * or frequency * length / stream rate with frequency. A step of exactly
+ * one frame is copied as is, other steps interpolate linearly between
+ * table frames.
+ */
+struct sof_tone_wave_config {
+	uint32_t size;
+	uint32_t channels;
+	uint32_t length;
+	uint32_t silence;
+	uint32_t rate;
+	int32_t frequency;
+
+	/* reserved */
+	uint32_t reserved[2];
+
+	int32_t data[];
+} __attribute__((packed));
+
 #endif /* __INCLUDE_UAPI_USER_TONE_H__ */
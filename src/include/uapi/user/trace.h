@@ -49,6 +49,74 @@ struct system_time {
 	uint32_t val_u;  /* Upper dword of current host time value */
 } __attribute__((packed));
 
+/* bootloader trace values */
+#define TRACE_BOOT_LDR_ENTRY		0x100
+#define TRACE_BOOT_LDR_HPSRAM		0x110
+#define TRACE_BOOT_LDR_MANIFEST	0x120
+#define TRACE_BOOT_LDR_JUMP		0x150
+
+#define TRACE_BOOT_LDR_PARSE_MODULE	0x210
+#define TRACE_BOOT_LDR_PARSE_SEGMENT	0x220
+
+/* general trace init codes - only used at boot when main trace is not available */
+#define TRACE_BOOT_START		0x1000
+#define TRACE_BOOT_ARCH		0x2000
+#define TRACE_BOOT_SYS			0x3000
+#define TRACE_BOOT_PLATFORM		0x4000
+#define TRACE_BOOT_TASK			0x5000
+
+/* system specific codes */
+#define TRACE_BOOT_SYS_WORK		(TRACE_BOOT_SYS + 0x100)
+#define TRACE_BOOT_SYS_CPU_FREQ		(TRACE_BOOT_SYS + 0x200)
+#define TRACE_BOOT_SYS_HEAP		(TRACE_BOOT_SYS + 0x300)
+#define TRACE_BOOT_SYS_NOTE		(TRACE_BOOT_SYS + 0x400)
+#define TRACE_BOOT_SYS_SCHED		(TRACE_BOOT_SYS + 0x500)
+#define TRACE_BOOT_SYS_POWER		(TRACE_BOOT_SYS + 0x600)
+#define TRACE_BOOT_SYS_TRACE		(TRACE_BOOT_SYS + 0x700)
+
+/* platform/device specific codes */
+#define TRACE_BOOT_PLATFORM_ENTRY	(TRACE_BOOT_PLATFORM + 0x100)
+#define TRACE_BOOT_PLATFORM_MBOX	(TRACE_BOOT_PLATFORM + 0x110)
+#define TRACE_BOOT_PLATFORM_SHIM	(TRACE_BOOT_PLATFORM + 0x120)
+#define TRACE_BOOT_PLATFORM_PMC		(TRACE_BOOT_PLATFORM + 0x130)
+#define TRACE_BOOT_PLATFORM_TIMER	(TRACE_BOOT_PLATFORM + 0x140)
+#define TRACE_BOOT_PLATFORM_CLOCK	(TRACE_BOOT_PLATFORM + 0x150)
+#define TRACE_BOOT_PLATFORM_SSP_FREQ	(TRACE_BOOT_PLATFORM + 0x160)
+#define TRACE_BOOT_PLATFORM_IPC		(TRACE_BOOT_PLATFORM + 0x170)
+#define TRACE_BOOT_PLATFORM_DMA		(TRACE_BOOT_PLATFORM + 0x180)
+#define TRACE_BOOT_PLATFORM_SSP		(TRACE_BOOT_PLATFORM + 0x190)
+#define TRACE_BOOT_PLATFORM_DMIC	(TRACE_BOOT_PLATFORM + 0x1a0)
+#define TRACE_BOOT_PLATFORM_IDC		(TRACE_BOOT_PLATFORM + 0x1b0)
+#define TRACE_BOOT_PLATFORM_DAI		(TRACE_BOOT_PLATFORM + 0x1c0)
+#define TRACE_BOOT_PLATFORM_DMA_TRACE	(TRACE_BOOT_PLATFORM + 0x1d0)
+
+/* task specific codes */
+#define TRACE_BOOT_TASK_COMP		(TRACE_BOOT_TASK + 0x100)
+#define TRACE_BOOT_TASK_READY		(TRACE_BOOT_TASK + 0x200)
+
+/*
+ * Boot profile (CONFIG_BOOT_PROFILE).
+ *
+ * The master core records the wall clock at each boot trace point and
+ * writes the record to the start of the mailbox debug region just before
+ * FW_READY. Timestamps are in platform timer ticks. Points that don't fit
+ * the region are counted in dropped.
+ */
+#define SOF_BOOT_PROFILE_MAGIC		0x544f4f42	/* "BOOT" */
+
+struct sof_boot_profile_point {
+	uint32_t point;			/* TRACE_BOOT_ code */
+	uint64_t timestamp;		/* platform timer ticks */
+} __attribute__((packed));
+
+struct sof_boot_profile {
+	uint32_t magic;			/* SOF_BOOT_PROFILE_MAGIC */
+	uint32_t count;			/* points recorded */
+	uint32_t dropped;		/* points that didn't fit */
+	uint32_t reserved;
+	struct sof_boot_profile_point points[0];
+} __attribute__((packed));
+
 /* trace event classes - high 8 bits*/
 #define TRACE_CLASS_IRQ		(1 << 24)
 #define TRACE_CLASS_IPC		(2 << 24)
@@ -115,4 +183,30 @@ struct log_entry_header {
 	uint32_t log_entry_address;	/* Address of log entry in ELF */
 } __attribute__((packed));
 
+/*
+ * Packed DMA trace records (CONFIG_TRACE_PACKED).
+ *
+ * Each record starts with a tag byte. A sync record is the tag followed by
+ * SOF_TRACE_PACK_MAGIC and the absolute 64 bit little endian timestamp, it
+ * resets the delta state of the decoder. An event record is followed by
+ *   zigzag varint timestamp delta to the previous record
+ *   varint id_0 and varint id_1	unless SOF_TRACE_PACK_SAME_IDS
+ *   core id byte			unless SOF_TRACE_PACK_SAME_CORE
+ *   zigzag varint log entry address delta to the previous record
+ *   varint of each parameter
+ * Varints are little endian base 128 with the top bit set on all but the
+ * last byte.
+ */
+#define SOF_TRACE_PACK_SAME_IDS		0x01
+#define SOF_TRACE_PACK_SAME_CORE	0x02
+#define SOF_TRACE_PACK_PARAMS_SHIFT	2
+#define SOF_TRACE_PACK_PARAMS_MASK	0x1c
+#define SOF_TRACE_PACK_TYPE_MASK	0xe0
+#define SOF_TRACE_PACK_TYPE_EVENT	0x00
+#define SOF_TRACE_PACK_TYPE_SYNC	0xe0
+
+#define SOF_TRACE_PACK_MAGIC		"SPK"
+#define SOF_TRACE_PACK_MAGIC_SIZE	3
+#define SOF_TRACE_PACK_SYNC_SIZE	(1 + SOF_TRACE_PACK_MAGIC_SIZE + 8)
+
 #endif //#ifndef __INCLUDE_LOGGING__
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Seppo Ingalsuo <seppo.ingalsuo@linux.intel.com>
+ */
+
+#ifndef __INCLUDE_UAPI_USER_VOICE_H__
+#define __INCLUDE_UAPI_USER_VOICE_H__
+
+#include <stdint.h>
+
+/* Voice capture front end type */
+
+#define SOF_VOICE_MAX_SIZE 512 /* Max size allowed for config data in bytes */
+
+#define SOF_VOICE_GAIN_ZERO_DB (1 << 16) /* Q8.16 unity gain */
+
+/* voice_configuration
+ *     uint32_t size
+ *         This is the number of bytes need to store the received voice
+ *         front end configuration.
+ *     int32_t gain
+ *         Q8.16 linear gain applied after the high-pass filter to all
+ *         channels. The volume control can change it per channel.
+ *     uint32_t num_responses
+ *         0 to run without high-pass filter, 1 if data[] holds one.
+ *     int32_t data[]
+ *         The high-pass filter in the same format as an IIR EQ response,
+ *         see struct sof_eq_iir_header_df2t. All channels use it.
+ */
+
+struct sof_voice_config {
+	uint32_t size;
+	int32_t gain;
+	uint32_t num_responses;
+
+	/* reserved */
+	uint32_t reserved[4];
+
+	int32_t data[]; /* high-pass response */
+} __attribute__((packed));
+
+#endif /* __INCLUDE_UAPI_USER_VOICE_H__ */
@@ -43,6 +43,7 @@
 #include <sof/schedule.h>
 #include <sof/dma-trace.h>
 #include <sof/pm_runtime.h>
+#include <sof/timebase.h>
 #include <sof/cpu.h>
 #include <platform/idc.h>
 #include <platform/platform.h>
@@ -64,6 +65,7 @@ int master_core_init(struct sof *sof)
 	trace_point(TRACE_BOOT_SYS_HEAP);
 	init_heap(sof);
 
+	trace_point(TRACE_BOOT_SYS_TRACE);
 	trace_init(sof);
 
 	trace_point(TRACE_BOOT_SYS_NOTE);
@@ -80,6 +82,8 @@ int master_core_init(struct sof *sof)
 	if (err < 0)
 		panic(SOF_IPC_PANIC_PLATFORM);
 
+	timebase_init();
+
 	trace_point(TRACE_BOOT_PLATFORM);
 
 	/* should not return */
@@ -109,6 +109,22 @@ int dma_copy_to_host_nowait(struct dma_copy *dc, struct dma_sg_config *host_sg,
 	return size;
 }
 
+int dma_copy_from_host_nowait(struct dma_copy *dc,
+			      struct dma_sg_config *host_sg,
+			      int32_t host_offset, void *local_ptr,
+			      int32_t size)
+{
+	int ret;
+
+	/* tell gateway to copy */
+	ret = dma_copy(dc->dmac, dc->chan, size, 0);
+	if (ret < 0)
+		return ret;
+
+	/* bytes copied */
+	return size;
+}
+
 #else
 
 int dma_copy_to_host_nowait(struct dma_copy *dc, struct dma_sg_config *host_sg,
@@ -138,10 +154,60 @@ int dma_copy_to_host_nowait(struct dma_copy *dc, struct dma_sg_config *host_sg,
 	/* configure local DMA elem */
 	local_sg_elem.dest = host_sg_elem->dest + offset;
 	local_sg_elem.src = (uint32_t)local_ptr;
-	if (size >= HOST_PAGE_SIZE - offset)
-		local_sg_elem.size = HOST_PAGE_SIZE - offset;
-	else
-		local_sg_elem.size = size;
+	local_sg_elem.size = MIN(size, MIN(HOST_PAGE_SIZE,
+					   host_sg_elem->size - offset));
+
+	config.elem_array.elems = &local_sg_elem;
+	config.elem_array.count = 1;
+
+	/* start the DMA */
+	err = dma_set_config(dc->dmac, dc->chan, &config);
+	if (err < 0)
+		return err;
+
+	err = dma_start(dc->dmac, dc->chan);
+	if (err < 0)
+		return err;
+
+	/* bytes copied */
+	return local_sg_elem.size;
+}
+
+/* Copy host memory to DSP memory.
+ * Copies host to DSP memory in a single PAGE_SIZE or smaller block. Does not
+ * waits/sleeps and can be used in IRQ context.
+ */
+int dma_copy_from_host_nowait(struct dma_copy *dc,
+			      struct dma_sg_config *host_sg,
+			      int32_t host_offset, void *local_ptr,
+			      int32_t size)
+{
+	struct dma_sg_config config;
+	struct dma_sg_elem *host_sg_elem;
+	struct dma_sg_elem local_sg_elem;
+	int32_t err;
+	int32_t offset = host_offset;
+
+	if (size <= 0)
+		return 0;
+
+	/* find host element with host_offset */
+	host_sg_elem = sg_get_elem_at(host_sg, &offset);
+	if (host_sg_elem == NULL)
+		return -EINVAL;
+
+	/* set up DMA configuration */
+	config.direction = DMA_DIR_HMEM_TO_LMEM;
+	config.src_width = sizeof(uint32_t);
+	config.dest_width = sizeof(uint32_t);
+	config.cyclic = 0;
+	dma_sg_init(&config.elem_array);
+
+	/* configure local DMA elem */
+	local_sg_elem.src = host_sg_elem->src + offset;
+	local_sg_elem.dest = (uint32_t)local_ptr;
+	local_sg_elem.size = MIN(size, MIN(HOST_PAGE_SIZE,
+					   host_sg_elem->size - offset));
 
 	config.elem_array.elems = &local_sg_elem;
 	config.elem_array.count = 1;
@@ -56,15 +56,20 @@
 #include <platform/idc.h>
 #include <sof/audio/component.h>
 #include <sof/audio/pipeline.h>
+#include <sof/audio/format.h>
 #include <uapi/ipc/header.h>
 #include <uapi/ipc/pm.h>
 #include <uapi/ipc/stream.h>
 #include <uapi/ipc/topology.h>
 #include <uapi/ipc/pm.h>
 #include <uapi/ipc/control.h>
+#include <uapi/ipc/debug.h>
 #include <sof/dma-trace.h>
+#include <sof/probe.h>
+#include <sof/coredump.h>
 #include <sof/cpu.h>
 #include <sof/idc.h>
+#include <sof/module.h>
 #include <config.h>
 
 #define iGS(x) ((x >> SOF_GLB_TYPE_SHIFT) & 0xf)
@@ -126,6 +131,7 @@ struct ipc *_ipc;
 static inline struct sof_ipc_cmd_hdr *mailbox_validate(void)
 {
 	struct sof_ipc_cmd_hdr *hdr = _ipc->comp_data;
+	uint32_t size;
 
 	/* read component values from the inbox */
 	mailbox_hostbox_read(hdr, 0, sizeof(*hdr));
@@ -136,10 +142,15 @@ static inline struct sof_ipc_cmd_hdr *mailbox_validate(void)
 		return NULL;
 	}
 
+	/* control data payload is left in the inbox for ipc_comp_value() */
+	size = hdr->size;
+	if (hdr->cmd == (SOF_IPC_GLB_COMP_MSG | SOF_IPC_COMP_SET_DATA))
+		size = MIN(size, sizeof(struct sof_ipc_ctrl_data));
+
 	/* read rest of component data */
-	mailbox_hostbox_read(hdr + 1, sizeof(*hdr), hdr->size - sizeof(*hdr));
+	mailbox_hostbox_read(hdr + 1, sizeof(*hdr), size - sizeof(*hdr));
 
-	dcache_writeback_region(hdr, hdr->size);
+	dcache_writeback_region(hdr, size);
 
 	return hdr;
 }
@@ -216,6 +227,92 @@ static bool is_hostless_upstream(struct comp_dev *current)
  */
 
 /* allocate a new stream */
+/* pcm params after the host buffer is set up, see ipc_defer() */
+struct ipc_pcm_params_stage {
+	struct comp_dev *cd;
+	uint32_t comp_id;
+	uint32_t stream;
+};
+
+static struct ipc_pcm_params_stage pcm_params_stage;
+
+static int ipc_stream_pcm_params_error(struct ipc_pcm_params_stage *stage)
+{
+	int err;
+
+	err = pipeline_reset(stage->cd->pipeline, stage->cd);
+	if (err < 0)
+		trace_ipc_error("ipc: pipe %d comp %d reset failed %d",
+				stage->cd->pipeline->ipc_pipe.pipeline_id,
+				stage->comp_id, err);
+	return -EINVAL;
+}
+
+/* last stage, prepare the pipeline and reply with the stream offsets */
+static int ipc_stream_pcm_prepare(void *data)
+{
+	struct ipc_pcm_params_stage *stage = data;
+	struct sof_ipc_pcm_params_reply reply;
+	struct comp_dev *cd = stage->cd;
+	int err, posn_offset;
+#ifdef CONFIG_STREAM_STATS
+	int stats_offset;
+#endif
+
+	/* prepare pipeline audio params */
+	err = pipeline_prepare(cd->pipeline, cd);
+	if (err < 0) {
+		trace_ipc_error("ipc: pipe %d comp %d prepare failed %d",
+				cd->pipeline->ipc_pipe.pipeline_id,
+				stage->comp_id, err);
+		return ipc_stream_pcm_params_error(stage);
+	}
+
+	posn_offset = ipc_get_posn_offset(_ipc, cd->pipeline);
+	if (posn_offset < 0) {
+		trace_ipc_error("ipc: pipe %d comp %d posn offset failed %d",
+				cd->pipeline->ipc_pipe.pipeline_id,
+				stage->comp_id, err);
+		return ipc_stream_pcm_params_error(stage);
+	}
+	/* write component values to the outbox */
+	reply.rhdr.hdr.size = sizeof(reply);
+	reply.rhdr.hdr.cmd = stage->stream;
+	reply.rhdr.error = 0;
+	reply.comp_id = stage->comp_id;
+	reply.posn_offset = posn_offset;
+	reply.stats_offset = 0;
+
+#ifdef CONFIG_STREAM_STATS
+	/* stats are best effort, small stream regions have no slot for them */
+	stats_offset = ipc_get_stats_offset(_ipc, cd->pipeline);
+	if (stats_offset > 0) {
+		pipeline_stats_init(cd->pipeline, cd, stats_offset);
+		reply.stats_offset = stats_offset;
+	}
+#endif
+	mailbox_hostbox_write(0, &reply, sizeof(reply));
+	return 1;
+}
+
+/* configure pipeline audio params, buffers may be reallocated here */
+static int ipc_stream_pcm_pipe_params(void *data)
+{
+	struct ipc_pcm_params_stage *stage = data;
+	int err;
+
+	err = pipeline_params(stage->cd->pipeline, stage->cd,
+			      (struct sof_ipc_pcm_params *)_ipc->comp_data);
+	if (err < 0) {
+		trace_ipc_error("ipc: pipe %d comp %d params failed %d",
+				stage->cd->pipeline->ipc_pipe.pipeline_id,
+				stage->comp_id, err);
+		return ipc_stream_pcm_params_error(stage);
+	}
+
+	return ipc_defer(ipc_stream_pcm_prepare, stage);
+}
+
 static int ipc_stream_pcm_params(uint32_t stream)
 {
 #ifdef CONFIG_HOST_PTABLE
@@ -223,12 +320,11 @@ static int ipc_stream_pcm_params(uint32_t stream)
 	struct sof_ipc_comp_host *host = NULL;
 	struct dma_sg_elem_array elem_array;
 	uint32_t ring_size;
+	int err;
 #endif
 	struct sof_ipc_pcm_params pcm_params;
-	struct sof_ipc_pcm_params_reply reply;
 	struct ipc_comp_dev *pcm_dev;
 	struct comp_dev *cd;
-	int err, posn_offset;
 
 	/* copy message with ABI safe method */
 	IPC_COPY_CMD(pcm_params, _ipc->comp_data);
@@ -257,6 +353,10 @@ static int ipc_stream_pcm_params(uint32_t stream)
 	}
 	cd->params = pcm_params.params;
 
+	pcm_params_stage.cd = cd;
+	pcm_params_stage.comp_id = pcm_params.comp_id;
+	pcm_params_stage.stream = stream;
+
 #ifdef CONFIG_HOST_PTABLE
 	dma_sg_init(&elem_array);
 
@@ -304,52 +404,14 @@ static int ipc_stream_pcm_params(uint32_t stream)
 pipe_params:
 #endif
 
-	/* configure pipeline audio params */
-	err = pipeline_params(pcm_dev->cd->pipeline, pcm_dev->cd,
-			      (struct sof_ipc_pcm_params *)_ipc->comp_data);
-	if (err < 0) {
-		trace_ipc_error("ipc: pipe %d comp %d params failed %d",
-				pcm_dev->cd->pipeline->ipc_pipe.pipeline_id,
-				pcm_params.comp_id, err);
-		goto error;
-	}
-
-	/* prepare pipeline audio params */
-	err = pipeline_prepare(pcm_dev->cd->pipeline, pcm_dev->cd);
-	if (err < 0) {
-		trace_ipc_error("ipc: pipe %d comp %d prepare failed %d",
-				pcm_dev->cd->pipeline->ipc_pipe.pipeline_id,
-				pcm_params.comp_id, err);
-		goto error;
-	}
-
-	posn_offset = ipc_get_posn_offset(_ipc, pcm_dev->cd->pipeline);
-	if (posn_offset < 0) {
-		trace_ipc_error("ipc: pipe %d comp %d posn offset failed %d",
-				pcm_dev->cd->pipeline->ipc_pipe.pipeline_id,
-				pcm_params.comp_id, err);
-		goto error;
-	}
-	/* write component values to the outbox */
-	reply.rhdr.hdr.size = sizeof(reply);
-	reply.rhdr.hdr.cmd = stream;
-	reply.rhdr.error = 0;
-	reply.comp_id = pcm_params.comp_id;
-	reply.posn_offset = posn_offset;
-	mailbox_hostbox_write(0, &reply, sizeof(reply));
-	return 1;
+	/* the pipeline is configured and prepared in deferred stages */
+	return ipc_defer(ipc_stream_pcm_pipe_params, &pcm_params_stage);
 
-error:
 #ifdef CONFIG_HOST_PTABLE
+error:
 	dma_sg_free(&elem_array);
+	return ipc_stream_pcm_params_error(&pcm_params_stage);
 #endif
-
-	err = pipeline_reset(pcm_dev->cd->pipeline, pcm_dev->cd);
-	if (err < 0)
-		trace_ipc_error("ipc: pipe %d comp %d reset failed %d",
-				pcm_dev->cd->pipeline->ipc_pipe.pipeline_id,
-				pcm_params.comp_id, err);
-	return -EINVAL;
 }
 
 /* free stream resources */
@@ -418,18 +480,75 @@ static int ipc_stream_position(uint32_t header)
 	return 1;
 }
 
+#ifdef CONFIG_IPC_POSN_BATCH
+/*
+ * Notify host of all stream positions updated since the last batch. The
+ * work is only unlinked from its queue after returning, so the next batch
+ * is started on the other work item.
+ */
+uint64_t ipc_stream_posn_work(void *data, uint64_t delay)
+{
+	struct ipc *ipc = data;
+	struct sof_ipc_stream_posn_batch batch;
+	uint32_t flags;
+
+	spin_lock_irq(&ipc->lock, flags);
+	batch.slot_mask = ipc->shared_ctx->posn_pending;
+	ipc->shared_ctx->posn_pending = 0;
+	ipc->shared_ctx->posn_next ^= 1;
+	spin_unlock_irq(&ipc->lock, flags);
+
+	if (!batch.slot_mask)
+		return 0;
+
+	batch.rhdr.hdr.cmd = SOF_IPC_GLB_STREAM_MSG |
+			     SOF_IPC_STREAM_POSITION_BATCH;
+	batch.rhdr.hdr.size = sizeof(batch);
+	batch.rhdr.error = 0;
+
+	ipc_queue_host_message(ipc, batch.rhdr.hdr.cmd, &batch,
+			       sizeof(batch), 0);
+
+	return 0;
+}
+#endif
+
 /* send stream position */
 int ipc_stream_send_position(struct comp_dev *cdev,
 	struct sof_ipc_stream_posn *posn)
 {
+#ifdef CONFIG_IPC_POSN_BATCH
+	struct work *work = NULL;
+	uint32_t slot;
+	uint32_t flags;
+#endif
+
 	posn->rhdr.hdr.cmd = SOF_IPC_GLB_STREAM_MSG | SOF_IPC_STREAM_POSITION |
 		cdev->comp.id;
 	posn->rhdr.hdr.size = sizeof(*posn);
 	posn->comp_id = cdev->comp.id;
 
 	mailbox_stream_write(cdev->pipeline->posn_offset, posn, sizeof(*posn));
+
+#ifdef CONFIG_IPC_POSN_BATCH
+	/* flag the slot and let one rate limited IPC report all slots */
+	slot = cdev->pipeline->posn_offset / sizeof(*posn);
+
+	spin_lock_irq(&_ipc->lock, flags);
+	if (!_ipc->shared_ctx->posn_pending)
+		work = &_ipc->shared_ctx->posn_work[_ipc->shared_ctx->posn_next];
+	_ipc->shared_ctx->posn_pending |= BIT(slot);
+	spin_unlock_irq(&_ipc->lock, flags);
+
+	/* the first update of a batch starts the period */
+	if (work)
+		work_schedule_default(work, IPC_POSN_BATCH_PERIOD);
+
+	return 0;
+#else
 	return ipc_queue_host_message(_ipc, posn->rhdr.hdr.cmd, posn,
 				      sizeof(*posn), 0);
+#endif
 }
 
 /* send stream position TODO: send compound message  */
@@ -447,12 +566,29 @@ int ipc_stream_send_xrun(struct comp_dev *cdev,
 				      sizeof(*posn), 0);
 }
 
+/* map SOF_IPC_STREAM_TRIG_ command type to COMP_TRIGGER_ */
+static int ipc_stream_trigger_cmd(uint32_t ipc_cmd)
+{
+	switch (ipc_cmd) {
+	case iCS(SOF_IPC_STREAM_TRIG_START):
+		return COMP_TRIGGER_START;
+	case iCS(SOF_IPC_STREAM_TRIG_STOP):
+		return COMP_TRIGGER_STOP;
+	case iCS(SOF_IPC_STREAM_TRIG_PAUSE):
+		return COMP_TRIGGER_PAUSE;
+	case iCS(SOF_IPC_STREAM_TRIG_RELEASE):
+		return COMP_TRIGGER_RELEASE;
+	default:
+		return -EINVAL;
+	}
+}
+
 static int ipc_stream_trigger(uint32_t header)
 {
 	struct ipc_comp_dev *pcm_dev;
 	struct sof_ipc_stream stream;
 	uint32_t ipc_cmd = (header & SOF_CMD_TYPE_MASK) >> SOF_CMD_TYPE_SHIFT;
-	uint32_t cmd;
+	int cmd;
 	int ret;
 
 	/* copy message with ABI safe method */
@@ -467,27 +603,22 @@ static int ipc_stream_trigger(uint32_t header)
 		return -ENODEV;
 	}
 
-	switch (ipc_cmd) {
-	case iCS(SOF_IPC_STREAM_TRIG_START):
-		cmd = COMP_TRIGGER_START;
-		break;
-	case iCS(SOF_IPC_STREAM_TRIG_STOP):
-		cmd = COMP_TRIGGER_STOP;
-		break;
-	case iCS(SOF_IPC_STREAM_TRIG_PAUSE):
-		cmd = COMP_TRIGGER_PAUSE;
-		break;
-	case iCS(SOF_IPC_STREAM_TRIG_RELEASE):
-		cmd = COMP_TRIGGER_RELEASE;
-		break;
 	/* XRUN is special case- TODO */
-	case iCS(SOF_IPC_STREAM_TRIG_XRUN):
+	if (ipc_cmd == iCS(SOF_IPC_STREAM_TRIG_XRUN))
 		return 0;
-	default:
+
+	cmd = ipc_stream_trigger_cmd(ipc_cmd);
+	if (cmd < 0) {
 		trace_ipc_error("ipc: invalid trigger cmd %d", ipc_cmd);
 		return -ENODEV;
 	}
 
+#ifdef CONFIG_PIPELINE_CORE_BALANCE
+	/* pick the least loaded core for the pipeline */
+	if (cmd == COMP_TRIGGER_START)
+		ipc_pipeline_balance(_ipc, pcm_dev->cd->pipeline);
+#endif
+
 	/* trigger the component */
 	ret = pipeline_trigger(pcm_dev->cd->pipeline, pcm_dev->cd, cmd);
 	if (ret < 0) {
@@ -498,6 +629,151 @@ static int ipc_stream_trigger(uint32_t header)
 	return ret;
 }
 
+/* cache operation on the group members running on the given cores */
+static void ipc_stream_group_cache(uint32_t cores, int cmd)
+{
+	struct ipc_group_trigger *group = &_ipc->shared_ctx->group;
+	struct ipc_comp_dev *pcm_dev;
+	uint32_t i;
+
+	for (i = 0; i < group->count; i++) {
+		pcm_dev = ipc_get_comp(_ipc, group->comp_id[i]);
+		if (cores & (1 << pcm_dev->cd->pipeline->ipc_pipe.core))
+			pipeline_cache(pcm_dev->cd->pipeline, pcm_dev->cd,
+				       cmd);
+	}
+}
+
+/* collect the group trigger results posted by the other cores */
+static int ipc_stream_group_wait(uint32_t cores)
+{
+	struct ipc_group_trigger *group = &_ipc->shared_ctx->group;
+	uint64_t deadline = group->start +
+		clock_ms_to_ticks(PLATFORM_DEFAULT_CLOCK, 1) *
+		IPC_GROUP_TRIGGER_TIMEOUT / 1000;
+	int ret = 0;
+	int core;
+
+	for (core = 0; core < PLATFORM_CORE_COUNT; core++) {
+		if (!(cores & (1 << core)))
+			continue;
+
+		while (!group->done[core]) {
+			if (platform_timer_get(platform_timer) > deadline) {
+				trace_ipc_error("ipc: group trigger core %d "
+						"timeout", core);
+				return -ETIME;
+			}
+			idelay(PLATFORM_DEFAULT_DELAY);
+		}
+
+		if (group->ret[core] < 0 && !ret)
+			ret = group->ret[core];
+	}
+
+	return ret;
+}
+
+static int ipc_stream_trigger_group(uint32_t header)
+{
+	struct sof_ipc_stream_group *req = _ipc->comp_data;
+	struct ipc_group_trigger *group = &_ipc->shared_ctx->group;
+	struct idc_msg group_msg = { IDC_MSG_PPL_GROUP,
+		IDC_MSG_PPL_GROUP_EXT, 0 };
+	struct ipc_comp_dev *pcm_dev;
+	uint32_t delay = IPC_GROUP_TRIGGER_DELAY;
+	uint32_t cores = 0;
+	uint32_t i;
+	int core;
+	int cmd;
+	int ret;
+	int err;
+
+	if (req->hdr.size < sizeof(*req) || !req->count ||
+	    req->count > IPC_GROUP_TRIGGER_MAX ||
+	    req->hdr.size < sizeof(*req) + req->count * sizeof(uint32_t)) {
+		trace_ipc_error("ipc: group trigger invalid size %d count %d",
+				req->hdr.size, req->count);
+		return -EINVAL;
+	}
+
+	cmd = ipc_stream_trigger_cmd((req->cmd & SOF_CMD_TYPE_MASK) >>
+				     SOF_CMD_TYPE_SHIFT);
+	if (cmd < 0) {
+		trace_ipc_error("ipc: invalid group trigger cmd 0x%x",
+				req->cmd);
+		return cmd;
+	}
+
+	trace_ipc("ipc: group of %d -> trigger cmd %d", req->count, cmd);
+
+	/* resolve every member before anything is triggered */
+	for (i = 0; i < req->count; i++) {
+		pcm_dev = ipc_get_comp(_ipc, req->comp_id[i]);
+		if (!pcm_dev || pcm_dev->type != COMP_TYPE_COMPONENT) {
+			trace_ipc_error("ipc: comp %d not found",
+					req->comp_id[i]);
+			return -ENODEV;
+		}
+
+#ifdef CONFIG_PIPELINE_CORE_BALANCE
+		if (cmd == COMP_TRIGGER_START)
+			ipc_pipeline_balance(_ipc, pcm_dev->cd->pipeline);
+#endif
+
+		core = pcm_dev->cd->pipeline->ipc_pipe.core;
+		if (core != cpu_get_id()) {
+			if (!cpu_is_core_enabled(core)) {
+				trace_ipc_error("ipc: comp %d core %d is not "
+						"enabled", req->comp_id[i],
+						core);
+				return -EINVAL;
+			}
+			cores |= 1 << core;
+		}
+
+		group->comp_id[i] = req->comp_id[i];
+	}
+
+	if (req->delay_us)
+		delay = MIN(req->delay_us, IPC_GROUP_TRIGGER_DELAY_MAX);
+
+	group->cmd = cmd;
+	group->count = req->count;
+	for (core = 0; core < PLATFORM_CORE_COUNT; core++) {
+		group->done[core] = 0;
+		group->ret[core] = 0;
+	}
+
+	/* writeback pipelines the other cores are about to start */
+	if (cmd == COMP_TRIGGER_START)
+		ipc_stream_group_cache(cores, COMP_CACHE_WRITEBACK_INV);
+
+	group->start = platform_timer_get(platform_timer) +
+		clock_ms_to_ticks(PLATFORM_DEFAULT_CLOCK, 1) * delay / 1000;
+
+	/* fan out without waiting, results come back through the group */
+	for (core = 0; core < PLATFORM_CORE_COUNT; core++) {
+		if (!(cores & (1 << core)))
+			continue;
+
+		group_msg.core = core;
+		idc_send_msg(&group_msg, IDC_NON_BLOCKING);
+	}
+
+	ret = ipc_pipeline_group_trigger(_ipc);
+
+	err = ipc_stream_group_wait(cores);
+	if (err < 0 && !ret)
+		ret = err;
+
+	/* invalidate pipelines stopped by the other cores */
+	if (cmd == COMP_TRIGGER_STOP)
+		ipc_stream_group_cache(cores, COMP_CACHE_INVALIDATE);
+
+	return ret;
+}
+
 static int ipc_glb_stream_message(uint32_t header)
 {
 	uint32_t cmd = (header & SOF_CMD_TYPE_MASK) >> SOF_CMD_TYPE_SHIFT;
@@ -514,6 +790,8 @@ static int ipc_glb_stream_message(uint32_t header)
 	case iCS(SOF_IPC_STREAM_TRIG_DRAIN):
 	case iCS(SOF_IPC_STREAM_TRIG_XRUN):
 		return ipc_stream_trigger(header);
+	case iCS(SOF_IPC_STREAM_TRIG_GROUP):
+		return ipc_stream_trigger_group(header);
 	case iCS(SOF_IPC_STREAM_POSITION):
 		return ipc_stream_position(header);
 	default:
@@ -546,9 +824,9 @@ static int ipc_dai_config(uint32_t header)
 		return -ENODEV;
 	}
 
-	/* configure DAI */
-	ret = dai_set_config(dai,
-			     (struct sof_ipc_dai_config *)_ipc->comp_data);
+	/* configure DAI, an unchanged config leaves the hardware alone */
+	ret = dai_apply_config(dai,
+			       (struct sof_ipc_dai_config *)_ipc->comp_data);
 	dai_put(dai); /* free ref immediately */
 	if (ret < 0) {
 		trace_ipc_error("ipc: dai %d,%d config failed %d",
@@ -580,6 +858,74 @@ static int ipc_glb_dai_message(uint32_t header)
  * PM IPC Operations.
  */
 
+#ifdef CONFIG_HOST_PTABLE
+static void ipc_pm_dma_complete(void *data, uint32_t type,
+				struct dma_sg_elem *next)
+{
+	completion_t *comp = (completion_t *)data;
+
+	if (type == DMA_IRQ_TYPE_LLIST)
+		wait_completed(comp);
+
+	next->size = DMA_RELOAD_END;
+}
+
+/* save or restore heap context with the host PM context buffer */
+static int ipc_pm_context_copy(struct sof_ipc_host_buffer *buffer, int save)
+{
+	struct ipc_data *iipc = ipc_get_drvdata(_ipc);
+	struct dma_sg_config sg;
+	struct dma_copy dc;
+	int err;
+
+	if (buffer->size < mm_pm_context_size()) {
+		trace_ipc_error("ipc: pm context buffer %u too small",
+				buffer->size);
+		return -ENOMEM;
+	}
+
+	dma_sg_init(&sg.elem_array);
+
+	/* use DMA to read in compressed page table from host */
+	err = ipc_get_page_descriptors(iipc->dmac, iipc->page_table, buffer);
+	if (err < 0) {
+		trace_ipc_error("ipc: pm failed to get descriptors %d", err);
+		goto out;
+	}
+
+	err = ipc_parse_page_descriptors(iipc->page_table, buffer,
+					 &sg.elem_array,
+					 save ? SOF_IPC_STREAM_CAPTURE :
+					 SOF_IPC_STREAM_PLAYBACK);
+	if (err < 0) {
+		trace_ipc_error("ipc: pm failed to parse descriptors %d", err);
+		goto out;
+	}
+
+	err = dma_copy_new(&dc);
+	if (err < 0) {
+		trace_ipc_error("ipc: pm failed to get DMA %d", err);
+		goto out;
+	}
+
+	/* no trace position updates for context copies */
+	dma_set_cb(dc.dmac, dc.chan, DMA_IRQ_TYPE_LLIST, ipc_pm_dma_complete,
+		   &dc.complete);
+	wait_init(&dc.complete);
+
+	if (save)
+		err = mm_pm_context_save(&dc, &sg);
+	else
+		err = mm_pm_context_restore(&dc, &sg);
+
+	dma_copy_free(&dc);
+
+out:
+	dma_sg_free(&sg.elem_array);
+	return err;
+}
+#endif
+
 static int ipc_pm_context_size(uint32_t header)
 {
 	struct sof_ipc_pm_ctx pm_ctx;
@@ -588,18 +934,26 @@ static int ipc_pm_context_size(uint32_t header)
 
 	bzero(&pm_ctx, sizeof(pm_ctx));
 
-	/* TODO: calculate the context and size of host buffers required */
+	pm_ctx.hdr.cmd = header;
+	pm_ctx.hdr.size = sizeof(pm_ctx);
+	pm_ctx.size = mm_pm_context_size();
 
 	/* write the context to the host driver */
-	//mailbox_hostbox_write(0, &pm_ctx, sizeof(pm_ctx));
+	mailbox_hostbox_write(0, &pm_ctx, sizeof(pm_ctx));
 
-	return 0;
+	return 1;
 }
 
 static int ipc_pm_context_save(uint32_t header)
 {
-	//struct sof_ipc_pm_ctx *pm_ctx = _ipc->comp_data;
 	struct ipc_data *iipc = ipc_get_drvdata(_ipc);
+#ifdef CONFIG_HOST_PTABLE
+	struct sof_ipc_pm_ctx pm_ctx;
+	int err;
+
+	/* copy message with ABI safe method */
+	IPC_COPY_CMD(pm_ctx, _ipc->comp_data);
+#endif
 
 	trace_ipc("ipc: pm -> save");
 
@@ -607,8 +961,17 @@ static int ipc_pm_context_save(uint32_t header)
 
 	/* TODO: mask ALL platform interrupts except DMA */
 
-	/* TODO now save the context - create SG buffer config using */
-	//mm_pm_context_save(struct dma_sg_config *sg);
+	/* DAI registers are lost in D3, so configs are applied again */
+	dai_config_invalidate();
+
+	/* save the heap context, only what changed since the last save */
+#ifdef CONFIG_HOST_PTABLE
+	if (pm_ctx.buffer.size) {
+		err = ipc_pm_context_copy(&pm_ctx.buffer, 1);
+		if (err < 0)
+			return err;
+	}
+#endif
 
 	/* mask all DSP interrupts */
 	arch_interrupt_disable_mask(0xffffffff);
@@ -622,12 +985,6 @@ static int ipc_pm_context_save(uint32_t header)
 
 	/* TODO: disable SSP and DMA HW */
 
-	/* TODO: save the context */
-	//reply.entries_no = 0;
-
-	/* write the context to the host driver */
-	//mailbox_hostbox_write(0, pm_ctx, sizeof(*pm_ctx));
-
 	iipc->pm_prepare_D3 = 1;
 
 	return 0;
@@ -635,12 +992,20 @@ static int ipc_pm_context_save(uint32_t header)
 
 static int ipc_pm_context_restore(uint32_t header)
 {
-	//struct sof_ipc_pm_ctx *pm_ctx = _ipc->comp_data;
+#ifdef CONFIG_HOST_PTABLE
+	struct sof_ipc_pm_ctx pm_ctx;
+
+	/* copy message with ABI safe method */
+	IPC_COPY_CMD(pm_ctx, _ipc->comp_data);
+#endif
 
 	trace_ipc("ipc: pm -> restore");
 
-	/* restore context placeholder */
-	//mailbox_hostbox_write(0, pm_ctx, sizeof(*pm_ctx));
+	/* restore the heap context before any pipeline work */
+#ifdef CONFIG_HOST_PTABLE
+	if (pm_ctx.buffer.size)
+		return ipc_pm_context_copy(&pm_ctx.buffer, 0);
+#endif
 
 	return 0;
 }
@@ -653,13 +1018,15 @@ static int ipc_pm_core_enable(uint32_t header)
 	/* copy message with ABI safe method */
 	IPC_COPY_CMD(pm_core_config, _ipc->comp_data);
 
-	trace_ipc("ipc: pm core mask 0x%x -> enable",
-		  pm_core_config.enable_mask);
+	trace_ipc("ipc: pm core mask 0x%x standby 0x%x -> enable",
+		  pm_core_config.enable_mask, pm_core_config.standby_mask);
 
 	for (i = 0; i < PLATFORM_CORE_COUNT; i++) {
 		if (i != PLATFORM_MASTER_CORE_ID) {
 			if (pm_core_config.enable_mask & (1 << i))
 				cpu_enable_core(i);
+			else if (pm_core_config.standby_mask & (1 << i))
+				cpu_standby_core(i);
 			else
 				cpu_disable_core(i);
 		}
@@ -775,6 +1142,26 @@ int ipc_dma_trace_send_position(void)
 				      sizeof(posn), 1);
 }
 
+/* apply host runtime trace level filter */
+static int ipc_trace_filter_update(uint32_t header)
+{
+	struct sof_ipc_trace_filter *filter = _ipc->comp_data;
+	int err;
+
+	/* elems are variable sized so check the size against the buffer */
+	if (filter->hdr.size > SOF_IPC_MSG_MAX_SIZE) {
+		trace_ipc_error("ipc: trace filter size %u too big",
+				filter->hdr.size);
+		return -EINVAL;
+	}
+
+	err = trace_filter_update(filter);
+	if (err < 0)
+		trace_ipc_error("ipc: trace filter update failed %d", err);
+
+	return err;
+}
+
 static int ipc_glb_debug_message(uint32_t header)
 {
 	uint32_t cmd = (header & SOF_CMD_TYPE_MASK) >> SOF_CMD_TYPE_SHIFT;
@@ -784,18 +1171,455 @@ static int ipc_glb_debug_message(uint32_t header)
 	switch (cmd) {
 	case iCS(SOF_IPC_TRACE_DMA_PARAMS):
 		return ipc_dma_trace_config(header);
+	case iCS(SOF_IPC_TRACE_FILTER_UPDATE):
+		return ipc_trace_filter_update(header);
 	default:
 		trace_ipc_error("ipc: unknown debug cmd %u", cmd);
 		return -EINVAL;
 	}
 }
 
-static int ipc_glb_gdb_debug(uint32_t header)
+#ifdef CONFIG_PERFORMANCE_COUNTERS
+/* read component copy() performance counters for a pipeline */
+static int ipc_debug_comp_perf(uint32_t header)
 {
-	/* no furher information needs to be extracted form header */
-	(void) header;
+	struct sof_ipc_debug_perf_params params;
+	struct sof_ipc_debug_perf *reply = _ipc->comp_data;
+	struct sof_ipc_debug_perf_elem *elem;
+	struct ipc_comp_dev *icd;
+	struct comp_dev *cd;
+	struct list_item *clist;
+	uint32_t count = 0;
 
-#ifdef CONFIG_GDB_DEBUG
+	/* copy message with ABI safe method */
+	IPC_COPY_CMD(params, _ipc->comp_data);
+
+	trace_ipc("ipc: pipe %d -> comp perf", params.pipeline_id);
+
+	/* reply is built in place of the request */
+	list_for_item(clist, &_ipc->shared_ctx->comp_list) {
+		icd = container_of(clist, struct ipc_comp_dev, list);
+		if (icd->type != COMP_TYPE_COMPONENT)
+			continue;
+
+		cd = icd->cd;
+		if (cd->comp.pipeline_id != params.pipeline_id)
+			continue;
+
+		if (count == SOF_IPC_DEBUG_PERF_MAX_ELEMS) {
+			trace_ipc_error("ipc: pipe %d has more than %d comps",
+					params.pipeline_id,
+					SOF_IPC_DEBUG_PERF_MAX_ELEMS);
+			break;
+		}
+
+		/* counters may be updated by another core */
+		if (cd->pipeline && cd->pipeline->ipc_pipe.core != cpu_get_id())
+			dcache_invalidate_region(&cd->perf, sizeof(cd->perf));
+
+		elem = &reply->elems[count++];
+		elem->comp_id = cd->comp.id;
+		elem->count = cd->perf.count;
+		elem->min = cd->perf.count ? cd->perf.min : 0;
+		elem->max = cd->perf.max;
+		elem->avg = cd->perf.count ?
+			cd->perf.total / cd->perf.count : 0;
+
+		if (params.flags & SOF_IPC_DEBUG_PERF_RESET) {
+			comp_perf_reset(cd);
+			dcache_writeback_region(&cd->perf, sizeof(cd->perf));
+		}
+	}
+
+	reply->rhdr.hdr.cmd = header;
+	reply->rhdr.hdr.size = sizeof(*reply) + count * sizeof(*elem);
+	reply->rhdr.error = 0;
+	reply->pipeline_id = params.pipeline_id;
+	reply->num_elems = count;
+
+	mailbox_hostbox_write(0, reply, reply->rhdr.hdr.size);
+	return 1;
+}
+#endif
+
+static int ipc_debug_task_stats(uint32_t header)
+{
+	struct sof_ipc_debug_task_params params;
+	struct sof_ipc_debug_task_stats reply;
+	struct ipc_comp_dev *icd;
+	struct list_item *clist;
+	struct task *task;
+
+	/* copy message with ABI safe method */
+	IPC_COPY_CMD(params, _ipc->comp_data);
+
+	trace_ipc("ipc: pipe %d -> task stats", params.pipeline_id);
+
+	list_for_item(clist, &_ipc->shared_ctx->comp_list) {
+		icd = container_of(clist, struct ipc_comp_dev, list);
+		if (icd->type != COMP_TYPE_PIPELINE ||
+		    icd->pipeline->ipc_pipe.pipeline_id != params.pipeline_id)
+			continue;
+
+		/* stats are updated by the core running the pipeline */
+		task = pipeline_sched_task(icd->pipeline);
+		if (task->core != cpu_get_id())
+			dcache_invalidate_region(task, sizeof(*task));
+
+		reply.rhdr.hdr.cmd = header;
+		reply.rhdr.hdr.size = sizeof(reply);
+		reply.rhdr.error = 0;
+		reply.pipeline_id = params.pipeline_id;
+		reply.missed = task->stats.missed;
+		reply.rescheduled = task->stats.rescheduled;
+		reply.cancelled = task->stats.cancelled;
+		reply.max_lateness = task->stats.max_lateness;
+		reply.max_rtime = task->max_rtime;
+		reply.max_qdelay = task->stats.max_qdelay;
+		reply.promoted = task->stats.promoted;
+
+		if (params.flags & SOF_IPC_DEBUG_TASK_RESET) {
+			schedule_task_stats_reset(task);
+			dcache_writeback_region(&task->stats,
+						sizeof(task->stats));
+		}
+
+		mailbox_hostbox_write(0, &reply, sizeof(reply));
+		return 1;
+	}
+
+	trace_ipc_error("ipc: pipe %d not found", params.pipeline_id);
+	return -ENODEV;
+}
+
+static int ipc_debug_heap_info(uint32_t header)
+{
+	struct sof_ipc_debug_heap_params params;
+	struct sof_ipc_debug_heap *reply = _ipc->comp_data;
+	int size;
+
+	/* copy message with ABI safe method */
+	IPC_COPY_CMD(params, _ipc->comp_data);
+
+	trace_ipc("ipc: zone %d -> heap info", params.zone);
+
+	/* reply is built in place of the request */
+	size = heap_info(params.zone, reply);
+	if (size < 0)
+		return size;
+
+	reply->rhdr.hdr.cmd = header;
+	reply->rhdr.hdr.size = size;
+	reply->rhdr.error = 0;
+
+	mailbox_hostbox_write(0, reply, reply->rhdr.hdr.size);
+	return 1;
+}
+
+#ifdef CONFIG_HEAP_HISTOGRAM
+static int ipc_debug_heap_hist(uint32_t header)
+{
+	struct sof_ipc_debug_heap_params params;
+	struct sof_ipc_debug_heap_hist *reply = _ipc->comp_data;
+	int size;
+
+	/* copy message with ABI safe method */
+	IPC_COPY_CMD(params, _ipc->comp_data);
+
+	trace_ipc("ipc: zone %d -> heap hist", params.zone);
+
+	/* reply is built in place of the request */
+	size = heap_hist(params.zone, reply);
+	if (size < 0)
+		return size;
+
+	reply->rhdr.hdr.cmd = header;
+	reply->rhdr.hdr.size = size;
+	reply->rhdr.error = 0;
+
+	mailbox_hostbox_write(0, reply, reply->rhdr.hdr.size);
+	return 1;
+}
+#endif
+
+#ifdef CONFIG_MEM_BENCH
+/* time the heaps of a zone, keeps this core busy for the whole run */
+static int ipc_debug_mem_bench(uint32_t header)
+{
+	struct sof_ipc_debug_mem_bench_params params;
+	struct sof_ipc_debug_mem_bench *reply = _ipc->comp_data;
+	int size;
+
+	/* copy message with ABI safe method */
+	IPC_COPY_CMD(params, _ipc->comp_data);
+
+	trace_ipc("ipc: zone %d size %u -> mem bench", params.zone,
+		  params.size);
+
+	/* reply is built in place of the request */
+	size = mem_bench(&params, reply);
+	if (size < 0)
+		return size;
+
+	reply->rhdr.hdr.cmd = header;
+	reply->rhdr.hdr.size = size;
+	reply->rhdr.error = 0;
+
+	mailbox_hostbox_write(0, reply, reply->rhdr.hdr.size);
+	return 1;
+}
+#endif
+
+#ifdef CONFIG_LOCK_PROFILE
+/* read IRQ off lock hold times of all cores */
+static int ipc_debug_lock_prof(uint32_t header)
+{
+	struct sof_ipc_debug_lock_params params;
+	struct sof_ipc_debug_lock_prof *reply = _ipc->comp_data;
+	int size;
+
+	/* copy message with ABI safe method */
+	IPC_COPY_CMD(params, _ipc->comp_data);
+
+	trace_ipc("ipc: lock prof flags 0x%x", params.flags);
+
+	/* reply is built in place of the request */
+	size = lock_prof_info(reply, params.flags & SOF_IPC_DEBUG_LOCK_RESET);
+
+	reply->rhdr.hdr.cmd = header;
+	reply->rhdr.hdr.size = size;
+	reply->rhdr.error = 0;
+
+	mailbox_hostbox_write(0, reply, reply->rhdr.hdr.size);
+	return 1;
+}
+#endif
+
+#ifdef CONFIG_IRQ_STATS
+/* read handler statistics of all child IRQs */
+static int ipc_debug_irq_stats(uint32_t header)
+{
+	struct sof_ipc_debug_irq_params params;
+	struct sof_ipc_debug_irq_stats *reply = _ipc->comp_data;
+	int size;
+
+	/* copy message with ABI safe method */
+	IPC_COPY_CMD(params, _ipc->comp_data);
+
+	trace_ipc("ipc: irq stats flags 0x%x", params.flags);
+
+	/* reply is built in place of the request */
+	size = interrupt_stats_info(reply,
+				    params.flags & SOF_IPC_DEBUG_IRQ_RESET);
+
+	reply->rhdr.hdr.cmd = header;
+	reply->rhdr.hdr.size = size;
+	reply->rhdr.error = 0;
+
+	mailbox_hostbox_write(0, reply, reply->rhdr.hdr.size);
+	return 1;
+}
+#endif
+
+/* start the probe extraction stream */
+static int ipc_probe_init(uint32_t header)
+{
+	struct sof_ipc_probe_dma params;
+#ifdef CONFIG_HOST_PTABLE
+	struct ipc_data *iipc = ipc_get_drvdata(_ipc);
+	struct dma_sg_elem_array elem_array;
+#endif
+	int err;
+
+	/* copy message with ABI safe method */
+	IPC_COPY_CMD(params, _ipc->comp_data);
+
+	trace_ipc("ipc: probe init, stream_tag = %u", params.stream_tag);
+
+#ifdef CONFIG_HOST_PTABLE
+	dma_sg_init(&elem_array);
+
+	/* use DMA to read in compressed page table ringbuffer from host */
+	err = ipc_get_page_descriptors(iipc->dmac, iipc->page_table,
+				       &params.buffer);
+	if (err < 0) {
+		trace_ipc_error("ipc: probe failed to get descriptors %d",
+				err);
+		return err;
+	}
+
+	err = ipc_parse_page_descriptors(iipc->page_table, &params.buffer,
+					 &elem_array, SOF_IPC_STREAM_CAPTURE);
+	if (err < 0) {
+		trace_ipc_error("ipc: probe failed to parse descriptors %d",
+				err);
+		return err;
+	}
+
+	err = probe_init(params.stream_tag, &elem_array, params.buffer.size);
+	if (err < 0)
+		dma_sg_free(&elem_array);
+#else
+	err = probe_init(params.stream_tag, NULL, params.buffer.size);
+#endif
+
+	if (err < 0)
+		trace_ipc_error("ipc: failed to init probes %d", err);
+
+	return err;
+}
+
+/* attach or detach a probe point */
+static int ipc_probe_point(uint32_t header)
+{
+	struct sof_ipc_probe_point params;
+	struct ipc_comp_dev *icd;
+
+	/* copy message with ABI safe method */
+	IPC_COPY_CMD(params, _ipc->comp_data);
+
+	icd = ipc_get_comp(_ipc, params.buffer_id);
+	if (!icd || icd->type != COMP_TYPE_BUFFER) {
+		trace_ipc_error("ipc: probe buffer %u not found",
+				params.buffer_id);
+		return -ENODEV;
+	}
+
+	return probe_point_set(icd->cb, params.enable);
+}
+
+/* send probe extraction stream position to host */
+int ipc_probe_send_position(struct probe_data *d)
+{
+	struct sof_ipc_probe_posn posn;
+
+	posn.rhdr.hdr.cmd = SOF_IPC_GLB_DEBUG | SOF_IPC_DEBUG_PROBE_POSITION;
+	posn.rhdr.hdr.size = sizeof(posn);
+	posn.rhdr.error = 0;
+	posn.host_offset = d->host_offset;
+	posn.packets = d->packets;
+	posn.dropped = d->dropped;
+
+	return ipc_queue_host_message(_ipc, posn.rhdr.hdr.cmd, &posn,
+				      sizeof(posn), 1);
+}
+
+/* set up the host buffer core dumps are streamed to */
+static int ipc_coredump_init(uint32_t header)
+{
+	struct sof_ipc_coredump_dma params;
+#ifdef CONFIG_HOST_PTABLE
+	struct ipc_data *iipc = ipc_get_drvdata(_ipc);
+	struct dma_sg_elem_array elem_array;
+#endif
+	int err;
+
+	/* copy message with ABI safe method */
+	IPC_COPY_CMD(params, _ipc->comp_data);
+
+	trace_ipc("ipc: coredump init, stream_tag = %u", params.stream_tag);
+
+#ifdef CONFIG_HOST_PTABLE
+	dma_sg_init(&elem_array);
+
+	/* use DMA to read in compressed page table ringbuffer from host */
+	err = ipc_get_page_descriptors(iipc->dmac, iipc->page_table,
+				       &params.buffer);
+	if (err < 0) {
+		trace_ipc_error("ipc: coredump failed to get descriptors %d",
+				err);
+		return err;
+	}
+
+	err = ipc_parse_page_descriptors(iipc->page_table, &params.buffer,
+					 &elem_array, SOF_IPC_STREAM_CAPTURE);
+	if (err < 0) {
+		trace_ipc_error("ipc: coredump failed to parse descriptors %d",
+				err);
+		return err;
+	}
+
+	err = coredump_init(params.stream_tag, &elem_array,
+			    params.buffer.size);
+	if (err < 0)
+		dma_sg_free(&elem_array);
+#else
+	err = coredump_init(params.stream_tag, NULL, params.buffer.size);
+#endif
+
+	if (err < 0)
+		trace_ipc_error("ipc: failed to init coredump %d", err);
+
+	return err;
+}
+
+/* stream a core dump to the host now */
+static int ipc_coredump(uint32_t header)
+{
+	struct sof_ipc_coredump_reply reply;
+	int err;
+
+	err = coredump_stream(0, &reply);
+	if (err < 0)
+		return err;
+
+	reply.rhdr.hdr.cmd = header;
+	reply.rhdr.hdr.size = sizeof(reply);
+	reply.rhdr.error = 0;
+
+	mailbox_hostbox_write(0, &reply, sizeof(reply));
+	return 1;
+}
+
+static int ipc_glb_debug(uint32_t header)
+{
+	uint32_t cmd = (header & SOF_CMD_TYPE_MASK) >> SOF_CMD_TYPE_SHIFT;
+
+	switch (cmd) {
+#ifdef CONFIG_PERFORMANCE_COUNTERS
+	case iCS(SOF_IPC_DEBUG_COMP_PERF):
+		return ipc_debug_comp_perf(header);
+#endif
+	case iCS(SOF_IPC_DEBUG_TASK_STATS):
+		return ipc_debug_task_stats(header);
+	case iCS(SOF_IPC_DEBUG_HEAP_INFO):
+		return ipc_debug_heap_info(header);
+#ifdef CONFIG_HEAP_HISTOGRAM
+	case iCS(SOF_IPC_DEBUG_HEAP_HIST):
+		return ipc_debug_heap_hist(header);
+#endif
+#ifdef CONFIG_MEM_BENCH
+	case iCS(SOF_IPC_DEBUG_MEM_BENCH):
+		return ipc_debug_mem_bench(header);
+#endif
+#ifdef CONFIG_LOCK_PROFILE
+	case iCS(SOF_IPC_DEBUG_LOCK_PROF):
+		return ipc_debug_lock_prof(header);
+#endif
+#ifdef CONFIG_IRQ_STATS
+	case iCS(SOF_IPC_DEBUG_IRQ_STATS):
+		return ipc_debug_irq_stats(header);
+#endif
+	case iCS(SOF_IPC_DEBUG_PROBE_INIT):
+		return ipc_probe_init(header);
+	case iCS(SOF_IPC_DEBUG_PROBE_POINT):
+		return ipc_probe_point(header);
+	case iCS(SOF_IPC_DEBUG_COREDUMP_INIT):
+		return ipc_coredump_init(header);
+	case iCS(SOF_IPC_DEBUG_COREDUMP):
+		return ipc_coredump(header);
+	default:
+		trace_ipc_error("ipc: unknown debug cmd %u", cmd);
+		return -EINVAL;
+	}
+}
+
+static int ipc_glb_gdb_debug(uint32_t header)
+{
+	/* no furher information needs to be extracted form header */
+	(void) header;
+
+#ifdef CONFIG_GDB_DEBUG
 	/* TODO: this asm should be in arch/include/debug.h with a generic */
 	/* name and trigger debug exception */
 	asm volatile("_break 0, 0");
@@ -810,6 +1634,13 @@ static int ipc_glb_gdb_debug(uint32_t header)
  * Topology IPC Operations.
  */
 
+/* commands for active pipelines on other cores are forwarded by IDC */
+static inline bool ipc_comp_is_remote(struct comp_dev *dev)
+{
+	return dev->pipeline->status == COMP_STATE_ACTIVE &&
+		cpu_get_id() != dev->pipeline->ipc_pipe.core;
+}
+
 static int ipc_comp_cmd(struct comp_dev *dev, int cmd,
 			struct sof_ipc_ctrl_data *data, int size)
 {
@@ -817,8 +1648,7 @@ static int ipc_comp_cmd(struct comp_dev *dev, int cmd,
 	int core = dev->pipeline->ipc_pipe.core;
 
 	/* pipeline running on other core */
-	if (dev->pipeline->status == COMP_STATE_ACTIVE &&
-	    cpu_get_id() != core) {
+	if (ipc_comp_is_remote(dev)) {
 
 		/* check if requested core is enabled */
 		if (!cpu_is_core_enabled(core))
@@ -836,6 +1666,25 @@ static int ipc_comp_cmd(struct comp_dev *dev, int cmd,
 	}
 }
 
+/* locate SET_DATA payload, local components read it from the inbox */
+static struct sof_ipc_ctrl_data *ipc_comp_data_payload(struct comp_dev *dev)
+{
+	struct sof_ipc_ctrl_data *cdata = _ipc->comp_data;
+	uint32_t size = cdata->rhdr.hdr.size;
+
+	if (size <= sizeof(*cdata))
+		return cdata;
+
+	if (!ipc_comp_is_remote(dev))
+		return mailbox_hostbox_data(0, size);
+
+	/* remote core reads comp_data so copy the rest of the message */
+	mailbox_hostbox_read(cdata + 1, sizeof(*cdata), size - sizeof(*cdata));
+	dcache_writeback_region(cdata, size);
+
+	return cdata;
+}
+
 /* get/set component values or runtime data */
 static int ipc_comp_value(uint32_t header, uint32_t cmd)
 {
@@ -854,7 +1703,10 @@ static int ipc_comp_value(uint32_t header, uint32_t cmd)
 		trace_ipc_error("ipc: comp %d not found", data.comp_id);
 		return -ENODEV;
 	}
-	
+
+	if (cmd == COMP_CMD_SET_DATA)
+		_data = ipc_comp_data_payload(comp_dev->cd);
+
 	/* get component values */
 	ret = ipc_comp_cmd(comp_dev->cd, cmd, _data, SOF_IPC_MSG_MAX_SIZE);
 	if (ret < 0) {
@@ -866,7 +1718,10 @@ static int ipc_comp_value(uint32_t header, uint32_t cmd)
 	/* write component values to the outbox */
 	if (_data->rhdr.hdr.size <= MAILBOX_HOSTBOX_SIZE &&
 	    _data->rhdr.hdr.size <= SOF_IPC_MSG_MAX_SIZE) {
-		mailbox_hostbox_write(0, _data, data.rhdr.hdr.size);
+		if (_data != _ipc->comp_data)
+			dcache_writeback_region(_data, data.rhdr.hdr.size);
+		else
+			mailbox_hostbox_write(0, _data, data.rhdr.hdr.size);
 		ret = 1;
 	} else {
 		trace_ipc_error("ipc: comp %d cmd %u returned %d bytes max %d",
@@ -876,7 +1731,203 @@ static int ipc_comp_value(uint32_t header, uint32_t cmd)
 		ret = -EINVAL;
 	}
 
-	return ret;
+	return ret;
+}
+
+/* control data built for each component in a batch */
+static uint32_t ipc_batch_data[SOF_IPC_MSG_MAX_SIZE / sizeof(uint32_t)];
+
+/* set values of many components between two pipeline copies */
+static int ipc_comp_value_batch(uint32_t header)
+{
+	struct sof_ipc_ctrl_batch *batch = _ipc->comp_data;
+	struct sof_ipc_ctrl_batch_elem *elem;
+	struct sof_ipc_ctrl_data *data =
+		(struct sof_ipc_ctrl_data *)ipc_batch_data;
+	struct ipc_comp_dev *icd;
+	uint32_t offset;
+	uint32_t values;
+	uint32_t flags;
+	int ret = 0;
+	int i;
+
+	trace_ipc("ipc: comp batch of %d", batch->num_elems);
+
+	if (batch->hdr.size < sizeof(*batch)) {
+		trace_ipc_error("ipc: comp batch size %d too small",
+				batch->hdr.size);
+		return -EINVAL;
+	}
+
+	/* validate every elem before any is applied */
+	offset = sizeof(*batch);
+	for (i = 0; i < batch->num_elems; i++) {
+		elem = (struct sof_ipc_ctrl_batch_elem *)
+			((uint8_t *)batch + offset);
+		if (offset + sizeof(*elem) > batch->hdr.size)
+			goto overflow;
+
+		values = elem->num_elems * sizeof(elem->chanv[0]);
+		if (offset + sizeof(*elem) + values > batch->hdr.size ||
+		    sizeof(*data) + values > sizeof(ipc_batch_data))
+			goto overflow;
+
+		icd = ipc_get_comp(_ipc, elem->comp_id);
+		if (!icd || icd->type != COMP_TYPE_COMPONENT) {
+			trace_ipc_error("ipc: comp %d not found",
+					elem->comp_id);
+			return -ENODEV;
+		}
+
+		/* elems are applied together so can't be forwarded by IDC */
+		if (ipc_comp_is_remote(icd->cd)) {
+			trace_ipc_error("ipc: comp %d batch on remote core",
+					elem->comp_id);
+			return -EINVAL;
+		}
+
+		offset += sizeof(*elem) + values;
+	}
+
+	/* no pipeline copy can run on this core between elems */
+	flags = interrupt_global_disable();
+
+	offset = sizeof(*batch);
+	for (i = 0; i < batch->num_elems; i++) {
+		elem = (struct sof_ipc_ctrl_batch_elem *)
+			((uint8_t *)batch + offset);
+		values = elem->num_elems * sizeof(elem->chanv[0]);
+		offset += sizeof(*elem) + values;
+
+		icd = ipc_get_comp(_ipc, elem->comp_id);
+
+		bzero(data, sizeof(*data));
+		data->rhdr.hdr.cmd = SOF_IPC_GLB_COMP_MSG |
+			SOF_IPC_COMP_SET_VALUE;
+		data->rhdr.hdr.size = sizeof(*data) + values;
+		data->comp_id = elem->comp_id;
+		data->type = elem->type;
+		data->cmd = elem->cmd;
+		data->index = elem->index;
+		data->num_elems = elem->num_elems;
+		memcpy(data->chanv, elem->chanv, values);
+
+		ret = comp_cmd(icd->cd, COMP_CMD_SET_VALUE, data,
+			       sizeof(ipc_batch_data));
+		if (ret < 0) {
+			trace_ipc_error("ipc: comp %d batch cmd %u failed %d",
+					elem->comp_id, elem->cmd, ret);
+			break;
+		}
+	}
+
+	interrupt_global_enable(flags);
+
+	return ret < 0 ? ret : 0;
+
+overflow:
+	trace_ipc_error("ipc: comp batch elem %d overflows msg", i);
+	return -EINVAL;
+}
+
+/* queue control changes of a component at stream positions */
+static int ipc_comp_value_sched(uint32_t header)
+{
+	struct sof_ipc_ctrl_sched *sched = _ipc->comp_data;
+	struct sof_ipc_ctrl_event *event;
+	struct ipc_comp_dev *icd;
+	uint32_t offset;
+	uint32_t size;
+	int cmd;
+	int ret;
+	int i;
+
+	trace_ipc("ipc: comp %d sched %d events", sched->comp_id,
+		  sched->num_events);
+
+	if (sched->hdr.size < sizeof(*sched) ||
+	    sched->hdr.size > SOF_IPC_MSG_MAX_SIZE) {
+		trace_ipc_error("ipc: comp sched size %d invalid",
+				sched->hdr.size);
+		return -EINVAL;
+	}
+
+	icd = ipc_get_comp(_ipc, sched->comp_id);
+	if (!icd || icd->type != COMP_TYPE_COMPONENT) {
+		trace_ipc_error("ipc: comp %d not found", sched->comp_id);
+		return -ENODEV;
+	}
+
+	/* events are applied by copy() of components supporting them, the
+	 * queue is only accessed on the core running the pipeline
+	 */
+	if (!icd->cd->can_schedule || ipc_comp_is_remote(icd->cd)) {
+		trace_ipc_error("ipc: comp %d can't schedule events",
+				sched->comp_id);
+		return -EINVAL;
+	}
+
+	/* validate every event before any is queued */
+	offset = sizeof(*sched);
+	for (i = 0; i < sched->num_events; i++) {
+		event = (struct sof_ipc_ctrl_event *)
+			((uint8_t *)sched + offset);
+		if (offset + sizeof(*event) > sched->hdr.size)
+			goto overflow;
+
+		size = event->data.rhdr.hdr.size;
+		if (size < sizeof(event->data) ||
+		    offset + sizeof(*event) - sizeof(event->data) + size >
+		    sched->hdr.size)
+			goto overflow;
+
+		switch (iCS(event->data.rhdr.hdr.cmd)) {
+		case iCS(SOF_IPC_COMP_SET_VALUE):
+			break;
+		case iCS(SOF_IPC_COMP_SET_DATA):
+			if (size < sizeof(event->data) +
+			    sizeof(event->data.data[0]) ||
+			    event->data.data->magic != SOF_ABI_MAGIC ||
+			    event->data.data->abi != SOF_ABI_VERSION) {
+				trace_ipc_error("ipc: comp sched event %d "
+						"invalid data", i);
+				return -EINVAL;
+			}
+			break;
+		default:
+			trace_ipc_error("ipc: comp sched event %d cmd 0x%x",
+					i, event->data.rhdr.hdr.cmd);
+			return -EINVAL;
+		}
+
+		offset += sizeof(*event) - sizeof(event->data) + size;
+	}
+
+	offset = sizeof(*sched);
+	for (i = 0; i < sched->num_events; i++) {
+		event = (struct sof_ipc_ctrl_event *)
+			((uint8_t *)sched + offset);
+		offset += sizeof(*event) - sizeof(event->data) +
+			event->data.rhdr.hdr.size;
+
+		cmd = iCS(event->data.rhdr.hdr.cmd) ==
+			iCS(SOF_IPC_COMP_SET_DATA) ? COMP_CMD_SET_DATA :
+			COMP_CMD_SET_VALUE;
+
+		ret = comp_event_schedule(icd->cd, event->position, cmd,
+					  &event->data);
+		if (ret < 0) {
+			trace_ipc_error("ipc: comp %d sched event %d failed %d",
+					sched->comp_id, i, ret);
+			return ret;
+		}
+	}
+
+	return 0;
+
+overflow:
+	trace_ipc_error("ipc: comp sched event %d overflows msg", i);
+	return -EINVAL;
 }
 
 static int ipc_glb_comp_message(uint32_t header)
@@ -892,6 +1943,10 @@ static int ipc_glb_comp_message(uint32_t header)
 		return ipc_comp_value(header, COMP_CMD_SET_DATA);
 	case iCS(SOF_IPC_COMP_GET_DATA):
 		return ipc_comp_value(header, COMP_CMD_GET_DATA);
+	case iCS(SOF_IPC_COMP_SET_VALUE_BATCH):
+		return ipc_comp_value_batch(header);
+	case iCS(SOF_IPC_COMP_SET_VALUE_SCHED):
+		return ipc_comp_value_sched(header);
 	default:
 		trace_ipc_error("ipc: unknown comp cmd %u", cmd);
 		return -EINVAL;
@@ -968,8 +2023,7 @@ static int ipc_glb_tplg_pipe_new(uint32_t header)
 
 	trace_ipc("ipc: pipe %d -> new", ipc_pipeline.pipeline_id);
 
-	ret = ipc_pipeline_new(_ipc,
-			       (struct sof_ipc_pipe_new *)_ipc->comp_data);
+	ret = ipc_pipeline_new(_ipc, &ipc_pipeline);
 	if (ret < 0) {
 		trace_ipc_error("ipc: pipe %d creation failed %d",
 				ipc_pipeline.pipeline_id, ret);
@@ -1033,6 +2087,377 @@ static int ipc_glb_tplg_free(uint32_t header,
 	return ret;
 }
 
+/* minimum descriptor size, or 0 if the command is not allowed in a batch */
+static uint32_t ipc_tplg_batch_desc_size(uint32_t cmd)
+{
+	switch (cmd) {
+	case iCS(SOF_IPC_TPLG_COMP_NEW):
+		return sizeof(struct sof_ipc_comp);
+	case iCS(SOF_IPC_TPLG_BUFFER_NEW):
+		return sizeof(struct sof_ipc_buffer);
+	case iCS(SOF_IPC_TPLG_PIPE_NEW):
+		return sizeof(struct sof_ipc_pipe_new);
+	case iCS(SOF_IPC_TPLG_COMP_CONNECT):
+		return sizeof(struct sof_ipc_pipe_comp_connect);
+	case iCS(SOF_IPC_TPLG_PIPE_COMPLETE):
+		return sizeof(struct sof_ipc_pipe_ready);
+	default:
+		return 0;
+	}
+}
+
+static int ipc_tplg_batch_apply(struct sof_ipc_cmd_hdr *desc)
+{
+	uint32_t cmd = (desc->cmd & SOF_CMD_TYPE_MASK) >> SOF_CMD_TYPE_SHIFT;
+
+	switch (cmd) {
+	case iCS(SOF_IPC_TPLG_COMP_NEW):
+		return ipc_comp_new(_ipc, (struct sof_ipc_comp *)desc);
+	case iCS(SOF_IPC_TPLG_BUFFER_NEW):
+		return ipc_buffer_new(_ipc, (struct sof_ipc_buffer *)desc);
+	case iCS(SOF_IPC_TPLG_PIPE_NEW):
+		return ipc_pipeline_new(_ipc, (struct sof_ipc_pipe_new *)desc);
+	case iCS(SOF_IPC_TPLG_COMP_CONNECT):
+		return ipc_comp_connect(_ipc,
+				(struct sof_ipc_pipe_comp_connect *)desc);
+	case iCS(SOF_IPC_TPLG_PIPE_COMPLETE):
+		return ipc_pipeline_complete(_ipc,
+				((struct sof_ipc_pipe_ready *)desc)->comp_id);
+	default:
+		return -EINVAL;
+	}
+}
+
+/* pipeline freeing also undoes its completion */
+static void ipc_tplg_batch_undo(struct sof_ipc_cmd_hdr *desc)
+{
+	uint32_t cmd = (desc->cmd & SOF_CMD_TYPE_MASK) >> SOF_CMD_TYPE_SHIFT;
+
+	switch (cmd) {
+	case iCS(SOF_IPC_TPLG_COMP_NEW):
+		ipc_comp_free(_ipc, ((struct sof_ipc_comp *)desc)->id);
+		break;
+	case iCS(SOF_IPC_TPLG_BUFFER_NEW):
+		ipc_buffer_free(_ipc,
+				((struct sof_ipc_buffer *)desc)->comp.id);
+		break;
+	case iCS(SOF_IPC_TPLG_PIPE_NEW):
+		ipc_pipeline_free(_ipc,
+				  ((struct sof_ipc_pipe_new *)desc)->comp_id);
+		break;
+	case iCS(SOF_IPC_TPLG_COMP_CONNECT):
+		ipc_comp_disconnect(_ipc,
+				(struct sof_ipc_pipe_comp_connect *)desc);
+		break;
+	default:
+		break;
+	}
+}
+
+/* completion can only be undone for pipelines created in the same batch */
+static bool ipc_tplg_batch_has_pipe(uint8_t *data, uint32_t *offset,
+				    uint32_t count, uint32_t comp_id)
+{
+	struct sof_ipc_pipe_new *pipe;
+	uint32_t i;
+
+	for (i = 0; i < count; i++) {
+		pipe = (struct sof_ipc_pipe_new *)(data + offset[i]);
+		if ((pipe->hdr.cmd & SOF_CMD_TYPE_MASK) ==
+		    SOF_IPC_TPLG_PIPE_NEW && pipe->comp_id == comp_id)
+			return true;
+	}
+
+	return false;
+}
+
+/* apply count descriptors from data + pos up to size, all or nothing */
+static int ipc_tplg_batch_run(uint8_t *data, uint32_t pos, uint32_t size,
+			      uint32_t count, uint32_t *offset,
+			      uint32_t *applied)
+{
+	struct sof_ipc_cmd_hdr *desc;
+	uint32_t desc_size;
+	uint32_t cmd;
+	uint32_t done;
+	uint32_t i;
+	int ret = 0;
+
+	for (done = 0; done < count; done++) {
+		desc = (struct sof_ipc_cmd_hdr *)(data + pos);
+		cmd = (desc->cmd & SOF_CMD_TYPE_MASK) >> SOF_CMD_TYPE_SHIFT;
+
+		/* descriptor must fit the message and be a known type */
+		if (pos + sizeof(*desc) > size ||
+		    desc->size > size - pos ||
+		    (desc->cmd & SOF_GLB_TYPE_MASK) != SOF_IPC_GLB_TPLG_MSG) {
+			ret = -EINVAL;
+			break;
+		}
+
+		desc_size = ipc_tplg_batch_desc_size(cmd);
+		if (!desc_size || desc->size < desc_size) {
+			ret = -EINVAL;
+			break;
+		}
+
+		if (cmd == iCS(SOF_IPC_TPLG_PIPE_COMPLETE) &&
+		    !ipc_tplg_batch_has_pipe(data, offset, done,
+				((struct sof_ipc_pipe_ready *)desc)->comp_id)) {
+			ret = -EINVAL;
+			break;
+		}
+
+		ret = ipc_tplg_batch_apply(desc);
+		if (ret < 0)
+			break;
+
+		offset[done] = pos;
+		pos += ALIGN_UP(desc->size, 4);
+	}
+
+	if (ret < 0) {
+		trace_ipc_error("ipc: tplg batch descriptor %d failed %d",
+				done, ret);
+
+		/* undo in reverse order so links go before their ends */
+		for (i = done; i > 0; i--)
+			ipc_tplg_batch_undo((struct sof_ipc_cmd_hdr *)
+					    (data + offset[i - 1]));
+	}
+
+	*applied = done;
+	return ret;
+}
+
+static void ipc_tplg_batch_reply(uint32_t header, int ret, uint32_t done)
+{
+	struct sof_ipc_tplg_batch_reply reply;
+
+	reply.rhdr.hdr.size = sizeof(reply);
+	reply.rhdr.hdr.cmd = header;
+	reply.rhdr.error = ret;
+	reply.done = done;
+	reply.reserved[0] = 0;
+	reply.reserved[1] = 0;
+	reply.reserved[2] = 0;
+	mailbox_hostbox_write(0, &reply, sizeof(reply));
+}
+
+static int ipc_glb_tplg_batch(uint32_t header)
+{
+	struct sof_ipc_tplg_batch *batch = _ipc->comp_data;
+	uint32_t offset[IPC_TPLG_BATCH_MAX];
+	uint32_t done;
+	int ret;
+
+	if (batch->hdr.size < sizeof(*batch) ||
+	    batch->count > IPC_TPLG_BATCH_MAX) {
+		trace_ipc_error("ipc: tplg batch invalid size %d count %d",
+				batch->hdr.size, batch->count);
+		return -EINVAL;
+	}
+
+	trace_ipc("ipc: tplg batch -> %d descriptors", batch->count);
+
+	ret = ipc_tplg_batch_run((uint8_t *)batch, sizeof(*batch),
+				 batch->hdr.size, batch->count, offset, &done);
+
+	ipc_tplg_batch_reply(header, ret, done);
+	return 1;
+}
+
+#ifdef CONFIG_HOST_PTABLE
+/* DMA timeout per page in microseconds */
+#define IPC_TPLG_BLOB_TIMEOUT	1000
+
+/* read the whole blob from the host buffer, a page at a time */
+static int ipc_tplg_blob_fetch(struct sof_ipc_host_buffer *buffer,
+			       uint8_t *blob)
+{
+	struct ipc_data *iipc = ipc_get_drvdata(_ipc);
+	struct dma_sg_config sg;
+	struct dma_copy dc;
+	uint32_t offset = 0;
+	uint32_t size = buffer->size;
+	int err;
+
+	dma_sg_init(&sg.elem_array);
+
+	/* use DMA to read in compressed page table from host */
+	err = ipc_get_page_descriptors(iipc->dmac, iipc->page_table, buffer);
+	if (err < 0) {
+		trace_ipc_error("ipc: tplg blob failed to get descriptors %d",
+				err);
+		goto out;
+	}
+
+	err = ipc_parse_page_descriptors(iipc->page_table, buffer,
+					 &sg.elem_array,
+					 SOF_IPC_STREAM_PLAYBACK);
+	if (err < 0) {
+		trace_ipc_error("ipc: tplg blob failed to parse descriptors %d",
+				err);
+		goto out;
+	}
+
+	err = dma_copy_new(&dc);
+	if (err < 0) {
+		trace_ipc_error("ipc: tplg blob failed to get DMA %d", err);
+		goto out;
+	}
+
+	/* no trace position updates for blob copies */
+	dma_set_cb(dc.dmac, dc.chan, DMA_IRQ_TYPE_LLIST, ipc_pm_dma_complete,
+		   &dc.complete);
+	wait_init(&dc.complete);
+
+	while (size) {
+		wait_clear(&dc.complete);
+		dc.complete.timeout = IPC_TPLG_BLOB_TIMEOUT;
+
+		err = dma_copy_from_host_nowait(&dc, &sg, offset,
+						blob + offset, size);
+		if (err <= 0) {
+			err = err < 0 ? err : -EINVAL;
+			break;
+		}
+
+#if !defined CONFIG_DMA_GW
+		if (wait_for_completion_timeout(&dc.complete) < 0) {
+			err = -ETIME;
+			break;
+		}
+#endif
+
+		dcache_invalidate_region(blob + offset, err);
+		offset += err;
+		size -= err;
+		err = 0;
+	}
+
+	dma_copy_free(&dc);
+
+out:
+	dma_sg_free(&sg.elem_array);
+	return err;
+}
+#endif
+
+/* build a whole pre-linked topology fetched from the host in one go */
+static int ipc_glb_tplg_blob(uint32_t header)
+{
+#ifdef CONFIG_HOST_PTABLE
+	struct sof_ipc_tplg_blob msg;
+	struct sof_ipc_tplg_blob_hdr *blob;
+	uint32_t *offset = NULL;
+	uint32_t done = 0;
+	int ret;
+
+	/* copy message with ABI safe method */
+	IPC_COPY_CMD(msg, _ipc->comp_data);
+
+	if (msg.buffer.size < sizeof(*blob) ||
+	    msg.buffer.size > IPC_TPLG_BLOB_MAX_SIZE) {
+		trace_ipc_error("ipc: tplg blob invalid size %d",
+				msg.buffer.size);
+		return -EINVAL;
+	}
+
+	blob = rmalloc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM, msg.buffer.size);
+	if (!blob) {
+		trace_ipc_error("ipc: tplg blob alloc %d failed",
+				msg.buffer.size);
+		return -ENOMEM;
+	}
+
+	ret = ipc_tplg_blob_fetch(&msg.buffer, (uint8_t *)blob);
+	if (ret < 0)
+		goto out;
+
+	if (blob->magic != SOF_IPC_TPLG_BLOB_MAGIC ||
+	    SOF_ABI_VERSION_INCOMPATIBLE(SOF_ABI_VERSION, blob->abi) ||
+	    blob->size < sizeof(*blob) || blob->size > msg.buffer.size ||
+	    !blob->count ||
+	    blob->count > (blob->size - sizeof(*blob)) /
+			  sizeof(struct sof_ipc_cmd_hdr)) {
+		trace_ipc_error("ipc: tplg blob invalid header size %d count %d",
+				blob->size, blob->count);
+		ret = -EINVAL;
+		goto out;
+	}
+
+	offset = rmalloc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM,
+			 sizeof(*offset) * blob->count);
+	if (!offset) {
+		trace_ipc_error("ipc: tplg blob offsets alloc failed");
+		ret = -ENOMEM;
+		goto out;
+	}
+
+	trace_ipc("ipc: tplg blob -> %d descriptors", blob->count);
+
+	ret = ipc_tplg_batch_run((uint8_t *)blob, sizeof(*blob), blob->size,
+				 blob->count, offset, &done);
+
+	ipc_tplg_batch_reply(header, ret, done);
+	ret = 1;
+
+out:
+	if (offset)
+		rfree(offset);
+	rfree(blob);
+	return ret;
+#else
+	trace_ipc_error("ipc: tplg blob needs host page tables");
+	return -EINVAL;
+#endif
+}
+
+/* remember where a component module image is, it loads on first use */
+static int ipc_glb_tplg_module_new(uint32_t header)
+{
+#ifdef CONFIG_HOST_PTABLE
+	struct ipc_data *iipc = ipc_get_drvdata(_ipc);
+	struct sof_ipc_module_new msg;
+	struct dma_sg_elem_array elem_array;
+	int err;
+
+	/* copy message with ABI safe method */
+	IPC_COPY_CMD(msg, _ipc->comp_data);
+
+	trace_ipc("ipc: module type %d -> new", msg.comp_type);
+
+	dma_sg_init(&elem_array);
+
+	/* use DMA to read in compressed page table from host */
+	err = ipc_get_page_descriptors(iipc->dmac, iipc->page_table,
+				       &msg.buffer);
+	if (err < 0) {
+		trace_ipc_error("ipc: module failed to get descriptors %d",
+				err);
+		return err;
+	}
+
+	err = ipc_parse_page_descriptors(iipc->page_table, &msg.buffer,
+					 &elem_array, SOF_IPC_STREAM_PLAYBACK);
+	if (err < 0) {
+		trace_ipc_error("ipc: module failed to parse descriptors %d",
+				err);
+		return err;
+	}
+
+	err = module_register(msg.comp_type, &elem_array, msg.buffer.size);
+	if (err < 0)
+		dma_sg_free(&elem_array);
+
+	return err;
+#else
+	trace_ipc_error("ipc: module needs host page tables");
+	return -EINVAL;
+#endif
+}
+
 static int ipc_glb_tplg_message(uint32_t header)
 {
 	uint32_t cmd = (header & SOF_CMD_TYPE_MASK) >> SOF_CMD_TYPE_SHIFT;
@@ -1054,6 +2479,12 @@ static int ipc_glb_tplg_message(uint32_t header)
 		return ipc_glb_tplg_buffer_new(header);
 	case iCS(SOF_IPC_TPLG_BUFFER_FREE):
 		return ipc_glb_tplg_free(header, ipc_buffer_free);
+	case iCS(SOF_IPC_TPLG_BATCH):
+		return ipc_glb_tplg_batch(header);
+	case iCS(SOF_IPC_TPLG_BLOB):
+		return ipc_glb_tplg_blob(header);
+	case iCS(SOF_IPC_TPLG_MODULE_NEW):
+		return ipc_glb_tplg_module_new(header);
 	default:
 		trace_ipc_error("ipc: unknown tplg header %u", header);
 		return -EINVAL;
@@ -1096,6 +2527,8 @@ int ipc_cmd(void)
 		return ipc_glb_debug_message(hdr->cmd);
 	case iGS(SOF_IPC_GLB_GDB_DEBUG):
 		return ipc_glb_gdb_debug(hdr->cmd);
+	case iGS(SOF_IPC_GLB_DEBUG):
+		return ipc_glb_debug(hdr->cmd);
 	default:
 		trace_ipc_error("ipc: unknown command type %u", type);
 		return -EINVAL;
@@ -1116,114 +2549,86 @@ static inline struct ipc_msg *msg_get_empty(struct ipc *ipc)
 	return msg;
 }
 
-static inline struct ipc_msg *ipc_glb_stream_message_find(struct ipc *ipc,
-	struct sof_ipc_stream_posn *posn)
+/* only position messages can be replaced by a newer one */
+static inline int msg_replaceable(uint32_t header)
 {
-	struct list_item *plist;
-	struct ipc_msg *msg = NULL;
-	struct sof_ipc_stream_posn *old_posn = NULL;
-	uint32_t cmd;
-
-	/* Check whether the command is expected */
-	cmd = (posn->rhdr.hdr.cmd & SOF_CMD_TYPE_MASK) >> SOF_CMD_TYPE_SHIFT;
-
-	switch (cmd) {
-	case iCS(SOF_IPC_STREAM_TRIG_XRUN):
-	case iCS(SOF_IPC_STREAM_POSITION):
+	uint32_t type = (header & SOF_GLB_TYPE_MASK) >> SOF_GLB_TYPE_SHIFT;
+	uint32_t cmd = (header & SOF_CMD_TYPE_MASK) >> SOF_CMD_TYPE_SHIFT;
 
-		/* iterate host message list for searching */
-		list_for_item(plist, &ipc->shared_ctx->msg_list) {
-			msg = container_of(plist, struct ipc_msg, list);
-			if (msg->header == posn->rhdr.hdr.cmd) {
-				old_posn = (struct sof_ipc_stream_posn *)msg->tx_data;
-				if (old_posn->comp_id == posn->comp_id)
-					return msg;
-			}
-		}
-		break;
+	switch (type) {
+	case iGS(SOF_IPC_GLB_STREAM_MSG):
+		return cmd == iCS(SOF_IPC_STREAM_TRIG_XRUN) ||
+			cmd == iCS(SOF_IPC_STREAM_POSITION);
+	case iGS(SOF_IPC_GLB_TRACE_MSG):
+		return cmd == iCS(SOF_IPC_TRACE_DMA_POSITION);
+	case iGS(SOF_IPC_GLB_DEBUG):
+		return cmd == iCS(SOF_IPC_DEBUG_PROBE_POSITION);
 	default:
-		break;
+		return 0;
 	}
-
-	/* no match */
-	return NULL;
 }
 
-static inline struct ipc_msg *ipc_glb_trace_message_find(struct ipc *ipc,
-	struct sof_ipc_dma_trace_posn *posn)
+/* stream message headers carry the comp id in the low bits */
+static inline uint32_t msg_index_hash(uint32_t header)
 {
-	struct list_item *plist;
-	struct ipc_msg *msg = NULL;
-	uint32_t cmd;
-
-	/* Check whether the command is expected */
-	cmd = (posn->rhdr.hdr.cmd & SOF_CMD_TYPE_MASK) >> SOF_CMD_TYPE_SHIFT;
-
-	switch (cmd) {
-	case iCS(SOF_IPC_TRACE_DMA_POSITION):
-		/* iterate host message list for searching */
-		list_for_item(plist, &ipc->shared_ctx->msg_list) {
-			msg = container_of(plist, struct ipc_msg, list);
-			if (msg->header == posn->rhdr.hdr.cmd)
-				return msg;
-		}
-		break;
-	default:
-		break;
-	}
-
-	/* no match */
-	return NULL;
+	return (header ^ (header >> SOF_CMD_TYPE_SHIFT)) & (MSG_INDEX_SIZE - 1);
 }
 
-static inline struct ipc_msg *msg_find(struct ipc *ipc, uint32_t header,
-	void *tx_data)
+/* locks held by caller */
+static inline struct ipc_msg *msg_find(struct ipc *ipc, uint32_t header)
 {
-	uint32_t type;
+	struct ipc_msg *msg;
 
-	/* use different sub function for different global message type */
-	type = (header & SOF_GLB_TYPE_MASK) >> SOF_GLB_TYPE_SHIFT;
-
-	switch (type) {
-	case iGS(SOF_IPC_GLB_STREAM_MSG):
-		return ipc_glb_stream_message_find(ipc,
-			(struct sof_ipc_stream_posn *)tx_data);
-	case iGS(SOF_IPC_GLB_TRACE_MSG):
-		return ipc_glb_trace_message_find(ipc,
-			(struct sof_ipc_dma_trace_posn *)tx_data);
-	default:
-		/* not found */
+	if (!msg_replaceable(header))
 		return NULL;
-	}
+
+	msg = ipc->shared_ctx->msg_index[msg_index_hash(header)];
+	if (msg && msg->queued && msg->header == header)
+		return msg;
+
+	/* not queued, or its index slot was taken by another header */
+	return NULL;
 }
 
+/*
+ * Replacing a queued message is an index lookup and a copy under the lock.
+ * A new message is taken from the empty list and filled with IRQs enabled,
+ * the lock is only held again to queue it.
+ */
 int ipc_queue_host_message(struct ipc *ipc, uint32_t header, void *tx_data,
 			   size_t tx_bytes, uint32_t replace)
 {
 	struct ipc_msg *msg = NULL;
-	uint32_t flags, found = 0;
-	int ret = 0;
+	uint32_t flags;
 
 	spin_lock_irq(&ipc->lock, flags);
 
 	/* do we need to replace an existing message? */
 	if (replace)
-		msg = msg_find(ipc, header, tx_data);
+		msg = msg_find(ipc, header);
 
-	/* do we need to use a new empty message? */
-	if (msg)
-		found = 1;
-	else
-		msg = msg_get_empty(ipc);
+	if (msg) {
+		/* still queued so the sender has not read the payload */
+		msg->tx_size = tx_bytes;
+		if (tx_bytes > 0 && tx_bytes < SOF_IPC_MSG_MAX_SIZE)
+			rmemcpy(msg->tx_data, tx_data, tx_bytes);
+
+		spin_unlock_irq(&ipc->lock, flags);
+		return 0;
+	}
+
+	/* use a new empty message */
+	msg = msg_get_empty(ipc);
+
+	spin_unlock_irq(&ipc->lock, flags);
 
 	if (msg == NULL) {
 		trace_ipc_error("ipc: msg hdr for 0x%08x not found "
 				"replace %d", header, replace);
-		ret = -EBUSY;
-		goto out;
+		return -EBUSY;
 	}
 
-	/* prepare the message */
+	/* prepare the message, nobody else can see it until it is queued */
 	msg->header = header;
 	msg->tx_size = tx_bytes;
 
@@ -1231,15 +2636,19 @@ int ipc_queue_host_message(struct ipc *ipc, uint32_t header, void *tx_data,
 	if (tx_bytes > 0 && tx_bytes < SOF_IPC_MSG_MAX_SIZE)
 		rmemcpy(msg->tx_data, tx_data, tx_bytes);
 
-	if (!found) {
-		/* now queue the message */
-		ipc->shared_ctx->dsp_pending = 1;
-		list_item_append(&msg->list, &ipc->shared_ctx->msg_list);
-	}
+	spin_lock_irq(&ipc->lock, flags);
+
+	/* now queue the message */
+	msg->queued = 1;
+	if (msg_replaceable(header))
+		ipc->shared_ctx->msg_index[msg_index_hash(header)] = msg;
+
+	ipc->shared_ctx->dsp_pending = 1;
+	list_item_append(&msg->list, &ipc->shared_ctx->msg_list);
 
-out:
 	spin_unlock_irq(&ipc->lock, flags);
-	return ret;
+
+	return 0;
 }
 
 /* process current message */
@@ -1260,3 +2669,33 @@ void ipc_schedule_process(struct ipc *ipc)
 {
 	schedule_task(&ipc->ipc_task, 0, 100);
 }
+
+/* deferred stages only need to complete well within the host timeout */
+#define IPC_DEFER_DEADLINE_US	10000
+
+/*
+ * Long running handlers split their work into stages so the IPC task
+ * never holds its IRQ level for long. A handler queues its next stage
+ * with ipc_defer() and returns its value. The stage runs as low priority
+ * work behind any audio task due at that level and may defer again, its
+ * final return value completes the command like a handler return value.
+ * The host waits for the reply, so no other command runs meanwhile.
+ */
+int ipc_defer(int (*func)(void *data), void *data)
+{
+	_ipc->defer_func = func;
+	_ipc->defer_data = data;
+	schedule_task(&_ipc->defer_task, 0, IPC_DEFER_DEADLINE_US);
+
+	return IPC_CMD_DEFERRED;
+}
+
+void ipc_defer_task(void *data)
+{
+	struct ipc *ipc = data;
+	int err;
+
+	err = ipc->defer_func(ipc->defer_data);
+	if (err != IPC_CMD_DEFERRED)
+		ipc_platform_complete_cmd(ipc, err);
+}
@@ -38,7 +38,12 @@
 #include <sof/stream.h>
 #include <sof/alloc.h>
 #include <sof/ipc.h>
+#include <sof/mailbox.h>
 #include <sof/debug.h>
+#include <sof/cpu.h>
+#include <sof/wait.h>
+#include <sof/drivers/timer.h>
+#include <arch/cache.h>
 #include <platform/platform.h>
 #include <sof/audio/component.h>
 #include <sof/audio/pipeline.h>
@@ -46,33 +51,39 @@
 
 /*
  * Components, buffers and pipelines all use the same set of monotonic ID
- * numbers passed in by the host. They are stored in different lists, hence
- * more than 1 list may need to be searched for the corresponding component.
+ * numbers passed in by the host. They are all kept in one list for walking
+ * and are also hashed by ID, so a lookup only searches a single bucket.
+ * Monotonic IDs spread evenly over the buckets.
  */
 
+static inline struct list_item *ipc_comp_bucket(struct ipc *ipc, uint32_t id)
+{
+	return &ipc->shared_ctx->comp_hash[id & (COMP_HASH_SIZE - 1)];
+}
+
+static void ipc_comp_add(struct ipc *ipc, struct ipc_comp_dev *icd,
+			 uint32_t id)
+{
+	icd->id = id;
+	list_item_append(&icd->list, &ipc->shared_ctx->comp_list);
+	list_item_append(&icd->hash_list, ipc_comp_bucket(ipc, id));
+}
+
+static void ipc_comp_del(struct ipc_comp_dev *icd)
+{
+	list_item_del(&icd->list);
+	list_item_del(&icd->hash_list);
+}
+
 struct ipc_comp_dev *ipc_get_comp(struct ipc *ipc, uint32_t id)
 {
 	struct ipc_comp_dev *icd;
 	struct list_item *clist;
 
-	list_for_item(clist, &ipc->shared_ctx->comp_list) {
-		icd = container_of(clist, struct ipc_comp_dev, list);
-		switch (icd->type) {
-		case COMP_TYPE_COMPONENT:
-			if (icd->cd->comp.id == id)
-				return icd;
-			break;
-		case COMP_TYPE_BUFFER:
-			if (icd->cb->ipc_buffer.comp.id == id)
-				return icd;
-			break;
-		case COMP_TYPE_PIPELINE:
-			if (icd->pipeline->ipc_pipe.comp_id == id)
-				return icd;
-			break;
-		default:
-			break;
-		}
+	list_for_item(clist, ipc_comp_bucket(ipc, id)) {
+		icd = container_of(clist, struct ipc_comp_dev, hash_list);
+		if (icd->id == id)
+			return icd;
 	}
 
 	return NULL;
@@ -99,6 +110,69 @@ int ipc_get_posn_offset(struct ipc *ipc, struct pipeline *pipe)
 	return -EINVAL;
 }
 
+int ipc_get_vol_offset(struct ipc *ipc, struct comp_dev *dev)
+{
+	uint32_t base = PLATFORM_MAX_STREAMS *
+		sizeof(struct sof_ipc_stream_posn);
+	uint32_t vol_size = sizeof(struct sof_ipc_ctrl_mmap_vol);
+	uint32_t offset;
+	int i;
+
+	for (i = 0; i < PLATFORM_MAX_STREAMS; i++) {
+		if (ipc->vol_map[i] == dev)
+			return base + i * vol_size;
+	}
+
+	for (i = 0; i < PLATFORM_MAX_STREAMS; i++) {
+		offset = base + i * vol_size;
+		if (offset + vol_size > MAILBOX_STREAM_SIZE)
+			break;
+
+		if (ipc->vol_map[i] == NULL) {
+			ipc->vol_map[i] = dev;
+			return offset;
+		}
+	}
+
+	return -ENOMEM;
+}
+
+void ipc_put_vol_offset(struct ipc *ipc, struct comp_dev *dev)
+{
+	int i;
+
+	for (i = 0; i < PLATFORM_MAX_STREAMS; i++) {
+		if (ipc->vol_map[i] == dev)
+			ipc->vol_map[i] = NULL;
+	}
+}
+
+#ifdef CONFIG_STREAM_STATS
+/* stats slots follow the volume slots and use the position slot index */
+int ipc_get_stats_offset(struct ipc *ipc, struct pipeline *pipe)
+{
+	uint32_t base = PLATFORM_MAX_STREAMS *
+		(sizeof(struct sof_ipc_stream_posn) +
+		 sizeof(struct sof_ipc_ctrl_mmap_vol));
+	uint32_t stats_size = sizeof(struct sof_ipc_stream_stats);
+	uint32_t offset;
+	int i;
+
+	for (i = 0; i < PLATFORM_MAX_STREAMS; i++) {
+		if (ipc->posn_map[i] != pipe)
+			continue;
+
+		offset = base + i * stats_size;
+		if (offset + stats_size > MAILBOX_STREAM_SIZE)
+			return -ENOMEM;
+
+		return offset;
+	}
+
+	return -EINVAL;
+}
+#endif
+
 int ipc_comp_new(struct ipc *ipc, struct sof_ipc_comp *comp)
 {
 	struct comp_dev *cd;
@@ -132,7 +206,7 @@ int ipc_comp_new(struct ipc *ipc, struct sof_ipc_comp *comp)
 	icd->type = COMP_TYPE_COMPONENT;
 
 	/* add new component to the list */
-	list_item_append(&icd->list, &ipc->shared_ctx->comp_list);
+	ipc_comp_add(ipc, icd, comp->id);
 	return ret;
 }
 
@@ -147,7 +221,7 @@ int ipc_comp_free(struct ipc *ipc, uint32_t comp_id)
 
 	/* free component and remove from list */
 	comp_free(icd->cd);
-	list_item_del(&icd->list);
+	ipc_comp_del(icd);
 	rfree(icd);
 
 	return 0;
@@ -186,7 +260,7 @@ int ipc_buffer_new(struct ipc *ipc, struct sof_ipc_buffer *desc)
 	ibd->type = COMP_TYPE_BUFFER;
 
 	/* add new buffer to the list */
-	list_item_append(&ibd->list, &ipc->shared_ctx->comp_list);
+	ipc_comp_add(ipc, ibd, desc->comp.id);
 	return ret;
 }
 
@@ -201,7 +275,7 @@ int ipc_buffer_free(struct ipc *ipc, uint32_t buffer_id)
 
 	/* free buffer and remove from list */
 	buffer_free(ibd->cb);
-	list_item_del(&ibd->list);
+	ipc_comp_del(ibd);
 	rfree(ibd);
 
 	return 0;
@@ -246,6 +320,30 @@ int ipc_comp_connect(struct ipc *ipc,
 	}
 }
 
+int ipc_comp_disconnect(struct ipc *ipc,
+	struct sof_ipc_pipe_comp_connect *connect)
+{
+	struct ipc_comp_dev *icd_source;
+	struct ipc_comp_dev *icd_sink;
+
+	icd_source = ipc_get_comp(ipc, connect->source_id);
+	icd_sink = ipc_get_comp(ipc, connect->sink_id);
+	if (icd_source == NULL || icd_sink == NULL)
+		return -ENODEV;
+
+	/* check source and sink types */
+	if (icd_source->type == COMP_TYPE_BUFFER &&
+		icd_sink->type == COMP_TYPE_COMPONENT)
+		pipeline_buffer_disconnect(icd_source->cb, icd_sink->cd);
+	else if (icd_source->type == COMP_TYPE_COMPONENT &&
+		icd_sink->type == COMP_TYPE_BUFFER)
+		pipeline_comp_disconnect(icd_source->cd, icd_sink->cb);
+	else
+		return -EINVAL;
+
+	return 0;
+}
+
 
 int ipc_pipeline_new(struct ipc *ipc,
 	struct sof_ipc_pipe_new *pipe_desc)
@@ -263,6 +361,13 @@ int ipc_pipeline_new(struct ipc *ipc,
 		return -EINVAL;
 	}
 
+	if (pipe_desc->periods_per_sched > PIPELINE_MAX_PERIODS_PER_SCHED) {
+		trace_ipc_error("ipc_pipeline_new() error: %u periods per "
+				"run, max %u", pipe_desc->periods_per_sched,
+				PIPELINE_MAX_PERIODS_PER_SCHED);
+		return -EINVAL;
+	}
+
 	/* find the scheduling component */
 	icd = ipc_get_comp(ipc, pipe_desc->sched_id);
 	if (icd == NULL) {
@@ -297,7 +402,7 @@ int ipc_pipeline_new(struct ipc *ipc,
 	ipc_pipe->type = COMP_TYPE_PIPELINE;
 
 	/* add new pipeline to the list */
-	list_item_append(&ipc_pipe->list, &ipc->shared_ctx->comp_list);
+	ipc_comp_add(ipc, ipc_pipe, pipe_desc->comp_id);
 	return 0;
 }
 
@@ -319,15 +424,48 @@ int ipc_pipeline_free(struct ipc *ipc, uint32_t comp_id)
 		return ret;
 	}
 
-	list_item_del(&ipc_pipe->list);
+	ipc_comp_del(ipc_pipe);
 	rfree(ipc_pipe);
 
 	return 0;
 }
 
+/* use lock free mode for buffers connecting pipelines on different cores */
+static void ipc_pipeline_buffers_spsc(struct ipc *ipc, struct pipeline *p)
+{
+	struct ipc_comp_dev *icd;
+	struct list_item *clist;
+	struct comp_buffer *buffer;
+	struct pipeline *source;
+	struct pipeline *sink;
+
+	list_for_item(clist, &ipc->shared_ctx->comp_list) {
+		icd = container_of(clist, struct ipc_comp_dev, list);
+		if (icd->type != COMP_TYPE_BUFFER)
+			continue;
+
+		buffer = icd->cb;
+		if (buffer->spsc || !buffer->source || !buffer->sink)
+			continue;
+
+		/* both pipelines must be complete */
+		source = buffer->source->pipeline;
+		sink = buffer->sink->pipeline;
+		if (!source || !sink || (source != p && sink != p))
+			continue;
+
+		if (source->ipc_pipe.core != sink->ipc_pipe.core) {
+			trace_ipc("ipc: buffer %d in SPSC mode",
+				  buffer->ipc_buffer.comp.id);
+			buffer_set_spsc(buffer);
+		}
+	}
+}
+
 int ipc_pipeline_complete(struct ipc *ipc, uint32_t comp_id)
 {
 	struct ipc_comp_dev *ipc_pipe;
+	int ret;
 
 	/* check whether pipeline exists */
 	ipc_pipe = ipc_get_comp(ipc, comp_id);
@@ -335,8 +473,173 @@ int ipc_pipeline_complete(struct ipc *ipc, uint32_t comp_id)
 		return -EINVAL;
 
 	/* free buffer and remove from list */
-	return pipeline_complete(ipc_pipe->pipeline);
+	ret = pipeline_complete(ipc_pipe->pipeline);
+	if (ret < 0)
+		return ret;
+
+	ipc_pipeline_buffers_spsc(ipc, ipc_pipe->pipeline);
+
+	return ret;
+}
+
+static void ipc_pipeline_group_cache(struct ipc *ipc, int cmd)
+{
+	struct ipc_group_trigger *group = &ipc->shared_ctx->group;
+	struct ipc_comp_dev *pcm_dev;
+	uint32_t i;
+
+	for (i = 0; i < group->count; i++) {
+		pcm_dev = ipc_get_comp(ipc, group->comp_id[i]);
+		if (pcm_dev &&
+		    pcm_dev->cd->pipeline->ipc_pipe.core == cpu_get_id())
+			pipeline_cache(pcm_dev->cd->pipeline, pcm_dev->cd, cmd);
+	}
+}
+
+int ipc_pipeline_group_trigger(struct ipc *ipc)
+{
+	struct ipc_group_trigger *group = &ipc->shared_ctx->group;
+	struct ipc_comp_dev *pcm_dev;
+	struct pipeline *p;
+	uint32_t i;
+	int ret = 0;
+	int err;
+
+	/* slave cores pick up the pipeline state written by the master */
+	if (cpu_get_id() != PLATFORM_MASTER_CORE_ID &&
+	    group->cmd == COMP_TRIGGER_START)
+		ipc_pipeline_group_cache(ipc, COMP_CACHE_INVALIDATE);
+
+	while (platform_timer_get(platform_timer) < group->start)
+		idelay(PLATFORM_DEFAULT_DELAY);
+
+	/* DAIs of all the members on this core start together */
+	dai_group_begin();
+
+	for (i = 0; i < group->count; i++) {
+		pcm_dev = ipc_get_comp(ipc, group->comp_id[i]);
+		if (!pcm_dev)
+			continue;
+
+		p = pcm_dev->cd->pipeline;
+		if (p->ipc_pipe.core != cpu_get_id())
+			continue;
+
+		err = pipeline_trigger(p, pcm_dev->cd, group->cmd);
+		if (err < 0) {
+			trace_ipc_error("ipc: comp %d group trigger failed %d",
+					group->comp_id[i], err);
+			if (!ret)
+				ret = err;
+		}
+	}
+
+	err = dai_group_end();
+	if (err < 0 && !ret)
+		ret = err;
+
+	if (cpu_get_id() != PLATFORM_MASTER_CORE_ID &&
+	    group->cmd == COMP_TRIGGER_STOP)
+		ipc_pipeline_group_cache(ipc, COMP_CACHE_WRITEBACK_INV);
+
+	return ret;
+}
+
+#ifdef CONFIG_PIPELINE_CORE_BALANCE
+/* pipeline can only be moved if no buffer is shared with another pipeline */
+static int ipc_pipeline_standalone(struct ipc *ipc, struct pipeline *p)
+{
+	struct ipc_comp_dev *icd;
+	struct list_item *clist;
+	struct comp_buffer *buffer;
+
+	list_for_item(clist, &ipc->shared_ctx->comp_list) {
+		icd = container_of(clist, struct ipc_comp_dev, list);
+		if (icd->type != COMP_TYPE_BUFFER)
+			continue;
+
+		buffer = icd->cb;
+		if (!buffer->source || !buffer->sink)
+			continue;
+
+		/* buffer crosses pipelines with one end in ours */
+		if (buffer->source->pipeline != buffer->sink->pipeline &&
+		    (buffer->source->pipeline == p ||
+		     buffer->sink->pipeline == p))
+			return 0;
+	}
+
+	return 1;
+}
+
+/* sum of running pipeline loads on core in 1/1000 of core time */
+static uint32_t ipc_core_load(struct ipc *ipc, int core, struct pipeline *skip)
+{
+	struct ipc_comp_dev *icd;
+	struct list_item *clist;
+	struct pipeline *p;
+	uint32_t load = 0;
+
+	list_for_item(clist, &ipc->shared_ctx->comp_list) {
+		icd = container_of(clist, struct ipc_comp_dev, list);
+		if (icd->type != COMP_TYPE_PIPELINE)
+			continue;
+
+		p = icd->pipeline;
+		if (p == skip)
+			continue;
+
+		/* runtime stats are updated by the core running the pipeline */
+		if (p->ipc_pipe.core != cpu_get_id())
+			dcache_invalidate_region(&p->pipe_task,
+						 sizeof(p->pipe_task));
+
+		if (p->ipc_pipe.core == core && p->status == COMP_STATE_ACTIVE)
+			load += pipeline_load(p);
+	}
+
+	return load;
+}
+
+/*
+ * Assign pipeline to the least loaded enabled core before it's started.
+ * The IDC pipeline trigger then runs it on the new core.
+ */
+void ipc_pipeline_balance(struct ipc *ipc, struct pipeline *p)
+{
+	uint32_t best_load;
+	uint32_t load;
+	int best_core;
+	int i;
+
+	if (p->status == COMP_STATE_ACTIVE || !ipc_pipeline_standalone(ipc, p))
+		return;
+
+	best_core = p->ipc_pipe.core;
+	best_load = ipc_core_load(ipc, best_core, p);
+
+	for (i = 0; i < PLATFORM_CORE_COUNT; i++) {
+		if (i == best_core || !cpu_is_core_enabled(i))
+			continue;
+
+		load = ipc_core_load(ipc, i, p);
+		if (load < best_load) {
+			best_load = load;
+			best_core = i;
+		}
+	}
+
+	if (best_core == p->ipc_pipe.core)
+		return;
+
+	trace_ipc("ipc: pipe %d moved from core %d to %d load %d",
+		  p->ipc_pipe.pipeline_id, p->ipc_pipe.core, best_core,
+		  best_load);
+
+	p->ipc_pipe.core = best_core;
+	p->pipe_task.core = best_core;
 }
+#endif
 
 int ipc_comp_dai_config(struct ipc *ipc, struct sof_ipc_dai_config *config)
 {
@@ -388,10 +691,41 @@ int ipc_comp_dai_config(struct ipc *ipc, struct sof_ipc_dai_config *config)
 }
 
 #ifdef CONFIG_HOST_PTABLE
+/* physical address of a page in the compressed 20 bit page table */
+static uint32_t ipc_page_addr(uint8_t *page_table, int page)
+{
+	uint32_t idx = (((page << 2) + page)) >> 1;
+	uint32_t phy_addr = page_table[idx] | (page_table[idx + 1] << 8)
+		| (page_table[idx + 2] << 16);
+
+	if (page & 0x1)
+		phy_addr <<= 8;
+	else
+		phy_addr <<= 12;
+
+	return phy_addr & 0xfffff000;
+}
+
+/* number of physically contiguous page runs in the page table */
+static uint32_t ipc_page_runs(uint8_t *page_table, int pages)
+{
+	uint32_t runs = 1;
+	int i;
+
+	for (i = 1; i < pages; i++) {
+		if (ipc_page_addr(page_table, i) !=
+		    ipc_page_addr(page_table, i - 1) + HOST_PAGE_SIZE)
+			runs++;
+	}
+
+	return runs;
+}
+
 /*
  * Parse the host page tables and create the audio DMA SG configuration
- * for host audio DMA buffer. This involves creating a dma_sg_elem for each
- * page table entry and adding each elem to a list in struct dma_sg_config.
+ * for host audio DMA buffer. Physically contiguous pages are merged, so
+ * there is a dma_sg_elem for each run of pages rather than for each page
+ * table entry, e.g. a single elem for a contiguous deep buffer.
  */
 int ipc_parse_page_descriptors(uint8_t *page_table,
 			       struct sof_ipc_host_buffer *ring,
@@ -399,9 +733,9 @@ int ipc_parse_page_descriptors(uint8_t *page_table,
 			       uint32_t direction)
 {
 	int i;
-	uint32_t idx;
 	uint32_t phy_addr;
-	struct dma_sg_elem *e;
+	uint32_t size;
+	struct dma_sg_elem *e = NULL;
 
 	/* the ring size may be not multiple of the page size, the last
 	 * page may be not full used. The used size should be in range
@@ -415,35 +749,36 @@ int ipc_parse_page_descriptors(uint8_t *page_table,
 		return -EINVAL;
 	}
 
+	elem_array->count = ipc_page_runs(page_table, ring->pages);
 	elem_array->elems = rzalloc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM,
-				    sizeof(struct dma_sg_elem) * ring->pages);
+				    sizeof(struct dma_sg_elem) *
+				    elem_array->count);
 	if (!elem_array->elems)
 		return -ENOMEM;
-	elem_array->count = ring->pages;
 
 	for (i = 0; i < ring->pages; i++) {
-		idx = (((i << 2) + i)) >> 1;
-		phy_addr = page_table[idx] | (page_table[idx + 1] << 8)
-				| (page_table[idx + 2] << 16);
+		phy_addr = ipc_page_addr(page_table, i);
 
-		if (i & 0x1)
-			phy_addr <<= 8;
+		/* the last page may be not full used */
+		if (i == (ring->pages - 1))
+			size = ring->size - HOST_PAGE_SIZE * i;
 		else
-			phy_addr <<= 12;
-		phy_addr &= 0xfffff000;
+			size = HOST_PAGE_SIZE;
 
-		e = elem_array->elems + i;
+		/* page continues the current run */
+		if (e && phy_addr == ipc_page_addr(page_table, i - 1) +
+		    HOST_PAGE_SIZE) {
+			e->size += size;
+			continue;
+		}
+
+		e = e ? e + 1 : elem_array->elems;
 
 		if (direction == SOF_IPC_STREAM_PLAYBACK)
 			e->src = phy_addr;
 		else
 			e->dest = phy_addr;
-
-		/* the last page may be not full used */
-		if (i == (ring->pages - 1))
-			e->size = ring->size - HOST_PAGE_SIZE * i;
-		else
-			e->size = HOST_PAGE_SIZE;
+		e->size = size;
 	}
 
 	return 0;
@@ -538,8 +873,10 @@ int ipc_init(struct sof *sof)
 				      SOF_IPC_MSG_MAX_SIZE);
 	sof->ipc->dmat = sof->dmat;
 
-	for (i = 0; i < PLATFORM_MAX_STREAMS; i++)
+	for (i = 0; i < PLATFORM_MAX_STREAMS; i++) {
 		sof->ipc->posn_map[i] = NULL;
+		sof->ipc->vol_map[i] = NULL;
+	}
 
 	spinlock_init(&sof->ipc->lock);
 
@@ -553,10 +890,20 @@ int ipc_init(struct sof *sof)
 	list_init(&sof->ipc->shared_ctx->empty_list);
 	list_init(&sof->ipc->shared_ctx->msg_list);
 	list_init(&sof->ipc->shared_ctx->comp_list);
+	for (i = 0; i < COMP_HASH_SIZE; i++)
+		list_init(&sof->ipc->shared_ctx->comp_hash[i]);
 
 	for (i = 0; i < MSG_QUEUE_SIZE; i++)
 		list_item_prepend(&sof->ipc->shared_ctx->message[i].list,
 				  &sof->ipc->shared_ctx->empty_list);
 
+#ifdef CONFIG_IPC_POSN_BATCH
+	sof->ipc->shared_ctx->posn_pending = 0;
+	sof->ipc->shared_ctx->posn_next = 0;
+	for (i = 0; i < ARRAY_SIZE(sof->ipc->shared_ctx->posn_work); i++)
+		work_init(&sof->ipc->shared_ctx->posn_work[i],
+			  ipc_stream_posn_work, sof->ipc, WORK_ASYNC);
+#endif
+
 	return platform_ipc_init(sof->ipc);
 }
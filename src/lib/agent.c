@@ -41,6 +41,7 @@
 #include <sof/alloc.h>
 #include <sof/clk.h>
 #include <sof/trace.h>
+#include <sof/timebase.h>
 #include <platform/timer.h>
 #include <platform/platform.h>
 #include <platform/clk.h>
@@ -56,7 +57,7 @@ void sa_enter_idle(struct sof *sof)
 {
 	struct sa *sa = sof->sa;
 
-	sa->last_idle = platform_timer_get(platform_timer);
+	sa->last_idle = timebase_get();
 }
 
 static uint64_t validate(void *data, uint64_t delay)
@@ -65,7 +66,7 @@ static uint64_t validate(void *data, uint64_t delay)
 	uint64_t current;
 	uint64_t delta;
 
-	current = platform_timer_get(platform_timer);
+	current = timebase_get();
 	delta = current - sa->last_idle;
 
 	/* were we last idle longer than timeout */
@@ -95,5 +96,6 @@ void sa_init(struct sof *sof)
 	/* set lst idle time to now to give time for boot completion */
 	sa->last_idle = platform_timer_get(platform_timer) + sa->ticks;
 	work_init(&sa->work, validate, sa, WORK_ASYNC);
+	work_set_slack(&sa->work, PLATFORM_WORKQ_DEFAULT_TIMEOUT);
 	work_schedule_default(&sa->work, PLATFORM_IDLE_TIME);
 }
@@ -36,8 +36,17 @@
 #include <sof/trace.h>
 #include <sof/lock.h>
 #include <sof/cpu.h>
+#include <sof/dma.h>
+#include <sof/wait.h>
+#include <arch/cache.h>
 #include <platform/memory.h>
+#include <uapi/ipc/debug.h>
 #include <stdint.h>
+#include <errno.h>
+
+#ifdef CONFIG_SRAM_BANK_GATING
+#include <platform/pm_runtime.h>
+#endif
 
 /* debug to set memory value on every allocation */
 #define DEBUG_BLOCK_FREE 0
@@ -62,6 +71,12 @@ extern struct mm memmap;
  *    set at build time.
  * 3) Buffer memory pool has fixed size allocation map and can be freed on
  *    module removal or calls to rfree(). Saved as part of PM context.
+ *
+ * Platforms defining PLATFORM_HEAP_CORE also carve a runtime and a buffer
+ * heap out for each core. Runtime and buffer allocations try the calling
+ * core's partition first without taking memmap.lock and fall back to the
+ * shared pools above when it's exhausted. Blocks freed by another core are
+ * queued on the owner and returned by the owner on its next alloc or free.
  */
 
 #if DEBUG_BLOCK_FREE
@@ -99,6 +114,209 @@ static inline void flush_block_map(struct block_map *map)
 	dcache_writeback_invalidate_region(map, sizeof(*map));
 }
 
+/* update heap usage high watermark */
+static inline void heap_update_peak(struct mm_heap *heap)
+{
+	if (heap->info.used > heap->info.peak)
+		heap->info.peak = heap->info.used;
+}
+
+#ifdef CONFIG_HEAP_HISTOGRAM
+/* request size histogram of a core, only written by the core itself */
+struct heap_hist_core {
+	struct sof_ipc_debug_heap_hist_bin
+		bins[SOF_IPC_DEBUG_HEAP_BUFFER + 1][SOF_IPC_DEBUG_HEAP_HIST_BINS];
+} __attribute__ ((__aligned__(PLATFORM_DCACHE_ALIGN)));
+
+static struct heap_hist_core heap_hist_cores[PLATFORM_CORE_COUNT];
+
+static inline void block_map_update_peak(struct block_map *map)
+{
+	uint16_t used = map->count - map->free_count;
+
+	if (used > map->peak_used)
+		map->peak_used = used;
+}
+
+/* count request in the size bin of its zone */
+static void heap_hist_record(int zone, size_t bytes, void *ptr)
+{
+	struct sof_ipc_debug_heap_hist_bin *bin;
+	int hzone;
+	int i = 0;
+
+	switch (zone & RZONE_TYPE_MASK) {
+	case RZONE_SYS:
+		hzone = SOF_IPC_DEBUG_HEAP_SYS;
+		break;
+	case RZONE_SYS_RUNTIME:
+		hzone = SOF_IPC_DEBUG_HEAP_SYS_RUNTIME;
+		break;
+	case RZONE_RUNTIME:
+		hzone = SOF_IPC_DEBUG_HEAP_RUNTIME;
+		break;
+	case RZONE_BUFFER:
+		hzone = SOF_IPC_DEBUG_HEAP_BUFFER;
+		break;
+	default:
+		return;
+	}
+
+	while (i < SOF_IPC_DEBUG_HEAP_HIST_BINS - 1 && bytes > (16 << i))
+		i++;
+
+	bin = &heap_hist_cores[cpu_get_id()].bins[hzone][i];
+	bin->allocs++;
+	if (!ptr)
+		bin->fails++;
+
+	/* heap_hist() may be called on another core */
+	dcache_writeback_region(bin, sizeof(*bin));
+}
+#else
+static inline void block_map_update_peak(struct block_map *map) { }
+static inline void heap_hist_record(int zone, size_t bytes, void *ptr) { }
+#endif
+
+#ifdef CONFIG_SRAM_BANK_GATING
+#define SRAM_BANK(addr)	(((addr) - HP_SRAM_BASE) / SRAM_BANK_SIZE)
+
+/* allocations per HP SRAM bank, banks that aren't wholly inside a shared
+ * buffer heap keep one extra user so they are never gated
+ */
+static uint16_t sram_bank_users[PLATFORM_HPSRAM_EBB_COUNT];
+
+/* only shared buffer heaps are gated, they are used under memmap.lock */
+static inline int heap_is_gated(struct mm_heap *heap)
+{
+	return heap >= memmap.buffer &&
+		heap < memmap.buffer + PLATFORM_HEAP_BUFFER;
+}
+
+/* banks are counted here and switched before pm_runtime_init(), so the
+ * platform is called directly
+ */
+static void sram_bank_get(uint32_t bank)
+{
+	if (!sram_bank_users[bank]++)
+		platform_pm_runtime_get(HPSRAM_BANK, bank, 0);
+}
+
+static void sram_bank_put(uint32_t bank)
+{
+	if (!--sram_bank_users[bank])
+		platform_pm_runtime_put(HPSRAM_BANK, bank, 0);
+}
+
+/* power up gated banks under a new allocation */
+static void heap_banks_get(struct mm_heap *heap, void *ptr, uint32_t size)
+{
+	uint32_t bank;
+
+	if (!heap_is_gated(heap))
+		return;
+
+	for (bank = SRAM_BANK((uint32_t)ptr);
+	     bank <= SRAM_BANK((uint32_t)ptr + size - 1); bank++)
+		sram_bank_get(bank);
+}
+
+/* gate banks left without allocation */
+static void heap_banks_put(struct mm_heap *heap, void *ptr, uint32_t size)
+{
+	uint32_t bank;
+
+	if (!heap_is_gated(heap))
+		return;
+
+	for (bank = SRAM_BANK((uint32_t)ptr);
+	     bank <= SRAM_BANK((uint32_t)ptr + size - 1); bank++)
+		sram_bank_put(bank);
+}
+
+/* count bank users from the block headers of the shared buffer heaps */
+static void sram_banks_count(uint16_t *users)
+{
+	struct mm_heap *heap;
+	struct block_map *map;
+	struct block_hdr *hdr;
+	uint32_t bank;
+	uint32_t end;
+	int i;
+	int j;
+	int k;
+
+	for (i = 0; i < PLATFORM_HPSRAM_EBB_COUNT; i++)
+		users[i] = 1;
+
+	for (i = 0; i < PLATFORM_HEAP_BUFFER; i++) {
+		heap = &memmap.buffer[i];
+
+		/* LP SRAM heaps aren't gated */
+		if (heap->heap < HP_SRAM_BASE ||
+		    heap->heap + heap->size > HP_SRAM_BASE + HP_SRAM_SIZE)
+			continue;
+
+		bank = SRAM_BANK(heap->heap + SRAM_BANK_SIZE - 1);
+		end = SRAM_BANK(heap->heap + heap->size);
+		for (; bank < end; bank++)
+			users[bank] = 0;
+
+		for (j = 0; j < heap->blocks; j++) {
+			map = &heap->map[j];
+
+			for (k = 0; k < map->count; k++) {
+				hdr = &map->block[k];
+				if (!hdr->used || !hdr->size)
+					continue;
+
+				bank = SRAM_BANK(map->base +
+						 k * map->block_size);
+				end = SRAM_BANK(map->base + (k + hdr->size) *
+						map->block_size - 1);
+				for (; bank <= end; bank++)
+					users[bank]++;
+			}
+		}
+	}
+}
+
+/* recount bank users and switch banks that gained or lost all of them */
+static void sram_banks_update(void)
+{
+	uint16_t users[PLATFORM_HPSRAM_EBB_COUNT];
+	int i;
+
+	sram_banks_count(users);
+
+	for (i = 0; i < PLATFORM_HPSRAM_EBB_COUNT; i++) {
+		if (users[i] && !sram_bank_users[i])
+			platform_pm_runtime_get(HPSRAM_BANK, i, 0);
+		else if (!users[i] && sram_bank_users[i])
+			platform_pm_runtime_put(HPSRAM_BANK, i, 0);
+
+		sram_bank_users[i] = users[i];
+	}
+}
+
+/* the boot loader powers up all banks, gate the unused ones */
+static void init_sram_banks(void)
+{
+	int i;
+
+	for (i = 0; i < PLATFORM_HPSRAM_EBB_COUNT; i++)
+		sram_bank_users[i] = 1;
+
+	sram_banks_update();
+}
+#else
+static inline void heap_banks_get(struct mm_heap *heap, void *ptr,
+				  uint32_t size) { }
+static inline void heap_banks_put(struct mm_heap *heap, void *ptr,
+				  uint32_t size) { }
+static inline void sram_banks_update(void) { }
+#endif
+
 /* total size of block */
 static inline uint32_t block_get_size(struct block_map *map)
 {
@@ -140,6 +358,104 @@ static void write_pattern(struct mm_heap *heap_map, int heap_depth,
 }
 #endif
 
+#ifdef CONFIG_ALLOC_FREE_LIST
+
+/* heaps that can be freed to, in lookup index order */
+#define HEAP_LOOKUP_COUNT	(PLATFORM_HEAP_SYSTEM_RUNTIME + \
+				PLATFORM_HEAP_RUNTIME + PLATFORM_HEAP_BUFFER)
+
+#define HEAP_LOOKUP_SLOT(addr) \
+	(((addr) >> HEAP_LOOKUP_SHIFT) & (HEAP_LOOKUP_ENTRIES - 1))
+
+static struct mm_heap *heap_from_lookup_idx(int idx)
+{
+	if (idx < PLATFORM_HEAP_SYSTEM_RUNTIME)
+		return &memmap.system_runtime[idx];
+
+	idx -= PLATFORM_HEAP_SYSTEM_RUNTIME;
+	if (idx < PLATFORM_HEAP_RUNTIME)
+		return &memmap.runtime[idx];
+
+	return &memmap.buffer[idx - PLATFORM_HEAP_RUNTIME];
+}
+
+/* add block to head of map free list */
+static inline void block_free_list_push(struct block_map *map,
+					unsigned int block)
+{
+	struct block_hdr *hdr = &map->block[block];
+
+	hdr->prev_free = BLOCK_FREE_END;
+	hdr->next_free = map->free_head;
+
+	if (map->free_head != BLOCK_FREE_END)
+		map->block[map->free_head].prev_free = block;
+
+	map->free_head = block;
+}
+
+/* unlink block from map free list */
+static inline void block_free_list_remove(struct block_map *map,
+					  unsigned int block)
+{
+	struct block_hdr *hdr = &map->block[block];
+
+	if (hdr->prev_free != BLOCK_FREE_END)
+		map->block[hdr->prev_free].next_free = hdr->next_free;
+	else
+		map->free_head = hdr->next_free;
+
+	if (hdr->next_free != BLOCK_FREE_END)
+		map->block[hdr->next_free].prev_free = hdr->prev_free;
+}
+
+/* all blocks are free at init, keep lowest block at list head */
+static void block_free_list_init(struct block_map *map)
+{
+	int i;
+
+	map->free_head = BLOCK_FREE_END;
+
+	for (i = map->count - 1; i >= 0; i--)
+		block_free_list_push(map, i);
+}
+
+/* map every address slot covered by a heap to that heap, slots shared
+ * by more than one heap fall back to searching in get_heap_from_ptr()
+ */
+static void init_heap_lookup(void)
+{
+	struct mm_heap *heap;
+	uint32_t addr;
+	uint8_t *entry;
+	int slots;
+	int i;
+
+	for (i = 0; i < HEAP_LOOKUP_COUNT; i++) {
+		heap = heap_from_lookup_idx(i);
+		if (!heap->size)
+			continue;
+
+		addr = heap->heap & ~((1 << HEAP_LOOKUP_SHIFT) - 1);
+
+		for (slots = 0; slots < HEAP_LOOKUP_ENTRIES &&
+		     addr < heap->heap + heap->size; slots++) {
+			entry = &memmap.heap_lookup[HEAP_LOOKUP_SLOT(addr)];
+
+			if (*entry == HEAP_LOOKUP_NONE)
+				*entry = i + 1;
+			else if (*entry != i + 1)
+				*entry = HEAP_LOOKUP_MULTI;
+
+			addr += 1 << HEAP_LOOKUP_SHIFT;
+		}
+	}
+
+	dcache_writeback_region(memmap.heap_lookup,
+				sizeof(memmap.heap_lookup));
+}
+#endif
+
 static void init_heap_map(struct mm_heap *heap, int count)
 {
 	struct block_map *next_map;
@@ -151,6 +467,9 @@ static void init_heap_map(struct mm_heap *heap, int count)
 		/* init the map[0] */
 		current_map = &heap[i].map[0];
 		current_map->base = heap[i].heap;
+#ifdef CONFIG_ALLOC_FREE_LIST
+		block_free_list_init(current_map);
+#endif
 		flush_block_map(current_map);
 
 		/* map[j]'s base is calculated based on map[j-1] */
@@ -160,6 +479,9 @@ static void init_heap_map(struct mm_heap *heap, int count)
 				current_map->block_size *
 				current_map->count;
 			current_map = &heap[i].map[j];
+#ifdef CONFIG_ALLOC_FREE_LIST
+			block_free_list_init(current_map);
+#endif
 			flush_block_map(current_map);
 		}
 
@@ -196,6 +518,7 @@ static void *rmalloc_sys(int zone, int core, size_t bytes)
 
 	cpu_heap->info.used += bytes;
 	cpu_heap->info.free -= alignment + bytes;
+	heap_update_peak(cpu_heap);
 
 	/* other core should have the latest value */
 	if (core != cpu_get_id())
@@ -213,17 +536,42 @@ static void *alloc_block(struct mm_heap *heap, int level,
 	uint32_t caps)
 {
 	struct block_map *map = &heap->map[level];
-	struct block_hdr *hdr = &map->block[map->first_free];
+	struct block_hdr *hdr;
+	unsigned int block;
 	void *ptr;
+#ifndef CONFIG_ALLOC_FREE_LIST
 	int i;
+#endif
+
+#if defined(CONFIG_ALLOC_FREE_LIST) && !defined(CONFIG_SRAM_BANK_GATING)
+	block = map->free_head;
+#else
+	/* lowest free block keeps the upper banks empty for gating, first_free
+	 * is exact without free lists and a lower bound with them
+	 */
+	for (block = map->first_free; map->block[block].used; block++)
+		;
+#endif
+	hdr = &map->block[block];
 
 	map->free_count--;
-	ptr = (void *)(map->base + map->first_free * map->block_size);
+	map->pm_dirty = 1;
+	ptr = (void *)(map->base + block * map->block_size);
 	hdr->size = 1;
 	hdr->used = 1;
 	heap->info.used += map->block_size;
 	heap->info.free -= map->block_size;
-
+	heap_update_peak(heap);
+	block_map_update_peak(map);
+	heap_banks_get(heap, ptr, map->block_size);
+
+#ifdef CONFIG_ALLOC_FREE_LIST
+	/* first_free is kept only as a lower bound for alloc_cont_blocks() */
+	block_free_list_remove(map, block);
+#ifdef CONFIG_SRAM_BANK_GATING
+	map->first_free = block + 1;
+#endif
+#else
 	/* find next free */
 	for (i = map->first_free; i < map->count; ++i) {
 
@@ -234,6 +582,7 @@ static void *alloc_block(struct mm_heap *heap, int level,
 			break;
 		}
 	}
+#endif
 
 	return ptr;
 }
@@ -281,16 +630,23 @@ static void *alloc_cont_blocks(struct mm_heap *heap, int level,
 found:
 	/* found some free blocks */
 	map->free_count -= count;
+	map->pm_dirty = 1;
 	ptr = (void *)(map->base + start * map->block_size);
 	hdr = &map->block[start];
 	hdr->size = count;
 	heap->info.used += count * map->block_size;
 	heap->info.free -= count * map->block_size;
+	heap_update_peak(heap);
+	block_map_update_peak(map);
+	heap_banks_get(heap, ptr, count * map->block_size);
 
 	/* allocate each block */
 	for (current = start; current < end; current++) {
 		hdr = &map->block[current];
 		hdr->used = 1;
+#ifdef CONFIG_ALLOC_FREE_LIST
+		block_free_list_remove(map, current);
+#endif
 	}
 
 	/* do we need to find a new first free block ? */
@@ -316,6 +672,23 @@ static struct mm_heap *get_heap_from_ptr(void *ptr)
 	struct mm_heap *heap;
 	int i;
 
+#ifdef CONFIG_ALLOC_FREE_LIST
+	uint8_t idx = memmap.heap_lookup[HEAP_LOOKUP_SLOT((uint32_t)ptr)];
+
+	/* slot owned by a single heap, no need to search */
+	if (idx != HEAP_LOOKUP_MULTI) {
+		if (idx == HEAP_LOOKUP_NONE)
+			return NULL;
+
+		heap = heap_from_lookup_idx(idx - 1);
+		if ((uint32_t)ptr >= heap->heap &&
+		    (uint32_t)ptr < heap->heap + heap->size)
+			return heap;
+
+		return NULL;
+	}
+#endif
+
 	/* find mm_heap that ptr belongs to */
 	heap = memmap.system_runtime + cpu_get_id();
 	if ((uint32_t)ptr >= heap->heap &&
@@ -387,24 +760,15 @@ static void *get_ptr_from_heap(struct mm_heap *heap, int zone, uint32_t caps,
 	return ptr;
 }
 
-/* free block(s) */
-static void free_block(void *ptr)
+/* free block(s) of heap */
+static void free_heap_block(struct mm_heap *heap, void *ptr)
 {
-	struct mm_heap *heap;
 	struct block_map *block_map;
 	struct block_hdr *hdr;
 	int i;
 	int block;
 	int used_blocks;
 
-	heap = get_heap_from_ptr(ptr);
-	if (!heap) {
-		trace_error(TRACE_CLASS_MEM, "free_block() error: invalid "
-			    "heap = %p, cpu = %d",
-			    (uintptr_t)ptr, cpu_get_id());
-		return;
-	}
-
 	/* find block that ptr belongs to */
 	for (i = 0; i < heap->blocks; i++) {
 		block_map = &heap->map[i];
@@ -431,11 +795,15 @@ found:
 
 	/* free block header and continuous blocks */
 	used_blocks = block + hdr->size;
+	block_map->pm_dirty = 1;
 
 	for (i = block; i < used_blocks; i++) {
 		hdr = &block_map->block[i];
 		hdr->size = 0;
 		hdr->used = 0;
+#ifdef CONFIG_ALLOC_FREE_LIST
+		block_free_list_push(block_map, i);
+#endif
 		block_map->free_count++;
 		heap->info.used -= block_map->block_size;
 		heap->info.free += block_map->block_size;
@@ -455,8 +823,145 @@ found:
 		DEBUG_BLOCK_FREE_VALUE, block_map->block_size *
 		(i - block));
 #endif
+
+	heap_banks_put(heap, ptr, block_map->block_size * (i - block));
+}
+
+/* free block(s) */
+static void free_block(void *ptr)
+{
+	struct mm_heap *heap;
+
+	heap = get_heap_from_ptr(ptr);
+	if (!heap) {
+		trace_error(TRACE_CLASS_MEM, "free_block() error: invalid "
+			    "heap = %p, cpu = %d",
+			    (uintptr_t)ptr, cpu_get_id());
+		return;
+	}
+
+	free_heap_block(heap, ptr);
+}
+
+#ifdef PLATFORM_HEAP_CORE
+
+/* per core partition ptr belongs to, NULL if it's in a shared heap */
+static struct mm_core_heap *get_core_heap_from_ptr(void *ptr)
+{
+	uint32_t addr = (uint32_t)ptr;
+
+	if (addr < HEAP_CORE_BASE || addr >= HEAP_CORE_BASE + HEAP_CORE_T_SIZE)
+		return NULL;
+
+	return &memmap.core[(addr - HEAP_CORE_BASE) / HEAP_CORE_SIZE];
+}
+
+static void free_core_block(struct mm_core_heap *core_heap, void *ptr)
+{
+	if ((uint32_t)ptr < core_heap->buffer.heap)
+		free_heap_block(&core_heap->runtime, ptr);
+	else
+		free_heap_block(&core_heap->buffer, ptr);
+}
+
+/* return blocks queued by other cores, called by the owner with irqs off */
+static void core_heap_drain(struct mm_core_heap *core_heap)
+{
+	volatile uint32_t *head = cache_to_uncache(&core_heap->remote_free);
+	uint32_t ptr;
+	uint32_t next;
+
+	/* common case, nothing queued and no need for the lock */
+	if (!*head)
+		return;
+
+	spin_lock(&core_heap->lock);
+	ptr = *head;
+	*head = 0;
+	spin_unlock(&core_heap->lock);
+
+	while (ptr) {
+		/* link was written back by the freeing core */
+		dcache_invalidate_region((void *)ptr, sizeof(next));
+		next = *(uint32_t *)ptr;
+		free_core_block(core_heap, (void *)ptr);
+		ptr = next;
+	}
+}
+
+/* queue block on its owner, the link lives in the freed block itself */
+static void core_heap_remote_free(struct mm_core_heap *core_heap, void *ptr)
+{
+	volatile uint32_t *head = cache_to_uncache(&core_heap->remote_free);
+	uint32_t flags;
+
+	spin_lock_irq(&core_heap->lock, flags);
+	*(uint32_t *)ptr = *head;
+	dcache_writeback_invalidate_region(ptr, sizeof(uint32_t));
+	*head = (uint32_t)ptr;
+	spin_unlock_irq(&core_heap->lock, flags);
+}
+
+/* allocate from this core's runtime partition */
+static void *rmalloc_core(int zone, uint32_t caps, size_t bytes)
+{
+	struct mm_core_heap *core_heap = memmap.core + cpu_get_id();
+	uint32_t flags;
+	void *ptr;
+
+	if ((core_heap->runtime.caps & caps) != caps)
+		return NULL;
+
+	/* only the owner touches the maps, just keep local irqs out */
+	flags = interrupt_global_disable();
+	core_heap_drain(core_heap);
+	ptr = get_ptr_from_heap(&core_heap->runtime, zone, caps, bytes);
+	interrupt_global_enable(flags);
+
+	return ptr;
+}
+
+static void *balloc_heap(struct mm_heap *heap, uint32_t caps, size_t bytes);
+
+/* allocate from this core's buffer partition */
+static void *balloc_core(uint32_t caps, size_t bytes)
+{
+	struct mm_core_heap *core_heap = memmap.core + cpu_get_id();
+	uint32_t flags;
+	void *ptr = NULL;
+
+	if ((core_heap->buffer.caps & caps) != caps)
+		return NULL;
+
+	flags = interrupt_global_disable();
+	core_heap_drain(core_heap);
+
+	/* don't report a failed search when the shared heap can take it */
+	if (core_heap->buffer.info.free >= bytes)
+		ptr = balloc_heap(&core_heap->buffer, caps, bytes);
+
+	interrupt_global_enable(flags);
+
+	return ptr;
 }
 
+static void rfree_core(struct mm_core_heap *core_heap, void *ptr)
+{
+	uint32_t flags;
+
+	if (core_heap != memmap.core + cpu_get_id()) {
+		core_heap_remote_free(core_heap, ptr);
+		return;
+	}
+
+	flags = interrupt_global_disable();
+	core_heap_drain(core_heap);
+	free_core_block(core_heap, ptr);
+	interrupt_global_enable(flags);
+}
+
+#endif
+
 #if defined CONFIG_DEBUG_HEAP
 
 static void trace_heap_blocks(struct mm_heap *heap)
@@ -575,6 +1080,14 @@ void *_malloc(int zone, uint32_t caps, size_t bytes)
 	uint32_t flags;
 	void *ptr = NULL;
 
+#ifdef PLATFORM_HEAP_CORE
+	if ((zone & RZONE_TYPE_MASK) == RZONE_RUNTIME) {
+		ptr = rmalloc_core(zone, caps, bytes);
+		if (ptr)
+			goto out;
+	}
+#endif
+
 	spin_lock_irq(&memmap.lock, flags);
 
 	switch (zone & RZONE_TYPE_MASK) {
@@ -591,10 +1104,15 @@ void *_malloc(int zone, uint32_t caps, size_t bytes)
 		trace_mem_error("rmalloc() error: invalid zone");
 		break;
 	}
+	spin_unlock_irq(&memmap.lock, flags);
+
+#ifdef PLATFORM_HEAP_CORE
+out:
+#endif
+	heap_hist_record(zone, bytes, ptr);
 #if DEBUG_BLOCK_FREE
 	bzero(ptr, bytes);
 #endif
-	spin_unlock_irq(&memmap.lock, flags);
 	memmap.heap_trace_updated = 1;
 	return ptr;
 }
@@ -628,20 +1146,11 @@ void *rzalloc_core_sys(int core, size_t bytes)
 	return ptr;
 }
 
-/* allocates continuous buffers - not for direct use, clients use rballoc() */
-void *_balloc(int zone, uint32_t caps, size_t bytes)
+/* allocates continuous blocks from buffer heap */
+static void *balloc_heap(struct mm_heap *heap, uint32_t caps, size_t bytes)
 {
-	struct mm_heap *heap;
 	struct block_map *map;
 	int i;
-	uint32_t flags;
-	void *ptr = NULL;
-
-	spin_lock_irq(&memmap.lock, flags);
-
-	heap = get_heap_from_caps(memmap.buffer, PLATFORM_HEAP_BUFFER, caps);
-	if (heap == NULL)
-		goto out;
 
 	/* will request fit in single block */
 	for (i = 0; i < heap->blocks; i++) {
@@ -656,16 +1165,14 @@ void *_balloc(int zone, uint32_t caps, size_t bytes)
 			continue;
 
 		/* allocate block */
-		ptr = alloc_block(heap, i, caps);
-		goto out;
+		return alloc_block(heap, i, caps);
 	}
 
 	/* request spans > 1 block */
 
 	/* only 1 choice for block size */
 	if (heap->blocks == 1) {
-		ptr = alloc_cont_blocks(heap, 0, caps, bytes);
-		goto out;
+		return alloc_cont_blocks(heap, 0, caps, bytes);
 	} else {
 
 		/* find best block size for request */
@@ -678,9 +1185,34 @@ void *_balloc(int zone, uint32_t caps, size_t bytes)
 		}
 	}
 
-	ptr = alloc_cont_blocks(heap, heap->blocks - 1, caps, bytes);
+	return alloc_cont_blocks(heap, heap->blocks - 1, caps, bytes);
+}
+
+/* allocates continuous buffers - not for direct use, clients use rballoc() */
+void *_balloc(int zone, uint32_t caps, size_t bytes)
+{
+	struct mm_heap *heap;
+	uint32_t flags;
+	void *ptr = NULL;
+
+#ifdef PLATFORM_HEAP_CORE
+	ptr = balloc_core(caps, bytes);
+	if (ptr)
+		goto out;
+#endif
+
+	spin_lock_irq(&memmap.lock, flags);
+
+	heap = get_heap_from_caps(memmap.buffer, PLATFORM_HEAP_BUFFER, caps);
+	if (heap)
+		ptr = balloc_heap(heap, caps, bytes);
+
+	spin_unlock_irq(&memmap.lock, flags);
 
+#ifdef PLATFORM_HEAP_CORE
 out:
+#endif
+	heap_hist_record(RZONE_BUFFER, bytes, ptr);
 	if (ptr && ((zone & RZONE_FLAG_MASK) == RZONE_FLAG_UNCACHED))
 		ptr = cache_to_uncache(ptr);
 
@@ -688,13 +1220,15 @@ out:
 	bzero(ptr, bytes);
 #endif
 
-	spin_unlock_irq(&memmap.lock, flags);
 	return ptr;
 }
 
 void rfree(void *ptr)
 {
 	struct mm_heap *cpu_heap;
+#ifdef PLATFORM_HEAP_CORE
+	struct mm_core_heap *core_heap;
+#endif
 	uint32_t flags;
 
 	/* sanity check - NULL ptrs are fine */
@@ -717,6 +1251,15 @@ void rfree(void *ptr)
 		panic(SOF_IPC_PANIC_MEM);
 	}
 
+#ifdef PLATFORM_HEAP_CORE
+	core_heap = get_core_heap_from_ptr(ptr);
+	if (core_heap) {
+		rfree_core(core_heap, ptr);
+		memmap.heap_trace_updated = 1;
+		return;
+	}
+#endif
+
 	/* free the block */
 	spin_lock_irq(&memmap.lock, flags);
 	free_block(ptr);
@@ -724,12 +1267,204 @@ void rfree(void *ptr)
 	memmap.heap_trace_updated = 1;
 }
 
-/* TODO: all mm_pm_...() routines to be implemented for IMR storage */
-uint32_t mm_pm_context_size(void)
+/*
+ * PM context is laid out in the host buffer at fixed offsets, one record per
+ * runtime and buffer heap: the mm_heap, then for each block map the
+ * block_map, its block headers and its block data. Fixed offsets let a save
+ * skip anything the host copy already holds. Block maps with no allocation
+ * or free since the last save keep their headers, and free blocks are never
+ * copied. Writes to used blocks aren't tracked so they are always copied.
+ */
+
+/* host context buffer matches the heaps since the last save or restore */
+static uint32_t mm_pm_ctx_valid;
+
+/* DMA timeout per page in microseconds */
+#define MM_PM_COPY_TIMEOUT	1000
+
+static int mm_pm_copy(struct dma_copy *dc, struct dma_sg_config *sg,
+		      uint32_t offset, void *ptr, uint32_t size, int save)
+{
+	int ret;
+
+	if (save)
+		dcache_writeback_region(ptr, size);
+
+	while (size) {
+		wait_clear(&dc->complete);
+		dc->complete.timeout = MM_PM_COPY_TIMEOUT;
+
+		if (save)
+			ret = dma_copy_to_host_nowait(dc, sg, offset, ptr,
+						      size);
+		else
+			ret = dma_copy_from_host_nowait(dc, sg, offset, ptr,
+							size);
+		if (ret <= 0)
+			return ret < 0 ? ret : -EINVAL;
+
+#if !defined CONFIG_DMA_GW
+		if (wait_for_completion_timeout(&dc->complete) < 0)
+			return -ETIME;
+#endif
+
+		if (!save)
+			dcache_invalidate_region(ptr, ret);
+
+		offset += ret;
+		ptr = (uint8_t *)ptr + ret;
+		size -= ret;
+	}
+
+	return 0;
+}
+
+/* copy the used blocks of a map, a run of used blocks at a time */
+static int mm_pm_copy_blocks(struct dma_copy *dc, struct dma_sg_config *sg,
+			     uint32_t offset, struct block_map *map, int save)
+{
+	unsigned int start;
+	unsigned int end;
+	int ret;
+
+	for (start = 0; start < map->count; start = end) {
+		if (!map->block[start].used) {
+			end = start + 1;
+			continue;
+		}
+
+		for (end = start + 1; end < map->count; end++) {
+			if (!map->block[end].used)
+				break;
+		}
+
+		ret = mm_pm_copy(dc, sg, offset + start * map->block_size,
+				 (void *)(map->base + start * map->block_size),
+				 (end - start) * map->block_size, save);
+		if (ret < 0)
+			return ret;
+	}
+
+	return 0;
+}
+
+static int mm_pm_heap_copy(struct dma_copy *dc, struct dma_sg_config *sg,
+			   uint32_t *offset, struct mm_heap *heap, int save)
 {
+	struct block_map *map;
+	uint32_t hdr_size;
+	int ret;
+	int i;
+
+	ret = mm_pm_copy(dc, sg, *offset, heap, sizeof(*heap), save);
+	if (ret < 0)
+		return ret;
+	*offset += sizeof(*heap);
+
+	for (i = 0; i < heap->blocks; i++) {
+		map = &heap->map[i];
+		hdr_size = map->count * sizeof(struct block_hdr);
+
+		/* headers unchanged since the host copy was made */
+		if (save && mm_pm_ctx_valid && !map->pm_dirty) {
+			*offset += sizeof(*map) + hdr_size;
+		} else {
+			/* cleared first so the saved map is clean too */
+			map->pm_dirty = 0;
+
+			ret = mm_pm_copy(dc, sg, *offset, map, sizeof(*map),
+					 save);
+			if (ret < 0)
+				return ret;
+			*offset += sizeof(*map);
+
+			ret = mm_pm_copy(dc, sg, *offset, map->block, hdr_size,
+					 save);
+			if (ret < 0)
+				return ret;
+			*offset += hdr_size;
+		}
+
+		/* restored headers may use banks that are gated now */
+		if (!save)
+			sram_banks_update();
+
+		ret = mm_pm_copy_blocks(dc, sg, *offset, map, save);
+		if (ret < 0)
+			return ret;
+		*offset += map->count * map->block_size;
+	}
+
 	return 0;
 }
 
+static int mm_pm_context_copy(struct dma_copy *dc, struct dma_sg_config *sg,
+			      int save)
+{
+	uint32_t offset = 0;
+	int ret = 0;
+	int i;
+
+	for (i = 0; i < PLATFORM_HEAP_RUNTIME; i++) {
+		ret = mm_pm_heap_copy(dc, sg, &offset, &memmap.runtime[i],
+				      save);
+		if (ret < 0)
+			goto out;
+	}
+
+	for (i = 0; i < PLATFORM_HEAP_BUFFER; i++) {
+		ret = mm_pm_heap_copy(dc, sg, &offset, &memmap.buffer[i],
+				      save);
+		if (ret < 0)
+			goto out;
+	}
+
+#ifdef PLATFORM_HEAP_CORE
+	for (i = 0; i < PLATFORM_HEAP_CORE; i++) {
+		/* owners are down, so queued blocks are returned here */
+		if (save)
+			core_heap_drain(&memmap.core[i]);
+
+		ret = mm_pm_heap_copy(dc, sg, &offset,
+				      &memmap.core[i].runtime, save);
+		if (ret < 0)
+			goto out;
+
+		ret = mm_pm_heap_copy(dc, sg, &offset,
+				      &memmap.core[i].buffer, save);
+		if (ret < 0)
+			goto out;
+	}
+#endif
+
+out:
+	/* a failed copy leaves the host buffer partly stale */
+	mm_pm_ctx_valid = ret < 0 ? 0 : 1;
+	return ret;
+}
+
+/* host buffer size needed for the runtime and buffer heap context */
+uint32_t mm_pm_context_size(void)
+{
+	uint32_t size = 0;
+	int i;
+
+	for (i = 0; i < PLATFORM_HEAP_RUNTIME; i++)
+		size += heap_get_size(&memmap.runtime[i]);
+
+	for (i = 0; i < PLATFORM_HEAP_BUFFER; i++)
+		size += heap_get_size(&memmap.buffer[i]);
+
+#ifdef PLATFORM_HEAP_CORE
+	for (i = 0; i < PLATFORM_HEAP_CORE; i++) {
+		size += heap_get_size(&memmap.core[i].runtime);
+		size += heap_get_size(&memmap.core[i].buffer);
+	}
+#endif
+
+	return size;
+}
+
 /*
  * Save the DSP memories that are in use the system and modules. All pipeline and modules
  * must be disabled before calling this functions. No allocations are permitted after
@@ -737,7 +1472,13 @@ uint32_t mm_pm_context_size(void)
  */
 int mm_pm_context_save(struct dma_copy *dc, struct dma_sg_config *sg)
 {
-	return -ENOTSUP;
+	int ret;
+
+	ret = mm_pm_context_copy(dc, sg, 1);
+	if (ret < 0)
+		trace_mem_error("mm_pm_context_save() error: %d", ret);
+
+	return ret;
 }
 
 /*
@@ -746,7 +1487,13 @@ int mm_pm_context_save(struct dma_copy *dc, struct dma_sg_config *sg)
  */
 int mm_pm_context_restore(struct dma_copy *dc, struct dma_sg_config *sg)
 {
-	return -ENOTSUP;
+	int ret;
+
+	ret = mm_pm_context_copy(dc, sg, 0);
+	if (ret < 0)
+		trace_mem_error("mm_pm_context_restore() error: %d", ret);
+
+	return ret;
 }
 
 void free_heap(int zone)
@@ -805,13 +1552,225 @@ void heap_trace_all(int force)
 		heap_trace(memmap.buffer, PLATFORM_HEAP_BUFFER);
 		trace_mem_init("heap: runtime status");
 		heap_trace(memmap.runtime, PLATFORM_HEAP_RUNTIME);
+#ifdef PLATFORM_HEAP_CORE
+		trace_mem_init("heap: core %d status", cpu_get_id());
+		heap_trace(&memmap.core[cpu_get_id()].runtime, 1);
+		heap_trace(&memmap.core[cpu_get_id()].buffer, 1);
+#endif
 	}
 	memmap.heap_trace_updated = 0;
 }
 
+/* longest run of free blocks in map */
+static uint32_t block_map_largest_free(struct block_map *map)
+{
+	uint32_t largest = 0;
+	uint32_t run = 0;
+	int i;
+
+	/* no free blocks below first_free */
+	for (i = map->first_free; i < map->count; i++) {
+		if (map->block[i].used) {
+			run = 0;
+			continue;
+		}
+
+		if (++run > largest)
+			largest = run;
+	}
+
+	return largest;
+}
+
+static struct mm_heap *heap_get_zone(uint32_t zone, int *count)
+{
+	switch (zone) {
+	case SOF_IPC_DEBUG_HEAP_SYS:
+		*count = PLATFORM_HEAP_SYSTEM;
+		return memmap.system;
+	case SOF_IPC_DEBUG_HEAP_SYS_RUNTIME:
+		*count = PLATFORM_HEAP_SYSTEM_RUNTIME;
+		return memmap.system_runtime;
+	case SOF_IPC_DEBUG_HEAP_RUNTIME:
+		*count = PLATFORM_HEAP_RUNTIME;
+		return memmap.runtime;
+	case SOF_IPC_DEBUG_HEAP_BUFFER:
+		*count = PLATFORM_HEAP_BUFFER;
+		return memmap.buffer;
+	default:
+		return NULL;
+	}
+}
+
+int heap_info(uint32_t zone, struct sof_ipc_debug_heap *info)
+{
+	struct sof_ipc_debug_heap_map *elem;
+	struct block_map *map;
+	struct mm_heap *heap;
+	uint32_t flags;
+	int count;
+	int i;
+	int j;
+
+	heap = heap_get_zone(zone, &count);
+	if (!heap) {
+		trace_mem_error("heap_info() error: invalid zone %u", zone);
+		return -EINVAL;
+	}
+
+	info->zone = zone;
+	info->num_heaps = count;
+	info->size = 0;
+	info->used = 0;
+	info->free = 0;
+	info->peak = 0;
+	info->num_elems = 0;
+
+	spin_lock_irq(&memmap.lock, flags);
+
+	for (i = 0; i < count; i++, heap++) {
+		/* per core heaps are updated by their own core */
+		if ((zone == SOF_IPC_DEBUG_HEAP_SYS ||
+		     zone == SOF_IPC_DEBUG_HEAP_SYS_RUNTIME) &&
+		    i != cpu_get_id())
+			dcache_invalidate_region(heap, sizeof(*heap));
+
+		info->size += heap->size;
+		info->used += heap->info.used;
+		info->free += heap->info.free;
+		info->peak += heap->info.peak;
+
+		for (j = 0; j < heap->blocks; j++) {
+			if (info->num_elems == SOF_IPC_DEBUG_HEAP_MAX_ELEMS)
+				break;
+
+			map = &heap->map[j];
+			if (zone == SOF_IPC_DEBUG_HEAP_SYS_RUNTIME &&
+			    i != cpu_get_id()) {
+				dcache_invalidate_region(map, sizeof(*map));
+				dcache_invalidate_region(map->block,
+							 sizeof(*map->block) *
+							 map->count);
+			}
+
+			elem = &info->elems[info->num_elems++];
+			elem->heap = i;
+			elem->caps = heap->caps;
+			elem->block_size = map->block_size;
+			elem->count = map->count;
+			elem->free_count = map->free_count;
+			elem->largest_free = block_map_largest_free(map);
+		}
+	}
+
+	spin_unlock_irq(&memmap.lock, flags);
+
+	return sizeof(*info) + info->num_elems * sizeof(*elem);
+}
+
+#ifdef CONFIG_MEM_BENCH
+int heap_alloc_at(uint32_t zone, int index, size_t bytes, uint32_t *caps,
+		  void **ptr)
+{
+	struct mm_heap *heap;
+	uint32_t flags;
+	int count;
+
+	/* system heaps are never freed, core heaps aren't in the memmap */
+	if (zone != SOF_IPC_DEBUG_HEAP_RUNTIME &&
+	    zone != SOF_IPC_DEBUG_HEAP_BUFFER)
+		return -EINVAL;
+
+	heap = heap_get_zone(zone, &count);
+	if (index >= count)
+		return -ENOENT;
+
+	heap += index;
+	*caps = heap->caps;
+
+	spin_lock_irq(&memmap.lock, flags);
+	*ptr = balloc_heap(heap, heap->caps, bytes);
+	spin_unlock_irq(&memmap.lock, flags);
+
+	return *ptr ? 0 : -ENOMEM;
+}
+#endif
+
+#ifdef CONFIG_HEAP_HISTOGRAM
+int heap_hist(uint32_t zone, struct sof_ipc_debug_heap_hist *hist)
+{
+	struct sof_ipc_debug_heap_hist_map *elem;
+	struct sof_ipc_debug_heap_hist_bin *bin;
+	struct block_map *map;
+	struct mm_heap *heap;
+	uint32_t flags;
+	int count;
+	int core;
+	int i;
+	int j;
+
+	heap = heap_get_zone(zone, &count);
+	if (!heap) {
+		trace_mem_error("heap_hist() error: invalid zone %u", zone);
+		return -EINVAL;
+	}
+
+	hist->zone = zone;
+	hist->num_maps = 0;
+	bzero(hist->bins, sizeof(hist->bins));
+
+	/* sum the request bins of all cores */
+	for (core = 0; core < PLATFORM_CORE_COUNT; core++) {
+		bin = heap_hist_cores[core].bins[zone];
+		if (core != cpu_get_id())
+			dcache_invalidate_region(bin, sizeof(*bin) *
+						 SOF_IPC_DEBUG_HEAP_HIST_BINS);
+
+		for (i = 0; i < SOF_IPC_DEBUG_HEAP_HIST_BINS; i++) {
+			hist->bins[i].allocs += bin[i].allocs;
+			hist->bins[i].fails += bin[i].fails;
+		}
+	}
+
+	spin_lock_irq(&memmap.lock, flags);
+
+	for (i = 0; i < count; i++, heap++) {
+		/* per core heaps are updated by their own core */
+		if ((zone == SOF_IPC_DEBUG_HEAP_SYS ||
+		     zone == SOF_IPC_DEBUG_HEAP_SYS_RUNTIME) &&
+		    i != cpu_get_id())
+			dcache_invalidate_region(heap, sizeof(*heap));
+
+		for (j = 0; j < heap->blocks; j++) {
+			if (hist->num_maps == SOF_IPC_DEBUG_HEAP_HIST_MAX_MAPS)
+				break;
+
+			map = &heap->map[j];
+			if (zone == SOF_IPC_DEBUG_HEAP_SYS_RUNTIME &&
+			    i != cpu_get_id())
+				dcache_invalidate_region(map, sizeof(*map));
+
+			elem = &hist->maps[hist->num_maps++];
+			elem->heap = i;
+			elem->block_size = map->block_size;
+			elem->count = map->count;
+			elem->peak_used = map->peak_used;
+		}
+	}
+
+	spin_unlock_irq(&memmap.lock, flags);
+
+	return sizeof(*hist) + hist->num_maps * sizeof(*elem);
+}
+#endif
+
 /* initialise map */
 void init_heap(struct sof *sof)
 {
+#ifdef PLATFORM_HEAP_CORE
+	int i;
+#endif
+
 	/* sanity check for malformed images or loader issues */
 	if (memmap.system[0].heap != HEAP_SYSTEM_0_BASE)
 		panic(SOF_IPC_PANIC_MEM);
@@ -824,6 +1783,24 @@ void init_heap(struct sof *sof)
 
 	init_heap_map(memmap.buffer, PLATFORM_HEAP_BUFFER);
 
+#ifdef PLATFORM_HEAP_CORE
+	for (i = 0; i < PLATFORM_HEAP_CORE; i++) {
+		spinlock_init(&memmap.core[i].lock);
+		init_heap_map(&memmap.core[i].runtime, 1);
+		init_heap_map(&memmap.core[i].buffer, 1);
+		dcache_writeback_invalidate_region(&memmap.core[i],
+						   sizeof(memmap.core[i]));
+	}
+#endif
+
+#ifdef CONFIG_ALLOC_FREE_LIST
+	init_heap_lookup();
+#endif
+
+#ifdef CONFIG_SRAM_BANK_GATING
+	init_sram_banks();
+#endif
+
 #if DEBUG_BLOCK_FREE
 	write_pattern((struct mm_heap *)&memmap.buffer, PLATFORM_HEAP_BUFFER,
 				  DEBUG_BLOCK_FREE_VALUE);
@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Liam Girdwood <liam.r.girdwood@linux.intel.com>
+ */
+
+/*
+ * Boot profile. Each boot trace point on the master core records the
+ * platform wall clock, and the whole record is written to the mailbox
+ * debug region just before FW_READY for the host to read back.
+ */
+
+#include <sof/trace.h>
+#include <sof/mailbox.h>
+#include <sof/cpu.h>
+#include <sof/string.h>
+#include <sof/math/numbers.h>
+#include <arch/cache.h>
+#include <platform/timer.h>
+#include <sof/drivers/timer.h>
+#include <platform/platform.h>
+#include <stdint.h>
+
+#ifdef CONFIG_BOOT_PROFILE
+
+#define BOOT_PROFILE_POINTS \
+	((MAILBOX_DEBUG_SIZE - sizeof(struct sof_boot_profile)) / \
+	 sizeof(struct sof_boot_profile_point))
+
+struct boot_profile {
+	struct sof_boot_profile hdr;
+	struct sof_boot_profile_point points[BOOT_PROFILE_POINTS];
+	uint32_t complete;
+};
+
+static struct boot_profile boot_profile;
+
+void boot_profile_point(uint32_t point)
+{
+	struct boot_profile *bp = &boot_profile;
+
+	if (bp->complete || cpu_get_id() != PLATFORM_MASTER_CORE_ID)
+		return;
+
+	if (bp->hdr.count == BOOT_PROFILE_POINTS) {
+		bp->hdr.dropped++;
+		return;
+	}
+
+	bp->points[bp->hdr.count].point = point;
+	bp->points[bp->hdr.count].timestamp =
+		platform_timer_get(platform_timer);
+	bp->hdr.count++;
+}
+
+void boot_profile_complete(void)
+{
+	struct boot_profile *bp = &boot_profile;
+	void *base = (void *)mailbox_get_debug_base();
+	size_t size = sizeof(bp->hdr) +
+		bp->hdr.count * sizeof(struct sof_boot_profile_point);
+
+	bp->hdr.magic = SOF_BOOT_PROFILE_MAGIC;
+	bp->complete = 1;
+
+	rmemcpy(base, bp, size);
+	dcache_writeback_region(base, size);
+}
+
+#endif
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Liam Girdwood <liam.r.girdwood@linux.intel.com>
+ */
+
+/*
+ * Data cache locking. Locked lines can't be evicted, so each core counts the
+ * lines locked in every set of its data cache and keeps at least one way of
+ * each set unlocked for all other data. Counts are only written by their own
+ * core with IRQs off, so no locking is needed.
+ */
+
+#include <sof/cache_lock.h>
+#include <sof/cpu.h>
+#include <sof/interrupt.h>
+#include <arch/cache.h>
+#include <platform/platform.h>
+#include <errno.h>
+#include <stdint.h>
+
+#if defined(CONFIG_CACHE_LOCK) && XCHAL_DCACHE_LINE_LOCKABLE
+
+#define DCACHE_SET(line)	((line) / DCACHE_LINE_SIZE % DCACHE_SETS)
+
+/* locked lines per data cache set */
+static uint8_t dcache_set_locks[PLATFORM_CORE_COUNT][DCACHE_SETS];
+
+/* lines of the region, first inclusive and end exclusive */
+static void dcache_lines(void *addr, size_t size, uintptr_t *first,
+			 uintptr_t *end)
+{
+	*first = (uintptr_t)addr & ~(DCACHE_LINE_SIZE - 1);
+	*end = ((uintptr_t)addr + size + DCACHE_LINE_SIZE - 1) &
+		~(DCACHE_LINE_SIZE - 1);
+}
+
+int cache_lock_data(void *addr, size_t size)
+{
+	uint8_t *locks = dcache_set_locks[cpu_get_id()];
+	uint32_t flags;
+	uintptr_t first;
+	uintptr_t line;
+	uintptr_t end;
+
+	if (!size)
+		return 0;
+
+	dcache_lines(addr, size, &first, &end);
+
+	flags = interrupt_global_disable();
+
+	for (line = first; line < end; line += DCACHE_LINE_SIZE) {
+		if (locks[DCACHE_SET(line)] >= DCACHE_WAYS - 1)
+			goto full;
+		locks[DCACHE_SET(line)]++;
+	}
+
+	dcache_lock_region((void *)first, end - first);
+
+	interrupt_global_enable(flags);
+	return 0;
+
+full:
+	/* roll back the lines counted so far */
+	while (line > first) {
+		line -= DCACHE_LINE_SIZE;
+		locks[DCACHE_SET(line)]--;
+	}
+
+	interrupt_global_enable(flags);
+	return -ENOSPC;
+}
+
+void cache_unlock_data(void *addr, size_t size)
+{
+	uint8_t *locks = dcache_set_locks[cpu_get_id()];
+	uint32_t flags;
+	uintptr_t first;
+	uintptr_t line;
+	uintptr_t end;
+
+	if (!size)
+		return;
+
+	dcache_lines(addr, size, &first, &end);
+
+	flags = interrupt_global_disable();
+
+	dcache_unlock_region((void *)first, end - first);
+
+	for (line = first; line < end; line += DCACHE_LINE_SIZE)
+		if (locks[DCACHE_SET(line)])
+			locks[DCACHE_SET(line)]--;
+
+	interrupt_global_enable(flags);
+}
+
+#endif
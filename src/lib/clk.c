@@ -36,10 +36,16 @@
 #include <sof/alloc.h>
 #include <sof/lock.h>
 #include <sof/notifier.h>
+#include <sof/schedule.h>
+#include <sof/work.h>
+#include <sof/wait.h>
 #include <sof/cpu.h>
+#include <sof/math/numbers.h>
 #include <platform/clk.h>
 #include <platform/clk-map.h>
 #include <platform/platcfg.h>
+#include <platform/platform.h>
+#include <sof/drivers/timer.h>
 #include <config.h>
 #include <stdint.h>
 #include <limits.h>
@@ -62,8 +68,42 @@ struct clk_data {
 	spinlock_t lock;
 };
 
+#ifdef CONFIG_CLOCK_GOVERNOR
+/* governor evaluation window */
+#define CLK_GOV_WINDOW_MS	100
+
+/* load in 1/1000 of the period: step up above HIGH, step down only when
+ * the load predicted at the lower frequency stays below TARGET
+ */
+#define CLK_GOV_LOAD_HIGH	800
+#define CLK_GOV_LOAD_TARGET	600
+
+/* per core load accounting, only written by its own core */
+struct clk_gov {
+	uint64_t win_start;	/* window start in scheduler ticks */
+	uint64_t busy;		/* pipeline run ticks in window */
+	uint32_t peak;		/* worst single run load in window */
+};
+#endif
+
+#ifdef CONFIG_IDLE_MANAGER
+/* predicted idle needed to amortise the two clock switches */
+#define CLK_IDLE_LOW_MIN_US	2000
+
+/* per core idle state, only written by its own core */
+struct clk_idle {
+	uint32_t restore_freq;	/* clock to restore on wake, 0 if not lowered */
+};
+#endif
+
 struct clk_pdata {
 	struct clk_data clk[NUM_CLOCKS];
+#ifdef CONFIG_CLOCK_GOVERNOR
+	struct clk_gov gov[PLATFORM_CORE_COUNT];
+#endif
+#ifdef CONFIG_IDLE_MANAGER
+	struct clk_idle idle[PLATFORM_CORE_COUNT];
+#endif
 };
 
 static struct clk_pdata *clk_pdata;
@@ -147,6 +187,137 @@ out:
 	spin_unlock_irq(&clk_pdata->clk[clock].lock, flags);
 }
 
+#ifdef CONFIG_CLOCK_GOVERNOR
+/* next cpu_freq entry above (up) or below the current frequency, the
+ * tables are not sorted on all platforms so scan the whole table
+ */
+static uint32_t clock_gov_next_freq(uint32_t freq, int up)
+{
+	uint32_t next = freq;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(cpu_freq); i++) {
+		if (up && cpu_freq[i].freq > freq &&
+		    (next == freq || cpu_freq[i].freq < next))
+			next = cpu_freq[i].freq;
+		if (!up && cpu_freq[i].freq < freq &&
+		    (next == freq || cpu_freq[i].freq > next))
+			next = cpu_freq[i].freq;
+	}
+
+	return next;
+}
+
+static void clock_gov_step(int clock, uint32_t freq, uint32_t load)
+{
+	trace_clk("clk: gov core %d load %d freq %d", cpu_get_id(), load,
+		  freq);
+	clock_set_freq(clock, freq);
+}
+
+void clock_gov_account(uint64_t rtime, uint64_t period)
+{
+	struct clk_gov *gov = &clk_pdata->gov[cpu_get_id()];
+	int clock = CLK_CPU(cpu_get_id());
+	uint64_t now = platform_timer_get(platform_timer);
+	uint64_t window;
+	uint32_t freq = clk_pdata->clk[clock].freq;
+	uint32_t next;
+	uint32_t load;
+
+	if (!period)
+		return;
+
+	gov->busy += rtime;
+	load = rtime * 1000 / period;
+	if (load > gov->peak)
+		gov->peak = load;
+
+	/* a single run close to its deadline steps up straight away */
+	if (load > CLK_GOV_LOAD_HIGH) {
+		next = clock_gov_next_freq(freq, 1);
+		if (next != freq)
+			clock_gov_step(clock, next, load);
+		goto reset;
+	}
+
+	window = now - gov->win_start;
+	if (window < clock_ms_to_ticks(PLATFORM_SCHED_CLOCK,
+				       CLK_GOV_WINDOW_MS))
+		return;
+
+	/* summed load of all pipelines on this core over the window */
+	load = gov->busy * 1000 / window;
+	if (load > CLK_GOV_LOAD_HIGH) {
+		next = clock_gov_next_freq(freq, 1);
+		if (next != freq)
+			clock_gov_step(clock, next, load);
+		goto reset;
+	}
+
+	/* both loads scale with the clock, check them at the lower rate */
+	next = clock_gov_next_freq(freq, 0);
+	if (next != freq &&
+	    (uint64_t)MAX(load, gov->peak) * freq / next < CLK_GOV_LOAD_TARGET)
+		clock_gov_step(clock, next, load);
+
+reset:
+	gov->win_start = now;
+	gov->busy = 0;
+	gov->peak = 0;
+}
+#endif
+
+/* cpu_freq[] is not sorted on every platform, so scan it */
+uint32_t clock_cpu_min_freq(void)
+{
+	uint32_t freq = cpu_freq[0].freq;
+	int i;
+
+	for (i = 1; i < ARRAY_SIZE(cpu_freq); i++)
+		freq = MIN(freq, cpu_freq[i].freq);
+
+	return freq;
+}
+
+#ifdef CONFIG_IDLE_MANAGER
+void clock_idle_exit(void)
+{
+	struct clk_idle *idle = &clk_pdata->idle[cpu_get_id()];
+	uint32_t freq = idle->restore_freq;
+
+	if (!freq)
+		return;
+
+	idle->restore_freq = 0;
+	clock_set_freq(CLK_CPU(cpu_get_id()), freq);
+}
+
+void clock_idle_wait(void)
+{
+	struct clk_idle *idle = &clk_pdata->idle[cpu_get_id()];
+	int clock = CLK_CPU(cpu_get_id());
+	uint32_t freq = clk_pdata->clk[clock].freq;
+	uint32_t low = clock_cpu_min_freq();
+	uint64_t predicted;
+
+	/* the wake up comes from the next EDF task or work queue run, any
+	 * other interrupt just ends the idle period early
+	 */
+	predicted = MIN(schedule_next_wakeup_us(), work_next_wakeup_us());
+
+	if (freq != low && predicted > CLK_IDLE_LOW_MIN_US) {
+		idle->restore_freq = freq;
+		clock_set_freq(clock, low);
+	}
+
+	wait_for_interrupt(0);
+
+	/* no-op if the scheduler IRQ has already restored the clock */
+	clock_idle_exit();
+}
+#endif
+
 uint64_t clock_ms_to_ticks(int clock, uint64_t ms)
 {
 	return clk_pdata->clk[clock].ticks_per_msec * ms;
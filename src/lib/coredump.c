@@ -0,0 +1,615 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*
+ * Core dump of the firmware state that a register and stack dump can't
+ * explain, such as leaked heap blocks and stuck buffers. Records are staged
+ * in a small local ring and moved to a host buffer with DMA each time it
+ * fills, so the dump isn't bounded by the mailbox size. The copies are
+ * polled for completion as the dump also runs from panic with IRQs off.
+ */
+
+#include <stdint.h>
+#include <errno.h>
+#include <sof/sof.h>
+#include <sof/alloc.h>
+#include <sof/ipc.h>
+#include <sof/dma.h>
+#include <sof/cpu.h>
+#include <sof/wait.h>
+#include <sof/interrupt.h>
+#include <sof/coredump.h>
+#include <sof/math/numbers.h>
+#include <sof/audio/component.h>
+#include <sof/audio/buffer.h>
+#include <sof/audio/pipeline.h>
+#include <arch/cache.h>
+#include <platform/platform.h>
+#include <platform/timer.h>
+#include <uapi/abi.h>
+
+/* local staging ring, records are moved to the host as it fills */
+#define COREDUMP_LOCAL_SIZE	2048
+
+/* time to wait for each staged copy to reach the host in cycles */
+#define COREDUMP_DMA_TIMEOUT	4000000
+
+struct coredump_data {
+	struct dma_sg_config config;
+	struct dma_copy dc;
+	void *addr;		/* staging ring base address */
+	uint32_t r_off;		/* ring offset of next byte to copy */
+	uint32_t w_off;		/* ring offset of next byte to stage */
+	uint32_t avail;		/* staged bytes not copied yet */
+	uint32_t host_size;
+	uint32_t host_offset;	/* dump bytes copied to host */
+	uint32_t size;		/* dump bytes accepted */
+	uint32_t records;
+	uint32_t dropped;	/* records that didn't fit the host buffer */
+	uint32_t stream_tag;
+	uint32_t enabled;
+	uint32_t busy;		/* a panic during the dump skips the next */
+};
+
+extern struct mm memmap;
+extern struct ipc *_ipc;
+
+static struct coredump_data *coredump_data;
+
+/* padding of record payloads to a 4 byte multiple */
+static const uint32_t coredump_pad;
+
+/* room always kept for the end record */
+#define COREDUMP_END_BYTES \
+	(sizeof(struct sof_coredump_record) + sizeof(struct sof_coredump_end))
+
+#if defined CONFIG_DMA_GW
+
+static int coredump_dma_start(struct coredump_data *d)
+{
+	struct dma_sg_config config;
+	uint32_t elem_size = sizeof(uint64_t) * 2;
+	int err;
+
+	err = dma_copy_set_stream_tag(&d->dc, d->stream_tag);
+	if (err < 0)
+		return err;
+
+	config.direction = DMA_DIR_LMEM_TO_HMEM;
+	config.src_width = sizeof(uint32_t);
+	config.dest_width = sizeof(uint32_t);
+	config.cyclic = 0;
+
+	err = dma_sg_alloc(&config.elem_array, RZONE_SYS, config.direction,
+			   COREDUMP_LOCAL_SIZE / elem_size, elem_size,
+			   (uint32_t)d->addr, 0);
+	if (err < 0)
+		return err;
+
+	err = dma_set_config(d->dc.dmac, d->dc.chan, &config);
+	if (err < 0)
+		return err;
+
+	return dma_start(d->dc.dmac, d->dc.chan);
+}
+
+/* the gateway has moved the copy once its buffer holds no data */
+static int coredump_dma_done(struct coredump_data *d, void *ptr,
+			     uint32_t bytes)
+{
+	uint32_t avail;
+	uint32_t free;
+
+	return !dma_get_data_size(d->dc.dmac, d->dc.chan, &avail, &free) &&
+		!avail;
+}
+
+#else
+
+/* a one shot copy is done once its source address reaches the end */
+static int coredump_dma_done(struct coredump_data *d, void *ptr,
+			     uint32_t bytes)
+{
+	struct dma_chan_status status;
+
+	return !dma_status(d->dc.dmac, d->dc.chan, &status,
+			   DMA_DIR_LMEM_TO_HMEM) &&
+		status.r_pos >= (uint32_t)ptr + bytes;
+}
+
+#endif
+
+/* copy the staged bytes to the host and wait until they are there */
+static int coredump_flush(struct coredump_data *d)
+{
+	uint32_t timeout;
+	int32_t size;
+	void *ptr;
+
+	while (d->avail) {
+		ptr = (char *)d->addr + d->r_off;
+		size = MIN(d->avail, COREDUMP_LOCAL_SIZE - d->r_off);
+
+		dcache_writeback_region(ptr, size);
+
+		size = dma_copy_to_host_nowait(&d->dc, &d->config,
+					       d->host_offset, ptr, size);
+		if (size <= 0)
+			return size < 0 ? size : -EIO;
+
+		timeout = 0;
+		while (!coredump_dma_done(d, ptr, size)) {
+			if (timeout >= COREDUMP_DMA_TIMEOUT)
+				return -ETIME;
+			idelay(PLATFORM_DEFAULT_DELAY);
+			timeout += PLATFORM_DEFAULT_DELAY;
+		}
+
+		d->host_offset += size;
+		d->avail -= size;
+		d->r_off += size;
+		if (d->r_off >= COREDUMP_LOCAL_SIZE)
+			d->r_off -= COREDUMP_LOCAL_SIZE;
+	}
+
+	return 0;
+}
+
+/* stage bytes, flushing the ring to the host whenever it is full */
+static int coredump_write(struct coredump_data *d, const void *src,
+			  uint32_t bytes)
+{
+	uint32_t n;
+	int ret;
+
+	while (bytes) {
+		if (d->avail == COREDUMP_LOCAL_SIZE) {
+			ret = coredump_flush(d);
+			if (ret < 0)
+				return ret;
+		}
+
+		n = MIN(bytes, COREDUMP_LOCAL_SIZE - d->avail);
+		n = MIN(n, COREDUMP_LOCAL_SIZE - d->w_off);
+		memcpy((char *)d->addr + d->w_off, src, n);
+
+		d->w_off += n;
+		if (d->w_off >= COREDUMP_LOCAL_SIZE)
+			d->w_off -= COREDUMP_LOCAL_SIZE;
+		d->avail += n;
+
+		src = (const char *)src + n;
+		bytes -= n;
+	}
+
+	return 0;
+}
+
+/*
+ * Start a record of size payload bytes. Returns 1 when the caller should
+ * write the payload and finish it with coredump_record_end(), 0 when the
+ * record doesn't fit the host buffer and was dropped.
+ */
+static int coredump_record(struct coredump_data *d, uint32_t type,
+			   uint32_t size)
+{
+	struct sof_coredump_record rec;
+	uint32_t total = sizeof(rec) + ((size + 3) & ~3);
+	int ret;
+
+	if (d->size + total + COREDUMP_END_BYTES > d->host_size) {
+		d->dropped++;
+		return 0;
+	}
+
+	rec.magic = SOF_COREDUMP_MAGIC;
+	rec.type = type;
+	rec.size = size;
+
+	ret = coredump_write(d, &rec, sizeof(rec));
+	if (ret < 0)
+		return ret;
+
+	d->size += total;
+	d->records++;
+
+	return 1;
+}
+
+static int coredump_record_end(struct coredump_data *d, uint32_t size)
+{
+	uint32_t pad = ((size + 3) & ~3) - size;
+
+	return pad ? coredump_write(d, &coredump_pad, pad) : 0;
+}
+
+/* write a record with a single payload struct */
+static int coredump_record_data(struct coredump_data *d, uint32_t type,
+				const void *data, uint32_t size)
+{
+	int ret;
+
+	ret = coredump_record(d, type, size);
+	if (ret <= 0)
+		return ret;
+
+	ret = coredump_write(d, data, size);
+	if (ret < 0)
+		return ret;
+
+	return coredump_record_end(d, size);
+}
+
+static int coredump_heap_map(struct coredump_data *d, uint32_t zone,
+			     uint32_t index, struct mm_heap *heap,
+			     struct block_map *map)
+{
+	struct sof_coredump_heap rec;
+	struct block_hdr *hdr;
+	uint32_t size = sizeof(rec) + map->count * sizeof(uint16_t);
+	uint16_t entry;
+	int ret;
+	int i;
+
+	ret = coredump_record(d, SOF_COREDUMP_HEAP, size);
+	if (ret <= 0)
+		return ret;
+
+	rec.zone = zone;
+	rec.heap = index;
+	rec.caps = heap->caps;
+	rec.base = map->base;
+	rec.block_size = map->block_size;
+	rec.count = map->count;
+	rec.free_count = map->free_count;
+	rec.first_free = map->first_free;
+
+	ret = coredump_write(d, &rec, sizeof(rec));
+	if (ret < 0)
+		return ret;
+
+	for (i = 0; i < map->count; i++) {
+		hdr = &map->block[i];
+		entry = hdr->used ? SOF_COREDUMP_BLOCK_USED |
+			(hdr->size & SOF_COREDUMP_BLOCK_SIZE_MASK) : 0;
+
+		ret = coredump_write(d, &entry, sizeof(entry));
+		if (ret < 0)
+			return ret;
+	}
+
+	return coredump_record_end(d, size);
+}
+
+static int coredump_heap_zone(struct coredump_data *d, uint32_t zone,
+			      struct mm_heap *heap, int count)
+{
+	struct block_map *map;
+	int ret;
+	int i;
+	int j;
+
+	for (i = 0; i < count; i++, heap++) {
+		/* per core heaps are updated by their own core */
+		if ((zone == SOF_IPC_DEBUG_HEAP_SYS ||
+		     zone == SOF_IPC_DEBUG_HEAP_SYS_RUNTIME) &&
+		    i != cpu_get_id())
+			dcache_invalidate_region(heap, sizeof(*heap));
+
+		for (j = 0; j < heap->blocks; j++) {
+			map = &heap->map[j];
+			if (zone == SOF_IPC_DEBUG_HEAP_SYS_RUNTIME &&
+			    i != cpu_get_id()) {
+				dcache_invalidate_region(map, sizeof(*map));
+				dcache_invalidate_region(map->block,
+							 sizeof(*map->block) *
+							 map->count);
+			}
+
+			ret = coredump_heap_map(d, zone, i, heap, map);
+			if (ret < 0)
+				return ret;
+		}
+	}
+
+	return 0;
+}
+
+static int coredump_heaps(struct coredump_data *d)
+{
+	int ret;
+#ifdef PLATFORM_HEAP_CORE
+	int i;
+#endif
+
+	ret = coredump_heap_zone(d, SOF_IPC_DEBUG_HEAP_SYS, memmap.system,
+				 PLATFORM_HEAP_SYSTEM);
+	if (ret < 0)
+		return ret;
+
+	ret = coredump_heap_zone(d, SOF_IPC_DEBUG_HEAP_SYS_RUNTIME,
+				 memmap.system_runtime,
+				 PLATFORM_HEAP_SYSTEM_RUNTIME);
+	if (ret < 0)
+		return ret;
+
+	ret = coredump_heap_zone(d, SOF_IPC_DEBUG_HEAP_RUNTIME,
+				 memmap.runtime, PLATFORM_HEAP_RUNTIME);
+	if (ret < 0)
+		return ret;
+
+	ret = coredump_heap_zone(d, SOF_IPC_DEBUG_HEAP_BUFFER,
+				 memmap.buffer, PLATFORM_HEAP_BUFFER);
+	if (ret < 0)
+		return ret;
+
+#ifdef PLATFORM_HEAP_CORE
+	for (i = 0; i < PLATFORM_HEAP_CORE; i++) {
+		ret = coredump_heap_zone(d, SOF_COREDUMP_HEAP_CORE_RUNTIME,
+					 &memmap.core[i].runtime, 1);
+		if (ret < 0)
+			return ret;
+
+		ret = coredump_heap_zone(d, SOF_COREDUMP_HEAP_CORE_BUFFER,
+					 &memmap.core[i].buffer, 1);
+		if (ret < 0)
+			return ret;
+	}
+#endif
+
+	return 0;
+}
+
+static int coredump_pipe(struct coredump_data *d, struct pipeline *p)
+{
+	struct sof_coredump_pipe rec;
+
+	rec.pipeline_id = p->ipc_pipe.pipeline_id;
+	rec.core = p->ipc_pipe.core;
+	rec.status = p->status;
+	rec.sched_id = p->sched_comp ? p->sched_comp->comp.id : ~0;
+	rec.source_id = p->source_comp ? p->source_comp->comp.id : ~0;
+	rec.xrun_bytes = p->xrun_bytes;
+	rec.period = p->ipc_pipe.deadline;
+	rec.priority = p->ipc_pipe.priority;
+
+	return coredump_record_data(d, SOF_COREDUMP_PIPE, &rec, sizeof(rec));
+}
+
+static int coredump_comp(struct coredump_data *d, struct comp_dev *cd)
+{
+	struct sof_coredump_comp rec;
+
+	rec.comp_id = cd->comp.id;
+	rec.type = cd->comp.type;
+	rec.pipeline_id = cd->comp.pipeline_id;
+	rec.state = cd->state;
+	rec.frames = cd->frames;
+	rec.reserved = 0;
+	rec.position = cd->position;
+
+	return coredump_record_data(d, SOF_COREDUMP_COMP, &rec, sizeof(rec));
+}
+
+static int coredump_buffer(struct coredump_data *d, struct comp_buffer *cb)
+{
+	struct sof_coredump_buffer rec;
+
+	rec.buffer_id = cb->ipc_buffer.comp.id;
+	rec.source_id = cb->source ? cb->source->comp.id : ~0;
+	rec.sink_id = cb->sink ? cb->sink->comp.id : ~0;
+	rec.size = cb->size;
+	rec.avail = comp_buffer_get_avail_bytes(cb);
+	rec.free = comp_buffer_get_free_bytes(cb);
+	rec.addr = (uint32_t)cb->addr;
+	rec.r_ptr = (uint32_t)cb->r_ptr;
+	rec.w_ptr = (uint32_t)cb->w_ptr;
+	rec.reserved = 0;
+
+	return coredump_record_data(d, SOF_COREDUMP_BUFFER, &rec, sizeof(rec));
+}
+
+/* pipelines, components and buffers in topology order */
+static int coredump_topology(struct coredump_data *d)
+{
+	struct ipc_comp_dev *icd;
+	struct list_item *clist;
+	int ret = 0;
+
+	if (!_ipc)
+		return 0;
+
+	list_for_item(clist, &_ipc->shared_ctx->comp_list) {
+		icd = container_of(clist, struct ipc_comp_dev, list);
+
+		switch (icd->type) {
+		case COMP_TYPE_PIPELINE:
+			ret = coredump_pipe(d, icd->pipeline);
+			break;
+		case COMP_TYPE_COMPONENT:
+			ret = coredump_comp(d, icd->cd);
+			break;
+		case COMP_TYPE_BUFFER:
+			ret = coredump_buffer(d, icd->cb);
+			break;
+		default:
+			break;
+		}
+
+		if (ret < 0)
+			return ret;
+	}
+
+	return 0;
+}
+
+static int coredump_run(struct coredump_data *d, uint32_t panic)
+{
+	struct sof_coredump_hdr hdr;
+	struct sof_coredump_end end;
+	int ret;
+
+	d->size = 0;
+	d->records = 0;
+	d->dropped = 0;
+	d->host_offset = 0;
+
+	hdr.abi_version = SOF_ABI_VERSION;
+	hdr.core = cpu_get_id();
+	hdr.panic = panic;
+	hdr.reserved = 0;
+	hdr.timestamp = platform_timer_get(platform_timer);
+
+	ret = coredump_record_data(d, SOF_COREDUMP_HDR, &hdr, sizeof(hdr));
+	if (ret < 0)
+		return ret;
+
+	ret = coredump_heaps(d);
+	if (ret < 0)
+		return ret;
+
+	ret = coredump_topology(d);
+	if (ret < 0)
+		return ret;
+
+	/* room for this was kept by every other record */
+	end.records = d->records;
+	end.dropped = d->dropped;
+
+	ret = coredump_record_data(d, SOF_COREDUMP_END, &end, sizeof(end));
+	if (ret < 0)
+		return ret;
+
+	return coredump_flush(d);
+}
+
+int coredump_stream(uint32_t panic, struct sof_ipc_coredump_reply *reply)
+{
+	struct coredump_data *d = coredump_data;
+	uint32_t flags;
+	int ret;
+
+	if (!d || !d->enabled)
+		return -ENODEV;
+
+	/* a fault while dumping must not dump again */
+	if (d->busy)
+		return -EBUSY;
+	d->busy = 1;
+
+	/* nothing may change the state while it is written out */
+	flags = interrupt_global_disable();
+	ret = coredump_run(d, panic);
+	interrupt_global_enable(flags);
+
+	if (reply) {
+		reply->size = d->size;
+		reply->records = d->records;
+		reply->dropped = d->dropped;
+		reply->reserved = 0;
+	}
+
+	d->busy = 0;
+
+	if (ret < 0)
+		trace_coredump_error("coredump_stream() error: ret = %d", ret);
+
+	return ret;
+}
+
+int coredump_init(uint32_t stream_tag, struct dma_sg_elem_array *elem_array,
+		  uint32_t host_size)
+{
+	struct coredump_data *d = coredump_data;
+	int err;
+
+	trace_coredump("coredump_init(), host_size = %u", host_size);
+
+	if (d && d->enabled) {
+		trace_coredump_error("coredump_init() error: already enabled");
+		return -EBUSY;
+	}
+
+	if (host_size < COREDUMP_END_BYTES * 2) {
+		trace_coredump_error("coredump_init() error: host buffer too "
+				     "small");
+		return -EINVAL;
+	}
+
+	/* allocated on first use and kept, a panic may come from any core */
+	if (!d) {
+		d = rzalloc(RZONE_SYS | RZONE_FLAG_UNCACHED, SOF_MEM_CAPS_RAM,
+			    sizeof(*d));
+		if (!d)
+			return -ENOMEM;
+
+		dma_sg_init(&d->config.elem_array);
+		coredump_data = d;
+	}
+
+	d->stream_tag = stream_tag;
+	d->host_size = host_size;
+	if (elem_array)
+		d->config.elem_array = *elem_array;
+
+	err = dma_copy_new(&d->dc);
+	if (err < 0) {
+		trace_coredump_error("coredump_init() error: dma_copy_new() "
+				     "failed");
+		return err;
+	}
+
+	if (!d->addr) {
+		d->addr = rballoc(RZONE_RUNTIME,
+				  SOF_MEM_CAPS_RAM | SOF_MEM_CAPS_DMA,
+				  COREDUMP_LOCAL_SIZE);
+		if (!d->addr) {
+			trace_coredump_error("coredump_init() error: alloc "
+					     "failed");
+			return -ENOMEM;
+		}
+	}
+
+	d->r_off = 0;
+	d->w_off = 0;
+	d->avail = 0;
+
+#if defined CONFIG_DMA_GW
+	err = coredump_dma_start(d);
+	if (err < 0) {
+		trace_coredump_error("coredump_init() error: "
+				     "coredump_dma_start() failed");
+		return err;
+	}
+#endif
+
+	d->enabled = 1;
+
+	return 0;
+}
@@ -29,9 +29,33 @@
  */
 
 #include <sof/dai.h>
+#include <sof/alloc.h>
+#include <sof/cpu.h>
+#include <sof/interrupt.h>
+#include <platform/platform.h>
 
 #define trace_dai(__e, ...) trace_event(TRACE_CLASS_DAI, __e, ##__VA_ARGS__)
 
+/* DAI starts a single trigger can collect */
+#define DAI_GROUP_MAX	8
+
+struct dai_group_entry {
+	struct dai *dai;
+	struct dma *dma;
+	int chan;
+	int cmd;
+	int direction;
+};
+
+/* starts collected by a trigger, only used by its own core */
+struct dai_group {
+	uint32_t depth;		/* nested dai_group_begin() calls */
+	uint32_t count;
+	struct dai_group_entry entry[DAI_GROUP_MAX];
+} __attribute__ ((__aligned__(PLATFORM_DCACHE_ALIGN)));
+
+static struct dai_group dai_group[PLATFORM_CORE_COUNT];
+
 struct dai_info {
 	struct dai_type_info *dai_type_array;
 	size_t num_dai_types;
@@ -59,6 +83,13 @@ static inline struct dai_type_info *dai_find_type(uint32_t type)
 	return NULL;
 }
 
+/* the hardware loses its config when the DAI is removed */
+static void dai_config_free(struct dai *dai)
+{
+	rfree(dai->config);
+	dai->config = NULL;
+}
+
 struct dai *dai_get(uint32_t type, uint32_t index, uint32_t flags)
 {
 	int ret = 0;
@@ -101,6 +132,7 @@ void dai_put(struct dai *dai)
 
 	spin_lock(&dai->lock);
 	if (--dai->sref == 0) {
+		dai_config_free(dai);
 		ret = dai_remove(dai);
 		if (ret < 0) {
 			trace_error(TRACE_CLASS_DAI,
@@ -112,3 +144,140 @@ void dai_put(struct dai *dai)
 		    (uintptr_t)dai, dai->sref);
 	spin_unlock(&dai->lock);
 }
+
+int dai_apply_config(struct dai *dai, struct sof_ipc_dai_config *config)
+{
+	int ret;
+
+	if (dai->config && dai->config->hdr.size == config->hdr.size &&
+	    !memcmp(dai->config, config, config->hdr.size)) {
+		trace_dai("dai_apply_config(), type = %d, index = %d "
+			  "unchanged", dai->type, dai->index);
+		return 0;
+	}
+
+	/* a failed config leaves the hardware state unknown */
+	dai_config_free(dai);
+
+	ret = dai_set_config(dai, config);
+	if (ret < 0)
+		return ret;
+
+	/* without a copy the next config is just applied again */
+	dai->config = rmalloc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM,
+			      config->hdr.size);
+	if (dai->config)
+		memcpy(dai->config, config, config->hdr.size);
+
+	return 0;
+}
+
+void dai_config_invalidate(void)
+{
+	struct dai_type_info *dti;
+	struct dai *d;
+
+	for (dti = lib_dai.dai_type_array;
+	     dti < lib_dai.dai_type_array + lib_dai.num_dai_types; dti++) {
+		for (d = dti->dai_array; d < dti->dai_array + dti->num_dais;
+		     d++)
+			dai_config_free(d);
+	}
+}
+
+void dai_group_begin(void)
+{
+	dai_group[cpu_get_id()].depth++;
+}
+
+int dai_group_start(struct dai *dai, struct dma *dma, int chan, int cmd,
+		    int direction)
+{
+	struct dai_group *group = &dai_group[cpu_get_id()];
+	struct dai_group_entry *entry;
+	int ret;
+
+	/* outside of a group, or full, start straight away */
+	if (!group->depth || group->count == DAI_GROUP_MAX) {
+		ret = dma_start(dma, chan);
+		if (ret < 0)
+			return ret;
+		dai_trigger(dai, cmd, direction);
+		return 0;
+	}
+
+	entry = &group->entry[group->count++];
+	entry->dai = dai;
+	entry->dma = dma;
+	entry->chan = chan;
+	entry->cmd = cmd;
+	entry->direction = direction;
+
+	return 0;
+}
+
+int dai_group_end(void)
+{
+	struct dai_group *group = &dai_group[cpu_get_id()];
+	struct dai_group_entry *entry;
+	uint32_t started = 0;
+	uint32_t failed = 0;
+	uint32_t members;
+	uint32_t chan_mask;
+	uint32_t flags;
+	uint32_t i;
+	uint32_t j;
+	int ret = 0;
+	int err;
+
+	if (--group->depth || !group->count)
+		return 0;
+
+	trace_dai("dai_group_end(), starting %d DAIs", group->count);
+
+	flags = interrupt_global_disable();
+
+	/* one start per DMA controller for all its channels in the group */
+	for (i = 0; i < group->count; i++) {
+		entry = &group->entry[i];
+		if (started & (1 << i))
+			continue;
+
+		chan_mask = 0;
+		members = 0;
+		for (j = i; j < group->count; j++) {
+			if (group->entry[j].dma == entry->dma) {
+				chan_mask |= 1 << group->entry[j].chan;
+				members |= 1 << j;
+			}
+		}
+		started |= members;
+
+		/* like dma_start(), a failed DMA leaves its DAIs stopped */
+		err = dma_start_group(entry->dma, chan_mask);
+		if (err < 0) {
+			failed |= members;
+			if (!ret)
+				ret = err;
+		}
+	}
+
+	/* the DAIs wait for their DMA, so start them last and together */
+	for (i = 0; i < group->count; i++) {
+		if (failed & (1 << i))
+			continue;
+
+		entry = &group->entry[i];
+		dai_trigger(entry->dai, entry->cmd, entry->direction);
+	}
+
+	interrupt_global_enable(flags);
+
+	group->count = 0;
+
+	if (ret < 0)
+		trace_error(TRACE_CLASS_DAI, "dai_group_end() error: "
+			    "ret = %d", ret);
+
+	return ret;
+}
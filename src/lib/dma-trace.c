@@ -39,6 +39,8 @@
 #include <platform/platform.h>
 #include <sof/lock.h>
 #include <sof/cpu.h>
+#include <sof/interrupt.h>
+#include <sof/math/numbers.h>
 #include <stdint.h>
 
 static struct dma_trace_data *trace_data = NULL;
@@ -50,16 +52,22 @@ static int dma_trace_get_avail_data(struct dma_trace_data *d,
 				    struct dma_trace_buf *buffer,
 				    int avail);
 
+static void dtrace_drain_rings(struct dma_trace_data *d);
+
 static uint64_t trace_work(void *data, uint64_t delay)
 {
 	struct dma_trace_data *d = (struct dma_trace_data *)data;
 	struct dma_trace_buf *buffer = &d->dmatb;
 	struct dma_sg_config *config = &d->config;
 	unsigned long flags;
-	uint32_t avail = buffer->avail;
+	uint32_t avail;
 	int32_t size;
 	uint32_t overflow;
 
+	/* move the events of all cores into the DMA buffer */
+	dtrace_drain_rings(d);
+	avail = buffer->avail;
+
 	/* make sure we don't write more than buffer */
 	if (avail > DMA_TRACE_LOCAL_SIZE) {
 		overflow = avail - DMA_TRACE_LOCAL_SIZE;
@@ -73,9 +81,13 @@ static uint64_t trace_work(void *data, uint64_t delay)
 	 */
 	size = dma_trace_get_avail_data(d, buffer, avail);
 
-	/* any data to copy ? */
-	if (size == 0)
-		return DMA_TRACE_PERIOD;
+	/* any data to copy ? back off while there is none */
+	if (size == 0) {
+		spin_lock_irq(&d->lock, flags);
+		d->period = MIN(d->period * 2, DMA_TRACE_PERIOD_MAX);
+		spin_unlock_irq(&d->lock, flags);
+		return d->period;
+	}
 
 	d->overflow = overflow;
 
@@ -106,19 +118,34 @@ out:
 
 	/* disregard any old messages and don't resend them if we overflow */
 	if (size > 0) {
-		if (d->overflow)
+		if (d->overflow) {
 			buffer->avail = DMA_TRACE_LOCAL_SIZE - size;
-		else
+#ifdef CONFIG_TRACE_PACKED
+			/* host lost records so deltas must restart */
+			d->pack.sync = 1;
+#endif
+		} else {
 			buffer->avail -= size;
+		}
 	}
 
 	/* DMA trace copying is done, allow reschedule */
 	d->copy_in_progress = 0;
 
+	/* shorten the period while copies stay large */
+	if (size >= DMA_TRACE_WATERMARK)
+		d->period = MAX(d->period / 2, DMA_TRACE_PERIOD_MIN);
+	else
+		d->period = DMA_TRACE_PERIOD;
+
 	spin_unlock_irq(&d->lock, flags);
 
+	/* drain data left behind by a wrap without waiting a period */
+	if (size > 0 && buffer->avail)
+		return DMA_TRACE_RESCHEDULE_TIME;
+
 	/* reschedule the trace copying work */
-	return DMA_TRACE_PERIOD;
+	return d->period;
 }
 
 int dma_trace_init_early(struct sof *sof)
@@ -148,6 +175,7 @@ int dma_trace_init_complete(struct dma_trace_data *d)
 	}
 
 	work_init(&d->dmat_work, trace_work, d, WORK_ASYNC);
+	work_set_slack(&d->dmat_work, PLATFORM_WORKQ_DEFAULT_TIMEOUT);
 
 	return 0;
 }
@@ -167,6 +195,24 @@ int dma_trace_host_buffer(struct dma_trace_data *d,
 static int dma_trace_buffer_init(struct dma_trace_data *d)
 {
 	struct dma_trace_buf *buffer = &d->dmatb;
+	struct dma_trace_ring *ring;
+	int i;
+
+	/* allocate the trace ring of each core */
+	for (i = 0; i < PLATFORM_CORE_COUNT; i++) {
+		ring = &d->ring[i];
+		if (!ring->addr)
+			ring->addr = rballoc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM,
+					     DMA_TRACE_RING_SIZE);
+		if (!ring->addr) {
+			trace_buffer_error("dma_trace_buffer_init() error: "
+					   "ring alloc failed");
+			return -ENOMEM;
+		}
+
+		ring->w_pos = 0;
+		ring->r_pos = 0;
+	}
 
 	/* allocate new buffer */
 	buffer->addr = rballoc(RZONE_RUNTIME,
@@ -188,6 +234,11 @@ static int dma_trace_buffer_init(struct dma_trace_data *d)
 	buffer->end_addr = buffer->addr + buffer->size;
 	buffer->avail = 0;
 
+#ifdef CONFIG_TRACE_PACKED
+	/* decoder has no delta state at the start of the stream */
+	d->pack.sync = 1;
+#endif
+
 	return 0;
 }
 
@@ -327,7 +378,8 @@ int dma_trace_enable(struct dma_trace_data *d)
 	}
 
 	d->enabled = 1;
-	work_schedule_default(&d->dmat_work, DMA_TRACE_PERIOD);
+	d->period = DMA_TRACE_PERIOD;
+	work_schedule_default(&d->dmat_work, d->period);
 
 	return 0;
 }
@@ -342,6 +394,9 @@ void dma_trace_flush(void *t)
 	if (!trace_data || !trace_data->dmatb.addr)
 		return;
 
+	/* take the events not copied by trace work yet */
+	dtrace_drain_rings(trace_data);
+
 	buffer = &trace_data->dmatb;
 	avail = buffer->avail;
 
@@ -393,38 +448,145 @@ static int dtrace_calc_buf_overflow(struct dma_trace_buf *buffer,
 	return overflow;
 }
 
+#ifdef CONFIG_TRACE_PACKED
+/* records between sync records so a decoder can join mid stream */
+#define DTRACE_PACK_SYNC_PERIOD	64
+
+/* sync, tag, 64 bit delta, ids, core, entry delta and params */
+#define DTRACE_PACK_MAX_SIZE	(SOF_TRACE_PACK_SYNC_SIZE + 1 + 10 + 2 * 2 + \
+				 1 + 5 + _TRACE_EVENT_MAX_ARGUMENT_COUNT * 5)
+
+static uint32_t dtrace_pack_varint(uint8_t *dst, uint64_t value)
+{
+	uint32_t i = 0;
+
+	while (value >= 0x80) {
+		dst[i++] = (value & 0x7f) | 0x80;
+		value >>= 7;
+	}
+	dst[i++] = value;
+
+	return i;
+}
+
+static uint64_t dtrace_pack_zigzag(int64_t value)
+{
+	return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+/*
+ * Encode a raw trace record as described in uapi/user/trace.h. Only the
+ * given copy of the delta state is updated, so the caller can discard it
+ * when the record does not fit in the buffer.
+ */
+static uint32_t dtrace_pack_event(struct dma_trace_pack *pack,
+				  const char *e, uint32_t length,
+				  uint8_t *dst)
+{
+	struct log_entry_header header;
+	const uint32_t *params;
+	uint32_t params_num;
+	uint32_t size = 0;
+	uint8_t *tag;
+	uint32_t i;
+
+	memcpy(&header, e, sizeof(header));
+	params = (const uint32_t *)(e + sizeof(header));
+	params_num = (length - sizeof(header)) / sizeof(uint32_t);
+
+	if (pack->sync || pack->records >= DTRACE_PACK_SYNC_PERIOD) {
+		dst[size++] = SOF_TRACE_PACK_TYPE_SYNC;
+		memcpy(dst + size, SOF_TRACE_PACK_MAGIC,
+		       SOF_TRACE_PACK_MAGIC_SIZE);
+		size += SOF_TRACE_PACK_MAGIC_SIZE;
+		memcpy(dst + size, &header.timestamp, sizeof(uint64_t));
+		size += sizeof(uint64_t);
+
+		pack->timestamp = header.timestamp;
+		pack->entry = 0;
+		pack->id_0 = UINT32_MAX;
+		pack->core = UINT32_MAX;
+		pack->records = 0;
+		pack->sync = 0;
+	}
+
+	tag = dst + size++;
+	*tag = SOF_TRACE_PACK_TYPE_EVENT |
+		(params_num << SOF_TRACE_PACK_PARAMS_SHIFT);
+
+	size += dtrace_pack_varint(dst + size,
+				   dtrace_pack_zigzag(header.timestamp -
+						      pack->timestamp));
+
+	if (header.id_0 == pack->id_0 && header.id_1 == pack->id_1) {
+		*tag |= SOF_TRACE_PACK_SAME_IDS;
+	} else {
+		size += dtrace_pack_varint(dst + size, header.id_0);
+		size += dtrace_pack_varint(dst + size, header.id_1);
+	}
+
+	if (header.core_id == pack->core)
+		*tag |= SOF_TRACE_PACK_SAME_CORE;
+	else
+		dst[size++] = header.core_id;
+
+	size += dtrace_pack_varint(dst + size,
+				   dtrace_pack_zigzag((int32_t)
+						      (header.log_entry_address -
+						       pack->entry)));
+
+	for (i = 0; i < params_num; i++)
+		size += dtrace_pack_varint(dst + size, params[i]);
+
+	pack->timestamp = header.timestamp;
+	pack->entry = header.log_entry_address;
+	pack->id_0 = header.id_0;
+	pack->id_1 = header.id_1;
+	pack->core = header.core_id;
+	pack->records++;
+
+	return size;
+}
+#endif
+
 static void dtrace_add_event(const char *e, uint32_t length)
 {
 	struct dma_trace_buf *buffer = &trace_data->dmatb;
+#ifdef CONFIG_TRACE_PACKED
+	uint8_t packed[DTRACE_PACK_MAX_SIZE];
+	struct dma_trace_pack pack;
+#endif
 	uint32_t margin;
 	uint32_t overflow = 0;
 
-	margin = dtrace_calc_buf_margin(buffer);
-	overflow = dtrace_calc_buf_overflow(buffer, length);
-
 	/* tracing dropped entries */
-	if (dropped_entries) {
-		if (!overflow) {
-			/*
-			 * if any dropped entries have appeared and there
-			 * is not any overflow, their amount will be logged
-			 */
-			uint32_t tmp_dropped_entries = dropped_entries;
-
-			dropped_entries = 0;
-			/*
-			 * this trace_error invocation causes recursion,
-			 * so after it we have to recalculate margin and
-			 * overflow
-			 */
-			trace_error(0, "dtrace_add_event() error: "
-				    "number of dropped logs = %u",
-				    tmp_dropped_entries);
-			margin = dtrace_calc_buf_margin(buffer);
-			overflow = dtrace_calc_buf_overflow(buffer, length);
-		}
+	if (dropped_entries && !dtrace_calc_buf_overflow(buffer, length)) {
+		/*
+		 * if any dropped entries have appeared and there
+		 * is not any overflow, their amount will be logged
+		 */
+		uint32_t tmp_dropped_entries = dropped_entries;
+
+		dropped_entries = 0;
+		/*
+		 * this trace_error invocation causes recursion,
+		 * so margin and overflow and the packed record are
+		 * only calculated after it
+		 */
+		trace_error(0, "dtrace_add_event() error: "
+			    "number of dropped logs = %u",
+			    tmp_dropped_entries);
 	}
 
+#ifdef CONFIG_TRACE_PACKED
+	pack = trace_data->pack;
+	length = dtrace_pack_event(&pack, e, length, packed);
+	e = (const char *)packed;
+#endif
+
+	margin = dtrace_calc_buf_margin(buffer);
+	overflow = dtrace_calc_buf_overflow(buffer, length);
+
 	/* checking overflow */
 	if (!overflow) {
 		/* check for buffer wrap */
@@ -449,46 +611,202 @@ static void dtrace_add_event(const char *e, uint32_t length)
 
 		buffer->avail += length;
 		trace_data->messages++;
+#ifdef CONFIG_TRACE_PACKED
+		trace_data->pack = pack;
+#endif
 	} else {
 		/* if there is not enough memory for new log, we drop it */
 		dropped_entries++;
 	}
 }
 
+/* bytes used in ring, including skipped tails */
+static uint32_t dtrace_ring_used(struct dma_trace_ring *ring)
+{
+	uint32_t w = ring->w_pos;
+	uint32_t r = ring->r_pos;
+
+	return w >= r ? w - r : DMA_TRACE_RING_SIZE - r + w;
+}
+
+/*
+ * Put an event in the ring of the calling core, IRQs are off. Records don't
+ * wrap and a word is always left free, so a full ring never looks empty.
+ */
+static void dtrace_ring_put(struct dma_trace_ring *ring, const char *e,
+			    uint32_t length)
+{
+	uint32_t need = sizeof(uint32_t) + length;
+	uint32_t w = ring->w_pos;
+	uint32_t r = ring->r_pos;
+	uint32_t tail = DMA_TRACE_RING_SIZE - w;
+	uint32_t *dst;
+
+	if (w < r) {
+		if (r - w <= need)
+			goto drop;
+	} else if (tail < need || (tail == need && !r)) {
+		/* skip the tail, the reader wraps on a zero length */
+		if (r <= need)
+			goto drop;
+
+		*(uint32_t *)(ring->addr + w) = 0;
+		dcache_writeback_region(ring->addr + w, sizeof(uint32_t));
+		w = 0;
+	}
+
+	dst = ring->addr + w;
+	dst[0] = length;
+	memcpy(dst + 1, e, length);
+	dcache_writeback_region(dst, need);
+
+	w += need;
+	if (w == DMA_TRACE_RING_SIZE)
+		w = 0;
+
+	/* publish the record after its data */
+	ring->w_pos = w;
+	return;
+
+drop:
+	ring->dropped++;
+}
+
+/* oldest record of ring or NULL if it is empty */
+static const char *dtrace_ring_peek(struct dma_trace_ring *ring,
+				    uint32_t *length)
+{
+	uint32_t *src;
+
+	if (ring->r_pos == ring->w_pos)
+		return NULL;
+
+	src = ring->addr + ring->r_pos;
+	dcache_invalidate_region(src, sizeof(uint32_t));
+	if (!*src) {
+		ring->r_pos = 0;
+		if (!ring->w_pos)
+			return NULL;
+
+		src = ring->addr;
+		dcache_invalidate_region(src, sizeof(uint32_t));
+	}
+
+	*length = *src;
+	dcache_invalidate_region(src + 1, *length);
+
+	return (const char *)(src + 1);
+}
+
+static void dtrace_ring_pop(struct dma_trace_ring *ring, uint32_t length)
+{
+	uint32_t r = ring->r_pos + sizeof(uint32_t) + length;
+
+	ring->r_pos = r == DMA_TRACE_RING_SIZE ? 0 : r;
+}
+
+/*
+ * Merge the rings of all cores into the DMA buffer in timestamp order. Runs
+ * on the master core in trace work, events stay in their rings while the
+ * DMA buffer is full.
+ */
+static void dtrace_drain_rings(struct dma_trace_data *d)
+{
+	struct log_entry_header header;
+	struct dma_trace_ring *ring;
+	const char *oldest;
+	const char *e;
+	uint64_t timestamp = 0;
+	uint32_t oldest_length = 0;
+	uint32_t length;
+	int records;
+	int core = 0;
+	int i;
+
+	for (i = 0; i < PLATFORM_CORE_COUNT; i++) {
+		ring = &d->ring[i];
+		dropped_entries += ring->dropped - ring->dropped_seen;
+		ring->dropped_seen = ring->dropped;
+	}
+
+	/* bound the work if cores keep tracing while we drain */
+	for (records = DMA_TRACE_LOCAL_SIZE / sizeof(header); records > 0;
+	     records--) {
+		oldest = NULL;
+
+		for (i = 0; i < PLATFORM_CORE_COUNT; i++) {
+			e = dtrace_ring_peek(&d->ring[i], &length);
+			if (!e)
+				continue;
+
+			memcpy(&header, e, sizeof(header));
+			if (!oldest || header.timestamp < timestamp) {
+				oldest = e;
+				oldest_length = length;
+				timestamp = header.timestamp;
+				core = i;
+			}
+		}
+
+		if (!oldest ||
+		    dtrace_calc_buf_overflow(&d->dmatb, oldest_length))
+			return;
+
+		dtrace_add_event(oldest, oldest_length);
+		dtrace_ring_pop(&d->ring[core], oldest_length);
+	}
+}
+
 void dtrace_event(const char *e, uint32_t length)
 {
-	struct dma_trace_buf *buffer = NULL;
+	struct dma_trace_ring *ring;
 	unsigned long flags;
+	uint32_t idle;
 
 	if (!trace_data || !trace_data->dmatb.addr ||
 	    length > DMA_TRACE_LOCAL_SIZE / 8 || length == 0)
 		return;
 
-	buffer = &trace_data->dmatb;
+	/* no other core touches this ring, local IRQs off is enough */
+	ring = &trace_data->ring[cpu_get_id()];
+	flags = interrupt_global_disable();
+	dtrace_ring_put(ring, e, length);
+	interrupt_global_enable(flags);
+
+	/* trace work runs on the master core, slave rings wait for it */
+	if (cpu_get_id() != PLATFORM_MASTER_CORE_ID)
+		return;
 
 	spin_lock_irq(&trace_data->lock, flags);
-	dtrace_add_event(e, length);
 
-	/* if DMA trace copying is working or slave core
-	 * don't check if local buffer is half full
-	 */
-	if (trace_data->copy_in_progress ||
-	    cpu_get_id() != PLATFORM_MASTER_CORE_ID) {
+	/* if DMA trace copying is working don't check the fill level */
+	if (trace_data->copy_in_progress) {
 		spin_unlock_irq(&trace_data->lock, flags);
 		return;
 	}
 
+	/* trace work backed off while idle, bring it back to normal */
+	idle = trace_data->period > DMA_TRACE_PERIOD;
+	if (idle)
+		trace_data->period = DMA_TRACE_PERIOD;
+
 	spin_unlock_irq(&trace_data->lock, flags);
 
-	/* schedule copy now if buffer > 50% full */
-	if (trace_data->enabled &&
-	    buffer->avail >= (DMA_TRACE_LOCAL_SIZE / 2)) {
+	if (!trace_data->enabled)
+		return;
+
+	/* schedule copy now if events are above the watermark */
+	if (trace_data->dmatb.avail + dtrace_ring_used(ring) >=
+	    DMA_TRACE_WATERMARK) {
 		work_reschedule_default(&trace_data->dmat_work,
 		DMA_TRACE_RESCHEDULE_TIME);
 		/* reschedule should not be interrupted
 		 * just like we are in copy progress
 		 */
 		trace_data->copy_in_progress = 1;
+	} else if (idle) {
+		work_reschedule_default(&trace_data->dmat_work,
+					DMA_TRACE_PERIOD);
 	}
 }
 
@@ -498,5 +816,5 @@ void dtrace_event_atomic(const char *e, uint32_t length)
 	    length > DMA_TRACE_LOCAL_SIZE / 8 || length == 0)
 		return;
 
-	dtrace_add_event(e, length);
+	dtrace_ring_put(&trace_data->ring[cpu_get_id()], e, length);
 }
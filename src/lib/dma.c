@@ -45,13 +45,97 @@ static struct dma_info lib_dma = {
 
 void dma_install(struct dma *dma_array, size_t num_dmas)
 {
+	int i;
+
+	for (i = 0; i < num_dmas; i++) {
+		list_init(&dma_array[i].streams);
+		dma_array[i].bandwidth = 0;
+	}
+
 	lib_dma.dma_array = dma_array;
 	lib_dma.num_dmas = num_dmas;
 }
 
+/* true if DMAC d can serve a request for dir, caps and dev */
+static int dma_match(struct dma *d, uint32_t dir, uint32_t cap, uint32_t dev)
+{
+	/* skip if this DMAC does not support the requested dir */
+	if (dir && (d->plat_data.dir & dir) == 0)
+		return 0;
+
+	/* skip if this DMAC does not support the requested caps */
+	if (cap && (d->plat_data.caps & cap) == 0)
+		return 0;
+
+	/* skip if this DMAC does not support the requested dev */
+	if (dev && (d->plat_data.devs & dev) == 0)
+		return 0;
+
+	/* skip if this DMAC has 1 user per avail channel */
+	/* TODO: this should be fixed in dai.c to allow more users */
+	if (d->sref >= d->plat_data.channels)
+		return 0;
+
+	return 1;
+}
+
+static void dma_trace_no_match(uint32_t dir, uint32_t cap, uint32_t dev,
+			       uint32_t flags)
+{
+	struct dma *d;
+
+	trace_error(TRACE_CLASS_DMA, "No DMAC dir %d caps 0x%x dev 0x%x flags 0x%x",
+		    dir, cap, dev, flags);
+
+	for (d = lib_dma.dma_array; d < lib_dma.dma_array + lib_dma.num_dmas;
+		d++) {
+		trace_error(TRACE_CLASS_DMA, " DMAC ID %d users %d busy channels %d",
+			    d->plat_data.id, d->sref,
+			    atomic_read(&d->num_channels_busy));
+		trace_error(TRACE_CLASS_DMA, "  caps 0x%x dev 0x%x",
+			    d->plat_data.caps, d->plat_data.devs);
+	}
+}
+
+/* takes a user reference, the first user probes the DMAC */
+static struct dma *dma_ref(struct dma *dmin)
+{
+	int ret;
+
+	/* return DMAC */
+	tracev_event(TRACE_CLASS_DMA, "dma_get(), dma-probe id = %d",
+		     dmin->plat_data.id);
+
+	/* Shared DMA controllers with multiple channels
+	 * may be requested many times, let the probe()
+	 * do on-first-use initialization.
+	 */
+	spin_lock(&dmin->lock);
+
+	ret = 0;
+	if (dmin->sref == 0) {
+		ret = dma_probe(dmin);
+		if (ret < 0) {
+			trace_error(TRACE_CLASS_DMA,
+				    "dma_get() error: dma-probe failed"
+				    " id = %d, ret = %d",
+				    dmin->plat_data.id, ret);
+		}
+	}
+	if (!ret)
+		dmin->sref++;
+
+	trace_event(TRACE_CLASS_DMA, "dma_get() ID %d sref = %d busy channels %d",
+		    dmin->plat_data.id, dmin->sref,
+		    atomic_read(&dmin->num_channels_busy));
+
+	spin_unlock(&dmin->lock);
+	return !ret ? dmin : NULL;
+}
+
 struct dma *dma_get(uint32_t dir, uint32_t cap, uint32_t dev, uint32_t flags)
 {
-	int ch_count, ret;
+	int ch_count;
 	int min_ch_count = INT32_MAX;
 	struct dma *d = NULL, *dmin = NULL;
 
@@ -63,21 +147,7 @@ struct dma *dma_get(uint32_t dir, uint32_t cap, uint32_t dev, uint32_t flags)
 	/* find DMAC with free channels that matches request */
 	for (d = lib_dma.dma_array; d < lib_dma.dma_array + lib_dma.num_dmas;
 	     d++) {
-		/* skip if this DMAC does not support the requested dir */
-		if (dir && (d->plat_data.dir & dir) == 0)
-			continue;
-
-		/* skip if this DMAC does not support the requested caps */
-		if (cap && (d->plat_data.caps & cap) == 0)
-			continue;
-
-		/* skip if this DMAC does not support the requested dev */
-		if (dev && (d->plat_data.devs & dev) == 0)
-			continue;
-
-		/* skip if this DMAC has 1 user per avail channel */
-		/* TODO: this should be fixed in dai.c to allow more users */
-		if (d->sref >= d->plat_data.channels)
+		if (!dma_match(d, dir, cap, dev))
 			continue;
 
 		/* if exclusive access is requested */
@@ -100,49 +170,104 @@ struct dma *dma_get(uint32_t dir, uint32_t cap, uint32_t dev, uint32_t flags)
 	}
 
 	if (!dmin) {
-		trace_error(TRACE_CLASS_DMA, "No DMAC dir %d caps 0x%x dev 0x%x flags 0x%x",
-			    dir, cap, dev, flags);
-
-		for (d = lib_dma.dma_array; d < lib_dma.dma_array + lib_dma.num_dmas;
-			d++) {
-			trace_error(TRACE_CLASS_DMA, " DMAC ID %d users %d busy channels %d",
-				    d->plat_data.id, d->sref,
-				    atomic_read(&d->num_channels_busy));
-			trace_error(TRACE_CLASS_DMA, "  caps 0x%x dev 0x%x",
-				    d->plat_data.caps, d->plat_data.devs);
-		}
+		dma_trace_no_match(dir, cap, dev, flags);
 		return NULL;
 	}
 
-	/* return DMAC */
-	tracev_event(TRACE_CLASS_DMA, "dma_get(), dma-probe id = %d",
-		     dmin->plat_data.id);
+	return dma_ref(dmin);
+}
 
-	/* Shared DMA controllers with multiple channels
-	 * may be requested many times, let the probe()
-	 * do on-first-use initialization.
-	 */
-	spin_lock(&dmin->lock);
+/* true if DMAC d moves a stream of the pipeline, caller holds d->lock */
+static int dma_has_pipeline(struct dma *d, uint32_t pipeline_id)
+{
+	struct dma_stream *stream;
+	struct list_item *slist;
 
-	ret = 0;
-	if (dmin->sref == 0) {
-		ret = dma_probe(dmin);
-		if (ret < 0) {
-			trace_error(TRACE_CLASS_DMA,
-				    "dma_get() error: dma-probe failed"
-				    " id = %d, ret = %d",
-				    dmin->plat_data.id, ret);
+	list_for_item(slist, &d->streams) {
+		stream = container_of(slist, struct dma_stream, list);
+		if (stream->pipeline_id == pipeline_id)
+			return 1;
+	}
+
+	return 0;
+}
+
+struct dma *dma_get_stream(uint32_t dir, uint32_t cap, uint32_t dev,
+			   struct dma_stream *stream)
+{
+	uint32_t min_bandwidth = UINT32_MAX;
+	int min_sref = INT32_MAX;
+	struct dma *d = NULL, *dmin = NULL;
+	uint32_t bandwidth;
+	int related;
+
+	if (!lib_dma.num_dmas) {
+		trace_error(TRACE_CLASS_DMA, "dma_get_stream(): No DMACs "
+			    "installed");
+		return NULL;
+	}
+
+	for (d = lib_dma.dma_array; d < lib_dma.dma_array + lib_dma.num_dmas;
+	     d++) {
+		if (!dma_match(d, dir, cap, dev))
+			continue;
+
+		spin_lock(&d->lock);
+		related = dma_has_pipeline(d, stream->pipeline_id);
+		bandwidth = d->bandwidth;
+		spin_unlock(&d->lock);
+
+		/* keep a pipeline on one DMAC for a coherent group start */
+		if (related) {
+			dmin = d;
+			break;
+		}
+
+		/* otherwise balance the arbitration load of the DMACs */
+		if (bandwidth < min_bandwidth ||
+		    (bandwidth == min_bandwidth && d->sref < min_sref)) {
+			dmin = d;
+			min_bandwidth = bandwidth;
+			min_sref = d->sref;
 		}
 	}
-	if (!ret)
-		dmin->sref++;
 
-	trace_event(TRACE_CLASS_DMA, "dma_get() ID %d sref = %d busy channels %d",
-		    dmin->plat_data.id, dmin->sref,
-		    atomic_read(&dmin->num_channels_busy));
+	if (!dmin) {
+		dma_trace_no_match(dir, cap, dev, DMA_ACCESS_SHARED);
+		return NULL;
+	}
+
+	if (!dma_ref(dmin))
+		return NULL;
 
+	spin_lock(&dmin->lock);
+	list_item_append(&stream->list, &dmin->streams);
+	dmin->bandwidth += stream->bandwidth;
+	trace_event(TRACE_CLASS_DMA, "dma_get_stream() ID %d pipe %d "
+		    "bandwidth %u", dmin->plat_data.id, stream->pipeline_id,
+		    dmin->bandwidth);
 	spin_unlock(&dmin->lock);
-	return !ret ? dmin : NULL;
+
+	return dmin;
+}
+
+void dma_stream_update(struct dma *dma, struct dma_stream *stream,
+		       uint32_t bandwidth)
+{
+	spin_lock(&dma->lock);
+	dma->bandwidth += bandwidth - stream->bandwidth;
+	stream->bandwidth = bandwidth;
+	spin_unlock(&dma->lock);
+}
+
+void dma_put_stream(struct dma *dma, struct dma_stream *stream)
+{
+	spin_lock(&dma->lock);
+	list_item_del(&stream->list);
+	dma->bandwidth -= stream->bandwidth;
+	spin_unlock(&dma->lock);
+
+	dma_put(dma);
 }
 
 void dma_put(struct dma *dma)
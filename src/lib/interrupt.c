@@ -33,11 +33,26 @@
 #include <sof/interrupt.h>
 #include <sof/interrupt-map.h>
 #include <sof/alloc.h>
+#include <sof/cpu.h>
 #include <arch/interrupt.h>
+#include <arch/cache.h>
 #include <platform/interrupt.h>
+#include <platform/platform.h>
+#include <platform/timer.h>
+#include <sof/drivers/timer.h>
+#include <uapi/ipc/debug.h>
 #include <stdint.h>
 #include <stdlib.h>
 
+#ifdef CONFIG_IRQ_STATS
+/* every registered child IRQ for statistics */
+static struct list_item irq_stats_list = {
+	.next = &irq_stats_list,
+	.prev = &irq_stats_list,
+};
+static spinlock_t irq_stats_lock;
+#endif
+
 static int irq_register_child(struct irq_desc *parent, int irq, int unmask,
 			      void (*handler)(void *arg), void *arg);
 static void irq_unregister_child(struct irq_desc *parent, int irq);
@@ -65,6 +80,7 @@ static int irq_register_child(struct irq_desc *parent, int irq, int unmask,
 		goto finish;
 	}
 
+	child->irq = irq;
 	child->enabled_count = 0;
 	child->handler = handler;
 	child->handler_arg = arg;
@@ -73,6 +89,12 @@ static int irq_register_child(struct irq_desc *parent, int irq, int unmask,
 
 	list_item_append(&child->irq_list, &parent->child[SOF_IRQ_BIT(irq)]);
 
+#ifdef CONFIG_IRQ_STATS
+	spin_lock(&irq_stats_lock);
+	list_item_append(&child->stats_list, &irq_stats_list);
+	spin_unlock(&irq_stats_lock);
+#endif
+
 	/* do we need to register parent ? */
 	if (parent->num_children == 0) {
 		ret = arch_interrupt_register(parent->irq,
@@ -103,6 +125,11 @@ static void irq_unregister_child(struct irq_desc *parent, int irq)
 
 		if (SOF_IRQ_ID(irq) == child->id) {
 			list_item_del(&child->irq_list);
+#ifdef CONFIG_IRQ_STATS
+			spin_lock(&irq_stats_lock);
+			list_item_del(&child->stats_list);
+			spin_unlock(&irq_stats_lock);
+#endif
 			parent->num_children--;
 			rfree(child);
 		}
@@ -223,3 +250,69 @@ uint32_t interrupt_disable(uint32_t irq)
 	else
 		return irq_disable_child(parent, irq);
 }
+
+#ifdef CONFIG_IRQ_STATS
+void interrupt_child_run(struct irq_desc *child, uint64_t dispatch)
+{
+	struct irq_stats *stats = &child->stats;
+	uint64_t start;
+	uint32_t delta;
+
+	start = platform_timer_get(platform_timer);
+	child->handler(child->handler_arg);
+	delta = platform_timer_get(platform_timer) - start;
+
+	stats->count++;
+	stats->total_run += delta;
+	if (delta > stats->max_run)
+		stats->max_run = delta;
+
+	/* time spent in the parent and earlier children before entry */
+	delta = start - dispatch;
+	if (delta > stats->max_latency)
+		stats->max_latency = delta;
+}
+
+int interrupt_stats_info(struct sof_ipc_debug_irq_stats *info, int reset)
+{
+	struct sof_ipc_debug_irq_elem *elem;
+	struct irq_desc *child;
+	struct list_item *clist;
+
+	info->num_irqs = 0;
+	info->num_elems = 0;
+
+	spin_lock(&irq_stats_lock);
+
+	list_for_item(clist, &irq_stats_list) {
+		child = container_of(clist, struct irq_desc, stats_list);
+		info->num_irqs++;
+
+		if (info->num_elems == SOF_IPC_DEBUG_IRQ_MAX_ELEMS)
+			continue;
+
+		/* stats are updated by the core the IRQ is routed to */
+		if (SOF_IRQ_CPU(child->irq) != cpu_get_id())
+			dcache_invalidate_region(&child->stats,
+						 sizeof(child->stats));
+
+		elem = &info->elems[info->num_elems++];
+		elem->irq = child->irq;
+		elem->count = child->stats.count;
+		elem->avg_run = child->stats.count ?
+			child->stats.total_run / child->stats.count : 0;
+		elem->max_run = child->stats.max_run;
+		elem->max_latency = child->stats.max_latency;
+
+		if (reset) {
+			bzero(&child->stats, sizeof(child->stats));
+			dcache_writeback_region(&child->stats,
+						sizeof(child->stats));
+		}
+	}
+
+	spin_unlock(&irq_stats_lock);
+
+	return sizeof(*info) + info->num_elems * sizeof(*elem);
+}
+#endif
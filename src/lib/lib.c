@@ -33,6 +33,16 @@
 #include <sof/sof.h>
 #include <sof/alloc.h>
 
+#if defined(__XCC__)
+#include <xtensa/config/core-isa.h>
+
+#if XCHAL_HAVE_HIFI3
+#include <xtensa/tie/xt_hifi3.h>
+#define LIB_HIFI3	1
+#endif
+
+#endif
+
 #if 0 // TODO: only compile if no arch memcpy is available.
 
 void cmemcpy(void *dest, void *src, size_t size)
@@ -52,8 +62,8 @@ void cmemcpy(void *dest, void *src, size_t size)
 		d32[i] = s32[i];
 
 	/* copy remaining bytes */
-	d8 = (uint8_t*) d32[i];
-	s8 = (uint8_t*) s32[i];
+	d8 = (uint8_t*) &d32[i];
+	s8 = (uint8_t*) &s32[i];
 	for (i = 0; i <	r; i++)
 		d8[i] = s8[i];
 }
@@ -67,34 +77,71 @@ void *memcpy(void *dest, const void *src, size_t n)
 	return dest;
 }
 
-/* generic bzero - TODO: can be optimsed for ARCH ? */
+/* bzero is memset() with the aligned fast paths below */
 void bzero(void *s, size_t n)
 {
-	uint32_t *d32 = s;
-	uint8_t *d8;
-	int i;
-	int d = n >> 2;
-	int r = n % 4;
-
-	/* zero word at a time */
-	for (i = 0; i <	d; i++)
-		d32[i] = 0;
-
-	/* zero remaining bytes */
-	d8 = (uint8_t*) &d32[i];
-	for (i = 0; i <	r; i++)
-		d8[i] = 0;
+	memset(s, 0, n);
 }
 
-/* generic memset - TODO: can be optimsed for ARCH ? */
+/*
+ * memset - byte stores until the destination is aligned, then 64 bit
+ * HiFi3 stores (or 4 x 32 bit word stores) for the bulk, then the tail.
+ */
 void *memset(void *s, int c, size_t n)
 {
 	uint8_t *d8 = s;
 	uint8_t v = c;
-	int i;
+	uint32_t w = v * 0x01010101;
+	uint32_t *d32;
+#if LIB_HIFI3
+	ae_int32x2 *d64;
+	ae_int32x2 w64;
+	size_t i;
+#endif
+
+	/* head bytes up to word alignment */
+	while (n && ((uintptr_t)d8 & 0x3)) {
+		*d8++ = v;
+		n--;
+	}
+
+	d32 = (uint32_t *)d8;
+
+#if LIB_HIFI3
+	/* one more word to reach 64 bit alignment */
+	if (n >= sizeof(uint32_t) && ((uintptr_t)d32 & 0x7)) {
+		*d32++ = w;
+		n -= sizeof(uint32_t);
+	}
+
+	w64 = AE_MOVDA32X2(w, w);
+	d64 = (ae_int32x2 *)d32;
+	for (i = 0; i < n >> 3; i++)
+		AE_S32X2_IP(w64, d64, sizeof(ae_int32x2));
+
+	d32 = (uint32_t *)d64;
+	n &= 0x7;
+#else
+	/* four words per loop */
+	while (n >= 4 * sizeof(uint32_t)) {
+		d32[0] = w;
+		d32[1] = w;
+		d32[2] = w;
+		d32[3] = w;
+		d32 += 4;
+		n -= 4 * sizeof(uint32_t);
+	}
+#endif
+
+	while (n >= sizeof(uint32_t)) {
+		*d32++ = w;
+		n -= sizeof(uint32_t);
+	}
 
-	for (i = 0; i <	n; i++)
-		d8[i] = v;
+	/* tail bytes */
+	d8 = (uint8_t *)d32;
+	while (n--)
+		*d8++ = v;
 
 	return s;
 }
@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Liam Girdwood <liam.r.girdwood@linux.intel.com>
+ */
+
+/*
+ * Lock profile. Each core keeps a table of the locks it has taken with
+ * IRQs off. Tables are only written by their own core with IRQs off, so
+ * no locking is needed. The host reads the tables summed over all cores.
+ */
+
+#include <sof/lock.h>
+#include <sof/cpu.h>
+#include <sof/alloc.h>
+#include <arch/cache.h>
+#include <platform/timer.h>
+#include <sof/drivers/timer.h>
+#include <platform/platform.h>
+#include <uapi/ipc/debug.h>
+#include <stdint.h>
+
+#ifdef CONFIG_LOCK_PROFILE
+
+/* locks profiled per core */
+#define LOCK_PROF_ENTRIES	16
+
+struct lock_prof_entry {
+	uint32_t user;		/* spinlock_init() line */
+	uint32_t count;		/* times taken */
+	uint32_t spins;		/* failed tries */
+	uint32_t max;		/* longest hold */
+	uint64_t total;		/* total hold */
+};
+
+struct lock_prof {
+	struct lock_prof_entry entries[LOCK_PROF_ENTRIES];
+	uint32_t dropped;	/* locks with no free entry */
+} __attribute__ ((__aligned__(PLATFORM_DCACHE_ALIGN)));
+
+static struct lock_prof lock_prof[PLATFORM_CORE_COUNT];
+
+void lock_prof_acquire(spinlock_t *lock)
+{
+	uint32_t spins = 0;
+
+	while (!arch_try_lock(lock))
+		spins++;
+
+	lock->prof_spins = spins;
+	lock->prof_start = platform_timer_get(platform_timer);
+}
+
+void lock_prof_release(spinlock_t *lock)
+{
+	struct lock_prof *prof = &lock_prof[cpu_get_id()];
+	struct lock_prof_entry *entry;
+	uint32_t hold;
+	int i;
+
+	hold = (uint32_t)platform_timer_get(platform_timer) -
+		lock->prof_start;
+
+	for (i = 0; i < LOCK_PROF_ENTRIES; i++) {
+		entry = &prof->entries[i];
+
+		/* unused entries are never followed by used ones */
+		if (!entry->count)
+			entry->user = lock->user;
+
+		if (entry->user == lock->user)
+			break;
+	}
+
+	arch_spin_unlock(lock);
+
+	if (i == LOCK_PROF_ENTRIES) {
+		prof->dropped++;
+		return;
+	}
+
+	entry->count++;
+	entry->spins += lock->prof_spins;
+	entry->total += hold;
+	if (hold > entry->max)
+		entry->max = hold;
+}
+
+static struct lock_prof_entry lock_prof_sum[SOF_IPC_DEBUG_LOCK_MAX_ELEMS];
+
+int lock_prof_info(struct sof_ipc_debug_lock_prof *info, int reset)
+{
+	struct sof_ipc_debug_lock_elem *elem;
+	struct lock_prof_entry *entry;
+	struct lock_prof_entry *sum;
+	struct lock_prof *prof;
+	uint32_t flags;
+	int core;
+	int i;
+	int j;
+
+	info->dropped = 0;
+	info->num_elems = 0;
+
+	/* our own table must not change while it's read */
+	flags = interrupt_global_disable();
+
+	for (core = 0; core < PLATFORM_CORE_COUNT; core++) {
+		prof = &lock_prof[core];
+
+		/* other cores update their own table */
+		if (core != cpu_get_id())
+			dcache_invalidate_region(prof, sizeof(*prof));
+
+		info->dropped += prof->dropped;
+
+		for (i = 0; i < LOCK_PROF_ENTRIES; i++) {
+			entry = &prof->entries[i];
+			if (!entry->count)
+				break;
+
+			for (j = 0; j < info->num_elems; j++) {
+				if (lock_prof_sum[j].user == entry->user)
+					break;
+			}
+
+			if (j == info->num_elems) {
+				if (j == SOF_IPC_DEBUG_LOCK_MAX_ELEMS) {
+					info->dropped++;
+					continue;
+				}
+
+				bzero(&lock_prof_sum[j], sizeof(*sum));
+				lock_prof_sum[j].user = entry->user;
+				info->num_elems++;
+			}
+
+			sum = &lock_prof_sum[j];
+			sum->count += entry->count;
+			sum->spins += entry->spins;
+			sum->total += entry->total;
+			if (entry->max > sum->max)
+				sum->max = entry->max;
+		}
+
+		if (reset) {
+			bzero(prof, sizeof(*prof));
+			dcache_writeback_region(prof, sizeof(*prof));
+		}
+	}
+
+	interrupt_global_enable(flags);
+
+	for (i = 0; i < info->num_elems; i++) {
+		sum = &lock_prof_sum[i];
+		elem = &info->elems[i];
+		elem->user = sum->user;
+		elem->count = sum->count;
+		elem->spins = sum->spins;
+		elem->max = sum->max;
+		elem->avg = sum->total / sum->count;
+	}
+
+	return sizeof(*info) + info->num_elems * sizeof(*elem);
+}
+
+#endif
@@ -0,0 +1,262 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Liam Girdwood <liam.r.girdwood@linux.intel.com>
+ */
+
+/*
+ * Memory benchmark. Each heap of a zone is timed through its cached and
+ * uncached alias with the core cycle counter, keeping the fastest of a few
+ * runs. The uncached alias is timed first so the cached runs don't start
+ * from lines the uncached writes left stale.
+ */
+
+#include <sof/alloc.h>
+#include <sof/clk.h>
+#include <sof/cpu.h>
+#include <sof/string.h>
+#include <sof/audio/format.h>
+#include <sof/timebase.h>
+#include <arch/cache.h>
+#include <platform/clk.h>
+#include <platform/memory.h>
+#include <platform/platform.h>
+#include <uapi/ipc/debug.h>
+#include <stdint.h>
+#include <errno.h>
+
+#ifdef CONFIG_MEM_BENCH
+
+/* bytes apart of two dependent loads, past any line and prefetch */
+#define MEM_BENCH_CHASE_STRIDE	(37 * PLATFORM_DCACHE_ALIGN)
+
+typedef uint32_t (*mem_bench_test)(void *ptr, uint32_t size);
+
+static uint32_t mem_bench_read(void *ptr, uint32_t size)
+{
+	volatile uint32_t *p = ptr;
+	uint32_t sum = 0;
+	uint32_t start;
+	uint32_t i;
+
+	start = arch_timer_get_cycles();
+	for (i = 0; i < size / sizeof(uint32_t); i++)
+		sum += p[i];
+
+	/* keep the loads */
+	p[0] = sum;
+
+	return arch_timer_get_cycles() - start;
+}
+
+static uint32_t mem_bench_write(void *ptr, uint32_t size)
+{
+	volatile uint32_t *p = ptr;
+	uint32_t start;
+	uint32_t i;
+
+	start = arch_timer_get_cycles();
+	for (i = 0; i < size / sizeof(uint32_t); i++)
+		p[i] = i;
+
+	return arch_timer_get_cycles() - start;
+}
+
+static uint32_t mem_bench_copy(void *ptr, uint32_t size)
+{
+	uint32_t start;
+
+	start = arch_timer_get_cycles();
+	memcpy((char *)ptr + size / 2, ptr, size / 2);
+
+	return arch_timer_get_cycles() - start;
+}
+
+/* link the words a stride apart into a ring covering the buffer */
+static uint32_t mem_bench_chase_init(void *ptr, uint32_t size)
+{
+	uint32_t words = size / sizeof(uint32_t);
+	uint32_t stride = MEM_BENCH_CHASE_STRIDE / sizeof(uint32_t);
+	uint32_t *p = ptr;
+	uint32_t loads = 0;
+	uint32_t i = 0;
+
+	do {
+		p[i] = (i + stride) % words;
+		i = p[i];
+		loads++;
+	} while (i);
+
+	return loads;
+}
+
+/* result in 1/256 cycles per load */
+static uint32_t mem_bench_latency(void *ptr, uint32_t size)
+{
+	volatile uint32_t *p = ptr;
+	uint32_t loads = mem_bench_chase_init(ptr, size);
+	uint32_t start;
+	uint32_t i = 0;
+	uint32_t n;
+
+	start = arch_timer_get_cycles();
+	for (n = 0; n < loads; n++)
+		i = p[i];
+
+	return ((uint64_t)(arch_timer_get_cycles() - start) << 8) / loads;
+}
+
+/* results per KB of dirty lines */
+static uint32_t mem_bench_writeback(void *ptr, uint32_t size)
+{
+	uint32_t start;
+
+	mem_bench_write(ptr, size);
+
+	start = arch_timer_get_cycles();
+	dcache_writeback_region(ptr, size);
+
+	return (uint64_t)(arch_timer_get_cycles() - start) * 1024 / size;
+}
+
+static uint32_t mem_bench_invalidate(void *ptr, uint32_t size)
+{
+	uint32_t start;
+
+	mem_bench_read(ptr, size);
+
+	start = arch_timer_get_cycles();
+	dcache_invalidate_region(ptr, size);
+
+	return (uint64_t)(arch_timer_get_cycles() - start) * 1024 / size;
+}
+
+static uint32_t mem_bench_run(mem_bench_test test, void *ptr, uint32_t size,
+			      uint32_t iterations)
+{
+	uint32_t best = UINT32_MAX;
+	uint32_t cycles;
+	uint32_t i;
+
+	for (i = 0; i < iterations; i++) {
+		cycles = test(ptr, size);
+		if (cycles < best)
+			best = cycles;
+	}
+
+	return best;
+}
+
+static void mem_bench_alias(struct sof_ipc_debug_mem_bench_elem *elem,
+			    void *ptr, uint32_t size, uint32_t iterations)
+{
+	elem->read = mem_bench_run(mem_bench_read, ptr, size, iterations);
+	elem->write = mem_bench_run(mem_bench_write, ptr, size, iterations);
+	elem->copy = mem_bench_run(mem_bench_copy, ptr, size, iterations);
+	elem->latency = mem_bench_run(mem_bench_latency, ptr, size,
+				      iterations);
+
+	if (elem->uncached) {
+		elem->writeback = 0;
+		elem->invalidate = 0;
+		return;
+	}
+
+	elem->writeback = mem_bench_run(mem_bench_writeback, ptr, size,
+					iterations);
+	elem->invalidate = mem_bench_run(mem_bench_invalidate, ptr, size,
+					 iterations);
+}
+
+int mem_bench(struct sof_ipc_debug_mem_bench_params *params,
+	      struct sof_ipc_debug_mem_bench *bench)
+{
+	struct sof_ipc_debug_mem_bench_elem *elem;
+	uint32_t size = params->size ? params->size :
+		SOF_IPC_DEBUG_MEM_BENCH_SIZE;
+	uint32_t iterations = params->iterations ? params->iterations :
+		SOF_IPC_DEBUG_MEM_BENCH_ITERS;
+	uint32_t caps;
+	void *ptr;
+	int heap;
+	int ret;
+
+	if (size > SOF_IPC_DEBUG_MEM_BENCH_SIZE_MAX ||
+	    size < MEM_BENCH_CHASE_STRIDE * 2)
+		return -EINVAL;
+
+	/* whole lines so the cache tests cover only the buffer */
+	size = ALIGN_DOWN(size, PLATFORM_DCACHE_ALIGN);
+
+	bench->zone = params->zone;
+	bench->size = size;
+	bench->iterations = iterations;
+	bench->cycles_per_ms = clock_ms_to_ticks(CLK_CPU(cpu_get_id()), 1);
+	bench->num_elems = 0;
+
+	for (heap = 0; ; heap++) {
+		ret = heap_alloc_at(params->zone, heap, size, &caps, &ptr);
+		if (ret == -ENOENT)
+			break;
+		if (ret == -ENOMEM)
+			continue;
+		if (ret < 0)
+			return ret;
+
+		if (bench->num_elems + 2 > SOF_IPC_DEBUG_MEM_BENCH_MAX_ELEMS) {
+			rfree(ptr);
+			break;
+		}
+
+		/* platforms without an uncached alias report cached only */
+		if (cache_to_uncache(ptr) != ptr) {
+			/* no dirty lines may land over the uncached writes */
+			dcache_writeback_invalidate_region(ptr, size);
+
+			elem = &bench->elems[bench->num_elems++];
+			elem->heap = heap;
+			elem->caps = caps;
+			elem->uncached = 1;
+			mem_bench_alias(elem, cache_to_uncache(ptr), size,
+					iterations);
+
+			dcache_invalidate_region(ptr, size);
+		}
+
+		elem = &bench->elems[bench->num_elems++];
+		elem->heap = heap;
+		elem->caps = caps;
+		elem->uncached = 0;
+		mem_bench_alias(elem, ptr, size, iterations);
+
+		rfree(ptr);
+	}
+
+	return sizeof(*bench) + bench->num_elems * sizeof(*elem);
+}
+
+#endif
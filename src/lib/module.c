@@ -0,0 +1,367 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Liam Girdwood <liam.r.girdwood@linux.intel.com>
+ */
+
+/*
+ * Loadable component modules. The host hands over the location of each
+ * module image at topology load time and the image stays in host memory
+ * until the first comp_new() of its component type. It is then fetched by
+ * DMA into the runtime heap, relocated, linked against the firmware export
+ * table below and its init function registers the component driver.
+ * Loaded modules stay resident.
+ */
+
+#include <sof/module.h>
+#include <sof/audio/component.h>
+#include <sof/alloc.h>
+#include <sof/dma.h>
+#include <sof/list.h>
+#include <sof/trace.h>
+#include <sof/wait.h>
+#include <arch/cache.h>
+#include <uapi/abi.h>
+#include <uapi/user/module.h>
+#include <errno.h>
+#include <stdint.h>
+
+#ifdef CONFIG_COMP_MODULES
+
+#define trace_module(__e, ...) \
+	trace_event(TRACE_CLASS_COMP, __e, ##__VA_ARGS__)
+#define trace_module_error(__e, ...) \
+	trace_error(TRACE_CLASS_COMP, __e, ##__VA_ARGS__)
+
+/* DMA timeout per page in microseconds */
+#define MODULE_COPY_TIMEOUT	1000
+
+/* largest zeroed area a module may ask for */
+#define MODULE_BSS_MAX		(64 * 1024)
+
+struct module_desc {
+	struct list_item list;
+	uint32_t comp_type;
+	uint32_t size;			/* image size in host memory */
+	struct dma_sg_config sg;	/* host pages holding the image */
+	void *mem;			/* loaded image, NULL until loaded */
+};
+
+struct module_export {
+	const char *name;
+	void *addr;
+};
+
+#define MODULE_EXPORT(sym)	{ #sym, (void *)&sym }
+
+#define MODULE_EXPORT_TRACE(n)				\
+	MODULE_EXPORT(_trace_event##n),			\
+	MODULE_EXPORT(_trace_event_atomic##n),		\
+	MODULE_EXPORT(_trace_event_mbox##n),		\
+	MODULE_EXPORT(_trace_event_mbox_atomic##n)
+
+/* firmware symbols modules can link against */
+static const struct module_export module_exports[] = {
+	MODULE_EXPORT(comp_register),
+	MODULE_EXPORT(comp_unregister),
+	MODULE_EXPORT(comp_set_state),
+	MODULE_EXPORT(comp_set_period_bytes),
+	MODULE_EXPORT(comp_update_buffer_produce),
+	MODULE_EXPORT(comp_update_buffer_consume),
+	MODULE_EXPORT(_malloc),
+	MODULE_EXPORT(_zalloc),
+	MODULE_EXPORT(_balloc),
+	MODULE_EXPORT(rfree),
+	MODULE_EXPORT(memcpy),
+	MODULE_EXPORT(memset),
+	MODULE_EXPORT(bzero),
+	MODULE_EXPORT_TRACE(0),
+	MODULE_EXPORT_TRACE(1),
+	MODULE_EXPORT_TRACE(2),
+	MODULE_EXPORT_TRACE(3),
+	MODULE_EXPORT_TRACE(4),
+};
+
+/* only used from IPC context, so no locking */
+static struct list_item module_list = {&module_list, &module_list};
+
+static struct module_desc *module_find(uint32_t comp_type)
+{
+	struct module_desc *mod;
+	struct list_item *mlist;
+
+	list_for_item(mlist, &module_list) {
+		mod = container_of(mlist, struct module_desc, list);
+		if (mod->comp_type == comp_type)
+			return mod;
+	}
+
+	return NULL;
+}
+
+int module_register(uint32_t comp_type, struct dma_sg_elem_array *elem_array,
+		    uint32_t size)
+{
+	struct module_desc *mod;
+
+	if (size < sizeof(struct sof_module_hdr)) {
+		trace_module_error("module: type %d invalid size %d",
+				   comp_type, size);
+		return -EINVAL;
+	}
+
+	/* a type can only be provided once */
+	if (module_find(comp_type)) {
+		trace_module_error("module: type %d already registered",
+				   comp_type);
+		return -EEXIST;
+	}
+
+	mod = rzalloc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM, sizeof(*mod));
+	if (!mod)
+		return -ENOMEM;
+
+	mod->comp_type = comp_type;
+	mod->size = size;
+	mod->sg.elem_array = *elem_array;
+
+	list_item_append(&mod->list, &module_list);
+
+	trace_module("module: type %d registered, %d bytes", comp_type, size);
+	return 0;
+}
+
+static void module_dma_complete(void *data, uint32_t type,
+				struct dma_sg_elem *next)
+{
+	completion_t *comp = (completion_t *)data;
+
+	if (type == DMA_IRQ_TYPE_LLIST)
+		wait_completed(comp);
+
+	next->size = DMA_RELOAD_END;
+}
+
+/* read the whole image from host memory, a page at a time */
+static int module_fetch(struct module_desc *mod, uint8_t *dest)
+{
+	struct dma_copy dc;
+	uint32_t offset = 0;
+	uint32_t size = mod->size;
+	int ret;
+
+	ret = dma_copy_new(&dc);
+	if (ret < 0)
+		return ret;
+
+	dma_set_cb(dc.dmac, dc.chan, DMA_IRQ_TYPE_LLIST, module_dma_complete,
+		   &dc.complete);
+	wait_init(&dc.complete);
+
+	while (size) {
+		wait_clear(&dc.complete);
+		dc.complete.timeout = MODULE_COPY_TIMEOUT;
+
+		ret = dma_copy_from_host_nowait(&dc, &mod->sg, offset,
+						dest + offset, size);
+		if (ret <= 0) {
+			ret = ret < 0 ? ret : -EINVAL;
+			break;
+		}
+
+#if !defined CONFIG_DMA_GW
+		if (wait_for_completion_timeout(&dc.complete) < 0) {
+			ret = -ETIME;
+			break;
+		}
+#endif
+
+		dcache_invalidate_region(dest + offset, ret);
+		offset += ret;
+		size -= ret;
+		ret = 0;
+	}
+
+	dma_copy_free(&dc);
+	return ret;
+}
+
+static void *module_symbol(const char *name)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(module_exports); i++)
+		if (!rstrcmp(module_exports[i].name, name))
+			return module_exports[i].addr;
+
+	return NULL;
+}
+
+/* patch every relocated word of the image copied to mem */
+static int module_relocate(struct sof_module_hdr *hdr, uint8_t *mem)
+{
+	struct sof_module_reloc *reloc;
+	struct sof_module_import *import;
+	uint32_t *word;
+	void *addr;
+	int i;
+
+	reloc = (struct sof_module_reloc *)((uint8_t *)(hdr + 1) +
+					    hdr->image_size);
+	import = (struct sof_module_import *)(reloc + hdr->reloc_count);
+
+	for (i = 0; i < hdr->reloc_count; i++, reloc++) {
+		if (reloc->offset > hdr->image_size - sizeof(*word) ||
+		    reloc->offset % sizeof(*word))
+			return -EINVAL;
+
+		word = (uint32_t *)(mem + reloc->offset);
+
+		switch (reloc->type) {
+		case SOF_MODULE_RELOC_BASE:
+			*word += (uint32_t)mem;
+			break;
+		case SOF_MODULE_RELOC_IMPORT:
+			if (reloc->import >= hdr->import_count)
+				return -EINVAL;
+
+			import[reloc->import].name[SOF_MODULE_NAME_SIZE - 1] =
+				'\0';
+			addr = module_symbol(import[reloc->import].name);
+			if (!addr) {
+				trace_module_error("module: type %d unresolved "
+						   "import %d",
+						   hdr->comp_type,
+						   reloc->import);
+				return -ENOENT;
+			}
+			*word = (uint32_t)addr;
+			break;
+		default:
+			return -EINVAL;
+		}
+	}
+
+	return 0;
+}
+
+static int module_check(struct module_desc *mod, struct sof_module_hdr *hdr)
+{
+	uint32_t tables;
+
+	if (hdr->magic != SOF_MODULE_MAGIC ||
+	    SOF_ABI_VERSION_INCOMPATIBLE(SOF_ABI_VERSION, hdr->abi) ||
+	    hdr->comp_type != mod->comp_type || hdr->size != mod->size)
+		return -EINVAL;
+
+	/* image, relocations and imports must fill the rest exactly */
+	if (hdr->reloc_count > mod->size / sizeof(struct sof_module_reloc) ||
+	    hdr->import_count > mod->size / sizeof(struct sof_module_import))
+		return -EINVAL;
+
+	tables = hdr->reloc_count * sizeof(struct sof_module_reloc) +
+		hdr->import_count * sizeof(struct sof_module_import);
+	if (hdr->image_size > mod->size - sizeof(*hdr) ||
+	    sizeof(*hdr) + hdr->image_size + tables != mod->size ||
+	    hdr->init_offset >= hdr->image_size ||
+	    hdr->bss_size > MODULE_BSS_MAX)
+		return -EINVAL;
+
+	return 0;
+}
+
+int module_load(uint32_t comp_type)
+{
+	struct module_desc *mod;
+	struct sof_module_hdr *hdr;
+	uint8_t *mem;
+	int (*init)(void);
+	int ret;
+
+	mod = module_find(comp_type);
+	if (!mod)
+		return -ENODEV;
+
+	/* loaded before, so its driver is gone or never registered */
+	if (mod->mem)
+		return -EINVAL;
+
+	trace_module("module: type %d load", comp_type);
+
+	hdr = rmalloc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM, mod->size);
+	if (!hdr)
+		return -ENOMEM;
+
+	ret = module_fetch(mod, (uint8_t *)hdr);
+	if (ret < 0) {
+		trace_module_error("module: type %d fetch failed %d",
+				   comp_type, ret);
+		goto out;
+	}
+
+	ret = module_check(mod, hdr);
+	if (ret < 0) {
+		trace_module_error("module: type %d invalid image", comp_type);
+		goto out;
+	}
+
+	/* only text, data and bss stay resident */
+	mem = rzalloc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM,
+		      hdr->image_size + hdr->bss_size);
+	if (!mem) {
+		ret = -ENOMEM;
+		goto out;
+	}
+
+	memcpy(mem, hdr + 1, hdr->image_size);
+
+	ret = module_relocate(hdr, mem);
+	if (ret < 0) {
+		trace_module_error("module: type %d relocation failed %d",
+				   comp_type, ret);
+		rfree(mem);
+		goto out;
+	}
+
+	/* make the code visible to instruction fetch */
+	dcache_writeback_region(mem, hdr->image_size);
+	icache_invalidate_region(mem, hdr->image_size);
+
+	mod->mem = mem;
+
+	init = (int (*)(void))(mem + hdr->init_offset);
+	ret = init();
+	if (ret < 0)
+		trace_module_error("module: type %d init failed %d",
+				   comp_type, ret);
+
+out:
+	rfree(hdr);
+	return ret;
+}
+
+#endif
@@ -42,8 +42,11 @@ void notifier_register(struct notifier *notifier)
 {
 	struct notify *notify = *arch_notify_get();
 
+	if (notifier->id >= NOTIFIER_ID_COUNT)
+		return;
+
 	spin_lock(&notify->lock);
-	list_item_prepend(&notifier->list, &notify->list);
+	list_item_prepend(&notifier->list, &notify->list[notifier->id]);
 	spin_unlock(&notify->lock);
 }
 
@@ -51,52 +54,86 @@ void notifier_unregister(struct notifier *notifier)
 {
 	struct notify *notify = *arch_notify_get();
 
+	if (notifier->id >= NOTIFIER_ID_COUNT)
+		return;
+
 	spin_lock(&notify->lock);
 	list_item_del(&notifier->list);
 	spin_unlock(&notify->lock);
 }
 
-void notifier_notify(void)
+/* only clients of this event id are walked, a client may unregister
+ * itself from its callback
+ */
+static void notifier_notify_local(struct notify *notify)
 {
-	struct notify *notify = *arch_notify_get();
 	struct list_item *wlist;
+	struct list_item *tlist;
 	struct notifier *n;
 
-	if (!list_is_empty(&notify->list)) {
-		dcache_invalidate_region(&_notify_data, sizeof(_notify_data));
-		dcache_invalidate_region(_notify_data.data,
-					 _notify_data.data_size);
-
-		/* iterate through notifiers and send event to
-		 * interested clients
-		 */
-		list_for_item(wlist, &notify->list) {
-			n = container_of(wlist, struct notifier, list);
-			if (n->id == _notify_data.id)
-				n->cb(_notify_data.message, n->cb_data,
-				      _notify_data.data);
-		}
+	list_for_item_safe(wlist, tlist, &notify->list[_notify_data.id]) {
+		n = container_of(wlist, struct notifier, list);
+		n->cb(_notify_data.message, n->cb_data, _notify_data.data);
 	}
 }
 
+/* IDC entry on the targeted remote cores */
+void notifier_notify(void)
+{
+	struct notify *notify = *arch_notify_get();
+
+	dcache_invalidate_region(&_notify_data, sizeof(_notify_data));
+
+	if (_notify_data.id >= NOTIFIER_ID_COUNT ||
+	    list_is_empty(&notify->list[_notify_data.id]))
+		return;
+
+	dcache_invalidate_region(_notify_data.data, _notify_data.data_size);
+	notifier_notify_local(notify);
+}
+
+/* cores in standby still track clock changes for their work queues */
+static inline int notifier_core_up(int core)
+{
+	return cpu_is_core_enabled(core) || cpu_is_core_standby(core);
+}
+
 void notifier_event(struct notify_data *notify_data)
 {
 	struct notify *notify = *arch_notify_get();
 	struct idc_msg notify_msg = { IDC_MSG_NOTIFY, IDC_MSG_NOTIFY_EXT };
+	uint32_t remote_mask;
 	int i = 0;
 
+	if (notify_data->id >= NOTIFIER_ID_COUNT)
+		return;
+
+	remote_mask = notify_data->target_core_mask &
+		~NOTIFIER_TARGET_CORE_MASK(cpu_get_id());
+
 	spin_lock(&notify->lock);
 
 	_notify_data = *notify_data;
-	dcache_writeback_region(_notify_data.data, _notify_data.data_size);
-	dcache_writeback_region(&_notify_data, sizeof(_notify_data));
+
+	/* the local core reads the event in place, only the cores woken
+	 * through IDC need it written back
+	 */
+	for (i = 0; i < PLATFORM_CORE_COUNT; i++) {
+		if ((remote_mask & (1 << i)) && notifier_core_up(i)) {
+			dcache_writeback_region(_notify_data.data,
+						_notify_data.data_size);
+			dcache_writeback_region(&_notify_data,
+						sizeof(_notify_data));
+			break;
+		}
+	}
 
 	/* notify selected targets */
 	for (i = 0; i < PLATFORM_CORE_COUNT; i++) {
 		if (_notify_data.target_core_mask & (1 << i)) {
 			if (i == cpu_get_id()) {
-				notifier_notify();
-			} else if (cpu_is_core_enabled(i)) {
+				notifier_notify_local(notify);
+			} else if (notifier_core_up(i)) {
 				notify_msg.core = i;
 				idc_send_msg(&notify_msg, IDC_BLOCKING);
 			}
@@ -109,17 +146,22 @@ void notifier_event(struct notify_data *notify_data)
 void init_system_notify(struct sof *sof)
 {
 	struct notify **notify = arch_notify_get();
+	int i;
+
 	*notify = rzalloc(RZONE_SYS, SOF_MEM_CAPS_RAM, sizeof(**notify));
 
-	list_init(&(*notify)->list);
+	for (i = 0; i < NOTIFIER_ID_COUNT; i++)
+		list_init(&(*notify)->list[i]);
 	spinlock_init(&(*notify)->lock);
 }
 
 void free_system_notify(void)
 {
 	struct notify *notify = *arch_notify_get();
+	int i;
 
 	spin_lock(&notify->lock);
-	list_item_del(&notify->list);
+	for (i = 0; i < NOTIFIER_ID_COUNT; i++)
+		list_item_del(&notify->list[i]);
 	spin_unlock(&notify->lock);
 }
@@ -41,56 +41,162 @@
 /** \brief Runtime power management data pointer. */
 static struct pm_runtime_data *prd;
 
+/**
+ * \brief Returns reference count of the device resource.
+ * \param[in] context Type of power management context.
+ * \param[in] index Index of the device.
+ * \return Reference count or NULL if the resource is not counted.
+ */
+static struct pm_runtime_ref *pm_runtime_ref_get(enum pm_runtime_context
+						 context, uint32_t index)
+{
+	/* L1 exit is a one shot request with no matching get */
+	if (context == PM_RUNTIME_HOST_DMA_L1 ||
+	    context >= PM_RUNTIME_CONTEXT_COUNT ||
+	    index >= PM_RUNTIME_MAX_INDEX)
+		return NULL;
+
+	return &prd->ref[context][index];
+}
+
+/**
+ * \brief Releases resources whose last user left PM_RUNTIME_PUT_DELAY ago.
+ * \param[in] data Unused.
+ * \param[in] delay Unused.
+ * \return Always 0, work is not rescheduled.
+ */
+static uint64_t pm_runtime_put_work(void *data, uint64_t delay)
+{
+	struct pm_runtime_ref *ref;
+	uint32_t flags;
+	int i;
+	int j;
+
+	spin_lock_irq(&prd->lock, flags);
+
+	for (i = 0; i < PM_RUNTIME_CONTEXT_COUNT; i++) {
+		for (j = 0; j < PM_RUNTIME_MAX_INDEX; j++) {
+			ref = &prd->ref[i][j];
+			if (!ref->pending)
+				continue;
+
+			ref->pending = 0;
+			if (!ref->count)
+				platform_pm_runtime_put(i, j, 0);
+		}
+	}
+
+	spin_unlock_irq(&prd->lock, flags);
+
+	return 0;
+}
+
 void pm_runtime_init(void)
 {
 	trace_pm("pm_runtime_init()");
 
-	prd = rzalloc(RZONE_SYS, SOF_MEM_CAPS_RAM, sizeof(*prd));
+	prd = rzalloc(RZONE_SYS | RZONE_FLAG_UNCACHED, SOF_MEM_CAPS_RAM,
+		      sizeof(*prd));
 	spinlock_init(&prd->lock);
+	work_init(&prd->put_work, pm_runtime_put_work, NULL, WORK_ASYNC);
 
 	platform_pm_runtime_init(prd);
 }
 
+/**
+ * \brief Takes device resource, platform is called for the first user only.
+ * \param[in] context Type of power management context.
+ * \param[in] index Index of the device.
+ * \param[in] flags Flags, set of RPM_...
+ */
+static void pm_runtime_ref_inc(enum pm_runtime_context context,
+			       uint32_t index, uint32_t flags)
+{
+	struct pm_runtime_ref *ref = pm_runtime_ref_get(context, index);
+	uint32_t irq_flags;
+
+	if (!ref) {
+		platform_pm_runtime_get(context, index, flags);
+		return;
+	}
+
+	spin_lock_irq(&prd->lock, irq_flags);
+
+	/* a deferred release still pending means the resource is active */
+	if (!ref->count++) {
+		if (ref->pending)
+			ref->pending = 0;
+		else
+			platform_pm_runtime_get(context, index, flags);
+	}
+
+	spin_unlock_irq(&prd->lock, irq_flags);
+}
+
+/**
+ * \brief Drops device resource, platform is called for the last user only.
+ * \param[in] context Type of power management context.
+ * \param[in] index Index of the device.
+ * \param[in] flags Flags, RPM_ASYNC defers the release.
+ */
+static void pm_runtime_ref_dec(enum pm_runtime_context context,
+			       uint32_t index, uint32_t flags)
+{
+	struct pm_runtime_ref *ref = pm_runtime_ref_get(context, index);
+	uint32_t irq_flags;
+
+	if (!ref) {
+		platform_pm_runtime_put(context, index, flags);
+		return;
+	}
+
+	spin_lock_irq(&prd->lock, irq_flags);
+
+	if (!ref->count) {
+		trace_pm_error("pm_runtime_put() error: context %d index %d "
+			       "not taken", context, index);
+		goto out;
+	}
+
+	if (--ref->count)
+		goto out;
+
+	if (flags & RPM_ASYNC) {
+		ref->pending = 1;
+		work_reschedule_default(&prd->put_work, PM_RUNTIME_PUT_DELAY);
+	} else {
+		ref->pending = 0;
+		platform_pm_runtime_put(context, index, flags);
+	}
+
+out:
+	spin_unlock_irq(&prd->lock, irq_flags);
+}
+
 void pm_runtime_get(enum pm_runtime_context context, uint32_t index)
 {
 	tracev_pm("pm_runtime_get()");
 
-	switch (context) {
-	default:
-		platform_pm_runtime_get(context, index, RPM_ASYNC);
-		break;
-	}
+	pm_runtime_ref_inc(context, index, RPM_ASYNC);
 }
 
 void pm_runtime_get_sync(enum pm_runtime_context context, uint32_t index)
 {
 	tracev_pm("pm_runtime_get_sync()");
 
-	switch (context) {
-	default:
-		platform_pm_runtime_get(context, index, 0);
-		break;
-	}
+	pm_runtime_ref_inc(context, index, 0);
 }
 
 void pm_runtime_put(enum pm_runtime_context context, uint32_t index)
 {
 	tracev_pm("pm_runtime_put()");
 
-	switch (context) {
-	default:
-		platform_pm_runtime_put(context, index, RPM_ASYNC);
-		break;
-	}
+	pm_runtime_ref_dec(context, index, RPM_ASYNC);
 }
 
 void pm_runtime_put_sync(enum pm_runtime_context context, uint32_t index)
 {
 	tracev_pm("pm_runtime_put_sync()");
 
-	switch (context) {
-	default:
-		platform_pm_runtime_put(context, index, 0);
-		break;
-	}
+	pm_runtime_ref_dec(context, index, 0);
 }
@@ -0,0 +1,355 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*
+ * Probe points mirror the data produced into pipeline buffers to a host
+ * extraction stream, so any buffer can be captured without changing the
+ * topology. Producers copy each period with a packet header into a local
+ * ring under the probe lock and a work item moves the ring to the host
+ * with DMA, much like DMA trace. Packets that don't fit are dropped whole,
+ * so the cost in the pipeline is bounded by one memcpy of the period.
+ */
+
+#include <stdint.h>
+#include <errno.h>
+#include <sof/sof.h>
+#include <sof/alloc.h>
+#include <sof/ipc.h>
+#include <sof/lock.h>
+#include <sof/probe.h>
+#include <sof/math/numbers.h>
+#include <arch/cache.h>
+#include <platform/platform.h>
+#include <platform/timer.h>
+
+static struct probe_data *probe_data;
+
+/* padding of packet data to a 4 byte multiple */
+static const uint32_t probe_pad;
+
+#if defined CONFIG_DMA_GW
+
+static int probe_dma_start(struct probe_data *d)
+{
+	struct dma_sg_config config;
+	uint32_t elem_size = sizeof(uint64_t) * 2;
+	int err;
+
+	err = dma_copy_set_stream_tag(&d->dc, d->stream_tag);
+	if (err < 0)
+		return err;
+
+	config.direction = DMA_DIR_LMEM_TO_HMEM;
+	config.src_width = sizeof(uint32_t);
+	config.dest_width = sizeof(uint32_t);
+	config.cyclic = 0;
+
+	err = dma_sg_alloc(&config.elem_array, RZONE_SYS, config.direction,
+			   PROBE_LOCAL_SIZE / elem_size, elem_size,
+			   (uint32_t)d->pb.addr, 0);
+	if (err < 0)
+		return err;
+
+	err = dma_set_config(d->dc.dmac, d->dc.chan, &config);
+	if (err < 0)
+		return err;
+
+	return dma_start(d->dc.dmac, d->dc.chan);
+}
+
+/* the gateway wraps in both buffers, ring data is already written back */
+static uint32_t probe_get_avail_data(struct probe_data *d, uint32_t avail)
+{
+	return avail;
+}
+
+#else
+
+static uint32_t probe_get_avail_data(struct probe_data *d, uint32_t avail)
+{
+	struct probe_buf *pb = &d->pb;
+	uint32_t size = avail;
+
+	/* host buffer wrap ? */
+	if (d->host_offset + size > d->host_size)
+		size = d->host_size - d->host_offset;
+
+	/* local buffer wrap ? */
+	if (pb->r_ptr + size > pb->end_addr)
+		size = pb->end_addr - pb->r_ptr;
+
+	return size;
+}
+
+#endif
+
+static uint64_t probe_work(void *data, uint64_t delay)
+{
+	struct probe_data *d = data;
+	struct probe_buf *pb = &d->pb;
+	unsigned long flags;
+	uint32_t avail;
+	int32_t size;
+
+	/* the previous copy is complete now, report where it ended */
+	if (d->old_host_offset != d->host_offset) {
+		ipc_probe_send_position(d);
+		d->old_host_offset = d->host_offset;
+	}
+
+	spin_lock_irq(&d->lock, flags);
+	avail = pb->avail;
+	spin_unlock_irq(&d->lock, flags);
+
+	size = probe_get_avail_data(d, avail);
+	if (!size)
+		return PROBE_PERIOD;
+
+	size = dma_copy_to_host_nowait(&d->dc, &d->config, d->host_offset,
+				       pb->r_ptr, size);
+	if (size < 0) {
+		trace_probe_error("probe_work() error: "
+				  "dma_copy_to_host_nowait() failed");
+		return PROBE_PERIOD;
+	}
+
+	/* update host pointer and check for wrap */
+	d->host_offset += size;
+	if (d->host_offset >= d->host_size)
+		d->host_offset -= d->host_size;
+
+	/* update local pointer and check for wrap */
+	pb->r_ptr += size;
+	if (pb->r_ptr >= pb->end_addr)
+		pb->r_ptr -= pb->size;
+
+	spin_lock_irq(&d->lock, flags);
+	pb->avail -= size;
+	spin_unlock_irq(&d->lock, flags);
+
+	/* drain data left behind by a wrap without waiting a period */
+	return (uint32_t)size < avail ? PROBE_PERIOD / 8 : PROBE_PERIOD;
+}
+
+static int probe_buffer_init(struct probe_data *d)
+{
+	struct probe_buf *pb = &d->pb;
+
+	pb->addr = rballoc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM | SOF_MEM_CAPS_DMA,
+			   PROBE_LOCAL_SIZE);
+	if (!pb->addr) {
+		trace_probe_error("probe_buffer_init() error: alloc failed");
+		return -ENOMEM;
+	}
+
+	bzero(pb->addr, PROBE_LOCAL_SIZE);
+	dcache_writeback_invalidate_region(pb->addr, PROBE_LOCAL_SIZE);
+
+	pb->size = PROBE_LOCAL_SIZE;
+	pb->w_ptr = pb->addr;
+	pb->r_ptr = pb->addr;
+	pb->end_addr = pb->addr + pb->size;
+	pb->avail = 0;
+
+	return 0;
+}
+
+int probe_init(uint32_t stream_tag, struct dma_sg_elem_array *elem_array,
+	       uint32_t host_size)
+{
+	struct probe_data *d = probe_data;
+	int err;
+
+	trace_probe("probe_init()");
+
+	if (d && d->enabled) {
+		trace_probe_error("probe_init() error: already enabled");
+		return -EBUSY;
+	}
+
+	/* allocated on first use and kept, producers may run on any core */
+	if (!d) {
+		d = rzalloc(RZONE_SYS | RZONE_FLAG_UNCACHED, SOF_MEM_CAPS_RAM,
+			    sizeof(*d));
+		if (!d)
+			return -ENOMEM;
+
+		spinlock_init(&d->lock);
+		dma_sg_init(&d->config.elem_array);
+		work_init(&d->work, probe_work, d, WORK_ASYNC);
+		probe_data = d;
+	}
+
+	d->stream_tag = stream_tag;
+	d->host_size = host_size;
+	d->host_offset = 0;
+	d->old_host_offset = 0;
+	if (elem_array)
+		d->config.elem_array = *elem_array;
+
+	err = dma_copy_new(&d->dc);
+	if (err < 0) {
+		trace_probe_error("probe_init() error: dma_copy_new() failed");
+		return err;
+	}
+
+	if (!d->pb.addr) {
+		err = probe_buffer_init(d);
+		if (err < 0)
+			return err;
+	}
+
+#if defined CONFIG_DMA_GW
+	err = probe_dma_start(d);
+	if (err < 0) {
+		trace_probe_error("probe_init() error: probe_dma_start() "
+				  "failed");
+		return err;
+	}
+#endif
+
+	d->enabled = 1;
+	work_schedule_default(&d->work, PROBE_PERIOD);
+
+	return 0;
+}
+
+int probe_point_set(struct comp_buffer *buffer, uint32_t enable)
+{
+	struct probe_data *d = probe_data;
+	uint32_t id = buffer->ipc_buffer.comp.id;
+	unsigned long flags;
+	uint32_t i;
+	int ret = 0;
+
+	trace_probe("probe_point_set(), id = %u, enable = %u", id, enable);
+
+	if (!d || !d->enabled) {
+		trace_probe_error("probe_point_set() error: no extraction "
+				  "stream");
+		return -ENODEV;
+	}
+
+	spin_lock_irq(&d->lock, flags);
+
+	for (i = 0; i < d->num_points; i++)
+		if (d->points[i] == id)
+			break;
+
+	if (enable) {
+		if (i == d->num_points) {
+			if (d->num_points == PROBE_MAX_POINTS) {
+				ret = -ENOSPC;
+				goto out;
+			}
+			d->points[d->num_points++] = id;
+		}
+	} else if (i < d->num_points) {
+		d->points[i] = d->points[--d->num_points];
+	}
+
+	buffer->probe = enable ? 1 : 0;
+
+out:
+	spin_unlock_irq(&d->lock, flags);
+
+	if (ret < 0)
+		trace_probe_error("probe_point_set() error: no free point");
+
+	return ret;
+}
+
+/* copy to the ring write pointer with wrap, caller has checked for room */
+static void probe_ring_write(struct probe_buf *pb, const void *src,
+			     uint32_t bytes)
+{
+	uint32_t n;
+
+	while (bytes) {
+		n = MIN(bytes, (uint32_t)(pb->end_addr - pb->w_ptr));
+		memcpy(pb->w_ptr, src, n);
+		dcache_writeback_region(pb->w_ptr, n);
+
+		pb->w_ptr += n;
+		if (pb->w_ptr >= pb->end_addr)
+			pb->w_ptr = pb->addr;
+
+		src = (const char *)src + n;
+		bytes -= n;
+	}
+}
+
+void probe_produce(struct comp_buffer *buffer, void *ptr, uint32_t bytes)
+{
+	struct probe_data *d = probe_data;
+	struct sof_ipc_probe_packet hdr;
+	struct probe_buf *pb;
+	unsigned long flags;
+	uint32_t pad = ((bytes + 3) & ~3) - bytes;
+	uint32_t total = sizeof(hdr) + bytes + pad;
+	uint32_t n;
+
+	if (!d || !d->enabled)
+		return;
+
+	pb = &d->pb;
+
+	hdr.magic = SOF_IPC_PROBE_MAGIC;
+	hdr.buffer_id = buffer->ipc_buffer.comp.id;
+	hdr.size = bytes;
+	hdr.timestamp = platform_timer_get(platform_timer);
+
+	spin_lock_irq(&d->lock, flags);
+
+	hdr.seq = d->seq++;
+
+	/* drop whole packets so the host never sees a torn one */
+	if (total > PROBE_MAX_PACKET || total > pb->size - pb->avail) {
+		d->dropped++;
+		goto out;
+	}
+
+	probe_ring_write(pb, &hdr, sizeof(hdr));
+
+	while (bytes) {
+		n = MIN(bytes, buffer_bytes_to_wrap(buffer, ptr));
+		probe_ring_write(pb, ptr, n);
+		ptr = buffer_wrap(buffer, (char *)ptr + n);
+		bytes -= n;
+	}
+
+	if (pad)
+		probe_ring_write(pb, &probe_pad, pad);
+
+	pb->avail += total;
+	d->packets++;
+
+out:
+	spin_unlock_irq(&d->lock, flags);
+}
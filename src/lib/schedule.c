@@ -40,6 +40,7 @@
 #include <sof/clk.h>
 #include <sof/schedule.h>
 #include <sof/work.h>
+#include <sof/timebase.h>
 #include <platform/timer.h>
 #include <platform/clk.h>
 #include <sof/audio/component.h>
@@ -48,13 +49,108 @@
 
 struct schedule_data {
 	spinlock_t lock;
-	struct list_item list;	/* list of tasks in priority queue */
+	/* queued tasks as a binary min heap, earliest task at index 0 */
+	struct task *queue[SCHEDULE_MAX_QUEUED_TASKS];
+	uint32_t queued;	/* number of tasks in queue */
 	uint32_t clock;
 	struct work work;
 };
 
 #define SLOT_ALIGN_TRIES	10
 
+/* latest time the task can be started and still meet its deadline */
+static inline uint64_t edf_latest_start(struct task *task)
+{
+	/* include the length of task in deadline calc */
+	return task->deadline - task->max_rtime;
+}
+
+/* run queue order - highest priority first, then earliest deadline */
+static inline int edf_task_before(struct task *a, struct task *b)
+{
+	if (a->priority != b->priority)
+		return a->priority < b->priority;
+
+	return edf_latest_start(a) < edf_latest_start(b);
+}
+
+static inline void edf_queue_set(struct schedule_data *sch, uint32_t idx,
+				 struct task *task)
+{
+	sch->queue[idx] = task;
+	task->queue_idx = idx;
+}
+
+/* move task towards the head of the queue - locks held by caller */
+static void edf_queue_sift_up(struct schedule_data *sch, uint32_t idx)
+{
+	struct task *task = sch->queue[idx];
+	uint32_t parent;
+
+	while (idx > 0) {
+		parent = (idx - 1) >> 1;
+		if (!edf_task_before(task, sch->queue[parent]))
+			break;
+
+		edf_queue_set(sch, idx, sch->queue[parent]);
+		idx = parent;
+	}
+
+	edf_queue_set(sch, idx, task);
+}
+
+/* move task towards the tail of the queue - locks held by caller */
+static void edf_queue_sift_down(struct schedule_data *sch, uint32_t idx)
+{
+	struct task *task = sch->queue[idx];
+	uint32_t child;
+
+	while ((child = (idx << 1) + 1) < sch->queued) {
+		/* pick the earlier of the two children */
+		if (child + 1 < sch->queued &&
+		    edf_task_before(sch->queue[child + 1], sch->queue[child]))
+			child++;
+
+		if (!edf_task_before(sch->queue[child], task))
+			break;
+
+		edf_queue_set(sch, idx, sch->queue[child]);
+		idx = child;
+	}
+
+	edf_queue_set(sch, idx, task);
+}
+
+/* add task to run queue - locks held by caller */
+static int edf_queue_insert(struct schedule_data *sch, struct task *task)
+{
+	if (sch->queued == SCHEDULE_MAX_QUEUED_TASKS)
+		return -ENOSPC;
+
+	edf_queue_set(sch, sch->queued++, task);
+	edf_queue_sift_up(sch, task->queue_idx);
+
+	return 0;
+}
+
+/* remove task from any position in run queue - locks held by caller */
+static void edf_queue_remove(struct schedule_data *sch, struct task *task)
+{
+	uint32_t idx = task->queue_idx;
+	struct task *last;
+
+	last = sch->queue[--sch->queued];
+	if (last == task)
+		return;
+
+	/* fill the hole with the last task and restore heap order */
+	edf_queue_set(sch, idx, last);
+	if (idx > 0 && edf_task_before(last, sch->queue[(idx - 1) >> 1]))
+		edf_queue_sift_up(sch, idx);
+	else
+		edf_queue_sift_down(sch, idx);
+}
+
 /*
  * Simple rescheduler to calculate tasks new start time and deadline if
  * prevoius deadline was missed. Tries to align at first with current task
@@ -83,81 +179,54 @@ static inline void edf_reschedule(struct task *task, uint64_t current)
 }
 
 /*
- * Find the first non running task with the earliest deadline.
+ * Find the queued task with the highest priority and earliest deadline.
+ * The run queue is kept ordered so this is the head of the queue unless
+ * the head has already missed its deadline, in which case it's rescheduled
+ * once and any further late tasks are cancelled.
  * TODO: Reduce cache invalidations by checking if the currently
  * running task AND the earliest queued task will both complete before their
  * deadlines. If so, then schedule the earlier queued task after the currently
  * running task has completed.
  */
-static inline struct task *edf_get_next(uint64_t current,
-	struct task *ignore)
+static inline struct task *edf_get_next(uint64_t current)
 {
 	struct schedule_data *sch = *arch_schedule_get();
 	struct task *task;
-	struct task *next_task = NULL;
-	struct list_item *clist;
-	struct list_item *tlist;
-	uint64_t next_delta = UINT64_MAX;
-	int next_priority = TASK_PRI_LOW;
-	uint64_t delta;
-	uint64_t deadline;
+	uint64_t latest;
 	int reschedule = 0;
- 
-	/* any tasks in the scheduler ? */
-	if (list_is_empty(&sch->list)) {
-		return NULL;
-	}
 
-	/* check every queued or running task in list */
-	list_for_item_safe(clist, tlist, &sch->list) {
-		task = container_of(clist, struct task, list);
-
-		/* only check queued tasks */
-		if (task->state != TASK_STATE_QUEUED)
-			continue;
-
-		/* ignore the ignored tasks */
-		if (task == ignore)
-			continue;
-
-		/* include the length of task in deadline calc */
-		deadline = task->deadline - task->max_rtime;
-
-		if (current < deadline) {
-			delta = deadline - current;
-
-			/* get highest priority */
-			if (task->priority < next_priority) {
-				next_priority = task->priority;
-				next_delta = delta;
-				next_task = task;
-			} else if (task->priority == next_priority) {
-				/* get earliest deadline */
-				if (delta < next_delta) {
-					next_delta = delta;
-					next_task = task;
-				}
-			}
-		} else {
-			/* missed scheduling - will be rescheduled */
+	while (sch->queued) {
+		task = sch->queue[0];
+		latest = edf_latest_start(task);
+
+		if (current < latest)
+			return task;
+
+		/* missed scheduling - will be rescheduled */
+		trace_pipe("edf_get_next(), "
+			   "missed scheduling - will be rescheduled");
+		edf_queue_remove(sch, task);
+
+		task->stats.missed++;
+		if (current - latest > task->stats.max_lateness)
+			task->stats.max_lateness = current - latest;
+
+		/* have we already tried to rescheule ? */
+		if (!reschedule) {
+			reschedule++;
 			trace_pipe("edf_get_next(), "
-				   "missed scheduling - will be rescheduled");
-
-			/* have we already tried to rescheule ? */
-			if (!reschedule) {
-				reschedule++;
-				trace_pipe("edf_get_next(), "
-					   "didnt tried to reschedule yet");
-				edf_reschedule(task, current);
-			} else {
-				/* reschedule failed */
-				list_item_del(&task->list);
-				task->state = TASK_STATE_CANCEL;
-			}
+				   "didnt tried to reschedule yet");
+			task->stats.rescheduled++;
+			edf_reschedule(task, current);
+			edf_queue_insert(sch, task);
+		} else {
+			/* reschedule failed */
+			task->stats.cancelled++;
+			task->state = TASK_STATE_CANCEL;
 		}
 	}
 
-	return next_task;
+	return NULL;
 }
 
 /* work set in the future when next task can be scheduled */
@@ -174,26 +243,38 @@ static uint64_t sch_work(void *data, uint64_t delay)
  * Schedule task with the earliest deadline from task list.
  * Can run in IRQ context.
  */
-static struct task *schedule_edf(void)
+static struct task * __hot_text schedule_edf(void)
 {
 	struct schedule_data *sch = *arch_schedule_get();
 	struct task *task;
 	struct task *future_task = NULL;
 	uint64_t current;
 	uint32_t flags;
+	int run;
 
 	tracev_pipe("schedule_edf()");
 
 	interrupt_clear(PLATFORM_SCHEDULE_IRQ);
 
-	while (!list_is_empty(&sch->list)) {
+	/* one timer read per pass, tasks are only started from here */
+	timebase_refresh();
+
+	while (sch->queued) {
 		spin_lock_irq(&sch->lock, flags);
 
 		/* get the current time */
-		current = platform_timer_get(platform_timer);
+		current = timebase_get();
 
 		/* get next task to be scheduled */
-		task = edf_get_next(current, NULL);
+		task = edf_get_next(current);
+
+		/* init task for running if it can be started now */
+		run = task && task->start <= current;
+		if (run) {
+			task->start = current;
+			task->state = TASK_STATE_PENDING;
+			edf_queue_remove(sch, task);
+		}
 		spin_unlock_irq(&sch->lock, flags);
 
 		/* any tasks ? */
@@ -201,17 +282,8 @@ static struct task *schedule_edf(void)
 			return NULL;
 
 		/* can task be started now ? */
-		if (task->start <= current) {
-			/* yes, run current task */
-			task->start = current;
-
-			/* init task for running */
-			spin_lock_irq(&sch->lock, flags);
-			task->state = TASK_STATE_PENDING;
-			list_item_del(&task->list);
-			spin_unlock_irq(&sch->lock, flags);
-
-			/* now run task at correct run level */
+		if (run) {
+			/* yes, now run task at correct run level */
 			if (run_task(task) < 0) {
 				trace_error(TRACE_CLASS_PIPE,
 					    "schedule_edf() error");
@@ -245,7 +317,7 @@ int schedule_task_cancel(struct task *task)
 	if (task->state == TASK_STATE_QUEUED) {
 		/* delete task */
 		task->state = TASK_STATE_CANCEL;
-		list_item_del(&task->list);
+		edf_queue_remove(sch, task);
 	}
 
 	spin_unlock_irq(&sch->lock, flags);
@@ -279,7 +351,7 @@ static int _schedule_task(struct task *task, uint64_t start, uint64_t deadline)
 	}
 
 	/* get the current time */
-	current = platform_timer_get(platform_timer);
+	current = timebase_get();
 
 	ticks_per_ms = clock_ms_to_ticks(sch->clock, 1);
 
@@ -293,8 +365,13 @@ static int _schedule_task(struct task *task, uint64_t start, uint64_t deadline)
 	/* calculate deadline - TODO: include MIPS */
 	task->deadline = task->start + ticks_per_ms * deadline / 1000;
 
-	/* add task to list */
-	list_item_append(&task->list, &sch->list);
+	/* add task to run queue */
+	if (edf_queue_insert(sch, task) < 0) {
+		trace_error(TRACE_CLASS_PIPE, "_schedule_task() error: "
+			    "run queue full");
+		spin_unlock_irq(&sch->lock, flags);
+		return 0;
+	}
 	task->state = TASK_STATE_QUEUED;
 	spin_unlock_irq(&sch->lock, flags);
 
@@ -388,6 +465,11 @@ static void scheduler_run(void *unused)
 
 	tracev_pipe("scheduler_run()");
 
+#ifdef CONFIG_IDLE_MANAGER
+	/* tasks must not run at the idle clock */
+	clock_idle_exit();
+#endif
+
 	/* EDF is only scheduler supported atm */
 	future_task = schedule_edf();
 	if (future_task)
@@ -395,35 +477,48 @@ static void scheduler_run(void *unused)
 					   future_task->start);
 }
 
+/* time until the earliest queued task start, UINT64_MAX if none queued */
+uint64_t schedule_next_wakeup_us(void)
+{
+	struct schedule_data *sch = *arch_schedule_get();
+	uint64_t current;
+	uint64_t start;
+	uint32_t flags;
+
+	spin_lock_irq(&sch->lock, flags);
+	start = sch->queued ? sch->queue[0]->start : UINT64_MAX;
+	spin_unlock_irq(&sch->lock, flags);
+
+	if (start == UINT64_MAX)
+		return start;
+
+	current = timebase_get();
+	if (start <= current)
+		return 0;
+
+	return (start - current) * 1000 / clock_ms_to_ticks(sch->clock, 1);
+}
+
 /* run the scheduler */
 void schedule(void)
 {
 	struct schedule_data *sch = *arch_schedule_get();
-	struct list_item *tlist;
-	struct task *task;
+	uint32_t queued;
 	uint32_t flags;
 
 	tracev_pipe("schedule()");
 
+	/* make sure we have a queued task first before we start scheduling
+	 * as contexts switches are not free.
+	 */
 	spin_lock_irq(&sch->lock, flags);
-
-	/* make sure we have a queued task in the list first before we
-	   start scheduling as contexts switches are not free. */
-	list_for_item(tlist, &sch->list) {
-		task = container_of(tlist, struct task, list);
-
-		/* schedule if we find any queued tasks */
-		if (task->state == TASK_STATE_QUEUED) {
-			spin_unlock_irq(&sch->lock, flags);
-			goto schedule;
-		}
-	}
+	queued = sch->queued;
+	spin_unlock_irq(&sch->lock, flags);
 
 	/* no task to schedule */
-	spin_unlock_irq(&sch->lock, flags);
-	return;
+	if (!queued)
+		return;
 
-schedule:
 	/* TODO: detect current IRQ context and call scheduler_run if both
 	 * current context matches scheduler context. saves a DSP context
 	 * switch.
@@ -444,7 +539,6 @@ int scheduler_init(struct sof *sof)
 	if (!*sch)
 		return -ENOMEM;
 
-	list_init(&((*sch)->list));
 	spinlock_init(&((*sch)->lock));
 	(*sch)->clock = PLATFORM_SCHED_CLOCK;
 	work_init(&((*sch)->work), sch_work, *sch, WORK_ASYNC);
@@ -476,7 +570,7 @@ void scheduler_free(void)
 	arch_free_tasks();
 
 	work_cancel_default(&(*sch)->work);
-	list_item_del(&(*sch)->list);
+	(*sch)->queued = 0;
 
 	spin_unlock_irq(&(*sch)->lock, flags);
 }
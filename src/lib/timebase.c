@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Liam Girdwood <liam.r.girdwood@linux.intel.com>
+ */
+
+#include <sof/timebase.h>
+#include <sof/clk.h>
+#include <sof/notifier.h>
+#include <platform/clk.h>
+#include <platform/platform.h>
+#include <sof/drivers/timer.h>
+#include <stdint.h>
+
+/* refresh pairs summed before the ratio is updated */
+#define TIMEBASE_CAL_MS		10
+
+/* longest extension of the cached value by the cycle counter */
+#define TIMEBASE_MAX_US		1000
+
+struct timebase timebase[PLATFORM_CORE_COUNT];
+
+uint64_t timebase_refresh(void)
+{
+	struct timebase *tb = &timebase[cpu_get_id()];
+	uint64_t now;
+	uint64_t ticks;
+	uint32_t cycles;
+	uint32_t flags;
+
+	flags = interrupt_global_disable();
+
+	cycles = arch_timer_get_cycles();
+	now = platform_timer_get(platform_timer);
+
+	/* the counter ran for the whole pair, add it to the calibration */
+	ticks = now - tb->now;
+	if (tb->valid && ticks < tb->cal_window) {
+		tb->cal_ticks += ticks;
+		tb->cal_cycles += cycles - tb->cycles;
+
+		if (tb->cal_ticks >= tb->cal_window) {
+			if (tb->cal_cycles)
+				tb->ticks_q16 = (tb->cal_ticks << 16) /
+					tb->cal_cycles;
+			tb->cal_ticks = 0;
+			tb->cal_cycles = 0;
+		}
+	}
+
+	tb->now = now;
+	tb->cycles = cycles;
+	tb->valid = tb->ticks_q16 != 0;
+
+	interrupt_global_enable(flags);
+
+	return now;
+}
+
+/* seed the ratio from the clock tables until calibration refines it */
+static void timebase_seed(struct timebase *tb, uint32_t cycles_per_ms)
+{
+	uint64_t ticks_per_ms = clock_ms_to_ticks(PLATFORM_SCHED_CLOCK, 1);
+	uint32_t flags;
+
+	flags = interrupt_global_disable();
+
+	tb->ticks_q16 = (ticks_per_ms << 16) / cycles_per_ms;
+	tb->max_cycles = (uint64_t)cycles_per_ms * TIMEBASE_MAX_US / 1000;
+	tb->cal_window = ticks_per_ms * TIMEBASE_CAL_MS;
+	tb->cal_ticks = 0;
+	tb->cal_cycles = 0;
+	tb->valid = 0;
+
+	interrupt_global_enable(flags);
+}
+
+static void timebase_clk_notify(int message, void *data, void *event_data)
+{
+	struct timebase *tb = data;
+
+	/* cycles no longer match the ratio until the new clock is seeded */
+	if (message == CLOCK_NOTIFY_PRE)
+		tb->valid = 0;
+	else
+		timebase_seed(tb, clock_ms_to_ticks(CLK_CPU(cpu_get_id()), 1));
+}
+
+void timebase_init(void)
+{
+	struct timebase *tb = &timebase[cpu_get_id()];
+
+	timebase_seed(tb, clock_ms_to_ticks(CLK_CPU(cpu_get_id()), 1));
+
+	tb->clk_notifier.cb = timebase_clk_notify;
+	tb->clk_notifier.cb_data = tb;
+	tb->clk_notifier.id = NOTIFIER_ID_CPU_FREQ;
+	notifier_register(&tb->clk_notifier);
+
+	timebase_refresh();
+}
@@ -33,21 +33,41 @@
 #include <sof/sof.h>
 #include <sof/alloc.h>
 #include <arch/cache.h>
+#include <sof/timebase.h>
 #include <platform/timer.h>
 #include <sof/lock.h>
 #include <sof/dma-trace.h>
 #include <sof/cpu.h>
 #include <sof/preproc.h>
+#include <sof/math/numbers.h>
+#include <uapi/ipc/trace.h>
+#include <errno.h>
 #include <stdint.h>
 
 struct trace {
 	uint32_t pos ;	/* trace position */
+	uint32_t wb_pos;	/* first mailbox byte not written back yet */
 	uint32_t enable;
 	spinlock_t lock;
 };
 
 static struct trace *trace;
 
+/* component specific trace level, takes precedence over its class level */
+struct trace_filter_comp {
+	uint32_t trace_class;
+	uint32_t comp_id;
+	uint32_t level;
+};
+
+/* everything is traced until the host sets a filter */
+uint8_t trace_filter_level[TRACE_FILTER_CLASSES] = {
+	[0 ... TRACE_FILTER_CLASSES - 1] = LOG_LEVEL_VERBOSE,
+};
+
+static struct trace_filter_comp trace_filter_comps[TRACE_FILTER_COMP_MAX];
+static uint32_t trace_filter_comp_count;
+
 /* calculates total message size, both header and payload in bytes */
 #define MESSAGE_SIZE(args_num)	\
 	(sizeof(struct log_entry_header) + args_num * sizeof(uint32_t))
@@ -62,6 +82,9 @@ static struct trace *trace;
 
 #define TRACE_ID_MASK ((1 << TRACE_ID_LENGTH) - 1)
 
+/* mailbox trace bytes collected before they are written back from cache */
+#define TRACE_MBOX_BATCH	256
+
 static void put_header(uint32_t *dst, uint32_t id_0, uint32_t id_1,
 		       uint32_t entry, uint64_t timestamp)
 {
@@ -76,30 +99,53 @@ static void put_header(uint32_t *dst, uint32_t id_0, uint32_t id_1,
 	memcpy(dst, &header, sizeof(header));
 }
 
-static void mtrace_event(const char *data, uint32_t length)
+/* write back mailbox trace written since the last write back */
+static void mtrace_writeback(void)
 {
-	volatile char *t;
-	uint32_t i, available;
+	if (trace->pos > trace->wb_pos)
+		dcache_writeback_region((void *)(MAILBOX_TRACE_BASE +
+					trace->wb_pos),
+					trace->pos - trace->wb_pos);
 
-	available = MAILBOX_TRACE_SIZE - trace->pos;
+	trace->wb_pos = trace->pos;
+}
 
-	t = (volatile char *)(MAILBOX_TRACE_BASE);
+/*
+ * Entries are whole words so they are copied a word at a time, and the
+ * cache is written back once per TRACE_MBOX_BATCH bytes or on wrap.
+ */
+static void mtrace_event(const char *data, uint32_t length)
+{
+	volatile uint32_t *t = (volatile uint32_t *)MAILBOX_TRACE_BASE;
+	const uint32_t *src = (const uint32_t *)data;
+	uint32_t words = length / sizeof(uint32_t);
+	uint32_t available;
+	uint32_t i;
+	uint32_t n;
 
-	/* write until we run out of space */
-	for (i = 0; i < available && i < length; i++)
-		t[trace->pos + i] = data[i];
+	available = (MAILBOX_TRACE_SIZE - trace->pos) / sizeof(uint32_t);
+	n = MIN(words, available);
 
-	dcache_writeback_region((void *)&t[trace->pos], i);
-	trace->pos += length;
+	/* write until we run out of space */
+	t += trace->pos / sizeof(uint32_t);
+	for (i = 0; i < n; i++)
+		t[i] = src[i];
+	trace->pos += n * sizeof(uint32_t);
 
 	/* if there was more data than space available, wrap back */
-	if (length > available) {
-		for (i = 0; i < length - available; i++)
-			t[i] = data[available + i];
+	if (words > n) {
+		mtrace_writeback();
+
+		t = (volatile uint32_t *)MAILBOX_TRACE_BASE;
+		for (i = 0; i < words - n; i++)
+			t[i] = src[n + i];
 
-		dcache_writeback_region((void *)t, i);
-		trace->pos = i;
+		trace->wb_pos = 0;
+		trace->pos = i * sizeof(uint32_t);
 	}
+
+	if (trace->pos - trace->wb_pos >= TRACE_MBOX_BATCH)
+		mtrace_writeback();
 }
 
 #define _TRACE_EVENT_NTH_IMPL_PAYLOAD_STEP(i, _)	\
@@ -127,7 +173,7 @@ META_IF_ELSE(is_atomic)(_atomic)()					\
 		return;							\
 									\
 	put_header(dt, id_0, id_1, log_entry,				\
-		   platform_timer_get(platform_timer));			\
+		   timebase_get());					\
 									\
 	_TRACE_EVENT_NTH_PAYLOAD_IMPL(arg_count)			\
 	META_IF_ELSE(is_atomic)						\
@@ -216,6 +262,9 @@ void trace_flush(void)
 {
 	volatile uint64_t *t;
 
+	/* make batched mailbox trace visible to the host */
+	mtrace_writeback();
+
 	/* get mailbox position */
 	t = (volatile uint64_t *)(MAILBOX_TRACE_BASE + trace->pos);
 
@@ -223,6 +272,120 @@ void trace_flush(void)
 	dma_trace_flush((void *)t);
 }
 
+#define TRACE_FILTER_IDX(trace_class) \
+	(((trace_class) >> TRACE_CLASS_SHIFT) & (TRACE_FILTER_CLASSES - 1))
+
+/* slow path, only taken for classes with component overrides */
+int trace_filter_comp(uint32_t level, uint32_t trace_class, uint32_t comp_id)
+{
+	uint32_t i;
+
+	for (i = 0; i < trace_filter_comp_count; i++) {
+		if (trace_filter_comps[i].trace_class == trace_class &&
+		    trace_filter_comps[i].comp_id == comp_id)
+			return level <= trace_filter_comps[i].level;
+	}
+
+	return level <= (trace_filter_level[TRACE_FILTER_IDX(trace_class)] &
+			 ~TRACE_FILTER_COMP);
+}
+
+/* drop all component overrides of a class */
+static void trace_filter_class_reset(uint32_t trace_class)
+{
+	uint32_t i = 0;
+
+	while (i < trace_filter_comp_count) {
+		if (trace_filter_comps[i].trace_class == trace_class)
+			trace_filter_comps[i] =
+				trace_filter_comps[--trace_filter_comp_count];
+		else
+			i++;
+	}
+
+	trace_filter_level[TRACE_FILTER_IDX(trace_class)] &=
+		~TRACE_FILTER_COMP;
+}
+
+static int trace_filter_comp_set(uint32_t trace_class, uint32_t comp_id,
+				 uint32_t level)
+{
+	struct trace_filter_comp *comp = NULL;
+	uint32_t i;
+
+	for (i = 0; i < trace_filter_comp_count; i++) {
+		if (trace_filter_comps[i].trace_class == trace_class &&
+		    trace_filter_comps[i].comp_id == comp_id) {
+			comp = &trace_filter_comps[i];
+			break;
+		}
+	}
+
+	if (!comp) {
+		if (trace_filter_comp_count == TRACE_FILTER_COMP_MAX)
+			return -ENOMEM;
+		comp = &trace_filter_comps[trace_filter_comp_count++];
+	}
+
+	comp->trace_class = trace_class;
+	comp->comp_id = comp_id;
+	comp->level = level;
+
+	trace_filter_level[TRACE_FILTER_IDX(trace_class)] |= TRACE_FILTER_COMP;
+
+	return 0;
+}
+
+/*
+ * Apply host trace filter. An element with comp_id -1 sets the level of
+ * the whole class and drops its component overrides, otherwise the level
+ * only applies to the given component of the class.
+ */
+int trace_filter_update(const struct sof_ipc_trace_filter *filter)
+{
+	const struct sof_ipc_trace_filter_elem *elem;
+	uint32_t idx;
+	uint32_t i;
+	int ret = 0;
+
+	if (filter->hdr.size < sizeof(*filter) ||
+	    filter->elem_cnt > (filter->hdr.size - sizeof(*filter)) /
+	    sizeof(*elem))
+		return -EINVAL;
+
+	for (i = 0; i < filter->elem_cnt; i++) {
+		elem = &filter->elems[i];
+
+		if (elem->level > LOG_LEVEL_VERBOSE ||
+		    elem->trace_class & ((1 << TRACE_CLASS_SHIFT) - 1) ||
+		    (elem->trace_class >> TRACE_CLASS_SHIFT) >=
+		    TRACE_FILTER_CLASSES) {
+			ret = -EINVAL;
+			break;
+		}
+
+		if (elem->comp_id < 0) {
+			trace_filter_class_reset(elem->trace_class);
+			idx = TRACE_FILTER_IDX(elem->trace_class);
+			trace_filter_level[idx] = elem->level;
+		} else {
+			ret = trace_filter_comp_set(elem->trace_class,
+						    elem->comp_id,
+						    elem->level);
+			if (ret < 0)
+				break;
+		}
+	}
+
+	/* other cores read the filter through their own cache */
+	dcache_writeback_region(trace_filter_level,
+				sizeof(trace_filter_level));
+	dcache_writeback_region(trace_filter_comps,
+				sizeof(trace_filter_comps));
+
+	return ret;
+}
+
 void trace_off(void)
 {
 	trace->enable = 0;
@@ -236,6 +399,7 @@ void trace_init(struct sof *sof)
 			sizeof(*trace));
 	trace->enable = 1;
 	trace->pos = 0;
+	trace->wb_pos = 0;
 	spinlock_init(&trace->lock);
 
 	bzero((void *)MAILBOX_TRACE_BASE, MAILBOX_TRACE_SIZE);
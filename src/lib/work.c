@@ -40,9 +40,14 @@
 #include <sof/debug.h>
 #include <sof/cpu.h>
 #include <sof/atomic.h>
+#include <sof/idc.h>
+#include <sof/interrupt.h>
+#include <arch/cache.h>
 #include <platform/clk.h>
+#include <platform/idc.h>
 #include <platform/platform.h>
 #include <limits.h>
+#include <errno.h>
 
 /*
  * Generic delayed work queue support.
@@ -59,8 +64,41 @@
  * The generic work queues are intended to stay in time synchronisation with
  * any CPU clock changes. i.e. timeouts will remain constant regardless of CPU
  * frequency changes.
+ *
+ * Work can also be handed to the system work queue of another core, so it
+ * runs where its data is cache hot. Each source and target core pair has a
+ * single producer ring in uncached shared memory, the target is woken by an
+ * IDC message and schedules everything queued for it.
+ *
+ * Background work with no timing needs goes to a pool shared by all cores
+ * instead. Each core takes one item from the pool per pass of its idle loop,
+ * where interrupts and scheduled tasks preempt it, and cores with nothing to
+ * do are woken by IDC to steal from it.
  */
 
+/* cross core submissions queued per source core, power of 2 */
+#define WORK_INBOX_SIZE		8
+
+/* source core to target core ring, needs no lock with one producer */
+struct work_inbox {
+	struct work *volatile work[WORK_INBOX_SIZE];
+	volatile uint64_t timeout[WORK_INBOX_SIZE];
+	volatile uint32_t head;		/* advanced by the target core */
+	volatile uint32_t tail;		/* advanced by the source core */
+};
+
+/* background work pool slots, power of 2 */
+#define WORK_POOL_SIZE		16
+
+/* background work taken by any core */
+struct work_pool {
+	spinlock_t lock;
+	struct work *work[WORK_POOL_SIZE];
+	uint32_t head;
+	uint32_t tail;
+	uint32_t idle_mask;		/* cores waiting for pool work */
+};
+
 struct work_queue {
 	struct list_item work;		/* list of work */
 	uint64_t timeout;		/* timeout for next queue run */
@@ -79,6 +117,13 @@ struct work_queue_shared_context {
 
 	/* registered timers */
 	struct timer *timers[PLATFORM_CORE_COUNT];
+
+	/* cross core work, indexed by target then source core */
+	struct work_inbox inbox[PLATFORM_CORE_COUNT][PLATFORM_CORE_COUNT];
+	/* IDC sent and target not yet draining */
+	volatile uint32_t inbox_notify[PLATFORM_CORE_COUNT];
+
+	struct work_pool pool;
 };
 
 static struct work_queue_shared_context *work_shared_ctx;
@@ -123,6 +168,13 @@ static inline void work_clear_timer(struct work_queue *queue)
 	}
 }
 
+/* work due within its slack runs now rather than keeping the timer armed */
+static inline uint64_t work_slack_ticks(struct work_queue *queue,
+					struct work *work)
+{
+	return queue->ticks_per_msec * work->slack / 1000;
+}
+
 /* is there any work pending in the current time window ? */
 static int is_work_pending(struct work_queue *queue)
 {
@@ -130,6 +182,7 @@ static int is_work_pending(struct work_queue *queue)
 	struct work *work;
 	uint64_t win_end;
 	uint64_t win_start;
+	uint64_t early;
 	int pending_count = 0;
 
 	/* get the current valid window of work */
@@ -143,9 +196,11 @@ static int is_work_pending(struct work_queue *queue)
 		list_for_item(wlist, &queue->work) {
 
 			work = container_of(wlist, struct work, list);
+			early = work_slack_ticks(queue, work);
 
 			/* if work has timed out then mark it as pending to run */
-			if (work->timeout >= win_start && work->timeout <= win_end) {
+			if (work->timeout >= win_start &&
+			    work->timeout <= win_end + early) {
 				work->pending = 1;
 				pending_count++;
 			} else {
@@ -158,9 +213,10 @@ static int is_work_pending(struct work_queue *queue)
 		list_for_item(wlist, &queue->work) {
 
 			work = container_of(wlist, struct work, list);
+			early = work_slack_ticks(queue, work);
 
 			/* if work has timed out then mark it as pending to run */
-			if (work->timeout <= win_end ||
+			if (work->timeout <= win_end + early ||
 				(work->timeout >= win_start &&
 				work->timeout < ULONG_LONG_MAX)) {
 				work->pending = 1;
@@ -198,6 +254,7 @@ static void run_work(struct work_queue *queue, uint32_t *flags)
 	struct work *work;
 	uint64_t reschedule_usecs;
 	uint64_t udelay;
+	uint64_t now;
 	int cpu = cpu_get_id();
 
 	/* check each work item in queue for pending */
@@ -208,8 +265,11 @@ static void run_work(struct work_queue *queue, uint32_t *flags)
 		/* run work if its pending and remove from the queue */
 		if (work->pending) {
 
-			udelay = ((work_get_timer(queue) - work->timeout) /
-				queue->ticks_per_msec) * 1000;
+			/* no delay for work run early within its slack */
+			now = work_get_timer(queue);
+			udelay = now > work->timeout ?
+				((now - work->timeout) /
+				 queue->ticks_per_msec) * 1000 : 0;
 
 			/* work can run in non atomic context */
 			spin_unlock_irq(&queue->lock, *flags);
@@ -483,6 +543,187 @@ void work_cancel_default(struct work *w)
 	work_cancel(*arch_work_queue_get(), w);
 }
 
+/*
+ * Queue work for the system work queue of core. The work is written back
+ * here and read by the target, so the caller must not touch it until it
+ * has run. Slave cores only take IDC from the master core, so one side has
+ * to be the master core.
+ */
+int work_schedule_on_core(int core, struct work *w, uint64_t timeout)
+{
+	struct idc_msg work_msg = { IDC_MSG_WORK, IDC_MSG_WORK_EXT, core };
+	struct work_inbox *inbox;
+	uint32_t flags;
+	uint32_t tail;
+	int ret = 0;
+
+	if (core == cpu_get_id()) {
+		work_schedule_default(w, timeout);
+		return 0;
+	}
+
+	if (core >= PLATFORM_CORE_COUNT || !cpu_is_core_enabled(core) ||
+	    (core != PLATFORM_MASTER_CORE_ID &&
+	     cpu_get_id() != PLATFORM_MASTER_CORE_ID))
+		return -EINVAL;
+
+	inbox = &work_shared_ctx->inbox[core][cpu_get_id()];
+
+	/* local interrupts are the only other producer on this ring */
+	flags = interrupt_global_disable();
+
+	tail = inbox->tail;
+	if (tail - inbox->head == WORK_INBOX_SIZE) {
+		interrupt_global_enable(flags);
+		return -EBUSY;
+	}
+
+	dcache_writeback_invalidate_region(w, sizeof(*w));
+
+	inbox->work[tail & (WORK_INBOX_SIZE - 1)] = w;
+	inbox->timeout[tail & (WORK_INBOX_SIZE - 1)] = timeout;
+	inbox->tail = tail + 1;
+
+	interrupt_global_enable(flags);
+
+	/* target clears the flag before draining, so it can't miss us */
+	if (!work_shared_ctx->inbox_notify[core]) {
+		work_shared_ctx->inbox_notify[core] = 1;
+		ret = idc_send_msg(&work_msg, IDC_BLOCKING);
+	}
+
+	return ret;
+}
+
+void work_inbox_drain(void)
+{
+	struct work_inbox *inbox;
+	struct work *w;
+	uint32_t head;
+	int core = cpu_get_id();
+	int i;
+
+	work_shared_ctx->inbox_notify[core] = 0;
+
+	for (i = 0; i < PLATFORM_CORE_COUNT; i++) {
+		inbox = &work_shared_ctx->inbox[core][i];
+
+		for (head = inbox->head; head != inbox->tail; head++) {
+			w = inbox->work[head & (WORK_INBOX_SIZE - 1)];
+
+			/* keeps our copy if the work is already queued here */
+			dcache_writeback_invalidate_region(w, sizeof(*w));
+
+			work_schedule_default(w, inbox->timeout[head &
+						(WORK_INBOX_SIZE - 1)]);
+			inbox->head = head + 1;
+		}
+	}
+}
+
+/*
+ * Wake an idle core for the pool. Slave cores only take IDC from the master
+ * core, so work submitted on a slave core can only wake the master core,
+ * otherwise it waits for a core to pass through its idle loop.
+ */
+static int work_pool_wake(uint32_t idle_mask)
+{
+	struct idc_msg work_msg = { IDC_MSG_WORK, IDC_MSG_WORK_EXT };
+	int core;
+
+	for (core = 0; core < PLATFORM_CORE_COUNT; core++) {
+		if (!(idle_mask & (1 << core)) || core == cpu_get_id())
+			continue;
+
+		if (cpu_get_id() != PLATFORM_MASTER_CORE_ID &&
+		    core != PLATFORM_MASTER_CORE_ID)
+			continue;
+
+		/* cores in standby are booted and idle, so they help too */
+		if (!cpu_is_core_enabled(core) && !cpu_is_core_standby(core))
+			continue;
+
+		work_msg.core = core;
+		return idc_send_msg(&work_msg, IDC_BLOCKING);
+	}
+
+	return 0;
+}
+
+/*
+ * Queue work to run once on whichever core is idle first. The callback
+ * return value is ignored and the work and its data must not be touched by
+ * the caller until it has run.
+ */
+int work_submit_background(struct work *w)
+{
+	struct work_pool *pool = &work_shared_ctx->pool;
+	uint32_t idle_mask;
+	uint32_t flags;
+
+	spin_lock_irq(&pool->lock, flags);
+
+	if (pool->tail - pool->head == WORK_POOL_SIZE) {
+		spin_unlock_irq(&pool->lock, flags);
+		return -EBUSY;
+	}
+
+	dcache_writeback_invalidate_region(w, sizeof(*w));
+
+	pool->work[pool->tail & (WORK_POOL_SIZE - 1)] = w;
+	pool->tail++;
+
+	/* the woken core takes the work, so don't wake it again */
+	idle_mask = pool->idle_mask;
+	pool->idle_mask = 0;
+
+	spin_unlock_irq(&pool->lock, flags);
+
+	return work_pool_wake(idle_mask);
+}
+
+void work_background_run(void)
+{
+	struct work_pool *pool = &work_shared_ctx->pool;
+	struct work *w = NULL;
+	uint32_t flags;
+
+	spin_lock_irq(&pool->lock, flags);
+
+	if (pool->head != pool->tail) {
+		w = pool->work[pool->head & (WORK_POOL_SIZE - 1)];
+		pool->head++;
+	} else {
+		pool->idle_mask |= 1 << cpu_get_id();
+	}
+
+	spin_unlock_irq(&pool->lock, flags);
+
+	if (!w)
+		return;
+
+	dcache_invalidate_region(w, sizeof(*w));
+	w->cb(w->cb_data, 0);
+}
+
+/* time until the next queue run on this core, UINT64_MAX if no work */
+uint64_t work_next_wakeup_us(void)
+{
+	struct work_queue *queue = *arch_work_queue_get();
+	uint64_t current;
+	uint64_t next;
+
+	if (!queue || !atomic_read(&queue->num_work))
+		return UINT64_MAX;
+
+	current = work_get_timer(queue);
+	next = work_shared_ctx->last_tick;
+	if (next <= current)
+		return 0;
+
+	return (next - current) * 1000 / queue->ticks_per_msec;
+}
+
 struct work_queue *work_new_queue(struct work_queue_timesource *ts)
 {
 	struct work_queue *queue;
@@ -525,6 +766,7 @@ void init_system_workq(struct work_queue_timesource *ts)
 					  sizeof(*work_shared_ctx));
 		atomic_init(&work_shared_ctx->total_num_work, 0);
 		atomic_init(&work_shared_ctx->timer_clients, 0);
+		spinlock_init(&work_shared_ctx->pool.lock);
 	}
 }
 
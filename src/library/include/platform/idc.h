@@ -31,9 +31,16 @@
 #ifndef __INCLUDE_LIB_PLATFORM_IDC_H__
 #define __INCLUDE_LIB_PLATFORM_IDC_H__
 
-static inline int idc_send_msg(struct idc_msg *msg, uint32_t mode)
+#include <errno.h>
+
+/* messages run on the thread of the emulated core, see src/host/smp.c */
+int idc_send_msg(struct idc_msg *msg, uint32_t mode);
+
+static inline int idc_send_msg_async(struct idc_msg *msg,
+				     void (*cb)(void *data, int ret),
+				     void *cb_data)
 {
-	return 0;
+	return -ENODEV;
 }
 
 static inline void idc_process_msg_queue(void)
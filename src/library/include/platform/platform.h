@@ -67,6 +67,10 @@
 /* DSP default delay in cycles */
 #define PLATFORM_DEFAULT_DELAY	12
 
+/* host library emulates the cores with one thread each */
+#define PLATFORM_CORE_COUNT	4
+#define PLATFORM_MASTER_CORE_ID	0
+
 static inline void platform_panic(uint32_t p) {}
 
 extern struct timer *platform_timer;
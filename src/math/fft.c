@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2018, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <sof/audio/format.h>
+#include <sof/math/trig.h>
+#include <sof/math/fft.h>
+
+void fft_init_twiddle(struct icomplex32 *twiddle, int size)
+{
+	int32_t w;
+	int k;
+
+	/* W(k) = cos(2 pi k / size) - j sin(2 pi k / size), angle is Q4.28 */
+	for (k = 0; k < size / 2; k++) {
+		w = (int32_t)(((int64_t)PI_MUL2_Q4_28 * k) / size);
+		twiddle[k].real = sin_fixed(w + PI_DIV2_Q4_28);
+		twiddle[k].imag = -sin_fixed(w);
+	}
+}
+
+/* Reorder data to bit reversed index order for the decimation in time */
+static void fft_bit_reverse(struct icomplex32 *buf, int size)
+{
+	struct icomplex32 tmp;
+	int i;
+	int j = 0;
+	int m;
+
+	for (i = 0; i < size - 1; i++) {
+		if (i < j) {
+			tmp = buf[i];
+			buf[i] = buf[j];
+			buf[j] = tmp;
+		}
+
+		m = size >> 1;
+		while (m <= j) {
+			j -= m;
+			m >>= 1;
+		}
+		j += m;
+	}
+}
+
+void fft_execute(struct icomplex32 *buf, const struct icomplex32 *twiddle,
+		 int size, bool ifft)
+{
+	struct icomplex32 *a;
+	struct icomplex32 *b;
+	int64_t tr;
+	int64_t ti;
+	int64_t ar;
+	int64_t ai;
+	int32_t wr;
+	int32_t wi;
+	int half;
+	int step;
+	int len;
+	int i;
+	int j;
+
+	fft_bit_reverse(buf, size);
+
+	for (len = 2; len <= size; len <<= 1) {
+		half = len >> 1;
+		step = size / len;
+		for (j = 0; j < half; j++) {
+			/* Inverse transform uses conjugate twiddle factors */
+			wr = twiddle[j * step].real;
+			wi = ifft ? -twiddle[j * step].imag :
+				twiddle[j * step].imag;
+			for (i = j; i < size; i += len) {
+				a = &buf[i];
+				b = &buf[i + half];
+
+				/* Q1.31 x Q1.31 -> Q2.62 -> Q2.31, the product
+				 * is kept in 64 bits since it may exceed Q1.31.
+				 */
+				tr = Q_SHIFT_RND((int64_t)b->real * wr -
+						 (int64_t)b->imag * wi, 62, 31);
+				ti = Q_SHIFT_RND((int64_t)b->real * wi +
+						 (int64_t)b->imag * wr, 62, 31);
+				ar = a->real;
+				ai = a->imag;
+
+				if (ifft) {
+					a->real = sat_int32(ar + tr);
+					a->imag = sat_int32(ai + ti);
+					b->real = sat_int32(ar - tr);
+					b->imag = sat_int32(ai - ti);
+				} else {
+					/* Scale every stage by 1/2 */
+					a->real = sat_int32((ar + tr) >> 1);
+					a->imag = sat_int32((ai + ti) >> 1);
+					b->real = sat_int32((ar - tr) >> 1);
+					b->imag = sat_int32((ai - ti) >> 1);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,299 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Seppo Ingalsuo <seppo.ingalsuo@linux.intel.com>
+ */
+
+#include <stdint.h>
+#include <sof/audio/format.h>
+#include <sof/math/numbers.h>
+#include <sof/math/fixed.h>
+
+#if defined(__XCC__)
+#include <xtensa/config/core-isa.h>
+#if XCHAL_HAVE_HIFI3
+#include <xtensa/tie/xt_hifi3.h>
+#endif
+#endif
+
+/* Chebyshev fits as Q2.30 polynomials of a Q1.31 fraction 0 <= f < 1,
+ * max error of log2(1 + f) is 2.5e-6 and of 2^f is 3e-9.
+ */
+#define LOG2_ORDER 6
+#define EXP2_ORDER 6
+
+static const int32_t log2_coef[LOG2_ORDER + 1] = {
+	2624, 1548822680, -770208733, 488024777,
+	-292806781, 126286087, -26380263
+};
+
+static const int32_t exp2_coef[EXP2_ORDER + 1] = {
+	1073741827, 744260852, 257945486, 59571873,
+	10398316, 1330509, 234782
+};
+
+#define LOG2_10_DIV20_Q1_31 356689313 /* log2(10)/20 */
+#define DB_PER_LOG2_Q4_28 1616142483 /* 20/log2(10) */
+
+/* Newton-Raphson seed 48/17 - 32/17 * m for 0.5 <= m < 1, Q3.29 */
+#define INV_SEED_C0_Q3_29 1515870810
+#define INV_SEED_C1_Q3_29 1010580540
+#define INV_ITERATIONS 3
+
+static inline int32_t poly_q30(const int32_t *c, int order, int32_t f)
+{
+	int32_t acc = c[order];
+	int k;
+
+	for (k = order - 1; k >= 0; k--)
+		acc = c[k] + (int32_t)(((int64_t)acc * f) >> 31);
+
+	return acc;
+}
+
+/* Splits x > 0 into exponent e and fraction f with x = 2^e * (1 + f) */
+static inline int log2_split(int32_t x, int32_t *f)
+{
+	int s = norm_int32(x);
+
+	*f = (int32_t)(((uint32_t)x << (s + 1)) - 0x80000000u);
+	return 30 - s - 16;
+}
+
+static inline int32_t log2_join(int e, int32_t p)
+{
+	return (e << 16) + Q_SHIFT_RND(p, 30, 16);
+}
+
+/* Splits x into integer part i and Q1.31 fraction f with x = i + f */
+static inline int exp2_split(int32_t x, int32_t *f)
+{
+	*f = (x & 0xffff) << 15;
+	return x >> 16;
+}
+
+static inline int32_t exp2_join(int i, int32_t p)
+{
+	int shift = 14 - i;
+
+	if (shift < 0)
+		return shift < -2 ? INT32_MAX : sat_int32((int64_t)p << -shift);
+
+	if (shift > 31)
+		return 0;
+
+	return (int32_t)(((int64_t)p + ((int64_t)1 << shift >> 1)) >> shift);
+}
+
+int32_t log2_fixed(int32_t x)
+{
+	int32_t f;
+	int e;
+
+	if (x <= 0)
+		return INT32_MIN;
+
+	e = log2_split(x, &f);
+	return log2_join(e, poly_q30(log2_coef, LOG2_ORDER, f));
+}
+
+int32_t exp2_fixed(int32_t x)
+{
+	int32_t f;
+	int i;
+
+	i = exp2_split(x, &f);
+	return exp2_join(i, poly_q30(exp2_coef, EXP2_ORDER, f));
+}
+
+int32_t sqrt_fixed(int32_t x)
+{
+	uint64_t op = (uint64_t)x << 16;
+	uint64_t res = 0;
+	uint64_t one = (uint64_t)1 << 46;
+
+	if (x <= 0)
+		return 0;
+
+	while (one > op)
+		one >>= 2;
+
+	while (one) {
+		if (op >= res + one) {
+			op -= res + one;
+			res = (res >> 1) + one;
+		} else {
+			res >>= 1;
+		}
+		one >>= 2;
+	}
+
+	/* round to nearest */
+	if (op > res)
+		res++;
+
+	return (int32_t)res;
+}
+
+int32_t inv_fixed(int32_t x)
+{
+	int32_t m;
+	int32_t y;
+	int32_t e;
+	int64_t r;
+	int s;
+	int i;
+
+	if (!x)
+		return INT32_MAX;
+
+	/* -1/32768 can't be normalised as positive */
+	if (x == INT32_MIN)
+		return -2;
+
+	/* |x| = m * 2^(s - 31) * 2^16 with Q1.31 mantissa 0.5 <= m < 1 */
+	s = norm_int32(x > 0 ? x : -x);
+	m = (x > 0 ? x : -x) << s;
+
+	y = INV_SEED_C0_Q3_29 - (int32_t)(((int64_t)INV_SEED_C1_Q3_29 * m) >> 31);
+	for (i = 0; i < INV_ITERATIONS; i++) {
+		/* y = y * (2 - m * y) */
+		e = (1 << 30) - (int32_t)(((int64_t)m * y) >> 31);
+		y = (int32_t)(((int64_t)y * e) >> 29);
+	}
+
+	/* 1/x = y * 2^(s - 28) in Q16.16 */
+	if (s > 28)
+		r = (int64_t)y << (s - 28);
+	else
+		r = ((int64_t)y + ((int64_t)1 << (28 - s) >> 1)) >> (28 - s);
+
+	return sat_int32(x > 0 ? r : -r);
+}
+
+int32_t lin2db_fixed(int32_t x)
+{
+	if (x <= 0)
+		return INT32_MIN;
+
+	return q_multsr_sat_32x32(log2_fixed(x), DB_PER_LOG2_Q4_28, 28);
+}
+
+int32_t db2lin_fixed(int32_t x)
+{
+	return exp2_fixed(q_multsr_sat_32x32(x, LOG2_10_DIV20_Q1_31, 31));
+}
+
+#if defined(__XCC__) && XCHAL_HAVE_HIFI3
+
+/* Two lane version of poly_q30(), gives the same result bit exactly */
+static inline ae_int32x2 poly_q30_x2(const int32_t *c, int order,
+				     ae_int32x2 f)
+{
+	ae_int32x2 acc = AE_MOVDA32(c[order]);
+	ae_int64 h;
+	ae_int64 l;
+	int k;
+
+	for (k = order - 1; k >= 0; k--) {
+		h = AE_SRAI64(AE_MUL32_HH(acc, f), 31);
+		l = AE_SRAI64(AE_MUL32_LL(acc, f), 31);
+		acc = AE_MOVDA32X2(AE_MOVAD32_L(AE_MOVINT32X2_FROMINT64(h)),
+				   AE_MOVAD32_L(AE_MOVINT32X2_FROMINT64(l)));
+		acc = AE_ADD32(acc, AE_MOVDA32(c[k]));
+	}
+
+	return acc;
+}
+
+void log2_fixed_batch(const int32_t *x, int32_t *y, int n)
+{
+	ae_int32x2 p;
+	int32_t f0;
+	int32_t f1;
+	int e0;
+	int e1;
+	int i;
+
+	for (i = 0; i + 1 < n; i += 2) {
+		if (x[i] <= 0 || x[i + 1] <= 0) {
+			y[i] = log2_fixed(x[i]);
+			y[i + 1] = log2_fixed(x[i + 1]);
+			continue;
+		}
+
+		e0 = log2_split(x[i], &f0);
+		e1 = log2_split(x[i + 1], &f1);
+		p = poly_q30_x2(log2_coef, LOG2_ORDER, AE_MOVDA32X2(f0, f1));
+		y[i] = log2_join(e0, AE_MOVAD32_H(p));
+		y[i + 1] = log2_join(e1, AE_MOVAD32_L(p));
+	}
+
+	if (i < n)
+		y[i] = log2_fixed(x[i]);
+}
+
+void exp2_fixed_batch(const int32_t *x, int32_t *y, int n)
+{
+	ae_int32x2 p;
+	int32_t f0;
+	int32_t f1;
+	int i0;
+	int i1;
+	int i;
+
+	for (i = 0; i + 1 < n; i += 2) {
+		i0 = exp2_split(x[i], &f0);
+		i1 = exp2_split(x[i + 1], &f1);
+		p = poly_q30_x2(exp2_coef, EXP2_ORDER, AE_MOVDA32X2(f0, f1));
+		y[i] = exp2_join(i0, AE_MOVAD32_H(p));
+		y[i + 1] = exp2_join(i1, AE_MOVAD32_L(p));
+	}
+
+	if (i < n)
+		y[i] = exp2_fixed(x[i]);
+}
+
+#else
+
+void log2_fixed_batch(const int32_t *x, int32_t *y, int n)
+{
+	int i;
+
+	for (i = 0; i < n; i++)
+		y[i] = log2_fixed(x[i]);
+}
+
+void exp2_fixed_batch(const int32_t *x, int32_t *y, int n)
+{
+	int i;
+
+	for (i = 0; i < n; i++)
+		y[i] = exp2_fixed(x[i]);
+}
+
+#endif
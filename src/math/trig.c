@@ -34,6 +34,13 @@
 #include <sof/audio/format.h>
 #include <sof/math/trig.h>
 
+#if defined(__XCC__)
+#include <xtensa/config/core-isa.h>
+#if XCHAL_HAVE_HIFI3
+#include <xtensa/tie/xt_hifi3.h>
+#endif
+#endif
+
 
 #define SINE_C_Q20 341782638 /* 2*SINE_NQUART/pi in Q12.20 */
 #define SINE_NQUART 512 /* Must be 2^N */
@@ -598,3 +605,102 @@ int32_t sin_fixed(int32_t w) {
 	sine = s0 + q_mults_32x32(frac, delta, Q_SHIFT_BITS_64(31, 31, 31));
     return (int32_t) sine;
 }
+
+#if defined(__XCC__) && XCHAL_HAVE_HIFI3
+
+/* Table index and Q1.31 interpolation fraction of one Q4.28 x Q12.20
+ * product held as Q16.48.
+ */
+static inline void sine_index(ae_int64 prod, int *idx, int32_t *frac)
+{
+	*idx = AE_MOVAD32_H(AE_MOVINT32X2_FROMINT64(prod)) >> 16;
+	*frac = AE_MOVAD32_L(AE_MOVINT32X2_FROMINT64(AE_SRAI64(prod, 17))) &
+		INT32_MAX;
+}
+
+/* HiFi3 batch sine, two angles per loop. The Q16.48 index products and
+ * the interpolation products are computed as 64 bit vectors lanes, table
+ * reads are scalar. Truncation matches sin_fixed() so results are equal.
+ */
+void sin_fixed_batch(const int32_t *w, int32_t *out, int n)
+{
+	const ae_int32x2 *in = (const ae_int32x2 *)w;
+	ae_int32x2 *dst = (ae_int32x2 *)out;
+	ae_valign in_align = AE_LA64_PP(in);
+	ae_valign out_align = AE_ZALIGN64();
+	ae_int32x2 c = AE_MOVDA32(SINE_C_Q20);
+	ae_int32x2 angle;
+	ae_int32x2 frac;
+	ae_int32x2 s0;
+	ae_int32x2 delta;
+	ae_int64 interp_h;
+	ae_int64 interp_l;
+	int32_t frac_h;
+	int32_t frac_l;
+	int idx_h;
+	int idx_l;
+	int i;
+
+	for (i = 0; i < n >> 1; i++) {
+		AE_LA32X2_IP(angle, in_align, in);
+
+		/* Q4.28 x Q12.20 -> Q16.48 */
+		sine_index(AE_MUL32_HH(angle, c), &idx_h, &frac_h);
+		sine_index(AE_MUL32_LL(angle, c), &idx_l, &frac_l);
+
+		s0 = AE_MOVDA32X2(sine_lookup(idx_h), sine_lookup(idx_l));
+		delta = AE_SUB32(AE_MOVDA32X2(sine_lookup(idx_h + 1),
+					      sine_lookup(idx_l + 1)), s0);
+		frac = AE_MOVDA32X2(frac_h, frac_l);
+
+		/* Q1.31 x Q1.31 -> Q2.62, truncated to Q1.31 */
+		interp_h = AE_SRAI64(AE_MUL32_HH(frac, delta), 31);
+		interp_l = AE_SRAI64(AE_MUL32_LL(frac, delta), 31);
+
+		angle = AE_ADD32(s0, AE_MOVDA32X2(
+			AE_MOVAD32_L(AE_MOVINT32X2_FROMINT64(interp_h)),
+			AE_MOVAD32_L(AE_MOVINT32X2_FROMINT64(interp_l))));
+		AE_SA32X2_IP(angle, out_align, dst);
+	}
+
+	AE_SA64POS_FP(out_align, dst);
+
+	if (n & 1)
+		out[n - 1] = sin_fixed(w[n - 1]);
+}
+
+#else
+
+/* Generic batch sine, the compiler can inline sin_fixed() and the table
+ * reads into one loop.
+ */
+void sin_fixed_batch(const int32_t *w, int32_t *out, int n)
+{
+	int i;
+
+	for (i = 0; i < n; i++)
+		out[i] = sin_fixed(w[i]);
+}
+
+#endif
+
+/* Sines of n angles from w advancing by w_step, the phase wraps like the
+ * tone generator accumulator. Angles are written to out first and then
+ * converted in place.
+ */
+int32_t sin_fixed_step(int32_t w, int32_t w_step, int32_t *out, int n)
+{
+	int64_t phase = w;
+	int i;
+
+	for (i = 0; i < n; i++) {
+		out[i] = (int32_t)phase;
+		phase += w_step;
+		if (phase > PI_MUL2_Q4_28)
+			phase -= PI_MUL2_Q4_28;
+	}
+
+	sin_fixed_batch(out, out, n);
+
+	return (int32_t)phase;
+}
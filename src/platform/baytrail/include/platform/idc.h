@@ -31,11 +31,17 @@
 #ifndef __INCLUDE_PLATFORM_IDC_H__
 #define __INCLUDE_PLATFORM_IDC_H__
 
+#include <errno.h>
+
 struct idc_msg;
 
 static inline int idc_send_msg(struct idc_msg *msg,
 			       uint32_t mode) { return 0; }
 
+static inline int idc_send_msg_async(struct idc_msg *msg,
+				     void (*cb)(void *data, int ret),
+				     void *cb_data) { return -ENODEV; }
+
 static inline void idc_init(void) { }
 
 #endif
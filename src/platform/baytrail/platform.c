@@ -243,6 +243,7 @@ int platform_init(struct sof *sof)
 	trace_point(TRACE_BOOT_PLATFORM_IPC);
 	ipc_init(sof);
 
+	trace_point(TRACE_BOOT_PLATFORM_DAI);
 	ret = dai_init();
 	if (ret < 0)
 		return -ENODEV;
@@ -290,6 +291,7 @@ int platform_init(struct sof *sof)
 #endif
 
 	/* Initialize DMA for Trace*/
+	trace_point(TRACE_BOOT_PLATFORM_DMA_TRACE);
 	dma_trace_init_complete(sof->dmat);
 
 	/* show heap status */
@@ -231,6 +231,7 @@ int platform_init(struct sof *sof)
 	trace_point(TRACE_BOOT_PLATFORM_IPC);
 	ipc_init(sof);
 
+	trace_point(TRACE_BOOT_PLATFORM_DAI);
 	ret = dai_init();
 	if (ret < 0)
 		return -ENODEV;
@@ -248,6 +249,7 @@ int platform_init(struct sof *sof)
 	dai_probe(ssp1);
 
 	/* Initialize DMA for Trace*/
+	trace_point(TRACE_BOOT_PLATFORM_DMA_TRACE);
 	dma_trace_init_complete(sof->dmat);
 
 	/* show heap status */
@@ -38,6 +38,13 @@ static inline int idc_send_msg(struct idc_msg *msg, uint32_t mode)
 	return arch_idc_send_msg(msg, mode);
 }
 
+static inline int idc_send_msg_async(struct idc_msg *msg,
+				     void (*cb)(void *data, int ret),
+				     void *cb_data)
+{
+	return arch_idc_send_msg_async(msg, cb, cb_data);
+}
+
 static inline void idc_init(void)
 {
 	arch_idc_init();
@@ -161,6 +161,8 @@
  * +---------------------+----------------+-----------------------------------+
  * | HEAP_RUNTIME_BASE   | Runtime Heap   |  HEAP_RUNTIME_SIZE                |
  * +---------------------+----------------+-----------------------------------+
+ * | HEAP_CORE_BASE      | Per core Heaps |  HEAP_CORE_T_SIZE                 |
+ * +---------------------+----------------+-----------------------------------+
  * | HEAP_BUFFER_BASE    | Module Buffers |  HEAP_BUFFER_SIZE                 |
  * +---------------------+----------------+-----------------------------------+
  * | SOF_STACK_END      | Stack          |  SOF_STACK_SIZE                  |
@@ -195,6 +197,12 @@
 #define HEAP_RT_COUNT512		64
 #define HEAP_RT_COUNT1024		8
 
+/* Heap section sizes for per core runtime and buffer heaps */
+#define HEAP_CORE_RT_COUNT64		32
+#define HEAP_CORE_RT_COUNT256		16
+#define HEAP_CORE_RT_COUNT1024		2
+#define HEAP_CORE_BUFFER_COUNT		64
+
 #define L2_VECTOR_SIZE		0x1000
 
 /* HP SRAM windows */
@@ -320,7 +328,21 @@
 #define SOF_STACK_BASE		(HP_SRAM_BASE + HP_SRAM_SIZE)
 #define SOF_STACK_END		(SOF_STACK_BASE - SOF_STACK_TOTAL_SIZE)
 
-#define HEAP_BUFFER_BASE	(HEAP_RUNTIME_BASE + HEAP_RUNTIME_SIZE)
+#define HEAP_CORE_BASE		(HEAP_RUNTIME_BASE + HEAP_RUNTIME_SIZE)
+#define HEAP_CORE_RUNTIME_SIZE \
+	(HEAP_CORE_RT_COUNT64 * 64 + HEAP_CORE_RT_COUNT256 * 256 + \
+	HEAP_CORE_RT_COUNT1024 * 1024)
+#define HEAP_CORE_BUFFER_SIZE \
+	(HEAP_CORE_BUFFER_COUNT * HEAP_BUFFER_BLOCK_SIZE)
+#define HEAP_CORE_SIZE		(HEAP_CORE_RUNTIME_SIZE + HEAP_CORE_BUFFER_SIZE)
+#define HEAP_CORE_T_SIZE	(HEAP_CORE_SIZE * PLATFORM_HEAP_CORE)
+
+/* runtime heap of core n is followed by its buffer heap */
+#define HEAP_CORE_RUNTIME_BASE(n)	(HEAP_CORE_BASE + (n) * HEAP_CORE_SIZE)
+#define HEAP_CORE_BUFFER_BASE(n) \
+	(HEAP_CORE_RUNTIME_BASE(n) + HEAP_CORE_RUNTIME_SIZE)
+
+#define HEAP_BUFFER_BASE	(HEAP_CORE_BASE + HEAP_CORE_T_SIZE)
 #define HEAP_BUFFER_SIZE	\
 	(SOF_STACK_END - HEAP_BUFFER_BASE)
 #define HEAP_BUFFER_BLOCK_SIZE		0x180
@@ -386,6 +408,7 @@
 #define PLATFORM_HEAP_SYSTEM_RUNTIME	4 /* one per core */
 #define PLATFORM_HEAP_RUNTIME		1
 #define PLATFORM_HEAP_BUFFER		3
+#define PLATFORM_HEAP_CORE		4 /* one per core */
 
 /* Stack configuration */
 #define SOF_LP_STACK_SIZE			0x1000
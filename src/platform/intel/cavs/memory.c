@@ -71,6 +71,50 @@ static struct block_map rt_heap_map[] = {
 	BLOCK_DEF(1024, HEAP_RT_COUNT1024, mod_block1024),
 };
 
+#ifdef PLATFORM_HEAP_CORE
+/* Heap blocks and memory maps for per core runtime and buffer heaps */
+#define CORE_HEAP_MAPS(n) \
+static struct block_hdr core_##n##_rt_block64[HEAP_CORE_RT_COUNT64]; \
+static struct block_hdr core_##n##_rt_block256[HEAP_CORE_RT_COUNT256]; \
+static struct block_hdr core_##n##_rt_block1024[HEAP_CORE_RT_COUNT1024]; \
+static struct block_hdr core_##n##_buf_block[HEAP_CORE_BUFFER_COUNT]; \
+static struct block_map core_##n##_rt_heap_map[] = { \
+	BLOCK_DEF(64, HEAP_CORE_RT_COUNT64, core_##n##_rt_block64), \
+	BLOCK_DEF(256, HEAP_CORE_RT_COUNT256, core_##n##_rt_block256), \
+	BLOCK_DEF(1024, HEAP_CORE_RT_COUNT1024, core_##n##_rt_block1024), \
+}; \
+static struct block_map core_##n##_buf_heap_map[] = { \
+	BLOCK_DEF(HEAP_BUFFER_BLOCK_SIZE, HEAP_CORE_BUFFER_COUNT, \
+		  core_##n##_buf_block), \
+}
+
+CORE_HEAP_MAPS(0);
+CORE_HEAP_MAPS(1);
+CORE_HEAP_MAPS(2);
+CORE_HEAP_MAPS(3);
+
+#define CORE_HEAP_DEF(n) { \
+	.runtime = { \
+		.blocks = ARRAY_SIZE(core_##n##_rt_heap_map), \
+		.map = core_##n##_rt_heap_map, \
+		.heap = HEAP_CORE_RUNTIME_BASE(n), \
+		.size = HEAP_CORE_RUNTIME_SIZE, \
+		.info = {.free = HEAP_CORE_RUNTIME_SIZE,}, \
+		.caps = SOF_MEM_CAPS_RAM | SOF_MEM_CAPS_EXT | \
+			SOF_MEM_CAPS_CACHE, \
+	}, \
+	.buffer = { \
+		.blocks = ARRAY_SIZE(core_##n##_buf_heap_map), \
+		.map = core_##n##_buf_heap_map, \
+		.heap = HEAP_CORE_BUFFER_BASE(n), \
+		.size = HEAP_CORE_BUFFER_SIZE, \
+		.info = {.free = HEAP_CORE_BUFFER_SIZE,}, \
+		.caps = SOF_MEM_CAPS_RAM | SOF_MEM_CAPS_EXT | \
+			SOF_MEM_CAPS_CACHE, \
+	}, \
+}
+#endif
+
 /* Heap blocks for buffers */
 static struct block_hdr buf_block[HEAP_BUFFER_COUNT];
 static struct block_hdr hp_buf_block[HEAP_HP_BUFFER_COUNT];
@@ -205,7 +249,18 @@ struct mm memmap = {
 			SOF_MEM_CAPS_CACHE | SOF_MEM_CAPS_DMA,
 	},
 #endif
+#ifdef PLATFORM_HEAP_CORE
+	.core[0] = CORE_HEAP_DEF(0),
+	.core[1] = CORE_HEAP_DEF(1),
+	.core[2] = CORE_HEAP_DEF(2),
+	.core[3] = CORE_HEAP_DEF(3),
+	.total = {.free = HEAP_SYSTEM_T_SIZE + HEAP_RUNTIME_SIZE +
+			HEAP_SYS_RUNTIME_T_SIZE + HEAP_BUFFER_SIZE +
+			HEAP_HP_BUFFER_SIZE + HEAP_LP_BUFFER_SIZE +
+			HEAP_CORE_T_SIZE,},
+#else
 	.total = {.free = HEAP_SYSTEM_T_SIZE + HEAP_RUNTIME_SIZE +
 			HEAP_SYS_RUNTIME_T_SIZE + HEAP_BUFFER_SIZE +
 			HEAP_HP_BUFFER_SIZE + HEAP_LP_BUFFER_SIZE,},
+#endif
 };
@@ -382,6 +382,7 @@ int platform_init(struct sof *sof)
 	ipc_init(sof);
 
 	/* init DAIs */
+	trace_point(TRACE_BOOT_PLATFORM_DAI);
 	ret = dai_init();
 	if (ret < 0)
 		return -ENODEV;
@@ -391,6 +392,7 @@ int platform_init(struct sof *sof)
 	idc_init();
 
 	/* Initialize DMA for Trace*/
+	trace_point(TRACE_BOOT_PLATFORM_DMA_TRACE);
 	dma_trace_init_complete(sof->dmat);
 
 	/* show heap status */
@@ -216,6 +216,37 @@ static inline void cavs_pm_runtime_en_dwdma_clk_gating(uint32_t index)
 #endif
 }
 
+#if defined(CONFIG_SRAM_BANK_GATING)
+/**
+ * \brief Powers HP SRAM bank up or gates it.
+ *
+ * Called by the allocator under its lock, possibly before tracing is up.
+ *
+ * \param[in] index Index of the bank (EBB).
+ * \param[in] enable True to power the bank up.
+ */
+static inline void cavs_pm_runtime_hpsram_bank_power(uint32_t index,
+						     bool enable)
+{
+	uint32_t segment = index / EBB_SEGMENT_SIZE;
+	uint32_t bit = BIT(index % EBB_SEGMENT_SIZE);
+	uint32_t mask = io_reg_read(SHIM_HSPGCTL(segment));
+
+	/* set bit gates the bank */
+	if (enable)
+		mask &= ~bit;
+	else
+		mask |= bit;
+
+	io_reg_write(SHIM_HSPGCTL(segment), mask);
+	io_reg_write(SHIM_HSRMCTL(segment), mask);
+
+	/* bank has to be powered before the allocator hands it out */
+	while ((io_reg_read(SHIM_HSPGISTS(segment)) & bit) != (mask & bit))
+		idelay(PLATFORM_DEFAULT_DELAY);
+}
+#endif
+
 void platform_pm_runtime_init(struct pm_runtime_data *prd)
 {
 	struct platform_pm_runtime_data *pprd;
@@ -245,6 +276,11 @@ void platform_pm_runtime_get(enum pm_runtime_context context, uint32_t index,
 	case DW_DMAC_CLK:
 		cavs_pm_runtime_dis_dwdma_clk_gating(index);
 		break;
+#if defined(CONFIG_SRAM_BANK_GATING)
+	case HPSRAM_BANK:
+		cavs_pm_runtime_hpsram_bank_power(index, true);
+		break;
+#endif
 	default:
 		break;
 	}
@@ -271,6 +307,11 @@ void platform_pm_runtime_put(enum pm_runtime_context context, uint32_t index,
 	case DW_DMAC_CLK:
 		cavs_pm_runtime_en_dwdma_clk_gating(index);
 		break;
+#if defined(CONFIG_SRAM_BANK_GATING)
+	case HPSRAM_BANK:
+		cavs_pm_runtime_hpsram_bank_power(index, false);
+		break;
+#endif
 	default:
 		break;
 	}
@@ -37,6 +37,7 @@
 #include <sof/interrupt.h>
 #include <sof/ipc.h>
 #include <sof/agent.h>
+#include <sof/clk.h>
 #include <platform/idc.h>
 #include <platform/interrupt.h>
 #include <platform/shim.h>
@@ -58,6 +59,7 @@ int do_task_master_core(struct sof *sof)
 	struct audio_data pdata;
 #endif
 	/* init default audio components */
+	trace_point(TRACE_BOOT_TASK_COMP);
 	sys_comp_init();
 	sys_comp_dai_init();
 	sys_comp_host_init();
@@ -66,9 +68,16 @@ int do_task_master_core(struct sof *sof)
 	sys_comp_switch_init();
 	sys_comp_volume_init();
 	sys_comp_src_init();
+	sys_comp_asrc_init();
+	sys_comp_conv_init();
 	sys_comp_tone_init();
 	sys_comp_eq_iir_init();
 	sys_comp_eq_fir_init();
+	sys_comp_drc_init();
+	sys_comp_kpb_init();
+	sys_comp_decoder_init();
+	sys_comp_voice_init();
+	sys_comp_crossover_init();
 
 #if STATIC_PIPE
 	/* init static pipeline */
@@ -77,19 +86,30 @@ int do_task_master_core(struct sof *sof)
 		panic(SOF_IPC_PANIC_TASK);
 #endif
 	/* let host know DSP boot is complete */
+	trace_point(TRACE_BOOT_TASK_READY);
+#ifdef CONFIG_BOOT_PROFILE
+	boot_profile_complete();
+#endif
 	platform_boot_complete(0);
 
 	/* main audio IPC processing loop */
 	while (1) {
 		/* sleep until next IPC or DMA */
 		sa_enter_idle(sof);
+#ifdef CONFIG_IDLE_MANAGER
+		clock_idle_wait();
+#else
 		wait_for_interrupt(0);
+#endif
 
 		/* now process any IPC messages from host */
 		ipc_process_msg_queue();
 
 		/* schedule any idle tasks */
 		schedule();
+
+		/* background work from any core */
+		work_background_run();
 	}
 
 	/* something bad happened */
@@ -101,10 +121,17 @@ int do_task_slave_core(struct sof *sof)
 	/* main audio IDC processing loop */
 	while (1) {
 		/* sleep until next IDC */
+#ifdef CONFIG_IDLE_MANAGER
+		clock_idle_wait();
+#else
 		wait_for_interrupt(0);
+#endif
 
 		/* schedule any idle tasks */
 		schedule();
+
+		/* background work from any core */
+		work_background_run();
 	}
 
 	/* something bad happened */
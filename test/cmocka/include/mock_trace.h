@@ -30,7 +30,19 @@
 	_TRACE_N(N, 1, 0)	\
 	_TRACE_N(N, 1, 1)
 
-#define TRACE_IMPL()	\
+#define TRACE_FILTER_IMPL()						\
+	uint8_t trace_filter_level[TRACE_FILTER_CLASSES];		\
+	int trace_filter_comp(uint32_t level, uint32_t trace_class,	\
+			      uint32_t comp_id)				\
+	{								\
+		(void)level;						\
+		(void)trace_class;					\
+		(void)comp_id;						\
+		return 0;						\
+	}
+
+#define TRACE_IMPL()		\
+	TRACE_FILTER_IMPL()	\
 	_TRACE_GROUP(0)	\
 	_TRACE_GROUP(1)	\
 	_TRACE_GROUP(2)	\
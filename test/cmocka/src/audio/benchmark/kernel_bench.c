@@ -0,0 +1,357 @@
+/*
+ * Copyright (c) 2018, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*
+ * Processing kernel benchmarks. Every kernel runs over fixed input vectors
+ * and the best of BENCH_RUNS runs is reported in cycles per sample. On
+ * Xtensa the CCOUNT register is read so the numbers are exact on the ISS and
+ * a kernel fails when it exceeds its budget. The budgets can be overridden
+ * at build time, e.g. make check BENCH_CFLAGS=-DBENCH_VOL_MAX_CPS=20.
+ * Host builds run the same code and only print nanoseconds per sample.
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <time.h>
+#include <cmocka.h>
+#include <sof/audio/component.h>
+#include <sof/audio/format.h>
+#include <sof/math/trig.h>
+#include <uapi/user/eq.h>
+#include "volume.h"
+#include "iir.h"
+#include "fir_config.h"
+
+#if FIR_GENERIC
+#include "fir.h"
+#define bench_eq_fir_s32 eq_fir_s32
+#endif
+
+#if FIR_HIFIEP
+#include "fir_hifi2ep.h"
+#define bench_eq_fir_s32 eq_fir_s32_hifiep
+#endif
+
+#if FIR_HIFI3
+#include "fir_hifi3.h"
+#define bench_eq_fir_s32 eq_fir_s32_hifi3
+#endif
+
+/* cycles per sample budgets */
+#ifndef BENCH_VOL_MAX_CPS
+#define BENCH_VOL_MAX_CPS	40
+#endif
+
+#ifndef BENCH_FIR_MAX_CPS
+#define BENCH_FIR_MAX_CPS	200
+#endif
+
+#ifndef BENCH_IIR_MAX_CPS
+#define BENCH_IIR_MAX_CPS	120
+#endif
+
+#ifndef BENCH_SIN_MAX_CPS
+#define BENCH_SIN_MAX_CPS	120
+#endif
+
+#define BENCH_RUNS		4
+#define BENCH_FRAMES		480	/* 10 ms at 48 kHz */
+#define BENCH_CHANNELS		2
+#define BENCH_SAMPLES		(BENCH_FRAMES * BENCH_CHANNELS)
+#define BENCH_FIR_LENGTH	64
+#define BENCH_IIR_BIQUADS	2
+
+static int32_t bench_in[BENCH_SAMPLES];
+static int32_t bench_out[BENCH_SAMPLES];
+
+#if defined __XTENSA__
+#define BENCH_UNIT	"cycles"
+#else
+#define BENCH_UNIT	"ns"
+#endif
+
+static inline uint32_t bench_cycles(void)
+{
+#if defined __XTENSA__
+	uint32_t ccount;
+
+	__asm__ __volatile__ ("rsr.ccount %0" : "=a" (ccount));
+	return ccount;
+#else
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+}
+
+static void bench_report(const char *kernel, uint32_t cycles, int samples,
+			 uint32_t max_cps)
+{
+	uint32_t cps = (cycles + samples - 1) / samples;
+
+	print_message("%s: %u %s/sample (budget %u)\n", kernel, cps,
+		      BENCH_UNIT, max_cps);
+#if defined __XTENSA__
+	assert_true(cps <= max_cps);
+#endif
+}
+
+static void bench_fill(void)
+{
+	int i;
+
+	/* deterministic full scale ramp with alternating sign */
+	for (i = 0; i < BENCH_SAMPLES; i++)
+		bench_in[i] = (i & 1 ? -1 : 1) * (i << 20);
+}
+
+static void bench_buffer(struct comp_buffer *buffer, int32_t *data)
+{
+	buffer->addr = data;
+	buffer->r_ptr = data;
+	buffer->w_ptr = data;
+	buffer->end_addr = data + BENCH_SAMPLES;
+	buffer->size = sizeof(bench_in);
+}
+
+static void test_bench_volume(void **state)
+{
+	static const uint32_t fmts[] = {
+		SOF_IPC_FRAME_S16_LE,
+		SOF_IPC_FRAME_S24_4LE,
+		SOF_IPC_FRAME_S32_LE,
+	};
+	static const char * const fmt_names[] = { "s16", "s24", "s32" };
+	struct comp_dev *dev;
+	struct comp_data *cd;
+	struct comp_buffer source;
+	struct comp_buffer sink;
+	scale_vol func;
+	uint32_t best;
+	uint32_t t;
+	char name[32];
+	int i;
+	int j;
+	int ch;
+	int run;
+
+	(void)state;
+
+	bench_fill();
+	bench_buffer(&source, bench_in);
+	bench_buffer(&sink, bench_out);
+
+	dev = test_calloc(1, COMP_SIZE(struct sof_ipc_comp_volume));
+	cd = test_calloc(1, sizeof(*cd));
+	comp_set_drvdata(dev, cd);
+	dev->params.channels = BENCH_CHANNELS;
+	dev->frames = BENCH_FRAMES;
+
+	for (ch = 0; ch < BENCH_CHANNELS; ch++) {
+		cd->volume[ch] = VOL_ZERO_DB >> 1;
+		cd->rvolume[ch] = cd->volume[ch];
+	}
+
+	for (i = 0; i < ARRAY_SIZE(fmts); i++) {
+		for (j = 0; j < ARRAY_SIZE(fmts); j++) {
+			cd->source_format = fmts[i];
+			cd->sink_format = fmts[j];
+			func = vol_get_processing_function(dev);
+			if (!func)
+				continue;
+
+			best = UINT32_MAX;
+			for (run = 0; run < BENCH_RUNS; run++) {
+				t = bench_cycles();
+				func(dev, &sink, &source);
+				t = bench_cycles() - t;
+				if (t < best)
+					best = t;
+			}
+
+			snprintf(name, sizeof(name), "vol %s->%s",
+				 fmt_names[i], fmt_names[j]);
+			bench_report(name, best, BENCH_SAMPLES,
+				     BENCH_VOL_MAX_CPS);
+		}
+	}
+
+	test_free(cd);
+	test_free(dev);
+}
+
+static void test_bench_fir(void **state)
+{
+	struct sof_eq_fir_coef_data *config;
+	struct fir_state_32x16 fir[BENCH_CHANNELS];
+	struct comp_buffer source;
+	struct comp_buffer sink;
+	int32_t *delay;
+	int32_t *data;
+	uint32_t best = UINT32_MAX;
+	uint32_t t;
+	int ch;
+	int i;
+	int run;
+
+	(void)state;
+
+	bench_fill();
+	bench_buffer(&source, bench_in);
+	bench_buffer(&sink, bench_out);
+
+	/* averaging filter */
+	config = test_calloc(1, sizeof(*config) +
+			     BENCH_FIR_LENGTH * sizeof(int16_t));
+	config->length = BENCH_FIR_LENGTH;
+	config->out_shift = 0;
+	for (i = 0; i < BENCH_FIR_LENGTH; i++)
+		config->coef[i] = INT16_MAX / BENCH_FIR_LENGTH;
+
+	delay = test_calloc(BENCH_CHANNELS * BENCH_FIR_LENGTH,
+			    sizeof(int32_t));
+	data = delay;
+	for (ch = 0; ch < BENCH_CHANNELS; ch++) {
+		assert_true(fir_init_coef(&fir[ch], config) > 0);
+		fir_init_delay(&fir[ch], &data);
+	}
+
+	for (run = 0; run < BENCH_RUNS; run++) {
+		t = bench_cycles();
+		bench_eq_fir_s32(fir, &source, &sink, BENCH_FRAMES,
+				 BENCH_CHANNELS);
+		t = bench_cycles() - t;
+		if (t < best)
+			best = t;
+	}
+
+	bench_report("eq_fir s32", best, BENCH_SAMPLES, BENCH_FIR_MAX_CPS);
+
+	test_free(delay);
+	test_free(config);
+}
+
+static void bench_iir(const char *kernel, unsigned int precision)
+{
+	int32_t coef[BENCH_IIR_BIQUADS * SOF_EQ_IIR_NBIQUAD_DF2T];
+	int64_t delay[BENCH_IIR_BIQUADS * IIR_DF2T_NUM_DELAYS] = { 0 };
+	struct iir_state_df2t iir;
+	uint32_t best = UINT32_MAX;
+	uint32_t t;
+	int32_t *c;
+	int i;
+	int run;
+
+	bench_fill();
+
+	/* two identical low pass sections in series */
+	for (i = 0; i < BENCH_IIR_BIQUADS; i++) {
+		c = &coef[i * SOF_EQ_IIR_NBIQUAD_DF2T];
+		c[0] = -402961225;	/* a2 */
+		c[1] = 1306649706;	/* a1 */
+		c[2] = 37739338;	/* b2 */
+		c[3] = 75478676;	/* b1 */
+		c[4] = 37739338;	/* b0 */
+		c[5] = 0;		/* output shift */
+		c[6] = 16384;		/* output gain */
+	}
+
+	iir.biquads = BENCH_IIR_BIQUADS;
+	iir.biquads_in_series = BENCH_IIR_BIQUADS;
+	iir.precision = precision;
+	iir.coef = coef;
+	iir.delay = delay;
+	iir.delay32 = (int32_t *)delay;
+
+	for (run = 0; run < BENCH_RUNS; run++) {
+		t = bench_cycles();
+		for (i = 0; i < BENCH_SAMPLES; i++)
+			bench_out[i] = iir_df2t(&iir, bench_in[i]);
+		t = bench_cycles() - t;
+		if (t < best)
+			best = t;
+	}
+
+	bench_report(kernel, best, BENCH_SAMPLES, BENCH_IIR_MAX_CPS);
+}
+
+static void test_bench_iir(void **state)
+{
+	(void)state;
+
+	bench_iir("iir_df2t", SOF_EQ_IIR_PRECISION_64);
+}
+
+static void test_bench_iir_32(void **state)
+{
+	(void)state;
+
+	bench_iir("iir_df2t 32 bit state", SOF_EQ_IIR_PRECISION_32);
+}
+
+static void test_bench_sin_fixed(void **state)
+{
+	uint32_t best = UINT32_MAX;
+	uint32_t t;
+	int i;
+	int run;
+
+	(void)state;
+
+	for (run = 0; run < BENCH_RUNS; run++) {
+		t = bench_cycles();
+		/* sweep 0 .. 2pi in Q4.28 */
+		for (i = 0; i < BENCH_SAMPLES; i++)
+			bench_out[i] = sin_fixed((int32_t)(1686629713LL * i /
+							   BENCH_SAMPLES));
+		t = bench_cycles() - t;
+		if (t < best)
+			best = t;
+	}
+
+	bench_report("sin_fixed", best, BENCH_SAMPLES, BENCH_SIN_MAX_CPS);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_bench_volume),
+		cmocka_unit_test(test_bench_fir),
+		cmocka_unit_test(test_bench_iir),
+		cmocka_unit_test(test_bench_iir_32),
+		cmocka_unit_test(test_bench_sin_fixed),
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <sof/audio/component.h>
+#include <sof/audio/buffer.h>
+#include <sof/ipc.h>
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <math.h>
+#include <cmocka.h>
+
+static struct comp_driver driver;
+static struct comp_dev producer;
+static struct comp_dev consumer[3];
+
+static struct comp_buffer *fanout_buffer_new(uint32_t caps,
+					     struct comp_dev *sink)
+{
+	struct sof_ipc_buffer test_buf_desc = {
+		.size = 16,
+		.caps = caps | SOF_MEM_CAPS_FANOUT,
+	};
+
+	struct comp_buffer *buf = buffer_new(&test_buf_desc);
+
+	assert_non_null(buf);
+
+	list_init(&buf->source_list);
+	list_init(&buf->sink_list);
+
+	buf->source = &producer;
+	buf->sink = sink;
+	buf->connected = 1;
+	sink->state = COMP_STATE_ACTIVE;
+
+	return buf;
+}
+
+static void test_audio_buffer_fanout_shared(void **state)
+{
+	(void)state;
+
+	struct comp_buffer *a = fanout_buffer_new(0, &consumer[0]);
+	struct comp_buffer *b = fanout_buffer_new(SOF_MEM_CAPS_POW2,
+						  &consumer[1]);
+
+	comp_update_buffer_produce(a, 4);
+	buffer_fanout_join(a, b);
+
+	/* joining reader starts empty at the write position */
+	assert_ptr_equal(b->addr, a->addr);
+	assert_ptr_equal(b->w_ptr, a->w_ptr);
+	assert_ptr_equal(b->r_ptr, a->w_ptr);
+	assert_int_equal(comp_buffer_get_avail_bytes(b), 0);
+
+	comp_update_buffer_produce(a, 8);
+
+	assert_ptr_equal(a->w_ptr, a->addr + 12);
+	assert_ptr_equal(b->w_ptr, a->w_ptr);
+	assert_int_equal(comp_buffer_get_avail_bytes(a), 12);
+	assert_int_equal(comp_buffer_get_avail_bytes(b), 8);
+
+	/* the slowest reader limits the writer */
+	assert_int_equal(comp_buffer_get_free_bytes(a), 4);
+	comp_update_buffer_consume(a, 12);
+	assert_int_equal(comp_buffer_get_free_bytes(a), 8);
+	assert_int_equal(comp_buffer_get_free_bytes(b), 8);
+
+	comp_update_buffer_consume(b, 8);
+	comp_update_buffer_produce(b, 10);
+
+	assert_ptr_equal(a->w_ptr, a->addr + 6);
+	assert_ptr_equal(b->w_ptr, a->w_ptr);
+	assert_int_equal(comp_buffer_get_avail_bytes(a), 10);
+	assert_int_equal(comp_buffer_get_avail_bytes(b), 10);
+
+	buffer_free(b);
+	assert_null(a->next_reader);
+	buffer_free(a);
+}
+
+static void test_audio_buffer_fanout_inactive(void **state)
+{
+	(void)state;
+
+	struct comp_buffer *a = fanout_buffer_new(0, &consumer[0]);
+	struct comp_buffer *b = fanout_buffer_new(0, &consumer[1]);
+	struct comp_buffer *c = fanout_buffer_new(SOF_MEM_CAPS_POW2,
+						  &consumer[2]);
+
+	buffer_fanout_join(a, b);
+	buffer_fanout_join(a, c);
+
+	/* a stopped reader drops data instead of holding the writer */
+	consumer[1].state = COMP_STATE_PAUSED;
+	comp_update_buffer_produce(a, 12);
+	comp_update_buffer_consume(a, 12);
+	comp_update_buffer_consume(c, 12);
+	comp_update_buffer_produce(c, 12);
+
+	assert_int_equal(comp_buffer_get_avail_bytes(b), 0);
+	assert_int_equal(comp_buffer_get_free_bytes(a), 4);
+
+	/* restarted reader picks up at the write position */
+	consumer[1].state = COMP_STATE_ACTIVE;
+	buffer_reset_pos(b);
+	assert_ptr_equal(b->r_ptr, a->w_ptr);
+	assert_int_equal(comp_buffer_get_avail_bytes(b), 0);
+
+	comp_update_buffer_produce(a, 2);
+	assert_int_equal(comp_buffer_get_avail_bytes(b), 2);
+	assert_int_equal(comp_buffer_get_avail_bytes(c), 14);
+	assert_int_equal(comp_buffer_get_free_bytes(b), 2);
+
+	/* resizing applies to every reader */
+	assert_int_equal(buffer_set_size(b, 8), 0);
+	assert_int_equal(a->size, 8);
+	assert_int_equal(c->mask, 7);
+
+	buffer_free(a);
+	buffer_free(c);
+	assert_null(b->next_reader);
+	buffer_free(b);
+}
+
+static void test_audio_buffer_fanout_loopback(void **state)
+{
+	(void)state;
+
+	struct comp_buffer *dai = fanout_buffer_new(0, &consumer[0]);
+	struct comp_buffer *ref = fanout_buffer_new(SOF_MEM_CAPS_LOOPBACK,
+						    &consumer[1]);
+
+	consumer[0].comp.type = SOF_COMP_DAI;
+	consumer[0].drv = &driver;
+
+	buffer_fanout_join(dai, ref);
+	buffer_loopback_update(ref);
+	assert_ptr_equal(ref->trail, dai);
+
+	/* reference data only appears as the DAI plays it */
+	comp_update_buffer_produce(dai, 12);
+	assert_int_equal(comp_buffer_get_avail_bytes(ref), 0);
+
+	comp_update_buffer_consume(dai, 4);
+	assert_int_equal(comp_buffer_get_avail_bytes(ref), 4);
+	assert_int_equal(buffer_loopback_delay(ref), 4);
+	assert_int_equal(comp_buffer_get_free_bytes(dai), 4);
+
+	comp_update_buffer_consume(ref, 4);
+	assert_ptr_equal(ref->r_ptr, dai->r_ptr);
+	assert_int_equal(comp_buffer_get_avail_bytes(ref), 0);
+	assert_int_equal(comp_buffer_get_free_bytes(dai), 8);
+
+	/* restarted reference is aligned with the DAI */
+	comp_update_buffer_consume(dai, 6);
+	buffer_reset_pos(ref);
+	assert_ptr_equal(ref->r_ptr, dai->r_ptr);
+	assert_int_equal(comp_buffer_get_avail_bytes(ref), 0);
+	assert_int_equal(comp_buffer_get_free_bytes(dai), 14);
+
+	buffer_free(dai);
+	assert_null(ref->trail);
+	buffer_free(ref);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_audio_buffer_fanout_shared),
+		cmocka_unit_test(test_audio_buffer_fanout_inactive),
+		cmocka_unit_test(test_audio_buffer_fanout_loopback),
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
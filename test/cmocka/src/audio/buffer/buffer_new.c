@@ -33,6 +33,8 @@
 #include <sof/ipc.h>
 
 #include <stdio.h>
+#include <errno.h>
+#include <string.h>
 #include <stdarg.h>
 #include <stddef.h>
 #include <setjmp.h>
@@ -57,10 +59,45 @@ static void test_audio_buffer_new(void **state)
 	buffer_free(buf);
 }
 
+static void test_audio_buffer_set_size_grow(void **state)
+{
+	(void)state;
+
+	struct sof_ipc_buffer test_buf_desc = {
+		.size = 256
+	};
+
+	struct comp_buffer *buf = buffer_new(&test_buf_desc);
+	struct comp_dev dai;
+
+	assert_non_null(buf);
+
+	/* a bigger size replaces the allocation */
+	assert_int_equal(buffer_set_size(buf, 512), 0);
+	assert_int_equal(buf->alloc_size, 512);
+	assert_int_equal(buf->size, 512);
+	assert_int_equal(buf->free, 512);
+
+	/* a smaller size keeps it */
+	assert_int_equal(buffer_set_size(buf, 128), 0);
+	assert_int_equal(buf->alloc_size, 512);
+	assert_int_equal(buf->size, 128);
+
+	/* DMA descriptors hold the address of DMA connected buffers */
+	memset(&dai, 0, sizeof(dai));
+	dai.is_dma_connected = 1;
+	buf->sink = &dai;
+	assert_int_equal(buffer_set_size(buf, 1024), -ENOMEM);
+	assert_int_equal(buf->alloc_size, 512);
+
+	buffer_free(buf);
+}
+
 int main(void)
 {
 	const struct CMUnitTest tests[] = {
-		cmocka_unit_test(test_audio_buffer_new)
+		cmocka_unit_test(test_audio_buffer_new),
+		cmocka_unit_test(test_audio_buffer_set_size_grow)
 	};
 
 	cmocka_set_message_output(CM_OUTPUT_TAP);
@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2018, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <sof/audio/component.h>
+#include <sof/audio/buffer.h>
+#include <sof/ipc.h>
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <math.h>
+#include <cmocka.h>
+
+static struct comp_dev producer;
+static struct comp_dev consumer;
+
+static struct comp_buffer *spsc_buffer_new(uint32_t size)
+{
+	struct sof_ipc_buffer test_buf_desc = {
+		.size = size
+	};
+
+	struct comp_buffer *buf = buffer_new(&test_buf_desc);
+
+	assert_non_null(buf);
+
+	list_init(&buf->source_list);
+	list_init(&buf->sink_list);
+
+	buf->source = &producer;
+	buf->sink = &consumer;
+	buffer_set_spsc(buf);
+
+	return buf;
+}
+
+static void test_audio_buffer_spsc_produce_consume(void **state)
+{
+	(void)state;
+
+	struct comp_buffer *buf = spsc_buffer_new(10);
+
+	assert_int_equal(comp_buffer_get_avail_bytes(buf), 0);
+	assert_int_equal(comp_buffer_get_free_bytes(buf), 10);
+
+	comp_update_buffer_produce(buf, 6);
+
+	assert_int_equal(comp_buffer_get_avail_bytes(buf), 6);
+	assert_int_equal(comp_buffer_get_free_bytes(buf), 4);
+	assert_ptr_equal(buf->w_ptr, buf->r_ptr + 6);
+
+	comp_update_buffer_consume(buf, 4);
+
+	assert_int_equal(comp_buffer_get_avail_bytes(buf), 2);
+	assert_int_equal(comp_buffer_get_free_bytes(buf), 8);
+	assert_ptr_equal(buf->r_ptr, buf->addr + 4);
+
+	buffer_free(buf);
+}
+
+static void test_audio_buffer_spsc_full_and_empty(void **state)
+{
+	(void)state;
+
+	struct comp_buffer *buf = spsc_buffer_new(10);
+
+	/* read and write positions are equal for both full and empty */
+	comp_update_buffer_produce(buf, 10);
+
+	assert_ptr_equal(buf->w_ptr, buf->r_ptr);
+	assert_int_equal(comp_buffer_get_avail_bytes(buf), 10);
+	assert_int_equal(comp_buffer_get_free_bytes(buf), 0);
+
+	comp_update_buffer_consume(buf, 10);
+
+	assert_ptr_equal(buf->w_ptr, buf->r_ptr);
+	assert_int_equal(comp_buffer_get_avail_bytes(buf), 0);
+	assert_int_equal(comp_buffer_get_free_bytes(buf), 10);
+
+	buffer_free(buf);
+}
+
+static void test_audio_buffer_spsc_wrap(void **state)
+{
+	(void)state;
+
+	struct comp_buffer *buf = spsc_buffer_new(10);
+	int i;
+
+	for (i = 0; i < 7; i++) {
+		comp_update_buffer_produce(buf, 6);
+		comp_update_buffer_consume(buf, 6);
+	}
+
+	assert_ptr_equal(buf->w_ptr, buf->addr + (7 * 6) % 10);
+	assert_ptr_equal(buf->r_ptr, buf->w_ptr);
+	assert_int_equal(comp_buffer_get_avail_bytes(buf), 0);
+
+	comp_update_buffer_produce(buf, 8);
+
+	assert_ptr_equal(buf->w_ptr, buf->addr + (7 * 6 + 8) % 10);
+	assert_int_equal(comp_buffer_get_avail_bytes(buf), 8);
+	assert_int_equal(comp_buffer_get_free_bytes(buf), 2);
+
+	buffer_free(buf);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_audio_buffer_spsc_produce_consume),
+		cmocka_unit_test(test_audio_buffer_spsc_full_and_empty),
+		cmocka_unit_test(test_audio_buffer_spsc_wrap),
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
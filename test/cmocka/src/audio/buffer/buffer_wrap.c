@@ -78,11 +78,71 @@ static void test_audio_buffer_write_fill_10_bytes_and_write_5(void **state)
 	buffer_free(buf);
 }
 
+static void test_audio_buffer_wrap_segments(void **state)
+{
+	(void)state;
+
+	struct sof_ipc_buffer source_desc = {
+		.size = 64
+	};
+	struct sof_ipc_buffer sink_desc = {
+		.size = 48
+	};
+
+	struct comp_buffer *source = buffer_new(&source_desc);
+	struct comp_buffer *sink = buffer_new(&sink_desc);
+	int32_t *src;
+	int16_t *dst;
+	uint32_t samples = 40;
+	uint32_t n;
+	int segments = 0;
+	int i = 0;
+	int j;
+
+	assert_non_null(source);
+	assert_non_null(sink);
+
+	/* start close to the end of both buffers */
+	src = (int32_t *)source->addr + 12;
+	dst = (int16_t *)sink->addr + 20;
+
+	while (samples) {
+		n = buffer_segment_samples(source, src, sizeof(int32_t),
+					   sink, dst, sizeof(int16_t), samples);
+		assert_true(n > 0);
+		assert_true(buffer_bytes_to_wrap(source, src) >=
+			    n * sizeof(int32_t));
+		assert_true(buffer_bytes_to_wrap(sink, dst) >=
+			    n * sizeof(int16_t));
+
+		for (j = 0; j < n; j++, i++) {
+			*src++ = i;
+			*dst++ = i;
+		}
+
+		src = buffer_wrap(source, src);
+		dst = buffer_wrap(sink, dst);
+		samples -= n;
+		segments++;
+	}
+
+	/* segments of 4, 16, 8, 8 and 4 samples end at every wrap */
+	assert_int_equal(segments, 5);
+	assert_ptr_equal(src, (int32_t *)source->addr + 4);
+	assert_ptr_equal(dst, (int16_t *)sink->addr + 12);
+	assert_int_equal(((int32_t *)source->addr)[3], 39);
+	assert_int_equal(((int16_t *)sink->addr)[11], 39);
+
+	buffer_free(source);
+	buffer_free(sink);
+}
+
 int main(void)
 {
 	const struct CMUnitTest tests[] = {
 		cmocka_unit_test
-			(test_audio_buffer_write_fill_10_bytes_and_write_5)
+			(test_audio_buffer_write_fill_10_bytes_and_write_5),
+		cmocka_unit_test(test_audio_buffer_wrap_segments),
 	};
 
 	cmocka_set_message_output(CM_OUTPUT_TAP);
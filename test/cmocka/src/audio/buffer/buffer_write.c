@@ -102,12 +102,75 @@ static void test_audio_buffer_fill_10_bytes(void **state)
 	buffer_free(buf);
 }
 
+static void *inplace_ptr;
+static uint32_t inplace_bytes;
+
+static int inplace_copy(struct comp_dev *dev, struct comp_buffer *buffer,
+			void *ptr, uint32_t bytes)
+{
+	uint8_t *data = ptr;
+	uint32_t i;
+
+	(void)dev;
+
+	/* invert the new data, it must not be visible to the consumer yet */
+	assert_ptr_equal(buffer->w_ptr, ptr);
+	for (i = 0; i < bytes; i++)
+		data[i] = ~data[i];
+
+	inplace_ptr = ptr;
+	inplace_bytes = bytes;
+
+	return 0;
+}
+
+static void test_audio_buffer_produce_inplace(void **state)
+{
+	(void)state;
+
+	struct sof_ipc_buffer test_buf_desc = {
+		.size = 256
+	};
+	struct comp_driver drv = {
+		.ops = {
+			.copy_inplace = inplace_copy,
+		},
+	};
+	struct comp_dev dev = {
+		.drv = &drv,
+	};
+
+	struct comp_buffer *buf = buffer_new(&test_buf_desc);
+
+	assert_non_null(buf);
+
+	buf->bypass_comp = &dev;
+	buf->inplace = 1;
+
+	uint8_t bytes[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+	uint8_t *start = buf->w_ptr;
+	int i;
+
+	memcpy(buf->w_ptr, &bytes, 10);
+	comp_update_buffer_produce(buf, 10);
+
+	assert_ptr_equal(inplace_ptr, start);
+	assert_int_equal(inplace_bytes, 10);
+	assert_int_equal(buf->avail, 10);
+
+	for (i = 0; i < 10; i++)
+		assert_int_equal(start[i], (uint8_t)~bytes[i]);
+
+	buffer_free(buf);
+}
+
 int main(void)
 {
 	const struct CMUnitTest tests[] = {
 		cmocka_unit_test
 			(test_audio_buffer_write_10_bytes_out_of_256_and_read_back),
-		cmocka_unit_test(test_audio_buffer_fill_10_bytes)
+		cmocka_unit_test(test_audio_buffer_fill_10_bytes),
+		cmocka_unit_test(test_audio_buffer_produce_inplace)
 	};
 
 	cmocka_set_message_output(CM_OUTPUT_TAP);
@@ -34,6 +34,7 @@
 #include <config.h>
 #include <sof/alloc.h>
 #include <sof/trace.h>
+#include <sof/probe.h>
 
 #include <mock_trace.h>
 
@@ -61,4 +62,8 @@ void rfree(void *ptr)
 {
 	free(ptr);
 }
+
+void probe_produce(struct comp_buffer *buffer, void *ptr, uint32_t bytes)
+{
+}
 #endif
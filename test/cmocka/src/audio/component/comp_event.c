@@ -0,0 +1,234 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <setjmp.h>
+#include <string.h>
+#include <errno.h>
+#include <cmocka.h>
+#include <sof/audio/component.h>
+
+#define TEST_PERIOD_FRAMES	8
+#define TEST_MAX_APPLIED	8
+
+/* values set by the events in the order they were applied */
+static struct {
+	uint32_t value[TEST_MAX_APPLIED];
+	uint64_t position[TEST_MAX_APPLIED];
+	int count;
+} applied;
+
+static int test_cmd(struct comp_dev *dev, int cmd, void *data,
+		    int max_data_size)
+{
+	struct sof_ipc_ctrl_data *cdata = data;
+
+	(void)max_data_size;
+
+	assert_int_equal(cmd, COMP_CMD_SET_VALUE);
+	assert_true(applied.count < TEST_MAX_APPLIED);
+
+	applied.value[applied.count] = cdata->chanv[0].value;
+	applied.position[applied.count] = dev->event_position;
+	applied.count++;
+
+	return 0;
+}
+
+static struct comp_driver test_drv = {
+	.ops = {
+		.cmd = test_cmd,
+	},
+};
+
+static int setup(void **state)
+{
+	struct comp_dev *dev = calloc(1, sizeof(*dev));
+
+	if (!dev)
+		return -ENOMEM;
+
+	dev->drv = &test_drv;
+	spinlock_init(&dev->lock);
+	list_init(&dev->event_list);
+	memset(&applied, 0, sizeof(applied));
+
+	*state = dev;
+	return 0;
+}
+
+static int teardown(void **state)
+{
+	struct comp_dev *dev = *state;
+
+	comp_event_flush(dev);
+	free(dev);
+	return 0;
+}
+
+static void schedule_value(struct comp_dev *dev, uint64_t position,
+			   uint32_t value)
+{
+	struct {
+		struct sof_ipc_ctrl_data data;
+		struct sof_ipc_ctrl_value_chan chanv;
+	} msg;
+
+	memset(&msg, 0, sizeof(msg));
+	msg.data.rhdr.hdr.size = sizeof(msg);
+	msg.data.num_elems = 1;
+	msg.chanv.value = value;
+
+	assert_int_equal(comp_event_schedule(dev, position,
+					     COMP_CMD_SET_VALUE, &msg.data),
+			 0);
+}
+
+/* copy a period the way components do, returns the number of parts */
+static int copy_period(struct comp_dev *dev, uint32_t *parts)
+{
+	uint32_t frames = TEST_PERIOD_FRAMES;
+	uint32_t n;
+	int count = 0;
+
+	while (frames) {
+		n = comp_event_run(dev, frames);
+		assert_true(n > 0);
+		parts[count++] = n;
+		comp_event_advance(dev, n);
+		frames -= n;
+	}
+
+	return count;
+}
+
+static void test_audio_comp_event_split(void **state)
+{
+	struct comp_dev *dev = *state;
+	uint32_t parts[TEST_PERIOD_FRAMES];
+
+	/* same position events apply in the order they were scheduled */
+	schedule_value(dev, 10, 1);
+	schedule_value(dev, 5, 2);
+	schedule_value(dev, 10, 3);
+
+	assert_int_equal(copy_period(dev, parts), 2);
+	assert_int_equal(parts[0], 5);
+	assert_int_equal(parts[1], 3);
+
+	assert_int_equal(copy_period(dev, parts), 2);
+	assert_int_equal(parts[0], 2);
+	assert_int_equal(parts[1], 6);
+
+	assert_int_equal(copy_period(dev, parts), 1);
+	assert_int_equal(parts[0], TEST_PERIOD_FRAMES);
+
+	assert_int_equal(applied.count, 3);
+	assert_int_equal(applied.value[0], 2);
+	assert_int_equal(applied.position[0], 5);
+	assert_int_equal(applied.value[1], 1);
+	assert_int_equal(applied.position[1], 10);
+	assert_int_equal(applied.value[2], 3);
+	assert_int_equal(applied.position[2], 10);
+	assert_true(list_is_empty(&dev->event_list));
+}
+
+static void test_audio_comp_event_late(void **state)
+{
+	struct comp_dev *dev = *state;
+	uint32_t parts[TEST_PERIOD_FRAMES];
+
+	copy_period(dev, parts);
+
+	/* a position already passed applies before the next period */
+	schedule_value(dev, 3, 7);
+	assert_int_equal(copy_period(dev, parts), 1);
+	assert_int_equal(applied.count, 1);
+	assert_int_equal(applied.value[0], 7);
+	assert_int_equal(applied.position[0], TEST_PERIOD_FRAMES);
+}
+
+static void test_audio_comp_event_flush(void **state)
+{
+	struct comp_dev *dev = *state;
+	uint32_t parts[TEST_PERIOD_FRAMES];
+
+	schedule_value(dev, 20, 1);
+	copy_period(dev, parts);
+
+	/* reset drops queued events and restarts the position */
+	comp_event_flush(dev);
+	assert_true(list_is_empty(&dev->event_list));
+	assert_int_equal(dev->event_position, 0);
+
+	copy_period(dev, parts);
+	copy_period(dev, parts);
+	copy_period(dev, parts);
+	assert_int_equal(applied.count, 0);
+}
+
+static void test_audio_comp_event_limit(void **state)
+{
+	struct comp_dev *dev = *state;
+	struct sof_ipc_ctrl_data data;
+	int ret;
+	int i;
+
+	memset(&data, 0, sizeof(data));
+	data.rhdr.hdr.size = sizeof(data);
+
+	for (i = 0; ; i++) {
+		ret = comp_event_schedule(dev, i, COMP_CMD_SET_VALUE, &data);
+		if (ret < 0)
+			break;
+	}
+
+	assert_int_equal(ret, -ENOSPC);
+	assert_true(i > 0);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test_setup_teardown(test_audio_comp_event_split,
+						setup, teardown),
+		cmocka_unit_test_setup_teardown(test_audio_comp_event_late,
+						setup, teardown),
+		cmocka_unit_test_setup_teardown(test_audio_comp_event_flush,
+						setup, teardown),
+		cmocka_unit_test_setup_teardown(test_audio_comp_event_limit,
+						setup, teardown),
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,220 @@
+/*
+ * Copyright (c) 2018, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <math.h>
+#include <cmocka.h>
+#include <sof/audio/component.h>
+#include "conv.h"
+
+/* odd so the kernels also convert a scalar tail */
+#define CONV_TEST_SAMPLES	23
+
+struct conv_test_parameters {
+	uint32_t source_format;
+	uint32_t sink_format;
+};
+
+static const int32_t test_s32[] = {
+	INT32_MAX, INT32_MIN, 0, 1, -1, 0x7f, 0x80, -0x80, -0x81,
+	0x7fff, 0x8000, -0x8000, -0x8001, 0x12345678, -0x12345678,
+	0x7fffff80, 0x7fff8000, 0x40000000, -0x40000000,
+};
+
+static const int32_t test_s24[] = {
+	0x7fffff, 0x800000, 0, 1, 0xffffff, 0x7f, 0x80, 0xffff80, 0xffff7f,
+	0x7fff80, 0x123456, 0xedcba9, 0x00400000, 0x00c00000,
+	/* unused top byte must be ignored */
+	0x11000001, 0xff7fffff, 0x7f800000,
+};
+
+static const int16_t test_s16[] = {
+	INT16_MAX, INT16_MIN, 0, 1, -1, 0x1234, -0x1234, 0x4000, -0x4000,
+};
+
+static int32_t ref_sext24(int32_t x)
+{
+	return (int32_t)((uint32_t)x << 8) >> 8;
+}
+
+static int32_t ref_round(double x, double min, double max)
+{
+	x = floor(x + 0.5);
+
+	if (x > max)
+		return max;
+	if (x < min)
+		return min;
+	return x;
+}
+
+static void fill_source(uint32_t fmt, void *src)
+{
+	int16_t *src16 = src;
+	int32_t *src32 = src;
+	int i;
+
+	for (i = 0; i < CONV_TEST_SAMPLES; i++) {
+		switch (fmt) {
+		case SOF_IPC_FRAME_S16_LE:
+			src16[i] = test_s16[i % ARRAY_SIZE(test_s16)];
+			break;
+		case SOF_IPC_FRAME_S24_4LE:
+			src32[i] = test_s24[i % ARRAY_SIZE(test_s24)];
+			break;
+		default:
+			src32[i] = test_s32[i % ARRAY_SIZE(test_s32)];
+			break;
+		}
+	}
+}
+
+/* reference conversion of one sample, computed in double */
+static int32_t ref_convert(uint32_t source_fmt, uint32_t sink_fmt,
+			   const void *src, int i)
+{
+	double val;
+
+	switch (source_fmt) {
+	case SOF_IPC_FRAME_S16_LE:
+		val = ((const int16_t *)src)[i] * 65536.0;
+		break;
+	case SOF_IPC_FRAME_S24_4LE:
+		val = ref_sext24(((const int32_t *)src)[i]) * 256.0;
+		break;
+	default:
+		val = ((const int32_t *)src)[i];
+		break;
+	}
+
+	/* equal formats are copied as is */
+	if (source_fmt == sink_fmt)
+		return source_fmt == SOF_IPC_FRAME_S16_LE ?
+			((const int16_t *)src)[i] : ((const int32_t *)src)[i];
+
+	switch (sink_fmt) {
+	case SOF_IPC_FRAME_S16_LE:
+		return ref_round(val / 65536.0, INT16_MIN, INT16_MAX);
+	case SOF_IPC_FRAME_S24_4LE:
+		return ref_round(val / 256.0, INT24_MINVALUE, INT24_MAXVALUE);
+	default:
+		return val;
+	}
+}
+
+static void test_audio_conv(void **state)
+{
+	struct conv_test_parameters *parameters = *state;
+	struct comp_dev dev;
+	struct comp_dev *devp = &dev;
+	struct conv_data cd;
+	int32_t src[CONV_TEST_SAMPLES];
+	int32_t dst[CONV_TEST_SAMPLES];
+	int32_t out;
+	int i;
+
+	memset(&cd, 0, sizeof(cd));
+	cd.source_format = parameters->source_format;
+	cd.sink_format = parameters->sink_format;
+	comp_set_drvdata(devp, &cd);
+
+	cd.conv = conv_get_processing_function(devp);
+	assert_non_null(cd.conv);
+
+	fill_source(cd.source_format, src);
+	memset(dst, 0, sizeof(dst));
+
+	cd.conv(dst, src, CONV_TEST_SAMPLES);
+
+	for (i = 0; i < CONV_TEST_SAMPLES; i++) {
+		out = cd.sink_format == SOF_IPC_FRAME_S16_LE ?
+			((int16_t *)dst)[i] : dst[i];
+		assert_int_equal(out, ref_convert(cd.source_format,
+						  cd.sink_format, src, i));
+	}
+
+	/* nothing may be written past the last sample */
+	if (cd.sink_format == SOF_IPC_FRAME_S16_LE)
+		assert_int_equal(((int16_t *)dst)[CONV_TEST_SAMPLES], 0);
+}
+
+static void test_audio_conv_float(void **state)
+{
+	struct comp_dev dev;
+	struct comp_dev *devp = &dev;
+	struct conv_data cd;
+
+	(void)state;
+
+	memset(&cd, 0, sizeof(cd));
+	cd.source_format = SOF_IPC_FRAME_FLOAT;
+	cd.sink_format = SOF_IPC_FRAME_S32_LE;
+	comp_set_drvdata(devp, &cd);
+
+	assert_null(conv_get_processing_function(devp));
+}
+
+static struct conv_test_parameters parameters[] = {
+	{ SOF_IPC_FRAME_S16_LE,  SOF_IPC_FRAME_S16_LE },
+	{ SOF_IPC_FRAME_S16_LE,  SOF_IPC_FRAME_S24_4LE },
+	{ SOF_IPC_FRAME_S16_LE,  SOF_IPC_FRAME_S32_LE },
+	{ SOF_IPC_FRAME_S24_4LE, SOF_IPC_FRAME_S16_LE },
+	{ SOF_IPC_FRAME_S24_4LE, SOF_IPC_FRAME_S24_4LE },
+	{ SOF_IPC_FRAME_S24_4LE, SOF_IPC_FRAME_S32_LE },
+	{ SOF_IPC_FRAME_S32_LE,  SOF_IPC_FRAME_S16_LE },
+	{ SOF_IPC_FRAME_S32_LE,  SOF_IPC_FRAME_S24_4LE },
+	{ SOF_IPC_FRAME_S32_LE,  SOF_IPC_FRAME_S32_LE },
+};
+
+int main(void)
+{
+	int i;
+
+	struct CMUnitTest tests[ARRAY_SIZE(parameters) + 1];
+
+	for (i = 0; i < ARRAY_SIZE(parameters); i++) {
+		tests[i].name = "test_audio_conv";
+		tests[i].test_func = test_audio_conv;
+		tests[i].setup_func = NULL;
+		tests[i].teardown_func = NULL;
+		tests[i].initial_state = &parameters[i];
+	}
+
+	tests[i].name = "test_audio_conv_float";
+	tests[i].test_func = test_audio_conv_float;
+	tests[i].setup_func = NULL;
+	tests[i].teardown_func = NULL;
+	tests[i].initial_state = NULL;
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
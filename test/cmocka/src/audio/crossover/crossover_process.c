@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2018, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <string.h>
+#include <cmocka.h>
+#include <sof/audio/component.h>
+#include "crossover.h"
+
+/* odd so a paired kernel also handles a tail */
+#define CROSSOVER_TEST_SAMPLES	13
+
+#define CROSSOVER_TEST_Q2_30_HALF	(1 << 29)
+#define CROSSOVER_TEST_Q2_14_ONE	(1 << 14)
+
+/* y[n] = (x[n] + x[n - 1]) / 2 */
+static int32_t test_low_coef[SOF_EQ_IIR_NBIQUAD_DF2T] = {
+	0, 0, 0, CROSSOVER_TEST_Q2_30_HALF, CROSSOVER_TEST_Q2_30_HALF, 0,
+	CROSSOVER_TEST_Q2_14_ONE,
+};
+
+/* y[n] = (x[n] - x[n - 1]) / 2, the sum with the low band is x[n] */
+static int32_t test_high_coef[SOF_EQ_IIR_NBIQUAD_DF2T] = {
+	0, 0, 0, -CROSSOVER_TEST_Q2_30_HALF, CROSSOVER_TEST_Q2_30_HALF, 0,
+	CROSSOVER_TEST_Q2_14_ONE,
+};
+
+static int64_t test_delay[2][IIR_DF2T_NUM_DELAYS];
+
+/* multiples of two so the halves are exact */
+static int32_t test_sample(int i)
+{
+	return (i & 1 ? -1 : 1) * (0x100000 * (i + 1) + 2);
+}
+
+static void test_iir_init(struct iir_state_df2t *iir, int32_t *coef,
+			  int64_t *delay)
+{
+	memset(iir, 0, sizeof(*iir));
+	memset(delay, 0, IIR_DF2T_NUM_DELAYS * sizeof(int64_t));
+	iir->biquads = 1;
+	iir->biquads_in_series = 1;
+	iir->precision = SOF_EQ_IIR_PRECISION_64;
+	iir->coef = coef;
+	iir->delay = delay;
+}
+
+static void test_check_bands(const int32_t *low, const int32_t *high)
+{
+	int32_t prev = 0;
+	int32_t x;
+	int i;
+
+	for (i = 0; i < CROSSOVER_TEST_SAMPLES; i++) {
+		x = test_sample(i);
+		assert_int_equal(low[i], (x + prev) / 2);
+		assert_int_equal(high[i], (x - prev) / 2);
+		assert_int_equal(low[i] + high[i], x);
+		prev = x;
+	}
+}
+
+static void test_audio_crossover_split(void **state)
+{
+	struct iir_state_df2t lowpass;
+	struct iir_state_df2t highpass;
+	int32_t x[CROSSOVER_TEST_SAMPLES] __attribute__((aligned(8)));
+	int32_t low[CROSSOVER_TEST_SAMPLES] __attribute__((aligned(8)));
+	int32_t high[CROSSOVER_TEST_SAMPLES] __attribute__((aligned(8)));
+	int i;
+
+	(void)state;
+
+	test_iir_init(&lowpass, test_low_coef, test_delay[0]);
+	test_iir_init(&highpass, test_high_coef, test_delay[1]);
+	for (i = 0; i < CROSSOVER_TEST_SAMPLES; i++)
+		x[i] = test_sample(i);
+
+	crossover_split(&lowpass, &highpass, x, low, high,
+			CROSSOVER_TEST_SAMPLES);
+
+	test_check_bands(low, high);
+}
+
+static void test_audio_crossover_split_in_place(void **state)
+{
+	struct iir_state_df2t lowpass;
+	struct iir_state_df2t highpass;
+	int32_t x[CROSSOVER_TEST_SAMPLES] __attribute__((aligned(8)));
+	int32_t high[CROSSOVER_TEST_SAMPLES] __attribute__((aligned(8)));
+	int i;
+
+	(void)state;
+
+	test_iir_init(&lowpass, test_low_coef, test_delay[0]);
+	test_iir_init(&highpass, test_high_coef, test_delay[1]);
+	for (i = 0; i < CROSSOVER_TEST_SAMPLES; i++)
+		x[i] = test_sample(i);
+
+	/* the low band replaces the input like the next split takes it */
+	crossover_split(&lowpass, &highpass, x, x, high,
+			CROSSOVER_TEST_SAMPLES);
+
+	test_check_bands(x, high);
+}
+
+static void test_audio_crossover_split_blocks(void **state)
+{
+	struct iir_state_df2t lowpass;
+	struct iir_state_df2t highpass;
+	int32_t x[CROSSOVER_TEST_SAMPLES] __attribute__((aligned(8)));
+	int32_t low[CROSSOVER_TEST_SAMPLES] __attribute__((aligned(8)));
+	int32_t high[CROSSOVER_TEST_SAMPLES] __attribute__((aligned(8)));
+	int i;
+
+	(void)state;
+
+	test_iir_init(&lowpass, test_low_coef, test_delay[0]);
+	test_iir_init(&highpass, test_high_coef, test_delay[1]);
+	for (i = 0; i < CROSSOVER_TEST_SAMPLES; i++)
+		x[i] = test_sample(i);
+
+	/* the filter state carries over from one block to the next */
+	crossover_split(&lowpass, &highpass, x, low, high, 5);
+	crossover_split(&lowpass, &highpass, x + 5, low + 5, high + 5,
+			CROSSOVER_TEST_SAMPLES - 5);
+
+	test_check_bands(low, high);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_audio_crossover_split),
+		cmocka_unit_test(test_audio_crossover_split_in_place),
+		cmocka_unit_test(test_audio_crossover_split_blocks),
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
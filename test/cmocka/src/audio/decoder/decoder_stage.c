@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <string.h>
+#include <cmocka.h>
+#include <sof/audio/component.h>
+#include "decoder.h"
+
+#define DECODER_TEST_BUFFER	8
+
+static void setup_buffer(struct comp_buffer *buffer, uint32_t *data,
+			 uint32_t words, uint32_t start)
+{
+	memset(buffer, 0, sizeof(*buffer));
+	buffer->addr = data;
+	buffer->end_addr = data + words;
+	buffer->size = words * sizeof(uint32_t);
+	buffer->r_ptr = data + start;
+	buffer->w_ptr = data + start;
+}
+
+/* fill across the source wrap, drain across the sink wrap */
+static void test_audio_decoder_stage_wrap(void **state)
+{
+	uint32_t src_data[DECODER_TEST_BUFFER];
+	uint32_t sink_data[DECODER_TEST_BUFFER];
+	uint32_t stage_data[DECODER_TEST_BUFFER];
+	struct decoder_stage stage = { (uint8_t *)stage_data,
+				       sizeof(stage_data), 0, 0 };
+	struct comp_buffer source;
+	struct comp_buffer sink;
+	uint32_t *ptr;
+	uint32_t i;
+
+	(void)state;
+
+	setup_buffer(&source, src_data, DECODER_TEST_BUFFER, 5);
+	setup_buffer(&sink, sink_data, DECODER_TEST_BUFFER, 6);
+
+	ptr = source.r_ptr;
+	for (i = 0; i < 6; i++) {
+		*ptr = i;
+		ptr = buffer_wrap(&source, ptr + 1);
+	}
+
+	decoder_stage_fill(&stage, &source, 6 * sizeof(uint32_t));
+	assert_int_equal(decoder_stage_level(&stage), 6 * sizeof(uint32_t));
+
+	for (i = 0; i < 6; i++)
+		assert_int_equal(stage_data[i], i);
+
+	decoder_stage_drain(&stage, &sink, 4 * sizeof(uint32_t));
+	assert_int_equal(decoder_stage_level(&stage), 2 * sizeof(uint32_t));
+
+	ptr = sink.w_ptr;
+	for (i = 0; i < 4; i++) {
+		assert_int_equal(*ptr, i);
+		ptr = buffer_wrap(&sink, ptr + 1);
+	}
+}
+
+/* compaction keeps the held bytes and frees the space before them */
+static void test_audio_decoder_stage_compact(void **state)
+{
+	uint32_t sink_data[DECODER_TEST_BUFFER];
+	uint32_t stage_data[DECODER_TEST_BUFFER] = { 0, 1, 2, 3, 4, 5 };
+	struct decoder_stage stage = { (uint8_t *)stage_data,
+				       sizeof(stage_data), 0,
+				       6 * sizeof(uint32_t) };
+	struct comp_buffer sink;
+
+	(void)state;
+
+	setup_buffer(&sink, sink_data, DECODER_TEST_BUFFER, 0);
+
+	decoder_stage_drain(&stage, &sink, 4 * sizeof(uint32_t));
+	decoder_stage_compact(&stage);
+
+	assert_int_equal(stage.r, 0);
+	assert_int_equal(stage.w, 2 * sizeof(uint32_t));
+	assert_int_equal(stage_data[0], 4);
+	assert_int_equal(stage_data[1], 5);
+
+	/* an emptied stage starts over at its base */
+	decoder_stage_drain(&stage, &sink, 2 * sizeof(uint32_t));
+	assert_int_equal(stage.r, 0);
+	assert_int_equal(stage.w, 0);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_audio_decoder_stage_wrap),
+		cmocka_unit_test(test_audio_decoder_stage_compact),
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2018, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <string.h>
+#include <cmocka.h>
+#include <sof/audio/component.h>
+#include "drc.h"
+
+/* odd so a vector kernel also handles a tail */
+#define DRC_TEST_SAMPLES	13
+
+#define DRC_TEST_GAIN_ONE	(1 << 30) /* Q2.30 */
+
+static int32_t test_sample(int i)
+{
+	return (i & 1 ? -1 : 1) * (0x1000000 * (i + 1) + 77);
+}
+
+static void test_audio_drc_peak(void **state)
+{
+	int32_t x[DRC_TEST_SAMPLES] __attribute__((aligned(8)));
+	int i;
+
+	(void)state;
+
+	for (i = 0; i < DRC_TEST_SAMPLES; i++)
+		x[i] = test_sample(i);
+
+	/* the largest magnitude is the negative odd tail sample */
+	x[DRC_TEST_SAMPLES - 1] = x[DRC_TEST_SAMPLES - 2] - 1;
+	assert_int_equal(drc_peak(x, DRC_TEST_SAMPLES, 0),
+			 -x[DRC_TEST_SAMPLES - 2] + 1);
+
+	/* a larger start value is kept */
+	assert_int_equal(drc_peak(x, DRC_TEST_SAMPLES, INT32_MAX - 1),
+			 INT32_MAX - 1);
+
+	/* negative full scale saturates */
+	x[3] = INT32_MIN;
+	assert_int_equal(drc_peak(x, DRC_TEST_SAMPLES, 0), INT32_MAX);
+}
+
+static void test_audio_drc_gain_acc(void **state)
+{
+	int32_t x[DRC_TEST_SAMPLES] __attribute__((aligned(8)));
+	int32_t y[DRC_TEST_SAMPLES] __attribute__((aligned(8)));
+	int32_t step = -DRC_TEST_GAIN_ONE / 16;
+	int64_t ref;
+	int i;
+
+	(void)state;
+
+	for (i = 0; i < DRC_TEST_SAMPLES; i++) {
+		x[i] = test_sample(i);
+		y[i] = 1000 * i;
+	}
+
+	/* gain ramps from 1.0 towards 0.25 over the samples */
+	drc_gain_acc(x, y, DRC_TEST_SAMPLES, DRC_TEST_GAIN_ONE, step);
+
+	for (i = 0; i < DRC_TEST_SAMPLES; i++) {
+		ref = ((int64_t)test_sample(i) *
+		       (DRC_TEST_GAIN_ONE + i * step)) >> 30;
+		assert_int_equal(y[i], ref + 1000 * i);
+	}
+}
+
+static void test_audio_drc_gain_acc_saturate(void **state)
+{
+	int32_t x[DRC_TEST_SAMPLES] __attribute__((aligned(8)));
+	int32_t y[DRC_TEST_SAMPLES] __attribute__((aligned(8)));
+	int i;
+
+	(void)state;
+
+	for (i = 0; i < DRC_TEST_SAMPLES; i++) {
+		x[i] = i & 1 ? INT32_MIN : INT32_MAX;
+		y[i] = i & 1 ? -1000 : 1000;
+	}
+
+	/* +6 dB of a full scale sample and the sum both saturate */
+	drc_gain_acc(x, y, DRC_TEST_SAMPLES, INT32_MAX, 0);
+
+	for (i = 0; i < DRC_TEST_SAMPLES; i++)
+		assert_int_equal(y[i], i & 1 ? INT32_MIN : INT32_MAX);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_audio_drc_peak),
+		cmocka_unit_test(test_audio_drc_gain_acc),
+		cmocka_unit_test(test_audio_drc_gain_acc_saturate),
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2018, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <string.h>
+#include <cmocka.h>
+#include <sof/audio/component.h>
+#include "kpb.h"
+
+/* a period of 3 words doesn't divide the 8 word stream buffers */
+#define KPB_TEST_PERIOD		(3 * sizeof(uint32_t))
+#define KPB_TEST_BUFFER		8
+
+static void setup_buffer(struct comp_buffer *buffer, uint32_t *data,
+			 uint32_t words, uint32_t start)
+{
+	memset(buffer, 0, sizeof(*buffer));
+	buffer->addr = data;
+	buffer->end_addr = data + words;
+	buffer->size = words * sizeof(uint32_t);
+	buffer->r_ptr = data + start;
+	buffer->w_ptr = data + start;
+}
+
+/* write periods of a counting stream through a 8 word source buffer */
+static void write_periods(struct kpb_hist *hist, uint32_t periods,
+			  uint32_t *count)
+{
+	uint32_t data[KPB_TEST_BUFFER];
+	struct comp_buffer source;
+	uint32_t *ptr;
+	uint32_t i;
+	uint32_t j;
+
+	setup_buffer(&source, data, KPB_TEST_BUFFER, 5);
+
+	for (i = 0; i < periods; i++) {
+		ptr = source.r_ptr;
+		for (j = 0; j < KPB_TEST_PERIOD / sizeof(uint32_t); j++) {
+			*ptr = (*count)++;
+			ptr = buffer_wrap(&source, ptr + 1);
+		}
+
+		kpb_hist_write(hist, &source, KPB_TEST_PERIOD);
+		source.r_ptr = ptr;
+	}
+}
+
+/* read bytes of history through a 8 word sink and check the stream */
+static void check_read(struct kpb_hist *hist, uint32_t bytes,
+		       uint32_t first)
+{
+	uint32_t data[KPB_TEST_BUFFER];
+	struct comp_buffer sink;
+	uint32_t *ptr;
+	uint32_t n;
+	uint32_t j;
+
+	setup_buffer(&sink, data, KPB_TEST_BUFFER, 6);
+
+	while (bytes) {
+		n = MIN(bytes, KPB_TEST_PERIOD);
+		ptr = sink.w_ptr;
+		kpb_hist_read(hist, &sink, n);
+
+		for (j = 0; j < n / sizeof(uint32_t); j++) {
+			assert_int_equal(*ptr, first++);
+			ptr = buffer_wrap(&sink, ptr + 1);
+		}
+
+		sink.w_ptr = ptr;
+		bytes -= n;
+	}
+}
+
+static void test_audio_kpb_hist_fifo(void **state)
+{
+	uint32_t ring[4 * KPB_TEST_PERIOD / sizeof(uint32_t)];
+	struct kpb_hist hist = { (uint8_t *)ring, sizeof(ring), 0, 0 };
+	uint32_t count = 0;
+
+	(void)state;
+
+	write_periods(&hist, 3, &count);
+	assert_int_equal(hist.level, 3 * KPB_TEST_PERIOD);
+
+	check_read(&hist, 2 * KPB_TEST_PERIOD, 0);
+	assert_int_equal(hist.level, KPB_TEST_PERIOD);
+
+	/* wraps the ring write offset */
+	write_periods(&hist, 2, &count);
+	check_read(&hist, 3 * KPB_TEST_PERIOD, 6);
+	assert_int_equal(hist.level, 0);
+}
+
+static void test_audio_kpb_hist_overwrite(void **state)
+{
+	uint32_t ring[4 * KPB_TEST_PERIOD / sizeof(uint32_t)];
+	struct kpb_hist hist = { (uint8_t *)ring, sizeof(ring), 0, 0 };
+	uint32_t count = 0;
+
+	(void)state;
+
+	/* the oldest 3 periods are dropped */
+	write_periods(&hist, 7, &count);
+	assert_int_equal(hist.level, sizeof(ring));
+
+	check_read(&hist, sizeof(ring), 9);
+	assert_int_equal(hist.level, 0);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_audio_kpb_hist_fifo),
+		cmocka_unit_test(test_audio_kpb_hist_overwrite),
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
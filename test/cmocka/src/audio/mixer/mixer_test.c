@@ -41,6 +41,7 @@
 #include <sof/audio/format.h>
 
 #include "comp_mock.h"
+#include "mixer.h"
 
 #define MIX_TEST_SAMPLES 32
 
@@ -80,6 +81,8 @@ struct source {
 struct mix_test_case {
 	int num_sources;
 	int num_chans;
+	uint32_t frame_fmt;
+	uint32_t underrun;
 	const char *name;
 	struct source *sources;
 };
@@ -88,12 +91,24 @@ struct mix_test_case {
 	{ \
 		.num_sources = (_num_sources), \
 		.num_chans = (_num_chans), \
+		.frame_fmt = SOF_IPC_FRAME_S32_LE, \
 		.name = ("test_audio_mixer_copy_" \
 			 #_num_sources "_srcs_" \
 			 #_num_chans "ch"), \
 		.sources = NULL \
 	}
 
+#define TEST_CASE_S16(_num_sources, _num_chans) \
+	{ \
+		.num_sources = (_num_sources), \
+		.num_chans = (_num_chans), \
+		.frame_fmt = SOF_IPC_FRAME_S16_LE, \
+		.name = ("test_audio_mixer_copy_s16_" \
+			 #_num_sources "_srcs_" \
+			 #_num_chans "ch"), \
+		.sources = NULL \
+	}
+
 static struct mix_test_case mix_test_cases[] = {
 	TEST_CASE(1, 2),
 	TEST_CASE(1, 4),
@@ -104,7 +119,41 @@ static struct mix_test_case mix_test_cases[] = {
 	TEST_CASE(3, 2),
 	TEST_CASE(4, 2),
 	TEST_CASE(6, 2),
-	TEST_CASE(8, 2)
+	TEST_CASE(8, 2),
+	TEST_CASE_S16(2, 2),
+	TEST_CASE_S16(3, 2),
+	TEST_CASE_S16(4, 2),
+	TEST_CASE_S16(2, 1)
+};
+
+/* sources and sink wrap at different points within the period */
+static struct mix_test_case mix_wrap_test_case = TEST_CASE(3, 2);
+
+/* second source is late for the period */
+static struct mix_test_case mix_late_test_case = {
+	.num_sources = 2,
+	.num_chans = 2,
+	.frame_fmt = SOF_IPC_FRAME_S32_LE,
+	.underrun = SOF_MIXER_UNDERRUN_SILENCE,
+	.name = "test_audio_mixer_copy_late_source",
+};
+
+/* second source leaves and joins the running mix */
+static struct mix_test_case mix_attach_test_case = {
+	.num_sources = 2,
+	.num_chans = 2,
+	.frame_fmt = SOF_IPC_FRAME_S32_LE,
+	.underrun = SOF_MIXER_UNDERRUN_XRUN,
+	.name = "test_audio_mixer_copy_attach",
+};
+
+/* s16 source at 0dB and s32 source at -6dB mixed to s32 */
+static struct mix_test_case mix_convert_test_case = {
+	.num_sources = 2,
+	.num_chans = 2,
+	.frame_fmt = SOF_IPC_FRAME_S32_LE,
+	.underrun = SOF_MIXER_UNDERRUN_XRUN,
+	.name = "test_audio_mixer_copy_convert",
 };
 
 static struct sof_ipc_comp mock_comp = {
@@ -147,6 +196,7 @@ static void create_sources(struct mix_test_case *tc)
 		};
 
 		src->comp = create_comp(&mock_comp, &drv_mock);
+		src->comp->params.frame_fmt = tc->frame_fmt;
 		src->buf = buffer_new(&buf);
 
 		src->buf->source = src->comp;
@@ -196,15 +246,16 @@ static int test_setup(void **state)
 		.config = {
 			.hdr = {
 				.size = sizeof(struct sof_ipc_comp_config)
-			}
+			},
+			.periods_sink = 1,
 		}
 	};
+	struct mix_test_case *tc = *((struct mix_test_case **)state);
 
+	mixer.underrun = tc ? tc->underrun : SOF_MIXER_UNDERRUN_XRUN;
 	mixer_dev_mock = create_comp((struct sof_ipc_comp *)&mixer,
 				     &mixer_drv_mock);
 
-	struct mix_test_case *tc = *((struct mix_test_case **)state);
-
 	if (tc) {
 		struct sof_ipc_buffer buf = {
 			.size = (MIX_TEST_SAMPLES * sizeof(uint32_t)) *
@@ -217,6 +268,7 @@ static int test_setup(void **state)
 		post_mixer_comp = create_comp(&mock_comp, &drv_mock);
 
 		activate_periph_comps(tc);
+		mixer_dev_mock->params.frame_fmt = tc->frame_fmt;
 		mixer_drv_mock.ops.prepare(mixer_dev_mock);
 
 		mixer_dev_mock->state = COMP_STATE_ACTIVE;
@@ -264,6 +316,38 @@ static void test_audio_mixer_prepare_no_sources(void **state)
 	assert_int_equal(downstream, 0);
 }
 
+static void test_audio_mixer_copy_s16(struct mix_test_case *tc)
+{
+	int src_idx;
+	int smp;
+
+	for (src_idx = 0; src_idx < tc->num_sources; ++src_idx) {
+		int16_t *samples = tc->sources[src_idx].buf->addr;
+
+		for (smp = 0; smp < MIX_TEST_SAMPLES; ++smp) {
+			double rad = M_PI / (180.0 / (smp * (src_idx + 1)));
+
+			samples[smp] = sin(rad) * INT16_MAX;
+		}
+	}
+
+	mixer_drv_mock.ops.copy(mixer_dev_mock);
+
+	for (smp = 0; smp < MIX_TEST_SAMPLES; ++smp) {
+		int32_t sum = 0;
+
+		for (src_idx = 0; src_idx < tc->num_sources; ++src_idx) {
+			int16_t *samples = tc->sources[src_idx].buf->addr;
+
+			sum += samples[smp];
+		}
+
+		int16_t *out_samples = post_mixer_buf->addr;
+
+		assert_int_equal(out_samples[smp], sat_int16(sum));
+	}
+}
+
 static void test_audio_mixer_copy(void **state)
 {
 	int src_idx;
@@ -272,6 +356,11 @@ static void test_audio_mixer_copy(void **state)
 
 	mixer_dev_mock->params.channels = tc->num_chans;
 
+	if (tc->frame_fmt == SOF_IPC_FRAME_S16_LE) {
+		test_audio_mixer_copy_s16(tc);
+		return;
+	}
+
 	for (src_idx = 0; src_idx < tc->num_sources; ++src_idx) {
 		uint32_t *samples = tc->sources[src_idx].buf->addr;
 
@@ -303,9 +392,208 @@ static void test_audio_mixer_copy(void **state)
 	}
 }
 
+static void test_audio_mixer_copy_wrap(void **state)
+{
+	struct mix_test_case *tc = *((struct mix_test_case **)state);
+	int samples = MIX_TEST_SAMPLES * tc->num_chans;
+	int src_idx;
+	int smp;
+	int offset;
+
+	mixer_dev_mock->params.channels = tc->num_chans;
+
+	for (src_idx = 0; src_idx < tc->num_sources; ++src_idx) {
+		struct comp_buffer *buf = tc->sources[src_idx].buf;
+		int32_t *data = buf->addr;
+
+		for (smp = 0; smp < samples; ++smp)
+			data[smp] = (src_idx + 1) * 1000 + smp;
+
+		/* start reading a few samples before the buffer end */
+		buf->r_ptr = data + samples - (src_idx * 2 + 3);
+	}
+
+	offset = samples - 5;
+	post_mixer_buf->w_ptr = (int32_t *)post_mixer_buf->addr + offset;
+
+	mixer_drv_mock.ops.copy(mixer_dev_mock);
+
+	for (smp = 0; smp < samples; ++smp) {
+		int32_t *out_samples = post_mixer_buf->addr;
+		int32_t sum = 0;
+
+		for (src_idx = 0; src_idx < tc->num_sources; ++src_idx) {
+			int start = samples - (src_idx * 2 + 3);
+
+			sum += (src_idx + 1) * 1000 + (start + smp) % samples;
+		}
+
+		assert_int_equal(out_samples[(offset + smp) % samples], sum);
+	}
+}
+
+static void test_audio_mixer_copy_late_source(void **state)
+{
+	struct mix_test_case *tc = *((struct mix_test_case **)state);
+	struct comp_buffer *on_time = tc->sources[0].buf;
+	struct comp_buffer *late = tc->sources[1].buf;
+	int samples = MIX_TEST_SAMPLES * tc->num_chans;
+	int32_t *out_samples = post_mixer_buf->addr;
+	int32_t *in_samples = on_time->addr;
+	int32_t *late_samples = late->addr;
+	int smp;
+
+	mixer_dev_mock->params.channels = tc->num_chans;
+	assert_int_equal(mixer_drv_mock.ops.params(mixer_dev_mock), 0);
+
+	for (smp = 0; smp < samples; ++smp) {
+		in_samples[smp] = smp + 1;
+		late_samples[smp] = 1000;
+	}
+
+	comp_update_buffer_produce(on_time, on_time->size);
+	comp_update_buffer_produce(late, late->size / 2);
+
+	assert_int_equal(mixer_drv_mock.ops.copy(mixer_dev_mock),
+			 MIX_TEST_SAMPLES);
+
+	/* late source is silent and keeps its data for the next period */
+	for (smp = 0; smp < samples; ++smp)
+		assert_int_equal(out_samples[smp], smp + 1);
+
+	assert_int_equal(on_time->avail, 0);
+	assert_int_equal(late->avail, late->size / 2);
+	assert_int_equal(post_mixer_buf->avail, post_mixer_buf->size);
+}
+
+/* mix a period with the first source at smp and the second at 1 << 20
+ * if it has data, check the second is mixed with the gain ramp */
+static void mix_attach_period(struct mix_test_case *tc, int fill,
+			      int32_t start, int32_t end)
+{
+	struct comp_buffer *first = tc->sources[0].buf;
+	struct comp_buffer *second = tc->sources[1].buf;
+	int samples = MIX_TEST_SAMPLES * tc->num_chans;
+	int32_t *out_samples = post_mixer_buf->addr;
+	int32_t *first_samples = first->addr;
+	int32_t *second_samples = second->addr;
+	int32_t gain;
+	int smp;
+
+	for (smp = 0; smp < samples; ++smp) {
+		first_samples[smp] = smp;
+		second_samples[smp] = 1 << 20;
+	}
+
+	comp_update_buffer_produce(first, first->size);
+	if (fill)
+		comp_update_buffer_produce(second, second->size);
+
+	assert_int_equal(mixer_drv_mock.ops.copy(mixer_dev_mock),
+			 MIX_TEST_SAMPLES);
+
+	for (smp = 0; smp < samples; ++smp) {
+		gain = start + (end - start) * (smp / tc->num_chans) /
+			MIX_TEST_SAMPLES;
+		assert_int_equal(out_samples[smp], smp + (gain << 5));
+	}
+
+	assert_int_equal(first->avail, 0);
+	comp_update_buffer_consume(post_mixer_buf, post_mixer_buf->avail);
+}
+
+static void test_audio_mixer_copy_attach(void **state)
+{
+	struct mix_test_case *tc = *((struct mix_test_case **)state);
+	struct comp_dev *second = tc->sources[1].comp;
+	struct comp_buffer *second_buf = tc->sources[1].buf;
+
+	mixer_dev_mock->params.channels = tc->num_chans;
+	assert_int_equal(mixer_drv_mock.ops.params(mixer_dev_mock), 0);
+
+	/* stopped with nothing left is dropped at once */
+	second->state = COMP_STATE_PREPARE;
+	assert_int_equal(mixer_drv_mock.ops.trigger(mixer_dev_mock,
+						    COMP_TRIGGER_STOP), 1);
+	assert_int_equal(mixer_dev_mock->state, COMP_STATE_ACTIVE);
+	mix_attach_period(tc, 0, 0, 0);
+
+	/* started, the mixer stays running and waits for a whole period */
+	second->state = COMP_STATE_ACTIVE;
+	assert_int_equal(mixer_drv_mock.ops.trigger(mixer_dev_mock,
+						    COMP_TRIGGER_START), 1);
+	mix_attach_period(tc, 0, 0, 0);
+
+	/* joins ramped in, then mixed at full gain */
+	mix_attach_period(tc, 1, 0, MIXER_GAIN_ONE);
+	assert_int_equal(second_buf->avail, 0);
+	mix_attach_period(tc, 1, MIXER_GAIN_ONE, MIXER_GAIN_ONE);
+
+	/* stopped with a period left ramps out, then is gone */
+	second->state = COMP_STATE_PREPARE;
+	assert_int_equal(mixer_drv_mock.ops.trigger(mixer_dev_mock,
+						    COMP_TRIGGER_STOP), 1);
+	mix_attach_period(tc, 1, MIXER_GAIN_ONE, 0);
+	mix_attach_period(tc, 1, 0, 0);
+	assert_int_equal(second_buf->avail, second_buf->size);
+}
+
+static void test_audio_mixer_copy_convert(void **state)
+{
+	struct mix_test_case *tc = *((struct mix_test_case **)state);
+	struct comp_buffer *s16_buf = tc->sources[0].buf;
+	struct comp_buffer *s32_buf = tc->sources[1].buf;
+	int samples = MIX_TEST_SAMPLES * tc->num_chans;
+	int32_t *out_samples = post_mixer_buf->addr;
+	int16_t *s16_samples = s16_buf->addr;
+	int32_t *s32_samples = s32_buf->addr;
+	struct sof_ipc_ctrl_data *cdata;
+	int smp;
+
+	cdata = calloc(1, sizeof(*cdata) + sizeof(cdata->chanv[0]));
+	cdata->cmd = SOF_CTRL_CMD_VOLUME;
+	cdata->num_elems = 1;
+	cdata->chanv[0].channel = 2;
+	cdata->chanv[0].value = MIXER_VOLUME_ZERO_DB / 2;
+	assert_int_equal(mixer_drv_mock.ops.cmd(mixer_dev_mock,
+						COMP_CMD_SET_VALUE, cdata,
+						sizeof(*cdata) +
+						sizeof(cdata->chanv[0])), 0);
+	free(cdata);
+
+	/* sources of pipelines 1 and 2, prepared again with their formats */
+	tc->sources[0].comp->params.frame_fmt = SOF_IPC_FRAME_S16_LE;
+	tc->sources[0].comp->comp.pipeline_id = 1;
+	tc->sources[1].comp->comp.pipeline_id = 2;
+	mixer_dev_mock->state = COMP_STATE_PREPARE;
+	mixer_drv_mock.ops.prepare(mixer_dev_mock);
+	mixer_dev_mock->state = COMP_STATE_ACTIVE;
+
+	mixer_dev_mock->params.channels = tc->num_chans;
+	assert_int_equal(mixer_drv_mock.ops.params(mixer_dev_mock), 0);
+
+	for (smp = 0; smp < samples; ++smp) {
+		s16_samples[smp] = smp * 100 - 1000;
+		s32_samples[smp] = 1 << 20;
+	}
+
+	comp_update_buffer_produce(s16_buf, samples * sizeof(int16_t));
+	comp_update_buffer_produce(s32_buf, s32_buf->size);
+
+	assert_int_equal(mixer_drv_mock.ops.copy(mixer_dev_mock),
+			 MIX_TEST_SAMPLES);
+
+	for (smp = 0; smp < samples; ++smp)
+		assert_int_equal(out_samples[smp],
+				 ((smp * 100 - 1000) << 16) + (1 << 19));
+
+	assert_int_equal(s16_buf->avail, 0);
+	assert_int_equal(s32_buf->avail, 0);
+}
+
 int main(void)
 {
-	struct CMUnitTest tests[ARRAY_SIZE(mix_test_cases) + 2];
+	struct CMUnitTest tests[ARRAY_SIZE(mix_test_cases) + 6];
 
 	int i;
 	int cur_test_case = 0;
@@ -322,7 +610,31 @@ int main(void)
 	tests[1].teardown_func = test_teardown;
 	tests[1].name = "test_audio_mixer_prepare_no_sources";
 
-	for (i = 2; i < ARRAY_SIZE(tests); (++i, ++cur_test_case)) {
+	tests[2].test_func = test_audio_mixer_copy_wrap;
+	tests[2].initial_state = &mix_wrap_test_case;
+	tests[2].setup_func = test_setup;
+	tests[2].teardown_func = test_teardown;
+	tests[2].name = "test_audio_mixer_copy_wrap";
+
+	tests[3].test_func = test_audio_mixer_copy_late_source;
+	tests[3].initial_state = &mix_late_test_case;
+	tests[3].setup_func = test_setup;
+	tests[3].teardown_func = test_teardown;
+	tests[3].name = mix_late_test_case.name;
+
+	tests[4].test_func = test_audio_mixer_copy_attach;
+	tests[4].initial_state = &mix_attach_test_case;
+	tests[4].setup_func = test_setup;
+	tests[4].teardown_func = test_teardown;
+	tests[4].name = mix_attach_test_case.name;
+
+	tests[5].test_func = test_audio_mixer_copy_convert;
+	tests[5].initial_state = &mix_convert_test_case;
+	tests[5].setup_func = test_setup;
+	tests[5].teardown_func = test_teardown;
+	tests[5].name = mix_convert_test_case.name;
+
+	for (i = 6; i < ARRAY_SIZE(tests); (++i, ++cur_test_case)) {
 		tests[i].test_func = test_audio_mixer_copy;
 		tests[i].initial_state = &mix_test_cases[cur_test_case];
 		tests[i].setup_func = test_setup;
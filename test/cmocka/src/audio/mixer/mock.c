@@ -35,6 +35,7 @@
 
 #include <sof/alloc.h>
 #include <sof/audio/component.h>
+#include <sof/probe.h>
 
 #include "comp_mock.h"
 
@@ -75,3 +76,7 @@ int comp_set_state(struct comp_dev *dev, int cmd)
 void work_schedule_default(struct work *w, uint64_t timeout)
 {
 }
+
+void probe_produce(struct comp_buffer *buffer, void *ptr, uint32_t bytes)
+{
+}
@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2018, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <string.h>
+#include <cmocka.h>
+#include <sof/audio/component.h>
+#include "mux.h"
+
+/* odd so a 32 bit vector kernel can't round the count */
+#define MUX_TEST_FRAMES		13
+
+struct mux_test_parameters {
+	uint32_t sample_bytes;
+	uint32_t offset;
+};
+
+static void setup_route(struct mux_route *route, uint32_t offset)
+{
+	route->wide_channels = 4;
+	route->channels = 2;
+	route->offset = offset;
+	route->map[0] = offset;
+	route->map[1] = offset + 1;
+}
+
+/* sample value unique to the frame and channel */
+static int32_t test_sample(uint32_t frame, uint32_t ch)
+{
+	return (int32_t)(0x10000 * frame + ch + 1) * -3;
+}
+
+static int32_t get_sample(uint32_t bytes, const void *ptr, uint32_t i)
+{
+	return bytes == sizeof(int16_t) ? ((const int16_t *)ptr)[i] :
+		((const int32_t *)ptr)[i];
+}
+
+static void set_sample(uint32_t bytes, void *ptr, uint32_t i, int32_t val)
+{
+	if (bytes == sizeof(int16_t))
+		((int16_t *)ptr)[i] = val;
+	else
+		((int32_t *)ptr)[i] = val;
+}
+
+static void test_audio_mux_gather(void **state)
+{
+	struct mux_test_parameters *params = *state;
+	uint32_t bytes = params->sample_bytes;
+	const struct mux_func_map *func;
+	struct mux_route route;
+	int64_t wide[MUX_TEST_FRAMES * 2];
+	int64_t narrow[MUX_TEST_FRAMES + 1];
+	uint32_t frame;
+	uint32_t ch;
+
+	setup_route(&route, params->offset);
+	func = mux_get_processing_function(bytes, &route);
+	assert_non_null(func);
+
+	for (frame = 0; frame < MUX_TEST_FRAMES; frame++)
+		for (ch = 0; ch < 4; ch++)
+			set_sample(bytes, wide, frame * 4 + ch,
+				   test_sample(frame, ch));
+	memset(narrow, 0x55, sizeof(narrow));
+
+	func->gather(&route, wide, narrow, MUX_TEST_FRAMES);
+
+	for (frame = 0; frame < MUX_TEST_FRAMES; frame++)
+		for (ch = 0; ch < 2; ch++)
+			assert_int_equal(get_sample(bytes, narrow,
+						    frame * 2 + ch),
+					 get_sample(bytes, wide, frame * 4 +
+						    params->offset + ch));
+
+	/* nothing written after the last frame */
+	assert_int_equal(get_sample(bytes, narrow, MUX_TEST_FRAMES * 2),
+			 get_sample(bytes, narrow, MUX_TEST_FRAMES * 2 + 1));
+}
+
+static void test_audio_mux_scatter(void **state)
+{
+	struct mux_test_parameters *params = *state;
+	uint32_t bytes = params->sample_bytes;
+	const struct mux_func_map *func;
+	struct mux_route route;
+	int64_t wide[MUX_TEST_FRAMES * 2];
+	int64_t narrow[MUX_TEST_FRAMES];
+	uint32_t frame;
+	uint32_t ch;
+	int32_t ref;
+
+	setup_route(&route, params->offset);
+	func = mux_get_processing_function(bytes, &route);
+	assert_non_null(func);
+
+	for (frame = 0; frame < MUX_TEST_FRAMES; frame++)
+		for (ch = 0; ch < 2; ch++)
+			set_sample(bytes, narrow, frame * 2 + ch,
+				   test_sample(frame, ch));
+	memset(wide, 0, sizeof(wide));
+
+	func->scatter(&route, wide, narrow, MUX_TEST_FRAMES);
+
+	/* other mux side channels are left alone */
+	for (frame = 0; frame < MUX_TEST_FRAMES; frame++) {
+		for (ch = 0; ch < 4; ch++) {
+			if (ch >= params->offset && ch < params->offset + 2)
+				ref = get_sample(bytes, narrow, frame * 2 +
+						 ch - params->offset);
+			else
+				ref = 0;
+
+			assert_int_equal(get_sample(bytes, wide,
+						    frame * 4 + ch), ref);
+		}
+	}
+}
+
+static void test_audio_mux_no_function(void **state)
+{
+	struct mux_route route = {
+		.wide_channels = 6,
+		.channels = 2,
+	};
+
+	(void)state;
+
+	/* other shapes are routed sample by sample by the component */
+	assert_null(mux_get_processing_function(sizeof(int16_t), &route));
+}
+
+static struct mux_test_parameters parameters[] = {
+	{ sizeof(int16_t), 0 },
+	{ sizeof(int16_t), 1 },
+	{ sizeof(int16_t), 2 },
+	{ sizeof(int32_t), 0 },
+	{ sizeof(int32_t), 1 },
+	{ sizeof(int32_t), 2 },
+};
+
+int main(void)
+{
+	struct CMUnitTest tests[ARRAY_SIZE(parameters) * 2 + 1];
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(parameters); i++) {
+		tests[i * 2].name = "test_audio_mux_gather";
+		tests[i * 2].test_func = test_audio_mux_gather;
+		tests[i * 2].setup_func = NULL;
+		tests[i * 2].teardown_func = NULL;
+		tests[i * 2].initial_state = &parameters[i];
+
+		tests[i * 2 + 1].name = "test_audio_mux_scatter";
+		tests[i * 2 + 1].test_func = test_audio_mux_scatter;
+		tests[i * 2 + 1].setup_func = NULL;
+		tests[i * 2 + 1].teardown_func = NULL;
+		tests[i * 2 + 1].initial_state = &parameters[i];
+	}
+
+	tests[i * 2].name = "test_audio_mux_no_function";
+	tests[i * 2].test_func = test_audio_mux_no_function;
+	tests[i * 2].setup_func = NULL;
+	tests[i * 2].teardown_func = NULL;
+	tests[i * 2].initial_state = NULL;
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2018, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <sof/audio/component.h>
+#include <sof/audio/pipeline.h>
+#include "pipeline_mocks.h"
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+static int setup(void **state)
+{
+	struct pipeline *p = calloc(sizeof(struct pipeline), 1);
+	struct comp_dev *sched_comp = calloc(sizeof(struct comp_dev), 1);
+
+	list_init(&sched_comp->bsink_list);
+	list_init(&sched_comp->bsource_list);
+	sched_comp->state = COMP_STATE_READY;
+	p->sched_comp = sched_comp;
+
+	*state = p;
+	return 0;
+}
+
+static int teardown(void **state)
+{
+	struct pipeline *p = *state;
+
+	free(p->sched_comp);
+	free(p);
+	return 0;
+}
+
+static void test_audio_pipeline_arena_alloc_zeroed(void **state)
+{
+	struct pipeline *p = *state;
+	uint8_t *ptr;
+	int i;
+
+	ptr = pipeline_arena_alloc(p, 100);
+
+	assert_non_null(ptr);
+	for (i = 0; i < 100; i++)
+		assert_int_equal(ptr[i], 0);
+}
+
+static void test_audio_pipeline_arena_alloc_no_overlap(void **state)
+{
+	struct pipeline *p = *state;
+	uint8_t *first;
+	uint8_t *second;
+
+	first = pipeline_arena_alloc(p, 30);
+	memset(first, 0xff, 30);
+	second = pipeline_arena_alloc(p, 30);
+
+	assert_non_null(first);
+	assert_non_null(second);
+	assert_true(second >= first + 30 || first >= second + 30);
+	assert_int_equal(second[0], 0);
+}
+
+static void test_audio_pipeline_arena_alloc_large(void **state)
+{
+	struct pipeline *p = *state;
+	uint8_t *small;
+	uint8_t *large;
+	size_t large_size = 64 * 1024;
+
+	small = pipeline_arena_alloc(p, 16);
+	large = pipeline_arena_alloc(p, large_size);
+
+	assert_non_null(small);
+	assert_non_null(large);
+	assert_int_equal(large[large_size - 1], 0);
+}
+
+static void test_audio_pipeline_arena_free(void **state)
+{
+	struct pipeline *p = *state;
+	int err;
+
+	pipeline_arena_alloc(p, 16);
+	assert_non_null(p->arena);
+
+	err = pipeline_free(p);
+
+	assert_int_equal(err, 0);
+	assert_null(p->arena);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test_setup_teardown(
+			test_audio_pipeline_arena_alloc_zeroed,
+			setup, teardown
+		),
+		cmocka_unit_test_setup_teardown(
+			test_audio_pipeline_arena_alloc_no_overlap,
+			setup, teardown
+		),
+		cmocka_unit_test_setup_teardown(
+			test_audio_pipeline_arena_alloc_large,
+			setup, teardown
+		),
+		cmocka_unit_test_setup_teardown(
+			test_audio_pipeline_arena_free,
+			setup, teardown
+		),
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
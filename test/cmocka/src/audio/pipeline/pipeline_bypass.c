@@ -0,0 +1,212 @@
+/*
+ * Copyright (c) 2018, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <sof/audio/component.h>
+#include <sof/audio/pipeline.h>
+#include "pipeline_mocks.h"
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+/* graph under test: first -> b0 -> eq -> b1 -> last */
+struct bypass_test_data {
+	struct pipeline p;
+	struct comp_driver drv;
+	struct comp_dev first;
+	struct comp_dev eq;
+	struct comp_dev last;
+	struct comp_buffer b0;
+	struct comp_buffer b1;
+};
+
+static int mock_op(struct comp_dev *dev)
+{
+	(void)dev;
+	return 0;
+}
+
+static void init_comp(struct bypass_test_data *data, struct comp_dev *dev,
+		      int direction)
+{
+	list_init(&dev->bsource_list);
+	list_init(&dev->bsink_list);
+	dev->drv = &data->drv;
+	dev->pipeline = &data->p;
+	dev->state = COMP_STATE_READY;
+	dev->params.direction = direction;
+}
+
+static void connect(struct comp_dev *source, struct comp_buffer *buffer,
+		    struct comp_dev *sink)
+{
+	buffer->source = source;
+	buffer->sink = sink;
+	buffer->connected = 1;
+	list_item_append(&buffer->source_list, &source->bsink_list);
+	list_item_append(&buffer->sink_list, &sink->bsource_list);
+}
+
+static struct bypass_test_data *setup_graph(int direction)
+{
+	struct bypass_test_data *data = calloc(sizeof(*data), 1);
+
+	data->drv.ops.prepare = mock_op;
+	data->drv.ops.reset = mock_op;
+
+	init_comp(data, &data->first, direction);
+	init_comp(data, &data->eq, direction);
+	init_comp(data, &data->last, direction);
+	data->first.is_endpoint = 1;
+	data->last.is_endpoint = 1;
+	data->eq.can_bypass = 1;
+
+	connect(&data->first, &data->b0, &data->eq);
+	connect(&data->eq, &data->b1, &data->last);
+
+	return data;
+}
+
+static int setup_playback(void **state)
+{
+	*state = setup_graph(SOF_IPC_STREAM_PLAYBACK);
+	return 0;
+}
+
+static int setup_capture(void **state)
+{
+	*state = setup_graph(SOF_IPC_STREAM_CAPTURE);
+	return 0;
+}
+
+static int teardown(void **state)
+{
+	free(*state);
+	return 0;
+}
+
+static struct comp_dev *host_comp(struct bypass_test_data *data)
+{
+	if (data->first.params.direction == SOF_IPC_STREAM_PLAYBACK)
+		return &data->first;
+
+	return &data->last;
+}
+
+static void assert_connected(struct bypass_test_data *data)
+{
+	assert_ptr_equal(data->b0.sink, &data->eq);
+	assert_ptr_equal(data->b0.bypass_comp, NULL);
+	assert_ptr_equal(list_first_item(&data->eq.bsource_list,
+					 struct comp_buffer, sink_list),
+			 &data->b0);
+	assert_ptr_equal(list_first_item(&data->last.bsource_list,
+					 struct comp_buffer, sink_list),
+			 &data->b1);
+}
+
+static void test_audio_pipeline_bypass_prepare(void **state)
+{
+	struct bypass_test_data *data = *state;
+
+	assert_int_equal(pipeline_prepare(&data->p, host_comp(data)), 0);
+
+	/* last component now reads directly from the first buffer */
+	assert_ptr_equal(data->b0.sink, &data->last);
+	assert_ptr_equal(data->b0.bypass_comp, &data->eq);
+	assert_true(list_is_empty(&data->eq.bsource_list));
+	assert_ptr_equal(list_first_item(&data->last.bsource_list,
+					 struct comp_buffer, sink_list),
+			 &data->b0);
+	assert_true(list_item_is_last(data->last.bsource_list.next,
+				      &data->last.bsource_list));
+}
+
+static void test_audio_pipeline_bypass_reset_restores(void **state)
+{
+	struct bypass_test_data *data = *state;
+
+	assert_int_equal(pipeline_prepare(&data->p, host_comp(data)), 0);
+	assert_int_equal(pipeline_reset(&data->p, host_comp(data)), 0);
+
+	assert_connected(data);
+}
+
+static void test_audio_pipeline_bypass_not_allowed(void **state)
+{
+	struct bypass_test_data *data = *state;
+
+	data->eq.can_bypass = 0;
+
+	assert_int_equal(pipeline_prepare(&data->p, host_comp(data)), 0);
+
+	assert_connected(data);
+}
+
+static void test_audio_pipeline_bypass_dma_sink(void **state)
+{
+	struct bypass_test_data *data = *state;
+
+	/* DMA descriptors of a DAI point at its own buffer */
+	data->last.is_dma_connected = 1;
+
+	assert_int_equal(pipeline_prepare(&data->p, host_comp(data)), 0);
+
+	assert_connected(data);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test_setup_teardown
+			(test_audio_pipeline_bypass_prepare,
+			 setup_playback, teardown),
+		cmocka_unit_test_setup_teardown
+			(test_audio_pipeline_bypass_reset_restores,
+			 setup_playback, teardown),
+		cmocka_unit_test_setup_teardown
+			(test_audio_pipeline_bypass_not_allowed,
+			 setup_playback, teardown),
+		cmocka_unit_test_setup_teardown
+			(test_audio_pipeline_bypass_dma_sink,
+			 setup_playback, teardown),
+		cmocka_unit_test_setup_teardown
+			(test_audio_pipeline_bypass_prepare,
+			 setup_capture, teardown),
+		cmocka_unit_test_setup_teardown
+			(test_audio_pipeline_bypass_reset_restores,
+			 setup_capture, teardown),
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -257,6 +257,46 @@ static void test_audio_pipeline_complete_connect_upstream_other_pipeline
 	assert_ptr_equal(test_data->first, result.source_comp);
 }
 
+/*Test comp -> buffer disconnect reverses the connect*/
+static void test_audio_pipeline_comp_disconnect(void **state)
+{
+	struct pipeline_connect_data *test_data = *state;
+
+	cleanup_test_data(test_data);
+
+	test_data->b2->source = NULL;
+	test_data->b2->sink = test_data->second;
+	pipeline_comp_connect(test_data->first, test_data->b2);
+	assert_int_equal(test_data->b2->connected, 1);
+
+	/*Testing component*/
+	pipeline_comp_disconnect(test_data->first, test_data->b2);
+
+	assert_null(test_data->b2->source);
+	assert_int_equal(test_data->b2->connected, 0);
+	assert_true(list_is_empty(&test_data->first->bsink_list));
+}
+
+/*Test buffer -> comp disconnect reverses the connect*/
+static void test_audio_pipeline_buffer_disconnect(void **state)
+{
+	struct pipeline_connect_data *test_data = *state;
+
+	cleanup_test_data(test_data);
+
+	test_data->b2->source = test_data->first;
+	test_data->b2->sink = NULL;
+	pipeline_buffer_connect(test_data->b2, test_data->second);
+	assert_int_equal(test_data->b2->connected, 1);
+
+	/*Testing component*/
+	pipeline_buffer_disconnect(test_data->b2, test_data->second);
+
+	assert_null(test_data->b2->sink);
+	assert_int_equal(test_data->b2->connected, 0);
+	assert_true(list_is_empty(&test_data->second->bsource_list));
+}
+
 int main(void)
 {
 	const struct CMUnitTest tests[] = {
@@ -287,6 +327,12 @@ int main(void)
 		cmocka_unit_test(
 		test_audio_pipeline_complete_connect_upstream_other_pipeline
 		),
+		cmocka_unit_test(
+		test_audio_pipeline_comp_disconnect
+		),
+		cmocka_unit_test(
+		test_audio_pipeline_buffer_disconnect
+		),
 	};
 
 	cmocka_set_message_output(CM_OUTPUT_TAP);
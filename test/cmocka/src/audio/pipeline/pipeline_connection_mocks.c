@@ -40,6 +40,10 @@ void cleanup_test_data(struct pipeline_connect_data *data)
 	list_init(&data->second->bsink_list);
 	list_init(&data->b2->sink_list);
 	list_init(&data->b2->source_list);
+
+	/* tests complete pipelines on their own stack */
+	data->first->pipeline = NULL;
+	data->second->pipeline = NULL;
 }
 
 struct pipeline_connect_data *get_standard_connect_objects(void)
@@ -35,6 +35,14 @@
 TRACE_IMPL()
 
 struct ipc *_ipc;
+struct timer *platform_timer;
+
+uint64_t platform_timer_get(struct timer *timer)
+{
+	(void)timer;
+
+	return 0;
+}
 
 void platform_dai_timestamp(struct comp_dev *dai,
 	struct sof_ipc_stream_posn *posn)
@@ -43,11 +51,14 @@ void platform_dai_timestamp(struct comp_dev *dai,
 	(void)posn;
 }
 
+/* the task runs at once, like the host scheduler */
 void schedule_task(struct task *task, uint64_t start, uint64_t deadline)
 {
 	(void)deadline;
 	(void)start;
-	(void)task;
+
+	if (task->func)
+		task->func(task->data);
 }
 
 void schedule_task_complete(struct task *task)
@@ -106,3 +117,99 @@ void heap_trace_all(int force)
 {
 	(void)force;
 }
+
+int buffer_realloc(struct comp_buffer *buffer, uint32_t size)
+{
+	(void)buffer;
+	(void)size;
+
+	return 0;
+}
+
+void buffer_fanout_join(struct comp_buffer *group, struct comp_buffer *buffer)
+{
+	(void)group;
+	(void)buffer;
+}
+
+uint32_t buffer_fanout_free_bytes(struct comp_buffer *buffer)
+{
+	(void)buffer;
+
+	return 0;
+}
+
+void buffer_fanout_reset_pos(struct comp_buffer *buffer)
+{
+	(void)buffer;
+}
+
+uint32_t buffer_loopback_avail_bytes(struct comp_buffer *buffer)
+{
+	(void)buffer;
+
+	return 0;
+}
+
+void buffer_loopback_update(struct comp_buffer *buffer)
+{
+	(void)buffer;
+}
+
+void dai_group_begin(void)
+{
+}
+
+int dai_group_end(void)
+{
+	return 0;
+}
+
+void comp_update_buffer_produce(struct comp_buffer *buffer, uint32_t bytes)
+{
+	(void)buffer;
+	(void)bytes;
+}
+
+void comp_update_buffer_consume(struct comp_buffer *buffer, uint32_t bytes)
+{
+	(void)buffer;
+	(void)bytes;
+}
+
+void comp_event_flush(struct comp_dev *dev)
+{
+	(void)dev;
+}
+
+void comp_set_period_bytes(struct comp_dev *dev, uint32_t frames,
+			   enum sof_ipc_frame *format, uint32_t *period_bytes)
+{
+	*format = dev->params.frame_fmt;
+	*period_bytes = frames * comp_frame_bytes(dev);
+}
+
+bool buffer_is_silent(struct comp_buffer *buffer, uint32_t bytes)
+{
+	const int16_t *sample = buffer->r_ptr;
+	uint32_t i;
+
+	for (i = 0; i < bytes / sizeof(int16_t); i++)
+		if (sample[i])
+			return false;
+
+	return true;
+}
+
+void buffer_fade_in(struct comp_buffer *buffer, uint32_t frames,
+		    uint32_t channels, enum sof_ipc_frame frame_fmt)
+{
+	int16_t *sample = buffer->r_ptr;
+	uint32_t i;
+
+	(void)channels;
+	(void)frame_fmt;
+
+	for (i = 0; i < frames; i++)
+		sample[i] = (sample[i] * (int32_t)((i << 15) / frames)) >> 15;
+}
@@ -44,3 +44,10 @@ void *rzalloc(int zone, uint32_t caps, size_t bytes)
 	(void)caps;
 	return calloc(bytes, 1);
 }
+
+void *_balloc(int zone, uint32_t caps, size_t bytes)
+{
+	(void)zone;
+	(void)caps;
+	return malloc(bytes);
+}
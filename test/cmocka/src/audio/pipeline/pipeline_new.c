@@ -126,6 +126,24 @@ static void test_audio_pipeline_new_ipc_data_coppy(void **state)
 	sizeof(struct sof_ipc_pipe_new));
 }
 
+static void test_audio_pipeline_new_throughput(void **state)
+{
+	struct pipeline_new_setup_data *test_data = *state;
+	struct sof_ipc_pipe_new pipe_desc = test_data->ipc_data;
+
+	pipe_desc.frames_per_sched = 48;
+	pipe_desc.deadline = 1000;
+	pipe_desc.periods_per_sched = 10;
+
+	/*Testing component*/
+	struct pipeline *result = pipeline_new(&pipe_desc,
+	test_data->comp_data);
+
+	/*Each run processes and is scheduled for all periods*/
+	assert_int_equal(result->ipc_pipe.frames_per_sched, 480);
+	assert_int_equal(result->ipc_pipe.deadline, 10000);
+}
+
 int main(void)
 {
 
@@ -135,6 +153,7 @@ int main(void)
 		cmocka_unit_test(test_audio_pipeline_new_sheduler_init),
 		cmocka_unit_test(test_audio_pipeline_new_sheduler_config),
 		cmocka_unit_test(test_audio_pipeline_new_ipc_data_coppy),
+		cmocka_unit_test(test_audio_pipeline_new_throughput),
 	};
 
 	cmocka_set_message_output(CM_OUTPUT_TAP);
@@ -0,0 +1,503 @@
+/*
+ * Copyright (c) 2018, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <sof/audio/component.h>
+#include <sof/audio/pipeline.h>
+#include "pipeline_mocks.h"
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#define MAX_COPIES	8
+#define IDLE_FRAMES	4
+
+/* graph under test: first -> b0 -> eq -> b1 -> last */
+struct sched_test_data {
+	struct pipeline p;
+	struct pipeline p2;	/* owns last in the group tests */
+	struct comp_driver drv;
+	struct comp_dev first;
+	struct comp_dev eq;
+	struct comp_dev last;
+	struct comp_buffer b0;
+	struct comp_buffer b1;
+	int16_t in[IDLE_FRAMES];
+	int16_t out[IDLE_FRAMES];
+};
+
+/* components copied by the last pipeline run, in order */
+static struct comp_dev *copied[MAX_COPIES];
+static int num_copied;
+
+static int mock_copy(struct comp_dev *dev)
+{
+	if (num_copied < MAX_COPIES)
+		copied[num_copied] = dev;
+	num_copied++;
+	return 0;
+}
+
+static int mock_trigger(struct comp_dev *dev, int cmd)
+{
+	return 0;
+}
+
+static void init_comp(struct sched_test_data *data, struct comp_dev *dev)
+{
+	list_init(&dev->bsource_list);
+	list_init(&dev->bsink_list);
+	list_init(&dev->event_list);
+	dev->drv = &data->drv;
+	dev->pipeline = &data->p;
+	dev->state = COMP_STATE_ACTIVE;
+}
+
+static void connect(struct comp_dev *source, struct comp_buffer *buffer,
+		    struct comp_dev *sink)
+{
+	buffer->source = source;
+	buffer->sink = sink;
+	buffer->connected = 1;
+	list_item_append(&buffer->source_list, &source->bsink_list);
+	list_item_append(&buffer->sink_list, &sink->bsource_list);
+}
+
+static void init_buffer(struct comp_buffer *buffer, int16_t *samples)
+{
+	buffer->addr = samples;
+	buffer->end_addr = samples + IDLE_FRAMES;
+	buffer->r_ptr = samples;
+	buffer->w_ptr = samples;
+	buffer->size = IDLE_FRAMES * sizeof(int16_t);
+	buffer->avail = buffer->size;
+	buffer->free = buffer->size;
+}
+
+static struct sched_test_data *setup_graph(void)
+{
+	struct sched_test_data *data = calloc(sizeof(*data), 1);
+	struct sof_ipc_pipe_new desc = {0};
+	struct pipeline *p = pipeline_new(&desc, NULL);
+
+	/* copies run from the pipeline task */
+	schedule_task_init(&data->p.pipe_task, p->pipe_task.func, &data->p);
+	free(p);
+
+	data->drv.ops.copy = mock_copy;
+	data->drv.ops.trigger = mock_trigger;
+
+	init_comp(data, &data->first);
+	init_comp(data, &data->eq);
+	init_comp(data, &data->last);
+	data->first.is_endpoint = 1;
+	data->last.is_endpoint = 1;
+
+	connect(&data->first, &data->b0, &data->eq);
+	connect(&data->eq, &data->b1, &data->last);
+
+	/* timer driven pipelines copy the periods their DMA reports */
+	data->p.ipc_pipe.timer_delay = 1;
+	data->p.sched_dirty = 1;
+
+	return data;
+}
+
+static int setup_playback(void **state)
+{
+	struct sched_test_data *data = setup_graph();
+
+	data->p.sched_comp = &data->first;
+	*state = data;
+	return 0;
+}
+
+static int setup_capture(void **state)
+{
+	struct sched_test_data *data = setup_graph();
+
+	data->p.sched_comp = &data->last;
+	*state = data;
+	return 0;
+}
+
+/* mono s16 periods of IDLE_FRAMES, idle after one silent period */
+static int setup_idle(void **state)
+{
+	struct sched_test_data *data = setup_graph();
+	struct comp_dev *devs[] = {&data->first, &data->eq, &data->last};
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(devs); i++) {
+		devs[i]->frames = IDLE_FRAMES;
+		devs[i]->params.frame_fmt = SOF_IPC_FRAME_S16_LE;
+		devs[i]->params.channels = 1;
+		devs[i]->params.rate = IDLE_FRAMES * 1000;
+	}
+
+	init_buffer(&data->b0, data->in);
+	init_buffer(&data->b1, data->out);
+
+	data->eq.can_idle = 1;
+	data->p.ipc_pipe.idle_ms = 1;
+	data->p.sched_comp = &data->first;
+	*state = data;
+	return 0;
+}
+
+/* capture of mono s16 periods of IDLE_FRAMES driven by sink free space */
+static int setup_pull(void **state)
+{
+	int ret = setup_idle(state);
+	struct sched_test_data *data = *state;
+
+	data->eq.can_idle = 0;
+	data->p.ipc_pipe.idle_ms = 0;
+	data->p.ipc_pipe.pull = 1;
+	data->p.sched_comp = &data->last;
+	return ret;
+}
+
+/* playback of mono s16 periods of IDLE_FRAMES started before host data */
+static int setup_fast_start(void **state)
+{
+	int ret = setup_idle(state);
+	struct sched_test_data *data = *state;
+
+	data->eq.can_idle = 0;
+	data->p.ipc_pipe.idle_ms = 0;
+	data->p.ipc_pipe.fast_start = 1;
+	data->p.start_pending = 1;
+	data->b0.avail = 0;
+	return ret;
+}
+
+/* mono s16 periods of IDLE_FRAMES with eq beyond a parked buffer */
+static int setup_parked(void **state)
+{
+	int ret = setup_idle(state);
+	struct sched_test_data *data = *state;
+
+	data->eq.can_idle = 0;
+	data->p.ipc_pipe.idle_ms = 0;
+	data->b0.parked = 1;
+	return ret;
+}
+
+/* last is the scheduling component of a second pipeline fed by the first */
+static int setup_group(void **state)
+{
+	struct sched_test_data *data = setup_graph();
+
+	data->p.sched_comp = &data->first;
+	data->p.source_comp = &data->first;
+
+	schedule_task_init(&data->p2.pipe_task, data->p.pipe_task.func,
+			   &data->p2);
+	data->p2.sched_comp = &data->last;
+	data->p2.source_comp = &data->last;
+	data->p2.sched_dirty = 1;
+	data->last.pipeline = &data->p2;
+
+	*state = data;
+	return 0;
+}
+
+static int teardown(void **state)
+{
+	free(*state);
+	return 0;
+}
+
+static void run_copy(struct sched_test_data *data)
+{
+	num_copied = 0;
+	pipeline_schedule_copy(&data->p, 0);
+}
+
+static void assert_copied_all(struct sched_test_data *data)
+{
+	assert_int_equal(num_copied, 3);
+	assert_ptr_equal(copied[0], &data->first);
+	assert_ptr_equal(copied[1], &data->eq);
+	assert_ptr_equal(copied[2], &data->last);
+}
+
+static void test_audio_pipeline_sched_order(void **state)
+{
+	struct sched_test_data *data = *state;
+
+	run_copy(data);
+	assert_copied_all(data);
+	assert_int_equal(data->p.sched_count, 3);
+
+	/* compiled schedule gives the same order */
+	run_copy(data);
+	assert_copied_all(data);
+}
+
+static void test_audio_pipeline_sched_inactive(void **state)
+{
+	struct sched_test_data *data = *state;
+
+	data->eq.state = COMP_STATE_PAUSED;
+
+	run_copy(data);
+
+	/* nothing behind a paused component is copied */
+	assert_int_equal(num_copied, 1);
+	assert_ptr_equal(copied[0], data->p.sched_comp);
+}
+
+static void test_audio_pipeline_sched_disconnect(void **state)
+{
+	struct sched_test_data *data = *state;
+
+	run_copy(data);
+	assert_copied_all(data);
+
+	pipeline_buffer_disconnect(&data->b1, &data->last);
+	assert_int_equal(data->p.sched_dirty, 1);
+
+	run_copy(data);
+
+	assert_int_equal(num_copied, 2);
+	assert_ptr_equal(copied[0], &data->first);
+	assert_ptr_equal(copied[1], &data->eq);
+}
+
+static void test_audio_pipeline_sched_periods(void **state)
+{
+	struct sched_test_data *data = *state;
+
+	/* every period the DMA moved since the last poll is copied */
+	num_copied = 0;
+	pipeline_schedule_periods(&data->p, 3);
+	assert_int_equal(num_copied, 9);
+	assert_int_equal(data->p.timer_periods, 0);
+}
+
+static void test_audio_pipeline_sched_group(void **state)
+{
+	struct sched_test_data *data = *state;
+	struct pipeline_group *g;
+
+	/* the feeding pipeline is placed first whatever the start order */
+	pipeline_trigger(&data->p2, &data->last, COMP_TRIGGER_START);
+	pipeline_trigger(&data->p, &data->first, COMP_TRIGGER_START);
+
+	g = data->p.group;
+	assert_non_null(g);
+	assert_ptr_equal(data->p2.group, g);
+	assert_int_equal(g->count, 2);
+	assert_ptr_equal(g->pipes[0], &data->p);
+	assert_ptr_equal(g->pipes[1], &data->p2);
+
+	/* one group run copies both pipelines in order */
+	num_copied = 0;
+	data->p.group_pending = 1;
+	pipeline_schedule_copy(&data->p2, 0);
+	assert_copied_all(data);
+
+	/* only the pipelines asking for a copy run */
+	num_copied = 0;
+	pipeline_schedule_copy(&data->p2, 0);
+	assert_int_equal(num_copied, 1);
+	assert_ptr_equal(copied[0], &data->last);
+
+	pipeline_trigger(&data->p, &data->first, COMP_TRIGGER_STOP);
+	assert_null(data->p.group);
+	assert_null(data->p2.group);
+	assert_int_equal(g->count, 0);
+}
+
+static void test_audio_pipeline_sched_idle(void **state)
+{
+	struct sched_test_data *data = *state;
+
+	/* first silent period is counted and processed */
+	run_copy(data);
+	assert_copied_all(data);
+	assert_int_equal(data->p.idle_frames, IDLE_FRAMES);
+
+	/* idle pipeline writes silence in place of the eq copy */
+	data->out[0] = 1;
+	run_copy(data);
+	assert_int_equal(num_copied, 2);
+	assert_ptr_equal(copied[0], &data->first);
+	assert_ptr_equal(copied[1], &data->last);
+	assert_int_equal(data->out[0], 0);
+
+	/* input that is not silent is processed right away */
+	data->in[IDLE_FRAMES - 1] = 1;
+	run_copy(data);
+	assert_copied_all(data);
+	assert_int_equal(data->p.idle_frames, 0);
+}
+
+static void test_audio_pipeline_sched_idle_event(void **state)
+{
+	struct sched_test_data *data = *state;
+	struct list_item event;
+
+	run_copy(data);
+	assert_copied_all(data);
+
+	/* pending control events are applied by the component copy */
+	list_item_append(&event, &data->eq.event_list);
+	run_copy(data);
+	assert_copied_all(data);
+	assert_int_equal(data->p.idle_frames, IDLE_FRAMES);
+}
+
+static void test_audio_pipeline_sched_pull(void **state)
+{
+	struct sched_test_data *data = *state;
+
+	run_copy(data);
+	assert_copied_all(data);
+
+	/* eq waits while its sink has no room for a period */
+	data->b1.free = 0;
+	run_copy(data);
+	assert_int_equal(num_copied, 2);
+	assert_ptr_equal(copied[0], &data->first);
+	assert_ptr_equal(copied[1], &data->last);
+
+	/* and while its source has less than a period */
+	data->b1.free = data->b1.size;
+	data->b0.avail = data->b0.size / 2;
+	run_copy(data);
+	assert_int_equal(num_copied, 2);
+
+	/* components processing partial blocks always run */
+	data->eq.can_pull = 1;
+	data->p.sched_dirty = 1;
+	run_copy(data);
+	assert_copied_all(data);
+}
+
+static void test_audio_pipeline_sched_fast_start(void **state)
+{
+	struct sched_test_data *data = *state;
+	int i;
+
+	/* eq writes silence until the host delivers a period */
+	data->out[0] = 1;
+	run_copy(data);
+	assert_int_equal(num_copied, 2);
+	assert_ptr_equal(copied[0], &data->first);
+	assert_ptr_equal(copied[1], &data->last);
+	assert_int_equal(data->out[0], 0);
+	assert_int_equal(data->p.start_pending, 1);
+
+	/* the first host period fades in */
+	for (i = 0; i < IDLE_FRAMES; i++)
+		data->in[i] = 1000;
+	data->b0.avail = data->b0.size;
+	run_copy(data);
+	assert_copied_all(data);
+	assert_int_equal(data->p.start_pending, 0);
+	assert_int_equal(data->in[0], 0);
+	assert_int_equal(data->in[IDLE_FRAMES / 2], 500);
+
+	/* and later periods run unchanged */
+	data->in[0] = 1000;
+	run_copy(data);
+	assert_copied_all(data);
+	assert_int_equal(data->in[0], 1000);
+}
+
+static void test_audio_pipeline_sched_parked(void **state)
+{
+	struct sched_test_data *data = *state;
+
+	/* parked branch writes silence in place of the eq copy */
+	data->in[0] = 1;
+	data->out[0] = 1;
+	run_copy(data);
+	assert_int_equal(num_copied, 2);
+	assert_ptr_equal(copied[0], &data->first);
+	assert_ptr_equal(copied[1], &data->last);
+	assert_int_equal(data->out[0], 0);
+
+	/* unparked branch runs from the next copy */
+	pipeline_buffer_park(&data->b0, 0);
+	assert_int_equal(data->p.sched_dirty, 1);
+	run_copy(data);
+	assert_copied_all(data);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test_setup_teardown
+			(test_audio_pipeline_sched_order,
+			 setup_playback, teardown),
+		cmocka_unit_test_setup_teardown
+			(test_audio_pipeline_sched_inactive,
+			 setup_playback, teardown),
+		cmocka_unit_test_setup_teardown
+			(test_audio_pipeline_sched_disconnect,
+			 setup_playback, teardown),
+		cmocka_unit_test_setup_teardown
+			(test_audio_pipeline_sched_order,
+			 setup_capture, teardown),
+		cmocka_unit_test_setup_teardown
+			(test_audio_pipeline_sched_inactive,
+			 setup_capture, teardown),
+		cmocka_unit_test_setup_teardown
+			(test_audio_pipeline_sched_periods,
+			 setup_playback, teardown),
+		cmocka_unit_test_setup_teardown
+			(test_audio_pipeline_sched_group,
+			 setup_group, teardown),
+		cmocka_unit_test_setup_teardown
+			(test_audio_pipeline_sched_idle,
+			 setup_idle, teardown),
+		cmocka_unit_test_setup_teardown
+			(test_audio_pipeline_sched_idle_event,
+			 setup_idle, teardown),
+		cmocka_unit_test_setup_teardown
+			(test_audio_pipeline_sched_pull,
+			 setup_pull, teardown),
+		cmocka_unit_test_setup_teardown
+			(test_audio_pipeline_sched_parked,
+			 setup_parked, teardown),
+		cmocka_unit_test_setup_teardown
+			(test_audio_pipeline_sched_fast_start,
+			 setup_fast_start, teardown),
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2018, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <string.h>
+#include <cmocka.h>
+#include <sof/audio/component.h>
+#include "voice.h"
+
+#define VOICE_TEST_FRAMES	7
+#define VOICE_TEST_CHANNELS	2
+
+#define VOICE_TEST_Q2_30_ONE	(1 << 30)
+#define VOICE_TEST_Q2_14_ONE	(1 << 14)
+
+/* y[n] = x[n] - x[n - 1], blocks DC after the first sample */
+static int32_t test_diff_coef[SOF_EQ_IIR_NBIQUAD_DF2T] = {
+	0, 0, 0, -VOICE_TEST_Q2_30_ONE, VOICE_TEST_Q2_30_ONE, 0,
+	VOICE_TEST_Q2_14_ONE,
+};
+
+static int64_t test_delay[VOICE_TEST_CHANNELS][IIR_DF2T_NUM_DELAYS];
+
+static void test_voice_init(struct voice_data *cd, int highpass)
+{
+	int ch;
+
+	memset(cd, 0, sizeof(*cd));
+	memset(test_delay, 0, sizeof(test_delay));
+
+	for (ch = 0; ch < VOICE_TEST_CHANNELS; ch++) {
+		cd->gain[ch] = SOF_VOICE_GAIN_ZERO_DB;
+		if (!highpass)
+			continue;
+
+		cd->iir[ch].biquads = 1;
+		cd->iir[ch].biquads_in_series = 1;
+		cd->iir[ch].coef = test_diff_coef;
+		cd->iir[ch].delay = test_delay[ch];
+	}
+}
+
+static void test_audio_voice_s16_gain(void **state)
+{
+	struct voice_data cd;
+	int16_t x[VOICE_TEST_FRAMES * VOICE_TEST_CHANNELS];
+	int16_t y[VOICE_TEST_FRAMES * VOICE_TEST_CHANNELS];
+	int i;
+
+	(void)state;
+
+	test_voice_init(&cd, 0);
+
+	/* +6 dB on the left, -6 dB on the right */
+	cd.gain[0] = 2 * SOF_VOICE_GAIN_ZERO_DB;
+	cd.gain[1] = SOF_VOICE_GAIN_ZERO_DB / 2;
+	for (i = 0; i < VOICE_TEST_FRAMES * VOICE_TEST_CHANNELS; i++)
+		x[i] = (i & 1 ? -1 : 1) * 1000 * (i + 1);
+
+	/* a full scale sample saturates */
+	x[0] = INT16_MAX;
+
+	voice_s16(&cd, VOICE_TEST_CHANNELS, x, y, VOICE_TEST_FRAMES);
+
+	assert_int_equal(y[0], INT16_MAX);
+	for (i = 1; i < VOICE_TEST_FRAMES * VOICE_TEST_CHANNELS; i++)
+		assert_int_equal(y[i], i & 1 ? x[i] / 2 : x[i] * 2);
+}
+
+static void test_audio_voice_s24_in_place(void **state)
+{
+	struct voice_data cd;
+	int32_t x[VOICE_TEST_FRAMES * VOICE_TEST_CHANNELS];
+	int i;
+
+	(void)state;
+
+	test_voice_init(&cd, 0);
+
+	/* unity gain in place keeps the samples */
+	for (i = 0; i < VOICE_TEST_FRAMES * VOICE_TEST_CHANNELS; i++)
+		x[i] = (i & 1 ? -1 : 1) * 100000 * (i + 1);
+
+	voice_s24(&cd, VOICE_TEST_CHANNELS, x, x, VOICE_TEST_FRAMES);
+
+	for (i = 0; i < VOICE_TEST_FRAMES * VOICE_TEST_CHANNELS; i++)
+		assert_int_equal(x[i], (i & 1 ? -1 : 1) * 100000 * (i + 1));
+}
+
+static void test_audio_voice_s32_highpass(void **state)
+{
+	struct voice_data cd;
+	int32_t x[VOICE_TEST_FRAMES * VOICE_TEST_CHANNELS];
+	int32_t y[VOICE_TEST_FRAMES * VOICE_TEST_CHANNELS];
+	int i;
+
+	(void)state;
+
+	test_voice_init(&cd, 1);
+
+	/* DC passes the first frame only, each channel has its own state */
+	for (i = 0; i < VOICE_TEST_FRAMES * VOICE_TEST_CHANNELS; i++)
+		x[i] = i & 1 ? -0x10000000 : 0x20000000;
+
+	voice_s32(&cd, VOICE_TEST_CHANNELS, x, y, VOICE_TEST_FRAMES);
+
+	assert_int_equal(y[0], 0x20000000);
+	assert_int_equal(y[1], -0x10000000);
+	for (i = VOICE_TEST_CHANNELS;
+	     i < VOICE_TEST_FRAMES * VOICE_TEST_CHANNELS; i++)
+		assert_int_equal(y[i], 0);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_audio_voice_s16_gain),
+		cmocka_unit_test(test_audio_voice_s24_in_place),
+		cmocka_unit_test(test_audio_voice_s32_highpass),
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
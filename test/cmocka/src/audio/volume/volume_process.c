@@ -86,6 +86,7 @@ static int setup(void **state)
 	cd->sink_format = parameters->sink_format;
 	cd->scale_vol = vol_get_processing_function(vol_state->dev);
 	set_volume(cd->volume, parameters->volume, parameters->channels);
+	cd->ramp = false;
 
 	/* allocate new sink buffer */
 	vol_state->sink = test_malloc(sizeof(*vol_state->sink));
@@ -331,6 +332,26 @@ static struct vol_test_parameters parameters[] = {
 	{ VOL_MAX,     2, 48, 1, SOF_IPC_FRAME_S32_LE, SOF_IPC_FRAME_S32_LE,   verify_s32_to_s24_s32 },
 	{ VOL_MAX / 2, 2, 48, 1, SOF_IPC_FRAME_S32_LE, SOF_IPC_FRAME_S32_LE,   verify_s32_to_s24_s32 },
 	{ VOL_MAX / 3, 2, 48, 1, SOF_IPC_FRAME_S32_LE, SOF_IPC_FRAME_S32_LE,   verify_s32_to_s24_s32 },
+
+	{ VOL_MAX / 2, 5, 48, 1, SOF_IPC_FRAME_S16_LE,  SOF_IPC_FRAME_S16_LE,  verify_s16_to_s16 },
+	{ VOL_MAX / 2, 5, 48, 1, SOF_IPC_FRAME_S16_LE,  SOF_IPC_FRAME_S24_4LE, verify_s16_to_sX },
+	{ VOL_MAX / 2, 5, 48, 1, SOF_IPC_FRAME_S16_LE,  SOF_IPC_FRAME_S32_LE,  verify_s16_to_sX },
+	{ VOL_MAX / 2, 5, 48, 1, SOF_IPC_FRAME_S24_4LE, SOF_IPC_FRAME_S16_LE,  verify_sX_to_s16 },
+	{ VOL_MAX / 2, 5, 48, 1, SOF_IPC_FRAME_S24_4LE, SOF_IPC_FRAME_S24_4LE, verify_s24_to_s24_s32 },
+	{ VOL_MAX / 2, 5, 48, 1, SOF_IPC_FRAME_S24_4LE, SOF_IPC_FRAME_S32_LE,  verify_s24_to_s24_s32 },
+	{ VOL_MAX / 2, 5, 48, 1, SOF_IPC_FRAME_S32_LE,  SOF_IPC_FRAME_S16_LE,  verify_sX_to_s16 },
+	{ VOL_MAX / 2, 5, 48, 1, SOF_IPC_FRAME_S32_LE,  SOF_IPC_FRAME_S24_4LE, verify_s32_to_s24_s32 },
+	{ VOL_MAX / 2, 5, 48, 1, SOF_IPC_FRAME_S32_LE,  SOF_IPC_FRAME_S32_LE,  verify_s32_to_s24_s32 },
+
+	{ VOL_MAX / 2, 6, 48, 1, SOF_IPC_FRAME_S16_LE,  SOF_IPC_FRAME_S16_LE,  verify_s16_to_s16 },
+	{ VOL_MAX / 2, 6, 48, 1, SOF_IPC_FRAME_S16_LE,  SOF_IPC_FRAME_S24_4LE, verify_s16_to_sX },
+	{ VOL_MAX / 2, 6, 48, 1, SOF_IPC_FRAME_S16_LE,  SOF_IPC_FRAME_S32_LE,  verify_s16_to_sX },
+	{ VOL_MAX / 2, 6, 48, 1, SOF_IPC_FRAME_S24_4LE, SOF_IPC_FRAME_S16_LE,  verify_sX_to_s16 },
+	{ VOL_MAX / 2, 6, 48, 1, SOF_IPC_FRAME_S24_4LE, SOF_IPC_FRAME_S24_4LE, verify_s24_to_s24_s32 },
+	{ VOL_MAX / 2, 6, 48, 1, SOF_IPC_FRAME_S24_4LE, SOF_IPC_FRAME_S32_LE,  verify_s24_to_s24_s32 },
+	{ VOL_MAX / 2, 6, 48, 1, SOF_IPC_FRAME_S32_LE,  SOF_IPC_FRAME_S16_LE,  verify_sX_to_s16 },
+	{ VOL_MAX / 2, 6, 48, 1, SOF_IPC_FRAME_S32_LE,  SOF_IPC_FRAME_S24_4LE, verify_s32_to_s24_s32 },
+	{ VOL_MAX / 2, 6, 48, 1, SOF_IPC_FRAME_S32_LE,  SOF_IPC_FRAME_S32_LE,  verify_s32_to_s24_s32 },
 };
 
 int main(void)
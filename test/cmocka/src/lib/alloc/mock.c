@@ -40,6 +40,7 @@ TRACE_IMPL()
 
 struct dma_copy;
 struct dma_sg_config;
+struct work;
 
 int rstrlen(const char *s)
 {
@@ -51,3 +52,43 @@ int rstrlen(const char *s)
 void trace_flush(void)
 {
 }
+
+int dma_copy_to_host_nowait(struct dma_copy *dc, struct dma_sg_config *host_sg,
+			    int32_t host_offset, void *local_ptr, int32_t size)
+{
+	(void)dc;
+	(void)host_sg;
+	(void)host_offset;
+	(void)local_ptr;
+
+	return size;
+}
+
+int dma_copy_from_host_nowait(struct dma_copy *dc,
+			      struct dma_sg_config *host_sg,
+			      int32_t host_offset, void *local_ptr,
+			      int32_t size)
+{
+	(void)dc;
+	(void)host_sg;
+	(void)host_offset;
+	(void)local_ptr;
+
+	return size;
+}
+
+void work_schedule_default(struct work *work, uint64_t timeout)
+{
+	(void)work;
+	(void)timeout;
+}
+
+void work_cancel_default(struct work *work)
+{
+	(void)work;
+}
+
+void arch_wait_for_interrupt(int level)
+{
+	(void)level;
+}
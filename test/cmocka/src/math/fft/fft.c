@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2018, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <math.h>
+#include <cmocka.h>
+
+#include <sof/audio/format.h>
+#include <sof/math/fft.h>
+
+#define FFT_SIZE		128
+
+/* Max error in Q1.31 LSBs */
+#define FFT_TOLERANCE		4
+#define IFFT_TOLERANCE		64
+
+static struct icomplex32 twiddle[FFT_SIZE / 2];
+static struct icomplex32 buf[FFT_SIZE];
+static double ref_re[FFT_SIZE];
+static double ref_im[FFT_SIZE];
+
+static void init_input(void)
+{
+	int i;
+
+	/* Sum of two tones and DC, peak amplitude is below 0.9 */
+	for (i = 0; i < FFT_SIZE; i++) {
+		ref_re[i] = 0.1 + 0.4 * sin(2 * M_PI * 5 * i / FFT_SIZE) +
+			0.3 * cos(2 * M_PI * 17 * i / FFT_SIZE + 0.5);
+		ref_im[i] = 0.2 * sin(2 * M_PI * 11 * i / FFT_SIZE);
+		buf[i].real = (int32_t)lrint(ref_re[i] * 2147483648.0);
+		buf[i].imag = (int32_t)lrint(ref_im[i] * 2147483648.0);
+	}
+}
+
+static void test_math_fft_forward(void **state)
+{
+	(void)state;
+
+	double re;
+	double im;
+	double a;
+	int k;
+	int n;
+
+	fft_init_twiddle(twiddle, FFT_SIZE);
+	init_input();
+	fft_execute(buf, twiddle, FFT_SIZE, false);
+
+	/* Compare to DFT scaled by 1 / FFT_SIZE */
+	for (k = 0; k < FFT_SIZE; k++) {
+		re = 0;
+		im = 0;
+		for (n = 0; n < FFT_SIZE; n++) {
+			a = -2 * M_PI * k * n / FFT_SIZE;
+			re += ref_re[n] * cos(a) - ref_im[n] * sin(a);
+			im += ref_re[n] * sin(a) + ref_im[n] * cos(a);
+		}
+
+		re = re / FFT_SIZE * 2147483648.0;
+		im = im / FFT_SIZE * 2147483648.0;
+		assert_true(fabs(buf[k].real - re) <= FFT_TOLERANCE);
+		assert_true(fabs(buf[k].imag - im) <= FFT_TOLERANCE);
+	}
+}
+
+static void test_math_fft_inverse(void **state)
+{
+	(void)state;
+
+	int i;
+
+	/* Scaled forward and unscaled inverse transform restore input */
+	fft_init_twiddle(twiddle, FFT_SIZE);
+	init_input();
+	fft_execute(buf, twiddle, FFT_SIZE, false);
+	fft_execute(buf, twiddle, FFT_SIZE, true);
+
+	for (i = 0; i < FFT_SIZE; i++) {
+		assert_true(fabs(buf[i].real - ref_re[i] * 2147483648.0) <=
+			    IFFT_TOLERANCE);
+		assert_true(fabs(buf[i].imag - ref_im[i] * 2147483648.0) <=
+			    IFFT_TOLERANCE);
+	}
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_math_fft_forward),
+		cmocka_unit_test(test_math_fft_inverse),
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
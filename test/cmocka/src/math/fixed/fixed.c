@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <math.h>
+#include <cmocka.h>
+
+#include <sof/math/fixed.h>
+
+/* odd so a vector implementation also handles a tail */
+#define N_POINTS 257
+
+#define Q16(x) ((double)(x) / 65536.0)
+
+/* error in Q16.16 LSBs relative to the exact result */
+static double lsb_err(int32_t y, double ref)
+{
+	return fabs(y - ref * 65536.0);
+}
+
+static void test_math_fixed_log2(void **state)
+{
+	(void)state;
+
+	int32_t x[N_POINTS];
+	int32_t y[N_POINTS];
+	double diff;
+	int i;
+
+	/* from 1/65536 up to just under 32768 */
+	for (i = 0; i < N_POINTS; i++)
+		x[i] = (int32_t)pow(2.0, 31.0 * i / N_POINTS);
+
+	log2_fixed_batch(x, y, N_POINTS);
+
+	for (i = 0; i < N_POINTS; i++) {
+		diff = lsb_err(y[i], log2(Q16(x[i])));
+		if (diff > 1.0)
+			printf("%s: diff for %d = %f\n", __func__, x[i], diff);
+
+		assert_true(diff <= 1.0);
+		assert_int_equal(y[i], log2_fixed(x[i]));
+	}
+
+	assert_int_equal(log2_fixed(0), INT32_MIN);
+	assert_int_equal(log2_fixed(-FIXED_ONE_Q16), INT32_MIN);
+	assert_int_equal(log2_fixed(FIXED_ONE_Q16), 0);
+}
+
+static void test_math_fixed_exp2(void **state)
+{
+	(void)state;
+
+	int32_t x[N_POINTS];
+	int32_t y[N_POINTS];
+	double ref;
+	int i;
+
+	/* from -16 up to just under 15 */
+	for (i = 0; i < N_POINTS; i++)
+		x[i] = -16 * 65536 + (int32_t)((int64_t)31 * 65536 * i /
+					       N_POINTS);
+
+	exp2_fixed_batch(x, x, N_POINTS);
+	for (i = 0; i < N_POINTS; i++) {
+		y[i] = -16 * 65536 + (int32_t)((int64_t)31 * 65536 * i /
+					       N_POINTS);
+		ref = exp2(Q16(y[i]));
+
+		/* relative accuracy for large, one LSB for small results */
+		assert_true(lsb_err(x[i], ref) <= 1.0 + ref * 65536.0 * 1e-8);
+		assert_int_equal(x[i], exp2_fixed(y[i]));
+	}
+
+	assert_int_equal(exp2_fixed(0), FIXED_ONE_Q16);
+	assert_int_equal(exp2_fixed(16 * 65536), INT32_MAX);
+	assert_int_equal(exp2_fixed(INT32_MIN), 0);
+}
+
+static void test_math_fixed_sqrt(void **state)
+{
+	(void)state;
+
+	int32_t x;
+	int i;
+
+	for (i = 0; i < N_POINTS; i++) {
+		x = (int32_t)pow(2.0, 31.0 * i / N_POINTS);
+		assert_true(lsb_err(sqrt_fixed(x), sqrt(Q16(x))) <= 0.5);
+	}
+
+	assert_int_equal(sqrt_fixed(INT32_MAX), 11863283);
+	assert_int_equal(sqrt_fixed(4 * FIXED_ONE_Q16), 2 * FIXED_ONE_Q16);
+	assert_int_equal(sqrt_fixed(-1), 0);
+}
+
+static void test_math_fixed_inv(void **state)
+{
+	(void)state;
+
+	double ref;
+	double tol;
+	int32_t x;
+	int i;
+
+	/* from 1/16384 up to 16384 with both signs */
+	for (i = 0; i < N_POINTS; i++) {
+		x = (int32_t)pow(2.0, 2.0 + 28.0 * i / (N_POINTS - 1));
+		ref = 1.0 / Q16(x);
+		tol = 1.0 + ref * 65536.0 * 1e-8;
+		assert_true(lsb_err(inv_fixed(x), ref) <= tol);
+		assert_true(lsb_err(inv_fixed(-x), -ref) <= tol);
+	}
+
+	assert_int_equal(inv_fixed(0), INT32_MAX);
+	assert_int_equal(inv_fixed(1), INT32_MAX);
+	assert_int_equal(inv_fixed(INT32_MIN), -2);
+	assert_int_equal(inv_fixed(2 * FIXED_ONE_Q16), FIXED_ONE_Q16 / 2);
+}
+
+static void test_math_fixed_db(void **state)
+{
+	(void)state;
+
+	int32_t db;
+	int32_t lin;
+	double ref;
+
+	/* -90 dB .. +90 dB in 0.5 dB steps */
+	for (db = -90 * 65536; db <= 90 * 65536; db += 32768) {
+		ref = pow(10.0, Q16(db) / 20.0);
+		lin = db2lin_fixed(db);
+		assert_true(lsb_err(lin, ref) <= 1.0 + ref * 65536.0 * 1e-5);
+
+		/* back to dB, within 0.001 dB where the gain is resolved */
+		if (lin >= 256)
+			assert_true(fabs(Q16(lin2db_fixed(lin)) -
+					 20.0 * log10(Q16(lin))) < 0.001);
+	}
+
+	assert_int_equal(db2lin_fixed(0), FIXED_ONE_Q16);
+	assert_int_equal(lin2db_fixed(FIXED_ONE_Q16), 0);
+	assert_int_equal(lin2db_fixed(0), INT32_MIN);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_math_fixed_log2),
+		cmocka_unit_test(test_math_fixed_exp2),
+		cmocka_unit_test(test_math_fixed_sqrt),
+		cmocka_unit_test(test_math_fixed_inv),
+		cmocka_unit_test(test_math_fixed_db),
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <math.h>
+#include <cmocka.h>
+
+#include <sof/audio/format.h>
+#include <sof/math/trig.h>
+
+#define CMP_TOLERANCE 0.000005
+
+/* odd so a vector implementation also handles a tail */
+#define BATCH_SIZE 361
+
+static void test_math_trig_sin_fixed_batch(void **state)
+{
+	(void)state;
+
+	int32_t w[BATCH_SIZE];
+	int32_t out[BATCH_SIZE];
+	int i;
+
+	/* whole circle in steps of a little under one degree */
+	for (i = 0; i < BATCH_SIZE; i++)
+		w[i] = (int32_t)((int64_t)PI_MUL2_Q4_28 * i / (BATCH_SIZE - 1));
+
+	sin_fixed_batch(w, out, BATCH_SIZE);
+
+	/* batch must give exactly the single sample results */
+	for (i = 0; i < BATCH_SIZE; i++) {
+		double ref = sin(Q_CONVERT_QTOF(w[i], 28));
+		double diff = fabs(Q_CONVERT_QTOF(out[i], 31) - ref);
+
+		assert_int_equal(out[i], sin_fixed(w[i]));
+
+		if (diff > CMP_TOLERANCE) {
+			printf("%s: diff for angle %d = %.10f\n", __func__,
+			       w[i], diff);
+		}
+
+		assert_true(diff <= CMP_TOLERANCE);
+	}
+
+	/* angles and results may share the array */
+	sin_fixed_batch(w, w, BATCH_SIZE);
+	for (i = 0; i < BATCH_SIZE; i++)
+		assert_int_equal(w[i], out[i]);
+}
+
+static void test_math_trig_sin_fixed_step(void **state)
+{
+	(void)state;
+
+	int32_t out[BATCH_SIZE];
+	int32_t w_step = PI_Q4_28 / 7;
+	int32_t w = PI_MUL2_Q4_28 - 3 * w_step; /* wraps on the 4th angle */
+	int64_t phase;
+	int32_t next;
+	int i;
+
+	next = sin_fixed_step(w, w_step, out, BATCH_SIZE);
+
+	/* same accumulator and wrap as the tone generator */
+	phase = w;
+	for (i = 0; i < BATCH_SIZE; i++) {
+		assert_int_equal(out[i], sin_fixed((int32_t)phase));
+		phase += w_step;
+		if (phase > PI_MUL2_Q4_28)
+			phase -= PI_MUL2_Q4_28;
+	}
+
+	assert_int_equal(next, (int32_t)phase);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_math_trig_sin_fixed_batch),
+		cmocka_unit_test(test_math_trig_sin_fixed_step)
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,151 @@
+#!/usr/bin/env python3
+
+# Tool for decoding the FW state dump streamed to the host DMA buffer on a
+# panic or on SOF_IPC_DEBUG_COREDUMP. For more detailed usage, use --help.
+
+from __future__  import print_function
+import argparse
+import struct
+import sys
+
+COREDUMP_MAGIC = 0x434d4450
+
+RECORD = struct.Struct("<III")
+RECORD_TYPES = {}
+
+ZONES = {
+	0: "system",
+	1: "system runtime",
+	2: "runtime",
+	3: "buffer",
+	4: "core runtime",
+	5: "core buffer",
+}
+
+COMP_STATES = {
+	0: "init",
+	1: "ready",
+	2: "suspend",
+	3: "prepare",
+	4: "paused",
+	5: "active",
+}
+
+BLOCK_USED = 1 << 15
+BLOCK_SIZE_MASK = 0x7fff
+
+def stderr_print(*args, **kwargs):
+	print(*args, file=sys.stderr, **kwargs)
+
+def record(rtype, fmt):
+	def register(func):
+		RECORD_TYPES[rtype] = (struct.Struct(fmt), func)
+		return func
+	return register
+
+def state_name(state):
+	return COMP_STATES.get(state, str(state))
+
+@record(0, "<IIIIQ")
+def print_hdr(fields, payload, args):
+	abi, core, panic, _, timestamp = fields
+	print("dump by core {:d} at {:d}, ABI {:d}.{:d}.{:d}".format(core,
+		timestamp, abi >> 24, (abi >> 12) & 0xfff, abi & 0xfff))
+	print("reason: " + ("panic 0x{:08x}".format(panic) if panic
+		else "on demand"))
+
+@record(1, "<IIIIIIII")
+def print_heap(fields, payload, args):
+	zone, heap, caps, base, block_size, count, free_count, first_free = \
+		fields
+	blocks = struct.unpack("<{:d}H".format(count), payload[:count * 2])
+	print("heap {:s}[{:d}] caps 0x{:x} base 0x{:08x}: {:d} x {:d} bytes, "
+		"{:d} free, first free {:d}".format(ZONES.get(zone, str(zone)),
+		heap, caps, base, count, block_size, free_count, first_free))
+	if not args.verbose:
+		return
+	# list each allocation so leaks show up as unexpected survivors
+	for i, entry in enumerate(blocks):
+		if entry & BLOCK_USED and entry & BLOCK_SIZE_MASK:
+			print("\talloc 0x{:08x} {:d} blocks".format(
+				base + i * block_size, entry & BLOCK_SIZE_MASK))
+
+@record(2, "<IIIIIiII")
+def print_pipe(fields, payload, args):
+	pipe_id, core, status, sched_id, source_id, xrun, period, prio = fields
+	print("pipe {:d} core {:d} {:s} sched {:d} source {:d} period {:d}us "
+		"priority {:d} xrun {:d}".format(pipe_id, core,
+		state_name(status), sched_id, source_id, period, prio, xrun))
+
+@record(3, "<IIIIIIQ")
+def print_comp(fields, payload, args):
+	comp_id, ctype, pipe_id, state, frames, _, position = fields
+	print("\tcomp {:d} type {:d} pipe {:d} {:s} frames {:d} position "
+		"{:d}".format(comp_id, ctype, pipe_id, state_name(state), frames,
+		position))
+
+@record(4, "<IIIIIIIIII")
+def print_buffer(fields, payload, args):
+	buf_id, source, sink, size, avail, free, addr, r_ptr, w_ptr, _ = fields
+	print("\tbuffer {:d} {:d} -> {:d} size {:d} avail {:d} free {:d} "
+		"addr 0x{:08x} r 0x{:08x} w 0x{:08x}".format(buf_id,
+		source if source != 0xffffffff else -1,
+		sink if sink != 0xffffffff else -1,
+		size, avail, free, addr, r_ptr, w_ptr))
+
+@record(5, "<II")
+def print_end(fields, payload, args):
+	records, dropped = fields
+	print("end: {:d} records, {:d} dropped".format(records, dropped))
+	if dropped:
+		print("dump was truncated, use a larger host buffer")
+
+def parse_params():
+	parser = argparse.ArgumentParser(
+		description="Tool for decoding FW state dumps."
+			+" It prints the heap block maps, pipelines, components and"
+			+" buffers recorded in a dump."
+	)
+	parser.add_argument('-i', '--infile', type=str,
+		help='path to state dump bin, stdin if not given')
+	parser.add_argument('-v', '--verbose', action='store_true',
+		help='list every heap allocation')
+	return parser.parse_args()
+
+def read_dump(args):
+	if args.infile:
+		with open(args.infile, "rb") as f:
+			return f.read()
+	return sys.stdin.buffer.read()
+
+def decode(data, args):
+	offset = 0
+	while offset + RECORD.size <= len(data):
+		magic, rtype, size = RECORD.unpack_from(data, offset)
+		if magic != COREDUMP_MAGIC:
+			stderr_print("bad record magic 0x{:08x} at {:d}"
+				.format(magic, offset))
+			return 1
+		offset += RECORD.size
+		payload = data[offset : offset + size]
+		offset += (size + 3) & ~3
+
+		if rtype not in RECORD_TYPES:
+			stderr_print("skipping unknown record type {:d}"
+				.format(rtype))
+			continue
+
+		fmt, func = RECORD_TYPES[rtype]
+		if len(payload) < fmt.size:
+			stderr_print("short record type {:d}".format(rtype))
+			return 1
+		func(fmt.unpack_from(payload), payload[fmt.size:], args)
+		if rtype == 5:
+			return 0
+
+	stderr_print("dump ended without an end record")
+	return 1
+
+if __name__ == "__main__":
+	args = parse_params()
+	sys.exit(decode(read_dump(args), args))
@@ -32,7 +32,12 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 #include <alsa/asoundlib.h>
+#include <uapi/abi.h>
+#include <uapi/user/header.h>
 
 #define SOF_CTRL_CMD_BINARY 3 /* TODO: From uapi ipc */
 
@@ -55,6 +60,18 @@ static void usage(char *name)
 	fprintf(stdout, "in <file>.\n");
 	fprintf(stdout, "\t\t\t\tThe ASCII text file must contain comma\n");
 	fprintf(stdout, "\t\t\t\tseparated unsigned integers.\n");
+	fprintf(stdout, "%s:\t -b\t\tSetup equalizer with each binary ",
+		name);
+	fprintf(stdout, "blob\n");
+	fprintf(stdout, "\t\t\t\tread from stdin until end of file.\n");
+	fprintf(stdout, "%s:\t -u <path>\tSetup equalizer with each ", name);
+	fprintf(stdout, "binary blob\n");
+	fprintf(stdout, "\t\t\t\tsent to UNIX socket <path>, a 32 bit\n");
+	fprintf(stdout, "\t\t\t\tstatus is returned for each blob.\n");
+	fprintf(stdout, "\t\t\t\tBlobs are as written by the tune\n");
+	fprintf(stdout, "\t\t\t\ttools, an ABI header and EQ config.\n");
+	fprintf(stdout, "Batch example %s -Dhw:0 -n 22 -b < sweep.bin\n",
+		name);
 	exit(0);
 }
 
@@ -99,6 +116,160 @@ static int read_setup(unsigned int *data, char setup[], size_t smax)
 	return n;
 }
 
+/* read exactly bytes, returns 0 at end of stream before the first byte */
+static int read_full(int fd, void *buf, size_t bytes)
+{
+	size_t done = 0;
+	ssize_t n;
+
+	while (done < bytes) {
+		n = read(fd, (char *)buf + done, bytes - done);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n < 0)
+			return -errno;
+		if (n == 0)
+			return done ? -EPIPE : 0;
+		done += n;
+	}
+
+	return done;
+}
+
+static int write_full(int fd, const void *buf, size_t bytes)
+{
+	size_t done = 0;
+	ssize_t n;
+
+	while (done < bytes) {
+		n = write(fd, (const char *)buf + done, bytes - done);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n < 0)
+			return -errno;
+		done += n;
+	}
+
+	return done;
+}
+
+/* read one ABI header prefixed blob into the TLV data, returns its size */
+static int read_blob(int fd, unsigned int *data, size_t smax)
+{
+	struct sof_abi_hdr *hdr = (struct sof_abi_hdr *)data;
+	int ret;
+
+	ret = read_full(fd, hdr, sizeof(*hdr));
+	if (ret <= 0)
+		return ret;
+
+	if (hdr->magic != SOF_ABI_MAGIC) {
+		fprintf(stderr, "Error: bad blob magic 0x%x.\n", hdr->magic);
+		return -EINVAL;
+	}
+
+	if (smax < sizeof(*hdr) || hdr->size > smax - sizeof(*hdr)) {
+		fprintf(stderr, "Error: blob of %u bytes exceeds control ",
+			hdr->size);
+		fprintf(stderr, "size.\n");
+		return -EINVAL;
+	}
+
+	ret = read_full(fd, hdr->data, hdr->size);
+	if (ret < 0)
+		return ret;
+	if (ret != hdr->size)
+		return -EPIPE;
+
+	return sizeof(*hdr) + hdr->size;
+}
+
+/*
+ * Write each blob read from in to the control with the device kept open.
+ * With out >= 0 the TLV write status of each blob is sent back to it, so
+ * a client knows when the update is applied. Returns the blob count or a
+ * negative error when the stream is broken.
+ */
+static int write_blobs(snd_ctl_t *ctl, snd_ctl_elem_id_t *id,
+		       unsigned int *user_data, size_t smax, int in, int out)
+{
+	int32_t status;
+	int count = 0;
+	int n;
+
+	for (;;) {
+		n = read_blob(in, &user_data[2], smax);
+		if (n <= 0)
+			return n < 0 ? n : count;
+
+		user_data[1] = n;
+		status = snd_ctl_elem_tlv_write(ctl, id, user_data);
+		if (status)
+			fprintf(stderr, "Error: failed TLV write %d.\n",
+				status);
+
+		if (out >= 0 && write_full(out, &status, sizeof(status)) < 0)
+			return -EPIPE;
+
+		count++;
+	}
+}
+
+/* serve blobs to the control from clients of a UNIX socket until killed */
+static int serve_socket(snd_ctl_t *ctl, snd_ctl_elem_id_t *id,
+			unsigned int *user_data, size_t smax, char *path)
+{
+	struct sockaddr_un addr;
+	int sock;
+	int conn;
+	int n;
+
+	sock = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (sock < 0) {
+		fprintf(stderr, "Error: socket: %s\n", strerror(errno));
+		return -errno;
+	}
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+	unlink(path);
+
+	if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) ||
+	    listen(sock, 1)) {
+		fprintf(stderr, "Error: %s: %s\n", path, strerror(errno));
+		close(sock);
+		return -errno;
+	}
+
+	fprintf(stdout, "Listening on %s.\n", path);
+	fflush(stdout);
+
+	for (;;) {
+		conn = accept(sock, NULL, NULL);
+		if (conn < 0) {
+			if (errno == EINTR)
+				continue;
+			fprintf(stderr, "Error: accept: %s\n",
+				strerror(errno));
+			break;
+		}
+
+		n = write_blobs(ctl, id, user_data, smax, conn, conn);
+		if (n < 0)
+			fprintf(stderr, "Error: client stream failed %d.\n",
+				n);
+		else
+			fprintf(stdout, "Applied %d blobs.\n", n);
+		fflush(stdout);
+
+		close(conn);
+	}
+
+	close(sock);
+	return -errno;
+}
+
 int main(int argc, char *argv[])
 {
 	snd_ctl_t *ctl;
@@ -121,9 +292,11 @@ int main(int argc, char *argv[])
 	char *dev = "hw:0";
 	char *cname = NULL;
 	char *setup = NULL;
+	char *sock_path = NULL;
 	int set = 0;
+	int batch = 0;
 
-	while ((opt = getopt(argc, argv, "hD:c:s:n:")) != -1) {
+	while ((opt = getopt(argc, argv, "hD:c:s:n:bu:")) != -1) {
 		switch (opt) {
 		case 'D':
 			dev = optarg;
@@ -139,6 +312,12 @@ int main(int argc, char *argv[])
 			setup = optarg;
 			set = 1;
 			break;
+		case 'b':
+			batch = 1;
+			break;
+		case 'u':
+			sock_path = optarg;
+			break;
 		case 'h':
 			usage(argv[0]);
 			exit(0);
@@ -216,7 +395,21 @@ int main(int argc, char *argv[])
 	}
 
 	user_data[0] = SOF_CTRL_CMD_BINARY;
-	if (set) {
+	if (sock_path) {
+		ret = serve_socket(ctl, id, user_data, ctrl_size, sock_path);
+		free(user_data);
+		exit(ret);
+	} else if (batch) {
+		n = write_blobs(ctl, id, user_data, ctrl_size, STDIN_FILENO,
+				-1);
+		free(user_data);
+		if (n < 0) {
+			fprintf(stderr, "Error: failed blob read %d.\n", n);
+			exit(EXIT_FAILURE);
+		}
+		fprintf(stdout, "Applied %d blobs.\n", n);
+		return 0;
+	} else if (set) {
 		fprintf(stdout, "Applying configuration \"%s\" ", setup);
 		fprintf(stdout, "into device %s control %s.\n", dev, cname);
 		n = read_setup(&user_data[2], setup, ctrl_size);
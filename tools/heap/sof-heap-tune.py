@@ -0,0 +1,151 @@
+#!/usr/bin/env python3
+
+# Tool for sizing the HEAP_*_COUNT* block map settings of a platform
+# memory.h from SOF_IPC_DEBUG_HEAP_HIST replies. Record one reply per
+# topology after running its use cases, then pass them all to this tool.
+# For more detailed usage, use --help.
+
+from __future__  import print_function
+import argparse
+import math
+import struct
+import sys
+
+REPLY_HDR = struct.Struct("<IIi")
+HIST_HDR = struct.Struct("<II")
+HIST_BINS = 14
+HIST_BIN = struct.Struct("<II")
+HIST_MAP = struct.Struct("<IIII")
+
+ZONES = {
+	0: "system",
+	1: "system runtime",
+	2: "runtime",
+	3: "buffer",
+}
+
+def stderr_print(*args, **kwargs):
+	print(*args, file=sys.stderr, **kwargs)
+
+def bin_limit(i):
+	return 16 << i
+
+class Hist:
+	def __init__(self, name, data):
+		offset = REPLY_HDR.size
+		self.name = name
+		self.zone, num_maps = HIST_HDR.unpack_from(data, offset)
+		offset += HIST_HDR.size
+		self.bins = []
+		for i in range(HIST_BINS):
+			self.bins.append(HIST_BIN.unpack_from(data, offset))
+			offset += HIST_BIN.size
+		# peak blocks in use by block size, over all heaps of the zone
+		self.peaks = {}
+		self.counts = {}
+		for i in range(num_maps):
+			_, size, count, peak = HIST_MAP.unpack_from(data, offset)
+			offset += HIST_MAP.size
+			self.peaks[size] = self.peaks.get(size, 0) + peak
+			self.counts[size] = self.counts.get(size, 0) + count
+
+	def demand(self):
+		# failed requests did not show up in the peaks, charge each one
+		# to the smallest block size that fits its whole size bin
+		demand = dict(self.peaks)
+		sizes = sorted(demand)
+		for i, (_, fails) in enumerate(self.bins):
+			if not fails:
+				continue
+			fit = [s for s in sizes if s >= bin_limit(i)]
+			if fit:
+				demand[fit[0]] += fails
+			else:
+				demand[sizes[-1]] += fails * int(math.ceil(
+					float(bin_limit(i)) / sizes[-1]))
+		return demand
+
+def parse_params():
+	parser = argparse.ArgumentParser(
+		description="Tool for sizing heap block maps."
+			+" It prints the block counts that cover the peak usage"
+			+" and failed requests of all given allocation histograms."
+	)
+	parser.add_argument('infiles', nargs='+', type=str,
+		help='SOF_IPC_DEBUG_HEAP_HIST reply bins, one per topology')
+	parser.add_argument('-p', '--prefix', type=str, default="HEAP_RT_COUNT",
+		help='define name prefix, HEAP_RT_COUNT if not given')
+	parser.add_argument('-m', '--margin', type=int, default=25,
+		help='headroom over the peak in percent, 25 if not given')
+	parser.add_argument('-b', '--budget', type=int,
+		help='zone size in bytes to fill, current size if not given')
+	parser.add_argument('-v', '--verbose', action='store_true',
+		help='print the request histogram and per size demand')
+	return parser.parse_args()
+
+def read_hists(args):
+	hists = []
+	for name in args.infiles:
+		with open(name, "rb") as f:
+			hists.append(Hist(name, f.read()))
+	if len(set(h.zone for h in hists)) != 1:
+		stderr_print("histograms are from different zones")
+		return None
+	if len(set(tuple(sorted(h.counts)) for h in hists)) != 1:
+		stderr_print("histograms have different block sizes")
+		return None
+	return hists
+
+def print_hist(hist):
+	print("{:s}: {:s} zone".format(hist.name,
+		ZONES.get(hist.zone, str(hist.zone))))
+	for i, (allocs, fails) in enumerate(hist.bins):
+		if not allocs:
+			continue
+		limit = "<= {:d}".format(bin_limit(i)) \
+			if i < HIST_BINS - 1 else "> {:d}".format(bin_limit(i - 1))
+		print("\t{:>10s} bytes: {:d} requests, {:d} failed".format(limit,
+			allocs, fails))
+
+def tune(hists, args):
+	sizes = sorted(hists[0].counts)
+	demand = dict((s, max(h.demand()[s] for h in hists)) for s in sizes)
+
+	counts = {}
+	for s in sizes:
+		counts[s] = max(1, int(math.ceil(demand[s] *
+			(100 + args.margin) / 100.0)))
+
+	budget = args.budget
+	if budget is None:
+		budget = sum(s * c for s, c in hists[0].counts.items())
+	used = sum(s * c for s, c in counts.items())
+	if used > budget:
+		stderr_print("warning: needs {:d} bytes, {:d} over budget".format(
+			used, used - budget))
+	else:
+		# hand out the spare space in proportion to the demand
+		spare = budget - used
+		total = sum(s * demand[s] for s in sizes)
+		for s in sizes:
+			share = s * demand[s] if total else s
+			part = spare * share // (total if total else sum(sizes))
+			counts[s] += part // s
+		used = sum(s * c for s, c in counts.items())
+
+	if args.verbose:
+		for h in hists:
+			print_hist(h)
+		for s in sizes:
+			print("block {:d}: count {:d} demand {:d} -> {:d}".format(s,
+				hists[0].counts[s], demand[s], counts[s]))
+		print("{:d} of {:d} bytes".format(used, budget))
+
+	for s in sizes:
+		print("#define {:s}{:d}\t\t{:d}".format(args.prefix, s, counts[s]))
+	return 0
+
+if __name__ == "__main__":
+	args = parse_params()
+	hists = read_hists(args)
+	sys.exit(tune(hists, args) if hists else 1)
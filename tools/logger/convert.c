@@ -19,6 +19,8 @@
 #include <errno.h>
 #include <unistd.h>
 #include <math.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "convert.h"
 
 #define CEIL(a, b) ((a+b-1)/b)
@@ -28,6 +30,9 @@
 #define TRACE_MAX_FILENAME_LEN		128
 #define TRACE_MAX_IDS_STR		10
 #define TRACE_IDS_MASK			((1 << TRACE_ID_LENGTH) - 1)
+#define LDC_DICT_MIN_SIZE		1024	/* power of 2 */
+#define CONVERT_INPUT_SIZE		(64 * 1024)
+#define CONVERT_FOLLOW_POLL_US		(100 * 1000)
 
 struct ldc_entry_header {
 	uint32_t level;
@@ -41,11 +46,106 @@ struct ldc_entry_header {
 
 struct ldc_entry {
 	struct ldc_entry_header header;
-	char *file_name;
-	char *text;
+	const char *file_name;
+	const char *text;
 	uint32_t *params;
 };
 
+/* parsed ldc entry, strings point into the mapped ldc file */
+struct ldc_dict_entry {
+	uint32_t address;
+	const struct ldc_entry_header *header;
+	const char *file_name;
+	const char *text;
+};
+
+/* ldc file mapped once, entries are parsed on first use and cached */
+struct ldc_dict {
+	struct snd_sof_logs_header *snd;
+	const uint8_t *map;
+	size_t map_size;
+	struct ldc_dict_entry *entries;	/* open addressing hash table */
+	uint32_t size;			/* table slots, power of 2 */
+	uint32_t count;			/* used slots */
+};
+
+/*
+ * Input bytes pending conversion. Memory use is bounded by the buffer, and
+ * in follow mode running out of input waits for more instead of ending.
+ */
+struct convert_input {
+	int fd;
+	int follow;
+	FILE *bin_fd;			/* copy of all input bytes or NULL */
+	size_t r;			/* first pending byte */
+	size_t w;			/* end of pending bytes */
+	uint8_t buf[CONVERT_INPUT_SIZE];
+};
+
+/* make at least n bytes pending, -ENODATA at end of input */
+static int input_fill(struct convert_input *in, size_t n)
+{
+	ssize_t ret;
+
+	while (in->w - in->r < n) {
+		/* move the partial record to the start when out of room */
+		if (in->w == sizeof(in->buf) || in->r + n > sizeof(in->buf)) {
+			memmove(in->buf, in->buf + in->r, in->w - in->r);
+			in->w -= in->r;
+			in->r = 0;
+		}
+
+		ret = read(in->fd, in->buf + in->w, sizeof(in->buf) - in->w);
+		if (ret < 0) {
+			if (errno == EINTR)
+				continue;
+			fprintf(stderr, "error: input read failed %d\n", errno);
+			return -errno;
+		}
+
+		if (!ret) {
+			if (!in->follow)
+				return -ENODATA;
+			usleep(CONVERT_FOLLOW_POLL_US);
+			continue;
+		}
+
+		if (in->bin_fd) {
+			if (fwrite(in->buf + in->w, 1, ret, in->bin_fd) != ret) {
+				fprintf(stderr, "error: binary output write "
+					"failed\n");
+				return -EIO;
+			}
+			fflush(in->bin_fd);
+		}
+
+		in->w += ret;
+	}
+
+	return 0;
+}
+
+static int input_read(struct convert_input *in, void *dst, size_t n)
+{
+	int ret = input_fill(in, n);
+
+	if (ret)
+		return ret;
+
+	memcpy(dst, in->buf + in->r, n);
+	in->r += n;
+
+	return 0;
+}
+
+static int input_getc(struct convert_input *in)
+{
+	if (input_fill(in, 1))
+		return EOF;
+
+	return in->buf[in->r++];
+}
+
 static double to_usecs(uint64_t time, double clk)
 {
 	/* trace timestamp uses CPU system clock at default 25MHz ticks */
@@ -149,90 +249,157 @@ static void print_entry_params(FILE *out_fd, struct log_entry_header dma_log,
 	fflush(out_fd);
 }
 
-static int fetch_entry(struct convert_config *config, uint32_t base_address,
-	uint32_t data_offset, struct log_entry_header dma_log, uint64_t *last_timestamp)
+static inline uint32_t ldc_dict_hash(uint32_t address)
 {
-	struct ldc_entry entry;
-	uint32_t entry_offset;
-
-	int ret;
+	/* entries are word aligned, Fibonacci hash the rest */
+	return (address >> 2) * 2654435761u;
+}
 
-	entry.file_name = NULL;
-	entry.text = NULL;
-	entry.params = NULL;
+static struct ldc_dict_entry *ldc_dict_slot(struct ldc_dict_entry *entries,
+	uint32_t size, uint32_t address)
+{
+	uint32_t i = ldc_dict_hash(address) & (size - 1);
 
-	/* evaluate entry offset in input file */
-	entry_offset = dma_log.log_entry_address - base_address;
+	while (entries[i].header && entries[i].address != address)
+		i = (i + 1) & (size - 1);
 
-	/* set file position to beginning of processed entry */
-	fseek(config->ldc_fd, entry_offset + data_offset, SEEK_SET);
+	return &entries[i];
+}
 
-	/* fetching elf header params */
-	ret = fread(&entry.header, sizeof(entry.header), 1, config->ldc_fd);
-	if (!ret) {
-		ret = -ferror(config->ldc_fd);
-		goto out;
-	}
-	if (entry.header.file_name_len > TRACE_MAX_FILENAME_LEN) {
-		fprintf(stderr, "Error: Invalid filename length. \n");
-		ret = -EINVAL;
-		goto out;
+static int ldc_dict_grow(struct ldc_dict *dict)
+{
+	struct ldc_dict_entry *entries;
+	uint32_t size = dict->size ? dict->size * 2 : LDC_DICT_MIN_SIZE;
+	uint32_t i;
+
+	entries = calloc(size, sizeof(*entries));
+	if (!entries) {
+		fprintf(stderr, "error: can't allocate %u ldc dictionary "
+			"entries\n", size);
+		return -ENOMEM;
 	}
-	entry.file_name = (char *)malloc(entry.header.file_name_len);
 
-	if (!entry.file_name) {
-		fprintf(stderr, "error: can't allocate %d byte for "
-			"entry.file_name\n", entry.header.file_name_len);
-		ret = -ENOMEM;
-		goto out;
+	for (i = 0; i < dict->size; i++) {
+		if (dict->entries[i].header)
+			*ldc_dict_slot(entries, size,
+				       dict->entries[i].address) =
+				dict->entries[i];
 	}
 
-	ret = fread(entry.file_name, sizeof(char), entry.header.file_name_len,
-		config->ldc_fd);
-	if (ret != entry.header.file_name_len) {
-		ret = -ferror(config->ldc_fd);
-		goto out;
+	free(dict->entries);
+	dict->entries = entries;
+	dict->size = size;
+
+	return 0;
+}
+
+/* parse the entry at address in the mapped ldc file */
+static int ldc_dict_parse(struct ldc_dict *dict, uint32_t address,
+	struct ldc_dict_entry *entry)
+{
+	const struct ldc_entry_header *header;
+	size_t offset;
+
+	offset = (size_t)dict->snd->data_offset + address -
+		dict->snd->base_address;
+	if (offset + sizeof(*header) > dict->map_size) {
+		fprintf(stderr, "Error: entry 0x%x beyond ldc file. \n",
+			address);
+		return -EINVAL;
 	}
 
-	/* fetching text */
-	if (entry.header.text_len > TRACE_MAX_TEXT_LEN) {
+	header = (const struct ldc_entry_header *)(dict->map + offset);
+	offset += sizeof(*header);
+
+	if (header->file_name_len > TRACE_MAX_FILENAME_LEN ||
+	    !header->file_name_len) {
+		fprintf(stderr, "Error: Invalid filename length. \n");
+		return -EINVAL;
+	}
+	if (header->text_len > TRACE_MAX_TEXT_LEN || !header->text_len) {
 		fprintf(stderr, "Error: Invalid text length. \n");
-		ret = -EINVAL;
-		goto out;
+		return -EINVAL;
 	}
-	entry.text = (char *)malloc(entry.header.text_len);
-	if (entry.text == NULL) {
-		fprintf(stderr, "error: can't allocate %d byte for "
-			"entry.text\n", entry.header.text_len);
-		ret = -ENOMEM;
-		goto out;
+	if (header->params_num > TRACE_MAX_PARAMS_COUNT) {
+		fprintf(stderr, "Error: Invalid number of parameters. \n");
+		return -EINVAL;
 	}
-	ret = fread(entry.text, sizeof(char), entry.header.text_len, config->ldc_fd);
-	if (ret != entry.header.text_len) {
-		ret = -ferror(config->ldc_fd);
-		goto out;
+	if (offset + header->file_name_len + header->text_len >
+	    dict->map_size) {
+		fprintf(stderr, "Error: entry 0x%x beyond ldc file. \n",
+			address);
+		return -EINVAL;
 	}
 
-	/* fetching entry params from dma dump */
-	if (entry.header.params_num > TRACE_MAX_PARAMS_COUNT) {
-		fprintf(stderr, "Error: Invalid number of parameters. \n");
-		ret = -EINVAL;
-		goto out;
+	entry->address = address;
+	entry->header = header;
+	entry->file_name = (const char *)dict->map + offset;
+	entry->text = entry->file_name + header->file_name_len;
+
+	/* strings are printed directly from the map */
+	if (entry->file_name[header->file_name_len - 1] ||
+	    entry->text[header->text_len - 1]) {
+		fprintf(stderr, "Error: entry 0x%x string not terminated. \n",
+			address);
+		return -EINVAL;
 	}
-	entry.params = (uint32_t *)malloc(sizeof(uint32_t) *
-		entry.header.params_num);
-	if (entry.params == NULL) {
-		fprintf(stderr, "error: can't allocate %d byte for "
-			"entry.params\n", (int)(sizeof(uint32_t) *
-			entry.header.params_num));
-		ret = -ENOMEM;
-		goto out;
+
+	return 0;
+}
+
+static const struct ldc_dict_entry *ldc_dict_lookup(struct ldc_dict *dict,
+	uint32_t address)
+{
+	struct ldc_dict_entry *slot;
+
+	if (dict->size) {
+		slot = ldc_dict_slot(dict->entries, dict->size, address);
+		if (slot->header)
+			return slot;
 	}
-	ret = fread(entry.params, sizeof(uint32_t), entry.header.params_num,
-		config->in_fd);
-	if (ret != entry.header.params_num) {
-		ret = -ferror(config->in_fd);
-		goto out;
+
+	/* keep the table at most half full */
+	if ((dict->count + 1) * 2 > dict->size && ldc_dict_grow(dict))
+		return NULL;
+
+	slot = ldc_dict_slot(dict->entries, dict->size, address);
+	if (ldc_dict_parse(dict, address, slot)) {
+		slot->header = NULL;
+		return NULL;
+	}
+	dict->count++;
+
+	return slot;
+}
+
+/* params are read from the input unless already decoded into params */
+static int fetch_entry(struct convert_config *config, struct ldc_dict *dict,
+	struct convert_input *in, struct log_entry_header dma_log,
+	const uint32_t *params, uint64_t *last_timestamp)
+{
+	const struct ldc_dict_entry *dict_entry;
+	uint32_t entry_params[TRACE_MAX_PARAMS_COUNT];
+	struct ldc_entry entry;
+	int ret;
+
+	dict_entry = ldc_dict_lookup(dict, dma_log.log_entry_address);
+	if (!dict_entry)
+		return -EINVAL;
+
+	entry.header = *dict_entry->header;
+	entry.file_name = dict_entry->file_name;
+	entry.text = dict_entry->text;
+	entry.params = entry_params;
+
+	/* fetching entry params from dma dump */
+	if (params) {
+		memcpy(entry.params, params,
+		       sizeof(uint32_t) * entry.header.params_num);
+	} else {
+		ret = input_read(in, entry.params,
+				 sizeof(uint32_t) * entry.header.params_num);
+		if (ret)
+			return ret;
 	}
 
 	/* printing entry content */
@@ -240,58 +407,215 @@ static int fetch_entry(struct convert_config *config, uint32_t base_address,
 			   config->clock, config->use_colors);
 	*last_timestamp = dma_log.timestamp;
 
-	/* set f_ldc file position to the beginning */
-	rewind(config->ldc_fd);
-
-	ret = 0;
-out:
-	/* free alocated memory */
-	free(entry.params);
-	free(entry.text);
-	free(entry.file_name);
-
-	return ret;
+	return 0;
 }
 
-static int logger_read(struct convert_config *config,
-	struct snd_sof_logs_header *snd)
+static int logger_read(struct convert_config *config, struct ldc_dict *dict,
+	struct convert_input *in)
 {
+	struct snd_sof_logs_header *snd = dict->snd;
 	struct log_entry_header dma_log;
 	int ret = 0;
 	print_table_header(config->out_fd);
 	uint64_t last_timestamp = 0;
 
-	while (!feof(config->in_fd)) {
+	while (1) {
 		/* getting entry parameters from dma dump */
-		ret = fread(&dma_log, sizeof(dma_log), 1, config->in_fd);
-		if (!ret) {
-			return -ferror(config->in_fd);
-		}
+		ret = input_fill(in, sizeof(dma_log));
+		if (ret)
+			return ret == -ENODATA ? 0 : ret;
+		memcpy(&dma_log, in->buf + in->r, sizeof(dma_log));
 
 		/* checking if received trace address is located in
 		 * entry section in elf file.
 		 */
 		if ((dma_log.log_entry_address < snd->base_address) ||
 			dma_log.log_entry_address > snd->base_address + snd->data_length) {
-			/* in case the address is not correct input fd should be
+			/* in case the address is not correct input should be
 			 * move forward by one DWORD, not entire struct dma_log
 			 */
-			fseek(config->in_fd, -(sizeof(dma_log) - sizeof(uint32_t)), SEEK_CUR);
+			in->r += sizeof(uint32_t);
 			continue;
 		}
+		in->r += sizeof(dma_log);
 
 		/* fetching entry from elf dump */
-		ret = fetch_entry(config, snd->base_address, snd->data_offset,
-			dma_log, &last_timestamp);
+		ret = fetch_entry(config, dict, in, dma_log, NULL,
+			&last_timestamp);
 		if (ret)
 			break;
 	}
 
-	return ret;
+	return ret == -ENODATA ? 0 : ret;
+}
+
+/* little endian base 128, returns -1 at end of input or on bad varint */
+static int read_varint(struct convert_input *in, uint64_t *value)
+{
+	int shift;
+	int c;
+
+	*value = 0;
+	for (shift = 0; shift < 64; shift += 7) {
+		c = input_getc(in);
+		if (c == EOF)
+			return -1;
+		*value |= (uint64_t)(c & 0x7f) << shift;
+		if (!(c & 0x80))
+			return 0;
+	}
+
+	return -1;
+}
+
+static int64_t unzigzag(uint64_t value)
+{
+	return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+/* read the magic and timestamp after a sync tag */
+static int read_packed_sync(struct convert_input *in, uint64_t *timestamp)
+{
+	uint8_t buf[SOF_TRACE_PACK_SYNC_SIZE - 1];
+
+	if (input_read(in, buf, sizeof(buf)))
+		return -1;
+
+	if (memcmp(buf, SOF_TRACE_PACK_MAGIC, SOF_TRACE_PACK_MAGIC_SIZE))
+		return -1;
+
+	memcpy(timestamp, buf + SOF_TRACE_PACK_MAGIC_SIZE, sizeof(*timestamp));
+	return 0;
+}
+
+/* scan byte wise for the next sync record */
+static int find_packed_sync(struct convert_input *in, uint64_t *timestamp)
+{
+	uint8_t win[SOF_TRACE_PACK_MAGIC_SIZE + 1] = { 0 };
+	int c;
+
+	while ((c = input_getc(in)) != EOF) {
+		memmove(win, win + 1, sizeof(win) - 1);
+		win[sizeof(win) - 1] = c;
+
+		if (win[0] == SOF_TRACE_PACK_TYPE_SYNC &&
+		    !memcmp(win + 1, SOF_TRACE_PACK_MAGIC,
+			    SOF_TRACE_PACK_MAGIC_SIZE))
+			return input_read(in, timestamp, sizeof(*timestamp)) ?
+				-1 : 0;
+	}
+
+	return -1;
+}
+
+/* decode packed DMA trace records, see uapi/user/trace.h */
+static int logger_read_packed(struct convert_config *config,
+	struct ldc_dict *dict, struct convert_input *in)
+{
+	struct snd_sof_logs_header *snd = dict->snd;
+	struct log_entry_header dma_log;
+	uint32_t params[TRACE_MAX_PARAMS_COUNT];
+	uint64_t last_timestamp = 0;
+	uint64_t timestamp = 0;
+	uint64_t value;
+	uint32_t entry = 0;
+	uint32_t id_0 = 0, id_1 = 0, core = 0;
+	uint32_t params_num;
+	int synced = 0;
+	int ret = 0;
+	int tag;
+	int i;
+
+	print_table_header(config->out_fd);
+
+	while (1) {
+		if (!synced) {
+			/* join the stream at the next sync record */
+			if (find_packed_sync(in, &timestamp))
+				return 0;
+			entry = 0;
+			synced = 1;
+		}
+
+		tag = input_getc(in);
+		if (tag == EOF)
+			return 0;
+
+		if ((tag & SOF_TRACE_PACK_TYPE_MASK) ==
+		    SOF_TRACE_PACK_TYPE_SYNC) {
+			if (read_packed_sync(in, &timestamp))
+				synced = 0;
+			entry = 0;
+			continue;
+		}
+
+		params_num = (tag & SOF_TRACE_PACK_PARAMS_MASK) >>
+			SOF_TRACE_PACK_PARAMS_SHIFT;
+		if ((tag & SOF_TRACE_PACK_TYPE_MASK) !=
+		    SOF_TRACE_PACK_TYPE_EVENT ||
+		    params_num > TRACE_MAX_PARAMS_COUNT) {
+			synced = 0;
+			continue;
+		}
+
+		if (read_varint(in, &value))
+			return 0;
+		timestamp += unzigzag(value);
+
+		if (!(tag & SOF_TRACE_PACK_SAME_IDS)) {
+			if (read_varint(in, &value))
+				return 0;
+			id_0 = value;
+			if (read_varint(in, &value))
+				return 0;
+			id_1 = value;
+		}
+
+		if (!(tag & SOF_TRACE_PACK_SAME_CORE)) {
+			ret = input_getc(in);
+			if (ret == EOF)
+				return 0;
+			core = ret;
+		}
+
+		if (read_varint(in, &value))
+			return 0;
+		entry += (uint32_t)unzigzag(value);
+
+		for (i = 0; i < params_num; i++) {
+			if (read_varint(in, &value))
+				return 0;
+			params[i] = value;
+		}
+		for (; i < TRACE_MAX_PARAMS_COUNT; i++)
+			params[i] = 0;
+
+		/* a bad address means we lost the stream, so resync */
+		if (entry < snd->base_address ||
+		    entry > snd->base_address + snd->data_length) {
+			synced = 0;
+			continue;
+		}
+
+		dma_log.id_0 = id_0;
+		dma_log.id_1 = id_1;
+		dma_log.core_id = core;
+		dma_log.timestamp = timestamp;
+		dma_log.log_entry_address = entry;
+
+		ret = fetch_entry(config, dict, in, dma_log, params,
+			&last_timestamp);
+		if (ret)
+			return ret == -ENODATA ? 0 : ret;
+	}
 }
 
 int convert(struct convert_config *config) {
 	struct snd_sof_logs_header snd;
+	struct convert_input *in;
+	struct ldc_dict dict;
+	struct stat st;
+	void *map;
 	int count, ret = 0;
 
 	count = fread(&snd, sizeof(snd), 1, config->ldc_fd);
@@ -356,5 +680,147 @@ int convert(struct convert_config *config) {
 				SOF_ABI_VERSION_PATCH(snd.version.abi_version));
 		return -EINVAL;
 	}
-	return logger_read(config, &snd);
+
+	/* map the ldc file once, entries are looked up by address */
+	if (fstat(fileno(config->ldc_fd), &st)) {
+		fprintf(stderr, "Error: can't stat %s. \n", config->ldc_file);
+		return -errno;
+	}
+
+	map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE,
+		   fileno(config->ldc_fd), 0);
+	if (map == MAP_FAILED) {
+		fprintf(stderr, "Error: can't map %s. \n", config->ldc_file);
+		return -errno;
+	}
+
+	memset(&dict, 0, sizeof(dict));
+	dict.snd = &snd;
+	dict.map = map;
+	dict.map_size = st.st_size;
+
+	in = calloc(1, sizeof(*in));
+	if (!in) {
+		fprintf(stderr, "error: can't allocate input buffer\n");
+		munmap(map, st.st_size);
+		return -ENOMEM;
+	}
+	in->fd = fileno(config->in_fd);
+	in->follow = config->follow;
+	in->bin_fd = config->bin_fd;
+
+	if (config->packed)
+		ret = logger_read_packed(config, &dict, in);
+	else
+		ret = logger_read(config, &dict, in);
+
+	free(in);
+	free(dict.entries);
+	munmap(map, st.st_size);
+
+	return ret;
+}
+
+#define BOOT_CASE(x) \
+	case(TRACE_BOOT_##x): return #x
+
+static const char *get_boot_point_name(uint32_t point)
+{
+	switch (point) {
+		BOOT_CASE(LDR_ENTRY);
+		BOOT_CASE(LDR_HPSRAM);
+		BOOT_CASE(LDR_MANIFEST);
+		BOOT_CASE(LDR_JUMP);
+		BOOT_CASE(LDR_PARSE_MODULE);
+		BOOT_CASE(LDR_PARSE_SEGMENT);
+		BOOT_CASE(START);
+		BOOT_CASE(ARCH);
+		BOOT_CASE(SYS);
+		BOOT_CASE(PLATFORM);
+		BOOT_CASE(SYS_WORK);
+		BOOT_CASE(SYS_CPU_FREQ);
+		BOOT_CASE(SYS_HEAP);
+		BOOT_CASE(SYS_NOTE);
+		BOOT_CASE(SYS_SCHED);
+		BOOT_CASE(SYS_POWER);
+		BOOT_CASE(SYS_TRACE);
+		BOOT_CASE(PLATFORM_ENTRY);
+		BOOT_CASE(PLATFORM_MBOX);
+		BOOT_CASE(PLATFORM_SHIM);
+		BOOT_CASE(PLATFORM_PMC);
+		BOOT_CASE(PLATFORM_TIMER);
+		BOOT_CASE(PLATFORM_CLOCK);
+		BOOT_CASE(PLATFORM_SSP_FREQ);
+		BOOT_CASE(PLATFORM_IPC);
+		BOOT_CASE(PLATFORM_DMA);
+		BOOT_CASE(PLATFORM_SSP);
+		BOOT_CASE(PLATFORM_DMIC);
+		BOOT_CASE(PLATFORM_IDC);
+		BOOT_CASE(PLATFORM_DAI);
+		BOOT_CASE(PLATFORM_DMA_TRACE);
+		BOOT_CASE(TASK_COMP);
+		BOOT_CASE(TASK_READY);
+	default: return "unknown";
+	}
+}
+
+#undef BOOT_CASE
+
+/*
+ * Decode the boot profile record. The input may be the debug region alone
+ * or a full mailbox dump, so scan for the magic on word boundaries.
+ */
+int boot_profile(struct convert_config *config)
+{
+	struct sof_boot_profile hdr;
+	struct sof_boot_profile_point bp;
+	uint64_t first = 0, last = 0;
+	uint32_t word;
+	double clock = config->clock;
+	int i;
+
+	while (1) {
+		if (fread(&word, sizeof(word), 1, config->in_fd) != 1) {
+			fprintf(stderr, "Error: no boot profile in %s\n",
+				config->in_file);
+			return -ENODATA;
+		}
+		if (word == SOF_BOOT_PROFILE_MAGIC)
+			break;
+	}
+
+	hdr.magic = word;
+	if (fread(&hdr.count, sizeof(hdr) - sizeof(hdr.magic), 1,
+		  config->in_fd) != 1) {
+		fprintf(stderr, "Error: truncated boot profile in %s\n",
+			config->in_file);
+		return -ENODATA;
+	}
+
+	fprintf(config->out_fd, "%5s %-20s %16s %14s %14s\n", "POINT", "NAME",
+		"TICKS", "DELTA us", "TOTAL us");
+
+	for (i = 0; i < hdr.count; i++) {
+		if (fread(&bp, sizeof(bp), 1, config->in_fd) != 1) {
+			fprintf(stderr, "Error: truncated boot profile in %s\n",
+				config->in_file);
+			return -ENODATA;
+		}
+
+		if (!i)
+			first = last = bp.timestamp;
+
+		fprintf(config->out_fd, "%5x %-20s %16llu %14.2f %14.2f\n",
+			bp.point, get_boot_point_name(bp.point),
+			(unsigned long long)bp.timestamp,
+			(bp.timestamp - last) / clock,
+			(bp.timestamp - first) / clock);
+		last = bp.timestamp;
+	}
+
+	if (hdr.dropped)
+		fprintf(config->out_fd, "%u boot points dropped\n",
+			hdr.dropped);
+
+	return 0;
 }
@@ -34,6 +34,12 @@ struct convert_config {
 	char *version_file;
 	FILE *version_fd;
 	int use_colors;
+	int packed;
+	int follow;
+	const char *bin_file;
+	FILE *bin_fd;
+	int boot_profile;
 };
 
 int convert(struct convert_config *config);
+int boot_profile(struct convert_config *config);
@@ -42,6 +42,10 @@ static void usage(void)
 	fprintf(stdout, "%s:\t -c\t\t\tSet timestamp clock in MHz\n", APP_NAME);
 	fprintf(stdout, "%s:\t -s\t\t\tTake a snapshot of state\n", APP_NAME);
 	fprintf(stdout, "%s:\t -t\t\t\tDisplay trace data\n", APP_NAME);
+	fprintf(stdout, "%s:\t -z\t\t\tInput is packed DMA trace\n", APP_NAME);
+	fprintf(stdout, "%s:\t -f\t\t\tFollow input, wait for new data at end of input\n", APP_NAME);
+	fprintf(stdout, "%s:\t -b bin_file\t\tCopy binary input to bin_file for later conversion\n", APP_NAME);
+	fprintf(stdout, "%s:\t -r\t\t\tDecode boot profile from mailbox (or -i infile)\n", APP_NAME);
 	exit(0);
 }
 
@@ -121,8 +125,13 @@ int main(int argc, char *argv[])
 	config.version_fd = NULL;
 	config.version_fw = 0;
 	config.use_colors = 1;
+	config.packed = 0;
+	config.follow = 0;
+	config.bin_file = NULL;
+	config.bin_fd = NULL;
+	config.boot_profile = 0;
 
-	while ((opt = getopt(argc, argv, "ho:i:l:ps:m:c:tev:")) != -1) {
+	while ((opt = getopt(argc, argv, "ho:i:l:ps:m:c:tev:zfb:r")) != -1) {
 		switch (opt) {
 		case 'o':
 			config.out_file = optarg;
@@ -156,12 +165,31 @@ int main(int argc, char *argv[])
 			config.version_fw = 1;
 			config.version_file = optarg;
 			break;
+		case 'z':
+			config.packed = 1;
+			break;
+		case 'f':
+			config.follow = 1;
+			break;
+		case 'b':
+			config.bin_file = optarg;
+			break;
+		case 'r':
+			config.boot_profile = 1;
+			break;
 		case 'h':
 		default: /* '?' */
 			usage();
 		}
 	}
-	
+
+	/* boot profile is read from the mailbox and needs no ldc file */
+	if (config.boot_profile) {
+		if (!config.in_file)
+			config.in_file = "/sys/kernel/debug/sof/mbox";
+		goto files;
+	}
+
 	if (!config.ldc_file) {
 		fprintf(stderr, "error: Missing ldc file\n");
 		usage();
@@ -185,6 +213,7 @@ int main(int argc, char *argv[])
 		}
 	}
 
+files:
 	if (config.out_file) {
 		config.out_fd = fopen(config.out_file, "w");
 		if (!config.out_fd) {
@@ -216,10 +245,24 @@ int main(int argc, char *argv[])
 			goto out;
 		}
 	}
+
+	if (config.bin_file) {
+		config.bin_fd = fopen(config.bin_file, "wb");
+		if (!config.bin_fd) {
+			fprintf(stderr, "error: Unable to open binary file %s\n",
+				config.bin_file);
+			ret = -errno;
+			goto out;
+		}
+	}
+
 	if (isatty(fileno(config.out_fd)) != 1)
 		config.use_colors = 0;
 
-	convert(&config);
+	if (config.boot_profile)
+		ret = boot_profile(&config);
+	else
+		convert(&config);
 
 out:
 	/* close files */
@@ -235,5 +278,8 @@ out:
 	if (config.version_fd)
 		fclose(config.version_fd);
 
+	if (config.bin_fd)
+		fclose(config.bin_fd);
+
 	return ret;
 }
@@ -0,0 +1,359 @@
+#!/usr/bin/env python3
+
+# Tool for collecting the benchmark results of the testbench, comp_bench,
+# kernel_bench, the ISS profile and the firmware pipeline load test into one
+# report of a commit and platform. The report is compared with the checked in
+# baseline of the platform, or a set of reports is listed side by side.
+# For more detailed usage, use --help.
+
+from __future__  import print_function
+import argparse
+import csv
+import json
+import os
+import re
+import subprocess
+import sys
+
+SCHEMA = 1
+
+# report columns, every result is one row
+FIELDS = ["commit", "platform", "source", "scope", "name", "metric", "value",
+	"unit"]
+
+# units and whether a bigger value is worse for every metric
+METRICS = {
+	"mcps": ("MCPS", True),
+	"cycles_per_period": ("cycles", True),
+	"max_cycles": ("cycles", True),
+	"realtime_factor": ("x", False),
+	"buffer_bytes": ("bytes", True),
+	"ns_per_frame": ("ns", True),
+	"cycles_per_sample": ("cycles", True),
+	"ns_per_sample": ("ns", True),
+	"self_time": ("s", True),
+	"latency": ("us", True),
+	"jitter_max": ("us", True),
+	"load": ("%", True),
+	"max_pipeline_load": ("%", True),
+	"missed": ("count", True),
+	"cancelled": ("count", True),
+	"xruns": ("count", True),
+}
+
+# enum sof_comp_type of src/include/uapi/ipc/topology.h
+COMP_TYPES = ["none", "host", "dai", "sg_host", "sg_dai", "volume", "mixer",
+	"mux", "src", "splitter", "tone", "switch", "buffer", "eq_iir",
+	"eq_fir", "fileread", "filewrite", "asrc", "conv", "drc", "kpb",
+	"decoder", "voice", "crossover"]
+
+# CSV headers of the tools, see tb_bench_report(), bench() of comp_fuzz.c and
+# multiplex_pipeline_load-test.sh
+TB_HEADER = "pipeline,comp,type,periods,cycles_per_period,max_cycles,mcps," \
+	"realtime_factor,buffer_bytes"
+BENCH_HEADER = "comp,format,channels,rate,sink_rate,ns_frame"
+LOAD_HEADER = "streams,load%,max%,missed,cancelled,xruns"
+
+KERNEL_LINE = re.compile(r"^\s*(?:#\s*)?(.+): (\d+) (cycles|ns)/sample")
+PROFILE_LINE = re.compile(r"^(\S+)\s+([0-9.]+)\s+[0-9.]+%$")
+PIPELINE_LINE = re.compile(r"^pipeline (\d+): ([0-9.]+) MCPS, ([0-9.]+) x")
+LATENCY_LINE = re.compile(r"^Impulse latency to output (\d+): (-?[0-9.]+) us")
+JITTER_LINE = re.compile(r"^Period jitter: avg [0-9.]+ us, max ([0-9.]+) us")
+
+def stderr_print(*args, **kwargs):
+	print(*args, file=sys.stderr, **kwargs)
+
+def result(source, scope, name, metric, value, unit=None):
+	return {"source": source, "scope": scope, "name": name,
+		"metric": metric, "value": float(value),
+		"unit": unit or METRICS[metric][0]}
+
+def comp_type(index):
+	index = int(index)
+	if index < len(COMP_TYPES):
+		return COMP_TYPES[index]
+	return "type{:d}".format(index)
+
+def read_testbench_csv(rows):
+	# testbench -P, the per pipeline sums have "all" as component
+	results = []
+	for r in rows:
+		if r["comp"] == "all":
+			name = "pipeline " + r["pipeline"]
+			results.append(result("testbench", "pipeline", name,
+				"mcps", r["mcps"]))
+			results.append(result("testbench", "pipeline", name,
+				"realtime_factor", r["realtime_factor"]))
+			results.append(result("testbench", "pipeline", name,
+				"buffer_bytes", r["buffer_bytes"]))
+			continue
+		name = "{:s} {:s}".format(comp_type(r["type"]), r["comp"])
+		for metric in ("mcps", "cycles_per_period", "max_cycles",
+			       "realtime_factor", "buffer_bytes"):
+			results.append(result("testbench", "component", name,
+				metric, r[metric]))
+	return results
+
+def read_bench_csv(rows):
+	# comp_bench -b -C, one row per stream combination
+	results = []
+	for r in rows:
+		name = "{:s} {:s} {:s}ch {:s}->{:s}".format(r["comp"],
+			r["format"], r["channels"], r["rate"], r["sink_rate"])
+		results.append(result("comp_bench", "component", name,
+			"ns_per_frame", r["ns_frame"]))
+	return results
+
+def read_load_csv(rows):
+	# multiplex_pipeline_load-test.sh, one row per number of streams
+	results = []
+	for r in rows:
+		name = "streams " + r["streams"]
+		results.append(result("firmware", "dsp", name, "load",
+			r["load%"]))
+		results.append(result("firmware", "dsp", name,
+			"max_pipeline_load", r["max%"]))
+		for metric in ("missed", "cancelled", "xruns"):
+			results.append(result("firmware", "dsp", name, metric,
+				r[metric]))
+	return results
+
+def read_report_rows(rows):
+	return [result(r["source"], r["scope"], r["name"], r["metric"],
+		r["value"], r["unit"]) for r in rows]
+
+def read_text(lines):
+	# kernel_bench output, ISS profile per source file and testbench output
+	results = []
+	flat = False
+	for line in lines:
+		line = line.rstrip()
+		m = KERNEL_LINE.match(line)
+		if m:
+			metric = "cycles_per_sample" if m.group(3) == "cycles" \
+				else "ns_per_sample"
+			results.append(result("kernel_bench", "kernel",
+				m.group(1), metric, m.group(2)))
+			continue
+		# the flat profile follows the per file sums after a blank line
+		if not line and results and results[-1]["source"] == "iss":
+			flat = True
+		m = PROFILE_LINE.match(line)
+		if m and not flat:
+			results.append(result("iss", "file", m.group(1),
+				"self_time", m.group(2)))
+			continue
+		m = PIPELINE_LINE.match(line)
+		if m:
+			name = "pipeline " + m.group(1)
+			results.append(result("testbench", "pipeline", name,
+				"mcps", m.group(2)))
+			results.append(result("testbench", "pipeline", name,
+				"realtime_factor", m.group(3)))
+			continue
+		m = LATENCY_LINE.match(line)
+		if m:
+			results.append(result("testbench", "output",
+				"output " + m.group(1), "latency", m.group(2)))
+			continue
+		m = JITTER_LINE.match(line)
+		if m:
+			results.append(result("testbench", "output", "period",
+				"jitter_max", m.group(1)))
+	return results
+
+def read_csv(lines, header):
+	rows = list(csv.DictReader(lines, [f.strip() for f in header]))
+	for r in rows:
+		for k in r:
+			r[k] = r[k].strip() if r[k] else ""
+	return rows
+
+def read_results(name):
+	"""Results of a tool output or report file, the format from the content"""
+	with open(name) as f:
+		text = f.read()
+
+	if name.endswith(".json"):
+		report = json.loads(text)
+		if report.get("schema") != SCHEMA:
+			raise ValueError("unsupported schema")
+		return report.get("commit"), report.get("platform"), \
+			read_report_rows(report["results"])
+
+	lines = [l for l in text.splitlines() if l and not l.startswith("#")]
+	header = lines[0].split(",") if lines else []
+	squashed = "".join(header).replace(" ", "")
+	if squashed == "".join(FIELDS):
+		rows = read_csv(lines[1:], header)
+		commits = set(r["commit"] for r in rows)
+		platforms = set(r["platform"] for r in rows)
+		return commits.pop() if len(commits) == 1 else None, \
+			platforms.pop() if len(platforms) == 1 else None, \
+			read_report_rows(rows)
+	if squashed == TB_HEADER.replace(",", ""):
+		return None, None, read_testbench_csv(read_csv(lines[1:],
+			header))
+	if squashed == BENCH_HEADER.replace(",", ""):
+		return None, None, read_bench_csv(read_csv(lines[1:], header))
+	if squashed == LOAD_HEADER.replace(",", ""):
+		return None, None, read_load_csv(read_csv(lines[1:],
+			LOAD_HEADER.split(",")))
+	return None, None, read_text(text.splitlines())
+
+def key(r):
+	return (r["source"], r["scope"], r["name"], r["metric"])
+
+def merge(results):
+	# a later result of the same component and metric replaces the earlier
+	merged = {}
+	for r in results:
+		merged[key(r)] = r
+	return [merged[k] for k in sorted(merged)]
+
+def git_commit():
+	top = os.path.dirname(os.path.abspath(__file__))
+	try:
+		out = subprocess.check_output(["git", "-C", top, "describe",
+			"--always", "--dirty"], stderr=subprocess.DEVNULL)
+		return out.decode().strip()
+	except (OSError, subprocess.CalledProcessError):
+		return "unknown"
+
+def write_report(name, commit, platform, results):
+	if name.endswith(".json"):
+		with open(name, "w") as f:
+			json.dump({"schema": SCHEMA, "commit": commit,
+				"platform": platform, "results": results}, f,
+				indent=1, sort_keys=True)
+			f.write("\n")
+		return
+
+	f = open(name, "w") if name != "-" else sys.stdout
+	writer = csv.DictWriter(f, FIELDS, lineterminator="\n")
+	writer.writeheader()
+	for r in results:
+		row = dict(r, commit=commit, platform=platform)
+		row["value"] = "{:g}".format(r["value"])
+		writer.writerow(row)
+	if f is not sys.stdout:
+		f.close()
+
+def change(old, new):
+	if old == new:
+		return 0.0
+	if old == 0:
+		return float("inf")
+	return 100.0 * (new - old) / abs(old)
+
+def compare(results, baseline, threshold, verbose):
+	"""Print the results that are worse than the baseline by more than
+	threshold percent, returns their count"""
+	base = dict((key(r), r) for r in baseline)
+	regressions = 0
+	for r in results:
+		b = base.get(key(r))
+		if not b or b["unit"] != r["unit"]:
+			continue
+		worse = METRICS.get(r["metric"], (None, True))[1]
+		delta = change(b["value"], r["value"])
+		bad = delta > threshold if worse else delta < -threshold
+		if bad or verbose:
+			print("{:s}{:<12s} {:<32s} {:<18s} {:12g} -> {:12g} {:s}"
+				" {:+.1f}%".format("REGRESSION " if bad else "",
+				r["source"], r["name"], r["metric"], b["value"],
+				r["value"], r["unit"], delta))
+		regressions += bad
+	return regressions
+
+def history(reports):
+	"""One line per component and metric with the value of every report"""
+	keys = sorted(set(k for _, _, results in reports
+		for k in (key(r) for r in results)))
+	values = [dict((key(r), r["value"]) for r in results)
+		for _, _, results in reports]
+
+	print("{:<12s} {:<32s} {:<18s}".format("source", "name", "metric") +
+		"".join(" {:>12.12s}".format(c or "-") for c, _, _ in reports) +
+		" {:>8s}".format("change"))
+	for k in keys:
+		row = [v.get(k) for v in values]
+		known = [v for v in row if v is not None]
+		delta = change(known[0], known[-1]) if len(known) > 1 else 0.0
+		print("{:<12s} {:<32.32s} {:<18s}".format(k[0], k[2], k[3]) +
+			"".join(" {:>12s}".format("-" if v is None else
+			"{:g}".format(v)) for v in row) +
+			" {:>+7.1f}%".format(delta))
+
+def parse_params():
+	parser = argparse.ArgumentParser(
+		description="Tool for merging benchmark results into one"
+			+" report per commit and platform, and for finding"
+			+" MCPS and latency regressions against a baseline."
+	)
+	parser.add_argument('infiles', nargs='+', type=str,
+		help='testbench, comp_bench, kernel_bench, ISS profile, load'
+			+' test or report files')
+	parser.add_argument('-p', '--platform', type=str,
+		help='platform of the results, host if not in a report')
+	parser.add_argument('-g', '--commit', type=str,
+		help='commit of the results, git describe if not given')
+	parser.add_argument('-o', '--output', type=str,
+		help='report file, JSON for .json names and CSV otherwise')
+	parser.add_argument('-b', '--baseline', type=str,
+		help='report to compare with, fails on regressions')
+	parser.add_argument('-t', '--threshold', type=float, default=5.0,
+		help='allowed change in percent, 5 if not given')
+	parser.add_argument('-u', '--update', action='store_true',
+		help='write the results into the baseline')
+	parser.add_argument('-H', '--history', action='store_true',
+		help='list the report files side by side')
+	parser.add_argument('-v', '--verbose', action='store_true',
+		help='print every compared result')
+	return parser.parse_args()
+
+if __name__ == "__main__":
+	args = parse_params()
+	reports = []
+	for name in args.infiles:
+		try:
+			reports.append(read_results(name))
+		except (ValueError, KeyError, TypeError, IOError) as e:
+			stderr_print("{:s}: error: {:s}".format(name, str(e)))
+			sys.exit(1)
+
+	if args.history:
+		history(reports)
+		sys.exit(0)
+
+	commit = args.commit or next((c for c, _, _ in reports if c), None) \
+		or git_commit()
+	platform = args.platform or next((p for _, p, _ in reports if p),
+		None) or "host"
+	results = merge([r for _, _, rs in reports for r in rs])
+	if not results:
+		stderr_print("error: no results found")
+		sys.exit(1)
+
+	if args.output:
+		write_report(args.output, commit, platform, results)
+
+	fail = 0
+	if args.baseline and os.path.exists(args.baseline):
+		_, _, baseline = read_results(args.baseline)
+		fail = compare(results, baseline, args.threshold,
+			args.verbose) > 0
+		# an update accepts the new results as the reference
+		if args.update:
+			fail = 0
+			write_report(args.baseline, commit, platform,
+				merge(baseline + results))
+	elif args.baseline and args.update:
+		write_report(args.baseline, commit, platform, results)
+	elif args.baseline:
+		stderr_print("{:s}: no baseline, not compared".format(
+			args.baseline))
+
+	if not args.output and not args.baseline:
+		write_report("-", commit, platform, results)
+	sys.exit(fail)
@@ -0,0 +1,1155 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Seppo Ingalsuo <seppo.ingalsuo@linux.intel.com>
+ */
+
+/*
+ * Native version of the SRC objective quality tests in src_test.m. The
+ * stimulus of a test is the same marker chirp and tone sweep the Octave
+ * scripts mix, the output of the test bench is measured from windowed FFT
+ * power spectra instead of the standard notch, low-pass and weighting
+ * filters of std_utils. Each run handles one test of one rate pair so that
+ * src_test_native.sh can run the whole rate matrix in parallel.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <math.h>
+
+#define QA_IDLE_T	0.5	/* silence around the markers in s */
+#define QA_MARK_T	0.2	/* marker chirp length in s */
+#define QA_MARK_DB	-10.0	/* marker chirp level in dBFS */
+#define QA_MARK_F0	200.0
+#define QA_MARK_F1	3500.0
+
+#define QA_FFT_MAX	(1 << 17)
+#define QA_TONE_BINS	8	/* half width of the window main lobe */
+#define QA_DC_BINS	8	/* bins near DC left out of noise sums */
+
+#define QA_MAX_TONES	512
+#define QA_EXIT_NA	2
+
+enum qa_test_id {
+	QA_G = 0,
+	QA_FR,
+	QA_THDNF,
+	QA_DR,
+	QA_AAP,
+	QA_AIP,
+	QA_NUM_TESTS,
+};
+
+static const char *qa_test_names[QA_NUM_TESTS] = {
+	"g", "fr", "thdnf", "dr", "aap", "aip",
+};
+
+/* tone sweep of a test, see mix_sweep.m and find_test_signal.m */
+struct qa_test {
+	enum qa_test_id id;
+	double fs1;		/* stimulus rate */
+	double fs2;		/* rate of the output to measure */
+	int bits_in;
+	int bits_out;
+	int nch;
+	int ch;			/* 0 based channel carrying the test */
+	double f[QA_MAX_TONES];	/* tone frequencies */
+	int nf;
+	double a_db[2];		/* tone levels */
+	int na;
+	double tl;		/* tone length in s, whole samples at fs1 */
+	double is;		/* ignore from tone start in s */
+	double ie;		/* ignore from tone end in s */
+	double tr;		/* tone ramp time in s */
+	double mt;		/* max marker distance error in s */
+	double skip;		/* extra settle time skipped in s */
+	double fu;		/* upper measurement band edge */
+	double f_lo;		/* frequency response ripple band */
+	double f_hi;
+	double limit;		/* pass/fail criteria */
+	int verbose;
+};
+
+struct qa_result {
+	double value;
+	double fr3db_hz;
+	int fail;
+};
+
+struct qa_spectrum {
+	double *p;		/* power per bin, sums to mean square */
+	int n;			/* FFT size */
+	double df;		/* bin spacing in Hz */
+};
+
+static void usage(char *name)
+{
+	fprintf(stdout, "Usage %s <option(s)>\n", name);
+	fprintf(stdout, "Generate example %s -t thdnf -r 44100 -R 48000 ",
+		name);
+	fprintf(stdout, "-g thdnf_in.raw\n");
+	fprintf(stdout, "Measure example %s -t thdnf -r 44100 -R 48000 ",
+		name);
+	fprintf(stdout, "-m thdnf_out.raw\n");
+	fprintf(stdout, "Compare example %s -B 32 -x ref.raw -T 1 ", name);
+	fprintf(stdout, "-m out.raw\n");
+	fprintf(stdout, "%s:\t \t\tSRC objective audio quality tests\n",
+		name);
+	fprintf(stdout, "%s:\t -t <test>\tg, fr, thdnf, dr, aap or aip\n",
+		name);
+	fprintf(stdout, "%s:\t -r <rate>\tStimulus sample rate\n", name);
+	fprintf(stdout, "%s:\t -R <rate>\tOutput sample rate\n", name);
+	fprintf(stdout, "%s:\t -b <bits>\tStimulus word length, 16, 24 ",
+		name);
+	fprintf(stdout, "or 32\n");
+	fprintf(stdout, "%s:\t -B <bits>\tOutput word length, 16, 24 ", name);
+	fprintf(stdout, "or 32\n");
+	fprintf(stdout, "%s:\t -n <nch>\tNumber of channels\n", name);
+	fprintf(stdout, "%s:\t -c <ch>\tChannel 1..nch to test\n", name);
+	fprintf(stdout, "%s:\t -g <file>\tWrite stimulus to raw <file>\n",
+		name);
+	fprintf(stdout, "%s:\t -m <file>\tMeasure test bench output ", name);
+	fprintf(stdout, "raw <file>\n");
+	fprintf(stdout, "%s:\t -x <file>\tCompare output with reference ",
+		name);
+	fprintf(stdout, "raw <file>\n");
+	fprintf(stdout, "%s:\t -T <lsb>\tAllowed compare difference, ", name);
+	fprintf(stdout, "0 for bit exact\n");
+	fprintf(stdout, "%s:\t -v\t\tPrint each measured tone\n", name);
+	fprintf(stdout, "A measurement prints <test> <value> <fail>, fail is\n");
+	fprintf(stdout, "0 for pass, 1 for fail and -2 if the test does not\n");
+	fprintf(stdout, "apply to the rate pair. The frequency response adds\n");
+	fprintf(stdout, "the -3 dB frequency and the upper ripple band edge.\n");
+	exit(0);
+}
+
+static double db_to_lin(double db)
+{
+	return pow(10, db / 20);
+}
+
+/* AES17 3.12.3, a full scale sine is 0 dBFS */
+static double ms_to_dbfs(double ms)
+{
+	return 10 * log10(ms + 1e-30) + 20 * log10(sqrt(2));
+}
+
+static void logspace(double *f, double f0, double f1, int n)
+{
+	int i;
+
+	if (n == 1) {
+		f[0] = f1;
+		return;
+	}
+
+	for (i = 0; i < n; i++)
+		f[i] = pow(10, log10(f0) + i * (log10(f1) - log10(f0)) /
+			   (n - 1));
+}
+
+static int log2_steps(double f0, double f1, double per_octave)
+{
+	return (int)ceil(log(f1 / f0) / log(2) * per_octave);
+}
+
+/* src_param.m passband of the converter */
+static double src_passband(double fs1, double fs2)
+{
+	double fs_min = fs1 < fs2 ? fs1 : fs2;
+
+	if (fs_min > 80e3)
+		return 24e3;
+
+	return 20 / 44.1 * fs_min;
+}
+
+static int test_setup(struct qa_test *t)
+{
+	double fs_min = t->fs1 < t->fs2 ? t->fs1 : t->fs2;
+	double f_min;
+	double c;
+	int n;
+	int i;
+
+	t->fu = src_passband(t->fs1, t->fs2);
+	t->is = 20e-3;
+	t->ie = 20e-3;
+	t->tr = 10e-3;
+	t->skip = 0;
+	t->na = 1;
+	t->a_db[0] = -20;
+
+	switch (t->id) {
+	case QA_G:
+		/* AES17 6.2.2 Gain */
+		t->f[0] = 997;
+		t->nf = 1;
+		t->tl = 0.5;
+		t->mt = 0.3;
+		t->limit = 0.1;
+		break;
+	case QA_FR:
+		/* AES17 6.2.3 Frequency response, dense grid for -3 dB */
+		n = log2_steps(997, fs_min / 2, 35);
+		if (n > QA_MAX_TONES / 2)
+			return -EINVAL;
+
+		logspace(t->f, 997, fs_min / 2, n);
+		c = t->f[0] / t->f[1];
+		for (f_min = 997 * c, i = 0; f_min > 20; f_min *= c)
+			i++;
+
+		if (n + i > QA_MAX_TONES)
+			return -EINVAL;
+
+		memmove(&t->f[i], t->f, n * sizeof(double));
+		t->nf = n + i;
+		for (f_min = 997 * c; i > 0; f_min *= c)
+			t->f[--i] = f_min;
+
+		t->tl = fmax(10 / t->f[0], 0.2);
+		t->mt = 0.1;
+		t->f_lo = 20;
+		t->f_hi = t->fu;
+		t->limit = 0.1;
+		break;
+	case QA_THDNF:
+		/* AES17 6.3.2 THD+N ratio vs. frequency, max octave steps */
+		t->nf = log2_steps(20, t->fu, 1);
+		logspace(t->f, 20, t->fu, t->nf);
+		t->a_db[0] = -1;
+		t->a_db[1] = -20;
+		t->na = 2;
+		t->tl = 4;
+		t->mt = 0.1;
+		t->limit = -80;
+		break;
+	case QA_DR:
+		/* AES17 6.4.1 Dynamic range */
+		t->f[0] = 997;
+		t->nf = 1;
+		t->a_db[0] = -60;
+		t->is = 1.0;
+		t->tl = 3;
+		t->mt = 0.3;
+		t->limit = 100;
+		break;
+	case QA_AAP:
+		/* AES17 6.6.6 Attenuation of alias products, needs
+		 * an input rate above the output rate
+		 */
+		if (t->fs1 <= t->fs2)
+			return -ENOTSUP;
+
+		n = log2_steps(t->fs2 / 2, t->fs1 / 2, 3);
+		if (n < 50)
+			n = 50;
+
+		t->f[0] = 997;
+		logspace(&t->f[1], t->fs1 / 2, t->fs2 / 2, n);
+		t->nf = n + 1;
+		t->tl = 0.2;
+		t->mt = 0.3;
+		t->limit = -60;
+		break;
+	case QA_AIP:
+		/* AES17 6.6.7 Attenuation of image products, needs
+		 * an output rate above the input rate
+		 */
+		if (t->fs1 >= t->fs2)
+			return -ENOTSUP;
+
+		n = log2_steps(20, t->fs1 / 2, 3);
+		t->f[0] = 997;
+		logspace(&t->f[1], 20, t->fs1 / 2, n);
+		t->nf = n + 1;
+		t->fu = t->fs1 / 2;
+		t->tl = 3;
+		t->mt = 0.1;
+		t->skip = 1.0;
+		t->limit = -60;
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	/* whole samples per tone at the stimulus rate */
+	t->tl = round(t->tl * t->fs1) / t->fs1;
+	return 0;
+}
+
+/* in place radix-2 FFT, n a power of two */
+static void fft(double *re, double *im, int n, int inverse)
+{
+	double wr, wi, ur, ui, tr, ti, a;
+	int i, j, k, m, h;
+
+	for (i = 1, j = 0; i < n; i++) {
+		for (k = n >> 1; j & k; k >>= 1)
+			j ^= k;
+		j |= k;
+		if (i < j) {
+			tr = re[i];
+			re[i] = re[j];
+			re[j] = tr;
+			ti = im[i];
+			im[i] = im[j];
+			im[j] = ti;
+		}
+	}
+
+	for (m = 2; m <= n; m <<= 1) {
+		h = m >> 1;
+		a = (inverse ? 2 : -2) * M_PI / m;
+		for (k = 0; k < h; k++) {
+			wr = cos(a * k);
+			wi = sin(a * k);
+			for (i = k; i < n; i += m) {
+				j = i + h;
+				tr = wr * re[j] - wi * im[j];
+				ti = wr * im[j] + wi * re[j];
+				ur = re[i];
+				ui = im[i];
+				re[i] = ur + tr;
+				im[i] = ui + ti;
+				re[j] = ur - tr;
+				im[j] = ui - ti;
+			}
+		}
+	}
+}
+
+static int fft_size(int n)
+{
+	int m = 1;
+
+	while (m < n)
+		m <<= 1;
+
+	return m;
+}
+
+/* 7 term Blackman-Harris, sidelobes below -180 dB */
+static double window(int i, int n)
+{
+	static const double c[] = {
+		0.27105140069342, 0.43329793923448, 0.21812299954311,
+		0.06592544638803, 0.01081174209837, 0.00077658482522,
+		0.00001388721735,
+	};
+	double x = 2 * M_PI * i / n;
+	double w = 0;
+	int k;
+
+	for (k = 0; k < 7; k++)
+		w += (k & 1 ? -c[k] : c[k]) * cos(k * x);
+
+	return w;
+}
+
+/* power spectrum of the largest power of two samples from x */
+static int spectrum(const double *x, int nx, double fs,
+		    struct qa_spectrum *s)
+{
+	double *re, *im;
+	double w2 = 0;
+	double w;
+	int n;
+	int i;
+
+	n = fft_size(nx + 1) >> 1;
+	if (n > QA_FFT_MAX)
+		n = QA_FFT_MAX;
+	if (n < 64)
+		return -EINVAL;
+
+	re = malloc(n * sizeof(double));
+	im = calloc(n, sizeof(double));
+	s->p = malloc((n / 2 + 1) * sizeof(double));
+	if (!re || !im || !s->p) {
+		free(re);
+		free(im);
+		free(s->p);
+		return -ENOMEM;
+	}
+
+	for (i = 0; i < n; i++) {
+		w = window(i, n);
+		re[i] = x[i] * w;
+		w2 += w * w;
+	}
+
+	fft(re, im, n, 0);
+
+	/* one sided, Parseval scaled to the mean square of x */
+	for (i = 0; i <= n / 2; i++) {
+		s->p[i] = (re[i] * re[i] + im[i] * im[i]) / (n * w2);
+		if (i > 0 && i < n / 2)
+			s->p[i] *= 2;
+	}
+
+	s->n = n;
+	s->df = fs / n;
+	free(re);
+	free(im);
+	return 0;
+}
+
+static int bin_of(struct qa_spectrum *s, double f)
+{
+	int k = (int)round(f / s->df);
+
+	if (k < 0)
+		return 0;
+	if (k > s->n / 2)
+		return s->n / 2;
+
+	return k;
+}
+
+static double band_power(struct qa_spectrum *s, double f_lo, double f_hi)
+{
+	double sum = 0;
+	int k;
+
+	for (k = bin_of(s, f_lo); k <= bin_of(s, f_hi); k++)
+		sum += s->p[k];
+
+	return sum;
+}
+
+static double tone_power(struct qa_spectrum *s, double f)
+{
+	return band_power(s, f - QA_TONE_BINS * s->df,
+			  f + QA_TONE_BINS * s->df);
+}
+
+/* the noise band sums leave out the DC bins and the test tone */
+static double noise_power(struct qa_spectrum *s, double f, double f_lo,
+			  double f_hi)
+{
+	double f_dc = QA_DC_BINS * s->df;
+	double sum;
+	double t;
+
+	if (f_lo < f_dc)
+		f_lo = f_dc;
+	if (f_hi <= f_lo)
+		return 0;
+
+	sum = band_power(s, f_lo, f_hi);
+	t = band_power(s, fmax(f - QA_TONE_BINS * s->df, f_lo),
+		       fmin(f + QA_TONE_BINS * s->df, f_hi));
+
+	return sum > t ? sum - t : 0;
+}
+
+/* AES17 CCIR-RMS weighting, ITU-R 468 shifted to 0 dB at 2 kHz */
+static double ccir_weight_db(double f)
+{
+	double h1, h2, r;
+
+	h1 = -4.737338981378384e-24 * pow(f, 6) +
+		2.043828333606125e-15 * pow(f, 4) -
+		1.363894795463638e-7 * f * f + 1;
+	h2 = 1.306612257412824e-19 * pow(f, 5) -
+		2.118150887518656e-11 * pow(f, 3) +
+		5.559488023498642e-4 * f;
+	r = 1.246332637532143e-4 * f / sqrt(h1 * h1 + h2 * h2);
+
+	return 18.2 + 20 * log10(r + 1e-30) - 5.63;
+}
+
+static double weighted_noise_power(struct qa_spectrum *s, double f)
+{
+	double sum = 0;
+	double fk;
+	int k;
+
+	for (k = QA_DC_BINS; k <= s->n / 2; k++) {
+		fk = k * s->df;
+		if (fabs(fk - f) <= QA_TONE_BINS * s->df)
+			continue;
+
+		sum += s->p[k] * pow(10, ccir_weight_db(fk) / 10);
+	}
+
+	return sum;
+}
+
+/* Hann windowed linear chirp of sync_chirp.m */
+static double *marker(double fs, int up, int *n)
+{
+	double f0 = up ? QA_MARK_F0 : QA_MARK_F1;
+	double f1 = up ? QA_MARK_F1 : QA_MARK_F0;
+	double a = db_to_lin(QA_MARK_DB);
+	double *x;
+	double t;
+	int i;
+
+	*n = (int)round(QA_MARK_T * fs);
+	x = malloc(*n * sizeof(double));
+	if (!x)
+		return NULL;
+
+	for (i = 0; i < *n; i++) {
+		t = i / fs;
+		x[i] = a * cos(2 * M_PI * (f0 * t + (f1 - f0) /
+					   (2 * QA_MARK_T) * t * t)) *
+			0.5 * (1 - cos(2 * M_PI * (i + 1) / (*n + 1)));
+	}
+
+	return x;
+}
+
+static int write_sample(FILE *fh, double x, int bits)
+{
+	double scale = ldexp(1, bits - 1);
+	double d = drand48() - drand48();	/* TPDF dither */
+	double v = floor(scale * x + d + 0.5);
+	int32_t s32;
+	int16_t s16;
+
+	if (v > scale - 1)
+		v = scale - 1;
+	if (v < -scale)
+		v = -scale;
+
+	if (bits == 16) {
+		s16 = (int16_t)v;
+		return fwrite(&s16, sizeof(s16), 1, fh) == 1 ? 0 : -EIO;
+	}
+
+	s32 = (int32_t)v;
+	return fwrite(&s32, sizeof(s32), 1, fh) == 1 ? 0 : -EIO;
+}
+
+static int write_frame(FILE *fh, struct qa_test *t, double x)
+{
+	int ret;
+	int j;
+
+	for (j = 0; j < t->nch; j++) {
+		ret = write_sample(fh, j == t->ch ? x : 0, t->bits_in);
+		if (ret < 0)
+			return ret;
+	}
+
+	return 0;
+}
+
+/* idle, start marker, tones, end marker, idle as in mix_sweep.m */
+static int generate(struct qa_test *t, const char *fn)
+{
+	double *mark_start = NULL;
+	double *mark_end = NULL;
+	int n_idle = (int)round(QA_IDLE_T * t->fs1);
+	int nt = (int)round(t->tl * t->fs1);
+	int n_ramp = (int)round(t->tr * t->fs1);
+	int n_mark;
+	double a, g, x;
+	FILE *fh;
+	int ret = -ENOMEM;
+	int i, m, n;
+
+	fh = fopen(fn, "wb");
+	if (!fh) {
+		fprintf(stderr, "error: can't open %s\n", fn);
+		return -errno;
+	}
+
+	mark_start = marker(t->fs1, 1, &n_mark);
+	mark_end = marker(t->fs1, 0, &n_mark);
+	if (!mark_start || !mark_end)
+		goto out;
+
+	ret = 0;
+	for (i = 0; i < n_idle && !ret; i++)
+		ret = write_frame(fh, t, 0);
+	for (i = 0; i < n_mark && !ret; i++)
+		ret = write_frame(fh, t, mark_start[i]);
+
+	for (m = 0; m < t->na; m++) {
+		a = db_to_lin(t->a_db[m]);
+		for (n = 0; n < t->nf; n++) {
+			for (i = 0; i < nt && !ret; i++) {
+				g = 1;
+				if (i < n_ramp)
+					g = (double)i / (n_ramp - 1);
+				if (i >= nt - n_ramp)
+					g = (double)(nt - 1 - i) / (n_ramp - 1);
+
+				x = a * g * sin(2 * M_PI * t->f[n] * i /
+						t->fs1);
+				ret = write_frame(fh, t, x);
+			}
+		}
+	}
+
+	for (i = 0; i < n_mark && !ret; i++)
+		ret = write_frame(fh, t, mark_end[i]);
+	for (i = 0; i < n_idle && !ret; i++)
+		ret = write_frame(fh, t, 0);
+
+out:
+	if (ret < 0)
+		fprintf(stderr, "error: failed to write %s\n", fn);
+	free(mark_start);
+	free(mark_end);
+	fclose(fh);
+	return ret;
+}
+
+static void *read_raw(const char *fn, int bits, long *samples)
+{
+	size_t bytes = bits == 16 ? sizeof(int16_t) : sizeof(int32_t);
+	void *data;
+	FILE *fh;
+	long size;
+
+	fh = fopen(fn, "rb");
+	if (!fh) {
+		fprintf(stderr, "error: can't open %s\n", fn);
+		return NULL;
+	}
+
+	fseek(fh, 0, SEEK_END);
+	size = ftell(fh);
+	fseek(fh, 0, SEEK_SET);
+
+	*samples = size / bytes;
+	data = malloc(*samples * bytes + 1);
+	if (data && fread(data, bytes, *samples, fh) != (size_t)*samples) {
+		fprintf(stderr, "error: failed to read %s\n", fn);
+		free(data);
+		data = NULL;
+	}
+
+	fclose(fh);
+	return data;
+}
+
+static int32_t raw_sample(const void *data, int bits, long i)
+{
+	if (bits == 16)
+		return ((const int16_t *)data)[i];
+
+	return ((const int32_t *)data)[i];
+}
+
+/* test channel of the output scaled to +/- 1.0 */
+static double *load_output(struct qa_test *t, const char *fn, long *nx)
+{
+	double scale = ldexp(1, -(t->bits_out - 1));
+	void *data;
+	double *x;
+	long samples;
+	long i;
+
+	data = read_raw(fn, t->bits_out, &samples);
+	if (!data)
+		return NULL;
+
+	*nx = samples / t->nch;
+	x = malloc((*nx + 1) * sizeof(double));
+	if (x) {
+		for (i = 0; i < *nx; i++)
+			x[i] = raw_sample(data, t->bits_out,
+					  i * t->nch + t->ch) * scale;
+	}
+
+	free(data);
+	return x;
+}
+
+/* lag of the best match of s within y, zero padded correlation */
+static long find_marker(const double *y, long ny, const double *s, int ns)
+{
+	double *yr, *yi, *sr, *si;
+	double best = -1;
+	double r;
+	long lag = -1;
+	long n;
+	long i;
+
+	n = fft_size(ny + ns);
+	yr = calloc(n, sizeof(double));
+	yi = calloc(n, sizeof(double));
+	sr = calloc(n, sizeof(double));
+	si = calloc(n, sizeof(double));
+	if (!yr || !yi || !sr || !si)
+		goto out;
+
+	memcpy(yr, y, ny * sizeof(double));
+	memcpy(sr, s, ns * sizeof(double));
+	fft(yr, yi, n, 0);
+	fft(sr, si, n, 0);
+
+	/* Y * conj(S) */
+	for (i = 0; i < n; i++) {
+		r = yr[i] * sr[i] + yi[i] * si[i];
+		yi[i] = yi[i] * sr[i] - yr[i] * si[i];
+		yr[i] = r;
+	}
+
+	fft(yr, yi, n, 1);
+	for (i = 0; i < ny; i++) {
+		if (yr[i] > best) {
+			best = yr[i];
+			lag = i;
+		}
+	}
+
+out:
+	free(yr);
+	free(yi);
+	free(sr);
+	free(si);
+	return lag;
+}
+
+/* first tone start in the output, see find_test_signal.m */
+static long find_test_signal(struct qa_test *t, const double *x, long nx)
+{
+	double *mark;
+	double len_s, ref_s;
+	long d_start, d_end;
+	long n;
+	int n_mark;
+
+	mark = marker(t->fs2, 1, &n_mark);
+	if (!mark)
+		return -ENOMEM;
+
+	/* idle, the marker and as much again for the converter delay */
+	n = (long)round(t->fs2 * (QA_IDLE_T + 2 * QA_MARK_T));
+	d_start = find_marker(x, n < nx ? n : nx, mark, n_mark);
+	free(mark);
+
+	mark = marker(t->fs2, 0, &n_mark);
+	if (!mark)
+		return -ENOMEM;
+
+	n = (long)round(t->fs2 * (2 * QA_IDLE_T + QA_MARK_T));
+	if (n > nx)
+		n = nx;
+	d_end = find_marker(x + nx - n, n, mark, n_mark);
+	free(mark);
+
+	if (d_start < 0 || d_end < 0)
+		return -ENOMEM;
+
+	d_end += nx - n;
+	len_s = (d_end - d_start) / t->fs2;
+	ref_s = QA_MARK_T + t->nf * t->na * t->tl;
+	if (fabs(len_s - ref_s) > t->mt) {
+		fprintf(stderr, "error: markers not found, %.3f s between them, expected %.3f s\n",
+			len_s, ref_s);
+		return -EINVAL;
+	}
+
+	return d_start + (long)round(QA_MARK_T * t->fs2);
+}
+
+/* spectrum of tone n of level m, past the settle time of the test */
+static int tone_spectrum(struct qa_test *t, const double *x, long nx,
+			 long d, int m, int n, struct qa_spectrum *s)
+{
+	long nt = (long)round(t->tl * t->fs2);
+	long n_skip = (long)round((t->is + t->skip) * t->fs2);
+	long n_use = nt - n_skip - (long)round(t->ie * t->fs2);
+	long i1 = d + (m * t->nf + n) * nt + n_skip;
+
+	if (n_use <= 0 || i1 + n_use > nx) {
+		fprintf(stderr, "error: output too short for %.0f Hz tone\n",
+			t->f[n]);
+		return -EINVAL;
+	}
+
+	return spectrum(x + i1, n_use, t->fs2, s);
+}
+
+static int measure_g(struct qa_test *t, const double *x, long nx, long d,
+		     struct qa_result *r)
+{
+	struct qa_spectrum s;
+	int ret;
+
+	ret = tone_spectrum(t, x, nx, d, 0, 0, &s);
+	if (ret < 0)
+		return ret;
+
+	r->value = ms_to_dbfs(tone_power(&s, t->f[0])) - t->a_db[0];
+	r->fail = fabs(r->value) > t->limit;
+	free(s.p);
+	return 0;
+}
+
+static int measure_fr(struct qa_test *t, const double *x, long nx, long d,
+		      struct qa_result *r)
+{
+	struct qa_spectrum s;
+	double m[QA_MAX_TONES];
+	double m_ref = 0;
+	double m_min = HUGE_VAL;
+	double m_max = -HUGE_VAL;
+	double df_ref = HUGE_VAL;
+	int ret;
+	int n;
+
+	for (n = 0; n < t->nf; n++) {
+		ret = tone_spectrum(t, x, nx, d, 0, n, &s);
+		if (ret < 0)
+			return ret;
+
+		m[n] = ms_to_dbfs(tone_power(&s, t->f[n])) - t->a_db[0];
+		free(s.p);
+
+		if (fabs(t->f[n] - 997) < df_ref) {
+			df_ref = fabs(t->f[n] - 997);
+			m_ref = m[n];
+		}
+	}
+
+	/* 997 Hz is 0 dB */
+	r->fr3db_hz = 0;
+	for (n = 0; n < t->nf; n++) {
+		m[n] -= m_ref;
+		if (t->verbose)
+			fprintf(stderr, "%10.1f Hz %8.3f dB\n", t->f[n], m[n]);
+		if (m[n] > -3)
+			r->fr3db_hz = t->f[n];
+		if (t->f[n] > t->f_lo && t->f[n] < t->f_hi) {
+			m_min = fmin(m_min, m[n]);
+			m_max = fmax(m_max, m[n]);
+		}
+	}
+
+	r->value = (m_max - m_min) / 2;
+	r->fail = r->value > t->limit;
+	return 0;
+}
+
+static int measure_thdnf(struct qa_test *t, const double *x, long nx, long d,
+			 struct qa_result *r)
+{
+	struct qa_spectrum s;
+	double total, thdn;
+	int ret;
+	int m, n;
+
+	r->value = -HUGE_VAL;
+	for (m = 0; m < t->na; m++) {
+		for (n = 0; n < t->nf; n++) {
+			ret = tone_spectrum(t, x, nx, d, m, n, &s);
+			if (ret < 0)
+				return ret;
+
+			total = band_power(&s, QA_DC_BINS * s.df, t->fu);
+			thdn = 10 * log10((noise_power(&s, t->f[n], 0, t->fu) +
+					   1e-30) / (total + 1e-30));
+			free(s.p);
+
+			if (t->verbose)
+				fprintf(stderr, "%10.1f Hz %6.1f dBFS THD+N %8.2f dB\n",
+					t->f[n], t->a_db[m], thdn);
+			r->value = fmax(r->value, thdn);
+		}
+	}
+
+	r->fail = r->value > t->limit;
+	return 0;
+}
+
+static int measure_dr(struct qa_test *t, const double *x, long nx, long d,
+		      struct qa_result *r)
+{
+	struct qa_spectrum s;
+	double level, noise;
+	int ret;
+
+	ret = tone_spectrum(t, x, nx, d, 0, 0, &s);
+	if (ret < 0)
+		return ret;
+
+	level = ms_to_dbfs(tone_power(&s, t->f[0]));
+	noise = ms_to_dbfs(weighted_noise_power(&s, t->f[0]));
+	free(s.p);
+
+	r->value = level - noise - t->a_db[0];
+	r->fail = r->value < t->limit;
+	return 0;
+}
+
+/* the first tone is the 997 Hz reference, the sweep follows */
+static int measure_xp(struct qa_test *t, const double *x, long nx, long d,
+		      struct qa_result *r)
+{
+	struct qa_spectrum s;
+	double ref = 0;
+	double m;
+	int ret;
+	int n;
+
+	r->value = -HUGE_VAL;
+	for (n = 0; n < t->nf; n++) {
+		ret = tone_spectrum(t, x, nx, d, 0, n, &s);
+		if (ret < 0)
+			return ret;
+
+		if (t->id == QA_AAP)
+			/* anything left of a tone above output Nyquist */
+			m = ms_to_dbfs(band_power(&s, QA_DC_BINS * s.df,
+						  t->fs2 / 2));
+		else if (n == 0)
+			m = ms_to_dbfs(band_power(&s, QA_DC_BINS * s.df,
+						  t->fu));
+		else
+			/* images above the stimulus Nyquist */
+			m = ms_to_dbfs(noise_power(&s, t->f[n], t->fu,
+						   t->fs2 / 2));
+		free(s.p);
+
+		if (n == 0) {
+			ref = m;
+			continue;
+		}
+
+		if (t->verbose)
+			fprintf(stderr, "%10.1f Hz %8.2f dB\n", t->f[n],
+				m - ref);
+		r->value = fmax(r->value, m - ref);
+	}
+
+	r->fail = r->value > t->limit;
+	return 0;
+}
+
+static int measure(struct qa_test *t, const char *fn, struct qa_result *r)
+{
+	double *x;
+	long nx;
+	long d;
+	int ret;
+
+	x = load_output(t, fn, &nx);
+	if (!x)
+		return -EINVAL;
+
+	d = find_test_signal(t, x, nx);
+	if (d < 0) {
+		ret = d;
+		goto out;
+	}
+
+	switch (t->id) {
+	case QA_G:
+		ret = measure_g(t, x, nx, d, r);
+		break;
+	case QA_FR:
+		ret = measure_fr(t, x, nx, d, r);
+		break;
+	case QA_THDNF:
+		ret = measure_thdnf(t, x, nx, d, r);
+		break;
+	case QA_DR:
+		ret = measure_dr(t, x, nx, d, r);
+		break;
+	default:
+		ret = measure_xp(t, x, nx, d, r);
+		break;
+	}
+
+out:
+	free(x);
+	return ret;
+}
+
+/* largest sample difference of two outputs in LSB */
+static int compare(const char *fn, const char *ref, int bits, long tol)
+{
+	void *a, *b;
+	long na, nb;
+	long diff;
+	long max = 0;
+	long i;
+
+	a = read_raw(fn, bits, &na);
+	b = read_raw(ref, bits, &nb);
+	if (!a || !b) {
+		free(a);
+		free(b);
+		return -EINVAL;
+	}
+
+	for (i = 0; i < na && i < nb; i++) {
+		diff = labs((long)raw_sample(a, bits, i) -
+			    (long)raw_sample(b, bits, i));
+		if (diff > max)
+			max = diff;
+	}
+
+	if (na != nb)
+		fprintf(stderr, "error: %ld samples, reference has %ld\n",
+			na, nb);
+
+	printf("cmp %ld %d\n", max, na != nb || max > tol);
+	free(a);
+	free(b);
+	return 0;
+}
+
+static int check_bits(int bits)
+{
+	return bits == 16 || bits == 24 || bits == 32;
+}
+
+int main(int argc, char *argv[])
+{
+	struct qa_test t;
+	struct qa_result r;
+	char *gen = NULL;
+	char *out = NULL;
+	char *ref = NULL;
+	long tol = 0;
+	int opt;
+	int ret;
+	int i;
+
+	memset(&t, 0, sizeof(t));
+	memset(&r, 0, sizeof(r));
+	t.id = QA_NUM_TESTS;
+	t.bits_in = 32;
+	t.bits_out = 32;
+	t.nch = 2;
+	t.ch = 0;
+
+	while ((opt = getopt(argc, argv, "ht:r:R:b:B:n:c:g:m:x:T:v")) != -1) {
+		switch (opt) {
+		case 't':
+			for (i = 0; i < QA_NUM_TESTS; i++)
+				if (!strcmp(optarg, qa_test_names[i]))
+					t.id = i;
+			break;
+		case 'r':
+			t.fs1 = atof(optarg);
+			break;
+		case 'R':
+			t.fs2 = atof(optarg);
+			break;
+		case 'b':
+			t.bits_in = atoi(optarg);
+			break;
+		case 'B':
+			t.bits_out = atoi(optarg);
+			break;
+		case 'n':
+			t.nch = atoi(optarg);
+			break;
+		case 'c':
+			t.ch = atoi(optarg) - 1;
+			break;
+		case 'g':
+			gen = optarg;
+			break;
+		case 'm':
+			out = optarg;
+			break;
+		case 'x':
+			ref = optarg;
+			break;
+		case 'T':
+			tol = atol(optarg);
+			break;
+		case 'v':
+			t.verbose = 1;
+			break;
+		case 'h':
+			usage(argv[0]);
+			break;
+		default:
+			usage(argv[0]);
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	if (!check_bits(t.bits_in) || !check_bits(t.bits_out) ||
+	    t.nch < 1 || t.ch < 0 || t.ch >= t.nch) {
+		fprintf(stderr, "error: invalid format\n");
+		exit(EXIT_FAILURE);
+	}
+
+	if (ref && out) {
+		ret = compare(out, ref, t.bits_out, tol);
+		exit(ret < 0 ? EXIT_FAILURE : 0);
+	}
+
+	if (t.id == QA_NUM_TESTS || t.fs1 <= 0 || t.fs2 <= 0 ||
+	    (!gen && !out)) {
+		fprintf(stderr, "error: test, rates and a file are needed\n");
+		usage(argv[0]);
+		exit(EXIT_FAILURE);
+	}
+
+	ret = test_setup(&t);
+	if (ret == -ENOTSUP) {
+		printf("%s nan -2\n", qa_test_names[t.id]);
+		exit(QA_EXIT_NA);
+	}
+	if (ret < 0) {
+		fprintf(stderr, "error: can't set up %s for %.0f -> %.0f\n",
+			qa_test_names[t.id], t.fs1, t.fs2);
+		exit(EXIT_FAILURE);
+	}
+
+	/* same dither for every run so reruns give the same stimulus */
+	srand48(t.id + 1);
+
+	if (gen) {
+		ret = generate(&t, gen);
+		exit(ret < 0 ? EXIT_FAILURE : 0);
+	}
+
+	ret = measure(&t, out, &r);
+	if (ret < 0) {
+		printf("%s nan 1\n", qa_test_names[t.id]);
+		exit(EXIT_FAILURE);
+	}
+
+	if (t.id == QA_FR)
+		printf("%s %.3f %d %.1f %.1f\n", qa_test_names[t.id], r.value,
+		       r.fail, r.fr3db_hz, t.f_hi);
+	else
+		printf("%s %.3f %d\n", qa_test_names[t.id], r.value, r.fail);
+
+	return 0;
+}
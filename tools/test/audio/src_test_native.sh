@@ -0,0 +1,197 @@
+#!/bin/bash
+
+# Copyright (c) 2019, Intel Corporation
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#   * Redistributions of source code must retain the above copyright
+#     notice, this list of conditions and the following disclaimer.
+#   * Redistributions in binary form must reproduce the above copyright
+#     notice, this list of conditions and the following disclaimer in the
+#     documentation and/or other materials provided with the distribution.
+#   * Neither the name of the Intel Corporation nor the
+#     names of its contributors may be used to endorse or promote products
+#     derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#
+# Author: Seppo Ingalsuo <seppo.ingalsuo@linux.intel.com>
+#
+
+# SRC objective quality tests of src_test.m with the native sof-audio-qa
+# analyser. Rate pairs run in parallel, each in its own work directory.
+#
+# Run from this directory like src_test.sh, see src_run.sh for the test
+# bench location.
+#
+# Usage: src_test_native.sh [-j jobs] [-b bits_in] [-B bits_out]
+#                           [-k keep_dir] [-x ref_dir [-T lsb]]
+#
+# -k keeps the test bench outputs of every pair in keep_dir, -x compares
+# the outputs of this run with ones kept before, bit exact unless a
+# tolerance in LSB is given with -T.
+
+QA=${QA:-./qa/sof-audio-qa}
+WORK=work
+JOBS=$(nproc)
+BITS_IN=32
+BITS_OUT=32
+KEEP=
+REF=
+TOL=0
+
+FS_IN="8000 11025 12000 16000 22050 24000 32000 44100 48000 50000 64000 \
+88200 96000 176400 192000"
+FS_OUT="8000 11025 12000 16000 22050 24000 32000 44100 48000 50000"
+TESTS="g fr thdnf dr aap aip"
+
+while getopts "j:b:B:k:x:T:" opt; do
+	case $opt in
+	j) JOBS=$OPTARG ;;
+	b) BITS_IN=$OPTARG ;;
+	B) BITS_OUT=$OPTARG ;;
+	k) KEEP=$OPTARG ;;
+	x) REF=$OPTARG ;;
+	T) TOL=$OPTARG ;;
+	*) exit 1 ;;
+	esac
+done
+
+if [ ! -x $QA ]; then
+	echo "Error: $QA not found, build tools or set QA." >&2
+	exit 1
+fi
+
+# Run all tests of one rate pair, results go to $WORK/<in>-<out>/result
+run_pair() {
+	local fs1=$1
+	local fs2=$2
+	local dir=$WORK/$fs1-$fs2
+	local fmt="-r $fs1 -R $fs2 -b $BITS_IN -B $BITS_OUT"
+	local t
+
+	mkdir -p $dir
+	rm -f $dir/result
+	for t in $TESTS; do
+		$QA -t $t $fmt -g $dir/${t}_in.raw >> $dir/result
+		case $? in
+		0) ;;
+		2) continue ;;
+		*) echo "$t nan 1" >> $dir/result; continue ;;
+		esac
+
+		./src_run.sh $BITS_IN $BITS_OUT $fs1 $fs2 $dir/${t}_in.raw \
+			$dir/${t}_out.raw > $dir/${t}.log 2>&1
+
+		# no output from the first test, the pair is not supported
+		if [ ! -s $dir/${t}_out.raw ]; then
+			[ $t == g ] && echo "x" > $dir/result && break
+			echo "$t nan 1" >> $dir/result
+			continue
+		fi
+
+		$QA -t $t $fmt -m $dir/${t}_out.raw >> $dir/result \
+			2>> $dir/${t}.log
+
+		if [ -n "$REF" ]; then
+			$QA -B $BITS_OUT -T $TOL -x $REF/$fs1-$fs2/${t}_out.raw \
+				-m $dir/${t}_out.raw | sed "s/^cmp/${t}_cmp/" \
+				>> $dir/result 2>> $dir/${t}.log
+		fi
+		if [ -n "$KEEP" ]; then
+			mkdir -p $KEEP/$fs1-$fs2
+			mv $dir/${t}_out.raw $KEEP/$fs1-$fs2/
+		fi
+		rm -f $dir/${t}_in.raw $dir/${t}_out.raw
+	done
+	echo "Done $fs1 -> $fs2: $(tr '\n' ' ' < $dir/result)"
+}
+
+# Field of a test result of a pair, x for unsupported pairs
+result() {
+	local file=$WORK/$1-$2/result
+
+	if [ ! -s $file ] || grep -q "^x$" $file; then
+		echo x
+		return
+	fi
+	awk -v t=$3 -v f=$4 '$1 == t { print $f }' $file
+}
+
+# Table in the format of print_val() in src_test.m
+print_val() {
+	local test=$1
+	local field=$2
+	local title=$3
+	local width=$4
+	local scale=${5:-1}
+	local fs1 fs2 v
+
+	printf "\nSRC test result: %s\n" "$title"
+	printf "%8s, " "in \\ out"
+	printf "%${width}.1f, " $(echo $FS_OUT | awk '{for (i = 1; i <= NF; i++) print $i / 1000}')
+	printf "\n"
+	for fs1 in $FS_IN; do
+		printf "%8.1f, " $(awk "BEGIN { print $fs1 / 1000 }")
+		for fs2 in $FS_OUT; do
+			v=$(result $fs1 $fs2 $test $field)
+			case $v in
+			x|"") printf "%${width}s, " x ;;
+			nan) printf "%${width}s, " - ;;
+			*) printf "%${width}.2f, " $(awk "BEGIN { print $v / $scale }") ;;
+			esac
+		done
+		printf "\n"
+	done
+}
+
+export QA WORK BITS_IN BITS_OUT KEEP REF TOL TESTS
+export -f run_pair
+
+mkdir -p $WORK reports
+for fs2 in $FS_OUT; do
+	for fs1 in $FS_IN; do
+		echo $fs1 $fs2
+	done
+done | xargs -P $JOBS -n 2 bash -c 'run_pair $0 $1'
+
+print_val g 2 "Gain dB" 8 | tee reports/g_src.txt
+print_val fr 2 "Frequency response +/- X.XX dB" 8 | tee reports/fr_src.txt
+print_val fr 4 "Frequency response -3 dB 0 - X kHz" 8 1000 | \
+	tee -a reports/fr_src.txt
+print_val thdnf 2 "Worst-case THD+N vs. frequency" 8 | \
+	tee reports/thdnf_src.txt
+print_val dr 2 "Dynamic range dB (CCIR-RMS)" 8 | tee reports/dr_src.txt
+print_val aap 2 "Attenuation of alias products dB" 8 | \
+	tee reports/aap_src.txt
+print_val aip 2 "Attenuation of image products dB" 8 | \
+	tee reports/aip_src.txt
+
+# Verdicts of all pairs, 1 fail, 0 pass, -2 not applicable
+awk '
+	$1 == "x" { next }
+	$3 == 0 { pass++ }
+	$3 == 1 { fail++; print "Failed: " FILENAME " " $0 > "/dev/stderr" }
+	$3 == -2 { na++ }
+	END {
+		printf "\nNumber of passed tests = %d\n", pass
+		printf "Number of failed tests = %d\n", fail
+		printf "Number of non-applicable tests = %d\n", na
+		if (fail > 0 || pass < 1) {
+			printf "\nERROR: TEST FAILED!!!\n"
+			exit 1
+		}
+		printf "\nTest passed.\n"
+	}' $WORK/*/result | tee reports/pf_src.txt
+exit ${PIPESTATUS[0]}
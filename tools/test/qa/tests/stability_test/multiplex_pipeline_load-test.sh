@@ -0,0 +1,221 @@
+#!/bin/bash
+# DSP load and xrun scaling test for concurrent multiplex pipelines
+
+# Copyright (c) 2019, Intel Corporation
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#   * Redistributions of source code must retain the above copyright
+#     notice, this list of conditions and the following disclaimer.
+#   * Redistributions in binary form must reproduce the above copyright
+#     notice, this list of conditions and the following disclaimer in the
+#     documentation and/or other materials provided with the distribution.
+#   * Neither the name of the Intel Corporation nor the
+#     names of its contributors may be used to endorse or promote products
+#     derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#
+# Author: Keqiao Zhang <keqiao.zhang@linux.intel.com>
+#
+
+# Runs the first 1, 2 .. N of the given pipelines at the same time. At each
+# step the SOF_IPC_DEBUG_TASK_STATS of every running pipeline is read through
+# the IPC message injector of the kernel driver, and aplay/arecord report
+# xruns. The worst pipeline task run time in a period is the load of the
+# pipeline, the sum over the pipelines is the DSP load of the step.
+#
+# Usage: multiplex_pipeline_load-test.sh [options] pcm1p[:pipe] pcm1c[:pipe] ..
+#
+# The pipeline ID after a colon enables the task statistics of the PCM,
+# without it the PCM adds load but only its xruns are counted.
+#
+# -t seconds of each step, 5 by default
+# -c timer clock in MHz, 19.2 by default
+# -p pipeline period in us, 1000 by default
+# -l fail when xruns appear at this many streams or less
+# -i IPC message injector, /sys/kernel/debug/sof/ipc_msg_inject by default
+
+FORMATE=s16_le	# sample formate
+CHANNEL=2	# test channel number
+FREQENCY=48000	# sample frequency
+T_TIME=5	# time for each step
+INTERVAL=1	# internal time for each step
+CLOCK=19.2	# timer clock MHz
+PERIOD=1000	# pipeline period us
+LIMIT=0		# streams that must run without xruns
+INJECT=/sys/kernel/debug/sof/ipc_msg_inject
+LOG=multiplex_load
+
+# SOF_IPC_GLB_DEBUG | SOF_IPC_DEBUG_TASK_STATS
+TASK_STATS_CMD=$(( 0xB0020000 ))
+TASK_RESET=1
+
+while getopts "t:c:p:l:i:" opt; do
+	case $opt in
+	t) T_TIME=$OPTARG ;;
+	c) CLOCK=$OPTARG ;;
+	p) PERIOD=$OPTARG ;;
+	l) LIMIT=$OPTARG ;;
+	i) INJECT=$OPTARG ;;
+	*) exit 1 ;;
+	esac
+done
+shift $((OPTIND - 1))
+PARAMS=($@)	# name and pipeline of test pipelines
+NUMBER=${#PARAMS[@]}
+
+if [ $NUMBER == 0 ]; then
+	echo "Usage: ./multiplex_pipeline_load-test.sh [-t sec] [-c MHz]" \
+	     "[-p us] [-l streams] [-i injector] pcm0p:1 pcm0c:2 .."
+	echo "eg. ./multiplex_pipeline_load-test.sh -l 2 pcm0p:1 pcm0c:2 pcm1p"
+	echo "it will run pcm0p, then pcm0p and pcm0c, then all three and"
+	echo "report the DSP load of pipelines 1 and 2 at each step"
+	exit 1
+fi
+
+if [ ! -w $INJECT ]; then
+	echo "Warning: $INJECT not available, only xruns are counted"
+	INJECT=
+fi
+
+# little endian 32 bit word as printf escapes
+le32()
+{
+	printf '\\x%02x\\x%02x\\x%02x\\x%02x' $(( $1 & 0xff )) \
+		$(( ($1 >> 8) & 0xff )) $(( ($1 >> 16) & 0xff )) \
+		$(( ($1 >> 24) & 0xff ))
+}
+
+# read and clear the task statistics of a pipeline, prints the words of
+# struct sof_ipc_debug_task_stats after the reply header: pipeline_id
+# missed rescheduled cancelled max_lateness max_rtime max_qdelay promoted
+task_stats()
+{
+	local msg
+	local reply
+
+	msg=$(le32 16)$(le32 $TASK_STATS_CMD)$(le32 $1)$(le32 $TASK_RESET)
+	printf "$msg" > $INJECT || return 1
+
+	# reply header is size, cmd and error
+	reply=(`od -An -v -t d4 -N 44 $INJECT`)
+	[ ${#reply[@]} == 11 -a "${reply[2]}" == 0 ] || return 1
+	echo ${reply[@]:3}
+}
+
+# start the first n pipelines, report the step when they have stopped
+pipeline_step()
+{
+	local n=$1
+	local pids=()
+	local xruns=0
+	local missed=0
+	local cancelled=0
+	local load_sum=0
+	local load_max=0
+	local i pcm pipe pcmid test_type cmd data stats load
+
+	# clear the statistics of the previous step
+	for ((i = 0; i < n; i++)); do
+		pipe=${PARAMS[$i]#*:}
+		[ -n "$INJECT" -a "$pipe" != "${PARAMS[$i]}" ] &&
+			task_stats $pipe > /dev/null
+	done
+
+	# start pipeline
+	for ((i = 0; i < n; i++)); do
+		pcm=${PARAMS[$i]%%:*}
+		pcmid=`echo $pcm| cut -c 4`
+		test_type=`echo $pcm| cut -c 5`
+		if [[ $test_type == 'p' || $test_type == "P" ]]; then
+			cmd=aplay
+			data=/dev/zero
+		elif [[ $test_type == 'c' || $test_type == "C" ]]; then
+			cmd=arecord
+			data=/dev/null
+		else
+			echo "Wrong parameters, should be pcm0p/pcm0c ..."
+			exit 1
+		fi
+
+		$cmd -Dhw:0,$pcmid -f $FORMATE -c $CHANNEL -r $FREQENCY \
+			-d $T_TIME $data > $LOG.$n.$i.txt 2>&1 &
+		pids[$i]=$!
+	done
+
+	for ((i = 0; i < n; i++)); do
+		if ! wait ${pids[$i]}; then
+			echo "${PARAMS[$i]} failed at $n streams, see $LOG.$n.$i.txt"
+			let xruns++
+		fi
+		let xruns+=`grep -c "underrun\|overrun" $LOG.$n.$i.txt`
+	done
+
+	# task statistics of the step
+	for ((i = 0; i < n; i++)); do
+		pipe=${PARAMS[$i]#*:}
+		[ -z "$INJECT" -o "$pipe" == "${PARAMS[$i]}" ] && continue
+
+		stats=(`task_stats $pipe`)
+		if [ ${#stats[@]} -lt 8 ]; then
+			echo "No task statistics for pipeline $pipe"
+			continue
+		fi
+
+		let missed+=${stats[1]}
+		let cancelled+=${stats[3]}
+		let xruns+=${stats[3]}
+		load=`awk "BEGIN { print ${stats[5]} * 100 / ($CLOCK * $PERIOD) }"`
+		load_sum=`awk "BEGIN { print $load_sum + $load }"`
+		load_max=`awk "BEGIN { print ($load > $load_max) ? $load : $load_max }"`
+		printf "  %-10s load %6.1f%%, missed %d, rescheduled %d," \
+			${PARAMS[$i]} $load ${stats[1]} ${stats[2]}
+		printf " cancelled %d, lateness %d\n" ${stats[3]} ${stats[4]}
+	done
+
+	printf "%7d, %8.1f, %8.1f, %6d, %9d, %5d\n" $n $load_sum $load_max \
+		$missed $cancelled $xruns >> $LOG.csv
+	printf "Streams %d: load %.1f%%, max pipeline %.1f%%, missed %d," \
+		$n $load_sum $load_max $missed
+	printf " cancelled %d, xruns %d\n" $cancelled $xruns
+
+	return $(( xruns > 0 ))
+}
+
+# run test
+echo "streams,   load %,    max %, missed, cancelled, xruns" > $LOG.csv
+FIRST_XRUN=0
+for n in $(seq 1 $NUMBER)
+do
+	echo "Test: $n streams"
+	if ! pipeline_step $n && [ $FIRST_XRUN == 0 ]; then
+		FIRST_XRUN=$n
+	fi
+	sleep $INTERVAL
+done
+
+echo
+cat $LOG.csv
+if [ $FIRST_XRUN == 0 ]; then
+	echo "No xruns with up to $NUMBER streams"
+	exit 0
+fi
+
+echo "First xruns at $FIRST_XRUN streams"
+if [ $FIRST_XRUN -le $LIMIT ]; then
+	echo "Xruns within the limit of $LIMIT streams"
+	exit 1
+fi
+exit 0
@@ -13,3 +13,6 @@ define(`MEM_CAP_LP', eval(1 << 3))
 define(`MEM_CAP_HP', eval(1 << 4))
 define(`MEM_CAP_DMA', eval(1 << 5))
 define(`MEM_CAP_CACHE', eval(1 << 6))
+define(`MEM_CAP_EXEC', eval(1 << 7))
+define(`MEM_CAP_SHARED', eval(1 << 8))
+define(`MEM_CAP_ZERO', eval(1 << 9))
@@ -0,0 +1,393 @@
+#!/usr/bin/env python3
+
+# Tool for checking that a topology fits the cycle and memory budget of a
+# platform. Reads a binary .tplg, estimates the MCPS of every component per
+# core and the heap use per zone, and fails when a budget is exceeded.
+# For more detailed usage, use --help.
+
+from __future__  import print_function
+import argparse
+import math
+import os
+import re
+import struct
+import sys
+
+TPLG_MAGIC = 0x41536f43 # 'CoSA'
+HDR = struct.Struct("<9I")
+VENDOR_ARRAY = struct.Struct("<III")
+TUPLE_WORD = struct.Struct("<II")
+TUPLE_STRING_SIZE = 48 # token and char[44]
+TUPLE_UUID_SIZE = 20 # token and uuid[16]
+NAME_SIZE = 44
+
+TYPE_DAPM_GRAPH = 4
+TYPE_DAPM_WIDGET = 5
+
+TUPLE_TYPE_UUID = 0
+TUPLE_TYPE_STRING = 1
+
+# struct snd_soc_tplg_dapm_widget: size, id, name, sname, reg, shift, mask,
+# subseq, invert, ignore_suspend, event_flags, event_type, num_kcontrols
+WIDGET = struct.Struct("<II44s44s6IHHI")
+
+# SND_SOC_TPLG_DAPM_ widget types used by SOF
+DAPM_MUX = 2
+DAPM_MIXER = 3
+DAPM_PGA = 4
+DAPM_AIF_IN = 11
+DAPM_AIF_OUT = 12
+DAPM_DAI_IN = 13
+DAPM_DAI_OUT = 14
+DAPM_BUFFER = 16
+DAPM_SCHEDULER = 17
+DAPM_EFFECT = 18
+DAPM_SIGGEN = 19
+DAPM_SRC = 20
+
+KINDS = {
+	DAPM_MUX: "mux",
+	DAPM_MIXER: "mixer",
+	DAPM_PGA: "volume",
+	DAPM_AIF_IN: "host",
+	DAPM_AIF_OUT: "host",
+	DAPM_DAI_IN: "dai",
+	DAPM_DAI_OUT: "dai",
+	DAPM_SIGGEN: "tone",
+	DAPM_SRC: "src",
+}
+
+# SOF tokens of tools/topology/sof/tokens.m4
+TKN_BUF_SIZE = 100
+TKN_SCHED_DEADLINE = 200
+TKN_SCHED_CORE = 203
+TKN_SCHED_FRAMES = 204
+TKN_SRC_RATE_IN = 300
+TKN_SRC_RATE_OUT = 301
+TKN_COMP_PERIOD_SINK_COUNT = 400
+TKN_COMP_FORMAT = 402
+TKN_EFFECT_TYPE = 900
+
+SAMPLE_BYTES = {"s16le": 2, "s24le": 4, "s32le": 4, "float": 4}
+
+# Cycles per sample of one channel. The volume, FIR, IIR and tone values are
+# the kernel_bench budgets, the others are estimates of the copy loops. Use
+# -c with kernel_bench output of the target to calibrate.
+COSTS = {
+	"host": 10,
+	"dai": 10,
+	"volume": 40,
+	"mixer": 20,
+	"mux": 10,
+	"tone": 120,
+	"src": 300,
+	"eqfir": 200,
+	"eqiir": 120,
+	"effect": 200,
+}
+
+# kernel_bench reports used for calibration
+BENCH = {
+	"vol s32->s32": "volume",
+	"eq_fir s32": "eqfir",
+	"iir_df2t": "eqiir",
+	"sin_fixed": "tone",
+}
+
+# Fixed cycles per period of each component and of each pipeline for the
+# copy call, buffer bookkeeping and scheduling
+COMP_PERIOD_CYCLES = 1500
+PIPE_PERIOD_CYCLES = 3000
+
+# Runtime zone bytes of the component device and private data, and buffer
+# zone bytes of delay lines per channel
+COMP_RUNTIME = {
+	"host": 512,
+	"dai": 512,
+	"volume": 256,
+	"mixer": 256,
+	"mux": 256,
+	"tone": 512,
+	"src": 512,
+	"eqfir": 1024,
+	"eqiir": 1024,
+	"effect": 1024,
+	"pipeline": 256,
+	"buffer": 128,
+}
+COMP_DELAY = {
+	"src": 4096,
+	"eqfir": 1024,
+	"eqiir": 176,
+}
+
+# Blocks of the buffer zone heaps, HEAP_BUFFER_BLOCK_SIZE
+BUFFER_BLOCK = 0x180
+
+# Platforms by topology name: cores, max clock in MHz and sizes of the runtime
+# and buffer zones in bytes from the platform memory.h
+PLATFORMS = {
+	"byt": (1, 343, 22784, 40704),
+	"cht": (1, 343, 22784, 40704),
+	"hsw": (1, 320, 44032, 406528),
+	"bdw": (1, 320, 44032, 406528),
+	"apl": (2, 400, 90112, 22528 + 32768),
+	"glk": (2, 400, 90112, 22528 + 32768),
+	"cnl": (4, 400, 61440, 802560 + 131072 + 69632),
+	"whl": (4, 400, 61440, 802560 + 131072 + 69632),
+	"hda": (4, 400, 61440, 802560 + 131072 + 69632),
+	"icl": (4, 400, 90112, 2150144 + 131072 + 69632),
+}
+
+def stderr_print(*args, **kwargs):
+	print(*args, file=sys.stderr, **kwargs)
+
+def cstr(data):
+	return data.split(b"\0", 1)[0].decode(errors="replace")
+
+class Widget:
+	def __init__(self, index, wtype, name, tokens):
+		self.index = index
+		self.type = wtype
+		self.name = name
+		self.tokens = tokens
+		self.kind = KINDS.get(wtype)
+		if wtype == DAPM_EFFECT:
+			effect = tokens.get(TKN_EFFECT_TYPE, "").lower()
+			self.kind = effect if effect in COSTS else "effect"
+		self.mcps = 0.0
+		self.runtime = 0
+		self.buffer = 0
+
+def read_tuples(data):
+	tokens = {}
+	offset = 0
+	while offset + VENDOR_ARRAY.size <= len(data):
+		size, ttype, num = VENDOR_ARRAY.unpack_from(data, offset)
+		if size < VENDOR_ARRAY.size or offset + size > len(data):
+			break
+		elem = offset + VENDOR_ARRAY.size
+		for i in range(num):
+			if ttype == TUPLE_TYPE_STRING:
+				token, = struct.unpack_from("<I", data, elem)
+				tokens[token] = cstr(data[elem + 4 :
+					elem + TUPLE_STRING_SIZE])
+				elem += TUPLE_STRING_SIZE
+			elif ttype == TUPLE_TYPE_UUID:
+				elem += TUPLE_UUID_SIZE
+			else:
+				token, value = TUPLE_WORD.unpack_from(data, elem)
+				tokens[token] = value
+				elem += TUPLE_WORD.size
+		offset += size
+	return tokens
+
+def read_priv(data, offset, size):
+	# the private data size is the last word of each element structure
+	priv_size, = struct.unpack_from("<I", data, offset + size - 4)
+	return data[offset + size : offset + size + priv_size], size + priv_size
+
+def read_widgets(hdr_index, data, count):
+	widgets = []
+	offset = 0
+	for i in range(count):
+		fields = WIDGET.unpack_from(data, offset)
+		size, wtype, name, num_kcontrols = fields[0], fields[1], \
+			cstr(fields[2]), fields[-1]
+		priv, length = read_priv(data, offset, size)
+		widgets.append(Widget(hdr_index, wtype, name, read_tuples(priv)))
+		offset += length
+		for k in range(num_kcontrols):
+			ksize, = struct.unpack_from("<I", data, offset)
+			offset += read_priv(data, offset, ksize)[1]
+	return widgets
+
+def read_graph(data, count):
+	routes = []
+	for i in range(count):
+		elem = data[i * 3 * NAME_SIZE : (i + 1) * 3 * NAME_SIZE]
+		sink = cstr(elem[:NAME_SIZE])
+		source = cstr(elem[2 * NAME_SIZE:])
+		routes.append((source, sink))
+	return routes
+
+def read_tplg(name):
+	with open(name, "rb") as f:
+		data = f.read()
+
+	widgets = []
+	routes = []
+	offset = 0
+	while offset + HDR.size <= len(data):
+		magic, _, _, btype, size, _, payload, index, count = \
+			HDR.unpack_from(data, offset)
+		if magic != TPLG_MAGIC:
+			raise ValueError("bad block magic at 0x{:x}".format(offset))
+		block = data[offset + size : offset + size + payload]
+		if btype == TYPE_DAPM_WIDGET:
+			widgets += read_widgets(index, block, count)
+		elif btype == TYPE_DAPM_GRAPH:
+			routes += read_graph(block, count)
+		offset += size + payload
+	return widgets, routes
+
+def read_costs(names):
+	for name in names:
+		with open(name) as f:
+			for line in f:
+				m = re.match(r"^\s*(?:#\s*)?(.+): (\d+) cycles/sample",
+					line)
+				if m and m.group(1) in BENCH:
+					COSTS[BENCH[m.group(1)]] = int(m.group(2))
+
+def block_size(size):
+	# runtime zone blocks are powers of two from 64 bytes
+	return max(64, 1 << (size - 1).bit_length())
+
+class Pipeline:
+	def __init__(self, sched):
+		self.name = sched.name
+		self.core = sched.tokens.get(TKN_SCHED_CORE, 0)
+		self.frames = sched.tokens.get(TKN_SCHED_FRAMES, 48)
+		self.deadline = sched.tokens.get(TKN_SCHED_DEADLINE, 1000)
+		self.rate = self.frames * 1000000.0 / max(self.deadline, 1)
+		self.periods = 1000000.0 / max(self.deadline, 1)
+
+def channels(comp, pipe, buffers, routes):
+	# channels from the size of the buffer the component writes to
+	fmt = comp.tokens.get(TKN_COMP_FORMAT, "s32le")
+	periods = comp.tokens.get(TKN_COMP_PERIOD_SINK_COUNT, 2)
+	period = max(periods, 1) * pipe.frames * SAMPLE_BYTES.get(fmt, 4)
+	for source, sink in routes:
+		if source == comp.name and sink in buffers:
+			size = buffers[sink].tokens.get(TKN_BUF_SIZE, 0)
+			return max(1, int(round(float(size) / period)))
+	return 2
+
+def estimate(widgets, routes):
+	pipes = dict((w.index, Pipeline(w)) for w in widgets
+		if w.type == DAPM_SCHEDULER)
+	buffers = dict((w.name, w) for w in widgets if w.type == DAPM_BUFFER)
+
+	for w in widgets:
+		pipe = pipes.get(w.index)
+		if w.type == DAPM_SCHEDULER:
+			w.runtime = COMP_RUNTIME["pipeline"]
+			w.mcps = PIPE_PERIOD_CYCLES * pipe.periods / 1e6
+			continue
+		if w.type == DAPM_BUFFER:
+			w.runtime = COMP_RUNTIME["buffer"]
+			size = w.tokens.get(TKN_BUF_SIZE, 0)
+			w.buffer = int(math.ceil(float(size) / BUFFER_BLOCK)) \
+				* BUFFER_BLOCK
+			continue
+		if not w.kind or not pipe:
+			continue
+
+		nch = channels(w, pipe, buffers, routes)
+		rate = pipe.rate
+		if w.kind == "src":
+			rate = max(rate, w.tokens.get(TKN_SRC_RATE_IN, 0),
+				w.tokens.get(TKN_SRC_RATE_OUT, 0))
+		w.mcps = (COSTS[w.kind] * rate * nch +
+			COMP_PERIOD_CYCLES * pipe.periods) / 1e6
+		w.runtime = block_size(COMP_RUNTIME[w.kind])
+		w.buffer = COMP_DELAY.get(w.kind, 0) * nch
+	return pipes
+
+def guess_platform(name):
+	m = re.match(r"sof-([a-z]+)-", os.path.basename(name))
+	if m and m.group(1) in PLATFORMS:
+		return m.group(1)
+	return None
+
+def check(name, args):
+	platform = args.platform or guess_platform(name)
+	if not platform:
+		stderr_print("{:s}: unknown platform, not checked".format(name))
+		return 0
+	cores, mhz, runtime_size, buffer_size = PLATFORMS[platform]
+	if args.runtime is not None:
+		runtime_size = args.runtime
+	if args.buffer is not None:
+		buffer_size = args.buffer
+
+	widgets, routes = read_tplg(name)
+	pipes = estimate(widgets, routes)
+
+	core_mcps = [0.0] * cores
+	fail = 0
+	for pipe in pipes.values():
+		if pipe.core >= cores:
+			stderr_print("{:s}: {:s} on core {:d}, {:s} has {:d}"
+				.format(name, pipe.name, pipe.core, platform,
+				cores))
+			fail = 1
+
+	for w in widgets:
+		pipe = pipes.get(w.index)
+		core = pipe.core if pipe else 0
+		if core >= cores:
+			continue
+		core_mcps[core] += w.mcps
+		if args.verbose and (w.mcps or w.buffer):
+			print("\t{:<24s} core {:d} {:7.2f} MCPS {:6d} + {:6d} bytes"
+				.format(w.name, core, w.mcps, w.runtime,
+				w.buffer))
+
+	limit = mhz * args.load / 100.0
+	for core, mcps in enumerate(core_mcps):
+		if mcps > limit:
+			stderr_print("{:s}: core {:d} needs {:.1f} MCPS, budget {:.1f}"
+				.format(name, core, mcps, limit))
+			fail = 1
+
+	runtime = sum(w.runtime for w in widgets)
+	buffer = sum(w.buffer for w in widgets)
+	for zone, used, size in (("runtime", runtime, runtime_size),
+				 ("buffer", buffer, buffer_size)):
+		if used > size:
+			stderr_print("{:s}: {:s} zone needs {:d} bytes, size {:d}"
+				.format(name, zone, used, size))
+			fail = 1
+
+	print("{:s}: {:s}, MCPS per core {:s} of {:.0f}, runtime {:d} of {:d}, "
+		"buffer {:d} of {:d} bytes{:s}".format(name, platform,
+		" ".join("{:.1f}".format(m) for m in core_mcps), limit,
+		runtime, runtime_size, buffer, buffer_size,
+		", OVER BUDGET" if fail else ""))
+	return fail
+
+def parse_params():
+	parser = argparse.ArgumentParser(
+		description="Tool for checking topologies against platform"
+			+" budgets. It estimates the MCPS per core and heap use"
+			+" per zone and fails if any budget is exceeded."
+	)
+	parser.add_argument('infiles', nargs='+', type=str,
+		help='binary topology files')
+	parser.add_argument('-p', '--platform', choices=sorted(PLATFORMS),
+		help='platform, from the sof-<platform>- name if not given')
+	parser.add_argument('-l', '--load', type=int, default=90,
+		help='usable share of each core in percent, 90 if not given')
+	parser.add_argument('-c', '--costs', action='append', default=[],
+		help='kernel_bench output of the target for component costs')
+	parser.add_argument('-r', '--runtime', type=int,
+		help='runtime zone size in bytes, platform size if not given')
+	parser.add_argument('-b', '--buffer', type=int,
+		help='buffer zone size in bytes, platform size if not given')
+	parser.add_argument('-v', '--verbose', action='store_true',
+		help='print the estimate of every component')
+	return parser.parse_args()
+
+if __name__ == "__main__":
+	args = parse_params()
+	read_costs(args.costs)
+	fail = 0
+	for name in args.infiles:
+		try:
+			fail |= check(name, args)
+		except (ValueError, IndexError, struct.error) as e:
+			stderr_print("{:s}: error: {:s}".format(name, str(e)))
+			fail = 1
+	sys.exit(fail)
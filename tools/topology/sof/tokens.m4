@@ -28,11 +28,16 @@ SectionVendorTokens."sof_sched_tokens" {
 	SOF_TKN_SCHED_CORE			"203"
 	SOF_TKN_SCHED_FRAMES			"204"
 	SOF_TKN_SCHED_TIMER			"205"
+	SOF_TKN_SCHED_PERIODS			"206"
+	SOF_TKN_SCHED_IDLE			"207"
+	SOF_TKN_SCHED_PULL			"208"
+	SOF_TKN_SCHED_FAST_START		"209"
 }
 
 SectionVendorTokens."sof_volume_tokens" {
 	SOF_TKN_VOLUME_RAMP_STEP_TYPE		"250"
 	SOF_TKN_VOLUME_RAMP_STEP_MS		"251"
+	SOF_TKN_VOLUME_PRECISION		"252"
 }
 
 SectionVendorTokens."sof_src_tokens" {
@@ -88,3 +93,12 @@ SectionVendorTokens."sof_tone_tokens" {
 SectionVendorTokens."sof_effect_tokens" {
 	SOF_TKN_EFFECT_TYPE			"900"
 }
+
+SectionVendorTokens."sof_mixer_tokens" {
+	SOF_TKN_MIXER_UNDERRUN			"1000"
+}
+
+SectionVendorTokens."sof_switch_tokens" {
+	SOF_TKN_SWITCH_ROUTE			"1100"
+	SOF_TKN_SWITCH_FADE_MS			"1101"
+}
@@ -1,12 +1,14 @@
-function iir_resp = eq_iir_blob_quant(eq_z, eq_p, eq_k)
+function iir_resp = eq_iir_blob_quant(eq_z, eq_p, eq_k, precision)
 
 %% Convert IIR coefficients to 2nd order sections and quantize
 %
-%  iir_resp = eq_iir_blob_quant(z, p, k)
+%  iir_resp = eq_iir_blob_quant(z, p, k, precision)
 %
 %  z - zeros
 %  p - poles
 %  k - gain
+%  precision - optional filter state bits 64 (default) or 32, the 32 bit
+%              state is for responses with no very low frequency poles
 %
 %  iir_resp - vector to setup an IIR equalizer with number of sections, shifts,
 %  and quantized coefficients
@@ -42,6 +44,10 @@ function iir_resp = eq_iir_blob_quant(eq_z, eq_p, eq_k)
 % Author: Seppo Ingalsuo <seppo.ingalsuo@linux.intel.com>
 %
 
+if nargin < 4
+        precision = 64;
+end
+
 %% Settings
 bits_iir = 32; % Q2.30
 qf_iir = 30;
@@ -84,11 +90,19 @@ gain = 1;
 %  scaling shifts and finally gain multiplier for output.
 sz = size(sos);
 nbr_sections = sz(1);
-n_section_header = 6; % Two plus reserved[4] in ABI
+n_section_header = 6; % Three plus reserved[3] in ABI
 n_section = 7;
 iir_resp = int32(zeros(1,n_section_header+nbr_sections*n_section));
 iir_resp(1) = nbr_sections;
 iir_resp(2) = nbr_sections; % Note: All sections in series
+switch precision
+        case 64
+                iir_resp(3) = 0; % SOF_EQ_IIR_PRECISION_64
+        case 32
+                iir_resp(3) = 1; % SOF_EQ_IIR_PRECISION_32
+        otherwise
+                error('Precision must be 64 or 32');
+end
 
 scale_max_lin = 10^(scale_max/20);
 for n=1:nbr_sections
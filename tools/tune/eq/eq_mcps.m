@@ -0,0 +1,131 @@
+function mcps = eq_mcps(blobfn, type, fs, cost)
+
+%% Estimate MCPS of an EQ setup blob
+%
+% mcps = eq_mcps(blobfn, type, fs, cost)
+%
+% blobfn - file name of EQ setup blob
+% type   - 'fir' or 'iir'
+% fs     - sample rate, default 48 kHz
+% cost   - cycles model struct, optional, with fields
+%   mac    - cycles per FIR tap
+%   biquad - cycles per IIR biquad section
+%   sample - cycles per sample for load, round and store
+%   copy   - cycles per sample for a channel without response
+%
+% Every channel in the blob is counted with the response it is assigned.
+% Compare with comp_bench -b -c eq_fir -B <blob> on the host for the
+% relative cost of two blobs.
+%
+
+%%
+%%
+% Copyright (c) 2019, Intel Corporation
+% All rights reserved.
+%
+% Redistribution and use in source and binary forms, with or without
+% modification, are permitted provided that the following conditions are met:
+%   * Redistributions of source code must retain the above copyright
+%     notice, this list of conditions and the following disclaimer.
+%   * Redistributions in binary form must reproduce the above copyright
+%     notice, this list of conditions and the following disclaimer in the
+%     documentation and/or other materials provided with the distribution.
+%   * Neither the name of the Intel Corporation nor the
+%     names of its contributors may be used to endorse or promote products
+%     derived from this software without specific prior written permission.
+%
+% THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+% AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+% IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+% ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+% LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+% CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+% SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+% INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+% CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+% ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+% POSSIBILITY OF SUCH DAMAGE.
+
+if nargin < 4
+	cost.mac = 0.5;
+	cost.biquad = 6;
+	cost.sample = 10;
+	cost.copy = 2;
+end
+
+if nargin < 3
+	fs = 48e3;
+end
+
+switch lower(type)
+	case 'fir'
+		[assign, lengths] = fir_responses(blobfn);
+		resp_cycles = lengths * cost.mac + cost.sample;
+	case 'iir'
+		[assign, sections] = iir_responses(blobfn);
+		resp_cycles = sections * cost.biquad + cost.sample;
+	otherwise
+		error('Unknown EQ type!');
+end
+
+cycles = 0;
+for i = 1:length(assign)
+	if assign(i) < 0
+		cycles = cycles + cost.copy;
+	else
+		cycles = cycles + resp_cycles(assign(i) + 1);
+	end
+end
+
+mcps = cycles * fs / 1e6;
+fprintf('EQ %s: %d channels, %.2f MCPS at %.1f kHz\n', type, ...
+	length(assign), mcps, fs / 1e3);
+
+end
+
+%% FIR blob is 16 bit words, see eq_fir_blob_decode()
+function [assign, lengths] = fir_responses(blobfn)
+
+fh = fopen(blobfn, 'rb');
+blob16 = fread(fh, inf, 'int16');
+fclose(fh);
+
+abi = 16;
+n_blob_header = 12;
+n_fir_header = 10;
+channels = blob16(abi + 3);
+responses = blob16(abi + 4);
+assign = blob16(abi + 13:abi + 13 + channels - 1);
+
+lengths = zeros(1, responses);
+j = abi + n_blob_header + channels + 1;
+for i = 1:responses
+	lengths(i) = blob16(j);
+	j = j + lengths(i) + n_fir_header;
+end
+
+end
+
+%% IIR blob is 32 bit words, see eq_iir_blob_decode()
+function [assign, sections] = iir_responses(blobfn)
+
+fh = fopen(blobfn, 'rb');
+blob = fread(fh, inf, 'int32');
+fclose(fh);
+
+abi = 8;
+n_blob_header = 7;
+n_iir_header = 6;
+n_iir_section = 7;
+channels = blob(abi + 2);
+responses = blob(abi + 3);
+assign = blob(abi + 8:abi + 8 + channels - 1);
+
+sections = zeros(1, responses);
+j = abi + n_blob_header + channels + 1;
+for i = 1:responses
+	sections(i) = blob(j);
+	j = j + sections(i) * n_iir_section + n_iir_header;
+end
+
+end
@@ -109,7 +109,7 @@ end
 end
 
 function print_int_coef(src, fh, vtype, vfn, nbits)
-        fprintf(fh, 'const %s %s[%d] = {\n', ...
+        fprintf(fh, 'const %s %s[%d] __cold_rodata = {\n', ...
                 vtype, vfn, src.filter_length);
 
         cint = coef_quant(src, nbits);
@@ -14,6 +14,7 @@ function src_generate(fs_in, fs_out, fs_inout, cfg);
 %   profile - differentiate set with identifier, e.g. 'std'
 %   quality - quality factor, usually 1.0
 %   speed   - optimize speed, gives higher RAM size, usually 0
+%   cost    - cycles model for MCPS estimate, optional, see src_mcps_cost
 %
 % If fs_inout matrix is omitted this script will compute coefficients
 % for all fs_in <-> fs_out combinations.
@@ -61,6 +62,9 @@ end
 if nargin < 3
 	fs_inout = ones(length(fs_in), length(fs_out));
 end
+if ~isfield(cfg, 'cost')
+	cfg.cost = src_mcps_cost();
+end
 
 sio = size(fs_inout);
 if (length(fs_in) ~= sio(1)) ||  (length(fs_out) ~= sio(2))
@@ -104,6 +108,8 @@ nfso = length(fs_out);
 l_2s = zeros(2, nfsi, nfso);
 m_2s = zeros(2, nfsi, nfso);
 mops_2s = zeros(2, nfsi, nfso);
+mcps_2s = zeros(nfsi, nfso);
+rs_2s = zeros(nfsi, nfso);
 pb_2s = zeros(2,nfsi, nfso);
 sb_2s = zeros(2,nfsi, nfso);
 taps_2s = zeros(2,nfsi, nfso);
@@ -161,6 +167,8 @@ for b = 1:nfso
                         l_2s(:,a,b) = [src1.L src2.L];
                         m_2s(:,a,b) = [src1.M src2.M];
                         mops_2s(:,a,b) = [src1.MOPS src2.MOPS];
+                        mcps_2s(a,b) = src_mcps(src1, src2, 1, cfg.cost);
+                        rs_2s(a,b) = min(cnv1.rs, cnv2.rs);
                         pb_2s(:,a,b) = [round(1e4*src1.c_pb) round(1e4*src2.c_pb)];
                         sb_2s(:,a,b) = [round(1e4*src1.c_sb) round(1e4*src2.c_sb)];
 			taps_2s(:,a,b) = [src1.filter_length src2.filter_length];
@@ -249,7 +257,28 @@ for a = 1:nfsi
 end
 fprintf(fh,'\n');
 
-fprintf(fh,'Coefficient RAM %.1f kB\n', ...
+%% Print 2 stage estimated MCPS
+fprintf(fh,'Dual stage fractional SRC: estimated MCPS per channel\n');
+fprintf(fh,'%8s, ', 'in \ out');
+for b = 1:nfso
+        fprintf(fh,'%8.1f, ', fs_out(b)/1e3);
+end
+fprintf(fh,'\n');
+for a = 1:nfsi
+        fprintf(fh,'%8.1f, ', fs_in(a)/1e3);
+        for b = 1:nfso
+                if sum(l_2s(:,a,b)) < eps
+                        mcps_str = 'x';
+                else
+                        mcps_str = sprintf('%.2f', mcps_2s(a,b));
+                end
+                fprintf(fh,'%8s, ', mcps_str);
+        end
+        fprintf(fh,'\n');
+end
+fprintf(fh,'\n');
+
+ %.1f kB\n', ...
         defs.sum_filter_lengths*coef_bytes/1024);
 fprintf(fh,'Max. data RAM %.1f kB\n', ...
 	(defs.fir_delay_size + defs.out_delay_size+defs.stage_buf_size) ...
@@ -259,6 +288,29 @@ fprintf(fh,'\n');
 fclose(fh);
 type(fn);
 
+%% Export per conversion cost and quality for comparing configurations
+src_export_mcps(sprintf('%s/src_%s_mcps.csv', rdir, cfg.profile), ...
+	fs_in, fs_out, l_2s, m_2s, taps_2s, rs_2s, mops_2s, mcps_2s);
+
+end
+
+function src_export_mcps(fn, fs_in, fs_out, l_2s, m_2s, taps_2s, rs_2s, ...
+	mops_2s, mcps_2s)
+fh = fopen(fn, 'w');
+fprintf(fh, 'rate,sink_rate,l1,m1,l2,m2,taps1,taps2,rs,mops,mcps\n');
+for a = 1:length(fs_in)
+        for b = 1:length(fs_out)
+                if sum(l_2s(:,a,b)) > eps
+                        fprintf(fh, '%d,%d,%d,%d,%d,%d,%d,%d,%.1f,%.3f,%.3f\n', ...
+                                fs_in(a), fs_out(b), l_2s(1,a,b), ...
+                                m_2s(1,a,b), l_2s(2,a,b), m_2s(2,a,b), ...
+                                taps_2s(1,a,b), taps_2s(2,a,b), ...
+                                rs_2s(a,b), sum(mops_2s(:,a,b)), ...
+                                mcps_2s(a,b));
+                end
+        end
+end
+fclose(fh);
 end
 
 function d = mkdir_check(d)
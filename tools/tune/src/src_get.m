@@ -57,6 +57,8 @@ if abs(cnv.fs1-cnv.fs2) < 1
         %% Return minimum needed for scripts to work
         src.L=1;
         src.M=1;
+        src.fs1 = cnv.fs1;
+        src.fs2 = cnv.fs2;
         src.odm=1;
         src.idm=1;
         src.MOPS=0;
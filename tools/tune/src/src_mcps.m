@@ -0,0 +1,69 @@
+function mcps = src_mcps(src1, src2, ch, cost)
+
+% src_mcps - estimate MCPS of a two stage conversion
+%
+% mcps = src_mcps(src1, src2, ch, cost)
+%
+% src1 - first stage from src_get()
+% src2 - second stage from src_get()
+% ch   - number of channels, default 1
+% cost - cycles model struct, default from src_mcps_cost()
+%
+% A polyphase stage is run once per blk_in input frames and produces
+% blk_out output frames with subfilter_length MACs each per channel. The
+% estimate adds a fixed cost per stage call and per output sample to the
+% MACs. An unity stage only copies samples.
+%
+
+%%
+% Copyright (c) 2019, Intel Corporation
+% All rights reserved.
+%
+% Redistribution and use in source and binary forms, with or without
+% modification, are permitted provided that the following conditions are met:
+%   * Redistributions of source code must retain the above copyright
+%     notice, this list of conditions and the following disclaimer.
+%   * Redistributions in binary form must reproduce the above copyright
+%     notice, this list of conditions and the following disclaimer in the
+%     documentation and/or other materials provided with the distribution.
+%   * Neither the name of the Intel Corporation nor the
+%     names of its contributors may be used to endorse or promote products
+%     derived from this software without specific prior written permission.
+%
+% THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+% AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+% IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+% ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+% LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+% CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+% SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+% INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+% CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+% ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+% POSSIBILITY OF SUCH DAMAGE.
+
+if nargin < 4
+	cost = src_mcps_cost();
+end
+if nargin < 3
+	ch = 1;
+end
+
+mcps = stage_mcps(src1, ch, cost) + stage_mcps(src2, ch, cost);
+
+end
+
+function mcps = stage_mcps(src, ch, cost)
+
+if src.L == 1 && src.M == 1
+	% Unity stage copies the input to output
+	cycles = src.fs1 * ch * cost.copy;
+else
+	blocks = src.fs1 / src.blk_in;
+	outputs = blocks * src.blk_out * ch;
+	cycles = outputs * src.subfilter_length / cost.macs_per_cycle + ...
+		outputs * cost.sample + blocks * cost.block;
+end
+mcps = cycles / 1e6;
+
+end
@@ -0,0 +1,102 @@
+function check = src_mcps_check(bench_fn, mcps_fn, fmt, ch)
+
+% src_mcps_check - compare estimated SRC MCPS with measured copy() times
+%
+% check = src_mcps_check(bench_fn, mcps_fn, fmt, ch)
+%
+% bench_fn - CSV file from comp_bench -b -c src -C <file>
+% mcps_fn  - CSV file from src_generate(), reports/src_<profile>_mcps.csv
+% fmt      - sample format to compare, default 'S32_LE'
+% ch       - channels count to compare, default 2
+%
+% The measured time is scaled to the estimate with a least squares fit,
+% so only the relative cost of conversions is compared. A large error for
+% a conversion points to a cycles model term that needs adjusting in
+% src_mcps_cost().
+%
+% Returned struct fields
+% rate      - input rates of compared conversions
+% sink_rate - output rates of compared conversions
+% estimate  - estimated MCPS for ch channels
+% measured  - measured ns per second of input, scaled to the estimate
+% err       - relative error of the estimate
+%
+
+%%
+% Copyright (c) 2019, Intel Corporation
+% All rights reserved.
+%
+% Redistribution and use in source and binary forms, with or without
+% modification, are permitted provided that the following conditions are met:
+%   * Redistributions of source code must retain the above copyright
+%     notice, this list of conditions and the following disclaimer.
+%   * Redistributions in binary form must reproduce the above copyright
+%     notice, this list of conditions and the following disclaimer in the
+%     documentation and/or other materials provided with the distribution.
+%   * Neither the name of the Intel Corporation nor the
+%     names of its contributors may be used to endorse or promote products
+%     derived from this software without specific prior written permission.
+%
+% THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+% AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+% IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+% ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+% LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+% CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+% SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+% INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+% CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+% ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+% POSSIBILITY OF SUCH DAMAGE.
+
+if nargin < 4
+	ch = 2;
+end
+if nargin < 3
+	fmt = 'S32_LE';
+end
+
+fh = fopen(bench_fn, 'r');
+b = textscan(fh, '%s %s %d %d %d %f', 'Delimiter', ',', 'HeaderLines', 1);
+fclose(fh);
+
+fh = fopen(mcps_fn, 'r');
+e = textscan(fh, '%d %d %d %d %d %d %d %d %f %f %f', 'Delimiter', ',', ...
+	     'HeaderLines', 1);
+fclose(fh);
+
+check.rate = [];
+check.sink_rate = [];
+check.estimate = [];
+check.measured = [];
+for i = 1:length(b{1})
+	if ~strcmp(b{1}{i}, 'src') || ~strcmp(b{2}{i}, fmt) || b{3}(i) ~= ch
+		continue;
+	end
+	j = find(e{1} == b{4}(i) & e{2} == b{5}(i), 1);
+	if isempty(j)
+		continue;
+	end
+	check.rate(end + 1) = b{4}(i);
+	check.sink_rate(end + 1) = b{5}(i);
+	check.estimate(end + 1) = e{11}(j) * ch;
+	check.measured(end + 1) = b{6}(i) * double(b{4}(i));
+end
+
+if isempty(check.estimate)
+	error('No matching conversions found!');
+end
+
+k = check.measured(:) \ check.estimate(:);
+check.measured = k * check.measured;
+check.err = (check.estimate - check.measured) ./ check.measured;
+
+fprintf('%8s %8s %10s %10s %8s\n', 'rate', 'sink', 'estimate', ...
+	'measured', 'error');
+for i = 1:length(check.estimate)
+	fprintf('%8d %8d %10.2f %10.2f %7.1f%%\n', check.rate(i), ...
+		check.sink_rate(i), check.estimate(i), check.measured(i), ...
+		100 * check.err(i));
+end
+
+end
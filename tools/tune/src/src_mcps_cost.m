@@ -0,0 +1,66 @@
+function cost = src_mcps_cost(platform)
+
+% src_mcps_cost - get cycles model for SRC MCPS estimate
+%
+% cost = src_mcps_cost(platform)
+%
+% platform - 'generic' or 'hifi3', default 'generic'
+%
+% Returned struct fields
+% macs_per_cycle - FIR MACs per cycle in the polyphase filter
+% sample         - cycles per output sample for load, round and store
+% block          - cycles per stage call for setup and delay lines
+% copy           - cycles per sample for an unity stage
+%
+% The values are starting points. Fit them to a platform with
+% src_mcps_check() and measured copy() times.
+%
+
+%%
+% Copyright (c) 2019, Intel Corporation
+% All rights reserved.
+%
+% Redistribution and use in source and binary forms, with or without
+% modification, are permitted provided that the following conditions are met:
+%   * Redistributions of source code must retain the above copyright
+%     notice, this list of conditions and the following disclaimer.
+%   * Redistributions in binary form must reproduce the above copyright
+%     notice, this list of conditions and the following disclaimer in the
+%     documentation and/or other materials provided with the distribution.
+%   * Neither the name of the Intel Corporation nor the
+%     names of its contributors may be used to endorse or promote products
+%     derived from this software without specific prior written permission.
+%
+% THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+% AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+% IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+% ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+% LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+% CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+% SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+% INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+% CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+% ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+% POSSIBILITY OF SUCH DAMAGE.
+
+if nargin < 1
+	platform = 'generic';
+end
+
+switch lower(platform)
+	case 'generic'
+		cost.macs_per_cycle = 1;
+		cost.sample = 12;
+		cost.block = 200;
+		cost.copy = 4;
+	case 'hifi3'
+		% Two 32x32 MACs per cycle with the dual channel filter
+		cost.macs_per_cycle = 2;
+		cost.sample = 8;
+		cost.block = 150;
+		cost.copy = 2;
+	otherwise
+		error('Unknown platform!');
+end
+
+end